@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_BATTERYTABLE_HH_
+#define IGNITION_GAZEBO_BATTERYTABLE_HH_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Types.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class IGNITION_GAZEBO_HIDDEN BatteryTablePrivate;
+
+    /// \class BatteryTable BatteryTable.hh ignition/gazebo/BatteryTable.hh
+    /// \brief Table of all the batteries of the world, which are entities
+    /// with a BatterySoC component, indexed by the model they belong to and
+    /// by name. Systems which consume or depend on batteries use it to find
+    /// the batteries of their model without looping over all batteries.
+    ///
+    /// The table is rebuilt when entities are added or removed, by the
+    /// first system which calls Update afterwards. States of charge aren't
+    /// copied, they're read from the components when queried, so they're
+    /// always current. Queries may run concurrently with each other.
+    ///
+    /// There's one table per entity component manager, see For.
+    class IGNITION_GAZEBO_VISIBLE BatteryTable
+    {
+      /// \brief Get the table of an entity component manager, creating it
+      /// if needed. The table lives as long as a system holds it.
+      /// \param[in] _ecm Entity component manager.
+      /// \return The table.
+      public: static std::shared_ptr<BatteryTable> For(
+          const EntityComponentManager &_ecm);
+
+      /// \brief Constructor. Use For to share the table between systems.
+      public: BatteryTable();
+
+      /// \brief Destructor
+      public: ~BatteryTable();
+
+      /// \brief Bring the table up to date with the entities of the ECM.
+      /// It's cheap unless entities were added or removed, so every system
+      /// should call this before querying.
+      /// \param[in] _info Current simulation information.
+      /// \param[in] _ecm Entity component manager.
+      public: void Update(const UpdateInfo &_info,
+          const EntityComponentManager &_ecm);
+
+      /// \brief Number of batteries.
+      /// \return Number of batteries.
+      public: std::size_t Size() const;
+
+      /// \brief Get the batteries of a model.
+      /// \param[in] _model Model entity.
+      /// \return Battery entities, empty if the model has none.
+      public: std::vector<Entity> Batteries(Entity _model) const;
+
+      /// \brief Get the batteries with a given name.
+      /// \param[in] _name Battery name.
+      /// \return Battery entities, empty if there's none.
+      public: std::vector<Entity> BatteriesByName(
+          const std::string &_name) const;
+
+      /// \brief Check whether none of the batteries of a model is drained.
+      /// \param[in] _model Model entity.
+      /// \param[in] _ecm Entity component manager holding the states of
+      /// charge.
+      /// \return False if the state of charge of a battery of the model is
+      /// zero or less, true otherwise, including if it has no battery.
+      public: bool HasCharge(Entity _model,
+          const EntityComponentManager &_ecm) const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<BatteryTablePrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
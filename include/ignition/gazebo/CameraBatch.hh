@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_CAMERABATCH_HH_
+#define IGNITION_GAZEBO_CAMERABATCH_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class IGNITION_GAZEBO_HIDDEN CameraBatchPrivate;
+
+    /// \class CameraBatch CameraBatch.hh ignition/gazebo/CameraBatch.hh
+    /// \brief A contiguous buffer holding the latest frame of each camera in
+    /// a group, so consumers in the same process, such as learning code
+    /// stepping many identical environments, can read all of them as one
+    /// array instead of receiving one message per camera.
+    ///
+    /// The buffer holds Size() frames back to back, one slot per camera, and
+    /// is allocated when the first frame is written. All frames must have
+    /// the same dimensions and format as the first one, others are dropped.
+    /// On Linux, the buffer is page aligned and locked in memory, so it can
+    /// be registered with GPU APIs for fast transfers.
+    ///
+    /// A batch is complete once every slot was written with frames rendered
+    /// at the same simulation time. Consumers wait for that with WaitFor and
+    /// should read the buffer before the simulation steps again, since
+    /// frames of later steps are written in place.
+    ///
+    /// Batches are registered by name for the whole process. All functions
+    /// are thread safe.
+    class IGNITION_GAZEBO_VISIBLE CameraBatch
+    {
+      /// \brief Constructor, use Create instead.
+      /// \param[in] _name Name of the batch.
+      /// \param[in] _size Number of slots.
+      public: CameraBatch(const std::string &_name, std::size_t _size);
+
+      /// \brief Destructor
+      public: ~CameraBatch();
+
+      /// \brief Create a batch and register it, replacing a previous batch
+      /// with the same name. Holders of the previous batch can still use it.
+      /// \param[in] _name Name of the batch.
+      /// \param[in] _size Number of slots, must be positive.
+      /// \return The batch, or nullptr if _size is zero.
+      public: static std::shared_ptr<CameraBatch> Create(
+          const std::string &_name, std::size_t _size);
+
+      /// \brief Get a registered batch.
+      /// \param[in] _name Name of the batch.
+      /// \return The batch, or nullptr if there's none with that name.
+      public: static std::shared_ptr<CameraBatch> Find(
+          const std::string &_name);
+
+      /// \brief Unregister a batch. Holders can still use it.
+      /// \param[in] _name Name of the batch.
+      /// \return True if the batch was registered.
+      public: static bool Remove(const std::string &_name);
+
+      /// \brief Names of all registered batches.
+      /// \return Sorted names.
+      public: static std::vector<std::string> Names();
+
+      /// \brief Copy a frame into a slot. Called by the rendering threads.
+      /// \param[in] _slot Slot of the camera, less than Size().
+      /// \param[in] _data Frame data.
+      /// \param[in] _bytes Size of the data in bytes.
+      /// \param[in] _width Frame width.
+      /// \param[in] _height Frame height.
+      /// \param[in] _channels Number of channels per pixel.
+      /// \param[in] _format Pixel format, such as "RGB_INT8".
+      /// \param[in] _stamp Simulation time the frame was rendered at.
+      /// \return True if the frame was written.
+      public: bool Write(std::size_t _slot, const void *_data,
+          std::size_t _bytes, unsigned int _width, unsigned int _height,
+          unsigned int _channels, const std::string &_format,
+          const std::chrono::steady_clock::duration &_stamp);
+
+      /// \brief Wait until a batch newer than _sequence completes.
+      /// \param[in] _sequence Last sequence seen by the caller, 0 for none.
+      /// \param[in] _timeout Maximum time to wait.
+      /// \return The latest sequence, which is still _sequence on timeout.
+      public: uint64_t WaitFor(uint64_t _sequence,
+          const std::chrono::steady_clock::duration &_timeout) const;
+
+      /// \brief Name of the batch.
+      /// \return Name.
+      public: const std::string &Name() const;
+
+      /// \brief Number of slots.
+      /// \return Number of cameras in the batch.
+      public: std::size_t Size() const;
+
+      /// \brief Number of batches completed so far.
+      /// \return Sequence, starting at 0.
+      public: uint64_t Sequence() const;
+
+      /// \brief Simulation time of the latest complete batch.
+      /// \return Time, zero if none completed.
+      public: std::chrono::steady_clock::duration Stamp() const;
+
+      /// \brief Start of the buffer, holding Size() frames of FrameBytes()
+      /// bytes each.
+      /// \return Buffer, or nullptr until the first frame is written.
+      public: const void *Data() const;
+
+      /// \brief Size of each frame in bytes.
+      /// \return Bytes, zero until the first frame is written.
+      public: std::size_t FrameBytes() const;
+
+      /// \brief Width of the frames.
+      /// \return Width, zero until the first frame is written.
+      public: unsigned int Width() const;
+
+      /// \brief Height of the frames.
+      /// \return Height, zero until the first frame is written.
+      public: unsigned int Height() const;
+
+      /// \brief Channels per pixel of the frames.
+      /// \return Channels, zero until the first frame is written.
+      public: unsigned int Channels() const;
+
+      /// \brief Pixel format of the frames.
+      /// \return Format, empty until the first frame is written.
+      public: std::string Format() const;
+
+      /// \brief Whether the buffer is locked in memory.
+      /// \return True if locked.
+      public: bool Pinned() const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<CameraBatchPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
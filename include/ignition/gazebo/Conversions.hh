@@ -88,6 +88,29 @@ namespace ignition
     void IGNITION_GAZEBO_VISIBLE
     set(msgs::Time *_msg, const std::chrono::steady_clock::duration &_in);
 
+    /// \brief Helper function that sets a mutable msgs::Geometry object
+    /// to the values contained in a sdf::Geometry object. The message is
+    /// cleared first, and its sub-messages and repeated fields are reused,
+    /// so it's cheaper than copying the result of convert<msgs::Geometry>.
+    /// \param[out] _msg Geometry message to set.
+    /// \param[in] _in SDF geometry.
+    void IGNITION_GAZEBO_VISIBLE
+    set(msgs::Geometry *_msg, const sdf::Geometry &_in);
+
+    /// \brief Helper function that sets a mutable msgs::AxisAlignedBox
+    /// object to the values contained in a math::AxisAlignedBox object.
+    /// \param[out] _msg AxisAlignedBox message to set.
+    /// \param[in] _in Axis aligned box.
+    void IGNITION_GAZEBO_VISIBLE
+    set(msgs::AxisAlignedBox *_msg, const math::AxisAlignedBox &_in);
+
+    /// \brief Helper function that sets a gazebo::UpdateInfo object to the
+    /// values contained in a msgs::WorldStatistics object.
+    /// \param[out] _info UpdateInfo to set.
+    /// \param[in] _in WorldStatistics message.
+    void IGNITION_GAZEBO_VISIBLE
+    set(UpdateInfo *_info, const msgs::WorldStatistics &_in);
+
     /// \brief Generic conversion from an SDF geometry to another type.
     /// \param[in] _in SDF geometry.
     /// \return Conversion result.
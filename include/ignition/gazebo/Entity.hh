@@ -59,6 +59,44 @@ namespace ignition
 
     /// \brief Indicates a non-existant or invalid Entity.
     const Entity kNullEntity{0};
+
+    /// \brief Handle to an entity which also identifies the lifetime of
+    /// the entity it was created for.
+    ///
+    /// Entity ids may be reused, for example when seeking back through a
+    /// log recreates entities which had been removed. Systems which keep
+    /// entities across simulation steps can keep handles instead, obtained
+    /// from EntityComponentManager::Handle, and check them with
+    /// EntityComponentManager::HasEntity, which is a single comparison
+    /// against the generation the entity currently has.
+    struct EntityHandle
+    {
+      /// \brief The entity.
+      Entity entity{kNullEntity};
+
+      /// \brief Generation of the entity when the handle was created. Zero
+      /// for handles which don't refer to any entity.
+      uint64_t generation{0u};
+    };
+
+    /// \brief Equality operator for entity handles.
+    /// \param[in] _a First handle.
+    /// \param[in] _b Second handle.
+    /// \return True if both handles refer to the same lifetime of the same
+    /// entity.
+    inline bool operator==(const EntityHandle &_a, const EntityHandle &_b)
+    {
+      return _a.entity == _b.entity && _a.generation == _b.generation;
+    }
+
+    /// \brief Inequality operator for entity handles.
+    /// \param[in] _a First handle.
+    /// \param[in] _b Second handle.
+    /// \return True if the handles differ.
+    inline bool operator!=(const EntityHandle &_a, const EntityHandle &_b)
+    {
+      return !(_a == _b);
+    }
     }
   }
 }
@@ -20,6 +20,7 @@
 #include <ignition/msgs/serialized.pb.h>
 #include <ignition/msgs/serialized_map.pb.h>
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <optional>
@@ -33,6 +34,7 @@
 #include <vector>
 
 #include <ignition/common/Console.hh>
+#include <ignition/math/Pose3.hh>
 #include <ignition/math/graph/Graph.hh>
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/Export.hh"
@@ -49,6 +51,202 @@ namespace ignition
     inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     // Forward declarations.
     class IGNITION_GAZEBO_HIDDEN EntityComponentManagerPrivate;
+    class IGNITION_GAZEBO_HIDDEN StagedStatePrivate;
+    class IGNITION_GAZEBO_HIDDEN ComponentDemandPrivate;
+    class IGNITION_GAZEBO_HIDDEN ComponentSnapshotPrivate;
+    class IGNITION_GAZEBO_HIDDEN EntityCommandBufferPrivate;
+    class WorkStealingPool;
+
+    /// \brief A state message whose components were deserialized ahead of
+    /// time by EntityComponentManager::StageState. Applying it with
+    /// EntityComponentManager::SetState only moves data into the ECM, so
+    /// the costly part of setting a state can happen on another thread.
+    class IGNITION_GAZEBO_VISIBLE StagedState
+    {
+      /// \brief Constructor of an empty state.
+      public: StagedState();
+
+      /// \brief Move constructor
+      /// \param[in] _state State to move.
+      public: StagedState(StagedState &&_state) noexcept;
+
+      /// \brief Destructor
+      public: ~StagedState();
+
+      /// \brief Move assignment operator
+      /// \param[in] _state State to move.
+      /// \return Reference to this state.
+      public: StagedState &operator=(StagedState &&_state) noexcept;
+
+      /// \brief Whether the state has no changes to apply.
+      /// \return True if empty.
+      public: bool Empty() const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<StagedStatePrivate> dataPtr;
+
+      /// \brief Fills and applies the state.
+      private: friend class EntityComponentManager;
+    };
+
+    /// \brief In-memory copy of all entities and components of an entity
+    /// component manager, taken by EntityComponentManager::Snapshot.
+    /// Components are copied directly instead of being serialized, and a
+    /// snapshot isn't consumed by restoring it, so it can be restored any
+    /// number of times, into the manager it was taken from or into another
+    /// one. Snapshots can be shared between threads as long as none of them
+    /// modifies it.
+    class IGNITION_GAZEBO_VISIBLE ComponentSnapshot
+    {
+      /// \brief Constructor of an empty snapshot.
+      public: ComponentSnapshot();
+
+      /// \brief Move constructor
+      /// \param[in] _snapshot Snapshot to move.
+      public: ComponentSnapshot(ComponentSnapshot &&_snapshot) noexcept;
+
+      /// \brief Destructor
+      public: ~ComponentSnapshot();
+
+      /// \brief Move assignment operator
+      /// \param[in] _snapshot Snapshot to move.
+      /// \return Reference to this snapshot.
+      public: ComponentSnapshot &operator=(
+                  ComponentSnapshot &&_snapshot) noexcept;
+
+      /// \brief Number of entities in the snapshot.
+      /// \return Number of entities.
+      public: std::size_t EntityCount() const;
+
+      /// \brief Number of components in the snapshot.
+      /// \return Number of components of all entities.
+      public: std::size_t ComponentCount() const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<ComponentSnapshotPrivate> dataPtr;
+
+      /// \brief Fills and restores the snapshot.
+      private: friend class EntityComponentManager;
+    };
+
+    /// \brief A consumer's demand for a component of an entity, acquired
+    /// through EntityComponentManager::DemandComponent. Components which
+    /// are computed every step, such as world poses, velocities and joint
+    /// forces, are only filled by physics while they exist. A component
+    /// created by a demand is removed once every demand for it has been
+    /// released, so nobody keeps paying for it after its consumers are
+    /// gone. Components which already existed are never removed.
+    ///
+    /// The demand is released when the handle is destroyed, so consumers
+    /// usually keep it as a member. Handles can be released from any
+    /// thread, and can outlive the manager.
+    class IGNITION_GAZEBO_VISIBLE ComponentDemand
+    {
+      /// \brief Constructor of a handle without a demand.
+      public: ComponentDemand();
+
+      /// \brief Move constructor
+      /// \param[in] _demand Demand to move.
+      public: ComponentDemand(ComponentDemand &&_demand) noexcept;
+
+      /// \brief Destructor, which releases the demand.
+      public: ~ComponentDemand();
+
+      /// \brief Move assignment operator. The demand held by this handle,
+      /// if any, is released.
+      /// \param[in] _demand Demand to move.
+      /// \return Reference to this handle.
+      public: ComponentDemand &operator=(ComponentDemand &&_demand) noexcept;
+
+      /// \brief Release the demand. Nothing happens if it was already
+      /// released.
+      public: void Release();
+
+      /// \brief Whether the handle holds a demand.
+      /// \return True if it holds a demand which wasn't released.
+      public: bool Active() const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<ComponentDemandPrivate> dataPtr;
+
+      /// \brief Creates demands.
+      private: friend class EntityComponentManager;
+    };
+
+    /// \brief Structural changes to an entity component manager, recorded
+    /// to be applied later, at a point where no system is running.
+    ///
+    /// Each thread gets its own buffer from
+    /// EntityComponentManager::CommandBuffer, so systems running in
+    /// parallel can create and remove entities and components without
+    /// contending on the manager's locks. The simulation runner applies all
+    /// buffers after the PreUpdate and the Update phases. Commands recorded
+    /// by one thread are applied in the order they were recorded.
+    ///
+    /// Entities created through a buffer get their id right away, so
+    /// components can be recorded for them, but they only exist in the
+    /// manager once the buffer is applied.
+    class IGNITION_GAZEBO_VISIBLE EntityCommandBuffer
+    {
+      /// \brief Destructor
+      public: ~EntityCommandBuffer();
+
+      /// \brief Record the creation of an entity.
+      /// \return Id the entity will have.
+      public: Entity CreateEntity();
+
+      /// \brief Record the creation of a component. If the entity already
+      /// has a component of this type when the buffer is applied, its data
+      /// is replaced, as with EntityComponentManager::CreateComponent.
+      /// \param[in] _entity The entity.
+      /// \param[in] _data Data of the component, which is copied.
+      public: template<typename ComponentTypeT>
+              void CreateComponent(const Entity _entity,
+                  const ComponentTypeT &_data);
+
+      /// \brief Record the removal of a component.
+      /// \param[in] _entity The entity.
+      /// \param[in] _typeId Type of the component.
+      public: void RemoveComponent(const Entity _entity,
+                  const ComponentTypeId _typeId);
+
+      /// \brief Record the removal of a component.
+      /// \param[in] _entity The entity.
+      /// \tparam ComponentTypeT Type of the component.
+      public: template<typename ComponentTypeT>
+              void RemoveComponent(const Entity _entity);
+
+      /// \brief Record a request to remove an entity, see
+      /// EntityComponentManager::RequestRemoveEntity.
+      /// \param[in] _entity Entity to be removed.
+      /// \param[in] _recursive Whether to also remove all child entities.
+      public: void RequestRemoveEntity(const Entity _entity,
+                  bool _recursive = true);
+
+      /// \brief Number of commands recorded and not applied yet.
+      /// \return Number of commands.
+      public: std::size_t Size() const;
+
+      /// \brief Whether there are no commands to apply.
+      /// \return True if empty.
+      public: bool Empty() const;
+
+      /// \brief Constructor, only used by the entity component manager.
+      /// \param[in] _ecm Manager the buffer records changes for.
+      private: explicit EntityCommandBuffer(EntityComponentManager &_ecm);
+
+      /// \brief Record the creation of a component.
+      /// \param[in] _entity The entity.
+      /// \param[in] _comp Component to move into the manager.
+      private: void CreateComponentImplementation(const Entity _entity,
+                  std::unique_ptr<components::BaseComponent> _comp);
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<EntityCommandBufferPrivate> dataPtr;
+
+      /// \brief Creates and applies buffers.
+      private: friend class EntityComponentManager;
+    };
 
     /// \brief Type alias for the graph that holds entities.
     /// Each vertex is an entity, and the direction points from the parent to
@@ -75,6 +273,15 @@ namespace ignition
       /// \return An id for the Entity, or kNullEntity on failure.
       public: Entity CreateEntity();
 
+      /// \brief Creates several new entities at once. This is cheaper than
+      /// calling CreateEntity for each of them, because storage is reserved
+      /// once for all of them.
+      /// \param[in] _count Number of entities to create.
+      /// \return Ids of the new entities, which are consecutive. Fewer
+      /// entities are returned if the maximum number of entities is reached.
+      /// \sa CreateComponents
+      public: std::vector<Entity> CreateEntities(std::size_t _count);
+
       /// \brief Clone an entity and its components. If the entity has any child
       /// entities, they will also be cloned.
       /// When cloning entities, the following rules apply:
@@ -110,6 +317,29 @@ namespace ignition
       public: Entity Clone(Entity _entity, Entity _parent,
                   const std::string &_name, bool _allowRename);
 
+      /// \brief Clone an entity and all its descendants several times in
+      /// one pass. This is much cheaper than calling Clone repeatedly: the
+      /// subtree is walked once, unique names are found with a single scan
+      /// of existing names, all entities are created at once and components
+      /// of each type are created for all copies at once.
+      ///
+      /// Only the cloned root entities are renamed, to `<name>_<N>` with the
+      /// lowest free suffixes. Descendants keep their names, which are
+      /// unique within each cloned root, so joints keep referring to their
+      /// own copies of links. Model canonical links are remapped to the
+      /// copies.
+      /// \param[in] _entity The entity to clone.
+      /// \param[in] _parent The parent of the cloned roots, kNullEntity for
+      /// none.
+      /// \param[in] _name Base name of the cloned roots. If empty, the name
+      /// of _entity is used.
+      /// \param[in] _count Number of copies.
+      /// \return The cloned roots, in suffix order. Empty if _entity does not
+      /// exist or entities could not be created.
+      /// \sa Clone
+      public: std::vector<Entity> CloneMany(Entity _entity, Entity _parent,
+                  const std::string &_name, std::size_t _count);
+
       /// \brief Get the number of entities on the server.
       /// \return Entity count.
       public: size_t EntityCount() const;
@@ -167,6 +397,27 @@ namespace ignition
       /// \return True if the Entity exists.
       public: bool HasEntity(const Entity _entity) const;
 
+      /// \brief Get a handle to an entity, which can be kept across
+      /// simulation steps and checked with HasEntity(const EntityHandle &).
+      /// \param[in] _entity The entity.
+      /// \return Handle to the entity, or a handle which doesn't refer to
+      /// any entity if _entity doesn't exist.
+      public: EntityHandle Handle(const Entity _entity) const;
+
+      /// \brief Get whether the entity a handle was created for still
+      /// exists. This is false if the entity was removed, even if another
+      /// entity with the same id was created afterwards.
+      /// \param[in] _handle Handle to check.
+      /// \return True if the handle is still valid.
+      public: bool HasEntity(const EntityHandle &_handle) const;
+
+      /// \brief Get the command buffer of the calling thread, to record
+      /// structural changes which are applied when no system is running.
+      /// This is safe to call from systems running in parallel.
+      /// \return Command buffer of the calling thread.
+      /// \sa EntityCommandBuffer
+      public: EntityCommandBuffer &CommandBuffer();
+
       /// \brief Get the first parent of the given entity.
       /// \details Entities are not expected to have multiple parents.
       /// TODO(louise) Either prevent multiple parents or provide full support
@@ -238,6 +489,34 @@ namespace ignition
       public: template<typename ComponentTypeT>
               bool RemoveComponent(Entity _entity);
 
+      /// \brief Demand a component of an entity, which is created with
+      /// default data if the entity doesn't have it. Demands are counted,
+      /// and if the component was created by the first one, it's removed at
+      /// the end of the simulation step in which the last one is released.
+      /// Prefer this to creating components only to be filled by other
+      /// systems, see ComponentDemand.
+      /// \param[in] _entity The entity.
+      /// \param[in] _typeId Type of the component.
+      /// \return Handle holding the demand, which isn't active if the entity
+      /// doesn't exist or the type isn't registered.
+      public: ComponentDemand DemandComponent(const Entity _entity,
+                  const ComponentTypeId _typeId);
+
+      /// \brief Demand a component of an entity, see the non-template
+      /// version.
+      /// \param[in] _entity The entity.
+      /// \tparam ComponentTypeT Type of the component.
+      /// \return Handle holding the demand.
+      public: template<typename ComponentTypeT>
+              ComponentDemand DemandComponent(const Entity _entity);
+
+      /// \brief Get the number of demands held for a component.
+      /// \param[in] _entity The entity.
+      /// \param[in] _typeId Type of the component.
+      /// \return Number of demands which haven't been released.
+      public: std::size_t ComponentDemandCount(const Entity _entity,
+                  const ComponentTypeId _typeId) const;
+
       /// \brief Rebuild all the views. This could be an expensive
       /// operation.
       public: void RebuildViews();
@@ -255,6 +534,32 @@ namespace ignition
                   const Entity _entity,
                   const ComponentTypeT &_data);
 
+      /// \brief Create a component of a particular type for each of several
+      /// entities. This is equivalent to calling CreateComponent for each
+      /// entity, but views are only updated once for all the entities.
+      /// \param[in] _entities The entities that will be associated with the
+      /// components.
+      /// \param[in] _data Data of each component, in the same order as
+      /// _entities.
+      /// \return True if all components were created, false if the sizes
+      /// don't match or some of the entities don't exist.
+      public: template<typename ComponentTypeT>
+              bool CreateComponents(
+                  const std::vector<Entity> &_entities,
+                  const std::vector<ComponentTypeT> &_data);
+
+      /// \brief Create a component of a particular type with the same data
+      /// for each of several entities.
+      /// \param[in] _entities The entities that will be associated with the
+      /// components.
+      /// \param[in] _data Data copied into each component.
+      /// \return True if all components were created, false if some of the
+      /// entities don't exist.
+      public: template<typename ComponentTypeT>
+              bool CreateComponents(
+                  const std::vector<Entity> &_entities,
+                  const ComponentTypeT &_data);
+
       /// \brief Get a component assigned to an entity based on a
       /// component type.
       /// \param[in] _entity The entity.
@@ -271,6 +576,22 @@ namespace ignition
       public: template<typename ComponentTypeT>
               ComponentTypeT *Component(const Entity _entity);
 
+      /// \brief Get a component assigned to the entity of a handle.
+      /// \param[in] _handle Handle to the entity.
+      /// \return The component, or nullptr if the handle isn't valid
+      /// anymore or the component could not be found.
+      public: template<typename ComponentTypeT>
+              const ComponentTypeT *Component(
+                  const EntityHandle &_handle) const;
+
+      /// \brief Get a mutable component assigned to the entity of a
+      /// handle.
+      /// \param[in] _handle Handle to the entity.
+      /// \return The component, or nullptr if the handle isn't valid
+      /// anymore or the component could not be found.
+      public: template<typename ComponentTypeT>
+              ComponentTypeT *Component(const EntityHandle &_handle);
+
       /// \brief Get a component based on a key.
       /// \param[in] _key A key that uniquely identifies a component.
       /// \return The component associated with the key, or nullptr if the
@@ -332,6 +653,14 @@ namespace ignition
       public: std::unordered_set<ComponentTypeId> ComponentTypes(
           Entity _entity) const;
 
+      /// \brief Call a function for the type ID of each component attached
+      /// to an entity. Unlike ComponentTypes, this doesn't allocate. The
+      /// function must not create or remove components of the entity.
+      /// \param[in] _entity Entity to check.
+      /// \param[in] _f Function to call, returning false to stop.
+      public: void EachComponentType(Entity _entity,
+          const std::function<bool(ComponentTypeId)> &_f) const;
+
       /// \brief The first component instance of the specified type.
       /// This function is now deprecated, and will always return nullptr.
       /// \return nullptr.
@@ -375,6 +704,27 @@ namespace ignition
               std::vector<Entity> EntitiesByComponents(
                    const ComponentTypeTs &..._desiredComponents) const;
 
+      /// \brief Call a function for each entity which matches the value of
+      /// all the given components, like EntitiesByComponents but without
+      /// filling a vector. For example, the following stops at the first
+      /// sensor whose parent is `link`:
+      ///
+      ///  EachEntityByComponents([&](Entity _sensor)
+      ///    {
+      ///      found = _sensor;
+      ///      return false;
+      ///    }, components::ParentEntity(link), components::Sensor());
+      ///
+      /// \details Component type must have inequality operator. The
+      /// function must not create or remove entities or components.
+      ///
+      /// \param[in] _f Function to call, returning false to stop.
+      /// \param[in] _desiredComponents All the components which must match.
+      public: template<typename ...ComponentTypeTs>
+              void EachEntityByComponents(
+                   const std::function<bool(Entity)> &_f,
+                   const ComponentTypeTs &..._desiredComponents) const;
+
       /// \brief Get all entities which match the value of all the given
       /// components and are immediate children of a given parent entity.
       /// For example, the following will return a child of entity `parent`
@@ -394,6 +744,57 @@ namespace ignition
               std::vector<Entity> ChildrenByComponents(Entity _parent,
                    const ComponentTypeTs &..._desiredComponents) const;
 
+      /// \brief Get the child of an entity with a given name, which also has
+      /// components of the given types. For example, the following will
+      /// return the link named "wheel" of a model:
+      ///
+      ///  auto link = ChildByName<components::Link>(model, "wheel");
+      ///
+      /// Children are entities whose ParentEntity component holds _parent.
+      /// Unlike ChildrenByComponents, this doesn't scan a view: the ECM keeps
+      /// an index of children by name, which is updated as Name and
+      /// ParentEntity components are created, removed or marked as changed,
+      /// and as entities are removed. Components whose data is modified in
+      /// place must be marked as changed with SetChanged for the index to
+      /// see the new value.
+      /// \param[in] _parent Parent entity.
+      /// \param[in] _name Name of the child.
+      /// \tparam ComponentTypeTs Types of components the child must have.
+      /// \return The child with the lowest entity ID which matches, or
+      /// kNullEntity if there's none.
+      public: template<typename ...ComponentTypeTs>
+              Entity ChildByName(Entity _parent,
+                   const std::string &_name) const;
+
+      /// \brief Get the pose of an entity in the world frame, by composing
+      /// its Pose component with those of its ancestors, following
+      /// ParentEntity components up to the first ancestor without a pose.
+      ///
+      /// The world poses of the entity and of all the ancestors on the way
+      /// are cached, so that later calls for the same entities or their
+      /// siblings don't walk the hierarchy again. The cache is dropped when
+      /// a Pose or ParentEntity component is created, removed, set through
+      /// SetComponentData or marked as changed, and at the end of every
+      /// iteration.
+      ///
+      /// Poses written in place through Component<components::Pose>() and
+      /// not marked as changed aren't seen until the next iteration, or
+      /// ever for static entities, see IsStatic. Callers which can't
+      /// guarantee that should use gazebo::worldPose, which isn't cached.
+      /// \param[in] _entity Entity whose pose we want.
+      /// \return World pose, or nullopt if the entity doesn't have a Pose
+      /// component.
+      public: std::optional<math::Pose3d> EntityWorldPose(
+                  const Entity _entity) const;
+
+      /// \brief Get the children of an entity which have components of the
+      /// given types, using the same index as ChildByName.
+      /// \param[in] _parent Parent entity.
+      /// \tparam ComponentTypeTs Types of components the children must have.
+      /// \return Matching children, sorted by entity ID.
+      public: template<typename ...ComponentTypeTs>
+              std::vector<Entity> ChildrenWithComponents(Entity _parent) const;
+
       /// why is this required?
       private: template <typename T>
                struct identity;  // NOLINT
@@ -481,6 +882,51 @@ namespace ignition
                   bool(const Entity &_entity,
                        ComponentTypeTs *...)>>::type _f);
 
+      /// \brief Parallel version of Each(). The matching entities are split
+      /// into contiguous chunks which are processed concurrently by a worker
+      /// pool shared by all EachParallel calls. Small sets of entities are
+      /// processed on the calling thread. This call blocks until all entities
+      /// have been processed.
+      ///
+      /// Rules for the callback:
+      /// * It may be called concurrently from several threads, so anything it
+      ///   captures must be safe to use from multiple threads.
+      /// * The order in which entities are visited is unspecified.
+      /// * It must not call any non-const function of the entity component
+      ///   manager, such as creating or removing entities and components, or
+      ///   marking components as changed. Record those changes instead and
+      ///   apply them after EachParallel returns.
+      /// * Returning false stops further calls as soon as possible, but calls
+      ///   already running on other threads will complete.
+      ///
+      /// The worker pool is shared with State, SetState and the systems run
+      /// by the simulation runner, so EachParallel may be called from another
+      /// EachParallel callback or from systems running concurrently. The
+      /// number of chunks is limited by SetMaxThreads. When storage is
+      /// partitioned across NUMA nodes, entities are processed on threads
+      /// of the node holding their components, see SetNumaNodes.
+      /// \param[in] _f Callback function to be called for each matching entity.
+      /// \tparam ComponentTypeTs All the desired component types.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs>
+              void EachParallel(typename identity<std::function<
+                  bool(const Entity &_entity,
+                       const ComponentTypeTs *...)>>::type _f) const;
+
+      /// \brief Parallel version of Each() with mutable components. Follows
+      /// the same rules as the const version. Each entity is visited by a
+      /// single thread, so the callback may modify the components it receives,
+      /// but not components of other entities.
+      /// \param[in] _f Callback function to be called for each matching entity.
+      /// \tparam ComponentTypeTs All the desired mutable component types.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs>
+              void EachParallel(typename identity<std::function<
+                  bool(const Entity &_entity,
+                       ComponentTypeTs *...)>>::type _f);
+
       /// \brief Call a function for each parameter in a pack.
       /// \param[in] _f Function to be called.
       /// \param[in] _components Parameters which should be passed to the
@@ -539,11 +985,146 @@ namespace ignition
                   bool(const Entity &_entity,
                        const ComponentTypeTs *...)>>::type _f) const;
 
+      /// \brief Same as Each, but taking any callable, such as a lambda,
+      /// instead of a std::function. The callable's type is known at compile
+      /// time, so calls to it can be inlined into the loop over the matching
+      /// entities instead of going through type erasure for each entity.
+      /// This overload is picked over the std::function one whenever a
+      /// lambda is passed.
+      /// \param[in] _f Callable taking the entity and const pointers to the
+      /// components, returning false to stop further calls.
+      /// \tparam ComponentTypeTs All the desired component types.
+      /// \tparam FunctionT Type of the callable, deduced.
+      public: template<typename ...ComponentTypeTs, typename FunctionT>
+              void Each(FunctionT &&_f) const;
+
+      /// \brief Same as Each, but taking any callable. See the const
+      /// version.
+      /// \param[in] _f Callable taking the entity and pointers to the
+      /// components, returning false to stop further calls.
+      /// \tparam ComponentTypeTs All the desired mutable component types.
+      /// \tparam FunctionT Type of the callable, deduced.
+      public: template<typename ...ComponentTypeTs, typename FunctionT>
+              void Each(FunctionT &&_f);
+
+      /// \brief Same as EachNew, but taking any callable. See Each.
+      /// \param[in] _f Callable taking the entity and const pointers to the
+      /// components, returning false to stop further calls.
+      /// \tparam ComponentTypeTs All the desired component types.
+      /// \tparam FunctionT Type of the callable, deduced.
+      public: template<typename ...ComponentTypeTs, typename FunctionT>
+              void EachNew(FunctionT &&_f) const;
+
+      /// \brief Same as EachNew, but taking any callable. See Each.
+      /// \param[in] _f Callable taking the entity and pointers to the
+      /// components, returning false to stop further calls.
+      /// \tparam ComponentTypeTs All the desired mutable component types.
+      /// \tparam FunctionT Type of the callable, deduced.
+      public: template<typename ...ComponentTypeTs, typename FunctionT>
+              void EachNew(FunctionT &&_f);
+
+      /// \brief Same as EachRemoved, but taking any callable. See Each.
+      /// \param[in] _f Callable taking the entity and const pointers to the
+      /// components, returning false to stop further calls.
+      /// \tparam ComponentTypeTs All the desired component types.
+      /// \tparam FunctionT Type of the callable, deduced.
+      public: template<typename ...ComponentTypeTs, typename FunctionT>
+              void EachRemoved(FunctionT &&_f) const;
+
+      /// \brief Get the entities which have all the given component types,
+      /// and their components, as a range for a range-based for loop. This
+      /// visits the same entities as Each, without a callback:
+      /// \code
+      /// for (auto [entity, pose, name] :
+      ///     _ecm.EachRange<components::Pose, components::Name>())
+      /// {
+      ///   // pose and name are const pointers to the components
+      /// }
+      /// \endcode
+      /// Components of the given types must not be created or removed, and
+      /// entities must not be removed, while iterating.
+      /// \tparam ComponentTypeTs All the desired component types.
+      /// \return Range of tuples of an entity and const pointers to its
+      /// components.
+      public: template<typename ...ComponentTypeTs>
+              detail::ViewRange<const ComponentTypeTs...> EachRange() const;
+
+      /// \brief Same as the const version, with mutable components.
+      /// \tparam ComponentTypeTs All the desired mutable component types.
+      /// \return Range of tuples of an entity and pointers to its
+      /// components.
+      public: template<typename ...ComponentTypeTs>
+              detail::ViewRange<ComponentTypeTs...> EachRange();
+
+      /// \brief Get all entities whose first component type has been marked
+      /// as changed during the current iteration, either as a one-time or a
+      /// periodic change, and which contain all the other given component
+      /// types, as well as the components. Unlike Each, the cost of this
+      /// function scales with the number of changes instead of the number of
+      /// entities, so it's a cheap way of synchronizing a copy of the ECM.
+      /// Changes made without calling SetChanged, for example by modifying
+      /// the data of a component pointer directly, are not reported.
+      /// \param[in] _f Callback function to be called for each matching entity.
+      /// The function parameter are all the desired component types, in the
+      /// order they're listed on the template. The callback function can
+      /// return false to stop subsequent calls to the callback, otherwise
+      /// a true value should be returned.
+      /// \tparam ComponentTypeTs All the desired component types. The first
+      /// one is the type whose changes are iterated over.
+      /// \warning Changes are cleared at the end of each iteration, so this
+      /// function should be called in a System's PostUpdate callback.
+      public: template<typename ...ComponentTypeTs>
+              void EachChanged(typename identity<std::function<
+                  bool(const Entity &_entity,
+                       const ComponentTypeTs *...)>>::type _f) const;
+
+      /// \brief Whether an entity is static: a model whose Static component
+      /// is true, or a descendant of one, such as its links, visuals and
+      /// nested models. Models nested in a dynamic model aren't static,
+      /// since they move with it.
+      ///
+      /// Static entities usually make up most of a world and never move, so
+      /// their world poses are cached across steps by EntityWorldPose, and
+      /// EachDynamic skips them. Their poses may still be changed, as long
+      /// as the change is marked through SetChanged or SetComponentData.
+      /// \param[in] _entity Entity.
+      /// \return True if static.
+      public: bool IsStatic(const Entity _entity) const;
+
+      /// \brief Same as Each, but skipping static entities, see IsStatic.
+      /// The non-static entities of each set of component types are cached,
+      /// so loops over poses and velocities only pay for the entities which
+      /// may move. The callback must not change which entities are static.
+      /// \param[in] _f Callback function to be called for each matching
+      /// entity which isn't static. Returning false stops further calls.
+      /// \tparam ComponentTypeTs All the desired component types.
+      public: template<typename ...ComponentTypeTs>
+              void EachDynamic(typename identity<std::function<
+                  bool(const Entity &_entity,
+                       const ComponentTypeTs *...)>>::type _f) const;
+
+      /// \brief Same as Each, but skipping static entities, see IsStatic.
+      /// \param[in] _f Callback function to be called for each matching
+      /// entity which isn't static. Returning false stops further calls.
+      /// \tparam ComponentTypeTs All the desired component types.
+      public: template<typename ...ComponentTypeTs>
+              void EachDynamic(typename identity<std::function<
+                  bool(const Entity &_entity,
+                       ComponentTypeTs *...)>>::type _f);
+
       /// \brief Get a graph with all the entities. Entities are vertices and
       /// edges point from parent to children.
+      /// Entities are kept in a lighter structure internally, and the graph
+      /// is rebuilt on the first call after entities were created, removed
+      /// or reparented. Prefer ParentEntity, Descendants and EachEntity
+      /// where possible.
       /// \return Entity graph.
       public: const EntityGraph &Entities() const;
 
+      /// \brief Call a function for each entity, in ascending order of id.
+      /// \param[in] _f Function to call, returning false to stop.
+      public: void EachEntity(const std::function<bool(Entity)> &_f) const;
+
       /// \brief Get all entities which are descendants of a given entity,
       /// including the entity itself.
       /// \param[in] _entity Entity whose descendants we want.
@@ -551,6 +1132,15 @@ namespace ignition
       /// empty if the entity doesn't exist.
       public: std::unordered_set<Entity> Descendants(Entity _entity) const;
 
+      /// \brief Call a function for an entity and each of its descendants,
+      /// depth first. Unlike Descendants, this doesn't allocate. The function
+      /// must not create, remove or reparent entities.
+      /// \param[in] _entity Entity whose descendants we want.
+      /// \param[in] _f Function to call, returning false to stop. It isn't
+      /// called if the entity doesn't exist.
+      public: void EachDescendant(Entity _entity,
+          const std::function<bool(Entity)> &_f) const;
+
       /// \brief Get a message with the serialized state of the given entities
       /// and components.
       /// \details The header of the message will not be populated, it is the
@@ -643,6 +1233,23 @@ namespace ignition
       /// responsibility of the caller to timestamp it before use.
       public: void ChangedState(msgs::SerializedStateMap &_state) const;
 
+      /// \brief Get a message with the serialized state of the given
+      /// entities and components that are changing in the current iteration.
+      /// This is cheaper than filtering the output of ChangedState, because
+      /// components which aren't requested are never serialized.
+      ///
+      /// New entities are always serialized with all of their components,
+      /// so that the message has all the information needed to create them.
+      ///
+      /// \param[in] _state New serialized state.
+      /// \param[in] _entities Entities to be serialized. Leave empty to get
+      /// all entities.
+      /// \param[in] _types Type IDs of components to be serialized for
+      /// entities which already existed. Leave empty to get all types.
+      public: void ChangedState(msgs::SerializedStateMap &_state,
+          const std::unordered_set<Entity> &_entities,
+          const std::unordered_set<ComponentTypeId> &_types) const;
+
       /// \brief Set the absolute state of the ECM from a serialized message.
       /// Entities / components that are in the new state but not in the old
       /// one will be created.
@@ -653,6 +1260,50 @@ namespace ignition
       /// \param[in] _stateMsg Message containing state to be set.
       public: void SetState(const msgs::SerializedStateMap &_stateMsg);
 
+      /// \brief Deserialize the components of a state message without
+      /// applying it. No ECM is accessed, so this can run on a worker thread
+      /// while the ECM receiving the state is in use.
+      /// \param[in] _stateMsg Message containing state to be staged.
+      /// \return Staged state, to be applied with SetState.
+      public: static StagedState StageState(
+                  const msgs::SerializedStateMap &_stateMsg);
+
+      /// \brief Deserialize the components of a state message into a staged
+      /// state which was already applied. Its components are reused instead
+      /// of allocating new ones, so staging states in a loop, like a client
+      /// following a running or playing back simulation, doesn't allocate
+      /// per component once the states stop growing.
+      /// \param[in] _stateMsg Message containing state to be staged.
+      /// \param[in, out] _state Staged state to be overwritten with the new
+      /// one, to be applied with SetState.
+      public: static void StageState(
+                  const msgs::SerializedStateMap &_stateMsg,
+                  StagedState &_state);
+
+      /// \brief Apply a state staged by StageState. This has the same
+      /// effect as setting the state from the message it was staged from,
+      /// but component data is moved into the ECM instead of deserialized.
+      /// \param[in, out] _state Staged state. Its component data is moved
+      /// out, so it can't be applied again, but it can be passed back to
+      /// StageState to reuse its components.
+      public: void SetState(StagedState &_state);
+
+      /// \brief Copy all entities and components into memory, so that they
+      /// can be restored later with RestoreSnapshot. Entities requested to be
+      /// removed are still copied.
+      /// \return Snapshot of the current state.
+      public: ComponentSnapshot Snapshot() const;
+
+      /// \brief Make the entities and components match a snapshot.
+      /// Entities which aren't in the snapshot are requested to be removed,
+      /// and components which aren't in it are removed. The snapshot's
+      /// components are copied in and marked as one-time changes, and
+      /// entities missing from this manager are created with their ids in
+      /// the snapshot.
+      /// \param[in] _snapshot Snapshot to restore, which is left untouched.
+      /// \sa Snapshot
+      public: void RestoreSnapshot(const ComponentSnapshot &_snapshot);
+
       /// \brief Set the changed state of a component.
       /// \param[in] _entity The entity.
       /// \param[in] _type Type of the component.
@@ -668,16 +1319,265 @@ namespace ignition
       public: gazebo::ComponentState ComponentState(const Entity _entity,
           const ComponentTypeId _typeId) const;
 
+      /// \brief Get the version of a component's last change. Every time a
+      /// component is created, removed or marked as changed through
+      /// SetChanged, it's assigned a new version which is higher than all
+      /// previous ones. Unlike ComponentState, versions aren't reset at the
+      /// end of each iteration, so consumers that don't process every
+      /// iteration can check whether a component changed since they last
+      /// looked at it, and skip it otherwise.
+      /// \param[in] _entity Entity that contains the component.
+      /// \param[in] _typeId Component type ID.
+      /// \return Version of the last change, or zero if the component never
+      /// changed or the entity doesn't exist.
+      /// \sa CurrentVersion
+      public: uint64_t ComponentVersion(const Entity _entity,
+          const ComponentTypeId _typeId) const;
+
+      /// \brief Get the version assigned to the latest component change.
+      /// Store it and pass it to ComponentVersion or ChangedStateSince later
+      /// to find out what changed in the meantime.
+      /// \return Latest version, zero if nothing changed yet.
+      public: uint64_t CurrentVersion() const;
+
+      /// \brief Get the version of the latest change to any component of a
+      /// type, that is, the highest ComponentVersion of that type. Systems
+      /// waiting for a condition on some type of component can compare it
+      /// with the version they last looked at, and only search the entities
+      /// when it grew. Removing entities doesn't change it.
+      /// \param[in] _typeId Component type ID.
+      /// \return Version of the latest change, or zero if no component of
+      /// the type changed yet.
+      /// \sa ComponentVersion
+      public: uint64_t ComponentTypeVersion(
+          const ComponentTypeId _typeId) const;
+
+      /// \brief Components of one type which were added, changed or
+      /// removed since an observer was last notified.
+      public: struct ComponentChanges
+      {
+        /// \brief Type of the components.
+        ComponentTypeId typeId{0u};
+
+        /// \brief Entities which got a component of the type.
+        std::vector<Entity> added;
+
+        /// \brief Entities whose component was replaced or marked as
+        /// changed through SetChanged.
+        std::vector<Entity> changed;
+
+        /// \brief Entities whose component was removed, including entities
+        /// which were removed.
+        std::vector<Entity> removed;
+      };
+
+      /// \brief Function called with the changes observed since the last
+      /// notification.
+      public: using ComponentObserver =
+          std::function<void(const ComponentChanges &)>;
+
+      /// \brief Observe the components of a type, so that systems can react
+      /// to their changes instead of looking for them at every iteration.
+      ///
+      /// Changes are collected as they happen, and delivered in batches on
+      /// the simulation thread at phase boundaries: before PreUpdate, after
+      /// PreUpdate and after Update. Within a batch each entity is reported
+      /// once: a component which was added and then changed is reported as
+      /// added, one which was added and then removed isn't reported, and one
+      /// which was removed and then added again is reported as changed.
+      /// Entities are reported in the order they first changed.
+      ///
+      /// Changes made to component data in place are only seen if they're
+      /// marked with SetChanged.
+      /// \param[in] _typeId Type of the components to observe.
+      /// \param[in] _callback Function called with each batch which has
+      /// changes. It may modify the entity component manager, and those
+      /// changes are delivered with the next batch.
+      /// \param[in] _root Only report this entity and its descendants.
+      /// Leave as kNullEntity to report all entities.
+      /// \return Id of the observer, to pass to RemoveComponentObserver.
+      public: uint64_t AddComponentObserver(const ComponentTypeId _typeId,
+          ComponentObserver _callback, Entity _root = kNullEntity);
+
+      /// \brief Stop observing components. Changes which weren't delivered
+      /// yet are dropped.
+      /// \param[in] _id Id returned by AddComponentObserver.
+      /// \return False if there's no observer with that id.
+      public: bool RemoveComponentObserver(uint64_t _id);
+
+      /// \brief Get a message with the components that changed after a given
+      /// version. Components that were removed are added with the `remove`
+      /// flag set. Removed entities aren't reported, use ChangedState to
+      /// find out about them.
+      /// \param[out] _state Message to be filled. Existing entries for the
+      /// same components are overwritten.
+      /// \param[in] _version Only components with a higher version are
+      /// serialized.
+      /// \param[in] _types Type IDs of components to be serialized. Leave
+      /// empty to get all component types.
+      /// \sa CurrentVersion
+      public: void ChangedStateSince(msgs::SerializedStateMap &_state,
+          uint64_t _version,
+          const std::unordered_set<ComponentTypeId> &_types = {}) const;
+
       /// \brief All future entities will have an id that starts at _offset.
       /// This can be used to avoid entity id collisions, such as during log
       /// playback.
       /// \param[in] _offset Offset value.
       public: void SetEntityCreateOffset(uint64_t _offset);
 
+      /// \brief Set whether state messages hold components which have a
+      /// binary serialization, such as poses, velocities and joint
+      /// positions, in binary form. Binary data is written straight into
+      /// the message, skipping streams, which makes generating states
+      /// cheaper. Setting states accepts data in both forms regardless.
+      ///
+      /// Binary data is in the byte order of the host, and older versions
+      /// can't read it, so this is off by default.
+      /// \param[in] _binary True to serialize in binary form.
+      /// \sa components::ComponentBinarySerialization
+      public: void SetBinarySerialization(bool _binary);
+
+      /// \brief Whether state messages hold components in binary form.
+      /// \return True if enabled.
+      /// \sa SetBinarySerialization
+      public: bool BinarySerialization() const;
+
+      /// \brief Set the maximum number of threads, including the calling
+      /// thread, used to split up the work of State, SetState and
+      /// EachParallel. The threads are long-lived and shared by all those
+      /// calls.
+      /// \param[in] _count Number of threads. Zero, the default, uses the
+      /// hardware concurrency. One does all the work on the calling thread.
+      public: void SetMaxThreads(unsigned int _count);
+
+      /// \brief Get the maximum number of threads used to split up work.
+      /// \return Number of threads, always at least one.
+      /// \sa SetMaxThreads
+      public: unsigned int MaxThreads() const;
+
+      /// \brief Set whether parallel work gives the same results on every
+      /// run, regardless of the number of threads and of how they're
+      /// scheduled. When enabled:
+      /// * ParallelFor and EachParallel split their range into the same
+      ///   chunks whatever the number of threads, so partial results of
+      ///   each chunk can be combined in a reproducible order.
+      /// * Command buffers belong to tasks, which are the systems run by the
+      ///   simulation runner and the chunks of ParallelFor, instead of to
+      ///   threads. They are applied ordered by task.
+      /// * TaskSeed gives each task its own reproducible seed.
+      ///
+      /// Ids of entities created through command buffers by tasks running
+      /// at the same time still depend on timing, so systems which need
+      /// reproducible ids must create entities from serial stages. Set this
+      /// before any command buffer is used.
+      /// \param[in] _deterministic True to enable, false by default.
+      public: void SetDeterministic(bool _deterministic);
+
+      /// \brief Whether parallel work gives the same results on every run.
+      /// \return True if enabled.
+      /// \sa SetDeterministic
+      public: bool Deterministic() const;
+
+      /// \brief Seed for a random number generator used by the task running
+      /// on the calling thread, such as a chunk of ParallelFor. In
+      /// deterministic mode, each task gets the same seed on every run, and
+      /// different tasks get unrelated seeds, so they can draw numbers
+      /// without sharing a generator.
+      /// \param[in] _seed Base seed, such as the server's seed combined with
+      /// the iteration.
+      /// \return Seed of the task.
+      /// \sa SetDeterministic
+      public: uint64_t TaskSeed(uint64_t _seed) const;
+
+      /// \brief Hash of the full serialized state. Equal states give equal
+      /// hashes, whatever the order entities and components were created
+      /// in, so comparing the hashes of two runs step by step tells where
+      /// they diverge.
+      /// \return 64 bit FNV-1a hash of the state.
+      public: uint64_t StateHash() const;
+
+      /// \brief Split the range [0, _count) into chunks and call _f for each
+      /// chunk using the shared worker pool. Blocks until all chunks are done.
+      /// Small ranges are processed on the calling thread.
+      ///
+      /// This is meant for systems that need to write a lot of component
+      /// data which has already been computed, such as results of a physics
+      /// step. The same rules as EachParallel apply: _f may look up existing
+      /// components and modify their data, as long as each component is only
+      /// touched by one chunk, but it must not create or remove entities or
+      /// components, or mark components as changed.
+      /// \param[in] _count Number of items to process.
+      /// \param[in] _f Function called with the first and one past the last
+      /// index of each chunk.
+      /// \param[in] _minChunkSize Smallest number of items worth handing to
+      /// another thread. Use small values when each item is expensive.
+      /// \sa SetMaxThreads
+      public: void ParallelFor(std::size_t _count,
+          const std::function<void(std::size_t, std::size_t)> &_f,
+          std::size_t _minChunkSize = 32u) const;
+
+      /// \brief Partition component storage and parallel work across NUMA
+      /// nodes, so that threads mostly touch memory of their own node.
+      /// Ranges of consecutive entity ids are dealt to the partitions in
+      /// turn. The components of each range are allocated on its node, and
+      /// EachParallel runs each range on worker threads of that node. The
+      /// simulation runner assigns its workers to the same nodes, see
+      /// ServerConfig::SetNumaNodes.
+      ///
+      /// Only component types first created after this call are partitioned,
+      /// so set this before creating entities. In deterministic mode,
+      /// EachParallel keeps its fixed chunks and ignores partitions.
+      /// \param[in] _nodes NUMA node of each partition. Empty, the default,
+      /// doesn't partition anything.
+      public: void SetNumaNodes(const std::vector<unsigned int> &_nodes);
+
+      /// \brief NUMA node of each partition of component storage.
+      /// \return Nodes, empty if storage isn't partitioned.
+      /// \sa SetNumaNodes
+      public: const std::vector<unsigned int> &NumaNodes() const;
+
+      /// \brief Partition the components of an entity are stored in.
+      /// \param[in] _entity Entity.
+      /// \return Index into NumaNodes, always 0 if storage isn't partitioned.
+      /// \sa SetNumaNodes
+      public: unsigned int NumaPartition(const Entity _entity) const;
+
       /// \brief Return true if there are components marked for removal.
       /// \return True if there are components marked for removal.
       public: bool HasRemovedComponents() const;
 
+      /// \brief Memory held by the components of one type.
+      public: struct ComponentTypeMemory
+      {
+        /// \brief Component type.
+        ComponentTypeId typeId{0u};
+
+        /// \brief Number of components of this type.
+        std::size_t count{0u};
+
+        /// \brief Bytes taken by the components themselves. Memory the
+        /// components allocate on their own, such as the characters of a
+        /// string, isn't counted. Zero for types whose size isn't known to
+        /// the component factory.
+        std::size_t bytes{0u};
+
+        /// \brief Bytes reserved for components of this type, including
+        /// free slots kept for future components.
+        std::size_t reservedBytes{0u};
+      };
+
+      /// \brief Get the memory held by the components of each type which
+      /// has been created so far. This is meant for diagnostics, it's
+      /// cheap but not free.
+      /// \return Memory of each component type, in no particular order.
+      public: std::vector<ComponentTypeMemory> ComponentMemory() const;
+
+      /// \brief Estimate the memory held by all views, not counting the
+      /// components they point to.
+      /// \return Estimate in bytes.
+      public: std::size_t ViewsMemory() const;
+
       /// \brief Clear the list of newly added entities so that a call to
       /// EachAdded after this will have no entities to iterate. This function
       /// is protected to facilitate testing.
@@ -692,9 +1592,26 @@ namespace ignition
       /// facilitate testing.
       protected: void ProcessRemoveEntityRequests();
 
+      /// \brief Remove the components created by demands which have all
+      /// been released since the last call. This function is protected to
+      /// facilitate testing.
+      protected: void RemoveUndemandedComponents();
+
+      /// \brief Apply the commands recorded in the command buffers of all
+      /// threads, and empty the buffers. Buffers are applied in the order
+      /// their threads first used them. This function is protected to
+      /// facilitate testing.
+      protected: void ApplyCommandBuffers();
+
       /// \brief Mark all components as not changed.
       protected: void SetAllComponentsUnchanged();
 
+      /// \brief Deliver the changes collected since the last call to the
+      /// component observers. This function is protected to facilitate
+      /// testing.
+      /// \sa AddComponentObserver
+      protected: void NotifyComponentObservers();
+
       /// \brief Get whether an Entity exists and is new.
       ///
       /// Entities are considered new in the time between their creation and a
@@ -720,6 +1637,21 @@ namespace ignition
                    const ComponentTypeId _componentTypeId,
                    const components::BaseComponent *_data);
 
+      /// \brief Implementation of CreateComponents.
+      /// \param[in] _entities The entities that will be associated with the
+      /// components.
+      /// \param[in] _componentTypeId Id of the component type.
+      /// \param[in] _data Data used to construct each component, in the same
+      /// order as _entities.
+      /// \param[out] _update Indices of the entities whose component data
+      /// needs to be set externally.
+      /// \return True if all components were created or need to be set.
+      private: bool CreateComponentsImplementation(
+                   const std::vector<Entity> &_entities,
+                   const ComponentTypeId _componentTypeId,
+                   const std::vector<const components::BaseComponent *> &_data,
+                   std::vector<std::size_t> &_update);
+
       /// \brief Get a component based on a component type.
       /// \param[in] _entity The entity.
       /// \param[in] _type Id of the component type.
@@ -738,6 +1670,22 @@ namespace ignition
                    const Entity _entity,
                    const ComponentTypeId _type);
 
+      /// \brief Record that SetComponentData changed a component's data, so
+      /// that indices which depend on it are updated.
+      /// \param[in] _entity Entity that owns the component.
+      /// \param[in] _typeId Type of the component.
+      private: void ComponentDataSet(const Entity _entity,
+                   const ComponentTypeId _typeId);
+
+      /// \brief Get children from the index of children by name. Pending
+      /// changes to Name and ParentEntity components are applied to the index
+      /// first.
+      /// \param[in] _parent Parent entity.
+      /// \param[in] _name Name of the children, or nullptr for all children.
+      /// \return Children sorted by entity ID.
+      private: std::vector<Entity> IndexedChildren(Entity _parent,
+                   const std::string *_name) const;
+
       /// \brief Find a View that matches the set of ComponentTypeIds. If
       /// a match is not found, then a new view is created.
       /// \tparam ComponentTypeTs All the component types that define a view.
@@ -745,6 +1693,15 @@ namespace ignition
       private: template<typename ...ComponentTypeTs>
           detail::View *FindView() const;
 
+      /// \brief Get the entities which have all of the given component
+      /// types. Only the entities having the rarest of the types are
+      /// checked, so this is cheap for views of uncommon components even
+      /// in large worlds.
+      /// \param[in] _types Component types. All entities match if empty.
+      /// \return Matching entities, in ascending order.
+      private: std::vector<Entity> EntitiesWithComponentTypes(
+                   const std::set<ComponentTypeId> &_types) const;
+
       /// \brief Find a view based on the provided component type ids.
       /// \param[in] _types The component type ids that serve as a key into
       /// a map of views.
@@ -773,6 +1730,13 @@ namespace ignition
           Entity _entity,
           const std::unordered_set<ComponentTypeId> &_types = {}) const;
 
+      /// \brief Get the entities whose component of the given type has been
+      /// marked as changed in the current iteration.
+      /// \param[in] _typeId Component type ID.
+      /// \return Entities with one-time or periodic changes.
+      private: std::vector<Entity> ChangedEntities(
+          const ComponentTypeId _typeId) const;
+
       /// \brief Private data pointer.
       private: std::unique_ptr<EntityComponentManagerPrivate> dataPtr;
 
@@ -806,6 +1770,47 @@ namespace ignition
       /// otherwise.
       private: bool LockAddingEntitiesToViews() const;
 
+      /// \brief Use an external worker pool, so that the entity component
+      /// manager and whoever owns the pool share the same threads instead of
+      /// each having their own.
+      /// \param[in] _pool Pool to use. Pass nullptr to go back to a pool
+      /// owned by the entity component manager, which is created when first
+      /// needed.
+      private: void SetWorkerPool(std::shared_ptr<WorkStealingPool> _pool);
+
+      /// \brief Split a range of entities into chunks and call _f for each
+      /// chunk using the shared worker pool, like ParallelFor. When storage
+      /// is partitioned across NUMA nodes, each chunk only holds entities of
+      /// one partition and runs on a worker of its node, and _f may be
+      /// called more than once per chunk.
+      /// \param[in] _entities First entity.
+      /// \param[in] _count Number of entities.
+      /// \param[in] _f Function called with the first and one past the last
+      /// index of each range of entities.
+      private: void ParallelForEntities(const Entity *_entities,
+                   std::size_t _count,
+                   const std::function<void(std::size_t, std::size_t)> &_f)
+                   const;
+
+      /// \brief Entities of a view which aren't static, cached until the
+      /// view or the static entities change.
+      /// \param[in] _view View.
+      /// \return Non-static entities, in the view's order.
+      private: const std::vector<Entity> &DynamicEntities(
+                   const detail::BaseView *_view) const;
+
+      /// \brief Set the key of the task running on the calling thread,
+      /// which orders command buffers in deterministic mode.
+      /// \param[in] _key Key, unique among tasks running at the same time.
+      /// Zero outside of tasks.
+      /// \return Previous key, to be restored once the task is done.
+      private: static uint64_t SwapTaskKey(uint64_t _key);
+
+      /// \brief Command buffer of the task running on the calling thread,
+      /// used in deterministic mode.
+      /// \return Buffer of the task.
+      private: EntityCommandBuffer &TaskCommandBuffer();
+
       // Make runners friends so that they can manage entity creation and
       // removal. This should be safe since runners are internal
       // to Gazebo.
@@ -816,6 +1821,9 @@ namespace ignition
       // states. Like the runners, the managers are internal.
       friend class NetworkManagerPrimary;
       friend class NetworkManagerSecondary;
+
+      // Command buffers reserve entity ids
+      friend class EntityCommandBuffer;
     };
     }
   }
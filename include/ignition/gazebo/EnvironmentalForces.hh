@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_ENVIRONMENTALFORCES_HH_
+#define IGNITION_GAZEBO_ENVIRONMENTALFORCES_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Types.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class IGNITION_GAZEBO_HIDDEN EnvironmentalForcesPrivate;
+
+    /// \brief Kinematics of the links acted upon by environmental forces,
+    /// stored as contiguous arrays indexed by link slot, and the wrenches
+    /// accumulated on them during a step.
+    struct LinkKinematics
+    {
+      /// \brief Link entities.
+      std::vector<Entity> entities;
+
+      /// \brief Whether the link exists and has a world pose. Force models
+      /// should skip links which aren't valid.
+      std::vector<uint8_t> valid;
+
+      /// \brief World poses of the link frames.
+      std::vector<math::Pose3d> worldPoses;
+
+      /// \brief Linear velocities of the link origins in the world frame.
+      std::vector<math::Vector3d> linearVelocities;
+
+      /// \brief Angular velocities of the links in the world frame.
+      std::vector<math::Vector3d> angularVelocities;
+
+      /// \brief Link masses, zero if the link has no inertial.
+      std::vector<double> masses;
+
+      /// \brief Positions of the centers of mass relative to the link
+      /// origins, expressed in the world frame.
+      std::vector<math::Vector3d> comOffsets;
+
+      /// \brief Accumulated forces in the world frame, applied at the link
+      /// origins.
+      std::vector<math::Vector3d> forces;
+
+      /// \brief Accumulated torques in the world frame, about the link
+      /// origins.
+      std::vector<math::Vector3d> torques;
+
+      /// \brief Number of link slots.
+      /// \return Number of slots.
+      std::size_t Size() const
+      {
+        return this->entities.size();
+      }
+
+      /// \brief Add a wrench applied at the link origin.
+      /// \param[in] _slot Link slot.
+      /// \param[in] _force Force in the world frame.
+      /// \param[in] _torque Torque in the world frame.
+      void AddWorldWrench(std::size_t _slot,
+          const math::Vector3d &_force, const math::Vector3d &_torque)
+      {
+        this->forces[_slot] += _force;
+        this->torques[_slot] += _torque;
+      }
+
+      /// \brief Add a force applied at the center of mass of the link.
+      /// \param[in] _slot Link slot.
+      /// \param[in] _force Force in the world frame.
+      void AddWorldForce(std::size_t _slot,
+          const math::Vector3d &_force)
+      {
+        this->forces[_slot] += _force;
+        this->torques[_slot] += this->comOffsets[_slot].Cross(_force);
+      }
+    };
+
+    /// \class EnvironmentalForces EnvironmentalForces.hh
+    /// ignition/gazebo/EnvironmentalForces.hh
+    /// \brief Shared stage which computes the forces exerted by the
+    /// environment, such as buoyancy, hydrodynamics, lift, drag and wind,
+    /// on links.
+    ///
+    /// Systems which compute such forces register a force model, which is a
+    /// function evaluated on the kinematics of their links. Once per step,
+    /// after every model's system reached it in its PreUpdate, the stage
+    /// gathers the kinematics of all the links into a LinkKinematics batch,
+    /// evaluates all the models on it and applies a single wrench per link.
+    /// This way, the components of a link are read and its wrench command
+    /// is written once, regardless of how many systems act on it.
+    ///
+    /// There's one stage per entity component manager, see For.
+    class IGNITION_GAZEBO_VISIBLE EnvironmentalForces
+    {
+      /// \brief Function which adds the forces of a model to a batch.
+      /// \param[in] _info Current simulation information.
+      /// \param[in] _ecm Entity component manager, for any component which
+      /// isn't part of the batch.
+      /// \param[in] _links Kinematics of all the links. Forces should only
+      /// be added to the slots returned by AddLink.
+      public: using ForceModel = std::function<void(const UpdateInfo &_info,
+          const EntityComponentManager &_ecm, LinkKinematics &_links)>;
+
+      /// \brief Identifies a force model.
+      public: using ModelId = std::size_t;
+
+      /// \brief Get the stage of an entity component manager, creating it
+      /// if needed. The stage lives as long as a system holds it.
+      /// \param[in] _ecm Entity component manager.
+      /// \return The stage.
+      public: static std::shared_ptr<EnvironmentalForces> For(
+          const EntityComponentManager &_ecm);
+
+      /// \brief Constructor. Use For to share the stage between systems.
+      public: EnvironmentalForces();
+
+      /// \brief Destructor
+      public: ~EnvironmentalForces();
+
+      /// \brief Add a link to the batch, or get its slot if it's already
+      /// part of it. This creates the components which hold the world pose
+      /// and velocities of the link, if they don't exist.
+      /// \param[in] _ecm Mutable entity component manager.
+      /// \param[in] _link Link entity.
+      /// \return Slot of the link. Slots aren't reused, so once the link is
+      /// removed its slot stays invalid for the lifetime of the stage.
+      public: std::size_t AddLink(EntityComponentManager &_ecm,
+          Entity _link);
+
+      /// \brief Register a force model. The model is evaluated on every
+      /// step which isn't paused, once its system called Update. It's
+      /// waited for starting with the next step, see Update.
+      /// \param[in] _model Force model.
+      /// \param[in] _owner Entity the model's system is attached to, if
+      /// it's removed along with that entity.
+      /// \return Identifier of the model.
+      public: ModelId AddModel(ForceModel _model,
+          Entity _owner = kNullEntity);
+
+      /// \brief Unregister a force model. Systems must call this before
+      /// the data captured by their model is destroyed.
+      /// \param[in] _id Identifier of the model.
+      public: void RemoveModel(ModelId _id);
+
+      /// \brief Signal that the system of a model is ready for the current
+      /// step. The call which completes the set of registered models
+      /// gathers the link kinematics, evaluates all the models and applies
+      /// the wrenches. Systems must call this on every step which isn't
+      /// paused.
+      ///
+      /// The first call of each step rebuilds the set of models waited
+      /// for: models registered since then join it, models whose owner
+      /// entity is being removed leave it, and links being removed leave
+      /// the batch.
+      /// \param[in] _info Current simulation information.
+      /// \param[in] _ecm Mutable entity component manager.
+      /// \param[in] _id Identifier of the model.
+      public: void Update(const UpdateInfo &_info,
+          EntityComponentManager &_ecm, ModelId _id);
+
+      /// \brief Get the kinematics gathered on the last update.
+      /// \return The batch.
+      public: const LinkKinematics &Links() const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<EnvironmentalForcesPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
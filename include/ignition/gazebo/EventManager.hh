@@ -17,8 +17,14 @@
 #ifndef IGNITION_GAZEBO_EVENTMANAGER_HH_
 #define IGNITION_GAZEBO_EVENTMANAGER_HH_
 
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <typeinfo>
 #include <unordered_map>
 #include <utility>
@@ -47,6 +53,13 @@ namespace ignition
     /// occur.
     ///
     /// See \ref ignition::gazebo::events for a complete list of events.
+    ///
+    /// Events emitted very often, such as every step or every frame, can be
+    /// looked up once through Handle and signaled directly, skipping the
+    /// lookup of Emit. Events whose subscribers don't need to run before
+    /// the emitter continues, such as progress reports, can be emitted with
+    /// EmitAsync, so that slow subscribers don't hold up the simulation or
+    /// rendering threads.
 
     /// TODO: if visibility is added here the MSVC is unable to compile it.
     /// The use of smart pointer inside the unordered_map (events method) is
@@ -56,8 +69,18 @@ namespace ignition
       /// \brief Constructor
       public: EventManager() = default;
 
-      /// \brief Destructor
-      public: ~EventManager() = default;
+      /// \brief Destructor. Events queued by EmitAsync which weren't
+      /// delivered yet are delivered first.
+      public: ~EventManager()
+              {
+                {
+                  std::lock_guard<std::mutex> lock(this->asyncMutex);
+                  this->asyncStop = true;
+                }
+                this->asyncCv.notify_all();
+                if (this->asyncThread.joinable())
+                  this->asyncThread.join();
+              }
 
       /// \brief Add a connection to an event.
       /// \param[in] _subscriber A std::function callback function. The function
@@ -118,6 +141,123 @@ namespace ignition
                 }
               }
 
+      /// \brief Get an event, creating it if needed. The event lives as long
+      /// as the manager, so the pointer can be kept and the event signaled
+      /// directly, without looking it up on every emission:
+      ///
+      /// \code
+      /// auto *preRender = eventManager.Handle<events::PreRender>();
+      /// // For each frame
+      /// preRender->Signal();
+      /// \endcode
+      ///
+      /// Like Connect and Emit, this must not be called concurrently with
+      /// other calls to them, but signaling an event through its pointer
+      /// only involves that event.
+      /// \return Pointer to the event, or null if an event of another type
+      /// was registered with the same type info.
+      public: template <typename E>
+              E *Handle()
+              {
+                auto &event = this->events[typeid(E)];
+                if (nullptr == event)
+                  event = std::make_unique<E>();
+
+                E *eventPtr = dynamic_cast<E *>(event.get());
+                if (nullptr == eventPtr)
+                {
+                  ignerr << "Failed to get event: "
+                    << typeid(E).name() << std::endl;
+                }
+                return eventPtr;
+              }
+
+      /// \brief Emit an event signal to connected subscribers from the
+      /// manager's event thread, instead of the calling one. The arguments
+      /// are copied, and events are delivered in the order they were
+      /// emitted. The thread is started the first time this is called.
+      ///
+      /// Use it for events whose subscribers may be slow and don't need to
+      /// run before the emitter continues. Subscribers must be safe to call
+      /// from another thread.
+      ///
+      /// The event is taken from Handle, because emitters usually run on
+      /// other threads than the one connecting to events, and looking it up
+      /// could insert it concurrently. Get it once, for example while
+      /// configuring the emitting system:
+      ///
+      /// \code
+      /// auto *progress = eventManager.Handle<events::MeshPreloadProgress>();
+      /// // From any thread
+      /// eventManager.EmitAsync(progress, 10u, 100u);
+      /// \endcode
+      /// \param[in] _event Event returned by Handle. Nothing is emitted if
+      /// null.
+      /// \param[in] _args function arguments to be passed to the event
+      /// callbacks. Must match the signature of the event type E.
+      /// \sa FlushAsync
+      public: template <typename E, typename ... Args>
+              void EmitAsync(E *_event, Args && ... _args)
+              {
+                if (nullptr == _event)
+                  return;
+
+                auto args = std::make_tuple(
+                    std::decay_t<Args>(std::forward<Args>(_args)) ...);
+                {
+                  std::lock_guard<std::mutex> lock(this->asyncMutex);
+                  this->asyncQueue.push_back([_event, args]()
+                  {
+                    std::apply([_event](const auto & ... _a)
+                    {
+                      _event->Signal(_a ...);
+                    }, args);
+                  });
+                  if (!this->asyncThread.joinable())
+                  {
+                    this->asyncThread =
+                        std::thread(&EventManager::RunAsync, this);
+                  }
+                }
+                this->asyncCv.notify_all();
+              }
+
+      /// \brief Block until all events emitted through EmitAsync so far
+      /// were delivered. Must not be called from a subscriber of an
+      /// asynchronous event.
+      public: void FlushAsync()
+              {
+                std::unique_lock<std::mutex> lock(this->asyncMutex);
+                this->asyncCv.wait(lock, [this]
+                {
+                  return this->asyncQueue.empty() && !this->asyncBusy;
+                });
+              }
+
+      /// \brief Deliver events queued by EmitAsync until the manager is
+      /// destroyed.
+      private: void RunAsync()
+               {
+                 std::unique_lock<std::mutex> lock(this->asyncMutex);
+                 while (true)
+                 {
+                   this->asyncCv.wait(lock, [this]
+                   {
+                     return this->asyncStop || !this->asyncQueue.empty();
+                   });
+                   if (this->asyncQueue.empty())
+                     return;
+
+                   auto deliver = std::move(this->asyncQueue.front());
+                   this->asyncQueue.pop_front();
+                   this->asyncBusy = true;
+                   lock.unlock();
+                   deliver();
+                   lock.lock();
+                   this->asyncBusy = false;
+                   this->asyncCv.notify_all();
+                 }
+               }
 
       /// \brief Convenience type for storing typeinfo references.
       private: using TypeInfoRef = std::reference_wrapper<const std::type_info>;
@@ -144,6 +284,27 @@ namespace ignition
       private: std::unordered_map<TypeInfoRef,
                                   std::unique_ptr<ignition::common::Event>,
                                   Hasher, EqualTo> events;
+
+      /// \brief Protects the asynchronous event queue.
+      private: std::mutex asyncMutex;
+
+      /// \brief Notified when events are queued or delivered, and when
+      /// the manager is destroyed.
+      private: std::condition_variable asyncCv;
+
+      /// \brief Events emitted by EmitAsync and not delivered yet.
+      private: std::deque<std::function<void()>> asyncQueue;
+
+      /// \brief Whether the event thread is delivering an event.
+      private: bool asyncBusy{false};
+
+      /// \brief Whether the event thread should stop once the queue is
+      /// empty.
+      private: bool asyncStop{false};
+
+      /// \brief Thread delivering events emitted by EmitAsync, started
+      /// when first needed.
+      private: std::thread asyncThread;
     };
     }
   }
@@ -17,6 +17,11 @@
 #ifndef IGNITION_GAZEBO_EVENTS_HH_
 #define IGNITION_GAZEBO_EVENTS_HH_
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
 #include <sdf/Element.hh>
 #include <sdf/Plugin.hh>
 
@@ -31,6 +36,9 @@ namespace ignition
   {
     // Inline bracket to help doxygen filtering.
     inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    struct KinematicsSnapshot;
+
     /// \brief Namespace for all events. Refer to the EventManager class for
     /// more information about events.
     namespace events
@@ -72,6 +80,33 @@ namespace ignition
       /// Makre sure that you don't also connect to the LoadPlugins event.
       using LoadSdfPlugins = common::EventT<void(Entity, sdf::Plugins),
           struct LoadPluginsTag>;
+
+      /// \brief Emitted after a simulation step took longer than the step
+      /// budget, see ServerConfig::SetStepBudget. Passes the iteration of
+      /// the step, how long it took, and the name of the system which took
+      /// the longest during it.
+      using StepOverrun = common::EventT<void(uint64_t,
+          std::chrono::steady_clock::duration, const std::string &),
+          struct StepOverrunTag>;
+
+      /// \brief Emitted after the simulation was set back to a snapshot of
+      /// its state, taken in memory. Components already hold the restored
+      /// state, and systems which keep state of their own, such as physics
+      /// engines, should set it from the components before their next step.
+      using SnapshotRestored = common::EventT<void(void),
+          struct SnapshotRestoredTag>;
+
+      /// \brief Emitted by the physics system after each step while
+      /// simulation runs, with the world poses and velocities of all
+      /// non-static links and models. They're computed once from the
+      /// physics engine, instead of by each system through the component
+      /// tree. It's only emitted if there are subscribers, through
+      /// EventManager::EmitAsync, so subscribers are called from the event
+      /// thread and can compute and publish there without delaying the
+      /// step. Include KinematicsSnapshot.hh to read it.
+      using KinematicsUpdated = common::EventT<
+          void(std::shared_ptr<const KinematicsSnapshot>),
+          struct KinematicsUpdatedTag>;
       }
     }  // namespace events
   }  // namespace gazebo
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_KINEMATICSSNAPSHOT_HH_
+#define IGNITION_GAZEBO_KINEMATICSSNAPSHOT_HH_
+
+#include <unordered_map>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/Types.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief World pose and velocities of a link or model.
+    struct EntityKinematics
+    {
+      /// \brief Pose of the entity's frame in the world.
+      math::Pose3d worldPose;
+
+      /// \brief Linear velocity of the entity's origin, in the world frame.
+      math::Vector3d linearVelocity;
+
+      /// \brief Angular velocity, in the world frame.
+      math::Vector3d angularVelocity;
+    };
+
+    /// \brief Kinematics of all non-static links and models after a
+    /// simulation step, computed once by the physics system and passed to
+    /// the subscribers of events::KinematicsUpdated. It's never modified
+    /// after it's emitted, so it can be read from any thread, and kept for
+    /// as long as needed.
+    struct KinematicsSnapshot
+    {
+      /// \brief Information of the step.
+      UpdateInfo info;
+
+      /// \brief Kinematics of each link and model.
+      std::unordered_map<Entity, EntityKinematics> entities;
+
+      /// \brief Get the kinematics of an entity.
+      /// \param[in] _entity Link or model.
+      /// \return The kinematics, or nullptr if the entity isn't a non-static
+      /// link or model.
+      const EntityKinematics *Find(const Entity _entity) const
+      {
+        auto it = this->entities.find(_entity);
+        return it == this->entities.end() ? nullptr : &it->second;
+      }
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_LOCALTOPICS_HH_
+#define IGNITION_GAZEBO_LOCALTOPICS_HH_
+
+#include <google/protobuf/message.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class LocalTopics LocalTopics.hh ignition/gazebo/LocalTopics.hh
+    /// \brief Delivers messages to subscribers in the same process by
+    /// shared pointer, without serializing or copying them.
+    ///
+    /// This complements ign-transport for large messages, such as the
+    /// images and point clouds of rendering sensors. Publishers build each
+    /// message once and every local subscriber receives the same immutable
+    /// instance. Messages are also published on ign-transport as usual, so
+    /// subscribing here only saves work when the subscriber stops using the
+    /// ign-transport topic.
+    ///
+    /// Callbacks run on the publisher's thread, which may be a rendering
+    /// thread, so they should return quickly and keep the pointer if they
+    /// need the message for longer. All functions are thread safe.
+    class IGNITION_GAZEBO_VISIBLE LocalTopics
+    {
+      /// \brief Callback receiving messages of any type.
+      public: using Callback = std::function<void(
+          const std::shared_ptr<const google::protobuf::Message> &)>;
+
+      /// \brief Subscribe to a topic.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _callback Called with each message published on the
+      /// topic.
+      /// \return Subscription ID, used to unsubscribe.
+      public: static uint64_t Subscribe(const std::string &_topic,
+          Callback _callback);
+
+      /// \brief Subscribe to a topic, receiving only messages of a type.
+      /// \tparam MsgT Message type, such as msgs::Image.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _callback Called with each message of type MsgT
+      /// published on the topic.
+      /// \return Subscription ID, used to unsubscribe.
+      public: template <typename MsgT>
+              static uint64_t Subscribe(const std::string &_topic,
+                  std::function<void(const std::shared_ptr<const MsgT> &)>
+                  _callback)
+      {
+        return Subscribe(_topic, Callback(
+            [_callback](
+            const std::shared_ptr<const google::protobuf::Message> &_msg)
+            {
+              auto msg = std::dynamic_pointer_cast<const MsgT>(_msg);
+              if (msg)
+                _callback(msg);
+            }));
+      }
+
+      /// \brief Remove a subscription. The callback may still be running
+      /// on another thread when this returns.
+      /// \param[in] _id Subscription ID returned by Subscribe.
+      /// \return True if the subscription existed.
+      public: static bool Unsubscribe(uint64_t _id);
+
+      /// \brief Whether a topic has subscribers. Publishers should check
+      /// this before building messages which are only meant for local
+      /// subscribers.
+      /// \param[in] _topic Topic name.
+      /// \return True if there's at least one subscriber.
+      public: static bool HasSubscribers(const std::string &_topic);
+
+      /// \brief Publish a message to the local subscribers of a topic.
+      /// \param[in] _topic Topic name.
+      /// \param[in] _msg Message, which must not be modified afterwards.
+      /// \return Number of subscribers which received the message.
+      public: static std::size_t Publish(const std::string &_topic,
+          const std::shared_ptr<const google::protobuf::Message> &_msg);
+    };
+    }
+  }
+}
+#endif
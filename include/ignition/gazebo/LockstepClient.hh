@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_LOCKSTEPCLIENT_HH_
+#define IGNITION_GAZEBO_LOCKSTEPCLIENT_HH_
+
+#include <ignition/msgs/serialized_map.pb.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class IGNITION_GAZEBO_HIDDEN LockstepClientPrivate;
+
+    /// \class LockstepClient LockstepClient.hh
+    /// ignition/gazebo/LockstepClient.hh
+    /// \brief Drives a world one step at a time from another process on the
+    /// same host, through the lockstep channel of a server started with
+    /// ServerConfig::SetLockstepChannel.
+    ///
+    /// Each call to Step sends the actions for the next step and waits for
+    /// the observation of that step, through shared memory queues instead
+    /// of transport services and topics. This suits control loops, such as
+    /// hardware in the loop or reinforcement learning, which need a reply
+    /// for every step.
+    ///
+    /// The server must be running and unpaused, otherwise no step happens
+    /// and Step times out. There must be only one client per channel.
+    class IGNITION_GAZEBO_VISIBLE LockstepClient
+    {
+      /// \brief Connect to the lockstep channel of a world.
+      /// \param[in] _channel Name given to ServerConfig::SetLockstepChannel.
+      /// \param[in] _world Name of the world.
+      /// \return The client, or null if the server hasn't created the
+      /// channel.
+      public: static std::unique_ptr<LockstepClient> Connect(
+                  const std::string &_channel, const std::string &_world);
+
+      /// \brief Destructor
+      public: ~LockstepClient();
+
+      /// \brief Run one step. If a previous call timed out, its actions are
+      /// still applied, and the observation of that step is skipped.
+      /// \param[in] _actions State applied to the world before the step,
+      /// such as commands. It may be empty.
+      /// \param[out] _observation Iterations and sim time of the step, in
+      /// its stats, and the observed components which changed during the
+      /// step, in its state.
+      /// \param[in] _timeout How long to wait for the observation.
+      /// \return False if the actions couldn't be sent, or no observation
+      /// was received in time.
+      public: bool Step(const msgs::SerializedStateMap &_actions,
+                  msgs::SerializedStepMap &_observation,
+                  const std::chrono::steady_clock::duration &_timeout =
+                      std::chrono::seconds(10));
+
+      /// \brief Use Connect instead.
+      private: LockstepClient();
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<LockstepClientPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
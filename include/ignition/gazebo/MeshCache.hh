@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_MESHCACHE_HH_
+#define IGNITION_GAZEBO_MESHCACHE_HH_
+
+#include <memory>
+#include <string>
+
+#include <ignition/common/Mesh.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class IGNITION_GAZEBO_HIDDEN MeshCachePrivate;
+
+    /// \class MeshCache MeshCache.hh ignition/gazebo/MeshCache.hh
+    /// \brief On-disk cache of cooked meshes, shared by physics, rendering
+    /// and the exporters.
+    ///
+    /// Parsing large mesh files, especially COLLADA, is often the slowest
+    /// part of loading a world, and the server and every rendering process
+    /// used to parse each mesh on their own. The first time a mesh is
+    /// loaded, its submeshes, with their vertices, normals, texture
+    /// coordinates and indices, and its materials are stored in a compact
+    /// binary file, which later loads from any process read back instead.
+    /// Cooked files are keyed by a hash of the mesh file's contents, so
+    /// they're shared by identical meshes at different paths and are
+    /// rebuilt when a mesh changes.
+    ///
+    /// Loaded meshes are added to common::MeshManager under the requested
+    /// name, so code which loads meshes through the manager afterwards gets
+    /// the cooked mesh without parsing the file again. Meshes with skeletons
+    /// or PBR materials, which the cooked format doesn't hold, are always
+    /// parsed.
+    ///
+    /// The cache directory defaults to `~/.ignition/gazebo/mesh_cache`. It
+    /// can be changed with the `IGN_GAZEBO_MESH_CACHE_PATH` environment
+    /// variable, and caching is disabled if that variable is empty.
+    ///
+    /// There's one cache per process, see Instance.
+    class IGNITION_GAZEBO_VISIBLE MeshCache
+    {
+      /// \brief Get the cache of this process.
+      /// \return The cache.
+      public: static MeshCache &Instance();
+
+      /// \brief Destructor
+      public: ~MeshCache();
+
+      /// \brief Get a mesh, from common::MeshManager, from the cache
+      /// directory, or by parsing its file. Safe to call from any thread.
+      /// \param[in] _uri Path or URI of the mesh file, as given to
+      /// common::MeshManager::Load.
+      /// \return The mesh, owned by common::MeshManager, or nullptr if it
+      /// couldn't be loaded.
+      public: const common::Mesh *Load(const std::string &_uri);
+
+      /// \brief Set the directory where cooked meshes are stored. It's
+      /// created if needed.
+      /// \param[in] _dir Path to the directory, empty to disable caching.
+      public: void SetCacheDir(const std::string &_dir);
+
+      /// \brief Directory where cooked meshes are stored.
+      /// \return Path to the directory, empty if caching is disabled.
+      public: std::string CacheDir() const;
+
+      /// \brief Constructor, use Instance instead.
+      private: MeshCache();
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<MeshCachePrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
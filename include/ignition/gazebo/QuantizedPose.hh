@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_QUANTIZEDPOSE_HH_
+#define IGNITION_GAZEBO_QUANTIZEDPOSE_HH_
+
+#include <ignition/msgs/serialized_map.pb.h>
+
+#include <string>
+
+#include <ignition/math/Pose3.hh>
+#include "ignition/gazebo/config.hh"
+#include "ignition/gazebo/Export.hh"
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    //
+    /// \brief Encode a pose into a compact, lossy binary format.
+    ///
+    /// Positions are stored as fixed-point integers with the given resolution,
+    /// using variable-length encoding so that values close to the origin take
+    /// fewer bytes. Orientations are stored using the "smallest three"
+    /// encoding: the largest quaternion component is dropped and recovered
+    /// from the unit norm, and the other three are stored with 16 bits each.
+    /// A typical pose takes around 20 bytes, compared to 50 to 70 bytes for a
+    /// serialized msgs::Pose.
+    ///
+    /// The first byte of the encoding is zero, which is never the first byte
+    /// of a serialized protobuf message. This allows encoded poses to be told
+    /// apart from serialized msgs::Pose.
+    /// \param[in] _pose Pose to encode.
+    /// \param[in] _resolution Position resolution in meters. It's rounded to
+    /// a power of ten between 1e-9 and 1.
+    /// \return Encoded pose.
+    std::string IGNITION_GAZEBO_VISIBLE encodeQuantizedPose(
+        const math::Pose3d &_pose, double _resolution = 1e-4);
+
+    /// \brief Decode a pose encoded with encodeQuantizedPose.
+    /// \param[in] _data Encoded pose.
+    /// \param[out] _pose Decoded pose.
+    /// \return True if _data holds a valid encoded pose.
+    bool IGNITION_GAZEBO_VISIBLE decodeQuantizedPose(const std::string &_data,
+        math::Pose3d &_pose);
+
+    /// \brief Check whether data was encoded with encodeQuantizedPose.
+    /// \param[in] _data Data to check.
+    /// \return True if the data looks like an encoded pose.
+    bool IGNITION_GAZEBO_VISIBLE isQuantizedPose(const std::string &_data);
+
+    /// \brief Encode all components::Pose components in a state message with
+    /// encodeQuantizedPose, in place.
+    /// \param[in,out] _state State message.
+    /// \param[in] _resolution Position resolution in meters.
+    /// \return Number of poses encoded.
+    std::size_t IGNITION_GAZEBO_VISIBLE quantizePoses(
+        msgs::SerializedStateMap &_state, double _resolution = 1e-4);
+
+    /// \brief Check whether a state message holds any quantized
+    /// components::Pose component.
+    /// \param[in] _state State message.
+    /// \return True if at least one pose is quantized.
+    bool IGNITION_GAZEBO_VISIBLE hasQuantizedPoses(
+        const msgs::SerializedStateMap &_state);
+
+    /// \brief Replace all quantized components::Pose components in a state
+    /// message with regular serialized poses, in place, so the message can be
+    /// passed to EntityComponentManager::SetState.
+    /// \param[in,out] _state State message.
+    /// \return Number of poses decoded.
+    std::size_t IGNITION_GAZEBO_VISIBLE dequantizePoses(
+        msgs::SerializedStateMap &_state);
+    }
+  }
+}
+#endif
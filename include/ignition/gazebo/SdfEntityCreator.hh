@@ -18,6 +18,7 @@
 #define IGNITION_GAZEBO_CREATEREMOVE_HH_
 
 #include <memory>
+#include <vector>
 
 #include <sdf/Actor.hh>
 #include <sdf/Collision.hh>
@@ -98,6 +99,33 @@ namespace ignition
       /// \return Model entity.
       public: Entity CreateEntities(const sdf::Model *_model);
 
+      /// \brief Create all entities that exist in several sdf::Model
+      /// objects and load their plugins, as if CreateEntities were called
+      /// for each model in turn. When there are enough models and the
+      /// `EntityComponentManager` may use more than one thread, the models
+      /// are converted from SDF in parallel and then added to the
+      /// `EntityComponentManager` one after the other, so entities and
+      /// plugins are created in the same order either way.
+      /// \param[in] _models SDF model objects.
+      /// \return Model entities, in the same order as the models.
+      /// \sa EntityComponentManager::SetMaxThreads
+      public: std::vector<Entity> CreateEntities(
+          const std::vector<const sdf::Model *> &_models);
+
+      /// \brief Set whether models which are repeated when creating several
+      /// models at once are cloned instead of converted from SDF again.
+      /// Worlds often include the same model many times, and those models
+      /// only differ in name and pose. When this is enabled, only the first
+      /// of each is converted from SDF, and the others are cloned from it
+      /// with EntityComponentManager::CloneMany, getting their own name,
+      /// pose and SDF DOM. Models with plugins are always converted from
+      /// SDF. Entities of repeated models are created after all others, so
+      /// they get different ids than they would without it. Defaults to
+      /// false.
+      /// \param[in] _reuse True to clone repeated models.
+      /// \sa CreateEntities(const std::vector<const sdf::Model *> &)
+      public: void SetReuseRepeatedModels(bool _reuse);
+
       /// \brief Create all entities that exist in the sdf::Actor object and
       /// load their plugins.
       /// \param[in] _actor SDF actor object.
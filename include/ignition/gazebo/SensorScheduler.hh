@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SENSORSCHEDULER_HH_
+#define IGNITION_GAZEBO_SENSORSCHEDULER_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class IGNITION_GAZEBO_HIDDEN SensorSchedulerPrivate;
+
+    /// \class SensorScheduler SensorScheduler.hh
+    /// ignition/gazebo/SensorScheduler.hh
+    /// \brief Wakes sensors when their next measurement is due, so systems
+    /// don't have to visit every sensor on every step to find out.
+    ///
+    /// Each sensor entity is scheduled at a simulation time. Finding the
+    /// due sensors costs nothing when none are due, and is proportional to
+    /// the number of due sensors otherwise. Sensors which were woken up
+    /// aren't scheduled anymore until they're rescheduled, usually at the
+    /// next update time reported by the sensor.
+    ///
+    /// Systems owning a map of ign-sensors sensors can use UpdateDue,
+    /// which wakes, updates and reschedules the due sensors.
+    class IGNITION_GAZEBO_VISIBLE SensorScheduler
+    {
+      /// \brief Constructor
+      public: SensorScheduler();
+
+      /// \brief Destructor
+      public: ~SensorScheduler();
+
+      /// \brief Schedule a sensor, replacing its previous time if it was
+      /// already scheduled.
+      /// \param[in] _entity Sensor entity.
+      /// \param[in] _time Simulation time when the sensor is due.
+      public: void Schedule(Entity _entity,
+          const std::chrono::steady_clock::duration &_time);
+
+      /// \brief Schedule a sensor after it was woken up.
+      /// \param[in] _entity Sensor entity.
+      /// \param[in] _now Current simulation time.
+      /// \param[in] _next Next update time reported by the sensor.
+      /// \param[in] _rate Update rate of the sensor in Hz, zero or negative
+      /// if unlimited.
+      /// If _next isn't after _now, which happens when the sensor wasn't
+      /// updated because it had no subscribers, the sensor is scheduled one
+      /// period after _now. Sensors with an unlimited rate are due on the
+      /// next step.
+      public: void Reschedule(Entity _entity,
+          const std::chrono::steady_clock::duration &_now,
+          const std::chrono::steady_clock::duration &_next, double _rate);
+
+      /// \brief Stop scheduling a sensor.
+      /// \param[in] _entity Sensor entity.
+      public: void Remove(Entity _entity);
+
+      /// \brief Whether any sensor is due.
+      /// \param[in] _now Current simulation time.
+      /// \return True if at least one sensor is scheduled at or before
+      /// _now.
+      public: bool Due(const std::chrono::steady_clock::duration &_now) const;
+
+      /// \brief Time of the earliest scheduled sensor.
+      /// \return The time, or the largest duration if nothing is scheduled.
+      public: std::chrono::steady_clock::duration NextTime() const;
+
+      /// \brief Number of scheduled sensors.
+      /// \return Number of sensors.
+      public: std::size_t Size() const;
+
+      /// \brief Wake up all the sensors which are due. They stay
+      /// unscheduled until Schedule or Reschedule is called for them.
+      /// \param[in] _now Current simulation time.
+      /// \param[out] _due Due sensors, earliest first. It's cleared first.
+      public: void TakeDue(const std::chrono::steady_clock::duration &_now,
+          std::vector<Entity> &_due);
+
+      /// \brief Update the due sensors of a map of ign-sensors sensors,
+      /// then reschedule them. Sensors must be scheduled when they're added
+      /// to the map, and sensors which aren't in the map anymore are
+      /// dropped.
+      /// \tparam BaseSensorT Base sensor class, sensors::Sensor.
+      /// \param[in] _now Current simulation time.
+      /// \param[in] _sensors Map of sensor entity to a pointer to a sensor.
+      /// \param[in] _prepare Function called before updating the sensors,
+      /// only if at least one due sensor has subscribers. It should pass
+      /// the data from the ECM to the sensors.
+      /// \return True if the sensors were updated.
+      public: template <typename BaseSensorT, typename SensorMapT,
+                        typename PrepareT>
+              bool UpdateDue(const std::chrono::steady_clock::duration &_now,
+                  SensorMapT &_sensors, PrepareT &&_prepare)
+      {
+        auto &due = this->DueBuffer();
+        this->TakeDue(_now, due);
+        if (due.empty())
+          return false;
+
+        bool needsUpdate = false;
+        for (auto entity : due)
+        {
+          auto it = _sensors.find(entity);
+          if (it != _sensors.end() && it->second->HasConnections())
+          {
+            needsUpdate = true;
+            break;
+          }
+        }
+
+        if (needsUpdate)
+        {
+          _prepare();
+          for (auto entity : due)
+          {
+            auto it = _sensors.find(entity);
+            if (it != _sensors.end())
+            {
+              static_cast<BaseSensorT *>(it->second.get())->Update(_now,
+                  false);
+            }
+          }
+        }
+
+        for (auto entity : due)
+        {
+          auto it = _sensors.find(entity);
+          if (it == _sensors.end())
+            continue;
+
+          const auto *sensor = static_cast<BaseSensorT *>(it->second.get());
+          this->Reschedule(entity, _now, sensor->NextDataUpdateTime(),
+              sensor->UpdateRate());
+        }
+        return needsUpdate;
+      }
+
+      /// \brief Sensors woken up by the last UpdateDue call. Meant to be
+      /// used from its _prepare function, to only pass data to the sensors
+      /// which will be updated.
+      /// \return Due sensors, earliest first.
+      public: const std::vector<Entity> &DueSensors() const;
+
+      /// \brief Buffer filled with the due sensors by UpdateDue.
+      /// \return The buffer returned by DueSensors.
+      private: std::vector<Entity> &DueBuffer();
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<SensorSchedulerPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
@@ -109,6 +109,12 @@ namespace ignition
     /// 3. `/gazebo/resource_paths` : ignition::msgs::StringMsg_V
     ///   + Updated list of resource paths.
     ///
+    /// 4. `/world/<world_name>/performance` : ignition::msgs::Param_V
+    ///   + Wall time statistics of each system, one param per system and
+    ///     update phase. Only published if
+    ///     ServerConfig::SetSystemTimingPeriod is set. The latest message is
+    ///     also served on `/world/<world_name>/performance/info`.
+    ///
     class IGNITION_GAZEBO_VISIBLE Server
     {
       /// \brief Construct the server using the parameters specified in a
@@ -133,7 +139,9 @@ namespace ignition
       /// \brief Run the server. By default this is a non-blocking call,
       /// which means the server runs simulation in a separate thread. Pass
       /// in true to the _blocking argument to run the server in the current
-      /// thread.
+      /// thread. When the server has more than one world, such as copies
+      /// created through ServerConfig::SetWorldCopies, each world is stepped
+      /// in its own thread and this returns once all of them are done.
       /// \param[in] _blocking False to run the server in a new thread. True
       /// to run the server in the current thread.
       /// \param[in] _iterations Number of steps to perform. A value of
@@ -150,7 +158,8 @@ namespace ignition
                        const bool _paused = true);
 
       /// \brief Run the server once, all systems will be updated once and
-      /// then this returns. This is a blocking call.
+      /// then this returns. This is a blocking call. All worlds are stepped
+      /// in parallel, so this works as a batched step of world copies.
       /// \param[in] _paused True to run the simulation in a paused state,
       /// false to run simulation unpaused. The simulation iterations will
       /// be increased by 1.
@@ -28,6 +28,7 @@
 #include <sdf/Root.hh>
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Types.hh>
 
 namespace ignition
 {
@@ -343,6 +344,19 @@ namespace ignition
       /// \param[in] _playbackPath Path to recorded states
       public: void SetLogPlaybackPath(const std::string &_playbackPath);
 
+      /// \brief Get whether playback only applies recorded state on steps
+      /// where a rendering sensor is due.
+      /// \return True if playback state is batched for sensors.
+      public: bool LogPlaybackBatchToSensors() const;
+
+      /// \brief Set whether playback only applies recorded state on steps
+      /// where a rendering sensor is due. State changes in between are
+      /// merged and applied at once, which speeds up regenerating sensor
+      /// data from a log. Systems other than rendering sensors only see the
+      /// state on those steps.
+      /// \param[in] _batch True to batch playback state for sensors.
+      public: void SetLogPlaybackBatchToSensors(bool _batch);
+
       /// \brief Get whether meshes and material files are recorded
       /// \return True if resources should be recorded.
       public: bool LogRecordResources() const;
@@ -387,6 +401,318 @@ namespace ignition
       /// ~/.ignition/fuel.
       public: void SetResourceCache(const std::string &_path);
 
+      /// \brief Directory where worlds loaded from files are cached, with
+      /// their includes resolved into a single document. While none of the
+      /// files a world was built from change, later runs load the cached
+      /// document instead of resolving the includes again.
+      /// \return Path to the cache. An empty string, the default, disables
+      /// the cache.
+      public: const std::string &WorldCachePath() const;
+
+      /// \brief Set the directory where worlds loaded from files are cached.
+      /// \param[in] _path Path to the cache. An empty string disables the
+      /// cache.
+      /// \sa WorldCachePath
+      public: void SetWorldCachePath(const std::string &_path);
+
+      /// \brief Number of copies of each world to simulate. Each copy gets
+      /// its own simulation runner, entity component manager and systems,
+      /// so the copies are independent of each other, but they share the
+      /// parsed SDF and process wide resources such as loaded meshes and
+      /// plugin libraries. The first copy keeps the world's name, and the
+      /// others are named `<world_name>_<index>`, which also namespaces
+      /// their topics and services. All copies are stepped in parallel by
+      /// Server::Run and Server::RunOnce.
+      /// \return Number of copies, 1 by default.
+      public: unsigned int WorldCopies() const;
+
+      /// \brief Set the number of copies of each world to simulate.
+      /// \param[in] _copies Number of copies. Zero is treated as one.
+      /// \sa WorldCopies
+      public: void SetWorldCopies(unsigned int _copies);
+
+      /// \brief Period at which the wall time statistics of each system are
+      /// published on `/world/<world_name>/performance`. Each system's
+      /// PreUpdate, Update and PostUpdate is timed while this is positive.
+      /// \return Publish period, zero by default, which disables timing.
+      public: std::chrono::steady_clock::duration SystemTimingPeriod() const;
+
+      /// \brief Set the period at which system timings are published.
+      /// \param[in] _period Publish period. Zero disables timing.
+      /// \sa SystemTimingPeriod
+      public: void SetSystemTimingPeriod(
+                  const std::chrono::steady_clock::duration &_period);
+
+      /// \brief Minimum wall time between two messages on the world
+      /// statistics topics, `/world/<world_name>/stats` and `/stats`.
+      /// Statistics are also published whenever simulation is paused,
+      /// resumed or stepped, so requests are acknowledged right away.
+      /// \return Publish period, 100 ms by default. Zero publishes every
+      /// step.
+      public: std::chrono::steady_clock::duration StatsPublishPeriod() const;
+
+      /// \brief Set the minimum wall time between two world statistics
+      /// messages.
+      /// \param[in] _period Publish period. Zero publishes every step.
+      /// \sa StatsPublishPeriod
+      public: void SetStatsPublishPeriod(
+                  const std::chrono::steady_clock::duration &_period);
+
+      /// \brief Minimum wall time between two messages on the clock topics,
+      /// `/world/<world_name>/clock` and `/clock`.
+      /// \return Publish period, zero by default, which publishes every
+      /// step.
+      public: std::chrono::steady_clock::duration ClockPublishPeriod() const;
+
+      /// \brief Set the minimum wall time between two clock messages.
+      /// \param[in] _period Publish period. Zero publishes every step.
+      /// \sa ClockPublishPeriod
+      public: void SetClockPublishPeriod(
+                  const std::chrono::steady_clock::duration &_period);
+
+      /// \brief Wall time each simulation step should take at most. Steps
+      /// which take longer are counted, logged and reported through the
+      /// events::StepOverrun event, along with the system which took the
+      /// longest. If PreUpdate and Update already used up the budget, the
+      /// PostUpdates of skippable systems are skipped for that step.
+      /// \return Step budget, zero by default, which disables it.
+      /// \sa AddStepBudgetSkippableSystem
+      public: std::chrono::steady_clock::duration StepBudget() const;
+
+      /// \brief Set the wall time each simulation step should take at most.
+      /// Setting a budget also times each system, as if
+      /// SetSystemTimingPeriod had been set.
+      /// \param[in] _budget Step budget. Zero disables it.
+      /// \sa StepBudget
+      public: void SetStepBudget(
+                  const std::chrono::steady_clock::duration &_budget);
+
+      /// \brief Mark a system as not critical, so its PostUpdate may be
+      /// skipped on steps which overrun the step budget. This is meant for
+      /// systems such as broadcasters, which can miss a step.
+      /// \param[in] _name Plugin name of the system, such as
+      /// `ignition::gazebo::systems::SceneBroadcaster`.
+      public: void AddStepBudgetSkippableSystem(const std::string &_name);
+
+      /// \brief Systems whose PostUpdate may be skipped on steps which
+      /// overrun the step budget.
+      /// \return Plugin names of the systems.
+      /// \sa AddStepBudgetSkippableSystem
+      public: const std::vector<std::string> &StepBudgetSkippableSystems()
+                  const;
+
+      /// \brief Sim time of live simulation kept in memory, so that it can
+      /// be rewound to any of its recent steps by seeking back, for example
+      /// with the `playback/control` service or a world control request.
+      /// Steps are kept as the state that changed during them, with
+      /// periodic keyframes of the full state, and the physics engine is set
+      /// from the restored state.
+      /// \return Rewind window, zero by default, which disables it.
+      /// \sa RewindBufferBytes
+      public: std::chrono::steady_clock::duration RewindWindow() const;
+
+      /// \brief Set the sim time of live simulation kept in memory for
+      /// rewinding.
+      /// \param[in] _window Rewind window. Zero disables it.
+      /// \sa RewindWindow
+      public: void SetRewindWindow(
+                  const std::chrono::steady_clock::duration &_window);
+
+      /// \brief Most memory used to keep the steps of the rewind window. The
+      /// oldest steps are dropped as needed to stay under it, even if they're
+      /// within the window.
+      /// \return Memory limit in bytes, 64 MiB by default.
+      /// \sa RewindWindow
+      public: std::size_t RewindBufferBytes() const;
+
+      /// \brief Set the most memory used to keep the steps of the rewind
+      /// window.
+      /// \param[in] _bytes Memory limit in bytes.
+      /// \sa RewindBufferBytes
+      public: void SetRewindBufferBytes(std::size_t _bytes);
+
+      /// \brief How long before each step is due the simulation thread
+      /// stops sleeping and busy waits instead. Operating system sleeps
+      /// often overshoot by tens of microseconds or more, so spinning for
+      /// the last part of the wait keeps the step period much steadier, at
+      /// the cost of keeping a core busy.
+      /// \return Busy wait time, zero by default, which only sleeps.
+      public: std::chrono::steady_clock::duration PacingSpinTime() const;
+
+      /// \brief Set how long before each step is due the simulation thread
+      /// busy waits instead of sleeping.
+      /// \param[in] _spinTime Busy wait time. Zero only sleeps.
+      /// \sa PacingSpinTime
+      public: void SetPacingSpinTime(
+                  const std::chrono::steady_clock::duration &_spinTime);
+
+      /// \brief CPU the simulation thread is pinned to, which is best
+      /// combined with a core isolated from the scheduler and a busy wait
+      /// time. Only supported on Linux.
+      /// \return CPU index, or -1 by default, which doesn't pin the thread.
+      /// \sa PacingSpinTime
+      public: int PacingCpu() const;
+
+      /// \brief Set the CPU the simulation thread is pinned to.
+      /// \param[in] _cpu CPU index, or -1 to not pin the thread.
+      /// \sa PacingCpu
+      public: void SetPacingCpu(int _cpu);
+
+      /// \brief CPUs the thread stepping each world is restricted to. Use
+      /// numaNodeCpus to keep it on one NUMA node. Only supported on Linux.
+      /// \return CPU indices, empty by default, which doesn't restrict the
+      /// thread unless PacingCpu is set.
+      public: const std::vector<unsigned int> &SimulationThreadCpus() const;
+
+      /// \brief Set the CPUs the thread stepping each world is restricted
+      /// to. Takes precedence over SetPacingCpu.
+      /// \param[in] _cpus CPU indices. Empty doesn't restrict the thread.
+      /// \sa SimulationThreadCpus
+      public: void SetSimulationThreadCpus(
+                  const std::vector<unsigned int> &_cpus);
+
+      /// \brief CPUs the worker threads of each world are restricted to.
+      /// Workers run concurrent system updates and the entity component
+      /// manager's parallel work. Only supported on Linux.
+      /// \return CPU indices, empty by default, which doesn't restrict them.
+      public: const std::vector<unsigned int> &WorkerThreadCpus() const;
+
+      /// \brief Set the CPUs the worker threads of each world are
+      /// restricted to.
+      /// \param[in] _cpus CPU indices. Empty doesn't restrict the threads.
+      /// \sa WorkerThreadCpus
+      public: void SetWorkerThreadCpus(const std::vector<unsigned int> &_cpus);
+
+      /// \brief NUMA nodes each world is partitioned across. Components of
+      /// entities in different partitions are stored in memory of different
+      /// nodes, and each partition is processed by workers pinned to its
+      /// node's CPUs, unless WorkerThreadCpus is set. Listing the same node
+      /// more than once splits it into more partitions. Only supported on
+      /// Linux.
+      /// \return Node indices, empty by default, which doesn't partition
+      /// worlds.
+      public: const std::vector<unsigned int> &NumaNodes() const;
+
+      /// \brief Set the NUMA nodes each world is partitioned across.
+      /// \param[in] _nodes Node indices. Empty doesn't partition worlds.
+      /// \sa NumaNodes
+      public: void SetNumaNodes(const std::vector<unsigned int> &_nodes);
+
+      /// \brief File the profiling zones of the server are written to, as a
+      /// Chrome trace, when the server is destroyed. Zones are recorded by
+      /// TraceRecorder from the moment the server is created. If empty, the
+      /// `IGN_GAZEBO_TRACE_FILE` environment variable is used instead.
+      /// \return Path of the trace file, empty by default, which disables
+      /// tracing.
+      public: const std::string &TraceFile() const;
+
+      /// \brief Set the file the profiling zones of the server are written
+      /// to.
+      /// \param[in] _file Path of the trace file. Empty disables tracing.
+      /// \sa TraceFile
+      public: void SetTraceFile(const std::string &_file);
+
+      /// \brief Whether the server runs in batch mode, which steps as fast
+      /// as possible and doesn't communicate at all. In batch mode:
+      ///  * no transport services or topics are offered by the server, its
+      ///    worlds, system manager and level manager, so simulation is
+      ///    only driven through Server::Run and Server::RunOnce;
+      ///  * world statistics and clock aren't published;
+      ///  * world control messages aren't processed;
+      ///  * steps aren't paced, regardless of the real time factor;
+      ///  * when no systems are given, only the default physics system is
+      ///    loaded, without the scene broadcaster and user commands.
+      ///
+      /// Systems loaded explicitly may still use transport on their own.
+      /// Batch mode is ignored for distributed simulation, which relies on
+      /// transport.
+      /// \return True if in batch mode, false by default.
+      public: bool BatchMode() const;
+
+      /// \brief Set whether the server runs in batch mode.
+      /// \param[in] _batchMode True for batch mode.
+      /// \sa BatchMode
+      public: void SetBatchMode(bool _batchMode);
+
+      /// \brief Name of the lockstep channel, through which a controller
+      /// in another process on the same host drives simulation one step at
+      /// a time, see LockstepClient. When set, each world creates a pair of
+      /// shared memory queues, and before each unpaused step, the runner
+      /// waits for the controller's actions, a state which is applied to
+      /// the world. After the step, the runner sends back the components
+      /// of the types given by LockstepObservations which changed during
+      /// the step. Steps aren't paced, since waiting for actions already
+      /// paces them.
+      ///
+      /// Lockstep is ignored for distributed simulation.
+      /// \return Channel name, empty by default, which disables lockstep.
+      public: const std::string &LockstepChannel() const;
+
+      /// \brief Set the name of the lockstep channel.
+      /// \param[in] _name Channel name, empty to disable.
+      /// \sa LockstepChannel
+      public: void SetLockstepChannel(const std::string &_name);
+
+      /// \brief Component types sent back to the lockstep controller after
+      /// each step.
+      /// \return Component type ids, empty by default, which sends all the
+      /// components which changed.
+      /// \sa LockstepChannel
+      public: const std::vector<ComponentTypeId> &LockstepObservations()
+          const;
+
+      /// \brief Set the component types sent back to the lockstep
+      /// controller after each step.
+      /// \param[in] _types Component type ids, empty for all.
+      /// \sa LockstepObservations
+      public: void SetLockstepObservations(
+                  const std::vector<ComponentTypeId> &_types);
+
+      /// \brief Whether state messages generated by the server, such as the
+      /// ones broadcast to the GUI and recorded to logs, hold components
+      /// like poses, velocities and joint positions in binary form. This is
+      /// cheaper than serializing them through streams, but the states
+      /// can't be read by older versions.
+      /// \return True if enabled, false by default.
+      /// \sa EntityComponentManager::SetBinarySerialization
+      public: bool BinaryStateSerialization() const;
+
+      /// \brief Set whether state messages hold components in binary form.
+      /// \param[in] _binary True to serialize in binary form.
+      /// \sa BinaryStateSerialization
+      public: void SetBinaryStateSerialization(bool _binary);
+
+      /// \brief Whether systems and the entity component manager's parallel
+      /// work give the same results on every run, regardless of the number
+      /// of threads and of how they're scheduled, which lets runs be
+      /// compared step by step. Combine it with a seed and a state hash
+      /// period.
+      /// \return True if enabled, false by default.
+      /// \sa EntityComponentManager::SetDeterministic
+      /// \sa StateHashPeriod
+      public: bool Deterministic() const;
+
+      /// \brief Set whether parallel work gives the same results on every
+      /// run.
+      /// \param[in] _deterministic True to enable.
+      /// \sa Deterministic
+      public: void SetDeterministic(bool _deterministic);
+
+      /// \brief Number of iterations between hashes of the full state of
+      /// each world, which are published on the world's `state_hash` topic
+      /// and can be compared between runs. Hashing serializes the whole
+      /// state, so it's costly for large worlds.
+      /// \return Period in iterations, zero by default, which disables
+      /// hashing.
+      /// \sa EntityComponentManager::StateHash
+      public: unsigned int StateHashPeriod() const;
+
+      /// \brief Set the number of iterations between hashes of the full
+      /// state of each world.
+      /// \param[in] _iterations Period in iterations, zero to disable.
+      /// \sa StateHashPeriod
+      public: void SetStateHashPeriod(unsigned int _iterations);
+
       /// \brief Physics engine plugin library to load.
       /// \return File containing physics engine library.
       public: const std::string &PhysicsEngine() const;
@@ -441,6 +767,7 @@ namespace ignition
       /// \brief Generate PluginInfo for Log playback based on the
       /// internal state of this ServerConfig object:
       /// \sa LogPlaybackPath
+      /// \sa LogPlaybackBatchToSensors
       public: PluginInfo LogPlaybackPlugin() const;
 
       /// \brief Get all the plugins that should be loaded.
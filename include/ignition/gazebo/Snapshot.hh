@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SNAPSHOT_HH_
+#define IGNITION_GAZEBO_SNAPSHOT_HH_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include <ignition/gazebo/config.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class Snapshot Snapshot.hh ignition/gazebo/Snapshot.hh
+    /// \brief Immutable copy of some data, published by one thread and read
+    /// by any number of others without blocking the publisher.
+    ///
+    /// This lets transport callbacks answer read-only requests, such as
+    /// state queries, from the last completed simulation step instead of
+    /// waiting for the next one. The simulation thread builds a new value
+    /// and publishes it, and readers keep using the value they got for as
+    /// long as they need, since it's never modified. The previous value is
+    /// freed once its last reader releases it.
+    ///
+    /// \tparam T Type of the data.
+    template <typename T>
+    class Snapshot
+    {
+      /// \brief Publish a new value, replacing the current one.
+      /// \param[in] _value New value, or nullptr to clear the snapshot.
+      public: void Publish(std::shared_ptr<const T> _value)
+      {
+        std::atomic_store(&this->value, std::move(_value));
+        this->epoch.fetch_add(1u, std::memory_order_release);
+      }
+
+      /// \brief Get the last published value.
+      /// \return The value, or nullptr if none was published or the
+      /// snapshot was cleared.
+      public: std::shared_ptr<const T> Get() const
+      {
+        return std::atomic_load(&this->value);
+      }
+
+      /// \brief Number of times a value was published, which tells readers
+      /// whether the snapshot changed since they last read it.
+      /// \return Publish count.
+      public: uint64_t Epoch() const
+      {
+        return this->epoch.load(std::memory_order_acquire);
+      }
+
+      /// \brief Current value, only accessed atomically.
+      private: std::shared_ptr<const T> value;
+
+      /// \brief Publish count.
+      private: std::atomic<uint64_t> epoch{0u};
+    };
+    }
+  }
+}
+#endif
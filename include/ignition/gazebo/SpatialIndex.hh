@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SPATIALINDEX_HH_
+#define IGNITION_GAZEBO_SPATIALINDEX_HH_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Types.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class IGNITION_GAZEBO_HIDDEN SpatialIndexPrivate;
+
+    /// \class SpatialIndex SpatialIndex.hh ignition/gazebo/SpatialIndex.hh
+    /// \brief Bounding volume hierarchy over all the models of the world,
+    /// used to find which models are inside or near a region without
+    /// looping over all of them.
+    ///
+    /// The bounds of a model are its AxisAlignedBox component, if it has
+    /// one, grown to contain the origin of the model. Models without that
+    /// component are indexed by the point at their world pose. Bounds are
+    /// in the world frame.
+    ///
+    /// The hierarchy is refit to the current bounds once per step, by the
+    /// first system which calls Update. It's rebuilt when models are added
+    /// or removed, or when they moved so much that the refit hierarchy
+    /// became inefficient. Queries may run concurrently with each other.
+    ///
+    /// There's one index per entity component manager, see For.
+    class IGNITION_GAZEBO_VISIBLE SpatialIndex
+    {
+      /// \brief Closest model hit by a ray.
+      public: struct RayHit
+      {
+        /// \brief Model hit, or kNullEntity if the ray didn't hit any.
+        Entity entity{kNullEntity};
+
+        /// \brief Distance from the ray origin to the bounds of the model,
+        /// zero if the origin is inside them.
+        double distance{0.0};
+      };
+
+      /// \brief Get the index of an entity component manager, creating it
+      /// if needed. The index lives as long as a system holds it.
+      /// \param[in] _ecm Entity component manager.
+      /// \return The index.
+      public: static std::shared_ptr<SpatialIndex> For(
+          const EntityComponentManager &_ecm);
+
+      /// \brief Constructor. Use For to share the index between systems.
+      public: SpatialIndex();
+
+      /// \brief Destructor
+      public: ~SpatialIndex();
+
+      /// \brief Bring the index up to date with the current step. Only the
+      /// first call of each iteration does any work, so every system should
+      /// call this before querying.
+      /// \param[in] _info Current simulation information.
+      /// \param[in] _ecm Entity component manager.
+      public: void Update(const UpdateInfo &_info,
+          const EntityComponentManager &_ecm);
+
+      /// \brief Number of indexed models.
+      /// \return Number of models.
+      public: std::size_t Size() const;
+
+      /// \brief Get the indexed bounds of a model.
+      /// \param[in] _entity Model entity.
+      /// \return Bounds of the model, or an empty box if it isn't indexed.
+      public: math::AxisAlignedBox Bounds(Entity _entity) const;
+
+      /// \brief Find all models whose bounds intersect a box.
+      /// \param[in] _box Query box in the world frame.
+      /// \param[out] _result Models, in no particular order. It's cleared
+      /// first.
+      public: void Overlapping(const math::AxisAlignedBox &_box,
+          std::vector<Entity> &_result) const;
+
+      /// \brief Find all models whose bounds are within a distance of a
+      /// point.
+      /// \param[in] _center Query point in the world frame.
+      /// \param[in] _radius Distance from the point.
+      /// \param[out] _result Models, in no particular order. It's cleared
+      /// first.
+      public: void WithinRadius(const math::Vector3d &_center,
+          double _radius, std::vector<Entity> &_result) const;
+
+      /// \brief Find the models whose bounds are closest to a point.
+      /// \param[in] _point Query point in the world frame.
+      /// \param[in] _count Maximum number of models.
+      /// \param[out] _result Up to _count models, closest first. It's
+      /// cleared first.
+      public: void Nearest(const math::Vector3d &_point, std::size_t _count,
+          std::vector<Entity> &_result) const;
+
+      /// \brief Find the first model whose bounds are hit by a ray.
+      /// \param[in] _origin Origin of the ray in the world frame.
+      /// \param[in] _direction Direction of the ray, it doesn't need to be
+      /// normalized.
+      /// \param[in] _maxDistance Length of the ray.
+      /// \return The closest hit.
+      public: RayHit RayCast(const math::Vector3d &_origin,
+          const math::Vector3d &_direction, double _maxDistance) const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<SpatialIndexPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
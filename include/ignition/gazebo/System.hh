@@ -17,7 +17,13 @@
 #ifndef IGNITION_GAZEBO_SYSTEM_HH_
 #define IGNITION_GAZEBO_SYSTEM_HH_
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
 
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/EntityComponentManager.hh>
@@ -116,6 +122,84 @@ namespace ignition
                   EntityComponentManager &_ecm) = 0;
     };
 
+    /// \class ISystemComponentAccess ISystem.hh ignition/gazebo/System.hh
+    /// \brief Interface for a system that declares which component types it
+    /// reads and writes during PreUpdate and Update.
+    ///
+    /// Systems implementing this interface may run at the same time as other
+    /// systems in the same phase, as long as their declared accesses don't
+    /// conflict. Two systems conflict if one writes a component type that the
+    /// other reads or writes. Conflicting systems keep running in the order
+    /// they were added. Systems that don't implement this interface never run
+    /// alongside other systems.
+    ///
+    /// A system implementing this interface must not create or remove
+    /// entities or components during PreUpdate or Update, since those changes
+    /// affect all systems. It may modify and mark as changed the components
+    /// it declared as written.
+    class ISystemComponentAccess {
+      /// \brief Component types read by the system.
+      /// \return Set of component type ids.
+      public: virtual std::set<ComponentTypeId> ReadComponents() const = 0;
+
+      /// \brief Component types written by the system. A written component
+      /// doesn't need to be listed as read as well.
+      /// \return Set of component type ids.
+      public: virtual std::set<ComponentTypeId> WriteComponents() const = 0;
+    };
+
+    /// \class ISystemMemoryUsage ISystem.hh ignition/gazebo/System.hh
+    /// \brief Interface for a system that reports the memory it holds, so
+    /// it shows up in memory diagnostics next to the entity component
+    /// manager. See SimulationRunner's memory/info service.
+    class ISystemMemoryUsage {
+      /// \brief Estimate the memory held by the system. Called from the
+      /// simulation thread, between updates.
+      /// \return Estimate in bytes.
+      public: virtual std::size_t MemoryUsage() const = 0;
+    };
+
+    /// \brief Conditions which wake a sleeping system, see ISystemSleep.
+    /// The system wakes at the first step after any of them is met.
+    struct SystemWake
+    {
+      /// \brief Wake at the first step whose UpdateInfo::simTime is at
+      /// least this. Leave unset to not wake on simulation time.
+      std::optional<std::chrono::steady_clock::duration> simTime;
+
+      /// \brief Wake after a message is published on any of these topics.
+      std::vector<std::string> topics;
+
+      /// \brief Wake after a component of any of these types is created or
+      /// changed, as reported by EntityComponentManager::ComponentTypeVersion.
+      /// Changes made during the step in which the system fell asleep count
+      /// as well.
+      std::vector<ComponentTypeId> components;
+    };
+
+    /// \class ISystemSleep ISystem.hh ignition/gazebo/System.hh
+    /// \brief Interface for a system which can sleep while it has nothing to
+    /// do, such as a controller waiting for commands or a trigger waiting for
+    /// input. Simulation doesn't call a sleeping system at all, in any phase,
+    /// so worlds with many idle systems spend less time on each step.
+    ///
+    /// A sleeping system wakes when one of its SystemWake conditions is met,
+    /// when simulation time goes back, for example on reset, and when systems
+    /// are added. A system which sleeps without any condition only wakes for
+    /// the latter.
+    class ISystemSleep {
+      /// \brief Called from the simulation thread after each step the system
+      /// ran in, to ask whether it can sleep from the next step on. Systems
+      /// which receive messages themselves should only sleep after handling
+      /// the ones they got, since messages published before the system first
+      /// asks to wake on a topic don't wake it.
+      /// \param[in] _info Information of the step which just ran.
+      /// \param[out] _wake Conditions to wake the system, empty when called.
+      /// \return True to sleep until one of the conditions is met.
+      public: virtual bool Sleep(const UpdateInfo &_info,
+                                 SystemWake &_wake) = 0;
+    };
+
     /// \class ISystemPreUpdate ISystem.hh ignition/gazebo/System.hh
     /// \brief Interface for a system that uses the PreUpdate phase
     class ISystemPreUpdate {
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_TERRAINTILES_HH_
+#define IGNITION_GAZEBO_TERRAINTILES_HH_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <ignition/common/HeightmapData.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class IGNITION_GAZEBO_HIDDEN TerrainTilesPrivate;
+
+    /// \class TerrainTiles TerrainTiles.hh ignition/gazebo/TerrainTiles.hh
+    /// \brief Square tiles of a large heightmap, so that rendering and
+    /// physics only build the parts of the terrain which are in use.
+    ///
+    /// The heights of the whole terrain are computed once from the
+    /// heightmap data, at the terrain's size and sampling. Tiles share
+    /// their edge samples with their neighbors, so adjacent tiles meet
+    /// without gaps. Each tile has a pyramid of levels of detail, where
+    /// every level has half the resolution of the previous one and keeps
+    /// the tile's edges and corners, so tiles at any level still cover the
+    /// same area.
+    ///
+    /// Positions are in the frame of the heightmap geometry, with the
+    /// heightmap's position offset already applied to the tiles. As in
+    /// images, rows of tiles go from +y to -y and columns from -x to +x.
+    class IGNITION_GAZEBO_VISIBLE TerrainTiles
+    {
+      /// \brief Default number of samples along a side of a tile.
+      public: static constexpr unsigned int kDefaultTileSamples{257u};
+
+      /// \brief A tile selected for use.
+      public: struct Tile
+      {
+        /// \brief Index of the tile, see TileCount.
+        std::size_t index{0u};
+
+        /// \brief Level of detail to use, 0 being the full resolution.
+        unsigned int lod{0u};
+      };
+
+      /// \brief Constructor
+      public: TerrainTiles();
+
+      /// \brief Destructor
+      public: ~TerrainTiles();
+
+      /// \brief Whether a heightmap is large enough to be split into
+      /// tiles of a given size.
+      /// \param[in] _data Heightmap data.
+      /// \param[in] _sampling Samples per heightmap datum.
+      /// \param[in] _tileSamples Samples along a side of a tile, which must
+      /// be a power of two plus one.
+      /// \return True if Load would split the heightmap in more than one
+      /// tile.
+      public: static bool Tiled(const common::HeightmapData &_data,
+                  unsigned int _sampling, unsigned int _tileSamples);
+
+      /// \brief Split a heightmap into tiles. Any previous tiles are
+      /// dropped.
+      /// \param[in] _data Heightmap data, which is only used during the
+      /// call.
+      /// \param[in] _size Size of the whole terrain.
+      /// \param[in] _position Offset of the terrain.
+      /// \param[in] _sampling Samples per heightmap datum.
+      /// \param[in] _tileSamples Samples along a side of a tile, which must
+      /// be a power of two plus one.
+      /// \return False if the heightmap isn't square, or its samples can't
+      /// be split evenly into tiles of that size. Callers should then use
+      /// the heightmap as a whole.
+      public: bool Load(const common::HeightmapData &_data,
+                  const math::Vector3d &_size,
+                  const math::Vector3d &_position,
+                  unsigned int _sampling, unsigned int _tileSamples);
+
+      /// \brief Number of tiles, which are indexed row by row.
+      /// \return Number of tiles, zero if nothing was loaded.
+      public: std::size_t TileCount() const;
+
+      /// \brief Number of levels of detail of each tile.
+      /// \return Number of levels, including the full resolution one.
+      public: unsigned int LodCount() const;
+
+      /// \brief Size of every tile. Its height is that of the whole
+      /// terrain, so tiles have the same vertical scale.
+      /// \return Size.
+      public: math::Vector3d TileSize() const;
+
+      /// \brief Position of the center of a tile.
+      /// \param[in] _index Index of the tile.
+      /// \return Position, with the terrain's offset.
+      public: math::Vector3d TilePosition(std::size_t _index) const;
+
+      /// \brief Heightmap data of a tile, to be given to a render or
+      /// physics engine with the tile's size and position, and a sampling
+      /// of 1. Its heights are already scaled to the terrain's size.
+      /// \param[in] _index Index of the tile.
+      /// \param[in] _lod Level of detail.
+      /// \return Data which holds a copy of the tile's heights, or nullptr
+      /// if the tile or level doesn't exist.
+      public: std::shared_ptr<common::HeightmapData> TileData(
+                  std::size_t _index, unsigned int _lod) const;
+
+      /// \brief Select the tiles needed around some points. A tile's level
+      /// of detail goes up by one each time its distance to the closest
+      /// point doubles past _lodDistance.
+      /// \param[in] _points Points of interest, such as cameras or bodies.
+      /// \param[in] _radius Tiles closer than this horizontal distance to
+      /// a point are selected.
+      /// \param[in] _lodDistance Distance up to which the full resolution
+      /// is used. Zero or less always uses the full resolution.
+      /// \param[out] _tiles Selected tiles, by increasing index. It's
+      /// cleared first.
+      public: void Select(const std::vector<math::Vector3d> &_points,
+                  double _radius, double _lodDistance,
+                  std::vector<Tile> &_tiles) const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<TerrainTilesPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
@@ -17,8 +17,12 @@
 #ifndef IGNITION_GAZEBO_TESTFIXTURE_HH_
 #define IGNITION_GAZEBO_TESTFIXTURE_HH_
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "ignition/gazebo/EntityComponentManager.hh"
 #include "ignition/gazebo/Export.hh"
@@ -52,6 +56,30 @@ class IGNITION_GAZEBO_HIDDEN TestFixturePrivate;
 /// // Run the server
 /// fixture.Server()->Run(true, 1000, false);
 ///
+/// ## Batched stepping
+///
+/// For learning and other workloads which step many copies of a world, the
+/// fixture can read observations from and apply actions to all worlds of
+/// the server at once, without a callback per world or per entity. Each
+/// world has one row of observations and one row of actions, and the rows
+/// of all worlds are stored one after the other in flat buffers.
+///
+/// // Simulate 16 copies of the world
+/// ignition::gazebo::ServerConfig config;
+/// config.SetSdfFile("path_to.sdf");
+/// config.SetWorldCopies(16);
+/// ignition::gazebo::TestFixture fixture(config);
+///
+/// // Describe a row, before finalizing
+/// fixture.AddObservation("robot::base", TestFixture::Observation::POSE);
+/// fixture.AddAction("robot::wheel_joint", TestFixture::Action::JOINT_FORCE);
+/// fixture.Finalize();
+///
+/// std::vector<double> actions(
+///     fixture.WorldCount() * fixture.ActionSize(), 0.0);
+/// std::vector<double> observations;
+/// fixture.Step(actions, observations);
+///
 class IGNITION_GAZEBO_VISIBLE TestFixture
 {
   /// \brief Constructor
@@ -102,6 +130,98 @@ class IGNITION_GAZEBO_VISIBLE TestFixture
   /// \brief Get pointer to underlying server.
   public: std::shared_ptr<gazebo::Server> Server() const;
 
+  /// \brief Values which Step reads from each world.
+  public: enum class Observation
+  {
+    /// \brief World pose of a model or link, as x, y, z, qw, qx, qy, qz.
+    POSE,
+
+    /// \brief World linear velocity of a link, as x, y, z.
+    LINEAR_VELOCITY,
+
+    /// \brief World angular velocity of a link, as x, y, z.
+    ANGULAR_VELOCITY,
+
+    /// \brief Position of the first axis of a joint.
+    JOINT_POSITION,
+
+    /// \brief Velocity of the first axis of a joint.
+    JOINT_VELOCITY
+  };
+
+  /// \brief Commands which Step applies to each world.
+  public: enum class Action
+  {
+    /// \brief Force or torque on the first axis of a joint.
+    JOINT_FORCE,
+
+    /// \brief Velocity of the first axis of a joint.
+    JOINT_VELOCITY,
+
+    /// \brief Linear velocity of a model, in its own frame, as x, y, z.
+    LINEAR_VELOCITY,
+
+    /// \brief Angular velocity of a model, in its own frame, as x, y, z.
+    ANGULAR_VELOCITY
+  };
+
+  /// \brief Add a value to the observations of each world. This must be
+  /// called before Finalize.
+  /// \param[in] _scopedName Scoped name of the entity, such as
+  /// `model::link`, which must be unique within each world.
+  /// \param[in] _observation Value to read.
+  /// \return Offset of the value within each row of observations, or
+  /// std::nullopt if the fixture has already been finalized.
+  public: std::optional<std::size_t> AddObservation(
+      const std::string &_scopedName, Observation _observation);
+
+  /// \brief Add a command to the actions of each world. This must be
+  /// called before Finalize.
+  /// \param[in] _scopedName Scoped name of the entity, such as
+  /// `model::joint`, which must be unique within each world.
+  /// \param[in] _action Command to apply.
+  /// \return Offset of the command within each row of actions, or
+  /// std::nullopt if the fixture has already been finalized.
+  public: std::optional<std::size_t> AddAction(
+      const std::string &_scopedName, Action _action);
+
+  /// \brief Number of values in each world's row of observations.
+  /// \return Row size.
+  public: std::size_t ObservationSize() const;
+
+  /// \brief Number of values in each world's row of actions.
+  /// \return Row size.
+  public: std::size_t ActionSize() const;
+
+  /// \brief Number of worlds in the server, including world copies.
+  /// \return World count.
+  public: std::size_t WorldCount() const;
+
+  /// \brief Apply actions to all worlds, step all of them in parallel and
+  /// read their observations. The same actions are applied on every
+  /// iteration. Observations of entities which can't be found are NaN.
+  /// \param[in] _actions WorldCount() rows of ActionSize() values each. May
+  /// be null if there are no actions.
+  /// \param[out] _observations WorldCount() rows of ObservationSize()
+  /// values each. May be null if there are no observations.
+  /// \param[in] _iterations Number of iterations to step.
+  /// \return False if the fixture hasn't been finalized, or if the server
+  /// didn't complete the iterations.
+  public: bool Step(const double *_actions, double *_observations,
+      uint64_t _iterations = 1);
+
+  /// \brief Apply actions to all worlds, step all of them in parallel and
+  /// read their observations.
+  /// \param[in] _actions WorldCount() * ActionSize() values.
+  /// \param[out] _observations Resized to hold WorldCount() *
+  /// ObservationSize() values.
+  /// \param[in] _iterations Number of iterations to step.
+  /// \return False if the number of actions is wrong, or if stepping
+  /// failed.
+  /// \sa Step(const double *, double *, uint64_t)
+  public: bool Step(const std::vector<double> &_actions,
+      std::vector<double> &_observations, uint64_t _iterations = 1);
+
   /// \internal
   /// \brief Pointer to private data.
   // TODO(chapulina) Use IGN_UTILS_UNIQUE_IMPL_PTR(dataPtr) when porting to v6
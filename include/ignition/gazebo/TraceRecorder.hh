@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_TRACERECORDER_HH_
+#define IGNITION_GAZEBO_TRACERECORDER_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <ignition/common/Profiler.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class IGNITION_GAZEBO_HIDDEN TraceRecorderPrivate;
+
+    /// \class TraceRecorder TraceRecorder.hh ignition/gazebo/TraceRecorder.hh
+    /// \brief Records profiling zones in memory and writes them as a Chrome
+    /// trace, which can be opened in chrome://tracing or Perfetto.
+    ///
+    /// This is a lightweight alternative to the Remotery based profiler for
+    /// runs where no profiler UI can connect, such as headless runs in the
+    /// cloud. Zones are marked with IGN_GAZEBO_PROFILE, which also feeds the
+    /// Remotery profiler when that is enabled.
+    ///
+    /// Each thread records into its own fixed size ring buffer, so recording
+    /// a zone takes no lock and never allocates. When a buffer is full, the
+    /// oldest zones of that thread are overwritten, so a trace holds the
+    /// most recent activity.
+    ///
+    /// There's one recorder per process, see Instance.
+    class IGNITION_GAZEBO_VISIBLE TraceRecorder
+    {
+      /// \brief Get the recorder of this process.
+      /// \return The recorder.
+      public: static TraceRecorder &Instance();
+
+      /// \brief Destructor
+      public: ~TraceRecorder();
+
+      /// \brief Discard previously recorded zones and start recording.
+      /// \param[in] _zonesPerThread Capacity of the buffer of each thread.
+      /// Only applies to threads which haven't recorded before.
+      public: void Start(std::size_t _zonesPerThread = 65536u);
+
+      /// \brief Stop recording. Recorded zones are kept until the next
+      /// Start.
+      public: void Stop();
+
+      /// \brief Whether zones are being recorded.
+      /// \return True if recording.
+      public: bool Recording() const;
+
+      /// \brief Record a zone on the calling thread. Does nothing if not
+      /// recording.
+      /// \param[in] _name Zone name. Must outlive the recorder, such as a
+      /// string literal.
+      /// \param[in] _start When the zone started.
+      /// \param[in] _end When the zone ended.
+      public: void Record(const char *_name,
+                  std::chrono::steady_clock::time_point _start,
+                  std::chrono::steady_clock::time_point _end);
+
+      /// \brief Name the calling thread in traces. Threads named with
+      /// setCurrentThreadName are named here too.
+      /// \param[in] _name Thread name.
+      public: void SetThreadName(const std::string &_name);
+
+      /// \brief Number of zones currently held by all buffers.
+      /// \return Zone count.
+      public: std::size_t ZoneCount() const;
+
+      /// \brief Serialize the recorded zones in the Chrome trace event
+      /// format, with times in microseconds since Start.
+      /// \return JSON trace.
+      public: std::string ChromeTrace() const;
+
+      /// \brief Write the recorded zones to a file in the Chrome trace event
+      /// format.
+      /// \param[in] _path Path of the file, which is replaced.
+      /// \return True if the file was written.
+      public: bool WriteChromeTrace(const std::string &_path) const;
+
+      /// \brief Constructor, use Instance instead.
+      private: TraceRecorder();
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<TraceRecorderPrivate> dataPtr;
+    };
+
+    /// \brief Records a zone from its construction to its destruction,
+    /// if the trace recorder was recording when it was constructed.
+    class ScopedTraceZone
+    {
+      /// \brief Constructor
+      /// \param[in] _name Zone name. Must outlive the recorder, such as a
+      /// string literal.
+      public: explicit ScopedTraceZone(const char *_name)
+      {
+        if (TraceRecorder::Instance().Recording())
+        {
+          this->name = _name;
+          this->start = std::chrono::steady_clock::now();
+        }
+      }
+
+      /// \brief Destructor. Records the zone.
+      public: ~ScopedTraceZone()
+      {
+        if (nullptr != this->name)
+        {
+          TraceRecorder::Instance().Record(this->name, this->start,
+              std::chrono::steady_clock::now());
+        }
+      }
+
+      /// \brief Not copyable.
+      public: ScopedTraceZone(const ScopedTraceZone &) = delete;
+
+      /// \brief Not copyable.
+      public: ScopedTraceZone &operator=(const ScopedTraceZone &) = delete;
+
+      /// \brief Zone name, null if not recording.
+      private: const char *name{nullptr};
+
+      /// \brief When the zone started.
+      private: std::chrono::steady_clock::time_point start;
+    };
+    }
+  }
+}
+
+/// \brief Helpers to give each zone variable a unique name.
+#define IGN_GAZEBO_TRACE_CONCAT_IMPL(_a, _b) _a##_b
+#define IGN_GAZEBO_TRACE_CONCAT(_a, _b) IGN_GAZEBO_TRACE_CONCAT_IMPL(_a, _b)
+
+/// \brief Profile the rest of the current scope, both with the Remotery
+/// profiler, when enabled, and with the TraceRecorder, when recording.
+/// \param[in] _name Zone name, a string literal.
+#define IGN_GAZEBO_PROFILE(_name) \
+  IGN_PROFILE(_name); \
+  ::ignition::gazebo::ScopedTraceZone \
+      IGN_GAZEBO_TRACE_CONCAT(ignGazeboTraceZone, __LINE__)(_name)
+
+#endif
@@ -19,6 +19,7 @@
 
 #include <ignition/msgs/entity.pb.h>
 
+#include <functional>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -37,7 +38,9 @@ namespace ignition
     // Inline bracket to help doxygen filtering.
     inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     //
-    /// \brief Helper function to compute world pose of an entity
+    /// \brief Helper function to compute world pose of an entity. The pose
+    /// is always computed from the current Pose components, see
+    /// EntityComponentManager::EntityWorldPose for a cached alternative.
     /// \param[in] _entity Entity to get the world pose for
     /// \param[in] _ecm Immutable reference to ECM.
     /// \return World pose of entity
@@ -168,6 +171,25 @@ namespace ignition
     void IGNITION_GAZEBO_VISIBLE addResourcePaths(
         const std::vector<std::string> &_paths = {});
 
+    /// \brief Resolve a resource URI, remembering the result for the rest of
+    /// the process. Meshes and materials are often referenced thousands of
+    /// times by a world, and each resolution probes the filesystem. The cache
+    /// is cleared by `addResourcePaths` and `clearResourceCache`.
+    /// \param[in] _uri URI of the resource.
+    /// \param[in] _resolve Function resolving the URI into a path, or an
+    /// empty string if it can't be found. Only called for URIs which aren't
+    /// cached. Empty results are only cached for URIs which aren't http or
+    /// https, since those may be downloaded later.
+    /// \return Path of the resource, empty if it can't be found.
+    std::string IGNITION_GAZEBO_VISIBLE resolveResourceUri(
+        const std::string &_uri,
+        const std::function<std::string(const std::string &)> &_resolve);
+
+    /// \brief Forget all resources resolved by `resolveResourceUri` and
+    /// `findFuelResourceSdf`, for example after files were added to the
+    /// resource paths.
+    void IGNITION_GAZEBO_VISIBLE clearResourceCache();
+
     /// \brief Get the top level model of an entity
     /// \param[in] _entity Input entity
     /// \param[in] _ecm Constant reference to ECM.
@@ -230,6 +252,16 @@ namespace ignition
         const std::string &_sdfFilename,
         const std::string &_fuelResourceCache = "");
 
+    /// \brief Find the URIs of remote resources, such as Fuel models and
+    /// meshes, referenced by an SDF string. Only the `<uri>` elements of the
+    /// string itself are looked at, so resources referenced by the included
+    /// models aren't returned.
+    /// \param[in] _sdfString SDF string, such as the contents of a world
+    /// file.
+    /// \return Unique http and https URIs, in the order they appear.
+    std::vector<std::string> IGNITION_GAZEBO_VISIBLE fuelResourceUris(
+        const std::string &_sdfString);
+
     /// \brief Helper function to "enable" a component (i.e. create it if it
     /// doesn't exist) or "disable" a component (i.e. remove it if it exists).
     /// \param[in] _ecm Mutable reference to the ECM
@@ -287,6 +319,33 @@ namespace ignition
     std::optional<math::Vector3d> IGNITION_GAZEBO_VISIBLE sphericalCoordinates(
         Entity _entity, const EntityComponentManager &_ecm);
 
+    /// \brief Parse a list of CPUs in the format used by Linux, such as
+    /// "0-3,8,10-11".
+    /// \param[in] _list Comma separated CPU indices and inclusive ranges.
+    /// \return Sorted CPU indices without duplicates, or an empty vector if
+    /// the list is malformed.
+    std::vector<unsigned int> IGNITION_GAZEBO_VISIBLE parseCpuList(
+        const std::string &_list);
+
+    /// \brief Get the CPUs of a NUMA node. Only supported on Linux.
+    /// \param[in] _node NUMA node index.
+    /// \return CPU indices, or an empty vector if the node doesn't exist.
+    std::vector<unsigned int> IGNITION_GAZEBO_VISIBLE numaNodeCpus(
+        unsigned int _node);
+
+    /// \brief Restrict the calling thread to a set of CPUs. Only supported
+    /// on Linux.
+    /// \param[in] _cpus CPU indices. An empty set leaves the thread as is.
+    /// \return True if the affinity was set.
+    bool IGNITION_GAZEBO_VISIBLE setCurrentThreadAffinity(
+        const std::vector<unsigned int> &_cpus);
+
+    /// \brief Name the calling thread, so it can be told apart in tools
+    /// like top and gdb. Linux truncates names to 15 characters. Does
+    /// nothing on other platforms.
+    /// \param[in] _name Thread name.
+    void IGNITION_GAZEBO_VISIBLE setCurrentThreadName(const std::string &_name);
+
     /// \brief Environment variable holding resource paths.
     const std::string kResourcePathEnv{"IGN_GAZEBO_RESOURCE_PATH"};
 
@@ -300,6 +359,10 @@ namespace ignition
     /// \brief Environment variable holding paths to custom rendering engine
     /// plugins.
     const std::string kRenderPluginPathEnv{"IGN_GAZEBO_RENDER_ENGINE_PATH"};
+
+    /// \brief Environment variable holding the path of a trace file, see
+    /// ServerConfig::TraceFile.
+    const std::string kTraceFileEnv{"IGN_GAZEBO_TRACE_FILE"};
     }
   }
 }
@@ -19,6 +19,7 @@
 #define IGNITION_GAZEBO_BROKER_HH_
 
 #include <memory>
+#include <string>
 
 #include <ignition/utils/ImplPtr.hh>
 #include <sdf/sdf.hh>
@@ -82,11 +83,20 @@ namespace comms
   ///     <unbind_service>/broker/unbind_address</unbind_service>
   ///   </broker>
   /// </plugin>
+  ///
+  /// Clients living in the same process as the broker can skip Ignition
+  /// Transport altogether. They send shared messages with SendLocal and
+  /// receive all the messages of a step at once with BindLocal, without
+  /// copies or serialization. Those functions find the broker by its
+  /// messages topic once it's started.
   class IGNITION_GAZEBO_VISIBLE Broker
   {
     /// \brief Constructor.
     public: Broker();
 
+    /// \brief Destructor.
+    public: ~Broker();
+
     /// \brief Configure the broker via SDF.
     /// \param[in] _sdf The SDF Element associated with the broker parameters.
     public: void Load(std::shared_ptr<const sdf::Element> _sdf);
@@ -129,6 +139,64 @@ namespace comms
     /// \param[in] _msg The message from the client.
     public: void OnMsg(const ignition::msgs::Dataframe &_msg);
 
+    /// \brief Queue a message in the outbound queue of its sender without
+    /// copying it. The message is stamped with the current time, so it
+    /// shouldn't be modified by the caller afterwards.
+    /// \param[in] _msg The message from the client.
+    public: void Send(const msgs::DataframeSharedPtr &_msg);
+
+    /// \brief Bind an in-process client to an address, see
+    /// MsgManager::AddLocalSubscriber. The callback runs while the broker is
+    /// locked, so it must not call back into the broker.
+    /// \param[in] _address Client address.
+    /// \param[in] _modelName Model name associated to the address.
+    /// \param[in] _name Name identifying the client within the address.
+    /// \param[in] _callback Callback receiving the messages of each step.
+    /// \return True when the client was bound or false otherwise.
+    public: bool BindLocal(const std::string &_address,
+                           const std::string &_modelName,
+                           const std::string &_name,
+                           const LocalCallback &_callback);
+
+    /// \brief Unbind an in-process client from an address.
+    /// \param[in] _address Client address.
+    /// \param[in] _name Name identifying the client within the address.
+    /// \return True when the client was unbound or false otherwise.
+    public: bool UnbindLocal(const std::string &_address,
+                             const std::string &_name);
+
+    /// \brief Send a message through the started broker of this process
+    /// which receives messages on a topic. See Send.
+    /// \param[in] _msgTopic Messages topic of the broker.
+    /// \param[in] _msg The message from the client.
+    /// \return True if the broker was found or false otherwise.
+    public: static bool SendLocal(const std::string &_msgTopic,
+                                  const msgs::DataframeSharedPtr &_msg);
+
+    /// \brief Bind an in-process client through the started broker of this
+    /// process which receives messages on a topic. See BindLocal.
+    /// \param[in] _msgTopic Messages topic of the broker.
+    /// \param[in] _address Client address.
+    /// \param[in] _modelName Model name associated to the address.
+    /// \param[in] _name Name identifying the client within the address.
+    /// \param[in] _callback Callback receiving the messages of each step.
+    /// \return True when the client was bound or false otherwise.
+    public: static bool BindLocal(const std::string &_msgTopic,
+                                  const std::string &_address,
+                                  const std::string &_modelName,
+                                  const std::string &_name,
+                                  const LocalCallback &_callback);
+
+    /// \brief Unbind an in-process client through the started broker of this
+    /// process which receives messages on a topic.
+    /// \param[in] _msgTopic Messages topic of the broker.
+    /// \param[in] _address Client address.
+    /// \param[in] _name Name identifying the client within the address.
+    /// \return True when the client was unbound or false otherwise.
+    public: static bool UnbindLocal(const std::string &_msgTopic,
+                                    const std::string &_address,
+                                    const std::string &_name);
+
     /// \brief Process all the messages in the inbound queue and deliver them
     /// to the destination clients.
     public: void DeliverMsgs();
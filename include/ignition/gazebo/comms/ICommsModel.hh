@@ -114,10 +114,15 @@ namespace comms
     ///
     /// Note: this is an experimental interface and might change in the future.
     ///
+    /// Both registries are the same object, which is updated in place, so
+    /// changes made through _newRegistry are immediately visible through
+    /// _currentRegistry. Since the registry may be iterated while it's
+    /// modified, models must not add or remove addresses, only modify the
+    /// content of existing ones.
+    ///
     /// \param[in] _info Simulator information about the current timestep.
     /// \param[in] _currentRegistry The current registry.
-    /// \param[out] _newRegistry The new registry. When Step() is finished this
-    ///                         will become the new registry.
+    /// \param[out] _newRegistry The registry to modify.
     /// \param[in] _ecm - Ignition's ECM.
     public: virtual void Step(const UpdateInfo &_info,
                               const Registry &_currentRegistry,
@@ -19,6 +19,7 @@
 #define IGNITION_GAZEBO_MSGMANAGER_HH_
 
 #include <deque>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -51,6 +52,15 @@ using DataQueue = std::deque<msgs::DataframeSharedPtr>;
 using SubscriptionHandler =
   std::unordered_map<std::string, transport::Node::Publisher>;
 
+/// \brief Callback of an in-process subscriber. It receives all the messages
+/// delivered to its address during a step at once, without serialization.
+using LocalCallback = std::function<void(const DataQueue &)>;
+
+/// \brief A map where the key is the name of an in-process subscriber and the
+/// value is its callback.
+using LocalSubscriptionHandler =
+  std::unordered_map<std::string, LocalCallback>;
+
 /// \brief All the information associated to an address.
 struct AddressContent
 {
@@ -63,6 +73,9 @@ struct AddressContent
   /// \brief Subscribers.
   public: SubscriptionHandler subscriptions;
 
+  /// \brief In-process subscribers.
+  public: LocalSubscriptionHandler localSubscriptions;
+
   /// \brief Model name associated to this address.
   public: std::string modelName;
 
@@ -92,6 +105,20 @@ class IGNITION_GAZEBO_VISIBLE MsgManager
                              const std::string &_modelName,
                              const std::string &_topic);
 
+  /// \brief Add a new in-process subscriber. Its callback is called once per
+  /// DeliverMsgs with all the messages delivered to the address, which are
+  /// shared instead of published. The same address/model rules as in
+  /// AddSubscriber apply.
+  /// \param[in] _address The subscriber address.
+  /// \param[in] _modelName The model name.
+  /// \param[in] _name Name identifying the subscriber within the address.
+  /// \param[in] _callback Callback receiving the messages.
+  /// \return True if the subscriber was successfully added or false otherwise.
+  public: bool AddLocalSubscriber(const std::string &_address,
+                                  const std::string &_modelName,
+                                  const std::string &_name,
+                                  const LocalCallback &_callback);
+
   /// \brief Add a new message to the inbound queue.
   /// \param[in] _address The destination address.
   /// \param[in] _msg The message.
@@ -111,6 +138,13 @@ class IGNITION_GAZEBO_VISIBLE MsgManager
   public: bool RemoveSubscriber(const std::string &_address,
                                 const std::string &_topic);
 
+  /// \brief Remove an existing in-process subscriber.
+  /// \param[in] _address The subscriber address.
+  /// \param[in] _name The subscriber name.
+  /// \return True if the subscriber was removed or false otherwise.
+  public: bool RemoveLocalSubscriber(const std::string &_address,
+                                     const std::string &_name);
+
   /// \brief Remove a message from the inbound queue.
   /// \param[in] _address The destination address.
   /// \param[in] _Msg Message pointer to remove.
@@ -127,6 +161,8 @@ class IGNITION_GAZEBO_VISIBLE MsgManager
 
   /// \brief This function delivers all the messages in the inbound queue to
   /// the appropriate subscribers. This function also clears the inbound queue.
+  /// Topic subscribers receive one publication per message, in-process
+  /// subscribers receive the whole queue in a single call.
   public: void DeliverMsgs();
 
   /// \brief Get an inmutable reference to the data containing subscriptions and
@@ -140,7 +176,8 @@ class IGNITION_GAZEBO_VISIBLE MsgManager
   public: Registry &Data();
 
   /// \brief Get a copy of the data structure containing subscriptions and data
-  /// queues.
+  /// queues. This copies every queue and publisher, prefer Data to modify
+  /// the registry in place.
   /// \return A copy of the data.
   public: Registry Copy() const;
 
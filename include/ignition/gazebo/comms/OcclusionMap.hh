@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef IGNITION_GAZEBO_OCCLUSIONMAP_HH_
+#define IGNITION_GAZEBO_OCCLUSIONMAP_HH_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+#include <ignition/utils/ImplPtr.hh>
+#include <sdf/Element.hh>
+#include "ignition/gazebo/comms/PropagationModel.hh"
+#include "ignition/gazebo/config.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/Export.hh"
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace comms
+{
+  /// \brief Propagation model where each obstacle between a transmitter and
+  /// a receiver attenuates the signal by a fixed amount, such as the walls
+  /// of a building.
+  ///
+  /// A region of the world is split into a grid of cells. The number of
+  /// obstacles crossed by the segment between the centers of every pair of
+  /// cells is ray cast once, so looking up the attenuation of a link only
+  /// takes the cells of its two ends. Points outside of the region use the
+  /// closest cell. A region without height gives a 2D map.
+  ///
+  /// Obstacles are oriented boxes. The static collisions of the world are
+  /// added on the first Update, using their bounding box for shapes other
+  /// than boxes. Planes and meshes are ignored.
+  ///
+  /// The map takes a number of pairs quadratic in the number of cells, so
+  /// it's meant for coarse grids. It can be cached on disk, keyed by a hash
+  /// of the grid and the obstacles, so that later runs of the same world
+  /// load it instead of ray casting again.
+  ///
+  /// The model can be configured with the following SDF parameters:
+  ///
+  /// * Required parameters:
+  /// <min> Minimum corner of the region in the world frame.
+  /// <max> Maximum corner of the region in the world frame.
+  ///
+  /// * Optional parameters:
+  /// <resolution> Size of a cell in meters. Default is 1.
+  /// <obstacle_loss> Attenuation of each obstacle in dB. Default is 10.
+  /// <cache> Cache the map on disk. It may contain a <path> with the
+  ///         directory of the cache, which defaults to
+  ///         ~/.ignition/gazebo/occlusion_cache.
+  class IGNITION_GAZEBO_VISIBLE OcclusionMap : public PropagationModel
+  {
+    /// \brief Constructor.
+    public: OcclusionMap();
+
+    /// \brief Destructor.
+    public: ~OcclusionMap() override;
+
+    // Documentation inherited.
+    public: bool Load(std::shared_ptr<const sdf::Element> _sdf) override;
+
+    /// \brief Set the grid of the map.
+    /// \param[in] _region Region of the world covered by the map.
+    /// \param[in] _resolution Size of a cell in meters.
+    public: void SetGrid(const math::AxisAlignedBox &_region,
+                         double _resolution);
+
+    /// \brief Set the attenuation of each obstacle.
+    /// \param[in] _loss Attenuation in dB.
+    public: void SetObstacleLoss(double _loss);
+
+    /// \brief Set the directory where maps are cached.
+    /// \param[in] _path Directory, or empty to disable the cache.
+    public: void SetCachePath(const std::string &_path);
+
+    /// \brief Add an obstacle.
+    /// \param[in] _pose Pose of the center of the box in the world frame.
+    /// \param[in] _size Size of the box.
+    public: void AddBox(const math::Pose3d &_pose,
+                        const math::Vector3d &_size);
+
+    /// \brief Add the collisions of all the static models as obstacles.
+    /// \param[in] _ecm Entity component manager.
+    /// \return Number of obstacles added.
+    public: std::size_t AddStaticCollisions(
+                const EntityComponentManager &_ecm);
+
+    /// \brief Number of obstacles.
+    /// \return Number of obstacles.
+    public: std::size_t ObstacleCount() const;
+
+    /// \brief Ray cast all the pairs of cells, or load them from the cache.
+    /// \param[in] _ecm Entity component manager, used to ray cast in
+    /// parallel.
+    /// \return False if the grid is invalid or too large.
+    public: bool Build(const EntityComponentManager &_ecm);
+
+    /// \brief Whether the map was built.
+    /// \return True if the map can be queried.
+    public: bool Valid() const;
+
+    /// \brief Number of obstacles between two points, as found between the
+    /// centers of their cells.
+    /// \param[in] _from First point in the world frame.
+    /// \param[in] _to Second point in the world frame.
+    /// \return Number of obstacles, saturated at 255. Zero if the map
+    /// wasn't built.
+    public: unsigned int Obstacles(const math::Vector3d &_from,
+                                   const math::Vector3d &_to) const;
+
+    /// \brief Add the static collisions and build the map on the first
+    /// call.
+    /// \param[in] _info Current simulation information.
+    /// \param[in] _ecm Entity component manager.
+    public: void Update(const UpdateInfo &_info,
+                        const EntityComponentManager &_ecm) override;
+
+    // Documentation inherited.
+    public: double PathLoss(const math::Vector3d &_from,
+                            const math::Vector3d &_to) const override;
+
+    /// \brief Private data pointer.
+    IGN_UTILS_UNIQUE_IMPL_PTR(dataPtr)
+  };
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef IGNITION_GAZEBO_PROPAGATIONMODEL_HH_
+#define IGNITION_GAZEBO_PROPAGATIONMODEL_HH_
+
+#include <memory>
+
+#include <ignition/math/Vector3.hh>
+#include <sdf/Element.hh>
+#include "ignition/gazebo/config.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/Types.hh"
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace comms
+{
+  /// \brief Interface of the models of how the environment attenuates a
+  /// signal along its path, on top of the distance based path loss of a
+  /// comms model. Comms models which support it evaluate PathLoss for each
+  /// transmitter and receiver pair, possibly from several threads at once,
+  /// so it must be cheap and must not modify the model.
+  class PropagationModel
+  {
+    /// \brief Destructor.
+    public: virtual ~PropagationModel() = default;
+
+    /// \brief Configure the model via SDF.
+    /// \param[in] _sdf The SDF Element with the model parameters.
+    /// \return True if the configuration is valid.
+    public: virtual bool Load(std::shared_ptr<const sdf::Element> _sdf)
+    {
+      (void)_sdf;
+      return true;
+    }
+
+    /// \brief Bring the model up to date with the world. It's called once
+    /// per step before any PathLoss call of that step.
+    /// \param[in] _info Current simulation information.
+    /// \param[in] _ecm Entity component manager.
+    public: virtual void Update(const UpdateInfo &_info,
+                                const EntityComponentManager &_ecm)
+    {
+      (void)_info;
+      (void)_ecm;
+    }
+
+    /// \brief Attenuation of a signal between two points.
+    /// \param[in] _from Position of the transmitter in the world frame.
+    /// \param[in] _to Position of the receiver in the world frame.
+    /// \return Additional path loss in dB, infinite if the signal is
+    /// blocked.
+    public: virtual double PathLoss(const math::Vector3d &_from,
+                                    const math::Vector3d &_to) const = 0;
+  };
+}
+}
+}
+}
+
+#endif
@@ -18,12 +18,17 @@
 #define IGNITION_GAZEBO_COMPONENTS_COMPONENT_HH_
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <sstream>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <ignition/common/Console.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
 
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/Export.hh>
@@ -222,6 +227,219 @@ namespace serializers
       return _in;
     }
   };
+
+  /// \brief Binary serialization of component data straight into a buffer
+  /// provided by the caller, without streams. It's used for plain data
+  /// which is serialized often, such as poses, velocities and joint
+  /// positions, independently of the stream serializer of the component.
+  /// Data is written in the byte order of the host.
+  ///
+  /// Specializations implement three static functions:
+  /// \code
+  ///     static std::size_t Size(const DataType &_data);
+  ///     static void Write(char *_out, const DataType &_data);
+  ///     static bool Read(const char *_in, std::size_t _size,
+  ///                      DataType &_data);
+  /// \endcode
+  /// The primary template is for types without binary serialization.
+  /// \tparam DataType Type of the data.
+  template <typename DataType, typename Enable = void>
+  class BinarySerializer
+  {
+    /// \brief Whether DataType has a binary serialization.
+    public: static constexpr bool kSupported{false};
+  };
+
+  /// \brief Binary serialization of a fixed number of doubles, shared by the
+  /// math types.
+  /// \tparam N Number of doubles.
+  template <std::size_t N>
+  class DoublesBinarySerializer
+  {
+    /// \brief Whether the data has a binary serialization.
+    public: static constexpr bool kSupported{true};
+
+    /// \brief Write doubles.
+    /// \param[out] _out Buffer of at least N doubles.
+    /// \param[in] _values Values to write.
+    protected: static void WriteDoubles(char *_out, const double (&_values)[N])
+    {
+      std::memcpy(_out, _values, sizeof(_values));
+    }
+
+    /// \brief Read doubles.
+    /// \param[in] _in Buffer to read.
+    /// \param[in] _size Size of the buffer.
+    /// \param[out] _values Values read.
+    /// \return True if the buffer holds exactly N doubles.
+    protected: static bool ReadDoubles(const char *_in, std::size_t _size,
+        double (&_values)[N])
+    {
+      if (_size != sizeof(_values))
+        return false;
+      std::memcpy(_values, _in, sizeof(_values));
+      return true;
+    }
+  };
+
+  /// \brief Binary serialization of arithmetic types other than bool, whose
+  /// value representation isn't guaranteed.
+  template <typename DataType>
+  class BinarySerializer<DataType,
+      std::enable_if_t<std::is_arithmetic_v<DataType> &&
+      !std::is_same_v<DataType, bool>>>
+  {
+    /// \brief Whether DataType has a binary serialization.
+    public: static constexpr bool kSupported{true};
+
+    /// \brief Size of the serialization.
+    /// \return Size in bytes.
+    public: static std::size_t Size(const DataType &)
+    {
+      return sizeof(DataType);
+    }
+
+    /// \brief Serialize.
+    /// \param[out] _out Buffer of at least Size() bytes.
+    /// \param[in] _data Data to serialize.
+    public: static void Write(char *_out, const DataType &_data)
+    {
+      std::memcpy(_out, &_data, sizeof(DataType));
+    }
+
+    /// \brief Deserialize.
+    /// \param[in] _in Buffer to read.
+    /// \param[in] _size Size of the buffer.
+    /// \param[out] _data Data to populate.
+    /// \return False if the size doesn't match.
+    public: static bool Read(const char *_in, std::size_t _size,
+        DataType &_data)
+    {
+      if (_size != sizeof(DataType))
+        return false;
+      std::memcpy(&_data, _in, sizeof(DataType));
+      return true;
+    }
+  };
+
+  /// \brief Binary serialization of 3D vectors, as x, y and z.
+  template <>
+  class BinarySerializer<math::Vector3d> : public DoublesBinarySerializer<3>
+  {
+    /// \brief Size of the serialization.
+    /// \return Size in bytes.
+    public: static std::size_t Size(const math::Vector3d &)
+    {
+      return 3u * sizeof(double);
+    }
+
+    /// \brief Serialize.
+    /// \param[out] _out Buffer of at least Size() bytes.
+    /// \param[in] _data Data to serialize.
+    public: static void Write(char *_out, const math::Vector3d &_data)
+    {
+      const double values[3]{_data.X(), _data.Y(), _data.Z()};
+      WriteDoubles(_out, values);
+    }
+
+    /// \brief Deserialize.
+    /// \param[in] _in Buffer to read.
+    /// \param[in] _size Size of the buffer.
+    /// \param[out] _data Data to populate.
+    /// \return False if the size doesn't match.
+    public: static bool Read(const char *_in, std::size_t _size,
+        math::Vector3d &_data)
+    {
+      double values[3];
+      if (!ReadDoubles(_in, _size, values))
+        return false;
+      _data.Set(values[0], values[1], values[2]);
+      return true;
+    }
+  };
+
+  /// \brief Binary serialization of poses, as the x, y and z of the
+  /// position followed by the w, x, y and z of the orientation.
+  template <>
+  class BinarySerializer<math::Pose3d> : public DoublesBinarySerializer<7>
+  {
+    /// \brief Size of the serialization.
+    /// \return Size in bytes.
+    public: static std::size_t Size(const math::Pose3d &)
+    {
+      return 7u * sizeof(double);
+    }
+
+    /// \brief Serialize.
+    /// \param[out] _out Buffer of at least Size() bytes.
+    /// \param[in] _data Data to serialize.
+    public: static void Write(char *_out, const math::Pose3d &_data)
+    {
+      const auto &pos = _data.Pos();
+      const auto &rot = _data.Rot();
+      const double values[7]{pos.X(), pos.Y(), pos.Z(),
+          rot.W(), rot.X(), rot.Y(), rot.Z()};
+      WriteDoubles(_out, values);
+    }
+
+    /// \brief Deserialize.
+    /// \param[in] _in Buffer to read.
+    /// \param[in] _size Size of the buffer.
+    /// \param[out] _data Data to populate.
+    /// \return False if the size doesn't match.
+    public: static bool Read(const char *_in, std::size_t _size,
+        math::Pose3d &_data)
+    {
+      double values[7];
+      if (!ReadDoubles(_in, _size, values))
+        return false;
+      _data.Pos().Set(values[0], values[1], values[2]);
+      _data.Rot().Set(values[3], values[4], values[5], values[6]);
+      return true;
+    }
+  };
+
+  /// \brief Binary serialization of vectors of doubles, such as joint
+  /// positions. The number of values is implied by the size.
+  template <>
+  class BinarySerializer<std::vector<double>>
+  {
+    /// \brief Whether the data has a binary serialization.
+    public: static constexpr bool kSupported{true};
+
+    /// \brief Size of the serialization.
+    /// \param[in] _data Data to serialize.
+    /// \return Size in bytes.
+    public: static std::size_t Size(const std::vector<double> &_data)
+    {
+      return _data.size() * sizeof(double);
+    }
+
+    /// \brief Serialize.
+    /// \param[out] _out Buffer of at least Size() bytes.
+    /// \param[in] _data Data to serialize.
+    public: static void Write(char *_out, const std::vector<double> &_data)
+    {
+      if (!_data.empty())
+        std::memcpy(_out, _data.data(), _data.size() * sizeof(double));
+    }
+
+    /// \brief Deserialize.
+    /// \param[in] _in Buffer to read.
+    /// \param[in] _size Size of the buffer.
+    /// \param[out] _data Data to populate.
+    /// \return False if the size isn't a multiple of a double.
+    public: static bool Read(const char *_in, std::size_t _size,
+        std::vector<double> &_data)
+    {
+      if (_size % sizeof(double) != 0u)
+        return false;
+      _data.resize(_size / sizeof(double));
+      if (!_data.empty())
+        std::memcpy(_data.data(), _in, _size);
+      return true;
+    }
+  };
 }
 
 namespace components
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_COMPONENTS_CONTACTPOINTS_HH_
+#define IGNITION_GAZEBO_COMPONENTS_CONTACTPOINTS_HH_
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/components/Factory.hh>
+#include <ignition/gazebo/components/Component.hh>
+#include <ignition/gazebo/config.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace contact
+{
+  /// \brief A single point of contact between two collisions, as reported
+  /// by the physics engine.
+  struct ContactPoint
+  {
+    /// \brief The collision which owns the component.
+    Entity collision1{kNullEntity};
+
+    /// \brief The collision it's in contact with.
+    Entity collision2{kNullEntity};
+
+    /// \brief Position of the contact in world coordinates.
+    math::Vector3d position;
+
+    /// \brief Contact normal in world coordinates, pointing from collision1
+    /// to collision2. Zero if the engine doesn't provide it.
+    math::Vector3d normal;
+
+    /// \brief Penetration depth. Zero if the engine doesn't provide it.
+    double depth{0.0};
+
+    /// \brief Equality operator.
+    /// \param[in] _point Point to compare to.
+    /// \return True if all fields are equal.
+    public: bool operator==(const ContactPoint &_point) const
+    {
+      return this->collision1 == _point.collision1 &&
+          this->collision2 == _point.collision2 &&
+          this->position == _point.position &&
+          this->normal == _point.normal &&
+          math::equal(this->depth, _point.depth);
+    }
+
+    /// \brief Inequality operator.
+    /// \param[in] _point Point to compare to.
+    /// \return True if any field is different.
+    public: bool operator!=(const ContactPoint &_point) const
+    {
+      return !(*this == _point);
+    }
+  };
+}
+
+namespace serializers
+{
+  /// \brief Serializer for components::ContactPoints object
+  class ContactPointsSerializer
+  {
+    /// \brief Serialization for a list of contact::ContactPoint
+    /// \param[out] _out Output stream
+    /// \param[in] _points Object for the stream
+    /// \return The stream
+    public: static std::ostream &Serialize(std::ostream &_out,
+                const std::vector<contact::ContactPoint> &_points)
+    {
+      _out << _points.size();
+      for (const auto &point : _points)
+      {
+        _out << " " << point.collision1 << " " << point.collision2
+             << " " << point.position << " " << point.normal
+             << " " << point.depth;
+      }
+      return _out;
+    }
+
+    /// \brief Deserialization for a list of contact::ContactPoint
+    /// \param[in] _in Input stream
+    /// \param[out] _points The object to populate
+    /// \return The stream
+    public: static std::istream &Deserialize(std::istream &_in,
+                std::vector<contact::ContactPoint> &_points)
+    {
+      std::size_t count{0u};
+      _in >> count;
+      _points.resize(count);
+      for (auto &point : _points)
+      {
+        _in >> point.collision1 >> point.collision2 >> point.position
+            >> point.normal >> point.depth;
+      }
+      return _in;
+    }
+  };
+}
+
+namespace components
+{
+  /// \brief A component with the contacts of a collision from the latest
+  /// physics step, stored contiguously. This is a lighter alternative to
+  /// ContactSensorData, which is filled by the physics system without
+  /// creating any messages. Contacts with the same collision2 are adjacent.
+  using ContactPoints = Component<std::vector<contact::ContactPoint>,
+      class ContactPointsTag, serializers::ContactPointsSerializer>;
+  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.ContactPoints",
+                                ContactPoints)
+}
+}
+}
+}
+
+#endif
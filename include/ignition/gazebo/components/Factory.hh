@@ -17,12 +17,19 @@
 #ifndef IGNITION_GAZEBO_COMPONENTS_FACTORY_HH_
 #define IGNITION_GAZEBO_COMPONENTS_FACTORY_HH_
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <deque>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
+#include <new>
+#include <sstream>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -80,6 +87,146 @@ namespace components
     }
   };
 
+  /// \brief How to construct components of a type in memory owned by
+  /// someone else, such as a pool keeping components of the same type next
+  /// to each other. This isn't part of ComponentDescriptorBase so that
+  /// descriptors built against earlier versions keep working: the factory
+  /// fills it when registering a ComponentDescriptor, and types without it
+  /// are created on the heap through their descriptor.
+  struct ComponentPlacement
+  {
+    /// \brief Make the placement of a component type.
+    /// \tparam ComponentTypeT Type of component.
+    /// \return The placement.
+    template <typename ComponentTypeT>
+    static ComponentPlacement Of()
+    {
+      return ComponentPlacement{sizeof(ComponentTypeT),
+          alignof(ComponentTypeT), &ComponentPlacement::Construct<
+          ComponentTypeT>};
+    }
+
+    /// \brief Construct a component in memory provided by the caller.
+    /// \param[in] _memory Uninitialized memory of at least size bytes,
+    /// aligned to alignment.
+    /// \param[in] _data The data to populate the component with. If null,
+    /// the component is default constructed.
+    /// \return Pointer to the component.
+    template <typename ComponentTypeT>
+    static BaseComponent *Construct(void *_memory,
+        const components::BaseComponent *_data)
+    {
+      if (nullptr == _data)
+        return new (_memory) ComponentTypeT();
+
+      return new (_memory) ComponentTypeT(
+          *static_cast<const ComponentTypeT *>(_data));
+    }
+
+    /// \brief Size of the component type in bytes.
+    std::size_t size{0u};
+
+    /// \brief Alignment of the component type.
+    std::size_t alignment{alignof(std::max_align_t)};
+
+    /// \brief Function constructing a component in caller-owned memory.
+    /// The caller is responsible for calling the destructor and releasing
+    /// the memory.
+    BaseComponent *(*construct)(void *, const components::BaseComponent *){
+        nullptr};
+  };
+
+  /// \brief How to serialize the data of components of a type straight into
+  /// a buffer, without streams, see serializers::BinarySerializer. Like
+  /// ComponentPlacement, the factory keeps it for each type instead of
+  /// BaseComponent having virtual functions for it, so that the layout of
+  /// components is unchanged. Its functions are null for types without a
+  /// binary serialization.
+  struct ComponentBinarySerialization
+  {
+    /// \brief Make the binary serialization of a component type.
+    /// \tparam ComponentTypeT Type of component.
+    /// \return The binary serialization, empty if the type's data doesn't
+    /// have one.
+    template <typename ComponentTypeT>
+    static ComponentBinarySerialization Of()
+    {
+      if constexpr (Supported<ComponentTypeT>(0))
+      {
+        return ComponentBinarySerialization{
+            &ComponentBinarySerialization::Size<ComponentTypeT>,
+            &ComponentBinarySerialization::Write<ComponentTypeT>,
+            &ComponentBinarySerialization::Read<ComponentTypeT>};
+      }
+      else
+      {
+        return ComponentBinarySerialization();
+      }
+    }
+
+    /// \brief Whether the data of a component type has a binary
+    /// serialization.
+    /// \return True if supported.
+    template <typename ComponentTypeT>
+    static constexpr bool Supported(int,
+        const typename ComponentTypeT::Type * = nullptr)
+    {
+      return serializers::BinarySerializer<
+          typename ComponentTypeT::Type>::kSupported;
+    }
+
+    /// \brief Overload for component types without data.
+    /// \return False.
+    template <typename ComponentTypeT>
+    static constexpr bool Supported(...)
+    {
+      return false;
+    }
+
+    /// \brief Size of the binary serialization of a component.
+    /// \param[in] _comp Component of type ComponentTypeT.
+    /// \return Size in bytes.
+    template <typename ComponentTypeT>
+    static std::size_t Size(const BaseComponent &_comp)
+    {
+      return serializers::BinarySerializer<typename ComponentTypeT::Type>::
+          Size(static_cast<const ComponentTypeT &>(_comp).Data());
+    }
+
+    /// \brief Write the binary serialization of a component.
+    /// \param[in] _comp Component of type ComponentTypeT.
+    /// \param[out] _out Buffer of at least Size(_comp) bytes.
+    template <typename ComponentTypeT>
+    static void Write(const BaseComponent &_comp, char *_out)
+    {
+      serializers::BinarySerializer<typename ComponentTypeT::Type>::Write(
+          _out, static_cast<const ComponentTypeT &>(_comp).Data());
+    }
+
+    /// \brief Fill a component from its binary serialization.
+    /// \param[in] _comp Component of type ComponentTypeT.
+    /// \param[in] _in Buffer written by Write.
+    /// \param[in] _size Size of the buffer.
+    /// \return False if the buffer doesn't hold valid data, in which case
+    /// the component is unchanged.
+    template <typename ComponentTypeT>
+    static bool Read(BaseComponent &_comp, const char *_in,
+        std::size_t _size)
+    {
+      return serializers::BinarySerializer<typename ComponentTypeT::Type>::
+          Read(_in, _size, static_cast<ComponentTypeT &>(_comp).Data());
+    }
+
+    /// \brief Function returning the size of a component's serialization.
+    std::size_t (*size)(const BaseComponent &){nullptr};
+
+    /// \brief Function serializing a component.
+    void (*write)(const BaseComponent &, char *){nullptr};
+
+    /// \brief Function deserializing a component.
+    bool (*read)(BaseComponent &, const char *, std::size_t){nullptr};
+  };
+
   /// \brief A base class for an object responsible for creating storages.
   class StorageDescriptorBase
   {
@@ -219,6 +366,17 @@ namespace components
       return {};
     }
 
+    /// \brief Get the latest available component descriptor.
+    /// \return The descriptor, or nullptr if the queue is empty.
+    public: IGNITION_GAZEBO_HIDDEN ComponentDescriptorBase *Front() const
+    {
+      if (!this->queue.empty())
+      {
+        return this->queue.front().second;
+      }
+      return nullptr;
+    }
+
     /// \brief Queue of component descriptors registered by static registration
     /// objects.
     private: std::deque<std::pair<RegistrationObjectId,
@@ -322,7 +480,38 @@ namespace components
       }
 
       // Keep track of all types
-      this->compsById[ComponentTypeT::typeId].Add(_regObjId, _compDesc);
+      auto &queue = this->compsById[ComponentTypeT::typeId];
+      queue.Add(_regObjId, _compDesc);
+
+      // Types keep their index if they're registered again after being
+      // unregistered
+      auto indexIt = this->typeIndices.find(ComponentTypeT::typeId);
+      if (indexIt == this->typeIndices.end())
+      {
+        indexIt = this->typeIndices.emplace(ComponentTypeT::typeId,
+            this->descriptorTable.size()).first;
+        this->descriptorTable.push_back(nullptr);
+      }
+      this->descriptorTable[indexIt->second] = &queue;
+
+      // Only descriptors which create ComponentTypeT itself can be used to
+      // construct it in place or to access its data. Others get empty
+      // operations, so that the operations always follow the latest
+      // descriptor.
+      if (this->operationsTable.size() < this->descriptorTable.size())
+        this->operationsTable.resize(this->descriptorTable.size());
+      TypeOperations operations;
+      if (nullptr !=
+          dynamic_cast<ComponentDescriptor<ComponentTypeT> *>(_compDesc))
+      {
+        operations.placement = ComponentPlacement::Of<ComponentTypeT>();
+        operations.binary =
+            ComponentBinarySerialization::Of<ComponentTypeT>();
+        if constexpr (std::is_move_assignable_v<ComponentTypeT>)
+          operations.move = &Factory::MoveComponent<ComponentTypeT>;
+      }
+      this->operationsTable[indexIt->second].push_front(
+          {_regObjId, operations});
       namesById[ComponentTypeT::typeId] = ComponentTypeT::typeName;
       runtimeNamesById[ComponentTypeT::typeId] = runtimeName;
     }
@@ -378,8 +567,22 @@ namespace components
       {
         it->second.Remove(_regObjId);
 
+        auto indexIt = this->typeIndices.find(_typeId);
+        if (indexIt != this->typeIndices.end() &&
+            indexIt->second < this->operationsTable.size())
+        {
+          auto &operations = this->operationsTable[indexIt->second];
+          auto operationsIt = std::find_if(operations.rbegin(),
+              operations.rend(), [&](const auto &_item)
+              { return _item.first == _regObjId; });
+          if (operationsIt != operations.rend())
+            operations.erase(std::prev(operationsIt.base()));
+        }
+
         if (it->second.Empty())
         {
+          if (indexIt != this->typeIndices.end())
+            this->descriptorTable[indexIt->second] = nullptr;
           this->compsById.erase(it);
         }
       }
@@ -446,6 +649,149 @@ namespace components
       return comp;
     }
 
+    /// \brief Get the size in bytes of a component type, so that memory can
+    /// be reserved for it ahead of calling Construct.
+    /// \param[in] _type Component id.
+    /// \return Size of the component, or zero if the type is unknown or
+    /// has no placement.
+    public: std::size_t ComponentSize(const ComponentTypeId &_type) const
+    {
+      auto placement = this->Placement(this->TypeIndex(_type));
+      if (nullptr != placement)
+        return placement->size;
+      return 0u;
+    }
+
+    /// \brief Get the alignment of a component type.
+    /// \param[in] _type Component id.
+    /// \return Alignment of the component.
+    public: std::size_t ComponentAlignment(const ComponentTypeId &_type) const
+    {
+      auto placement = this->Placement(this->TypeIndex(_type));
+      if (nullptr != placement)
+        return placement->alignment;
+      return alignof(std::max_align_t);
+    }
+
+    /// \brief Construct a component in memory owned by the caller. This is
+    /// used to keep components of the same type next to each other in memory.
+    /// The caller is responsible for calling the component's destructor and
+    /// for releasing the memory.
+    /// \param[in] _type Component id to create.
+    /// \param[in] _memory Uninitialized memory of at least
+    /// ComponentSize(_type) bytes, aligned to ComponentAlignment(_type).
+    /// \param[in] _data The data to populate the component instance with.
+    /// Null to default-construct the component.
+    /// \return Pointer to the component. Null if the component type could not
+    /// be handled or has no placement.
+    public: components::BaseComponent *Construct(const ComponentTypeId &_type,
+        void *_memory, const components::BaseComponent *_data = nullptr)
+    {
+      if (nullptr == _memory)
+        return nullptr;
+
+      if (nullptr != _data && _type != _data->TypeId())
+      {
+        ignerr << "The typeID of _type [" << _type << "] does not match the "
+          << "typeID of _data [" << _data->TypeId() << "]." << std::endl;
+        return nullptr;
+      }
+
+      auto placement = this->Placement(this->TypeIndex(_type));
+      if (nullptr != placement)
+        return placement->construct(_memory, _data);
+      return nullptr;
+    }
+
+    /// \brief Get a compact index of a component type. Indices are dense
+    /// and assigned in registration order, and a type keeps its index if
+    /// it's unregistered and registered again. Resolving a type's index
+    /// once lets its descriptor be looked up without a map afterwards.
+    /// \param[in] _type Component id.
+    /// \return Index of the type, or kInvalidTypeIndex if it was never
+    /// registered.
+    /// \sa Descriptor
+    public: std::size_t TypeIndex(const ComponentTypeId &_type) const
+    {
+      auto it = this->typeIndices.find(_type);
+      if (it != this->typeIndices.end())
+        return it->second;
+      return kInvalidTypeIndex;
+    }
+
+    /// \brief Get the latest component descriptor of a type from its index.
+    /// This is a vector access, so it can be used for every component
+    /// created. The descriptor must not be kept, since it's deleted when the
+    /// library which registered it is unloaded.
+    /// \param[in] _typeIndex Index returned by TypeIndex.
+    /// \return The descriptor, or nullptr if the type isn't currently
+    /// registered.
+    public: const ComponentDescriptorBase *Descriptor(
+        std::size_t _typeIndex) const
+    {
+      if (_typeIndex >= this->descriptorTable.size() ||
+          nullptr == this->descriptorTable[_typeIndex])
+      {
+        return nullptr;
+      }
+      return this->descriptorTable[_typeIndex]->Front();
+    }
+
+    /// \brief Get how to construct components of a type in caller-owned
+    /// memory, from the type's index. Like Descriptor, the result must not
+    /// be kept.
+    /// \param[in] _typeIndex Index returned by TypeIndex.
+    /// \return The placement, or nullptr if the type isn't currently
+    /// registered, or its latest descriptor isn't a ComponentDescriptor of
+    /// the type. Such types are created on the heap.
+    public: const ComponentPlacement *Placement(std::size_t _typeIndex) const
+    {
+      auto operations = this->Operations(_typeIndex);
+      if (nullptr == operations || nullptr == operations->placement.construct)
+        return nullptr;
+      return &operations->placement;
+    }
+
+    /// \brief Get how to serialize components of a type in binary form.
+    /// Like Descriptor, the result must not be kept.
+    /// \param[in] _type Component id.
+    /// \return The binary serialization, or nullptr if the type isn't
+    /// currently registered, has no binary serialization, or its latest
+    /// descriptor isn't a ComponentDescriptor of the type.
+    public: const ComponentBinarySerialization *BinarySerialization(
+        const ComponentTypeId &_type) const
+    {
+      auto operations = this->Operations(this->TypeIndex(_type));
+      if (nullptr == operations || nullptr == operations->binary.write)
+        return nullptr;
+      return &operations->binary;
+    }
+
+    /// \brief Move the data of a component into another component of the
+    /// same type, such as when a component is replaced by a staged copy.
+    /// Types registered with a ComponentDescriptor of the type itself are
+    /// move assigned, others are serialized and deserialized.
+    /// \param[in, out] _to Component receiving the data.
+    /// \param[in, out] _from Component of the same type. Its data is left
+    /// valid but unspecified.
+    public: void MoveData(BaseComponent &_to, BaseComponent &_from) const
+    {
+      auto operations = this->Operations(this->TypeIndex(_to.TypeId()));
+      if (nullptr != operations && nullptr != operations->move)
+      {
+        operations->move(_to, _from);
+        return;
+      }
+
+      std::stringstream stream;
+      _from.Serialize(stream);
+      _to.Deserialize(stream);
+    }
+
+    /// \brief Value returned by TypeIndex for unknown component types.
+    public: static constexpr std::size_t kInvalidTypeIndex{
+        std::numeric_limits<std::size_t>::max()};
+
     /// \brief Create a new instance of a component storage.
     /// \param[in] _typeId Type of component which the storage will hold.
     /// \return Always returns nullptr.
@@ -496,8 +842,140 @@ namespace components
     /// they try to register different types with the same typeName.
     public: std::map<ComponentTypeId, std::string>
         runtimeNamesById;
+
+    /// \brief Compact index of each type ever registered.
+    private: std::map<ComponentTypeId, std::size_t> typeIndices;
+
+    /// \brief Descriptor queues indexed by type index, pointing into
+    /// compsById. Null for types which are currently unregistered.
+    private: std::vector<ComponentDescriptorQueue *> descriptorTable;
+
+    /// \brief Non-virtual operations on components of a type, which the
+    /// factory keeps along with each of the type's descriptors.
+    private: struct TypeOperations
+    {
+      /// \brief How to construct components in place.
+      ComponentPlacement placement;
+
+      /// \brief How to serialize components in binary form.
+      ComponentBinarySerialization binary;
+
+      /// \brief Function moving the data of the second component into the
+      /// first, see MoveData. Null if the type can't be move assigned.
+      void (*move)(BaseComponent &, BaseComponent &){nullptr};
+    };
+
+    /// \brief Move assign a component from another of the same type.
+    /// \param[in, out] _to Component of type ComponentTypeT.
+    /// \param[in, out] _from Component of type ComponentTypeT.
+    private: template <typename ComponentTypeT>
+    static void MoveComponent(BaseComponent &_to, BaseComponent &_from)
+    {
+      static_cast<ComponentTypeT &>(_to) =
+          std::move(static_cast<ComponentTypeT &>(_from));
+    }
+
+    /// \brief Get the operations of the latest descriptor of a type.
+    /// \param[in] _typeIndex Index returned by TypeIndex.
+    /// \return The operations, or nullptr if the type isn't currently
+    /// registered.
+    private: const TypeOperations *Operations(std::size_t _typeIndex) const
+    {
+      if (_typeIndex >= this->operationsTable.size() ||
+          this->operationsTable[_typeIndex].empty())
+      {
+        return nullptr;
+      }
+      return &this->operationsTable[_typeIndex].front().second;
+    }
+
+    /// \brief Operations of each type by type index, in the same order as
+    /// the type's descriptor queue, along with the registration which added
+    /// them.
+    private: std::vector<std::deque<std::pair<RegistrationObjectId,
+                 TypeOperations>>> operationsTable;
   };
 
+  /// \brief Bytes which start serialized component data holding the binary
+  /// serialization of the component instead of its stream serialization.
+  /// The first byte is zero, which neither a serialized protobuf message
+  /// nor a number written as text starts with.
+  constexpr char kBinaryDataPrefix[]{'\0', 'B', 'I', 'N'};
+
+  /// \brief Size of kBinaryDataPrefix.
+  constexpr std::size_t kBinaryDataPrefixSize{sizeof(kBinaryDataPrefix)};
+
+  /// \brief Serialize a component in its binary form, preceded by
+  /// kBinaryDataPrefix, into a string. The string is overwritten but keeps
+  /// its capacity.
+  /// \param[in] _binary Binary serialization of the component's type.
+  /// \param[in] _comp Component to serialize.
+  /// \param[out] _out String to hold the serialized data.
+  inline void SerializeBinaryData(const ComponentBinarySerialization &_binary,
+      const BaseComponent &_comp, std::string &_out)
+  {
+    _out.resize(kBinaryDataPrefixSize + _binary.size(_comp));
+    std::memcpy(_out.data(), kBinaryDataPrefix, kBinaryDataPrefixSize);
+    _binary.write(_comp, _out.data() + kBinaryDataPrefixSize);
+  }
+
+  /// \brief Serialize a component in its binary form, preceded by
+  /// kBinaryDataPrefix, into a string, using the binary serialization
+  /// registered for its type.
+  /// \param[in] _comp Component to serialize.
+  /// \param[out] _out String to hold the serialized data.
+  /// \return False if the component's type has no binary serialization, in
+  /// which case the string is unchanged.
+  inline bool SerializeBinaryData(const BaseComponent &_comp,
+      std::string &_out)
+  {
+    auto binary = Factory::Instance()->BinarySerialization(_comp.TypeId());
+    if (nullptr == binary)
+      return false;
+    SerializeBinaryData(*binary, _comp, _out);
+    return true;
+  }
+
+  /// \brief Deserialize component data written by SerializeBinaryData.
+  /// Serialized states may hold component data in either form, so callers
+  /// deserialize from a stream when this returns false.
+  /// \param[in] _binary Binary serialization of the component's type.
+  /// \param[in] _comp Component to fill.
+  /// \param[in] _data Serialized data.
+  /// \return True if _data was in binary form and was read.
+  inline bool DeserializeBinaryData(
+      const ComponentBinarySerialization &_binary, BaseComponent &_comp,
+      const std::string &_data)
+  {
+    if (nullptr == _binary.read || _data.size() < kBinaryDataPrefixSize ||
+        std::memcmp(_data.data(), kBinaryDataPrefix,
+        kBinaryDataPrefixSize) != 0)
+    {
+      return false;
+    }
+    return _binary.read(_comp, _data.data() + kBinaryDataPrefixSize,
+        _data.size() - kBinaryDataPrefixSize);
+  }
+
+  /// \brief Deserialize component data written by SerializeBinaryData,
+  /// using the binary serialization registered for the component's type.
+  /// \param[in] _comp Component to fill.
+  /// \param[in] _data Serialized data.
+  /// \return True if _data was in binary form and was read.
+  inline bool DeserializeBinaryData(BaseComponent &_comp,
+      const std::string &_data)
+  {
+    // Checked first, so stream serialized data doesn't need a lookup
+    if (_data.size() < kBinaryDataPrefixSize ||
+        std::memcmp(_data.data(), kBinaryDataPrefix,
+        kBinaryDataPrefixSize) != 0)
+    {
+      return false;
+    }
+    auto binary = Factory::Instance()->BinarySerialization(_comp.TypeId());
+    return nullptr != binary && DeserializeBinaryData(*binary, _comp, _data);
+  }
+
   /// \brief Static component registration macro.
   ///
   /// Use this macro to register components.
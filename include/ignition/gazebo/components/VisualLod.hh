@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_COMPONENTS_VISUALLOD_HH_
+#define IGNITION_GAZEBO_COMPONENTS_VISUALLOD_HH_
+
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <ignition/math/Helpers.hh>
+
+#include <ignition/gazebo/components/Factory.hh>
+#include <ignition/gazebo/components/Component.hh>
+#include <ignition/gazebo/config.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace lod
+{
+  /// \brief A level of detail of a visual, which replaces the visual's
+  /// geometry when the visual is far enough from all cameras.
+  struct Level
+  {
+    /// \brief Distance to the nearest camera from which this level is used,
+    /// in meters.
+    double distance{0.0};
+
+    /// \brief Full path to the mesh rendered at this level. If empty, the
+    /// visual isn't rendered at all from this distance.
+    std::string mesh;
+
+    /// \brief Equality operator.
+    /// \param[in] _level Level to compare to.
+    /// \return True if all fields are equal.
+    public: bool operator==(const Level &_level) const
+    {
+      return math::equal(this->distance, _level.distance) &&
+          this->mesh == _level.mesh;
+    }
+
+    /// \brief Inequality operator.
+    /// \param[in] _level Level to compare to.
+    /// \return True if any field is different.
+    public: bool operator!=(const Level &_level) const
+    {
+      return !(*this == _level);
+    }
+  };
+}
+
+namespace serializers
+{
+  /// \brief Serializer for components::VisualLod object
+  class VisualLodSerializer
+  {
+    /// \brief Serialization for a list of lod::Level
+    /// \param[out] _out Output stream
+    /// \param[in] _levels Object for the stream
+    /// \return The stream
+    public: static std::ostream &Serialize(std::ostream &_out,
+                const std::vector<lod::Level> &_levels)
+    {
+      _out << _levels.size();
+      for (const auto &level : _levels)
+        _out << " " << level.distance << " " << std::quoted(level.mesh);
+      return _out;
+    }
+
+    /// \brief Deserialization for a list of lod::Level
+    /// \param[in] _in Input stream
+    /// \param[out] _levels The object to populate
+    /// \return The stream
+    public: static std::istream &Deserialize(std::istream &_in,
+                std::vector<lod::Level> &_levels)
+    {
+      std::size_t count{0u};
+      _in >> count;
+      _levels.resize(count);
+      for (auto &level : _levels)
+        _in >> level.distance >> std::quoted(level.mesh);
+      return _in;
+    }
+  };
+}
+
+namespace components
+{
+  /// \brief Levels of detail of a visual, sorted by increasing distance.
+  /// The visual's own geometry is used closer than the first level.
+  ///
+  /// In SDF, levels go inside the visual's `ignition::gazebo` plugin, the
+  /// same way levels are given for worlds. A level without a mesh hides the
+  /// visual:
+  ///
+  /// ```
+  /// <plugin name="ignition::gazebo" filename="dummy">
+  ///   <lod>
+  ///     <level>
+  ///       <distance>30</distance>
+  ///       <mesh>meshes/tree_low.dae</mesh>
+  ///     </level>
+  ///     <level>
+  ///       <distance>200</distance>
+  ///     </level>
+  ///   </lod>
+  /// </plugin>
+  /// ```
+  using VisualLod = Component<std::vector<lod::Level>, class VisualLodTag,
+      serializers::VisualLodSerializer>;
+  IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.VisualLod", VisualLod)
+}
+}
+}
+}
+
+#endif
@@ -17,7 +17,11 @@
 #ifndef IGNITION_GAZEBO_DETAIL_BASEVIEW_HH_
 #define IGNITION_GAZEBO_DETAIL_BASEVIEW_HH_
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 #include <vector>
@@ -37,6 +41,19 @@ namespace detail
 /// \brief A key into the map of views
 using ComponentTypeKey = std::vector<ComponentTypeId>;
 
+/// \brief Estimate the heap memory held by an unordered container: its
+/// bucket array, plus one node per element holding the element and a link.
+/// Memory owned by the elements themselves isn't counted.
+/// \param[in] _container Unordered map or set.
+/// \return Estimate in bytes.
+template <typename ContainerT>
+std::size_t unorderedMemoryUsage(const ContainerT &_container)
+{
+  return _container.bucket_count() * sizeof(void *) +
+      _container.size() *
+      (sizeof(typename ContainerT::value_type) + 2u * sizeof(void *));
+}
+
 /// \brief Hash functor for ComponentTypeKey.
 /// The implementation was inspired by:
 /// * https://stackoverflow.com/a/20511429
@@ -54,6 +71,382 @@ struct ComponentTypeHasher
   }
 };
 
+/// \brief A set of entities stored as a sparse set: the entities live in a
+/// dense, contiguous array, and an index maps each entity to its position in
+/// that array. Insertion and removal are O(1) and iteration is a linear walk
+/// over contiguous memory.
+///
+/// Removing an entity moves the last entity into the freed position, so the
+/// elements may stop being ordered. Call sort() to restore ascending order;
+/// this is a no-op if the set is already ordered.
+///
+/// The interface mirrors the subset of std::set that views need, so that it
+/// can be used as a drop-in replacement. Iterating with begin() and end()
+/// doesn't allow changing the set. Use forEach, or hold an Iteration, to
+/// visit entities while callbacks may insert or erase some.
+class EntitySet
+{
+  /// \brief Iterator over the entities in the set.
+  public: using const_iterator = std::vector<Entity>::const_iterator;
+
+  /// \brief While an Iteration of a set exists, erased entities leave a
+  /// kNullEntity hole instead of being replaced by the last entity, and
+  /// sort() does nothing, so entities don't move. Holes are removed by the
+  /// next change made once no Iteration is left. Iterations may be created
+  /// from several threads at once.
+  public: class Iteration
+  {
+    /// \brief Constructor
+    /// \param[in] _set Set being iterated over.
+    public: explicit Iteration(const EntitySet &_set)
+        : set(_set)
+    {
+      ++this->set.iterations;
+    }
+
+    /// \brief Destructor
+    public: ~Iteration()
+    {
+      --this->set.iterations;
+    }
+
+    /// \brief Not copyable, each Iteration is counted once.
+    public: Iteration(const Iteration &) = delete;
+
+    /// \brief Not assignable.
+    public: Iteration &operator=(const Iteration &) = delete;
+
+    /// \brief Set being iterated over.
+    private: const EntitySet &set;
+  };
+
+  /// \brief Add an entity to the set.
+  /// \param[in] _entity Entity to add.
+  /// \return True if the entity was added, false if it was already present.
+  public: bool insert(const Entity _entity)
+  {
+    this->Compact();
+    if (!this->index.emplace(_entity, this->dense.size()).second)
+      return false;
+
+    // The last slot may be a hole, so don't rely on it while there are any
+    if (!this->dense.empty() &&
+        (this->holes > 0u || _entity < this->dense.back()))
+    {
+      this->isSorted = false;
+    }
+    this->dense.push_back(_entity);
+    ++this->changes;
+    return true;
+  }
+
+  /// \brief Remove an entity from the set.
+  /// \param[in] _entity Entity to remove.
+  /// \return Number of entities removed, either 0 or 1.
+  public: std::size_t erase(const Entity _entity)
+  {
+    this->Compact();
+    auto it = this->index.find(_entity);
+    if (it == this->index.end())
+      return 0u;
+
+    const auto pos = it->second;
+    this->index.erase(it);
+    ++this->changes;
+
+    if (this->iterations > 0u)
+    {
+      this->dense[pos] = kNullEntity;
+      ++this->holes;
+      return 1u;
+    }
+
+    const auto last = this->dense.size() - 1u;
+    if (pos != last)
+    {
+      this->dense[pos] = this->dense[last];
+      this->index[this->dense[pos]] = pos;
+      this->isSorted = false;
+    }
+    this->dense.pop_back();
+    return 1u;
+  }
+
+  /// \brief Find an entity in the set.
+  /// \param[in] _entity Entity to find.
+  /// \return Iterator to the entity, or end() if it's not in the set.
+  public: const_iterator find(const Entity _entity) const
+  {
+    auto it = this->index.find(_entity);
+    if (it == this->index.end())
+      return this->dense.end();
+    return this->dense.begin() + it->second;
+  }
+
+  /// \brief Check if an entity is in the set.
+  /// \param[in] _entity Entity to check.
+  /// \return 1 if the entity is in the set, 0 otherwise.
+  public: std::size_t count(const Entity _entity) const
+  {
+    return this->index.count(_entity);
+  }
+
+  /// \brief Number of entities in the set.
+  /// \return Size of the set.
+  public: std::size_t size() const
+  {
+    return this->dense.size() - this->holes;
+  }
+
+  /// \brief Whether the set is empty.
+  /// \return True if there are no entities in the set.
+  public: bool empty() const
+  {
+    return this->size() == 0u;
+  }
+
+  /// \brief Remove all entities from the set.
+  public: void clear()
+  {
+    this->dense.clear();
+    this->index.clear();
+    this->holes = 0u;
+    this->isSorted = true;
+    ++this->changes;
+  }
+
+  /// \brief Reserve memory for a number of entities.
+  /// \param[in] _count Number of entities.
+  public: void reserve(const std::size_t _count)
+  {
+    this->dense.reserve(_count);
+    this->index.reserve(_count);
+  }
+
+  /// \brief Iterator to the first entity. The range may hold kNullEntity
+  /// holes while an Iteration exists.
+  /// \return Begin iterator.
+  public: const_iterator begin() const
+  {
+    return this->dense.begin();
+  }
+
+  /// \brief Iterator past the last entity.
+  /// \return End iterator.
+  public: const_iterator end() const
+  {
+    return this->dense.end();
+  }
+
+  /// \brief Number of slots of the dense array, including holes. Along
+  /// with Slot, lets an Iteration walk the set by position, which stays
+  /// valid when inserting reallocates the array.
+  /// \return Number of slots.
+  public: std::size_t SlotCount() const
+  {
+    return this->dense.size();
+  }
+
+  /// \brief Entity in a slot of the dense array.
+  /// \param[in] _slot Slot, less than SlotCount().
+  /// \return The entity, or kNullEntity for a hole.
+  public: Entity Slot(const std::size_t _slot) const
+  {
+    return this->dense[_slot];
+  }
+
+  /// \brief Call a function on each entity, in order, until it returns
+  /// false. The function may insert and erase entities: erased entities
+  /// which weren't visited yet are skipped, and inserted entities are
+  /// visited after the others.
+  /// \param[in] _f Function taking an entity and returning whether to
+  /// continue.
+  public: template <typename FunctionT>
+          void forEach(FunctionT &&_f) const
+  {
+    Iteration iteration(*this);
+    for (std::size_t i = 0u; i < this->dense.size(); ++i)
+    {
+      const Entity entity = this->dense[i];
+      if (entity != kNullEntity && !_f(entity))
+        break;
+    }
+  }
+
+  /// \brief Whether the entities are in ascending order.
+  /// \return True if iteration yields entities in ascending order.
+  public: bool sorted() const
+  {
+    return this->isSorted;
+  }
+
+  /// \brief Estimate the heap memory held by the set.
+  /// \return Estimate in bytes.
+  public: std::size_t memoryUsage() const
+  {
+    return this->dense.capacity() * sizeof(Entity) +
+        unorderedMemoryUsage(this->index);
+  }
+
+  /// \brief Put the entities back in ascending order, if needed. Does
+  /// nothing while an Iteration exists.
+  public: void sort()
+  {
+    this->Compact();
+    if (this->isSorted || this->iterations > 0u)
+      return;
+
+    std::sort(this->dense.begin(), this->dense.end());
+    for (std::size_t i = 0; i < this->dense.size(); ++i)
+      this->index[this->dense[i]] = i;
+    this->isSorted = true;
+    ++this->changes;
+  }
+
+  /// \brief Number of changes to the contents or order of the set, so
+  /// copies of it can tell when they're out of date.
+  /// \return Count of changes.
+  public: uint64_t version() const
+  {
+    return this->changes;
+  }
+
+  /// \brief Remove the holes left by erasing while iterating, once no
+  /// Iteration is left. Keeps the order of the remaining entities.
+  private: void Compact()
+  {
+    if (this->holes == 0u || this->iterations > 0u)
+      return;
+
+    this->dense.erase(std::remove(this->dense.begin(), this->dense.end(),
+        kNullEntity), this->dense.end());
+    for (std::size_t i = 0; i < this->dense.size(); ++i)
+      this->index[this->dense[i]] = i;
+    this->holes = 0u;
+  }
+
+  /// \brief The entities, contiguous in memory.
+  private: std::vector<Entity> dense;
+
+  /// \brief Position of each entity in the dense array.
+  private: std::unordered_map<Entity, std::size_t> index;
+
+  /// \brief Whether the dense array is in ascending order.
+  private: bool isSorted{true};
+
+  /// \brief See version().
+  private: uint64_t changes{0u};
+
+  /// \brief Number of kNullEntity holes in the dense array.
+  private: std::size_t holes{0u};
+
+  /// \brief Counter of Iteration objects, which is reset instead of copied
+  /// along with the set, since the copy isn't being iterated over.
+  private: class IterationCount
+  {
+    /// \brief Constructor
+    public: IterationCount() = default;
+
+    /// \brief Copy constructor, starts from zero.
+    public: IterationCount(const IterationCount &)
+    {
+    }
+
+    /// \brief Assignment, keeps the count.
+    /// \return Reference to this.
+    public: IterationCount &operator=(const IterationCount &)
+    {
+      return *this;
+    }
+
+    /// \brief Increment.
+    /// \return Reference to this.
+    public: IterationCount &operator++()
+    {
+      ++this->count;
+      return *this;
+    }
+
+    /// \brief Decrement.
+    /// \return Reference to this.
+    public: IterationCount &operator--()
+    {
+      --this->count;
+      return *this;
+    }
+
+    /// \brief Current count.
+    /// \return Number of Iteration objects.
+    public: operator std::size_t() const
+    {
+      return this->count.load();
+    }
+
+    /// \brief Number of Iteration objects. Atomic, since const sets are
+    /// iterated over from parallel systems.
+    private: std::atomic<std::size_t> count{0u};
+  };
+
+  /// \brief Number of Iteration objects of this set.
+  private: mutable IterationCount iterations;
+};
+
+/// \brief Ordered copy of an EntitySet, made on demand for the accessors
+/// of BaseView which return a std::set. Copying or moving it drops the copy.
+class OrderedEntities
+{
+  /// \brief Constructor
+  public: OrderedEntities() = default;
+
+  /// \brief Copy constructor, doesn't copy the cached set.
+  public: OrderedEntities(const OrderedEntities &)
+  {
+  }
+
+  /// \brief Assignment, drops the cached set.
+  /// \return Reference to this.
+  public: OrderedEntities &operator=(const OrderedEntities &)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->valid = false;
+    return *this;
+  }
+
+  /// \brief Get the entities of a set in a std::set, updating the copy if
+  /// the set changed since it was made.
+  /// \param[in] _entities The set.
+  /// \return The ordered copy.
+  public: const std::set<Entity> &From(const EntitySet &_entities)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!this->valid || this->version != _entities.version())
+    {
+      this->entities.clear();
+      for (const Entity entity : _entities)
+      {
+        if (entity != kNullEntity)
+          this->entities.insert(entity);
+      }
+      this->version = _entities.version();
+      this->valid = true;
+    }
+    return this->entities;
+  }
+
+  /// \brief Protects the copy, which may be requested by const calls made
+  /// in parallel.
+  private: std::mutex mutex;
+
+  /// \brief The copy.
+  private: std::set<Entity> entities;
+
+  /// \brief Version of the set the copy was made from.
+  private: uint64_t version{0u};
+
+  /// \brief Whether a copy was made.
+  private: bool valid{false};
+};
+
 /// \brief A view is a cache to entities, and their components, that
 /// match a set of component types. A cache is used because systems will
 /// frequently, potentially every iteration, query the
@@ -147,6 +540,12 @@ class IGNITION_GAZEBO_VISIBLE BaseView
   /// about to take place.
   public: void ResetNewEntityState();
 
+  /// \brief Make sure the entities in the view are iterated in ascending
+  /// order. Removing entities from the view may leave the internal entity
+  /// sets out of order; this puts them back in order. This is cheap if the
+  /// sets are already ordered.
+  public: void SortEntities();
+
   /// \brief Get the set of component types that this view requires.
   /// \return The set of component types.
   public: const std::set<ComponentTypeId> &ComponentTypes() const;
@@ -155,7 +554,8 @@ class IGNITION_GAZEBO_VISIBLE BaseView
   /// state.
   public: virtual void Reset() = 0;
 
-  /// \brief Get all of the entities in the view
+  /// \brief Get all of the entities in the view. This is an ordered copy
+  /// of DenseEntities, made when the view changed since the last call.
   /// \return The entities in the view
   public: const std::set<Entity> &Entities() const;
 
@@ -164,14 +564,32 @@ class IGNITION_GAZEBO_VISIBLE BaseView
   /// created entity (perhaps this entity has existed for some time, and just
   /// had a component added to it that now makes this entity a part of the
   /// view). An entity's "newness" is determined by the entity component
-  /// manager.
+  /// manager. This is an ordered copy of DenseNewEntities.
   /// \return The newly created entities that are a part of the view
   public: const std::set<Entity> &NewEntities() const;
 
-  /// \brief Get all of the entities to be removed from the view
+  /// \brief Get all of the entities to be removed from the view. This is an
+  /// ordered copy of DenseToRemoveEntities.
   /// \return The entities to be removed from the view
   public: const std::set<Entity> &ToRemoveEntities() const;
 
+  /// \brief Get all of the entities in the view, as stored by the view.
+  /// \return The entities in the view
+  /// \sa Entities
+  public: const EntitySet &DenseEntities() const;
+
+  /// \brief Get the newly created entities of the view, as stored by the
+  /// view.
+  /// \return The newly created entities that are a part of the view
+  /// \sa NewEntities
+  public: const EntitySet &DenseNewEntities() const;
+
+  /// \brief Get the entities to be removed from the view, as stored by the
+  /// view.
+  /// \return The entities to be removed from the view
+  /// \sa ToRemoveEntities
+  public: const EntitySet &DenseToRemoveEntities() const;
+
   /// \brief Get all of the entities that should be added to the view. This is
   /// useful for adding entities to the view before the view is used to ensure
   /// that the view is up-to-date. Once all entities marked "to be added" are
@@ -187,23 +605,19 @@ class IGNITION_GAZEBO_VISIBLE BaseView
   /// \sa ToAddEntities
   public: void ClearToAddEntities();
 
-  // TODO(adlarkin) make this a std::unordered_set for better performance.
-  // We need to make sure nothing else depends on the ordered preserved by
-  // std::set first
+  /// \brief Estimate the heap memory held by the entity sets of the view.
+  /// This isn't virtual, see View::MemoryUsage for the whole view.
+  /// \return Estimate in bytes.
+  public: std::size_t MemoryUsage() const;
+
   /// \brief All the entities that belong to this view.
-  protected: std::set<Entity> entities;
+  protected: EntitySet entities;
 
-  // TODO(adlarkin) make this a std::unordered_set for better performance.
-  // We need to make sure nothing else depends on the ordered preserved by
-  // std::set first
   /// \brief List of newly created entities
-  protected: std::set<Entity> newEntities;
+  protected: EntitySet newEntities;
 
-  // TODO(adlarkin) make this a std::unordered_set for better performance.
-  // We need to make sure nothing else depends on the ordered preserved by
-  // std::set first
   /// \brief List of entities about to be removed
-  protected: std::set<Entity> toRemoveEntities;
+  protected: EntitySet toRemoveEntities;
 
   /// \brief List of entities to be added to the view. The value of the map
   /// indicates whether the entity is new to the entity component manager or not
@@ -211,6 +625,15 @@ class IGNITION_GAZEBO_VISIBLE BaseView
 
   /// \brief The component types in the view
   protected: std::set<ComponentTypeId> componentTypes;
+
+  /// \brief Ordered copy of entities, see Entities.
+  private: mutable OrderedEntities orderedEntities;
+
+  /// \brief Ordered copy of newEntities, see NewEntities.
+  private: mutable OrderedEntities orderedNewEntities;
+
+  /// \brief Ordered copy of toRemoveEntities, see ToRemoveEntities.
+  private: mutable OrderedEntities orderedToRemoveEntities;
 };
 }  // namespace detail
 }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
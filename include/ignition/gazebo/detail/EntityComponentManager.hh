@@ -17,12 +17,15 @@
 #ifndef IGNITION_GAZEBO_DETAIL_ENTITYCOMPONENTMANAGER_HH_
 #define IGNITION_GAZEBO_DETAIL_ENTITYCOMPONENTMANAGER_HH_
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <set>
+#include <string>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -82,6 +85,22 @@ auto CompareData = [](const DataType &_a, const DataType &_b) -> bool
   return false;
 };
 
+//////////////////////////////////////////////////
+template<typename ComponentTypeT>
+void EntityCommandBuffer::CreateComponent(const Entity _entity,
+    const ComponentTypeT &_data)
+{
+  this->CreateComponentImplementation(_entity,
+      std::make_unique<ComponentTypeT>(_data));
+}
+
+//////////////////////////////////////////////////
+template<typename ComponentTypeT>
+void EntityCommandBuffer::RemoveComponent(const Entity _entity)
+{
+  this->RemoveComponent(_entity, ComponentTypeT::typeId);
+}
+
 //////////////////////////////////////////////////
 template<typename ComponentTypeT>
 ComponentTypeT *EntityComponentManager::CreateComponent(const Entity _entity,
@@ -104,6 +123,57 @@ ComponentTypeT *EntityComponentManager::CreateComponent(const Entity _entity,
   return comp;
 }
 
+//////////////////////////////////////////////////
+template<typename ComponentTypeT>
+bool EntityComponentManager::CreateComponents(
+    const std::vector<Entity> &_entities,
+    const std::vector<ComponentTypeT> &_data)
+{
+  if (_entities.size() != _data.size())
+  {
+    ignerr << "Can't create [" << _data.size() << "] components of type "
+           << ComponentTypeT::typeId << " for [" << _entities.size()
+           << "] entities." << std::endl;
+    return false;
+  }
+
+  std::vector<const components::BaseComponent *> data;
+  data.reserve(_data.size());
+  for (const auto &value : _data)
+    data.push_back(&value);
+
+  std::vector<std::size_t> update;
+  bool result = this->CreateComponentsImplementation(_entities,
+      ComponentTypeT::typeId, data, update);
+  for (auto index : update)
+  {
+    auto comp = this->Component<ComponentTypeT>(_entities[index]);
+    if (comp)
+      *comp = _data[index];
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////
+template<typename ComponentTypeT>
+bool EntityComponentManager::CreateComponents(
+    const std::vector<Entity> &_entities, const ComponentTypeT &_data)
+{
+  std::vector<const components::BaseComponent *> data(_entities.size(),
+      &_data);
+
+  std::vector<std::size_t> update;
+  bool result = this->CreateComponentsImplementation(_entities,
+      ComponentTypeT::typeId, data, update);
+  for (auto index : update)
+  {
+    auto comp = this->Component<ComponentTypeT>(_entities[index]);
+    if (comp)
+      *comp = _data;
+  }
+  return result;
+}
+
 //////////////////////////////////////////////////
 template<typename ComponentTypeT>
 const ComponentTypeT *EntityComponentManager::Component(
@@ -127,6 +197,27 @@ ComponentTypeT *EntityComponentManager::Component(const Entity _entity)
       this->ComponentImplementation(_entity, typeId));
 }
 
+//////////////////////////////////////////////////
+template<typename ComponentTypeT>
+const ComponentTypeT *EntityComponentManager::Component(
+    const EntityHandle &_handle) const
+{
+  if (!this->HasEntity(_handle))
+    return nullptr;
+
+  return this->Component<ComponentTypeT>(_handle.entity);
+}
+
+//////////////////////////////////////////////////
+template<typename ComponentTypeT>
+ComponentTypeT *EntityComponentManager::Component(const EntityHandle &_handle)
+{
+  if (!this->HasEntity(_handle))
+    return nullptr;
+
+  return this->Component<ComponentTypeT>(_handle.entity);
+}
+
 //////////////////////////////////////////////////
 template<typename ComponentTypeT>
 const ComponentTypeT *EntityComponentManager::Component(
@@ -183,7 +274,11 @@ bool EntityComponentManager::SetComponentData(const Entity _entity,
     return true;
   }
 
-  return comp->SetData(_data, CompareData<typename ComponentTypeT::Type>);
+  if (!comp->SetData(_data, CompareData<typename ComponentTypeT::Type>))
+    return false;
+
+  this->ComponentDataSet(_entity, ComponentTypeT::typeId);
+  return true;
 }
 
 //////////////////////////////////////////////////
@@ -214,7 +309,7 @@ Entity EntityComponentManager::EntityByComponents(
 
   // Iterate over entities
   Entity result{kNullEntity};
-  for (const Entity entity : view->Entities())
+  view->DenseEntities().forEach([&](const Entity entity)
   {
     bool different{false};
 
@@ -235,9 +330,10 @@ Entity EntityComponentManager::EntityByComponents(
     if (!different)
     {
       result = entity;
-      break;
+      return false;
     }
-  }
+    return true;
+  });
 
   return result;
 }
@@ -246,13 +342,27 @@ Entity EntityComponentManager::EntityByComponents(
 template<typename ...ComponentTypeTs>
 std::vector<Entity> EntityComponentManager::EntitiesByComponents(
     const ComponentTypeTs &..._desiredComponents) const
+{
+  std::vector<Entity> result;
+  this->EachEntityByComponents([&](Entity _entity)
+  {
+    result.push_back(_entity);
+    return true;
+  }, _desiredComponents...);
+  return result;
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+void EntityComponentManager::EachEntityByComponents(
+    const std::function<bool(Entity)> &_f,
+    const ComponentTypeTs &..._desiredComponents) const
 {
   // Get all entities which have components of the desired types
   const auto &view = this->FindView<ComponentTypeTs...>();
 
   // Iterate over entities
-  std::vector<Entity> result;
-  for (const Entity entity : view->Entities())
+  view->DenseEntities().forEach([&](const Entity entity)
   {
     bool different{false};
 
@@ -270,13 +380,8 @@ std::vector<Entity> EntityComponentManager::EntitiesByComponents(
       }
     }, _desiredComponents...);
 
-    if (!different)
-    {
-      result.push_back(entity);
-    }
-  }
-
-  return result;
+    return different || _f(entity);
+  });
 }
 
 //////////////////////////////////////////////////
@@ -287,16 +392,17 @@ std::vector<Entity> EntityComponentManager::ChildrenByComponents(Entity _parent,
   // Get all entities which have components of the desired types
   const auto &view = this->FindView<ComponentTypeTs...>();
 
-  // Get all entities which are immediate children of the given parent
-  auto children = this->Entities().AdjacentsFrom(_parent);
-
   // Iterate over entities
   std::vector<Entity> result;
-  for (const Entity entity : view->Entities())
+  if (!this->HasEntity(_parent))
+    return result;
+
+  view->DenseEntities().forEach([&](const Entity entity)
   {
-    if (children.find(entity) == children.end())
+    // Only keep immediate children of the given parent
+    if (this->ParentEntity(entity) != _parent)
     {
-      continue;
+      return true;
     }
 
     // Iterate over desired components, comparing each of them to the
@@ -318,11 +424,50 @@ std::vector<Entity> EntityComponentManager::ChildrenByComponents(Entity _parent,
     {
       result.push_back(entity);
     }
-  }
+    return true;
+  });
 
   return result;
 }
 
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+Entity EntityComponentManager::ChildByName(Entity _parent,
+    const std::string &_name) const
+{
+  for (const Entity entity : this->IndexedChildren(_parent, &_name))
+  {
+    if ((this->EntityHasComponentType(entity, ComponentTypeTs::typeId) &&
+        ...))
+    {
+      return entity;
+    }
+  }
+  return kNullEntity;
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+std::vector<Entity> EntityComponentManager::ChildrenWithComponents(
+    Entity _parent) const
+{
+  auto children = this->IndexedChildren(_parent, nullptr);
+  children.erase(std::remove_if(children.begin(), children.end(),
+      [&](const Entity _entity)
+      {
+        return !(this->EntityHasComponentType(_entity,
+            ComponentTypeTs::typeId) && ...);
+      }), children.end());
+  return children;
+}
+
+//////////////////////////////////////////////////
+template<typename ComponentTypeT>
+ComponentDemand EntityComponentManager::DemandComponent(const Entity _entity)
+{
+  return this->DemandComponent(_entity, ComponentTypeT::typeId);
+}
+
 //////////////////////////////////////////////////
 template <typename T>
 struct EntityComponentManager::identity  // NOLINT
@@ -335,20 +480,15 @@ template<typename ...ComponentTypeTs>
 void EntityComponentManager::EachNoCache(typename identity<std::function<
     bool(const Entity &_entity, const ComponentTypeTs *...)>>::type _f) const
 {
-  for (const auto &vertex : this->Entities().Vertices())
+  auto types = std::set<ComponentTypeId>{ComponentTypeTs::typeId...};
+  this->EachEntity([&](Entity entity)
   {
-    Entity entity = vertex.first;
-    auto types = std::set<ComponentTypeId>{ComponentTypeTs::typeId...};
-
     if (this->EntityMatches(entity, types))
     {
-      if (!_f(entity,
-              this->Component<ComponentTypeTs>(entity)...))
-      {
-        break;
-      }
+      return _f(entity, this->Component<ComponentTypeTs>(entity)...);
     }
-  }
+    return true;
+  });
 }
 
 //////////////////////////////////////////////////
@@ -356,20 +496,15 @@ template<typename ...ComponentTypeTs>
 void EntityComponentManager::EachNoCache(typename identity<std::function<
     bool(const Entity &_entity, ComponentTypeTs *...)>>::type _f)
 {
-  for (const auto &vertex : this->Entities().Vertices())
+  auto types = std::set<ComponentTypeId>{ComponentTypeTs::typeId...};
+  this->EachEntity([&](Entity entity)
   {
-    Entity entity = vertex.first;
-    auto types = std::set<ComponentTypeId>{ComponentTypeTs::typeId...};
-
     if (this->EntityMatches(entity, types))
     {
-      if (!_f(entity,
-              this->Component<ComponentTypeTs>(entity)...))
-      {
-        break;
-      }
+      return _f(entity, this->Component<ComponentTypeTs>(entity)...);
     }
-  }
+    return true;
+  });
 }
 
 namespace detail
@@ -389,7 +524,7 @@ namespace detail
 /// \return The value of return by the function _f.
 template <typename... ComponentTypeTs, typename FuncT, typename BaseComponentT,
           std::size_t... Is>
-constexpr bool applyFunctionImpl(const FuncT &_f, const Entity &_entity,
+constexpr bool applyFunctionImpl(FuncT &_f, const Entity &_entity,
                        const std::vector<BaseComponentT *> &_data,
                        std::index_sequence<Is...>)
 {
@@ -408,7 +543,7 @@ constexpr bool applyFunctionImpl(const FuncT &_f, const Entity &_entity,
 /// become the arguments of the callback function _f.
 /// \return The value of return by the function _f.
 template <typename... ComponentTypeTs, typename FuncT, typename BaseComponentT>
-constexpr bool applyFunction(const FuncT &_f, const Entity &_entity,
+constexpr bool applyFunction(FuncT &_f, const Entity &_entity,
                    const std::vector<BaseComponentT *> &_data)
 {
   return applyFunctionImpl<ComponentTypeTs...>(
@@ -427,14 +562,11 @@ void EntityComponentManager::Each(typename identity<std::function<
 
   // Iterate over the entities in the view, and invoke the callback
   // function.
-  for (const Entity entity : view->Entities())
+  view->DenseEntities().forEach([&](const Entity entity)
   {
     const auto &data = view->EntityComponentData(entity);
-    if (!detail::applyFunction<const ComponentTypeTs...>(_f, entity, data))
-    {
-      break;
-    }
-  }
+    return detail::applyFunction<const ComponentTypeTs...>(_f, entity, data);
+  });
 }
 
 //////////////////////////////////////////////////
@@ -448,16 +580,91 @@ void EntityComponentManager::Each(typename identity<std::function<
 
   // Iterate over the entities in the view, and invoke the callback
   // function.
-  for (const Entity entity : view->Entities())
+  view->DenseEntities().forEach([&](const Entity entity)
+  {
+    const auto &data = view->EntityComponentData(entity);
+    return detail::applyFunction<ComponentTypeTs...>(_f, entity, data);
+  });
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+void EntityComponentManager::EachDynamic(typename identity<std::function<
+    bool(const Entity &_entity, const ComponentTypeTs *...)>>::type _f) const
+{
+  auto view = this->FindView<ComponentTypeTs...>();
+  for (const Entity entity : this->DynamicEntities(view))
+  {
+    const auto &data = view->EntityComponentData(entity);
+    if (!detail::applyFunction<const ComponentTypeTs...>(_f, entity, data))
+      break;
+  }
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+void EntityComponentManager::EachDynamic(typename identity<std::function<
+    bool(const Entity &_entity, ComponentTypeTs *...)>>::type _f)
+{
+  auto view = this->FindView<ComponentTypeTs...>();
+  for (const Entity entity : this->DynamicEntities(view))
   {
     const auto &data = view->EntityComponentData(entity);
     if (!detail::applyFunction<ComponentTypeTs...>(_f, entity, data))
-    {
       break;
-    }
   }
 }
 
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+void EntityComponentManager::EachParallel(typename identity<std::function<
+    bool(const Entity &_entity, const ComponentTypeTs *...)>>::type _f) const
+{
+  auto view = this->FindView<ComponentTypeTs...>();
+  const auto &entities = view->DenseEntities();
+
+  std::atomic<bool> stop{false};
+  this->ParallelForEntities(entities.empty() ? nullptr : &*entities.begin(),
+      entities.size(), [&](std::size_t _begin, std::size_t _end)
+  {
+    for (auto it = entities.begin() + _begin;
+         it != entities.begin() + _end && !stop; ++it)
+    {
+      // Holes are left by removals while the view is iterated over
+      if (*it == kNullEntity)
+        continue;
+      const auto &data = view->EntityComponentData(*it);
+      if (!detail::applyFunction<const ComponentTypeTs...>(_f, *it, data))
+        stop = true;
+    }
+  });
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+void EntityComponentManager::EachParallel(typename identity<std::function<
+    bool(const Entity &_entity, ComponentTypeTs *...)>>::type _f)
+{
+  auto view = this->FindView<ComponentTypeTs...>();
+  const auto &entities = view->DenseEntities();
+
+  std::atomic<bool> stop{false};
+  this->ParallelForEntities(entities.empty() ? nullptr : &*entities.begin(),
+      entities.size(), [&](std::size_t _begin, std::size_t _end)
+  {
+    for (auto it = entities.begin() + _begin;
+         it != entities.begin() + _end && !stop; ++it)
+    {
+      // Holes are left by removals while the view is iterated over
+      if (*it == kNullEntity)
+        continue;
+      const auto &data = view->EntityComponentData(*it);
+      if (!detail::applyFunction<ComponentTypeTs...>(_f, *it, data))
+        stop = true;
+    }
+  });
+}
+
 //////////////////////////////////////////////////
 template <class Function, class... ComponentTypeTs>
 void EntityComponentManager::ForEach(Function _f,
@@ -478,14 +685,11 @@ void EntityComponentManager::EachNew(typename identity<std::function<
   // Iterate over the entities in the view and in the newly created
   // entities list, and invoke the callback
   // function.
-  for (const Entity entity : view->NewEntities())
+  view->DenseNewEntities().forEach([&](const Entity entity)
   {
     const auto &data = view->EntityComponentData(entity);
-    if (!detail::applyFunction<ComponentTypeTs...>(_f, entity, data))
-    {
-      break;
-    }
-  }
+    return detail::applyFunction<ComponentTypeTs...>(_f, entity, data);
+  });
 }
 
 //////////////////////////////////////////////////
@@ -500,14 +704,11 @@ void EntityComponentManager::EachNew(typename identity<std::function<
   // Iterate over the entities in the view and in the newly created
   // entities list, and invoke the callback
   // function.
-  for (const Entity entity : view->NewEntities())
+  view->DenseNewEntities().forEach([&](const Entity entity)
   {
     const auto &data = view->EntityComponentData(entity);
-    if (!detail::applyFunction<const ComponentTypeTs...>(_f, entity, data))
-    {
-      break;
-    }
-  }
+    return detail::applyFunction<const ComponentTypeTs...>(_f, entity, data);
+  });
 }
 
 //////////////////////////////////////////////////
@@ -522,13 +723,121 @@ void EntityComponentManager::EachRemoved(typename identity<std::function<
   // Iterate over the entities in the view and in the newly created
   // entities list, and invoke the callback
   // function.
-  for (const Entity entity : view->ToRemoveEntities())
+  view->DenseToRemoveEntities().forEach([&](const Entity entity)
   {
     const auto &data = view->EntityComponentData(entity);
-    if (!detail::applyFunction<const ComponentTypeTs...>(_f, entity, data))
-    {
+    return detail::applyFunction<const ComponentTypeTs...>(_f, entity, data);
+  });
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs, typename FunctionT>
+void EntityComponentManager::Each(FunctionT &&_f) const
+{
+  auto view = this->FindView<ComponentTypeTs...>();
+  view->DenseEntities().forEach([&](const Entity entity)
+  {
+    const auto &data = view->EntityComponentData(entity);
+    return detail::applyFunction<const ComponentTypeTs...>(_f, entity, data);
+  });
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs, typename FunctionT>
+void EntityComponentManager::Each(FunctionT &&_f)
+{
+  auto view = this->FindView<ComponentTypeTs...>();
+  view->DenseEntities().forEach([&](const Entity entity)
+  {
+    const auto &data = view->EntityComponentData(entity);
+    return detail::applyFunction<ComponentTypeTs...>(_f, entity, data);
+  });
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs, typename FunctionT>
+void EntityComponentManager::EachNew(FunctionT &&_f) const
+{
+  auto view = this->FindView<ComponentTypeTs...>();
+  view->DenseNewEntities().forEach([&](const Entity entity)
+  {
+    const auto &data = view->EntityComponentData(entity);
+    return detail::applyFunction<const ComponentTypeTs...>(_f, entity, data);
+  });
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs, typename FunctionT>
+void EntityComponentManager::EachNew(FunctionT &&_f)
+{
+  auto view = this->FindView<ComponentTypeTs...>();
+  view->DenseNewEntities().forEach([&](const Entity entity)
+  {
+    const auto &data = view->EntityComponentData(entity);
+    return detail::applyFunction<ComponentTypeTs...>(_f, entity, data);
+  });
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs, typename FunctionT>
+void EntityComponentManager::EachRemoved(FunctionT &&_f) const
+{
+  auto view = this->FindView<ComponentTypeTs...>();
+  view->DenseToRemoveEntities().forEach([&](const Entity entity)
+  {
+    const auto &data = view->EntityComponentData(entity);
+    return detail::applyFunction<const ComponentTypeTs...>(_f, entity, data);
+  });
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+detail::ViewRange<const ComponentTypeTs...>
+    EntityComponentManager::EachRange() const
+{
+  auto view = this->FindView<ComponentTypeTs...>();
+  return detail::ViewRange<const ComponentTypeTs...>(view,
+      view->DenseEntities());
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+detail::ViewRange<ComponentTypeTs...> EntityComponentManager::EachRange()
+{
+  auto view = this->FindView<ComponentTypeTs...>();
+  return detail::ViewRange<ComponentTypeTs...>(view, view->DenseEntities());
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+void EntityComponentManager::EachChanged(typename identity<std::function<
+    bool(const Entity &_entity, const ComponentTypeTs *...)>>::type _f) const
+{
+  static_assert(sizeof...(ComponentTypeTs) > 0,
+      "EachChanged needs at least one component type");
+  using ChangedComponentT =
+      std::tuple_element_t<0, std::tuple<ComponentTypeTs...>>;
+
+  // Only look up the changed entities instead of going through a view, so
+  // the cost doesn't depend on how many entities match the component types.
+  for (const Entity entity : this->ChangedEntities(ChangedComponentT::typeId))
+  {
+    auto components =
+        std::make_tuple(this->Component<ComponentTypeTs>(entity)...);
+
+    bool hasAll = std::apply([](const auto *..._comps)
+        {
+          return ((nullptr != _comps) && ...);
+        }, components);
+    if (!hasAll)
+      continue;
+
+    bool keepGoing = std::apply([&](const auto *..._comps)
+        {
+          return _f(entity, _comps...);
+        }, components);
+    if (!keepGoing)
       break;
-    }
   }
 }
 
@@ -572,20 +881,23 @@ detail::View *EntityComponentManager::FindView() const
     }
     view->ClearToAddEntities();
 
+    // entities may have been added or removed out of order since the view
+    // was last used, restore ascending order so iteration is deterministic.
+    // Views may be iterated over by other threads while systems run in
+    // parallel, so they're only sorted while systems run one at a time.
+    if (!this->LockAddingEntitiesToViews())
+      view->SortEntities();
+
     return view;
   }
 
   // create a new view if one wasn't found
   detail::View view(std::set<ComponentTypeId>{ComponentTypeTs::typeId...});
 
-  for (const auto &vertex : this->Entities().Vertices())
+  // only add entities to the view that have all of the components in viewKey
+  for (const Entity entity :
+      this->EntitiesWithComponentTypes(view.ComponentTypes()))
   {
-    Entity entity = vertex.first;
-
-    // only add entities to the view that have all of the components in viewKey
-    if (!this->EntityMatches(entity, view.ComponentTypes()))
-      continue;
-
     view.AddEntityWithConstComps(entity, this->IsNewEntity(entity),
         this->Component<ComponentTypeTs>(entity)...);
     view.AddEntityWithComps(entity, this->IsNewEntity(entity),
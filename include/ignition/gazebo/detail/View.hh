@@ -17,6 +17,10 @@
 #ifndef IGNITION_GAZEBO_DETAIL_VIEW_HH_
 #define IGNITION_GAZEBO_DETAIL_VIEW_HH_
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
 #include <set>
 #include <tuple>
 #include <unordered_map>
@@ -120,6 +124,11 @@ class IGNITION_GAZEBO_VISIBLE View : public BaseView
   /// \brief Documentation inherited
   public: void Reset() override;
 
+  /// \brief Estimate the heap memory held by the view, not counting the
+  /// components it points to, which belong to the entity component manager.
+  /// \return Estimate in bytes.
+  public: std::size_t MemoryUsage() const;
+
   /// \brief A map of entities to their component data. Since tuples are defined
   /// at compile time, we need separate containers that have tuples for both
   /// non-const and const component pointers (calls to ECM::Each can have a
@@ -160,6 +169,163 @@ class IGNITION_GAZEBO_VISIBLE View : public BaseView
              missingCompTracker;
 };
 
+/// \brief Entities of a view and their components, to be iterated over
+/// with a range-based for loop. Dereferencing an iterator gives a tuple of
+/// the entity and pointers to its components, which can be unpacked with
+/// structured bindings. See EntityComponentManager::EachRange.
+///
+/// The range holds an EntitySet::Iteration, so the loop may add or remove
+/// components: entities which leave the view before being reached are
+/// skipped, and entities which join it are visited at the end.
+/// \tparam ComponentTypeTs Component types of the view, const qualified for
+/// read-only access.
+template <typename... ComponentTypeTs>
+class ViewRange
+{
+  /// \brief Iterator over the entities of the view.
+  public: class Iterator
+  {
+    /// \brief Type of the elements.
+    public: using value_type = std::tuple<Entity, ComponentTypeTs *...>;
+
+    /// \brief Elements are returned by value.
+    public: using reference = value_type;
+
+    /// \brief Elements are returned by value.
+    public: using pointer = void;
+
+    /// \brief Distance between iterators.
+    public: using difference_type = std::ptrdiff_t;
+
+    /// \brief Iterator category.
+    public: using iterator_category = std::forward_iterator_tag;
+
+    /// \brief Constructor
+    /// \param[in] _view View holding the component data.
+    /// \param[in] _entities The view's entities.
+    /// \param[in] _slot Slot of the entities to start at, skipping holes.
+    public: Iterator(const View *_view, const EntitySet *_entities,
+                std::size_t _slot)
+        : view(_view), entities(_entities), slot(_slot)
+    {
+      this->SkipHoles();
+    }
+
+    /// \brief Get the entity and its components.
+    /// \return Tuple of the entity and pointers to its components.
+    public: value_type operator*() const
+    {
+      const Entity entity = this->entities->Slot(this->slot);
+      return this->Make(entity, this->view->EntityComponentData(entity),
+          std::index_sequence_for<ComponentTypeTs...>{});
+    }
+
+    /// \brief Move to the next entity.
+    /// \return Reference to this iterator.
+    public: Iterator &operator++()
+    {
+      ++this->slot;
+      this->SkipHoles();
+      return *this;
+    }
+
+    /// \brief Equality operator.
+    /// \param[in] _other Iterator to compare to.
+    /// \return True if both point to the same entity.
+    public: bool operator==(const Iterator &_other) const
+    {
+      return this->Position() == _other.Position();
+    }
+
+    /// \brief Inequality operator.
+    /// \param[in] _other Iterator to compare to.
+    /// \return True if they point to different entities.
+    public: bool operator!=(const Iterator &_other) const
+    {
+      return this->Position() != _other.Position();
+    }
+
+    /// \brief Move past holes left by removed entities.
+    private: void SkipHoles()
+    {
+      while (this->slot < this->entities->SlotCount() &&
+             this->entities->Slot(this->slot) == kNullEntity)
+      {
+        ++this->slot;
+      }
+    }
+
+    /// \brief Current slot, where all slots past the last one are the
+    /// same, so the end iterator still matches after entities are added.
+    /// \return Slot.
+    private: std::size_t Position() const
+    {
+      return std::min(this->slot, this->entities->SlotCount());
+    }
+
+    /// \brief Build the tuple of an entity.
+    /// \param[in] _entity The entity.
+    /// \param[in] _data The entity's component pointers.
+    /// \return Tuple of the entity and its components.
+    private: template <std::size_t... Is>
+             static value_type Make(const Entity _entity,
+                 const std::vector<components::BaseComponent *> &_data,
+                 std::index_sequence<Is...>)
+    {
+      return value_type(_entity,
+          static_cast<ComponentTypeTs *>(_data[Is])...);
+    }
+
+    /// \brief View holding the component data.
+    private: const View *view;
+
+    /// \brief The view's entities.
+    private: const EntitySet *entities;
+
+    /// \brief Slot of the current entity.
+    private: std::size_t slot;
+  };
+
+  /// \brief Constructor
+  /// \param[in] _view View to iterate over.
+  /// \param[in] _entities Entities of the view to iterate over.
+  public: ViewRange(const View *_view, const EntitySet &_entities)
+      : view(_view), entities(_entities), iteration(_entities)
+  {
+  }
+
+  /// \brief Iterator to the first entity.
+  /// \return Iterator.
+  public: Iterator begin() const
+  {
+    return Iterator(this->view, &this->entities, 0u);
+  }
+
+  /// \brief Iterator past the last entity.
+  /// \return Iterator.
+  public: Iterator end() const
+  {
+    return Iterator(this->view, &this->entities,
+        std::numeric_limits<std::size_t>::max());
+  }
+
+  /// \brief Number of entities.
+  /// \return Number of entities in the range.
+  public: std::size_t size() const
+  {
+    return this->entities.size();
+  }
+
+  /// \brief View holding the component data.
+  private: const View *view;
+
+  /// \brief Entities to iterate over.
+  private: const EntitySet &entities;
+
+  /// \brief Keeps entities in place while the range exists.
+  private: EntitySet::Iteration iteration;
+};
+
 //////////////////////////////////////////////////
 template <typename... ComponentTypeTs>
 void View::AddEntityWithConstComps(const Entity &_entity, const bool _new,
@@ -18,6 +18,8 @@
 #define IGNITION_GAZEBO_RENDERING_EVENTS_HH_
 
 
+#include <cstddef>
+
 #include <ignition/common/Event.hh>
 
 #include "ignition/gazebo/config.hh"
@@ -65,6 +67,22 @@ namespace ignition
       /// \endcode
       using PostRender = ignition::common::EventT<void(void),
           struct PostRenderTag>;
+
+      /// \brief The mesh preload progress event is emitted while meshes
+      /// are being loaded ahead of the first render, with the number of
+      /// meshes processed so far and the total. It's emitted one last time
+      /// once all meshes are processed. The event is emitted through
+      /// EventManager::EmitAsync, so subscribers are called from the event
+      /// manager's thread and don't slow down loading.
+      ///
+      /// For example:
+      /// \code
+      /// auto *progress = eventManager.Handle<
+      ///     ignition::gazebo::events::MeshPreloadProgress>();
+      /// eventManager.EmitAsync(progress, 10u, 100u);
+      /// \endcode
+      using MeshPreloadProgress = ignition::common::EventT<
+          void(std::size_t, std::size_t), struct MeshPreloadProgressTag>;
       }
     }  // namespace events
   }  // namespace gazebo
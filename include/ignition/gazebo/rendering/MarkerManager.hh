@@ -34,6 +34,19 @@ class MarkerManagerPrivate;
 
 /// \brief Creates, deletes, and maintains marker visuals. Only the
 /// Scene class should instantiate and use this class.
+///
+/// Markers are received on the `<topic>` and `<topic>_array` services,
+/// and each gets its own visual. For drawing many markers at once, such
+/// as paths or occupancy, the `<topic>_batch` service takes a
+/// msgs::Marker_V whose markers are merged into a single visual per
+/// namespace, with one dynamic mesh per kind of primitive: triangles,
+/// lines and points. Markers in a batch are identified by their id, so
+/// clients can add, modify or delete a subset of them with later
+/// requests. Boxes, spheres and cylinders are drawn coarsely, text and
+/// capsules aren't supported, parents and lifetimes are ignored, and all
+/// markers in a batch share the material of the one with the lowest id.
+/// Markers are expanded into primitives on the transport thread, and the
+/// meshes are only rebuilt on updates where their batch changed.
 class IGNITION_GAZEBO_RENDERING_VISIBLE MarkerManager
 {
   /// \brief Constructor
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_RENDERING_MESHPRELOADER_HH_
+#define IGNITION_GAZEBO_RENDERING_MESHPRELOADER_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <string>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/rendering/Export.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+  // forward declaration
+  class MeshPreloaderPrivate;
+
+  /// \class MeshPreloader MeshPreloader.hh
+  /// ignition/gazebo/rendering/MeshPreloader.hh
+  /// \brief Loads the meshes used by a world into common::MeshManager on
+  /// background threads, so that creating visuals doesn't stall on parsing
+  /// mesh files the first time they're used.
+  ///
+  /// Mesh files are parsed in parallel, each thread with its own loader,
+  /// and the resulting meshes are added to the mesh manager under the same
+  /// names SceneManager and the physics system look them up by. Meshes
+  /// that are already loaded are skipped.
+  class IGNITION_GAZEBO_RENDERING_VISIBLE MeshPreloader
+  {
+    /// \brief Constructor
+    public: MeshPreloader();
+
+    /// \brief Destructor. Waits for loading to finish.
+    public: ~MeshPreloader();
+
+    /// \brief Get the meshes referenced by the geometries and levels of
+    /// detail of all entities.
+    /// \param[in] _ecm Entity component manager.
+    /// \return Mesh names, as passed to common::MeshManager::Load.
+    public: static std::set<std::string> Meshes(
+        const EntityComponentManager &_ecm);
+
+    /// \brief Start loading meshes in the background. Does nothing if
+    /// loading was already started.
+    /// \param[in] _meshes Mesh names, see Meshes.
+    /// \param[in] _threads Number of threads to use, zero to use one per
+    /// hardware thread.
+    public: void Start(const std::set<std::string> &_meshes,
+        unsigned int _threads = 0u);
+
+    /// \brief Wait for loading to finish.
+    /// \param[in] _timeout Maximum time to wait.
+    /// \return True if all meshes were processed.
+    public: bool WaitFor(const std::chrono::steady_clock::duration &_timeout);
+
+    /// \brief Whether all meshes were processed.
+    /// \return True if done, or if loading was never started.
+    public: bool Done() const;
+
+    /// \brief Number of meshes processed so far, including the ones which
+    /// failed to load.
+    /// \return Number of meshes.
+    public: std::size_t Processed() const;
+
+    /// \brief Number of meshes to process.
+    /// \return Number of meshes.
+    public: std::size_t Total() const;
+
+    /// \brief Private data pointer.
+    private: std::unique_ptr<MeshPreloaderPrivate> dataPtr;
+  };
+}
+}
+}
+#endif
@@ -51,6 +51,10 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     public: ~RenderUtil();
 
     /// \brief Initialize the renderer. Must be called in the rendering thread.
+    /// Render engines are loaded once per process. RenderUtil instances
+    /// using the same engine, like the GUI and the sensors system running
+    /// in the same process, share its GPU resources such as meshes and
+    /// textures.
     public: void Init();
 
     /// \brief Count of pending sensors. Must be called in the rendering thread.
@@ -127,6 +131,45 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \param[in] _enabled True to enable sky, false to disable sky
     public: void SetSkyEnabled(bool _enabled);
 
+    /// \brief Set whether UpdateFromECM should only sync the poses of
+    /// entities whose pose components were marked as changed during the
+    /// current iteration, instead of the poses of all entities. This makes
+    /// the cost of syncing depend on how many entities moved, which helps in
+    /// large worlds that are mostly static. Only enable it if the ECM
+    /// passed to UpdateFromECM has its changes cleared every iteration, like
+    /// the server's, and all systems that move entities call SetChanged.
+    /// Actors are always updated. Defaults to false.
+    /// \param[in] _enabled True to only sync changed poses.
+    public: void SetIncrementalUpdates(bool _enabled);
+
+    /// \brief Set whether pose updates of models that are outside the
+    /// frusta of all cameras in the scene should be skipped. This saves
+    /// scene graph updates in large worlds seen by narrow cameras. Only
+    /// models with a components::AxisAlignedBox are culled, together with
+    /// all their descendants other than cameras. Skipped poses are applied
+    /// as soon as the model comes into view. Nothing is culled while the
+    /// scene has sensors that can't be represented by a frustum, such as
+    /// lidars. Defaults to false.
+    /// \param[in] _enabled True to cull pose updates.
+    /// \param[in] _margin Distance in meters bounding boxes are grown by
+    /// on each side before being tested, to account for visuals that are
+    /// larger than collisions.
+    public: void SetFrustumCulling(bool _enabled, double _margin = 1.0);
+
+    /// \brief Set whether poses should be extrapolated between updates
+    /// from the ECM, so entities keep moving smoothly when Update is called
+    /// more often than UpdateFromECM, such as when the GUI renders faster
+    /// than the server publishes state. Entities are moved from the last
+    /// received pose using the world velocities of top level models if
+    /// they're in the ECM, and finite differences of the last two poses
+    /// otherwise. Received poses are always applied as they are, and
+    /// nothing is extrapolated while paused. Defaults to false.
+    /// \param[in] _enabled True to extrapolate poses.
+    /// \param[in] _maxTime Maximum simulation time in seconds poses are
+    /// extrapolated past the last update, which bounds how far off they
+    /// get if updates stop coming.
+    public: void SetPoseExtrapolation(bool _enabled, double _maxTime = 0.2);
+
     /// \brief Show grid view in the scene
     public: void ShowGrid();
 
@@ -143,6 +186,7 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \param[in] _createSensorCb Callback function for creating the sensors
     /// The callback function args are: sensor entity, sensor sdf
     /// and parent name, it returns the name of the rendering sensor created.
+    /// If it returns an empty name, no sensor is added to the scene.
     public: void SetEnableSensors(bool _enable, std::function<
         std::string(const gazebo::Entity &, const sdf::Sensor &,
           const std::string &)> _createSensorCb = {});
@@ -44,6 +44,7 @@
 
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/components/VisualLod.hh>
 #include <ignition/gazebo/rendering/Export.hh>
 
 namespace ignition
@@ -89,6 +90,23 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     public: bool valid = false;
   };
 
+  /// \brief Bone transforms of an actor's skeleton at a point in time, kept
+  /// in flat arrays instead of maps keyed by bone name.
+  class ActorSkeletonFrame
+  {
+    /// \brief Skin names of the bones, sorted, in the order of transforms.
+    /// Shared by all actors playing the same animation of the same
+    /// skeleton, so comparing pointers tells whether two frames have the
+    /// same layout.
+    public: std::shared_ptr<const std::vector<std::string>> boneNames;
+
+    /// \brief Local transform of each bone.
+    public: std::vector<math::Matrix4d> transforms;
+
+    /// \brief Pose of the actor along its trajectory.
+    public: math::Matrix4d actorPose;
+  };
+
   /// \brief Scene manager class for loading and managing objects in the scene
   class IGNITION_GAZEBO_RENDERING_VISIBLE SceneManager
   {
@@ -106,6 +124,28 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \return Pointer to scene
     public: rendering::ScenePtr Scene() const;
 
+    /// \brief Set whether visual geometries with identical material
+    /// properties share a single material instead of each holding a copy.
+    /// Sharing materials lets render engines which batch draw calls by
+    /// material, such as ogre2, instance repeated geometries. It only
+    /// affects visuals created afterwards. Materials loaded from mesh files
+    /// aren't shared. Use UniqueMaterial before modifying a geometry's
+    /// material. Disabled by default.
+    /// \param[in] _share True to share materials.
+    public: void SetShareMaterials(bool _share);
+
+    /// \brief Get whether materials are shared between geometries.
+    /// \return True if materials are shared.
+    /// \sa SetShareMaterials
+    public: bool ShareMaterials() const;
+
+    /// \brief Get a geometry's material, making sure it isn't shared with
+    /// other geometries first, so that it can be modified.
+    /// \param[in] _geom Geometry whose material will be modified.
+    /// \return The geometry's own material, or nullptr if it has none.
+    public: rendering::MaterialPtr UniqueMaterial(
+        const rendering::GeometryPtr &_geom);
+
     /// \brief Set the world's ID.
     /// \param[in] _id World ID.
     public: void SetWorldId(Entity _id);
@@ -188,6 +228,29 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
         const sdf::Joint &_joint, Entity _childId = 0,
         Entity _parentId = 0);
 
+    /// \brief Give a visual levels of detail. Each level replaces the
+    /// visual's geometries with a mesh from a given distance to the closest
+    /// camera, or hides the visual if the level has no mesh. The mesh
+    /// inherits the scale of the visual's original geometry, for example a
+    /// box's size. Only visuals with geometries of their own are supported.
+    /// \param[in] _id Visual entity, which must have been created already.
+    /// \param[in] _levels Levels of detail, sorted by increasing distance.
+    /// \return True if the levels were set.
+    /// \sa UpdateLods
+    public: bool SetVisualLod(Entity _id,
+        const std::vector<lod::Level> &_levels);
+
+    /// \brief Select the level of detail of each visual which has them,
+    /// based on its distance to the closest camera in the scene. This
+    /// should be called after updating poses and before rendering.
+    ///
+    /// Heightmaps too large for a single geometry are split into tiles,
+    /// see TerrainTiles, which are also updated here: only the tiles
+    /// within the far clip distance of a camera exist, each at a level of
+    /// detail which halves its resolution every time its distance to the
+    /// closest camera doubles.
+    public: void UpdateLods();
+
     /// \brief Create a collision visual
     /// \param[in] _id Unique visual id
     /// \param[in] _collision Collision sdf dom
@@ -296,6 +359,21 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     public: std::map<std::string, math::Matrix4d> ActorSkeletonTransformsAt(
         Entity _id, std::chrono::steady_clock::duration _time) const;
 
+    /// \brief Get the skeleton local transforms of actor mesh given an id,
+    /// as flat arrays. The transforms are sampled from animations baked
+    /// when the actor is created, which are shared by all actors using the
+    /// same skeleton, so this is much cheaper than
+    /// ActorSkeletonTransformsAt for scenes with many actors.
+    /// \param[in] _id Entity's unique id
+    /// \param[in] _time Simulation time
+    /// \param[out] _frame Bone transforms and actor pose. Reusing it
+    /// across calls avoids allocating.
+    /// \return False if the entity isn't an animated actor, in which case
+    /// _frame is left untouched.
+    public: bool ActorSkeletonFrameAt(Entity _id,
+        std::chrono::steady_clock::duration _time,
+        ActorSkeletonFrame &_frame) const;
+
     /// \brief Get the actor animation update data given an id.
     /// Use this function to let the render engine handle the actor animation.
     /// by setting the animation name to be played.
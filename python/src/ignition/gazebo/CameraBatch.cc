@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "CameraBatch.hh"
+
+#include "ignition/gazebo/CameraBatch.hh"
+
+namespace ignition
+{
+namespace gazebo
+{
+namespace python
+{
+/// \brief Get the NumPy type of the frames of a batch.
+/// \param[in] _batch Batch whose frames were allocated.
+/// \return Element type.
+static pybind11::dtype FrameDtype(const CameraBatch &_batch)
+{
+  const std::size_t elements = static_cast<std::size_t>(_batch.Width()) *
+      _batch.Height() * _batch.Channels();
+  const std::size_t bytes = elements > 0u ?
+      _batch.FrameBytes() / elements : 1u;
+  const bool isFloat = _batch.Format().find("FLOAT") != std::string::npos;
+  if (bytes == 2u)
+    return isFloat ? pybind11::dtype("float16") : pybind11::dtype("uint16");
+  if (bytes == 4u)
+    return isFloat ? pybind11::dtype("float32") : pybind11::dtype("uint32");
+  return pybind11::dtype("uint8");
+}
+
+void
+defineGazeboCameraBatch(pybind11::object module)
+{
+  pybind11::class_<CameraBatch, std::shared_ptr<CameraBatch>>(
+      module, "CameraBatch")
+  .def_static(
+    "find", &CameraBatch::Find,
+    "Get a camera batch configured in the Sensors system by name, or None.")
+  .def_static(
+    "names", &CameraBatch::Names,
+    "Names of all camera batches.")
+  .def(
+    "name", &CameraBatch::Name,
+    "Name of the batch.")
+  .def(
+    "size", &CameraBatch::Size,
+    "Number of cameras in the batch.")
+  .def(
+    "sequence", &CameraBatch::Sequence,
+    "Number of batches completed so far.")
+  .def(
+    "stamp",
+    [](const CameraBatch &_self)
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+          _self.Stamp()).count();
+    },
+    "Sim time of the latest complete batch, in nanoseconds.")
+  .def(
+    "wait",
+    [](const CameraBatch &_self, uint64_t _sequence, double _timeout)
+    {
+      auto timeout =
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(_timeout));
+      pybind11::gil_scoped_release release;
+      return _self.WaitFor(_sequence, timeout);
+    },
+    pybind11::arg("sequence") = 0u,
+    pybind11::arg("timeout") = 1.0,
+    "Wait up to timeout seconds for a batch newer than sequence to "
+    "complete, and return the latest sequence.")
+  .def(
+    "pinned", &CameraBatch::Pinned,
+    "Whether the buffer is locked in memory.")
+  .def(
+    "data_ptr",
+    [](const CameraBatch &_self)
+    {
+      return reinterpret_cast<uintptr_t>(_self.Data());
+    },
+    "Address of the buffer, 0 until the first frame is written. Can be "
+    "registered with GPU APIs, such as cudaHostRegister.")
+  .def(
+    "array",
+    [](const std::shared_ptr<CameraBatch> &_self) -> pybind11::object
+    {
+      const void *data = _self->Data();
+      if (nullptr == data)
+        return pybind11::none();
+
+      auto dtype = FrameDtype(*_self);
+      const auto itemSize = static_cast<pybind11::ssize_t>(dtype.itemsize());
+      const auto width = static_cast<pybind11::ssize_t>(_self->Width());
+      const auto channels = static_cast<pybind11::ssize_t>(_self->Channels());
+      const auto frameBytes =
+          static_cast<pybind11::ssize_t>(_self->FrameBytes());
+
+      // The array views the batch's buffer and keeps the batch alive
+      auto holder = new std::shared_ptr<CameraBatch>(_self);
+      pybind11::capsule base(holder, [](void *_holder)
+      {
+        delete static_cast<std::shared_ptr<CameraBatch> *>(_holder);
+      });
+      pybind11::array array(dtype,
+          {static_cast<pybind11::ssize_t>(_self->Size()),
+           static_cast<pybind11::ssize_t>(_self->Height()), width, channels},
+          {frameBytes, width * channels * itemSize, channels * itemSize,
+           itemSize},
+          data, base);
+      array.attr("setflags")(pybind11::arg("write") = false);
+      return std::move(array);
+    },
+    "Read-only (size, height, width, channels) array viewing the batch's "
+    "buffer, or None until the first frame is written. Frames of later "
+    "steps are written in place, so copy what needs to be kept before "
+    "stepping again.");
+}
+}  // namespace python
+}  // namespace gazebo
+}  // namespace ignition
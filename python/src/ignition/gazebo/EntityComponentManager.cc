@@ -13,8 +13,24 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <ignition/gazebo/components/AngularVelocity.hh>
+#include <ignition/gazebo/components/Joint.hh>
+#include <ignition/gazebo/components/JointPosition.hh>
+#include <ignition/gazebo/components/JointVelocity.hh>
+#include <ignition/gazebo/components/LinearVelocity.hh>
+#include <ignition/gazebo/components/Link.hh>
+#include <ignition/gazebo/components/Model.hh>
+#include <ignition/gazebo/components/Pose.hh>
+#include <ignition/gazebo/Util.hh>
+
 #include "EntityComponentManager.hh"
 
 namespace ignition
@@ -23,12 +39,221 @@ namespace gazebo
 {
 namespace python
 {
+/// \brief Entities passed in from Python.
+using EntityArray = pybind11::array_t<uint64_t,
+    pybind11::array::c_style | pybind11::array::forcecast>;
+
+/// \brief Values returned to Python.
+using ValueArray = pybind11::array_t<double, pybind11::array::c_style>;
+
+/////////////////////////////////////////////////
+/// \brief Get all entities which have a component, in one pass.
+/// \tparam ComponentTypeT Component type.
+/// \param[in] _ecm Entity component manager.
+/// \return Array of entities.
+template <typename ComponentTypeT>
+EntityArray entitiesWith(const EntityComponentManager &_ecm)
+{
+  std::vector<uint64_t> entities;
+  _ecm.Each<ComponentTypeT>(
+      [&](const Entity &_entity, const ComponentTypeT *) -> bool
+      {
+        entities.push_back(_entity);
+        return true;
+      });
+
+  EntityArray result(static_cast<pybind11::ssize_t>(entities.size()));
+  std::copy(entities.begin(), entities.end(), result.mutable_data());
+  return result;
+}
+
+/////////////////////////////////////////////////
+/// \brief Fill one row of values per entity. The array is copied into,
+/// since components aren't stored as flat arrays of numbers, but the loop
+/// over entities runs without the GIL and without calling into Python.
+/// \param[in] _ecm Entity component manager.
+/// \param[in] _entities Entities to read.
+/// \param[in] _out Array to fill, or None to allocate one.
+/// \param[in] _width Number of values per entity.
+/// \param[in] _fill Function which fills the row of an entity, returning
+/// false if the entity doesn't have the data.
+/// \return Array of one row per entity. Rows of entities without the data
+/// are NaN.
+template <typename FillFn>
+ValueArray fillRows(const EntityComponentManager &_ecm,
+    const EntityArray &_entities, const pybind11::object &_out,
+    pybind11::ssize_t _width, FillFn _fill)
+{
+  const auto count = _entities.size();
+
+  ValueArray result;
+  if (_out.is_none())
+  {
+    result = _width == 1 ? ValueArray(count) : ValueArray({count, _width});
+  }
+  else
+  {
+    if (!pybind11::isinstance<ValueArray>(_out))
+      throw pybind11::value_error("out must be a contiguous float64 array");
+    result = pybind11::reinterpret_borrow<ValueArray>(_out);
+    if (!result.writeable() || result.size() != count * _width)
+    {
+      throw pybind11::value_error(
+          "out must be writeable and hold one row per entity");
+    }
+  }
+
+  const uint64_t *entities = _entities.data();
+  double *data = result.mutable_data();
+  {
+    pybind11::gil_scoped_release release;
+    for (pybind11::ssize_t i = 0; i < count; ++i)
+    {
+      double *row = data + i * _width;
+      if (!_fill(_ecm, static_cast<Entity>(entities[i]), row))
+      {
+        std::fill(row, row + _width,
+            std::numeric_limits<double>::quiet_NaN());
+      }
+    }
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////
+/// \brief Write a pose as x, y, z, qw, qx, qy, qz.
+/// \param[in] _pose Pose.
+/// \param[out] _row Row to write to.
+void poseRow(const math::Pose3d &_pose, double *_row)
+{
+  _row[0] = _pose.Pos().X();
+  _row[1] = _pose.Pos().Y();
+  _row[2] = _pose.Pos().Z();
+  _row[3] = _pose.Rot().W();
+  _row[4] = _pose.Rot().X();
+  _row[5] = _pose.Rot().Y();
+  _row[6] = _pose.Rot().Z();
+}
+
+/////////////////////////////////////////////////
+/// \brief Bind a getter which returns a row of 3 values per entity from a
+/// vector component.
+/// \tparam ComponentTypeT Component holding a math::Vector3d.
+/// \return Function to bind.
+template <typename ComponentTypeT>
+auto vectorRows()
+{
+  return [](const EntityComponentManager &_ecm, const EntityArray &_entities,
+      const pybind11::object &_out)
+  {
+    return fillRows(_ecm, _entities, _out, 3,
+        [](const EntityComponentManager &_e, Entity _entity, double *_row)
+        {
+          auto comp = _e.Component<ComponentTypeT>(_entity);
+          if (nullptr == comp)
+            return false;
+          _row[0] = comp->Data().X();
+          _row[1] = comp->Data().Y();
+          _row[2] = comp->Data().Z();
+          return true;
+        });
+  };
+}
+
+/////////////////////////////////////////////////
+/// \brief Bind a getter which returns the first axis of a joint component.
+/// \tparam ComponentTypeT Component holding a value per joint axis.
+/// \return Function to bind.
+template <typename ComponentTypeT>
+auto axisValues()
+{
+  return [](const EntityComponentManager &_ecm, const EntityArray &_entities,
+      const pybind11::object &_out)
+  {
+    return fillRows(_ecm, _entities, _out, 1,
+        [](const EntityComponentManager &_e, Entity _entity, double *_row)
+        {
+          auto comp = _e.Component<ComponentTypeT>(_entity);
+          if (nullptr == comp || comp->Data().empty())
+            return false;
+          _row[0] = comp->Data().front();
+          return true;
+        });
+  };
+}
+
 /////////////////////////////////////////////////
 void defineGazeboEntityComponentManager(pybind11::object module)
 {
   pybind11::class_<ignition::gazebo::EntityComponentManager>(
       module, "EntityComponentManager")
-  .def(pybind11::init<>());
+  .def(pybind11::init<>())
+  .def(
+    "models", &entitiesWith<components::Model>,
+    "Get all model entities as an array.")
+  .def(
+    "links", &entitiesWith<components::Link>,
+    "Get all link entities as an array.")
+  .def(
+    "joints", &entitiesWith<components::Joint>,
+    "Get all joint entities as an array.")
+  .def(
+    "poses",
+    [](const EntityComponentManager &_ecm, const EntityArray &_entities,
+       const pybind11::object &_out)
+    {
+      return fillRows(_ecm, _entities, _out, 7,
+          [](const EntityComponentManager &_e, Entity _entity, double *_row)
+          {
+            auto comp = _e.Component<components::Pose>(_entity);
+            if (nullptr == comp)
+              return false;
+            poseRow(comp->Data(), _row);
+            return true;
+          });
+    },
+    pybind11::arg("entities"), pybind11::arg("out") = pybind11::none(),
+    "Get the poses of entities relative to their parents, as an (N, 7) "
+    "array of x, y, z, qw, qx, qy, qz. Rows of entities without a pose are "
+    "NaN. Pass an array as out to fill it instead of allocating one.")
+  .def(
+    "world_poses",
+    [](const EntityComponentManager &_ecm, const EntityArray &_entities,
+       const pybind11::object &_out)
+    {
+      return fillRows(_ecm, _entities, _out, 7,
+          [](const EntityComponentManager &_e, Entity _entity, double *_row)
+          {
+            if (nullptr == _e.Component<components::Pose>(_entity))
+              return false;
+            poseRow(worldPose(_entity, _e), _row);
+            return true;
+          });
+    },
+    pybind11::arg("entities"), pybind11::arg("out") = pybind11::none(),
+    "Get the world poses of entities, as an (N, 7) array of x, y, z, qw, qx, "
+    "qy, qz. Rows of entities without a pose are NaN.")
+  .def(
+    "world_linear_velocities", vectorRows<components::WorldLinearVelocity>(),
+    pybind11::arg("entities"), pybind11::arg("out") = pybind11::none(),
+    "Get the world linear velocities of links as an (N, 3) array. Physics "
+    "only computes them for links which have the component.")
+  .def(
+    "world_angular_velocities",
+    vectorRows<components::WorldAngularVelocity>(),
+    pybind11::arg("entities"), pybind11::arg("out") = pybind11::none(),
+    "Get the world angular velocities of links as an (N, 3) array. Physics "
+    "only computes them for links which have the component.")
+  .def(
+    "joint_positions", axisValues<components::JointPosition>(),
+    pybind11::arg("entities"), pybind11::arg("out") = pybind11::none(),
+    "Get the positions of the first axis of joints as an (N,) array. "
+    "Physics only computes them for joints which have the component.")
+  .def(
+    "joint_velocities", axisValues<components::JointVelocity>(),
+    pybind11::arg("entities"), pybind11::arg("out") = pybind11::none(),
+    "Get the velocities of the first axis of joints as an (N,) array. "
+    "Physics only computes them for joints which have the component.");
 }
 }  // namespace python
 }  // namespace gazebo
@@ -33,7 +33,13 @@ void defineGazeboServerConfig(pybind11::object module)
   .def(pybind11::init<>())
   .def(
     "set_sdf_file", &ignition::gazebo::ServerConfig::SetSdfFile,
-    "Set an SDF file to be used with the server.");
+    "Set an SDF file to be used with the server.")
+  .def(
+    "set_world_copies", &ignition::gazebo::ServerConfig::SetWorldCopies,
+    "Set the number of copies of each world to simulate.")
+  .def(
+    "world_copies", &ignition::gazebo::ServerConfig::WorldCopies,
+    "Number of copies of each world to simulate.");
 }
 }  // namespace python
 }  // namespace gazebo
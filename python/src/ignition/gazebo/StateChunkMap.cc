@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <pybind11/functional.h>
+#include <pybind11/stl.h>
+
+#include <vector>
+
+#include "StateChunkMap.hh"
+
+#include "StateChunkLog.hh"
+
+namespace ignition
+{
+namespace gazebo
+{
+namespace python
+{
+void
+defineGazeboStateChunkMap(pybind11::object module)
+{
+  using systems::StateChunkInfo;
+  using systems::StateChunkMap;
+  using systems::StateChunkRecord;
+  using systems::StateChunkStream;
+
+  pybind11::class_<StateChunkStream>(module, "StateChunkStream")
+  .def_readonly("entity", &StateChunkStream::entity,
+    "Entity the samples belong to.")
+  .def_readonly("type_id", &StateChunkStream::typeId,
+    "Type id of the sampled component.")
+  .def_readonly("times", &StateChunkStream::times,
+    "Sim time of each sample, in nanoseconds.")
+  .def_readonly("fields", &StateChunkStream::fields,
+    "One list per field, each with one value per sample.");
+
+  pybind11::class_<StateChunkRecord>(module, "StateChunkRecord")
+  .def_readonly("entity", &StateChunkRecord::entity,
+    "Entity the component belongs to.")
+  .def_readonly("type_id", &StateChunkRecord::typeId,
+    "Type id of the component, or zero if the entity was removed.")
+  .def_readonly("time", &StateChunkRecord::time,
+    "Sim time of the change, in nanoseconds.")
+  .def_readonly("remove", &StateChunkRecord::remove,
+    "True if the component or entity was removed.")
+  .def_property_readonly("data",
+    [](const StateChunkRecord &_record)
+    {
+      return pybind11::bytes(_record.data);
+    },
+    "Serialized component data.");
+
+  pybind11::class_<StateChunkInfo>(module, "StateChunkInfo")
+  .def_readonly("streams", &StateChunkInfo::streams,
+    "True if the chunk holds streams, false if it holds records.")
+  .def_readonly("start_time", &StateChunkInfo::startTime,
+    "Sim time of the first sample or record, in nanoseconds.")
+  .def_readonly("end_time", &StateChunkInfo::endTime,
+    "Sim time of the last sample or record, in nanoseconds.");
+
+  pybind11::class_<StateChunkMap>(module, "StateChunkMap")
+  .def(pybind11::init<>())
+  .def(
+    "open", &StateChunkMap::Open,
+    "Map a columnar state log, such as state.scl, and index its chunks.")
+  .def(
+    "close", &StateChunkMap::Close,
+    "Unmap the file.")
+  .def(
+    "is_open", &StateChunkMap::IsOpen,
+    "Whether a file is mapped.")
+  .def(
+    "resolution", &StateChunkMap::Resolution,
+    "Quantization resolution the file was written with.")
+  .def(
+    "has_index", &StateChunkMap::HasIndex,
+    "Whether the entity index written along with the log was loaded.")
+  .def(
+    "chunks", &StateChunkMap::Chunks,
+    "All complete chunks of the file, in the order they were written.")
+  .def(
+    "chunks_between", &StateChunkMap::ChunksBetween,
+    "Indices of the chunks which have data within a time range.")
+  .def(
+    "decode",
+    [](const StateChunkMap &_self, std::size_t _index)
+    {
+      std::vector<StateChunkStream> streams;
+      std::vector<StateChunkRecord> records;
+      _self.Decode(_index, streams, records);
+      return pybind11::make_tuple(streams, records);
+    },
+    "Decode one chunk into a tuple of streams and records.")
+  .def(
+    "sample",
+    [](StateChunkMap &_self, uint64_t _entity, uint64_t _typeId,
+       int64_t _time) -> pybind11::object
+    {
+      std::vector<double> values;
+      int64_t sampleTime;
+      if (!_self.Sample(_entity, _typeId, _time, values, sampleTime))
+        return pybind11::none();
+      return pybind11::make_tuple(sampleTime, values);
+    },
+    "Get the latest sample of a stream at or before a given time, as a "
+    "tuple of its time and values, or None.")
+  .def(
+    "entities", &StateChunkMap::Entities,
+    "All entities with data in the log.")
+  .def(
+    "entity_chunks", &StateChunkMap::EntityChunks,
+    "Chunks which hold data of an entity.")
+  .def(
+    "entity_history", &StateChunkMap::EntityHistory,
+    pybind11::arg("entity"),
+    pybind11::arg("on_stream") = nullptr,
+    pybind11::arg("on_record") = nullptr,
+    "Go through all data of one entity in the order it was recorded. Only "
+    "chunks which hold data of the entity are decoded. Callbacks return "
+    "False to stop.");
+}
+}  // namespace python
+}  // namespace gazebo
+}  // namespace ignition
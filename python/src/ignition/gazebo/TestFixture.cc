@@ -15,8 +15,11 @@
  *
 */
 #include <pybind11/functional.h>
+#include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 
+#include <cstdint>
+
 #include "TestFixture.hh"
 
 #include "ignition/gazebo/TestFixture.hh"
@@ -34,8 +37,25 @@ defineGazeboTestFixture(pybind11::object module)
 {
   pybind11::class_<TestFixture, std::shared_ptr<TestFixture>> testFixture(module, "TestFixture");
 
+  pybind11::enum_<TestFixture::Observation>(testFixture, "Observation")
+  .value("POSE", TestFixture::Observation::POSE)
+  .value("LINEAR_VELOCITY", TestFixture::Observation::LINEAR_VELOCITY)
+  .value("ANGULAR_VELOCITY", TestFixture::Observation::ANGULAR_VELOCITY)
+  .value("JOINT_POSITION", TestFixture::Observation::JOINT_POSITION)
+  .value("JOINT_VELOCITY", TestFixture::Observation::JOINT_VELOCITY);
+
+  pybind11::enum_<TestFixture::Action>(testFixture, "Action")
+  .value("JOINT_FORCE", TestFixture::Action::JOINT_FORCE)
+  .value("JOINT_VELOCITY", TestFixture::Action::JOINT_VELOCITY)
+  .value("LINEAR_VELOCITY", TestFixture::Action::LINEAR_VELOCITY)
+  .value("ANGULAR_VELOCITY", TestFixture::Action::ANGULAR_VELOCITY);
+
+  using Buffer = pybind11::array_t<double,
+      pybind11::array::c_style | pybind11::array::forcecast>;
+
   testFixture
   .def(pybind11::init<const std::string &>())
+  .def(pybind11::init<const ServerConfig &>())
   .def(
     "server", &TestFixture::Server,
     pybind11::return_value_policy::reference,
@@ -78,7 +98,82 @@ defineGazeboTestFixture(pybind11::object module)
     ),
     pybind11::return_value_policy::reference,
     "Wrapper around a system's post-update callback"
-  );
+  )
+  .def(
+    "add_observation", &TestFixture::AddObservation,
+    "Add a value to the observations of each world, before finalizing. "
+    "Returns its offset within each row of observations.")
+  .def(
+    "add_action", &TestFixture::AddAction,
+    "Add a command to the actions of each world, before finalizing. "
+    "Returns its offset within each row of actions.")
+  .def(
+    "observation_size", &TestFixture::ObservationSize,
+    "Number of values in each world's row of observations.")
+  .def(
+    "action_size", &TestFixture::ActionSize,
+    "Number of values in each world's row of actions.")
+  .def(
+    "world_count", &TestFixture::WorldCount,
+    "Number of worlds in the server, including world copies.")
+  .def(
+    "step",
+    [](TestFixture &_self, Buffer _actions, pybind11::object _observations,
+       uint64_t _iterations) -> pybind11::object
+    {
+      const auto worldCount = _self.WorldCount();
+      if (static_cast<std::size_t>(_actions.size()) !=
+          worldCount * _self.ActionSize())
+      {
+        throw pybind11::value_error("Expected world_count() * action_size() "
+            "actions");
+      }
+
+      // Reuse the caller's array if it has the right layout, so each step
+      // doesn't allocate
+      Buffer observations;
+      if (!_observations.is_none())
+      {
+        if (!pybind11::isinstance<Buffer>(_observations))
+        {
+          throw pybind11::value_error("Observations must be a contiguous "
+              "float64 array");
+        }
+        observations = pybind11::reinterpret_borrow<Buffer>(_observations);
+        if (!observations.writeable() ||
+            static_cast<std::size_t>(observations.size()) !=
+            worldCount * _self.ObservationSize())
+        {
+          throw pybind11::value_error("Observations must be writeable and "
+              "hold world_count() * observation_size() values");
+        }
+      }
+      else
+      {
+        observations = Buffer({static_cast<pybind11::ssize_t>(worldCount),
+            static_cast<pybind11::ssize_t>(_self.ObservationSize())});
+      }
+
+      const double *actionData = _actions.data();
+      double *observationData = observations.mutable_data();
+      bool result;
+      {
+        pybind11::gil_scoped_release release;
+        result = _self.Step(actionData, observationData, _iterations);
+      }
+
+      if (!result)
+        return pybind11::none();
+      return std::move(observations);
+    },
+    pybind11::arg("actions"),
+    pybind11::arg("observations") = pybind11::none(),
+    pybind11::arg("iterations") = 1u,
+    "Apply a (world_count, action_size) array of actions to all worlds, "
+    "step all of them in parallel and return a (world_count, "
+    "observation_size) array of observations, or None if stepping failed. "
+    "Pass an array as observations to have it filled instead of allocating "
+    "a new one.");
   // TODO(ahcorde): This method is not compiling for the following reason:
   // The EventManager class has an unordered_map which holds a unique_ptr
   // This make the class uncopyable, anyhow we should not copy the class
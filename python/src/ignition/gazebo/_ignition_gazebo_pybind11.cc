@@ -16,10 +16,12 @@
 
 #include <pybind11/pybind11.h>
 
+#include "CameraBatch.hh"
 #include "EntityComponentManager.hh"
 #include "EventManager.hh"
 #include "Server.hh"
 #include "ServerConfig.hh"
+#include "StateChunkMap.hh"
 #include "TestFixture.hh"
 #include "UpdateInfo.hh"
 #include "Util.hh"
@@ -28,10 +30,12 @@
 PYBIND11_MODULE(gazebo, m) {
   m.doc() = "Ignition Gazebo Python Library.";
 
+  ignition::gazebo::python::defineGazeboCameraBatch(m);
   ignition::gazebo::python::defineGazeboEntityComponentManager(m);
   ignition::gazebo::python::defineGazeboEventManager(m);
   ignition::gazebo::python::defineGazeboServer(m);
   ignition::gazebo::python::defineGazeboServerConfig(m);
+  ignition::gazebo::python::defineGazeboStateChunkMap(m);
   ignition::gazebo::python::defineGazeboTestFixture(m);
   ignition::gazebo::python::defineGazeboUpdateInfo(m);
   ignition::gazebo::python::defineGazeboWorld(m);
@@ -15,8 +15,10 @@
 import os
 import unittest
 
+import numpy as np
+
 from ignition.common import set_verbosity
-from ignition.gazebo import TestFixture, World, world_entity
+from ignition.gazebo import ServerConfig, TestFixture, World, world_entity
 from ignition.math import Vector3d
 from sdformat import Element
 
@@ -61,5 +63,53 @@ class TestTestFixture(unittest.TestCase):
         self.assertEqual(1000, iterations)
         self.assertEqual(1000, post_iterations)
 
+    def test_batched_step(self):
+        file_path = os.path.dirname(os.path.realpath(__file__))
+        config = ServerConfig()
+        config.set_sdf_file(os.path.join(file_path, 'gravity.sdf'))
+        config.set_world_copies(3)
+        helper = TestFixture(config)
+
+        self.assertEqual(0, helper.add_observation(
+            'falling::link', TestFixture.Observation.POSE))
+        self.assertEqual(7, helper.add_observation(
+            'falling::link', TestFixture.Observation.LINEAR_VELOCITY))
+
+        link_poses = []
+
+        def on_post_update_cb(_info, _ecm):
+            links = _ecm.links()
+            self.assertEqual(1, len(links))
+            self.assertEqual(0, len(_ecm.joint_positions(_ecm.joints())))
+            link_poses.append(_ecm.world_poses(links))
+
+        helper.on_post_update(on_post_update_cb)
+        helper.finalize()
+
+        self.assertEqual(3, helper.world_count())
+        self.assertEqual(10, helper.observation_size())
+        self.assertEqual(0, helper.action_size())
+
+        actions = np.zeros((3, 0))
+        observations = helper.step(actions, iterations=100)
+        self.assertEqual((3, 10), observations.shape)
+
+        # The callback only runs in the first world
+        self.assertEqual(100, len(link_poses))
+        self.assertEqual((1, 7), link_poses[-1].shape)
+        np.testing.assert_allclose(observations[0, :7], link_poses[-1][0])
+
+        # All copies fall the same way
+        for world in range(3):
+            self.assertLess(observations[world, 2], 0.0)
+            self.assertLess(observations[world, 9], 0.0)
+            self.assertAlmostEqual(observations[0, 2], observations[world, 2])
+
+        # Filling the same array again
+        previous_z = observations[0, 2]
+        self.assertIs(observations,
+                      helper.step(actions, observations, 100))
+        self.assertLess(observations[0, 2], previous_z)
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "AxisAlignedBoxGrid.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Boxes covering more cells than this are tested on every query
+/// instead, so a single huge box doesn't blow up the grid.
+static const int64_t kMaxCellsPerBox{1024};
+
+/// \brief Cell coordinates are clamped to this range so out of range
+/// positions still map to valid cells.
+static const double kMaxCell{1e9};
+
+//////////////////////////////////////////////////
+void AxisAlignedBoxGrid::Build(const std::vector<math::AxisAlignedBox> &_boxes)
+{
+  this->boxes = _boxes;
+  this->cells.clear();
+  this->oversized.clear();
+  this->visited.assign(this->boxes.size(), 0u);
+  this->queryCount = 0u;
+
+  // Cells roughly as large as a typical box, so each box only touches a few
+  // cells and each cell only holds a few boxes
+  std::vector<double> sizes;
+  for (const auto &box : this->boxes)
+  {
+    double size = std::max(box.XLength(), box.YLength());
+    if (std::isfinite(size) && size > 0.0)
+      sizes.push_back(size);
+  }
+  this->cellSize = 1.0;
+  if (!sizes.empty())
+  {
+    auto median = sizes.begin() + sizes.size() / 2;
+    std::nth_element(sizes.begin(), median, sizes.end());
+    this->cellSize = *median;
+  }
+
+  for (std::size_t i = 0; i < this->boxes.size(); ++i)
+  {
+    const auto &box = this->boxes[i];
+    const auto &min = box.Min();
+    const auto &max = box.Max();
+    if (!std::isfinite(min.X()) || !std::isfinite(min.Y()) ||
+        !std::isfinite(max.X()) || !std::isfinite(max.Y()))
+    {
+      this->oversized.push_back(i);
+      continue;
+    }
+
+    int64_t x0 = this->Cell(min.X());
+    int64_t x1 = this->Cell(max.X());
+    int64_t y0 = this->Cell(min.Y());
+    int64_t y1 = this->Cell(max.Y());
+    if ((x1 - x0 + 1) * (y1 - y0 + 1) > kMaxCellsPerBox)
+    {
+      this->oversized.push_back(i);
+      continue;
+    }
+
+    for (int64_t x = x0; x <= x1; ++x)
+    {
+      for (int64_t y = y0; y <= y1; ++y)
+        this->cells[this->Key(x, y)].push_back(i);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void AxisAlignedBoxGrid::Query(const math::AxisAlignedBox &_box,
+    std::vector<std::size_t> &_result) const
+{
+  _result.clear();
+  if (this->boxes.empty())
+    return;
+
+  const uint64_t query = ++this->queryCount;
+  auto test = [&](std::size_t _index)
+  {
+    if (this->visited[_index] == query)
+      return;
+    this->visited[_index] = query;
+    if (this->boxes[_index].Intersects(_box))
+      _result.push_back(_index);
+  };
+
+  for (auto index : this->oversized)
+    test(index);
+
+  int64_t x0 = this->Cell(_box.Min().X());
+  int64_t x1 = this->Cell(_box.Max().X());
+  int64_t y0 = this->Cell(_box.Min().Y());
+  int64_t y1 = this->Cell(_box.Max().Y());
+
+  // Very large queries are cheaper as a linear scan
+  if (x1 < x0 || y1 < y0 ||
+      (x1 - x0 + 1) * (y1 - y0 + 1) > static_cast<int64_t>(this->cells.size()))
+  {
+    for (std::size_t i = 0; i < this->boxes.size(); ++i)
+      test(i);
+    return;
+  }
+
+  for (int64_t x = x0; x <= x1; ++x)
+  {
+    for (int64_t y = y0; y <= y1; ++y)
+    {
+      auto it = this->cells.find(this->Key(x, y));
+      if (it == this->cells.end())
+        continue;
+      for (auto index : it->second)
+        test(index);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+std::size_t AxisAlignedBoxGrid::Size() const
+{
+  return this->boxes.size();
+}
+
+//////////////////////////////////////////////////
+double AxisAlignedBoxGrid::CellSize() const
+{
+  return this->boxes.empty() ? 0.0 : this->cellSize;
+}
+
+//////////////////////////////////////////////////
+int64_t AxisAlignedBoxGrid::Key(int64_t _x, int64_t _y) const
+{
+  return static_cast<int64_t>((static_cast<uint64_t>(_x) << 32) ^
+      (static_cast<uint64_t>(_y) & 0xFFFFFFFFu));
+}
+
+//////////////////////////////////////////////////
+int64_t AxisAlignedBoxGrid::Cell(double _value) const
+{
+  double cell = std::floor(_value / this->cellSize);
+  if (std::isnan(cell))
+    return 0;
+  return static_cast<int64_t>(std::clamp(cell, -kMaxCell, kMaxCell));
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_AXISALIGNEDBOXGRID_HH_
+#define IGNITION_GAZEBO_AXISALIGNEDBOXGRID_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <ignition/math/AxisAlignedBox.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class AxisAlignedBoxGrid AxisAlignedBoxGrid.hh
+    /// \brief Uniform grid over the horizontal plane used to quickly find
+    /// which of many static boxes overlap a query box.
+    ///
+    /// Each box is added to all the cells it touches. Queries only test the
+    /// boxes in the cells touched by the query box, so their cost depends on
+    /// how many boxes are nearby instead of on the total number of boxes.
+    /// The grid is meant to be built once and queried many times, so it
+    /// must be rebuilt whenever the boxes change.
+    class IGNITION_GAZEBO_VISIBLE AxisAlignedBoxGrid
+    {
+      /// \brief Build the grid. The cell size is chosen from the boxes'
+      /// horizontal size.
+      /// \param[in] _boxes Boxes to index. Their indices in this vector are
+      /// returned by queries.
+      public: void Build(const std::vector<math::AxisAlignedBox> &_boxes);
+
+      /// \brief Find all boxes which intersect a box.
+      /// \param[in] _box Query box.
+      /// \param[out] _result Indices of intersecting boxes, in no particular
+      /// order. It's cleared first.
+      public: void Query(const math::AxisAlignedBox &_box,
+          std::vector<std::size_t> &_result) const;
+
+      /// \brief Number of boxes in the grid.
+      /// \return Number of boxes.
+      public: std::size_t Size() const;
+
+      /// \brief Size of each cell in meters.
+      /// \return Cell size, zero before building.
+      public: double CellSize() const;
+
+      /// \brief Compute the key of the cell containing a point.
+      /// \param[in] _x X coordinate.
+      /// \param[in] _y Y coordinate.
+      /// \return Cell key.
+      private: int64_t Key(int64_t _x, int64_t _y) const;
+
+      /// \brief Compute the cell coordinate of a position along one axis.
+      /// \param[in] _value Position in meters.
+      /// \return Cell coordinate.
+      private: int64_t Cell(double _value) const;
+
+      /// \brief All boxes.
+      private: std::vector<math::AxisAlignedBox> boxes;
+
+      /// \brief Boxes in each cell.
+      private: std::unordered_map<int64_t, std::vector<std::size_t>> cells;
+
+      /// \brief Boxes which would cover too many cells, or have
+      /// non-finite bounds. These are always tested.
+      private: std::vector<std::size_t> oversized;
+
+      /// \brief Size of each cell in meters.
+      private: double cellSize{0.0};
+
+      /// \brief Last query in which each box was tested, so boxes which are
+      /// in multiple cells are only reported once.
+      private: mutable std::vector<uint64_t> visited;
+
+      /// \brief Counter incremented on every query.
+      private: mutable uint64_t queryCount{0};
+    };
+    }
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_AXISALIGNEDBOXGRID_HH_
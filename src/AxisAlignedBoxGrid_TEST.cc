@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <ignition/math/AxisAlignedBox.hh>
+
+#include "AxisAlignedBoxGrid.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+/// \brief Brute force version of AxisAlignedBoxGrid::Query.
+std::vector<std::size_t> Intersecting(
+    const std::vector<math::AxisAlignedBox> &_boxes,
+    const math::AxisAlignedBox &_box)
+{
+  std::vector<std::size_t> result;
+  for (std::size_t i = 0; i < _boxes.size(); ++i)
+  {
+    if (_boxes[i].Intersects(_box))
+      result.push_back(i);
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////
+TEST(AxisAlignedBoxGrid, Empty)
+{
+  AxisAlignedBoxGrid grid;
+  EXPECT_EQ(0u, grid.Size());
+  EXPECT_DOUBLE_EQ(0.0, grid.CellSize());
+
+  std::vector<std::size_t> result{1u, 2u};
+  grid.Query(math::AxisAlignedBox(math::Vector3d(0, 0, 0),
+      math::Vector3d(1, 1, 1)), result);
+  EXPECT_TRUE(result.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(AxisAlignedBoxGrid, MatchesBruteForce)
+{
+  // Tiles of 10 m, with some taller and overlapping ones, including
+  // negative coordinates
+  std::vector<math::AxisAlignedBox> boxes;
+  for (int x = -10; x < 10; ++x)
+  {
+    for (int y = -10; y < 10; ++y)
+    {
+      boxes.emplace_back(math::Vector3d(x * 10.0 - 1.0, y * 10.0 - 1.0, 0.0),
+          math::Vector3d(x * 10.0 + 11.0, y * 10.0 + 11.0, (x + y) % 3 + 1.0));
+    }
+  }
+
+  // A huge box and an infinite one are always tested
+  const double inf = std::numeric_limits<double>::infinity();
+  boxes.emplace_back(math::Vector3d(-1e6, -1e6, 0),
+      math::Vector3d(1e6, 1e6, 1));
+  boxes.emplace_back(math::Vector3d(-inf, 5, 0), math::Vector3d(inf, 6, 1));
+
+  AxisAlignedBoxGrid grid;
+  grid.Build(boxes);
+  EXPECT_EQ(boxes.size(), grid.Size());
+  EXPECT_DOUBLE_EQ(12.0, grid.CellSize());
+
+  std::vector<std::size_t> result;
+  for (double x = -120.0; x < 120.0; x += 7.3)
+  {
+    for (double y = -120.0; y < 120.0; y += 9.1)
+    {
+      for (double size : {0.5, 4.0, 30.0})
+      {
+        math::AxisAlignedBox query(math::Vector3d(x, y, 0.5),
+            math::Vector3d(x + size, y + size, 1.5));
+        grid.Query(query, result);
+        std::sort(result.begin(), result.end());
+        EXPECT_EQ(Intersecting(boxes, query), result) << x << " " << y;
+      }
+    }
+  }
+
+  // Queries larger than the grid
+  math::AxisAlignedBox everything(math::Vector3d(-1e7, -1e7, -1e7),
+      math::Vector3d(1e7, 1e7, 1e7));
+  grid.Query(everything, result);
+  EXPECT_EQ(boxes.size(), result.size());
+}
@@ -82,19 +82,46 @@ const std::set<ComponentTypeId> &BaseView::ComponentTypes() const
   return this->componentTypes;
 }
 
+//////////////////////////////////////////////////
+void BaseView::SortEntities()
+{
+  this->entities.sort();
+  this->newEntities.sort();
+  this->toRemoveEntities.sort();
+}
+
+//////////////////////////////////////////////////
 const std::set<Entity> &BaseView::Entities() const
 {
-  return this->entities;
+  return this->orderedEntities.From(this->entities);
 }
 
 //////////////////////////////////////////////////
 const std::set<Entity> &BaseView::NewEntities() const
 {
-  return this->newEntities;
+  return this->orderedNewEntities.From(this->newEntities);
 }
 
 //////////////////////////////////////////////////
 const std::set<Entity> &BaseView::ToRemoveEntities() const
+{
+  return this->orderedToRemoveEntities.From(this->toRemoveEntities);
+}
+
+//////////////////////////////////////////////////
+const EntitySet &BaseView::DenseEntities() const
+{
+  return this->entities;
+}
+
+//////////////////////////////////////////////////
+const EntitySet &BaseView::DenseNewEntities() const
+{
+  return this->newEntities;
+}
+
+//////////////////////////////////////////////////
+const EntitySet &BaseView::DenseToRemoveEntities() const
 {
   return this->toRemoveEntities;
 }
@@ -110,3 +137,11 @@ void BaseView::ClearToAddEntities()
 {
   this->toAddEntities.clear();
 }
+
+//////////////////////////////////////////////////
+std::size_t BaseView::MemoryUsage() const
+{
+  return this->entities.memoryUsage() + this->newEntities.memoryUsage() +
+      this->toRemoveEntities.memoryUsage() +
+      unorderedMemoryUsage(this->toAddEntities);
+}
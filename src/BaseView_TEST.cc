@@ -17,6 +17,11 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
 #include <ignition/common/Console.hh>
 
 #include "ignition/gazebo/Entity.hh"
@@ -53,6 +58,176 @@ TEST_F(BaseViewTest, ComponentTypes)
   EXPECT_FALSE(modelNameView.RequiresComponent(components::Visual::typeId));
 }
 
+/////////////////////////////////////////////////
+TEST_F(BaseViewTest, EntitySet)
+{
+  detail::EntitySet set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_TRUE(set.sorted());
+
+  EXPECT_TRUE(set.insert(3));
+  EXPECT_TRUE(set.insert(5));
+  EXPECT_TRUE(set.insert(8));
+  EXPECT_FALSE(set.insert(5));
+  EXPECT_EQ(3u, set.size());
+  EXPECT_TRUE(set.sorted());
+
+  // inserting a smaller entity breaks the order
+  EXPECT_TRUE(set.insert(1));
+  EXPECT_FALSE(set.sorted());
+  set.sort();
+  EXPECT_TRUE(set.sorted());
+  EXPECT_EQ((std::vector<Entity>{1, 3, 5, 8}),
+      std::vector<Entity>(set.begin(), set.end()));
+
+  // removing from the middle swaps the last entity in
+  EXPECT_EQ(1u, set.erase(3));
+  EXPECT_EQ(0u, set.erase(3));
+  EXPECT_EQ(3u, set.size());
+  EXPECT_EQ(0u, set.count(3));
+  EXPECT_EQ(set.end(), set.find(3));
+  EXPECT_FALSE(set.sorted());
+
+  // lookups still work before sorting
+  for (const Entity entity : {1u, 5u, 8u})
+  {
+    auto it = set.find(entity);
+    ASSERT_NE(set.end(), it);
+    EXPECT_EQ(entity, *it);
+    EXPECT_EQ(1u, set.count(entity));
+  }
+
+  set.sort();
+  EXPECT_EQ((std::vector<Entity>{1, 5, 8}),
+      std::vector<Entity>(set.begin(), set.end()));
+  for (const Entity entity : {1u, 5u, 8u})
+    EXPECT_EQ(entity, *set.find(entity));
+
+  // removing the last entity keeps the order
+  EXPECT_EQ(1u, set.erase(8));
+  EXPECT_TRUE(set.sorted());
+
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(set.end(), set.find(1));
+}
+
+/////////////////////////////////////////////////
+TEST_F(BaseViewTest, EntitySetChangedWhileIterating)
+{
+  detail::EntitySet set;
+  for (Entity entity = 1; entity <= 6; ++entity)
+    set.insert(entity);
+
+  // Erasing entities which weren't visited yet skips them, erasing visited
+  // ones doesn't skip others, and inserted entities are visited at the end,
+  // even if inserting reallocates the array
+  std::vector<Entity> visited;
+  set.forEach([&](const Entity _entity)
+  {
+    visited.push_back(_entity);
+    if (_entity == 2)
+    {
+      EXPECT_EQ(1u, set.erase(5));
+      EXPECT_EQ(1u, set.erase(1));
+      EXPECT_EQ(1u, set.erase(2));
+      for (Entity entity = 100; entity < 200; ++entity)
+        set.insert(entity);
+    }
+    if (_entity == 3)
+    {
+      // Sorting waits for the iteration to end
+      set.sort();
+    }
+    return _entity < 150;
+  });
+
+  std::vector<Entity> expected{1, 2, 3, 4, 6};
+  for (Entity entity = 100; entity <= 150; ++entity)
+    expected.push_back(entity);
+  EXPECT_EQ(expected, visited);
+
+  // Holes are removed by the next change
+  EXPECT_EQ(103u, set.size());
+  EXPECT_EQ(0u, set.count(5));
+  EXPECT_TRUE(set.insert(5));
+  EXPECT_FALSE(set.sorted());
+  set.sort();
+  EXPECT_EQ(104u, std::vector<Entity>(set.begin(), set.end()).size());
+  EXPECT_EQ(3u, *set.begin());
+  for (const Entity entity : {3u, 4u, 5u, 6u, 100u, 199u})
+    EXPECT_EQ(entity, *set.find(entity));
+
+  // Nested iterations keep entities in place until the outer one ends
+  std::size_t count{0u};
+  set.forEach([&](const Entity _outer)
+  {
+    set.forEach([&](const Entity _inner)
+    {
+      if (_inner != _outer)
+        set.erase(_inner);
+      return true;
+    });
+    ++count;
+    return true;
+  });
+  EXPECT_EQ(1u, count);
+  EXPECT_EQ(1u, set.size());
+  EXPECT_EQ(1u, set.count(3));
+
+  // Ordered copies follow changes
+  detail::OrderedEntities ordered;
+  EXPECT_EQ(std::set<Entity>{3}, ordered.From(set));
+  set.insert(1);
+  EXPECT_EQ((std::set<Entity>{1, 3}), ordered.From(set));
+}
+
+/////////////////////////////////////////////////
+TEST_F(BaseViewTest, EntitySetIteratedConcurrently)
+{
+  detail::EntitySet set;
+  for (Entity entity = 1; entity <= 100; ++entity)
+    set.insert(entity);
+
+  // Const iterations from many threads, as parallel systems do
+  const detail::EntitySet &constSet = set;
+  std::atomic<std::size_t> visited{0u};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t)
+  {
+    threads.emplace_back([&]
+    {
+      for (int i = 0; i < 1000; ++i)
+      {
+        constSet.forEach([&](const Entity)
+        {
+          ++visited;
+          return true;
+        });
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  EXPECT_EQ(8u * 1000u * 100u, visited.load());
+
+  // No iteration is left over, so erasing swaps and sorting works again
+  EXPECT_EQ(1u, set.erase(1));
+  EXPECT_EQ(99u, std::vector<Entity>(set.begin(), set.end()).size());
+  EXPECT_FALSE(set.sorted());
+  set.sort();
+  EXPECT_TRUE(set.sorted());
+
+  // Copies aren't being iterated over
+  set.forEach([&](const Entity)
+  {
+    detail::EntitySet copy = set;
+    EXPECT_EQ(1u, copy.erase(2));
+    EXPECT_EQ(98u, std::vector<Entity>(copy.begin(), copy.end()).size());
+    return false;
+  });
+}
+
 /////////////////////////////////////////////////
 TEST_F(BaseViewTest, ToAddEntities)
 {
@@ -474,6 +649,46 @@ TEST_F(BaseViewTest, ComponentChangeNotification)
   EXPECT_EQ(view.NewEntities().end(), view.NewEntities().find(e2));
 }
 
+/////////////////////////////////////////////////
+TEST_F(BaseViewTest, ComponentData)
+{
+  auto view =
+      detail::View({components::Model::typeId, components::Name::typeId});
+
+  const Entity count{200};
+  std::vector<components::Model> models(count);
+  std::vector<components::Name> names(count);
+  for (Entity e = 0; e < count; ++e)
+  {
+    view.AddEntityWithComps(e, false, &models[e], &names[e]);
+    view.AddEntityWithConstComps(e, false, &models[e], &names[e]);
+  }
+  EXPECT_EQ(count, view.Entities().size());
+
+  // Each entity keeps its own components
+  for (Entity e = 0; e < count; ++e)
+  {
+    const auto &data = view.EntityComponentData(e);
+    ASSERT_EQ(2u, data.size());
+    EXPECT_EQ(&models[e], data[0]);
+    EXPECT_EQ(&names[e], data[1]);
+    EXPECT_EQ(&names[e], view.EntityComponentConstData(e)[1]);
+  }
+
+  // Removed entities can be added back with other components
+  for (Entity e = 0; e < 50; ++e)
+    EXPECT_TRUE(view.RemoveEntity(e));
+  for (Entity e = 0; e < 50; ++e)
+  {
+    view.AddEntityWithComps(e, false, &models[count - 1 - e],
+        &names[count - 1 - e]);
+    view.AddEntityWithConstComps(e, false, &models[count - 1 - e],
+        &names[count - 1 - e]);
+  }
+  EXPECT_EQ(&models[count - 1], view.EntityComponentData(0)[0]);
+  EXPECT_EQ(&models[count - 1], view.EntityComponentData(count - 1)[0]);
+}
+
 /////////////////////////////////////////////////
 TEST_F(BaseViewTest, ComponentTypeHasher)
 {
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ignition/gazebo/BatteryTable.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "ignition/gazebo/components/BatterySoC.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/TraceRecorder.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Private data of BatteryTable
+class ignition::gazebo::BatteryTablePrivate
+{
+  /// \brief Gather all batteries and index them.
+  /// \param[in] _ecm Entity component manager.
+  public: void Build(const EntityComponentManager &_ecm);
+
+  /// \brief Batteries, grouped by model.
+  public: std::vector<Entity> batteries;
+
+  /// \brief First position in `batteries` and number of batteries of each
+  /// model.
+  public: std::unordered_map<Entity, std::pair<uint32_t, uint32_t>> models;
+
+  /// \brief Batteries by name.
+  public: std::unordered_map<std::string, std::vector<Entity>> names;
+
+  /// \brief Iteration and entity count when the table was last built.
+  public: std::optional<std::pair<uint64_t, std::size_t>> built;
+
+  /// \brief Protects the table.
+  public: mutable std::shared_mutex mutex;
+};
+
+//////////////////////////////////////////////////
+void BatteryTablePrivate::Build(const EntityComponentManager &_ecm)
+{
+  std::vector<std::pair<Entity, Entity>> modelBatteries;
+  this->names.clear();
+  _ecm.Each<components::BatterySoC>(
+      [&](const Entity &_entity, const components::BatterySoC *) -> bool
+      {
+        modelBatteries.emplace_back(_ecm.ParentEntity(_entity), _entity);
+        auto nameComp = _ecm.Component<components::Name>(_entity);
+        if (nameComp)
+          this->names[nameComp->Data()].push_back(_entity);
+        return true;
+      });
+  std::sort(modelBatteries.begin(), modelBatteries.end());
+
+  this->batteries.clear();
+  this->models.clear();
+  for (const auto &[model, battery] : modelBatteries)
+  {
+    auto &range = this->models.emplace(model,
+        std::make_pair(static_cast<uint32_t>(this->batteries.size()), 0u))
+        .first->second;
+    ++range.second;
+    this->batteries.push_back(battery);
+  }
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<BatteryTable> BatteryTable::For(
+    const EntityComponentManager &_ecm)
+{
+  static std::mutex mutex;
+  static std::unordered_map<const EntityComponentManager *,
+      std::weak_ptr<BatteryTable>> tables;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // Forget tables which are no longer used
+  for (auto it = tables.begin(); it != tables.end();)
+  {
+    if (it->second.expired())
+      it = tables.erase(it);
+    else
+      ++it;
+  }
+
+  auto &weak = tables[&_ecm];
+  auto table = weak.lock();
+  if (!table)
+  {
+    table = std::make_shared<BatteryTable>();
+    weak = table;
+  }
+  return table;
+}
+
+//////////////////////////////////////////////////
+BatteryTable::BatteryTable()
+  : dataPtr(std::make_unique<BatteryTablePrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+BatteryTable::~BatteryTable() = default;
+
+//////////////////////////////////////////////////
+void BatteryTable::Update(const UpdateInfo &_info,
+    const EntityComponentManager &_ecm)
+{
+  // Entities created later in an iteration change the count. Removals are
+  // processed at the end of iterations, and entities created and removed
+  // in the same iteration are caught by the new and removed flags.
+  const std::pair<uint64_t, std::size_t> key{_info.iterations,
+      _ecm.EntityCount()};
+  {
+    std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+    const auto &built = this->dataPtr->built;
+    if (built && built->second == key.second &&
+        (built->first == key.first ||
+         (!_ecm.HasNewEntities() && !_ecm.HasEntitiesMarkedForRemoval())))
+    {
+      return;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+  if (this->dataPtr->built && *this->dataPtr->built == key)
+    return;
+
+  IGN_GAZEBO_PROFILE("BatteryTable::Update");
+  this->dataPtr->Build(_ecm);
+  this->dataPtr->built = key;
+}
+
+//////////////////////////////////////////////////
+std::size_t BatteryTable::Size() const
+{
+  std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->batteries.size();
+}
+
+//////////////////////////////////////////////////
+std::vector<Entity> BatteryTable::Batteries(Entity _model) const
+{
+  std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+  auto it = this->dataPtr->models.find(_model);
+  if (it == this->dataPtr->models.end())
+    return {};
+
+  auto first = this->dataPtr->batteries.begin() + it->second.first;
+  return std::vector<Entity>(first, first + it->second.second);
+}
+
+//////////////////////////////////////////////////
+std::vector<Entity> BatteryTable::BatteriesByName(
+    const std::string &_name) const
+{
+  std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+  auto it = this->dataPtr->names.find(_name);
+  if (it == this->dataPtr->names.end())
+    return {};
+  return it->second;
+}
+
+//////////////////////////////////////////////////
+bool BatteryTable::HasCharge(Entity _model,
+    const EntityComponentManager &_ecm) const
+{
+  std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+  auto it = this->dataPtr->models.find(_model);
+  if (it == this->dataPtr->models.end())
+    return true;
+
+  for (uint32_t i = 0; i < it->second.second; ++i)
+  {
+    auto soc = _ecm.Component<components::BatterySoC>(
+        this->dataPtr->batteries[it->second.first + i]);
+    if (soc && soc->Data() <= 0)
+      return false;
+  }
+  return true;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "ignition/gazebo/BatteryTable.hh"
+#include "ignition/gazebo/components/BatterySoC.hh"
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Create a battery of a model.
+Entity CreateBattery(EntityComponentManager &_ecm, Entity _model,
+    const std::string &_name, double _soc)
+{
+  auto entity = _ecm.CreateEntity();
+  _ecm.SetParentEntity(entity, _model);
+  _ecm.CreateComponent(entity, components::ParentEntity(_model));
+  _ecm.CreateComponent(entity, components::Name(_name));
+  _ecm.CreateComponent(entity, components::BatterySoC(_soc));
+  return entity;
+}
+
+/////////////////////////////////////////////////
+TEST(BatteryTable, SharedPerEcm)
+{
+  EntityComponentManager ecm;
+  EntityComponentManager otherEcm;
+
+  auto table = BatteryTable::For(ecm);
+  ASSERT_NE(nullptr, table);
+  EXPECT_EQ(table, BatteryTable::For(ecm));
+  EXPECT_NE(table, BatteryTable::For(otherEcm));
+}
+
+/////////////////////////////////////////////////
+TEST(BatteryTable, Queries)
+{
+  EntityComponentManager ecm;
+  auto model1 = ecm.CreateEntity();
+  ecm.CreateComponent(model1, components::Model());
+  auto model2 = ecm.CreateEntity();
+  ecm.CreateComponent(model2, components::Model());
+  auto model3 = ecm.CreateEntity();
+  ecm.CreateComponent(model3, components::Model());
+
+  auto battery1 = CreateBattery(ecm, model1, "battery", 1.0);
+  auto battery2 = CreateBattery(ecm, model2, "battery", 1.0);
+  auto battery3 = CreateBattery(ecm, model2, "spare", 0.5);
+
+  BatteryTable table;
+  UpdateInfo info;
+  info.iterations = 1;
+  table.Update(info, ecm);
+  EXPECT_EQ(3u, table.Size());
+
+  EXPECT_EQ(std::vector<Entity>{battery1}, table.Batteries(model1));
+  auto batteries = table.Batteries(model2);
+  std::sort(batteries.begin(), batteries.end());
+  EXPECT_EQ((std::vector<Entity>{battery2, battery3}), batteries);
+  EXPECT_TRUE(table.Batteries(model3).empty());
+
+  batteries = table.BatteriesByName("battery");
+  std::sort(batteries.begin(), batteries.end());
+  EXPECT_EQ((std::vector<Entity>{battery1, battery2}), batteries);
+  EXPECT_EQ(std::vector<Entity>{battery3}, table.BatteriesByName("spare"));
+  EXPECT_TRUE(table.BatteriesByName("none").empty());
+
+  // States of charge are read when queried
+  EXPECT_TRUE(table.HasCharge(model1, ecm));
+  EXPECT_TRUE(table.HasCharge(model2, ecm));
+  EXPECT_TRUE(table.HasCharge(model3, ecm));
+  ecm.Component<components::BatterySoC>(battery3)->Data() = 0.0;
+  EXPECT_TRUE(table.HasCharge(model1, ecm));
+  EXPECT_FALSE(table.HasCharge(model2, ecm));
+}
+
+/////////////////////////////////////////////////
+TEST(BatteryTable, Update)
+{
+  EntityComponentManager ecm;
+  auto model = ecm.CreateEntity();
+  ecm.CreateComponent(model, components::Model());
+  CreateBattery(ecm, model, "battery", 1.0);
+
+  auto table = BatteryTable::For(ecm);
+  UpdateInfo info;
+  info.iterations = 1;
+  table->Update(info, ecm);
+  EXPECT_EQ(1u, table->Size());
+
+  // Batteries added later in the same iteration
+  CreateBattery(ecm, model, "drained", 0.0);
+  table->Update(info, ecm);
+  EXPECT_EQ(2u, table->Size());
+  EXPECT_FALSE(table->HasCharge(model, ecm));
+}
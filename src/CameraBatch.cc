@@ -0,0 +1,389 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ignition/gazebo/CameraBatch.hh"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <new>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+#include <ignition/common/Console.hh>
+
+#include "ignition/gazebo/TraceRecorder.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Private data of CameraBatch
+class ignition::gazebo::CameraBatchPrivate
+{
+  /// \brief Allocate the buffer for frames of a given size.
+  /// \param[in] _frameBytes Size of each frame in bytes.
+  /// \return True if successful.
+  public: bool Allocate(std::size_t _frameBytes);
+
+  /// \brief Name of the batch.
+  public: std::string name;
+
+  /// \brief Number of slots.
+  public: std::size_t size{0u};
+
+  /// \brief Protects everything below, except the frame data.
+  public: mutable std::mutex mutex;
+
+  /// \brief Notified when a batch completes.
+  public: mutable std::condition_variable completedCv;
+
+  /// \brief Frame buffer, null until the first frame is written.
+  public: unsigned char *data{nullptr};
+
+  /// \brief Size of the buffer in bytes.
+  public: std::size_t dataBytes{0u};
+
+  /// \brief True if the buffer was mapped instead of allocated with new.
+  public: bool mapped{false};
+
+  /// \brief True if the buffer is locked in memory.
+  public: bool pinned{false};
+
+  /// \brief Size of each frame in bytes.
+  public: std::size_t frameBytes{0u};
+
+  /// \brief Frame width.
+  public: unsigned int width{0u};
+
+  /// \brief Frame height.
+  public: unsigned int height{0u};
+
+  /// \brief Channels per pixel.
+  public: unsigned int channels{0u};
+
+  /// \brief Pixel format.
+  public: std::string format;
+
+  /// \brief Simulation time of the batch being filled.
+  public: std::chrono::steady_clock::duration pendingStamp{-1};
+
+  /// \brief Slots written for the batch being filled.
+  public: std::vector<bool> written;
+
+  /// \brief Number of true values in written.
+  public: std::size_t writtenCount{0u};
+
+  /// \brief Number of completed batches.
+  public: uint64_t sequence{0u};
+
+  /// \brief Simulation time of the latest completed batch.
+  public: std::chrono::steady_clock::duration stamp{0};
+
+  /// \brief True if a mismatching frame was already reported.
+  public: bool mismatchReported{false};
+};
+
+/// \brief Batches registered in this process.
+struct CameraBatches
+{
+  /// \brief Protects batches.
+  std::mutex mutex;
+
+  /// \brief Batches keyed by name.
+  std::map<std::string, std::shared_ptr<CameraBatch>> batches;
+};
+
+/// \brief Get the batches registered in this process.
+/// \return The batches.
+static CameraBatches &Batches()
+{
+  static CameraBatches batches;
+  return batches;
+}
+
+//////////////////////////////////////////////////
+bool CameraBatchPrivate::Allocate(std::size_t _frameBytes)
+{
+  const std::size_t bytes = _frameBytes * this->size;
+#ifndef _WIN32
+  // Mapped memory is page aligned, which lets consumers register it with
+  // GPU APIs, and locking it keeps those transfers from faulting
+  void *ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr != MAP_FAILED)
+  {
+    this->data = static_cast<unsigned char *>(ptr);
+    this->mapped = true;
+    this->pinned = mlock(ptr, bytes) == 0;
+    if (!this->pinned)
+    {
+      ignwarn << "Failed to lock the [" << bytes << "] bytes of camera batch ["
+              << this->name << "] in memory, check RLIMIT_MEMLOCK. Frames "
+              << "will be written to pageable memory." << std::endl;
+    }
+  }
+#endif
+  if (nullptr == this->data)
+  {
+    this->data = new (std::nothrow) unsigned char[bytes];
+    if (nullptr == this->data)
+    {
+      ignerr << "Failed to allocate [" << bytes << "] bytes for camera "
+             << "batch [" << this->name << "]." << std::endl;
+      return false;
+    }
+  }
+  this->dataBytes = bytes;
+  this->frameBytes = _frameBytes;
+  return true;
+}
+
+//////////////////////////////////////////////////
+CameraBatch::CameraBatch(const std::string &_name, std::size_t _size)
+  : dataPtr(std::make_unique<CameraBatchPrivate>())
+{
+  this->dataPtr->name = _name;
+  this->dataPtr->size = _size;
+  this->dataPtr->written.assign(_size, false);
+}
+
+//////////////////////////////////////////////////
+CameraBatch::~CameraBatch()
+{
+  if (nullptr == this->dataPtr->data)
+    return;
+
+#ifndef _WIN32
+  if (this->dataPtr->mapped)
+  {
+    munmap(this->dataPtr->data, this->dataPtr->dataBytes);
+    return;
+  }
+#endif
+  delete [] this->dataPtr->data;
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<CameraBatch> CameraBatch::Create(const std::string &_name,
+    std::size_t _size)
+{
+  if (_size == 0u)
+    return nullptr;
+
+  auto batch = std::make_shared<CameraBatch>(_name, _size);
+  auto &batches = Batches();
+  std::lock_guard<std::mutex> lock(batches.mutex);
+  batches.batches[_name] = batch;
+  return batch;
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<CameraBatch> CameraBatch::Find(const std::string &_name)
+{
+  auto &batches = Batches();
+  std::lock_guard<std::mutex> lock(batches.mutex);
+  auto it = batches.batches.find(_name);
+  if (it == batches.batches.end())
+    return nullptr;
+  return it->second;
+}
+
+//////////////////////////////////////////////////
+bool CameraBatch::Remove(const std::string &_name)
+{
+  auto &batches = Batches();
+  std::lock_guard<std::mutex> lock(batches.mutex);
+  return batches.batches.erase(_name) > 0u;
+}
+
+//////////////////////////////////////////////////
+std::vector<std::string> CameraBatch::Names()
+{
+  auto &batches = Batches();
+  std::lock_guard<std::mutex> lock(batches.mutex);
+  std::vector<std::string> names;
+  names.reserve(batches.batches.size());
+  for (const auto &batch : batches.batches)
+    names.push_back(batch.first);
+  return names;
+}
+
+//////////////////////////////////////////////////
+bool CameraBatch::Write(std::size_t _slot, const void *_data,
+    std::size_t _bytes, unsigned int _width, unsigned int _height,
+    unsigned int _channels, const std::string &_format,
+    const std::chrono::steady_clock::duration &_stamp)
+{
+  IGN_GAZEBO_PROFILE("CameraBatch::Write");
+  if (_slot >= this->dataPtr->size || nullptr == _data || _bytes == 0u)
+    return false;
+
+  unsigned char *dest{nullptr};
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    if (nullptr == this->dataPtr->data)
+    {
+      if (!this->dataPtr->Allocate(_bytes))
+        return false;
+      this->dataPtr->width = _width;
+      this->dataPtr->height = _height;
+      this->dataPtr->channels = _channels;
+      this->dataPtr->format = _format;
+    }
+    else if (_bytes != this->dataPtr->frameBytes ||
+        _width != this->dataPtr->width || _height != this->dataPtr->height ||
+        _channels != this->dataPtr->channels ||
+        _format != this->dataPtr->format)
+    {
+      if (!this->dataPtr->mismatchReported)
+      {
+        ignerr << "Dropping [" << _width << "x" << _height << "x"
+               << _channels << " " << _format << "] frame of camera batch ["
+               << this->dataPtr->name << "], whose frames are ["
+               << this->dataPtr->width << "x" << this->dataPtr->height << "x"
+               << this->dataPtr->channels << " " << this->dataPtr->format
+               << "]." << std::endl;
+        this->dataPtr->mismatchReported = true;
+      }
+      return false;
+    }
+    dest = this->dataPtr->data + _slot * this->dataPtr->frameBytes;
+  }
+
+  // Each slot is only written by the rendering thread of its camera, so
+  // frames are copied without holding the lock
+  std::memcpy(dest, _data, _bytes);
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    auto &d = *this->dataPtr;
+
+    // A newer frame starts a new batch, frames older than the batch being
+    // filled are kept but don't count towards it
+    if (_stamp > d.pendingStamp)
+    {
+      d.pendingStamp = _stamp;
+      std::fill(d.written.begin(), d.written.end(), false);
+      d.writtenCount = 0u;
+    }
+    if (_stamp == d.pendingStamp && !d.written[_slot])
+    {
+      d.written[_slot] = true;
+      ++d.writtenCount;
+    }
+    if (d.writtenCount < d.size)
+      return true;
+
+    ++d.sequence;
+    d.stamp = d.pendingStamp;
+    std::fill(d.written.begin(), d.written.end(), false);
+    d.writtenCount = 0u;
+  }
+  this->dataPtr->completedCv.notify_all();
+  return true;
+}
+
+//////////////////////////////////////////////////
+uint64_t CameraBatch::WaitFor(uint64_t _sequence,
+    const std::chrono::steady_clock::duration &_timeout) const
+{
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->completedCv.wait_for(lock, _timeout, [&]
+  {
+    return this->dataPtr->sequence > _sequence;
+  });
+  return this->dataPtr->sequence;
+}
+
+//////////////////////////////////////////////////
+const std::string &CameraBatch::Name() const
+{
+  return this->dataPtr->name;
+}
+
+//////////////////////////////////////////////////
+std::size_t CameraBatch::Size() const
+{
+  return this->dataPtr->size;
+}
+
+//////////////////////////////////////////////////
+uint64_t CameraBatch::Sequence() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->sequence;
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration CameraBatch::Stamp() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->stamp;
+}
+
+//////////////////////////////////////////////////
+const void *CameraBatch::Data() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->data;
+}
+
+//////////////////////////////////////////////////
+std::size_t CameraBatch::FrameBytes() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->frameBytes;
+}
+
+//////////////////////////////////////////////////
+unsigned int CameraBatch::Width() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->width;
+}
+
+//////////////////////////////////////////////////
+unsigned int CameraBatch::Height() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->height;
+}
+
+//////////////////////////////////////////////////
+unsigned int CameraBatch::Channels() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->channels;
+}
+
+//////////////////////////////////////////////////
+std::string CameraBatch::Format() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->format;
+}
+
+//////////////////////////////////////////////////
+bool CameraBatch::Pinned() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->pinned;
+}
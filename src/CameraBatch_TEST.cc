@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "ignition/gazebo/CameraBatch.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+/////////////////////////////////////////////////
+TEST(CameraBatch, Registry)
+{
+  EXPECT_EQ(nullptr, CameraBatch::Create("camera_batch_test_empty", 0u));
+  EXPECT_EQ(nullptr, CameraBatch::Find("camera_batch_test_empty"));
+
+  auto batch = CameraBatch::Create("camera_batch_test_registry", 3u);
+  ASSERT_NE(nullptr, batch);
+  EXPECT_EQ("camera_batch_test_registry", batch->Name());
+  EXPECT_EQ(3u, batch->Size());
+  EXPECT_EQ(batch, CameraBatch::Find("camera_batch_test_registry"));
+  EXPECT_EQ(nullptr, batch->Data());
+  EXPECT_EQ(0u, batch->Sequence());
+
+  auto names = CameraBatch::Names();
+  EXPECT_NE(names.end(),
+      std::find(names.begin(), names.end(), "camera_batch_test_registry"));
+
+  EXPECT_TRUE(CameraBatch::Remove("camera_batch_test_registry"));
+  EXPECT_FALSE(CameraBatch::Remove("camera_batch_test_registry"));
+  EXPECT_EQ(nullptr, CameraBatch::Find("camera_batch_test_registry"));
+}
+
+/////////////////////////////////////////////////
+TEST(CameraBatch, CompletesWhenAllSlotsWritten)
+{
+  auto batch = CameraBatch::Create("camera_batch_test_complete", 2u);
+  ASSERT_NE(nullptr, batch);
+
+  const std::array<unsigned char, 12> first{1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+      11, 12};
+  const std::array<unsigned char, 12> second{21, 22, 23, 24, 25, 26, 27, 28,
+      29, 30, 31, 32};
+
+  // The first frame sets the layout
+  EXPECT_TRUE(batch->Write(1u, second.data(), second.size(), 2u, 2u, 3u,
+      "RGB_INT8", 10ms));
+  ASSERT_NE(nullptr, batch->Data());
+  EXPECT_EQ(12u, batch->FrameBytes());
+  EXPECT_EQ(2u, batch->Width());
+  EXPECT_EQ(2u, batch->Height());
+  EXPECT_EQ(3u, batch->Channels());
+  EXPECT_EQ("RGB_INT8", batch->Format());
+  EXPECT_EQ(0u, batch->Sequence());
+  EXPECT_EQ(0u, batch->WaitFor(0u, 1ms));
+
+  // Mismatching frames and slots are dropped
+  EXPECT_FALSE(batch->Write(0u, first.data(), 6u, 1u, 2u, 3u, "RGB_INT8",
+      10ms));
+  EXPECT_FALSE(batch->Write(0u, first.data(), first.size(), 2u, 2u, 3u,
+      "BGR_INT8", 10ms));
+  EXPECT_FALSE(batch->Write(2u, first.data(), first.size(), 2u, 2u, 3u,
+      "RGB_INT8", 10ms));
+  EXPECT_EQ(0u, batch->Sequence());
+
+  // Frames of another time start a new batch
+  EXPECT_TRUE(batch->Write(0u, first.data(), first.size(), 2u, 2u, 3u,
+      "RGB_INT8", 20ms));
+  EXPECT_EQ(0u, batch->Sequence());
+
+  std::thread writer([&]
+  {
+    batch->Write(1u, second.data(), second.size(), 2u, 2u, 3u, "RGB_INT8",
+        20ms);
+  });
+  EXPECT_EQ(1u, batch->WaitFor(0u, 5s));
+  writer.join();
+  EXPECT_EQ(20ms, batch->Stamp());
+
+  // Slots are back to back
+  auto data = static_cast<const unsigned char *>(batch->Data());
+  EXPECT_EQ(0, std::memcmp(data, first.data(), first.size()));
+  EXPECT_EQ(0, std::memcmp(data + first.size(), second.data(),
+      second.size()));
+
+  // Writing a slot twice doesn't complete a batch
+  EXPECT_TRUE(batch->Write(0u, first.data(), first.size(), 2u, 2u, 3u,
+      "RGB_INT8", 30ms));
+  EXPECT_TRUE(batch->Write(0u, first.data(), first.size(), 2u, 2u, 3u,
+      "RGB_INT8", 30ms));
+  EXPECT_EQ(1u, batch->Sequence());
+  EXPECT_TRUE(batch->Write(1u, second.data(), second.size(), 2u, 2u, 3u,
+      "RGB_INT8", 30ms));
+  EXPECT_EQ(2u, batch->Sequence());
+  EXPECT_EQ(30ms, batch->Stamp());
+
+  CameraBatch::Remove("camera_batch_test_complete");
+}
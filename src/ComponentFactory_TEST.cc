@@ -139,3 +139,178 @@ TEST_F(ComponentFactoryTest, New)
   }
 }
 
+
+/////////////////////////////////////////////////
+TEST_F(ComponentFactoryTest, Construct)
+{
+  auto factory = components::Factory::Instance();
+
+  EXPECT_EQ(0u, factory->ComponentSize(123456789));
+  EXPECT_EQ(sizeof(components::Pose),
+      factory->ComponentSize(components::Pose::typeId));
+  EXPECT_EQ(alignof(components::Pose),
+      factory->ComponentAlignment(components::Pose::typeId));
+
+  alignas(components::Pose) unsigned char memory[sizeof(components::Pose)];
+
+  // Unknown type
+  EXPECT_EQ(nullptr, factory->Construct(123456789, memory));
+
+  // Null memory
+  EXPECT_EQ(nullptr, factory->Construct(components::Pose::typeId, nullptr));
+
+  // Default constructed
+  {
+    auto comp = factory->Construct(components::Pose::typeId, memory);
+    ASSERT_NE(nullptr, comp);
+    EXPECT_EQ(static_cast<void *>(memory), static_cast<void *>(comp));
+    EXPECT_EQ(components::Pose::typeId, comp->TypeId());
+    EXPECT_EQ(math::Pose3d::Zero,
+        static_cast<components::Pose *>(comp)->Data());
+    comp->~BaseComponent();
+  }
+
+  // Constructed from data
+  {
+    math::Pose3d pose(1, 2, 3, 0, 0, 0);
+    components::Pose poseComp(pose);
+    auto comp = factory->Construct(components::Pose::typeId, memory,
+        &poseComp);
+    ASSERT_NE(nullptr, comp);
+    EXPECT_EQ(pose, static_cast<components::Pose *>(comp)->Data());
+    comp->~BaseComponent();
+
+    // Mismatching component types
+    EXPECT_EQ(nullptr,
+        factory->Construct(components::Name::typeId, memory, &poseComp));
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_F(ComponentFactoryTest, TypeIndex)
+{
+  auto factory = components::Factory::Instance();
+
+  EXPECT_EQ(components::Factory::kInvalidTypeIndex,
+      factory->TypeIndex(123456789));
+  EXPECT_EQ(nullptr,
+      factory->Descriptor(components::Factory::kInvalidTypeIndex));
+
+  const auto poseIndex = factory->TypeIndex(components::Pose::typeId);
+  const auto nameIndex = factory->TypeIndex(components::Name::typeId);
+  ASSERT_NE(components::Factory::kInvalidTypeIndex, poseIndex);
+  ASSERT_NE(components::Factory::kInvalidTypeIndex, nameIndex);
+  EXPECT_NE(poseIndex, nameIndex);
+
+  auto descriptor = factory->Descriptor(poseIndex);
+  ASSERT_NE(nullptr, descriptor);
+  auto comp = descriptor->Create();
+  ASSERT_NE(nullptr, comp);
+  EXPECT_EQ(components::Pose::typeId, comp->TypeId());
+
+  // A type keeps its index when it's registered again
+  using Reregistered = components::Component<int, class ReregisteredTag>;
+  factory->Register<Reregistered>("ign_gazebo_components.Reregistered",
+      new components::ComponentDescriptor<Reregistered>());
+  const auto index = factory->TypeIndex(Reregistered::typeId);
+  ASSERT_NE(components::Factory::kInvalidTypeIndex, index);
+  EXPECT_NE(nullptr, factory->Descriptor(index));
+
+  factory->Unregister<Reregistered>();
+  EXPECT_FALSE(factory->HasType(Reregistered::typeId));
+  EXPECT_EQ(nullptr, factory->Descriptor(index));
+  EXPECT_EQ(index, factory->TypeIndex(Reregistered::typeId));
+
+  factory->Register<Reregistered>("ign_gazebo_components.Reregistered",
+      new components::ComponentDescriptor<Reregistered>());
+  EXPECT_EQ(index, factory->TypeIndex(Reregistered::typeId));
+  EXPECT_NE(nullptr, factory->Descriptor(index));
+}
+
+/////////////////////////////////////////////////
+/// \brief Descriptor which isn't a ComponentDescriptor, like those written
+/// before placements existed.
+template <typename ComponentTypeT>
+class HeapDescriptor : public components::ComponentDescriptorBase
+{
+  public: std::unique_ptr<components::BaseComponent> Create() const override
+  {
+    return std::make_unique<ComponentTypeT>();
+  }
+
+  public: std::unique_ptr<components::BaseComponent> Create(
+      const components::BaseComponent *_data) const override
+  {
+    return std::make_unique<ComponentTypeT>(
+        *static_cast<const ComponentTypeT *>(_data));
+  }
+};
+
+/////////////////////////////////////////////////
+TEST_F(ComponentFactoryTest, Placement)
+{
+  auto factory = components::Factory::Instance();
+
+  EXPECT_EQ(nullptr,
+      factory->Placement(components::Factory::kInvalidTypeIndex));
+
+  auto placement = factory->Placement(
+      factory->TypeIndex(components::Pose::typeId));
+  ASSERT_NE(nullptr, placement);
+  EXPECT_EQ(sizeof(components::Pose), placement->size);
+  EXPECT_EQ(alignof(components::Pose), placement->alignment);
+  EXPECT_NE(nullptr, placement->construct);
+
+  // Types registered with other descriptors have no placement, but can
+  // still be created
+  using HeapOnly = components::Component<int, class HeapOnlyTag>;
+  factory->Register<HeapOnly>("ign_gazebo_components.HeapOnly",
+      new HeapDescriptor<HeapOnly>());
+  const auto heapIndex = factory->TypeIndex(HeapOnly::typeId);
+  ASSERT_NE(components::Factory::kInvalidTypeIndex, heapIndex);
+  EXPECT_EQ(nullptr, factory->Placement(heapIndex));
+  EXPECT_EQ(0u, factory->ComponentSize(HeapOnly::typeId));
+
+  alignas(HeapOnly) unsigned char memory[sizeof(HeapOnly)];
+  EXPECT_EQ(nullptr, factory->Construct(HeapOnly::typeId, memory));
+
+  auto comp = factory->New<HeapOnly>();
+  ASSERT_NE(nullptr, comp);
+  EXPECT_EQ(HeapOnly::typeId, comp->TypeId());
+
+  // The placement goes away with the registration which added it
+  using Placed = components::Component<int, class PlacedTag>;
+  factory->Register<Placed>("ign_gazebo_components.Placed",
+      new components::ComponentDescriptor<Placed>());
+  const auto placedIndex = factory->TypeIndex(Placed::typeId);
+  EXPECT_NE(nullptr, factory->Placement(placedIndex));
+  EXPECT_EQ(sizeof(Placed), factory->ComponentSize(Placed::typeId));
+
+  factory->Unregister<Placed>();
+  EXPECT_EQ(nullptr, factory->Placement(placedIndex));
+  EXPECT_EQ(0u, factory->ComponentSize(Placed::typeId));
+}
+
+/////////////////////////////////////////////////
+TEST_F(ComponentFactoryTest, MoveData)
+{
+  auto factory = components::Factory::Instance();
+
+  // Registered types are move assigned
+  components::Pose pose(math::Pose3d(1, 2, 3, 0, 0, 0));
+  components::Pose otherPose;
+  factory->MoveData(otherPose, pose);
+  EXPECT_EQ(math::Pose3d(1, 2, 3, 0, 0, 0), otherPose.Data());
+
+  components::Name name("name");
+  components::Name otherName;
+  factory->MoveData(otherName, name);
+  EXPECT_EQ("name", otherName.Data());
+
+  // Others go through serialization
+  using Unregistered = components::Component<int, class UnregisteredTag>;
+  Unregistered value(5);
+  Unregistered otherValue(0);
+  factory->MoveData(otherValue, value);
+  EXPECT_EQ(5, otherValue.Data());
+}
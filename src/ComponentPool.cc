@@ -0,0 +1,324 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ComponentPool.hh"
+
+#include <algorithm>
+#include <new>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <ignition/common/Console.hh>
+
+/// \brief Size of the pages blocks are placed in when partitioned.
+static constexpr std::size_t kPageBytes{4096u};
+
+/// \brief Smallest block of a partitioned pool. Larger blocks mean fewer
+/// calls to place them.
+static constexpr std::size_t kMinNumaBlockBytes{16u * kPageBytes};
+
+/// \brief Deleter for blocks allocated with an explicit alignment.
+struct AlignedBlockDeleter
+{
+  /// \brief Alignment used to allocate the block.
+  std::size_t alignment;
+
+  /// \brief Release the block.
+  /// \param[in] _ptr Block to release.
+  void operator()(unsigned char *_ptr) const
+  {
+    ::operator delete(_ptr, std::align_val_t(this->alignment));
+  }
+};
+
+/// \brief A block of memory and the partition it belongs to.
+struct PoolBlock
+{
+  /// \brief Memory of the block.
+  std::unique_ptr<unsigned char[], AlignedBlockDeleter> memory;
+
+  /// \brief Partition which allocates from the block.
+  std::size_t partition{0u};
+};
+
+/// \brief Slots available to one partition.
+struct PoolPartition
+{
+  /// \brief Last block allocated for the partition, nullptr if none.
+  unsigned char *block{nullptr};
+
+  /// \brief Index of the next slot that has never been handed out in
+  /// block.
+  std::size_t nextUnused{0u};
+
+  /// \brief Slots that have been released and can be reused. They are
+  /// handed out in LIFO order, since recently freed memory is more likely to
+  /// still be in cache.
+  std::vector<unsigned char *> freeSlots;
+};
+
+class ignition::gazebo::ComponentPoolPrivate
+{
+  /// \brief Find the block holding a slot.
+  /// \param[in] _slot Slot.
+  /// \return The block, or nullptr if the slot isn't in the pool.
+  public: const PoolBlock *FindBlock(const unsigned char *_slot) const;
+
+  /// \brief Distance between consecutive slots, in bytes.
+  public: std::size_t stride{0u};
+
+  /// \brief Alignment of each slot.
+  public: std::size_t alignment{0u};
+
+  /// \brief Number of slots in each block.
+  public: std::size_t blockCapacity{0u};
+
+  /// \brief Alignment of each block.
+  public: std::size_t blockAlignment{0u};
+
+  /// \brief Size of each block in bytes. Partitioned blocks are rounded up
+  /// to whole pages.
+  public: std::size_t blockBytes{0u};
+
+  /// \brief Blocks of memory. Each block holds `blockCapacity` slots.
+  public: std::vector<PoolBlock> blocks;
+
+  /// \brief Partitions of the pool, there's always at least one.
+  public: std::vector<PoolPartition> partitions;
+
+  /// \brief NUMA node of each partition, empty if memory isn't placed.
+  public: std::vector<unsigned int> numaNodes;
+
+  /// \brief Number of slots currently allocated.
+  public: std::size_t count{0u};
+};
+
+using namespace ignition::gazebo;
+
+/// \brief Ask the kernel to place the pages of a memory range on a NUMA
+/// node, moving those already touched.
+/// \param[in] _ptr Start of the range, page aligned.
+/// \param[in] _bytes Size of the range.
+/// \param[in] _node NUMA node.
+static void placeOnNode(void *_ptr, std::size_t _bytes, unsigned int _node)
+{
+#ifdef __linux__
+  // MPOL_PREFERRED and MPOL_MF_MOVE from numaif.h, which would be the only
+  // reason to depend on libnuma
+  constexpr int kPreferred{1};
+  constexpr unsigned int kMove{1u << 1u};
+  constexpr std::size_t kMaskBits{8u * sizeof(unsigned long)};  // NOLINT
+
+  std::vector<unsigned long> mask(_node / kMaskBits + 1u, 0u);  // NOLINT
+  mask[_node / kMaskBits] = 1ul << (_node % kMaskBits);
+  if (syscall(SYS_mbind, _ptr, _bytes, kPreferred, mask.data(),
+      mask.size() * kMaskBits + 1u, kMove) != 0)
+  {
+    static bool warned{false};
+    if (!warned)
+    {
+      ignwarn << "Failed to place component memory on NUMA node [" << _node
+              << "]." << std::endl;
+      warned = true;
+    }
+  }
+#else
+  (void)_ptr;
+  (void)_bytes;
+  (void)_node;
+#endif
+}
+
+//////////////////////////////////////////////////
+ComponentPool::ComponentPool(std::size_t _size, std::size_t _alignment,
+    std::size_t _blockCapacity)
+  : dataPtr(std::make_unique<ComponentPoolPrivate>())
+{
+  // Alignment must be a power of two, fall back to the strictest fundamental
+  // alignment otherwise.
+  if (_alignment == 0u || (_alignment & (_alignment - 1u)) != 0u)
+    _alignment = alignof(std::max_align_t);
+
+  this->dataPtr->alignment = _alignment;
+  this->dataPtr->blockAlignment = _alignment;
+  this->dataPtr->stride =
+      ((std::max<std::size_t>(_size, 1u) + _alignment - 1u) / _alignment) *
+      _alignment;
+  this->dataPtr->blockCapacity = std::max<std::size_t>(_blockCapacity, 1u);
+  this->dataPtr->blockBytes =
+      this->dataPtr->stride * this->dataPtr->blockCapacity;
+  this->dataPtr->partitions.resize(1u);
+}
+
+//////////////////////////////////////////////////
+ComponentPool::~ComponentPool()
+{
+  if (this->dataPtr->count > 0u)
+  {
+    ignwarn << "Destroying component pool with [" << this->dataPtr->count
+            << "] slots still allocated." << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void *ComponentPool::Allocate(unsigned int _partition)
+{
+  ++this->dataPtr->count;
+
+  auto &partition = this->dataPtr->partitions[
+      _partition % this->dataPtr->partitions.size()];
+  if (!partition.freeSlots.empty())
+  {
+    auto slot = partition.freeSlots.back();
+    partition.freeSlots.pop_back();
+    return slot;
+  }
+
+  if (nullptr == partition.block ||
+      partition.nextUnused >= this->dataPtr->blockCapacity)
+  {
+    const auto bytes = this->dataPtr->blockBytes;
+    auto raw = static_cast<unsigned char *>(::operator new(bytes,
+        std::align_val_t(this->dataPtr->blockAlignment)));
+
+    // Placing the block before any slot is constructed means its pages are
+    // first touched on the right node
+    const auto index = static_cast<std::size_t>(
+        &partition - this->dataPtr->partitions.data());
+    if (!this->dataPtr->numaNodes.empty())
+      placeOnNode(raw, bytes, this->dataPtr->numaNodes[index]);
+
+    PoolBlock block;
+    block.memory = std::unique_ptr<unsigned char[], AlignedBlockDeleter>(raw,
+        AlignedBlockDeleter{this->dataPtr->blockAlignment});
+    block.partition = index;
+    this->dataPtr->blocks.push_back(std::move(block));
+    partition.block = raw;
+    partition.nextUnused = 0u;
+  }
+
+  auto slot = partition.block + partition.nextUnused * this->dataPtr->stride;
+  ++partition.nextUnused;
+  return slot;
+}
+
+//////////////////////////////////////////////////
+bool ComponentPool::Release(void *_ptr)
+{
+  if (nullptr == _ptr)
+    return false;
+
+  auto slot = static_cast<unsigned char *>(_ptr);
+  auto block = this->dataPtr->FindBlock(slot);
+  if (nullptr == block)
+  {
+    ignerr << "Attempted to release memory that doesn't belong to this "
+           << "component pool." << std::endl;
+    return false;
+  }
+
+  this->dataPtr->partitions[block->partition].freeSlots.push_back(slot);
+  --this->dataPtr->count;
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::size_t ComponentPool::Count() const
+{
+  return this->dataPtr->count;
+}
+
+//////////////////////////////////////////////////
+std::size_t ComponentPool::Capacity() const
+{
+  return this->dataPtr->blocks.size() * this->dataPtr->blockCapacity;
+}
+
+//////////////////////////////////////////////////
+std::size_t ComponentPool::Stride() const
+{
+  return this->dataPtr->stride;
+}
+
+//////////////////////////////////////////////////
+std::size_t ComponentPool::Alignment() const
+{
+  return this->dataPtr->alignment;
+}
+
+//////////////////////////////////////////////////
+bool ComponentPool::SetNumaNodes(const std::vector<unsigned int> &_nodes)
+{
+  if (!this->dataPtr->blocks.empty())
+    return false;
+
+  this->dataPtr->numaNodes = _nodes;
+  this->dataPtr->partitions.clear();
+  this->dataPtr->partitions.resize(std::max<std::size_t>(_nodes.size(), 1u));
+  if (_nodes.empty())
+    return true;
+
+  // Pages are the unit of placement, so blocks of different partitions
+  // must not share any
+  this->dataPtr->blockAlignment =
+      std::max(this->dataPtr->alignment, kPageBytes);
+  auto bytes = std::max(this->dataPtr->blockBytes, kMinNumaBlockBytes);
+  bytes = (bytes + kPageBytes - 1u) / kPageBytes * kPageBytes;
+  this->dataPtr->blockBytes = bytes;
+  this->dataPtr->blockCapacity = bytes / this->dataPtr->stride;
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::size_t ComponentPool::PartitionCount() const
+{
+  return this->dataPtr->partitions.size();
+}
+
+//////////////////////////////////////////////////
+std::size_t ComponentPool::Partition(const void *_ptr) const
+{
+  auto block = this->dataPtr->FindBlock(
+      static_cast<const unsigned char *>(_ptr));
+  if (nullptr == block)
+    return this->dataPtr->partitions.size();
+  return block->partition;
+}
+
+//////////////////////////////////////////////////
+const PoolBlock *ComponentPoolPrivate::FindBlock(
+    const unsigned char *_slot) const
+{
+  if (nullptr == _slot)
+    return nullptr;
+
+  // Blocks are few and usually the most recent one is the one being released
+  // from, so search backwards.
+  const auto blockBytes = this->blockBytes;
+  auto it = std::find_if(this->blocks.rbegin(), this->blocks.rend(),
+      [&](const PoolBlock &_block)
+      {
+        return _slot >= _block.memory.get() &&
+            _slot < _block.memory.get() + blockBytes;
+      });
+  if (it == this->blocks.rend())
+    return nullptr;
+  return &*it;
+}
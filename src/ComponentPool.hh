@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_COMPONENTPOOL_HH_
+#define IGNITION_GAZEBO_COMPONENTPOOL_HH_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class ComponentPoolPrivate;
+
+    /// \class ComponentPool ComponentPool.hh
+    /// \brief Contiguous storage for components of a single type.
+    ///
+    /// Memory is handed out in fixed-size slots which are carved from large
+    /// blocks, so that components of the same type end up next to each other
+    /// in memory instead of being scattered across the heap. Blocks are never
+    /// moved or shrunk while the pool is alive, which means that the address
+    /// of a slot is stable for as long as it is allocated. This is
+    /// important because views cache raw pointers to components.
+    ///
+    /// The pool only manages memory, it doesn't construct or destroy the
+    /// objects that live in it.
+    ///
+    /// Memory may be partitioned across NUMA nodes, with each partition
+    /// carving slots from its own blocks, placed on its node. Blocks are
+    /// then at least a few pages large so that they don't share pages.
+    class IGNITION_GAZEBO_VISIBLE ComponentPool
+    {
+      /// \brief Constructor
+      /// \param[in] _size Size in bytes of each object held by the pool.
+      /// \param[in] _alignment Alignment requirement of each object.
+      /// \param[in] _blockCapacity Number of objects per block of memory.
+      public: ComponentPool(std::size_t _size, std::size_t _alignment,
+                  std::size_t _blockCapacity = 64u);
+
+      /// \brief Destructor. All memory is released, so all objects in the
+      /// pool must have been destroyed by now.
+      public: ~ComponentPool();
+
+      /// \brief Get a slot of memory large enough to hold one object.
+      /// Released slots are reused before a new block is allocated.
+      /// \param[in] _partition Partition the slot is taken from, see
+      /// SetNumaNodes. Partitions past the last one wrap around.
+      /// \return Pointer to uninitialized memory.
+      public: void *Allocate(unsigned int _partition = 0u);
+
+      /// \brief Return a slot to the pool so it can be reused.
+      /// \param[in] _ptr Pointer previously returned by Allocate.
+      /// \return True if _ptr belongs to this pool.
+      public: bool Release(void *_ptr);
+
+      /// \brief Number of slots currently allocated.
+      /// \return Number of live objects.
+      public: std::size_t Count() const;
+
+      /// \brief Number of slots available without allocating a new block.
+      /// \return Total number of slots in all blocks.
+      public: std::size_t Capacity() const;
+
+      /// \brief Distance in bytes between consecutive slots. This is the size
+      /// of the object rounded up to its alignment.
+      /// \return Slot stride in bytes.
+      public: std::size_t Stride() const;
+
+      /// \brief Alignment of every slot. This is the alignment given to the
+      /// constructor, or the default one if that wasn't a power of two.
+      /// \return Slot alignment in bytes.
+      public: std::size_t Alignment() const;
+
+      /// \brief Partition the pool's memory across NUMA nodes. Partition i
+      /// allocates its blocks on node _nodes[i]. Placement is only
+      /// supported on Linux, elsewhere partitions are kept apart but not
+      /// placed. Can only be called before the first allocation.
+      /// \param[in] _nodes NUMA node of each partition. Empty, the default,
+      /// keeps a single partition which isn't placed on any node.
+      /// \return True if set, false if the pool already allocated memory.
+      public: bool SetNumaNodes(const std::vector<unsigned int> &_nodes);
+
+      /// \brief Number of partitions, see SetNumaNodes.
+      /// \return Number of partitions, at least one.
+      public: std::size_t PartitionCount() const;
+
+      /// \brief Partition a slot was allocated from.
+      /// \param[in] _ptr Pointer returned by Allocate.
+      /// \return Partition, or PartitionCount() if _ptr doesn't belong to
+      /// the pool.
+      public: std::size_t Partition(const void *_ptr) const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<ComponentPoolPrivate> dataPtr;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_COMPONENTPOOL_HH_
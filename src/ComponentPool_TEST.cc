@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include "ComponentPool.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(ComponentPool, AllocateContiguous)
+{
+  ComponentPool pool(24u, 8u, 4u);
+  EXPECT_EQ(0u, pool.Count());
+  EXPECT_EQ(0u, pool.Capacity());
+  EXPECT_EQ(24u, pool.Stride());
+
+  std::vector<unsigned char *> slots;
+  for (int i = 0; i < 4; ++i)
+    slots.push_back(static_cast<unsigned char *>(pool.Allocate()));
+
+  EXPECT_EQ(4u, pool.Count());
+  EXPECT_EQ(4u, pool.Capacity());
+
+  // All slots in a block are adjacent
+  for (std::size_t i = 1; i < slots.size(); ++i)
+    EXPECT_EQ(slots[i - 1] + pool.Stride(), slots[i]);
+
+  // Next allocation opens a new block without moving the old one
+  auto extra = pool.Allocate();
+  EXPECT_NE(nullptr, extra);
+  EXPECT_EQ(5u, pool.Count());
+  EXPECT_EQ(8u, pool.Capacity());
+
+  for (auto slot : slots)
+    EXPECT_TRUE(pool.Release(slot));
+  EXPECT_TRUE(pool.Release(extra));
+  EXPECT_EQ(0u, pool.Count());
+}
+
+/////////////////////////////////////////////////
+TEST(ComponentPool, Alignment)
+{
+  ComponentPool pool(20u, 32u, 3u);
+  EXPECT_EQ(32u, pool.Stride());
+  EXPECT_EQ(32u, pool.Alignment());
+
+  std::vector<void *> slots;
+  for (int i = 0; i < 7; ++i)
+  {
+    auto slot = pool.Allocate();
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(slot) % 32u);
+    slots.push_back(slot);
+  }
+
+  for (auto slot : slots)
+    EXPECT_TRUE(pool.Release(slot));
+
+  // Invalid alignment falls back to a sane default
+  ComponentPool badAlignment(10u, 3u);
+  EXPECT_EQ(alignof(std::max_align_t), badAlignment.Alignment());
+  EXPECT_EQ(0u, badAlignment.Stride() % alignof(std::max_align_t));
+}
+
+/////////////////////////////////////////////////
+TEST(ComponentPool, Reuse)
+{
+  ComponentPool pool(16u, 8u, 8u);
+
+  auto first = pool.Allocate();
+  auto second = pool.Allocate();
+  EXPECT_NE(first, second);
+
+  EXPECT_TRUE(pool.Release(first));
+  EXPECT_EQ(1u, pool.Count());
+
+  // Released slot is handed out again before growing
+  EXPECT_EQ(first, pool.Allocate());
+  EXPECT_EQ(8u, pool.Capacity());
+
+  // Memory that doesn't belong to the pool is rejected
+  int notOwned{0};
+  EXPECT_FALSE(pool.Release(&notOwned));
+  EXPECT_FALSE(pool.Release(nullptr));
+  EXPECT_EQ(2u, pool.Count());
+
+  EXPECT_TRUE(pool.Release(first));
+  EXPECT_TRUE(pool.Release(second));
+}
+
+/////////////////////////////////////////////////
+TEST(ComponentPool, NumaPartitions)
+{
+  ComponentPool pool(24u, 8u, 4u);
+  EXPECT_EQ(1u, pool.PartitionCount());
+
+  // Node 0 exists on every machine, placement failures are only warned
+  // about
+  EXPECT_TRUE(pool.SetNumaNodes({0u, 0u}));
+  EXPECT_EQ(2u, pool.PartitionCount());
+
+  auto first = pool.Allocate(0u);
+  auto second = pool.Allocate(1u);
+  auto wrapped = pool.Allocate(3u);
+  EXPECT_EQ(0u, pool.Partition(first));
+  EXPECT_EQ(1u, pool.Partition(second));
+  EXPECT_EQ(1u, pool.Partition(wrapped));
+  int notOwned{0};
+  EXPECT_EQ(2u, pool.Partition(&notOwned));
+
+  // Partitions have their own page aligned blocks, which hold more slots
+  // than requested so that they fill whole pages
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(first) % 4096u);
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(second) % 4096u);
+  EXPECT_EQ(static_cast<unsigned char *>(second) + pool.Stride(), wrapped);
+  EXPECT_GT(pool.Capacity(), 8u);
+
+  // Can't be partitioned again once memory was handed out
+  EXPECT_FALSE(pool.SetNumaNodes({}));
+
+  // Released slots go back to their partition
+  EXPECT_TRUE(pool.Release(first));
+  auto third = pool.Allocate(1u);
+  EXPECT_NE(first, third);
+  EXPECT_EQ(first, pool.Allocate(0u));
+  EXPECT_EQ(4u, pool.Count());
+
+  for (auto slot : {first, second, wrapped, third})
+    EXPECT_TRUE(pool.Release(slot));
+}
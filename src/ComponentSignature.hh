@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_COMPONENTSIGNATURE_HH_
+#define IGNITION_GAZEBO_COMPONENTSIGNATURE_HH_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class ComponentSignature ComponentSignature.hh
+    /// \brief Set of component types, stored as one bit per type.
+    ///
+    /// Component type ids are hashes, so each entity component manager maps
+    /// the types it holds to dense bit indices. The signature of an entity
+    /// has the bits of the components it currently has set, and the
+    /// signature of a view has the bits of the components it requires set.
+    /// Checking whether an entity matches a view is then a handful of AND
+    /// instructions instead of a hash lookup per required type.
+    ///
+    /// The first 128 bits are stored inline, so signatures of managers
+    /// holding fewer types never allocate. This class is header only and
+    /// has no private data pointer, because it's used on hot paths.
+    class ComponentSignature
+    {
+      /// \brief Set a bit.
+      /// \param[in] _bit Index of the bit.
+      public: void Set(std::size_t _bit)
+      {
+        this->Word(_bit, true) |= Mask(_bit);
+      }
+
+      /// \brief Clear a bit.
+      /// \param[in] _bit Index of the bit.
+      public: void Reset(std::size_t _bit)
+      {
+        if (_bit / 64u < kInlineWords + this->extra.size())
+          this->Word(_bit, false) &= ~Mask(_bit);
+      }
+
+      /// \brief Check a bit.
+      /// \param[in] _bit Index of the bit.
+      /// \return True if the bit is set.
+      public: bool Test(std::size_t _bit) const
+      {
+        const std::size_t word = _bit / 64u;
+        if (word < kInlineWords)
+          return (this->words[word] & Mask(_bit)) != 0u;
+        if (word - kInlineWords < this->extra.size())
+          return (this->extra[word - kInlineWords] & Mask(_bit)) != 0u;
+        return false;
+      }
+
+      /// \brief Check whether all the bits of another signature are set in
+      /// this one.
+      /// \param[in] _required Signature to check.
+      /// \return True if this signature is a superset of _required.
+      public: bool Contains(const ComponentSignature &_required) const
+      {
+        for (std::size_t i = 0; i < kInlineWords; ++i)
+        {
+          if ((this->words[i] & _required.words[i]) != _required.words[i])
+            return false;
+        }
+        for (std::size_t i = 0; i < _required.extra.size(); ++i)
+        {
+          const std::uint64_t word =
+              i < this->extra.size() ? this->extra[i] : 0u;
+          if ((word & _required.extra[i]) != _required.extra[i])
+            return false;
+        }
+        return true;
+      }
+
+      /// \brief Clear all bits.
+      public: void Clear()
+      {
+        this->words.fill(0u);
+        this->extra.clear();
+      }
+
+      /// \brief Mask of a bit within its word.
+      /// \param[in] _bit Index of the bit.
+      /// \return Mask.
+      private: static std::uint64_t Mask(std::size_t _bit)
+      {
+        return std::uint64_t{1u} << (_bit % 64u);
+      }
+
+      /// \brief Get the word holding a bit.
+      /// \param[in] _bit Index of the bit.
+      /// \param[in] _grow True to allocate the word if it's beyond the ones
+      /// stored. Otherwise the word must exist.
+      /// \return Reference to the word.
+      private: std::uint64_t &Word(std::size_t _bit, bool _grow)
+      {
+        const std::size_t word = _bit / 64u;
+        if (word < kInlineWords)
+          return this->words[word];
+        if (_grow && word - kInlineWords >= this->extra.size())
+          this->extra.resize(word - kInlineWords + 1u, 0u);
+        return this->extra[word - kInlineWords];
+      }
+
+      /// \brief Number of words stored inline.
+      private: static constexpr std::size_t kInlineWords{2u};
+
+      /// \brief First bits.
+      private: std::array<std::uint64_t, kInlineWords> words{};
+
+      /// \brief Bits past the inline ones, empty unless one of them was set.
+      private: std::vector<std::uint64_t> extra;
+    };
+    }
+  }
+}
+#endif
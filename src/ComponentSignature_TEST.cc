@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "ComponentSignature.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(ComponentSignature, SetReset)
+{
+  ComponentSignature signature;
+  EXPECT_FALSE(signature.Test(0u));
+  EXPECT_FALSE(signature.Test(500u));
+
+  signature.Set(0u);
+  signature.Set(63u);
+  signature.Set(64u);
+  EXPECT_TRUE(signature.Test(0u));
+  EXPECT_TRUE(signature.Test(63u));
+  EXPECT_TRUE(signature.Test(64u));
+  EXPECT_FALSE(signature.Test(1u));
+
+  // Bits past the inline ones
+  signature.Set(300u);
+  EXPECT_TRUE(signature.Test(300u));
+  EXPECT_FALSE(signature.Test(299u));
+
+  signature.Reset(63u);
+  signature.Reset(300u);
+  signature.Reset(1000u);
+  EXPECT_FALSE(signature.Test(63u));
+  EXPECT_FALSE(signature.Test(300u));
+  EXPECT_TRUE(signature.Test(64u));
+
+  signature.Clear();
+  EXPECT_FALSE(signature.Test(0u));
+  EXPECT_FALSE(signature.Test(64u));
+}
+
+/////////////////////////////////////////////////
+TEST(ComponentSignature, Contains)
+{
+  ComponentSignature entity;
+  ComponentSignature required;
+
+  // Everything contains the empty signature
+  EXPECT_TRUE(entity.Contains(required));
+
+  entity.Set(3u);
+  entity.Set(70u);
+  required.Set(3u);
+  EXPECT_TRUE(entity.Contains(required));
+
+  required.Set(70u);
+  EXPECT_TRUE(entity.Contains(required));
+
+  required.Set(4u);
+  EXPECT_FALSE(entity.Contains(required));
+  EXPECT_TRUE(required.Contains(entity));
+
+  // Required bits past the entity's bits
+  ComponentSignature large;
+  large.Set(200u);
+  EXPECT_FALSE(entity.Contains(large));
+  entity.Set(200u);
+  EXPECT_TRUE(entity.Contains(large));
+
+  // Extra bits of the entity don't matter
+  entity.Set(400u);
+  EXPECT_TRUE(entity.Contains(large));
+  EXPECT_FALSE(large.Contains(entity));
+}
@@ -26,8 +26,10 @@
 #include <ignition/math/Inertial.hh>
 
 #include "ignition/gazebo/components/Component.hh"
+#include "ignition/gazebo/components/Factory.hh"
 #include "ignition/gazebo/components/Serialization.hh"
 #include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 
 #include "../test/helpers/EnvTestFixture.hh"
@@ -594,3 +596,104 @@ TEST_F(ComponentTest, Clone)
     EXPECT_NE(&comp, derivedClone);
   }
 }
+
+//////////////////////////////////////////////////
+TEST_F(ComponentTest, BinarySerialization)
+{
+  // Pose
+  {
+    using Custom = components::Component<math::Pose3d, class CustomTag>;
+
+    const auto binary = components::ComponentBinarySerialization::Of<Custom>();
+    ASSERT_NE(nullptr, binary.write);
+
+    Custom comp(math::Pose3d(1, 2, 3, 0.1, 0.2, 0.3));
+    EXPECT_EQ(7u * sizeof(double), binary.size(comp));
+
+    std::string data;
+    components::SerializeBinaryData(binary, comp, data);
+    EXPECT_EQ(components::kBinaryDataPrefixSize + binary.size(comp),
+        data.size());
+
+    Custom other;
+    EXPECT_TRUE(components::DeserializeBinaryData(binary, other, data));
+    EXPECT_EQ(comp.Data(), other.Data());
+
+    // Wrong size leaves the component unchanged
+    Custom unchanged;
+    EXPECT_FALSE(components::DeserializeBinaryData(binary, unchanged,
+        data.substr(0, data.size() - 1)));
+    EXPECT_EQ(math::Pose3d::Zero, unchanged.Data());
+  }
+
+  // Vector of doubles, including empty ones
+  {
+    using Custom = components::Component<std::vector<double>,
+        class CustomTag>;
+
+    const auto binary = components::ComponentBinarySerialization::Of<Custom>();
+    for (const auto &values : {std::vector<double>{1.5, -2.0, 3.25},
+        std::vector<double>{}})
+    {
+      Custom comp(values);
+      std::string data;
+      components::SerializeBinaryData(binary, comp, data);
+
+      Custom other(std::vector<double>{9.0});
+      EXPECT_TRUE(components::DeserializeBinaryData(binary, other, data));
+      EXPECT_EQ(values, other.Data());
+    }
+  }
+
+  // Stream serialized data isn't mistaken for binary data
+  {
+    using Custom = components::Component<double, class CustomTag>;
+
+    const auto binary = components::ComponentBinarySerialization::Of<Custom>();
+    Custom comp(1.5);
+    EXPECT_FALSE(components::DeserializeBinaryData(binary, comp, "2.5"));
+    EXPECT_FALSE(components::DeserializeBinaryData(binary, comp, ""));
+    EXPECT_DOUBLE_EQ(1.5, comp.Data());
+  }
+
+  // Types without binary serialization
+  {
+    using Bool = components::Component<bool, class CustomTag>;
+    using Name = components::Component<std::string, class CustomTag>;
+    using NoData = components::Component<components::NoData,
+        class CustomTag>;
+
+    const auto binary = components::ComponentBinarySerialization::Of<Bool>();
+    EXPECT_EQ(nullptr, binary.write);
+    EXPECT_EQ(nullptr,
+        components::ComponentBinarySerialization::Of<Name>().write);
+    EXPECT_EQ(nullptr,
+        components::ComponentBinarySerialization::Of<NoData>().write);
+
+    std::string data(components::kBinaryDataPrefix,
+        components::kBinaryDataPrefixSize);
+    Bool comp(true);
+    EXPECT_FALSE(components::DeserializeBinaryData(binary, comp, data));
+  }
+
+  // Registered types are looked up in the factory
+  {
+    EXPECT_NE(nullptr, components::Factory::Instance()->BinarySerialization(
+        components::Pose::typeId));
+    EXPECT_EQ(nullptr, components::Factory::Instance()->BinarySerialization(
+        components::Name::typeId));
+
+    components::Pose comp(math::Pose3d(1, 2, 3, 0, 0, 0));
+    std::string data;
+    EXPECT_TRUE(components::SerializeBinaryData(comp, data));
+
+    components::Pose other;
+    EXPECT_TRUE(components::DeserializeBinaryData(other, data));
+    EXPECT_EQ(comp.Data(), other.Data());
+
+    std::string unchanged{"name"};
+    EXPECT_FALSE(components::SerializeBinaryData(components::Name("a"),
+        unchanged));
+    EXPECT_EQ("name", unchanged);
+  }
+}
@@ -157,53 +157,51 @@ sdf::Collision gazebo::convert(const msgs::Collision &_in)
 }
 
 //////////////////////////////////////////////////
-template<>
-IGNITION_GAZEBO_VISIBLE
-msgs::Geometry gazebo::convert(const sdf::Geometry &_in)
+void gazebo::set(msgs::Geometry *_msg, const sdf::Geometry &_in)
 {
-  msgs::Geometry out;
+  _msg->Clear();
   if (_in.Type() == sdf::GeometryType::BOX && _in.BoxShape())
   {
-    out.set_type(msgs::Geometry::BOX);
-    msgs::Set(out.mutable_box()->mutable_size(), _in.BoxShape()->Size());
+    _msg->set_type(msgs::Geometry::BOX);
+    msgs::Set(_msg->mutable_box()->mutable_size(), _in.BoxShape()->Size());
   }
   else if (_in.Type() == sdf::GeometryType::CAPSULE && _in.CapsuleShape())
   {
-    out.set_type(msgs::Geometry::CAPSULE);
-    out.mutable_capsule()->set_radius(_in.CapsuleShape()->Radius());
-    out.mutable_capsule()->set_length(_in.CapsuleShape()->Length());
+    _msg->set_type(msgs::Geometry::CAPSULE);
+    _msg->mutable_capsule()->set_radius(_in.CapsuleShape()->Radius());
+    _msg->mutable_capsule()->set_length(_in.CapsuleShape()->Length());
   }
   else if (_in.Type() == sdf::GeometryType::CYLINDER && _in.CylinderShape())
   {
-    out.set_type(msgs::Geometry::CYLINDER);
-    out.mutable_cylinder()->set_radius(_in.CylinderShape()->Radius());
-    out.mutable_cylinder()->set_length(_in.CylinderShape()->Length());
+    _msg->set_type(msgs::Geometry::CYLINDER);
+    _msg->mutable_cylinder()->set_radius(_in.CylinderShape()->Radius());
+    _msg->mutable_cylinder()->set_length(_in.CylinderShape()->Length());
   }
   else if (_in.Type() == sdf::GeometryType::ELLIPSOID && _in.EllipsoidShape())
   {
-    out.set_type(msgs::Geometry::ELLIPSOID);
-    msgs::Set(out.mutable_ellipsoid()->mutable_radii(),
+    _msg->set_type(msgs::Geometry::ELLIPSOID);
+    msgs::Set(_msg->mutable_ellipsoid()->mutable_radii(),
              _in.EllipsoidShape()->Radii());
   }
   else if (_in.Type() == sdf::GeometryType::PLANE && _in.PlaneShape())
   {
-    out.set_type(msgs::Geometry::PLANE);
-    msgs::Set(out.mutable_plane()->mutable_normal(),
+    _msg->set_type(msgs::Geometry::PLANE);
+    msgs::Set(_msg->mutable_plane()->mutable_normal(),
               _in.PlaneShape()->Normal());
-    msgs::Set(out.mutable_plane()->mutable_size(),
+    msgs::Set(_msg->mutable_plane()->mutable_size(),
               _in.PlaneShape()->Size());
   }
   else if (_in.Type() == sdf::GeometryType::SPHERE && _in.SphereShape())
   {
-    out.set_type(msgs::Geometry::SPHERE);
-    out.mutable_sphere()->set_radius(_in.SphereShape()->Radius());
+    _msg->set_type(msgs::Geometry::SPHERE);
+    _msg->mutable_sphere()->set_radius(_in.SphereShape()->Radius());
   }
   else if (_in.Type() == sdf::GeometryType::MESH && _in.MeshShape())
   {
     auto meshSdf = _in.MeshShape();
 
-    out.set_type(msgs::Geometry::MESH);
-    auto meshMsg = out.mutable_mesh();
+    _msg->set_type(msgs::Geometry::MESH);
+    auto meshMsg = _msg->mutable_mesh();
 
     msgs::Set(meshMsg->mutable_scale(), meshSdf->Scale());
     meshMsg->set_filename(asFullPath(meshSdf->Uri(), meshSdf->FilePath()));
@@ -214,8 +212,8 @@ msgs::Geometry gazebo::convert(const sdf::Geometry &_in)
   {
     auto heightmapSdf = _in.HeightmapShape();
 
-    out.set_type(msgs::Geometry::HEIGHTMAP);
-    auto heightmapMsg = out.mutable_heightmap();
+    _msg->set_type(msgs::Geometry::HEIGHTMAP);
+    auto heightmapMsg = _msg->mutable_heightmap();
 
     heightmapMsg->set_filename(asFullPath(heightmapSdf->Uri(),
         heightmapSdf->FilePath()));
@@ -246,10 +244,10 @@ msgs::Geometry gazebo::convert(const sdf::Geometry &_in)
   else if (_in.Type() == sdf::GeometryType::POLYLINE &&
       !_in.PolylineShape().empty())
   {
-    out.set_type(msgs::Geometry::POLYLINE);
+    _msg->set_type(msgs::Geometry::POLYLINE);
     for (const auto &polyline : _in.PolylineShape())
     {
-      auto polylineMsg = out.add_polyline();
+      auto polylineMsg = _msg->add_polyline();
       polylineMsg->set_height(polyline.Height());
       for (const auto &point : polyline.Points())
       {
@@ -262,6 +260,15 @@ msgs::Geometry gazebo::convert(const sdf::Geometry &_in)
     ignerr << "Geometry type [" << static_cast<int>(_in.Type())
            << "] not supported" << std::endl;
   }
+}
+
+//////////////////////////////////////////////////
+template<>
+IGNITION_GAZEBO_VISIBLE
+msgs::Geometry gazebo::convert(const sdf::Geometry &_in)
+{
+  msgs::Geometry out;
+  set(&out, _in);
   return out;
 }
 
@@ -732,12 +739,7 @@ msgs::Time gazebo::convert(
     const std::chrono::steady_clock::duration &_in)
 {
   msgs::Time out;
-
-  auto secNsec = math::durationToSecNsec(_in);
-
-  out.set_sec(secNsec.first);
-  out.set_nsec(secNsec.second);
-
+  set(&out, _in);
   return out;
 }
 
@@ -1602,25 +1604,39 @@ IGNITION_GAZEBO_VISIBLE
 gazebo::UpdateInfo gazebo::convert(const msgs::WorldStatistics &_in)
 {
   gazebo::UpdateInfo out;
-  out.iterations = _in.iterations();
-  out.paused = _in.paused();
-  out.simTime = convert<std::chrono::steady_clock::duration>(_in.sim_time());
-  out.realTime = convert<std::chrono::steady_clock::duration>(_in.real_time());
-  out.dt = convert<std::chrono::steady_clock::duration>(_in.step_size());
+  set(&out, _in);
   return out;
 }
 
+//////////////////////////////////////////////////
+void gazebo::set(gazebo::UpdateInfo *_info, const msgs::WorldStatistics &_in)
+{
+  _info->iterations = _in.iterations();
+  _info->paused = _in.paused();
+  _info->simTime =
+      convert<std::chrono::steady_clock::duration>(_in.sim_time());
+  _info->realTime =
+      convert<std::chrono::steady_clock::duration>(_in.real_time());
+  _info->dt = convert<std::chrono::steady_clock::duration>(_in.step_size());
+}
+
 //////////////////////////////////////////////////
 template<>
 IGNITION_GAZEBO_VISIBLE
 msgs::AxisAlignedBox gazebo::convert(const math::AxisAlignedBox &_in)
 {
   msgs::AxisAlignedBox out;
-  msgs::Set(out.mutable_min_corner(), _in.Min());
-  msgs::Set(out.mutable_max_corner(), _in.Max());
+  set(&out, _in);
   return out;
 }
 
+//////////////////////////////////////////////////
+void gazebo::set(msgs::AxisAlignedBox *_msg, const math::AxisAlignedBox &_in)
+{
+  msgs::Set(_msg->mutable_min_corner(), _in.Min());
+  msgs::Set(_msg->mutable_max_corner(), _in.Max());
+}
+
 //////////////////////////////////////////////////
 template<>
 IGNITION_GAZEBO_VISIBLE
@@ -351,6 +351,43 @@ TEST(Conversions, GeometryBox)
   EXPECT_EQ(math::Vector3d(1, 2, 3), newGeometry.BoxShape()->Size());
 }
 
+/////////////////////////////////////////////////
+TEST(Conversions, SetGeometry)
+{
+  sdf::Geometry polylineGeometry;
+  polylineGeometry.SetType(sdf::GeometryType::POLYLINE);
+  sdf::Polyline polyline;
+  polyline.SetHeight(1.0);
+  polyline.AddPoint({1.0, 2.0});
+  polylineGeometry.SetPolylineShape({polyline});
+
+  msgs::Geometry geometryMsg;
+  set(&geometryMsg, polylineGeometry);
+  EXPECT_EQ(msgs::Geometry::POLYLINE, geometryMsg.type());
+  ASSERT_EQ(1, geometryMsg.polyline_size());
+
+  // Setting the same message again replaces its contents
+  sdf::Geometry boxGeometry;
+  boxGeometry.SetType(sdf::GeometryType::BOX);
+  sdf::Box boxShape;
+  boxShape.SetSize(math::Vector3d(1, 2, 3));
+  boxGeometry.SetBoxShape(boxShape);
+
+  set(&geometryMsg, boxGeometry);
+  EXPECT_EQ(msgs::Geometry::BOX, geometryMsg.type());
+  EXPECT_EQ(0, geometryMsg.polyline_size());
+  EXPECT_EQ(math::Vector3d(1, 2, 3),
+      msgs::Convert(geometryMsg.box().size()));
+
+  set(&geometryMsg, polylineGeometry);
+  EXPECT_EQ(msgs::Geometry::POLYLINE, geometryMsg.type());
+  EXPECT_FALSE(geometryMsg.has_box());
+  ASSERT_EQ(1, geometryMsg.polyline_size());
+  ASSERT_EQ(1, geometryMsg.polyline(0).point_size());
+  EXPECT_DOUBLE_EQ(1.0, geometryMsg.polyline(0).point(0).x());
+  EXPECT_DOUBLE_EQ(2.0, geometryMsg.polyline(0).point(0).y());
+}
+
 /////////////////////////////////////////////////
 TEST(Conversions, GeometrySphere)
 {
@@ -875,6 +912,14 @@ TEST(Conversions, UpdateInfo)
   auto newInfo = convert<UpdateInfo>(statsMsg);
   EXPECT_EQ(1234000000, newInfo.simTime.count());
   EXPECT_TRUE(newInfo.paused);
+
+  UpdateInfo newInfo2;
+  set(&newInfo2, statsMsg);
+  EXPECT_EQ(1234000000, newInfo2.simTime.count());
+  EXPECT_EQ(2345000000, newInfo2.realTime.count());
+  EXPECT_EQ(3456000000, newInfo2.dt.count());
+  EXPECT_EQ(1234u, newInfo2.iterations);
+  EXPECT_TRUE(newInfo2.paused);
 }
 
 /////////////////////////////////////////////////
@@ -897,6 +942,10 @@ TEST(Conversions, AxisAlignedbox)
   auto aabb2 = convert<math::AxisAlignedBox>(aabbMsg2);
   EXPECT_EQ(math::Vector3d(2, 3, 4), aabb2.Min());
   EXPECT_EQ(math::Vector3d(20, 30, 40), aabb2.Max());
+
+  set(&aabbMsg2, aabb);
+  EXPECT_EQ(math::Vector3d(-1, -2, -3), msgs::Convert(aabbMsg2.min_corner()));
+  EXPECT_EQ(math::Vector3d(1, 2, 3), msgs::Convert(aabbMsg2.max_corner()));
 }
 
 /////////////////////////////////////////////////
@@ -17,18 +17,29 @@
 
 #include "ignition/gazebo/EntityComponentManager.hh"
 
+#include <algorithm>
+#include <atomic>
+#include <istream>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
 #include <set>
 #include <sstream>
+#include <streambuf>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
 #include <ignition/common/Profiler.hh>
-#include <ignition/math/graph/GraphAlgorithms.hh>
 
 #include "ignition/gazebo/components/CanonicalLink.hh"
 #include "ignition/gazebo/components/ChildLinkName.hh"
@@ -39,12 +50,278 @@
 #include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/ParentLinkName.hh"
+#include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/Recreate.hh"
+#include "ignition/gazebo/components/Static.hh"
 #include "ignition/gazebo/components/World.hh"
 
+#include "ComponentPool.hh"
+#include "ComponentSignature.hh"
+#include "EntityHierarchy.hh"
+#include "WorkStealingPool.hh"
+
 using namespace ignition;
 using namespace gazebo;
 
+/// \brief Deleter for components held by the entity component manager.
+/// Components are usually constructed in a ComponentPool, in which case they
+/// must be destroyed in place and their memory handed back to the pool.
+/// Components without a placement in the factory are heap allocated.
+struct ComponentDeleter
+{
+  /// \brief Pool which owns the component's memory, or nullptr if the
+  /// component was heap allocated.
+  ComponentPool *pool{nullptr};
+
+  /// \brief Destroy a component.
+  /// \param[in] _comp Component to destroy.
+  void operator()(components::BaseComponent *_comp) const
+  {
+    if (nullptr == this->pool)
+    {
+      delete _comp;
+      return;
+    }
+
+    // Get the address of the most derived object, which is where the
+    // component was constructed.
+    void *memory = dynamic_cast<void *>(_comp);
+    _comp->~BaseComponent();
+    this->pool->Release(memory);
+  }
+};
+
+/// \brief Owning pointer to a component stored in the ECM.
+using ComponentPtr =
+    std::unique_ptr<components::BaseComponent, ComponentDeleter>;
+
+/// \brief Stream buffer which appends everything written to it to a string.
+/// This lets components serialize straight into a message field, reusing its
+/// capacity, instead of going through a temporary std::ostringstream.
+class StringAppendBuf : public std::streambuf
+{
+  /// \brief Set the string to append to.
+  /// \param[in] _target String to append to, or nullptr.
+  public: void SetTarget(std::string *_target)
+  {
+    this->target = _target;
+  }
+
+  // Documentation inherited
+  protected: int_type overflow(int_type _c) override
+  {
+    if (nullptr == this->target)
+      return traits_type::eof();
+    if (!traits_type::eq_int_type(_c, traits_type::eof()))
+      this->target->push_back(traits_type::to_char_type(_c));
+    return traits_type::not_eof(_c);
+  }
+
+  // Documentation inherited
+  protected: std::streamsize xsputn(const char *_s, std::streamsize _n)
+      override
+  {
+    if (nullptr == this->target)
+      return 0;
+    this->target->append(_s, static_cast<std::size_t>(_n));
+    return _n;
+  }
+
+  /// \brief String being appended to.
+  private: std::string *target{nullptr};
+};
+
+/// \brief Serialize a component into a string. The string is overwritten,
+/// but keeps its capacity, so serializing into a reused message doesn't
+/// allocate once the message has grown to its steady-state size.
+/// \param[in] _comp Component to serialize.
+/// \param[out] _out String to hold the serialized data.
+/// \param[in] _binary True to use the binary serialization of the component,
+/// if it has one.
+static void SerializeComponent(const components::BaseComponent *_comp,
+    std::string *_out, bool _binary)
+{
+  if (_binary && components::SerializeBinaryData(*_comp, *_out))
+    return;
+
+  // One stream per thread, since states may be generated concurrently from
+  // multiple PostUpdate threads.
+  thread_local StringAppendBuf buffer;
+  thread_local std::ostream stream(&buffer);
+  thread_local const std::ios_base::fmtflags defaultFlags = stream.flags();
+
+  // Match the state of a newly constructed stream
+  stream.clear();
+  stream.flags(defaultFlags);
+  stream.precision(6);
+  stream.width(0);
+  stream.fill(' ');
+
+  _out->clear();
+  buffer.SetTarget(_out);
+  _comp->Serialize(stream);
+  buffer.SetTarget(nullptr);
+}
+
+/// \brief Stream buffer which reads from a string without copying it, unlike
+/// std::istringstream.
+class StringReadBuf : public std::streambuf
+{
+  /// \brief Set the string to read from. The string must outlive any reads.
+  /// \param[in] _source String to read from.
+  public: void SetSource(const std::string &_source)
+  {
+    // The get area is never written to, std::streambuf just doesn't have a
+    // const interface.
+    auto begin = const_cast<char *>(_source.data());
+    this->setg(begin, begin, begin + _source.size());
+  }
+
+  // Documentation inherited
+  protected: pos_type seekoff(off_type _off, std::ios_base::seekdir _dir,
+      std::ios_base::openmode _which) override
+  {
+    if (!(_which & std::ios_base::in))
+      return pos_type(off_type(-1));
+
+    char *base = this->eback();
+    if (_dir == std::ios_base::cur)
+      _off += this->gptr() - base;
+    else if (_dir == std::ios_base::end)
+      _off += this->egptr() - base;
+
+    if (_off < 0 || _off > this->egptr() - base)
+      return pos_type(off_type(-1));
+
+    this->setg(base, base + _off, this->egptr());
+    return pos_type(_off);
+  }
+
+  // Documentation inherited
+  protected: pos_type seekpos(pos_type _pos, std::ios_base::openmode _which)
+      override
+  {
+    return this->seekoff(off_type(_pos), std::ios_base::beg, _which);
+  }
+};
+
+/// \brief Deserialize a component from a string, in either binary or stream
+/// form.
+/// \param[in] _comp Component to deserialize into.
+/// \param[in] _data Serialized data.
+static void DeserializeComponent(components::BaseComponent *_comp,
+    const std::string &_data)
+{
+  if (components::DeserializeBinaryData(*_comp, _data))
+    return;
+
+  // One stream per thread, since SetState deserializes components
+  // concurrently.
+  thread_local StringReadBuf buffer;
+  thread_local std::istream stream(&buffer);
+  thread_local const std::ios_base::fmtflags defaultFlags = stream.flags();
+
+  // Match the state of a newly constructed stream
+  buffer.SetSource(_data);
+  stream.clear();
+  stream.flags(defaultFlags);
+  stream.width(0);
+
+  _comp->Deserialize(stream);
+}
+
+/// \brief Number of entity component managers ever created, used to give
+/// each of them a unique id.
+static std::atomic<uint64_t> gManagerCount{0u};
+
+/// \brief Key of the task running on this thread, which identifies it
+/// the same way on every run. Zero outside of tasks. Each level of nested
+/// ParallelFor chunks takes kTaskKeyBits more bits, so keys never collide.
+static thread_local uint64_t tTaskKey{0u};
+
+/// \brief Bits taken by the chunk index in a task key.
+static constexpr unsigned int kTaskKeyBits{7u};
+
+/// \brief Number of chunks ParallelFor splits a range into in deterministic
+/// mode, whatever the number of threads. Must fit in kTaskKeyBits.
+static constexpr std::size_t kDeterministicChunks{64u};
+
+/// \brief Number of consecutive entity ids assigned to the same NUMA
+/// partition. Large enough to keep the entities of a model together.
+static constexpr Entity kNumaEntityRange{256u};
+
+/// \brief NUMA partition of an entity. Ranges of ids are dealt to the
+/// partitions in turn, so partitions grow evenly as entities are created.
+/// \param[in] _entity Entity.
+/// \param[in] _partitions Number of partitions.
+/// \return Partition index.
+static unsigned int numaPartition(const Entity _entity,
+    const std::size_t _partitions)
+{
+  if (_partitions <= 1u)
+    return 0u;
+  return static_cast<unsigned int>((_entity / kNumaEntityRange) % _partitions);
+}
+
+/// \brief Demands held for components, shared between a manager and its
+/// ComponentDemand handles, so handles can outlive the manager.
+class ComponentDemandRegistry
+{
+  /// \brief Demands for a component type of an entity.
+  public: struct Demand
+  {
+    /// \brief Type of the component.
+    ComponentTypeId type;
+
+    /// \brief Number of demands which weren't released.
+    std::size_t count;
+
+    /// \brief True if the first demand created the component.
+    bool created;
+  };
+
+  /// \brief Find the demands for a component.
+  /// \param[in] _entity The entity.
+  /// \param[in] _type Type of the component.
+  /// \return Pointer to the demands, or nullptr if there are none.
+  public: Demand *Find(const Entity _entity, const ComponentTypeId _type)
+  {
+    auto it = this->demands.find(_entity);
+    if (it == this->demands.end())
+      return nullptr;
+    for (auto &demand : it->second)
+    {
+      if (demand.type == _type)
+        return &demand;
+    }
+    return nullptr;
+  }
+
+  /// \brief Release a demand.
+  /// \param[in] _entity The entity.
+  /// \param[in] _type Type of the component.
+  public: void Release(const Entity _entity, const ComponentTypeId _type)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto *demand = this->Find(_entity, _type);
+    if (nullptr == demand || 0u == demand->count)
+      return;
+    if (0u == --demand->count)
+      this->released.emplace_back(_entity, _type);
+  }
+
+  /// \brief Protects all members, since handles may be released from any
+  /// thread.
+  public: std::mutex mutex;
+
+  /// \brief Demands of each entity.
+  public: std::unordered_map<Entity, std::vector<Demand>> demands;
+
+  /// \brief Components whose demand count reached zero since they were
+  /// last processed.
+  public: std::vector<std::pair<Entity, ComponentTypeId>> released;
+};
+
 class ignition::gazebo::EntityComponentManagerPrivate
 {
   /// \brief Implementation of the CreateEntity function, which takes a specific
@@ -53,6 +330,13 @@ class ignition::gazebo::EntityComponentManagerPrivate
   /// \return Created entity, which should match the input.
   public: Entity CreateEntityImplementation(Entity _entity);
 
+  /// \brief Create multiple entities at once. This is equivalent to calling
+  /// CreateEntityImplementation for each of them, but storage is only grown
+  /// and locks are only taken once.
+  /// \param[in] _entities Entities to be created. They must not exist yet.
+  public: void CreateEntitiesImplementation(
+      const std::vector<Entity> &_entities);
+
   /// \brief Recursively insert an entity and all its descendants into a given
   /// set.
   /// \param[in] _entity Entity to be inserted.
@@ -95,6 +379,30 @@ class ignition::gazebo::EntityComponentManagerPrivate
   /// \param[in] _entity Entity that has component newly modified
   public: void AddModifiedComponent(const Entity &_entity);
 
+  /// \brief Assign a new version to a component, to record that it has
+  /// changed.
+  /// \param[in] _entity Entity that owns the component.
+  /// \param[in] _typeId Type of the component.
+  public: void BumpComponentVersion(const Entity _entity,
+              const ComponentTypeId _typeId);
+
+  /// \brief Record that an entity's place in the child index may have
+  /// changed, if the component is a Name or ParentEntity, and that cached
+  /// world poses are out of date, if it's a Pose or ParentEntity.
+  /// \param[in] _entity Entity that owns the component.
+  /// \param[in] _typeId Type of the component.
+  public: void InvalidateIndices(const Entity _entity,
+              const ComponentTypeId _typeId);
+
+  /// \brief Remove an entity from the child index.
+  /// \param[in] _entity Entity to remove.
+  public: void RemoveFromChildIndex(const Entity _entity) const;
+
+  /// \brief Recompute staticEntities if needed. Must be called with
+  /// staticMutex locked.
+  /// \param[in] _ecm Manager owning this.
+  public: void UpdateStaticEntities(const EntityComponentManager &_ecm) const;
+
   /// \brief Check whether a component is marked as a component that is
   /// currently removed or not.
   /// \param[in] _entity The entity
@@ -104,6 +412,44 @@ class ignition::gazebo::EntityComponentManagerPrivate
   public: bool ComponentMarkedAsRemoved(const Entity _entity,
               const ComponentTypeId _typeId) const;
 
+  /// \brief Get the bit of a component type in signatures, assigning the
+  /// next free bit if the type doesn't have one yet.
+  /// \param[in] _typeId Component type.
+  /// \return Index of the bit.
+  public: std::size_t ComponentTypeBit(const ComponentTypeId _typeId);
+
+  /// \brief Build the signature of a set of component types, without
+  /// assigning bits.
+  /// \param[in] _types Component types.
+  /// \param[out] _signature Signature with the bits of _types set.
+  /// \return False if a type doesn't have a bit yet, in which case no
+  /// entity can have all the types.
+  public: bool TypesSignature(const std::set<ComponentTypeId> &_types,
+              ComponentSignature &_signature) const;
+
+  /// \brief Get the signature of the component types required by a view,
+  /// computing it the first time.
+  /// \param[in] _view The view.
+  /// \return The view's signature.
+  public: const ComponentSignature &ViewSignature(
+              const detail::BaseView *_view);
+
+  /// \brief Check whether an entity has all the components of a
+  /// signature, not counting removed ones.
+  /// \param[in] _entity The entity.
+  /// \param[in] _signature Required components.
+  /// \return True if the entity matches.
+  public: bool EntityMatchesSignature(const Entity _entity,
+              const ComponentSignature &_signature) const;
+
+  /// \brief Set or clear the bit of a component type in the signature of
+  /// an entity.
+  /// \param[in] _entity The entity.
+  /// \param[in] _typeId Component type.
+  /// \param[in] _present True if the entity now has the component.
+  public: void UpdateSignature(const Entity _entity,
+              const ComponentTypeId _typeId, bool _present);
+
   /// \brief Set a cloned joint's parent or child link name.
   /// \param[in] _joint The cloned joint.
   /// \param[in] _originalLink The original joint's parent or child link.
@@ -120,12 +466,38 @@ class ignition::gazebo::EntityComponentManagerPrivate
           bool ClonedJointLinkName(Entity _joint, Entity _originalLink,
               EntityComponentManager *_ecm);
 
+  /// \brief Instantiate a new component. The component is placed in the pool
+  /// for its type, so that components of the same type are contiguous in
+  /// memory. If the component type has no placement in the factory, it is
+  /// allocated on the heap by its descriptor instead.
+  /// \param[in] _entity Entity the component belongs to, which decides
+  /// the NUMA partition its memory comes from.
+  /// \param[in] _typeId Type of the component to create.
+  /// \param[in] _data Data used to construct the component, or nullptr to
+  /// default construct it.
+  /// \return The new component, or nullptr if it couldn't be created.
+  public: ComponentPtr NewComponent(const Entity _entity,
+              const ComponentTypeId _typeId,
+              const components::BaseComponent *_data);
+
   /// \brief All component types that have ever been created.
   public: std::unordered_set<ComponentTypeId> createdCompTypes;
 
-  /// \brief A graph holding all entities, arranged according to their
-  /// parenting.
-  public: EntityGraph entities;
+  /// \brief All entities, arranged according to their parenting.
+  public: EntityHierarchy hierarchy;
+
+  /// \brief Graph of all entities, only built when requested through
+  /// Entities(), for backwards compatibility.
+  public: mutable EntityGraph entities;
+
+  /// \brief True if the hierarchy changed since the graph was built.
+  public: mutable bool entitiesDirty{false};
+
+  /// \brief Protects building the graph.
+  public: mutable std::mutex entitiesMutex;
+
+  /// \brief Reused buffer for walking descendants.
+  public: std::vector<Entity> descendantsBuffer;
 
   /// \brief Components that have been changed through a periodic change.
   /// The key is the type of component which has changed, and the value is the
@@ -177,14 +549,230 @@ class ignition::gazebo::EntityComponentManagerPrivate
   /// new entities to them or not.
   public: bool lockAddEntitiesToViews{false};
 
-  /// \brief Cache of previously queried descendants. The key is the parent
-  /// entity for which descendants were queried, and the value are all its
-  /// descendants.
-  public: mutable std::unordered_map<Entity, std::unordered_set<Entity>>
-          descendantCache;
+  /// \brief Get the worker pool, creating it if needed.
+  /// \return The worker pool.
+  public: std::shared_ptr<WorkStealingPool> WorkerPool();
+
+  /// \brief Run tasks on the worker pool, or on the calling thread if
+  /// there's only one task or one thread.
+  /// \param[in] _count Number of tasks.
+  /// \param[in] _task Function called with each task index.
+  public: void RunTasks(std::size_t _count,
+              const std::function<void(std::size_t)> &_task);
+
+  /// \brief Worker pool used by State, SetState and EachParallel. Either
+  /// set by the runner, or created the first time it's needed, so that
+  /// entity component managers that don't need it don't spawn threads.
+  public: std::shared_ptr<WorkStealingPool> workerPool;
+
+  /// \brief True if workerPool was set through SetWorkerPool.
+  public: bool externalWorkerPool{false};
+
+  /// \brief Maximum number of threads used to split up work.
+  public: unsigned int maxThreads{
+      std::max(std::thread::hardware_concurrency(), 1u)};
+
+  /// \brief Protects workerPool, which may be lazily created from
+  /// concurrent const calls.
+  public: std::mutex workerPoolMutex;
+
+  /// \brief A mutex to protect the changed component maps, since systems
+  /// running concurrently may mark components as changed.
+  public: std::mutex changedComponentsMutex;
+
+  /// \brief Version assigned to the latest component change. Versions
+  /// increase monotonically and are never reset, unlike the changed
+  /// component maps which are cleared every iteration.
+  public: uint64_t componentVersion{0u};
+
+  /// \brief Version of the last change of each component. The key is the
+  /// entity, and the value maps component types to versions. Removed
+  /// components keep their entry until the entity is removed, so that
+  /// ChangedStateSince can report them.
+  public: std::unordered_map<Entity,
+          std::unordered_map<ComponentTypeId, uint64_t>> componentVersions;
+
+  /// \brief Version of the last change of any component of each type.
+  /// Unlike componentVersions, it's kept when entities are removed.
+  public: std::unordered_map<ComponentTypeId, uint64_t> componentTypeVersions;
+
+  /// \brief Kinds of changes collected for component observers.
+  public: enum class ObservedChange : uint8_t
+  {
+    ADDED,
+    CHANGED,
+    REMOVED
+  };
+
+  /// \brief A component observer and the changes it wasn't notified of yet.
+  public: struct Observer
+  {
+    /// \brief Type of the observed components.
+    ComponentTypeId typeId{0u};
+
+    /// \brief Only this entity and its descendants are reported, unless
+    /// it's kNullEntity.
+    Entity root{kNullEntity};
+
+    /// \brief Function to notify.
+    EntityComponentManager::ComponentObserver callback;
+
+    /// \brief Changes in the order they happened.
+    std::vector<std::pair<Entity, ObservedChange>> pending;
+  };
+
+  /// \brief Record a change for the observers of a component type.
+  /// \param[in] _entity Entity that owns the component.
+  /// \param[in] _typeId Type of the component.
+  /// \param[in] _change Kind of change.
+  public: void RecordObservedChange(const Entity _entity,
+              const ComponentTypeId _typeId, ObservedChange _change);
+
+  /// \brief Whether an entity is in the subtree of an observer.
+  /// \param[in] _entity Entity to check.
+  /// \param[in] _root Root of the subtree, kNullEntity for all entities.
+  /// \return True if _entity is _root or one of its descendants.
+  public: bool InSubtree(Entity _entity, Entity _root) const;
+
+  /// \brief Component observers keyed by id, so that they're notified in
+  /// the order they were added.
+  public: std::map<uint64_t, Observer> observers;
+
+  /// \brief Observers of each component type. Pointers are into observers.
+  public: std::unordered_map<ComponentTypeId, std::vector<Observer *>>
+            typeObservers;
+
+  /// \brief Id of the last observer added.
+  public: uint64_t lastObserverId{0u};
+
+  /// \brief Children of one entity in the child index.
+  public: struct IndexedChildren
+  {
+    /// \brief All children, sorted by entity ID.
+    std::vector<Entity> children;
+
+    /// \brief Children which have a name, keyed by it.
+    std::unordered_multimap<std::string, Entity> byName;
+  };
+
+  /// \brief Where an entity was added to the child index.
+  public: struct ChildIndexKey
+  {
+    /// \brief Value of the ParentEntity component.
+    Entity parent;
+
+    /// \brief Value of the Name component, if the entity has one.
+    std::optional<std::string> name;
+  };
+
+  /// \brief Index of children by name, keyed by the value of their
+  /// ParentEntity component. Changes are queued in childIndexPending and
+  /// applied on the next lookup.
+  public: mutable std::unordered_map<Entity, IndexedChildren> childIndex;
+
+  /// \brief Where each indexed entity was added to childIndex.
+  public: mutable std::unordered_map<Entity, ChildIndexKey> childIndexKeys;
+
+  /// \brief Entities whose Name or ParentEntity changed, or which were
+  /// removed, since the child index was last updated.
+  public: mutable std::unordered_set<Entity> childIndexPending;
+
+  /// \brief Protects the child index, which is updated during const
+  /// lookups that systems may make in parallel.
+  public: mutable std::mutex childIndexMutex;
+
+  /// \brief World pose of an entity, cached by EntityWorldPose.
+  public: struct CachedWorldPose
+  {
+    /// \brief Pose in the world frame.
+    math::Pose3d pose;
+
+    /// \brief Value of worldPoseEpoch when the pose was computed.
+    uint64_t epoch{0u};
+  };
+
+  /// \brief World poses computed since the last change to a Pose or
+  /// ParentEntity component, by entity. Entries from older epochs are out of
+  /// date.
+  public: mutable std::unordered_map<Entity, CachedWorldPose> worldPoseCache;
+
+  /// \brief Incremented whenever cached world poses may be out of date.
+  public: std::atomic<uint64_t> worldPoseEpoch{1u};
+
+  /// \brief Value of worldPoseEpoch when the world pose of a static entity
+  /// may have last changed. Cached poses of static entities are valid as
+  /// long as it doesn't change, across steps.
+  public: std::atomic<uint64_t> staticPoseEpoch{1u};
+
+  /// \brief Entities which are static, see IsStatic.
+  public: mutable std::unordered_set<Entity> staticEntities;
+
+  /// \brief Whether staticEntities must be recomputed, because a Static or
+  /// ParentEntity component changed.
+  public: std::atomic<bool> staticDirty{true};
+
+  /// \brief Incremented whenever staticEntities is recomputed.
+  public: mutable uint64_t staticVersion{0u};
+
+  /// \brief Non-static entities of a view, see EachDynamic.
+  public: struct DynamicEntities
+  {
+    /// \brief Version of the view's entities the list was made from.
+    uint64_t viewVersion{0u};
+
+    /// \brief staticVersion the list was made from.
+    uint64_t staticVersion{0u};
+
+    /// \brief The entities.
+    std::vector<Entity> entities;
+  };
+
+  /// \brief Non-static entities of each view used by EachDynamic.
+  public: mutable std::unordered_map<const detail::BaseView *,
+      DynamicEntities> dynamicEntities;
+
+  /// \brief Protects the static entities and the dynamic entities of
+  /// views, which are updated during const calls that systems may make in
+  /// parallel.
+  public: mutable std::mutex staticMutex;
+
+  /// \brief Protects the world pose cache, which is filled during const
+  /// lookups that systems may make in parallel.
+  public: mutable std::mutex worldPoseMutex;
+
+  /// \brief Whether state messages hold components in binary form.
+  public: bool binarySerialization{false};
 
   /// \brief Keep track of entities already used to ensure uniqueness.
-  public: uint64_t entityCount{0};
+  /// Atomic so command buffers can reserve ids from any thread.
+  public: std::atomic<uint64_t> entityCount{0};
+
+  /// \brief Unique id of this manager, which tells the command buffer
+  /// cached by each thread apart from buffers of other managers.
+  public: const uint64_t managerId{++gManagerCount};
+
+  /// \brief Command buffers of all threads, in the order the threads first
+  /// asked for them.
+  public: std::vector<std::unique_ptr<EntityCommandBuffer>> commandBuffers;
+
+  /// \brief Command buffer of each thread.
+  public: std::unordered_map<std::thread::id, EntityCommandBuffer *>
+            threadCommandBuffers;
+
+  /// \brief Protects the command buffer containers. Each thread only locks
+  /// it the first time it asks for its buffer.
+  public: std::mutex commandBuffersMutex;
+
+  /// \brief Command buffer of each task, used in deterministic mode.
+  public: std::unordered_map<uint64_t, EntityCommandBuffer *>
+            taskCommandBuffers;
+
+  /// \brief Whether parallel work is reproducible, see SetDeterministic.
+  public: bool deterministic{false};
+
+  /// \brief NUMA node of each partition of component storage, see
+  /// SetNumaNodes.
+  public: std::vector<unsigned int> numaNodes;
 
   /// \brief Unordered map of removed components. The key is the entity to
   /// which belongs the component, and the value is a set of the component types
@@ -200,9 +788,26 @@ class ignition::gazebo::EntityComponentManagerPrivate
   public: std::unordered_map<Entity, std::unordered_set<ComponentTypeId>>
     componentsMarkedAsRemoved;
 
+  /// \brief How components of a type are allocated.
+  public: struct ComponentTypePool
+  {
+    /// \brief Contiguous memory pool. A nullptr value means the type can't
+    /// be pooled, so its components are heap allocated.
+    std::unique_ptr<ComponentPool> pool;
+
+    /// \brief Index of the type in the component factory, resolved once so
+    /// the type's descriptor is found without a map lookup.
+    std::size_t factoryIndex{components::Factory::kInvalidTypeIndex};
+  };
+
+  /// \brief Allocation of each component type.
+  /// This must be declared before componentStorage so that the pools outlive
+  /// all the components they hold.
+  public: std::unordered_map<ComponentTypeId, ComponentTypePool>
+            componentPools;
+
   /// \brief A map of an entity to its components
-  public: std::unordered_map<Entity,
-           std::vector<std::unique_ptr<components::BaseComponent>>>
+  public: std::unordered_map<Entity, std::vector<ComponentPtr>>
              componentStorage;
 
   /// \brief A map that keeps track of where each type of component is
@@ -232,6 +837,27 @@ class ignition::gazebo::EntityComponentManagerPrivate
           std::unordered_map<ComponentTypeId, std::size_t>>::iterator>
             componentTypeIndexIterators;
 
+  /// \brief Bit of each component type held by this manager in component
+  /// signatures. Bits are dense, so signatures stay small even though type
+  /// ids are hashes.
+  public: std::unordered_map<ComponentTypeId, std::size_t>
+            componentTypeBits;
+
+  /// \brief Signature of the components each entity currently has, which
+  /// excludes components marked as removed.
+  public: std::unordered_map<Entity, ComponentSignature> entitySignatures;
+
+  /// \brief Entities currently having each component type, kept in sync
+  /// with entitySignatures. New views only check the entities of their
+  /// rarest required type instead of every entity.
+  public: std::unordered_map<ComponentTypeId, std::unordered_set<Entity>>
+            typeEntities;
+
+  /// \brief Signature of the components required by each view. Cleared
+  /// when views are cleared or a component type gets a new bit.
+  public: std::unordered_map<const detail::BaseView *, ComponentSignature>
+            viewSignatures;
+
   /// \brief True if the componentTypeIndex map was changed.  Primarily used
   /// by the multithreading functionality in `State()` to allocate work to
   /// each thread.
@@ -276,6 +902,10 @@ class ignition::gazebo::EntityComponentManagerPrivate
 
   /// \brief Set of entities that are prevented from removal.
   public: std::unordered_set<Entity> pinnedEntities;
+
+  /// \brief Demands for components, see DemandComponent.
+  public: std::shared_ptr<ComponentDemandRegistry> demandRegistry{
+      std::make_shared<ComponentDemandRegistry>()};
 };
 
 //////////////////////////////////////////////////
@@ -290,7 +920,7 @@ EntityComponentManager::~EntityComponentManager() = default;
 //////////////////////////////////////////////////
 size_t EntityComponentManager::EntityCount() const
 {
-  return this->dataPtr->entities.Vertices().size();
+  return this->dataPtr->hierarchy.Size();
 }
 
 /////////////////////////////////////////////////
@@ -308,11 +938,34 @@ Entity EntityComponentManager::CreateEntity()
   return this->dataPtr->CreateEntityImplementation(entity);
 }
 
+/////////////////////////////////////////////////
+std::vector<Entity> EntityComponentManager::CreateEntities(std::size_t _count)
+{
+  IGN_PROFILE("EntityComponentManager::CreateEntities");
+
+  const auto available = std::numeric_limits<uint64_t>::max() - 1u -
+      this->dataPtr->entityCount;
+  if (_count > available)
+  {
+    ignwarn << "Reached maximum number of entities, creating [" << available
+            << "] out of [" << _count << "] entities." << std::endl;
+    _count = available;
+  }
+
+  std::vector<Entity> entities(_count);
+  for (auto &entity : entities)
+    entity = ++this->dataPtr->entityCount;
+
+  this->dataPtr->CreateEntitiesImplementation(entities);
+  return entities;
+}
+
 /////////////////////////////////////////////////
 Entity EntityComponentManagerPrivate::CreateEntityImplementation(Entity _entity)
 {
   IGN_PROFILE("EntityComponentManager::CreateEntityImplementation");
-  this->entities.AddVertex(std::to_string(_entity), _entity, _entity);
+  this->hierarchy.Add(_entity);
+  this->entitiesDirty = true;
 
   // Add entity to the list of newly created entities
   {
@@ -320,11 +973,8 @@ Entity EntityComponentManagerPrivate::CreateEntityImplementation(Entity _entity)
     this->newlyCreatedEntities.insert(_entity);
   }
 
-  // Reset descendants cache
-  this->descendantCache.clear();
-
   const auto result = this->componentStorage.insert({_entity,
-      std::vector<std::unique_ptr<components::BaseComponent>>()});
+      std::vector<ComponentPtr>()});
   if (!result.second)
   {
     ignwarn << "Attempted to add entity [" << _entity
@@ -341,9 +991,44 @@ Entity EntityComponentManagerPrivate::CreateEntityImplementation(Entity _entity)
       << "type index.\n";
   }
 
+  this->entitySignatures.emplace(_entity, ComponentSignature());
+
   return _entity;
 }
 
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::CreateEntitiesImplementation(
+    const std::vector<Entity> &_entities)
+{
+  IGN_PROFILE("EntityComponentManager::CreateEntitiesImplementation");
+  if (_entities.empty())
+    return;
+
+  this->componentStorage.reserve(
+      this->componentStorage.size() + _entities.size());
+  this->componentTypeIndex.reserve(
+      this->componentTypeIndex.size() + _entities.size());
+  this->entitySignatures.reserve(
+      this->entitySignatures.size() + _entities.size());
+
+  {
+    std::lock_guard<std::mutex> lock(this->entityCreatedMutex);
+    this->newlyCreatedEntities.reserve(
+        this->newlyCreatedEntities.size() + _entities.size());
+    this->newlyCreatedEntities.insert(_entities.begin(), _entities.end());
+  }
+
+  for (const Entity entity : _entities)
+  {
+    this->hierarchy.Add(entity);
+    this->componentStorage.emplace(entity, std::vector<ComponentPtr>());
+    this->componentTypeIndex.emplace(entity,
+        std::unordered_map<ComponentTypeId, std::size_t>());
+    this->entitySignatures.emplace(entity, ComponentSignature());
+  }
+  this->entitiesDirty = true;
+}
+
 /////////////////////////////////////////////////
 Entity EntityComponentManager::Clone(Entity _entity, Entity _parent,
     const std::string &_name, bool _allowRename)
@@ -604,127 +1289,391 @@ Entity EntityComponentManager::CloneImpl(Entity _entity, Entity _parent,
 }
 
 /////////////////////////////////////////////////
-void EntityComponentManager::ClearNewlyCreatedEntities()
-{
-  std::lock_guard<std::mutex> lock(this->dataPtr->entityCreatedMutex);
-  this->dataPtr->newlyCreatedEntities.clear();
-
-  for (auto &view : this->dataPtr->views)
-  {
-    view.second.first->ResetNewEntityState();
-  }
-}
-
-/////////////////////////////////////////////////
-bool EntityComponentManager::HasRemovedComponents() const
+std::vector<Entity> EntityComponentManager::CloneMany(Entity _entity,
+    Entity _parent, const std::string &_name, std::size_t _count)
 {
-  std::lock_guard<std::mutex> lock(this->dataPtr->removedComponentsMutex);
-  return !this->dataPtr->removedComponents.empty();
-}
+  IGN_PROFILE("EntityComponentManager::CloneMany");
 
-/////////////////////////////////////////////////
-void EntityComponentManager::ClearRemovedComponents()
-{
-  std::lock_guard<std::mutex> lock(this->dataPtr->removedComponentsMutex);
-  this->dataPtr->removedComponents.clear();
-}
+  std::vector<Entity> roots;
+  if (_count == 0u)
+    return roots;
 
-/////////////////////////////////////////////////
-void EntityComponentManagerPrivate::InsertEntityRecursive(Entity _entity,
-    std::unordered_set<Entity> &_set)
-{
-  for (const auto &vertex : this->entities.AdjacentsFrom(_entity))
+  if (!this->HasEntity(_entity))
   {
-    this->InsertEntityRecursive(vertex.first, _set);
+    ignerr << "Requested to clone entity [" << _entity
+      << "], but this entity does not exist." << std::endl;
+    return roots;
   }
-  _set.insert(_entity);
-}
 
-/////////////////////////////////////////////////
-void EntityComponentManagerPrivate::EraseEntityRecursive(Entity _entity,
-    std::unordered_set<Entity> &_set)
-{
-  for (const auto &vertex : this->entities.AdjacentsFrom(_entity))
+  // The subtree, breadth first so parents come before their children.
+  // Like Clone, children are found through their ParentEntity component.
+  std::vector<Entity> originals{_entity};
+  for (std::size_t i = 0; i < originals.size(); ++i)
   {
-    this->EraseEntityRecursive(vertex.first, _set);
+    for (const Entity child :
+        this->EntitiesByComponents(components::ParentEntity(originals[i])))
+    {
+      originals.push_back(child);
+    }
   }
-  _set.erase(_entity);
-}
+  const std::size_t subtreeSize = originals.size();
 
-/////////////////////////////////////////////////
-void EntityComponentManager::RequestRemoveEntity(Entity _entity,
-    bool _recursive)
-{
-  // Store the to-be-removed entities in a temporary set so we can call
-  // UpdateViews on each of them
-  std::unordered_set<Entity> tmpToRemoveEntities;
-  if (!_recursive)
-  {
-    tmpToRemoveEntities.insert(_entity);
-  }
-  else
+  std::unordered_map<Entity, std::size_t> originalIndex;
+  originalIndex.reserve(subtreeSize);
+  for (std::size_t i = 0; i < subtreeSize; ++i)
+    originalIndex[originals[i]] = i;
+
+  // Find the lowest free suffixes with a single scan of existing names
+  std::string baseName = _name;
+  if (baseName.empty())
   {
-    this->dataPtr->InsertEntityRecursive(_entity, tmpToRemoveEntities);
+    auto nameComp = this->Component<components::Name>(_entity);
+    baseName = nameComp ? nameComp->Data() : "cloned_entity";
   }
-
-  // Remove entities from tmpToRemoveEntities that are marked as
-  // unremovable.
-  for (auto iter = tmpToRemoveEntities.begin();
-       iter != tmpToRemoveEntities.end();)
+  const std::string prefix = baseName + "_";
+  std::unordered_set<uint64_t> usedSuffixes;
+  this->dataPtr->hierarchy.Each([&](Entity _existing)
   {
-    if (std::find(this->dataPtr->pinnedEntities.begin(),
-                  this->dataPtr->pinnedEntities.end(), *iter) !=
-               this->dataPtr->pinnedEntities.end())
+    auto nameComp = this->Component<components::Name>(_existing);
+    if (!nameComp || nameComp->Data().size() <= prefix.size() ||
+        nameComp->Data().size() - prefix.size() > 19u ||
+        nameComp->Data().compare(0, prefix.size(), prefix) != 0)
     {
-      iter = tmpToRemoveEntities.erase(iter);
+      return true;
     }
-    else
+    const std::string digits = nameComp->Data().substr(prefix.size());
+    if (std::all_of(digits.begin(), digits.end(),
+        [](char _c) { return _c >= '0' && _c <= '9'; }))
     {
-      ++iter;
+      usedSuffixes.insert(std::stoull(digits));
     }
-  }
+    return true;
+  });
 
+  std::vector<components::Name> rootNames;
+  rootNames.reserve(_count);
+  for (uint64_t suffix = 1u; rootNames.size() < _count; ++suffix)
   {
-    std::lock_guard<std::mutex> lock(this->dataPtr->entityRemoveMutex);
-    this->dataPtr->toRemoveEntities.insert(tmpToRemoveEntities.begin(),
-                                          tmpToRemoveEntities.end());
+    if (usedSuffixes.find(suffix) == usedSuffixes.end())
+      rootNames.emplace_back(prefix + std::to_string(suffix));
   }
 
-  for (const auto &removedEntity : tmpToRemoveEntities)
+  // Copy c of original i is clones[c * subtreeSize + i]
+  auto clones = this->CreateEntities(_count * subtreeSize);
+  if (clones.size() != _count * subtreeSize)
   {
-    for (auto &view : this->dataPtr->views)
-    {
-      view.second.first->MarkEntityToRemove(removedEntity);
-    }
+    ignerr << "Failed to create entities to clone entity [" << _entity
+           << "] [" << _count << "] times." << std::endl;
+    for (const Entity clone : clones)
+      this->RequestRemoveEntity(clone, false);
+    return roots;
   }
-}
 
-/////////////////////////////////////////////////
-void EntityComponentManager::RequestRemoveEntities()
-{
-  if (this->dataPtr->pinnedEntities.empty())
+  roots.reserve(_count);
+  for (std::size_t c = 0; c < _count; ++c)
+    roots.push_back(clones[c * subtreeSize]);
+
+  // Parents and names
+  std::vector<Entity> parented;
+  std::vector<components::ParentEntity> parents;
+  parented.reserve(clones.size());
+  parents.reserve(clones.size());
+  std::vector<components::Name> names;
+  names.reserve(clones.size());
+  for (std::size_t c = 0; c < _count; ++c)
   {
+    for (std::size_t i = 0; i < subtreeSize; ++i)
     {
-      std::lock_guard<std::mutex> lock(this->dataPtr->entityRemoveMutex);
-      this->dataPtr->removeAllEntities = true;
-    }
-    this->RebuildViews();
-  }
-  else
-  {
+      const Entity clone = clones[c * subtreeSize + i];
+      Entity parent = _parent;
+      if (i != 0u)
+      {
+        parent = clones[c * subtreeSize + originalIndex[
+            this->Component<components::ParentEntity>(originals[i])->Data()]];
+      }
+      if (parent != kNullEntity)
+      {
+        this->SetParentEntity(clone, parent);
+        parented.push_back(clone);
+        parents.emplace_back(parent);
+      }
+
+      if (i == 0u)
+      {
+        names.push_back(rootNames[c]);
+      }
+      else
+      {
+        auto nameComp = this->Component<components::Name>(originals[i]);
+        names.emplace_back(nameComp ? nameComp->Data() : std::string());
+      }
+    }
+  }
+  this->CreateComponents(parented, parents);
+  this->CreateComponents(clones, names);
+
+  // All other components, one batch per type. Components are copied from
+  // the originals' instances.
+  std::unordered_map<ComponentTypeId,
+      std::pair<std::vector<Entity>,
+                std::vector<const components::BaseComponent *>>> batches;
+  for (std::size_t i = 0; i < subtreeSize; ++i)
+  {
+    this->EachComponentType(originals[i], [&](ComponentTypeId _type)
+    {
+      if (_type == components::Name::typeId ||
+          _type == components::ParentEntity::typeId)
+      {
+        return true;
+      }
+
+      const auto *originalComp =
+          this->ComponentImplementation(originals[i], _type);
+      auto &batch = batches[_type];
+      for (std::size_t c = 0; c < _count; ++c)
+      {
+        batch.first.push_back(clones[c * subtreeSize + i]);
+        batch.second.push_back(originalComp);
+      }
+      return true;
+    });
+  }
+
+  std::vector<std::size_t> update;
+  for (const auto &[type, batch] : batches)
+  {
+    update.clear();
+    this->CreateComponentsImplementation(batch.first, type, batch.second,
+        update);
+    if (!update.empty())
+    {
+      // Cloned entities are new, so none of their components exist yet
+      // LCOV_EXCL_START
+      ignerr << "Internal error: The component's data needs to be updated but "
+             << "this should not happen." << std::endl;
+      // LCOV_EXCL_STOP
+    }
+  }
+
+  // Cloned models get the copies of their canonical links
+  for (std::size_t i = 0; i < subtreeSize; ++i)
+  {
+    auto canonicalComp =
+        this->Component<components::ModelCanonicalLink>(originals[i]);
+    if (!canonicalComp)
+      continue;
+
+    auto iter = originalIndex.find(canonicalComp->Data());
+    if (iter == originalIndex.end())
+    {
+      ignerr << "Error: attempted to clone model [" << originals[i]
+        << "] with canonical link [" << canonicalComp->Data()
+        << "], but the link is not part of the cloned entities." << std::endl;
+      continue;
+    }
+    for (std::size_t c = 0; c < _count; ++c)
+    {
+      this->SetComponentData<components::ModelCanonicalLink>(
+          clones[c * subtreeSize + i], clones[c * subtreeSize + iter->second]);
+    }
+  }
+
+  return roots;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::ClearNewlyCreatedEntities()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->entityCreatedMutex);
+  this->dataPtr->newlyCreatedEntities.clear();
+
+  for (auto &view : this->dataPtr->views)
+  {
+    view.second.first->ResetNewEntityState();
+  }
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::HasRemovedComponents() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->removedComponentsMutex);
+  return !this->dataPtr->removedComponents.empty();
+}
+
+/////////////////////////////////////////////////
+std::vector<EntityComponentManager::ComponentTypeMemory>
+    EntityComponentManager::ComponentMemory() const
+{
+  std::vector<ComponentTypeMemory> memory;
+  memory.reserve(this->dataPtr->componentPools.size());
+
+  // Pooled types are accounted by their pool
+  std::unordered_map<ComponentTypeId, std::size_t> heapTypes;
+  for (const auto &[typeId, typePool] : this->dataPtr->componentPools)
+  {
+    const auto &pool = typePool.pool;
+    ComponentTypeMemory typeMemory;
+    typeMemory.typeId = typeId;
+    if (nullptr != pool)
+    {
+      typeMemory.count = pool->Count();
+      typeMemory.bytes = pool->Count() * pool->Stride();
+      typeMemory.reservedBytes = pool->Capacity() * pool->Stride();
+    }
+    else
+    {
+      heapTypes[typeId] = memory.size();
+    }
+    memory.push_back(typeMemory);
+  }
+
+  // Heap allocated components have to be counted one by one
+  if (!heapTypes.empty())
+  {
+    for (const auto &[entity, comps] : this->dataPtr->componentStorage)
+    {
+      for (const auto &comp : comps)
+      {
+        if (nullptr != comp.get_deleter().pool)
+          continue;
+        auto it = heapTypes.find(comp->TypeId());
+        if (it != heapTypes.end())
+          ++memory[it->second].count;
+      }
+    }
+  }
+
+  return memory;
+}
+
+/////////////////////////////////////////////////
+std::size_t EntityComponentManager::ViewsMemory() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->viewsMutex);
+  std::size_t bytes{0u};
+  // All views are created by FindView as detail::View
+  for (const auto &view : this->dataPtr->views)
+  {
+    bytes += static_cast<const detail::View *>(
+        view.second.first.get())->MemoryUsage();
+  }
+  return bytes;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::ClearRemovedComponents()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->removedComponentsMutex);
+  this->dataPtr->removedComponents.clear();
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::InsertEntityRecursive(Entity _entity,
+    std::unordered_set<Entity> &_set)
+{
+  this->hierarchy.Descendants(_entity, this->descendantsBuffer);
+  _set.insert(this->descendantsBuffer.begin(), this->descendantsBuffer.end());
+  _set.insert(_entity);
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::EraseEntityRecursive(Entity _entity,
+    std::unordered_set<Entity> &_set)
+{
+  this->hierarchy.Descendants(_entity, this->descendantsBuffer);
+  for (const Entity entity : this->descendantsBuffer)
+    _set.erase(entity);
+  _set.erase(_entity);
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::RequestRemoveEntity(Entity _entity,
+    bool _recursive)
+{
+  // Store the to-be-removed entities in a temporary set so we can call
+  // UpdateViews on each of them
+  std::unordered_set<Entity> tmpToRemoveEntities;
+  if (!_recursive)
+  {
+    tmpToRemoveEntities.insert(_entity);
+  }
+  else
+  {
+    this->dataPtr->InsertEntityRecursive(_entity, tmpToRemoveEntities);
+  }
+
+  // Remove entities from tmpToRemoveEntities that are marked as
+  // unremovable.
+  for (auto iter = tmpToRemoveEntities.begin();
+       iter != tmpToRemoveEntities.end();)
+  {
+    if (std::find(this->dataPtr->pinnedEntities.begin(),
+                  this->dataPtr->pinnedEntities.end(), *iter) !=
+               this->dataPtr->pinnedEntities.end())
+    {
+      iter = tmpToRemoveEntities.erase(iter);
+    }
+    else
+    {
+      ++iter;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->entityRemoveMutex);
+    this->dataPtr->toRemoveEntities.insert(tmpToRemoveEntities.begin(),
+                                          tmpToRemoveEntities.end());
+  }
+
+  for (const auto &removedEntity : tmpToRemoveEntities)
+  {
+    for (auto &view : this->dataPtr->views)
+    {
+      view.second.first->MarkEntityToRemove(removedEntity);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::RequestRemoveEntities()
+{
+  if (this->dataPtr->pinnedEntities.empty())
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->entityRemoveMutex);
+      this->dataPtr->removeAllEntities = true;
+    }
+
+    // Views already hold every entity matching them, so there's no need
+    // to rebuild them, only to mark their entities for removal
+    for (auto &viewPair : this->dataPtr->views)
+    {
+      auto &view = viewPair.second.first;
+      view->DenseEntities().forEach([&](const Entity _entity)
+      {
+        view->MarkEntityToRemove(_entity);
+        return true;
+      });
+      for (const auto &toAdd : view->ToAddEntities())
+        view->MarkEntityToRemove(toAdd.first);
+    }
+  }
+  else
+  {
     std::unordered_set<Entity> tmpToRemoveEntities;
 
     // Store the to-be-removed entities in a temporary set so we can
     // mark each of them to be removed from views that contain them.
-    for (const auto &vertex : this->dataPtr->entities.Vertices())
+    this->dataPtr->hierarchy.Each([&](Entity _entity)
     {
       if (std::find(this->dataPtr->pinnedEntities.begin(),
-                    this->dataPtr->pinnedEntities.end(), vertex.first) ==
+                    this->dataPtr->pinnedEntities.end(), _entity) ==
           this->dataPtr->pinnedEntities.end())
       {
-        tmpToRemoveEntities.insert(vertex.first);
+        tmpToRemoveEntities.insert(_entity);
       }
-    }
+      return true;
+    });
 
     {
       std::lock_guard<std::mutex> lock(this->dataPtr->entityRemoveMutex);
@@ -747,22 +1696,79 @@ void EntityComponentManager::ProcessRemoveEntityRequests()
 {
   IGN_PROFILE("EntityComponentManager::ProcessRemoveEntityRequests");
   std::lock_guard<std::mutex> lock(this->dataPtr->entityRemoveMutex);
+
+  // Observers are told about the components of removed entities, which
+  // must be found while the entities and their ancestors still exist
+  for (const auto &typeObservers : this->dataPtr->typeObservers)
+  {
+    const ComponentTypeId typeId = typeObservers.first;
+    if (this->dataPtr->removeAllEntities)
+    {
+      auto typeIter = this->dataPtr->typeEntities.find(typeId);
+      if (typeIter == this->dataPtr->typeEntities.end())
+        continue;
+      for (const Entity entity : typeIter->second)
+      {
+        this->dataPtr->RecordObservedChange(entity, typeId,
+            EntityComponentManagerPrivate::ObservedChange::REMOVED);
+      }
+      continue;
+    }
+
+    for (const Entity entity : this->dataPtr->toRemoveEntities)
+    {
+      if (this->EntityHasComponentType(entity, typeId))
+      {
+        this->dataPtr->RecordObservedChange(entity, typeId,
+            EntityComponentManagerPrivate::ObservedChange::REMOVED);
+      }
+    }
+  }
+
   // Short-cut if erasing all entities
   if (this->dataPtr->removeAllEntities)
   {
     IGN_PROFILE("RemoveAll");
     this->dataPtr->removeAllEntities = false;
-    this->dataPtr->entities = EntityGraph();
+    this->dataPtr->hierarchy.Clear();
+    this->dataPtr->entitiesDirty = true;
     this->dataPtr->toRemoveEntities.clear();
     this->dataPtr->componentsMarkedAsRemoved.clear();
 
     // reset the entity component storage
     this->dataPtr->componentStorage.clear();
     this->dataPtr->componentTypeIndex.clear();
+    this->dataPtr->entitySignatures.clear();
+    this->dataPtr->typeEntities.clear();
+    this->dataPtr->componentVersions.clear();
     this->dataPtr->componentTypeIndexDirty = true;
 
+    {
+      std::lock_guard<std::mutex> lockIndex(this->dataPtr->childIndexMutex);
+      this->dataPtr->childIndex.clear();
+      this->dataPtr->childIndexKeys.clear();
+      this->dataPtr->childIndexPending.clear();
+    }
+    {
+      std::lock_guard<std::mutex> lockPoses(this->dataPtr->worldPoseMutex);
+      this->dataPtr->worldPoseCache.clear();
+      ++this->dataPtr->worldPoseEpoch;
+    }
+
     // All views are now invalid.
     this->dataPtr->views.clear();
+    {
+      std::lock_guard<std::mutex> lockStatic(this->dataPtr->staticMutex);
+      this->dataPtr->dynamicEntities.clear();
+      this->dataPtr->staticDirty = true;
+    }
+    this->dataPtr->viewSignatures.clear();
+    {
+      auto &registry = *this->dataPtr->demandRegistry;
+      std::lock_guard<std::mutex> lockDemands(registry.mutex);
+      registry.demands.clear();
+      registry.released.clear();
+    }
   }
   else
   {
@@ -774,13 +1780,38 @@ void EntityComponentManager::ProcessRemoveEntityRequests()
       if (!this->HasEntity(entity))
         continue;
 
-      // Remove from graph
-      this->dataPtr->entities.RemoveVertex(entity);
+      // Remove from hierarchy
+      this->dataPtr->hierarchy.Remove(entity);
+      this->dataPtr->entitiesDirty = true;
 
       this->dataPtr->componentsMarkedAsRemoved.erase(entity);
       this->dataPtr->componentStorage.erase(entity);
-      this->dataPtr->componentTypeIndex.erase(entity);
+      {
+        // Demands for removed entities can't be satisfied anymore
+        auto &registry = *this->dataPtr->demandRegistry;
+        std::lock_guard<std::mutex> lockDemands(registry.mutex);
+        registry.demands.erase(entity);
+      }
+      auto typeMapIter = this->dataPtr->componentTypeIndex.find(entity);
+      if (typeMapIter != this->dataPtr->componentTypeIndex.end())
+      {
+        for (const auto &typeIndex : typeMapIter->second)
+        {
+          auto typeIter = this->dataPtr->typeEntities.find(typeIndex.first);
+          if (typeIter != this->dataPtr->typeEntities.end())
+            typeIter->second.erase(entity);
+        }
+        this->dataPtr->componentTypeIndex.erase(typeMapIter);
+      }
+      this->dataPtr->entitySignatures.erase(entity);
+      this->dataPtr->componentVersions.erase(entity);
       this->dataPtr->componentTypeIndexDirty = true;
+      this->dataPtr->InvalidateIndices(entity,
+          components::ParentEntity::typeId);
+      {
+        std::lock_guard<std::mutex> lockPoses(this->dataPtr->worldPoseMutex);
+        this->dataPtr->worldPoseCache.erase(entity);
+      }
 
       // Remove the entity from views.
       for (auto &view : this->dataPtr->views)
@@ -791,9 +1822,6 @@ void EntityComponentManager::ProcessRemoveEntityRequests()
     // Clear the set of entities to remove.
     this->dataPtr->toRemoveEntities.clear();
   }
-
-  // Reset descendants cache
-  this->dataPtr->descendantCache.clear();
 }
 
 /////////////////////////////////////////////////
@@ -821,10 +1849,15 @@ bool EntityComponentManager::RemoveComponent(
       this->dataPtr->periodicChangedComponents.erase(periodicIter);
   }
 
+  this->dataPtr->BumpComponentVersion(_entity, _typeId);
+  this->dataPtr->RecordObservedChange(_entity, _typeId,
+      EntityComponentManagerPrivate::ObservedChange::REMOVED);
+
   auto compPtr = this->ComponentImplementation(_entity, _typeId);
   if (compPtr)
   {
     this->dataPtr->componentsMarkedAsRemoved[_entity].insert(_typeId);
+    this->dataPtr->UpdateSignature(_entity, _typeId, false);
 
     // update views to reflect the component removal
     for (auto &viewPair : this->dataPtr->views)
@@ -963,45 +1996,78 @@ std::unordered_set<ComponentTypeId>
   return periodicComponents;
 }
 
+/////////////////////////////////////////////////
+std::vector<Entity> EntityComponentManager::ChangedEntities(
+    const ComponentTypeId _typeId) const
+{
+  std::vector<Entity> entities;
+
+  // An entity is never in both sets, see SetChanged
+  auto oneTimeIter = this->dataPtr->oneTimeChangedComponents.find(_typeId);
+  if (oneTimeIter != this->dataPtr->oneTimeChangedComponents.end())
+  {
+    entities.insert(entities.end(), oneTimeIter->second.begin(),
+        oneTimeIter->second.end());
+  }
+
+  auto periodicIter = this->dataPtr->periodicChangedComponents.find(_typeId);
+  if (periodicIter != this->dataPtr->periodicChangedComponents.end())
+  {
+    entities.insert(entities.end(), periodicIter->second.begin(),
+        periodicIter->second.end());
+  }
+
+  return entities;
+}
+
 /////////////////////////////////////////////////
 bool EntityComponentManager::HasEntity(const Entity _entity) const
 {
-  auto vertex = this->dataPtr->entities.VertexFromId(_entity);
-  return vertex.Id() != math::graph::kNullId;
+  return this->dataPtr->hierarchy.Has(_entity);
 }
 
 /////////////////////////////////////////////////
-Entity EntityComponentManager::ParentEntity(const Entity _entity) const
+void EntityComponentManager::SetBinarySerialization(bool _binary)
 {
-  auto parents = this->Entities().AdjacentsTo(_entity);
-  if (parents.empty())
-    return kNullEntity;
+  this->dataPtr->binarySerialization = _binary;
+}
 
-  // TODO(louise) Do we want to support multiple parents?
-  return parents.begin()->first;
+/////////////////////////////////////////////////
+bool EntityComponentManager::BinarySerialization() const
+{
+  return this->dataPtr->binarySerialization;
 }
 
 /////////////////////////////////////////////////
-bool EntityComponentManager::SetParentEntity(const Entity _child,
-    const Entity _parent)
+EntityHandle EntityComponentManager::Handle(const Entity _entity) const
 {
-  // Remove current parent(s)
-  auto parents = this->Entities().AdjacentsTo(_child);
-  for (const auto &parent : parents)
-  {
-    auto edge = this->dataPtr->entities.EdgeFromVertices(parent.first, _child);
-    this->dataPtr->entities.RemoveEdge(edge);
-  }
+  const uint64_t generation = this->dataPtr->hierarchy.Generation(_entity);
+  if (generation == 0u)
+    return EntityHandle();
+  return EntityHandle{_entity, generation};
+}
 
-  // Leave parent-less
-  if (_parent == kNullEntity)
-  {
-    return true;
-  }
+/////////////////////////////////////////////////
+bool EntityComponentManager::HasEntity(const EntityHandle &_handle) const
+{
+  return _handle.generation != 0u &&
+      this->dataPtr->hierarchy.Generation(_handle.entity) ==
+      _handle.generation;
+}
+
+/////////////////////////////////////////////////
+Entity EntityComponentManager::ParentEntity(const Entity _entity) const
+{
+  return this->dataPtr->hierarchy.Parent(_entity);
+}
 
-  // Add edge
-  auto edge = this->dataPtr->entities.AddEdge({_parent, _child}, true);
-  return (math::graph::kNullId != edge.Id());
+/////////////////////////////////////////////////
+bool EntityComponentManager::SetParentEntity(const Entity _child,
+    const Entity _parent)
+{
+  this->dataPtr->entitiesDirty = true;
+  this->dataPtr->staticDirty = true;
+  return this->dataPtr->hierarchy.SetParent(_child, _parent);
 }
 
 /////////////////////////////////////////////////
@@ -1035,6 +2101,7 @@ bool EntityComponentManager::CreateComponentImplementation(
 
   this->dataPtr->AddModifiedComponent(_entity);
   this->dataPtr->oneTimeChangedComponents[_componentTypeId].insert(_entity);
+  this->dataPtr->BumpComponentVersion(_entity, _componentTypeId);
 
   // make sure the entity exists
   auto typeMapIter = this->dataPtr->componentTypeIndex.find(_entity);
@@ -1056,7 +2123,8 @@ bool EntityComponentManager::CreateComponentImplementation(
   }
 
   // Instantiate the new component.
-  auto newComp = components::Factory::Instance()->New(_componentTypeId, _data);
+  auto newComp = this->dataPtr->NewComponent(_entity, _componentTypeId,
+      _data);
 
   const auto compIdxIter = typeMapIter->second.find(_componentTypeId);
   // If entity has never had a component of this type
@@ -1066,13 +2134,19 @@ bool EntityComponentManager::CreateComponentImplementation(
     entityCompIter->second.push_back(std::move(newComp));
     this->dataPtr->componentTypeIndex[_entity][_componentTypeId] = vectorIdx;
     this->dataPtr->componentTypeIndexDirty = true;
+    this->dataPtr->UpdateSignature(_entity, _componentTypeId, true);
+    this->dataPtr->RecordObservedChange(_entity, _componentTypeId,
+        EntityComponentManagerPrivate::ObservedChange::ADDED);
 
     updateData = false;
     for (auto &viewPair : this->dataPtr->views)
     {
       auto &view = viewPair.second.first;
-      if (this->EntityMatches(_entity, view->ComponentTypes()))
+      if (this->dataPtr->EntityMatchesSignature(_entity,
+          this->dataPtr->ViewSignature(view.get())))
+      {
         view->MarkEntityToAdd(_entity, this->IsNewEntity(_entity));
+      }
     }
   }
   else
@@ -1098,6 +2172,9 @@ bool EntityComponentManager::CreateComponentImplementation(
     else if (this->dataPtr->ComponentMarkedAsRemoved(_entity, _componentTypeId))
     {
       this->dataPtr->componentsMarkedAsRemoved[_entity].erase(_componentTypeId);
+      this->dataPtr->UpdateSignature(_entity, _componentTypeId, true);
+      this->dataPtr->RecordObservedChange(_entity, _componentTypeId,
+          EntityComponentManagerPrivate::ObservedChange::ADDED);
 
       for (auto &viewPair : this->dataPtr->views)
       {
@@ -1105,8 +2182,13 @@ bool EntityComponentManager::CreateComponentImplementation(
             this->IsNewEntity(_entity), _componentTypeId);
       }
     }
-  }
-
+    else
+    {
+      this->dataPtr->RecordObservedChange(_entity, _componentTypeId,
+          EntityComponentManagerPrivate::ObservedChange::CHANGED);
+    }
+  }
+
   this->dataPtr->createdCompTypes.insert(_componentTypeId);
 
   // If the component is a components::ParentEntity, then make sure to
@@ -1120,32 +2202,192 @@ bool EntityComponentManager::CreateComponentImplementation(
   return updateData;
 }
 
+/////////////////////////////////////////////////
+bool EntityComponentManager::CreateComponentsImplementation(
+    const std::vector<Entity> &_entities,
+    const ComponentTypeId _componentTypeId,
+    const std::vector<const components::BaseComponent *> &_data,
+    std::vector<std::size_t> &_update)
+{
+  IGN_PROFILE("EntityComponentManager::CreateComponentsImplementation");
+
+  if (_entities.empty())
+    return true;
+
+  if (!this->HasComponentType(_componentTypeId) &&
+      !components::Factory::Instance()->HasType(_componentTypeId))
+  {
+    ignerr << "Failed to create components of type [" << _componentTypeId
+           << "] for [" << _entities.size()
+           << "] entities. Type has not been properly registered."
+           << std::endl;
+    return false;
+  }
+
+  bool result{true};
+
+  // Entities which got a component of this type for the first time, and
+  // may have to be added to views
+  std::vector<Entity> added;
+  added.reserve(_entities.size());
+
+  auto &changed = this->dataPtr->oneTimeChangedComponents[_componentTypeId];
+  changed.reserve(changed.size() + _entities.size());
+
+  for (std::size_t i = 0; i < _entities.size(); ++i)
+  {
+    const Entity entity = _entities[i];
+
+    auto typeMapIter = this->dataPtr->componentTypeIndex.find(entity);
+    auto entityCompIter = this->dataPtr->componentStorage.find(entity);
+    if (typeMapIter == this->dataPtr->componentTypeIndex.end() ||
+        entityCompIter == this->dataPtr->componentStorage.end())
+    {
+      ignerr << "Trying to create a component of type [" << _componentTypeId
+        << "] attached to entity [" << entity << "], but this entity does "
+        << "not exist. This create component request will be ignored."
+        << std::endl;
+      result = false;
+      continue;
+    }
+
+    this->dataPtr->AddModifiedComponent(entity);
+    changed.insert(entity);
+    this->dataPtr->BumpComponentVersion(entity, _componentTypeId);
+
+    const auto compIdxIter = typeMapIter->second.find(_componentTypeId);
+    if (compIdxIter == typeMapIter->second.end())
+    {
+      typeMapIter->second[_componentTypeId] = entityCompIter->second.size();
+      entityCompIter->second.push_back(
+          this->dataPtr->NewComponent(entity, _componentTypeId, _data[i]));
+      this->dataPtr->UpdateSignature(entity, _componentTypeId, true);
+      this->dataPtr->RecordObservedChange(entity, _componentTypeId,
+          EntityComponentManagerPrivate::ObservedChange::ADDED);
+      added.push_back(entity);
+      continue;
+    }
+
+    // Existing components get their data set by the caller, see
+    // CreateComponentImplementation
+    _update.push_back(i);
+    if (!entityCompIter->second.at(compIdxIter->second))
+    {
+      ignerr << "Internal error: entity [" << entity << "] has a component of "
+        << "type [" << _componentTypeId << "] in the storage, but the instance "
+        << "of this component is nullptr. This should never happen!"
+        << std::endl;
+      result = false;
+    }
+    else if (this->dataPtr->ComponentMarkedAsRemoved(entity, _componentTypeId))
+    {
+      this->dataPtr->componentsMarkedAsRemoved[entity].erase(
+          _componentTypeId);
+      this->dataPtr->UpdateSignature(entity, _componentTypeId, true);
+      this->dataPtr->RecordObservedChange(entity, _componentTypeId,
+          EntityComponentManagerPrivate::ObservedChange::ADDED);
+      for (auto &viewPair : this->dataPtr->views)
+      {
+        viewPair.second.first->NotifyComponentAddition(entity,
+            this->IsNewEntity(entity), _componentTypeId);
+      }
+    }
+    else
+    {
+      this->dataPtr->RecordObservedChange(entity, _componentTypeId,
+          EntityComponentManagerPrivate::ObservedChange::CHANGED);
+    }
+  }
+
+  this->dataPtr->createdCompTypes.insert(_componentTypeId);
+
+  if (!added.empty())
+  {
+    this->dataPtr->componentTypeIndexDirty = true;
+
+    // Only views which require this type can start matching the new
+    // entities, all others already matched them or still don't
+    for (auto &viewPair : this->dataPtr->views)
+    {
+      auto &view = viewPair.second.first;
+      const auto &types = view->ComponentTypes();
+      if (types.find(_componentTypeId) == types.end())
+        continue;
+
+      const auto &signature = this->dataPtr->ViewSignature(view.get());
+      for (const Entity entity : added)
+      {
+        if (this->dataPtr->EntityMatchesSignature(entity, signature))
+          view->MarkEntityToAdd(entity, this->IsNewEntity(entity));
+      }
+    }
+  }
+
+  // Keep the entity graph in sync, as in CreateComponentImplementation
+  if (_componentTypeId == components::ParentEntity::typeId)
+  {
+    for (const Entity entity : _entities)
+    {
+      auto parentComp = this->Component<components::ParentEntity>(entity);
+      if (parentComp)
+        this->SetParentEntity(entity, parentComp->Data());
+    }
+  }
+
+  return result;
+}
+
 /////////////////////////////////////////////////
 bool EntityComponentManager::EntityMatches(Entity _entity,
     const std::set<ComponentTypeId> &_types) const
 {
-  auto iter = this->dataPtr->componentTypeIndex.find(_entity);
-  if (iter == this->dataPtr->componentTypeIndex.end())
+  ComponentSignature signature;
+  if (!this->dataPtr->TypesSignature(_types, signature))
     return false;
 
-  // quick check: the entity cannot match _types if _types is larger than the
-  // number of component types the entity has
-  if (_types.size() > iter->second.size())
-    return false;
+  return this->dataPtr->EntityMatchesSignature(_entity, signature);
+}
+
+/////////////////////////////////////////////////
+std::vector<Entity> EntityComponentManager::EntitiesWithComponentTypes(
+    const std::set<ComponentTypeId> &_types) const
+{
+  IGN_PROFILE("EntityComponentManager::EntitiesWithComponentTypes");
 
-  // \todo(nkoenig) The performance of this could be improved.
-  // It might be possible to create bitmask for component sets.
-  // Fixing this might not be high priority, unless we expect frequent
-  // creation of entities and/or queries.
-  for (const ComponentTypeId &type : _types)
+  std::vector<Entity> result;
+  if (_types.empty())
   {
-    auto typeIter = iter->second.find(type);
-    if (typeIter == iter->second.end() ||
-        this->dataPtr->ComponentMarkedAsRemoved(_entity, type))
-      return false;
+    this->EachEntity([&](Entity _entity)
+    {
+      result.push_back(_entity);
+      return true;
+    });
+    return result;
   }
 
-  return true;
+  // Only entities having the rarest type can match
+  const std::unordered_set<Entity> *candidates{nullptr};
+  for (const ComponentTypeId type : _types)
+  {
+    auto iter = this->dataPtr->typeEntities.find(type);
+    if (iter == this->dataPtr->typeEntities.end() || iter->second.empty())
+      return result;
+    if (nullptr == candidates || iter->second.size() < candidates->size())
+      candidates = &iter->second;
+  }
+
+  ComponentSignature signature;
+  if (!this->dataPtr->TypesSignature(_types, signature))
+    return result;
+
+  result.reserve(candidates->size());
+  for (const Entity entity : *candidates)
+  {
+    if (this->dataPtr->EntityMatchesSignature(entity, signature))
+      result.push_back(entity);
+  }
+  std::sort(result.begin(), result.end());
+  return result;
 }
 
 /////////////////////////////////////////////////
@@ -1213,9 +2455,36 @@ bool EntityComponentManager::HasComponentType(
 //////////////////////////////////////////////////
 const EntityGraph &EntityComponentManager::Entities() const
 {
+  std::lock_guard<std::mutex> lock(this->dataPtr->entitiesMutex);
+  if (this->dataPtr->entitiesDirty)
+  {
+    IGN_PROFILE("EntityComponentManager::Entities");
+    this->dataPtr->entitiesDirty = false;
+    auto &graph = this->dataPtr->entities;
+    graph = EntityGraph();
+    this->dataPtr->hierarchy.Each([&](Entity _entity)
+    {
+      graph.AddVertex(std::to_string(_entity), _entity, _entity);
+      return true;
+    });
+    this->dataPtr->hierarchy.Each([&](Entity _entity)
+    {
+      Entity parent = this->dataPtr->hierarchy.Parent(_entity);
+      if (parent != kNullEntity)
+        graph.AddEdge({parent, _entity}, true);
+      return true;
+    });
+  }
   return this->dataPtr->entities;
 }
 
+//////////////////////////////////////////////////
+void EntityComponentManager::EachEntity(
+    const std::function<bool(Entity)> &_f) const
+{
+  this->dataPtr->hierarchy.Each(_f);
+}
+
 //////////////////////////////////////////////////
 std::pair<detail::BaseView *, std::mutex *> EntityComponentManager::FindView(
     const std::vector<ComponentTypeId> &_types) const
@@ -1256,18 +2525,15 @@ void EntityComponentManager::RebuildViews()
 
     // Add all the entities that match the component types to the
     // view.
-    for (const auto &vertex : this->dataPtr->entities.Vertices())
+    for (const Entity entity :
+        this->EntitiesWithComponentTypes(view->ComponentTypes()))
     {
-      Entity entity = vertex.first;
-      if (this->EntityMatches(entity, view->ComponentTypes()))
-      {
-        view->MarkEntityToAdd(entity, this->IsNewEntity(entity));
+      view->MarkEntityToAdd(entity, this->IsNewEntity(entity));
 
-        // If there is a request to delete this entity, update the view as
-        // well
-        if (this->IsMarkedForRemoval(entity))
-          view->MarkEntityToRemove(entity);
-      }
+      // If there is a request to delete this entity, update the view as
+      // well
+      if (this->IsMarkedForRemoval(entity))
+        view->MarkEntityToRemove(entity);
     }
   }
 }
@@ -1359,37 +2625,39 @@ void EntityComponentManager::AddEntityToMessage(msgs::SerializedState &_msg,
     entityMsg->set_remove(true);
   }
 
+  auto addComponent = [&](const ComponentTypeId _type)
+  {
+    // The component instance is nullptr if the component was removed
+    auto compBase = this->ComponentImplementation(_entity, _type);
+    if (nullptr == compBase)
+      return;
+
+    // Repeated fields keep cleared elements around, so this reuses the
+    // component messages, and their string capacity, of a cleared message.
+    auto compMsg = entityMsg->add_components();
+    compMsg->set_type(compBase->TypeId());
+    SerializeComponent(compBase, compMsg->mutable_component(),
+        this->dataPtr->binarySerialization);
+  };
+
   // Insert all of the entity's components if the passed in types
   // set is empty
-  auto types = _types;
-  if (types.empty())
+  if (_types.empty())
   {
-    for (auto &type : this->dataPtr->componentTypeIndex[_entity])
+    for (const auto &type : iter->second)
     {
       if (!this->dataPtr->ComponentMarkedAsRemoved(_entity, type.first))
-        types.insert(type.first);
+        addComponent(type.first);
     }
   }
-
-  for (const ComponentTypeId type : types)
+  else
   {
-    // If the entity does not have the component, continue
-    auto typeIter = iter->second.find(type);
-    if (typeIter == iter->second.end())
-      continue;
-
-    // The component instance is nullptr if the component was removed
-    auto compBase = this->ComponentImplementation(_entity, type);
-    if (nullptr == compBase)
-      continue;
-
-    auto compMsg = entityMsg->add_components();
-    compMsg->set_type(compBase->TypeId());
-
-    std::ostringstream ostr;
-    compBase->Serialize(ostr);
-
-    compMsg->set_component(ostr.str());
+    for (const ComponentTypeId type : _types)
+    {
+      // If the entity does not have the component, continue
+      if (iter->second.find(type) != iter->second.end())
+        addComponent(type);
+    }
   }
 
   // Add a component to the message and set it to be removed if the component
@@ -1406,50 +2674,33 @@ void EntityComponentManager::AddEntityToMessage(msgs::SerializedStateMap &_msg,
   if (iter == this->dataPtr->componentTypeIndex.end())
     return;
 
-  // Set the default entity iterator to the end. This will allow us to know
-  // if the entity has been added to the message.
-  auto entIter = _msg.mutable_entities()->end();
-  // Add an entity to the message and set it to be removed if the entity
-  // exists in the toRemoveEntities list.
-  if (this->dataPtr->toRemoveEntities.find(_entity) !=
-      this->dataPtr->toRemoveEntities.end())
+  // Entity message, null until the entity has been added to the message.
+  // Entries are constructed in place to avoid copying temporary messages.
+  msgs::SerializedEntityMap *entityMsg{nullptr};
+  auto findOrAddEntity = [&]()
   {
-    // Find the entity in the message, and add if not present.
-    entIter = _msg.mutable_entities()->find(_entity);
-    if (entIter == _msg.mutable_entities()->end())
+    if (nullptr == entityMsg)
     {
-      msgs::SerializedEntityMap ent;
-      ent.set_id(_entity);
-      (*_msg.mutable_entities())[static_cast<uint64_t>(_entity)] = ent;
-      entIter = _msg.mutable_entities()->find(_entity);
+      entityMsg = &(*_msg.mutable_entities())[static_cast<uint64_t>(_entity)];
+      entityMsg->set_id(_entity);
     }
+  };
 
-    entIter->second.set_remove(true);
-  }
-
-  // Insert all of the entity's components if the passed in types
-  // set is empty
-  auto types = _types;
-  if (types.empty())
+  // Add an entity to the message and set it to be removed if the entity
+  // exists in the toRemoveEntities list.
+  if (this->dataPtr->toRemoveEntities.find(_entity) !=
+      this->dataPtr->toRemoveEntities.end())
   {
-    for (auto &type : this->dataPtr->componentTypeIndex[_entity])
-    {
-      if (!this->dataPtr->ComponentMarkedAsRemoved(_entity, type.first))
-        types.insert(type.first);
-    }
+    findOrAddEntity();
+    entityMsg->set_remove(true);
   }
 
-  // Empty means all types
-  for (const ComponentTypeId type : types)
+  auto addComponent = [&](const ComponentTypeId type)
   {
-    auto typeIter = iter->second.find(type);
-    if (typeIter == iter->second.end())
-    {
-      continue;
-    }
-
     const components::BaseComponent *compBase =
       this->ComponentImplementation(_entity, type);
+    if (nullptr == compBase)
+      return;
 
     // If not sending full state, skip unchanged components
     if (!_full)
@@ -1474,39 +2725,39 @@ void EntityComponentManager::AddEntityToMessage(msgs::SerializedStateMap &_msg,
       }
 
       if (noChange)
-        continue;
+        return;
     }
 
-    /// Find the entity in the message, if not already found.
-    /// Add the entity to the message, if not already added.
-    if (entIter == _msg.mutable_entities()->end())
-    {
-      entIter = _msg.mutable_entities()->find(_entity);
-      if (entIter == _msg.mutable_entities()->end())
-      {
-        msgs::SerializedEntityMap ent;
-        ent.set_id(_entity);
-        (*_msg.mutable_entities())[static_cast<uint64_t>(_entity)] = ent;
-        entIter = _msg.mutable_entities()->find(_entity);
-      }
-    }
+    // Find the entity in the message, and add it if not already added.
+    findOrAddEntity();
 
-    auto compIter = entIter->second.mutable_components()->find(type);
     // Find the component in the message, and add the component to the
     // message if it's not present.
-    if (compIter == entIter->second.mutable_components()->end())
-    {
-      msgs::SerializedComponent cmp;
-      cmp.set_type(compBase->TypeId());
-      (*(entIter->second.mutable_components()))[
-        static_cast<int64_t>(type)] = cmp;
-      compIter = entIter->second.mutable_components()->find(type);
-    }
+    auto &compMsg =
+        (*entityMsg->mutable_components())[static_cast<int64_t>(type)];
+    compMsg.set_type(compBase->TypeId());
 
     // Serialize and store the message
-    std::ostringstream ostr;
-    compBase->Serialize(ostr);
-    compIter->second.set_component(ostr.str());
+    SerializeComponent(compBase, compMsg.mutable_component(),
+        this->dataPtr->binarySerialization);
+  };
+
+  // Empty means all types
+  if (_types.empty())
+  {
+    for (const auto &type : iter->second)
+    {
+      if (!this->dataPtr->ComponentMarkedAsRemoved(_entity, type.first))
+        addComponent(type.first);
+    }
+  }
+  else
+  {
+    for (const ComponentTypeId type : _types)
+    {
+      if (iter->second.find(type) != iter->second.end())
+        addComponent(type);
+    }
   }
 
   // Add a component to the message and set it to be removed if the component
@@ -1563,6 +2814,43 @@ void EntityComponentManager::ChangedState(
   }
 }
 
+//////////////////////////////////////////////////
+void EntityComponentManager::ChangedState(
+    msgs::SerializedStateMap &_state,
+    const std::unordered_set<Entity> &_entities,
+    const std::unordered_set<ComponentTypeId> &_types) const
+{
+  IGN_PROFILE("EntityComponentManager::ChangedState Filtered");
+  auto requested = [&](const Entity _entity)
+  {
+    return _entities.empty() || _entities.find(_entity) != _entities.end();
+  };
+
+  // New entities, with all their components
+  for (const auto &entity : this->dataPtr->newlyCreatedEntities)
+  {
+    if (requested(entity))
+      this->AddEntityToMessage(_state, entity);
+  }
+
+  // Entities being removed
+  for (const auto &entity : this->dataPtr->toRemoveEntities)
+  {
+    if (requested(entity))
+      this->AddEntityToMessage(_state, entity, _types);
+  }
+
+  // New / removed / changed components
+  for (const auto &entity : this->dataPtr->modifiedComponents)
+  {
+    if (requested(entity) && this->dataPtr->newlyCreatedEntities.find(entity)
+        == this->dataPtr->newlyCreatedEntities.end())
+    {
+      this->AddEntityToMessage(_state, entity, _types);
+    }
+  }
+}
+
 //////////////////////////////////////////////////
 void EntityComponentManagerPrivate::CalculateStateThreadLoad()
 {
@@ -1578,8 +2866,8 @@ void EntityComponentManagerPrivate::CalculateStateThreadLoad()
 
   // Set the number of threads to spawn to the min of the calculated thread
   // count or max threads that the hardware supports
-  int maxThreads = std::thread::hardware_concurrency();
-  uint64_t numThreads = std::min(numEntities, maxThreads);
+  int maxThreads = static_cast<int>(this->maxThreads);
+  uint64_t numThreads = std::max(std::min(numEntities, maxThreads), 1);
 
   int entitiesPerThread = static_cast<int>(std::ceil(
     static_cast<double>(numEntities) / numThreads));
@@ -1636,8 +2924,22 @@ void EntityComponentManager::State(
     const std::unordered_set<ComponentTypeId> &_types,
     bool _full) const
 {
+  IGN_PROFILE("EntityComponentManager::State Map");
+
+  // When only a few entities are requested, such as the performers of a
+  // network secondary, visiting them directly is much cheaper than scanning
+  // every entity in the ECM.
+  if (!_entities.empty() && _entities.size() * this->dataPtr->maxThreads <
+      this->dataPtr->componentTypeIndex.size())
+  {
+    for (const auto &entity : _entities)
+    {
+      this->AddEntityToMessage(_state, entity, _types, _full);
+    }
+    return;
+  }
+
   std::mutex stateMapMutex;
-  std::vector<std::thread> workers;
 
   this->dataPtr->CalculateStateThreadLoad();
 
@@ -1662,19 +2964,11 @@ void EntityComponentManager::State(
     }
   };
 
-  // Spawn workers
-  uint64_t numThreads = this->dataPtr->componentTypeIndexIterators.size() - 1;
-  for (uint64_t i = 0; i < numThreads; i++)
+  // Process each group of entities on the worker pool
+  const auto &iterators = this->dataPtr->componentTypeIndexIterators;
+  this->dataPtr->RunTasks(iterators.size() - 1, [&](std::size_t _i)
   {
-    workers.push_back(std::thread(functor,
-        this->dataPtr->componentTypeIndexIterators[i],
-        this->dataPtr->componentTypeIndexIterators[i+1]));
-  }
-
-  // Wait for each thread to finish processing its components
-  std::for_each(workers.begin(), workers.end(), [](std::thread &_t)
-  {
-    _t.join();
+    functor(iterators[_i], iterators[_i + 1]);
   });
 }
 
@@ -1742,35 +3036,31 @@ void EntityComponentManager::SetState(
       // Get Component
       auto comp = this->ComponentImplementation(entity, type);
 
-      // Create if new
-      if (nullptr == comp)
+      // Create if new, default constructed in the ECM so it's deserialized
+      // in place without a temporary
+      const bool created = nullptr == comp;
+      if (created)
       {
-        std::istringstream istr(compMsg.component());
-
-        auto newComp = components::Factory::Instance()->New(type);
-        if (nullptr == newComp)
+        this->CreateComponentImplementation(entity, type, nullptr);
+        comp = this->ComponentImplementation(entity, type);
+        if (nullptr == comp)
         {
           ignerr << "Failed to create component type ["
             << compMsg.type() << "]" << std::endl;
           continue;
         }
-        newComp->Deserialize(istr);
-
-        auto updateData =
-          this->CreateComponentImplementation(entity, type, newComp.get());
-        if (updateData)
-        {
-          // Set comp so we deserialize the data below again
-          comp = this->ComponentImplementation(entity, type);
-        }
       }
 
       // Update component value
-      if (comp)
+      DeserializeComponent(comp, compMsg.component());
+      this->dataPtr->AddModifiedComponent(entity);
+      this->dataPtr->InvalidateIndices(entity, type);
+
+      // The entity graph is updated from the data of new parents
+      if (created && type == components::ParentEntity::typeId)
       {
-        std::istringstream istr(compMsg.component());
-        comp->Deserialize(istr);
-        this->dataPtr->AddModifiedComponent(entity);
+        this->SetParentEntity(entity,
+            static_cast<components::ParentEntity *>(comp)->Data());
       }
     }
   }
@@ -1781,217 +3071,1864 @@ void EntityComponentManager::SetState(
     const msgs::SerializedStateMap &_stateMsg)
 {
   IGN_PROFILE("EntityComponentManager::SetState Map");
-  // Create / remove / update entities
-  for (const auto &iter : _stateMsg.entities())
+
+  // A component whose data must be deserialized from the message.
+  struct PendingComponent
   {
-    const auto &entityMsg = iter.second;
+    // Entity that owns the component.
+    Entity entity;
 
-    Entity entity{entityMsg.id()};
+    // Type of the component.
+    ComponentTypeId type;
 
-    // Remove entity
-    if (entityMsg.remove())
-    {
-      this->RequestRemoveEntity(entity);
-      continue;
-    }
+    // Component to deserialize into.
+    components::BaseComponent *comp;
 
-    // Create entity if it doesn't exist
-    if (!this->HasEntity(entity))
+    // Serialized data, owned by the message.
+    const std::string *data;
+  };
+
+  // Components that already exist in the ECM.
+  std::vector<PendingComponent> updatedComps;
+
+  // Components that were just created. They're default constructed in the
+  // ECM and deserialized in place, which saves a temporary and a copy per
+  // component.
+  std::vector<PendingComponent> newComps;
+
+  // Create all new entities at once
+  {
+    IGN_PROFILE("CreateEntities");
+    std::vector<Entity> newEntities;
+    for (const auto &iter : _stateMsg.entities())
     {
-      this->dataPtr->CreateEntityImplementation(entity);
+      Entity entity{iter.second.id()};
+      if (!iter.second.remove() && !this->HasEntity(entity))
+        newEntities.push_back(entity);
     }
+    this->dataPtr->CreateEntitiesImplementation(newEntities);
+  }
 
-    // Create / remove / update components
-    for (const auto &compIter : iter.second.components())
+  // Factory lookups are cached since states usually hold many components of
+  // few types.
+  std::unordered_map<ComponentTypeId, bool> registeredTypes;
+
+  // Remove entities and components, and find which components need to be
+  // deserialized.
+  {
+    IGN_PROFILE("Match");
+    for (const auto &iter : _stateMsg.entities())
     {
-      const auto &compMsg = compIter.second;
+      const auto &entityMsg = iter.second;
 
-      uint64_t type = compMsg.type();
+      Entity entity{entityMsg.id()};
 
-      // Components which haven't been registered in this process, such as 3rd
-      // party components streamed to other secondaries and the GUI.
-      if (!components::Factory::Instance()->HasType(type))
+      // Remove entity
+      if (entityMsg.remove())
       {
-        static std::unordered_set<unsigned int> printedComps;
-        if (printedComps.find(type) == printedComps.end())
-        {
-          printedComps.insert(type);
-          ignwarn << "Component type [" << type << "] has not been "
-                  << "registered in this process, so it can't be deserialized."
-                  << std::endl;
-        }
+        this->RequestRemoveEntity(entity);
         continue;
       }
 
-      // Remove component
-      if (compMsg.remove())
+      // Create / remove / update components
+      for (const auto &compIter : iter.second.components())
       {
-        this->RemoveComponent(entity, compIter.first);
-        continue;
-      }
+        const auto &compMsg = compIter.second;
 
-      // Get Component
-      components::BaseComponent *comp =
-        this->ComponentImplementation(entity, compIter.first);
-
-      // Create if new
-      if (nullptr == comp)
-      {
-        std::istringstream istr(compMsg.component());
+        uint64_t type = compMsg.type();
 
-        // Create component
-        auto newComp = components::Factory::Instance()->New(compMsg.type());
-        if (nullptr == newComp)
+        // Components which haven't been registered in this process, such as
+        // 3rd party components streamed to other secondaries and the GUI.
+        auto registeredIt = registeredTypes.find(type);
+        if (registeredIt == registeredTypes.end())
         {
-          ignerr << "Failed to create component of type [" << compMsg.type()
-            << "]" << std::endl;
+          registeredIt = registeredTypes.emplace(type,
+              components::Factory::Instance()->HasType(type)).first;
+        }
+        if (!registeredIt->second)
+        {
+          static std::unordered_set<unsigned int> printedComps;
+          if (printedComps.find(type) == printedComps.end())
+          {
+            printedComps.insert(type);
+            ignwarn << "Component type [" << type << "] has not been "
+                    << "registered in this process, so it can't be "
+                    << "deserialized." << std::endl;
+          }
           continue;
         }
-        newComp->Deserialize(istr);
 
-        auto updateData = this->CreateComponentImplementation(
-          entity, newComp->TypeId(), newComp.get());
-        if (updateData)
+        // Remove component
+        if (compMsg.remove())
         {
-          // Set comp so we deserialize the data below again
-          comp = this->ComponentImplementation(entity, compIter.first);
+          this->RemoveComponent(entity, compIter.first);
+          continue;
         }
-      }
 
-      // Update component value
-      if (comp)
-      {
-        std::istringstream istr(compMsg.component());
-        comp->Deserialize(istr);
-        this->SetChanged(entity, compIter.first,
-            _stateMsg.has_one_time_component_changes() ?
-            ComponentState::OneTimeChange :
-            ComponentState::PeriodicChange);
+        // Get Component
+        components::BaseComponent *comp =
+          this->ComponentImplementation(entity, compIter.first);
+
+        if (nullptr != comp)
+        {
+          updatedComps.push_back({entity, compIter.first, comp,
+              &compMsg.component()});
+          continue;
+        }
+
+        // Create if new
+        auto updateData = this->CreateComponentImplementation(entity,
+            compIter.first, nullptr);
+        comp = this->ComponentImplementation(entity, compIter.first);
+        if (nullptr == comp)
+        {
+          ignerr << "Failed to create component of type [" << compMsg.type()
+            << "]" << std::endl;
+          continue;
+        }
+
+        // Components which existed but had been removed are updated
+        // instead
+        auto &pending = updateData ? updatedComps : newComps;
+        pending.push_back({entity, compIter.first, comp,
+            &compMsg.component()});
+      }
+    }
+  }
+
+  // Deserialization of each component is independent, so shard it across
+  // threads.
+  {
+    IGN_PROFILE("Deserialize");
+    const std::size_t newCount = newComps.size();
+    this->ParallelFor(newCount + updatedComps.size(),
+        [&](std::size_t _begin, std::size_t _end)
+        {
+          for (std::size_t i = _begin; i < _end; ++i)
+          {
+            const auto &pending = i < newCount ? newComps[i] :
+                updatedComps[i - newCount];
+            DeserializeComponent(pending.comp, *pending.data);
+          }
+        });
+  }
+
+  // Creating a ParentEntity updates the entity graph from its data, which
+  // was only deserialized now, and mark updated components as changed
+  {
+    IGN_PROFILE("Create");
+    for (const auto &pending : newComps)
+    {
+      if (pending.type == components::ParentEntity::typeId)
+      {
+        this->SetParentEntity(pending.entity, static_cast<
+            components::ParentEntity *>(pending.comp)->Data());
+      }
+    }
+
+    const auto state = _stateMsg.has_one_time_component_changes() ?
+        ComponentState::OneTimeChange : ComponentState::PeriodicChange;
+    for (const auto &pending : updatedComps)
+      this->SetChanged(pending.entity, pending.type, state);
+  }
+}
+
+/// \brief Private data of EntityCommandBuffer.
+class ignition::gazebo::EntityCommandBufferPrivate
+{
+  /// \brief Kinds of commands.
+  public: enum class Type
+  {
+    /// \brief Create an entity.
+    CREATE_ENTITY,
+
+    /// \brief Create a component, or replace its data.
+    CREATE_COMPONENT,
+
+    /// \brief Remove a component.
+    REMOVE_COMPONENT,
+
+    /// \brief Request to remove an entity.
+    REMOVE_ENTITY,
+  };
+
+  /// \brief A recorded command.
+  public: struct Command
+  {
+    /// \brief Kind of command.
+    Type type;
+
+    /// \brief Entity the command applies to.
+    Entity entity;
+
+    /// \brief Component type, for component commands.
+    ComponentTypeId componentType{0u};
+
+    /// \brief Component to create, for CREATE_COMPONENT.
+    std::unique_ptr<components::BaseComponent> comp;
+
+    /// \brief Whether to remove children too, for REMOVE_ENTITY.
+    bool recursive{true};
+  };
+
+  /// \brief Constructor
+  /// \param[in] _ecm Manager the buffer records changes for.
+  public: explicit EntityCommandBufferPrivate(EntityComponentManager &_ecm)
+    : ecm(_ecm)
+  {
+  }
+
+  /// \brief Manager the buffer records changes for.
+  public: EntityComponentManager &ecm;
+
+  /// \brief Commands in the order they were recorded.
+  public: std::vector<Command> commands;
+
+  /// \brief Task the buffer belongs to, if it was given out in
+  /// deterministic mode instead of to a thread.
+  public: std::optional<uint64_t> taskKey;
+};
+
+//////////////////////////////////////////////////
+EntityCommandBuffer::EntityCommandBuffer(EntityComponentManager &_ecm)
+  : dataPtr(std::make_unique<EntityCommandBufferPrivate>(_ecm))
+{
+}
+
+//////////////////////////////////////////////////
+EntityCommandBuffer::~EntityCommandBuffer() = default;
+
+//////////////////////////////////////////////////
+Entity EntityCommandBuffer::CreateEntity()
+{
+  const Entity entity = ++this->dataPtr->ecm.dataPtr->entityCount;
+  this->dataPtr->commands.push_back(
+      {EntityCommandBufferPrivate::Type::CREATE_ENTITY, entity});
+  return entity;
+}
+
+//////////////////////////////////////////////////
+void EntityCommandBuffer::CreateComponentImplementation(const Entity _entity,
+    std::unique_ptr<components::BaseComponent> _comp)
+{
+  const ComponentTypeId type = _comp->TypeId();
+  this->dataPtr->commands.push_back(
+      {EntityCommandBufferPrivate::Type::CREATE_COMPONENT, _entity, type,
+      std::move(_comp)});
+}
+
+//////////////////////////////////////////////////
+void EntityCommandBuffer::RemoveComponent(const Entity _entity,
+    const ComponentTypeId _typeId)
+{
+  this->dataPtr->commands.push_back(
+      {EntityCommandBufferPrivate::Type::REMOVE_COMPONENT, _entity, _typeId});
+}
+
+//////////////////////////////////////////////////
+void EntityCommandBuffer::RequestRemoveEntity(const Entity _entity,
+    bool _recursive)
+{
+  this->dataPtr->commands.push_back(
+      {EntityCommandBufferPrivate::Type::REMOVE_ENTITY, _entity, 0u, nullptr,
+      _recursive});
+}
+
+//////////////////////////////////////////////////
+std::size_t EntityCommandBuffer::Size() const
+{
+  return this->dataPtr->commands.size();
+}
+
+//////////////////////////////////////////////////
+bool EntityCommandBuffer::Empty() const
+{
+  return this->dataPtr->commands.empty();
+}
+
+//////////////////////////////////////////////////
+EntityCommandBuffer &EntityComponentManager::CommandBuffer()
+{
+  if (this->dataPtr->deterministic)
+    return this->TaskCommandBuffer();
+
+  // Last buffer given to this thread, and the id of its manager
+  thread_local std::pair<uint64_t, EntityCommandBuffer *> cached{0u, nullptr};
+  if (cached.first == this->dataPtr->managerId)
+    return *cached.second;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->commandBuffersMutex);
+  auto &buffer =
+      this->dataPtr->threadCommandBuffers[std::this_thread::get_id()];
+  if (nullptr == buffer)
+  {
+    this->dataPtr->commandBuffers.push_back(
+        std::unique_ptr<EntityCommandBuffer>(new EntityCommandBuffer(*this)));
+    buffer = this->dataPtr->commandBuffers.back().get();
+  }
+  cached = {this->dataPtr->managerId, buffer};
+  return *buffer;
+}
+
+//////////////////////////////////////////////////
+EntityCommandBuffer &EntityComponentManager::TaskCommandBuffer()
+{
+  // Last buffer given to this thread, and the manager and task it's for
+  thread_local std::tuple<uint64_t, uint64_t, EntityCommandBuffer *> cached{
+      0u, 0u, nullptr};
+  if (std::get<0>(cached) == this->dataPtr->managerId &&
+      std::get<1>(cached) == tTaskKey)
+  {
+    return *std::get<2>(cached);
+  }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->commandBuffersMutex);
+  auto &buffer = this->dataPtr->taskCommandBuffers[tTaskKey];
+  if (nullptr == buffer)
+  {
+    std::unique_ptr<EntityCommandBuffer> taskBuffer(
+        new EntityCommandBuffer(*this));
+    taskBuffer->dataPtr->taskKey = tTaskKey;
+
+    // Keep buffers sorted by task, after the ones of threads, so they're
+    // applied in the same order on every run
+    auto &buffers = this->dataPtr->commandBuffers;
+    auto it = std::upper_bound(buffers.begin(), buffers.end(), tTaskKey,
+        [](uint64_t _key, const std::unique_ptr<EntityCommandBuffer> &_other)
+        {
+          const auto &otherKey = _other->dataPtr->taskKey;
+          return otherKey.has_value() && _key < *otherKey;
+        });
+    buffer = buffers.insert(it, std::move(taskBuffer))->get();
+  }
+  cached = {this->dataPtr->managerId, tTaskKey, buffer};
+  return *buffer;
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::ApplyCommandBuffers()
+{
+  IGN_PROFILE("EntityComponentManager::ApplyCommandBuffers");
+  using Type = EntityCommandBufferPrivate::Type;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->commandBuffersMutex);
+  for (auto &buffer : this->dataPtr->commandBuffers)
+  {
+    auto &commands = buffer->dataPtr->commands;
+    for (auto &command : commands)
+    {
+      switch (command.type)
+      {
+        case Type::CREATE_ENTITY:
+          this->dataPtr->CreateEntityImplementation(command.entity);
+          break;
+        case Type::CREATE_COMPONENT:
+        {
+          // Returns true if the component already existed, in which case
+          // its data is replaced
+          if (this->CreateComponentImplementation(command.entity,
+              command.componentType, command.comp.get()))
+          {
+            auto *comp = this->ComponentImplementation(command.entity,
+                command.componentType);
+            if (nullptr != comp)
+            {
+              components::Factory::Instance()->MoveData(*comp,
+                  *command.comp);
+            }
+          }
+          break;
+        }
+        case Type::REMOVE_COMPONENT:
+          this->RemoveComponent(command.entity, command.componentType);
+          break;
+        case Type::REMOVE_ENTITY:
+          this->RequestRemoveEntity(command.entity, command.recursive);
+          break;
+      }
+    }
+    commands.clear();
+  }
+}
+
+/// \brief Private data of StagedState.
+class ignition::gazebo::StagedStatePrivate
+{
+  /// \brief A component deserialized ahead of time.
+  public: struct Component
+  {
+    /// \brief Entity that owns the component.
+    Entity entity;
+
+    /// \brief Type of the component.
+    ComponentTypeId type;
+
+    /// \brief Deserialized component.
+    std::unique_ptr<components::BaseComponent> comp;
+  };
+
+  /// \brief Entities in the state which aren't removed.
+  public: std::vector<Entity> entities;
+
+  /// \brief Entities removed by the state.
+  public: std::vector<Entity> removedEntities;
+
+  /// \brief Components removed by the state.
+  public: std::vector<std::pair<Entity, ComponentTypeId>> removedComponents;
+
+  /// \brief Components created or updated by the state.
+  public: std::vector<Component> components;
+
+  /// \brief True if the state has one time component changes.
+  public: bool oneTimeChanges{false};
+
+  /// \brief Components whose data was already applied, kept by type so
+  /// staging the next state into this one deserializes into them instead
+  /// of allocating new ones.
+  public: std::unordered_map<ComponentTypeId,
+      std::vector<std::unique_ptr<components::BaseComponent>>> spare;
+};
+
+//////////////////////////////////////////////////
+StagedState::StagedState()
+  : dataPtr(std::make_unique<StagedStatePrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+StagedState::StagedState(StagedState &&_state) noexcept = default;
+
+//////////////////////////////////////////////////
+StagedState::~StagedState() = default;
+
+//////////////////////////////////////////////////
+StagedState &StagedState::operator=(StagedState &&_state) noexcept = default;
+
+//////////////////////////////////////////////////
+bool StagedState::Empty() const
+{
+  return nullptr == this->dataPtr || (this->dataPtr->entities.empty() &&
+      this->dataPtr->removedEntities.empty());
+}
+
+//////////////////////////////////////////////////
+StagedState EntityComponentManager::StageState(
+    const msgs::SerializedStateMap &_stateMsg)
+{
+  StagedState staged;
+  StageState(_stateMsg, staged);
+  return staged;
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::StageState(
+    const msgs::SerializedStateMap &_stateMsg, StagedState &_state)
+{
+  IGN_PROFILE("EntityComponentManager::StageState");
+
+  if (nullptr == _state.dataPtr)
+    _state.dataPtr = std::make_unique<StagedStatePrivate>();
+  auto &data = *_state.dataPtr;
+
+  // Components which weren't applied are reused as well
+  for (auto &staged : data.components)
+    data.spare[staged.type].push_back(std::move(staged.comp));
+  data.components.clear();
+  data.entities.clear();
+  data.removedEntities.clear();
+  data.removedComponents.clear();
+
+  data.oneTimeChanges = _stateMsg.has_one_time_component_changes();
+
+  std::unordered_map<ComponentTypeId, bool> registeredTypes;
+  for (const auto &iter : _stateMsg.entities())
+  {
+    const auto &entityMsg = iter.second;
+    Entity entity{entityMsg.id()};
+
+    if (entityMsg.remove())
+    {
+      data.removedEntities.push_back(entity);
+      continue;
+    }
+    data.entities.push_back(entity);
+
+    for (const auto &compIter : entityMsg.components())
+    {
+      const auto &compMsg = compIter.second;
+
+      // Components which haven't been registered in this process are
+      // skipped, as in SetState.
+      auto registeredIt = registeredTypes.find(compMsg.type());
+      if (registeredIt == registeredTypes.end())
+      {
+        registeredIt = registeredTypes.emplace(compMsg.type(),
+            components::Factory::Instance()->HasType(compMsg.type())).first;
+      }
+      if (!registeredIt->second)
+        continue;
+
+      if (compMsg.remove())
+      {
+        data.removedComponents.emplace_back(entity, compIter.first);
+        continue;
+      }
+
+      std::unique_ptr<components::BaseComponent> comp;
+      auto spareIt = data.spare.find(compMsg.type());
+      if (spareIt != data.spare.end() && !spareIt->second.empty())
+      {
+        comp = std::move(spareIt->second.back());
+        spareIt->second.pop_back();
+      }
+      else
+      {
+        comp = components::Factory::Instance()->New(compMsg.type());
+      }
+      if (nullptr == comp)
+      {
+        ignerr << "Failed to create component of type [" << compMsg.type()
+          << "]" << std::endl;
+        continue;
+      }
+      DeserializeComponent(comp.get(), compMsg.component());
+      data.components.push_back({entity, compIter.first, std::move(comp)});
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::SetState(StagedState &_state)
+{
+  IGN_PROFILE("EntityComponentManager::SetState Staged");
+
+  if (nullptr == _state.dataPtr)
+    return;
+  auto &data = *_state.dataPtr;
+
+  {
+    IGN_PROFILE("CreateEntities");
+    std::vector<Entity> newEntities;
+    for (const auto &entity : data.entities)
+    {
+      if (!this->HasEntity(entity))
+        newEntities.push_back(entity);
+    }
+    this->dataPtr->CreateEntitiesImplementation(newEntities);
+  }
+
+  for (const auto &entity : data.removedEntities)
+    this->RequestRemoveEntity(entity);
+
+  for (const auto &[entity, type] : data.removedComponents)
+    this->RemoveComponent(entity, type);
+
+  const auto state = data.oneTimeChanges ?
+      ComponentState::OneTimeChange : ComponentState::PeriodicChange;
+  {
+    IGN_PROFILE("Move");
+    for (auto &staged : data.components)
+    {
+      auto *comp = this->ComponentImplementation(staged.entity, staged.type);
+      if (nullptr == comp)
+      {
+        // Returns true if the component existed but had been removed, in
+        // which case its data is stale
+        if (!this->CreateComponentImplementation(staged.entity, staged.type,
+            staged.comp.get()))
+        {
+          continue;
+        }
+        comp = this->ComponentImplementation(staged.entity, staged.type);
+        if (nullptr == comp)
+          continue;
+      }
+      components::Factory::Instance()->MoveData(*comp, *staged.comp);
+      this->SetChanged(staged.entity, staged.type, state);
+    }
+  }
+
+  // Keep the emptied components for the next state staged into this one
+  for (auto &staged : data.components)
+    data.spare[staged.type].push_back(std::move(staged.comp));
+  data.components.clear();
+}
+
+/// \brief Private data of ComponentDemand.
+class ignition::gazebo::ComponentDemandPrivate
+{
+  /// \brief Registry holding the demand.
+  public: std::weak_ptr<ComponentDemandRegistry> registry;
+
+  /// \brief The entity.
+  public: Entity entity{kNullEntity};
+
+  /// \brief Type of the component.
+  public: ComponentTypeId type{0u};
+};
+
+//////////////////////////////////////////////////
+ComponentDemand::ComponentDemand()
+  : dataPtr(std::make_unique<ComponentDemandPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+ComponentDemand::ComponentDemand(ComponentDemand &&_demand) noexcept
+    = default;
+
+//////////////////////////////////////////////////
+ComponentDemand::~ComponentDemand()
+{
+  this->Release();
+}
+
+//////////////////////////////////////////////////
+ComponentDemand &ComponentDemand::operator=(
+    ComponentDemand &&_demand) noexcept
+{
+  if (this != &_demand)
+  {
+    this->Release();
+    this->dataPtr = std::move(_demand.dataPtr);
+  }
+  return *this;
+}
+
+//////////////////////////////////////////////////
+void ComponentDemand::Release()
+{
+  if (nullptr == this->dataPtr)
+    return;
+
+  auto registry = this->dataPtr->registry.lock();
+  if (nullptr != registry)
+    registry->Release(this->dataPtr->entity, this->dataPtr->type);
+  this->dataPtr->registry.reset();
+}
+
+//////////////////////////////////////////////////
+bool ComponentDemand::Active() const
+{
+  return nullptr != this->dataPtr && !this->dataPtr->registry.expired();
+}
+
+//////////////////////////////////////////////////
+ComponentDemand EntityComponentManager::DemandComponent(
+    const Entity _entity, const ComponentTypeId _typeId)
+{
+  ComponentDemand handle;
+  if (!this->HasEntity(_entity) ||
+      !components::Factory::Instance()->HasType(_typeId))
+  {
+    return handle;
+  }
+
+  auto &registry = *this->dataPtr->demandRegistry;
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto *demand = registry.Find(_entity, _typeId);
+  if (nullptr != demand)
+  {
+    ++demand->count;
+  }
+  else
+  {
+    const bool create = !this->EntityHasComponentType(_entity, _typeId);
+    if (create)
+    {
+      auto comp = components::Factory::Instance()->New(_typeId);
+      if (nullptr == comp)
+        return handle;
+      // Returns true if the component existed but had been removed, in
+      // which case its data is stale
+      if (this->CreateComponentImplementation(_entity, _typeId, comp.get()))
+      {
+        auto *existing = this->ComponentImplementation(_entity, _typeId);
+        if (nullptr != existing)
+          components::Factory::Instance()->MoveData(*existing, *comp);
+      }
+    }
+    registry.demands[_entity].push_back({_typeId, 1u, create});
+  }
+
+  handle.dataPtr->registry = this->dataPtr->demandRegistry;
+  handle.dataPtr->entity = _entity;
+  handle.dataPtr->type = _typeId;
+  return handle;
+}
+
+//////////////////////////////////////////////////
+std::size_t EntityComponentManager::ComponentDemandCount(
+    const Entity _entity, const ComponentTypeId _typeId) const
+{
+  auto &registry = *this->dataPtr->demandRegistry;
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto *demand = registry.Find(_entity, _typeId);
+  return nullptr == demand ? 0u : demand->count;
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::RemoveUndemandedComponents()
+{
+  IGN_PROFILE("EntityComponentManager::RemoveUndemandedComponents");
+
+  // Components are removed without holding the registry's lock
+  std::vector<std::pair<Entity, ComponentTypeId>> toRemove;
+  {
+    auto &registry = *this->dataPtr->demandRegistry;
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    if (registry.released.empty())
+      return;
+
+    for (const auto &[entity, type] : registry.released)
+    {
+      auto it = registry.demands.find(entity);
+      if (it == registry.demands.end())
+        continue;
+
+      auto &entityDemands = it->second;
+      for (auto demandIt = entityDemands.begin();
+           demandIt != entityDemands.end(); ++demandIt)
+      {
+        // Demanded again after being released
+        if (demandIt->type != type || demandIt->count > 0u)
+          continue;
+        if (demandIt->created)
+          toRemove.emplace_back(entity, type);
+        entityDemands.erase(demandIt);
+        break;
+      }
+      if (entityDemands.empty())
+        registry.demands.erase(it);
+    }
+    registry.released.clear();
+  }
+
+  for (const auto &[entity, type] : toRemove)
+    this->RemoveComponent(entity, type);
+}
+
+/// \brief Private data of ComponentSnapshot.
+class ignition::gazebo::ComponentSnapshotPrivate
+{
+  /// \brief A copied component.
+  public: struct Component
+  {
+    /// \brief Type of the component.
+    ComponentTypeId type;
+
+    /// \brief Copy of the component, which is never modified.
+    std::unique_ptr<components::BaseComponent> comp;
+  };
+
+  /// \brief Entities in the order they were copied.
+  public: std::vector<Entity> entities;
+
+  /// \brief Components of each entity, in the same order as entities.
+  public: std::vector<std::vector<Component>> components;
+
+  /// \brief Entity count of the manager when the snapshot was taken.
+  public: uint64_t entityCount{0u};
+};
+
+//////////////////////////////////////////////////
+ComponentSnapshot::ComponentSnapshot()
+  : dataPtr(std::make_unique<ComponentSnapshotPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+ComponentSnapshot::ComponentSnapshot(ComponentSnapshot &&_snapshot) noexcept
+    = default;
+
+//////////////////////////////////////////////////
+ComponentSnapshot::~ComponentSnapshot() = default;
+
+//////////////////////////////////////////////////
+ComponentSnapshot &ComponentSnapshot::operator=(
+    ComponentSnapshot &&_snapshot) noexcept = default;
+
+//////////////////////////////////////////////////
+std::size_t ComponentSnapshot::EntityCount() const
+{
+  return nullptr == this->dataPtr ? 0u : this->dataPtr->entities.size();
+}
+
+//////////////////////////////////////////////////
+std::size_t ComponentSnapshot::ComponentCount() const
+{
+  if (nullptr == this->dataPtr)
+    return 0u;
+
+  std::size_t count{0u};
+  for (const auto &components : this->dataPtr->components)
+    count += components.size();
+  return count;
+}
+
+//////////////////////////////////////////////////
+ComponentSnapshot EntityComponentManager::Snapshot() const
+{
+  IGN_PROFILE("EntityComponentManager::Snapshot");
+
+  ComponentSnapshot snapshot;
+  auto &data = *snapshot.dataPtr;
+  data.entityCount = this->dataPtr->entityCount;
+  data.entities.reserve(this->dataPtr->hierarchy.Size());
+  data.components.reserve(this->dataPtr->hierarchy.Size());
+
+  this->dataPtr->hierarchy.Each([&](Entity _entity)
+  {
+    data.entities.push_back(_entity);
+    auto &components = data.components.emplace_back();
+    this->EachComponentType(_entity, [&](ComponentTypeId _type)
+    {
+      // Clone doesn't modify the component, it just isn't const
+      auto *comp = const_cast<components::BaseComponent *>(
+          this->ComponentImplementation(_entity, _type));
+      if (nullptr != comp)
+        components.push_back({_type, comp->Clone()});
+      return true;
+    });
+    return true;
+  });
+
+  return snapshot;
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::RestoreSnapshot(
+    const ComponentSnapshot &_snapshot)
+{
+  IGN_PROFILE("EntityComponentManager::RestoreSnapshot");
+
+  if (nullptr == _snapshot.dataPtr)
+    return;
+  const auto &snapshot = *_snapshot.dataPtr;
+
+  // Restoring is setting a state whose components are copies of the
+  // snapshot's, so the snapshot can be restored again
+  StagedState staged;
+  auto &data = *staged.dataPtr;
+  data.oneTimeChanges = true;
+  data.entities = snapshot.entities;
+
+  std::unordered_set<Entity> snapshotEntities(snapshot.entities.begin(),
+      snapshot.entities.end());
+  this->dataPtr->hierarchy.Each([&](Entity _entity)
+  {
+    if (snapshotEntities.find(_entity) == snapshotEntities.end())
+      data.removedEntities.push_back(_entity);
+    return true;
+  });
+
+  std::unordered_set<ComponentTypeId> snapshotTypes;
+  for (std::size_t i = 0; i < snapshot.entities.size(); ++i)
+  {
+    const Entity entity = snapshot.entities[i];
+    snapshotTypes.clear();
+    for (const auto &component : snapshot.components[i])
+    {
+      snapshotTypes.insert(component.type);
+      data.components.push_back({entity, component.type,
+          component.comp->Clone()});
+    }
+
+    this->EachComponentType(entity, [&](ComponentTypeId _type)
+    {
+      if (snapshotTypes.find(_type) == snapshotTypes.end())
+        data.removedComponents.emplace_back(entity, _type);
+      return true;
+    });
+  }
+
+  // Entities created after the snapshot keep their ids reserved until
+  // they're removed, so ids are never reused
+  if (this->dataPtr->entityCount < snapshot.entityCount)
+    this->dataPtr->entityCount = snapshot.entityCount;
+
+  this->SetState(staged);
+}
+
+//////////////////////////////////////////////////
+std::unordered_set<Entity> EntityComponentManager::Descendants(Entity _entity)
+    const
+{
+  std::vector<Entity> descVector;
+  this->dataPtr->hierarchy.Descendants(_entity, descVector);
+  return std::unordered_set<Entity>(descVector.begin(), descVector.end());
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::EachDescendant(Entity _entity,
+    const std::function<bool(Entity)> &_f) const
+{
+  this->dataPtr->hierarchy.EachDescendant(_entity, _f);
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::SetAllComponentsUnchanged()
+{
+  // Cached world poses only last one iteration, in case poses were modified
+  // in place without being marked as changed
+  ++this->dataPtr->worldPoseEpoch;
+
+  this->dataPtr->periodicChangedComponents.clear();
+  this->dataPtr->oneTimeChangedComponents.clear();
+  this->dataPtr->modifiedComponents.clear();
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::SetChanged(
+    const Entity _entity, const ComponentTypeId _type,
+    gazebo::ComponentState _c)
+{
+  // make sure _entity exists
+  auto ecIter = this->dataPtr->componentTypeIndex.find(_entity);
+  if (ecIter == this->dataPtr->componentTypeIndex.end())
+    return;
+
+  // make sure the entity has a component of type _type
+  if (ecIter->second.find(_type) == ecIter->second.end() ||
+      this->dataPtr->ComponentMarkedAsRemoved(_entity, _type))
+    return;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->changedComponentsMutex);
+  if (_c == ComponentState::PeriodicChange)
+  {
+    this->dataPtr->periodicChangedComponents[_type].insert(_entity);
+    auto oneTimeIter = this->dataPtr->oneTimeChangedComponents.find(_type);
+    if (oneTimeIter != this->dataPtr->oneTimeChangedComponents.end())
+      oneTimeIter->second.erase(_entity);
+  }
+  else if (_c == ComponentState::OneTimeChange)
+  {
+    auto periodicIter = this->dataPtr->periodicChangedComponents.find(_type);
+    if (periodicIter != this->dataPtr->periodicChangedComponents.end())
+      periodicIter->second.erase(_entity);
+    this->dataPtr->oneTimeChangedComponents[_type].insert(_entity);
+  }
+  else
+  {
+    auto periodicIter = this->dataPtr->periodicChangedComponents.find(_type);
+    if (periodicIter != this->dataPtr->periodicChangedComponents.end())
+      periodicIter->second.erase(_entity);
+    auto oneTimeIter = this->dataPtr->oneTimeChangedComponents.find(_type);
+    if (oneTimeIter != this->dataPtr->oneTimeChangedComponents.end())
+      oneTimeIter->second.erase(_entity);
+
+    // the component state is flagged as no change, so don't mark the
+    // corresponding entity as one with a modified component
+    return;
+  }
+
+  this->dataPtr->BumpComponentVersion(_entity, _type);
+  this->dataPtr->RecordObservedChange(_entity, _type,
+      EntityComponentManagerPrivate::ObservedChange::CHANGED);
+  this->dataPtr->AddModifiedComponent(_entity);
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::RecordObservedChange(const Entity _entity,
+    const ComponentTypeId _typeId, ObservedChange _change)
+{
+  auto typeIter = this->typeObservers.find(_typeId);
+  if (typeIter == this->typeObservers.end())
+    return;
+
+  for (Observer *observer : typeIter->second)
+  {
+    // Removed entities can't be located when notifying, so they're filtered
+    // now
+    if (_change == ObservedChange::REMOVED &&
+        !this->InSubtree(_entity, observer->root))
+    {
+      continue;
+    }
+    observer->pending.emplace_back(_entity, _change);
+  }
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManagerPrivate::InSubtree(Entity _entity,
+    Entity _root) const
+{
+  if (_root == kNullEntity)
+    return true;
+
+  for (Entity entity = _entity; entity != kNullEntity;
+       entity = this->hierarchy.Parent(entity))
+  {
+    if (entity == _root)
+      return true;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::BumpComponentVersion(const Entity _entity,
+    const ComponentTypeId _typeId)
+{
+  this->componentVersions[_entity][_typeId] = ++this->componentVersion;
+  this->componentTypeVersions[_typeId] = this->componentVersion;
+  this->InvalidateIndices(_entity, _typeId);
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::InvalidateIndices(const Entity _entity,
+    const ComponentTypeId _typeId)
+{
+  // Poses of descendants depend on this one, so all are recomputed
+  if (_typeId == components::Pose::typeId ||
+      _typeId == components::ParentEntity::typeId)
+  {
+    ++this->worldPoseEpoch;
+  }
+
+  if (_typeId == components::Static::typeId ||
+      _typeId == components::ParentEntity::typeId)
+  {
+    this->staticDirty = true;
+  }
+  else if (_typeId == components::Pose::typeId)
+  {
+    // Static poses are cached until a static entity, or a root which static
+    // entities may be placed in, moves
+    std::lock_guard<std::mutex> lock(this->staticMutex);
+    if (this->staticDirty ||
+        this->staticEntities.find(_entity) != this->staticEntities.end() ||
+        this->hierarchy.Parent(_entity) == kNullEntity)
+    {
+      this->staticPoseEpoch = this->worldPoseEpoch.load();
+    }
+  }
+
+  if (_typeId != components::Name::typeId &&
+      _typeId != components::ParentEntity::typeId)
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(this->childIndexMutex);
+  this->childIndexPending.insert(_entity);
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::RemoveFromChildIndex(
+    const Entity _entity) const
+{
+  auto keyIt = this->childIndexKeys.find(_entity);
+  if (keyIt == this->childIndexKeys.end())
+    return;
+
+  auto indexIt = this->childIndex.find(keyIt->second.parent);
+  if (indexIt != this->childIndex.end())
+  {
+    auto &children = indexIt->second.children;
+    auto it = std::lower_bound(children.begin(), children.end(), _entity);
+    if (it != children.end() && *it == _entity)
+      children.erase(it);
+
+    if (keyIt->second.name)
+    {
+      auto range = indexIt->second.byName.equal_range(*keyIt->second.name);
+      for (auto it2 = range.first; it2 != range.second; ++it2)
+      {
+        if (it2->second == _entity)
+        {
+          indexIt->second.byName.erase(it2);
+          break;
+        }
+      }
+    }
+
+    if (children.empty())
+      this->childIndex.erase(indexIt);
+  }
+  this->childIndexKeys.erase(keyIt);
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::UpdateStaticEntities(
+    const EntityComponentManager &_ecm) const
+{
+  if (!this->staticDirty)
+    return;
+  this->staticDirty = false;
+
+  IGN_PROFILE("EntityComponentManager::UpdateStaticEntities");
+  this->staticEntities.clear();
+
+  auto isStatic = [&](Entity _entity)
+  {
+    auto staticComp = _ecm.Component<components::Static>(_entity);
+    return nullptr != staticComp && staticComp->Data();
+  };
+
+  _ecm.Each<components::Static>(
+      [&](const Entity &_entity, const components::Static *_static)
+      {
+        if (!_static->Data() ||
+            this->staticEntities.find(_entity) != this->staticEntities.end())
+        {
+          return true;
+        }
+
+        // Models nested in a dynamic model move with it
+        for (Entity parent = this->hierarchy.Parent(_entity);
+             parent != kNullEntity; parent = this->hierarchy.Parent(parent))
+        {
+          if (!isStatic(parent) &&
+              nullptr != _ecm.Component<components::Pose>(parent))
+          {
+            return true;
+          }
+        }
+
+        this->hierarchy.EachDescendant(_entity, [&](Entity _descendant)
+        {
+          this->staticEntities.insert(_descendant);
+          return true;
+        });
+        return true;
+      });
+
+  ++this->staticVersion;
+
+  // Cached poses may have been computed with entities which are no longer
+  // static
+  this->staticPoseEpoch = ++this->worldPoseEpoch;
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::IsStatic(const Entity _entity) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->staticMutex);
+  this->dataPtr->UpdateStaticEntities(*this);
+  return this->dataPtr->staticEntities.find(_entity) !=
+      this->dataPtr->staticEntities.end();
+}
+
+/////////////////////////////////////////////////
+const std::vector<Entity> &EntityComponentManager::DynamicEntities(
+    const detail::BaseView *_view) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->staticMutex);
+  this->dataPtr->UpdateStaticEntities(*this);
+
+  auto &cached = this->dataPtr->dynamicEntities[_view];
+  const auto &entities = _view->DenseEntities();
+  if (cached.viewVersion != entities.version() ||
+      cached.staticVersion != this->dataPtr->staticVersion)
+  {
+    cached.viewVersion = entities.version();
+    cached.staticVersion = this->dataPtr->staticVersion;
+    cached.entities.clear();
+    entities.forEach([&](const Entity _entity)
+    {
+      if (this->dataPtr->staticEntities.find(_entity) ==
+          this->dataPtr->staticEntities.end())
+      {
+        cached.entities.push_back(_entity);
+      }
+      return true;
+    });
+  }
+  return cached.entities;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::ComponentDataSet(const Entity _entity,
+    const ComponentTypeId _typeId)
+{
+  this->dataPtr->InvalidateIndices(_entity, _typeId);
+}
+
+/////////////////////////////////////////////////
+std::optional<math::Pose3d> EntityComponentManager::EntityWorldPose(
+    const Entity _entity) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->worldPoseMutex);
+  const uint64_t epoch = this->dataPtr->worldPoseEpoch;
+  auto &cache = this->dataPtr->worldPoseCache;
+
+  // Poses of static entities stay valid across steps
+  std::lock_guard<std::mutex> lockStatic(this->dataPtr->staticMutex);
+  this->dataPtr->UpdateStaticEntities(*this);
+  const uint64_t staticEpoch = this->dataPtr->staticPoseEpoch;
+  auto validEpoch = [&](Entity _entity)
+  {
+    return this->dataPtr->staticEntities.find(_entity) !=
+        this->dataPtr->staticEntities.end() ? staticEpoch : epoch;
+  };
+
+  // Walk up until an ancestor whose world pose is known, or the root of the
+  // chain of poses
+  std::vector<std::pair<Entity, const math::Pose3d *>> chain;
+  std::optional<math::Pose3d> base;
+  Entity entity = _entity;
+  while (true)
+  {
+    auto cacheIt = cache.find(entity);
+    if (cacheIt != cache.end() && cacheIt->second.epoch == validEpoch(entity))
+    {
+      base = cacheIt->second.pose;
+      break;
+    }
+
+    auto poseComp = this->Component<components::Pose>(entity);
+    if (nullptr == poseComp)
+      break;
+    chain.emplace_back(entity, &poseComp->Data());
+
+    auto parentComp = this->Component<components::ParentEntity>(entity);
+    if (nullptr == parentComp)
+      break;
+    entity = parentComp->Data();
+  }
+
+  // The entity itself doesn't have a pose
+  if (chain.empty())
+    return base;
+
+  // Compose down to the entity, caching every ancestor on the way
+  math::Pose3d pose = base ? *base : math::Pose3d::Zero;
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+  {
+    pose = pose * *it->second;
+    cache[it->first] = {pose, validEpoch(it->first)};
+  }
+  return pose;
+}
+
+/////////////////////////////////////////////////
+std::vector<Entity> EntityComponentManager::IndexedChildren(Entity _parent,
+    const std::string *_name) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->childIndexMutex);
+
+  // Re-add an entity with the current values of its components
+  auto reindex = [&](Entity _entity)
+  {
+    this->dataPtr->RemoveFromChildIndex(_entity);
+
+    auto parentComp = this->Component<components::ParentEntity>(_entity);
+    if (!parentComp)
+      return;
+
+    auto &indexed = this->dataPtr->childIndex[parentComp->Data()];
+    auto &children = indexed.children;
+    children.insert(std::lower_bound(children.begin(), children.end(),
+        _entity), _entity);
+
+    auto &key = this->dataPtr->childIndexKeys[_entity];
+    key.parent = parentComp->Data();
+    auto nameComp = this->Component<components::Name>(_entity);
+    if (nameComp)
+    {
+      indexed.byName.emplace(nameComp->Data(), _entity);
+      key.name = nameComp->Data();
+    }
+  };
+
+  for (const Entity entity : this->dataPtr->childIndexPending)
+    reindex(entity);
+  this->dataPtr->childIndexPending.clear();
+
+  auto indexIt = this->dataPtr->childIndex.find(_parent);
+  if (indexIt == this->dataPtr->childIndex.end())
+    return {};
+
+  if (nullptr == _name)
+    return indexIt->second.children;
+
+  std::vector<Entity> result;
+  std::vector<Entity> stale;
+  auto range = indexIt->second.byName.equal_range(*_name);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    // Components modified in place without being marked as changed
+    auto nameComp = this->Component<components::Name>(it->second);
+    auto parentComp = this->Component<components::ParentEntity>(it->second);
+    if (!nameComp || nameComp->Data() != *_name ||
+        !parentComp || parentComp->Data() != _parent)
+    {
+      stale.push_back(it->second);
+      continue;
+    }
+    result.push_back(it->second);
+  }
+  for (const Entity entity : stale)
+    reindex(entity);
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+/////////////////////////////////////////////////
+uint64_t EntityComponentManager::ComponentVersion(const Entity _entity,
+    const ComponentTypeId _typeId) const
+{
+  auto entityIt = this->dataPtr->componentVersions.find(_entity);
+  if (entityIt == this->dataPtr->componentVersions.end())
+    return 0u;
+
+  auto typeIt = entityIt->second.find(_typeId);
+  if (typeIt == entityIt->second.end())
+    return 0u;
+
+  return typeIt->second;
+}
+
+/////////////////////////////////////////////////
+uint64_t EntityComponentManager::CurrentVersion() const
+{
+  return this->dataPtr->componentVersion;
+}
+
+/////////////////////////////////////////////////
+uint64_t EntityComponentManager::ComponentTypeVersion(
+    const ComponentTypeId _typeId) const
+{
+  auto typeIt = this->dataPtr->componentTypeVersions.find(_typeId);
+  if (typeIt == this->dataPtr->componentTypeVersions.end())
+    return 0u;
+
+  return typeIt->second;
+}
+
+/////////////////////////////////////////////////
+uint64_t EntityComponentManager::AddComponentObserver(
+    const ComponentTypeId _typeId, ComponentObserver _callback, Entity _root)
+{
+  const uint64_t id = ++this->dataPtr->lastObserverId;
+  auto &observer = this->dataPtr->observers[id];
+  observer.typeId = _typeId;
+  observer.root = _root;
+  observer.callback = std::move(_callback);
+  this->dataPtr->typeObservers[_typeId].push_back(&observer);
+  return id;
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::RemoveComponentObserver(uint64_t _id)
+{
+  auto iter = this->dataPtr->observers.find(_id);
+  if (iter == this->dataPtr->observers.end())
+    return false;
+
+  auto typeIter = this->dataPtr->typeObservers.find(iter->second.typeId);
+  auto &typeObservers = typeIter->second;
+  typeObservers.erase(std::remove(typeObservers.begin(), typeObservers.end(),
+      &iter->second), typeObservers.end());
+  if (typeObservers.empty())
+    this->dataPtr->typeObservers.erase(typeIter);
+
+  this->dataPtr->observers.erase(iter);
+  return true;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::NotifyComponentObservers()
+{
+  IGN_PROFILE("EntityComponentManager::NotifyComponentObservers");
+  using ObservedChange = EntityComponentManagerPrivate::ObservedChange;
+
+  // Callbacks may add or remove observers, so ids are collected first
+  std::vector<uint64_t> ids;
+  ids.reserve(this->dataPtr->observers.size());
+  for (const auto &observer : this->dataPtr->observers)
+  {
+    if (!observer.second.pending.empty())
+      ids.push_back(observer.first);
+  }
+
+  std::vector<std::pair<Entity, ObservedChange>> pending;
+  std::vector<Entity> order;
+  // An empty state means the changes cancelled out. Such entries are kept,
+  // so that each entity appears in order only once
+  std::unordered_map<Entity, std::optional<ObservedChange>> states;
+  for (const uint64_t id : ids)
+  {
+    auto iter = this->dataPtr->observers.find(id);
+    if (iter == this->dataPtr->observers.end())
+      continue;
+
+    // Changes made by callbacks go to the next batch
+    pending.clear();
+    pending.swap(iter->second.pending);
+
+    // Coalesce the changes of each entity
+    order.clear();
+    states.clear();
+    for (const auto &change : pending)
+    {
+      auto state = states.find(change.first);
+      if (state == states.end())
+      {
+        states.emplace(change.first, change.second);
+        order.push_back(change.first);
+      }
+      else if (!state->second)
+      {
+        state->second = change.second;
+      }
+      else if (state->second == ObservedChange::ADDED &&
+               change.second == ObservedChange::REMOVED)
+      {
+        state->second.reset();
+      }
+      else if (state->second == ObservedChange::REMOVED &&
+               change.second == ObservedChange::ADDED)
+      {
+        state->second = ObservedChange::CHANGED;
+      }
+      else if (change.second == ObservedChange::REMOVED)
+      {
+        state->second = ObservedChange::REMOVED;
+      }
+    }
+
+    const auto &observer = iter->second;
+    ComponentChanges changes;
+    changes.typeId = observer.typeId;
+    for (const Entity entity : order)
+    {
+      const auto &state = states.at(entity);
+      if (!state)
+        continue;
+
+      // Removals were filtered when recorded, since removed entities can't
+      // be located anymore
+      if (*state == ObservedChange::REMOVED)
+      {
+        changes.removed.push_back(entity);
+        continue;
+      }
+
+      if (!this->EntityHasComponentType(entity, observer.typeId) ||
+          !this->dataPtr->InSubtree(entity, observer.root))
+      {
+        continue;
+      }
+
+      if (*state == ObservedChange::ADDED)
+        changes.added.push_back(entity);
+      else
+        changes.changed.push_back(entity);
+    }
+
+    if (changes.added.empty() && changes.changed.empty() &&
+        changes.removed.empty())
+    {
+      continue;
+    }
+
+    // Copy the callback, in case it removes its own observer
+    auto callback = observer.callback;
+    callback(changes);
+  }
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::ChangedStateSince(
+    msgs::SerializedStateMap &_state, uint64_t _version,
+    const std::unordered_set<ComponentTypeId> &_types) const
+{
+  IGN_PROFILE("EntityComponentManager::ChangedStateSince");
+  for (const auto &entityIt : this->dataPtr->componentVersions)
+  {
+    msgs::SerializedEntityMap *entityMsg{nullptr};
+    for (const auto &typeIt : entityIt.second)
+    {
+      if (typeIt.second <= _version ||
+          (!_types.empty() && _types.find(typeIt.first) == _types.end()))
+      {
+        continue;
+      }
+
+      if (nullptr == entityMsg)
+      {
+        auto &entry =
+            (*_state.mutable_entities())[static_cast<uint64_t>(entityIt.first)];
+        entityMsg = &entry;
+        entityMsg->set_id(entityIt.first);
+      }
+
+      auto &compMsg = (*entityMsg->mutable_components())[
+          static_cast<int64_t>(typeIt.first)];
+      compMsg.set_type(typeIt.first);
+
+      const components::BaseComponent *compBase{nullptr};
+      if (!this->dataPtr->ComponentMarkedAsRemoved(entityIt.first,
+          typeIt.first))
+      {
+        compBase = this->ComponentImplementation(entityIt.first, typeIt.first);
       }
+
+      if (nullptr == compBase)
+      {
+        compMsg.set_remove(true);
+        continue;
+      }
+
+      SerializeComponent(compBase, compMsg.mutable_component(),
+          this->dataPtr->binarySerialization);
     }
   }
 }
 
-//////////////////////////////////////////////////
-std::unordered_set<Entity> EntityComponentManager::Descendants(Entity _entity)
-    const
+/////////////////////////////////////////////////
+std::unordered_set<ComponentTypeId> EntityComponentManager::ComponentTypes(
+    const Entity _entity) const
 {
-  // Check cache
-  if (this->dataPtr->descendantCache.find(_entity) !=
-      this->dataPtr->descendantCache.end())
+  auto it = this->dataPtr->componentTypeIndex.find(_entity);
+  if (it == this->dataPtr->componentTypeIndex.end())
+    return {};
+
+  std::unordered_set<ComponentTypeId> result;
+  for (const auto &type : it->second)
   {
-    return this->dataPtr->descendantCache[_entity];
+    if (!this->dataPtr->ComponentMarkedAsRemoved(_entity, type.first))
+      result.insert(type.first);
   }
 
-  std::unordered_set<Entity> descendants;
+  return result;
+}
 
-  if (!this->HasEntity(_entity))
-    return descendants;
+/////////////////////////////////////////////////
+void EntityComponentManager::EachComponentType(Entity _entity,
+    const std::function<bool(ComponentTypeId)> &_f) const
+{
+  auto it = this->dataPtr->componentTypeIndex.find(_entity);
+  if (it == this->dataPtr->componentTypeIndex.end())
+    return;
+
+  for (const auto &type : it->second)
+  {
+    if (!this->dataPtr->ComponentMarkedAsRemoved(_entity, type.first) &&
+        !_f(type.first))
+    {
+      return;
+    }
+  }
+}
 
-  auto descVector = math::graph::BreadthFirstSort(this->dataPtr->entities,
-      _entity);
-  std::move(descVector.begin(), descVector.end(), std::inserter(descendants,
-      descendants.end()));
+/////////////////////////////////////////////////
+void EntityComponentManager::SetEntityCreateOffset(uint64_t _offset)
+{
+  if (_offset < this->dataPtr->entityCount)
+  {
+    ignwarn << "Setting an entity offset of [" << _offset << "] is less than "
+     << "the current entity count of [" << this->dataPtr->entityCount << "]. "
+     << "Incorrect behavior should be expected.\n";
+  }
 
-  this->dataPtr->descendantCache[_entity] = descendants;
-  return descendants;
+  this->dataPtr->entityCount = _offset;
 }
 
-//////////////////////////////////////////////////
-void EntityComponentManager::SetAllComponentsUnchanged()
+/////////////////////////////////////////////////
+void EntityComponentManager::LockAddingEntitiesToViews(bool _lock)
 {
-  this->dataPtr->periodicChangedComponents.clear();
-  this->dataPtr->oneTimeChangedComponents.clear();
-  this->dataPtr->modifiedComponents.clear();
+  this->dataPtr->lockAddEntitiesToViews = _lock;
 }
 
 /////////////////////////////////////////////////
-void EntityComponentManager::SetChanged(
-    const Entity _entity, const ComponentTypeId _type,
-    gazebo::ComponentState _c)
+bool EntityComponentManager::LockAddingEntitiesToViews() const
 {
-  // make sure _entity exists
-  auto ecIter = this->dataPtr->componentTypeIndex.find(_entity);
-  if (ecIter == this->dataPtr->componentTypeIndex.end())
+  return this->dataPtr->lockAddEntitiesToViews;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::ParallelFor(std::size_t _count,
+    const std::function<void(std::size_t, std::size_t)> &_f,
+    std::size_t _minChunkSize) const
+{
+  IGN_PROFILE("EntityComponentManager::ParallelFor");
+
+  if (_count == 0u)
     return;
 
-  // make sure the entity has a component of type _type
-  if (ecIter->second.find(_type) == ecIter->second.end() ||
-      this->dataPtr->ComponentMarkedAsRemoved(_entity, _type))
+  // Below this many items per chunk, the cost of handing work to another
+  // thread outweighs the benefit. In deterministic mode, chunks don't depend
+  // on the number of threads.
+  const bool deterministic = this->dataPtr->deterministic;
+  const std::size_t chunkCount = std::min<std::size_t>(
+      deterministic ? kDeterministicChunks : this->dataPtr->maxThreads,
+      _count / std::max<std::size_t>(_minChunkSize, 1u));
+  if (chunkCount <= 1u)
+  {
+    _f(0u, _count);
     return;
+  }
 
-  if (_c == ComponentState::PeriodicChange)
+  const std::size_t chunkSize = (_count + chunkCount - 1u) / chunkCount;
+  const uint64_t parentKey = tTaskKey;
+  this->dataPtr->RunTasks(chunkCount, [&](std::size_t _chunk)
   {
-    this->dataPtr->periodicChangedComponents[_type].insert(_entity);
-    auto oneTimeIter = this->dataPtr->oneTimeChangedComponents.find(_type);
-    if (oneTimeIter != this->dataPtr->oneTimeChangedComponents.end())
-      oneTimeIter->second.erase(_entity);
+    const std::size_t begin = _chunk * chunkSize;
+    const std::size_t end = std::min(begin + chunkSize, _count);
+    if (begin >= end)
+      return;
+
+    if (!deterministic)
+    {
+      _f(begin, end);
+      return;
+    }
+
+    // Each chunk is a task of its own, since chunks run in any order and on
+    // any thread. Workers may run chunks of other calls while waiting, so
+    // restore the key they had.
+    const uint64_t prevKey = std::exchange(tTaskKey,
+        (parentKey << kTaskKeyBits) | (_chunk + 1u));
+    _f(begin, end);
+    tTaskKey = prevKey;
+  });
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::ParallelForEntities(const Entity *_entities,
+    std::size_t _count,
+    const std::function<void(std::size_t, std::size_t)> &_f) const
+{
+  const auto partitions = this->dataPtr->numaNodes.size();
+  if (partitions <= 1u || this->dataPtr->deterministic ||
+      this->dataPtr->maxThreads <= 1u)
+  {
+    this->ParallelFor(_count, _f);
+    return;
   }
-  else if (_c == ComponentState::OneTimeChange)
+
+  IGN_PROFILE("EntityComponentManager::ParallelForEntities");
+  if (_count == 0u)
+    return;
+
+  // Gather the runs of consecutive entities of each partition
+  std::vector<std::vector<std::pair<std::size_t, std::size_t>>> runs(
+      partitions);
+  std::vector<std::size_t> partitionSizes(partitions, 0u);
+  for (std::size_t begin = 0u; begin < _count;)
   {
-    auto periodicIter = this->dataPtr->periodicChangedComponents.find(_type);
-    if (periodicIter != this->dataPtr->periodicChangedComponents.end())
-      periodicIter->second.erase(_entity);
-    this->dataPtr->oneTimeChangedComponents[_type].insert(_entity);
+    const auto partition = numaPartition(_entities[begin], partitions);
+    std::size_t end = begin + 1u;
+    while (end < _count &&
+        numaPartition(_entities[end], partitions) == partition)
+    {
+      ++end;
+    }
+    runs[partition].emplace_back(begin, end);
+    partitionSizes[partition] += end - begin;
+    begin = end;
   }
-  else
+
+  // Split each partition's entities between the threads of its node, as
+  // ParallelFor would split them between all threads
+  constexpr std::size_t kMinChunkSize{32u};
+  const auto pool = this->dataPtr->WorkerPool();
+  const std::size_t threadsPerNode = std::max<std::size_t>(
+      std::min<std::size_t>(this->dataPtr->maxThreads, pool->ThreadCount()) /
+      partitions, 1u);
+
+  struct Chunk
   {
-    auto periodicIter = this->dataPtr->periodicChangedComponents.find(_type);
-    if (periodicIter != this->dataPtr->periodicChangedComponents.end())
-      periodicIter->second.erase(_entity);
-    auto oneTimeIter = this->dataPtr->oneTimeChangedComponents.find(_type);
-    if (oneTimeIter != this->dataPtr->oneTimeChangedComponents.end())
-      oneTimeIter->second.erase(_entity);
+    unsigned int partition;
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+  };
+  std::vector<Chunk> chunks;
+  for (std::size_t p = 0u; p < partitions; ++p)
+  {
+    if (partitionSizes[p] == 0u)
+      continue;
 
-    // the component state is flagged as no change, so don't mark the
-    // corresponding entity as one with a modified component
+    const std::size_t chunkCount = std::clamp<std::size_t>(
+        partitionSizes[p] / kMinChunkSize, 1u, threadsPerNode);
+    const std::size_t chunkSize =
+        (partitionSizes[p] + chunkCount - 1u) / chunkCount;
+
+    Chunk chunk{static_cast<unsigned int>(p), {}};
+    std::size_t filled{0u};
+    for (auto [begin, end] : runs[p])
+    {
+      while (begin < end)
+      {
+        const auto take = std::min(end - begin, chunkSize - filled);
+        chunk.ranges.emplace_back(begin, begin + take);
+        begin += take;
+        filled += take;
+        if (filled == chunkSize)
+        {
+          chunks.push_back(std::move(chunk));
+          chunk = Chunk{static_cast<unsigned int>(p), {}};
+          filled = 0u;
+        }
+      }
+    }
+    if (!chunk.ranges.empty())
+      chunks.push_back(std::move(chunk));
+  }
+
+  if (chunks.size() == 1u)
+  {
+    for (const auto &range : chunks[0].ranges)
+      _f(range.first, range.second);
     return;
   }
 
-  this->dataPtr->AddModifiedComponent(_entity);
+  pool->RunOnNodes(chunks.size(), [&](std::size_t _chunk)
+  {
+    return chunks[_chunk].partition;
+  },
+  [&](std::size_t _chunk)
+  {
+    for (const auto &range : chunks[_chunk].ranges)
+      _f(range.first, range.second);
+  });
 }
 
 /////////////////////////////////////////////////
-std::unordered_set<ComponentTypeId> EntityComponentManager::ComponentTypes(
-    const Entity _entity) const
+void EntityComponentManager::SetNumaNodes(
+    const std::vector<unsigned int> &_nodes)
 {
-  auto it = this->dataPtr->componentTypeIndex.find(_entity);
-  if (it == this->dataPtr->componentTypeIndex.end())
-    return {};
+  this->dataPtr->numaNodes = _nodes;
 
-  std::unordered_set<ComponentTypeId> result;
-  for (const auto &type : it->second)
+  // Pools which already hold components keep their layout
+  for (auto &[typeId, typePool] : this->dataPtr->componentPools)
   {
-    if (!this->dataPtr->ComponentMarkedAsRemoved(_entity, type.first))
-      result.insert(type.first);
+    if (nullptr != typePool.pool && !typePool.pool->SetNumaNodes(_nodes))
+    {
+      igndbg << "Components of type [" << typeId << "] were created before "
+             << "NUMA nodes were set, they won't be partitioned."
+             << std::endl;
+    }
   }
+}
 
-  return result;
+/////////////////////////////////////////////////
+const std::vector<unsigned int> &EntityComponentManager::NumaNodes() const
+{
+  return this->dataPtr->numaNodes;
 }
 
 /////////////////////////////////////////////////
-void EntityComponentManager::SetEntityCreateOffset(uint64_t _offset)
+unsigned int EntityComponentManager::NumaPartition(const Entity _entity) const
 {
-  if (_offset < this->dataPtr->entityCount)
+  return numaPartition(_entity, this->dataPtr->numaNodes.size());
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::SetMaxThreads(unsigned int _count)
+{
+  if (_count == 0u)
+    _count = std::max(std::thread::hardware_concurrency(), 1u);
+
+  if (_count == this->dataPtr->maxThreads)
+    return;
+
+  this->dataPtr->maxThreads = _count;
+
+  // State splits its work once per change of the entities, so make it split
+  // again
+  this->dataPtr->componentTypeIndexDirty = true;
+
+  // Let the pool be recreated with the new size, unless it's external
+  std::lock_guard<std::mutex> lock(this->dataPtr->workerPoolMutex);
+  if (!this->dataPtr->externalWorkerPool)
+    this->dataPtr->workerPool.reset();
+}
+
+/////////////////////////////////////////////////
+unsigned int EntityComponentManager::MaxThreads() const
+{
+  return this->dataPtr->maxThreads;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::SetDeterministic(bool _deterministic)
+{
+  this->dataPtr->deterministic = _deterministic;
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::Deterministic() const
+{
+  return this->dataPtr->deterministic;
+}
+
+/////////////////////////////////////////////////
+uint64_t EntityComponentManager::TaskSeed(uint64_t _seed) const
+{
+  // SplitMix64 finalizer, so that close seeds and keys give unrelated
+  // sequences
+  uint64_t z = _seed + (tTaskKey + 1u) * 0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30u)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27u)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31u);
+}
+
+/////////////////////////////////////////////////
+uint64_t EntityComponentManager::StateHash() const
+{
+  IGN_PROFILE("EntityComponentManager::StateHash");
+  msgs::SerializedStateMap msg;
+  this->State(msg, {}, {}, true);
+
+  // Maps are serialized sorted by key, so the bytes only depend on the
+  // state, not on the order entities and components were added in
+  std::string bytes;
   {
-    ignwarn << "Setting an entity offset of [" << _offset << "] is less than "
-     << "the current entity count of [" << this->dataPtr->entityCount << "]. "
-     << "Incorrect behavior should be expected.\n";
+    google::protobuf::io::StringOutputStream stringStream(&bytes);
+    google::protobuf::io::CodedOutputStream codedStream(&stringStream);
+    codedStream.SetSerializationDeterministic(true);
+    msg.SerializeToCodedStream(&codedStream);
   }
 
-  this->dataPtr->entityCount = _offset;
+  // 64 bit FNV-1a
+  uint64_t hash{0xCBF29CE484222325ull};
+  for (const char c : bytes)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
 }
 
 /////////////////////////////////////////////////
-void EntityComponentManager::LockAddingEntitiesToViews(bool _lock)
+uint64_t EntityComponentManager::SwapTaskKey(uint64_t _key)
 {
-  this->dataPtr->lockAddEntitiesToViews = _lock;
+  return std::exchange(tTaskKey, _key);
 }
 
 /////////////////////////////////////////////////
-bool EntityComponentManager::LockAddingEntitiesToViews() const
+void EntityComponentManager::SetWorkerPool(
+    std::shared_ptr<WorkStealingPool> _pool)
 {
-  return this->dataPtr->lockAddEntitiesToViews;
+  std::lock_guard<std::mutex> lock(this->dataPtr->workerPoolMutex);
+  this->dataPtr->externalWorkerPool = nullptr != _pool;
+  this->dataPtr->workerPool = std::move(_pool);
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<WorkStealingPool> EntityComponentManagerPrivate::WorkerPool()
+{
+  std::lock_guard<std::mutex> lock(this->workerPoolMutex);
+  if (nullptr == this->workerPool)
+    this->workerPool = std::make_shared<WorkStealingPool>(this->maxThreads);
+  return this->workerPool;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::RunTasks(std::size_t _count,
+    const std::function<void(std::size_t)> &_task)
+{
+  if (_count <= 1u || this->maxThreads <= 1u)
+  {
+    for (std::size_t i = 0u; i < _count; ++i)
+      _task(i);
+    return;
+  }
+
+  this->WorkerPool()->Run(_count, _task);
 }
 
 /////////////////////////////////////////////////
@@ -2021,6 +4958,83 @@ bool EntityComponentManagerPrivate::ComponentMarkedAsRemoved(
   return false;
 }
 
+/////////////////////////////////////////////////
+std::size_t EntityComponentManagerPrivate::ComponentTypeBit(
+    const ComponentTypeId _typeId)
+{
+  auto [iter, inserted] = this->componentTypeBits.emplace(_typeId,
+      this->componentTypeBits.size());
+
+  // Signatures of views requiring this type were built without its bit
+  if (inserted)
+    this->viewSignatures.clear();
+
+  return iter->second;
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManagerPrivate::TypesSignature(
+    const std::set<ComponentTypeId> &_types,
+    ComponentSignature &_signature) const
+{
+  for (const ComponentTypeId type : _types)
+  {
+    auto iter = this->componentTypeBits.find(type);
+    if (iter == this->componentTypeBits.end())
+      return false;
+    _signature.Set(iter->second);
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+const ComponentSignature &EntityComponentManagerPrivate::ViewSignature(
+    const detail::BaseView *_view)
+{
+  auto iter = this->viewSignatures.find(_view);
+  if (iter != this->viewSignatures.end())
+    return iter->second;
+
+  // Assign bits first, since assigning one clears the cache
+  ComponentSignature signature;
+  for (const ComponentTypeId type : _view->ComponentTypes())
+    signature.Set(this->ComponentTypeBit(type));
+
+  return this->viewSignatures.emplace(_view, std::move(signature))
+      .first->second;
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManagerPrivate::EntityMatchesSignature(
+    const Entity _entity, const ComponentSignature &_signature) const
+{
+  auto iter = this->entitySignatures.find(_entity);
+  return iter != this->entitySignatures.end() &&
+      iter->second.Contains(_signature);
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::UpdateSignature(const Entity _entity,
+    const ComponentTypeId _typeId, bool _present)
+{
+  auto iter = this->entitySignatures.find(_entity);
+  if (iter == this->entitySignatures.end())
+    return;
+
+  if (_present)
+  {
+    iter->second.Set(this->ComponentTypeBit(_typeId));
+    this->typeEntities[_typeId].insert(_entity);
+  }
+  else
+  {
+    iter->second.Reset(this->ComponentTypeBit(_typeId));
+    auto typeIter = this->typeEntities.find(_typeId);
+    if (typeIter != this->typeEntities.end())
+      typeIter->second.erase(_entity);
+  }
+}
+
 /////////////////////////////////////////////////
 template<typename ComponentTypeT>
 bool EntityComponentManagerPrivate::ClonedJointLinkName(Entity _joint,
@@ -2069,6 +5083,65 @@ bool EntityComponentManagerPrivate::ClonedJointLinkName(Entity _joint,
   return true;
 }
 
+/////////////////////////////////////////////////
+ComponentPtr EntityComponentManagerPrivate::NewComponent(const Entity _entity,
+    const ComponentTypeId _typeId, const components::BaseComponent *_data)
+{
+  auto factory = components::Factory::Instance();
+
+  if (nullptr != _data && _typeId != _data->TypeId())
+  {
+    ignerr << "The typeID of _type [" << _typeId << "] does not match the "
+      << "typeID of _data [" << _data->TypeId() << "]." << std::endl;
+    return nullptr;
+  }
+
+  auto poolIter = this->componentPools.find(_typeId);
+  if (poolIter == this->componentPools.end())
+  {
+    ComponentTypePool typePool;
+    typePool.factoryIndex = factory->TypeIndex(_typeId);
+    auto size = factory->ComponentSize(_typeId);
+    if (size > 0u)
+    {
+      typePool.pool = std::make_unique<ComponentPool>(size,
+          factory->ComponentAlignment(_typeId));
+      typePool.pool->SetNumaNodes(this->numaNodes);
+    }
+    poolIter = this->componentPools.emplace(_typeId,
+        std::move(typePool)).first;
+  }
+
+  // The type may have been registered after its first use
+  if (components::Factory::kInvalidTypeIndex == poolIter->second.factoryIndex)
+    poolIter->second.factoryIndex = factory->TypeIndex(_typeId);
+
+  // The descriptor is looked up every time, because it may change when
+  // libraries registering the type are unloaded
+  auto descriptor = factory->Descriptor(poolIter->second.factoryIndex);
+  if (nullptr == descriptor)
+    return nullptr;
+
+  // Types without a placement, for example those registered with a custom
+  // descriptor, are created on the heap by their descriptor. So are types
+  // registered again with a placement which doesn't fit the pool's slots.
+  auto pool = poolIter->second.pool.get();
+  auto placement = factory->Placement(poolIter->second.factoryIndex);
+  if (nullptr != pool && nullptr != placement &&
+      placement->size <= pool->Stride() &&
+      placement->alignment <= pool->Alignment())
+  {
+    auto memory = pool->Allocate(
+        numaPartition(_entity, this->numaNodes.size()));
+    return ComponentPtr(placement->construct(memory, _data),
+        ComponentDeleter{pool});
+  }
+
+  auto comp = nullptr == _data ? descriptor->Create() :
+      descriptor->Create(_data);
+  return ComponentPtr(comp.release(), ComponentDeleter{nullptr});
+}
+
 /////////////////////////////////////////////////
 void EntityComponentManager::PinEntity(const Entity _entity, bool _recursive)
 {
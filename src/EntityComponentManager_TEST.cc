@@ -17,6 +17,18 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
 #include <ignition/math/Pose3.hh>
@@ -33,6 +45,7 @@
 #include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/ParentLinkName.hh"
 #include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/Static.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 #include "ignition/gazebo/config.hh"
 #include "../test/helpers/EnvTestFixture.hh"
@@ -83,6 +96,15 @@ struct Custom
 using CustomComponent = Component<Custom, class CustomTag>;
 IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.CustomComponent",
     CustomComponent)
+
+struct alignas(64) OverAligned
+{
+  double value{0.0};
+};
+
+using OverAlignedComponent = Component<OverAligned, class OverAlignedTag>;
+IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.OverAlignedComponent",
+    OverAlignedComponent)
 }
 }
 }
@@ -98,6 +120,10 @@ class EntityCompMgrTest : public EntityComponentManager
   {
     this->ProcessRemoveEntityRequests();
   }
+  public: void RunApplyCommandBuffers()
+  {
+    this->ApplyCommandBuffers();
+  }
   public: void RunSetAllComponentsUnchanged()
   {
     this->SetAllComponentsUnchanged();
@@ -106,6 +132,14 @@ class EntityCompMgrTest : public EntityComponentManager
   {
     this->ClearRemovedComponents();
   }
+  public: void RunNotifyComponentObservers()
+  {
+    this->NotifyComponentObservers();
+  }
+  public: void RunRemoveUndemandedComponents()
+  {
+    this->RemoveUndemandedComponents();
+  }
 };
 
 class EntityComponentManagerFixture
@@ -3254,7 +3288,1964 @@ TEST_P(EntityComponentManagerFixture,
   EXPECT_EQ(321, comp->Data());
 }
 
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, SerializeReusedMessages)
+{
+  Entity e1 = manager.CreateEntity();
+  manager.CreateComponent<DoubleComponent>(e1, DoubleComponent(0.123456789));
+  manager.CreateComponent<IntComponent>(e1, IntComponent(42));
+
+  // Serialized data matches a fresh std::ostringstream, and doesn't depend on
+  // what was serialized before
+  std::ostringstream expectedDouble;
+  expectedDouble << 0.123456789;
+
+  msgs::SerializedStateMap stateMap;
+  for (int i = 0; i < 3; ++i)
+  {
+    stateMap.Clear();
+    manager.State(stateMap, {}, {}, true);
+    ASSERT_EQ(1, stateMap.entities_size());
+    const auto &entityMsg = stateMap.entities().at(e1);
+    EXPECT_EQ(e1, entityMsg.id());
+    ASSERT_EQ(2, entityMsg.components_size());
+    EXPECT_EQ(expectedDouble.str(), entityMsg.components().at(
+        static_cast<int64_t>(DoubleComponent::typeId)).component());
+    EXPECT_EQ("42", entityMsg.components().at(
+        static_cast<int64_t>(IntComponent::typeId)).component());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, StateFewEntities)
+{
+  // Many more entities than requested, so they're visited directly
+  manager.SetMaxThreads(2u);
+  const int count{100};
+  std::vector<Entity> entities;
+  for (int i = 0; i < count; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent<IntComponent>(entity, IntComponent(i));
+    entities.push_back(entity);
+  }
+  manager.RunSetAllComponentsUnchanged();
+
+  // Full state of the requested entities only, ignoring unknown ones
+  msgs::SerializedStateMap stateMap;
+  manager.State(stateMap, {entities[3], entities[50], kNullEntity}, {}, true);
+  ASSERT_EQ(2, stateMap.entities_size());
+  EXPECT_EQ("3", stateMap.entities().at(entities[3]).components().at(
+      static_cast<int64_t>(IntComponent::typeId)).component());
+  EXPECT_EQ("50", stateMap.entities().at(entities[50]).components().at(
+      static_cast<int64_t>(IntComponent::typeId)).component());
+
+  // Only changed components are included otherwise
+  manager.SetChanged(entities[50], IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  stateMap.Clear();
+  manager.State(stateMap, {entities[3], entities[50]});
+  ASSERT_EQ(1, stateMap.entities_size());
+  EXPECT_EQ(1u, stateMap.entities().count(entities[50]));
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, SetStateMany)
+{
+  // Enough components to be deserialized across threads
+  const int count{500};
+  EntityCompMgrTest original;
+  Entity root = original.CreateEntity();
+  original.CreateComponent<IntComponent>(root, IntComponent(-1));
+  std::vector<Entity> children;
+  for (int i = 0; i < count; ++i)
+  {
+    Entity child = original.CreateEntity();
+    original.CreateComponent<IntComponent>(child, IntComponent(i));
+    original.CreateComponent<DoubleComponent>(child, DoubleComponent(i * 0.5));
+    original.CreateComponent<ParentEntity>(child, ParentEntity(root));
+    children.push_back(child);
+  }
+
+  msgs::SerializedStateMap stateMap;
+  original.State(stateMap, {}, {}, true);
+
+  // New entities and components are created
+  manager.SetState(stateMap);
+  EXPECT_EQ(count + 1u, manager.EntityCount());
+  for (int i = 0; i < count; ++i)
+  {
+    Entity child = children[i];
+    auto intComp = manager.Component<IntComponent>(child);
+    ASSERT_NE(nullptr, intComp);
+    EXPECT_EQ(i, intComp->Data());
+    auto doubleComp = manager.Component<DoubleComponent>(child);
+    ASSERT_NE(nullptr, doubleComp);
+    EXPECT_DOUBLE_EQ(i * 0.5, doubleComp->Data());
+    EXPECT_EQ(root, manager.ParentEntity(child));
+  }
+  EXPECT_EQ(static_cast<std::size_t>(count),
+      manager.Descendants(root).size() - 1u);
+
+  // Existing components are updated
+  for (int i = 0; i < count; ++i)
+  {
+    original.Component<IntComponent>(children[i])->Data() = i * 2;
+  }
+  manager.RunSetAllComponentsUnchanged();
+  stateMap.Clear();
+  original.State(stateMap, {}, {IntComponent::typeId}, true);
+  manager.SetState(stateMap);
+  for (int i = 0; i < count; ++i)
+  {
+    EXPECT_EQ(i * 2, manager.Component<IntComponent>(children[i])->Data());
+    EXPECT_EQ(ComponentState::PeriodicChange,
+        manager.ComponentState(children[i], IntComponent::typeId));
+    EXPECT_EQ(ComponentState::NoChange,
+        manager.ComponentState(children[i], DoubleComponent::typeId));
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, SetStagedState)
+{
+  EntityCompMgrTest original;
+  Entity root = original.CreateEntity();
+  original.CreateComponent<IntComponent>(root, IntComponent(-1));
+  Entity child = original.CreateEntity();
+  original.CreateComponent<IntComponent>(child, IntComponent(1));
+  original.CreateComponent<DoubleComponent>(child, DoubleComponent(0.5));
+  original.CreateComponent<ParentEntity>(child, ParentEntity(root));
+
+  msgs::SerializedStateMap stateMap;
+  original.State(stateMap, {}, {}, true);
+
+  // Staging doesn't touch any ECM
+  auto staged = EntityComponentManager::StageState(stateMap);
+  EXPECT_FALSE(staged.Empty());
+  EXPECT_EQ(0u, manager.EntityCount());
+
+  // New entities and components are created
+  manager.SetState(staged);
+  EXPECT_EQ(2u, manager.EntityCount());
+  ASSERT_NE(nullptr, manager.Component<IntComponent>(child));
+  EXPECT_EQ(1, manager.Component<IntComponent>(child)->Data());
+  ASSERT_NE(nullptr, manager.Component<DoubleComponent>(child));
+  EXPECT_DOUBLE_EQ(0.5, manager.Component<DoubleComponent>(child)->Data());
+  EXPECT_EQ(root, manager.ParentEntity(child));
+
+  // Existing components are updated, and removed ones are removed
+  original.Component<IntComponent>(child)->Data() = 2;
+  original.RemoveComponent<DoubleComponent>(child);
+  manager.RunSetAllComponentsUnchanged();
+  stateMap.Clear();
+  original.State(stateMap, {}, {}, true);
+  staged = EntityComponentManager::StageState(stateMap);
+  manager.SetState(staged);
+  EXPECT_EQ(2, manager.Component<IntComponent>(child)->Data());
+  EXPECT_EQ(nullptr, manager.Component<DoubleComponent>(child));
+
+  // Moved from states are empty
+  StagedState moved(std::move(staged));
+  EXPECT_TRUE(staged.Empty());
+  EXPECT_TRUE(StagedState().Empty());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, StageStateReusingComponents)
+{
+  EntityCompMgrTest original;
+  Entity e1 = original.CreateEntity();
+  original.CreateComponent<IntComponent>(e1, IntComponent(1));
+  original.CreateComponent<DoubleComponent>(e1, DoubleComponent(0.5));
+
+  msgs::SerializedStateMap stateMap;
+  original.State(stateMap, {}, {}, true);
+
+  StagedState staged;
+  EntityComponentManager::StageState(stateMap, staged);
+  manager.SetState(staged);
+  EXPECT_EQ(1, manager.Component<IntComponent>(e1)->Data());
+  EXPECT_DOUBLE_EQ(0.5, manager.Component<DoubleComponent>(e1)->Data());
+
+  // Staging into the applied state overwrites it, and data already moved
+  // into the manager isn't affected by the reused components
+  original.Component<IntComponent>(e1)->Data() = 2;
+  Entity e2 = original.CreateEntity();
+  original.CreateComponent<IntComponent>(e2, IntComponent(3));
+  original.RemoveComponent<DoubleComponent>(e1);
+  stateMap.Clear();
+  original.State(stateMap, {}, {}, true);
+  EntityComponentManager::StageState(stateMap, staged);
+  EXPECT_EQ(1, manager.Component<IntComponent>(e1)->Data());
+
+  manager.RunSetAllComponentsUnchanged();
+  manager.SetState(staged);
+  EXPECT_EQ(2u, manager.EntityCount());
+  EXPECT_EQ(2, manager.Component<IntComponent>(e1)->Data());
+  EXPECT_EQ(nullptr, manager.Component<DoubleComponent>(e1));
+  ASSERT_NE(nullptr, manager.Component<IntComponent>(e2));
+  EXPECT_EQ(3, manager.Component<IntComponent>(e2)->Data());
+
+  // States which weren't applied can be staged into as well
+  original.Component<IntComponent>(e2)->Data() = 4;
+  stateMap.Clear();
+  original.State(stateMap, {}, {}, true);
+  EntityComponentManager::StageState(stateMap, staged);
+  original.Component<IntComponent>(e2)->Data() = 5;
+  stateMap.Clear();
+  original.State(stateMap, {}, {}, true);
+  EntityComponentManager::StageState(stateMap, staged);
+  manager.SetState(staged);
+  EXPECT_EQ(5, manager.Component<IntComponent>(e2)->Data());
+
+  // Moved from states can be staged into
+  StagedState moved(std::move(staged));
+  EntityComponentManager::StageState(stateMap, staged);
+  EXPECT_FALSE(staged.Empty());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, MaxThreads)
+{
+  EXPECT_LE(1u, manager.MaxThreads());
+
+  const int count{300};
+  for (int i = 0; i < count; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent<IntComponent>(entity, IntComponent(i));
+  }
+
+  // The same state is generated no matter how many threads are used
+  for (unsigned int threads : {1u, 2u, 7u, 0u})
+  {
+    manager.SetMaxThreads(threads);
+    EXPECT_LE(1u, manager.MaxThreads());
+    if (threads > 0u)
+      EXPECT_EQ(threads, manager.MaxThreads());
+
+    for (int repeat = 0; repeat < 3; ++repeat)
+    {
+      msgs::SerializedStateMap stateMap;
+      manager.State(stateMap, {}, {}, true);
+      ASSERT_EQ(count, stateMap.entities_size());
+
+      int sum{0};
+      for (const auto &entity : stateMap.entities())
+      {
+        sum += std::stoi(entity.second.components().at(
+            static_cast<int64_t>(IntComponent::typeId)).component());
+      }
+      EXPECT_EQ(count * (count - 1) / 2, sum);
+    }
+
+    std::atomic<int> visited{0};
+    manager.EachParallel<IntComponent>(
+        [&](const Entity &, const IntComponent *) -> bool
+        {
+          ++visited;
+          return true;
+        });
+    EXPECT_EQ(count, visited.load());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ParallelFor)
+{
+  const int count{500};
+  std::vector<Entity> entities;
+  for (int i = 0; i < count; ++i)
+  {
+    entities.push_back(manager.CreateEntity());
+    manager.CreateComponent<IntComponent>(entities.back(), IntComponent(i));
+  }
+
+  // Nothing to do
+  manager.ParallelFor(0u, [](std::size_t, std::size_t)
+      {
+        FAIL() << "Callback shouldn't be called for an empty range";
+      });
+
+  for (unsigned int threads : {1u, 4u})
+  {
+    manager.SetMaxThreads(threads);
+
+    // Every index is visited exactly once, and existing components can be
+    // written to from the chunks
+    std::atomic<int> visited{0};
+    manager.ParallelFor(entities.size(),
+        [&](std::size_t _begin, std::size_t _end)
+        {
+          EXPECT_LT(_begin, _end);
+          for (std::size_t i = _begin; i < _end; ++i)
+          {
+            auto comp = manager.Component<IntComponent>(entities[i]);
+            ASSERT_NE(nullptr, comp);
+            comp->Data() += 1;
+            ++visited;
+          }
+        });
+    EXPECT_EQ(count, visited.load());
+  }
+
+  // Expensive items can be split one per chunk
+  std::atomic<int> chunks{0};
+  manager.ParallelFor(4u, [&](std::size_t _begin, std::size_t _end)
+      {
+        EXPECT_EQ(_begin + 1u, _end);
+        ++chunks;
+      }, 1u);
+  EXPECT_EQ(4, chunks.load());
+
+  for (int i = 0; i < count; ++i)
+  {
+    EXPECT_EQ(i + 2,
+        manager.Component<IntComponent>(entities[i])->Data());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, NumaNodes)
+{
+  EXPECT_TRUE(manager.NumaNodes().empty());
+  EXPECT_EQ(0u, manager.NumaPartition(1000u));
+
+  // Nodes are set before components are created, so their storage is
+  // partitioned
+  manager.SetNumaNodes({0u, 0u});
+  ASSERT_EQ(2u, manager.NumaNodes().size());
+
+  const int count{1000};
+  std::vector<Entity> entities;
+  for (int i = 0; i < count; ++i)
+  {
+    entities.push_back(manager.CreateEntity());
+    manager.CreateComponent<IntComponent>(entities.back(), IntComponent(i));
+  }
+
+  // Ranges of ids alternate between partitions
+  std::set<unsigned int> partitions;
+  for (auto entity : entities)
+  {
+    EXPECT_GT(2u, manager.NumaPartition(entity));
+    EXPECT_EQ(manager.NumaPartition(entity),
+        manager.NumaPartition(entity - entity % 256u));
+    partitions.insert(manager.NumaPartition(entity));
+  }
+  EXPECT_EQ(2u, partitions.size());
+
+  // Every entity is still visited exactly once
+  for (unsigned int threads : {1u, 4u})
+  {
+    manager.SetMaxThreads(threads);
+    std::mutex mutex;
+    std::set<Entity> visited;
+    std::atomic<int> sum{0};
+    manager.EachParallel<IntComponent>(
+        [&](const Entity &_entity, const IntComponent *_int) -> bool
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          EXPECT_TRUE(visited.insert(_entity).second);
+          sum += _int->Data();
+          return true;
+        });
+    EXPECT_EQ(static_cast<std::size_t>(count), visited.size());
+    EXPECT_EQ(count * (count - 1) / 2, sum.load());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ComponentVersions)
+{
+  EXPECT_EQ(0u, manager.CurrentVersion());
+
+  Entity e1 = manager.CreateEntity();
+  Entity e2 = manager.CreateEntity();
+  EXPECT_EQ(0u, manager.ComponentVersion(e1, IntComponent::typeId));
+
+  manager.CreateComponent<IntComponent>(e1, IntComponent(1));
+  manager.CreateComponent<DoubleComponent>(e1, DoubleComponent(1.0));
+  manager.CreateComponent<IntComponent>(e2, IntComponent(2));
+
+  auto v1Int = manager.ComponentVersion(e1, IntComponent::typeId);
+  auto v1Double = manager.ComponentVersion(e1, DoubleComponent::typeId);
+  auto v2Int = manager.ComponentVersion(e2, IntComponent::typeId);
+  EXPECT_LT(0u, v1Int);
+  EXPECT_LT(v1Int, v1Double);
+  EXPECT_LT(v1Double, v2Int);
+  EXPECT_EQ(v2Int, manager.CurrentVersion());
+
+  // Latest version of each type
+  EXPECT_EQ(v2Int, manager.ComponentTypeVersion(IntComponent::typeId));
+  EXPECT_EQ(v1Double, manager.ComponentTypeVersion(DoubleComponent::typeId));
+  EXPECT_EQ(0u, manager.ComponentTypeVersion(StringComponent::typeId));
+
+  // Versions survive the end of the iteration
+  manager.RunSetAllComponentsUnchanged();
+  const auto checkpoint = manager.CurrentVersion();
+  EXPECT_EQ(v1Int, manager.ComponentVersion(e1, IntComponent::typeId));
+
+  msgs::SerializedStateMap stateMap;
+  manager.ChangedStateSince(stateMap, checkpoint);
+  EXPECT_EQ(0, stateMap.entities_size());
+
+  // Only the changed component is serialized
+  manager.Component<IntComponent>(e2)->Data() = 3;
+  manager.SetChanged(e2, IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  EXPECT_LT(checkpoint, manager.ComponentVersion(e2, IntComponent::typeId));
+  EXPECT_EQ(v1Int, manager.ComponentVersion(e1, IntComponent::typeId));
+  EXPECT_EQ(manager.ComponentVersion(e2, IntComponent::typeId),
+      manager.ComponentTypeVersion(IntComponent::typeId));
+  EXPECT_EQ(v1Double, manager.ComponentTypeVersion(DoubleComponent::typeId));
+
+  // Setting no change doesn't bump the version
+  const auto beforeNoChange = manager.CurrentVersion();
+  manager.SetChanged(e1, IntComponent::typeId, ComponentState::NoChange);
+  EXPECT_EQ(beforeNoChange, manager.CurrentVersion());
+
+  manager.ChangedStateSince(stateMap, checkpoint);
+  ASSERT_EQ(1, stateMap.entities_size());
+  {
+    const auto &entityMsg = stateMap.entities().at(e2);
+    ASSERT_EQ(1, entityMsg.components_size());
+    const auto &compMsg = entityMsg.components().at(
+        static_cast<int64_t>(IntComponent::typeId));
+    EXPECT_EQ("3", compMsg.component());
+    EXPECT_FALSE(compMsg.remove());
+  }
+
+  // Removed components are reported as removed
+  stateMap.Clear();
+  EXPECT_TRUE(manager.RemoveComponent<DoubleComponent>(e1));
+  manager.ChangedStateSince(stateMap, checkpoint);
+  ASSERT_EQ(2, stateMap.entities_size());
+  {
+    const auto &entityMsg = stateMap.entities().at(e1);
+    ASSERT_EQ(1, entityMsg.components_size());
+    EXPECT_TRUE(entityMsg.components().at(
+        static_cast<int64_t>(DoubleComponent::typeId)).remove());
+  }
+
+  // Filter by type
+  stateMap.Clear();
+  manager.ChangedStateSince(stateMap, checkpoint, {IntComponent::typeId});
+  ASSERT_EQ(1, stateMap.entities_size());
+  EXPECT_EQ(1u, stateMap.entities().count(e2));
+
+  // Removed entities are forgotten
+  manager.RequestRemoveEntity(e2);
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(0u, manager.ComponentVersion(e2, IntComponent::typeId));
+  EXPECT_LT(checkpoint, manager.ComponentTypeVersion(IntComponent::typeId));
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ChangedStateFiltered)
+{
+  Entity e1 = manager.CreateEntity();
+  Entity e2 = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(e1, IntComponent(1));
+  manager.CreateComponent<DoubleComponent>(e1, DoubleComponent(1.0));
+  manager.CreateComponent<IntComponent>(e2, IntComponent(2));
+
+  // New entities are complete, even if their types weren't requested
+  msgs::SerializedStateMap stateMap;
+  manager.ChangedState(stateMap, {e1}, {IntComponent::typeId});
+  ASSERT_EQ(1, stateMap.entities_size());
+  EXPECT_EQ(2, stateMap.entities().at(e1).components_size());
+
+  manager.RunClearNewlyCreatedEntities();
+  manager.RunSetAllComponentsUnchanged();
+
+  manager.Component<IntComponent>(e1)->Data() = 3;
+  manager.SetChanged(e1, IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  manager.Component<DoubleComponent>(e1)->Data() = 3.0;
+  manager.SetChanged(e1, DoubleComponent::typeId,
+      ComponentState::PeriodicChange);
+  manager.Component<IntComponent>(e2)->Data() = 4;
+  manager.SetChanged(e2, IntComponent::typeId,
+      ComponentState::OneTimeChange);
+
+  // Only the requested types of existing entities are serialized
+  stateMap.Clear();
+  manager.ChangedState(stateMap, {}, {DoubleComponent::typeId});
+  ASSERT_EQ(1, stateMap.entities_size());
+  {
+    const auto &entityMsg = stateMap.entities().at(e1);
+    ASSERT_EQ(1, entityMsg.components_size());
+    EXPECT_EQ(1u, entityMsg.components().count(
+        static_cast<int64_t>(DoubleComponent::typeId)));
+  }
+
+  // Only the requested entities are serialized
+  stateMap.Clear();
+  manager.ChangedState(stateMap, {e2}, {});
+  ASSERT_EQ(1, stateMap.entities_size());
+  EXPECT_EQ("4", stateMap.entities().at(e2).components().at(
+      static_cast<int64_t>(IntComponent::typeId)).component());
+
+  // Removals of requested entities are reported
+  manager.RequestRemoveEntity(e2);
+  stateMap.Clear();
+  manager.ChangedState(stateMap, {e2}, {DoubleComponent::typeId});
+  ASSERT_EQ(1, stateMap.entities_size());
+  EXPECT_TRUE(stateMap.entities().at(e2).remove());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EachChanged)
+{
+  Entity e1 = manager.CreateEntity();
+  Entity e2 = manager.CreateEntity();
+  Entity e3 = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(e1, IntComponent(1));
+  manager.CreateComponent<DoubleComponent>(e1, DoubleComponent(1.0));
+  manager.CreateComponent<IntComponent>(e2, IntComponent(2));
+  manager.CreateComponent<IntComponent>(e3, IntComponent(3));
+
+  auto changed = [&]()
+  {
+    std::set<Entity> entities;
+    manager.EachChanged<IntComponent>(
+        [&](const Entity &_entity, const IntComponent *_int) -> bool
+        {
+          EXPECT_NE(nullptr, _int);
+          entities.insert(_entity);
+          return true;
+        });
+    return entities;
+  };
+
+  // New components count as changed
+  EXPECT_EQ(std::set<Entity>({e1, e2, e3}), changed());
+
+  manager.RunSetAllComponentsUnchanged();
+  EXPECT_TRUE(changed().empty());
+
+  // One-time and periodic changes
+  manager.SetChanged(e1, IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  manager.SetChanged(e3, IntComponent::typeId,
+      ComponentState::OneTimeChange);
+  EXPECT_EQ(std::set<Entity>({e1, e3}), changed());
+
+  // Entities missing any of the other components are skipped
+  int count{0};
+  manager.EachChanged<IntComponent, DoubleComponent>(
+      [&](const Entity &_entity, const IntComponent *,
+          const DoubleComponent *_double) -> bool
+      {
+        EXPECT_EQ(e1, _entity);
+        EXPECT_DOUBLE_EQ(1.0, _double->Data());
+        ++count;
+        return true;
+      });
+  EXPECT_EQ(1, count);
+
+  // Changes to other component types aren't reported
+  manager.RunSetAllComponentsUnchanged();
+  manager.SetChanged(e1, DoubleComponent::typeId,
+      ComponentState::PeriodicChange);
+  EXPECT_TRUE(changed().empty());
+
+  // Setting no change removes the entity
+  manager.SetChanged(e2, IntComponent::typeId,
+      ComponentState::OneTimeChange);
+  manager.SetChanged(e3, IntComponent::typeId,
+      ComponentState::OneTimeChange);
+  manager.SetChanged(e3, IntComponent::typeId, ComponentState::NoChange);
+  EXPECT_EQ(std::set<Entity>({e2}), changed());
+
+  // Removed components aren't reported
+  EXPECT_TRUE(manager.RemoveComponent<IntComponent>(e2));
+  EXPECT_TRUE(changed().empty());
+
+  // Returning false stops the iteration
+  manager.SetChanged(e1, IntComponent::typeId,
+      ComponentState::OneTimeChange);
+  manager.SetChanged(e3, IntComponent::typeId,
+      ComponentState::OneTimeChange);
+  count = 0;
+  manager.EachChanged<IntComponent>(
+      [&](const Entity &, const IntComponent *) -> bool
+      {
+        ++count;
+        return false;
+      });
+  EXPECT_EQ(1, count);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EachParallel)
+{
+  // Enough entities to be split across threads
+  const int count{1000};
+  for (int i = 0; i < count; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent<IntComponent>(entity, IntComponent(i));
+    if (i % 2 == 0)
+      manager.CreateComponent<Even>(entity, Even());
+  }
+
+  // Mutable components, each entity is visited exactly once
+  std::atomic<int> visited{0};
+  manager.EachParallel<IntComponent>(
+      [&](const Entity &, IntComponent *_int) -> bool
+      {
+        _int->Data() *= 2;
+        ++visited;
+        return true;
+      });
+  EXPECT_EQ(count, visited.load());
+
+  long long serialSum{0};
+  manager.Each<IntComponent>(
+      [&](const Entity &, const IntComponent *_int) -> bool
+      {
+        EXPECT_EQ(0, _int->Data() % 2);
+        serialSum += _int->Data();
+        return true;
+      });
+  EXPECT_EQ(static_cast<long long>(count) * (count - 1), serialSum);
+
+  // Const components, multiple types
+  std::atomic<int> evenCount{0};
+  const auto &constManager = manager;
+  constManager.EachParallel<IntComponent, Even>(
+      [&](const Entity &, const IntComponent *_int, const Even *_even) -> bool
+      {
+        EXPECT_NE(nullptr, _int);
+        EXPECT_NE(nullptr, _even);
+        ++evenCount;
+        return true;
+      });
+  EXPECT_EQ(count / 2, evenCount.load());
+
+  // Returning false stops the iteration early
+  visited = 0;
+  constManager.EachParallel<IntComponent>(
+      [&](const Entity &, const IntComponent *) -> bool
+      {
+        ++visited;
+        return false;
+      });
+  EXPECT_GE(visited.load(), 1);
+  EXPECT_LT(visited.load(), count);
+
+  // Nested calls fall back to running on the calling thread
+  std::atomic<int> nested{0};
+  constManager.EachParallel<Even>(
+      [&](const Entity &, const Even *) -> bool
+      {
+        if (nested == 0)
+        {
+          constManager.EachParallel<IntComponent>(
+              [&](const Entity &, const IntComponent *) -> bool
+              {
+                ++nested;
+                return true;
+              });
+        }
+        return true;
+      });
+  EXPECT_GE(nested.load(), count);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EachCallableAndRange)
+{
+  std::vector<Entity> entities;
+  for (int i = 0; i < 4; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent(entity, IntComponent(i));
+    if (i % 2 == 0)
+      manager.CreateComponent(entity, DoubleComponent(i * 0.5));
+    entities.push_back(entity);
+  }
+
+  // Mutable lambdas and function objects are accepted
+  int sum{0};
+  manager.Each<IntComponent>(
+      [sum = 0, &total = sum](const Entity &, IntComponent *_int)
+      mutable -> bool
+      {
+        sum += _int->Data();
+        total = sum;
+        return true;
+      });
+  EXPECT_EQ(6, sum);
+
+  struct Counter
+  {
+    int *count;
+    bool operator()(const Entity &, const IntComponent *,
+        const DoubleComponent *) const
+    {
+      ++(*this->count);
+      return true;
+    }
+  };
+  int count{0};
+  const auto &constManager = manager;
+  constManager.Each<IntComponent, DoubleComponent>(Counter{&count});
+  EXPECT_EQ(2, count);
+
+  // Returning false stops
+  count = 0;
+  manager.Each<IntComponent>([&](const Entity &, const IntComponent *)
+      {
+        ++count;
+        return false;
+      });
+  EXPECT_EQ(1, count);
+
+  // All entities are new until the end of the iteration
+  count = 0;
+  constManager.EachNew<DoubleComponent>(
+      [&](const Entity &, const DoubleComponent *)
+      {
+        ++count;
+        return true;
+      });
+  EXPECT_EQ(2, count);
+
+  manager.RequestRemoveEntity(entities[3]);
+  std::vector<Entity> removed;
+  constManager.EachRemoved<IntComponent>(
+      [&](const Entity &_entity, const IntComponent *)
+      {
+        removed.push_back(_entity);
+        return true;
+      });
+  ASSERT_EQ(1u, removed.size());
+  EXPECT_EQ(entities[3], removed[0]);
+  manager.ProcessEntityRemovals();
+
+  // Ranges visit the same entities as Each, and give mutable components
+  // through a non-const manager
+  for (auto [entity, intComp, doubleComp] :
+      manager.EachRange<IntComponent, DoubleComponent>())
+  {
+    EXPECT_DOUBLE_EQ(intComp->Data() * 0.5, doubleComp->Data());
+    intComp->Data() += 10;
+    EXPECT_NE(kNullEntity, entity);
+  }
+
+  std::vector<int> values;
+  auto range = constManager.EachRange<IntComponent>();
+  EXPECT_EQ(3u, range.size());
+  for (auto [entity, intComp] : range)
+  {
+    static_assert(std::is_same_v<decltype(intComp), const IntComponent *>);
+    EXPECT_EQ(intComp, manager.Component<IntComponent>(entity));
+    values.push_back(intComp->Data());
+  }
+  EXPECT_EQ((std::vector<int>{10, 1, 12}), values);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EachWhileViewChanges)
+{
+  std::vector<Entity> entities;
+  for (int i = 0; i < 10; ++i)
+  {
+    entities.push_back(manager.CreateEntity());
+    manager.CreateComponent(entities.back(), IntComponent(i));
+  }
+
+  // Entities which leave a view keep their cached data, so adding their
+  // component back makes them join it right away
+  int count{0};
+  manager.Each<IntComponent>([&](const Entity &, const IntComponent *)
+      {
+        ++count;
+        return true;
+      });
+  EXPECT_EQ(10, count);
+  const std::vector<Entity> rejoining(entities.begin() + 5, entities.end());
+  for (const Entity entity : rejoining)
+    EXPECT_TRUE(manager.RemoveComponent<IntComponent>(entity));
+
+  // Entities joining the view during the iteration are visited, and those
+  // leaving it are only skipped if they weren't visited yet
+  std::set<Entity> visited;
+  manager.Each<IntComponent>([&](const Entity &_entity, IntComponent *)
+      {
+        EXPECT_TRUE(visited.insert(_entity).second);
+        if (_entity == entities[1])
+        {
+          for (const Entity entity : rejoining)
+            manager.CreateComponent(entity, IntComponent(0));
+          EXPECT_TRUE(manager.RemoveComponent<IntComponent>(entities[0]));
+          EXPECT_TRUE(manager.RemoveComponent<IntComponent>(entities[3]));
+        }
+        return true;
+      });
+  std::set<Entity> expected(rejoining.begin(), rejoining.end());
+  expected.insert({entities[0], entities[1], entities[2], entities[4]});
+  EXPECT_EQ(expected, visited);
+
+  // Ranges behave the same
+  visited.clear();
+  for (auto [entity, intComp] : manager.EachRange<IntComponent>())
+  {
+    EXPECT_NE(nullptr, intComp);
+    EXPECT_TRUE(visited.insert(entity).second);
+    if (entity == entities[1])
+    {
+      manager.CreateComponent(entities[0], IntComponent(0));
+      EXPECT_TRUE(manager.RemoveComponent<IntComponent>(entities[2]));
+    }
+  }
+  expected.erase(entities[2]);
+  EXPECT_EQ(expected, visited);
+
+  count = 0;
+  manager.Each<IntComponent>([&](const Entity &, const IntComponent *)
+      {
+        ++count;
+        return true;
+      });
+  EXPECT_EQ(8, count);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, DemandComponent)
+{
+  Entity e1 = manager.CreateEntity();
+  Entity e2 = manager.CreateEntity();
+  manager.CreateComponent(e2, IntComponent(5));
+
+  // Nonexistent entities can't be demanded
+  EXPECT_FALSE(manager.DemandComponent<IntComponent>(kNullEntity).Active());
+  EXPECT_FALSE(ComponentDemand().Active());
+
+  // The first demand creates the component
+  auto demand1 = manager.DemandComponent<IntComponent>(e1);
+  EXPECT_TRUE(demand1.Active());
+  ASSERT_NE(nullptr, manager.Component<IntComponent>(e1));
+  EXPECT_EQ(1u, manager.ComponentDemandCount(e1, IntComponent::typeId));
+
+  // It's kept while any demand is held
+  auto demand2 = manager.DemandComponent<IntComponent>(e1);
+  EXPECT_EQ(2u, manager.ComponentDemandCount(e1, IntComponent::typeId));
+  demand1.Release();
+  EXPECT_FALSE(demand1.Active());
+  demand1.Release();
+  EXPECT_EQ(1u, manager.ComponentDemandCount(e1, IntComponent::typeId));
+  manager.RunRemoveUndemandedComponents();
+  EXPECT_NE(nullptr, manager.Component<IntComponent>(e1));
+
+  // And removed once the last one is released, which happens when handles
+  // are destroyed
+  {
+    ComponentDemand moved(std::move(demand2));
+    EXPECT_TRUE(moved.Active());
+  }
+  EXPECT_EQ(0u, manager.ComponentDemandCount(e1, IntComponent::typeId));
+  EXPECT_NE(nullptr, manager.Component<IntComponent>(e1));
+  manager.RunRemoveUndemandedComponents();
+  EXPECT_EQ(nullptr, manager.Component<IntComponent>(e1));
+
+  // Demanding again before the component is removed keeps it
+  demand1 = manager.DemandComponent<IntComponent>(e1);
+  demand1.Release();
+  demand1 = manager.DemandComponent<IntComponent>(e1);
+  manager.RunRemoveUndemandedComponents();
+  EXPECT_NE(nullptr, manager.Component<IntComponent>(e1));
+  EXPECT_EQ(1u, manager.ComponentDemandCount(e1, IntComponent::typeId));
+
+  // Components which existed before being demanded are never removed
+  {
+    auto demand = manager.DemandComponent<IntComponent>(e2);
+    EXPECT_EQ(5, manager.Component<IntComponent>(e2)->Data());
+  }
+  manager.RunRemoveUndemandedComponents();
+  ASSERT_NE(nullptr, manager.Component<IntComponent>(e2));
+  EXPECT_EQ(5, manager.Component<IntComponent>(e2)->Data());
+
+  // Demands of removed entities are dropped, and handles can outlive the
+  // manager
+  auto outliving = std::make_unique<EntityCompMgrTest>();
+  Entity e3 = outliving->CreateEntity();
+  auto demand3 = outliving->DemandComponent<DoubleComponent>(e3);
+  outliving->RequestRemoveEntity(e3);
+  outliving->ProcessEntityRemovals();
+  EXPECT_EQ(0u, outliving->ComponentDemandCount(e3,
+      DoubleComponent::typeId));
+  outliving.reset();
+  EXPECT_FALSE(demand3.Active());
+  demand3.Release();
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EntityMatches)
+{
+  Entity entity = manager.CreateEntity();
+  EXPECT_TRUE(manager.EntityMatches(entity, {}));
+  EXPECT_FALSE(manager.EntityMatches(kNullEntity, {}));
+
+  // Types the manager has never seen
+  EXPECT_FALSE(manager.EntityMatches(entity, {IntComponent::typeId}));
+
+  manager.CreateComponent(entity, IntComponent(1));
+  manager.CreateComponent(entity, DoubleComponent(2.0));
+  EXPECT_TRUE(manager.EntityMatches(entity, {IntComponent::typeId}));
+  EXPECT_TRUE(manager.EntityMatches(entity,
+      {IntComponent::typeId, DoubleComponent::typeId}));
+  EXPECT_FALSE(manager.EntityMatches(entity,
+      {IntComponent::typeId, BoolComponent::typeId}));
+
+  // A view is populated, then follows removals and re-additions
+  int count{0};
+  auto countEntities = [&]()
+  {
+    count = 0;
+    manager.Each<IntComponent, DoubleComponent>(
+        [&](const Entity &, const IntComponent *,
+            const DoubleComponent *) -> bool
+        {
+          ++count;
+          return true;
+        });
+    return count;
+  };
+  EXPECT_EQ(1, countEntities());
+
+  EXPECT_TRUE(manager.RemoveComponent<DoubleComponent>(entity));
+  EXPECT_FALSE(manager.EntityMatches(entity,
+      {IntComponent::typeId, DoubleComponent::typeId}));
+  EXPECT_EQ(0, countEntities());
+
+  manager.CreateComponent(entity, DoubleComponent(3.0));
+  EXPECT_TRUE(manager.EntityMatches(entity,
+      {IntComponent::typeId, DoubleComponent::typeId}));
+  EXPECT_EQ(1, countEntities());
+
+  // New entities are added to existing views
+  Entity other = manager.CreateEntity();
+  manager.CreateComponent(other, DoubleComponent(4.0));
+  EXPECT_EQ(1, countEntities());
+  manager.CreateComponent(other, IntComponent(5));
+  EXPECT_EQ(2, countEntities());
+}
+
 // Run multiple times. We want to make sure that static globals don't cause
 // problems.
 INSTANTIATE_TEST_SUITE_P(EntityComponentManagerRepeat,
     EntityComponentManagerFixture, ::testing::Range(1, 10));
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, CreateInBatches)
+{
+  // A view which exists before the batch is updated by it
+  int viewCount{0};
+  manager.Each<IntComponent, DoubleComponent>(
+      [&](const Entity &, const IntComponent *, const DoubleComponent *)
+      {
+        ++viewCount;
+        return true;
+      });
+  EXPECT_EQ(0, viewCount);
+
+  auto parent = manager.CreateEntity();
+
+  EXPECT_TRUE(manager.CreateEntities(0u).empty());
+  auto entities = manager.CreateEntities(100u);
+  ASSERT_EQ(100u, entities.size());
+  EXPECT_EQ(101u, manager.EntityCount());
+  for (std::size_t i = 0; i < entities.size(); ++i)
+  {
+    EXPECT_EQ(parent + 1 + i, entities[i]);
+    EXPECT_TRUE(manager.HasEntity(entities[i]));
+  }
+
+  // Ids keep increasing after a batch
+  EXPECT_EQ(entities.back() + 1, manager.CreateEntity());
+
+  std::vector<IntComponent> ints;
+  for (std::size_t i = 0; i < entities.size(); ++i)
+    ints.push_back(IntComponent(static_cast<int>(i)));
+  EXPECT_TRUE(manager.CreateComponents(entities, ints));
+  EXPECT_TRUE(manager.CreateComponents(entities, DoubleComponent(0.5)));
+  EXPECT_TRUE(manager.CreateComponents(entities,
+      components::ParentEntity(parent)));
+
+  for (std::size_t i = 0; i < entities.size(); ++i)
+  {
+    auto intComp = manager.Component<IntComponent>(entities[i]);
+    ASSERT_NE(nullptr, intComp);
+    EXPECT_EQ(static_cast<int>(i), intComp->Data());
+    auto doubleComp = manager.Component<DoubleComponent>(entities[i]);
+    ASSERT_NE(nullptr, doubleComp);
+    EXPECT_DOUBLE_EQ(0.5, doubleComp->Data());
+    EXPECT_EQ(parent, manager.ParentEntity(entities[i]));
+  }
+
+  viewCount = 0;
+  manager.Each<IntComponent, DoubleComponent>(
+      [&](const Entity &, const IntComponent *, const DoubleComponent *)
+      {
+        ++viewCount;
+        return true;
+      });
+  EXPECT_EQ(100, viewCount);
+
+  // Entities of the batch are new
+  int newCount{0};
+  manager.EachNew<IntComponent, DoubleComponent>(
+      [&](const Entity &, const IntComponent *, const DoubleComponent *)
+      {
+        ++newCount;
+        return true;
+      });
+  EXPECT_EQ(100, newCount);
+
+  // Existing components are updated
+  EXPECT_TRUE(manager.CreateComponents(entities, IntComponent(7)));
+  for (auto entity : entities)
+    EXPECT_EQ(7, manager.Component<IntComponent>(entity)->Data());
+
+  // Sizes must match, and entities must exist
+  EXPECT_FALSE(manager.CreateComponents(entities,
+      std::vector<IntComponent>(3u, IntComponent(1))));
+  EXPECT_FALSE(manager.CreateComponents({entities.front(), Entity{999999}},
+      IntComponent(3)));
+  EXPECT_EQ(3, manager.Component<IntComponent>(entities.front())->Data());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, MemoryAccounting)
+{
+  EXPECT_TRUE(manager.ComponentMemory().empty());
+  EXPECT_EQ(0u, manager.ViewsMemory());
+
+  std::vector<Entity> entities;
+  for (int i = 0; i < 100; ++i)
+  {
+    auto entity = manager.CreateEntity();
+    manager.CreateComponent(entity, IntComponent(i));
+    if (i % 2 == 0)
+      manager.CreateComponent(entity, DoubleComponent(0.5));
+    entities.push_back(entity);
+  }
+
+  auto typeMemory = [&](ComponentTypeId _typeId)
+  {
+    for (const auto &memory : manager.ComponentMemory())
+    {
+      if (memory.typeId == _typeId)
+        return memory;
+    }
+    return EntityComponentManager::ComponentTypeMemory();
+  };
+
+  auto ints = typeMemory(IntComponent::typeId);
+  EXPECT_EQ(100u, ints.count);
+  EXPECT_GE(ints.bytes, 100u * sizeof(IntComponent));
+  EXPECT_GE(ints.reservedBytes, ints.bytes);
+
+  auto doubles = typeMemory(DoubleComponent::typeId);
+  EXPECT_EQ(50u, doubles.count);
+  EXPECT_GE(doubles.bytes, 50u * sizeof(DoubleComponent));
+
+  // Views hold memory once used
+  manager.Each<IntComponent, DoubleComponent>(
+      [&](const Entity &, const IntComponent *, const DoubleComponent *)
+      {
+        return true;
+      });
+  EXPECT_GT(manager.ViewsMemory(), 50u * sizeof(Entity));
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ChildByName)
+{
+  Entity model = manager.CreateEntity();
+  Entity link1 = manager.CreateEntity();
+  Entity link2 = manager.CreateEntity();
+  Entity joint = manager.CreateEntity();
+  Entity other = manager.CreateEntity();
+
+  manager.CreateComponent(link1, components::Link());
+  manager.CreateComponent(link1, components::Name("base"));
+  manager.CreateComponent(link1, components::ParentEntity(model));
+  manager.CreateComponent(link2, components::Link());
+  manager.CreateComponent(link2, components::Name("wheel"));
+  manager.CreateComponent(link2, components::ParentEntity(model));
+  manager.CreateComponent(joint, components::Joint());
+  manager.CreateComponent(joint, components::Name("wheel"));
+  manager.CreateComponent(joint, components::ParentEntity(model));
+  manager.CreateComponent(other, components::Link());
+  manager.CreateComponent(other, components::Name("wheel"));
+
+  EXPECT_EQ(link1, manager.ChildByName<components::Link>(model, "base"));
+  EXPECT_EQ(link2, manager.ChildByName<components::Link>(model, "wheel"));
+  EXPECT_EQ(joint, manager.ChildByName<components::Joint>(model, "wheel"));
+  EXPECT_EQ(link2, manager.ChildByName(model, "wheel"));
+  EXPECT_EQ(kNullEntity, manager.ChildByName<components::Joint>(model,
+      "base"));
+  EXPECT_EQ(kNullEntity, manager.ChildByName(model, "missing"));
+  EXPECT_EQ(kNullEntity, manager.ChildByName(other, "wheel"));
+
+  EXPECT_EQ(std::vector<Entity>({link1, link2, joint}),
+      manager.ChildrenWithComponents(model));
+  EXPECT_EQ(std::vector<Entity>({link1, link2}),
+      manager.ChildrenWithComponents<components::Link>(model));
+
+  // Renamed through SetComponentData
+  manager.SetComponentData<components::Name>(link2, "tire");
+  EXPECT_EQ(kNullEntity, manager.ChildByName<components::Link>(model,
+      "wheel"));
+  EXPECT_EQ(link2, manager.ChildByName<components::Link>(model, "tire"));
+
+  // Names modified in place aren't returned under their old name
+  manager.Component<components::Name>(link1)->Data() = "chassis";
+  EXPECT_EQ(kNullEntity, manager.ChildByName(model, "base"));
+  EXPECT_EQ(link1, manager.ChildByName(model, "chassis"));
+
+  // Reparented
+  manager.SetComponentData<components::ParentEntity>(other, model);
+  EXPECT_EQ(other, manager.ChildByName<components::Link>(model, "wheel"));
+  EXPECT_EQ(3u, manager.ChildrenWithComponents<components::Link>(
+      model).size());
+
+  // Removed
+  manager.RequestRemoveEntity(other);
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(kNullEntity, manager.ChildByName<components::Link>(model,
+      "wheel"));
+  EXPECT_EQ(joint, manager.ChildByName(model, "wheel"));
+  EXPECT_EQ(std::vector<Entity>({link1, link2}),
+      manager.ChildrenWithComponents<components::Link>(model));
+
+  manager.RequestRemoveEntities();
+  manager.ProcessEntityRemovals();
+  EXPECT_TRUE(manager.ChildrenWithComponents(model).empty());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EntityWorldPose)
+{
+  // world
+  //  - model
+  //    - link1
+  //    - link2
+  Entity world = manager.CreateEntity();
+  Entity model = manager.CreateEntity();
+  Entity link1 = manager.CreateEntity();
+  Entity link2 = manager.CreateEntity();
+
+  manager.CreateComponent(model, components::ParentEntity(world));
+  manager.CreateComponent(model,
+      components::Pose(math::Pose3d(1, 0, 0, 0, 0, IGN_PI_2)));
+  manager.CreateComponent(link1, components::ParentEntity(model));
+  manager.CreateComponent(link1, components::Pose(math::Pose3d(1, 0, 0, 0,
+      0, 0)));
+  manager.CreateComponent(link2, components::ParentEntity(model));
+
+  EXPECT_FALSE(manager.EntityWorldPose(world));
+  EXPECT_FALSE(manager.EntityWorldPose(link2));
+  EXPECT_EQ(math::Pose3d(1, 0, 0, 0, 0, IGN_PI_2),
+      manager.EntityWorldPose(model));
+  EXPECT_EQ(math::Pose3d(1, 1, 0, 0, 0, IGN_PI_2),
+      manager.EntityWorldPose(link1));
+
+  // Siblings are composed with the cached pose of their parent
+  manager.CreateComponent(link2, components::Pose(math::Pose3d(0, 2, 0, 0,
+      0, 0)));
+  EXPECT_EQ(math::Pose3d(-1, 0, 0, 0, 0, IGN_PI_2),
+      manager.EntityWorldPose(link2));
+
+  // Moving the model moves its links
+  manager.SetComponentData<components::Pose>(model, math::Pose3d(0, 0, 1, 0,
+      0, 0));
+  EXPECT_EQ(math::Pose3d(1, 0, 1, 0, 0, 0), manager.EntityWorldPose(link1));
+
+  manager.Component<components::Pose>(model)->Data() =
+      math::Pose3d(0, 0, 2, 0, 0, 0);
+  manager.SetChanged(model, components::Pose::typeId,
+      ComponentState::PeriodicChange);
+  EXPECT_EQ(math::Pose3d(1, 0, 2, 0, 0, 0), manager.EntityWorldPose(link1));
+
+  // Poses modified in place are picked up after the iteration
+  manager.Component<components::Pose>(model)->Data() =
+      math::Pose3d(0, 0, 3, 0, 0, 0);
+  manager.RunSetAllComponentsUnchanged();
+  EXPECT_EQ(math::Pose3d(0, 2, 3, 0, 0, 0), manager.EntityWorldPose(link2));
+
+  // Reparented
+  manager.SetComponentData<components::ParentEntity>(link2, world);
+  EXPECT_EQ(math::Pose3d(0, 2, 0, 0, 0, 0), manager.EntityWorldPose(link2));
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EntityHandle)
+{
+  Entity entity = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(entity, IntComponent(123));
+
+  EntityHandle handle = manager.Handle(entity);
+  EXPECT_EQ(entity, handle.entity);
+  EXPECT_TRUE(manager.HasEntity(handle));
+  EXPECT_EQ(handle, manager.Handle(entity));
+  ASSERT_NE(nullptr, manager.Component<IntComponent>(handle));
+  EXPECT_EQ(123, manager.Component<IntComponent>(handle)->Data());
+  EXPECT_EQ(nullptr, manager.Component<DoubleComponent>(handle));
+
+  // Handles to missing entities are never valid
+  EXPECT_FALSE(manager.HasEntity(manager.Handle(kNullEntity)));
+  EXPECT_FALSE(manager.HasEntity(manager.Handle(entity + 100)));
+  EXPECT_FALSE(manager.HasEntity(EntityHandle()));
+
+  auto stateMsg = manager.State();
+
+  manager.RequestRemoveEntity(entity);
+  manager.ProcessEntityRemovals();
+  EXPECT_FALSE(manager.HasEntity(handle));
+  EXPECT_EQ(nullptr, manager.Component<IntComponent>(handle));
+
+  // Recreating an entity with the same id doesn't revive old handles
+  manager.SetState(stateMsg);
+  EXPECT_TRUE(manager.HasEntity(entity));
+  EXPECT_FALSE(manager.HasEntity(handle));
+  EXPECT_EQ(nullptr, manager.Component<IntComponent>(handle));
+
+  EntityHandle newHandle = manager.Handle(entity);
+  EXPECT_NE(handle, newHandle);
+  EXPECT_TRUE(manager.HasEntity(newHandle));
+  EXPECT_NE(nullptr, manager.Component<IntComponent>(newHandle));
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, CommandBuffer)
+{
+  Entity existing = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(existing, IntComponent(1));
+  manager.CreateComponent<DoubleComponent>(existing, DoubleComponent(2.0));
+
+  auto &buffer = manager.CommandBuffer();
+  EXPECT_EQ(&buffer, &manager.CommandBuffer());
+  EXPECT_TRUE(buffer.Empty());
+
+  // Created entities get their id right away, but only exist once applied
+  Entity created = buffer.CreateEntity();
+  EXPECT_NE(kNullEntity, created);
+  EXPECT_NE(existing, created);
+  EXPECT_FALSE(manager.HasEntity(created));
+  EXPECT_NE(created, manager.CreateEntity());
+
+  buffer.CreateComponent(created, IntComponent(3));
+  buffer.CreateComponent(existing, IntComponent(4));
+  buffer.RemoveComponent<DoubleComponent>(existing);
+  EXPECT_EQ(4u, buffer.Size());
+  EXPECT_EQ(1, manager.Component<IntComponent>(existing)->Data());
+
+  // Each thread has its own buffer
+  EntityCommandBuffer *otherBuffer{nullptr};
+  Entity otherCreated{kNullEntity};
+  std::thread thread([&]
+  {
+    otherBuffer = &manager.CommandBuffer();
+    otherCreated = otherBuffer->CreateEntity();
+    otherBuffer->CreateComponent(otherCreated, IntComponent(5));
+  });
+  thread.join();
+  ASSERT_NE(nullptr, otherBuffer);
+  EXPECT_NE(&buffer, otherBuffer);
+  EXPECT_NE(created, otherCreated);
+
+  manager.RunApplyCommandBuffers();
+  EXPECT_TRUE(buffer.Empty());
+  EXPECT_TRUE(otherBuffer->Empty());
+
+  EXPECT_TRUE(manager.HasEntity(created));
+  EXPECT_TRUE(manager.HasEntity(otherCreated));
+  ASSERT_NE(nullptr, manager.Component<IntComponent>(created));
+  EXPECT_EQ(3, manager.Component<IntComponent>(created)->Data());
+  EXPECT_EQ(4, manager.Component<IntComponent>(existing)->Data());
+  EXPECT_EQ(nullptr, manager.Component<DoubleComponent>(existing));
+  ASSERT_NE(nullptr, manager.Component<IntComponent>(otherCreated));
+  EXPECT_EQ(5, manager.Component<IntComponent>(otherCreated)->Data());
+
+  // Entity removals are requested when applied, and processed as usual
+  buffer.RequestRemoveEntity(created);
+  manager.ProcessEntityRemovals();
+  EXPECT_TRUE(manager.HasEntity(created));
+  manager.RunApplyCommandBuffers();
+  EXPECT_TRUE(manager.HasEntity(created));
+  manager.ProcessEntityRemovals();
+  EXPECT_FALSE(manager.HasEntity(created));
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, BinarySerialization)
+{
+  Entity entity = manager.CreateEntity();
+  const math::Pose3d pose(1, 2, 3, 0.1, 0.2, 0.3);
+  manager.CreateComponent(entity, components::Pose(pose));
+  manager.CreateComponent(entity, StringComponent("name"));
+
+  EXPECT_FALSE(manager.BinarySerialization());
+  manager.SetBinarySerialization(true);
+  EXPECT_TRUE(manager.BinarySerialization());
+
+  // Components with a binary serialization are sent in binary form, the
+  // others through streams
+  msgs::SerializedStateMap stateMapMsg;
+  manager.State(stateMapMsg);
+  const auto &compsMsg = stateMapMsg.entities().at(entity).components();
+  const auto &poseData =
+      compsMsg.at(static_cast<int64_t>(components::Pose::typeId)).component();
+  ASSERT_EQ(components::kBinaryDataPrefixSize + 7u * sizeof(double),
+      poseData.size());
+  EXPECT_EQ('\0', poseData[0]);
+  EXPECT_EQ("name",
+      compsMsg.at(static_cast<int64_t>(StringComponent::typeId)).component());
+
+  // Both forms are read back, from both kinds of state messages
+  EntityComponentManager mapEcm;
+  mapEcm.SetState(stateMapMsg);
+  ASSERT_NE(nullptr, mapEcm.Component<components::Pose>(entity));
+  EXPECT_EQ(pose, mapEcm.Component<components::Pose>(entity)->Data());
+  ASSERT_NE(nullptr, mapEcm.Component<StringComponent>(entity));
+  EXPECT_EQ("name", mapEcm.Component<StringComponent>(entity)->Data());
+
+  EntityComponentManager ecm;
+  ecm.SetState(manager.State({entity}));
+  ASSERT_NE(nullptr, ecm.Component<components::Pose>(entity));
+  EXPECT_EQ(pose, ecm.Component<components::Pose>(entity)->Data());
+
+  // States from managers not using binary serialization are still read
+  manager.SetBinarySerialization(false);
+  manager.SetComponentData<components::Pose>(entity, math::Pose3d::Zero);
+  ecm.SetState(manager.State({entity}));
+  EXPECT_EQ(math::Pose3d::Zero,
+      ecm.Component<components::Pose>(entity)->Data());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EachQueries)
+{
+  /*        1
+   *      /   \
+   *     2     3
+   *     |
+   *     4
+   */
+  Entity e1 = manager.CreateEntity();
+  Entity e2 = manager.CreateEntity();
+  Entity e3 = manager.CreateEntity();
+  Entity e4 = manager.CreateEntity();
+  manager.SetParentEntity(e2, e1);
+  manager.SetParentEntity(e3, e1);
+  manager.SetParentEntity(e4, e2);
+
+  manager.CreateComponent(e1, IntComponent(1));
+  manager.CreateComponent(e1, DoubleComponent(1.0));
+  manager.CreateComponent(e2, IntComponent(2));
+  manager.CreateComponent(e3, IntComponent(2));
+  manager.CreateComponent(e4, IntComponent(2));
+  manager.CreateComponent(e4, DoubleComponent(2.0));
+
+  // Component types match ComponentTypes, excluding removed ones
+  std::unordered_set<ComponentTypeId> types;
+  auto insertType = [&](ComponentTypeId _type)
+  {
+    types.insert(_type);
+    return true;
+  };
+  manager.EachComponentType(e1, insertType);
+  EXPECT_EQ(manager.ComponentTypes(e1), types);
+  EXPECT_EQ(2u, types.size());
+
+  manager.RemoveComponent<DoubleComponent>(e1);
+  types.clear();
+  manager.EachComponentType(e1, insertType);
+  EXPECT_EQ(std::unordered_set<ComponentTypeId>{IntComponent::typeId},
+      types);
+
+  types.clear();
+  manager.EachComponentType(kNullEntity, insertType);
+  EXPECT_TRUE(types.empty());
+
+  // Descendants match Descendants
+  std::unordered_set<Entity> descendants;
+  auto insertEntity = [&](Entity _entity)
+  {
+    descendants.insert(_entity);
+    return true;
+  };
+  manager.EachDescendant(e1, insertEntity);
+  EXPECT_EQ(manager.Descendants(e1), descendants);
+  EXPECT_EQ(4u, descendants.size());
+
+  descendants.clear();
+  manager.EachDescendant(e2, insertEntity);
+  EXPECT_EQ((std::unordered_set<Entity>{e2, e4}), descendants);
+
+  // Entities by components match EntitiesByComponents, and can stop early
+  std::vector<Entity> entities;
+  manager.EachEntityByComponents([&](Entity _entity)
+  {
+    entities.push_back(_entity);
+    return true;
+  }, IntComponent(2));
+  EXPECT_EQ(manager.EntitiesByComponents(IntComponent(2)), entities);
+  EXPECT_EQ(3u, entities.size());
+
+  entities.clear();
+  manager.EachEntityByComponents([&](Entity _entity)
+  {
+    entities.push_back(_entity);
+    return false;
+  }, IntComponent(2));
+  EXPECT_EQ(1u, entities.size());
+
+  entities.clear();
+  manager.EachEntityByComponents([&](Entity _entity)
+  {
+    entities.push_back(_entity);
+    return true;
+  }, IntComponent(2), DoubleComponent(2.0));
+  EXPECT_EQ(std::vector<Entity>{e4}, entities);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, CloneMany)
+{
+  // A model with a canonical link, another link and a joint between them
+  Entity model = manager.CreateEntity();
+  manager.CreateComponent(model, components::Name("box"));
+  manager.CreateComponent(model, IntComponent(123));
+  Entity canonical = manager.CreateEntity();
+  manager.CreateComponent(canonical, components::Name("base"));
+  manager.CreateComponent(canonical, components::ParentEntity(model));
+  manager.CreateComponent(canonical, components::CanonicalLink());
+  manager.CreateComponent(canonical, components::Link());
+  Entity link = manager.CreateEntity();
+  manager.CreateComponent(link, components::Name("lid"));
+  manager.CreateComponent(link, components::ParentEntity(model));
+  manager.CreateComponent(link, components::Link());
+  Entity joint = manager.CreateEntity();
+  manager.CreateComponent(joint, components::Name("hinge"));
+  manager.CreateComponent(joint, components::ParentEntity(model));
+  manager.CreateComponent(joint, components::Joint());
+  manager.CreateComponent(joint, components::ParentLinkName("base"));
+  manager.CreateComponent(joint, components::ChildLinkName("lid"));
+  manager.CreateComponent(model, components::ModelCanonicalLink(canonical));
+
+  // An existing name takes a suffix
+  Entity other = manager.CreateEntity();
+  manager.CreateComponent(other, components::Name("box_2"));
+  EXPECT_EQ(5u, manager.EntityCount());
+
+  EXPECT_TRUE(manager.CloneMany(model, kNullEntity, "", 0u).empty());
+  EXPECT_TRUE(manager.CloneMany(kNullEntity, kNullEntity, "", 3u).empty());
+
+  auto clones = manager.CloneMany(model, kNullEntity, "", 3u);
+  ASSERT_EQ(3u, clones.size());
+  EXPECT_EQ(17u, manager.EntityCount());
+
+  const std::vector<std::string> expectedNames{"box_1", "box_3", "box_4"};
+  for (std::size_t c = 0; c < clones.size(); ++c)
+  {
+    const Entity clone = clones[c];
+    EXPECT_NE(model, clone);
+    ASSERT_NE(nullptr, manager.Component<components::Name>(clone));
+    EXPECT_EQ(expectedNames[c],
+        manager.Component<components::Name>(clone)->Data());
+    ASSERT_NE(nullptr, manager.Component<IntComponent>(clone));
+    EXPECT_EQ(123, manager.Component<IntComponent>(clone)->Data());
+    EXPECT_EQ(nullptr, manager.Component<components::ParentEntity>(clone));
+
+    // Children keep their names under each copy
+    auto clonedCanonical = manager.EntityByComponents(
+        components::ParentEntity(clone), components::Name("base"));
+    auto clonedLink = manager.EntityByComponents(
+        components::ParentEntity(clone), components::Name("lid"));
+    auto clonedJoint = manager.EntityByComponents(
+        components::ParentEntity(clone), components::Name("hinge"));
+    ASSERT_NE(kNullEntity, clonedCanonical);
+    ASSERT_NE(kNullEntity, clonedLink);
+    ASSERT_NE(kNullEntity, clonedJoint);
+    EXPECT_NE(nullptr,
+        manager.Component<components::CanonicalLink>(clonedCanonical));
+    EXPECT_NE(nullptr, manager.Component<components::Link>(clonedLink));
+    EXPECT_EQ("lid",
+        manager.Component<components::ChildLinkName>(clonedJoint)->Data());
+
+    // The canonical link is the copy's own
+    auto canonicalComp =
+        manager.Component<components::ModelCanonicalLink>(clone);
+    ASSERT_NE(nullptr, canonicalComp);
+    EXPECT_EQ(clonedCanonical, canonicalComp->Data());
+  }
+  EXPECT_EQ(canonical,
+      manager.Component<components::ModelCanonicalLink>(model)->Data());
+
+  // Views see the copies
+  std::size_t links{0u};
+  manager.Each<components::Link>(
+      [&](const Entity &, const components::Link *) -> bool
+      {
+        ++links;
+        return true;
+      });
+  EXPECT_EQ(8u, links);
+
+  // Cloning under a parent with a given base name
+  auto named = manager.CloneMany(link, model, "door", 2u);
+  ASSERT_EQ(2u, named.size());
+  EXPECT_EQ("door_1", manager.Component<components::Name>(named[0])->Data());
+  EXPECT_EQ("door_2", manager.Component<components::Name>(named[1])->Data());
+  EXPECT_EQ(model,
+      manager.Component<components::ParentEntity>(named[1])->Data());
+  EXPECT_EQ(model, manager.ParentEntity(named[1]));
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ViewCreationAfterChanges)
+{
+  std::vector<Entity> entities;
+  for (int i = 0; i < 10; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    entities.push_back(entity);
+    manager.CreateComponent(entity, IntComponent(i));
+    if (i % 3 == 0)
+      manager.CreateComponent(entity, DoubleComponent(i));
+  }
+  manager.RemoveComponent<DoubleComponent>(entities[3]);
+  manager.RemoveComponent<IntComponent>(entities[6]);
+  manager.RunClearNewlyCreatedEntities();
+
+  // The first use of these signatures builds their views from the current
+  // components, in ascending order
+  std::vector<Entity> visited;
+  manager.Each<IntComponent, DoubleComponent>(
+      [&](const Entity &_entity, const IntComponent *,
+          const DoubleComponent *) -> bool
+      {
+        visited.push_back(_entity);
+        return true;
+      });
+  EXPECT_EQ((std::vector<Entity>{entities[0], entities[9]}), visited);
+
+  visited.clear();
+  manager.Each<DoubleComponent>(
+      [&](const Entity &_entity, const DoubleComponent *) -> bool
+      {
+        visited.push_back(_entity);
+        return true;
+      });
+  EXPECT_EQ((std::vector<Entity>{entities[0], entities[6], entities[9]}),
+      visited);
+
+  // Removed entities don't show up in new views
+  manager.RequestRemoveEntity(entities[9]);
+  manager.ProcessEntityRemovals();
+  visited.clear();
+  manager.Each<IntComponent, DoubleComponent, BoolComponent>(
+      [&](const Entity &_entity, const IntComponent *,
+          const DoubleComponent *, const BoolComponent *) -> bool
+      {
+        visited.push_back(_entity);
+        return true;
+      });
+  EXPECT_TRUE(visited.empty());
+
+  // Rebuilding doesn't change what views see
+  manager.RebuildViews();
+  visited.clear();
+  manager.Each<IntComponent, DoubleComponent>(
+      [&](const Entity &_entity, const IntComponent *,
+          const DoubleComponent *) -> bool
+      {
+        visited.push_back(_entity);
+        return true;
+      });
+  EXPECT_EQ(std::vector<Entity>{entities[0]}, visited);
+
+  // Removing all entities marks them in existing views
+  manager.RequestRemoveEntities();
+  EXPECT_EQ(1, removedCount<IntComponent, DoubleComponent>(manager));
+  EXPECT_EQ(8, removedCount<IntComponent>(manager));
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ComponentObservers)
+{
+  Entity root = manager.CreateEntity();
+  Entity child = manager.CreateEntity();
+  Entity other = manager.CreateEntity();
+  manager.SetParentEntity(child, root);
+
+  std::vector<EntityComponentManager::ComponentChanges> all;
+  std::vector<EntityComponentManager::ComponentChanges> subtree;
+  auto allId = manager.AddComponentObserver(IntComponent::typeId,
+      [&](const EntityComponentManager::ComponentChanges &_changes)
+      {
+        all.push_back(_changes);
+      });
+  auto subtreeId = manager.AddComponentObserver(IntComponent::typeId,
+      [&](const EntityComponentManager::ComponentChanges &_changes)
+      {
+        subtree.push_back(_changes);
+      }, root);
+  EXPECT_NE(allId, subtreeId);
+
+  // Nothing to report
+  manager.RunNotifyComponentObservers();
+  EXPECT_TRUE(all.empty());
+
+  // Other types aren't reported
+  manager.CreateComponent<IntComponent>(other, IntComponent(1));
+  manager.CreateComponent<IntComponent>(child, IntComponent(2));
+  manager.CreateComponent<DoubleComponent>(root, DoubleComponent(1.0));
+  manager.RunNotifyComponentObservers();
+  ASSERT_EQ(1u, all.size());
+  EXPECT_EQ(IntComponent::typeId, all[0].typeId);
+  EXPECT_EQ((std::vector<Entity>{other, child}), all[0].added);
+  EXPECT_TRUE(all[0].changed.empty());
+  EXPECT_TRUE(all[0].removed.empty());
+  ASSERT_EQ(1u, subtree.size());
+  EXPECT_EQ(std::vector<Entity>{child}, subtree[0].added);
+
+  // Changes are coalesced
+  all.clear();
+  subtree.clear();
+  manager.SetChanged(child, IntComponent::typeId,
+      ComponentState::OneTimeChange);
+  manager.SetChanged(child, IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  manager.SetChanged(other, IntComponent::typeId, ComponentState::NoChange);
+  Entity added = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(added, IntComponent(3));
+  manager.SetChanged(added, IntComponent::typeId,
+      ComponentState::OneTimeChange);
+  Entity transient = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(transient, IntComponent(4));
+  EXPECT_TRUE(manager.RemoveComponent<IntComponent>(transient));
+  manager.RunNotifyComponentObservers();
+  ASSERT_EQ(1u, all.size());
+  EXPECT_EQ(std::vector<Entity>{added}, all[0].added);
+  EXPECT_EQ(std::vector<Entity>{child}, all[0].changed);
+  EXPECT_TRUE(all[0].removed.empty());
+  ASSERT_EQ(1u, subtree.size());
+  EXPECT_TRUE(subtree[0].added.empty());
+  EXPECT_EQ(std::vector<Entity>{child}, subtree[0].changed);
+
+  // Removing and adding back is a change
+  all.clear();
+  EXPECT_TRUE(manager.RemoveComponent<IntComponent>(other));
+  manager.CreateComponent<IntComponent>(other, IntComponent(5));
+  manager.RunNotifyComponentObservers();
+  ASSERT_EQ(1u, all.size());
+  EXPECT_EQ(std::vector<Entity>{other}, all[0].changed);
+
+  // Components of removed entities are reported as removed, also to the
+  // subtree, even though the entity can't be located anymore
+  all.clear();
+  subtree.clear();
+  manager.RequestRemoveEntity(root);
+  manager.ProcessEntityRemovals();
+  manager.RunNotifyComponentObservers();
+  ASSERT_EQ(1u, all.size());
+  EXPECT_EQ(std::vector<Entity>{child}, all[0].removed);
+  ASSERT_EQ(1u, subtree.size());
+  EXPECT_EQ(std::vector<Entity>{child}, subtree[0].removed);
+
+  // Removed observers aren't notified, and callbacks may remove observers
+  all.clear();
+  EXPECT_TRUE(manager.RemoveComponentObserver(subtreeId));
+  EXPECT_FALSE(manager.RemoveComponentObserver(subtreeId));
+  std::size_t selfCount{0u};
+  uint64_t selfId{0u};
+  selfId = manager.AddComponentObserver(IntComponent::typeId,
+      [&](const EntityComponentManager::ComponentChanges &)
+      {
+        ++selfCount;
+        EXPECT_TRUE(manager.RemoveComponentObserver(selfId));
+      });
+  manager.SetChanged(other, IntComponent::typeId,
+      ComponentState::OneTimeChange);
+  manager.RunNotifyComponentObservers();
+  manager.SetChanged(other, IntComponent::typeId,
+      ComponentState::OneTimeChange);
+  manager.RunNotifyComponentObservers();
+  EXPECT_EQ(2u, all.size());
+  EXPECT_EQ(1u, selfCount);
+  EXPECT_TRUE(manager.RemoveComponentObserver(allId));
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ComponentObserversReportOnce)
+{
+  std::vector<EntityComponentManager::ComponentChanges> all;
+  manager.AddComponentObserver(IntComponent::typeId,
+      [&](const EntityComponentManager::ComponentChanges &_changes)
+      {
+        all.push_back(_changes);
+      });
+
+  // Adding, removing and adding back within a batch is a single addition
+  Entity entity = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(entity, IntComponent(1));
+  EXPECT_TRUE(manager.RemoveComponent<IntComponent>(entity));
+  manager.CreateComponent<IntComponent>(entity, IntComponent(2));
+  manager.RunNotifyComponentObservers();
+  ASSERT_EQ(1u, all.size());
+  EXPECT_EQ(std::vector<Entity>{entity}, all[0].added);
+  EXPECT_TRUE(all[0].changed.empty());
+  EXPECT_TRUE(all[0].removed.empty());
+
+  // Once more, starting from an existing component
+  all.clear();
+  EXPECT_TRUE(manager.RemoveComponent<IntComponent>(entity));
+  manager.CreateComponent<IntComponent>(entity, IntComponent(3));
+  EXPECT_TRUE(manager.RemoveComponent<IntComponent>(entity));
+  manager.CreateComponent<IntComponent>(entity, IntComponent(4));
+  manager.RunNotifyComponentObservers();
+  ASSERT_EQ(1u, all.size());
+  EXPECT_TRUE(all[0].added.empty());
+  EXPECT_EQ(std::vector<Entity>{entity}, all[0].changed);
+  EXPECT_TRUE(all[0].removed.empty());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, Snapshots)
+{
+  Entity parent = manager.CreateEntity();
+  Entity child = manager.CreateEntity();
+  manager.CreateComponent(child, components::ParentEntity(parent));
+  manager.CreateComponent<IntComponent>(parent, IntComponent(1));
+  manager.CreateComponent<DoubleComponent>(child, DoubleComponent(2.0));
+  manager.RunClearNewlyCreatedEntities();
+
+  auto snapshot = manager.Snapshot();
+  EXPECT_EQ(2u, snapshot.EntityCount());
+  EXPECT_EQ(3u, snapshot.ComponentCount());
+
+  // Diverge from the snapshot
+  manager.Component<IntComponent>(parent)->Data() = 10;
+  EXPECT_TRUE(manager.RemoveComponent<DoubleComponent>(child));
+  manager.CreateComponent<StringComponent>(child, StringComponent("new"));
+  Entity added = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(added, IntComponent(3));
+  manager.RequestRemoveEntity(child);
+  manager.ProcessEntityRemovals();
+  EXPECT_FALSE(manager.HasEntity(child));
+
+  // Restoring can be repeated, since the snapshot isn't consumed
+  for (int i = 0; i < 2; ++i)
+  {
+    manager.RestoreSnapshot(snapshot);
+    manager.ProcessEntityRemovals();
+    manager.RunClearRemovedComponents();
+
+    EXPECT_TRUE(manager.HasEntity(parent));
+    EXPECT_TRUE(manager.HasEntity(child));
+    EXPECT_FALSE(manager.HasEntity(added));
+    EXPECT_EQ(parent, manager.ParentEntity(child));
+    ASSERT_NE(nullptr, manager.Component<IntComponent>(parent));
+    EXPECT_EQ(1, manager.Component<IntComponent>(parent)->Data());
+    ASSERT_NE(nullptr, manager.Component<DoubleComponent>(child));
+    EXPECT_DOUBLE_EQ(2.0, manager.Component<DoubleComponent>(child)->Data());
+    EXPECT_EQ(nullptr, manager.Component<StringComponent>(child));
+    EXPECT_TRUE(manager.HasOneTimeComponentChanges());
+
+    manager.Component<IntComponent>(parent)->Data() = 20;
+    manager.CreateComponent<StringComponent>(parent, StringComponent("x"));
+    manager.RunSetAllComponentsUnchanged();
+  }
+
+  // New entities don't reuse the ids of removed ones
+  EXPECT_LT(added, manager.CreateEntity());
+
+  // A snapshot can be restored into another manager
+  EntityCompMgrTest other;
+  other.RestoreSnapshot(snapshot);
+  EXPECT_TRUE(other.HasEntity(parent));
+  EXPECT_EQ(parent, other.ParentEntity(child));
+  ASSERT_NE(nullptr, other.Component<DoubleComponent>(child));
+  EXPECT_DOUBLE_EQ(2.0, other.Component<DoubleComponent>(child)->Data());
+  EXPECT_LT(child, other.CreateEntity());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, Deterministic)
+{
+  EXPECT_FALSE(manager.Deterministic());
+  manager.SetDeterministic(true);
+  EXPECT_TRUE(manager.Deterministic());
+
+  Entity target = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(target, IntComponent(0));
+
+  // Chunks, the commands they record and their seeds are the same whatever
+  // the number of threads
+  auto run = [&](unsigned int _threads)
+  {
+    manager.SetMaxThreads(_threads);
+    std::mutex mutex;
+    std::set<std::pair<std::size_t, std::size_t>> chunks;
+    std::set<uint64_t> seeds;
+    manager.ParallelFor(1000u, [&](std::size_t _begin, std::size_t _end)
+    {
+      manager.CommandBuffer().CreateComponent(target,
+          IntComponent(static_cast<int>(_begin)));
+      std::lock_guard<std::mutex> lock(mutex);
+      chunks.insert({_begin, _end});
+      seeds.insert(manager.TaskSeed(42u));
+    }, 10u);
+    manager.RunApplyCommandBuffers();
+    EXPECT_EQ(chunks.size(), seeds.size());
+    return std::make_tuple(chunks, seeds,
+        manager.Component<IntComponent>(target)->Data());
+  };
+
+  const auto [chunks, seeds, value] = run(1u);
+  EXPECT_LT(1u, chunks.size());
+  EXPECT_EQ(1000u, chunks.rbegin()->second);
+
+  // Commands are applied in chunk order, so the last chunk wins
+  EXPECT_EQ(static_cast<int>(chunks.rbegin()->first), value);
+
+  for (unsigned int threads : {2u, 8u})
+  {
+    const auto [otherChunks, otherSeeds, otherValue] = run(threads);
+    EXPECT_EQ(chunks, otherChunks);
+    EXPECT_EQ(seeds, otherSeeds);
+    EXPECT_EQ(value, otherValue);
+  }
+
+  // States hash the same however they were built
+  EntityCompMgrTest other;
+  Entity otherTarget = other.CreateEntity();
+  other.CreateComponent<IntComponent>(otherTarget, IntComponent(value));
+  EXPECT_EQ(manager.StateHash(), other.StateHash());
+  EXPECT_EQ(manager.StateHash(), manager.StateHash());
+
+  other.Component<IntComponent>(otherTarget)->Data() = value + 1;
+  EXPECT_NE(manager.StateHash(), other.StateHash());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, StaticEntities)
+{
+  // world
+  //  - ground (static)
+  //    - groundLink
+  //  - robot
+  //    - robotLink
+  //    - sensor (static, but moves with the robot)
+  //      - sensorLink
+  Entity world = manager.CreateEntity();
+  auto create = [&](Entity _parent, std::optional<bool> _static)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent(entity, components::ParentEntity(_parent));
+    manager.CreateComponent(entity, components::Pose(math::Pose3d(1, 0, 0,
+        0, 0, 0)));
+    if (_static)
+      manager.CreateComponent(entity, components::Static(*_static));
+    return entity;
+  };
+  Entity ground = create(world, true);
+  Entity groundLink = create(ground, std::nullopt);
+  Entity robot = create(world, false);
+  Entity robotLink = create(robot, std::nullopt);
+  Entity sensor = create(robot, true);
+  Entity sensorLink = create(sensor, std::nullopt);
+
+  EXPECT_FALSE(manager.IsStatic(world));
+  EXPECT_TRUE(manager.IsStatic(ground));
+  EXPECT_TRUE(manager.IsStatic(groundLink));
+  EXPECT_FALSE(manager.IsStatic(robot));
+  EXPECT_FALSE(manager.IsStatic(robotLink));
+  EXPECT_FALSE(manager.IsStatic(sensor));
+  EXPECT_FALSE(manager.IsStatic(sensorLink));
+
+  // Only entities which may move are visited
+  std::set<Entity> dynamic;
+  manager.EachDynamic<components::Pose>(
+      [&](const Entity &_entity, const components::Pose *) -> bool
+      {
+        dynamic.insert(_entity);
+        return true;
+      });
+  EXPECT_EQ(std::set<Entity>({robot, robotLink, sensor, sensorLink}),
+      dynamic);
+
+  // Static poses are kept across iterations, and updated when marked as
+  // changed
+  EXPECT_EQ(math::Pose3d(2, 0, 0, 0, 0, 0),
+      manager.EntityWorldPose(groundLink));
+  manager.RunSetAllComponentsUnchanged();
+  EXPECT_EQ(math::Pose3d(2, 0, 0, 0, 0, 0),
+      manager.EntityWorldPose(groundLink));
+  manager.SetComponentData<components::Pose>(ground,
+      math::Pose3d(0, 0, 1, 0, 0, 0));
+  EXPECT_EQ(math::Pose3d(1, 0, 1, 0, 0, 0),
+      manager.EntityWorldPose(groundLink));
+
+  // Dynamic poses still follow changes made in place
+  EXPECT_EQ(math::Pose3d(2, 0, 0, 0, 0, 0),
+      manager.EntityWorldPose(robotLink));
+  manager.Component<components::Pose>(robot)->Data() =
+      math::Pose3d(0, 0, 2, 0, 0, 0);
+  manager.RunSetAllComponentsUnchanged();
+  EXPECT_EQ(math::Pose3d(1, 0, 2, 0, 0, 0),
+      manager.EntityWorldPose(robotLink));
+
+  // Making the robot static makes its whole subtree static
+  manager.SetComponentData<components::Static>(robot, true);
+  EXPECT_TRUE(manager.IsStatic(robotLink));
+  EXPECT_TRUE(manager.IsStatic(sensorLink));
+  dynamic.clear();
+  manager.EachDynamic<components::Pose>(
+      [&](const Entity &_entity, const components::Pose *) -> bool
+      {
+        dynamic.insert(_entity);
+        return true;
+      });
+  EXPECT_TRUE(dynamic.empty());
+
+  // New entities are picked up
+  Entity added = create(world, std::nullopt);
+  dynamic.clear();
+  manager.EachDynamic<components::Pose>(
+      [&](const Entity &_entity, const components::Pose *) -> bool
+      {
+        dynamic.insert(_entity);
+        return true;
+      });
+  EXPECT_EQ(std::set<Entity>({added}), dynamic);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, OverAlignedComponents)
+{
+  std::vector<Entity> entities;
+  for (int i = 0; i < 10; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent(entity, components::OverAlignedComponent());
+    entities.push_back(entity);
+  }
+
+  for (const Entity entity : entities)
+  {
+    auto comp = manager.Component<components::OverAlignedComponent>(entity);
+    ASSERT_NE(nullptr, comp);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(&comp->Data()) %
+        alignof(components::OverAligned));
+  }
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "EntityHierarchy.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Entities with ids below this are stored in the vector of nodes,
+/// which grows up to the largest id. It's large enough for any world, but
+/// keeps arbitrary ids, such as ones received from other processes, from
+/// growing the vector unboundedly.
+static constexpr Entity kMaxDenseEntity{1u << 22};
+
+/////////////////////////////////////////////////
+EntityHierarchy::Node *EntityHierarchy::Find(Entity _entity)
+{
+  return const_cast<Node *>(
+      static_cast<const EntityHierarchy *>(this)->Find(_entity));
+}
+
+/////////////////////////////////////////////////
+const EntityHierarchy::Node *EntityHierarchy::Find(Entity _entity) const
+{
+  if (_entity < kMaxDenseEntity)
+  {
+    if (_entity >= this->nodes.size() ||
+        this->nodes[_entity].generation == 0u)
+    {
+      return nullptr;
+    }
+    return &this->nodes[_entity];
+  }
+
+  auto iter = this->largeNodes.find(_entity);
+  return iter == this->largeNodes.end() ? nullptr : &iter->second;
+}
+
+/////////////////////////////////////////////////
+bool EntityHierarchy::Add(Entity _entity)
+{
+  if (_entity == kNullEntity || this->Has(_entity))
+    return false;
+
+  if (_entity < kMaxDenseEntity)
+  {
+    if (_entity >= this->nodes.size())
+      this->nodes.resize(_entity + 1u);
+    this->nodes[_entity] = Node();
+    this->nodes[_entity].generation = ++this->lastGeneration;
+  }
+  else
+  {
+    this->largeNodes[_entity].generation = ++this->lastGeneration;
+  }
+  ++this->count;
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool EntityHierarchy::Remove(Entity _entity)
+{
+  Node *node = this->Find(_entity);
+  if (!node)
+    return false;
+
+  this->Detach(*node);
+
+  for (Entity child = node->firstChild; child != kNullEntity;)
+  {
+    Node *childNode = this->Find(child);
+    child = childNode->nextSibling;
+    childNode->parent = kNullEntity;
+    childNode->prevSibling = kNullEntity;
+    childNode->nextSibling = kNullEntity;
+  }
+
+  if (_entity < kMaxDenseEntity)
+    this->nodes[_entity] = Node();
+  else
+    this->largeNodes.erase(_entity);
+  --this->count;
+  return true;
+}
+
+/////////////////////////////////////////////////
+void EntityHierarchy::Clear()
+{
+  this->nodes.clear();
+  this->largeNodes.clear();
+  this->count = 0u;
+}
+
+/////////////////////////////////////////////////
+bool EntityHierarchy::Has(Entity _entity) const
+{
+  return this->Find(_entity) != nullptr;
+}
+
+/////////////////////////////////////////////////
+std::size_t EntityHierarchy::Size() const
+{
+  return this->count;
+}
+
+/////////////////////////////////////////////////
+uint64_t EntityHierarchy::Generation(Entity _entity) const
+{
+  const Node *node = this->Find(_entity);
+  return node ? node->generation : 0u;
+}
+
+/////////////////////////////////////////////////
+Entity EntityHierarchy::Parent(Entity _entity) const
+{
+  const Node *node = this->Find(_entity);
+  return node ? node->parent : kNullEntity;
+}
+
+/////////////////////////////////////////////////
+bool EntityHierarchy::SetParent(Entity _child, Entity _parent)
+{
+  Node *childNode = this->Find(_child);
+  if (!childNode)
+    return false;
+
+  this->Detach(*childNode);
+
+  if (_parent == kNullEntity)
+    return true;
+
+  Node *parentNode = this->Find(_parent);
+  if (!parentNode)
+    return false;
+
+  // Refuse cycles, which would make walking descendants loop forever
+  for (Entity ancestor = _parent; ancestor != kNullEntity;
+       ancestor = this->Parent(ancestor))
+  {
+    if (ancestor == _child)
+      return false;
+  }
+
+  childNode->parent = _parent;
+  childNode->nextSibling = parentNode->firstChild;
+  if (parentNode->firstChild != kNullEntity)
+    this->Find(parentNode->firstChild)->prevSibling = _child;
+  parentNode->firstChild = _child;
+  return true;
+}
+
+/////////////////////////////////////////////////
+void EntityHierarchy::Detach(Node &_node)
+{
+  if (_node.parent == kNullEntity)
+    return;
+
+  if (_node.prevSibling != kNullEntity)
+    this->Find(_node.prevSibling)->nextSibling = _node.nextSibling;
+  else
+    this->Find(_node.parent)->firstChild = _node.nextSibling;
+
+  if (_node.nextSibling != kNullEntity)
+    this->Find(_node.nextSibling)->prevSibling = _node.prevSibling;
+
+  _node.parent = kNullEntity;
+  _node.prevSibling = kNullEntity;
+  _node.nextSibling = kNullEntity;
+}
+
+/////////////////////////////////////////////////
+Entity EntityHierarchy::FirstChild(Entity _entity) const
+{
+  const Node *node = this->Find(_entity);
+  return node ? node->firstChild : kNullEntity;
+}
+
+/////////////////////////////////////////////////
+Entity EntityHierarchy::NextSibling(Entity _entity) const
+{
+  const Node *node = this->Find(_entity);
+  return node ? node->nextSibling : kNullEntity;
+}
+
+/////////////////////////////////////////////////
+void EntityHierarchy::Descendants(Entity _entity,
+    std::vector<Entity> &_descendants) const
+{
+  _descendants.clear();
+  if (!this->Has(_entity))
+    return;
+
+  // The output doubles as the queue of the breadth first walk
+  _descendants.push_back(_entity);
+  for (std::size_t i = 0; i < _descendants.size(); ++i)
+  {
+    for (Entity child = this->FirstChild(_descendants[i]);
+         child != kNullEntity; child = this->NextSibling(child))
+    {
+      _descendants.push_back(child);
+    }
+  }
+}
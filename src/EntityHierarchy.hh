@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_ENTITYHIERARCHY_HH_
+#define IGNITION_GAZEBO_ENTITYHIERARCHY_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class EntityHierarchy EntityHierarchy.hh
+    /// \brief Parent / child relationships of all entities of an entity
+    /// component manager.
+    ///
+    /// Each entity has a node holding its parent, its first child and its
+    /// previous and next siblings, so looking up a parent, adding, removing
+    /// or reparenting an entity are constant time, and children and
+    /// descendants can be walked without allocating. Entity ids are
+    /// allocated sequentially, so nodes are stored in a vector indexed by
+    /// id, with a map for the rare ids too large for it.
+    ///
+    /// Children are walked in the reverse order they were added.
+    ///
+    /// Nodes also hold the generation of their entity, which lets handles
+    /// to entities be checked with a single lookup and comparison.
+    class IGNITION_GAZEBO_VISIBLE EntityHierarchy
+    {
+      /// \brief Add an entity without a parent.
+      /// \param[in] _entity Entity to add.
+      /// \return False if _entity is null or already exists.
+      public: bool Add(Entity _entity);
+
+      /// \brief Remove an entity. Its children are left without a parent.
+      /// \param[in] _entity Entity to remove.
+      /// \return False if _entity doesn't exist.
+      public: bool Remove(Entity _entity);
+
+      /// \brief Remove all entities.
+      public: void Clear();
+
+      /// \brief Whether an entity exists.
+      /// \param[in] _entity Entity to check.
+      /// \return True if it exists.
+      public: bool Has(Entity _entity) const;
+
+      /// \brief Number of entities.
+      /// \return Entity count.
+      public: std::size_t Size() const;
+
+      /// \brief Get the generation of an entity. Each time an entity is
+      /// added it gets a new generation, distinct from the ones of all
+      /// entities added before, including previous entities with the same
+      /// id. Clearing doesn't reset generations.
+      /// \param[in] _entity The entity.
+      /// \return The generation, or zero if the entity doesn't exist.
+      public: uint64_t Generation(Entity _entity) const;
+
+      /// \brief Get the parent of an entity.
+      /// \param[in] _entity The entity.
+      /// \return The parent, or kNullEntity if it has none or doesn't
+      /// exist.
+      public: Entity Parent(Entity _entity) const;
+
+      /// \brief Set the parent of an entity, detaching it from its current
+      /// parent first.
+      /// \param[in] _child The entity.
+      /// \param[in] _parent New parent, kNullEntity to leave it without one.
+      /// \return False if _child doesn't exist, or if _parent doesn't exist
+      /// or is _child or one of its descendants. _child is detached anyway
+      /// as long as it exists.
+      public: bool SetParent(Entity _child, Entity _parent);
+
+      /// \brief Get the first child of an entity.
+      /// \param[in] _entity The entity.
+      /// \return First child, kNullEntity if there's none.
+      public: Entity FirstChild(Entity _entity) const;
+
+      /// \brief Get the next sibling of an entity.
+      /// \param[in] _entity The entity.
+      /// \return Next sibling, kNullEntity if there's none.
+      public: Entity NextSibling(Entity _entity) const;
+
+      /// \brief Get an entity and all its descendants, breadth first.
+      /// \param[in] _entity The entity.
+      /// \param[out] _descendants Filled with _entity and its descendants.
+      /// It's cleared first, and reusing it avoids allocating. Empty if
+      /// _entity doesn't exist.
+      public: void Descendants(Entity _entity,
+                  std::vector<Entity> &_descendants) const;
+
+      /// \brief Call a function for an entity and each of its descendants,
+      /// depth first, without allocating. The hierarchy must not be
+      /// modified while walking it.
+      /// \param[in] _entity The entity.
+      /// \param[in] _f Function to call, returning false to stop.
+      public: template <typename FunctionT>
+              void EachDescendant(Entity _entity, FunctionT &&_f) const
+      {
+        if (!this->Has(_entity) || !_f(_entity))
+          return;
+
+        Entity current = this->FirstChild(_entity);
+        while (current != kNullEntity)
+        {
+          if (!_f(current))
+            return;
+
+          // Go down if possible, otherwise to the next sibling of the
+          // closest ancestor which has one, without leaving _entity
+          Entity next = this->FirstChild(current);
+          for (Entity node = current; next == kNullEntity && node != _entity;
+               node = this->Parent(node))
+          {
+            next = this->NextSibling(node);
+          }
+          current = next;
+        }
+      }
+
+      /// \brief Call a function for each entity, in ascending order.
+      /// \param[in] _f Function to call, returning false to stop.
+      public: template <typename FunctionT>
+              void Each(FunctionT &&_f) const
+      {
+        for (std::size_t i = 1; i < this->nodes.size(); ++i)
+        {
+          if (this->nodes[i].generation != 0u &&
+              !_f(static_cast<Entity>(i)))
+            return;
+        }
+
+        if (this->largeNodes.empty())
+          return;
+
+        std::vector<Entity> large;
+        large.reserve(this->largeNodes.size());
+        for (const auto &node : this->largeNodes)
+          large.push_back(node.first);
+        std::sort(large.begin(), large.end());
+        for (const Entity entity : large)
+        {
+          if (!_f(entity))
+            return;
+        }
+      }
+
+      /// \brief Links of an entity.
+      private: struct Node
+      {
+        /// \brief Parent, kNullEntity if none.
+        Entity parent{kNullEntity};
+
+        /// \brief First child, kNullEntity if none.
+        Entity firstChild{kNullEntity};
+
+        /// \brief Previous sibling, kNullEntity if none.
+        Entity prevSibling{kNullEntity};
+
+        /// \brief Next sibling, kNullEntity if none.
+        Entity nextSibling{kNullEntity};
+
+        /// \brief Generation of the entity, zero if it doesn't exist.
+        uint64_t generation{0u};
+      };
+
+      /// \brief Get the node of an entity.
+      /// \param[in] _entity The entity.
+      /// \return The node, or null if the entity doesn't exist.
+      private: Node *Find(Entity _entity);
+
+      /// \copydoc Find
+      private: const Node *Find(Entity _entity) const;
+
+      /// \brief Remove an entity from the children of its parent.
+      /// \param[in] _node Node of the entity.
+      private: void Detach(Node &_node);
+
+      /// \brief Nodes of entities with small ids, indexed by id.
+      private: std::vector<Node> nodes;
+
+      /// \brief Nodes of entities whose ids are too large for nodes.
+      private: std::unordered_map<Entity, Node> largeNodes;
+
+      /// \brief Number of entities.
+      private: std::size_t count{0u};
+
+      /// \brief Last generation given to an added entity.
+      private: uint64_t lastGeneration{0u};
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "EntityHierarchy.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(EntityHierarchy, AddRemove)
+{
+  EntityHierarchy hierarchy;
+  EXPECT_EQ(0u, hierarchy.Size());
+  EXPECT_FALSE(hierarchy.Add(kNullEntity));
+
+  EXPECT_TRUE(hierarchy.Add(1));
+  EXPECT_TRUE(hierarchy.Add(5));
+  EXPECT_FALSE(hierarchy.Add(5));
+  EXPECT_EQ(2u, hierarchy.Size());
+  EXPECT_TRUE(hierarchy.Has(5));
+  EXPECT_FALSE(hierarchy.Has(4));
+
+  // Ids too large for the vector
+  const Entity large{1ull << 40};
+  EXPECT_TRUE(hierarchy.Add(large));
+  EXPECT_TRUE(hierarchy.Has(large));
+  EXPECT_TRUE(hierarchy.SetParent(large, 1));
+  EXPECT_EQ(1u, hierarchy.Parent(large));
+
+  std::vector<Entity> all;
+  hierarchy.Each([&](Entity _entity)
+  {
+    all.push_back(_entity);
+    return true;
+  });
+  EXPECT_EQ((std::vector<Entity>{1, 5, large}), all);
+
+  EXPECT_TRUE(hierarchy.Remove(5));
+  EXPECT_FALSE(hierarchy.Remove(5));
+  EXPECT_FALSE(hierarchy.Has(5));
+  EXPECT_EQ(2u, hierarchy.Size());
+
+  hierarchy.Clear();
+  EXPECT_EQ(0u, hierarchy.Size());
+  EXPECT_FALSE(hierarchy.Has(1));
+  EXPECT_FALSE(hierarchy.Has(large));
+}
+
+/////////////////////////////////////////////////
+TEST(EntityHierarchy, Parenting)
+{
+  /*        1
+   *      /   \
+   *     2     3
+   *    / \
+   *   4   5
+   */
+  EntityHierarchy hierarchy;
+  for (Entity entity = 1; entity <= 5; ++entity)
+    EXPECT_TRUE(hierarchy.Add(entity));
+
+  EXPECT_TRUE(hierarchy.SetParent(2, 1));
+  EXPECT_TRUE(hierarchy.SetParent(3, 1));
+  EXPECT_TRUE(hierarchy.SetParent(4, 2));
+  EXPECT_TRUE(hierarchy.SetParent(5, 2));
+  EXPECT_EQ(kNullEntity, hierarchy.Parent(1));
+  EXPECT_EQ(2u, hierarchy.Parent(4));
+  EXPECT_EQ(kNullEntity, hierarchy.Parent(100));
+
+  std::vector<Entity> children;
+  for (Entity child = hierarchy.FirstChild(2); child != kNullEntity;
+       child = hierarchy.NextSibling(child))
+  {
+    children.push_back(child);
+  }
+  std::sort(children.begin(), children.end());
+  EXPECT_EQ((std::vector<Entity>{4, 5}), children);
+
+  std::vector<Entity> descendants;
+  hierarchy.Descendants(1, descendants);
+  ASSERT_EQ(5u, descendants.size());
+  EXPECT_EQ(1u, descendants.front());
+  hierarchy.Descendants(3, descendants);
+  EXPECT_EQ((std::vector<Entity>{3}), descendants);
+  hierarchy.Descendants(100, descendants);
+  EXPECT_TRUE(descendants.empty());
+
+  std::vector<Entity> visited;
+  auto visit = [&](Entity _entity)
+  {
+    visited.push_back(_entity);
+    return true;
+  };
+  hierarchy.EachDescendant(1, visit);
+  ASSERT_EQ(5u, visited.size());
+  EXPECT_EQ(1u, visited.front());
+  std::sort(visited.begin(), visited.end());
+  EXPECT_EQ((std::vector<Entity>{1, 2, 3, 4, 5}), visited);
+
+  // Depth first, staying within the subtree
+  visited.clear();
+  hierarchy.EachDescendant(2, visit);
+  ASSERT_EQ(3u, visited.size());
+  EXPECT_EQ(2u, visited[0]);
+  std::sort(visited.begin(), visited.end());
+  EXPECT_EQ((std::vector<Entity>{2, 4, 5}), visited);
+
+  visited.clear();
+  hierarchy.EachDescendant(5, visit);
+  EXPECT_EQ((std::vector<Entity>{5}), visited);
+
+  visited.clear();
+  hierarchy.EachDescendant(100, visit);
+  EXPECT_TRUE(visited.empty());
+
+  // Stopping early
+  std::size_t count{0u};
+  hierarchy.EachDescendant(1, [&](Entity)
+  {
+    return ++count < 2u;
+  });
+  EXPECT_EQ(2u, count);
+
+  // Missing entities and cycles are refused
+  EXPECT_FALSE(hierarchy.SetParent(100, 1));
+  EXPECT_FALSE(hierarchy.SetParent(3, 100));
+  EXPECT_EQ(kNullEntity, hierarchy.Parent(3));
+  EXPECT_FALSE(hierarchy.SetParent(1, 4));
+  EXPECT_FALSE(hierarchy.SetParent(1, 1));
+  EXPECT_EQ(kNullEntity, hierarchy.Parent(1));
+
+  // Reparent
+  EXPECT_TRUE(hierarchy.SetParent(3, 1));
+  EXPECT_TRUE(hierarchy.SetParent(4, 3));
+  EXPECT_EQ(3u, hierarchy.Parent(4));
+  hierarchy.Descendants(2, descendants);
+  EXPECT_EQ((std::vector<Entity>{2, 5}), descendants);
+
+  // Removing an entity orphans its children
+  EXPECT_TRUE(hierarchy.Remove(3));
+  EXPECT_EQ(kNullEntity, hierarchy.Parent(4));
+  hierarchy.Descendants(1, descendants);
+  std::sort(descendants.begin(), descendants.end());
+  EXPECT_EQ((std::vector<Entity>{1, 2, 5}), descendants);
+}
+
+/////////////////////////////////////////////////
+TEST(EntityHierarchy, Generation)
+{
+  EntityHierarchy hierarchy;
+  EXPECT_EQ(0u, hierarchy.Generation(1));
+
+  EXPECT_TRUE(hierarchy.Add(1));
+  EXPECT_TRUE(hierarchy.Add(2));
+  const uint64_t first = hierarchy.Generation(1);
+  EXPECT_NE(0u, first);
+  EXPECT_NE(first, hierarchy.Generation(2));
+
+  // Reparenting keeps the generation
+  EXPECT_TRUE(hierarchy.SetParent(2, 1));
+  EXPECT_EQ(first, hierarchy.Generation(1));
+
+  // Re-adding an id gives it a new generation, also after clearing
+  EXPECT_TRUE(hierarchy.Remove(1));
+  EXPECT_EQ(0u, hierarchy.Generation(1));
+  EXPECT_TRUE(hierarchy.Add(1));
+  const uint64_t second = hierarchy.Generation(1);
+  EXPECT_NE(0u, second);
+  EXPECT_NE(first, second);
+
+  hierarchy.Clear();
+  EXPECT_EQ(0u, hierarchy.Generation(1));
+  EXPECT_TRUE(hierarchy.Add(1));
+  EXPECT_NE(first, hierarchy.Generation(1));
+  EXPECT_NE(second, hierarchy.Generation(1));
+
+  const Entity large{1ull << 40};
+  EXPECT_TRUE(hierarchy.Add(large));
+  EXPECT_NE(0u, hierarchy.Generation(large));
+}
@@ -0,0 +1,340 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ignition/gazebo/EnvironmentalForces.hh"
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "ignition/gazebo/components/AngularVelocity.hh"
+#include "ignition/gazebo/components/Inertial.hh"
+#include "ignition/gazebo/components/LinearVelocity.hh"
+#include "ignition/gazebo/components/Link.hh"
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/Link.hh"
+#include "ignition/gazebo/TraceRecorder.hh"
+#include "ignition/gazebo/Util.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Private data of EnvironmentalForces
+class ignition::gazebo::EnvironmentalForcesPrivate
+{
+  /// \brief Read the kinematics of all links and clear their wrenches.
+  /// \param[in] _ecm Entity component manager.
+  public: void Gather(const EntityComponentManager &_ecm);
+
+  /// \brief Apply the accumulated wrenches to the links.
+  /// \param[in] _ecm Mutable entity component manager.
+  public: void Scatter(EntityComponentManager &_ecm) const;
+
+  /// \brief Rebuild the set of models waited for, and drop the links which
+  /// are being removed, at the start of a step.
+  /// \param[in] _ecm Entity component manager.
+  public: void Rebuild(const EntityComponentManager &_ecm);
+
+  /// \brief A registered force model.
+  public: struct RegisteredModel
+  {
+    /// \brief Function which computes the forces.
+    EnvironmentalForces::ForceModel model;
+
+    /// \brief Last iteration for which the system of the model called
+    /// Update.
+    std::optional<uint64_t> readyIteration;
+
+    /// \brief Entity the model's system is attached to.
+    Entity owner{kNullEntity};
+
+    /// \brief Whether the model is waited for, false until the first
+    /// rebuild after it was registered.
+    bool waited{false};
+  };
+
+  /// \brief Kinematics and wrenches of all links.
+  public: LinkKinematics links;
+
+  /// \brief Slot of each link in the batch.
+  public: std::unordered_map<Entity, std::size_t> slots;
+
+  /// \brief Registered models, evaluated in registration order.
+  public: std::map<EnvironmentalForces::ModelId, RegisteredModel> models;
+
+  /// \brief Identifier of the next registered model.
+  public: EnvironmentalForces::ModelId nextModelId{0};
+
+  /// \brief Last iteration for which the models were evaluated.
+  public: std::optional<uint64_t> evaluatedIteration;
+
+  /// \brief Last iteration for which the set of models was rebuilt.
+  public: std::optional<uint64_t> rebuiltIteration;
+
+  /// \brief Protects all members, since systems may update concurrently.
+  public: mutable std::mutex mutex;
+};
+
+//////////////////////////////////////////////////
+void EnvironmentalForcesPrivate::Gather(const EntityComponentManager &_ecm)
+{
+  IGN_GAZEBO_PROFILE("EnvironmentalForces::Gather");
+  for (std::size_t i = 0; i < this->links.Size(); ++i)
+  {
+    const Entity entity = this->links.entities[i];
+    this->links.forces[i] = math::Vector3d::Zero;
+    this->links.torques[i] = math::Vector3d::Zero;
+
+    auto worldPose = _ecm.Component<components::WorldPose>(entity);
+    this->links.valid[i] = nullptr != worldPose;
+    if (!worldPose)
+    {
+      // Links added back while being removed are dropped once they're gone
+      if (entity != kNullEntity && !_ecm.HasEntity(entity))
+      {
+        this->slots.erase(entity);
+        this->links.entities[i] = kNullEntity;
+      }
+      continue;
+    }
+
+    const auto &pose = worldPose->Data();
+    this->links.worldPoses[i] = pose;
+
+    auto linVel = _ecm.Component<components::WorldLinearVelocity>(entity);
+    this->links.linearVelocities[i] =
+        linVel ? linVel->Data() : math::Vector3d::Zero;
+
+    auto angVel = _ecm.Component<components::WorldAngularVelocity>(entity);
+    this->links.angularVelocities[i] =
+        angVel ? angVel->Data() : math::Vector3d::Zero;
+
+    auto inertial = _ecm.Component<components::Inertial>(entity);
+    if (inertial)
+    {
+      this->links.masses[i] = inertial->Data().MassMatrix().Mass();
+      this->links.comOffsets[i] =
+          pose.Rot().RotateVector(inertial->Data().Pose().Pos());
+    }
+    else
+    {
+      this->links.masses[i] = 0.0;
+      this->links.comOffsets[i] = math::Vector3d::Zero;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void EnvironmentalForcesPrivate::Scatter(EntityComponentManager &_ecm) const
+{
+  IGN_GAZEBO_PROFILE("EnvironmentalForces::Scatter");
+  Link link;
+  for (std::size_t i = 0; i < this->links.Size(); ++i)
+  {
+    if (!this->links.valid[i])
+      continue;
+
+    const auto &force = this->links.forces[i];
+    const auto &torque = this->links.torques[i];
+    if (force == math::Vector3d::Zero && torque == math::Vector3d::Zero)
+      continue;
+
+    link.ResetEntity(this->links.entities[i]);
+    link.AddWorldWrench(_ecm, force, torque);
+  }
+}
+
+//////////////////////////////////////////////////
+void EnvironmentalForcesPrivate::Rebuild(const EntityComponentManager &_ecm)
+{
+  // Removed links keep their slot, which becomes invalid
+  _ecm.EachRemoved<components::Link>(
+      [&](const Entity &_entity, const components::Link *) -> bool
+      {
+        auto it = this->slots.find(_entity);
+        if (it == this->slots.end())
+          return true;
+
+        this->links.entities[it->second] = kNullEntity;
+        this->links.valid[it->second] = 0;
+        this->slots.erase(it);
+        return true;
+      });
+
+  std::unordered_set<Entity> removedModels;
+  _ecm.EachRemoved<components::Model>(
+      [&](const Entity &_entity, const components::Model *) -> bool
+      {
+        removedModels.insert(_entity);
+        return true;
+      });
+
+  for (auto it = this->models.begin(); it != this->models.end();)
+  {
+    const Entity owner = it->second.owner;
+    if (owner != kNullEntity &&
+        (removedModels.count(owner) > 0 || !_ecm.HasEntity(owner)))
+    {
+      it = this->models.erase(it);
+      continue;
+    }
+    it->second.waited = true;
+    ++it;
+  }
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<EnvironmentalForces> EnvironmentalForces::For(
+    const EntityComponentManager &_ecm)
+{
+  static std::mutex mutex;
+  static std::unordered_map<const EntityComponentManager *,
+      std::weak_ptr<EnvironmentalForces>> stages;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // Forget stages which are no longer used
+  for (auto it = stages.begin(); it != stages.end();)
+  {
+    if (it->second.expired())
+      it = stages.erase(it);
+    else
+      ++it;
+  }
+
+  auto &weak = stages[&_ecm];
+  auto stage = weak.lock();
+  if (!stage)
+  {
+    stage = std::make_shared<EnvironmentalForces>();
+    weak = stage;
+  }
+  return stage;
+}
+
+//////////////////////////////////////////////////
+EnvironmentalForces::EnvironmentalForces()
+  : dataPtr(std::make_unique<EnvironmentalForcesPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+EnvironmentalForces::~EnvironmentalForces() = default;
+
+//////////////////////////////////////////////////
+std::size_t EnvironmentalForces::AddLink(EntityComponentManager &_ecm,
+    Entity _link)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  auto it = this->dataPtr->slots.find(_link);
+  if (it != this->dataPtr->slots.end())
+    return it->second;
+
+  // Physics keeps the world pose up to date from now on
+  if (!_ecm.Component<components::WorldPose>(_link))
+    _ecm.CreateComponent(_link, components::WorldPose(worldPose(_link, _ecm)));
+  Link(_link).EnableVelocityChecks(_ecm, true);
+
+  auto &links = this->dataPtr->links;
+  const std::size_t slot = links.Size();
+  links.entities.push_back(_link);
+  links.valid.push_back(0);
+  links.worldPoses.emplace_back();
+  links.linearVelocities.emplace_back();
+  links.angularVelocities.emplace_back();
+  links.masses.push_back(0.0);
+  links.comOffsets.emplace_back();
+  links.forces.emplace_back();
+  links.torques.emplace_back();
+
+  this->dataPtr->slots[_link] = slot;
+  return slot;
+}
+
+//////////////////////////////////////////////////
+EnvironmentalForces::ModelId EnvironmentalForces::AddModel(ForceModel _model,
+    Entity _owner)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  const ModelId id = this->dataPtr->nextModelId++;
+  auto &registered = this->dataPtr->models[id];
+  registered.model = std::move(_model);
+  registered.owner = _owner;
+  return id;
+}
+
+//////////////////////////////////////////////////
+void EnvironmentalForces::RemoveModel(ModelId _id)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->models.erase(_id);
+}
+
+//////////////////////////////////////////////////
+void EnvironmentalForces::Update(const UpdateInfo &_info,
+    EntityComponentManager &_ecm, ModelId _id)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  if (this->dataPtr->rebuiltIteration != _info.iterations)
+  {
+    this->dataPtr->Rebuild(_ecm);
+    this->dataPtr->rebuiltIteration = _info.iterations;
+  }
+
+  auto it = this->dataPtr->models.find(_id);
+  if (it == this->dataPtr->models.end())
+    return;
+  it->second.readyIteration = _info.iterations;
+
+  if (this->dataPtr->evaluatedIteration == _info.iterations)
+    return;
+
+  // Wait for the other systems, which may still add links. Models
+  // registered during this step aren't waited for, since their system may
+  // have run already.
+  for (const auto &model : this->dataPtr->models)
+  {
+    if (model.second.waited &&
+        model.second.readyIteration != _info.iterations)
+    {
+      return;
+    }
+  }
+
+  IGN_GAZEBO_PROFILE("EnvironmentalForces::Update");
+  this->dataPtr->evaluatedIteration = _info.iterations;
+
+  this->dataPtr->Gather(_ecm);
+  for (const auto &model : this->dataPtr->models)
+  {
+    if (model.second.readyIteration == _info.iterations)
+      model.second.model(_info, _ecm, this->dataPtr->links);
+  }
+  this->dataPtr->Scatter(_ecm);
+}
+
+//////////////////////////////////////////////////
+const LinkKinematics &EnvironmentalForces::Links() const
+{
+  return this->dataPtr->links;
+}
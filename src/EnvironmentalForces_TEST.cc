@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ignition/math/Inertial.hh>
+#include <ignition/msgs/Utility.hh>
+
+#include "ignition/gazebo/EnvironmentalForces.hh"
+#include "ignition/gazebo/components/ExternalWorldWrenchCmd.hh"
+#include "ignition/gazebo/components/Inertial.hh"
+#include "ignition/gazebo/components/LinearVelocity.hh"
+#include "ignition/gazebo/components/Link.hh"
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Pose.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(EnvironmentalForces, SharedPerEcm)
+{
+  EntityComponentManager ecm;
+  EntityComponentManager otherEcm;
+
+  auto stage = EnvironmentalForces::For(ecm);
+  ASSERT_NE(nullptr, stage);
+  EXPECT_EQ(stage, EnvironmentalForces::For(ecm));
+  EXPECT_NE(stage, EnvironmentalForces::For(otherEcm));
+}
+
+/////////////////////////////////////////////////
+TEST(EnvironmentalForces, SingleWrenchPerLink)
+{
+  EntityComponentManager ecm;
+
+  math::MassMatrix3d massMatrix;
+  massMatrix.SetMass(2.0);
+  math::Inertiald inertial;
+  inertial.SetMassMatrix(massMatrix);
+  inertial.SetPose({0, 0, 1, 0, 0, 0});
+
+  auto link = ecm.CreateEntity();
+  ecm.CreateComponent(link, components::Link());
+  ecm.CreateComponent(link, components::Pose());
+  ecm.CreateComponent(link, components::Inertial(inertial));
+
+  auto stage = EnvironmentalForces::For(ecm);
+  auto slot = stage->AddLink(ecm, link);
+  EXPECT_EQ(slot, stage->AddLink(ecm, link));
+
+  // Components of the kinematics are created
+  EXPECT_NE(nullptr, ecm.Component<components::WorldPose>(link));
+  auto linVel = ecm.Component<components::WorldLinearVelocity>(link);
+  ASSERT_NE(nullptr, linVel);
+  *linVel = components::WorldLinearVelocity({1, 0, 0});
+
+  // A model which pushes against the velocity, at the center of mass
+  auto drag = stage->AddModel(
+      [&](const UpdateInfo &, const EntityComponentManager &,
+          LinkKinematics &_links)
+      {
+        EXPECT_TRUE(_links.valid[slot]);
+        _links.AddWorldForce(slot,
+            -_links.masses[slot] * _links.linearVelocities[slot]);
+      });
+
+  // A model which applies a wrench at the link origin
+  auto lift = stage->AddModel(
+      [&](const UpdateInfo &, const EntityComponentManager &,
+          LinkKinematics &_links)
+      {
+        _links.AddWorldWrench(slot, {0, 0, 10}, {0, 0, 1});
+      });
+
+  UpdateInfo info;
+  info.iterations = 1;
+
+  // Nothing is applied until all models are ready
+  stage->Update(info, ecm, drag);
+  EXPECT_EQ(nullptr, ecm.Component<components::ExternalWorldWrenchCmd>(link));
+
+  stage->Update(info, ecm, lift);
+  auto wrench = ecm.Component<components::ExternalWorldWrenchCmd>(link);
+  ASSERT_NE(nullptr, wrench);
+  EXPECT_EQ(math::Vector3d(-2, 0, 10), msgs::Convert(wrench->Data().force()));
+  // The drag at the center of mass adds a torque about the link origin
+  EXPECT_EQ(math::Vector3d(0, -2, 1), msgs::Convert(wrench->Data().torque()));
+
+  // Models are evaluated once per iteration
+  stage->Update(info, ecm, drag);
+  EXPECT_EQ(math::Vector3d(-2, 0, 10), msgs::Convert(wrench->Data().force()));
+
+  // Removed models are neither waited for nor evaluated
+  stage->RemoveModel(lift);
+  info.iterations = 2;
+  stage->Update(info, ecm, drag);
+  EXPECT_EQ(math::Vector3d(-4, 0, 10), msgs::Convert(wrench->Data().force()));
+}
+
+/////////////////////////////////////////////////
+TEST(EnvironmentalForces, ChangingModels)
+{
+  EntityComponentManager ecm;
+
+  auto model = ecm.CreateEntity();
+  ecm.CreateComponent(model, components::Model());
+  auto link = ecm.CreateEntity();
+  ecm.CreateComponent(link, components::Link());
+  ecm.CreateComponent(link, components::Pose());
+  ecm.CreateComponent(link, components::ParentEntity(model));
+
+  auto stage = EnvironmentalForces::For(ecm);
+  auto slot = stage->AddLink(ecm, link);
+
+  int worldCount{0};
+  auto world = stage->AddModel(
+      [&](const UpdateInfo &, const EntityComponentManager &,
+          LinkKinematics &)
+      {
+        ++worldCount;
+      });
+
+  int modelCount{0};
+  auto owned = stage->AddModel(
+      [&](const UpdateInfo &, const EntityComponentManager &,
+          LinkKinematics &)
+      {
+        ++modelCount;
+      }, model);
+
+  UpdateInfo info;
+  info.iterations = 1;
+  stage->Update(info, ecm, world);
+  EXPECT_EQ(0, worldCount);
+  stage->Update(info, ecm, owned);
+  EXPECT_EQ(1, worldCount);
+  EXPECT_EQ(1, modelCount);
+  EXPECT_TRUE(stage->Links().valid[slot]);
+
+  // A model registered once the step's first system arrived isn't waited
+  // for until the next step
+  info.iterations = 2;
+  stage->Update(info, ecm, world);
+  int lateCount{0};
+  auto late = stage->AddModel(
+      [&](const UpdateInfo &, const EntityComponentManager &,
+          LinkKinematics &)
+      {
+        ++lateCount;
+      });
+  stage->Update(info, ecm, owned);
+  EXPECT_EQ(2, worldCount);
+  EXPECT_EQ(0, lateCount);
+
+  info.iterations = 3;
+  stage->Update(info, ecm, world);
+  stage->Update(info, ecm, owned);
+  EXPECT_EQ(2, worldCount);
+  stage->Update(info, ecm, late);
+  EXPECT_EQ(3, worldCount);
+  EXPECT_EQ(1, lateCount);
+
+  // Once the owner is being removed, its model isn't waited for anymore
+  // and its links leave the batch
+  ecm.RequestRemoveEntity(model);
+  info.iterations = 4;
+  stage->Update(info, ecm, world);
+  EXPECT_EQ(3, worldCount);
+  stage->Update(info, ecm, late);
+  EXPECT_EQ(4, worldCount);
+  EXPECT_EQ(3, modelCount);
+  EXPECT_FALSE(stage->Links().valid[slot]);
+  EXPECT_EQ(kNullEntity, stage->Links().entities[slot]);
+
+  // Its system's calls are ignored
+  stage->Update(info, ecm, owned);
+  EXPECT_EQ(3, modelCount);
+}
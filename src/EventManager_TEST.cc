@@ -18,6 +18,10 @@
 #include <gtest/gtest.h>
 
 #include <atomic>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "ignition/gazebo/Events.hh"
 #include "ignition/gazebo/EventManager.hh"
@@ -119,3 +123,63 @@ TEST(EventManager, Disambiguate)
   EXPECT_EQ(1, calls);
 }
 
+
+/////////////////////////////////////////////////
+TEST(EventManager, Handle)
+{
+  EventManager eventManager;
+  auto *pause = eventManager.Handle<events::Pause>();
+  ASSERT_NE(nullptr, pause);
+  EXPECT_EQ(pause, eventManager.Handle<events::Pause>());
+
+  // Subscribers connected before and after the lookup are called
+  int calls{0};
+  auto connection1 = eventManager.Connect<events::Pause>(
+      [&](bool) { ++calls; });
+  pause->Signal(true);
+  EXPECT_EQ(1, calls);
+
+  eventManager.Emit<events::Pause>(true);
+  EXPECT_EQ(2, calls);
+}
+
+/////////////////////////////////////////////////
+TEST(EventManager, EmitAsync)
+{
+  using TestEvent = ignition::common::EventT<void(int, std::string),
+      struct AsyncTestEventTag>;
+
+  EventManager eventManager;
+  std::vector<std::pair<int, std::string>> received;
+  std::thread::id subscriberThread;
+  auto connection = eventManager.Connect<TestEvent>(
+      [&](int _count, std::string _name)
+      {
+        subscriberThread = std::this_thread::get_id();
+        received.push_back({_count, _name});
+      });
+
+  auto *event = eventManager.Handle<TestEvent>();
+  ASSERT_NE(nullptr, event);
+
+  // Arguments are copied, so they may go out of scope
+  for (int i = 0; i < 10; ++i)
+  {
+    std::string name = "event" + std::to_string(i);
+    eventManager.EmitAsync(event, i, name);
+  }
+  eventManager.FlushAsync();
+  ASSERT_EQ(10u, received.size());
+  EXPECT_NE(std::this_thread::get_id(), subscriberThread);
+
+  // Delivered in order
+  for (int i = 0; i < 10; ++i)
+  {
+    EXPECT_EQ(i, received[i].first);
+    EXPECT_EQ("event" + std::to_string(i), received[i].second);
+  }
+
+  // Flushing without pending events returns right away
+  eventManager.FlushAsync();
+  EXPECT_EQ(10u, received.size());
+}
@@ -161,18 +161,13 @@ std::optional<sdf::JointType> Joint::Type(
 Entity Joint::SensorByName(const EntityComponentManager &_ecm,
     const std::string &_name) const
 {
-  return _ecm.EntityByComponents(
-      components::ParentEntity(this->dataPtr->id),
-      components::Name(_name),
-      components::Sensor());
+  return _ecm.ChildByName<components::Sensor>(this->dataPtr->id, _name);
 }
 
 //////////////////////////////////////////////////
 std::vector<Entity> Joint::Sensors(const EntityComponentManager &_ecm) const
 {
-  return _ecm.EntitiesByComponents(
-      components::ParentEntity(this->dataPtr->id),
-      components::Sensor());
+  return _ecm.ChildrenWithComponents<components::Sensor>(this->dataPtr->id);
 }
 
 //////////////////////////////////////////////////
@@ -18,18 +18,29 @@
 #include "LevelManager.hh"
 
 #include <algorithm>
+#include <chrono>
+#include <unordered_set>
+#include <vector>
 
 #include <sdf/Actor.hh>
 #include <sdf/Atmosphere.hh>
+#include <sdf/Box.hh>
+#include <sdf/Collision.hh>
 #include <sdf/Light.hh>
+#include <sdf/Link.hh>
+#include <sdf/Mesh.hh>
 #include <sdf/Model.hh>
+#include <sdf/Visual.hh>
 #include <sdf/World.hh>
 
 #include <ignition/math/SphericalCoordinates.hh>
+#include <ignition/common/Filesystem.hh>
 #include <ignition/common/Profiler.hh>
+#include <ignition/common/Util.hh>
 
 #include "ignition/gazebo/Events.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/Util.hh"
 
 #include "ignition/gazebo/components/Actor.hh"
 #include "ignition/gazebo/components/Atmosphere.hh"
@@ -55,14 +66,65 @@
 #include "ignition/gazebo/components/RenderEngineServerPlugin.hh"
 #include "ignition/gazebo/components/Scene.hh"
 #include "ignition/gazebo/components/SphericalCoordinates.hh"
+#include "ignition/gazebo/components/Static.hh"
 #include "ignition/gazebo/components/Wind.hh"
 #include "ignition/gazebo/components/World.hh"
 
+#include "msgs/level_metrics.pb.h"
+
 #include "SimulationRunner.hh"
 
 using namespace ignition;
 using namespace gazebo;
 
+/////////////////////////////////////////////////
+/// \brief Resolve a resource URI to a file on disk.
+/// \param[in] _uri URI as written in SDF.
+/// \param[in] _filePath Path of the SDF file the URI was read from.
+/// \return Path to an existing file, or empty if it couldn't be found.
+static std::string ResolveResource(const std::string &_uri,
+    const std::string &_filePath)
+{
+  if (_uri.empty())
+    return std::string();
+
+  auto path = asFullPath(_uri, _filePath);
+  if (common::isFile(path))
+    return path;
+
+  return common::findFile(path);
+}
+
+/////////////////////////////////////////////////
+/// \brief Collect the mesh files used by a model and its nested models.
+/// \param[in] _model Model to collect from.
+/// \param[out] _files Resolved paths of the mesh files.
+static void CollectModelResources(const sdf::Model *_model,
+    std::vector<std::string> &_files)
+{
+  auto addGeometry = [&](const sdf::Geometry *_geom)
+  {
+    if (nullptr == _geom || nullptr == _geom->MeshShape())
+      return;
+    auto mesh = _geom->MeshShape();
+    auto path = ResolveResource(mesh->Uri(), mesh->FilePath());
+    if (!path.empty())
+      _files.push_back(path);
+  };
+
+  for (uint64_t l = 0; l < _model->LinkCount(); ++l)
+  {
+    auto link = _model->LinkByIndex(l);
+    for (uint64_t v = 0; v < link->VisualCount(); ++v)
+      addGeometry(link->VisualByIndex(v)->Geom());
+    for (uint64_t c = 0; c < link->CollisionCount(); ++c)
+      addGeometry(link->CollisionByIndex(c)->Geom());
+  }
+
+  for (uint64_t m = 0; m < _model->ModelCount(); ++m)
+    CollectModelResources(_model->ModelByIndex(m), _files);
+}
+
 /////////////////////////////////////////////////
 LevelManager::LevelManager(SimulationRunner *_runner, const bool _useLevels)
     : runner(_runner), useLevels(_useLevels)
@@ -80,6 +142,10 @@ LevelManager::LevelManager(SimulationRunner *_runner, const bool _useLevels)
   this->ReadLevelPerformerInfo();
   this->CreatePerformers();
 
+  // Batch mode doesn't offer any transport interface
+  if (this->runner->batchMode)
+    return;
+
   std::string service = transport::TopicUtils::AsValidTopic("/world/" +
       this->runner->sdfWorld->Name() + "/level/set_performer");
   if (service.empty())
@@ -89,6 +155,14 @@ LevelManager::LevelManager(SimulationRunner *_runner, const bool _useLevels)
     return;
   }
   this->node.Advertise(service, &LevelManager::OnSetPerformer, this);
+
+  std::string metricsTopic = transport::TopicUtils::AsValidTopic("/world/" +
+      this->runner->sdfWorld->Name() + "/level/metrics");
+  if (!metricsTopic.empty())
+  {
+    this->metricsPub =
+        this->node.Advertise<private_msgs::LevelMetrics>(metricsTopic);
+  }
 }
 
 /////////////////////////////////////////////////
@@ -224,6 +298,49 @@ void LevelManager::ReadLevelPerformerInfo()
     this->ReadPerformers(pluginElem);
     if (this->useLevels)
       this->ReadLevels(pluginElem);
+
+    auto prefetch = pluginElem->Get<double>("prefetch_buffer", 0.0).first;
+    if (prefetch < 0.0)
+    {
+      ignwarn << "The prefetch_buffer parameter cannot be a negative number. "
+              << "Setting to 0.0" << std::endl;
+      prefetch = 0.0;
+    }
+    this->prefetchBuffer = prefetch;
+
+    auto budget = pluginElem->Get<double>("load_budget", 0.0).first;
+    if (budget < 0.0)
+    {
+      ignwarn << "The load_budget parameter cannot be a negative number. "
+              << "Setting to 0.0" << std::endl;
+      budget = 0.0;
+    }
+    this->loadBudget = std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(budget));
+
+    auto delay = pluginElem->Get<double>("unload_delay", 0.0).first;
+    if (delay < 0.0)
+    {
+      ignwarn << "The unload_delay parameter cannot be a negative number. "
+              << "Setting to 0.0" << std::endl;
+      delay = 0.0;
+    }
+    this->unloadDelay = std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(delay));
+
+    auto cacheSize = pluginElem->Get<double>("level_cache_size", 0.0).first;
+    if (cacheSize < 0.0)
+    {
+      ignwarn << "The level_cache_size parameter cannot be a negative "
+              << "number. Setting to 0.0" << std::endl;
+      cacheSize = 0.0;
+    }
+    this->cacheBudget = static_cast<std::size_t>(cacheSize * 1024 * 1024);
+
+    this->entityCreator->SetReuseRepeatedModels(
+        pluginElem->Get<bool>("reuse_repeated_models", false).first);
   }
 
   this->ConfigureDefaultLevel();
@@ -438,6 +555,8 @@ void LevelManager::ReadLevels(const sdf::ElementPtr &_sdf)
 
     this->entityCreator->SetParent(levelEntity, this->worldEntity);
   }
+
+  this->levelIndexDirty = true;
 }
 
 /////////////////////////////////////////////////
@@ -604,6 +723,9 @@ void LevelManager::UpdateLevelsState()
   // If levels are not being used, we only process the default level.
   if (this->useLevels)
   {
+    this->UpdateLevelIndex();
+
+    std::vector<std::size_t> candidates;
     this->runner->entityCompMgr.Each<
       components::Performer,
       components::PerformerLevels,
@@ -635,59 +757,47 @@ void LevelManager::UpdateLevelsState()
 
           std::set<Entity> newPerfLevels;
 
-          // loop through levels and check for intersections
-          // Add all levels with intersections to the levelsToLoad even if they
-          // are currently active.
-          this->runner->entityCompMgr.Each<components::Level, components::Pose,
-            components::Geometry,
-            components::LevelBuffer >(
-                [&](const Entity &_entity, const components::Level *,
-                  const components::Pose *_pose,
-                  const components::Geometry *_levelGeometry,
-                  const components::LevelBuffer *_levelBuffer) -> bool
-                {
-                IGN_PROFILE("CheckPerformerAgainstLevel");
-                // Check if the performer is in this level
-                // assume a box for now
-                auto box = _levelGeometry->Data().BoxShape();
-                if (nullptr == box)
-                {
-                ignerr << "Level [" << _entity
-                << "]'s geometry is not a box." << std::endl;
-                return true;
-                }
-                auto buffer = _levelBuffer->Data();
-                auto center = _pose->Data().Pos();
-                math::AxisAlignedBox region{center - box->Size() / 2,
-                center + box->Size() / 2};
-
-                math::AxisAlignedBox outerRegion{
-                  center - (box->Size() / 2 + buffer),
-                         center + (box->Size() / 2 + buffer)};
-
-                if (region.Intersects(performerVolume))
-                {
-                  newPerfLevels.insert(_entity);
-                  levelsToLoad.push_back(_entity);
-                }
-                else
-                {
-                  // If the level is active, check if the performer is
-                  // outside of the buffer of this level
-                  if (this->IsLevelActive(_entity))
-                  {
-                    if (outerRegion.Intersects(performerVolume))
-                    {
-                      newPerfLevels.insert(_entity);
-                      levelsToLoad.push_back(_entity);
-                      return true;
-                    }
-                    // Otherwise, mark the level to be unloaded
-                    levelsToUnload.push_back(_entity);
-                  }
-                }
-                return true;
-                });
+          // Only levels whose buffer intersects the performer need to be
+          // checked. Add all levels with intersections to the levelsToLoad
+          // even if they are currently active. Levels which are only within
+          // the prefetch buffer have their resources read ahead of time.
+          {
+            IGN_PROFILE("CheckPerformerAgainstLevels");
+            math::AxisAlignedBox queryVolume{
+              performerVolume.Min() - math::Vector3d::One *
+                  this->prefetchBuffer,
+              performerVolume.Max() + math::Vector3d::One *
+                  this->prefetchBuffer};
+            this->levelGrid.Query(queryVolume, candidates);
+          }
+          for (auto index : candidates)
+          {
+            const auto &level = this->levelBounds[index];
+
+            if (!level.outer.Intersects(performerVolume))
+            {
+              if (!this->IsLevelActive(level.entity))
+                this->PrefetchLevel(level.entity);
+              continue;
+            }
+
+            // Levels are loaded when the performer enters them, and kept
+            // while the performer is within their buffer
+            if (level.region.Intersects(performerVolume) ||
+                this->IsLevelActive(level.entity))
+            {
+              newPerfLevels.insert(level.entity);
+              levelsToLoad.push_back(level.entity);
+            }
+          }
+
+          // Active levels which the performer isn't even buffered by are
+          // marked to be unloaded
+          for (const auto &level : this->activeLevels)
+          {
+            if (newPerfLevels.find(level) == newPerfLevels.end())
+              levelsToUnload.push_back(level);
+          }
 
           *_perfLevels = components::PerformerLevels(newPerfLevels);
 
@@ -743,6 +853,30 @@ void LevelManager::UpdateLevelsState()
       });
   levelsToUnload.erase(pendingRemove, levelsToUnload.end());
 
+  // Levels must stay out of reach for a while before being unloaded, so
+  // performers moving back and forth across a level's edge don't
+  // repeatedly load and unload it
+  if (this->unloadDelay > std::chrono::steady_clock::duration::zero())
+  {
+    const auto now = this->runner->currentInfo.simTime;
+    std::unordered_map<Entity, std::chrono::steady_clock::duration> waiting;
+    pendingRemove = std::remove_if(
+        levelsToUnload.begin(), levelsToUnload.end(), [&](Entity _entity)
+        {
+          auto it = this->unloadRequestTimes.find(_entity);
+          auto since = it == this->unloadRequestTimes.end() ? now : it->second;
+          if (now - since >= this->unloadDelay)
+            return false;
+
+          waiting[_entity] = since;
+          return true;
+        });
+    levelsToUnload.erase(pendingRemove, levelsToUnload.end());
+
+    // Levels which came back within reach start over next time
+    this->unloadRequestTimes = std::move(waiting);
+  }
+
   // Make a list of entity names to unload making sure to leave out the ones
   // that have been marked to be loaded above
   std::set<std::string> entityNamesToUnload;
@@ -771,6 +905,11 @@ void LevelManager::UpdateLevelsState()
     this->UnloadInactiveEntities(entityNamesToUnload);
   }
 
+  // Everything needed to start the simulation is created right away, later
+  // loads are spread across updates
+  this->CommitPendingLoads(this->initialLoadDone);
+  this->initialLoadDone = true;
+
   // Finally, upadte the list of active levels
   for (const auto &level : levelsToLoad)
   {
@@ -778,6 +917,7 @@ void LevelManager::UpdateLevelsState()
     {
       ignmsg << "Loaded level [" << level << "]" << std::endl;
       this->activeLevels.push_back(level);
+      ++this->levelsLoaded;
     }
   }
 
@@ -785,10 +925,14 @@ void LevelManager::UpdateLevelsState()
   for (const auto &toUnload : levelsToUnload)
   {
     ignmsg << "Unloaded level [" << toUnload << "]" << std::endl;
+    this->prefetchedLevels.erase(toUnload);
+    ++this->levelsUnloaded;
     pendingEnd = std::remove(this->activeLevels.begin(), pendingEnd, toUnload);
   }
   // Erase from vector
   this->activeLevels.erase(pendingEnd, this->activeLevels.end());
+
+  this->PublishMetrics();
 }
 
 /////////////////////////////////////////////////
@@ -802,6 +946,9 @@ void LevelManager::LoadActiveEntities(const std::set<std::string> &_namesToLoad)
     return;
   }
 
+  // Entities are queued here and created by CommitPendingLoads, so that
+  // their creation can be spread across updates.
+
   // Models
   for (uint64_t modelIndex = 0;
        modelIndex < this->runner->sdfWorld->ModelCount(); ++modelIndex)
@@ -811,9 +958,8 @@ void LevelManager::LoadActiveEntities(const std::set<std::string> &_namesToLoad)
     auto model = this->runner->sdfWorld->ModelByIndex(modelIndex);
     if (_namesToLoad.find(model->Name()) != _namesToLoad.end())
     {
-      Entity modelEntity = this->entityCreator->CreateEntities(model);
-
-      this->entityCreator->SetParent(modelEntity, this->worldEntity);
+      this->pendingLoads.push_back(
+          {PendingLoad::Type::MODEL, modelIndex, model->Name()});
     }
   }
 
@@ -826,9 +972,8 @@ void LevelManager::LoadActiveEntities(const std::set<std::string> &_namesToLoad)
     auto actor = this->runner->sdfWorld->ActorByIndex(actorIndex);
     if (_namesToLoad.find(actor->Name()) != _namesToLoad.end())
     {
-      Entity actorEntity = this->entityCreator->CreateEntities(actor);
-
-      this->entityCreator->SetParent(actorEntity, this->worldEntity);
+      this->pendingLoads.push_back(
+          {PendingLoad::Type::ACTOR, actorIndex, actor->Name()});
     }
   }
 
@@ -839,15 +984,175 @@ void LevelManager::LoadActiveEntities(const std::set<std::string> &_namesToLoad)
     auto light = this->runner->sdfWorld->LightByIndex(lightIndex);
     if (_namesToLoad.find(light->Name()) != _namesToLoad.end())
     {
-      Entity lightEntity = this->entityCreator->CreateEntities(light);
-
-      this->entityCreator->SetParent(lightEntity, this->worldEntity);
+      this->pendingLoads.push_back(
+          {PendingLoad::Type::LIGHT, lightIndex, light->Name()});
     }
   }
 
   this->activeEntityNames.insert(_namesToLoad.begin(), _namesToLoad.end());
 }
 
+/////////////////////////////////////////////////
+void LevelManager::CommitPendingLoads(bool _bounded)
+{
+  if (this->pendingLoads.empty())
+    return;
+
+  IGN_PROFILE("LevelManager::CommitPendingLoads");
+
+  _bounded = _bounded &&
+      this->loadBudget > std::chrono::steady_clock::duration::zero();
+  const auto deadline = std::chrono::steady_clock::now() + this->loadBudget;
+
+  uint32_t committed{0};
+
+  // Without a budget, consecutive models are created together so they can
+  // be converted from SDF in parallel
+  if (!_bounded)
+  {
+    std::vector<const sdf::Model *> models;
+    while (!this->pendingLoads.empty() &&
+        this->pendingLoads.front().type == PendingLoad::Type::MODEL &&
+        this->entityCache.find(this->pendingLoads.front().name) ==
+        this->entityCache.end())
+    {
+      models.push_back(this->runner->sdfWorld->ModelByIndex(
+          this->pendingLoads.front().index));
+      this->pendingLoads.pop_front();
+    }
+
+    for (auto entity : this->entityCreator->CreateEntities(models))
+      this->entityCreator->SetParent(entity, this->worldEntity);
+
+    committed += static_cast<uint32_t>(models.size());
+    this->entitiesCreated += models.size();
+  }
+
+  // At least one entity is created per update so loading always progresses
+  while (!this->pendingLoads.empty() && (!_bounded || committed == 0u ||
+      std::chrono::steady_clock::now() < deadline))
+  {
+    const auto load = std::move(this->pendingLoads.front());
+    this->pendingLoads.pop_front();
+    ++committed;
+
+    if (this->RestoreCachedEntity(load.name))
+    {
+      ++this->entitiesRestored;
+      continue;
+    }
+    ++this->entitiesCreated;
+
+    Entity entity{kNullEntity};
+    switch (load.type)
+    {
+      case PendingLoad::Type::MODEL:
+        entity = this->entityCreator->CreateEntities(
+            this->runner->sdfWorld->ModelByIndex(load.index));
+        break;
+      case PendingLoad::Type::ACTOR:
+        entity = this->entityCreator->CreateEntities(
+            this->runner->sdfWorld->ActorByIndex(load.index));
+        break;
+      case PendingLoad::Type::LIGHT:
+        entity = this->entityCreator->CreateEntities(
+            this->runner->sdfWorld->LightByIndex(load.index));
+        break;
+    }
+    this->entityCreator->SetParent(entity, this->worldEntity);
+  }
+
+  this->maxEntitiesPerUpdate = std::max(this->maxEntitiesPerUpdate, committed);
+
+  if (!this->pendingLoads.empty())
+  {
+    igndbg << "Deferred creation of [" << this->pendingLoads.size()
+           << "] level entities to the next update." << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////
+void LevelManager::PublishMetrics()
+{
+  if (!this->metricsPub.HasConnections())
+    return;
+
+  const auto now = std::chrono::steady_clock::now();
+  if (now - this->lastMetricsTime < std::chrono::seconds(1))
+    return;
+  this->lastMetricsTime = now;
+
+  private_msgs::LevelMetrics msg;
+  msg.set_active_levels(static_cast<uint32_t>(this->activeLevels.size()));
+  msg.set_levels_loaded(this->levelsLoaded);
+  msg.set_levels_unloaded(this->levelsUnloaded);
+  msg.set_entities_created(this->entitiesCreated);
+  msg.set_entities_restored(this->entitiesRestored);
+  msg.set_max_entities_per_update(this->maxEntitiesPerUpdate);
+  msg.set_pending_entities(static_cast<uint32_t>(this->pendingLoads.size()));
+  msg.set_cached_entities(static_cast<uint32_t>(this->entityCache.size()));
+  msg.set_cache_bytes(this->cacheBytes);
+  msg.set_pending_prefetches(
+      static_cast<uint32_t>(this->prefetcher.Pending()));
+  this->metricsPub.Publish(msg);
+
+  this->maxEntitiesPerUpdate = 0;
+}
+
+/////////////////////////////////////////////////
+void LevelManager::PrefetchLevel(const Entity _entity)
+{
+  if (!this->prefetchedLevels.insert(_entity).second)
+    return;
+
+  IGN_PROFILE("LevelManager::PrefetchLevel");
+
+  auto names = this->runner->entityCompMgr.Component<
+      components::LevelEntityNames>(_entity);
+  if (nullptr == names)
+    return;
+  const auto &entityNames = names->Data();
+
+  std::vector<std::string> files;
+  for (uint64_t modelIndex = 0;
+       modelIndex < this->runner->sdfWorld->ModelCount(); ++modelIndex)
+  {
+    auto model = this->runner->sdfWorld->ModelByIndex(modelIndex);
+    if (entityNames.find(model->Name()) != entityNames.end())
+      CollectModelResources(model, files);
+  }
+
+  for (uint64_t actorIndex = 0;
+       actorIndex < this->runner->sdfWorld->ActorCount(); ++actorIndex)
+  {
+    auto actor = this->runner->sdfWorld->ActorByIndex(actorIndex);
+    if (entityNames.find(actor->Name()) == entityNames.end())
+      continue;
+
+    auto skin = ResolveResource(actor->SkinFilename(), actor->FilePath());
+    if (!skin.empty())
+      files.push_back(skin);
+    for (uint64_t a = 0; a < actor->AnimationCount(); ++a)
+    {
+      auto animation = actor->AnimationByIndex(a);
+      auto path = ResolveResource(animation->Filename(),
+          animation->FilePath());
+      if (!path.empty())
+        files.push_back(path);
+    }
+  }
+
+  std::size_t queued{0};
+  for (const auto &file : files)
+  {
+    if (this->prefetcher.Prefetch(file))
+      ++queued;
+  }
+
+  igndbg << "Prefetching [" << queued << "] files for level [" << _entity
+         << "]" << std::endl;
+}
+
 /////////////////////////////////////////////////
 void LevelManager::UnloadInactiveEntities(
     const std::set<std::string> &_namesToUnload)
@@ -858,6 +1163,7 @@ void LevelManager::UnloadInactiveEntities(
       {
         if (_namesToUnload.find(_name->Data()) != _namesToUnload.end())
         {
+          this->CacheEntity(_entity, _name->Data());
           this->entityCreator->RequestRemoveEntity(_entity, true);
         }
         return true;
@@ -869,6 +1175,7 @@ void LevelManager::UnloadInactiveEntities(
       {
         if (_namesToUnload.find(_name->Data()) != _namesToUnload.end())
         {
+          this->CacheEntity(_entity, _name->Data());
           this->entityCreator->RequestRemoveEntity(_entity, true);
         }
         return true;
@@ -880,17 +1187,93 @@ void LevelManager::UnloadInactiveEntities(
       {
         if (_namesToUnload.find(_name->Data()) != _namesToUnload.end())
         {
+          this->CacheEntity(_entity, _name->Data());
           this->entityCreator->RequestRemoveEntity(_entity, true);
         }
         return true;
       });
 
+  // Entities which haven't been created yet don't need to be
+  this->pendingLoads.erase(std::remove_if(this->pendingLoads.begin(),
+      this->pendingLoads.end(), [&](const PendingLoad &_load)
+      {
+        return _namesToUnload.find(_load.name) != _namesToUnload.end();
+      }), this->pendingLoads.end());
+
   for (const auto &name : _namesToUnload)
   {
     this->activeEntityNames.erase(name);
   }
 }
 
+/////////////////////////////////////////////////
+void LevelManager::CacheEntity(const Entity _entity, const std::string &_name)
+{
+  if (0u == this->cacheBudget)
+    return;
+
+  IGN_PROFILE("LevelManager::CacheEntity");
+
+  // Only entities directly under the world are loaded from SDF, nested
+  // entities with the same name are cached along with their parents
+  auto parent = this->runner->entityCompMgr.Component<
+      components::ParentEntity>(_entity);
+  if (nullptr == parent || parent->Data() != this->worldEntity)
+    return;
+
+  auto existing = this->entityCache.find(_name);
+  if (existing != this->entityCache.end())
+  {
+    this->cacheBytes -= existing->second.bytes;
+    this->cacheOrder.erase(existing->second.order);
+    this->entityCache.erase(existing);
+  }
+
+  CachedEntity cached;
+  this->runner->entityCompMgr.State(cached.state,
+      this->runner->entityCompMgr.Descendants(_entity), {}, true);
+  cached.bytes = cached.state.ByteSizeLong();
+  if (cached.bytes > this->cacheBudget)
+  {
+    igndbg << "Entity [" << _name << "] is too large for the level cache."
+           << std::endl;
+    return;
+  }
+
+  this->cacheOrder.push_front(_name);
+  cached.order = this->cacheOrder.begin();
+  this->cacheBytes += cached.bytes;
+  this->entityCache.emplace(_name, std::move(cached));
+
+  // Drop the entities which have been unloaded for the longest
+  while (this->cacheBytes > this->cacheBudget)
+  {
+    auto evicted = this->entityCache.find(this->cacheOrder.back());
+    this->cacheBytes -= evicted->second.bytes;
+    this->entityCache.erase(evicted);
+    this->cacheOrder.pop_back();
+  }
+}
+
+/////////////////////////////////////////////////
+bool LevelManager::RestoreCachedEntity(const std::string &_name)
+{
+  auto cached = this->entityCache.find(_name);
+  if (cached == this->entityCache.end())
+    return false;
+
+  IGN_PROFILE("LevelManager::RestoreCachedEntity");
+
+  // The state holds the entity's ParentEntity component, so it's attached to
+  // the world again
+  this->runner->entityCompMgr.SetState(cached->second.state);
+
+  this->cacheBytes -= cached->second.bytes;
+  this->cacheOrder.erase(cached->second.order);
+  this->entityCache.erase(cached);
+  return true;
+}
+
 /////////////////////////////////////////////////
 bool LevelManager::IsLevelActive(const Entity _entity) const
 {
@@ -938,3 +1321,102 @@ int LevelManager::CreatePerformerEntity(const std::string &_name,
   this->entityCreator->SetParent(this->performerMap[_name], modelEntity);
   return 0;
 }
+
+/////////////////////////////////////////////////
+void LevelManager::CreateDynamicModelPerformers()
+{
+  IGN_PROFILE("LevelManager::CreateDynamicModelPerformers");
+
+  auto &ecm = this->runner->entityCompMgr;
+
+  // Visit models in a fixed order so all peers create the same entities
+  auto models = ecm.ChildrenByComponents(this->worldEntity,
+      components::Model());
+  std::sort(models.begin(), models.end());
+
+  // Performers only need a box to check against levels
+  sdf::Geometry geometry;
+  geometry.SetType(sdf::GeometryType::BOX);
+  geometry.SetBoxShape(sdf::Box());
+
+  for (const auto &modelEntity : models)
+  {
+    auto isStatic = ecm.Component<components::Static>(modelEntity);
+    if (isStatic && isStatic->Data())
+      continue;
+
+    if (!ecm.ChildrenByComponents(modelEntity,
+          components::Performer()).empty())
+    {
+      continue;
+    }
+
+    auto name = ecm.Component<components::Name>(modelEntity);
+    if (nullptr == name)
+      continue;
+
+    Entity performerEntity = ecm.CreateEntity();
+    this->performerMap[name->Data()] = performerEntity;
+
+    ecm.CreateComponent(performerEntity, components::Performer());
+    ecm.CreateComponent(performerEntity, components::PerformerLevels());
+    ecm.CreateComponent(performerEntity,
+        components::Name("perf_" + name->Data()));
+    ecm.CreateComponent(performerEntity, components::Geometry(geometry));
+
+    this->entityCreator->SetParent(performerEntity, modelEntity);
+
+    igndbg << "Created performer [" << performerEntity << "] for dynamic "
+           << "model [" << name->Data() << "]" << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////
+void LevelManager::UpdateLevelIndex()
+{
+  if (!this->levelIndexDirty)
+    return;
+  this->levelIndexDirty = false;
+
+  IGN_PROFILE("LevelManager::UpdateLevelIndex");
+
+  this->levelBounds.clear();
+  std::vector<math::AxisAlignedBox> outerRegions;
+
+  this->runner->entityCompMgr.Each<components::Level, components::Pose,
+    components::Geometry, components::LevelBuffer>(
+        [&](const Entity &_entity, const components::Level *,
+          const components::Pose *_pose,
+          const components::Geometry *_levelGeometry,
+          const components::LevelBuffer *_levelBuffer) -> bool
+        {
+          // Assume a box for now
+          auto box = _levelGeometry->Data().BoxShape();
+          if (nullptr == box)
+          {
+            ignerr << "Level [" << _entity << "]'s geometry is not a box."
+                   << std::endl;
+            return true;
+          }
+          auto buffer = _levelBuffer->Data();
+          auto center = _pose->Data().Pos();
+
+          LevelBounds level;
+          level.entity = _entity;
+          level.region = math::AxisAlignedBox{center - box->Size() / 2,
+              center + box->Size() / 2};
+          level.outer = math::AxisAlignedBox{
+              center - (box->Size() / 2 + buffer),
+              center + (box->Size() / 2 + buffer)};
+          this->levelBounds.push_back(level);
+
+          outerRegions.push_back(level.outer);
+          return true;
+        });
+
+  this->levelGrid.Build(outerRegions);
+
+  igndbg << "Indexed [" << this->levelBounds.size() << "] levels with a "
+         << "grid cell size of [" << this->levelGrid.CellSize() << "] m."
+         << std::endl;
+}
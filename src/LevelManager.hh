@@ -19,8 +19,12 @@
 #define IGNITION_GAZEBO_LEVELMANAGER_HH
 
 #include <ignition/msgs/boolean.pb.h>
+#include <ignition/msgs/serialized_map.pb.h>
 #include <ignition/msgs/stringmsg.pb.h>
 
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <list>
 #include <memory>
 #include <set>
@@ -33,11 +37,16 @@
 #include <sdf/Geometry.hh>
 #include <ignition/transport/Node.hh>
 
+#include <ignition/math/AxisAlignedBox.hh>
+
 #include "ignition/gazebo/config.hh"
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/SdfEntityCreator.hh"
 #include "ignition/gazebo/Types.hh"
 
+#include "AxisAlignedBoxGrid.hh"
+#include "ResourcePrefetcher.hh"
+
 namespace ignition
 {
   namespace gazebo
@@ -71,9 +80,33 @@ namespace ignition
     ///
     /// * Entities which are part of a level should not be modified during
     ///   simulation. Any component changes or additions will be ignored
-    ///   when the level is reloaded. Likewise, they should not be deleted.
+    ///   when the level is reloaded, unless the entity was restored from
+    ///   the level cache. Likewise, they should not be deleted.
     /// * Entities spawned during simulation are part of the default level.
     ///
+    /// Level streaming can be tuned with these elements of the
+    /// `ignition::gazebo` world plugin:
+    ///
+    /// * `<prefetch_buffer>`: Distance in meters beyond a level's buffer at
+    ///   which the meshes of the level's entities start being read in the
+    ///   background. Defaults to 0, which disables prefetching.
+    /// * `<load_budget>`: Maximum time in milliseconds spent creating level
+    ///   entities on each update. Entities which don't fit are created on
+    ///   the following updates. Defaults to 0, which creates every entity
+    ///   as soon as its level is loaded.
+    /// * `<unload_delay>`: Simulation time in seconds a level must stay out
+    ///   of reach of all performers before it's unloaded. Defaults to 0.
+    /// * `<level_cache_size>`: Memory budget in MiB for the state of
+    ///   entities of unloaded levels. Cached entities are restored with
+    ///   their last state instead of being recreated from SDF, and the
+    ///   least recently unloaded ones are dropped when the budget is
+    ///   exceeded. Defaults to 0, which disables the cache.
+    /// * `<reuse_repeated_models>`: If true, models which only differ in
+    ///   name and pose, such as the same model included many times, are
+    ///   converted from SDF once per level load and cloned for the other
+    ///   instances. See SdfEntityCreator::SetReuseRepeatedModels. Defaults
+    ///   to false.
+    ///
     class IGNITION_GAZEBO_VISIBLE LevelManager
     {
       /// \brief Constructor
@@ -88,11 +121,45 @@ namespace ignition
       /// every update cycle
       public: void UpdateLevelsState();
 
+      /// \brief Create a performer for every model directly under the world
+      /// which isn't static and doesn't have a performer yet. This is used
+      /// to partition the world spatially across network secondaries, so
+      /// it must be called at the same point on all network peers for the
+      /// performers to get matching entity IDs.
+      public: void CreateDynamicModelPerformers();
+
       /// \brief Load entities that have been marked for loading.
       /// \param[in] _namesToLoad List of of entity names to load
       private: void LoadActiveEntities(
           const std::set<std::string> &_namesToLoad);
 
+      /// \brief Create entities queued by LoadActiveEntities, for as long as
+      /// the load budget allows.
+      /// \param[in] _bounded False to create all queued entities regardless
+      /// of the budget.
+      private: void CommitPendingLoads(bool _bounded);
+
+      /// \brief Start reading the resources used by the entities of a level
+      /// in the background.
+      /// \param[in] _entity Level entity.
+      private: void PrefetchLevel(const Entity _entity);
+
+      /// \brief Store the state of an entity and its descendants in the
+      /// level cache, so it can be restored when its level is loaded again.
+      /// \param[in] _entity Top level entity.
+      /// \param[in] _name Name of the entity in the world SDF.
+      private: void CacheEntity(const Entity _entity,
+          const std::string &_name);
+
+      /// \brief Restore an entity from the level cache.
+      /// \param[in] _name Name of the entity in the world SDF.
+      /// \return True if the entity was cached and has been restored.
+      private: bool RestoreCachedEntity(const std::string &_name);
+
+      /// \brief Publish level streaming counters, if anyone is listening and
+      /// enough time passed since they were last published.
+      private: void PublishMetrics();
+
       /// \brief Unload entities that have been marked for unloading.
       /// \param[in] _namesToUnload List of entity names to unload
       private: void UnloadInactiveEntities(
@@ -120,6 +187,9 @@ namespace ignition
       /// schedule them to be loaded
       private: void ConfigureDefaultLevel();
 
+      /// \brief Rebuild the spatial index of levels if they changed.
+      private: void UpdateLevelIndex();
+
       /// \brief Determine if a level is active
       /// \param[in] _entity Entity of level to be checked
       /// \return True of the level is currently active
@@ -148,9 +218,126 @@ namespace ignition
       /// \brief List of currently active levels
       private: std::vector<Entity> activeLevels;
 
-      /// \brief Names of entities that are currently active (loaded).
+      /// \brief Bounds of a level, without its buffer.
+      private: struct LevelBounds
+      {
+        /// \brief Level entity.
+        Entity entity{kNullEntity};
+
+        /// \brief Region covered by the level.
+        math::AxisAlignedBox region;
+
+        /// \brief Region covered by the level including its buffer.
+        math::AxisAlignedBox outer;
+      };
+
+      /// \brief All levels, in the same order as in levelGrid.
+      private: std::vector<LevelBounds> levelBounds;
+
+      /// \brief Spatial index over the regions of all levels including their
+      /// buffers, used to find which levels each performer is close to.
+      private: AxisAlignedBoxGrid levelGrid;
+
+      /// \brief True if levels were created since levelGrid was built.
+      private: bool levelIndexDirty{true};
+
+      /// \brief Names of entities that are currently active (loaded). This
+      /// includes entities which are still waiting in pendingLoads.
       private: std::set<std::string> activeEntityNames;
 
+      /// \brief Entity of the world SDF waiting to be created.
+      private: struct PendingLoad
+      {
+        /// \brief Kind of entity.
+        enum class Type {MODEL, ACTOR, LIGHT};
+
+        /// \brief Kind of entity.
+        Type type{Type::MODEL};
+
+        /// \brief Index of the entity within the world SDF.
+        uint64_t index{0};
+
+        /// \brief Name of the entity.
+        std::string name;
+      };
+
+      /// \brief Entities waiting to be created, in creation order.
+      private: std::deque<PendingLoad> pendingLoads;
+
+      /// \brief Maximum time spent creating entities per update. Zero means
+      /// no limit.
+      private: std::chrono::steady_clock::duration loadBudget{0};
+
+      /// \brief Distance beyond a level's buffer at which it's prefetched.
+      /// Zero disables prefetching.
+      private: double prefetchBuffer{0.0};
+
+      /// \brief Levels whose resources have been prefetched.
+      private: std::set<Entity> prefetchedLevels;
+
+      /// \brief Reads level resources in the background.
+      private: ResourcePrefetcher prefetcher;
+
+      /// \brief True once the first update has created its entities.
+      private: bool initialLoadDone{false};
+
+      /// \brief Simulation time a level must be out of reach before it's
+      /// unloaded.
+      private: std::chrono::steady_clock::duration unloadDelay{0};
+
+      /// \brief Simulation time at which levels waiting for unloadDelay
+      /// first went out of reach.
+      private: std::unordered_map<Entity, std::chrono::steady_clock::duration>
+          unloadRequestTimes;
+
+      /// \brief Unloaded entity kept in the level cache.
+      private: struct CachedEntity
+      {
+        /// \brief Full state of the entity and its descendants.
+        msgs::SerializedStateMap state;
+
+        /// \brief Size of the serialized state, in bytes.
+        std::size_t bytes{0};
+
+        /// \brief Position of the entity in cacheOrder.
+        std::list<std::string>::iterator order;
+      };
+
+      /// \brief Cached entities, indexed by name.
+      private: std::unordered_map<std::string, CachedEntity> entityCache;
+
+      /// \brief Names of cached entities, most recently unloaded first.
+      private: std::list<std::string> cacheOrder;
+
+      /// \brief Total size of the cached states, in bytes.
+      private: std::size_t cacheBytes{0};
+
+      /// \brief Maximum size of the cached states, in bytes. Zero disables
+      /// the cache.
+      private: std::size_t cacheBudget{0};
+
+      /// \brief Publisher for level streaming counters.
+      private: transport::Node::Publisher metricsPub;
+
+      /// \brief Wall time at which metrics were last published.
+      private: std::chrono::steady_clock::time_point lastMetricsTime;
+
+      /// \brief Total number of times a level was loaded.
+      private: uint64_t levelsLoaded{0};
+
+      /// \brief Total number of times a level was unloaded.
+      private: uint64_t levelsUnloaded{0};
+
+      /// \brief Total number of entities created from SDF.
+      private: uint64_t entitiesCreated{0};
+
+      /// \brief Total number of entities restored from the cache.
+      private: uint64_t entitiesRestored{0};
+
+      /// \brief Largest number of entities committed in one update since
+      /// metrics were last published.
+      private: uint32_t maxEntitiesPerUpdate{0};
+
       /// \brief Pointer to the simulation runner associated with the level
       /// manager.
       private: SimulationRunner *const runner;
@@ -116,36 +116,27 @@ std::optional<Model> Link::ParentModel(const EntityComponentManager &_ecm) const
 Entity Link::CollisionByName(const EntityComponentManager &_ecm,
     const std::string &_name) const
 {
-  return _ecm.EntityByComponents(
-      components::ParentEntity(this->dataPtr->id),
-      components::Name(_name),
-      components::Collision());
+  return _ecm.ChildByName<components::Collision>(this->dataPtr->id, _name);
 }
 
 //////////////////////////////////////////////////
 Entity Link::VisualByName(const EntityComponentManager &_ecm,
     const std::string &_name) const
 {
-  return _ecm.EntityByComponents(
-      components::ParentEntity(this->dataPtr->id),
-      components::Name(_name),
-      components::Visual());
+  return _ecm.ChildByName<components::Visual>(this->dataPtr->id, _name);
 }
 
 //////////////////////////////////////////////////
 std::vector<Entity> Link::Collisions(const EntityComponentManager &_ecm) const
 {
-  return _ecm.EntitiesByComponents(
-      components::ParentEntity(this->dataPtr->id),
-      components::Collision());
+  return _ecm.ChildrenWithComponents<components::Collision>(
+      this->dataPtr->id);
 }
 
 //////////////////////////////////////////////////
 std::vector<Entity> Link::Visuals(const EntityComponentManager &_ecm) const
 {
-  return _ecm.EntitiesByComponents(
-      components::ParentEntity(this->dataPtr->id),
-      components::Visual());
+  return _ecm.ChildrenWithComponents<components::Visual>(this->dataPtr->id);
 }
 
 //////////////////////////////////////////////////
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ignition/gazebo/LocalTopics.hh"
+
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Subscribers of one topic. Lists are never modified once shared,
+/// so publishers can call them without holding the lock.
+using LocalSubscribers =
+    std::vector<std::pair<uint64_t, LocalTopics::Callback>>;
+
+/// \brief All the local subscriptions of this process.
+struct LocalSubscriptions
+{
+  /// \brief Protect the maps.
+  std::mutex mutex;
+
+  /// \brief Subscribers keyed by topic.
+  std::unordered_map<std::string, std::shared_ptr<const LocalSubscribers>>
+      topics;
+
+  /// \brief Topic of each subscription ID.
+  std::unordered_map<uint64_t, std::string> ids;
+
+  /// \brief Next subscription ID.
+  uint64_t nextId{1u};
+};
+
+/// \brief Get the local subscriptions of this process.
+/// \return The subscriptions.
+static LocalSubscriptions &Subscriptions()
+{
+  static LocalSubscriptions subscriptions;
+  return subscriptions;
+}
+
+//////////////////////////////////////////////////
+uint64_t LocalTopics::Subscribe(const std::string &_topic,
+    Callback _callback)
+{
+  if (!_callback)
+    return 0u;
+
+  auto &subs = Subscriptions();
+  std::lock_guard<std::mutex> lock(subs.mutex);
+  const uint64_t id = subs.nextId++;
+
+  auto &list = subs.topics[_topic];
+  auto updated = list ? std::make_shared<LocalSubscribers>(*list) :
+      std::make_shared<LocalSubscribers>();
+  updated->emplace_back(id, std::move(_callback));
+  list = std::move(updated);
+  subs.ids[id] = _topic;
+  return id;
+}
+
+//////////////////////////////////////////////////
+bool LocalTopics::Unsubscribe(uint64_t _id)
+{
+  auto &subs = Subscriptions();
+  std::lock_guard<std::mutex> lock(subs.mutex);
+  auto idIt = subs.ids.find(_id);
+  if (idIt == subs.ids.end())
+    return false;
+
+  auto topicIt = subs.topics.find(idIt->second);
+  subs.ids.erase(idIt);
+  if (topicIt == subs.topics.end())
+    return true;
+
+  auto updated = std::make_shared<LocalSubscribers>();
+  for (const auto &sub : *topicIt->second)
+  {
+    if (sub.first != _id)
+      updated->push_back(sub);
+  }
+
+  if (updated->empty())
+    subs.topics.erase(topicIt);
+  else
+    topicIt->second = std::move(updated);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool LocalTopics::HasSubscribers(const std::string &_topic)
+{
+  auto &subs = Subscriptions();
+  std::lock_guard<std::mutex> lock(subs.mutex);
+  return subs.topics.find(_topic) != subs.topics.end();
+}
+
+//////////////////////////////////////////////////
+std::size_t LocalTopics::Publish(const std::string &_topic,
+    const std::shared_ptr<const google::protobuf::Message> &_msg)
+{
+  if (!_msg)
+    return 0u;
+
+  std::shared_ptr<const LocalSubscribers> list;
+  {
+    auto &subs = Subscriptions();
+    std::lock_guard<std::mutex> lock(subs.mutex);
+    auto it = subs.topics.find(_topic);
+    if (it == subs.topics.end())
+      return 0u;
+    list = it->second;
+  }
+
+  for (const auto &sub : *list)
+    sub.second(_msg);
+  return list->size();
+}
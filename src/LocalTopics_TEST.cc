@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ignition/msgs/image.pb.h>
+#include <ignition/msgs/stringmsg.pb.h>
+
+#include <memory>
+
+#include "ignition/gazebo/LocalTopics.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(LocalTopics, PublishSubscribe)
+{
+  const std::string topic = "/local_topics_test/image";
+  EXPECT_FALSE(LocalTopics::HasSubscribers(topic));
+
+  auto image = std::make_shared<msgs::Image>();
+  image->set_width(4);
+  EXPECT_EQ(0u, LocalTopics::Publish(topic, image));
+
+  std::shared_ptr<const msgs::Image> received;
+  auto typedId = LocalTopics::Subscribe<msgs::Image>(topic,
+      [&](const std::shared_ptr<const msgs::Image> &_msg)
+      {
+        received = _msg;
+      });
+  int anyCount{0};
+  auto anyId = LocalTopics::Subscribe(topic,
+      [&](const std::shared_ptr<const google::protobuf::Message> &)
+      {
+        ++anyCount;
+      });
+  EXPECT_NE(typedId, anyId);
+  EXPECT_TRUE(LocalTopics::HasSubscribers(topic));
+  EXPECT_FALSE(LocalTopics::HasSubscribers("/local_topics_test/other"));
+
+  // Subscribers get the published instance
+  EXPECT_EQ(2u, LocalTopics::Publish(topic, image));
+  EXPECT_EQ(image.get(), received.get());
+  EXPECT_EQ(1, anyCount);
+
+  // Typed subscribers skip other types
+  received.reset();
+  EXPECT_EQ(2u, LocalTopics::Publish(topic,
+      std::make_shared<msgs::StringMsg>()));
+  EXPECT_EQ(nullptr, received);
+  EXPECT_EQ(2, anyCount);
+
+  EXPECT_TRUE(LocalTopics::Unsubscribe(typedId));
+  EXPECT_FALSE(LocalTopics::Unsubscribe(typedId));
+  EXPECT_EQ(1u, LocalTopics::Publish(topic, image));
+  EXPECT_EQ(nullptr, received);
+
+  EXPECT_TRUE(LocalTopics::Unsubscribe(anyId));
+  EXPECT_FALSE(LocalTopics::HasSubscribers(topic));
+  EXPECT_EQ(0u, LocalTopics::Subscribe(topic, nullptr));
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ignition/gazebo/LockstepClient.hh"
+
+#include <chrono>
+#include <string>
+
+#include <ignition/common/Console.hh>
+
+#include "network/SharedMemoryChannel.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Private data of LockstepClient.
+class ignition::gazebo::LockstepClientPrivate
+{
+  /// \brief Queue actions are sent on.
+  public: std::unique_ptr<SharedMemoryChannel> actions;
+
+  /// \brief Queue observations are received from.
+  public: std::unique_ptr<SharedMemoryChannel> observations;
+
+  /// \brief Serialized message, reused across steps.
+  public: std::string buffer;
+
+  /// \brief Number of actions sent whose observation wasn't read yet. The
+  /// server replies to each action once, in order, so when this is more
+  /// than one, the next observations belong to steps which timed out.
+  public: uint64_t pending{0u};
+};
+
+//////////////////////////////////////////////////
+LockstepClient::LockstepClient()
+  : dataPtr(std::make_unique<LockstepClientPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+LockstepClient::~LockstepClient() = default;
+
+//////////////////////////////////////////////////
+std::unique_ptr<LockstepClient> LockstepClient::Connect(
+    const std::string &_channel, const std::string &_world)
+{
+  // Must match SimulationRunner
+  const std::string prefix = "lockstep_" + _channel + "_" + _world;
+
+  std::unique_ptr<LockstepClient> client(new LockstepClient());
+  client->dataPtr->actions = SharedMemoryChannel::Open(prefix + "_actions");
+  client->dataPtr->observations =
+      SharedMemoryChannel::Open(prefix + "_observations");
+  if (!client->dataPtr->actions || !client->dataPtr->observations)
+    return nullptr;
+
+  // Drop observations of a previous client
+  while (client->dataPtr->observations->Read(client->dataPtr->buffer))
+  {
+  }
+  return client;
+}
+
+//////////////////////////////////////////////////
+bool LockstepClient::Step(const msgs::SerializedStateMap &_actions,
+    msgs::SerializedStepMap &_observation,
+    const std::chrono::steady_clock::duration &_timeout)
+{
+  auto &buffer = this->dataPtr->buffer;
+  _actions.SerializeToString(&buffer);
+  if (!this->dataPtr->actions->Write(buffer))
+  {
+    ignerr << "Lockstep actions of [" << buffer.size() << "] bytes don't fit "
+           << "in the channel." << std::endl;
+    return false;
+  }
+  ++this->dataPtr->pending;
+
+  // Sleep until the server writes the observation
+  const auto deadline = std::chrono::steady_clock::now() + _timeout;
+  while (true)
+  {
+    if (this->dataPtr->observations->Read(buffer))
+    {
+      // Observations of steps which timed out arrive late, skip them
+      if (--this->dataPtr->pending > 0u)
+        continue;
+
+      if (!_observation.ParseFromString(buffer))
+      {
+        ignerr << "Failed to parse lockstep observation." << std::endl;
+        return false;
+      }
+      return true;
+    }
+
+    const auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining <= std::chrono::steady_clock::duration::zero() ||
+        !this->dataPtr->observations->Wait(remaining))
+    {
+      return false;
+    }
+  }
+}
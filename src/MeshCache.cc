@@ -0,0 +1,477 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ignition/gazebo/MeshCache.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Material.hh>
+#include <ignition/common/MeshManager.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/common/SubMesh.hh>
+#include <ignition/common/Util.hh>
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Identifies cooked mesh files.
+static const char kMagic[4] = {'I', 'G', 'M', 'C'};
+
+/// \brief Version of the cooked mesh format, bump when it changes.
+static const uint32_t kVersion{2u};
+
+/// \brief Material index of submeshes without a material.
+static const int64_t kNoMaterial{-1};
+
+/// \brief Private data for MeshCache
+class ignition::gazebo::MeshCachePrivate
+{
+  /// \brief Protects all members, and serializes loading so that a mesh
+  /// is never parsed twice.
+  public: mutable std::mutex mutex;
+
+  /// \brief Directory where cooked meshes are stored, empty if disabled.
+  public: std::string cacheDir;
+
+  /// \brief Whether cacheDir exists, or was created.
+  public: bool dirReady{false};
+};
+
+//////////////////////////////////////////////////
+/// \brief Hash the contents of a file with 64-bit FNV-1a.
+/// \param[in] _path File to hash.
+/// \param[out] _hash Hash of the contents.
+/// \return False if the file couldn't be read.
+static bool HashFile(const std::string &_path, uint64_t &_hash)
+{
+  std::ifstream file(_path, std::ios::binary);
+  if (!file)
+    return false;
+
+  _hash = 14695981039346656037ull;
+  std::vector<char> buffer(1 << 20);
+  while (file)
+  {
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    const auto count = file.gcount();
+    for (std::streamsize i = 0; i < count; ++i)
+    {
+      _hash ^= static_cast<unsigned char>(buffer[i]);
+      _hash *= 1099511628211ull;
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Write a value in binary form.
+template <typename T>
+static void WriteValue(std::ostream &_out, const T &_value)
+{
+  _out.write(reinterpret_cast<const char *>(&_value), sizeof(T));
+}
+
+//////////////////////////////////////////////////
+/// \brief Read a value in binary form.
+template <typename T>
+static bool ReadValue(std::istream &_in, T &_value)
+{
+  _in.read(reinterpret_cast<char *>(&_value), sizeof(T));
+  return static_cast<bool>(_in);
+}
+
+//////////////////////////////////////////////////
+/// \brief Write a string, preceded by its size.
+static void WriteString(std::ostream &_out, const std::string &_value)
+{
+  WriteValue(_out, static_cast<uint32_t>(_value.size()));
+  _out.write(_value.data(), static_cast<std::streamsize>(_value.size()));
+}
+
+//////////////////////////////////////////////////
+/// \brief Read a string written by WriteString.
+static bool ReadString(std::istream &_in, std::string &_value)
+{
+  uint32_t size{0u};
+  if (!ReadValue(_in, size))
+    return false;
+  _value.resize(size);
+  _in.read(&_value[0], static_cast<std::streamsize>(size));
+  return static_cast<bool>(_in);
+}
+
+//////////////////////////////////////////////////
+/// \brief Write a color as four floats.
+static void WriteColor(std::ostream &_out, const math::Color &_color)
+{
+  const float rgba[4] = {_color.R(), _color.G(), _color.B(), _color.A()};
+  _out.write(reinterpret_cast<const char *>(rgba), sizeof(rgba));
+}
+
+//////////////////////////////////////////////////
+/// \brief Read a color written by WriteColor.
+static bool ReadColor(std::istream &_in, math::Color &_color)
+{
+  float rgba[4];
+  _in.read(reinterpret_cast<char *>(rgba), sizeof(rgba));
+  _color.Set(rgba[0], rgba[1], rgba[2], rgba[3]);
+  return static_cast<bool>(_in);
+}
+
+//////////////////////////////////////////////////
+/// \brief Write a list of vectors as consecutive doubles.
+/// \param[in] _count Number of vectors.
+/// \param[in] _get Function returning the components of a vector.
+template <std::size_t N, typename Getter>
+static void WriteVectors(std::ostream &_out, unsigned int _count,
+    const Getter &_get)
+{
+  WriteValue(_out, static_cast<uint64_t>(_count));
+  for (unsigned int i = 0u; i < _count; ++i)
+  {
+    const std::array<double, N> values = _get(i);
+    _out.write(reinterpret_cast<const char *>(values.data()),
+        sizeof(double) * N);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Read a list of vectors written by WriteVectors.
+/// \param[in] _add Function adding a vector from its components.
+template <std::size_t N, typename Adder>
+static bool ReadVectors(std::istream &_in, const Adder &_add)
+{
+  uint64_t count{0u};
+  if (!ReadValue(_in, count))
+    return false;
+  for (uint64_t i = 0u; i < count; ++i)
+  {
+    std::array<double, N> values;
+    _in.read(reinterpret_cast<char *>(values.data()), sizeof(double) * N);
+    if (!_in)
+      return false;
+    _add(values);
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Whether the cooked format holds everything in a mesh.
+/// \param[in] _mesh Mesh to check.
+/// \return False if the mesh has a skeleton or PBR materials.
+static bool Cookable(const common::Mesh &_mesh)
+{
+  if (_mesh.HasSkeleton())
+    return false;
+
+  for (unsigned int m = 0u; m < _mesh.MaterialCount(); ++m)
+  {
+    auto material = _mesh.MaterialByIndex(m);
+    if (material && nullptr != material->PbrMaterial())
+      return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Read a cooked mesh file.
+/// \param[in] _path File to read.
+/// \param[in] _name Name to give the mesh.
+/// \return The mesh, or nullptr if the file is missing or invalid.
+static std::unique_ptr<common::Mesh> ReadCooked(const std::string &_path,
+    const std::string &_name)
+{
+  IGN_PROFILE("MeshCache ReadCooked");
+
+  std::ifstream in(_path, std::ios::binary);
+  if (!in)
+    return nullptr;
+
+  char magic[4];
+  uint32_t version{0u};
+  uint32_t materialCount{0u};
+  in.read(magic, sizeof(magic));
+  if (!in || !std::equal(magic, magic + 4, kMagic) ||
+      !ReadValue(in, version) || version != kVersion ||
+      !ReadValue(in, materialCount))
+  {
+    return nullptr;
+  }
+
+  auto mesh = std::make_unique<common::Mesh>();
+  mesh->SetName(_name);
+  for (uint32_t m = 0u; m < materialCount; ++m)
+  {
+    auto material = std::make_shared<common::Material>();
+    math::Color ambient, diffuse, specular, emissive;
+    double transparency{0.0};
+    double shininess{0.0};
+    uint8_t lighting{0u};
+    std::string textureImage;
+    if (!ReadColor(in, ambient) || !ReadColor(in, diffuse) ||
+        !ReadColor(in, specular) || !ReadColor(in, emissive) ||
+        !ReadValue(in, transparency) || !ReadValue(in, shininess) ||
+        !ReadValue(in, lighting) || !ReadString(in, textureImage))
+    {
+      return nullptr;
+    }
+    material->SetAmbient(ambient);
+    material->SetDiffuse(diffuse);
+    material->SetSpecular(specular);
+    material->SetEmissive(emissive);
+    material->SetTransparency(transparency);
+    material->SetShininess(shininess);
+    material->SetLighting(lighting != 0u);
+    if (!textureImage.empty())
+      material->SetTextureImage(textureImage);
+    mesh->AddMaterial(material);
+  }
+
+  uint32_t subMeshCount{0u};
+  if (!ReadValue(in, subMeshCount))
+    return nullptr;
+
+  for (uint32_t s = 0u; s < subMeshCount; ++s)
+  {
+    std::string name;
+    int32_t primitive{0};
+    int64_t materialIndex{kNoMaterial};
+    if (!ReadString(in, name) || !ReadValue(in, primitive) ||
+        !ReadValue(in, materialIndex))
+    {
+      return nullptr;
+    }
+
+    common::SubMesh subMesh(name);
+    subMesh.SetPrimitiveType(
+        static_cast<common::SubMesh::PrimitiveType>(primitive));
+    if (materialIndex >= 0 &&
+        materialIndex < static_cast<int64_t>(materialCount))
+      subMesh.SetMaterialIndex(static_cast<unsigned int>(materialIndex));
+
+    uint64_t indexCount{0u};
+    if (!ReadVectors<3>(in, [&](const std::array<double, 3> &_v)
+        {
+          subMesh.AddVertex(_v[0], _v[1], _v[2]);
+        }) ||
+        !ReadVectors<3>(in, [&](const std::array<double, 3> &_v)
+        {
+          subMesh.AddNormal(_v[0], _v[1], _v[2]);
+        }) ||
+        !ReadVectors<2>(in, [&](const std::array<double, 2> &_v)
+        {
+          subMesh.AddTexCoord(_v[0], _v[1]);
+        }) ||
+        !ReadValue(in, indexCount))
+    {
+      return nullptr;
+    }
+
+    for (uint64_t i = 0u; i < indexCount; ++i)
+    {
+      uint32_t index{0u};
+      if (!ReadValue(in, index))
+        return nullptr;
+      subMesh.AddIndex(index);
+    }
+
+    mesh->AddSubMesh(subMesh);
+  }
+
+  return mesh;
+}
+
+//////////////////////////////////////////////////
+/// \brief Write a mesh to a cooked mesh file. The file is written under a
+/// temporary name and renamed, so other processes reading the cache never
+/// see a partial file.
+/// \param[in] _path File to write.
+/// \param[in] _mesh Mesh to write.
+static void WriteCooked(const std::string &_path, const common::Mesh &_mesh)
+{
+  IGN_PROFILE("MeshCache WriteCooked");
+
+  std::ostringstream tmpSuffix;
+  tmpSuffix << "." << &_mesh << ".tmp";
+  const auto tmpPath = _path + tmpSuffix.str();
+  std::ofstream out(tmpPath, std::ios::binary);
+
+  out.write(kMagic, sizeof(kMagic));
+  WriteValue(out, kVersion);
+
+  WriteValue(out, static_cast<uint32_t>(_mesh.MaterialCount()));
+  for (unsigned int m = 0u; m < _mesh.MaterialCount(); ++m)
+  {
+    auto material = _mesh.MaterialByIndex(m);
+    if (!material)
+      material = std::make_shared<common::Material>();
+    WriteColor(out, material->Ambient());
+    WriteColor(out, material->Diffuse());
+    WriteColor(out, material->Specular());
+    WriteColor(out, material->Emissive());
+    WriteValue(out, material->Transparency());
+    WriteValue(out, material->Shininess());
+    WriteValue(out, static_cast<uint8_t>(material->Lighting()));
+    WriteString(out, material->TextureImage());
+  }
+
+  WriteValue(out, static_cast<uint32_t>(_mesh.SubMeshCount()));
+  for (unsigned int s = 0u; s < _mesh.SubMeshCount(); ++s)
+  {
+    auto subMesh = _mesh.SubMeshByIndex(s).lock();
+    if (!subMesh)
+      subMesh = std::make_shared<common::SubMesh>();
+
+    int64_t materialIndex = subMesh->MaterialIndex() < _mesh.MaterialCount() ?
+        static_cast<int64_t>(subMesh->MaterialIndex()) : kNoMaterial;
+    WriteString(out, subMesh->Name());
+    WriteValue(out, static_cast<int32_t>(subMesh->SubMeshPrimitiveType()));
+    WriteValue(out, materialIndex);
+
+    WriteVectors<3>(out, subMesh->VertexCount(), [&](unsigned int _i)
+    {
+      const auto v = subMesh->Vertex(_i);
+      return std::array<double, 3>{v.X(), v.Y(), v.Z()};
+    });
+    WriteVectors<3>(out, subMesh->NormalCount(), [&](unsigned int _i)
+    {
+      const auto n = subMesh->Normal(_i);
+      return std::array<double, 3>{n.X(), n.Y(), n.Z()};
+    });
+    WriteVectors<2>(out, subMesh->TexCoordCount(), [&](unsigned int _i)
+    {
+      const auto t = subMesh->TexCoord(_i);
+      return std::array<double, 2>{t.X(), t.Y()};
+    });
+
+    WriteValue(out, static_cast<uint64_t>(subMesh->IndexCount()));
+    for (unsigned int i = 0u; i < subMesh->IndexCount(); ++i)
+      WriteValue(out, static_cast<uint32_t>(subMesh->Index(i)));
+  }
+
+  out.close();
+  if (!out || std::rename(tmpPath.c_str(), _path.c_str()) != 0)
+  {
+    ignwarn << "Failed to write mesh cache file [" << _path << "]."
+            << std::endl;
+    std::remove(tmpPath.c_str());
+  }
+}
+
+//////////////////////////////////////////////////
+MeshCache &MeshCache::Instance()
+{
+  static MeshCache cache;
+  return cache;
+}
+
+//////////////////////////////////////////////////
+MeshCache::MeshCache()
+  : dataPtr(std::make_unique<MeshCachePrivate>())
+{
+  const char *envDir = std::getenv("IGN_GAZEBO_MESH_CACHE_PATH");
+  if (nullptr != envDir)
+  {
+    this->dataPtr->cacheDir = envDir;
+  }
+  else
+  {
+    std::string home;
+    common::env(IGN_HOMEDIR, home);
+    this->dataPtr->cacheDir =
+        common::joinPaths(home, ".ignition", "gazebo", "mesh_cache");
+  }
+}
+
+//////////////////////////////////////////////////
+MeshCache::~MeshCache() = default;
+
+//////////////////////////////////////////////////
+const common::Mesh *MeshCache::Load(const std::string &_uri)
+{
+  IGN_PROFILE("MeshCache::Load");
+
+  auto *meshManager = common::MeshManager::Instance();
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  if (meshManager->HasMesh(_uri))
+    return meshManager->MeshByName(_uri);
+
+  // Create the directory lazily, so processes which never load meshes
+  // don't touch the disk
+  if (!this->dataPtr->cacheDir.empty() && !this->dataPtr->dirReady)
+  {
+    if (!common::exists(this->dataPtr->cacheDir) &&
+        !common::createDirectories(this->dataPtr->cacheDir))
+    {
+      ignwarn << "Failed to create mesh cache directory ["
+              << this->dataPtr->cacheDir << "]. Meshes won't be cached."
+              << std::endl;
+      this->dataPtr->cacheDir.clear();
+    }
+    this->dataPtr->dirReady = true;
+  }
+
+  uint64_t hash{0u};
+  std::string cookedPath;
+  if (!this->dataPtr->cacheDir.empty() &&
+      HashFile(common::findFile(_uri), hash))
+  {
+    std::ostringstream name;
+    name << std::hex << hash << ".mesh";
+    cookedPath = common::joinPaths(this->dataPtr->cacheDir, name.str());
+
+    auto cooked = ReadCooked(cookedPath, _uri);
+    if (cooked)
+    {
+      // The manager takes ownership
+      auto *result = cooked.release();
+      meshManager->AddMesh(result);
+      return result;
+    }
+  }
+
+  auto *mesh = meshManager->Load(_uri);
+  if (nullptr != mesh && !cookedPath.empty() && Cookable(*mesh))
+    WriteCooked(cookedPath, *mesh);
+
+  return mesh;
+}
+
+//////////////////////////////////////////////////
+void MeshCache::SetCacheDir(const std::string &_dir)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->cacheDir = _dir;
+  this->dataPtr->dirReady = false;
+}
+
+//////////////////////////////////////////////////
+std::string MeshCache::CacheDir() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->cacheDir;
+}
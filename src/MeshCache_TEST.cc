@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/SubMesh.hh>
+
+#include "ignition/gazebo/MeshCache.hh"
+#include "ignition/gazebo/test_config.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Count the cooked meshes in a directory.
+/// \param[in] _dir Directory.
+/// \return Number of files.
+static unsigned int CookedCount(const std::string &_dir)
+{
+  unsigned int count{0u};
+  for (common::DirIter file(_dir); file != common::DirIter(); ++file)
+  {
+    if (common::basename(*file).find(".mesh") != std::string::npos)
+      ++count;
+  }
+  return count;
+}
+
+/////////////////////////////////////////////////
+TEST(MeshCache, Load)
+{
+  auto &cache = MeshCache::Instance();
+  const auto originalDir = cache.CacheDir();
+
+  const auto dir = common::joinPaths(PROJECT_BINARY_PATH, "mesh_cache_test");
+  common::removeAll(dir);
+  const auto cacheDir = common::joinPaths(dir, "cache");
+  cache.SetCacheDir(cacheDir);
+
+  // Identical meshes at different paths
+  const auto source = common::joinPaths(PROJECT_SOURCE_PATH, "test", "worlds",
+      "models", "mesh_with_submeshes", "meshes", "mesh_with_submeshes.dae");
+  ASSERT_TRUE(common::createDirectories(dir));
+  const auto first = common::joinPaths(dir, "first.dae");
+  const auto second = common::joinPaths(dir, "second.dae");
+  ASSERT_TRUE(common::copyFile(source, first));
+  ASSERT_TRUE(common::copyFile(source, second));
+
+  // Parsed and cooked
+  auto *parsed = cache.Load(first);
+  ASSERT_NE(nullptr, parsed);
+  EXPECT_EQ(first, parsed->Name());
+  EXPECT_EQ(1u, CookedCount(cacheDir));
+
+  // Kept in memory
+  EXPECT_EQ(parsed, cache.Load(first));
+
+  // Read back from the cooked file, which is shared by both paths
+  auto *cooked = cache.Load(second);
+  ASSERT_NE(nullptr, cooked);
+  EXPECT_NE(parsed, cooked);
+  EXPECT_EQ(second, cooked->Name());
+  EXPECT_EQ(1u, CookedCount(cacheDir));
+
+  EXPECT_EQ(parsed->MaterialCount(), cooked->MaterialCount());
+  ASSERT_EQ(parsed->SubMeshCount(), cooked->SubMeshCount());
+  for (unsigned int s = 0u; s < parsed->SubMeshCount(); ++s)
+  {
+    auto parsedSub = parsed->SubMeshByIndex(s).lock();
+    auto cookedSub = cooked->SubMeshByIndex(s).lock();
+    ASSERT_NE(nullptr, parsedSub);
+    ASSERT_NE(nullptr, cookedSub);
+    EXPECT_EQ(parsedSub->Name(), cookedSub->Name());
+    EXPECT_EQ(parsedSub->MaterialIndex(), cookedSub->MaterialIndex());
+    ASSERT_EQ(parsedSub->VertexCount(), cookedSub->VertexCount());
+    EXPECT_EQ(parsedSub->NormalCount(), cookedSub->NormalCount());
+    EXPECT_EQ(parsedSub->TexCoordCount(), cookedSub->TexCoordCount());
+    ASSERT_EQ(parsedSub->IndexCount(), cookedSub->IndexCount());
+    for (unsigned int v = 0u; v < parsedSub->VertexCount(); ++v)
+      EXPECT_EQ(parsedSub->Vertex(v), cookedSub->Vertex(v));
+    for (unsigned int i = 0u; i < parsedSub->IndexCount(); ++i)
+      EXPECT_EQ(parsedSub->Index(i), cookedSub->Index(i));
+  }
+  EXPECT_EQ(parsed->Min(), cooked->Min());
+  EXPECT_EQ(parsed->Max(), cooked->Max());
+
+  // Nothing is written when disabled
+  const auto third = common::joinPaths(dir, "third.dae");
+  ASSERT_TRUE(common::copyFile(source, third));
+  common::removeAll(cacheDir);
+  cache.SetCacheDir("");
+  EXPECT_NE(nullptr, cache.Load(third));
+  EXPECT_FALSE(common::exists(cacheDir));
+
+  // Missing files
+  EXPECT_EQ(nullptr, cache.Load(common::joinPaths(dir, "missing.dae")));
+
+  cache.SetCacheDir(originalDir);
+}
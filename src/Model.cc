@@ -20,7 +20,6 @@
 #include "ignition/gazebo/components/Link.hh"
 #include "ignition/gazebo/components/Model.hh"
 #include "ignition/gazebo/components/Name.hh"
-#include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/PoseCmd.hh"
 #include "ignition/gazebo/components/SelfCollide.hh"
 #include "ignition/gazebo/components/SourceFilePath.hh"
@@ -132,44 +131,32 @@ std::string Model::SourceFilePath(const EntityComponentManager &_ecm) const
 Entity Model::JointByName(const EntityComponentManager &_ecm,
     const std::string &_name)
 {
-  return _ecm.EntityByComponents(
-      components::ParentEntity(this->dataPtr->id),
-      components::Name(_name),
-      components::Joint());
+  return _ecm.ChildByName<components::Joint>(this->dataPtr->id, _name);
 }
 
 //////////////////////////////////////////////////
 Entity Model::LinkByName(const EntityComponentManager &_ecm,
     const std::string &_name)
 {
-  return _ecm.EntityByComponents(
-      components::ParentEntity(this->dataPtr->id),
-      components::Name(_name),
-      components::Link());
+  return _ecm.ChildByName<components::Link>(this->dataPtr->id, _name);
 }
 
 //////////////////////////////////////////////////
 std::vector<Entity> Model::Joints(const EntityComponentManager &_ecm) const
 {
-  return _ecm.EntitiesByComponents(
-      components::ParentEntity(this->dataPtr->id),
-      components::Joint());
+  return _ecm.ChildrenWithComponents<components::Joint>(this->dataPtr->id);
 }
 
 //////////////////////////////////////////////////
 std::vector<Entity> Model::Links(const EntityComponentManager &_ecm) const
 {
-  return _ecm.EntitiesByComponents(
-      components::ParentEntity(this->dataPtr->id),
-      components::Link());
+  return _ecm.ChildrenWithComponents<components::Link>(this->dataPtr->id);
 }
 
 //////////////////////////////////////////////////
 std::vector<Entity> Model::Models(const EntityComponentManager &_ecm) const
 {
-  return _ecm.EntitiesByComponents(
-      components::ParentEntity(this->dataPtr->id),
-      components::Model());
+  return _ecm.ChildrenWithComponents<components::Model>(this->dataPtr->id);
 }
 
 //////////////////////////////////////////////////
@@ -206,7 +193,7 @@ void Model::SetWorldPoseCmd(EntityComponentManager &_ecm,
 //////////////////////////////////////////////////
 Entity Model::CanonicalLink(const EntityComponentManager &_ecm) const
 {
-  return _ecm.EntityByComponents(
-      components::ParentEntity(this->dataPtr->id),
-      components::CanonicalLink());
+  auto links = _ecm.ChildrenWithComponents<components::CanonicalLink>(
+      this->dataPtr->id);
+  return links.empty() ? kNullEntity : links.front();
 }
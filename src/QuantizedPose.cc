@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ignition/gazebo/QuantizedPose.hh"
+
+#include <ignition/msgs/pose.pb.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include <ignition/msgs/Utility.hh>
+
+#include "ignition/gazebo/components/Pose.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief First byte of an encoded pose. Zero is never a valid protobuf tag,
+/// so it can't be mistaken for a serialized message.
+static const unsigned char kMagic{0x00};
+
+/// \brief Version of the encoding.
+static const unsigned char kVersion{0x01};
+
+/// \brief Bytes used by the header: magic, version and resolution exponent.
+static const std::size_t kHeaderSize{3u};
+
+/// \brief Largest absolute value of the three smallest components of a unit
+/// quaternion.
+static const double kQuatRange{1.0 / std::sqrt(2.0)};
+
+/// \brief Largest value of a quantized quaternion component.
+static const double kQuatSteps{65535.0};
+
+//////////////////////////////////////////////////
+static void AppendVarint(std::string &_out, int64_t _value)
+{
+  // Zigzag so that small negative values are short too
+  auto zigzag = (static_cast<uint64_t>(_value) << 1) ^
+      static_cast<uint64_t>(_value >> 63);
+  while (zigzag >= 0x80)
+  {
+    _out.push_back(static_cast<char>((zigzag & 0x7F) | 0x80));
+    zigzag >>= 7;
+  }
+  _out.push_back(static_cast<char>(zigzag));
+}
+
+//////////////////////////////////////////////////
+static bool ReadVarint(const std::string &_data, std::size_t &_pos,
+    int64_t &_value)
+{
+  uint64_t zigzag{0u};
+  for (unsigned int shift = 0u; shift < 64u; shift += 7u)
+  {
+    if (_pos >= _data.size())
+      return false;
+    auto byte = static_cast<unsigned char>(_data[_pos++]);
+    zigzag |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0)
+    {
+      _value = static_cast<int64_t>(zigzag >> 1) ^
+          -static_cast<int64_t>(zigzag & 1u);
+      return true;
+    }
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+static int ResolutionExponent(double _resolution)
+{
+  if (!(_resolution > 0.0))
+    return -4;
+  auto exponent = static_cast<int>(std::round(std::log10(_resolution)));
+  return std::clamp(exponent, -9, 0);
+}
+
+//////////////////////////////////////////////////
+std::string ignition::gazebo::encodeQuantizedPose(const math::Pose3d &_pose,
+    double _resolution)
+{
+  const int exponent = ResolutionExponent(_resolution);
+  const double scale = std::pow(10.0, -exponent);
+
+  std::string out;
+  out.reserve(24u);
+  out.push_back(static_cast<char>(kMagic));
+  out.push_back(static_cast<char>(kVersion));
+  out.push_back(static_cast<char>(static_cast<int8_t>(exponent)));
+
+  for (int i = 0; i < 3; ++i)
+  {
+    AppendVarint(out, static_cast<int64_t>(std::llround(_pose.Pos()[i] *
+        scale)));
+  }
+
+  auto rot = _pose.Rot();
+  rot.Normalize();
+  double q[4]{rot.W(), rot.X(), rot.Y(), rot.Z()};
+
+  unsigned char largest{0u};
+  for (unsigned char i = 1u; i < 4u; ++i)
+  {
+    if (std::abs(q[i]) > std::abs(q[largest]))
+      largest = i;
+  }
+
+  // q and -q are the same rotation, make the dropped component positive so
+  // its sign doesn't need to be stored.
+  const double sign = q[largest] < 0.0 ? -1.0 : 1.0;
+  out.push_back(static_cast<char>(largest));
+  for (unsigned char i = 0u; i < 4u; ++i)
+  {
+    if (i == largest)
+      continue;
+    double normalized = std::clamp((q[i] * sign + kQuatRange) /
+        (2.0 * kQuatRange), 0.0, 1.0);
+    auto value = static_cast<uint16_t>(std::lround(normalized * kQuatSteps));
+    out.push_back(static_cast<char>(value & 0xFF));
+    out.push_back(static_cast<char>(value >> 8));
+  }
+
+  return out;
+}
+
+//////////////////////////////////////////////////
+bool ignition::gazebo::decodeQuantizedPose(const std::string &_data,
+    math::Pose3d &_pose)
+{
+  if (!isQuantizedPose(_data))
+    return false;
+
+  const int exponent = static_cast<int8_t>(_data[2]);
+  if (exponent < -9 || exponent > 0)
+    return false;
+  const double resolution = std::pow(10.0, exponent);
+
+  std::size_t pos{kHeaderSize};
+  math::Vector3d position;
+  for (int i = 0; i < 3; ++i)
+  {
+    int64_t value{0};
+    if (!ReadVarint(_data, pos, value))
+      return false;
+    position[i] = static_cast<double>(value) * resolution;
+  }
+
+  if (_data.size() != pos + 7u)
+    return false;
+
+  const auto largest = static_cast<unsigned char>(_data[pos++]);
+  if (largest > 3u)
+    return false;
+
+  double q[4]{0.0, 0.0, 0.0, 0.0};
+  double sumSquared{0.0};
+  for (unsigned char i = 0u; i < 4u; ++i)
+  {
+    if (i == largest)
+      continue;
+    auto value = static_cast<uint16_t>(
+        static_cast<unsigned char>(_data[pos]) |
+        (static_cast<unsigned char>(_data[pos + 1]) << 8));
+    pos += 2u;
+    q[i] = (value / kQuatSteps) * 2.0 * kQuatRange - kQuatRange;
+    sumSquared += q[i] * q[i];
+  }
+  q[largest] = std::sqrt(std::max(0.0, 1.0 - sumSquared));
+
+  math::Quaterniond rot(q[0], q[1], q[2], q[3]);
+  rot.Normalize();
+  _pose.Set(position, rot);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool ignition::gazebo::isQuantizedPose(const std::string &_data)
+{
+  return _data.size() > kHeaderSize &&
+      static_cast<unsigned char>(_data[0]) == kMagic &&
+      static_cast<unsigned char>(_data[1]) == kVersion;
+}
+
+//////////////////////////////////////////////////
+std::size_t ignition::gazebo::quantizePoses(msgs::SerializedStateMap &_state,
+    double _resolution)
+{
+  std::size_t count{0u};
+  msgs::Pose poseMsg;
+  for (auto &entityIt : *_state.mutable_entities())
+  {
+    auto compIt = entityIt.second.mutable_components()->find(
+        static_cast<int64_t>(components::Pose::typeId));
+    if (compIt == entityIt.second.mutable_components()->end() ||
+        compIt->second.remove() || isQuantizedPose(compIt->second.component()))
+    {
+      continue;
+    }
+
+    if (!poseMsg.ParseFromString(compIt->second.component()))
+      continue;
+
+    compIt->second.set_component(
+        encodeQuantizedPose(msgs::Convert(poseMsg), _resolution));
+    ++count;
+  }
+  return count;
+}
+
+//////////////////////////////////////////////////
+bool ignition::gazebo::hasQuantizedPoses(
+    const msgs::SerializedStateMap &_state)
+{
+  for (const auto &entityIt : _state.entities())
+  {
+    auto compIt = entityIt.second.components().find(
+        static_cast<int64_t>(components::Pose::typeId));
+    if (compIt != entityIt.second.components().end() &&
+        isQuantizedPose(compIt->second.component()))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+std::size_t ignition::gazebo::dequantizePoses(
+    msgs::SerializedStateMap &_state)
+{
+  std::size_t count{0u};
+  math::Pose3d pose;
+  for (auto &entityIt : *_state.mutable_entities())
+  {
+    auto compIt = entityIt.second.mutable_components()->find(
+        static_cast<int64_t>(components::Pose::typeId));
+    if (compIt == entityIt.second.mutable_components()->end() ||
+        !decodeQuantizedPose(compIt->second.component(), pose))
+    {
+      continue;
+    }
+
+    compIt->second.set_component(msgs::Convert(pose).SerializeAsString());
+    ++count;
+  }
+  return count;
+}
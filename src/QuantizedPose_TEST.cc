@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ignition/msgs/pose.pb.h>
+#include <ignition/msgs/serialized_map.pb.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <ignition/msgs/Utility.hh>
+
+#include "ignition/gazebo/QuantizedPose.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/Pose.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(QuantizedPose, RoundTrip)
+{
+  std::vector<math::Pose3d> poses{
+      math::Pose3d::Zero,
+      math::Pose3d(1.2345, -6.789, 0.001, 0.1, 0.2, 0.3),
+      math::Pose3d(-1000, 2000, -0.00004, IGN_PI, 0, 0),
+      math::Pose3d(0.5, 0.5, 0.5, -IGN_PI_2, 0.7, -2.5),
+      math::Pose3d(math::Vector3d(3, 2, 1), math::Quaterniond(0, 0, 0, -1))};
+
+  for (const auto &pose : poses)
+  {
+    auto data = encodeQuantizedPose(pose);
+    EXPECT_TRUE(isQuantizedPose(data));
+
+    // Never larger than the equivalent protobuf message
+    auto protoSize = msgs::Convert(pose).ByteSizeLong();
+    EXPECT_LE(data.size(), protoSize) << pose;
+
+    math::Pose3d decoded;
+    ASSERT_TRUE(decodeQuantizedPose(data, decoded)) << pose;
+    EXPECT_TRUE(pose.Pos().Equal(decoded.Pos(), 1e-4)) << pose << " vs "
+        << decoded;
+
+    // Compare rotations, which are the same up to sign
+    auto dot = std::abs(pose.Rot().Dot(decoded.Rot()));
+    EXPECT_NEAR(1.0, dot, 1e-4) << pose << " vs " << decoded;
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(QuantizedPose, Resolution)
+{
+  math::Pose3d pose(0.123456, 0, 0, 0, 0, 0);
+
+  math::Pose3d decoded;
+  ASSERT_TRUE(decodeQuantizedPose(encodeQuantizedPose(pose, 0.01), decoded));
+  EXPECT_DOUBLE_EQ(0.12, decoded.Pos().X());
+
+  ASSERT_TRUE(decodeQuantizedPose(encodeQuantizedPose(pose, 1e-6), decoded));
+  EXPECT_NEAR(0.123456, decoded.Pos().X(), 1e-9);
+
+  // Invalid resolution falls back to the default
+  ASSERT_TRUE(decodeQuantizedPose(encodeQuantizedPose(pose, -1.0), decoded));
+  EXPECT_NEAR(0.1235, decoded.Pos().X(), 1e-9);
+}
+
+/////////////////////////////////////////////////
+TEST(QuantizedPose, Invalid)
+{
+  math::Pose3d decoded;
+  EXPECT_FALSE(decodeQuantizedPose("", decoded));
+  EXPECT_FALSE(isQuantizedPose(""));
+
+  // Serialized protobuf messages never look like a quantized pose
+  auto proto = msgs::Convert(math::Pose3d(1, 2, 3, 0, 0, 0))
+      .SerializeAsString();
+  EXPECT_FALSE(isQuantizedPose(proto));
+  EXPECT_FALSE(decodeQuantizedPose(proto, decoded));
+
+  // Truncated data
+  auto data = encodeQuantizedPose(math::Pose3d(1, 2, 3, 0.1, 0.2, 0.3));
+  EXPECT_FALSE(decodeQuantizedPose(data.substr(0, data.size() - 1), decoded));
+  EXPECT_FALSE(decodeQuantizedPose(data + "x", decoded));
+}
+
+/////////////////////////////////////////////////
+TEST(QuantizedPose, StateMap)
+{
+  msgs::SerializedStateMap state;
+
+  const math::Pose3d pose(1, 2, 3, 0.1, 0.2, 0.3);
+  auto &entity = (*state.mutable_entities())[1u];
+  entity.set_id(1u);
+  auto &poseComp = (*entity.mutable_components())[
+      static_cast<int64_t>(components::Pose::typeId)];
+  poseComp.set_type(components::Pose::typeId);
+  poseComp.set_component(msgs::Convert(pose).SerializeAsString());
+
+  auto &nameComp = (*entity.mutable_components())[
+      static_cast<int64_t>(components::Name::typeId)];
+  nameComp.set_type(components::Name::typeId);
+  nameComp.set_component("name");
+
+  // Removed components are left alone
+  auto &removed = (*state.mutable_entities())[2u];
+  removed.set_id(2u);
+  auto &removedComp = (*removed.mutable_components())[
+      static_cast<int64_t>(components::Pose::typeId)];
+  removedComp.set_type(components::Pose::typeId);
+  removedComp.set_remove(true);
+
+  EXPECT_FALSE(hasQuantizedPoses(state));
+  EXPECT_EQ(1u, quantizePoses(state));
+  EXPECT_TRUE(hasQuantizedPoses(state));
+  EXPECT_TRUE(isQuantizedPose(poseComp.component()));
+  EXPECT_EQ("name", nameComp.component());
+  EXPECT_TRUE(removedComp.component().empty());
+
+  // Already quantized
+  EXPECT_EQ(0u, quantizePoses(state));
+
+  EXPECT_EQ(1u, dequantizePoses(state));
+  EXPECT_EQ(0u, dequantizePoses(state));
+  EXPECT_FALSE(hasQuantizedPoses(state));
+  EXPECT_EQ("name", nameComp.component());
+
+  msgs::Pose poseMsg;
+  ASSERT_TRUE(poseMsg.ParseFromString(poseComp.component()));
+  auto decoded = msgs::Convert(poseMsg);
+  EXPECT_TRUE(pose.Pos().Equal(decoded.Pos(), 1e-4));
+  EXPECT_NEAR(1.0, std::abs(pose.Rot().Dot(decoded.Rot())), 1e-4);
+}
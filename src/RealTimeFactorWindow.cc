@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "RealTimeFactorWindow.hh"
+
+#include <algorithm>
+#include <vector>
+
+class ignition::gazebo::RealTimeFactorWindowPrivate
+{
+  /// \brief Sim times, used as a ring buffer.
+  public: std::vector<std::chrono::steady_clock::duration> simTimes;
+
+  /// \brief Real times, parallel to simTimes.
+  public: std::vector<std::chrono::steady_clock::duration> realTimes;
+
+  /// \brief Index of the oldest pair.
+  public: std::size_t head{0u};
+
+  /// \brief Number of pairs in the window.
+  public: std::size_t count{0u};
+
+  /// \brief Sum of all sim times in the window.
+  public: std::chrono::steady_clock::duration simSum{0};
+
+  /// \brief Sum of all real times in the window.
+  public: std::chrono::steady_clock::duration realSum{0};
+};
+
+using namespace ignition::gazebo;
+
+//////////////////////////////////////////////////
+RealTimeFactorWindow::RealTimeFactorWindow(std::size_t _capacity)
+  : dataPtr(std::make_unique<RealTimeFactorWindowPrivate>())
+{
+  const auto capacity = std::max<std::size_t>(_capacity, 2u);
+  this->dataPtr->simTimes.resize(capacity);
+  this->dataPtr->realTimes.resize(capacity);
+}
+
+//////////////////////////////////////////////////
+RealTimeFactorWindow::~RealTimeFactorWindow() = default;
+
+//////////////////////////////////////////////////
+void RealTimeFactorWindow::Push(std::chrono::steady_clock::duration _simTime,
+    std::chrono::steady_clock::duration _realTime)
+{
+  auto &d = *this->dataPtr;
+  const auto capacity = d.simTimes.size();
+
+  if (d.count == capacity)
+  {
+    d.simSum -= d.simTimes[d.head];
+    d.realSum -= d.realTimes[d.head];
+    d.head = (d.head + 1u) % capacity;
+    --d.count;
+  }
+
+  const auto tail = (d.head + d.count) % capacity;
+  d.simTimes[tail] = _simTime;
+  d.realTimes[tail] = _realTime;
+  d.simSum += _simTime;
+  d.realSum += _realTime;
+  ++d.count;
+}
+
+//////////////////////////////////////////////////
+void RealTimeFactorWindow::Clear()
+{
+  this->dataPtr->head = 0u;
+  this->dataPtr->count = 0u;
+  this->dataPtr->simSum = std::chrono::steady_clock::duration::zero();
+  this->dataPtr->realSum = std::chrono::steady_clock::duration::zero();
+}
+
+//////////////////////////////////////////////////
+std::size_t RealTimeFactorWindow::Count() const
+{
+  return this->dataPtr->count;
+}
+
+//////////////////////////////////////////////////
+std::size_t RealTimeFactorWindow::Capacity() const
+{
+  return this->dataPtr->simTimes.size();
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration RealTimeFactorWindow::SimElapsed() const
+{
+  // Sum over all pairs of (time - oldest time)
+  if (this->dataPtr->count == 0u)
+    return std::chrono::steady_clock::duration::zero();
+  return this->dataPtr->simSum -
+      this->dataPtr->simTimes[this->dataPtr->head] *
+      static_cast<int64_t>(this->dataPtr->count);
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration RealTimeFactorWindow::RealElapsed() const
+{
+  if (this->dataPtr->count == 0u)
+    return std::chrono::steady_clock::duration::zero();
+  return this->dataPtr->realSum -
+      this->dataPtr->realTimes[this->dataPtr->head] *
+      static_cast<int64_t>(this->dataPtr->count);
+}
+
+//////////////////////////////////////////////////
+double RealTimeFactorWindow::RealTimeFactor() const
+{
+  const auto real = this->RealElapsed();
+  if (real.count() <= 0)
+    return 0.0;
+  return static_cast<double>(this->SimElapsed().count()) / real.count();
+}
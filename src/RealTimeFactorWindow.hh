@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_REALTIMEFACTORWINDOW_HH_
+#define IGNITION_GAZEBO_REALTIMEFACTORWINDOW_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class RealTimeFactorWindowPrivate;
+
+    /// \class RealTimeFactorWindow RealTimeFactorWindow.hh
+    /// \brief Computes the real time factor over the most recent steps.
+    ///
+    /// Pairs of sim and real times are kept in a fixed size ring buffer,
+    /// allocated up front, together with their running sums. Adding a pair
+    /// and computing the real time factor take constant time and never
+    /// allocate, no matter the window size.
+    ///
+    /// The real time factor is the ratio of the sim time elapsed since the
+    /// oldest pair to the real time elapsed since it, averaged over all
+    /// pairs in the window.
+    class IGNITION_GAZEBO_VISIBLE RealTimeFactorWindow
+    {
+      /// \brief Constructor
+      /// \param[in] _capacity Number of pairs in the window. At least 2.
+      public: explicit RealTimeFactorWindow(std::size_t _capacity = 20u);
+
+      /// \brief Destructor
+      public: ~RealTimeFactorWindow();
+
+      /// \brief Add the times of a step, dropping the oldest pair if the
+      /// window is full.
+      /// \param[in] _simTime Sim time of the step.
+      /// \param[in] _realTime Real time of the step.
+      public: void Push(std::chrono::steady_clock::duration _simTime,
+                  std::chrono::steady_clock::duration _realTime);
+
+      /// \brief Remove all pairs, such as after a rewind or seek.
+      public: void Clear();
+
+      /// \brief Number of pairs in the window.
+      /// \return Pair count.
+      public: std::size_t Count() const;
+
+      /// \brief Maximum number of pairs in the window.
+      /// \return Capacity.
+      public: std::size_t Capacity() const;
+
+      /// \brief Sim time elapsed since the oldest pair, summed over all
+      /// pairs in the window.
+      /// \return Summed sim time.
+      public: std::chrono::steady_clock::duration SimElapsed() const;
+
+      /// \brief Real time elapsed since the oldest pair, summed over all
+      /// pairs in the window.
+      /// \return Summed real time.
+      public: std::chrono::steady_clock::duration RealElapsed() const;
+
+      /// \brief Real time factor over the window.
+      /// \return SimElapsed divided by RealElapsed, or zero if no real time
+      /// elapsed.
+      public: double RealTimeFactor() const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<RealTimeFactorWindowPrivate> dataPtr;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_REALTIMEFACTORWINDOW_HH_
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "RealTimeFactorWindow.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+/////////////////////////////////////////////////
+TEST(RealTimeFactorWindow, Empty)
+{
+  RealTimeFactorWindow window(5u);
+  EXPECT_EQ(0u, window.Count());
+  EXPECT_EQ(5u, window.Capacity());
+  EXPECT_DOUBLE_EQ(0.0, window.RealTimeFactor());
+
+  // A single pair has no elapsed time
+  window.Push(1ms, 1ms);
+  EXPECT_EQ(1u, window.Count());
+  EXPECT_DOUBLE_EQ(0.0, window.RealTimeFactor());
+
+  // Capacity is at least 2
+  RealTimeFactorWindow tiny(0u);
+  EXPECT_EQ(2u, tiny.Capacity());
+}
+
+/////////////////////////////////////////////////
+TEST(RealTimeFactorWindow, Rolling)
+{
+  RealTimeFactorWindow window(4u);
+
+  // Sim runs at half speed
+  for (int i = 0; i < 4; ++i)
+    window.Push(i * 1ms, i * 2ms);
+  EXPECT_EQ(4u, window.Count());
+  EXPECT_EQ(0ms + 1ms + 2ms + 3ms, window.SimElapsed());
+  EXPECT_EQ(0ms + 2ms + 4ms + 6ms, window.RealElapsed());
+  EXPECT_DOUBLE_EQ(0.5, window.RealTimeFactor());
+
+  // Then twice as fast, older pairs drop out of the window
+  for (int i = 0; i < 3; ++i)
+    window.Push(3ms + (i + 1) * 2ms, 6ms + (i + 1) * 1ms);
+  EXPECT_EQ(4u, window.Count());
+  EXPECT_EQ(0ms + 2ms + 4ms + 6ms, window.SimElapsed());
+  EXPECT_EQ(0ms + 1ms + 2ms + 3ms, window.RealElapsed());
+  EXPECT_DOUBLE_EQ(2.0, window.RealTimeFactor());
+
+  window.Clear();
+  EXPECT_EQ(0u, window.Count());
+  EXPECT_DOUBLE_EQ(0.0, window.RealTimeFactor());
+
+  window.Push(10ms, 10ms);
+  window.Push(11ms, 11ms);
+  EXPECT_DOUBLE_EQ(1.0, window.RealTimeFactor());
+}
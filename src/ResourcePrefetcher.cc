@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ResourcePrefetcher.hh"
+
+#include <fstream>
+#include <vector>
+
+using namespace ignition;
+using namespace gazebo;
+
+//////////////////////////////////////////////////
+ResourcePrefetcher::~ResourcePrefetcher()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stop = true;
+  }
+  this->cv.notify_all();
+  if (this->worker.joinable())
+    this->worker.join();
+}
+
+//////////////////////////////////////////////////
+bool ResourcePrefetcher::Prefetch(const std::string &_path)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (_path.empty() || !this->queued.insert(_path).second)
+      return false;
+
+    this->queue.push_back(_path);
+
+    if (!this->worker.joinable())
+      this->worker = std::thread(&ResourcePrefetcher::Run, this);
+  }
+  this->cv.notify_one();
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::size_t ResourcePrefetcher::Pending() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->queue.size() + (this->reading ? 1u : 0u);
+}
+
+//////////////////////////////////////////////////
+std::size_t ResourcePrefetcher::BytesRead() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->bytesRead;
+}
+
+//////////////////////////////////////////////////
+void ResourcePrefetcher::Run()
+{
+  std::vector<char> buffer(1u << 16u);
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while (true)
+  {
+    this->cv.wait(lock, [this]
+    {
+      return this->stop || !this->queue.empty();
+    });
+    if (this->stop)
+      return;
+
+    std::string path = std::move(this->queue.front());
+    this->queue.pop_front();
+    this->reading = true;
+    lock.unlock();
+
+    // Missing files are silently skipped, whoever loads them later reports
+    // the error
+    std::size_t bytes{0u};
+    std::ifstream file(path, std::ios::binary);
+    while (file)
+    {
+      file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      bytes += static_cast<std::size_t>(file.gcount());
+    }
+
+    lock.lock();
+    this->reading = false;
+    this->bytesRead += bytes;
+  }
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_RESOURCEPREFETCHER_HH_
+#define IGNITION_GAZEBO_RESOURCEPREFETCHER_HH_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class ResourcePrefetcher ResourcePrefetcher.hh
+    /// \brief Reads files on a background thread, so they're already in the
+    /// operating system's page cache by the time they're loaded.
+    ///
+    /// This is used to hide disk latency when streaming levels: the meshes
+    /// of levels a performer is approaching are read ahead of time, so
+    /// loading them once the level becomes active doesn't stall the
+    /// simulation waiting on the disk. The file contents are discarded.
+    class IGNITION_GAZEBO_VISIBLE ResourcePrefetcher
+    {
+      /// \brief Constructor. The background thread is started on the first
+      /// call to Prefetch.
+      public: ResourcePrefetcher() = default;
+
+      /// \brief Destructor. Files which haven't been read yet are skipped.
+      public: ~ResourcePrefetcher();
+
+      /// \brief Queue a file to be read. Files are only read once.
+      /// \param[in] _path Full path to the file.
+      /// \return True if the file was queued, false if it had already been
+      /// queued before.
+      public: bool Prefetch(const std::string &_path);
+
+      /// \brief Number of files which are queued and haven't been read yet.
+      /// \return Number of pending files.
+      public: std::size_t Pending() const;
+
+      /// \brief Number of bytes read so far.
+      /// \return Bytes read.
+      public: std::size_t BytesRead() const;
+
+      /// \brief Read queued files until stopped, run from the worker thread.
+      private: void Run();
+
+      /// \brief Protects all members below.
+      private: mutable std::mutex mutex;
+
+      /// \brief Notified when files are queued or on shutdown.
+      private: std::condition_variable cv;
+
+      /// \brief Files waiting to be read.
+      private: std::deque<std::string> queue;
+
+      /// \brief All files ever queued.
+      private: std::unordered_set<std::string> queued;
+
+      /// \brief File being read by the worker, if any.
+      private: bool reading{false};
+
+      /// \brief Bytes read so far.
+      private: std::size_t bytesRead{0};
+
+      /// \brief True to stop the worker.
+      private: bool stop{false};
+
+      /// \brief Worker thread.
+      private: std::thread worker;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_RESOURCEPREFETCHER_HH_
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <ignition/common/Filesystem.hh>
+
+#include "ResourcePrefetcher.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(ResourcePrefetcher, ReadFiles)
+{
+  auto dir = common::joinPaths(common::cwd(), "resource_prefetcher_test");
+  ASSERT_TRUE(common::createDirectories(dir));
+  auto small = common::joinPaths(dir, "small.dae");
+  auto large = common::joinPaths(dir, "large.stl");
+  std::ofstream(small) << "hello";
+  std::ofstream(large) << std::string(200000u, 'x');
+
+  ResourcePrefetcher prefetcher;
+  EXPECT_EQ(0u, prefetcher.Pending());
+  EXPECT_EQ(0u, prefetcher.BytesRead());
+
+  EXPECT_TRUE(prefetcher.Prefetch(small));
+  EXPECT_TRUE(prefetcher.Prefetch(large));
+  EXPECT_TRUE(prefetcher.Prefetch(common::joinPaths(dir, "missing.obj")));
+
+  // Files are only queued once
+  EXPECT_FALSE(prefetcher.Prefetch(small));
+  EXPECT_FALSE(prefetcher.Prefetch(""));
+
+  for (int i = 0; i < 500 && prefetcher.Pending() > 0u; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(0u, prefetcher.Pending());
+  EXPECT_EQ(200005u, prefetcher.BytesRead());
+
+  common::removeAll(dir);
+}
@@ -0,0 +1,521 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "RewindBuffer.hh"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/msgs/serialized_map.pb.h>
+
+/// \brief A stored step.
+struct RewindEntry
+{
+  /// \brief Sim time of the step.
+  std::chrono::steady_clock::duration simTime{0};
+
+  /// \brief Iterations of the step.
+  uint64_t iterations{0u};
+
+  /// \brief Encoded and compressed msgs::SerializedStateMap, with the
+  /// full state for keyframes and the changes from the previous step
+  /// otherwise.
+  std::string data;
+
+  /// \brief Size of the encoded state before compression.
+  std::size_t rawSize{0u};
+};
+
+/// \brief A keyframe and the steps that changed the state after it.
+struct RewindGroup
+{
+  /// \brief Steps, starting with the keyframe.
+  std::vector<RewindEntry> entries;
+
+  /// \brief Memory used by the entries.
+  std::size_t bytes{0u};
+};
+
+class ignition::gazebo::RewindBufferPrivate
+{
+  /// \brief Memory used by an entry.
+  /// \param[in] _entry Entry.
+  /// \return Bytes.
+  public: static std::size_t EntryBytes(const RewindEntry &_entry);
+
+  /// \brief Drop the oldest groups which are out of the window or over the
+  /// memory limit.
+  public: void Trim();
+
+  /// \brief Store the changes from the previous step's full state to the
+  /// current one in msg. Components are compared by their serialized data,
+  /// so components that systems wrote in place without marking them as
+  /// changed, such as velocities written by physics, are caught too.
+  public: void Diff();
+
+  /// \brief Encode and compress msg into an entry.
+  /// \param[out] _entry Entry to fill.
+  /// \return False on failure.
+  public: bool Encode(RewindEntry &_entry);
+
+  /// \brief Decompress and decode an entry into msg.
+  /// \param[in] _entry Entry to read.
+  /// \return False on failure.
+  public: bool Decode(const RewindEntry &_entry);
+
+  /// \brief Sim time covered by the buffer.
+  public: std::chrono::steady_clock::duration window{0};
+
+  /// \brief Most memory used by the stored states.
+  public: std::size_t maxBytes{0u};
+
+  /// \brief Sim time between keyframes.
+  public: std::chrono::steady_clock::duration keyframePeriod{0};
+
+  /// \brief Size of the changes since the last keyframe which triggers a
+  /// new keyframe.
+  public: std::size_t keyframeBytes{0u};
+
+  /// \brief Groups, oldest first.
+  public: std::deque<RewindGroup> groups;
+
+  /// \brief Memory used by all groups.
+  public: std::size_t bytes{0u};
+
+  /// \brief Whether a keyframe must be stored next, because the history
+  /// was dropped.
+  public: bool keyframeNeeded{true};
+
+  /// \brief Whether the warning about states over the limit was printed.
+  public: bool warnedLimit{false};
+
+  /// \brief Reused message, so recording doesn't allocate every step.
+  public: msgs::SerializedStateMap msg;
+
+  /// \brief Full state of the current step.
+  public: msgs::SerializedStateMap current;
+
+  /// \brief Full state of the previous recorded step, which the next
+  /// step's changes are relative to.
+  public: msgs::SerializedStateMap previous;
+
+  /// \brief Reused buffer for encoded states.
+  public: std::string raw;
+};
+
+using namespace ignition;
+using namespace gazebo;
+
+//////////////////////////////////////////////////
+std::size_t RewindBufferPrivate::EntryBytes(const RewindEntry &_entry)
+{
+  return sizeof(RewindEntry) + _entry.data.capacity();
+}
+
+//////////////////////////////////////////////////
+void RewindBufferPrivate::Trim()
+{
+  const auto latest = this->groups.back().entries.back().simTime;
+  while (this->groups.size() > 1u)
+  {
+    // All steps of the oldest group are before the next keyframe
+    const bool outOfWindow =
+        this->groups[1].entries.front().simTime <= latest - this->window;
+    if (!outOfWindow && this->bytes <= this->maxBytes)
+      break;
+
+    this->bytes -= this->groups.front().bytes;
+    this->groups.pop_front();
+  }
+
+  // A single group over the limit can't be split, since its changes are
+  // useless without its keyframe
+  if (this->bytes > this->maxBytes)
+  {
+    this->groups.clear();
+    this->bytes = 0u;
+    this->keyframeNeeded = true;
+  }
+}
+
+//////////////////////////////////////////////////
+void RewindBufferPrivate::Diff()
+{
+  auto &entities = *this->msg.mutable_entities();
+  const auto &previousEntities = this->previous.entities();
+  for (const auto &[id, entityMsg] : this->current.entities())
+  {
+    if (entityMsg.remove())
+      continue;
+
+    auto previousIt = previousEntities.find(id);
+    if (previousIt == previousEntities.end() || previousIt->second.remove())
+    {
+      entities[id] = entityMsg;
+      continue;
+    }
+
+    // Only added to the message if something changed
+    msgs::SerializedEntityMap *changed{nullptr};
+    auto changedComponents = [&]()
+    {
+      if (nullptr == changed)
+      {
+        changed = &entities[id];
+        changed->set_id(id);
+      }
+      return changed->mutable_components();
+    };
+
+    const auto &previousComponents = previousIt->second.components();
+    for (const auto &[type, compMsg] : entityMsg.components())
+    {
+      if (compMsg.remove())
+        continue;
+      auto previousComp = previousComponents.find(type);
+      if (previousComp == previousComponents.end() ||
+          previousComp->second.remove() ||
+          previousComp->second.component() != compMsg.component())
+      {
+        (*changedComponents())[type] = compMsg;
+      }
+    }
+
+    for (const auto &[type, compMsg] : previousComponents)
+    {
+      if (compMsg.remove())
+        continue;
+      auto currentComp = entityMsg.components().find(type);
+      if (currentComp == entityMsg.components().end() ||
+          currentComp->second.remove())
+      {
+        auto &removed = (*changedComponents())[type];
+        removed.set_type(compMsg.type());
+        removed.set_remove(true);
+      }
+    }
+  }
+
+  const auto &currentEntities = this->current.entities();
+  for (const auto &[id, entityMsg] : previousEntities)
+  {
+    if (entityMsg.remove())
+      continue;
+    auto currentIt = currentEntities.find(id);
+    if (currentIt == currentEntities.end() || currentIt->second.remove())
+    {
+      auto &removed = entities[id];
+      removed.set_id(id);
+      removed.set_remove(true);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+bool RewindBufferPrivate::Encode(RewindEntry &_entry)
+{
+  this->msg.SerializeToString(&this->raw);
+  _entry.rawSize = this->raw.size();
+
+  // Recording happens every step, so speed matters more than size
+  uLongf compressedSize = compressBound(static_cast<uLong>(this->raw.size()));
+  _entry.data.resize(compressedSize);
+  if (compress2(reinterpret_cast<Bytef *>(&_entry.data[0]), &compressedSize,
+        reinterpret_cast<const Bytef *>(this->raw.data()),
+        static_cast<uLong>(this->raw.size()), Z_BEST_SPEED) != Z_OK)
+  {
+    ignerr << "Failed to compress the rewind state." << std::endl;
+    return false;
+  }
+  _entry.data.resize(compressedSize);
+  _entry.data.shrink_to_fit();
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool RewindBufferPrivate::Decode(const RewindEntry &_entry)
+{
+  this->raw.resize(_entry.rawSize);
+  uLongf rawSize = static_cast<uLongf>(_entry.rawSize);
+  if (uncompress(reinterpret_cast<Bytef *>(&this->raw[0]), &rawSize,
+        reinterpret_cast<const Bytef *>(_entry.data.data()),
+        static_cast<uLong>(_entry.data.size())) != Z_OK ||
+      rawSize != _entry.rawSize)
+  {
+    return false;
+  }
+  return this->msg.ParseFromString(this->raw);
+}
+
+//////////////////////////////////////////////////
+RewindBuffer::RewindBuffer(std::chrono::steady_clock::duration _window,
+    std::size_t _maxBytes)
+  : dataPtr(std::make_unique<RewindBufferPrivate>())
+{
+  this->dataPtr->window = _window;
+  this->dataPtr->maxBytes = _maxBytes;
+
+  // Frequent enough keyframes for whole groups to be dropped without
+  // losing much of the window
+  this->dataPtr->keyframePeriod = _window / 8;
+  this->dataPtr->keyframeBytes = _maxBytes / 8u;
+}
+
+//////////////////////////////////////////////////
+RewindBuffer::~RewindBuffer() = default;
+
+//////////////////////////////////////////////////
+void RewindBuffer::Record(const UpdateInfo &_info,
+    const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("RewindBuffer::Record");
+  auto &data = *this->dataPtr;
+  if (data.maxBytes == 0u ||
+      data.window <= std::chrono::steady_clock::duration::zero())
+  {
+    return;
+  }
+
+  bool keyframe = data.keyframeNeeded || data.groups.empty();
+  if (!keyframe)
+  {
+    const auto &group = data.groups.back();
+    keyframe = _info.simTime - group.entries.front().simTime >=
+        data.keyframePeriod ||
+        group.bytes - RewindBufferPrivate::EntryBytes(group.entries.front()) >=
+        data.keyframeBytes;
+  }
+
+  // Changes are found by comparing full states, since systems may write
+  // components in place without marking them as changed
+  data.current.Clear();
+  _ecm.State(data.current, {}, {}, true);
+  if (keyframe)
+  {
+    data.msg.Swap(&data.current);
+  }
+  else
+  {
+    data.msg.Clear();
+    data.Diff();
+  }
+
+  RewindEntry entry;
+  entry.simTime = _info.simTime;
+  entry.iterations = _info.iterations;
+  const bool encoded = data.Encode(entry);
+
+  // The next step is compared with this one
+  if (keyframe)
+    data.previous.Swap(&data.msg);
+  else
+    data.previous.Swap(&data.current);
+
+  if (!encoded)
+  {
+    this->Clear();
+    return;
+  }
+
+  const std::size_t entryBytes = RewindBufferPrivate::EntryBytes(entry);
+  if (entryBytes > data.maxBytes)
+  {
+    if (!data.warnedLimit)
+    {
+      ignwarn << "A simulation state of [" << entryBytes << "] bytes doesn't "
+              << "fit in the rewind buffer limit of [" << data.maxBytes
+              << "] bytes. The rewind history is dropped." << std::endl;
+      data.warnedLimit = true;
+    }
+    this->Clear();
+    return;
+  }
+
+  if (keyframe)
+    data.groups.emplace_back();
+  auto &group = data.groups.back();
+  group.entries.push_back(std::move(entry));
+  group.bytes += entryBytes;
+  data.bytes += entryBytes;
+  data.keyframeNeeded = false;
+
+  data.Trim();
+}
+
+//////////////////////////////////////////////////
+bool RewindBuffer::Restore(std::chrono::steady_clock::duration _simTime,
+    EntityComponentManager &_ecm, UpdateInfo &_info)
+{
+  IGN_PROFILE("RewindBuffer::Restore");
+  auto &data = *this->dataPtr;
+  if (data.groups.empty() ||
+      _simTime < data.groups.front().entries.front().simTime)
+  {
+    return false;
+  }
+
+  // Latest keyframe at or before the time, and latest step of its group
+  auto groupIt = std::prev(std::upper_bound(data.groups.begin(),
+      data.groups.end(), _simTime,
+      [](std::chrono::steady_clock::duration _time, const RewindGroup &_group)
+      {
+        return _time < _group.entries.front().simTime;
+      }));
+  auto &entries = groupIt->entries;
+  const auto end = std::upper_bound(entries.begin(), entries.end(), _simTime,
+      [](std::chrono::steady_clock::duration _time, const RewindEntry &_entry)
+      {
+        return _time < _entry.simTime;
+      });
+
+  // Merge the keyframe and the changes after it into the full state of the
+  // step, latest data winning
+  std::unordered_map<Entity,
+      std::unordered_map<int64_t, msgs::SerializedComponent>> merged;
+  for (auto it = entries.begin(); it != end; ++it)
+  {
+    if (!data.Decode(*it))
+    {
+      ignerr << "Failed to decode the rewind state at iteration ["
+             << it->iterations << "]." << std::endl;
+      return false;
+    }
+
+    for (auto &[id, entityMsg] : *data.msg.mutable_entities())
+    {
+      const Entity entity{id};
+      if (entityMsg.remove())
+      {
+        merged.erase(entity);
+        continue;
+      }
+
+      auto &components = merged[entity];
+      for (auto &[type, compMsg] : *entityMsg.mutable_components())
+      {
+        if (compMsg.remove())
+          components.erase(type);
+        else
+          components[type].Swap(&compMsg);
+      }
+    }
+  }
+
+  // Everything which isn't in the state is removed
+  msgs::SerializedStateMap state;
+  state.set_has_one_time_component_changes(true);
+  auto &stateEntities = *state.mutable_entities();
+  for (auto &[entity, components] : merged)
+  {
+    auto &entityMsg = stateEntities[entity];
+    entityMsg.set_id(entity);
+    auto &stateComponents = *entityMsg.mutable_components();
+    for (auto &[type, compMsg] : components)
+      stateComponents[type].Swap(&compMsg);
+
+    _ecm.EachComponentType(entity, [&](ComponentTypeId _type)
+    {
+      const auto type = static_cast<int64_t>(_type);
+      if (stateComponents.find(type) == stateComponents.end())
+      {
+        auto &compMsg = stateComponents[type];
+        compMsg.set_type(_type);
+        compMsg.set_remove(true);
+      }
+      return true;
+    });
+  }
+  _ecm.EachEntity([&](Entity _entity)
+  {
+    if (merged.find(_entity) == merged.end())
+    {
+      auto &entityMsg = stateEntities[_entity];
+      entityMsg.set_id(_entity);
+      entityMsg.set_remove(true);
+    }
+    return true;
+  });
+  _ecm.SetState(state);
+
+  const auto &restored = *std::prev(end);
+  _info.simTime = restored.simTime;
+  _info.iterations = restored.iterations;
+
+  // Simulation continues from the restored step
+  for (auto it = end; it != entries.end(); ++it)
+  {
+    const auto entryBytes = RewindBufferPrivate::EntryBytes(*it);
+    groupIt->bytes -= entryBytes;
+    data.bytes -= entryBytes;
+  }
+  entries.erase(end, entries.end());
+  for (auto it = std::next(groupIt); it != data.groups.end(); ++it)
+    data.bytes -= it->bytes;
+  data.groups.erase(std::next(groupIt), data.groups.end());
+
+  // The previous full state is no longer the one recorded last
+  data.keyframeNeeded = true;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+void RewindBuffer::Clear()
+{
+  this->dataPtr->groups.clear();
+  this->dataPtr->bytes = 0u;
+  this->dataPtr->keyframeNeeded = true;
+}
+
+//////////////////////////////////////////////////
+std::size_t RewindBuffer::Count() const
+{
+  std::size_t count{0u};
+  for (const auto &group : this->dataPtr->groups)
+    count += group.entries.size();
+  return count;
+}
+
+//////////////////////////////////////////////////
+std::size_t RewindBuffer::Bytes() const
+{
+  return this->dataPtr->bytes;
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration RewindBuffer::OldestTime() const
+{
+  if (this->dataPtr->groups.empty())
+    return std::chrono::steady_clock::duration::zero();
+  return this->dataPtr->groups.front().entries.front().simTime;
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration RewindBuffer::LatestTime() const
+{
+  if (this->dataPtr->groups.empty())
+    return std::chrono::steady_clock::duration::zero();
+  return this->dataPtr->groups.back().entries.back().simTime;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_REWINDBUFFER_HH_
+#define IGNITION_GAZEBO_REWINDBUFFER_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Types.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class RewindBufferPrivate;
+
+    /// \class RewindBuffer RewindBuffer.hh
+    /// \brief Rolling history of the most recent steps of a simulation, so
+    /// that it can be rewound to any of them.
+    ///
+    /// As in recorded logs, each step is stored as the state that changed
+    /// during it, and keyframes holding the full state are stored
+    /// periodically, or once the changes since the previous keyframe grew
+    /// too large. The changes are found by comparing the full state with the
+    /// previous step's, since some systems write components in place
+    /// without marking them as changed. States are kept encoded and
+    /// compressed, which is much more compact than the components they came
+    /// from. Restoring a step merges the latest
+    /// keyframe before it with the changes that followed, and sets the
+    /// result as one state.
+    ///
+    /// Steps older than the time window are dropped, a keyframe and the
+    /// changes after it at a time, and so are the oldest ones whenever the
+    /// memory used goes over the limit, so the buffer never holds more than
+    /// the limit.
+    class IGNITION_GAZEBO_VISIBLE RewindBuffer
+    {
+      /// \brief Constructor
+      /// \param[in] _window Sim time covered by the buffer.
+      /// \param[in] _maxBytes Most memory used by the stored states.
+      public: RewindBuffer(std::chrono::steady_clock::duration _window,
+                  std::size_t _maxBytes);
+
+      /// \brief Destructor
+      public: ~RewindBuffer();
+
+      /// \brief Store a step. Must be called once the step's systems ran and
+      /// before the ECM's changes are cleared. Steps must be recorded in
+      /// order of sim time.
+      /// \param[in] _info Info of the step.
+      /// \param[in] _ecm ECM after the step.
+      public: void Record(const UpdateInfo &_info,
+                  const EntityComponentManager &_ecm);
+
+      /// \brief Set the ECM to the state of the latest stored step at or
+      /// before a sim time. Steps after it are dropped, since simulation
+      /// continues from there.
+      /// \param[in] _simTime Sim time to go back to.
+      /// \param[in, out] _ecm ECM to set, which must be the one recorded.
+      /// \param[out] _info Sim time and iterations of the restored step.
+      /// \return False if no stored step covers the time, in which case
+      /// nothing changes.
+      public: bool Restore(std::chrono::steady_clock::duration _simTime,
+                  EntityComponentManager &_ecm, UpdateInfo &_info);
+
+      /// \brief Drop all stored steps.
+      public: void Clear();
+
+      /// \brief Number of stored steps.
+      /// \return Number of steps.
+      public: std::size_t Count() const;
+
+      /// \brief Memory used by the stored steps.
+      /// \return Bytes used, never more than the limit.
+      public: std::size_t Bytes() const;
+
+      /// \brief Sim time of the oldest step which can be restored.
+      /// \return Sim time, zero if empty.
+      public: std::chrono::steady_clock::duration OldestTime() const;
+
+      /// \brief Sim time of the latest stored step.
+      /// \return Sim time, zero if empty.
+      public: std::chrono::steady_clock::duration LatestTime() const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<RewindBufferPrivate> dataPtr;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_REWINDBUFFER_HH_
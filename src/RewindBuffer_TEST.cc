@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+#include <string>
+
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/Static.hh"
+
+#include "RewindBuffer.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+/// \brief ECM which can end a step as the simulation runner does.
+class RewindEcm : public EntityComponentManager
+{
+  /// \brief Clear the changes of the step.
+  public: void EndStep()
+  {
+    this->ClearNewlyCreatedEntities();
+    this->ProcessRemoveEntityRequests();
+    this->ClearRemovedComponents();
+    this->SetAllComponentsUnchanged();
+  }
+};
+
+/// \brief Info of a step.
+/// \param[in] _ms Sim time [ms], also used as iterations.
+/// \return Info.
+static UpdateInfo StepInfo(int _ms)
+{
+  UpdateInfo info;
+  info.simTime = std::chrono::milliseconds(_ms);
+  info.iterations = static_cast<uint64_t>(_ms);
+  return info;
+}
+
+/// \brief Set the name of an entity and mark it as changed.
+/// \param[in] _ecm ECM.
+/// \param[in] _entity Entity.
+/// \param[in] _name New name.
+static void SetName(RewindEcm &_ecm, Entity _entity, const std::string &_name)
+{
+  _ecm.Component<components::Name>(_entity)->Data() = _name;
+  _ecm.SetChanged(_entity, components::Name::typeId,
+      ComponentState::OneTimeChange);
+}
+
+/// \brief Name which doesn't compress much.
+/// \param[in] _size Length of the name.
+/// \param[in] _seed Seed of the characters.
+/// \return Name.
+static std::string RandomName(std::size_t _size, unsigned int _seed)
+{
+  std::mt19937 generator(_seed);
+  std::uniform_int_distribution<int> distribution('a', 'z');
+  std::string name(_size, ' ');
+  for (auto &c : name)
+    c = static_cast<char>(distribution(generator));
+  return name;
+}
+
+/////////////////////////////////////////////////
+TEST(RewindBuffer, Restore)
+{
+  RewindBuffer buffer(1s, 1u << 20);
+  RewindEcm ecm;
+  UpdateInfo info;
+  EXPECT_FALSE(buffer.Restore(0ms, ecm, info));
+
+  Entity box = ecm.CreateEntity();
+  ecm.CreateComponent(box, components::Name("box"));
+  ecm.CreateComponent(box, components::Pose());
+  Entity later{kNullEntity};
+  for (int ms = 1; ms <= 10; ++ms)
+  {
+    ecm.Component<components::Pose>(box)->Data().Pos().X(ms);
+    ecm.SetChanged(box, components::Pose::typeId,
+        ComponentState::PeriodicChange);
+    if (ms == 3)
+      ecm.CreateComponent(box, components::Static(true));
+    if (ms == 7)
+    {
+      later = ecm.CreateEntity();
+      ecm.CreateComponent(later, components::Name("later"));
+      EXPECT_TRUE(ecm.RemoveComponent<components::Static>(box));
+    }
+    if (ms == 8)
+      SetName(ecm, box, "renamed");
+
+    buffer.Record(StepInfo(ms), ecm);
+    ecm.EndStep();
+  }
+  EXPECT_EQ(10u, buffer.Count());
+  EXPECT_EQ(1ms, buffer.OldestTime());
+  EXPECT_EQ(10ms, buffer.LatestTime());
+  EXPECT_LT(0u, buffer.Bytes());
+
+  // Steps before the buffer can't be restored
+  EXPECT_FALSE(buffer.Restore(500us, ecm, info));
+
+  // Latest step at or before the time
+  ASSERT_TRUE(buffer.Restore(5500us, ecm, info));
+  EXPECT_EQ(5ms, info.simTime);
+  EXPECT_EQ(5u, info.iterations);
+  EXPECT_TRUE(ecm.HasOneTimeComponentChanges());
+  ecm.EndStep();
+
+  EXPECT_FALSE(ecm.HasEntity(later));
+  EXPECT_DOUBLE_EQ(5.0, ecm.Component<components::Pose>(box)->Data().X());
+  EXPECT_EQ("box", ecm.Component<components::Name>(box)->Data());
+  EXPECT_NE(nullptr, ecm.Component<components::Static>(box));
+
+  // Later steps are dropped
+  EXPECT_EQ(5u, buffer.Count());
+  EXPECT_EQ(5ms, buffer.LatestTime());
+
+  // Simulation continues from the restored step
+  for (int ms = 6; ms <= 8; ++ms)
+  {
+    ecm.Component<components::Pose>(box)->Data().Pos().X(-ms);
+    ecm.SetChanged(box, components::Pose::typeId,
+        ComponentState::PeriodicChange);
+    buffer.Record(StepInfo(ms), ecm);
+    ecm.EndStep();
+  }
+  ASSERT_TRUE(buffer.Restore(7ms, ecm, info));
+  ecm.EndStep();
+  EXPECT_EQ(7u, info.iterations);
+  EXPECT_DOUBLE_EQ(-7.0, ecm.Component<components::Pose>(box)->Data().X());
+
+  buffer.Clear();
+  EXPECT_EQ(0u, buffer.Count());
+  EXPECT_EQ(0u, buffer.Bytes());
+  EXPECT_FALSE(buffer.Restore(7ms, ecm, info));
+}
+
+/////////////////////////////////////////////////
+TEST(RewindBuffer, Window)
+{
+  RewindBuffer buffer(80ms, 1u << 20);
+  RewindEcm ecm;
+  Entity box = ecm.CreateEntity();
+  ecm.CreateComponent(box, components::Pose());
+  for (int ms = 1; ms <= 200; ++ms)
+  {
+    ecm.Component<components::Pose>(box)->Data().Pos().X(ms);
+    ecm.SetChanged(box, components::Pose::typeId,
+        ComponentState::PeriodicChange);
+    buffer.Record(StepInfo(ms), ecm);
+    ecm.EndStep();
+  }
+
+  // Whole groups of steps are dropped, so a bit more than the window is
+  // kept
+  EXPECT_EQ(200ms, buffer.LatestTime());
+  EXPECT_LE(buffer.OldestTime(), 120ms);
+  EXPECT_GT(buffer.OldestTime(), 100ms);
+
+  UpdateInfo info;
+  EXPECT_FALSE(buffer.Restore(50ms, ecm, info));
+  ASSERT_TRUE(buffer.Restore(150ms, ecm, info));
+  EXPECT_DOUBLE_EQ(150.0, ecm.Component<components::Pose>(box)->Data().X());
+}
+
+/////////////////////////////////////////////////
+TEST(RewindBuffer, MemoryLimit)
+{
+  const std::size_t limit{4096u};
+  RewindBuffer buffer(1s, limit);
+  RewindEcm ecm;
+  Entity box = ecm.CreateEntity();
+  ecm.CreateComponent(box, components::Name(""));
+  for (int ms = 1; ms <= 200; ++ms)
+  {
+    SetName(ecm, box, RandomName(200u, static_cast<unsigned int>(ms)));
+    buffer.Record(StepInfo(ms), ecm);
+    ecm.EndStep();
+    EXPECT_LE(buffer.Bytes(), limit);
+  }
+  EXPECT_LT(0u, buffer.Count());
+  EXPECT_EQ(200ms, buffer.LatestTime());
+
+  // The most recent steps are kept
+  UpdateInfo info;
+  ASSERT_TRUE(buffer.Restore(buffer.OldestTime(), ecm, info));
+  EXPECT_LT(100u, info.iterations);
+
+  // A state which doesn't fit drops the history
+  SetName(ecm, box, RandomName(2 * limit, 0u));
+  buffer.Record(StepInfo(201), ecm);
+  EXPECT_EQ(0u, buffer.Count());
+  EXPECT_EQ(0u, buffer.Bytes());
+}
+
+/////////////////////////////////////////////////
+TEST(RewindBuffer, UnmarkedChanges)
+{
+  RewindBuffer buffer(1s, 1u << 20);
+  RewindEcm ecm;
+  Entity box = ecm.CreateEntity();
+  ecm.CreateComponent(box, components::Pose());
+
+  // Written in place without marking the component as changed, as physics
+  // does for velocities
+  for (int ms = 1; ms <= 10; ++ms)
+  {
+    ecm.Component<components::Pose>(box)->Data().Pos().X(ms);
+    buffer.Record(StepInfo(ms), ecm);
+    ecm.EndStep();
+  }
+
+  UpdateInfo info;
+  ASSERT_TRUE(buffer.Restore(6ms, ecm, info));
+  ecm.EndStep();
+  EXPECT_DOUBLE_EQ(6.0, ecm.Component<components::Pose>(box)->Data().X());
+
+  // Recording continues from the restored state
+  for (int ms = 7; ms <= 9; ++ms)
+  {
+    ecm.Component<components::Pose>(box)->Data().Pos().X(-ms);
+    buffer.Record(StepInfo(ms), ecm);
+    ecm.EndStep();
+  }
+  ASSERT_TRUE(buffer.Restore(8ms, ecm, info));
+  ecm.EndStep();
+  EXPECT_DOUBLE_EQ(-8.0, ecm.Component<components::Pose>(box)->Data().X());
+}
@@ -15,12 +15,21 @@
  *
 */
 
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Profiler.hh>
 #include <sdf/Types.hh>
 
 #include "ignition/gazebo/Events.hh"
 #include "ignition/gazebo/SdfEntityCreator.hh"
+#include "ignition/gazebo/Util.hh"
 
 #include "ignition/gazebo/components/Actor.hh"
 #include "ignition/gazebo/components/AirPressureSensor.hh"
@@ -78,6 +87,7 @@
 #include "ignition/gazebo/components/Transparency.hh"
 #include "ignition/gazebo/components/Visibility.hh"
 #include "ignition/gazebo/components/Visual.hh"
+#include "ignition/gazebo/components/VisualLod.hh"
 #include "ignition/gazebo/components/WindMode.hh"
 #include "ignition/gazebo/components/World.hh"
 
@@ -100,11 +110,181 @@ class ignition::gazebo::SdfEntityCreatorPrivate
   /// \brief Keep track of new visuals being added, so we load their plugins
   /// only after we have their scoped name.
   public: std::map<Entity, sdf::Plugins> newVisuals;
+
+  /// \brief Whether repeated models are cloned instead of converted from
+  /// SDF, see SdfEntityCreator::SetReuseRepeatedModels.
+  public: bool reuseRepeatedModels{false};
+
+  /// \brief Entities and components of one model, created without touching
+  /// the ECM so that several models can be converted from SDF in parallel.
+  /// Staged entities are numbered from 1 in creation order and are created
+  /// in one batch. All other calls which would have gone to the ECM are
+  /// recorded, to be replayed later in the same order.
+  public: struct Staging
+  {
+    /// \brief Recorded ECM calls. Each receives the ECM and the table which
+    /// maps staged entities to the ones created in the ECM.
+    std::vector<std::function<void(EntityComponentManager &,
+        std::vector<Entity> &)>> calls;
+
+    /// \brief Name of each staged entity, indexed by staged entity.
+    std::vector<std::string> names = std::vector<std::string>(1u);
+
+    /// \brief Parent of each staged entity, indexed by staged entity.
+    std::vector<Entity> parents = std::vector<Entity>(1u, kNullEntity);
+
+    /// \brief Component types of each staged entity, indexed by staged
+    /// entity.
+    std::vector<std::vector<ComponentTypeId>> types =
+        std::vector<std::vector<ComponentTypeId>>(1u);
+
+    /// \brief Staged model entity.
+    Entity model{kNullEntity};
+
+    /// \brief Plugins of staged models, sensors and visuals.
+    std::map<Entity, sdf::Plugins> newModels;
+    std::map<Entity, sdf::Plugins> newSensors;
+    std::map<Entity, sdf::Plugins> newVisuals;
+  };
+
+  /// \brief Entities are staged here instead of created in the ECM while
+  /// this is set.
+  public: Staging *staging{nullptr};
+
+  /// \brief Create an entity, or stage it.
+  /// \return New entity.
+  public: Entity CreateEntity();
+
+  /// \brief Create a component, or stage it.
+  /// \param[in] _entity Entity which will own the component.
+  /// \param[in] _component Component to copy.
+  public: template <typename ComponentTypeT>
+          void CreateComponent(Entity _entity,
+              const ComponentTypeT &_component);
+
+  /// \brief Create a name component, or stage it while keeping track of
+  /// the name so staged links can be found by name.
+  /// \param[in] _entity Entity which will own the component.
+  /// \param[in] _component Name component.
+  public: void CreateComponent(Entity _entity,
+              const components::Name &_component);
+
+  /// \brief Create a component which holds an entity, or stage it so the
+  /// entity it holds is mapped when it's replayed.
+  /// \param[in] _entity Entity which will own the component.
+  /// \param[in] _target Entity held by the component.
+  public: template <typename ComponentTypeT>
+          void CreateEntityComponent(Entity _entity, Entity _target);
+
+  /// \brief Whether an entity, created or staged, has a component.
+  /// \param[in] _entity Entity.
+  /// \param[in] _typeId Component type.
+  /// \return True if it has a component of that type.
+  public: bool HasComponent(Entity _entity, ComponentTypeId _typeId) const;
+
+  /// \brief Find a descendent link among created or staged entities.
+  /// \param[in] _name The relative name of the link with "::" as the scope
+  /// delimiter
+  /// \param[in] _model Model entity that defines the scope
+  /// \return The link entity or kNullEntity if it was not found.
+  public: Entity FindDescendentLink(const std::string &_name,
+              Entity _model) const;
+
+  /// \brief Create all staged entities and components in the ECM.
+  /// \param[in] _staging Staged entities of one model. Its plugins are
+  /// added to newModels, newSensors and newVisuals.
+  /// \return Model entity.
+  public: Entity Commit(Staging &_staging);
+
+  /// \brief Load the plugins of all new models, sensors and visuals, then
+  /// forget about them.
+  public: void LoadNewPlugins();
 };
 
 using namespace ignition;
 using namespace gazebo;
 
+/// \brief Minimum number of models converted by each thread when creating
+/// several models at once.
+static constexpr std::size_t kMinModelsPerTask{4u};
+
+/////////////////////////////////////////////////
+/// \brief Append an SDF element and its descendants to the signature of a
+/// model. Models with the same signature only differ in name and pose.
+/// \param[in] _elem Element.
+/// \param[in] _root True if _elem is the model element, whose name and pose
+/// are left out.
+/// \param[in,out] _signature Signature to append to.
+/// \return False if _elem or one of its descendants is a plugin.
+static bool AppendSignature(const sdf::ElementPtr &_elem, bool _root,
+    std::string &_signature)
+{
+  if (_elem->GetName() == "plugin")
+    return false;
+
+  _signature += '<';
+  _signature += _elem->GetName();
+  for (const auto &attribute : _elem->GetAttributes())
+  {
+    if (_root && attribute->GetKey() == "name")
+      continue;
+    _signature += ' ';
+    _signature += attribute->GetKey();
+    _signature += '=';
+    _signature += attribute->GetAsString();
+  }
+  _signature += '>';
+  if (_elem->GetValue())
+    _signature += _elem->GetValue()->GetAsString();
+
+  for (auto child = _elem->GetFirstElement(); child;
+       child = child->GetNextElement())
+  {
+    if (_root && child->GetName() == "pose")
+      continue;
+    if (!AppendSignature(child, false, _signature))
+      return false;
+  }
+  _signature += "</>";
+  return true;
+}
+
+/////////////////////////////////////////////////
+/// \brief Find the models which are repeated among several models.
+/// \param[in] _models Models.
+/// \return The index of the first model each model repeats, which is its
+/// own index if it's not a repetition. Empty if there are no repetitions.
+static std::vector<std::size_t> FindRepeatedModels(
+    const std::vector<const sdf::Model *> &_models)
+{
+  IGN_PROFILE("SdfEntityCreator::FindRepeatedModels");
+
+  std::vector<std::size_t> sources(_models.size());
+  std::unordered_map<std::string, std::size_t> firstBySignature;
+  bool repeated{false};
+  std::string signature;
+  for (std::size_t i = 0; i < _models.size(); ++i)
+  {
+    sources[i] = i;
+
+    const auto elem = _models[i]->Element();
+    signature.clear();
+    if (!elem || !AppendSignature(elem, true, signature))
+      continue;
+
+    auto inserted = firstBySignature.emplace(signature, i);
+    if (!inserted.second)
+    {
+      sources[i] = inserted.first->second;
+      repeated = true;
+    }
+  }
+
+  if (!repeated)
+    sources.clear();
+  return sources;
+}
+
 /////////////////////////////////////////////////
 /// \brief Resolve the pose of an SDF DOM object with respect to its relative_to
 /// frame. If that fails, return the raw pose
@@ -183,6 +363,185 @@ static Entity FindDescendentLinkEntityByName(const std::string &_name,
   }
 }
 
+/////////////////////////////////////////////////
+Entity SdfEntityCreatorPrivate::CreateEntity()
+{
+  if (nullptr == this->staging)
+    return this->ecm->CreateEntity();
+
+  const Entity entity = this->staging->names.size();
+  this->staging->names.emplace_back();
+  this->staging->parents.push_back(kNullEntity);
+  this->staging->types.emplace_back();
+  return entity;
+}
+
+/////////////////////////////////////////////////
+template <typename ComponentTypeT>
+void SdfEntityCreatorPrivate::CreateComponent(Entity _entity,
+    const ComponentTypeT &_component)
+{
+  if (nullptr == this->staging)
+  {
+    this->ecm->CreateComponent(_entity, _component);
+    return;
+  }
+
+  if (_entity < this->staging->types.size())
+    this->staging->types[_entity].push_back(ComponentTypeT::typeId);
+  this->staging->calls.push_back(
+      [_entity, _component](EntityComponentManager &_ecm,
+          std::vector<Entity> &_entities)
+      {
+        _ecm.CreateComponent(_entities[_entity], _component);
+      });
+}
+
+/////////////////////////////////////////////////
+void SdfEntityCreatorPrivate::CreateComponent(Entity _entity,
+    const components::Name &_component)
+{
+  if (nullptr != this->staging && _entity < this->staging->names.size())
+    this->staging->names[_entity] = _component.Data();
+  this->CreateComponent<components::Name>(_entity, _component);
+}
+
+/////////////////////////////////////////////////
+template <typename ComponentTypeT>
+void SdfEntityCreatorPrivate::CreateEntityComponent(Entity _entity,
+    Entity _target)
+{
+  if (nullptr == this->staging)
+  {
+    this->ecm->CreateComponent(_entity, ComponentTypeT(_target));
+    return;
+  }
+
+  if (_entity < this->staging->types.size())
+    this->staging->types[_entity].push_back(ComponentTypeT::typeId);
+  this->staging->calls.push_back(
+      [_entity, _target](EntityComponentManager &_ecm,
+          std::vector<Entity> &_entities)
+      {
+        _ecm.CreateComponent(_entities[_entity],
+            ComponentTypeT(_entities[_target]));
+      });
+}
+
+/////////////////////////////////////////////////
+bool SdfEntityCreatorPrivate::HasComponent(Entity _entity,
+    ComponentTypeId _typeId) const
+{
+  if (nullptr == this->staging)
+    return this->ecm->EntityHasComponentType(_entity, _typeId);
+
+  if (_entity >= this->staging->types.size())
+    return false;
+  const auto &types = this->staging->types[_entity];
+  return std::find(types.begin(), types.end(), _typeId) != types.end();
+}
+
+/////////////////////////////////////////////////
+Entity SdfEntityCreatorPrivate::FindDescendentLink(const std::string &_name,
+    Entity _model) const
+{
+  if (nullptr == this->staging)
+    return FindDescendentLinkEntityByName(_name, _model, *this->ecm);
+
+  // Same as FindDescendentLinkEntityByName, on the staged entities
+  auto ind = _name.find(sdf::kSdfScopeDelimiter);
+  const bool nested = ind != std::string::npos;
+  if (nested && ind + 2 >= _name.size())
+    return kNullEntity;
+
+  const auto childName = nested ? _name.substr(0, ind) : _name;
+  const auto typeId =
+      nested ? components::Model::typeId : components::Link::typeId;
+
+  Entity found{kNullEntity};
+  for (Entity entity = 1; entity < this->staging->names.size(); ++entity)
+  {
+    if (this->staging->parents[entity] != _model ||
+        this->staging->names[entity] != childName ||
+        !this->HasComponent(entity, typeId))
+    {
+      continue;
+    }
+
+    if (kNullEntity != found)
+      return kNullEntity;
+    found = entity;
+  }
+
+  if (nested && kNullEntity != found)
+    return this->FindDescendentLink(_name.substr(ind + 2), found);
+  return found;
+}
+
+/////////////////////////////////////////////////
+Entity SdfEntityCreatorPrivate::Commit(Staging &_staging)
+{
+  IGN_PROFILE("SdfEntityCreator::Commit");
+
+  // Staged entities are numbered in creation order, so they can all be
+  // created at once and still get the ids they would have had
+  std::vector<Entity> entities{kNullEntity};
+  const auto created = this->ecm->CreateEntities(_staging.names.size() - 1u);
+  entities.insert(entities.end(), created.begin(), created.end());
+  entities.resize(_staging.names.size(), kNullEntity);
+
+  for (const auto &call : _staging.calls)
+    call(*this->ecm, entities);
+
+  // Entities are created in the same order they were staged, so the plugin
+  // maps keep their order
+  for (auto &[staged, plugins] : _staging.newModels)
+    this->newModels[entities[staged]] = std::move(plugins);
+  for (auto &[staged, plugins] : _staging.newSensors)
+    this->newSensors[entities[staged]] = std::move(plugins);
+  for (auto &[staged, plugins] : _staging.newVisuals)
+    this->newVisuals[entities[staged]] = std::move(plugins);
+
+  return entities[_staging.model];
+}
+
+/////////////////////////////////////////////////
+void SdfEntityCreatorPrivate::LoadNewPlugins()
+{
+  // Load all model plugins afterwards, so we get scoped name for nested models.
+  for (const auto &[entity, plugins] : this->newModels)
+  {
+    this->eventManager->Emit<events::LoadSdfPlugins>(entity, plugins);
+    for (const sdf::Plugin &p : plugins)
+    {
+      this->eventManager->Emit<events::LoadPlugins>(entity, p.ToElement());
+    }
+  }
+  this->newModels.clear();
+
+  // Load sensor plugins after model, so we get scoped name.
+  for (const auto &[entity, plugins] : this->newSensors)
+  {
+    this->eventManager->Emit<events::LoadSdfPlugins>(entity, plugins);
+    for (const sdf::Plugin &p : plugins)
+    {
+      this->eventManager->Emit<events::LoadPlugins>(entity, p.ToElement());
+    }
+  }
+  this->newSensors.clear();
+
+  // Load visual plugins after model, so we get scoped name.
+  for (const auto &[entity, plugins] : this->newVisuals)
+  {
+    this->eventManager->Emit<events::LoadSdfPlugins>(entity, plugins);
+    for (const sdf::Plugin &p : plugins)
+    {
+      this->eventManager->Emit<events::LoadPlugins>(entity, p.ToElement());
+    }
+  }
+  this->newVisuals.clear();
+}
+
 //////////////////////////////////////////////////
 SdfEntityCreator::SdfEntityCreator(EntityComponentManager &_ecm,
           EventManager &_eventManager)
@@ -222,41 +581,44 @@ Entity SdfEntityCreator::CreateEntities(const sdf::World *_world)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::World)");
 
   // World entity
-  Entity worldEntity = this->dataPtr->ecm->CreateEntity();
+  Entity worldEntity = this->dataPtr->CreateEntity();
 
   // World components
-  this->dataPtr->ecm->CreateComponent(worldEntity, components::World());
-  this->dataPtr->ecm->CreateComponent(worldEntity,
+  this->dataPtr->CreateComponent(worldEntity, components::World());
+  this->dataPtr->CreateComponent(worldEntity,
       components::Name(_world->Name()));
 
   // scene
   if (_world->Scene())
   {
-    this->dataPtr->ecm->CreateComponent(worldEntity,
+    this->dataPtr->CreateComponent(worldEntity,
         components::Scene(*_world->Scene()));
   }
 
   // atmosphere
   if (_world->Atmosphere())
   {
-    this->dataPtr->ecm->CreateComponent(worldEntity,
+    this->dataPtr->CreateComponent(worldEntity,
         components::Atmosphere(*_world->Atmosphere()));
   }
 
   // spherical coordinates
   if (_world->SphericalCoordinates())
   {
-    this->dataPtr->ecm->CreateComponent(worldEntity,
+    this->dataPtr->CreateComponent(worldEntity,
         components::SphericalCoordinates(*_world->SphericalCoordinates()));
   }
 
   // Models
+  std::vector<const sdf::Model *> models;
+  models.reserve(_world->ModelCount());
   for (uint64_t modelIndex = 0; modelIndex < _world->ModelCount();
       ++modelIndex)
   {
-    auto model = _world->ModelByIndex(modelIndex);
-    auto modelEntity = this->CreateEntities(model);
-
+    models.push_back(_world->ModelByIndex(modelIndex));
+  }
+  for (auto modelEntity : this->CreateEntities(models))
+  {
     this->SetParent(modelEntity, worldEntity);
   }
 
@@ -281,7 +643,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::World *_world)
   }
 
   // Gravity
-  this->dataPtr->ecm->CreateComponent(worldEntity,
+  this->dataPtr->CreateComponent(worldEntity,
       components::Gravity(_world->Gravity()));
 
   // Physics
@@ -291,7 +653,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::World *_world)
   {
     physics = _world->PhysicsDefault();
   }
-  this->dataPtr->ecm->CreateComponent(worldEntity,
+  this->dataPtr->CreateComponent(worldEntity,
       components::Physics(*physics));
 
   // Populate physics options that aren't accessible outside the Element()
@@ -305,7 +667,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::World *_world)
       auto collisionDetector =
           dartElem->Get<std::string>("collision_detector");
 
-      this->dataPtr->ecm->CreateComponent(worldEntity,
+      this->dataPtr->CreateComponent(worldEntity,
           components::PhysicsCollisionDetector(collisionDetector));
     }
     if (dartElem->HasElement("solver") &&
@@ -314,13 +676,13 @@ Entity SdfEntityCreator::CreateEntities(const sdf::World *_world)
       auto solver =
           dartElem->GetElement("solver")->Get<std::string>("solver_type");
 
-      this->dataPtr->ecm->CreateComponent(worldEntity,
+      this->dataPtr->CreateComponent(worldEntity,
           components::PhysicsSolver(solver));
     }
   }
 
   // MagneticField
-  this->dataPtr->ecm->CreateComponent(worldEntity,
+  this->dataPtr->CreateComponent(worldEntity,
       components::MagneticField(_world->MagneticField()));
 
   this->dataPtr->eventManager->Emit<events::LoadSdfPlugins>(worldEntity,
@@ -332,7 +694,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::World *_world)
   }
 
   // Store the world's SDF DOM to be used when saving the world to file
-  this->dataPtr->ecm->CreateComponent(
+  this->dataPtr->CreateComponent(
       worldEntity, components::WorldSdf(*_world));
 
   return worldEntity;
@@ -344,44 +706,121 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Model)");
 
   auto ent = this->CreateEntities(_model, false);
+  this->dataPtr->LoadNewPlugins();
 
-  // Load all model plugins afterwards, so we get scoped name for nested models.
-  for (const auto &[entity, plugins] : this->dataPtr->newModels)
+  return ent;
+}
+
+//////////////////////////////////////////////////
+std::vector<Entity> SdfEntityCreator::CreateEntities(
+    const std::vector<const sdf::Model *> &_models)
+{
+  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Model[])");
+
+  std::vector<std::size_t> sources;
+  if (this->dataPtr->reuseRepeatedModels)
+    sources = FindRepeatedModels(_models);
+  if (!sources.empty())
   {
-    this->dataPtr->eventManager->Emit<events::LoadSdfPlugins>(entity, plugins);
-    for (const sdf::Plugin &p : plugins)
+    // Only the first model of each repeated group is converted from SDF
+    std::vector<const sdf::Model *> firstModels;
+    std::map<std::size_t, std::vector<std::size_t>> repetitions;
+    for (std::size_t i = 0; i < _models.size(); ++i)
     {
-      this->dataPtr->eventManager->Emit<events::LoadPlugins>(entity,
-          p.ToElement());
+      if (sources[i] == i)
+        firstModels.push_back(_models[i]);
+      else
+        repetitions[sources[i]].push_back(i);
     }
-  }
-  this->dataPtr->newModels.clear();
 
-  // Load sensor plugins after model, so we get scoped name.
-  for (const auto &[entity, plugins] : this->dataPtr->newSensors)
-  {
-    this->dataPtr->eventManager->Emit<events::LoadSdfPlugins>(entity, plugins);
-    for (const sdf::Plugin &p : plugins)
+    this->dataPtr->reuseRepeatedModels = false;
+    const auto created = this->CreateEntities(firstModels);
+    this->dataPtr->reuseRepeatedModels = true;
+
+    std::vector<Entity> entities(_models.size(), kNullEntity);
+    for (std::size_t i = 0, c = 0; i < _models.size(); ++i)
     {
-      this->dataPtr->eventManager->Emit<events::LoadPlugins>(entity,
-          p.ToElement());
+      if (sources[i] == i)
+        entities[i] = created[c++];
     }
-  }
-  this->dataPtr->newSensors.clear();
 
-  // Load visual plugins after model, so we get scoped name.
-  for (const auto &[entity, plugins] : this->dataPtr->newVisuals)
-  {
-    this->dataPtr->eventManager->Emit<events::LoadSdfPlugins>(entity, plugins);
-    for (const sdf::Plugin &p : plugins)
+    // The others are cloned in one pass per group, and only get their own
+    // name, pose and DOM
+    for (const auto &[first, indices] : repetitions)
     {
-      this->dataPtr->eventManager->Emit<events::LoadPlugins>(entity,
-          p.ToElement());
+      const auto clones = this->dataPtr->ecm->CloneMany(entities[first],
+          kNullEntity, "", indices.size());
+      for (std::size_t c = 0; c < indices.size(); ++c)
+      {
+        const auto *model = _models[indices[c]];
+        if (c >= clones.size())
+        {
+          entities[indices[c]] = this->CreateEntities(model);
+          continue;
+        }
+
+        this->dataPtr->ecm->SetComponentData<components::Name>(clones[c],
+            model->Name());
+        this->dataPtr->ecm->SetComponentData<components::Pose>(clones[c],
+            ResolveSdfPose(model->SemanticPose()));
+        this->dataPtr->ecm->SetComponentData<components::ModelSdf>(
+            clones[c], *model);
+        entities[indices[c]] = clones[c];
+      }
     }
+
+    return entities;
   }
-  this->dataPtr->newVisuals.clear();
 
-  return ent;
+  std::vector<Entity> entities;
+  entities.reserve(_models.size());
+
+  // Staging has some overhead of its own, so it only pays off when each
+  // thread gets a few models
+  if (this->dataPtr->ecm->MaxThreads() <= 1u ||
+      _models.size() < 2u * kMinModelsPerTask)
+  {
+    for (auto model : _models)
+      entities.push_back(this->CreateEntities(model));
+    return entities;
+  }
+
+  // Converting SDF into components doesn't need the ECM, so each model is
+  // staged on its own, in parallel
+  std::vector<SdfEntityCreatorPrivate::Staging> staged(_models.size());
+  this->dataPtr->ecm->ParallelFor(_models.size(),
+      [&](std::size_t _begin, std::size_t _end)
+      {
+        SdfEntityCreator creator(*this);
+        for (std::size_t i = _begin; i < _end; ++i)
+        {
+          creator.dataPtr->staging = &staged[i];
+          staged[i].model = creator.CreateEntities(_models[i], false);
+          staged[i].newModels = std::move(creator.dataPtr->newModels);
+          staged[i].newSensors = std::move(creator.dataPtr->newSensors);
+          staged[i].newVisuals = std::move(creator.dataPtr->newVisuals);
+          creator.dataPtr->newModels.clear();
+          creator.dataPtr->newSensors.clear();
+          creator.dataPtr->newVisuals.clear();
+        }
+      }, kMinModelsPerTask);
+
+  // The ECM isn't thread safe, so models are added to it one at a time, in
+  // order
+  for (auto &staging : staged)
+  {
+    entities.push_back(this->dataPtr->Commit(staging));
+    this->dataPtr->LoadNewPlugins();
+    staging = SdfEntityCreatorPrivate::Staging();
+  }
+
+  return entities;
+}
+
+//////////////////////////////////////////////////
+void SdfEntityCreator::SetReuseRepeatedModels(bool _reuse)
+{
+  this->dataPtr->reuseRepeatedModels = _reuse;
 }
 
 //////////////////////////////////////////////////
@@ -389,24 +828,24 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model,
                                         bool _staticParent)
 {
   // Entity
-  Entity modelEntity = this->dataPtr->ecm->CreateEntity();
+  Entity modelEntity = this->dataPtr->CreateEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(modelEntity, components::Model());
-  this->dataPtr->ecm->CreateComponent(modelEntity,
+  this->dataPtr->CreateComponent(modelEntity, components::Model());
+  this->dataPtr->CreateComponent(modelEntity,
       components::Pose(ResolveSdfPose(_model->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(modelEntity,
+  this->dataPtr->CreateComponent(modelEntity,
       components::Name(_model->Name()));
   bool isStatic = _model->Static() || _staticParent;
-  this->dataPtr->ecm->CreateComponent(modelEntity,
+  this->dataPtr->CreateComponent(modelEntity,
       components::Static(isStatic));
-  this->dataPtr->ecm->CreateComponent(
+  this->dataPtr->CreateComponent(
       modelEntity, components::WindMode(_model->EnableWind()));
-  this->dataPtr->ecm->CreateComponent(
+  this->dataPtr->CreateComponent(
       modelEntity, components::SelfCollide(_model->SelfCollide()));
   if (_model->Element())
   {
-    this->dataPtr->ecm->CreateComponent(
+    this->dataPtr->CreateComponent(
         modelEntity, components::SourceFilePath(_model->Element()->FilePath()));
   }
 
@@ -426,14 +865,15 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model,
 
     if (canonicalLink == link)
     {
-      this->dataPtr->ecm->CreateComponent(linkEntity,
+      this->dataPtr->CreateComponent(linkEntity,
           components::CanonicalLink());
     }
 
     // Set wind mode if the link didn't override it
-    if (!this->dataPtr->ecm->Component<components::WindMode>(linkEntity))
+    if (!this->dataPtr->HasComponent(linkEntity,
+        components::WindMode::typeId))
     {
-      this->dataPtr->ecm->CreateComponent(
+      this->dataPtr->CreateComponent(
           linkEntity, components::WindMode(_model->EnableWind()));
     }
   }
@@ -462,12 +902,12 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model,
   const auto canonicalLinkPair = _model->CanonicalLinkAndRelativeName();
   if (canonicalLinkPair.first)
   {
-    Entity canonicalLinkEntity = FindDescendentLinkEntityByName(
-        canonicalLinkPair.second, modelEntity, *this->dataPtr->ecm);
+    Entity canonicalLinkEntity = this->dataPtr->FindDescendentLink(
+        canonicalLinkPair.second, modelEntity);
     if (kNullEntity != canonicalLinkEntity)
     {
-      this->dataPtr->ecm->CreateComponent(
-          modelEntity, components::ModelCanonicalLink(canonicalLinkEntity));
+      this->dataPtr->CreateEntityComponent<components::ModelCanonicalLink>(
+          modelEntity, canonicalLinkEntity);
     }
     else
     {
@@ -482,7 +922,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model,
   }
 
   // Store the model's SDF DOM to be used when saving the world to file
-  this->dataPtr->ecm->CreateComponent(
+  this->dataPtr->CreateComponent(
       modelEntity, components::ModelSdf(*_model));
 
   // Keep track of models so we can load their plugins after loading the entire
@@ -499,13 +939,13 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Actor *_actor)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Actor)");
 
   // Entity
-  Entity actorEntity = this->dataPtr->ecm->CreateEntity();
+  Entity actorEntity = this->dataPtr->CreateEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(actorEntity, components::Actor(*_actor));
-  this->dataPtr->ecm->CreateComponent(actorEntity,
+  this->dataPtr->CreateComponent(actorEntity, components::Actor(*_actor));
+  this->dataPtr->CreateComponent(actorEntity,
       components::Pose(_actor->RawPose()));
-  this->dataPtr->ecm->CreateComponent(actorEntity,
+  this->dataPtr->CreateComponent(actorEntity,
       components::Name(_actor->Name()));
 
   // Actor plugins
@@ -526,28 +966,28 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Light *_light)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Light)");
 
   // Entity
-  Entity lightEntity = this->dataPtr->ecm->CreateEntity();
+  Entity lightEntity = this->dataPtr->CreateEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(lightEntity, components::Light(*_light));
-  this->dataPtr->ecm->CreateComponent(lightEntity,
+  this->dataPtr->CreateComponent(lightEntity, components::Light(*_light));
+  this->dataPtr->CreateComponent(lightEntity,
       components::Pose(ResolveSdfPose(_light->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(lightEntity,
+  this->dataPtr->CreateComponent(lightEntity,
       components::Name(_light->Name()));
 
-  this->dataPtr->ecm->CreateComponent(lightEntity,
+  this->dataPtr->CreateComponent(lightEntity,
     components::LightType(convert(_light->Type())));
 
   // Light Visual
-  Entity lightVisualEntity = this->dataPtr->ecm->CreateEntity();
-  this->dataPtr->ecm->CreateComponent(lightVisualEntity, components::Visual());
-  this->dataPtr->ecm->CreateComponent(lightVisualEntity,
+  Entity lightVisualEntity = this->dataPtr->CreateEntity();
+  this->dataPtr->CreateComponent(lightVisualEntity, components::Visual());
+  this->dataPtr->CreateComponent(lightVisualEntity,
       components::Pose());
-  this->dataPtr->ecm->CreateComponent(lightVisualEntity,
+  this->dataPtr->CreateComponent(lightVisualEntity,
       components::Name(_light->Name() + "Visual"));
-  this->dataPtr->ecm->CreateComponent(lightVisualEntity,
+  this->dataPtr->CreateComponent(lightVisualEntity,
       components::CastShadows(false));
-  this->dataPtr->ecm->CreateComponent(lightVisualEntity,
+  this->dataPtr->CreateComponent(lightVisualEntity,
       components::Transparency(false));
   this->SetParent(lightVisualEntity, lightEntity);
 
@@ -560,21 +1000,21 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Link *_link)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Link)");
 
   // Entity
-  Entity linkEntity = this->dataPtr->ecm->CreateEntity();
+  Entity linkEntity = this->dataPtr->CreateEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(linkEntity, components::Link());
+  this->dataPtr->CreateComponent(linkEntity, components::Link());
 
-  this->dataPtr->ecm->CreateComponent(linkEntity,
+  this->dataPtr->CreateComponent(linkEntity,
       components::Pose(ResolveSdfPose(_link->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(linkEntity,
+  this->dataPtr->CreateComponent(linkEntity,
       components::Name(_link->Name()));
-  this->dataPtr->ecm->CreateComponent(linkEntity,
+  this->dataPtr->CreateComponent(linkEntity,
       components::Inertial(_link->Inertial()));
 
   if (_link->EnableWind())
   {
-    this->dataPtr->ecm->CreateComponent(
+    this->dataPtr->CreateComponent(
         linkEntity, components::WindMode(_link->EnableWind()));
   }
 
@@ -644,12 +1084,12 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Joint *_joint,
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Joint)");
 
   // Entity
-  Entity jointEntity = this->dataPtr->ecm->CreateEntity();
+  Entity jointEntity = this->dataPtr->CreateEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(jointEntity,
+  this->dataPtr->CreateComponent(jointEntity,
       components::Joint());
-  this->dataPtr->ecm->CreateComponent(jointEntity,
+  this->dataPtr->CreateComponent(jointEntity,
       components::JointType(_joint->Type()));
 
   // Sensors
@@ -672,7 +1112,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Joint *_joint,
       return kNullEntity;
     }
 
-    this->dataPtr->ecm->CreateComponent(jointEntity,
+    this->dataPtr->CreateComponent(jointEntity,
         components::JointAxis(std::move(*resolvedAxis)));
   }
 
@@ -686,15 +1126,15 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Joint *_joint,
       return kNullEntity;
     }
 
-    this->dataPtr->ecm->CreateComponent(jointEntity,
+    this->dataPtr->CreateComponent(jointEntity,
         components::JointAxis2(std::move(*resolvedAxis)));
   }
 
-  this->dataPtr->ecm->CreateComponent(jointEntity,
+  this->dataPtr->CreateComponent(jointEntity,
       components::Pose(ResolveSdfPose(_joint->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(jointEntity ,
+  this->dataPtr->CreateComponent(jointEntity ,
       components::Name(_joint->Name()));
-  this->dataPtr->ecm->CreateComponent(jointEntity ,
+  this->dataPtr->CreateComponent(jointEntity ,
       components::ThreadPitch(_joint->ThreadPitch()));
 
 
@@ -721,7 +1161,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Joint *_joint,
       return kNullEntity;
     }
   }
-  this->dataPtr->ecm->CreateComponent(
+  this->dataPtr->CreateComponent(
       jointEntity, components::ParentLinkName(resolvedParentLinkName));
 
   std::string resolvedChildLinkName;
@@ -747,7 +1187,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Joint *_joint,
     }
   }
 
-  this->dataPtr->ecm->CreateComponent(
+  this->dataPtr->CreateComponent(
       jointEntity, components::ChildLinkName(resolvedChildLinkName));
 
   return jointEntity;
@@ -759,44 +1199,44 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Visual *_visual)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Visual)");
 
   // Entity
-  Entity visualEntity = this->dataPtr->ecm->CreateEntity();
+  Entity visualEntity = this->dataPtr->CreateEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(visualEntity, components::Visual());
-  this->dataPtr->ecm->CreateComponent(visualEntity,
+  this->dataPtr->CreateComponent(visualEntity, components::Visual());
+  this->dataPtr->CreateComponent(visualEntity,
       components::Pose(ResolveSdfPose(_visual->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(visualEntity,
+  this->dataPtr->CreateComponent(visualEntity,
       components::Name(_visual->Name()));
-  this->dataPtr->ecm->CreateComponent(visualEntity,
+  this->dataPtr->CreateComponent(visualEntity,
       components::CastShadows(_visual->CastShadows()));
-  this->dataPtr->ecm->CreateComponent(visualEntity,
+  this->dataPtr->CreateComponent(visualEntity,
       components::Transparency(_visual->Transparency()));
-  this->dataPtr->ecm->CreateComponent(visualEntity,
+  this->dataPtr->CreateComponent(visualEntity,
       components::VisibilityFlags(_visual->VisibilityFlags()));
 
   if (_visual->HasLaserRetro())
   {
-    this->dataPtr->ecm->CreateComponent(visualEntity,
+    this->dataPtr->CreateComponent(visualEntity,
         components::LaserRetro(_visual->LaserRetro()));
   }
 
   if (_visual->Geom())
   {
-    this->dataPtr->ecm->CreateComponent(visualEntity,
+    this->dataPtr->CreateComponent(visualEntity,
         components::Geometry(*_visual->Geom()));
   }
 
   // \todo(louise) Populate with default material if undefined
   if (_visual->Material())
   {
-    this->dataPtr->ecm->CreateComponent(visualEntity,
+    this->dataPtr->CreateComponent(visualEntity,
         components::Material(*_visual->Material()));
   }
 
   // store the plugin in a component
   if (!_visual->Plugins().empty())
   {
-    this->dataPtr->ecm->CreateComponent(visualEntity,
+    this->dataPtr->CreateComponent(visualEntity,
         components::SystemPluginInfo(
           convert<msgs::Plugin_V>(_visual->Plugins())));
   }
@@ -806,9 +1246,48 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Visual *_visual)
     sdf::ElementPtr pluginElem = _visual->Element()->FindElement("plugin");
     if (pluginElem)
     {
-      this->dataPtr->ecm->CreateComponent(visualEntity,
+      this->dataPtr->CreateComponent(visualEntity,
           components::VisualPlugin(pluginElem));
     }
+
+    // Levels of detail are described inside the ignition::gazebo plugin,
+    // like levels are for worlds
+    for (auto plugin = pluginElem; plugin;
+         plugin = plugin->GetNextElement("plugin"))
+    {
+      if (plugin->Get<std::string>("name") != "ignition::gazebo" ||
+          !plugin->HasElement("lod"))
+      {
+        continue;
+      }
+
+      std::vector<lod::Level> levels;
+      auto lodElem = plugin->GetElement("lod");
+      for (auto levelElem = lodElem->FindElement("level"); levelElem;
+           levelElem = levelElem->GetNextElement("level"))
+      {
+        lod::Level level;
+        level.distance = levelElem->Get<double>("distance", 0.0).first;
+        if (levelElem->HasElement("mesh"))
+        {
+          level.mesh = asFullPath(levelElem->Get<std::string>("mesh"),
+              levelElem->FilePath());
+        }
+        levels.push_back(level);
+      }
+      std::sort(levels.begin(), levels.end(),
+          [](const lod::Level &_a, const lod::Level &_b)
+          {
+            return _a.distance < _b.distance;
+          });
+
+      if (!levels.empty())
+      {
+        this->dataPtr->CreateComponent(visualEntity,
+            components::VisualLod(levels));
+      }
+      break;
+    }
   }
 
   // Keep track of visuals so we can load their plugins after loading the
@@ -825,14 +1304,14 @@ Entity SdfEntityCreator::CreateEntities(const sdf::ParticleEmitter *_emitter)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::ParticleEmitter)");
 
   // Entity
-  Entity emitterEntity = this->dataPtr->ecm->CreateEntity();
+  Entity emitterEntity = this->dataPtr->CreateEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(emitterEntity,
+  this->dataPtr->CreateComponent(emitterEntity,
       components::ParticleEmitter(convert<msgs::ParticleEmitter>(*_emitter)));
-  this->dataPtr->ecm->CreateComponent(emitterEntity,
+  this->dataPtr->CreateComponent(emitterEntity,
       components::Pose(ResolveSdfPose(_emitter->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(emitterEntity,
+  this->dataPtr->CreateComponent(emitterEntity,
       components::Name(_emitter->Name()));
 
   return emitterEntity;
@@ -844,23 +1323,23 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Collision *_collision)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Collision)");
 
   // Entity
-  Entity collisionEntity = this->dataPtr->ecm->CreateEntity();
+  Entity collisionEntity = this->dataPtr->CreateEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(collisionEntity,
+  this->dataPtr->CreateComponent(collisionEntity,
       components::Collision());
-  this->dataPtr->ecm->CreateComponent(collisionEntity,
+  this->dataPtr->CreateComponent(collisionEntity,
       components::Pose(ResolveSdfPose(_collision->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(collisionEntity,
+  this->dataPtr->CreateComponent(collisionEntity,
       components::Name(_collision->Name()));
 
   if (_collision->Geom())
   {
-    this->dataPtr->ecm->CreateComponent(collisionEntity,
+    this->dataPtr->CreateComponent(collisionEntity,
         components::Geometry(*_collision->Geom()));
   }
 
-  this->dataPtr->ecm->CreateComponent(collisionEntity,
+  this->dataPtr->CreateComponent(collisionEntity,
       components::CollisionElement(*_collision));
 
   return collisionEntity;
@@ -872,132 +1351,132 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Sensor *_sensor)
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Sensor)");
 
   // Entity
-  Entity sensorEntity = this->dataPtr->ecm->CreateEntity();
+  Entity sensorEntity = this->dataPtr->CreateEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(sensorEntity,
+  this->dataPtr->CreateComponent(sensorEntity,
       components::Sensor());
-  this->dataPtr->ecm->CreateComponent(sensorEntity,
+  this->dataPtr->CreateComponent(sensorEntity,
       components::Pose(ResolveSdfPose(_sensor->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(sensorEntity,
+  this->dataPtr->CreateComponent(sensorEntity,
       components::Name(_sensor->Name()));
 
   if (_sensor->Type() == sdf::SensorType::CAMERA)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::Camera(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::GPU_LIDAR)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::GpuLidar(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::LIDAR)
   {
     // \todo(anyone) Implement CPU-based lidar
-    // this->dataPtr->ecm->CreateComponent(sensorEntity,
+    // this->dataPtr->CreateComponent(sensorEntity,
     //     components::Lidar(*_sensor));
     ignwarn << "Sensor type LIDAR not supported yet. Try using"
       << "a GPU LIDAR instead." << std::endl;
   }
   else if (_sensor->Type() == sdf::SensorType::DEPTH_CAMERA)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::DepthCamera(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::RGBD_CAMERA)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::RgbdCamera(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::THERMAL_CAMERA)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::ThermalCamera(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::SEGMENTATION_CAMERA)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::SegmentationCamera(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::BOUNDINGBOX_CAMERA)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::BoundingBoxCamera(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::AIR_PRESSURE)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::AirPressureSensor(*_sensor));
 
     // create components to be filled by physics
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::WorldPose(math::Pose3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::ALTIMETER)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::Altimeter(*_sensor));
 
     // create components to be filled by physics
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::WorldPose(math::Pose3d::Zero));
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::WorldLinearVelocity(math::Vector3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::GPS ||
            _sensor->Type() == sdf::SensorType::NAVSAT)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
             components::NavSat(*_sensor));
 
     // Create components to be filled by physics.
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::WorldLinearVelocity(math::Vector3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::IMU)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
             components::Imu(*_sensor));
 
     // create components to be filled by physics
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
             components::WorldPose(math::Pose3d::Zero));
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
             components::AngularVelocity(math::Vector3d::Zero));
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
             components::LinearAcceleration(math::Vector3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::FORCE_TORQUE)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::ForceTorque(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::LOGICAL_CAMERA)
   {
     auto elem = _sensor->Element();
 
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::LogicalCamera(elem));
 
     // create components to be filled by physics
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::WorldPose(math::Pose3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::MAGNETOMETER)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::Magnetometer(*_sensor));
 
     // create components to be filled by physics
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
         components::WorldPose(math::Pose3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::CONTACT)
   {
     auto elem = _sensor->Element();
 
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
             components::ContactSensor(elem));
     // We will let the contact system create the necessary components for
     // physics to populate.
@@ -1005,7 +1484,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Sensor *_sensor)
   else if (_sensor->Type() == sdf::SensorType::CUSTOM)
   {
     auto elem = _sensor->Element();
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    this->dataPtr->CreateComponent(sensorEntity,
             components::CustomSensor(*_sensor));
   }
   else
@@ -1045,7 +1524,22 @@ void SdfEntityCreator::SetParent(Entity _child, Entity _parent)
 {
   // TODO(louise) Figure out a way to avoid duplication while keeping all
   // state in components and also keeping a convenient graph in the ECM
-  this->dataPtr->ecm->SetParentEntity(_child, _parent);
-  this->dataPtr->ecm->CreateComponent(_child,
-      components::ParentEntity(_parent));
+  if (nullptr == this->dataPtr->staging)
+  {
+    this->dataPtr->ecm->SetParentEntity(_child, _parent);
+    this->dataPtr->ecm->CreateComponent(_child,
+        components::ParentEntity(_parent));
+    return;
+  }
+
+  if (_child < this->dataPtr->staging->parents.size())
+    this->dataPtr->staging->parents[_child] = _parent;
+  this->dataPtr->staging->calls.push_back(
+      [_child, _parent](EntityComponentManager &_ecm,
+          std::vector<Entity> &_entities)
+      {
+        _ecm.SetParentEntity(_entities[_child], _entities[_parent]);
+      });
+  this->dataPtr->CreateEntityComponent<components::ParentEntity>(_child,
+      _parent);
 }
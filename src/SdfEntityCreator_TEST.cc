@@ -47,6 +47,7 @@
 #include "ignition/gazebo/components/ParentLinkName.hh"
 #include "ignition/gazebo/components/Physics.hh"
 #include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/Static.hh"
 #include "ignition/gazebo/components/Transparency.hh"
 #include "ignition/gazebo/components/Visibility.hh"
 #include "ignition/gazebo/components/Visual.hh"
@@ -1273,3 +1274,141 @@ TEST_F(SdfEntityCreatorTest, EachRemovedRecursiveRemoved)
   EXPECT_EQ(0u, removedCount<components::Collision>(ecm));
   EXPECT_EQ(0u, removedCount<components::Visual>(ecm));
 }
+
+/////////////////////////////////////////////////
+TEST_F(SdfEntityCreatorTest, CreateEntitiesInParallel)
+{
+  for (const std::string world : {"shapes.sdf", "force_torque.sdf",
+       "nested_model_canonical_link.sdf", "level_performance.sdf"})
+  {
+    sdf::Root root;
+    root.Load(std::string(PROJECT_SOURCE_PATH) + "/test/worlds/" + world);
+    ASSERT_EQ(1u, root.WorldCount()) << world;
+
+    // Models are only staged in parallel with more than one thread
+    EntityComponentManager serialEcm;
+    serialEcm.SetMaxThreads(1u);
+    EventManager serialEvm;
+    SdfEntityCreator serialCreator(serialEcm, serialEvm);
+    serialCreator.CreateEntities(root.WorldByIndex(0));
+
+    EntityComponentManager parallelEcm;
+    parallelEcm.SetMaxThreads(4u);
+    EventManager parallelEvm;
+    SdfEntityCreator parallelCreator(parallelEcm, parallelEvm);
+    parallelCreator.CreateEntities(root.WorldByIndex(0));
+
+    // Both must create the same entities, with the same ids
+    ASSERT_EQ(serialEcm.EntityCount(), parallelEcm.EntityCount()) << world;
+    for (Entity entity = 1; entity <= serialEcm.EntityCount(); ++entity)
+    {
+      ASSERT_TRUE(parallelEcm.HasEntity(entity)) << world;
+      EXPECT_EQ(serialEcm.ComponentTypes(entity),
+          parallelEcm.ComponentTypes(entity)) << world << " " << entity;
+      EXPECT_EQ(serialEcm.ParentEntity(entity),
+          parallelEcm.ParentEntity(entity)) << world << " " << entity;
+
+      auto serialName = serialEcm.Component<components::Name>(entity);
+      auto parallelName = parallelEcm.Component<components::Name>(entity);
+      ASSERT_EQ(nullptr == serialName, nullptr == parallelName);
+      if (serialName)
+        EXPECT_EQ(serialName->Data(), parallelName->Data());
+
+      auto serialParent =
+          serialEcm.Component<components::ParentEntity>(entity);
+      auto parallelParent =
+          parallelEcm.Component<components::ParentEntity>(entity);
+      ASSERT_EQ(nullptr == serialParent, nullptr == parallelParent);
+      if (serialParent)
+        EXPECT_EQ(serialParent->Data(), parallelParent->Data());
+
+      auto serialCanonical =
+          serialEcm.Component<components::ModelCanonicalLink>(entity);
+      auto parallelCanonical =
+          parallelEcm.Component<components::ModelCanonicalLink>(entity);
+      ASSERT_EQ(nullptr == serialCanonical, nullptr == parallelCanonical);
+      if (serialCanonical)
+        EXPECT_EQ(serialCanonical->Data(), parallelCanonical->Data());
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_F(SdfEntityCreatorTest, ReuseRepeatedModels)
+{
+  const std::string model = R"(
+      <pose>POSE</pose>
+      <link name="link">
+        <collision name="collision">
+          <geometry><box><size>1 1 1</size></box></geometry>
+        </collision>
+        <visual name="visual">
+          <geometry><box><size>1 1 1</size></box></geometry>
+        </visual>
+      </link>
+    </model>)";
+  std::string sdfString = R"(<?xml version="1.0" ?>
+    <sdf version="1.6"><world name="default">)";
+  for (int i = 0; i < 4; ++i)
+  {
+    std::string instance = "<model name=\"box_" + std::to_string(i) + "\">" +
+        model;
+    instance.replace(instance.find("POSE"), 4,
+        std::to_string(i) + " 0 0 0 0 0");
+    sdfString += instance;
+  }
+  // Differs in more than name and pose, so it's converted from SDF
+  sdfString += R"(<model name="static_box"><static>true</static>)" + model;
+  sdfString += "</world></sdf>";
+  sdfString.replace(sdfString.rfind("POSE"), 4, "0 0 0 0 0 0");
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  const auto *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  ASSERT_EQ(5u, world->ModelCount());
+
+  std::vector<const sdf::Model *> models;
+  for (uint64_t i = 0; i < world->ModelCount(); ++i)
+    models.push_back(world->ModelByIndex(i));
+
+  SdfEntityCreator creator(this->ecm, this->evm);
+  creator.SetReuseRepeatedModels(true);
+  const auto entities = creator.CreateEntities(models);
+  ASSERT_EQ(models.size(), entities.size());
+
+  // Model, link, collision and visual for each model
+  EXPECT_EQ(20u, this->ecm.EntityCount());
+
+  for (std::size_t i = 0; i < models.size(); ++i)
+  {
+    const Entity entity = entities[i];
+    ASSERT_NE(kNullEntity, entity);
+
+    auto name = this->ecm.Component<components::Name>(entity);
+    ASSERT_NE(nullptr, name);
+    EXPECT_EQ(models[i]->Name(), name->Data());
+
+    auto modelSdf = this->ecm.Component<components::ModelSdf>(entity);
+    ASSERT_NE(nullptr, modelSdf);
+    EXPECT_EQ(models[i]->Name(), modelSdf->Data().Name());
+
+    auto pose = this->ecm.Component<components::Pose>(entity);
+    ASSERT_NE(nullptr, pose);
+    EXPECT_EQ(models[i]->RawPose(), pose->Data());
+
+    auto isStatic = this->ecm.Component<components::Static>(entity);
+    ASSERT_NE(nullptr, isStatic);
+    EXPECT_EQ(i == 4u, isStatic->Data());
+
+    // Each model has its own link, which is its canonical link
+    auto links = this->ecm.ChildrenByComponents(entity, components::Link());
+    ASSERT_EQ(1u, links.size());
+    auto canonical =
+        this->ecm.Component<components::ModelCanonicalLink>(entity);
+    ASSERT_NE(nullptr, canonical);
+    EXPECT_EQ(links[0], canonical->Data());
+    EXPECT_EQ(2u, this->ecm.EntitiesByComponents(
+        components::ParentEntity(links[0])).size());
+  }
+}
@@ -18,11 +18,15 @@
 #include "SdfGenerator.hh"
 
 #include <ctype.h>
+#include <algorithm>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <sdf/sdf.hh>
 
+#include <ignition/common/Profiler.hh>
 #include <ignition/common/URI.hh>
 
 #include "ignition/gazebo/Util.hh"
@@ -285,18 +289,48 @@ namespace sdf_generator
   }
 
   /////////////////////////////////////////////////
-  bool updateWorldElement(sdf::ElementPtr _elem,
-                          const EntityComponentManager &_ecm,
-                          const Entity &_entity,
-                          const IncludeUriMap &_includeUriMap,
-                          const msgs::SdfGeneratorConfig &_config)
+  /// \brief Get the generator configuration of a model, which is the global
+  /// configuration merged with the model's override, if any.
+  /// \param[in] _model Model entity
+  /// \param[in] _ecm Immutable reference to the Entity Component Manager
+  /// \param[in] _config Configuration for the world generator
+  /// \returns Configuration of the model
+  static msgs::SdfGeneratorConfig::EntityGeneratorConfig modelGenConfig(
+      const Entity _model, const EntityComponentManager &_ecm,
+      const msgs::SdfGeneratorConfig &_config)
+  {
+    auto modelConfig = _config.global_entity_gen_config();
+    if (_config.override_entity_gen_configs().empty())
+      return modelConfig;
+
+    const std::string modelName = scopedName(_model, _ecm, "::", false);
+    auto modelConfigIt =
+        _config.override_entity_gen_configs().find(modelName);
+    if (modelConfigIt != _config.override_entity_gen_configs().end())
+    {
+      mergeWithOverride(modelConfig, modelConfigIt->second);
+    }
+    return modelConfig;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Copy the sdf::Element of a world and remove the children which
+  /// are regenerated from the ECM, such as models and lights.
+  /// \param[in, out] _elem sdf::Element to update
+  /// \param[in] _ecm Immutable reference to the Entity Component Manager
+  /// \param[in] _entity World entity
+  /// \param[out] _worldDir Directory containing the world file
+  /// \returns False if the world has no WorldSdf component
+  static bool copyWorldElement(const sdf::ElementPtr &_elem,
+                               const EntityComponentManager &_ecm,
+                               const Entity _entity, std::string &_worldDir)
   {
     const auto *worldSdf = _ecm.Component<components::WorldSdf>(_entity);
 
     if (nullptr == worldSdf)
       return false;
 
-    if (!copySdf(_ecm.Component<components::WorldSdf>(_entity), _elem))
+    if (!copySdf(worldSdf, _elem))
       return false;
 
     // First remove child entities of <world> whose names can be changed during
@@ -326,12 +360,142 @@ namespace sdf_generator
       _elem->RemoveChild(e);
     }
 
-    auto worldDir = common::parentPath(worldSdf->Data().Element()->FilePath());
+    _worldDir = common::parentPath(worldSdf->Data().Element()->FilePath());
+    return true;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Add the element of a top level model to a world, either
+  /// expanded or as an include, depending on the configuration.
+  /// \param[in, out] _worldElem sdf::Element of the world
+  /// \param[in] _ecm Immutable reference to the Entity Component Manager
+  /// \param[in] _model Model entity
+  /// \param[in] _worldDir Directory containing the world file
+  /// \param[in] _includeUriMap Map from file paths to URIs used to preserve
+  /// included Fuel models
+  /// \param[in] _config Configuration for the world generator
+  /// \returns The added element
+  static sdf::ElementPtr addModelElement(const sdf::ElementPtr &_worldElem,
+      const EntityComponentManager &_ecm, const Entity _model,
+      const std::string &_worldDir, const IncludeUriMap &_includeUriMap,
+      const msgs::SdfGeneratorConfig &_config)
+  {
+    const auto *modelSdf = _ecm.Component<components::ModelSdf>(_model);
+
+    auto modelDir =
+        common::parentPath(modelSdf->Data().Element()->FilePath());
+
+    bool modelFromInclude = isModelFromInclude(modelDir, _worldDir);
+
+    auto uriMapIt = _includeUriMap.find(modelDir);
+
+    auto modelConfig = modelGenConfig(_model, _ecm, _config);
+
+    if (modelConfig.expand_include_tags().data() || !modelFromInclude)
+    {
+      auto modelElem = _worldElem->AddElement("model");
+      updateModelElement(modelElem, _ecm, _model);
+
+      // Check & update possible //model/include(s)
+      if (!modelConfig.expand_include_tags().data())
+      {
+        updateModelElementWithNestedInclude(modelElem,
+              modelConfig.save_fuel_version().data(), _includeUriMap);
+      }
+      return modelElem;
+    }
+    else if (uriMapIt != _includeUriMap.end())
+    {
+      // The fuel URI might have a version number. If it does, we remove
+      // it unless saveFuelModelVersion is set to true.
+      // Check if this is a fuel URI. We assume that it is a fuel URI if
+      // the scheme is http or https.
+      common::URI uri(uriMapIt->second);
+      if (uri.Scheme() == "http" || uri.Scheme() == "https")
+      {
+        removeVersionFromUri(uri);
+      }
+
+      if (modelConfig.save_fuel_version().data())
+      {
+        // Find out the model version from the file path. Note that we
+        // do this from the file path instead of the Fuel URI because the
+        // URI may not contain version information.
+        //
+        // We are assuming here that, for Fuel models, the directory
+        // containing the sdf file has the same name as the model version.
+        // For example, if the uri is
+        // https://example.org/1.0/test/models/Backpack
+        // the path to the directory containing the sdf file (modelDir)
+        // will be:
+        // $HOME/.ignition/fuel/example.org/test/models/Backpack/2/
+        // and the basename of the directory is "1", which is the model
+        // version.
+        //
+        // However, if symlinks (or other types of indirection) are used,
+        // the pattern of modelDir will be different. The assumption here
+        // is that regardless of the indirection, the name of the
+        // directory containing the sdf file can be used as the version
+        // number
+        //
+        uri.Path() /= common::basename(modelDir);
+      }
+
+      auto includeElem = _worldElem->AddElement("include");
+      updateIncludeElement(includeElem, _ecm, _model, uri.Str());
+      return includeElem;
+    }
+    else
+    {
+      // The model is not in the includeUriMap, but expandIncludeTags =
+      // false, so we will assume that its uri is the file path of the
+      // model on the local machine
+      auto includeElem = _worldElem->AddElement("include");
+      const std::string uri = "file://" + modelDir;
+      updateIncludeElement(includeElem, _ecm, _model, uri);
+      return includeElem;
+    }
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Add the elements of the lights which are direct children of a
+  /// world.
+  /// \param[in, out] _worldElem sdf::Element of the world
+  /// \param[in] _ecm Immutable reference to the Entity Component Manager
+  /// \param[in] _entity World entity
+  static void addLightElements(const sdf::ElementPtr &_worldElem,
+      const EntityComponentManager &_ecm, const Entity _entity)
+  {
+    _ecm.Each<components::Light, components::ParentEntity>(
+        [&](const Entity &_lightEntity,
+            const components::Light *,
+            const components::ParentEntity *_parent) -> bool
+        {
+          if (_parent->Data() != _entity)
+            return true;
+
+           auto lightElem = _worldElem->AddElement("light");
+           updateLightElement(lightElem, _ecm, _lightEntity);
+
+          return true;
+        });
+  }
+
+  /////////////////////////////////////////////////
+  bool updateWorldElement(sdf::ElementPtr _elem,
+                          const EntityComponentManager &_ecm,
+                          const Entity &_entity,
+                          const IncludeUriMap &_includeUriMap,
+                          const msgs::SdfGeneratorConfig &_config)
+  {
+    std::string worldDir;
+    if (!copyWorldElement(_elem, _ecm, _entity, worldDir))
+      return false;
 
     // models
     _ecm.Each<components::Model, components::ModelSdf>(
         [&](const Entity &_modelEntity, const components::Model *,
-            const components::ModelSdf *_modelSdf)
+            const components::ModelSdf *)
         {
           // skip nested models as they are not direct children of world
           auto parentComp = _ecm.Component<components::ParentEntity>(
@@ -339,106 +503,220 @@ namespace sdf_generator
           if (parentComp && parentComp->Data() != _entity)
             return true;
 
-          auto modelDir =
-              common::parentPath(_modelSdf->Data().Element()->FilePath());
+          addModelElement(_elem, _ecm, _modelEntity, worldDir,
+              _includeUriMap, _config);
+          return true;
+        });
 
-          const std::string modelName =
-              scopedName(_modelEntity, _ecm, "::", false);
+    // lights
+    addLightElements(_elem, _ecm, _entity);
 
-          bool modelFromInclude = isModelFromInclude(modelDir, worldDir);
+    return true;
+  }
 
-          auto uriMapIt = _includeUriMap.find(modelDir);
+  /////////////////////////////////////////////////
+  /// \brief Private data of WorldGenerator
+  class WorldGeneratorPrivate
+  {
+    /// \brief Generated text of a top level model
+    public: struct CachedModel
+    {
+      /// \brief Latest component version of the model and its descendants
+      uint64_t version{0u};
 
-          auto modelConfig = _config.global_entity_gen_config();
-          auto modelConfigIt =
-              _config.override_entity_gen_configs().find(modelName);
-          if (modelConfigIt != _config.override_entity_gen_configs().end())
-          {
-            mergeWithOverride(modelConfig, modelConfigIt->second);
-          }
+      /// \brief Number of entities in the model, which catches removed
+      /// descendants
+      std::size_t entityCount{0u};
 
-          if (modelConfig.expand_include_tags().data() || !modelFromInclude)
-          {
-            auto modelElem = _elem->AddElement("model");
-            updateModelElement(modelElem, _ecm, _modelEntity);
+      /// \brief Number of components in the model, which catches removed
+      /// components
+      std::size_t componentCount{0u};
 
-            // Check & update possible //model/include(s)
-            if (!modelConfig.expand_include_tags().data())
-            {
-              updateModelElementWithNestedInclude(modelElem,
-                    modelConfig.save_fuel_version().data(), _includeUriMap);
-            }
-          }
-          else if (uriMapIt != _includeUriMap.end())
+      /// \brief Everything besides the ECM which the text depends on, such
+      /// as the configuration and the include URI
+      std::string key;
+
+      /// \brief Generated text, indented for a child of <world>
+      std::string text;
+    };
+
+    /// \brief Cached models, by entity
+    public: std::unordered_map<Entity, CachedModel> models;
+
+    /// \brief Top level models in the order they're generated
+    public: std::vector<Entity> order;
+
+    /// \brief Text of the world up to its models
+    public: std::string head;
+
+    /// \brief Text of the lights
+    public: std::string lights;
+
+    /// \brief Text of the world after its lights
+    public: std::string tail;
+
+    /// \brief Number of models regenerated by the last update
+    public: std::size_t regenerated{0u};
+  };
+
+  /////////////////////////////////////////////////
+  WorldGenerator::WorldGenerator()
+    : dataPtr(std::make_unique<WorldGeneratorPrivate>())
+  {
+  }
+
+  /////////////////////////////////////////////////
+  WorldGenerator::~WorldGenerator() = default;
+
+  /////////////////////////////////////////////////
+  bool WorldGenerator::Update(const EntityComponentManager &_ecm,
+      const Entity &_entity, const IncludeUriMap &_includeUriMap,
+      const msgs::SdfGeneratorConfig &_config)
+  {
+    IGN_PROFILE("WorldGenerator::Update");
+
+    sdf::ElementPtr root = std::make_shared<sdf::Element>();
+    sdf::initFile("root.sdf", root);
+    auto worldElem = root->AddElement("world");
+    std::string worldDir;
+    if (!copyWorldElement(worldElem, _ecm, _entity, worldDir))
+      return false;
+
+    // Split the world without models and lights where they go, which is
+    // right before its closing tag
+    const std::string worldText = root->ToString("");
+    const std::string closing = "  </world>\n";
+    const auto split = worldText.rfind(closing);
+    if (split == std::string::npos)
+    {
+      // The world has no other children, so it's printed as an empty tag.
+      // This is rare enough to not be worth caching.
+      auto text = generateWorld(_ecm, _entity, _includeUriMap, _config);
+      if (!text)
+        return false;
+      this->dataPtr->head = *text;
+      this->dataPtr->order.clear();
+      this->dataPtr->models.clear();
+      this->dataPtr->lights.clear();
+      this->dataPtr->tail.clear();
+      this->dataPtr->regenerated = 0u;
+      return true;
+    }
+
+    const std::string configKey = _config.SerializeAsString();
+
+    this->dataPtr->order.clear();
+    this->dataPtr->regenerated = 0u;
+    _ecm.Each<components::Model, components::ModelSdf>(
+        [&](const Entity &_modelEntity, const components::Model *,
+            const components::ModelSdf *_modelSdf)
+        {
+          // skip nested models as they are not direct children of world
+          auto parentComp = _ecm.Component<components::ParentEntity>(
+              _modelEntity);
+          if (parentComp && parentComp->Data() != _entity)
+            return true;
+
+          WorldGeneratorPrivate::CachedModel current;
+          _ecm.EachDescendant(_modelEntity, [&](Entity _descendant)
           {
-            // The fuel URI might have a version number. If it does, we remove
-            // it unless saveFuelModelVersion is set to true.
-            // Check if this is a fuel URI. We assume that it is a fuel URI if
-            // the scheme is http or https.
-            common::URI uri(uriMapIt->second);
-            if (uri.Scheme() == "http" || uri.Scheme() == "https")
+            ++current.entityCount;
+            _ecm.EachComponentType(_descendant,
+                [&](ComponentTypeId _typeId)
             {
-              removeVersionFromUri(uri);
-            }
+              ++current.componentCount;
+              current.version = std::max(current.version,
+                  _ecm.ComponentVersion(_descendant, _typeId));
+              return true;
+            });
+            return true;
+          });
 
-            if (modelConfig.save_fuel_version().data())
-            {
-              // Find out the model version from the file path. Note that we
-              // do this from the file path instead of the Fuel URI because the
-              // URI may not contain version information.
-              //
-              // We are assuming here that, for Fuel models, the directory
-              // containing the sdf file has the same name as the model version.
-              // For example, if the uri is
-              // https://example.org/1.0/test/models/Backpack
-              // the path to the directory containing the sdf file (modelDir)
-              // will be:
-              // $HOME/.ignition/fuel/example.org/test/models/Backpack/2/
-              // and the basename of the directory is "1", which is the model
-              // version.
-              //
-              // However, if symlinks (or other types of indirection) are used,
-              // the pattern of modelDir will be different. The assumption here
-              // is that regardless of the indirection, the name of the
-              // directory containing the sdf file can be used as the version
-              // number
-              //
-              uri.Path() /= common::basename(modelDir);
-            }
-
-            auto includeElem = _elem->AddElement("include");
-            updateIncludeElement(includeElem, _ecm, _modelEntity, uri.Str());
-          }
-          else
-          {
-            // The model is not in the includeUriMap, but expandIncludeTags =
-            // false, so we will assume that its uri is the file path of the
-            // model on the local machine
-            auto includeElem = _elem->AddElement("include");
-            const std::string uri = "file://" + modelDir;
-            updateIncludeElement(includeElem, _ecm, _modelEntity, uri);
-          }
-          return true;
-        });
+          const auto modelDir =
+              common::parentPath(_modelSdf->Data().Element()->FilePath());
+          current.key = configKey + '\n' + worldDir + '\n' + modelDir;
+          auto uriMapIt = _includeUriMap.find(modelDir);
+          if (uriMapIt != _includeUriMap.end())
+            current.key += '\n' + uriMapIt->second;
 
-    // lights
-    _ecm.Each<components::Light, components::ParentEntity>(
-        [&](const Entity &_lightEntity,
-            const components::Light *,
-            const components::ParentEntity *_parent) -> bool
-        {
-          if (_parent->Data() != _entity)
+          this->dataPtr->order.push_back(_modelEntity);
+
+          auto cachedIt = this->dataPtr->models.find(_modelEntity);
+          if (cachedIt != this->dataPtr->models.end() &&
+              cachedIt->second.version == current.version &&
+              cachedIt->second.entityCount == current.entityCount &&
+              cachedIt->second.componentCount == current.componentCount &&
+              cachedIt->second.key == current.key)
+          {
             return true;
+          }
 
-           auto lightElem = _elem->AddElement("light");
-           updateLightElement(lightElem, _ecm, _lightEntity);
+          auto elem = addModelElement(worldElem, _ecm, _modelEntity,
+              worldDir, _includeUriMap, _config);
+          current.text = elem->ToString("    ");
+          worldElem->RemoveChild(elem);
 
+          this->dataPtr->models[_modelEntity] = std::move(current);
+          ++this->dataPtr->regenerated;
           return true;
         });
 
+    // Forget models which were removed
+    if (this->dataPtr->models.size() > this->dataPtr->order.size())
+    {
+      std::unordered_set<Entity> present(this->dataPtr->order.begin(),
+          this->dataPtr->order.end());
+      for (auto it = this->dataPtr->models.begin();
+           it != this->dataPtr->models.end();)
+      {
+        if (present.count(it->first) == 0u)
+          it = this->dataPtr->models.erase(it);
+        else
+          ++it;
+      }
+    }
+
+    // There are few lights, so they're always regenerated
+    addLightElements(worldElem, _ecm, _entity);
+    this->dataPtr->lights.clear();
+    if (worldElem->HasElement("light"))
+    {
+      for (auto lightElem = worldElem->GetElement("light"); lightElem;
+           lightElem = lightElem->GetNextElement("light"))
+      {
+        this->dataPtr->lights += lightElem->ToString("    ");
+      }
+    }
+
+    this->dataPtr->head = worldText.substr(0, split);
+    this->dataPtr->tail = worldText.substr(split);
     return true;
   }
 
+  /////////////////////////////////////////////////
+  std::string WorldGenerator::Text() const
+  {
+    std::size_t size = this->dataPtr->head.size() +
+        this->dataPtr->lights.size() + this->dataPtr->tail.size();
+    for (const Entity model : this->dataPtr->order)
+      size += this->dataPtr->models.at(model).text.size();
+
+    std::string text;
+    text.reserve(size);
+    text += this->dataPtr->head;
+    for (const Entity model : this->dataPtr->order)
+      text += this->dataPtr->models.at(model).text;
+    text += this->dataPtr->lights;
+    text += this->dataPtr->tail;
+    return text;
+  }
+
+  /////////////////////////////////////////////////
+  std::size_t WorldGenerator::RegeneratedModelCount() const
+  {
+    return this->dataPtr->regenerated;
+  }
+
   /////////////////////////////////////////////////
   bool updateModelElement(const sdf::ElementPtr &_elem,
                           const EntityComponentManager &_ecm,
@@ -918,14 +1196,12 @@ namespace sdf_generator
       _elem->RemoveChild(e);
     }
 
-    auto sensorEntities = _ecm.EntitiesByComponents(
-        components::ParentEntity(_entity), components::Sensor());
-
-    for (const auto &sensorEnt : sensorEntities)
+    _ecm.EachEntityByComponents([&](const Entity _sensor)
     {
       sdf::ElementPtr sensorElem = _elem->AddElement("sensor");
-      updateSensorElement(sensorElem, _ecm, sensorEnt);
-    }
+      updateSensorElement(sensorElem, _ecm, _sensor);
+      return true;
+    }, components::ParentEntity(_entity), components::Sensor());
 
     return updateJointNameAndPose();
   }
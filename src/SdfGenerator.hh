@@ -20,6 +20,8 @@
 #include <ignition/msgs/sdf_generator_config.pb.h>
 
 #include <sdf/Element.hh>
+#include <cstddef>
+#include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -51,6 +53,55 @@ namespace sdf_generator
       const IncludeUriMap &_includeUriMap = IncludeUriMap(),
       const msgs::SdfGeneratorConfig &_config = msgs::SdfGeneratorConfig());
 
+  // Forward declaration
+  class WorldGeneratorPrivate;
+
+  /// \brief Generates the SDFormat of a world repeatedly, such as for
+  /// periodic snapshots. The text of each top level model is cached along
+  /// with the latest component version found among the model and its
+  /// descendants, see EntityComponentManager::ComponentVersion. Only models
+  /// which changed since the previous generation are regenerated, so saving
+  /// a large and mostly static world is much cheaper than with
+  /// generateWorld, which yields the same text.
+  ///
+  /// Changes are only noticed if they're marked through
+  /// EntityComponentManager::SetChanged, or if components are created or
+  /// removed.
+  class IGNITION_GAZEBO_VISIBLE WorldGenerator
+  {
+    /// \brief Constructor
+    public: WorldGenerator();
+
+    /// \brief Destructor
+    public: ~WorldGenerator();
+
+    /// \brief Bring the generated world up to date with the ECM. This is
+    /// the only function which reads the ECM, so it's the only one which
+    /// needs to be synchronized with the simulation.
+    /// \input[in] _ecm Immutable reference to the Entity Component Manager
+    /// \input[in] _entity World entity
+    /// \input[in] _includeUriMap Map from file paths to URIs used to preserve
+    /// included Fuel models
+    /// \input[in] _config Configuration for the world generator
+    /// \returns True if generation succeeded.
+    public: bool Update(
+        const EntityComponentManager &_ecm, const Entity &_entity,
+        const IncludeUriMap &_includeUriMap = IncludeUriMap(),
+        const msgs::SdfGeneratorConfig &_config = msgs::SdfGeneratorConfig());
+
+    /// \brief Get the world generated by the last successful Update.
+    /// \returns Generated world string, empty if Update never succeeded.
+    public: std::string Text() const;
+
+    /// \brief Number of models regenerated by the last Update, the others
+    /// were reused from the cache.
+    /// \returns Model count.
+    public: std::size_t RegeneratedModelCount() const;
+
+    /// \brief Private data pointer
+    private: std::unique_ptr<WorldGeneratorPrivate> dataPtr;
+  };
+
   /// \brief Update a sdf::Element of a world. Intended for internal use.
   /// \input[in, out] _elem sdf::Element to update
   /// \input[in] _ecm Immutable reference to the Entity Component Manager
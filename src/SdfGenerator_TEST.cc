@@ -583,6 +583,51 @@ TEST_F(ElementUpdateFixture, WorldComponentUpdate)
   EXPECT_EQ(newPose, modelElem->Get<math::Pose3d>("pose"));
 }
 
+/////////////////////////////////////////////////
+TEST_F(ElementUpdateFixture, WorldGeneratorIncremental)
+{
+  this->LoadWorld("test/worlds/shapes.sdf");
+  Entity worldEntity = this->ecm.EntityByComponents(components::World());
+
+  sdf_generator::WorldGenerator generator;
+  EXPECT_TRUE(generator.Text().empty());
+
+  ASSERT_TRUE(generator.Update(this->ecm, worldEntity));
+  auto expected = sdf_generator::generateWorld(this->ecm, worldEntity);
+  ASSERT_TRUE(expected.has_value());
+  EXPECT_EQ(*expected, generator.Text());
+  const auto modelCount = generator.RegeneratedModelCount();
+  EXPECT_LT(1u, modelCount);
+
+  // Nothing changed, so all models are reused
+  ASSERT_TRUE(generator.Update(this->ecm, worldEntity));
+  EXPECT_EQ(0u, generator.RegeneratedModelCount());
+  EXPECT_EQ(*expected, generator.Text());
+
+  // Only the changed model is regenerated
+  Entity modelEntity = this->ecm.EntityByComponents(
+      components::Model(), components::Name("box"));
+  auto *poseComp = this->ecm.Component<components::Pose>(modelEntity);
+  ASSERT_NE(nullptr, poseComp);
+  *poseComp = components::Pose(math::Pose3d(0.1, 0.2, 0.3, 0, 0, 0));
+  this->ecm.SetChanged(modelEntity, components::Pose::typeId,
+      ComponentState::OneTimeChange);
+
+  ASSERT_TRUE(generator.Update(this->ecm, worldEntity));
+  EXPECT_EQ(1u, generator.RegeneratedModelCount());
+  expected = sdf_generator::generateWorld(this->ecm, worldEntity);
+  ASSERT_TRUE(expected.has_value());
+  EXPECT_EQ(*expected, generator.Text());
+
+  // A different configuration regenerates everything
+  this->sdfGenConfig.mutable_global_entity_gen_config()
+      ->mutable_expand_include_tags()
+      ->set_data(true);
+  ASSERT_TRUE(generator.Update(this->ecm, worldEntity, this->includeUriMap,
+      this->sdfGenConfig));
+  EXPECT_EQ(modelCount, generator.RegeneratedModelCount());
+}
+
 /////////////////////////////////////////////////
 TEST_F(ElementUpdateFixture, WorldWithModelsIncludedNotExpanded)
 {
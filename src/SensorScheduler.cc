@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ignition/gazebo/SensorScheduler.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief A sensor waiting in the scheduler's heap.
+struct ScheduledSensor
+{
+  /// \brief Time when the sensor is due.
+  std::chrono::steady_clock::duration time;
+
+  /// \brief Sensor entity.
+  Entity entity;
+
+  /// \brief Generation of the entry, entries whose generation doesn't
+  /// match the sensor's current one are stale.
+  uint64_t generation;
+
+  /// \brief Order for a min-heap on time.
+  /// \param[in] _other Other entry.
+  /// \return True if this entry is due after the other one.
+  bool operator>(const ScheduledSensor &_other) const
+  {
+    return this->time > _other.time;
+  }
+};
+
+/// \brief Private data of SensorScheduler
+class ignition::gazebo::SensorSchedulerPrivate
+{
+  /// \brief Drop stale entries from the top of the heap.
+  public: void Prune();
+
+  /// \brief Rebuild the heap without stale entries, once they're the
+  /// majority.
+  public: void Compact();
+
+  /// \brief Whether an entry is the current one of its sensor.
+  /// \param[in] _entry Heap entry.
+  /// \return True if it's current.
+  public: bool Current(const ScheduledSensor &_entry) const;
+
+  /// \brief Min-heap of scheduled sensors. Rescheduling or removing a
+  /// sensor leaves its previous entry in the heap, to be skipped later.
+  public: std::vector<ScheduledSensor> heap;
+
+  /// \brief Current generation of each scheduled sensor.
+  public: std::unordered_map<Entity, uint64_t> generations;
+
+  /// \brief Generation of the next entry.
+  public: uint64_t nextGeneration{0u};
+
+  /// \brief Due sensors of the last UpdateDue call.
+  public: std::vector<Entity> due;
+};
+
+//////////////////////////////////////////////////
+bool SensorSchedulerPrivate::Current(const ScheduledSensor &_entry) const
+{
+  auto it = this->generations.find(_entry.entity);
+  return it != this->generations.end() && it->second == _entry.generation;
+}
+
+//////////////////////////////////////////////////
+void SensorSchedulerPrivate::Prune()
+{
+  while (!this->heap.empty() && !this->Current(this->heap.front()))
+  {
+    std::pop_heap(this->heap.begin(), this->heap.end(),
+        std::greater<ScheduledSensor>());
+    this->heap.pop_back();
+  }
+}
+
+//////////////////////////////////////////////////
+void SensorSchedulerPrivate::Compact()
+{
+  if (this->heap.size() < 2u * this->generations.size() + 64u)
+    return;
+
+  this->heap.erase(std::remove_if(this->heap.begin(), this->heap.end(),
+      [this](const ScheduledSensor &_entry)
+      {
+        return !this->Current(_entry);
+      }), this->heap.end());
+  std::make_heap(this->heap.begin(), this->heap.end(),
+      std::greater<ScheduledSensor>());
+}
+
+//////////////////////////////////////////////////
+SensorScheduler::SensorScheduler()
+  : dataPtr(std::make_unique<SensorSchedulerPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+SensorScheduler::~SensorScheduler() = default;
+
+//////////////////////////////////////////////////
+void SensorScheduler::Schedule(Entity _entity,
+    const std::chrono::steady_clock::duration &_time)
+{
+  const auto generation = this->dataPtr->nextGeneration++;
+  this->dataPtr->generations[_entity] = generation;
+  this->dataPtr->heap.push_back({_time, _entity, generation});
+  std::push_heap(this->dataPtr->heap.begin(), this->dataPtr->heap.end(),
+      std::greater<ScheduledSensor>());
+  this->dataPtr->Compact();
+  this->dataPtr->Prune();
+}
+
+//////////////////////////////////////////////////
+void SensorScheduler::Reschedule(Entity _entity,
+    const std::chrono::steady_clock::duration &_now,
+    const std::chrono::steady_clock::duration &_next, double _rate)
+{
+  if (_next > _now)
+  {
+    this->Schedule(_entity, _next);
+    return;
+  }
+
+  // Due again on the next step
+  auto period = std::chrono::steady_clock::duration(1);
+  if (_rate > 0.0)
+  {
+    period = std::max(period,
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / _rate)));
+  }
+  this->Schedule(_entity, _now + period);
+}
+
+//////////////////////////////////////////////////
+void SensorScheduler::Remove(Entity _entity)
+{
+  this->dataPtr->generations.erase(_entity);
+  this->dataPtr->Prune();
+}
+
+//////////////////////////////////////////////////
+bool SensorScheduler::Due(const std::chrono::steady_clock::duration &_now)
+    const
+{
+  return !this->dataPtr->heap.empty() &&
+      this->dataPtr->heap.front().time <= _now;
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration SensorScheduler::NextTime() const
+{
+  if (this->dataPtr->heap.empty())
+    return std::chrono::steady_clock::duration::max();
+  return this->dataPtr->heap.front().time;
+}
+
+//////////////////////////////////////////////////
+std::size_t SensorScheduler::Size() const
+{
+  return this->dataPtr->generations.size();
+}
+
+//////////////////////////////////////////////////
+void SensorScheduler::TakeDue(const std::chrono::steady_clock::duration &_now,
+    std::vector<Entity> &_due)
+{
+  _due.clear();
+  auto &heap = this->dataPtr->heap;
+  while (!heap.empty() && heap.front().time <= _now)
+  {
+    _due.push_back(heap.front().entity);
+    this->dataPtr->generations.erase(heap.front().entity);
+    std::pop_heap(heap.begin(), heap.end(), std::greater<ScheduledSensor>());
+    heap.pop_back();
+    this->dataPtr->Prune();
+  }
+}
+
+//////////////////////////////////////////////////
+const std::vector<Entity> &SensorScheduler::DueSensors() const
+{
+  return this->dataPtr->due;
+}
+
+//////////////////////////////////////////////////
+std::vector<Entity> &SensorScheduler::DueBuffer()
+{
+  return this->dataPtr->due;
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "ignition/gazebo/SensorScheduler.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+/////////////////////////////////////////////////
+/// \brief Sensor with the interface used by SensorScheduler::UpdateDue,
+/// throttled like ign-sensors sensors.
+class FakeSensor
+{
+  /// \brief Constructor
+  /// \param[in] _rate Update rate in Hz.
+  public: explicit FakeSensor(double _rate) : rate(_rate) {}
+
+  public: bool HasConnections() const { return this->connected; }
+
+  public: double UpdateRate() const { return this->rate; }
+
+  public: std::chrono::steady_clock::duration NextDataUpdateTime() const
+  {
+    return this->next;
+  }
+
+  public: bool Update(const std::chrono::steady_clock::duration &_now,
+      bool)
+  {
+    if (_now < this->next)
+      return false;
+    ++this->updates;
+    this->next = _now +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / this->rate));
+    return true;
+  }
+
+  public: double rate;
+  public: bool connected{true};
+  public: int updates{0};
+  public: std::chrono::steady_clock::duration next{0};
+};
+
+/////////////////////////////////////////////////
+TEST(SensorScheduler, Schedule)
+{
+  SensorScheduler scheduler;
+  EXPECT_EQ(0u, scheduler.Size());
+  EXPECT_FALSE(scheduler.Due(100s));
+  EXPECT_EQ(std::chrono::steady_clock::duration::max(), scheduler.NextTime());
+
+  scheduler.Schedule(1, 30ms);
+  scheduler.Schedule(2, 10ms);
+  scheduler.Schedule(3, 20ms);
+  EXPECT_EQ(3u, scheduler.Size());
+  EXPECT_EQ(10ms, scheduler.NextTime());
+  EXPECT_FALSE(scheduler.Due(9ms));
+  EXPECT_TRUE(scheduler.Due(10ms));
+
+  // Rescheduling replaces the previous time
+  scheduler.Schedule(2, 40ms);
+  EXPECT_EQ(3u, scheduler.Size());
+  EXPECT_EQ(20ms, scheduler.NextTime());
+
+  std::vector<Entity> due;
+  scheduler.TakeDue(30ms, due);
+  EXPECT_EQ(std::vector<Entity>({3, 1}), due);
+  EXPECT_EQ(1u, scheduler.Size());
+
+  scheduler.Remove(2);
+  EXPECT_EQ(0u, scheduler.Size());
+  EXPECT_FALSE(scheduler.Due(100s));
+  scheduler.TakeDue(100s, due);
+  EXPECT_TRUE(due.empty());
+
+  // Sensors which weren't updated wait for one period, unlimited ones for
+  // the next step
+  scheduler.Reschedule(1, 1s, 900ms, 10.0);
+  scheduler.Reschedule(2, 1s, 1200ms, 10.0);
+  scheduler.Reschedule(3, 1s, 1s, 0.0);
+  scheduler.TakeDue(1s, due);
+  EXPECT_TRUE(due.empty());
+  scheduler.TakeDue(1001ms, due);
+  EXPECT_EQ(std::vector<Entity>({3}), due);
+  scheduler.TakeDue(1100ms, due);
+  EXPECT_EQ(std::vector<Entity>({1}), due);
+  scheduler.TakeDue(1200ms, due);
+  EXPECT_EQ(std::vector<Entity>({2}), due);
+}
+
+/////////////////////////////////////////////////
+TEST(SensorScheduler, UpdateDue)
+{
+  std::unordered_map<Entity, std::unique_ptr<FakeSensor>> sensors;
+  sensors[1] = std::make_unique<FakeSensor>(50.0);
+  sensors[2] = std::make_unique<FakeSensor>(100.0);
+
+  SensorScheduler scheduler;
+  for (const auto &it : sensors)
+    scheduler.Schedule(it.first, it.second->NextDataUpdateTime());
+
+  // 1 kHz steps for one second
+  int prepared{0};
+  int wakeups{0};
+  for (int i = 0; i < 1000; ++i)
+  {
+    if (scheduler.UpdateDue<FakeSensor>(std::chrono::milliseconds(i),
+        sensors, [&]{++prepared;}))
+    {
+      ++wakeups;
+    }
+  }
+  EXPECT_EQ(50, sensors[1]->updates);
+  EXPECT_EQ(100, sensors[2]->updates);
+  EXPECT_EQ(100, wakeups);
+  EXPECT_EQ(100, prepared);
+
+  // Sensors without subscribers don't trigger updates
+  sensors[1]->connected = false;
+  sensors[2]->connected = false;
+  prepared = 0;
+  for (int i = 1000; i < 2000; ++i)
+  {
+    scheduler.UpdateDue<FakeSensor>(std::chrono::milliseconds(i), sensors,
+        [&]{++prepared;});
+  }
+  EXPECT_EQ(0, prepared);
+  EXPECT_EQ(50, sensors[1]->updates);
+
+  // Removed sensors are dropped
+  sensors.erase(2);
+  sensors[1]->connected = true;
+  for (int i = 2000; i < 3000; ++i)
+  {
+    scheduler.UpdateDue<FakeSensor>(std::chrono::milliseconds(i), sensors,
+        [&]{++prepared;});
+  }
+  EXPECT_EQ(100, sensors[1]->updates);
+  EXPECT_EQ(50, prepared);
+  EXPECT_EQ(1u, scheduler.Size());
+}
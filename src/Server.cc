@@ -15,9 +15,14 @@
  *
 */
 
+#include <fstream>
+#include <iterator>
+#include <memory>
 #include <numeric>
 
+#include <ignition/common/Filesystem.hh>
 #include <ignition/common/SystemPaths.hh>
+#include <ignition/common/Util.hh>
 #include <ignition/fuel_tools/Interface.hh>
 #include <ignition/fuel_tools/ClientConfig.hh>
 #include <sdf/Root.hh>
@@ -25,10 +30,12 @@
 
 #include "ignition/gazebo/config.hh"
 #include "ignition/gazebo/Server.hh"
+#include "ignition/gazebo/TraceRecorder.hh"
 #include "ignition/gazebo/Util.hh"
 
 #include "ServerPrivate.hh"
 #include "SimulationRunner.hh"
+#include "WorldCache.hh"
 
 using namespace ignition;
 using namespace gazebo;
@@ -57,6 +64,17 @@ Server::Server(const ServerConfig &_config)
 {
   this->dataPtr->config = _config;
 
+  // Record a trace from the start, so loading the world is traced too
+  this->dataPtr->traceFile = _config.TraceFile();
+  if (this->dataPtr->traceFile.empty())
+    common::env(kTraceFileEnv, this->dataPtr->traceFile);
+  if (!this->dataPtr->traceFile.empty())
+  {
+    ignmsg << "Recording a trace to [" << this->dataPtr->traceFile << "]"
+           << std::endl;
+    TraceRecorder::Instance().Start();
+  }
+
   // Configure the fuel client
   fuel_tools::ClientConfig config;
   if (!_config.ResourceCache().empty())
@@ -95,6 +113,7 @@ Server::Server(const ServerConfig &_config)
         msg += "File path [" + _config.SdfFile() + "].\n";
       }
       ignmsg <<  msg;
+      this->dataPtr->PrefetchResources(_config.SdfString());
       errors = this->dataPtr->sdfRoot.LoadSdfString(_config.SdfString());
       break;
     }
@@ -113,12 +132,53 @@ Server::Server(const ServerConfig &_config)
 
       ignmsg << "Loading SDF world file[" << filePath << "].\n";
 
+      // Recording resources relies on the file each model was loaded from,
+      // which a cached world doesn't keep
+      std::unique_ptr<WorldCache> worldCache;
+      if (!_config.WorldCachePath().empty() && !_config.LogRecordResources())
+      {
+        filePath = common::absPath(filePath);
+        worldCache = std::make_unique<WorldCache>(_config.WorldCachePath());
+
+        std::string cachedSdf;
+        if (worldCache->Load(filePath, cachedSdf, this->dataPtr->fuelUriMap))
+        {
+          errors = this->dataPtr->sdfRoot.LoadSdfString(cachedSdf);
+          if (errors.empty())
+          {
+            ignmsg << "Loaded world from cache ["
+                   << worldCache->EntryPath(filePath) << "].\n";
+            break;
+          }
+
+          ignwarn << "Failed to load cached world, loading [" << filePath
+                  << "] instead.\n";
+          errors.clear();
+          this->dataPtr->sdfRoot = sdf::Root();
+          this->dataPtr->fuelUriMap.clear();
+        }
+      }
+
+      // Download all Fuel resources at once, instead of one by one as the
+      // parser reaches them
+      {
+        std::ifstream worldFile(filePath);
+        this->dataPtr->PrefetchResources(std::string(
+            (std::istreambuf_iterator<char>(worldFile)),
+            std::istreambuf_iterator<char>()));
+      }
+
       // \todo(nkoenig) Async resource download.
       // This call can block for a long period of time while
       // resources are downloaded. Blocking here causes the GUI to block with
       // a black screen (search for "Async resource download" in
       // 'src/gui_main.cc'.
       errors = this->dataPtr->sdfRoot.Load(filePath);
+      if (errors.empty() && worldCache)
+      {
+        worldCache->Save(filePath, this->dataPtr->sdfRoot,
+            this->dataPtr->fuelUriMap);
+      }
       break;
     }
 
@@ -156,7 +216,8 @@ Server::Server(const ServerConfig &_config)
   }
 
   // Establish publishers and subscribers.
-  this->dataPtr->SetupTransport();
+  if (!_config.BatchMode())
+    this->dataPtr->SetupTransport();
 }
 
 /////////////////////////////////////////////////
@@ -16,6 +16,8 @@
 */
 #include "ignition/gazebo/ServerConfig.hh"
 
+#include <algorithm>
+
 #include <tinyxml2.h>
 
 #include <ignition/common/Console.hh>
@@ -271,9 +273,31 @@ class ignition::gazebo::ServerConfigPrivate
             logRecordPath(_cfg->logRecordPath),
             logRecordPeriod(_cfg->logRecordPeriod),
             logPlaybackPath(_cfg->logPlaybackPath),
+            logPlaybackBatchToSensors(_cfg->logPlaybackBatchToSensors),
             logRecordResources(_cfg->logRecordResources),
             logRecordCompressPath(_cfg->logRecordCompressPath),
             resourceCache(_cfg->resourceCache),
+            worldCachePath(_cfg->worldCachePath),
+            worldCopies(_cfg->worldCopies),
+            systemTimingPeriod(_cfg->systemTimingPeriod),
+            statsPublishPeriod(_cfg->statsPublishPeriod),
+            clockPublishPeriod(_cfg->clockPublishPeriod),
+            stepBudget(_cfg->stepBudget),
+            stepBudgetSkippable(_cfg->stepBudgetSkippable),
+            rewindWindow(_cfg->rewindWindow),
+            rewindBufferBytes(_cfg->rewindBufferBytes),
+            pacingSpinTime(_cfg->pacingSpinTime),
+            pacingCpu(_cfg->pacingCpu),
+            simulationThreadCpus(_cfg->simulationThreadCpus),
+            workerThreadCpus(_cfg->workerThreadCpus),
+            numaNodes(_cfg->numaNodes),
+            traceFile(_cfg->traceFile),
+            batchMode(_cfg->batchMode),
+            lockstepChannel(_cfg->lockstepChannel),
+            lockstepObservations(_cfg->lockstepObservations),
+            binaryStateSerialization(_cfg->binaryStateSerialization),
+            deterministic(_cfg->deterministic),
+            stateHashPeriod(_cfg->stateHashPeriod),
             physicsEngine(_cfg->physicsEngine),
             renderEngineServer(_cfg->renderEngineServer),
             renderEngineGui(_cfg->renderEngineGui),
@@ -308,6 +332,9 @@ class ignition::gazebo::ServerConfigPrivate
   /// \brief Path to recorded states to play back using logging system
   public: std::string logPlaybackPath = "";
 
+  /// \brief Only apply played back state when rendering sensors are due
+  public: bool logPlaybackBatchToSensors{false};
+
   /// \brief Record meshes and material files
   public: bool logRecordResources{false};
 
@@ -318,6 +345,70 @@ class ignition::gazebo::ServerConfigPrivate
   /// from fuel.gazebosim.org, should be stored.
   public: std::string resourceCache = "";
 
+  /// \brief Directory where resolved worlds are cached, empty to disable.
+  public: std::string worldCachePath = "";
+
+  /// \brief Number of copies of each world.
+  public: unsigned int worldCopies{1u};
+
+  /// \brief Period at which system timings are published, zero to disable.
+  public: std::chrono::steady_clock::duration systemTimingPeriod{0};
+
+  /// \brief Minimum time between world statistics messages.
+  public: std::chrono::steady_clock::duration statsPublishPeriod{
+      std::chrono::milliseconds(100)};
+
+  /// \brief Minimum time between clock messages.
+  public: std::chrono::steady_clock::duration clockPublishPeriod{0};
+
+  /// \brief Wall time budget of each step, zero to disable.
+  public: std::chrono::steady_clock::duration stepBudget{0};
+
+  /// \brief Systems whose PostUpdate may be skipped on overrunning steps.
+  public: std::vector<std::string> stepBudgetSkippable;
+
+  /// \brief Sim time kept for rewinding, zero to disable.
+  public: std::chrono::steady_clock::duration rewindWindow{0};
+
+  /// \brief Memory limit of the rewind buffer.
+  public: std::size_t rewindBufferBytes{64u << 20};
+
+  /// \brief Time spent busy waiting before each step, zero to only sleep.
+  public: std::chrono::steady_clock::duration pacingSpinTime{0};
+
+  /// \brief CPU the simulation thread is pinned to, -1 for none.
+  public: int pacingCpu{-1};
+
+  /// \brief CPUs the simulation thread is restricted to.
+  public: std::vector<unsigned int> simulationThreadCpus;
+
+  /// \brief CPUs the worker threads are restricted to.
+  public: std::vector<unsigned int> workerThreadCpus;
+
+  /// \brief NUMA nodes worlds are partitioned across.
+  public: std::vector<unsigned int> numaNodes;
+
+  /// \brief File the trace is written to, empty to not trace.
+  public: std::string traceFile;
+
+  /// \brief Whether to run without transport or pacing.
+  public: bool batchMode{false};
+
+  /// \brief Name of the lockstep channel, empty to disable.
+  public: std::string lockstepChannel;
+
+  /// \brief Component types sent to the lockstep controller.
+  public: std::vector<ComponentTypeId> lockstepObservations;
+
+  /// \brief Whether states hold components in binary form.
+  public: bool binaryStateSerialization{false};
+
+  /// \brief Whether parallel work is reproducible.
+  public: bool deterministic{false};
+
+  /// \brief Iterations between state hashes, zero to disable.
+  public: unsigned int stateHashPeriod{0u};
+
   /// \brief File containing physics engine plugin. If empty, DART will be used.
   public: std::string physicsEngine = "";
 
@@ -527,6 +618,18 @@ void ServerConfig::SetLogPlaybackPath(const std::string &_playbackPath)
   this->dataPtr->logPlaybackPath = _playbackPath;
 }
 
+/////////////////////////////////////////////////
+bool ServerConfig::LogPlaybackBatchToSensors() const
+{
+  return this->dataPtr->logPlaybackBatchToSensors;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetLogPlaybackBatchToSensors(bool _batch)
+{
+  this->dataPtr->logPlaybackBatchToSensors = _batch;
+}
+
 /////////////////////////////////////////////////
 bool ServerConfig::LogRecordResources() const
 {
@@ -576,6 +679,268 @@ void ServerConfig::SetResourceCache(const std::string &_path)
   this->dataPtr->resourceCache = _path;
 }
 
+/////////////////////////////////////////////////
+const std::string &ServerConfig::WorldCachePath() const
+{
+  return this->dataPtr->worldCachePath;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetWorldCachePath(const std::string &_path)
+{
+  this->dataPtr->worldCachePath = _path;
+}
+
+/////////////////////////////////////////////////
+unsigned int ServerConfig::WorldCopies() const
+{
+  return this->dataPtr->worldCopies;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetWorldCopies(unsigned int _copies)
+{
+  this->dataPtr->worldCopies = std::max(_copies, 1u);
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration ServerConfig::SystemTimingPeriod() const
+{
+  return this->dataPtr->systemTimingPeriod;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetSystemTimingPeriod(
+    const std::chrono::steady_clock::duration &_period)
+{
+  this->dataPtr->systemTimingPeriod = _period;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration ServerConfig::StatsPublishPeriod() const
+{
+  return this->dataPtr->statsPublishPeriod;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetStatsPublishPeriod(
+    const std::chrono::steady_clock::duration &_period)
+{
+  this->dataPtr->statsPublishPeriod = _period;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration ServerConfig::ClockPublishPeriod() const
+{
+  return this->dataPtr->clockPublishPeriod;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetClockPublishPeriod(
+    const std::chrono::steady_clock::duration &_period)
+{
+  this->dataPtr->clockPublishPeriod = _period;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration ServerConfig::StepBudget() const
+{
+  return this->dataPtr->stepBudget;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetStepBudget(
+    const std::chrono::steady_clock::duration &_budget)
+{
+  this->dataPtr->stepBudget = _budget;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::AddStepBudgetSkippableSystem(const std::string &_name)
+{
+  this->dataPtr->stepBudgetSkippable.push_back(_name);
+}
+
+/////////////////////////////////////////////////
+const std::vector<std::string> &ServerConfig::StepBudgetSkippableSystems()
+    const
+{
+  return this->dataPtr->stepBudgetSkippable;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration ServerConfig::RewindWindow() const
+{
+  return this->dataPtr->rewindWindow;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetRewindWindow(
+    const std::chrono::steady_clock::duration &_window)
+{
+  this->dataPtr->rewindWindow = _window;
+}
+
+/////////////////////////////////////////////////
+std::size_t ServerConfig::RewindBufferBytes() const
+{
+  return this->dataPtr->rewindBufferBytes;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetRewindBufferBytes(std::size_t _bytes)
+{
+  this->dataPtr->rewindBufferBytes = _bytes;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration ServerConfig::PacingSpinTime() const
+{
+  return this->dataPtr->pacingSpinTime;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetPacingSpinTime(
+    const std::chrono::steady_clock::duration &_spinTime)
+{
+  this->dataPtr->pacingSpinTime = _spinTime;
+}
+
+/////////////////////////////////////////////////
+int ServerConfig::PacingCpu() const
+{
+  return this->dataPtr->pacingCpu;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetPacingCpu(int _cpu)
+{
+  this->dataPtr->pacingCpu = _cpu;
+}
+
+/////////////////////////////////////////////////
+const std::vector<unsigned int> &ServerConfig::SimulationThreadCpus() const
+{
+  return this->dataPtr->simulationThreadCpus;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetSimulationThreadCpus(
+    const std::vector<unsigned int> &_cpus)
+{
+  this->dataPtr->simulationThreadCpus = _cpus;
+}
+
+/////////////////////////////////////////////////
+const std::vector<unsigned int> &ServerConfig::WorkerThreadCpus() const
+{
+  return this->dataPtr->workerThreadCpus;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetWorkerThreadCpus(const std::vector<unsigned int> &_cpus)
+{
+  this->dataPtr->workerThreadCpus = _cpus;
+}
+
+/////////////////////////////////////////////////
+const std::vector<unsigned int> &ServerConfig::NumaNodes() const
+{
+  return this->dataPtr->numaNodes;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetNumaNodes(const std::vector<unsigned int> &_nodes)
+{
+  this->dataPtr->numaNodes = _nodes;
+}
+
+/////////////////////////////////////////////////
+const std::string &ServerConfig::TraceFile() const
+{
+  return this->dataPtr->traceFile;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetTraceFile(const std::string &_file)
+{
+  this->dataPtr->traceFile = _file;
+}
+
+/////////////////////////////////////////////////
+bool ServerConfig::BatchMode() const
+{
+  return this->dataPtr->batchMode;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetBatchMode(bool _batchMode)
+{
+  this->dataPtr->batchMode = _batchMode;
+}
+
+/////////////////////////////////////////////////
+const std::string &ServerConfig::LockstepChannel() const
+{
+  return this->dataPtr->lockstepChannel;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetLockstepChannel(const std::string &_name)
+{
+  this->dataPtr->lockstepChannel = _name;
+}
+
+/////////////////////////////////////////////////
+const std::vector<ComponentTypeId> &ServerConfig::LockstepObservations()
+    const
+{
+  return this->dataPtr->lockstepObservations;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetLockstepObservations(
+    const std::vector<ComponentTypeId> &_types)
+{
+  this->dataPtr->lockstepObservations = _types;
+}
+
+/////////////////////////////////////////////////
+bool ServerConfig::BinaryStateSerialization() const
+{
+  return this->dataPtr->binaryStateSerialization;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetBinaryStateSerialization(bool _binary)
+{
+  this->dataPtr->binaryStateSerialization = _binary;
+}
+
+/////////////////////////////////////////////////
+bool ServerConfig::Deterministic() const
+{
+  return this->dataPtr->deterministic;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetDeterministic(bool _deterministic)
+{
+  this->dataPtr->deterministic = _deterministic;
+}
+
+/////////////////////////////////////////////////
+unsigned int ServerConfig::StateHashPeriod() const
+{
+  return this->dataPtr->stateHashPeriod;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetStateHashPeriod(unsigned int _iterations)
+{
+  this->dataPtr->stateHashPeriod = _iterations;
+}
+
 /////////////////////////////////////////////////
 const std::string &ServerConfig::PhysicsEngine() const
 {
@@ -649,6 +1014,15 @@ ServerConfig::LogPlaybackPlugin() const
     plugin.InsertContent(pathElem);
   }
 
+  if (this->LogPlaybackBatchToSensors())
+  {
+    sdf::ElementPtr batchElem = std::make_shared<sdf::Element>();
+    batchElem->SetName("batch_to_sensors");
+    batchElem->AddValue("bool", "false", false, "");
+    batchElem->Set<bool>(true);
+    plugin.InsertContent(batchElem);
+  }
+
   return ServerConfig::PluginInfo(entityName, entityType, plugin);
 }
 
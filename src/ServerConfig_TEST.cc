@@ -248,6 +248,37 @@ TEST(ServerConfig, GenerateRecordPlugin)
   EXPECT_EQ(plugin.Plugin().Name(), "ignition::gazebo::systems::LogRecord");
 }
 
+//////////////////////////////////////////////////
+TEST(ServerConfig, GeneratePlaybackPlugin)
+{
+  auto batchElem = [](const ServerConfig::PluginInfo &_plugin)
+  {
+    for (const auto &elem : _plugin.Plugin().Contents())
+    {
+      if (elem->GetName() == "batch_to_sensors")
+        return elem;
+    }
+    return sdf::ElementPtr();
+  };
+
+  ServerConfig config;
+  config.SetLogPlaybackPath("foo/bar");
+  EXPECT_FALSE(config.LogPlaybackBatchToSensors());
+
+  auto plugin = config.LogPlaybackPlugin();
+  EXPECT_EQ(plugin.Plugin().Name(), "ignition::gazebo::systems::LogPlayback");
+  EXPECT_EQ(nullptr, batchElem(plugin));
+
+  config.SetLogPlaybackBatchToSensors(true);
+  EXPECT_TRUE(config.LogPlaybackBatchToSensors());
+
+  // Copies keep the setting
+  ServerConfig copy(config);
+  auto elem = batchElem(copy.LogPlaybackPlugin());
+  ASSERT_NE(nullptr, elem);
+  EXPECT_TRUE(elem->Get<bool>());
+}
+
 //////////////////////////////////////////////////
 TEST(ServerConfig, SdfRoot)
 {
@@ -21,17 +21,30 @@
 #include <sdf/Root.hh>
 #include <sdf/World.hh>
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <unordered_set>
+
 #include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Profiler.hh>
 #include <ignition/common/Util.hh>
 
 #include <ignition/fuel_tools/Interface.hh>
 
+#include "ignition/gazebo/TraceRecorder.hh"
 #include "ignition/gazebo/Util.hh"
 #include "SimulationRunner.hh"
+#include "WorkStealingPool.hh"
 
 using namespace ignition;
 using namespace gazebo;
 
+/// \brief Largest number of Fuel resources downloaded at once.
+static constexpr std::size_t kMaxPrefetchThreads{16u};
+
 /// \brief This struct provides access to the record plugin SDF string
 struct LoggingPlugin
 {
@@ -102,6 +115,12 @@ ServerPrivate::~ServerPrivate()
   {
     this->stopThread->join();
   }
+
+  if (!this->traceFile.empty())
+  {
+    TraceRecorder::Instance().Stop();
+    TraceRecorder::Instance().WriteChromeTrace(this->traceFile);
+  }
 }
 
 //////////////////////////////////////////////////
@@ -278,20 +297,44 @@ void ServerPrivate::AddRecordPlugin(const ServerConfig &_config)
 //////////////////////////////////////////////////
 void ServerPrivate::CreateEntities()
 {
-  // Create a simulation runner for each world.
+  const unsigned int copies = this->config.WorldCopies();
+
+  // Create a simulation runner for each copy of each world.
   for (uint64_t worldIndex = 0; worldIndex <
        this->sdfRoot.WorldCount(); ++worldIndex)
   {
-    auto world = this->sdfRoot.WorldByIndex(worldIndex);
+    const sdf::World *original = this->sdfRoot.WorldByIndex(worldIndex);
 
+    for (unsigned int copy = 0; copy < copies; ++copy)
     {
-      std::lock_guard<std::mutex> lock(this->worldsMutex);
-      this->worldNames.push_back(world->Name());
+      const sdf::World *world = original;
+
+      // All copies but the first need their own name, so their topics and
+      // services don't collide. The copied DOM still points to the original
+      // SDF elements and frame graphs, which are only read from.
+      if (copy > 0u)
+      {
+        auto worldCopy = std::make_unique<sdf::World>(*original);
+        worldCopy->SetName(original->Name() + "_" + std::to_string(copy));
+        world = worldCopy.get();
+        this->worldCopies.push_back(std::move(worldCopy));
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(this->worldsMutex);
+        this->worldNames.push_back(world->Name());
+      }
+      auto runner = std::make_unique<SimulationRunner>(
+          world, this->systemLoader, this->config);
+      runner->SetFuelUriMap(this->fuelUriMap);
+      this->simRunners.push_back(std::move(runner));
     }
-    auto runner = std::make_unique<SimulationRunner>(
-        world, this->systemLoader, this->config);
-    runner->SetFuelUriMap(this->fuelUriMap);
-    this->simRunners.push_back(std::move(runner));
+  }
+
+  if (copies > 1u)
+  {
+    ignmsg << "Simulating [" << copies << "] copies of each world."
+           << std::endl;
   }
 }
 
@@ -378,6 +421,17 @@ void ServerPrivate::SetupTransport()
     ignerr << "Something went wrong, failed to advertise ["
            << serverControlService << "]" << std::endl;
   }
+
+  std::string traceService{"/gazebo/trace"};
+  if (this->node.Advertise(traceService, &ServerPrivate::TraceService, this))
+  {
+    ignmsg << "Trace service on [" << traceService << "]." << std::endl;
+  }
+  else
+  {
+    ignerr << "Something went wrong, failed to advertise [" << traceService
+           << "]" << std::endl;
+  }
 }
 
 //////////////////////////////////////////////////
@@ -395,6 +449,23 @@ bool ServerPrivate::WorldsService(msgs::StringMsg_V &_res)
   return true;
 }
 
+//////////////////////////////////////////////////
+bool ServerPrivate::TraceService(const msgs::StringMsg &_req,
+    msgs::Boolean &_res)
+{
+  auto &recorder = TraceRecorder::Instance();
+  if (_req.data().empty())
+  {
+    recorder.Start();
+    _res.set_data(true);
+    return true;
+  }
+
+  // Recording goes on, so the trace can be written again later
+  _res.set_data(recorder.WriteChromeTrace(_req.data()));
+  return true;
+}
+
 //////////////////////////////////////////////////
 bool ServerPrivate::ServerControlService(
   const msgs::ServerControl &_req, msgs::Boolean &_res)
@@ -542,8 +613,12 @@ bool ServerPrivate::ResourcePathsResolveService(
 //////////////////////////////////////////////////
 std::string ServerPrivate::FetchResource(const std::string &_uri)
 {
-  auto path =
-      fuel_tools::fetchResourceWithClient(_uri, *this->fuelClient.get());
+  // The same meshes and materials are usually requested many times
+  auto path = resolveResourceUri(_uri, [this](const std::string &_toFetch)
+  {
+    return fuel_tools::fetchResourceWithClient(_toFetch,
+        *this->fuelClient.get());
+  });
 
   if (!path.empty())
   {
@@ -556,6 +631,82 @@ std::string ServerPrivate::FetchResource(const std::string &_uri)
   return path;
 }
 
+//////////////////////////////////////////////////
+std::size_t ServerPrivate::PrefetchResources(const std::string &_sdfString)
+{
+  IGN_PROFILE("ServerPrivate::PrefetchResources");
+
+  auto uris = fuelResourceUris(_sdfString);
+  if (uris.empty())
+    return 0u;
+
+  const auto start = std::chrono::steady_clock::now();
+  std::unordered_set<std::string> seen(uris.begin(), uris.end());
+
+  // Downloads mostly wait on the network, so use more threads than cores,
+  // each with its own client.
+  const auto threadCount = static_cast<unsigned int>(std::clamp<std::size_t>(
+      uris.size(), 1u, kMaxPrefetchThreads));
+  WorkStealingPool pool(threadCount);
+  const auto clientConfig = this->fuelClient->Config();
+
+  std::size_t cached{0u};
+  while (!uris.empty())
+  {
+    std::vector<std::string> paths(uris.size());
+    pool.Run(uris.size(), [&](std::size_t _index)
+    {
+      fuel_tools::FuelClient client(clientConfig);
+      paths[_index] = fuel_tools::fetchResourceWithClient(uris[_index],
+          client);
+    });
+
+    // Models can include other Fuel models, which are fetched in the next
+    // round
+    std::vector<std::string> nested;
+    for (const auto &path : paths)
+    {
+      if (path.empty())
+        continue;
+      ++cached;
+
+      std::vector<std::string> sdfFiles;
+      if (common::isDirectory(path))
+      {
+        for (common::DirIter file(path); file != common::DirIter(); ++file)
+        {
+          const std::string filePath = *file;
+          if (common::isFile(filePath) && filePath.size() > 4u &&
+              filePath.compare(filePath.size() - 4u, 4u, ".sdf") == 0)
+          {
+            sdfFiles.push_back(filePath);
+          }
+        }
+      }
+
+      for (const auto &sdfFile : sdfFiles)
+      {
+        std::ifstream file(sdfFile);
+        const std::string content((std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>());
+        for (auto &uri : fuelResourceUris(content))
+        {
+          if (seen.insert(uri).second)
+            nested.push_back(std::move(uri));
+        }
+      }
+    }
+    uris = std::move(nested);
+  }
+
+  ignmsg << "Prefetched [" << cached << "] of [" << seen.size()
+         << "] Fuel resources in ["
+         << std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count()
+         << "] ms." << std::endl;
+  return cached;
+}
+
 //////////////////////////////////////////////////
 std::string ServerPrivate::FetchResourceUri(const common::URI &_uri)
 {
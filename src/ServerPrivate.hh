@@ -31,6 +31,7 @@
 #include <vector>
 
 #include <sdf/Root.hh>
+#include <sdf/World.hh>
 
 #include <ignition/common/SignalHandler.hh>
 #include <ignition/common/URI.hh>
@@ -93,6 +94,14 @@ namespace ignition
       /// \return Path to the downloaded resource, empty on error.
       public: std::string FetchResource(const std::string &_uri);
 
+      /// \brief Download the Fuel resources referenced by an SDF string in
+      /// parallel, along with those referenced by the downloaded models, so
+      /// that parsing it afterwards only hits the local cache.
+      /// \param[in] _sdfString SDF string, such as the contents of a world
+      /// file.
+      /// \return Number of resources which are in the local cache.
+      public: std::size_t PrefetchResources(const std::string &_sdfString);
+
       /// \brief Fetch a resource from Fuel using fuel-tools.
       /// \param[in] _uri The resource URI to fetch.
       /// \return Path to the downloaded resource, empty on error.
@@ -146,6 +155,16 @@ namespace ignition
       private: bool ServerControlService(
         const ignition::msgs::ServerControl &_req, msgs::Boolean &_res);
 
+      /// \brief Callback for the trace service. Starts recording a trace,
+      /// or writes the recorded one.
+      /// \param[in] _req Path the trace is written to, without stopping the
+      /// recording. If empty, discards the recorded trace and starts
+      /// recording a new one.
+      /// \param[out] _res Whether the request was successfully fullfilled.
+      /// \return True if successful.
+      private: bool TraceService(const ignition::msgs::StringMsg &_req,
+                   msgs::Boolean &_res);
+
       /// \brief A pool of worker threads.
       public: common::WorkerPool workerPool{2};
 
@@ -176,9 +195,20 @@ namespace ignition
       /// pointer to child nodes of the root
       public: sdf::Root sdfRoot;
 
+      /// \brief Renamed copies of the worlds in sdfRoot, used by all but the
+      /// first copy of each world. They share the DOM elements of the
+      /// original world.
+      /// \sa ServerConfig::WorldCopies
+      public: std::vector<std::unique_ptr<sdf::World>> worldCopies;
+
       /// \brief The server configuration.
       public: ServerConfig config;
 
+      /// \brief File the trace is written to when the server is destroyed,
+      /// empty if not tracing.
+      /// \sa ServerConfig::TraceFile
+      public: std::string traceFile;
+
       /// \brief Client used to download resources from Ignition Fuel.
       public: std::unique_ptr<fuel_tools::FuelClient> fuelClient = nullptr;
 
@@ -16,7 +16,9 @@
 */
 
 #include <gtest/gtest.h>
+#include <chrono>
 #include <csignal>
+#include <sstream>
 #include <vector>
 #include <ignition/common/StringUtils.hh>
 #include <ignition/common/Util.hh>
@@ -28,8 +30,10 @@
 #include "ignition/gazebo/components/AxisAlignedBox.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/LockstepClient.hh"
 #include "ignition/gazebo/System.hh"
 #include "ignition/gazebo/SystemLoader.hh"
 #include "ignition/gazebo/Server.hh"
@@ -1203,6 +1207,172 @@ TEST_P(ServerFixture, Stop)
   EXPECT_FALSE(server.Running());
 }
 
+/////////////////////////////////////////////////
+TEST_P(ServerFixture, WorldCopies)
+{
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+  EXPECT_EQ(1u, serverConfig.WorldCopies());
+  serverConfig.SetWorldCopies(0u);
+  EXPECT_EQ(1u, serverConfig.WorldCopies());
+  serverConfig.SetWorldCopies(3u);
+  EXPECT_EQ(3u, serverConfig.WorldCopies());
+
+  gazebo::Server server(serverConfig);
+  EXPECT_FALSE(server.IterationCount(3));
+
+  // The first copy keeps the name of the world
+  EXPECT_TRUE(server.HasEntity("default", 0));
+  EXPECT_FALSE(server.HasEntity("default_1", 0));
+  EXPECT_TRUE(server.HasEntity("default_1", 1));
+  EXPECT_TRUE(server.HasEntity("default_2", 2));
+
+  for (unsigned int i = 0; i < 3u; ++i)
+  {
+    EXPECT_EQ(*server.EntityCount(0), *server.EntityCount(i));
+    EXPECT_TRUE(server.HasEntity("box", i));
+    server.SetUpdatePeriod(1ns, i);
+  }
+
+  // All copies are stepped together
+  EXPECT_TRUE(server.RunOnce(false));
+  EXPECT_TRUE(server.Run(true, 10, false));
+  for (unsigned int i = 0; i < 3u; ++i)
+    EXPECT_EQ(11u, *server.IterationCount(i));
+
+  // Removing an entity from one copy doesn't affect the others
+  EXPECT_TRUE(server.RequestRemoveEntity("box", true, 1));
+  EXPECT_TRUE(server.RunOnce(false));
+  EXPECT_TRUE(server.HasEntity("box", 0));
+  EXPECT_FALSE(server.HasEntity("box", 1));
+  EXPECT_TRUE(server.HasEntity("box", 2));
+}
+
+/////////////////////////////////////////////////
+TEST_P(ServerFixture, BatchMode)
+{
+  const std::string sdf = R"(
+    <?xml version="1.0" ?>
+    <sdf version="1.6">
+      <world name="batch_world">
+        <physics name="1ms" type="ignored">
+          <max_step_size>0.001</max_step_size>
+          <real_time_factor>1.0</real_time_factor>
+        </physics>
+      </world>
+    </sdf>)";
+
+  ServerConfig serverConfig;
+  EXPECT_FALSE(serverConfig.BatchMode());
+  serverConfig.SetBatchMode(true);
+  EXPECT_TRUE(serverConfig.BatchMode());
+  serverConfig.SetSdfString(sdf);
+
+  gazebo::Server server(serverConfig);
+
+  // The world doesn't offer any service
+  transport::Node node;
+  std::vector<std::string> services;
+  node.ServiceList(services);
+  for (const auto &service : services)
+    EXPECT_EQ(std::string::npos, service.find("batch_world")) << service;
+
+  // Steps aren't paced to the real time factor, 1000 steps would take a
+  // second otherwise
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(server.Run(true, 1000, false));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+  EXPECT_EQ(1000u, *server.IterationCount());
+}
+
+/////////////////////////////////////////////////
+TEST_P(ServerFixture, IGN_UTILS_TEST_DISABLED_ON_WIN32(Lockstep))
+{
+  const std::string sdf = R"(
+    <?xml version="1.0" ?>
+    <sdf version="1.6">
+      <world name="lockstep_world">
+        <physics name="1ms" type="ignored">
+          <max_step_size>0.001</max_step_size>
+          <real_time_factor>1.0</real_time_factor>
+        </physics>
+        <model name="box">
+          <static>true</static>
+          <link name="link"/>
+        </model>
+      </world>
+    </sdf>)";
+
+  ServerConfig serverConfig;
+  EXPECT_TRUE(serverConfig.LockstepChannel().empty());
+  serverConfig.SetLockstepChannel("server_test");
+  serverConfig.SetLockstepObservations({components::Name::typeId});
+  serverConfig.SetSdfString(sdf);
+
+  // No server, no channel
+  EXPECT_EQ(nullptr, LockstepClient::Connect("server_test", "other_world"));
+
+  gazebo::Server server(serverConfig);
+  auto box = server.EntityByName("box");
+  ASSERT_TRUE(box.has_value());
+
+  auto client = LockstepClient::Connect("server_test", "lockstep_world");
+  ASSERT_NE(nullptr, client);
+
+  // Each step waits for actions
+  EXPECT_TRUE(server.Run(false, 2, false));
+
+  msgs::SerializedStateMap actions;
+  msgs::SerializedStepMap observation;
+  ASSERT_TRUE(client->Step(actions, observation));
+  EXPECT_EQ(1u, observation.stats().iterations());
+  EXPECT_EQ(1000000, observation.stats().sim_time().nsec());
+  EXPECT_EQ(0, observation.state().entities().count(*box));
+
+  // Actions are applied before the step, and observed components which
+  // changed are sent back
+  std::ostringstream ostr;
+  components::Name("renamed").Serialize(ostr);
+  auto &entityMsg = (*actions.mutable_entities())[*box];
+  entityMsg.set_id(*box);
+  auto &compMsg = (*entityMsg.mutable_components())[components::Name::typeId];
+  compMsg.set_type(components::Name::typeId);
+  compMsg.set_component(ostr.str());
+
+  ASSERT_TRUE(client->Step(actions, observation));
+  EXPECT_EQ(2u, observation.stats().iterations());
+  ASSERT_EQ(1, observation.state().entities().count(*box));
+  const auto &observed = observation.state().entities().at(*box);
+  ASSERT_EQ(1, observed.components().count(components::Name::typeId));
+  components::Name name;
+  std::istringstream istr(
+      observed.components().at(components::Name::typeId).component());
+  name.Deserialize(istr);
+  EXPECT_EQ("renamed", name.Data());
+
+  // Nothing happens once the requested iterations ran
+  EXPECT_FALSE(client->Step({}, observation, std::chrono::milliseconds(50)));
+  EXPECT_EQ(2u, *server.IterationCount());
+
+  // The actions of the step which timed out are applied by the next run,
+  // and their late observation isn't mistaken for the next step's
+  while (server.Running())
+    IGN_SLEEP_MS(1);
+  EXPECT_TRUE(server.Run(false, 2, false));
+
+  std::ostringstream again;
+  components::Name("again").Serialize(again);
+  compMsg.set_component(again.str());
+  ASSERT_TRUE(client->Step(actions, observation));
+  EXPECT_EQ(4u, observation.stats().iterations());
+  ASSERT_EQ(1, observation.state().entities().count(*box));
+  std::istringstream againIstr(observation.state().entities().at(*box)
+      .components().at(components::Name::typeId).component());
+  name.Deserialize(againIstr);
+  EXPECT_EQ("again", name.Data());
+}
+
 // Run multiple times. We want to make sure that static globals don't cause
 // problems.
 INSTANTIATE_TEST_SUITE_P(ServerRepeat, ServerFixture, ::testing::Range(1, 2));
@@ -18,6 +18,7 @@
 #include "SimulationRunner.hh"
 
 #include <algorithm>
+#include <thread>
 
 #include <sdf/Root.hh>
 
@@ -33,6 +34,7 @@
 #include "ignition/gazebo/components/Recreate.hh"
 #include "ignition/gazebo/Events.hh"
 #include "ignition/gazebo/SdfEntityCreator.hh"
+#include "ignition/gazebo/TraceRecorder.hh"
 #include "ignition/gazebo/Util.hh"
 
 #include "network/NetworkManagerPrimary.hh"
@@ -43,6 +45,12 @@ using namespace gazebo;
 
 using StringSet = std::unordered_set<std::string>;
 
+/// \brief Maximum number of stats snapshots waiting to be published
+static constexpr std::size_t kMaxPendingStats{256};
+
+/// \brief Bytes available in each queue of a lockstep channel
+static constexpr std::size_t kLockstepCapacity{16u << 20};
+
 
 //////////////////////////////////////////////////
 SimulationRunner::SimulationRunner(const sdf::World *_world,
@@ -61,6 +69,65 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
   // Keep world name
   this->worldName = _world->Name();
 
+  // Distributed simulation is coordinated over transport
+  this->batchMode = _config.BatchMode();
+  if (this->batchMode && _config.UseDistributedSimulation())
+  {
+    ignwarn << "Batch mode isn't supported with distributed simulation, "
+            << "ignoring it." << std::endl;
+    this->batchMode = false;
+  }
+
+  if (!_config.LockstepChannel().empty())
+  {
+    if (_config.UseDistributedSimulation())
+    {
+      ignwarn << "Lockstep isn't supported with distributed simulation, "
+              << "ignoring it." << std::endl;
+    }
+    else
+    {
+      // Must match LockstepClient
+      const std::string prefix = "lockstep_" + _config.LockstepChannel() +
+          "_" + this->worldName;
+      this->lockstepActions = SharedMemoryChannel::Create(
+          prefix + "_actions", kLockstepCapacity);
+      this->lockstepObservations = SharedMemoryChannel::Create(
+          prefix + "_observations", kLockstepCapacity);
+      if (!this->lockstepActions || !this->lockstepObservations)
+      {
+        ignerr << "Failed to create lockstep channel [" << prefix
+               << "], stepping freely." << std::endl;
+        this->lockstepActions.reset();
+        this->lockstepObservations.reset();
+      }
+      else
+      {
+        this->lockstepTypes.insert(_config.LockstepObservations().begin(),
+            _config.LockstepObservations().end());
+        ignmsg << "World [" << this->worldName << "] steps in lockstep with "
+               << "channel [" << _config.LockstepChannel() << "]."
+               << std::endl;
+      }
+    }
+  }
+
+  // Copies of a world are stepped in parallel, so split the cores between
+  // them instead of letting each ECM use all of them.
+  if (_config.WorldCopies() > 1u)
+  {
+    this->entityCompMgr.SetMaxThreads(std::max(
+        std::thread::hardware_concurrency() / _config.WorldCopies(), 1u));
+  }
+
+  this->entityCompMgr.SetBinarySerialization(
+      _config.BinaryStateSerialization());
+  this->entityCompMgr.SetDeterministic(_config.Deterministic());
+
+  // Partition component storage before any entity is created, so all of
+  // it is placed on the nodes
+  this->entityCompMgr.SetNumaNodes(_config.NumaNodes());
+
   this->parametersRegistry = std::make_unique<
     ignition::transport::parameters::ParametersRegistry>(
       std::string{"world/"} + this->worldName);
@@ -106,7 +173,7 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
   // So to get a given RTF, our desired period is:
   //
   // period = step_size / RTF
-  if (this->desiredRtf < 1e-9)
+  if (this->desiredRtf < 1e-9 || this->batchMode)
   {
     this->updatePeriod = 0ms;
   }
@@ -138,7 +205,7 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
   // Create the system manager
   this->systemMgr = std::make_unique<SystemManager>(
       _systemLoader, &this->entityCompMgr, &this->eventMgr, validNs,
-      this->parametersRegistry.get());
+      this->parametersRegistry.get(), !this->batchMode);
 
   this->pauseConn = this->eventMgr.Connect<events::Pause>(
       std::bind(&SimulationRunner::SetPaused, this, std::placeholders::_1));
@@ -193,6 +260,11 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
   // Load the active levels
   this->levelMgr->UpdateLevelsState();
 
+  // All dynamic models need a performer so they can be assigned to the
+  // secondary which owns their region
+  if (this->networkMgr && this->networkMgr->Config().spatialPartitioning)
+    this->levelMgr->CreateDynamicModelPerformers();
+
   // Load any additional plugins from the Server Configuration
   this->LoadServerPlugins(this->serverConfig.Plugins());
 
@@ -204,11 +276,45 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
     ignmsg << "No systems loaded from SDF, loading defaults" << std::endl;
     bool isPlayback = !this->serverConfig.LogPlaybackPath().empty();
     auto plugins = gazebo::loadPluginInfo(isPlayback);
+
+    // Nobody listens to the broadcaster or sends commands in batch mode
+    if (this->batchMode)
+    {
+      plugins.remove_if([](const ServerConfig::PluginInfo &_plugin)
+      {
+        return _plugin.Filename().find("scene-broadcaster") !=
+            std::string::npos ||
+            _plugin.Filename().find("user-commands") != std::string::npos;
+      });
+    }
     this->LoadServerPlugins(plugins);
   }
 
   this->LoadLoggingPlugins(this->serverConfig);
 
+  this->stepBudget = this->serverConfig.StepBudget();
+
+  // Playback already seeks through the recorded log
+  if (this->serverConfig.RewindWindow() >
+      std::chrono::steady_clock::duration::zero() &&
+      this->serverConfig.LogPlaybackPath().empty())
+  {
+    this->rewindBuffer = std::make_unique<RewindBuffer>(
+        this->serverConfig.RewindWindow(),
+        this->serverConfig.RewindBufferBytes());
+  }
+  this->pacingSpinTime = this->serverConfig.PacingSpinTime();
+  this->statsPeriod = this->serverConfig.StatsPublishPeriod();
+  this->clockPeriod = this->serverConfig.ClockPublishPeriod();
+  this->stateHashPeriod = this->serverConfig.StateHashPeriod();
+
+  if (this->batchMode)
+  {
+    ignmsg << "World [" << _world->Name() << "] runs in batch mode, without "
+           << "transport or pacing." << std::endl;
+    return;
+  }
+
   // TODO(louise) Combine both messages into one.
   this->node->Advertise("control", &SimulationRunner::OnWorldControl, this);
   this->node->Advertise("control/state", &SimulationRunner::OnWorldControlState,
@@ -242,25 +348,59 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
 
   ignmsg << "Serving world SDF generation service on [" << opts.NameSpace()
          << "/" << genWorldSdfService << "]" << std::endl;
+
+  this->systemTimingPeriod = this->serverConfig.SystemTimingPeriod();
+  if (this->systemTimingPeriod > std::chrono::steady_clock::duration::zero())
+  {
+    std::string timingsTopic{"performance"};
+    this->systemTimingsPub =
+        this->node->Advertise<msgs::Param_V>(timingsTopic);
+
+    std::string timingsService{"performance/info"};
+    this->node->Advertise(timingsService,
+        &SimulationRunner::SystemTimingsService, this);
+
+    ignmsg << "Publishing system timings on [" << opts.NameSpace() << "/"
+           << timingsTopic << "] and serving them on [" << opts.NameSpace()
+           << "/" << timingsService << "]" << std::endl;
+  }
+
+  if (this->stateHashPeriod > 0u)
+  {
+    std::string stateHashTopic{"state_hash"};
+    this->stateHashPub =
+        this->node->Advertise<msgs::UInt64>(stateHashTopic);
+
+    ignmsg << "Publishing state hashes every [" << this->stateHashPeriod
+           << "] iterations on [" << opts.NameSpace() << "/"
+           << stateHashTopic << "]" << std::endl;
+  }
+
+  std::string memoryService{"memory/info"};
+  this->node->Advertise(memoryService, &SimulationRunner::MemoryService,
+      this);
+
+  ignmsg << "Serving memory usage on [" << opts.NameSpace() << "/"
+         << memoryService << "]" << std::endl;
 }
 
 //////////////////////////////////////////////////
 SimulationRunner::~SimulationRunner()
 {
+  this->StopStatsThread();
   this->StopWorkerThreads();
 }
 
 /////////////////////////////////////////////////
 void SimulationRunner::UpdateCurrentInfo()
 {
-  IGN_PROFILE("SimulationRunner::UpdateCurrentInfo");
+  IGN_GAZEBO_PROFILE("SimulationRunner::UpdateCurrentInfo");
 
   // Rewind
   if (this->requestedRewind)
   {
     igndbg << "Rewinding simulation back to time zero." << std::endl;
-    this->realTimes.clear();
-    this->simTimes.clear();
+    this->realTimeFactorWindow.Clear();
     this->realTimeFactor = 0;
 
     this->currentInfo.dt = -this->currentInfo.simTime;
@@ -268,6 +408,8 @@ void SimulationRunner::UpdateCurrentInfo()
     this->currentInfo.realTime = std::chrono::steady_clock::duration::zero();
     this->currentInfo.iterations = 0;
     this->realTimeWatch.Reset();
+    if (this->rewindBuffer)
+      this->rewindBuffer->Clear();
     if (!this->currentInfo.paused)
       this->realTimeWatch.Start();
 
@@ -282,8 +424,17 @@ void SimulationRunner::UpdateCurrentInfo()
     igndbg << "Seeking to " << std::chrono::duration_cast<std::chrono::seconds>(
         this->requestedSeek).count() << "s." << std::endl;
 
-    this->realTimes.clear();
-    this->simTimes.clear();
+    // Go back to the recorded state when possible, otherwise only time
+    // jumps
+    if (this->requestedSeek <= this->currentInfo.simTime &&
+        this->RewindTo(this->requestedSeek))
+    {
+      this->currentInfo.realTime = this->realTimeWatch.ElapsedRunTime();
+      this->requestedSeek = std::chrono::steady_clock::duration{-1};
+      return;
+    }
+
+    this->realTimeFactorWindow.Clear();
     this->realTimeFactor = 0;
 
     this->currentInfo.dt = this->requestedSeek - this->currentInfo.simTime;
@@ -300,39 +451,19 @@ void SimulationRunner::UpdateCurrentInfo()
   // Regular time flow
 
   // Store the real time and sim time only if not paused.
+  // The window only holds the most recent steps.
   if (this->realTimeWatch.Running())
   {
-    this->realTimes.push_back(this->realTimeWatch.ElapsedRunTime());
-    this->simTimes.push_back(this->currentInfo.simTime);
+    this->realTimeFactorWindow.Push(this->currentInfo.simTime,
+        this->realTimeWatch.ElapsedRunTime());
   }
 
-  // Maintain a window size of 20 for realtime and simtime.
-  if (this->realTimes.size() > 20)
-    this->realTimes.pop_front();
-  if (this->simTimes.size() > 20)
-    this->simTimes.pop_front();
-
-  // Compute the average sim and real times.
-  std::chrono::steady_clock::duration simAvg{0}, realAvg{0};
-  std::list<std::chrono::steady_clock::duration>::iterator simIter,
-    realIter;
-
-  simIter = ++(this->simTimes.begin());
-  realIter = ++(this->realTimes.begin());
-  while (simIter != this->simTimes.end() && realIter != this->realTimes.end())
-  {
-    simAvg += ((*simIter) - this->simTimes.front());
-    realAvg += ((*realIter) - this->realTimes.front());
-    ++simIter;
-    ++realIter;
-  }
-
-  // RTF, only compute this if the realTime count is greater than zero. The
-  // realtTime count could be zero if simulation was started paused.
-  if (realAvg.count() > 0)
+  // RTF, only compute this if real time has elapsed. It may not have if
+  // simulation was started paused.
+  if (this->realTimeFactorWindow.RealElapsed().count() > 0)
   {
     this->realTimeFactor = math::precision(
-          static_cast<double>(simAvg.count()) / realAvg.count(), 4);
+          this->realTimeFactorWindow.RealTimeFactor(), 4);
   }
 
   // Fill the current update info
@@ -386,15 +517,17 @@ void SimulationRunner::UpdatePhysicsParams()
     if (newRTF > 0.0)
     {
       this->desiredRtf = newRTF;
-      this->updatePeriod = std::chrono::nanoseconds(
-          static_cast<int>(this->stepSize.count() / this->desiredRtf));
+      if (!this->batchMode)
+      {
+        this->updatePeriod = std::chrono::nanoseconds(
+            static_cast<int>(this->stepSize.count() / this->desiredRtf));
+      }
       physicsComp->Data().SetRealTimeFactor(newRTF);
       updated = true;
     }
     if (updated)
     {
-      this->simTimes.clear();
-      this->realTimes.clear();
+      this->realTimeFactorWindow.Clear();
       // Set as OneTimeChange to make sure the update is not missed
       this->entityCompMgr.SetChanged(worldEntity, components::Physics::typeId,
           ComponentState::OneTimeChange);
@@ -406,55 +539,161 @@ void SimulationRunner::UpdatePhysicsParams()
 /////////////////////////////////////////////////
 void SimulationRunner::PublishStats()
 {
-  IGN_PROFILE("SimulationRunner::PublishStats");
+  const auto now = std::chrono::steady_clock::now();
+
+  // The GUI waits for statistics to acknowledge its pause and step requests
+  StatsSnapshot snapshot;
+  snapshot.stats = this->Stepping() ||
+      this->statsPaused != this->currentInfo.paused ||
+      now - this->statsPublished >= this->statsPeriod;
+  snapshot.clock = now - this->clockPublished >= this->clockPeriod;
+  if (!snapshot.stats && !snapshot.clock)
+    return;
+
+  IGN_GAZEBO_PROFILE("SimulationRunner::PublishStats");
 
-  // Create the world statistics message.
-  msgs::WorldStatistics msg;
-  msg.set_real_time_factor(this->realTimeFactor);
+  snapshot.info = this->currentInfo;
+  snapshot.realTimeFactor = this->realTimeFactor;
+  snapshot.stepping = this->Stepping();
+  snapshot.systemTime = std::chrono::system_clock::now();
 
-  auto realTimeSecNsec =
-    math::durationToSecNsec(this->currentInfo.realTime);
+  if (snapshot.stats)
+  {
+    this->statsPublished = now;
+    this->statsPaused = this->currentInfo.paused;
+  }
+  if (snapshot.clock)
+    this->clockPublished = now;
 
-  auto simTimeSecNsec =
-    math::durationToSecNsec(this->currentInfo.simTime);
+  bool queued{false};
+  {
+    std::lock_guard<std::mutex> lock(this->statsMutex);
+    if (this->statsThreadRunning)
+    {
+      // Drop snapshots rather than block the step if the helper falls behind
+      if (this->pendingStats.size() < kMaxPendingStats)
+        this->pendingStats.push_back(snapshot);
+      queued = true;
+    }
+  }
 
-  msg.mutable_real_time()->set_sec(realTimeSecNsec.first);
-  msg.mutable_real_time()->set_nsec(realTimeSecNsec.second);
+  if (queued)
+    this->statsCv.notify_one();
+  else
+    this->PublishSnapshot(snapshot);
+}
 
-  msg.mutable_sim_time()->set_sec(simTimeSecNsec.first);
-  msg.mutable_sim_time()->set_nsec(simTimeSecNsec.second);
+/////////////////////////////////////////////////
+void SimulationRunner::PublishSnapshot(const StatsSnapshot &_snapshot)
+{
+  IGN_GAZEBO_PROFILE("SimulationRunner::PublishSnapshot");
 
-  msg.set_iterations(this->currentInfo.iterations);
+  auto hasConnections = [](const transport::Node::Publisher &_pub)
+  {
+    return _pub.Valid() && _pub.HasConnections();
+  };
 
-  msg.set_paused(this->currentInfo.paused);
+  auto realTimeSecNsec = math::durationToSecNsec(_snapshot.info.realTime);
+  auto simTimeSecNsec = math::durationToSecNsec(_snapshot.info.simTime);
 
-  if (this->Stepping())
+  if (_snapshot.stats &&
+      (hasConnections(this->statsPub) || hasConnections(this->rootStatsPub)))
   {
-    auto headerData = msg.mutable_header()->add_data();
-    headerData->set_key("step");
+    // Create the world statistics message.
+    msgs::WorldStatistics msg;
+    msg.set_real_time_factor(_snapshot.realTimeFactor);
+
+    msg.mutable_real_time()->set_sec(realTimeSecNsec.first);
+    msg.mutable_real_time()->set_nsec(realTimeSecNsec.second);
+
+    msg.mutable_sim_time()->set_sec(simTimeSecNsec.first);
+    msg.mutable_sim_time()->set_nsec(simTimeSecNsec.second);
+
+    msg.set_iterations(_snapshot.info.iterations);
+
+    msg.set_paused(_snapshot.info.paused);
+
+    if (_snapshot.stepping)
+    {
+      auto headerData = msg.mutable_header()->add_data();
+      headerData->set_key("step");
+    }
+
+    this->statsPub.Publish(msg);
+
+    if (this->rootStatsPub.Valid())
+      this->rootStatsPub.Publish(msg);
   }
 
-  // Publish the stats message. The stats message is throttled.
-  this->statsPub.Publish(msg);
+  if (_snapshot.clock &&
+      (hasConnections(this->clockPub) || hasConnections(this->rootClockPub)))
+  {
+    auto systemTimeSecNsec = math::durationToSecNsec(
+        _snapshot.systemTime.time_since_epoch());
+
+    msgs::Clock clockMsg;
+    clockMsg.mutable_real()->set_sec(realTimeSecNsec.first);
+    clockMsg.mutable_real()->set_nsec(realTimeSecNsec.second);
+    clockMsg.mutable_sim()->set_sec(simTimeSecNsec.first);
+    clockMsg.mutable_sim()->set_nsec(simTimeSecNsec.second);
+    clockMsg.mutable_system()->set_sec(systemTimeSecNsec.first);
+    clockMsg.mutable_system()->set_nsec(systemTimeSecNsec.second);
+    this->clockPub.Publish(clockMsg);
+
+    // Only publish to root topic if no others are.
+    if (this->rootClockPub.Valid())
+      this->rootClockPub.Publish(clockMsg);
+  }
+}
 
-  if (this->rootStatsPub.Valid())
-    this->rootStatsPub.Publish(msg);
+/////////////////////////////////////////////////
+void SimulationRunner::StartStatsThread()
+{
+  std::lock_guard<std::mutex> lock(this->statsMutex);
+  if (this->statsThreadRunning)
+    return;
 
-  // Create and publish the clock message. The clock message is not
-  // throttled.
-  msgs::Clock clockMsg;
-  clockMsg.mutable_real()->set_sec(realTimeSecNsec.first);
-  clockMsg.mutable_real()->set_nsec(realTimeSecNsec.second);
-  clockMsg.mutable_sim()->set_sec(simTimeSecNsec.first);
-  clockMsg.mutable_sim()->set_nsec(simTimeSecNsec.second);
-  clockMsg.mutable_system()->set_sec(IGN_SYSTEM_TIME_S());
-  clockMsg.mutable_system()->set_nsec(
-      IGN_SYSTEM_TIME_NS() - IGN_SYSTEM_TIME_S() * IGN_SEC_TO_NANO);
-  this->clockPub.Publish(clockMsg);
+  this->statsThreadRunning = true;
+  this->statsThread = std::thread(&SimulationRunner::RunStatsThread, this);
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::StopStatsThread()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->statsMutex);
+    this->statsThreadRunning = false;
+  }
+  this->statsCv.notify_one();
+
+  if (this->statsThread.joinable())
+    this->statsThread.join();
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::RunStatsThread()
+{
+  setCurrentThreadName("gz-stats");
+
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(this->statsMutex);
+      this->statsCv.wait(lock, [this]
+      {
+        return !this->pendingStats.empty() || !this->statsThreadRunning;
+      });
+
+      // Pending snapshots are published before stopping
+      if (this->pendingStats.empty())
+        return;
+      std::swap(this->pendingStats, this->publishingStats);
+    }
 
-  // Only publish to root topic if no others are.
-  if (this->rootClockPub.Valid())
-    this->rootClockPub.Publish(clockMsg);
+    for (const auto &snapshot : this->publishingStats)
+      this->PublishSnapshot(snapshot);
+    this->publishingStats.clear();
+  }
 }
 
 //////////////////////////////////////////////////
@@ -486,83 +725,513 @@ void SimulationRunner::ProcessSystemQueue()
   if (0 == pending)
     return;
 
-  // If additional systems are to be added, stop the existing threads.
-  this->StopWorkerThreads();
-
   this->systemMgr->ActivatePendingSystems();
 
-  auto threadCount = this->systemMgr->SystemsPostUpdate().size() + 1u;
+  this->systemTimings.Resize(SystemTimings::Phase::PRE_UPDATE,
+      this->systemMgr->SystemsPreUpdate().size());
+  this->systemTimings.Resize(SystemTimings::Phase::UPDATE,
+      this->systemMgr->SystemsUpdate().size());
+  this->systemTimings.Resize(SystemTimings::Phase::POST_UPDATE,
+      this->systemMgr->SystemsPostUpdate().size());
+
+  // Systems are named after their plugin, followed by their entity
+  const auto &skippable = this->serverConfig.StepBudgetSkippableSystems();
+  const auto &postUpdateNames = this->systemMgr->SystemsPostUpdateNames();
+  this->postUpdateSkippable.assign(postUpdateNames.size(), false);
+  for (std::size_t i = 0; i < postUpdateNames.size(); ++i)
+  {
+    const auto &name = postUpdateNames[i];
+    this->postUpdateSkippable[i] = std::any_of(skippable.begin(),
+        skippable.end(), [&](const std::string &_skip)
+        {
+          return name.compare(0, _skip.size(), _skip) == 0 &&
+              (name.size() == _skip.size() || name[_skip.size()] == ' ');
+        });
+  }
 
-  igndbg << "Creating PostUpdate worker threads: "
-    << threadCount << std::endl;
+  this->systemSleep.Build(this->systemMgr->SystemsPreUpdateSleep(),
+      this->systemMgr->SystemsUpdateSleep(),
+      this->systemMgr->SystemsPostUpdateSleep());
+
+  this->preUpdateScheduler.Build(this->systemMgr->SystemsPreUpdateAccess());
+  this->updateScheduler.Build(this->systemMgr->SystemsUpdateAccess());
+
+  // Size the pool to the largest number of systems that may run at once, or
+  // to the number of threads the ECM splits its work into, since the ECM
+  // shares the pool.
+  std::size_t widest = std::max<std::size_t>(
+      this->systemMgr->SystemsPostUpdate().size(),
+      this->entityCompMgr.MaxThreads());
+  for (const auto *scheduler : {&this->preUpdateScheduler,
+                                &this->updateScheduler})
+  {
+    for (const auto &stage : scheduler->Stages())
+      widest = std::max(widest, stage.size());
+  }
+  const auto threadCount = static_cast<unsigned int>(
+      std::clamp<std::size_t>(widest, 1u,
+          std::max(std::thread::hardware_concurrency(), 1u)));
 
-  this->postUpdateStartBarrier = std::make_unique<Barrier>(threadCount);
-  this->postUpdateStopBarrier = std::make_unique<Barrier>(threadCount);
+  if (nullptr == this->systemsPool ||
+      this->systemsPool->ThreadCount() != threadCount)
+  {
+    this->StopWorkerThreads();
+
+    igndbg << "Creating system worker pool with [" << threadCount
+           << "] threads." << std::endl;
+    // With NUMA nodes, threads are spread evenly across them and each is
+    // pinned to its node's CPUs, unless worker CPUs were given
+    const auto cpus = this->serverConfig.WorkerThreadCpus();
+    const auto &nodes = this->serverConfig.NumaNodes();
+    std::vector<unsigned int> threadNodes;
+    std::vector<std::vector<unsigned int>> threadCpus;
+    for (unsigned int i = 0u; !nodes.empty() && i < threadCount; ++i)
+    {
+      threadNodes.push_back(static_cast<unsigned int>(
+          i * nodes.size() / threadCount));
+      threadCpus.push_back(cpus.empty() ?
+          numaNodeCpus(nodes[threadNodes.back()]) : cpus);
+    }
+    this->systemsPool = std::make_shared<WorkStealingPool>(threadCount,
+        [cpus, threadCpus](unsigned int _index)
+        {
+          setCurrentThreadName("gz-worker-" + std::to_string(_index));
+          setCurrentThreadAffinity(
+              _index < threadCpus.size() ? threadCpus[_index] : cpus);
+        }, threadNodes);
+    this->entityCompMgr.SetWorkerPool(this->systemsPool);
+  }
+}
 
-  this->postUpdateThreadsRunning = true;
-  int id = 0;
+/////////////////////////////////////////////////
+void SimulationRunner::UpdateSystems()
+{
+  IGN_GAZEBO_PROFILE("SimulationRunner::UpdateSystems");
+  // Systems that declare their component access through
+  // ISystemComponentAccess and don't conflict with each other are run
+  // concurrently. All other systems run serially, in the order they were
+  // added. Stages with a single system are run on this thread.
+
+  // Each system only records into its own buffer, so concurrently running
+  // systems can time themselves
+  const bool budgeted =
+      this->stepBudget > std::chrono::steady_clock::duration::zero();
+  const bool timed = budgeted ||
+      this->systemTimingPeriod > std::chrono::steady_clock::duration::zero();
+  // In deterministic mode, each system is a task of its own, so the
+  // commands it records are applied in the order systems were added,
+  // whichever thread ran it
+  const bool deterministic = this->entityCompMgr.Deterministic();
+  auto run = [&](SystemTimings::Phase _phase, std::size_t _i,
+      const auto &_update)
+  {
+    const uint64_t prevKey = deterministic ?
+        EntityComponentManager::SwapTaskKey(_i + 1u) : 0u;
+    if (!timed)
+    {
+      _update();
+    }
+    else
+    {
+      const auto start = std::chrono::steady_clock::now();
+      _update();
+      this->systemTimings.Record(_phase, _i,
+          std::chrono::steady_clock::now() - start);
+    }
+    if (deterministic)
+      EntityComponentManager::SwapTaskKey(prevKey);
+  };
+
+  // Systems which are asleep aren't called at all in this step
+  this->systemSleep.Wake(this->currentInfo, this->entityCompMgr);
+
+  // Component observers see the changes of the previous step and of the
+  // ones between steps, such as state messages, before PreUpdate
+  this->entityCompMgr.NotifyComponentObservers();
 
-  for (auto &system : this->systemMgr->SystemsPostUpdate())
   {
-    igndbg << "Creating postupdate worker thread (" << id << ")" << std::endl;
+    IGN_GAZEBO_PROFILE("PreUpdate");
+    const auto &systems = this->systemMgr->SystemsPreUpdate();
+    auto preUpdate = [&](std::size_t _i)
+    {
+      if (this->systemSleep.Asleep(SystemTimings::Phase::PRE_UPDATE, _i))
+        return;
+      run(SystemTimings::Phase::PRE_UPDATE, _i, [&]
+      {
+        systems[_i]->PreUpdate(this->currentInfo, this->entityCompMgr);
+      });
+    };
+    if (!this->preUpdateScheduler.HasParallelStages())
+    {
+      for (std::size_t i = 0; i < systems.size(); ++i)
+        preUpdate(i);
+    }
+    else
+    {
+      this->RunSystemStages(this->preUpdateScheduler, preUpdate);
+    }
+
+    // Structural changes recorded by PreUpdate are seen by Update
+    this->entityCompMgr.ApplyCommandBuffers();
+    this->entityCompMgr.NotifyComponentObservers();
+  }
 
-    this->postUpdateThreads.push_back(std::thread([&, id]()
+  {
+    IGN_GAZEBO_PROFILE("Update");
+    const auto &systems = this->systemMgr->SystemsUpdate();
+    auto update = [&](std::size_t _i)
     {
-      std::stringstream ss;
-      ss << "PostUpdateThread: " << id;
-      IGN_PROFILE_THREAD_NAME(ss.str().c_str());
-      while (this->postUpdateThreadsRunning)
+      if (this->systemSleep.Asleep(SystemTimings::Phase::UPDATE, _i))
+        return;
+      run(SystemTimings::Phase::UPDATE, _i, [&]
       {
-        this->postUpdateStartBarrier->Wait();
-        if (this->postUpdateThreadsRunning)
+        systems[_i]->Update(this->currentInfo, this->entityCompMgr);
+      });
+    };
+    if (!this->updateScheduler.HasParallelStages())
+    {
+      for (std::size_t i = 0; i < systems.size(); ++i)
+        update(i);
+    }
+    else
+    {
+      this->RunSystemStages(this->updateScheduler, update);
+    }
+
+    this->entityCompMgr.ApplyCommandBuffers();
+    this->entityCompMgr.NotifyComponentObservers();
+  }
+
+  {
+    IGN_GAZEBO_PROFILE("PostUpdate");
+    const auto &systems = this->systemMgr->SystemsPostUpdate();
+    // If no systems have been added, then the pool will be uninitialized, so
+    // guard against that condition.
+    if (this->systemsPool && !systems.empty())
+    {
+      // Non-critical systems miss this step if the budget is already used up
+      const bool skip = budgeted &&
+          std::chrono::steady_clock::now() - this->prevUpdateRealTime >
+          this->stepBudget;
+
+      // Systems which are asleep are left out, so they don't take a thread
+      auto &awake = this->postUpdateAwake;
+      awake.clear();
+      for (std::size_t i = 0; i < systems.size(); ++i)
+      {
+        if (!this->systemSleep.Asleep(SystemTimings::Phase::POST_UPDATE, i))
+          awake.push_back(i);
+      }
+
+      if (!awake.empty())
+      {
+        this->entityCompMgr.LockAddingEntitiesToViews(true);
+        this->systemsPool->Run(awake.size(), [&](std::size_t _j)
         {
-          system->PostUpdate(this->currentInfo, this->entityCompMgr);
-        }
-        this->postUpdateStopBarrier->Wait();
+          const auto i = awake[_j];
+          if (skip && this->postUpdateSkippable[i])
+          {
+            ++this->skippedPostUpdates;
+            return;
+          }
+          run(SystemTimings::Phase::POST_UPDATE, i, [&]
+          {
+            systems[i]->PostUpdate(this->currentInfo, this->entityCompMgr);
+          });
+        });
+        this->entityCompMgr.LockAddingEntitiesToViews(false);
       }
-      igndbg << "Exiting postupdate worker thread ("
-        << id << ")" << std::endl;
-    }));
-    id++;
+    }
   }
+
+  this->systemSleep.Sleep(this->currentInfo);
 }
 
 /////////////////////////////////////////////////
-void SimulationRunner::UpdateSystems()
+void SimulationRunner::RunSystemStages(const SystemScheduler &_scheduler,
+    const std::function<void(std::size_t)> &_run)
 {
-  IGN_PROFILE("SimulationRunner::UpdateSystems");
-  // \todo(nkoenig)  Systems used to be updated in parallel using
-  // an common::WorkerPool. There is overhead associated with
-  // this, most notably the creation and destruction of WorkOrders (see
-  // WorkerPool.cc). We could turn on parallel updates in the future, and/or
-  // turn it on if there are sufficient systems. More testing is required.
+  for (const auto &stage : _scheduler.Stages())
+  {
+    if (stage.size() == 1u)
+    {
+      _run(stage.front());
+      continue;
+    }
 
+    // Systems in this stage may use the same views at the same time
+    this->entityCompMgr.LockAddingEntitiesToViews(true);
+    this->systemsPool->Run(stage.size(), [&](std::size_t _i)
+    {
+      _run(stage[_i]);
+    });
+    this->entityCompMgr.LockAddingEntitiesToViews(false);
+  }
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::ReceiveLockstepActions()
+{
+  IGN_GAZEBO_PROFILE("SimulationRunner::ReceiveLockstepActions");
+
+  // Sleep until the controller writes, waking up now and then to notice
+  // the server stopping
+  while (!this->lockstepActions->Read(this->lockstepBuffer))
   {
-    IGN_PROFILE("PreUpdate");
-    for (auto& system : this->systemMgr->SystemsPreUpdate())
-      system->PreUpdate(this->currentInfo, this->entityCompMgr);
+    if (!this->running)
+      return;
+    this->lockstepActions->Wait(std::chrono::milliseconds(100));
   }
 
+  msgs::SerializedStateMap actions;
+  if (!actions.ParseFromString(this->lockstepBuffer))
   {
-    IGN_PROFILE("Update");
-    for (auto& system : this->systemMgr->SystemsUpdate())
-      system->Update(this->currentInfo, this->entityCompMgr);
+    ignerr << "Failed to parse lockstep actions." << std::endl;
+    return;
   }
+  this->entityCompMgr.SetState(actions);
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::SendLockstepObservation()
+{
+  IGN_GAZEBO_PROFILE("SimulationRunner::SendLockstepObservation");
 
+  msgs::SerializedStepMap msg;
+  msg.mutable_stats()->set_iterations(this->currentInfo.iterations);
+  set(msg.mutable_stats()->mutable_sim_time(), this->currentInfo.simTime);
+  this->entityCompMgr.State(*msg.mutable_state(), {}, this->lockstepTypes,
+      false);
+
+  msg.SerializeToString(&this->lockstepBuffer);
+  if (!this->lockstepObservations->Write(this->lockstepBuffer))
   {
-    IGN_PROFILE("PostUpdate");
-    this->entityCompMgr.LockAddingEntitiesToViews(true);
-    // If no systems implementing PostUpdate have been added, then
-    // the barriers will be uninitialized, so guard against that condition.
-    if (this->postUpdateStartBarrier && this->postUpdateStopBarrier)
+    ignerr << "Lockstep observation of [" << this->lockstepBuffer.size()
+           << "] bytes doesn't fit in the channel, dropping it." << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::HashState()
+{
+  if (this->stateHashPeriod == 0u || this->currentInfo.paused ||
+      this->currentInfo.iterations % this->stateHashPeriod != 0u)
+  {
+    return;
+  }
+
+  IGN_GAZEBO_PROFILE("SimulationRunner::HashState");
+  this->stateHash = this->entityCompMgr.StateHash();
+
+  if (!this->stateHashPub.Valid())
+    return;
+
+  msgs::UInt64 msg;
+  set(msg.mutable_header()->mutable_stamp(), this->currentInfo.simTime);
+  auto *iterations = msg.mutable_header()->add_data();
+  iterations->set_key("iterations");
+  iterations->add_value(std::to_string(this->currentInfo.iterations));
+  msg.set_data(this->stateHash);
+  this->stateHashPub.Publish(msg);
+}
+
+/////////////////////////////////////////////////
+uint64_t SimulationRunner::StateHash() const
+{
+  return this->stateHash;
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::PublishSystemTimings()
+{
+  if (this->systemTimingPeriod <= std::chrono::steady_clock::duration::zero())
+    return;
+
+  const auto now = std::chrono::steady_clock::now();
+  if (now - this->systemTimingsPublished < this->systemTimingPeriod)
+    return;
+  this->systemTimingsPublished = now;
+
+  IGN_GAZEBO_PROFILE("SimulationRunner::PublishSystemTimings");
+
+  auto micros = [](std::chrono::steady_clock::duration _duration)
+  {
+    return std::chrono::duration<double, std::micro>(_duration).count();
+  };
+
+  // One param per system and phase, with times in microseconds
+  msgs::Param_V msg;
+  auto addPhase = [&](SystemTimings::Phase _phase, const std::string &_name,
+      const std::vector<std::string> &_systems)
+  {
+    for (std::size_t i = 0; i < _systems.size(); ++i)
     {
-      this->postUpdateStartBarrier->Wait();
-      this->postUpdateStopBarrier->Wait();
+      const auto stats = this->systemTimings.Compute(_phase, i);
+      if (0u == stats.samples)
+        continue;
+
+      auto &params = *msg.add_param()->mutable_params();
+      params["system"].set_type(msgs::Any::STRING);
+      params["system"].set_string_value(_systems[i]);
+      params["phase"].set_type(msgs::Any::STRING);
+      params["phase"].set_string_value(_name);
+      params["samples"].set_type(msgs::Any::INT32);
+      params["samples"].set_int_value(static_cast<int32_t>(stats.samples));
+
+      auto addTime = [&](const std::string &_key,
+          std::chrono::steady_clock::duration _value)
+      {
+        params[_key].set_type(msgs::Any::DOUBLE);
+        params[_key].set_double_value(micros(_value));
+      };
+      addTime("mean_us", stats.mean);
+      addTime("p50_us", stats.p50);
+      addTime("p90_us", stats.p90);
+      addTime("p99_us", stats.p99);
+      addTime("max_us", stats.max);
     }
-    this->entityCompMgr.LockAddingEntitiesToViews(false);
+  };
+  addPhase(SystemTimings::Phase::PRE_UPDATE, "pre_update",
+      this->systemMgr->SystemsPreUpdateNames());
+  addPhase(SystemTimings::Phase::UPDATE, "update",
+      this->systemMgr->SystemsUpdateNames());
+  addPhase(SystemTimings::Phase::POST_UPDATE, "post_update",
+      this->systemMgr->SystemsPostUpdateNames());
+
+  // Memory goes along, so it can be followed over long runs
+  msg.MergeFrom(this->MemoryUsage());
+
+  this->systemTimingsPub.Publish(msg);
+
+  std::lock_guard<std::mutex> lock(this->systemTimingsMutex);
+  this->systemTimingsMsg = std::move(msg);
+}
+
+/////////////////////////////////////////////////
+msgs::Param_V SimulationRunner::MemoryUsage() const
+{
+  IGN_GAZEBO_PROFILE("SimulationRunner::MemoryUsage");
+
+  msgs::Param_V msg;
+  auto addParam = [&msg](const std::string &_kind, std::size_t _bytes)
+  {
+    auto &params = *msg.add_param()->mutable_params();
+    params["memory"].set_type(msgs::Any::STRING);
+    params["memory"].set_string_value(_kind);
+
+    // Doubles, since int32 would overflow past 2 GB
+    params["bytes"].set_type(msgs::Any::DOUBLE);
+    params["bytes"].set_double_value(static_cast<double>(_bytes));
+    return &params;
+  };
+
+  auto factory = components::Factory::Instance();
+  for (const auto &type : this->entityCompMgr.ComponentMemory())
+  {
+    auto &params = *addParam("component", type.bytes);
+    params["component"].set_type(msgs::Any::STRING);
+    params["component"].set_string_value(factory->Name(type.typeId));
+    params["count"].set_type(msgs::Any::INT32);
+    params["count"].set_int_value(static_cast<int32_t>(type.count));
+    params["reserved_bytes"].set_type(msgs::Any::DOUBLE);
+    params["reserved_bytes"].set_double_value(
+        static_cast<double>(type.reservedBytes));
+  }
+
+  addParam("views", this->entityCompMgr.ViewsMemory());
+
+  const auto &systems = this->systemMgr->SystemsMemoryUsage();
+  const auto &names = this->systemMgr->SystemsMemoryUsageNames();
+  for (std::size_t i = 0; i < systems.size(); ++i)
+  {
+    auto &params = *addParam("system", systems[i]->MemoryUsage());
+    params["system"].set_type(msgs::Any::STRING);
+    params["system"].set_string_value(names[i]);
+  }
+
+  return msg;
+}
+
+/////////////////////////////////////////////////
+bool SimulationRunner::MemoryService(msgs::Param_V &_res)
+{
+  std::unique_lock<std::mutex> lock(this->memoryMutex);
+  this->memoryRequested = true;
+
+  // The simulation thread steps even while paused, but not before the
+  // server runs
+  if (!this->memoryCv.wait_for(lock, std::chrono::seconds(1),
+      [this] { return !this->memoryRequested; }))
+  {
+    return false;
+  }
+
+  _res = this->memoryMsg;
+  return true;
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::CheckStepBudget()
+{
+  if (this->stepBudget <= std::chrono::steady_clock::duration::zero())
+    return;
+
+  const auto now = std::chrono::steady_clock::now();
+  const auto stepTime = now - this->prevUpdateRealTime;
+  if (stepTime <= this->stepBudget)
+    return;
+
+  ++this->stepOverruns;
+
+  // Blame the system which took the longest during this step
+  std::string slowest;
+  std::chrono::steady_clock::duration slowestTime{0};
+  auto findSlowest = [&](SystemTimings::Phase _phase,
+      const std::vector<std::string> &_names)
+  {
+    for (std::size_t i = 0; i < _names.size(); ++i)
+    {
+      const auto last = this->systemTimings.Last(_phase, i);
+      if (last > slowestTime)
+      {
+        slowestTime = last;
+        slowest = _names[i];
+      }
+    }
+  };
+  findSlowest(SystemTimings::Phase::PRE_UPDATE,
+      this->systemMgr->SystemsPreUpdateNames());
+  findSlowest(SystemTimings::Phase::UPDATE,
+      this->systemMgr->SystemsUpdateNames());
+  findSlowest(SystemTimings::Phase::POST_UPDATE,
+      this->systemMgr->SystemsPostUpdateNames());
+
+  this->eventMgr.Emit<events::StepOverrun>(this->currentInfo.iterations,
+      stepTime, slowest);
+
+  if (now - this->stepOverrunLogged >= std::chrono::seconds(1))
+  {
+    this->stepOverrunLogged = now;
+    ignwarn << "Step [" << this->currentInfo.iterations << "] took ["
+            << std::chrono::duration<double, std::milli>(stepTime).count()
+            << "] ms, over the budget of ["
+            << std::chrono::duration<double, std::milli>(
+                   this->stepBudget).count()
+            << "] ms. Slowest system: [" << slowest << "], ["
+            << std::chrono::duration<double, std::milli>(slowestTime).count()
+            << "] ms. Total overruns: [" << this->stepOverruns << "]."
+            << std::endl;
   }
 }
 
+/////////////////////////////////////////////////
+bool SimulationRunner::SystemTimingsService(msgs::Param_V &_res)
+{
+  std::lock_guard<std::mutex> lock(this->systemTimingsMutex);
+  _res = this->systemTimingsMsg;
+  return true;
+}
+
 /////////////////////////////////////////////////
 void SimulationRunner::Stop()
 {
@@ -579,20 +1248,17 @@ void SimulationRunner::OnStop()
 /////////////////////////////////////////////////
 void SimulationRunner::StopWorkerThreads()
 {
-  this->postUpdateThreadsRunning = false;
-  if (this->postUpdateStartBarrier)
-  {
-    this->postUpdateStartBarrier->Cancel();
-  }
-  if (this->postUpdateStopBarrier)
-  {
-    this->postUpdateStopBarrier->Cancel();
-  }
-  for (auto &thread : this->postUpdateThreads)
-  {
-    thread.join();
-  }
-  this->postUpdateThreads.clear();
+  if (nullptr == this->systemsPool)
+    return;
+
+  auto stats = this->systemsPool->Stats();
+  igndbg << "System worker pool ran [" << stats.tasks << "] tasks in ["
+         << stats.batches << "] batches, with [" << stats.steals
+         << "] steals and a maximum queue depth of [" << stats.maxQueueDepth
+         << "]." << std::endl;
+
+  this->entityCompMgr.SetWorkerPool(nullptr);
+  this->systemsPool.reset();
 }
 
 /////////////////////////////////////////////////
@@ -624,6 +1290,21 @@ bool SimulationRunner::Run(const uint64_t _iterations)
       return true;
     }
   }
+  // Pin the simulation thread, so the busy wait and the step run on cores
+  // that aren't shared with other work, or close to the world's memory
+  setCurrentThreadName("gz-sim");
+  auto cpus = this->serverConfig.SimulationThreadCpus();
+  if (cpus.empty() && this->serverConfig.PacingCpu() >= 0)
+    cpus.push_back(static_cast<unsigned int>(this->serverConfig.PacingCpu()));
+  if (cpus.empty() && !this->serverConfig.NumaNodes().empty())
+    cpus = numaNodeCpus(this->serverConfig.NumaNodes().front());
+  if (!cpus.empty() && setCurrentThreadAffinity(cpus))
+  {
+    igndbg << "Restricted simulation thread of world ["
+           << this->worldName << "] to [" << cpus.size() << "] CPUs"
+           << std::endl;
+  }
+
   // Keep track of wall clock time. Only start the realTimeWatch if this
   // runner is not paused.
   if (!this->currentInfo.paused)
@@ -636,22 +1317,17 @@ bool SimulationRunner::Run(const uint64_t _iterations)
 
   this->running = true;
 
-  // Create the world statistics publisher.
-  if (!this->statsPub.Valid())
+  // Create the world statistics publisher. Messages are throttled by
+  // PublishStats instead of by transport, so that pause and play requests
+  // from the GUI are always acknowledged quickly (see
+  // https://github.com/ignitionrobotics/ign-gui/pull/306 and
+  // https://github.com/ignitionrobotics/ign-gazebo/pull/1163)
+  if (!this->statsPub.Valid() && !this->batchMode)
   {
-    transport::AdvertiseMessageOptions advertOpts;
-    // publish 10 world statistics msgs/second. A smaller number isn't used
-    // because the GUI listens to these msgs to receive confirmation that
-    // pause/play GUI requests have been processed by the server, so we want to
-    // make sure that GUI requests are acknowledged quickly (see
-    // https://github.com/ignitionrobotics/ign-gui/pull/306 and
-    // https://github.com/ignitionrobotics/ign-gazebo/pull/1163)
-    advertOpts.SetMsgsPerSec(10);
-    this->statsPub = this->node->Advertise<msgs::WorldStatistics>(
-        "stats", advertOpts);
+    this->statsPub = this->node->Advertise<msgs::WorldStatistics>("stats");
   }
 
-  if (!this->rootStatsPub.Valid())
+  if (!this->rootStatsPub.Valid() && !this->batchMode)
   {
     // Check for the existence of other publishers on `/stats`
     std::vector<transport::MessagePublisher> publishers;
@@ -680,11 +1356,11 @@ bool SimulationRunner::Run(const uint64_t _iterations)
   }
 
   // Create the clock publisher.
-  if (!this->clockPub.Valid())
+  if (!this->clockPub.Valid() && !this->batchMode)
     this->clockPub = this->node->Advertise<msgs::Clock>("clock");
 
   // Create the global clock publisher.
-  if (!this->rootClockPub.Valid())
+  if (!this->rootClockPub.Valid() && !this->batchMode)
   {
     // Check for the existence of other publishers on `/clock`
     std::vector<transport::MessagePublisher> publishers;
@@ -712,6 +1388,10 @@ bool SimulationRunner::Run(const uint64_t _iterations)
     }
   }
 
+  // Serialize and publish stats and clock away from the step loop
+  if (!this->batchMode)
+    this->StartStatsThread();
+
   // Keep number of iterations requested by caller
   uint64_t processedIterations{0};
 
@@ -720,36 +1400,57 @@ bool SimulationRunner::Run(const uint64_t _iterations)
   while (this->running && (_iterations == 0 ||
        processedIterations < _iterations))
   {
-    IGN_PROFILE("SimulationRunner::Run - Iteration");
+    IGN_GAZEBO_PROFILE("SimulationRunner::Run - Iteration");
 
     // Update the step size and desired rtf
     this->UpdatePhysicsParams();
 
-    // Compute the time to sleep in order to match, as closely as possible,
-    // the update period.
-    sleepTime = 0ns;
-    actualSleep = 0ns;
-
-    sleepTime = std::max(0ns, this->prevUpdateRealTime +
-        this->updatePeriod - std::chrono::steady_clock::now() -
-        this->sleepOffset);
-
-    // Only sleep if needed.
-    if (sleepTime > 0ns)
+    if (this->batchMode || this->lockstepActions)
+    {
+      // Step as fast as possible, or as fast as the lockstep controller
+      // sends actions
+    }
+    else if (this->pacingSpinTime > 0ns)
     {
-      IGN_PROFILE("Sleep");
-      // Get the current time, sleep for the duration needed to match the
-      // updatePeriod, and then record the actual time slept.
-      startTime = std::chrono::steady_clock::now();
-      std::this_thread::sleep_for(sleepTime);
-      actualSleep = std::chrono::steady_clock::now() - startTime;
+      // Sleep until shortly before the step is due, then busy wait for the
+      // rest, since sleeps overshoot by an unpredictable amount.
+      IGN_GAZEBO_PROFILE("Sleep");
+      const auto due = this->prevUpdateRealTime + this->updatePeriod;
+      sleepTime = due - this->pacingSpinTime - std::chrono::steady_clock::now();
+      if (sleepTime > 0ns)
+        std::this_thread::sleep_for(sleepTime);
+      while (std::chrono::steady_clock::now() < due)
+      {
+      }
     }
+    else
+    {
+      // Compute the time to sleep in order to match, as closely as possible,
+      // the update period.
+      sleepTime = 0ns;
+      actualSleep = 0ns;
 
-    // Exponentially average out the difference between expected sleep time
-    // and actual sleep time.
-    this->sleepOffset =
-      std::chrono::duration_cast<std::chrono::nanoseconds>(
-          (actualSleep - sleepTime) * 0.01 + this->sleepOffset * 0.99);
+      sleepTime = std::max(0ns, this->prevUpdateRealTime +
+          this->updatePeriod - std::chrono::steady_clock::now() -
+          this->sleepOffset);
+
+      // Only sleep if needed.
+      if (sleepTime > 0ns)
+      {
+        IGN_GAZEBO_PROFILE("Sleep");
+        // Get the current time, sleep for the duration needed to match the
+        // updatePeriod, and then record the actual time slept.
+        startTime = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(sleepTime);
+        actualSleep = std::chrono::steady_clock::now() - startTime;
+      }
+
+      // Exponentially average out the difference between expected sleep
+      // time and actual sleep time.
+      this->sleepOffset =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            (actualSleep - sleepTime) * 0.01 + this->sleepOffset * 0.99);
+    }
 
     // Update time information. This will update the iteration count, RTF,
     // and other values.
@@ -780,6 +1481,7 @@ bool SimulationRunner::Run(const uint64_t _iterations)
     }
   }
 
+  this->StopStatsThread();
   this->running = false;
 
   return true;
@@ -788,15 +1490,22 @@ bool SimulationRunner::Run(const uint64_t _iterations)
 /////////////////////////////////////////////////
 void SimulationRunner::Step(const UpdateInfo &_info)
 {
-  IGN_PROFILE("SimulationRunner::Step");
+  IGN_GAZEBO_PROFILE("SimulationRunner::Step");
   this->currentInfo = _info;
 
-  // Process new ECM state information, typically sent from the GUI after
-  // a change was made to the GUI's ECM.
-  this->ProcessNewWorldControlState();
+  // Nothing is received or published in batch mode
+  if (!this->batchMode)
+  {
+    // Process new ECM state information, typically sent from the GUI after
+    // a change was made to the GUI's ECM.
+    this->ProcessNewWorldControlState();
 
-  // Publish info
-  this->PublishStats();
+    // Publish info
+    this->PublishStats();
+  }
+
+  if (this->lockstepActions && !this->currentInfo.paused)
+    this->ReceiveLockstepActions();
 
   // Record when the update step starts.
   this->prevUpdateRealTime = std::chrono::steady_clock::now();
@@ -818,6 +1527,44 @@ void SimulationRunner::Step(const UpdateInfo &_info)
   // Update all the systems.
   this->UpdateSystems();
 
+  // Record the step before its changes are cleared
+  if (this->rewindBuffer && !this->currentInfo.paused)
+    this->rewindBuffer->Record(this->currentInfo, this->entityCompMgr);
+
+  if (this->lockstepObservations && !this->currentInfo.paused)
+    this->SendLockstepObservation();
+
+  this->HashState();
+
+  this->PublishSystemTimings();
+
+  if (this->memoryRequested)
+  {
+    auto msg = this->MemoryUsage();
+    {
+      std::lock_guard<std::mutex> lock(this->memoryMutex);
+      this->memoryMsg = std::move(msg);
+      this->memoryRequested = false;
+    }
+    this->memoryCv.notify_all();
+  }
+
+  if (this->worldSdfRequested)
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->worldSdfMutex);
+      Entity world =
+          this->entityCompMgr.EntityByComponents(components::World());
+      this->worldSdfUpdated = this->worldGenerator.Update(
+          this->entityCompMgr, world, this->fuelUriMap,
+          this->worldSdfRequest);
+      this->worldSdfRequested = false;
+    }
+    this->worldSdfCv.notify_all();
+  }
+
+  this->CheckStepBudget();
+
   if (!this->Paused() &&
        this->requestedRunToSimTime >
        std::chrono::steady_clock::duration::zero() &&
@@ -840,7 +1587,8 @@ void SimulationRunner::Step(const UpdateInfo &_info)
   }
 
   // Process world control messages.
-  this->ProcessMessages();
+  if (!this->batchMode)
+    this->ProcessMessages();
 
   // Clear all new entities
   this->entityCompMgr.ClearNewlyCreatedEntities();
@@ -857,6 +1605,10 @@ void SimulationRunner::Step(const UpdateInfo &_info)
   // Process components removals
   this->entityCompMgr.ClearRemovedComponents();
 
+  // Remove components nobody demands anymore. They're reported as removed
+  // in the next step.
+  this->entityCompMgr.RemoveUndemandedComponents();
+
   // Each network manager takes care of marking its components as unchanged
   if (!this->networkMgr)
     this->entityCompMgr.SetAllComponentsUnchanged();
@@ -1028,6 +1780,18 @@ size_t SimulationRunner::EntityCount() const
   return this->entityCompMgr.EntityCount();
 }
 
+/////////////////////////////////////////////////
+uint64_t SimulationRunner::StepOverruns() const
+{
+  return this->stepOverruns;
+}
+
+/////////////////////////////////////////////////
+uint64_t SimulationRunner::SkippedPostUpdates() const
+{
+  return this->skippedPostUpdates;
+}
+
 /////////////////////////////////////////////////
 size_t SimulationRunner::SystemCount() const
 {
@@ -1196,7 +1960,7 @@ bool SimulationRunner::OnPlaybackControl(const msgs::LogPlaybackControl &_req,
 /////////////////////////////////////////////////
 void SimulationRunner::ProcessMessages()
 {
-  IGN_PROFILE("SimulationRunner::ProcessMessages");
+  IGN_GAZEBO_PROFILE("SimulationRunner::ProcessMessages");
   std::lock_guard<std::mutex> lock(this->msgBufferMutex);
   this->ProcessWorldControl();
 }
@@ -1204,7 +1968,7 @@ void SimulationRunner::ProcessMessages()
 /////////////////////////////////////////////////
 void SimulationRunner::ProcessWorldControl()
 {
-  IGN_PROFILE("SimulationRunner::ProcessWorldControl");
+  IGN_GAZEBO_PROFILE("SimulationRunner::ProcessWorldControl");
 
   // assume no stepping unless WorldControl msgs say otherwise
   this->SetStepping(false);
@@ -1241,7 +2005,7 @@ void SimulationRunner::ProcessWorldControl()
 /////////////////////////////////////////////////
 void SimulationRunner::ProcessRecreateEntitiesRemove()
 {
-  IGN_PROFILE("SimulationRunner::ProcessRecreateEntitiesRemove");
+  IGN_GAZEBO_PROFILE("SimulationRunner::ProcessRecreateEntitiesRemove");
 
   // store the original entities to recreate and put in request to remove them
   this->entityCompMgr.EachNoCache<components::Model,
@@ -1259,7 +2023,7 @@ void SimulationRunner::ProcessRecreateEntitiesRemove()
 /////////////////////////////////////////////////
 void SimulationRunner::ProcessRecreateEntitiesCreate()
 {
-  IGN_PROFILE("SimulationRunner::ProcessRecreateEntitiesCreate");
+  IGN_GAZEBO_PROFILE("SimulationRunner::ProcessRecreateEntitiesCreate");
 
   // clone the original entities
   for (auto & ent : this->entitiesToRecreate)
@@ -1342,6 +2106,58 @@ const math::clock::duration &SimulationRunner::StepSize() const
   return this->stepSize;
 }
 
+/////////////////////////////////////////////////
+std::shared_ptr<const SimulationSnapshot> SimulationRunner::Snapshot() const
+{
+  IGN_GAZEBO_PROFILE("SimulationRunner::Snapshot");
+  auto snapshot = std::make_shared<SimulationSnapshot>();
+  snapshot->info = this->currentInfo;
+  snapshot->components = this->entityCompMgr.Snapshot();
+  return snapshot;
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::RestoreSnapshot(const SimulationSnapshot &_snapshot)
+{
+  IGN_GAZEBO_PROFILE("SimulationRunner::RestoreSnapshot");
+
+  // Time jumps as when seeking, but the iterations are restored too, so the
+  // rollout is numbered as the original run
+  this->realTimeFactorWindow.Clear();
+  this->realTimeFactor = 0;
+  this->currentInfo.dt = _snapshot.info.simTime - this->currentInfo.simTime;
+  this->currentInfo.simTime = _snapshot.info.simTime;
+  this->currentInfo.iterations = _snapshot.info.iterations;
+
+  this->entityCompMgr.RestoreSnapshot(_snapshot.components);
+  this->eventMgr.Emit<events::SnapshotRestored>();
+
+  // The recorded steps belong to another timeline
+  if (this->rewindBuffer)
+    this->rewindBuffer->Clear();
+}
+
+/////////////////////////////////////////////////
+bool SimulationRunner::RewindTo(std::chrono::steady_clock::duration _simTime)
+{
+  IGN_GAZEBO_PROFILE("SimulationRunner::RewindTo");
+  UpdateInfo info;
+  if (!this->rewindBuffer ||
+      !this->rewindBuffer->Restore(_simTime, this->entityCompMgr, info))
+  {
+    return false;
+  }
+
+  this->realTimeFactorWindow.Clear();
+  this->realTimeFactor = 0;
+  this->currentInfo.dt = info.simTime - this->currentInfo.simTime;
+  this->currentInfo.simTime = info.simTime;
+  this->currentInfo.iterations = info.iterations;
+
+  this->eventMgr.Emit<events::SnapshotRestored>();
+  return true;
+}
+
 /////////////////////////////////////////////////
 void SimulationRunner::SetStepSize(const math::clock::duration &_step)
 {
@@ -1432,17 +2248,34 @@ bool SimulationRunner::GuiInfoService(msgs::GUI &_res)
 bool SimulationRunner::GenerateWorldSdf(const msgs::SdfGeneratorConfig &_req,
                                         msgs::StringMsg &_res)
 {
-  // TODO(addisu) This is not thread-safe. Wait until it is safe to access the
-  // ECM.
-  Entity world = this->entityCompMgr.EntityByComponents(components::World());
-  std::optional<std::string> genString = sdf_generator::generateWorld(
-      this->entityCompMgr, world, this->fuelUriMap, _req);
-  if (genString.has_value())
+  std::lock_guard<std::mutex> serviceLock(this->worldSdfServiceMutex);
+  std::unique_lock<std::mutex> lock(this->worldSdfMutex);
+  this->worldSdfRequest = _req;
+  this->worldSdfRequested = true;
+
+  // The simulation thread updates the generator between steps, so the ECM
+  // isn't read while systems modify it. It steps even while paused, but not
+  // before the server runs or after it stops, in which case it's safe to
+  // update the generator from here.
+  while (this->worldSdfRequested && this->running)
   {
-    _res.set_data(*genString);
-    return true;
+    this->worldSdfCv.wait_for(lock, std::chrono::milliseconds(100));
   }
-  return false;
+
+  if (this->worldSdfRequested)
+  {
+    Entity world =
+        this->entityCompMgr.EntityByComponents(components::World());
+    this->worldSdfUpdated = this->worldGenerator.Update(
+        this->entityCompMgr, world, this->fuelUriMap, _req);
+    this->worldSdfRequested = false;
+  }
+
+  if (!this->worldSdfUpdated)
+    return false;
+
+  _res.set_data(this->worldGenerator.Text());
+  return true;
 }
 
 //////////////////////////////////////////////////
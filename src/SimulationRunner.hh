@@ -19,16 +19,20 @@
 
 #include <ignition/msgs/gui.pb.h>
 #include <ignition/msgs/log_playback_control.pb.h>
+#include <ignition/msgs/param_v.pb.h>
 #include <ignition/msgs/sdf_generator_config.pb.h>
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -37,7 +41,6 @@
 #include <sdf/World.hh>
 
 #include <ignition/common/Event.hh>
-#include <ignition/common/WorkerPool.hh>
 #include <ignition/math/Stopwatch.hh>
 #include <ignition/msgs.hh>
 #include <ignition/transport/Node.hh>
@@ -52,9 +55,16 @@
 #include "ignition/gazebo/Types.hh"
 
 #include "network/NetworkManager.hh"
+#include "network/SharedMemoryChannel.hh"
 #include "LevelManager.hh"
+#include "RealTimeFactorWindow.hh"
+#include "RewindBuffer.hh"
+#include "SdfGenerator.hh"
 #include "SystemManager.hh"
-#include "Barrier.hh"
+#include "SystemScheduler.hh"
+#include "SystemSleep.hh"
+#include "SystemTimings.hh"
+#include "WorkStealingPool.hh"
 #include "WorldControl.hh"
 
 using namespace std::chrono_literals;
@@ -68,6 +78,19 @@ namespace ignition
     // Forward declarations.
     class SimulationRunnerPrivate;
 
+    /// \brief In-memory copy of the state of a simulation, taken by
+    /// SimulationRunner::Snapshot and restored by
+    /// SimulationRunner::RestoreSnapshot.
+    struct SimulationSnapshot
+    {
+      /// \brief Simulation time and iteration count when the snapshot was
+      /// taken.
+      UpdateInfo info;
+
+      /// \brief All entities and components.
+      ComponentSnapshot components;
+    };
+
     class IGNITION_GAZEBO_VISIBLE SimulationRunner
     {
       /// \brief Constructor
@@ -87,7 +110,7 @@ namespace ignition
       /// \brief Internal method for handling stop event (to prevent recursion)
       private: void OnStop();
 
-      /// \brief Stop and join all post update worker threads
+      /// \brief Stop and join all system worker threads
       private: void StopWorkerThreads();
 
       /// \brief Run the simulationrunner.
@@ -133,9 +156,59 @@ namespace ignition
       /// \brief Update all the systems
       public: void UpdateSystems();
 
-      /// \brief Publish current world statistics.
+      /// \brief Run the stages of a scheduler. Systems in the same stage run
+      /// concurrently on the systems pool, stages run one after the other.
+      /// \param[in] _scheduler Scheduler holding the stages.
+      /// \param[in] _run Function that runs the system at the given index.
+      private: void RunSystemStages(const SystemScheduler &_scheduler,
+          const std::function<void(std::size_t)> &_run);
+
+      /// \brief Publish current world statistics and clock, if their
+      /// publish periods have elapsed. The messages are built and published
+      /// by the stats thread while Run is running, or right away otherwise.
+      /// \sa ServerConfig::StatsPublishPeriod
+      /// \sa ServerConfig::ClockPublishPeriod
       public: void PublishStats();
 
+      /// \brief State of the world to publish on the stats and clock topics,
+      /// captured by PublishStats.
+      private: struct StatsSnapshot
+      {
+        /// \brief Update info of the step.
+        UpdateInfo info;
+
+        /// \brief Real time factor.
+        double realTimeFactor{0.0};
+
+        /// \brief Whether simulation is being stepped.
+        bool stepping{false};
+
+        /// \brief System time when the snapshot was taken.
+        std::chrono::system_clock::time_point systemTime;
+
+        /// \brief Whether to publish world statistics.
+        bool stats{false};
+
+        /// \brief Whether to publish the clock.
+        bool clock{false};
+      };
+
+      /// \brief Build the stats and clock messages of a snapshot and publish
+      /// them on the topics which have subscribers.
+      /// \param[in] _snapshot State of the world.
+      private: void PublishSnapshot(const StatsSnapshot &_snapshot);
+
+      /// \brief Start the stats thread.
+      private: void StartStatsThread();
+
+      /// \brief Stop the stats thread, once it published all pending
+      /// snapshots.
+      private: void StopStatsThread();
+
+      /// \brief Body of the stats thread, which publishes snapshots queued
+      /// by PublishStats.
+      private: void RunStatsThread();
+
       /// \brief Load system plugin for a given entity.
       /// \param[in] _entity The plugins will be associated with this Entity
       /// \param[in] _plugin SDF Plugin to load
@@ -182,6 +255,17 @@ namespace ignition
       /// \return System count.
       public: size_t SystemCount() const;
 
+      /// \brief Number of steps which took longer than the step budget.
+      /// \return Overrun count.
+      /// \sa ServerConfig::SetStepBudget
+      public: uint64_t StepOverruns() const;
+
+      /// \brief Number of system PostUpdates which were skipped because the
+      /// step budget was used up.
+      /// \return Skipped PostUpdate count.
+      /// \sa ServerConfig::AddStepBudgetSkippableSystem
+      public: uint64_t SkippedPostUpdates() const;
+
       /// \brief Set the update period. The update period is the wall-clock
       /// time between updates of all systems. Note that even if systems
       /// are being updated, this doesn't mean sim time is increasing.
@@ -219,6 +303,14 @@ namespace ignition
       public: void SetRunToSimTime(
                   const std::chrono::steady_clock::duration &_time);
 
+      /// \brief Measure the memory held by each component type, by the
+      /// views and by the systems implementing ISystemMemoryUsage. Must be
+      /// called between steps.
+      /// \return One param per component type, one for the views and one per
+      /// system. Each has a "memory" key set to "component", "views" or
+      /// "system" and a "bytes" key.
+      public: msgs::Param_V MemoryUsage() const;
+
       /// \brief Get the EntityComponentManager
       /// \return Reference to the entity component manager.
       public: const EntityComponentManager &EntityCompMgr() const;
@@ -281,6 +373,44 @@ namespace ignition
       /// \param[in] _step Step size.
       public: void SetStepSize(const ignition::math::clock::duration &_step);
 
+      /// \brief Copy the state of the simulation into memory, so that it can
+      /// be restored later, for example to simulate ahead from the same
+      /// state several times. Must be called between steps, not while Run is
+      /// stepping on another thread.
+      /// \return Snapshot, which never changes, so it can be restored by
+      /// several runners at once.
+      /// \sa RestoreSnapshot
+      public: std::shared_ptr<const SimulationSnapshot> Snapshot() const;
+
+      /// \brief Restore a snapshot taken by this runner, or by another one
+      /// loaded from the same world, so that cloning a snapshot into a
+      /// second runner forks the simulation. Simulation time and iterations
+      /// go back to those of the snapshot, entities and components are
+      /// restored with EntityComponentManager::RestoreSnapshot, and the
+      /// events::SnapshotRestored event is emitted for systems to resync
+      /// their own state, such as the physics engine's. Must be called
+      /// between steps, not while Run is stepping on another thread.
+      /// \param[in] _snapshot Snapshot to restore.
+      public: void RestoreSnapshot(const SimulationSnapshot &_snapshot);
+
+      /// \brief Rewind the simulation to the latest step recorded in the
+      /// rewind buffer at or before a sim time. Simulation time, iterations,
+      /// entities and components go back to those of the step, and the
+      /// events::SnapshotRestored event is emitted as when restoring a
+      /// snapshot. Seeking through the world control service rewinds this
+      /// way when possible. Must be called between steps, not while Run is
+      /// stepping on another thread.
+      /// \param[in] _simTime Sim time to go back to.
+      /// \return False if the rewind buffer is disabled or doesn't cover
+      /// the time, in which case nothing changes.
+      /// \sa ServerConfig::SetRewindWindow
+      public: bool RewindTo(std::chrono::steady_clock::duration _simTime);
+
+      /// \brief Hash of the full state at the last step it was computed.
+      /// \return Hash, zero if the state was never hashed.
+      /// \sa ServerConfig::StateHashPeriod
+      public: uint64_t StateHash() const;
+
       /// \brief World control service callback. This function stores the
       /// the request which will then be processed by the ProcessMessages
       /// function.
@@ -316,6 +446,27 @@ namespace ignition
       /// \return True if successful.
       private: bool GuiInfoService(ignition::msgs::GUI &_res);
 
+      /// \brief Callback for the system timings service.
+      /// \param[out] _res Response containing the statistics of each system
+      /// as of the last time they were published.
+      /// \return True if system timing is enabled.
+      private: bool SystemTimingsService(msgs::Param_V &_res);
+
+      /// \brief Compute the statistics of each system and publish them, if
+      /// the publish period has elapsed.
+      private: void PublishSystemTimings();
+
+      /// \brief Callback for the memory service. The memory is measured by
+      /// the simulation thread, at the end of its next step.
+      /// \param[out] _res Response containing the memory held by each
+      /// component type, the views and the systems which report it.
+      /// \return True if the memory was measured in time.
+      private: bool MemoryService(msgs::Param_V &_res);
+
+      /// \brief Check whether the step which started at prevUpdateRealTime
+      /// overran the step budget and report it.
+      private: void CheckStepBudget();
+
       /// \brief Calculate real time factor and populate currentInfo.
       private: void UpdateCurrentInfo();
 
@@ -410,9 +561,6 @@ namespace ignition
       /// \brief Manager of distributing/receiving network work.
       private: std::unique_ptr<NetworkManager> networkMgr{nullptr};
 
-      /// \brief A pool of worker threads.
-      private: common::WorkerPool workerPool{2};
-
       /// \brief Wall time of the previous update.
       private: std::chrono::steady_clock::time_point prevUpdateRealTime;
 
@@ -424,11 +572,34 @@ namespace ignition
       /// The default update rate is 500hz, which is a period of 2ms.
       private: std::chrono::steady_clock::duration updatePeriod{2ms};
 
-      /// \brief List of simulation times used to compute averages.
-      private: std::list<std::chrono::steady_clock::duration> simTimes;
+      /// \brief Sim and real times of the last 20 steps, used to compute
+      /// the real time factor.
+      private: RealTimeFactorWindow realTimeFactorWindow{20u};
+
+      /// \brief Recent steps which simulation can be rewound to, null if
+      /// disabled. \sa ServerConfig::RewindWindow
+      private: std::unique_ptr<RewindBuffer> rewindBuffer;
+
+      /// \brief Time spent busy waiting before each step instead of
+      /// sleeping. \sa ServerConfig::PacingSpinTime
+      private: std::chrono::steady_clock::duration pacingSpinTime{0};
+
+      /// \brief Whether to step without pacing or communicating.
+      /// \sa ServerConfig::BatchMode
+      private: bool batchMode{false};
+
+      /// \brief Queue the lockstep controller's actions are received from,
+      /// null if lockstep is disabled. \sa ServerConfig::LockstepChannel
+      private: std::unique_ptr<SharedMemoryChannel> lockstepActions;
 
-      /// \brief List of real times used to compute averages.
-      private: std::list<std::chrono::steady_clock::duration> realTimes;
+      /// \brief Queue observations are sent to the lockstep controller on.
+      private: std::unique_ptr<SharedMemoryChannel> lockstepObservations;
+
+      /// \brief Component types sent as observations, empty for all.
+      private: std::unordered_set<ComponentTypeId> lockstepTypes;
+
+      /// \brief Serialized lockstep message, reused across steps.
+      private: std::string lockstepBuffer;
 
       /// \brief Node for communication.
       private: std::unique_ptr<transport::Node> node{nullptr};
@@ -445,6 +616,43 @@ namespace ignition
       /// \brief Clock publisher for the root `/clock` topic.
       private: ignition::transport::Node::Publisher rootClockPub;
 
+      /// \brief Minimum time between world statistics messages.
+      /// \sa ServerConfig::StatsPublishPeriod
+      private: std::chrono::steady_clock::duration statsPeriod{100ms};
+
+      /// \brief Minimum time between clock messages.
+      /// \sa ServerConfig::ClockPublishPeriod
+      private: std::chrono::steady_clock::duration clockPeriod{0};
+
+      /// \brief Last time world statistics were published.
+      private: std::chrono::steady_clock::time_point statsPublished;
+
+      /// \brief Last time the clock was published.
+      private: std::chrono::steady_clock::time_point clockPublished;
+
+      /// \brief Pause state in the last published world statistics.
+      private: std::optional<bool> statsPaused;
+
+      /// \brief Publishes the snapshots taken by PublishStats, so messages
+      /// aren't built and sent on the simulation thread.
+      private: std::thread statsThread;
+
+      /// \brief True while the stats thread is accepting snapshots.
+      private: bool statsThreadRunning{false};
+
+      /// \brief Snapshots waiting to be published by the stats thread.
+      private: std::vector<StatsSnapshot> pendingStats;
+
+      /// \brief Snapshots being published by the stats thread, swapped with
+      /// pendingStats so neither allocates once warmed up.
+      private: std::vector<StatsSnapshot> publishingStats;
+
+      /// \brief Protects statsThreadRunning and pendingStats.
+      private: std::mutex statsMutex;
+
+      /// \brief Wakes up the stats thread.
+      private: std::condition_variable statsCv;
+
       /// \brief Name of world being simulated.
       private: std::string worldName;
 
@@ -503,21 +711,126 @@ namespace ignition
       /// \brief Copy of the server configuration.
       public: ServerConfig serverConfig;
 
-      /// \brief Collection of threads running system PostUpdates
-      private: std::vector<std::thread> postUpdateThreads;
+      /// \brief Stages of systems implementing PreUpdate which can run
+      /// concurrently.
+      private: SystemScheduler preUpdateScheduler;
+
+      /// \brief Stages of systems implementing Update which can run
+      /// concurrently.
+      private: SystemScheduler updateScheduler;
+
+      /// \brief Threads running system PostUpdates, as well as PreUpdates
+      /// and Updates that can run concurrently. It's shared with the entity
+      /// component manager, which uses it for State, SetState and
+      /// EachParallel. Sized to the largest number of systems that can run at
+      /// once or the ECM's thread count, up to the hardware concurrency.
+      private: std::shared_ptr<WorkStealingPool> systemsPool;
+
+      /// \brief Wall time of the recent updates of each system. Only
+      /// recorded while systemTimingPeriod is positive.
+      private: SystemTimings systemTimings;
+
+      /// \brief Period at which system timings are published.
+      /// \sa ServerConfig::SystemTimingPeriod
+      private: std::chrono::steady_clock::duration systemTimingPeriod{0};
+
+      /// \brief Last time system timings were published.
+      private: std::chrono::steady_clock::time_point systemTimingsPublished;
+
+      /// \brief Publisher of system timings.
+      private: transport::Node::Publisher systemTimingsPub;
+
+      /// \brief Wait for the lockstep controller's actions for this step
+      /// and apply them.
+      private: void ReceiveLockstepActions();
+
+      /// \brief Send the components which changed during this step to the
+      /// lockstep controller.
+      private: void SendLockstepObservation();
+
+      /// \brief Hash the state and publish it, if due at this step.
+      private: void HashState();
+
+      /// \brief Iterations between state hashes, zero to disable.
+      /// \sa ServerConfig::StateHashPeriod
+      private: unsigned int stateHashPeriod{0u};
+
+      /// \brief Hash of the state at the last hashed step.
+      private: uint64_t stateHash{0u};
+
+      /// \brief Publisher of state hashes.
+      private: transport::Node::Publisher stateHashPub;
 
-      /// \brief Flag to indicate running status of PostUpdate threads
-      private: std::atomic<bool> postUpdateThreadsRunning{false};
+      /// \brief Last published system timings, returned by the service.
+      private: msgs::Param_V systemTimingsMsg;
 
-      /// \brief Barrier to signal beginning of PostUpdate thread execution
-      private: std::unique_ptr<Barrier> postUpdateStartBarrier;
+      /// \brief Protects systemTimingsMsg, which is read by the service.
+      private: std::mutex systemTimingsMutex;
 
-      /// \brief Barrier to signal end of PostUpdate thread execution
-      private: std::unique_ptr<Barrier> postUpdateStopBarrier;
+      /// \brief Set by the memory service to ask the simulation thread to
+      /// measure memory.
+      private: std::atomic<bool> memoryRequested{false};
+
+      /// \brief Memory measured for the memory service.
+      private: msgs::Param_V memoryMsg;
+
+      /// \brief Protects memoryMsg.
+      private: std::mutex memoryMutex;
+
+      /// \brief Notified once memory was measured for the memory service.
+      private: std::condition_variable memoryCv;
+
+      /// \brief Wall time each step should take at most, zero to disable.
+      /// \sa ServerConfig::StepBudget
+      private: std::chrono::steady_clock::duration stepBudget{0};
+
+      /// \brief Whether the PostUpdate of each system may be skipped when
+      /// the step budget is used up. Parallel to the PostUpdate systems.
+      private: std::vector<bool> postUpdateSkippable;
+
+      /// \brief Which systems are asleep, and skipped.
+      private: SystemSleep systemSleep;
+
+      /// \brief Indices of the PostUpdate systems which are awake in the
+      /// current step, kept to not allocate at each step.
+      private: std::vector<std::size_t> postUpdateAwake;
+
+      /// \brief Number of steps which overran the step budget.
+      private: std::atomic<uint64_t> stepOverruns{0u};
+
+      /// \brief Number of PostUpdates skipped to stay within the budget.
+      private: std::atomic<uint64_t> skippedPostUpdates{0u};
+
+      /// \brief Last time an overrun was logged, to not flood the console.
+      private: std::chrono::steady_clock::time_point stepOverrunLogged;
 
       /// \brief Map from file paths to Fuel URIs.
       private: std::unordered_map<std::string, std::string> fuelUriMap;
 
+      /// \brief Generates the world for the generate world SDF service,
+      /// reusing the text of models which didn't change since the previous
+      /// request.
+      private: sdf_generator::WorldGenerator worldGenerator;
+
+      /// \brief Set by the generate world SDF service to ask the simulation
+      /// thread to update worldGenerator.
+      private: std::atomic<bool> worldSdfRequested{false};
+
+      /// \brief Configuration of the requested world.
+      private: msgs::SdfGeneratorConfig worldSdfRequest;
+
+      /// \brief Whether the last update of worldGenerator succeeded.
+      private: bool worldSdfUpdated{false};
+
+      /// \brief Protects worldGenerator and the request.
+      private: std::mutex worldSdfMutex;
+
+      /// \brief Notified once worldGenerator was updated.
+      private: std::condition_variable worldSdfCv;
+
+      /// \brief Serializes calls to the generate world SDF service.
+      private: std::mutex worldSdfServiceMutex;
+
       /// \brief True if Server::RunOnce triggered a blocking paused step
       private: bool blockingPausedStepPending{false};
 
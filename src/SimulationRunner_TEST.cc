@@ -18,6 +18,14 @@
 #include <gtest/gtest.h>
 #include <tinyxml2.h>
 
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
 #include <ignition/transport/Node.hh>
@@ -33,6 +41,7 @@
 #include <sdf/Sphere.hh>
 
 
+#include "ignition/gazebo/Events.hh"
 #include "ignition/gazebo/test_config.hh"
 #include "ignition/gazebo/components/CanonicalLink.hh"
 #include "ignition/gazebo/components/ChildLinkName.hh"
@@ -55,6 +64,7 @@
 #include "ignition/gazebo/components/Wind.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/Events.hh"
+#include "ignition/gazebo/System.hh"
 #include "ignition/gazebo/Util.hh"
 #include "ignition/gazebo/config.hh"
 
@@ -1593,6 +1603,261 @@ TEST_P(SimulationRunnerTest, GuiInfo)
   EXPECT_EQ(plugin.innerxml().find("<deletion_topic>"), std::string::npos);
 }
 
+/// \brief System which takes a known time to update.
+class SlowUpdateSystem : public System, public ISystemUpdate
+{
+  // Documentation inherited
+  public: void Update(const UpdateInfo &, EntityComponentManager &) override
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+};
+
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, SystemTimings)
+{
+  sdf::Root root;
+  root.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+  ASSERT_EQ(1u, root.WorldCount());
+
+  ServerConfig config;
+  config.SetSystemTimingPeriod(std::chrono::nanoseconds(1));
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader, config);
+  runner.AddSystem(std::make_shared<SlowUpdateSystem>());
+  runner.SetPaused(false);
+  EXPECT_TRUE(runner.Run(5));
+
+  transport::Node node;
+  bool result{false};
+  msgs::Param_V res;
+  EXPECT_TRUE(node.Request("/world/default/performance/info", 5000u, res,
+      result));
+  EXPECT_TRUE(result);
+
+  bool found{false};
+  for (const auto &param : res.param())
+  {
+    // Memory usage is published along
+    const auto &params = param.params();
+    if (params.count("memory"))
+      continue;
+
+    ASSERT_EQ(1u, params.count("system"));
+    if (params.at("system").string_value().find("SlowUpdateSystem") ==
+        std::string::npos)
+    {
+      continue;
+    }
+
+    found = true;
+    EXPECT_EQ("update", params.at("phase").string_value());
+    EXPECT_EQ(5, params.at("samples").int_value());
+    EXPECT_GE(params.at("p50_us").double_value(), 2000.0);
+    EXPECT_GE(params.at("max_us").double_value(),
+        params.at("p99_us").double_value());
+  }
+  EXPECT_TRUE(found);
+}
+
+/// \brief System which reports a known memory usage.
+class MemoryReportingSystem : public System, public ISystemMemoryUsage
+{
+  // Documentation inherited
+  public: std::size_t MemoryUsage() const override
+  {
+    return 1234u;
+  }
+};
+
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, MemoryUsage)
+{
+  sdf::Root root;
+  root.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+  ASSERT_EQ(1u, root.WorldCount());
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader);
+  runner.AddSystem(std::make_shared<MemoryReportingSystem>());
+  runner.SetPaused(false);
+  EXPECT_TRUE(runner.Run(1));
+
+  const auto msg = runner.MemoryUsage();
+  bool foundModels{false};
+  bool foundViews{false};
+  bool foundSystem{false};
+  for (const auto &param : msg.param())
+  {
+    const auto &params = param.params();
+    ASSERT_EQ(1u, params.count("memory"));
+    ASSERT_EQ(1u, params.count("bytes"));
+    const auto &kind = params.at("memory").string_value();
+    if (kind == "component" &&
+        params.at("component").string_value() == "ign_gazebo_components.Model")
+    {
+      foundModels = true;
+      EXPECT_GE(params.at("count").int_value(), 3);
+      EXPECT_GT(params.at("bytes").double_value(), 0.0);
+      EXPECT_GE(params.at("reserved_bytes").double_value(),
+          params.at("bytes").double_value());
+    }
+    else if (kind == "views")
+    {
+      foundViews = true;
+    }
+    else if (kind == "system")
+    {
+      foundSystem = true;
+      EXPECT_DOUBLE_EQ(1234.0, params.at("bytes").double_value());
+    }
+  }
+  EXPECT_TRUE(foundModels);
+  EXPECT_TRUE(foundViews);
+  EXPECT_TRUE(foundSystem);
+}
+
+/////////////////////////////////////////////////
+class CountingPostUpdateSystem : public System, public ISystemPostUpdate
+{
+  // Documentation inherited
+  public: void PostUpdate(const UpdateInfo &,
+              const EntityComponentManager &) override
+  {
+    ++this->count;
+  }
+
+  /// \brief Number of PostUpdate calls.
+  public: int count{0};
+};
+
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, StepBudget)
+{
+  sdf::Root root;
+  root.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+  ASSERT_EQ(1u, root.WorldCount());
+
+  ServerConfig config;
+  config.SetStepBudget(std::chrono::milliseconds(1));
+  config.AddStepBudgetSkippableSystem(
+      typeid(CountingPostUpdateSystem).name());
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader, config);
+
+  auto counting = std::make_shared<CountingPostUpdateSystem>();
+  runner.AddSystem(std::make_shared<SlowUpdateSystem>());
+  runner.AddSystem(counting);
+
+  int overruns{0};
+  std::string slowest;
+  auto connection = runner.EventMgr().Connect<events::StepOverrun>(
+      [&](uint64_t, std::chrono::steady_clock::duration _stepTime,
+          const std::string &_system)
+      {
+        ++overruns;
+        slowest = _system;
+        EXPECT_GT(_stepTime, std::chrono::milliseconds(1));
+      });
+
+  runner.SetPaused(false);
+  EXPECT_TRUE(runner.Run(5));
+
+  // Every step overruns because of the slow system, which is to blame
+  EXPECT_EQ(5, overruns);
+  EXPECT_EQ(5u, runner.StepOverruns());
+  EXPECT_NE(std::string::npos, slowest.find("SlowUpdateSystem"));
+
+  // The budget was used up before PostUpdate on every step
+  EXPECT_EQ(0, counting->count);
+  EXPECT_EQ(5u, runner.SkippedPostUpdates());
+}
+
+/////////////////////////////////////////////////
+/// \brief System which sleeps for 5 ms of simulation time after each update.
+class NappingSystem : public System, public ISystemUpdate,
+    public ISystemPostUpdate, public ISystemSleep
+{
+  // Documentation inherited
+  public: void Update(const UpdateInfo &, EntityComponentManager &) override
+  {
+    ++this->updates;
+  }
+
+  // Documentation inherited
+  public: void PostUpdate(const UpdateInfo &,
+              const EntityComponentManager &) override
+  {
+    ++this->postUpdates;
+  }
+
+  // Documentation inherited
+  public: bool Sleep(const UpdateInfo &_info, SystemWake &_wake) override
+  {
+    _wake.simTime = _info.simTime + std::chrono::milliseconds(5);
+    return true;
+  }
+
+  /// \brief Number of Update calls.
+  public: int updates{0};
+
+  /// \brief Number of PostUpdate calls.
+  public: int postUpdates{0};
+};
+
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, SleepingSystems)
+{
+  sdf::Root root;
+  root.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+  ASSERT_EQ(1u, root.WorldCount());
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader);
+
+  auto sleeping = std::make_shared<NappingSystem>();
+  auto counting = std::make_shared<CountingPostUpdateSystem>();
+  runner.AddSystem(sleeping);
+  runner.AddSystem(counting);
+
+  // Steps are 1 ms long, so the system only runs every 5 steps, in all
+  // phases, while other systems run at every step
+  runner.SetPaused(false);
+  EXPECT_TRUE(runner.Run(10));
+  EXPECT_EQ(2, sleeping->updates);
+  EXPECT_EQ(2, sleeping->postUpdates);
+  EXPECT_EQ(10, counting->count);
+}
+
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, PacingSpinTime)
+{
+  sdf::Root root;
+  root.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+  ASSERT_EQ(1u, root.WorldCount());
+
+  ServerConfig config;
+  config.SetPacingSpinTime(std::chrono::microseconds(300));
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader, config);
+  runner.SetUpdatePeriod(1ms);
+  runner.SetPaused(false);
+
+  // Steps are never run before they're due
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(runner.Run(20));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 19ms);
+  EXPECT_EQ(20u, runner.IterationCount());
+}
+
 /////////////////////////////////////////////////
 TEST_P(SimulationRunnerTest, GenerateWorldSdf)
 {
@@ -1666,6 +1931,244 @@ TEST_P(SimulationRunnerTest, GeneratedSdfHasNoSpuriousPlugins)
   EXPECT_TRUE(checkForSpuriousPlugins(newRoot.Element()));
 }
 
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, PublishPeriods)
+{
+  sdf::Root root;
+  root.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+  ASSERT_EQ(1u, root.WorldCount());
+
+  ServerConfig config;
+  EXPECT_EQ(100ms, config.StatsPublishPeriod());
+  EXPECT_EQ(0ms, config.ClockPublishPeriod());
+  config.SetStatsPublishPeriod(std::chrono::hours(1));
+  config.SetClockPublishPeriod(std::chrono::hours(1));
+  EXPECT_EQ(std::chrono::hours(1), config.StatsPublishPeriod());
+  EXPECT_EQ(std::chrono::hours(1), config.ClockPublishPeriod());
+
+  std::mutex mutex;
+  int statsCount{0};
+  int clockCount{0};
+  std::function<void(const msgs::WorldStatistics &)> statsCb =
+      [&](const msgs::WorldStatistics &)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++statsCount;
+      };
+  std::function<void(const msgs::Clock &)> periodClockCb =
+      [&](const msgs::Clock &)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++clockCount;
+      };
+
+  transport::Node node;
+  node.Subscribe("/world/default/stats", statsCb);
+  node.Subscribe("/world/default/clock", periodClockCb);
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader, config);
+  runner.SetPaused(false);
+  EXPECT_TRUE(runner.Run(100));
+
+  std::this_thread::sleep_for(100ms);
+
+  // Only the first step is due within the period
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_LE(statsCount, 1);
+  EXPECT_LE(clockCount, 1);
+}
+
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, Snapshots)
+{
+  sdf::Root root;
+  root.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+  ASSERT_EQ(1u, root.WorldCount());
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader);
+  runner.SetPaused(false);
+  EXPECT_TRUE(runner.Run(10));
+
+  auto snapshot = runner.Snapshot();
+  ASSERT_NE(nullptr, snapshot);
+  EXPECT_EQ(10u, snapshot->info.iterations);
+  EXPECT_EQ(10ms, snapshot->info.simTime);
+  const auto entityCount = runner.EntityCount();
+  EXPECT_EQ(entityCount, snapshot->components.EntityCount());
+
+  int restoredCount{0};
+  auto conn = runner.EventMgr().Connect<events::SnapshotRestored>(
+      [&]()
+      {
+        ++restoredCount;
+      });
+
+  // Roll out, removing an entity on the way, then go back
+  EXPECT_TRUE(runner.RequestRemoveEntity("box"));
+  EXPECT_TRUE(runner.Run(10));
+  EXPECT_FALSE(runner.HasEntity("box"));
+  EXPECT_EQ(20u, runner.CurrentInfo().iterations);
+
+  runner.RestoreSnapshot(*snapshot);
+  EXPECT_EQ(1, restoredCount);
+  EXPECT_EQ(10u, runner.CurrentInfo().iterations);
+  EXPECT_EQ(10ms, runner.CurrentInfo().simTime);
+  EXPECT_TRUE(runner.HasEntity("box"));
+
+  EXPECT_TRUE(runner.Run(5));
+  EXPECT_EQ(15u, runner.CurrentInfo().iterations);
+  EXPECT_EQ(15ms, runner.CurrentInfo().simTime);
+  EXPECT_EQ(entityCount, runner.EntityCount());
+
+  // Fork into a second runner loaded from the same world
+  SimulationRunner fork(root.WorldByIndex(0), systemLoader);
+  fork.RestoreSnapshot(*snapshot);
+  EXPECT_EQ(10u, fork.CurrentInfo().iterations);
+  EXPECT_EQ(runner.EntityByName("box"), fork.EntityByName("box"));
+  fork.SetPaused(false);
+  EXPECT_TRUE(fork.Run(5));
+  EXPECT_EQ(15ms, fork.CurrentInfo().simTime);
+  EXPECT_EQ(entityCount, fork.EntityCount());
+}
+
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, RewindTo)
+{
+  sdf::Root root;
+  root.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+  ASSERT_EQ(1u, root.WorldCount());
+
+  // Disabled by default
+  auto systemLoader = std::make_shared<SystemLoader>();
+  {
+    SimulationRunner runner(root.WorldByIndex(0), systemLoader);
+    runner.SetPaused(false);
+    EXPECT_TRUE(runner.Run(10));
+    EXPECT_FALSE(runner.RewindTo(5ms));
+    EXPECT_EQ(10u, runner.CurrentInfo().iterations);
+  }
+
+  ServerConfig serverConfig;
+  serverConfig.SetRewindWindow(50ms);
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader, serverConfig);
+  runner.SetPaused(false);
+  EXPECT_TRUE(runner.Run(10));
+
+  int restoredCount{0};
+  auto conn = runner.EventMgr().Connect<events::SnapshotRestored>(
+      [&]()
+      {
+        ++restoredCount;
+      });
+
+  EXPECT_TRUE(runner.RequestRemoveEntity("box"));
+  EXPECT_TRUE(runner.Run(100));
+  EXPECT_FALSE(runner.HasEntity("box"));
+  const auto entityCount = runner.EntityCount();
+
+  // Out of the window
+  EXPECT_FALSE(runner.RewindTo(5ms));
+  EXPECT_EQ(0, restoredCount);
+
+  // Back to before the sphere was removed
+  runner.RequestRemoveEntity("sphere");
+  EXPECT_TRUE(runner.Run(1));
+  EXPECT_FALSE(runner.HasEntity("sphere"));
+  ASSERT_TRUE(runner.RewindTo(100ms));
+  EXPECT_EQ(1, restoredCount);
+  EXPECT_EQ(100ms, runner.CurrentInfo().simTime);
+  EXPECT_EQ(100u, runner.CurrentInfo().iterations);
+  EXPECT_TRUE(runner.HasEntity("sphere"));
+  EXPECT_FALSE(runner.HasEntity("box"));
+  EXPECT_EQ(entityCount, runner.EntityCount());
+
+  // Simulation continues from there
+  EXPECT_TRUE(runner.Run(5));
+  EXPECT_EQ(105ms, runner.CurrentInfo().simTime);
+  EXPECT_TRUE(runner.HasEntity("sphere"));
+}
+
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, StateHash)
+{
+  sdf::Root root;
+  root.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+  ASSERT_EQ(1u, root.WorldCount());
+
+  ServerConfig serverConfig;
+  EXPECT_FALSE(serverConfig.Deterministic());
+  EXPECT_EQ(0u, serverConfig.StateHashPeriod());
+  serverConfig.SetDeterministic(true);
+  serverConfig.SetStateHashPeriod(5u);
+
+  // Hashes published by one run
+  std::mutex hashesMutex;
+  std::vector<std::pair<uint64_t, uint64_t>> hashes;
+  std::function<void(const msgs::UInt64 &)> cb =
+      [&](const msgs::UInt64 &_msg)
+      {
+        ASSERT_EQ(1, _msg.header().data_size());
+        std::lock_guard<std::mutex> lock(hashesMutex);
+        hashes.push_back({std::stoull(_msg.header().data(0).value(0)),
+            _msg.data()});
+      };
+  transport::Node node;
+  node.Subscribe("/world/default/state_hash", cb);
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  uint64_t firstHash{0u};
+  {
+    SimulationRunner runner(root.WorldByIndex(0), systemLoader,
+        serverConfig);
+    EXPECT_TRUE(runner.EntityCompMgr().Deterministic());
+    EXPECT_EQ(0u, runner.StateHash());
+    runner.SetPaused(false);
+    EXPECT_TRUE(runner.Run(20));
+    firstHash = runner.StateHash();
+    EXPECT_NE(0u, firstHash);
+  }
+
+  // Runs with the same config give the same hashes
+  {
+    SimulationRunner runner(root.WorldByIndex(0), systemLoader,
+        serverConfig);
+    runner.SetPaused(false);
+    EXPECT_TRUE(runner.Run(20));
+    EXPECT_EQ(firstHash, runner.StateHash());
+
+    // And different states give different ones
+    EXPECT_TRUE(runner.RequestRemoveEntity("box"));
+    EXPECT_TRUE(runner.Run(5));
+    EXPECT_NE(firstHash, runner.StateHash());
+  }
+
+  // Every 5 iterations of both runs
+  for (int sleep = 0; sleep < 30; ++sleep)
+  {
+    {
+      std::lock_guard<std::mutex> lock(hashesMutex);
+      if (hashes.size() >= 9u)
+        break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  std::lock_guard<std::mutex> lock(hashesMutex);
+  ASSERT_EQ(9u, hashes.size());
+  for (std::size_t i = 0; i < 4u; ++i)
+  {
+    EXPECT_EQ(5u * (i + 1u), hashes[i].first);
+    EXPECT_EQ(hashes[i], hashes[i + 4u]);
+  }
+  EXPECT_EQ(firstHash, hashes[3].second);
+  EXPECT_EQ(25u, hashes[8].first);
+}
+
 // Run multiple times. We want to make sure that static globals don't cause
 // problems.
 INSTANTIATE_TEST_SUITE_P(ServerRepeat, SimulationRunnerTest,
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "ignition/gazebo/Snapshot.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(Snapshot, Publish)
+{
+  Snapshot<std::vector<int>> snapshot;
+  EXPECT_EQ(nullptr, snapshot.Get());
+  EXPECT_EQ(0u, snapshot.Epoch());
+
+  snapshot.Publish(std::make_shared<const std::vector<int>>(3, 1));
+  auto first = snapshot.Get();
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(3u, first->size());
+  EXPECT_EQ(1u, snapshot.Epoch());
+
+  // Readers keep their value after a new one is published
+  snapshot.Publish(std::make_shared<const std::vector<int>>(5, 2));
+  EXPECT_EQ(3u, first->size());
+  EXPECT_EQ(5u, snapshot.Get()->size());
+  EXPECT_EQ(2u, snapshot.Epoch());
+
+  snapshot.Publish(nullptr);
+  EXPECT_EQ(nullptr, snapshot.Get());
+  EXPECT_EQ(3u, snapshot.Epoch());
+}
+
+/////////////////////////////////////////////////
+TEST(Snapshot, ConcurrentReaders)
+{
+  // Each value holds copies of the same number, so a reader seeing mixed
+  // numbers would have read a value while it was modified
+  Snapshot<std::vector<int>> snapshot;
+  snapshot.Publish(std::make_shared<const std::vector<int>>(1000, 0));
+
+  std::atomic<bool> stop{false};
+  std::atomic<bool> consistent{true};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 4; ++r)
+  {
+    readers.emplace_back([&]
+    {
+      while (!stop)
+      {
+        auto value = snapshot.Get();
+        for (auto v : *value)
+        {
+          if (v != value->front())
+            consistent = false;
+        }
+      }
+    });
+  }
+
+  for (int i = 1; i <= 1000; ++i)
+    snapshot.Publish(std::make_shared<const std::vector<int>>(1000, i));
+
+  stop = true;
+  for (auto &reader : readers)
+    reader.join();
+
+  EXPECT_TRUE(consistent);
+  EXPECT_EQ(1000, snapshot.Get()->front());
+  EXPECT_EQ(1001u, snapshot.Epoch());
+}
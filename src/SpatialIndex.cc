@@ -0,0 +1,645 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ignition/gazebo/SpatialIndex.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "ignition/gazebo/components/AxisAlignedBox.hh"
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/TraceRecorder.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Maximum number of models in a leaf of the hierarchy.
+static constexpr std::size_t kLeafSize{4u};
+
+/// \brief The hierarchy is rebuilt when refitting made the total surface
+/// area of its nodes grow by more than this factor since it was built.
+static constexpr double kRebuildRatio{2.0};
+
+/// \brief Private data of SpatialIndex
+class ignition::gazebo::SpatialIndexPrivate
+{
+  /// \brief Box stored as its corners, which is cheaper to test than
+  /// math::AxisAlignedBox.
+  public: struct Box
+  {
+    /// \brief Minimum corner.
+    math::Vector3d min;
+
+    /// \brief Maximum corner.
+    math::Vector3d max;
+  };
+
+  /// \brief Node of the hierarchy. The left child of an internal node is
+  /// stored right after it.
+  public: struct Node
+  {
+    /// \brief Bounds of all the models under the node.
+    Box box;
+
+    /// \brief Index of the right child, for internal nodes.
+    uint32_t right{0u};
+
+    /// \brief Index in `order` of the first model, for leaves.
+    uint32_t first{0u};
+
+    /// \brief Number of models, zero for internal nodes.
+    uint32_t count{0u};
+  };
+
+  /// \brief Read the bounds of all models, adding and removing models as
+  /// needed.
+  /// \param[in] _ecm Entity component manager.
+  /// \return True if models were added or removed.
+  public: bool Gather(const EntityComponentManager &_ecm);
+
+  /// \brief Build the hierarchy from scratch.
+  public: void Build();
+
+  /// \brief Build the subtree over a range of `order`.
+  /// \param[in] _first First position in `order`.
+  /// \param[in] _count Number of models.
+  /// \return Index of the root node of the subtree.
+  public: uint32_t BuildNode(std::size_t _first, std::size_t _count);
+
+  /// \brief Update the bounds of all nodes, keeping the structure.
+  public: void Refit();
+
+  /// \brief Total surface area of the nodes, a measure of how expensive
+  /// queries are.
+  /// \return Surface area.
+  public: double Cost() const;
+
+  /// \brief Visit the models whose bounds pass a test, skipping the
+  /// subtrees whose bounds don't.
+  /// \param[in] _test Test on a box.
+  /// \param[in] _visit Function called with the slot of each model.
+  public: template<typename TestFn, typename VisitFn>
+          void Traverse(TestFn _test, VisitFn _visit) const;
+
+  /// \brief Grow a box to contain another one.
+  /// \param[in, out] _box Box to grow.
+  /// \param[in] _other Box to contain.
+  public: static void Grow(Box &_box, const Box &_other);
+
+  /// \brief Surface area of a box.
+  /// \param[in] _box Box.
+  /// \return Surface area.
+  public: static double SurfaceArea(const Box &_box);
+
+  /// \brief Squared distance from a point to a box.
+  /// \param[in] _box Box.
+  /// \param[in] _point Point.
+  /// \return Squared distance, zero if the point is inside.
+  public: static double DistanceSquared(const Box &_box,
+      const math::Vector3d &_point);
+
+  /// \brief Intersect a ray with a box.
+  /// \param[in] _box Box.
+  /// \param[in] _origin Ray origin.
+  /// \param[in] _direction Unit ray direction.
+  /// \param[in] _maxDistance Length of the ray.
+  /// \param[out] _distance Distance to the box, if it's hit.
+  /// \return True if the box is hit.
+  public: static bool RayIntersects(const Box &_box,
+      const math::Vector3d &_origin, const math::Vector3d &_direction,
+      double _maxDistance, double &_distance);
+
+  /// \brief Indexed models.
+  public: std::vector<Entity> entities;
+
+  /// \brief Bounds of each model.
+  public: std::vector<Box> boxes;
+
+  /// \brief Last gather in which each model was found.
+  public: std::vector<uint64_t> seen;
+
+  /// \brief Slot of each model in the vectors above.
+  public: std::unordered_map<Entity, std::size_t> slots;
+
+  /// \brief Slots of the models, ordered so that the models of each leaf
+  /// are contiguous.
+  public: std::vector<uint32_t> order;
+
+  /// \brief Nodes of the hierarchy, the root first.
+  public: std::vector<Node> nodes;
+
+  /// \brief Cost of the hierarchy when it was built.
+  public: double buildCost{0.0};
+
+  /// \brief Number of gathers so far.
+  public: uint64_t gatherCount{0u};
+
+  /// \brief Iteration and component version of the last update.
+  public: std::optional<std::pair<uint64_t, uint64_t>> updated;
+
+  /// \brief Update holds it exclusively, queries share it.
+  public: mutable std::shared_mutex mutex;
+};
+
+//////////////////////////////////////////////////
+void SpatialIndexPrivate::Grow(Box &_box, const Box &_other)
+{
+  _box.min.Min(_other.min);
+  _box.max.Max(_other.max);
+}
+
+//////////////////////////////////////////////////
+double SpatialIndexPrivate::SurfaceArea(const Box &_box)
+{
+  const auto size = _box.max - _box.min;
+  return 2.0 * (size.X() * size.Y() + size.Y() * size.Z() +
+      size.Z() * size.X());
+}
+
+//////////////////////////////////////////////////
+double SpatialIndexPrivate::DistanceSquared(const Box &_box,
+    const math::Vector3d &_point)
+{
+  double result{0.0};
+  for (int a = 0; a < 3; ++a)
+  {
+    const double d = std::max({_box.min[a] - _point[a], 0.0,
+        _point[a] - _box.max[a]});
+    result += d * d;
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool SpatialIndexPrivate::RayIntersects(const Box &_box,
+    const math::Vector3d &_origin, const math::Vector3d &_direction,
+    double _maxDistance, double &_distance)
+{
+  double tMin{0.0};
+  double tMax{_maxDistance};
+  for (int a = 0; a < 3; ++a)
+  {
+    // Parallel to the slab
+    if (std::abs(_direction[a]) < 1e-12)
+    {
+      if (_origin[a] < _box.min[a] || _origin[a] > _box.max[a])
+        return false;
+      continue;
+    }
+
+    const double inverse = 1.0 / _direction[a];
+    double t1 = (_box.min[a] - _origin[a]) * inverse;
+    double t2 = (_box.max[a] - _origin[a]) * inverse;
+    if (t1 > t2)
+      std::swap(t1, t2);
+    tMin = std::max(tMin, t1);
+    tMax = std::min(tMax, t2);
+    if (tMin > tMax)
+      return false;
+  }
+  _distance = tMin;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool SpatialIndexPrivate::Gather(const EntityComponentManager &_ecm)
+{
+  ++this->gatherCount;
+  bool changed{false};
+
+  _ecm.Each<components::Model>(
+      [&](const Entity &_entity, const components::Model *) -> bool
+      {
+        auto pose = _ecm.EntityWorldPose(_entity);
+        if (!pose)
+          return true;
+
+        Box box{pose->Pos(), pose->Pos()};
+        auto aabb = _ecm.Component<components::AxisAlignedBox>(_entity);
+        if (aabb)
+        {
+          const auto &min = aabb->Data().Min();
+          const auto &max = aabb->Data().Max();
+          if (min.IsFinite() && max.IsFinite() && min.X() <= max.X() &&
+              min.Y() <= max.Y() && min.Z() <= max.Z())
+          {
+            Grow(box, {min, max});
+          }
+        }
+
+        auto it = this->slots.find(_entity);
+        if (it == this->slots.end())
+        {
+          this->slots[_entity] = this->entities.size();
+          this->entities.push_back(_entity);
+          this->boxes.push_back(box);
+          this->seen.push_back(this->gatherCount);
+          changed = true;
+        }
+        else
+        {
+          this->boxes[it->second] = box;
+          this->seen[it->second] = this->gatherCount;
+        }
+        return true;
+      });
+
+  // Remove models which weren't found
+  for (std::size_t i = 0; i < this->entities.size();)
+  {
+    if (this->seen[i] == this->gatherCount)
+    {
+      ++i;
+      continue;
+    }
+
+    this->slots.erase(this->entities[i]);
+    if (i + 1u != this->entities.size())
+    {
+      this->entities[i] = this->entities.back();
+      this->boxes[i] = this->boxes.back();
+      this->seen[i] = this->seen.back();
+      this->slots[this->entities[i]] = i;
+    }
+    this->entities.pop_back();
+    this->boxes.pop_back();
+    this->seen.pop_back();
+    changed = true;
+  }
+  return changed;
+}
+
+//////////////////////////////////////////////////
+void SpatialIndexPrivate::Build()
+{
+  IGN_GAZEBO_PROFILE("SpatialIndex::Build");
+  this->nodes.clear();
+  this->order.resize(this->entities.size());
+  std::iota(this->order.begin(), this->order.end(), 0u);
+  this->buildCost = 0.0;
+  if (this->order.empty())
+    return;
+
+  this->nodes.reserve(2u * this->order.size() / kLeafSize + 1u);
+  this->BuildNode(0u, this->order.size());
+  this->buildCost = this->Cost();
+}
+
+//////////////////////////////////////////////////
+uint32_t SpatialIndexPrivate::BuildNode(std::size_t _first,
+    std::size_t _count)
+{
+  const auto index = static_cast<uint32_t>(this->nodes.size());
+  this->nodes.emplace_back();
+
+  auto center = [this](uint32_t _slot)
+  {
+    return (this->boxes[_slot].min + this->boxes[_slot].max) * 0.5;
+  };
+
+  Box box{this->boxes[this->order[_first]]};
+  Box centers{center(this->order[_first]), center(this->order[_first])};
+  for (std::size_t i = _first + 1u; i < _first + _count; ++i)
+  {
+    Grow(box, this->boxes[this->order[i]]);
+    const auto c = center(this->order[i]);
+    Grow(centers, {c, c});
+  }
+  this->nodes[index].box = box;
+
+  if (_count <= kLeafSize)
+  {
+    this->nodes[index].first = static_cast<uint32_t>(_first);
+    this->nodes[index].count = static_cast<uint32_t>(_count);
+    return index;
+  }
+
+  // Split at the median along the axis where the centers spread the most
+  const auto extent = centers.max - centers.min;
+  int axis = extent.X() >= extent.Y() ? 0 : 1;
+  if (extent.Z() > extent[axis])
+    axis = 2;
+
+  const std::size_t half = _count / 2u;
+  auto first = this->order.begin() + _first;
+  std::nth_element(first, first + half, first + _count,
+      [&](uint32_t _a, uint32_t _b)
+      {
+        return center(_a)[axis] < center(_b)[axis];
+      });
+
+  this->BuildNode(_first, half);
+  const auto right = this->BuildNode(_first + half, _count - half);
+  this->nodes[index].right = right;
+  return index;
+}
+
+//////////////////////////////////////////////////
+void SpatialIndexPrivate::Refit()
+{
+  // Children are stored after their parents
+  for (std::size_t i = this->nodes.size(); i-- > 0u;)
+  {
+    auto &node = this->nodes[i];
+    if (node.count > 0u)
+    {
+      node.box = this->boxes[this->order[node.first]];
+      for (uint32_t k = 1u; k < node.count; ++k)
+        Grow(node.box, this->boxes[this->order[node.first + k]]);
+    }
+    else
+    {
+      node.box = this->nodes[i + 1u].box;
+      Grow(node.box, this->nodes[node.right].box);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+double SpatialIndexPrivate::Cost() const
+{
+  double cost{0.0};
+  for (const auto &node : this->nodes)
+    cost += SurfaceArea(node.box);
+  return cost;
+}
+
+//////////////////////////////////////////////////
+template<typename TestFn, typename VisitFn>
+void SpatialIndexPrivate::Traverse(TestFn _test, VisitFn _visit) const
+{
+  if (this->nodes.empty())
+    return;
+
+  std::vector<uint32_t> stack{0u};
+  while (!stack.empty())
+  {
+    const auto index = stack.back();
+    stack.pop_back();
+
+    const auto &node = this->nodes[index];
+    if (!_test(node.box))
+      continue;
+
+    if (node.count > 0u)
+    {
+      for (uint32_t k = 0u; k < node.count; ++k)
+      {
+        const auto slot = this->order[node.first + k];
+        if (_test(this->boxes[slot]))
+          _visit(slot);
+      }
+    }
+    else
+    {
+      stack.push_back(node.right);
+      stack.push_back(index + 1u);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<SpatialIndex> SpatialIndex::For(
+    const EntityComponentManager &_ecm)
+{
+  static std::mutex mutex;
+  static std::unordered_map<const EntityComponentManager *,
+      std::weak_ptr<SpatialIndex>> indices;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // Forget indices which are no longer used
+  for (auto it = indices.begin(); it != indices.end();)
+  {
+    if (it->second.expired())
+      it = indices.erase(it);
+    else
+      ++it;
+  }
+
+  auto &weak = indices[&_ecm];
+  auto index = weak.lock();
+  if (!index)
+  {
+    index = std::make_shared<SpatialIndex>();
+    weak = index;
+  }
+  return index;
+}
+
+//////////////////////////////////////////////////
+SpatialIndex::SpatialIndex()
+  : dataPtr(std::make_unique<SpatialIndexPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+SpatialIndex::~SpatialIndex() = default;
+
+//////////////////////////////////////////////////
+void SpatialIndex::Update(const UpdateInfo &_info,
+    const EntityComponentManager &_ecm)
+{
+  std::unique_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+  // While paused, iterations don't advance but models may still be moved
+  const std::pair<uint64_t, uint64_t> key{_info.iterations,
+      _ecm.CurrentVersion()};
+  if (this->dataPtr->updated && *this->dataPtr->updated == key)
+    return;
+  this->dataPtr->updated = key;
+
+  IGN_GAZEBO_PROFILE("SpatialIndex::Update");
+  if (this->dataPtr->Gather(_ecm) || this->dataPtr->nodes.empty())
+  {
+    this->dataPtr->Build();
+    return;
+  }
+
+  this->dataPtr->Refit();
+  if (this->dataPtr->Cost() > kRebuildRatio * this->dataPtr->buildCost)
+    this->dataPtr->Build();
+}
+
+//////////////////////////////////////////////////
+std::size_t SpatialIndex::Size() const
+{
+  std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->entities.size();
+}
+
+//////////////////////////////////////////////////
+math::AxisAlignedBox SpatialIndex::Bounds(Entity _entity) const
+{
+  std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+  auto it = this->dataPtr->slots.find(_entity);
+  if (it == this->dataPtr->slots.end())
+    return math::AxisAlignedBox();
+
+  const auto &box = this->dataPtr->boxes[it->second];
+  return math::AxisAlignedBox(box.min, box.max);
+}
+
+//////////////////////////////////////////////////
+void SpatialIndex::Overlapping(const math::AxisAlignedBox &_box,
+    std::vector<Entity> &_result) const
+{
+  _result.clear();
+  std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+
+  const auto &min = _box.Min();
+  const auto &max = _box.Max();
+  this->dataPtr->Traverse(
+      [&](const SpatialIndexPrivate::Box &_node)
+      {
+        return _node.min.X() <= max.X() && _node.max.X() >= min.X() &&
+            _node.min.Y() <= max.Y() && _node.max.Y() >= min.Y() &&
+            _node.min.Z() <= max.Z() && _node.max.Z() >= min.Z();
+      },
+      [&](std::size_t _slot)
+      {
+        _result.push_back(this->dataPtr->entities[_slot]);
+      });
+}
+
+//////////////////////////////////////////////////
+void SpatialIndex::WithinRadius(const math::Vector3d &_center,
+    double _radius, std::vector<Entity> &_result) const
+{
+  _result.clear();
+  if (_radius < 0.0)
+    return;
+
+  std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+  const double radiusSquared = _radius * _radius;
+  this->dataPtr->Traverse(
+      [&](const SpatialIndexPrivate::Box &_node)
+      {
+        return SpatialIndexPrivate::DistanceSquared(_node, _center) <=
+            radiusSquared;
+      },
+      [&](std::size_t _slot)
+      {
+        _result.push_back(this->dataPtr->entities[_slot]);
+      });
+}
+
+//////////////////////////////////////////////////
+void SpatialIndex::Nearest(const math::Vector3d &_point, std::size_t _count,
+    std::vector<Entity> &_result) const
+{
+  _result.clear();
+  std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+  const auto &nodes = this->dataPtr->nodes;
+  if (_count == 0u || nodes.empty())
+    return;
+
+  using Candidate = std::pair<double, uint32_t>;
+
+  // Nodes to visit, closest first
+  std::priority_queue<Candidate, std::vector<Candidate>,
+      std::greater<Candidate>> pending;
+  pending.emplace(SpatialIndexPrivate::DistanceSquared(nodes[0].box, _point),
+      0u);
+
+  // Best models so far, farthest first
+  std::priority_queue<Candidate> best;
+
+  while (!pending.empty())
+  {
+    const auto [distance, index] = pending.top();
+    pending.pop();
+    if (best.size() == _count && distance > best.top().first)
+      break;
+
+    const auto &node = nodes[index];
+    if (node.count > 0u)
+    {
+      for (uint32_t k = 0u; k < node.count; ++k)
+      {
+        const auto slot = this->dataPtr->order[node.first + k];
+        const double d = SpatialIndexPrivate::DistanceSquared(
+            this->dataPtr->boxes[slot], _point);
+        if (best.size() < _count)
+        {
+          best.emplace(d, slot);
+        }
+        else if (d < best.top().first)
+        {
+          best.pop();
+          best.emplace(d, slot);
+        }
+      }
+    }
+    else
+    {
+      for (auto child : {index + 1u, node.right})
+      {
+        pending.emplace(SpatialIndexPrivate::DistanceSquared(
+            nodes[child].box, _point), child);
+      }
+    }
+  }
+
+  _result.resize(best.size());
+  for (std::size_t i = best.size(); i-- > 0u;)
+  {
+    _result[i] = this->dataPtr->entities[best.top().second];
+    best.pop();
+  }
+}
+
+//////////////////////////////////////////////////
+SpatialIndex::RayHit SpatialIndex::RayCast(const math::Vector3d &_origin,
+    const math::Vector3d &_direction, double _maxDistance) const
+{
+  RayHit hit;
+  const double length = _direction.Length();
+  if (length <= 0.0 || _maxDistance < 0.0)
+    return hit;
+  const auto direction = _direction / length;
+
+  std::shared_lock<std::shared_mutex> lock(this->dataPtr->mutex);
+  double maxDistance = _maxDistance;
+  double distance{0.0};
+  this->dataPtr->Traverse(
+      [&](const SpatialIndexPrivate::Box &_node)
+      {
+        return SpatialIndexPrivate::RayIntersects(_node, _origin, direction,
+            maxDistance, distance);
+      },
+      [&](std::size_t _slot)
+      {
+        // The test just ran on this model's bounds
+        if (hit.entity == kNullEntity || distance < hit.distance)
+        {
+          hit.entity = this->dataPtr->entities[_slot];
+          hit.distance = distance;
+          maxDistance = distance;
+        }
+      });
+  return hit;
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ignition/gazebo/SpatialIndex.hh"
+#include "ignition/gazebo/components/AxisAlignedBox.hh"
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Pose.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+/// \brief Create a model on a grid with 1 m spacing.
+Entity CreateGridModel(EntityComponentManager &_ecm, int _x, int _y)
+{
+  auto entity = _ecm.CreateEntity();
+  _ecm.CreateComponent(entity, components::Model());
+  _ecm.CreateComponent(entity, components::Pose({_x * 1.0, _y * 1.0, 0,
+      0, 0, 0}));
+  return entity;
+}
+
+/////////////////////////////////////////////////
+TEST(SpatialIndex, SharedPerEcm)
+{
+  EntityComponentManager ecm;
+  EntityComponentManager otherEcm;
+
+  auto index = SpatialIndex::For(ecm);
+  ASSERT_NE(nullptr, index);
+  EXPECT_EQ(index, SpatialIndex::For(ecm));
+  EXPECT_NE(index, SpatialIndex::For(otherEcm));
+}
+
+/////////////////////////////////////////////////
+TEST(SpatialIndex, Queries)
+{
+  EntityComponentManager ecm;
+  std::vector<Entity> grid;
+  for (int x = 0; x < 10; ++x)
+    for (int y = 0; y < 10; ++y)
+      grid.push_back(CreateGridModel(ecm, x, y));
+
+  // Only models are indexed
+  ecm.CreateComponent(ecm.CreateEntity(), components::Pose());
+
+  SpatialIndex index;
+  UpdateInfo info;
+  info.iterations = 1;
+  index.Update(info, ecm);
+  EXPECT_EQ(100u, index.Size());
+
+  // Brute force reference
+  auto overlapping = [&](const math::AxisAlignedBox &_box)
+  {
+    std::vector<Entity> result;
+    for (int i = 0; i < 100; ++i)
+    {
+      if (_box.Contains({i / 10 * 1.0, i % 10 * 1.0, 0}))
+        result.push_back(grid[i]);
+    }
+    return result;
+  };
+
+  std::vector<Entity> result;
+  for (const auto &box : {math::AxisAlignedBox({-1, -1, -1}, {20, 20, 1}),
+      math::AxisAlignedBox({2.5, 3.5, -1}, {5.5, 4.5, 1}),
+      math::AxisAlignedBox({2, 2, 0}, {2, 2, 0}),
+      math::AxisAlignedBox({20, 20, 0}, {30, 30, 1})})
+  {
+    index.Overlapping(box, result);
+    std::sort(result.begin(), result.end());
+    EXPECT_EQ(overlapping(box), result);
+  }
+
+  index.WithinRadius({4.5, 4.5, 0}, 0.8, result);
+  EXPECT_EQ(4u, result.size());
+  index.WithinRadius({4.5, 4.5, 0}, -1, result);
+  EXPECT_TRUE(result.empty());
+
+  index.Nearest({9.1, 0.2, 0}, 3, result);
+  ASSERT_EQ(3u, result.size());
+  EXPECT_EQ(grid[90], result[0]);
+  EXPECT_EQ(grid[91], result[1]);
+  EXPECT_EQ(grid[80], result[2]);
+  index.Nearest({0, 0, 0}, 1000, result);
+  EXPECT_EQ(100u, result.size());
+  EXPECT_EQ(grid[0], result[0]);
+
+  // Rays along the second row
+  auto hit = index.RayCast({-2, 1, 0}, {2, 0, 0}, 10);
+  EXPECT_EQ(grid[1], hit.entity);
+  EXPECT_DOUBLE_EQ(2.0, hit.distance);
+  hit = index.RayCast({-2, 1.5, 0}, {1, 0, 0}, 100);
+  EXPECT_EQ(kNullEntity, hit.entity);
+  hit = index.RayCast({-2, 1, 0}, {1, 0, 0}, 1.5);
+  EXPECT_EQ(kNullEntity, hit.entity);
+}
+
+/////////////////////////////////////////////////
+TEST(SpatialIndex, Update)
+{
+  EntityComponentManager ecm;
+  auto parent = CreateGridModel(ecm, 0, 0);
+  auto child = CreateGridModel(ecm, 1, 0);
+  ecm.CreateComponent(child, components::ParentEntity(parent));
+  for (int x = 0; x < 10; ++x)
+    CreateGridModel(ecm, x, 5);
+
+  auto index = SpatialIndex::For(ecm);
+  UpdateInfo info;
+  info.iterations = 1;
+  index->Update(info, ecm);
+
+  std::vector<Entity> result;
+  index->Overlapping(math::AxisAlignedBox({0.5, -0.5, -1}, {1.5, 0.5, 1}),
+      result);
+  ASSERT_EQ(1u, result.size());
+  EXPECT_EQ(child, result[0]);
+
+  // Nested models follow their parents
+  ecm.SetComponentData<components::Pose>(parent,
+      math::Pose3d(0, 20, 0, 0, 0, 0));
+  info.iterations = 2;
+  index->Update(info, ecm);
+  index->Overlapping(math::AxisAlignedBox({0.5, -0.5, -1}, {1.5, 0.5, 1}),
+      result);
+  EXPECT_TRUE(result.empty());
+  index->WithinRadius({1, 20, 0}, 0.1, result);
+  ASSERT_EQ(1u, result.size());
+  EXPECT_EQ(child, result[0]);
+
+  // Bounds cover the axis aligned box and the origin
+  ecm.CreateComponent(parent, components::AxisAlignedBox(
+      math::AxisAlignedBox({2, 19, -1}, {3, 21, 1})));
+  info.iterations = 3;
+  index->Update(info, ecm);
+  EXPECT_EQ(math::AxisAlignedBox({0, 19, -1}, {3, 21, 1}),
+      index->Bounds(parent));
+  auto hit = index->RayCast({2.5, 30, 0}, {0, -1, 0}, 20);
+  EXPECT_EQ(parent, hit.entity);
+  EXPECT_DOUBLE_EQ(9.0, hit.distance);
+
+  // Models which are gone aren't indexed
+  ecm.RemoveComponent<components::Model>(child);
+  info.iterations = 4;
+  index->Update(info, ecm);
+  EXPECT_EQ(11u, index->Size());
+  index->WithinRadius({1, 20, 0}, 0.1, result);
+  EXPECT_TRUE(result.empty());
+  EXPECT_EQ(math::AxisAlignedBox(), index->Bounds(child));
+}
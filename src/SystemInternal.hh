@@ -19,6 +19,7 @@
 
 #include <chrono>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -50,6 +51,11 @@ namespace ignition
                 preupdate(systemPlugin->QueryInterface<ISystemPreUpdate>()),
                 update(systemPlugin->QueryInterface<ISystemUpdate>()),
                 postupdate(systemPlugin->QueryInterface<ISystemPostUpdate>()),
+                componentAccess(
+                  systemPlugin->QueryInterface<ISystemComponentAccess>()),
+                memoryUsage(
+                  systemPlugin->QueryInterface<ISystemMemoryUsage>()),
+                sleep(systemPlugin->QueryInterface<ISystemSleep>()),
                 parentEntity(_entity)
       {
       }
@@ -67,6 +73,11 @@ namespace ignition
                 preupdate(dynamic_cast<ISystemPreUpdate *>(_system.get())),
                 update(dynamic_cast<ISystemUpdate *>(_system.get())),
                 postupdate(dynamic_cast<ISystemPostUpdate *>(_system.get())),
+                componentAccess(
+                  dynamic_cast<ISystemComponentAccess *>(_system.get())),
+                memoryUsage(
+                  dynamic_cast<ISystemMemoryUsage *>(_system.get())),
+                sleep(dynamic_cast<ISystemSleep *>(_system.get())),
                 parentEntity(_entity)
       {
       }
@@ -104,6 +115,18 @@ namespace ignition
       /// Will be nullptr if the System doesn't implement this interface.
       public: ISystemPostUpdate *postupdate = nullptr;
 
+      /// \brief Access this system via the ISystemComponentAccess interface
+      /// Will be nullptr if the System doesn't implement this interface.
+      public: ISystemComponentAccess *componentAccess = nullptr;
+
+      /// \brief Access this system via the ISystemMemoryUsage interface
+      /// Will be nullptr if the System doesn't implement this interface.
+      public: ISystemMemoryUsage *memoryUsage = nullptr;
+
+      /// \brief Access this system via the ISystemSleep interface
+      /// Will be nullptr if the System doesn't implement this interface.
+      public: ISystemSleep *sleep = nullptr;
+
       /// \brief Entity that the system is attached to. It's passed to the
       /// system during the `Configure` call.
       public: Entity parentEntity = {kNullEntity};
@@ -114,6 +137,10 @@ namespace ignition
 
       /// \brief Vector of queries and callbacks
       public: std::vector<EntityQueryCallback> updates;
+
+      /// \brief Name which identifies the system in diagnostics, such as
+      /// its plugin name followed by the entity it's attached to.
+      public: std::string name;
     };
     }
   }  // namespace gazebo
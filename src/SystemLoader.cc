@@ -17,7 +17,9 @@
 
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 
 #include <ignition/gazebo/SystemLoader.hh>
 
@@ -59,9 +61,38 @@ class ignition::gazebo::SystemLoaderPrivate
   }
 
   //////////////////////////////////////////////////
-  public: bool InstantiateSystemPlugin(const sdf::Plugin &_sdfPlugin,
-              ignition::plugin::PluginPtr &_gzPlugin)
+  /// \brief Environment which determines PluginPaths.
+  /// \return Values of the variables, joined.
+  public: std::string PluginPathsEnv() const
   {
+    std::string pluginPath;
+    ignition::common::env(this->pluginPathEnv, pluginPath);
+    std::string homePath;
+    ignition::common::env(IGN_HOMEDIR, homePath);
+    return pluginPath + '\n' + homePath;
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Find and load a library, or get it from the cache of libraries
+  /// which were already loaded.
+  /// \param[in] _filename Library file name from the SDF.
+  /// \param[in] _name Plugin name from the SDF, used for error messages.
+  /// \return Library, or nullptr if it couldn't be found or loaded.
+  public: const std::pair<std::string, std::unordered_set<std::string>> *
+      Library(const std::string &_filename, const std::string &_name)
+  {
+    // Changes to the search paths may resolve file names differently
+    auto env = this->PluginPathsEnv();
+    if (env != this->librariesEnv)
+    {
+      this->libraries.clear();
+      this->librariesEnv = env;
+    }
+
+    auto cached = this->libraries.find(_filename);
+    if (cached != this->libraries.end())
+      return &cached->second;
+
     std::list<std::string> paths = this->PluginPaths();
     common::SystemPaths systemPaths;
     for (const auto &p : paths)
@@ -69,27 +100,42 @@ class ignition::gazebo::SystemLoaderPrivate
       systemPaths.AddPluginPaths(p);
     }
 
-    auto pathToLib = systemPaths.FindSharedLibrary(_sdfPlugin.Filename());
+    auto pathToLib = systemPaths.FindSharedLibrary(_filename);
     if (pathToLib.empty())
     {
       // We assume ignition::gazebo corresponds to the levels feature
-      if (_sdfPlugin.Name() != "ignition::gazebo")
+      if (_name != "ignition::gazebo")
       {
-        ignerr << "Failed to load system plugin [" << _sdfPlugin.Filename() <<
+        ignerr << "Failed to load system plugin [" << _filename <<
                   "] : couldn't find shared library." << std::endl;
       }
-      return false;
+      return nullptr;
     }
 
     auto pluginNames = this->loader.LoadLib(pathToLib);
     if (pluginNames.empty())
     {
-      ignerr << "Failed to load system plugin [" << _sdfPlugin.Filename() <<
+      ignerr << "Failed to load system plugin [" << _filename <<
                 "] : couldn't load library on path [" << pathToLib <<
                 "]." << std::endl;
-      return false;
+      return nullptr;
     }
 
+    return &this->libraries.emplace(_filename,
+        std::make_pair(pathToLib, std::move(pluginNames))).first->second;
+  }
+
+  //////////////////////////////////////////////////
+  public: bool InstantiateSystemPlugin(const sdf::Plugin &_sdfPlugin,
+              ignition::plugin::PluginPtr &_gzPlugin)
+  {
+    auto library = this->Library(_sdfPlugin.Filename(), _sdfPlugin.Name());
+    if (nullptr == library)
+      return false;
+
+    const auto &pathToLib = library->first;
+    const auto &pluginNames = library->second;
+
     auto pluginName = *pluginNames.begin();
     if (pluginName.empty())
     {
@@ -136,6 +182,16 @@ class ignition::gazebo::SystemLoaderPrivate
 
   /// \brief System plugins that have instances loaded via the manager.
   public: std::unordered_set<SystemPluginPtr> systemPluginsAdded;
+
+  /// \brief Libraries which have been loaded, keyed by the file name they
+  /// were requested with. Values are the path of the library and the
+  /// plugins in it. Many entities usually load the same few libraries, and
+  /// searching all plugin paths for each of them is slow.
+  public: std::unordered_map<std::string,
+      std::pair<std::string, std::unordered_set<std::string>>> libraries;
+
+  /// \brief Value of PluginPathsEnv when the libraries were found.
+  public: std::string librariesEnv;
 };
 
 //////////////////////////////////////////////////
@@ -156,7 +212,9 @@ std::list<std::string> SystemLoader::PluginPaths() const
 //////////////////////////////////////////////////
 void SystemLoader::AddSystemPluginPath(const std::string &_path)
 {
-  this->dataPtr->systemPluginPaths.insert(_path);
+  // New paths may come before the ones which found the cached libraries
+  if (this->dataPtr->systemPluginPaths.insert(_path).second)
+    this->dataPtr->libraries.clear();
 }
 
 //////////////////////////////////////////////////
@@ -17,6 +17,8 @@
 
 #include <list>
 #include <set>
+#include <string>
+#include <typeinfo>
 
 #include <ignition/common/StringUtils.hh>
 
@@ -33,7 +35,8 @@ SystemManager::SystemManager(
   EntityComponentManager *_entityCompMgr,
   EventManager *_eventMgr,
   const std::string &_namespace,
-  ignition::transport::parameters::ParametersRegistry *_parametersRegistry)
+  ignition::transport::parameters::ParametersRegistry *_parametersRegistry,
+  bool _advertise)
   : systemLoader(_systemLoader),
     entityCompMgr(_entityCompMgr),
     eventMgr(_eventMgr),
@@ -42,6 +45,9 @@ SystemManager::SystemManager(
   transport::NodeOptions opts;
   opts.SetNameSpace(_namespace);
   this->node = std::make_unique<transport::Node>(opts);
+  if (!_advertise)
+    return;
+
   std::string entitySystemAddService{"entity/system/add"};
   this->node->Advertise(entitySystemAddService,
       &SystemManager::EntitySystemAddService, this);
@@ -109,13 +115,33 @@ size_t SystemManager::ActivatePendingSystems()
       this->systemsConfigureParameters.push_back(system.configureParameters);
 
     if (system.preupdate)
+    {
       this->systemsPreupdate.push_back(system.preupdate);
+      this->systemsPreupdateAccess.push_back(system.componentAccess);
+      this->systemsPreupdateSleep.push_back(system.sleep);
+      this->systemsPreupdateNames.push_back(system.name);
+    }
 
     if (system.update)
+    {
       this->systemsUpdate.push_back(system.update);
+      this->systemsUpdateAccess.push_back(system.componentAccess);
+      this->systemsUpdateSleep.push_back(system.sleep);
+      this->systemsUpdateNames.push_back(system.name);
+    }
 
     if (system.postupdate)
+    {
       this->systemsPostupdate.push_back(system.postupdate);
+      this->systemsPostupdateSleep.push_back(system.sleep);
+      this->systemsPostupdateNames.push_back(system.name);
+    }
+
+    if (system.memoryUsage)
+    {
+      this->systemsMemoryUsage.push_back(system.memoryUsage);
+      this->systemsMemoryUsageNames.push_back(system.name);
+    }
   }
 
   this->pendingSystems.clear();
@@ -185,6 +211,17 @@ void SystemManager::AddSystemImpl(
       *this->entityCompMgr);
   }
 
+  // Plugins are named after their class. Systems added directly get the
+  // world's SDF, so fall back to their type.
+  if (_system.name.empty())
+  {
+    if (_sdf && _sdf->GetName() == "plugin" && _sdf->HasAttribute("name"))
+      _system.name = _sdf->Get<std::string>("name");
+    else if (_system.system)
+      _system.name = typeid(*_system.system).name();
+    _system.name += " [" + std::to_string(_system.parentEntity) + "]";
+  }
+
   // Update callbacks will be handled later, add to queue
   std::lock_guard<std::mutex> lock(this->pendingSystemsMutex);
   this->pendingSystems.push_back(_system);
@@ -215,12 +252,77 @@ const std::vector<ISystemUpdate *>& SystemManager::SystemsUpdate()
   return this->systemsUpdate;
 }
 
+//////////////////////////////////////////////////
+const std::vector<ISystemComponentAccess *>&
+SystemManager::SystemsPreUpdateAccess()
+{
+  return this->systemsPreupdateAccess;
+}
+
+//////////////////////////////////////////////////
+const std::vector<ISystemComponentAccess *>&
+SystemManager::SystemsUpdateAccess()
+{
+  return this->systemsUpdateAccess;
+}
+
 //////////////////////////////////////////////////
 const std::vector<ISystemPostUpdate *>& SystemManager::SystemsPostUpdate()
 {
   return this->systemsPostupdate;
 }
 
+//////////////////////////////////////////////////
+const std::vector<ISystemSleep *> &SystemManager::SystemsPreUpdateSleep()
+    const
+{
+  return this->systemsPreupdateSleep;
+}
+
+//////////////////////////////////////////////////
+const std::vector<ISystemSleep *> &SystemManager::SystemsUpdateSleep() const
+{
+  return this->systemsUpdateSleep;
+}
+
+//////////////////////////////////////////////////
+const std::vector<ISystemSleep *> &SystemManager::SystemsPostUpdateSleep()
+    const
+{
+  return this->systemsPostupdateSleep;
+}
+
+//////////////////////////////////////////////////
+const std::vector<std::string> &SystemManager::SystemsPreUpdateNames() const
+{
+  return this->systemsPreupdateNames;
+}
+
+//////////////////////////////////////////////////
+const std::vector<std::string> &SystemManager::SystemsUpdateNames() const
+{
+  return this->systemsUpdateNames;
+}
+
+//////////////////////////////////////////////////
+const std::vector<std::string> &SystemManager::SystemsPostUpdateNames() const
+{
+  return this->systemsPostupdateNames;
+}
+
+//////////////////////////////////////////////////
+const std::vector<ISystemMemoryUsage *> &SystemManager::SystemsMemoryUsage()
+    const
+{
+  return this->systemsMemoryUsage;
+}
+
+//////////////////////////////////////////////////
+const std::vector<std::string> &SystemManager::SystemsMemoryUsageNames() const
+{
+  return this->systemsMemoryUsageNames;
+}
+
 //////////////////////////////////////////////////
 std::vector<SystemInternal> SystemManager::TotalByEntity(Entity _entity)
 {
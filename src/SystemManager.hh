@@ -52,13 +52,16 @@ namespace ignition
       /// \param[in] _eventMgr Pointer to the event manager to be used when
       ///  configuring new systems
       /// \param[in] _namespace Namespace to use for the transport node
+      /// \param[in] _parametersRegistry Registry of system parameters
+      /// \param[in] _advertise Whether to offer the entity system services
       public: explicit SystemManager(
         const SystemLoaderPtr &_systemLoader,
         EntityComponentManager *_entityCompMgr = nullptr,
         EventManager *_eventMgr = nullptr,
         const std::string &_namespace = std::string(),
         ignition::transport::parameters::ParametersRegistry *
-          _parametersRegistry = nullptr);
+          _parametersRegistry = nullptr,
+        bool _advertise = true);
 
       /// \brief Load system plugin for a given entity.
       /// \param[in] _entity Entity
@@ -116,10 +119,71 @@ namespace ignition
       /// \return Vector of systems's update interfaces.
       public: const std::vector<ISystemUpdate *>& SystemsUpdate();
 
+      /// \brief Get the component access declared by each system returned by
+      /// SystemsPreUpdate(), in the same order.
+      /// \return Vector of component access interfaces. An element is nullptr
+      /// if the corresponding system doesn't declare its component access.
+      public: const std::vector<ISystemComponentAccess *>&
+      SystemsPreUpdateAccess();
+
+      /// \brief Get the component access declared by each system returned by
+      /// SystemsUpdate(), in the same order.
+      /// \return Vector of component access interfaces. An element is nullptr
+      /// if the corresponding system doesn't declare its component access.
+      public: const std::vector<ISystemComponentAccess *>&
+      SystemsUpdateAccess();
+
       /// \brief Get an vector of all active systems implementing "PostUpdate"
       /// \return Vector of systems's post-update interfaces.
       public: const std::vector<ISystemPostUpdate *>& SystemsPostUpdate();
 
+      /// \brief Get the sleep interface of each system returned by
+      /// SystemsPreUpdate(), in the same order.
+      /// \return Vector of sleep interfaces. An element is nullptr if the
+      /// corresponding system never sleeps.
+      public: const std::vector<ISystemSleep *> &SystemsPreUpdateSleep()
+          const;
+
+      /// \brief Get the sleep interface of each system returned by
+      /// SystemsUpdate(), in the same order.
+      /// \return Vector of sleep interfaces. An element is nullptr if the
+      /// corresponding system never sleeps.
+      public: const std::vector<ISystemSleep *> &SystemsUpdateSleep() const;
+
+      /// \brief Get the sleep interface of each system returned by
+      /// SystemsPostUpdate(), in the same order.
+      /// \return Vector of sleep interfaces. An element is nullptr if the
+      /// corresponding system never sleeps.
+      public: const std::vector<ISystemSleep *> &SystemsPostUpdateSleep()
+          const;
+
+      /// \brief Get the names of the systems returned by SystemsPreUpdate(),
+      /// in the same order.
+      /// \return Vector of system names.
+      /// \sa SystemInternal::name
+      public: const std::vector<std::string> &SystemsPreUpdateNames() const;
+
+      /// \brief Get the names of the systems returned by SystemsUpdate(), in
+      /// the same order.
+      /// \return Vector of system names.
+      public: const std::vector<std::string> &SystemsUpdateNames() const;
+
+      /// \brief Get the names of the systems returned by
+      /// SystemsPostUpdate(), in the same order.
+      /// \return Vector of system names.
+      public: const std::vector<std::string> &SystemsPostUpdateNames() const;
+
+      /// \brief Get an vector of all active systems implementing
+      /// "MemoryUsage"
+      /// \return Vector of systems's memory usage interfaces.
+      public: const std::vector<ISystemMemoryUsage *> &SystemsMemoryUsage()
+          const;
+
+      /// \brief Get the names of the systems returned by
+      /// SystemsMemoryUsage(), in the same order.
+      /// \return Vector of system names.
+      public: const std::vector<std::string> &SystemsMemoryUsageNames() const;
+
       /// \brief Get an vector of all systems attached to a given entity.
       /// \return Vector of systems.
       public: std::vector<SystemInternal> TotalByEntity(Entity _entity);
@@ -181,9 +245,39 @@ namespace ignition
       /// \brief Systems implementing Update
       private: std::vector<ISystemUpdate *> systemsUpdate;
 
+      /// \brief Component access of the systems implementing PreUpdate
+      private: std::vector<ISystemComponentAccess *> systemsPreupdateAccess;
+
+      /// \brief Component access of the systems implementing Update
+      private: std::vector<ISystemComponentAccess *> systemsUpdateAccess;
+
       /// \brief Systems implementing PostUpdate
       private: std::vector<ISystemPostUpdate *> systemsPostupdate;
 
+      /// \brief Sleep interfaces of the systems implementing PreUpdate
+      private: std::vector<ISystemSleep *> systemsPreupdateSleep;
+
+      /// \brief Sleep interfaces of the systems implementing Update
+      private: std::vector<ISystemSleep *> systemsUpdateSleep;
+
+      /// \brief Sleep interfaces of the systems implementing PostUpdate
+      private: std::vector<ISystemSleep *> systemsPostupdateSleep;
+
+      /// \brief Names of the systems implementing PreUpdate
+      private: std::vector<std::string> systemsPreupdateNames;
+
+      /// \brief Names of the systems implementing Update
+      private: std::vector<std::string> systemsUpdateNames;
+
+      /// \brief Names of the systems implementing PostUpdate
+      private: std::vector<std::string> systemsPostupdateNames;
+
+      /// \brief Systems implementing MemoryUsage
+      private: std::vector<ISystemMemoryUsage *> systemsMemoryUsage;
+
+      /// \brief Names of the systems implementing MemoryUsage
+      private: std::vector<std::string> systemsMemoryUsageNames;
+
       /// \brief System loader, for loading system plugins.
       private: SystemLoaderPtr systemLoader;
 
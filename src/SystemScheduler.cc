@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "SystemScheduler.hh"
+
+#include <algorithm>
+#include <set>
+
+#include <ignition/common/Console.hh>
+
+/// \brief Component access of a single system.
+struct SystemAccess
+{
+  /// \brief True if the system didn't declare its access.
+  bool exclusive{true};
+
+  /// \brief Component types read by the system.
+  std::set<ignition::gazebo::ComponentTypeId> reads;
+
+  /// \brief Component types written by the system.
+  std::set<ignition::gazebo::ComponentTypeId> writes;
+};
+
+class ignition::gazebo::SystemSchedulerPrivate
+{
+  /// \brief Check if two systems can't run at the same time.
+  /// \param[in] _a First system.
+  /// \param[in] _b Second system.
+  /// \return True if the systems conflict.
+  public: static bool Conflict(const SystemAccess &_a, const SystemAccess &_b);
+
+  /// \brief Stages of system indices, in execution order.
+  public: std::vector<std::vector<std::size_t>> stages;
+};
+
+using namespace ignition::gazebo;
+
+/// \brief Check if two sorted sets have at least one element in common.
+/// \param[in] _a First set.
+/// \param[in] _b Second set.
+/// \return True if the sets intersect.
+static bool Intersects(const std::set<ComponentTypeId> &_a,
+    const std::set<ComponentTypeId> &_b)
+{
+  auto a = _a.begin();
+  auto b = _b.begin();
+  while (a != _a.end() && b != _b.end())
+  {
+    if (*a == *b)
+      return true;
+    if (*a < *b)
+      ++a;
+    else
+      ++b;
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+bool SystemSchedulerPrivate::Conflict(const SystemAccess &_a,
+    const SystemAccess &_b)
+{
+  if (_a.exclusive || _b.exclusive)
+    return true;
+
+  return Intersects(_a.writes, _b.writes) ||
+         Intersects(_a.writes, _b.reads) ||
+         Intersects(_a.reads, _b.writes);
+}
+
+//////////////////////////////////////////////////
+SystemScheduler::SystemScheduler()
+  : dataPtr(std::make_unique<SystemSchedulerPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+SystemScheduler::~SystemScheduler() = default;
+
+//////////////////////////////////////////////////
+void SystemScheduler::Build(
+    const std::vector<ISystemComponentAccess *> &_access)
+{
+  std::vector<SystemAccess> systems(_access.size());
+  for (std::size_t i = 0; i < _access.size(); ++i)
+  {
+    if (nullptr == _access[i])
+      continue;
+
+    systems[i].exclusive = false;
+    systems[i].reads = _access[i]->ReadComponents();
+    systems[i].writes = _access[i]->WriteComponents();
+  }
+
+  // Each system runs one stage after the latest earlier system it conflicts
+  // with. This is the longest path to the system in the dependency graph,
+  // where there's an edge from each system to every later conflicting system.
+  std::vector<std::size_t> stageOf(systems.size(), 0u);
+  std::size_t stageCount{0u};
+  for (std::size_t i = 0; i < systems.size(); ++i)
+  {
+    for (std::size_t j = 0; j < i; ++j)
+    {
+      if (SystemSchedulerPrivate::Conflict(systems[j], systems[i]))
+        stageOf[i] = std::max(stageOf[i], stageOf[j] + 1u);
+    }
+    stageCount = std::max(stageCount, stageOf[i] + 1u);
+  }
+
+  this->dataPtr->stages.assign(stageCount, {});
+  for (std::size_t i = 0; i < systems.size(); ++i)
+    this->dataPtr->stages[stageOf[i]].push_back(i);
+
+  igndbg << "Scheduled [" << systems.size() << "] systems in ["
+         << stageCount << "] stages." << std::endl;
+}
+
+//////////////////////////////////////////////////
+const std::vector<std::vector<std::size_t>> &SystemScheduler::Stages() const
+{
+  return this->dataPtr->stages;
+}
+
+//////////////////////////////////////////////////
+bool SystemScheduler::HasParallelStages() const
+{
+  return std::any_of(this->dataPtr->stages.begin(),
+      this->dataPtr->stages.end(), [](const auto &_stage)
+      {
+        return _stage.size() > 1u;
+      });
+}
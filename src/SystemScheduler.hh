@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMSCHEDULER_HH_
+#define IGNITION_GAZEBO_SYSTEMSCHEDULER_HH_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/System.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class SystemSchedulerPrivate;
+
+    /// \class SystemScheduler SystemScheduler.hh
+    /// \brief Groups the systems of one update phase into stages that can run
+    /// concurrently.
+    ///
+    /// Systems are ordered by the dependency graph implied by the component
+    /// types they read and write: if two systems conflict, the one added
+    /// first runs in an earlier stage. Systems within a stage don't conflict
+    /// with each other. Systems that don't declare their component access
+    /// conflict with all other systems, so they always get a stage of their
+    /// own.
+    class IGNITION_GAZEBO_VISIBLE SystemScheduler
+    {
+      /// \brief Constructor
+      public: SystemScheduler();
+
+      /// \brief Destructor
+      public: ~SystemScheduler();
+
+      /// \brief Compute the stages for a list of systems.
+      /// \param[in] _access Component access of each system, in the order the
+      /// systems were added. Null elements are systems that don't declare
+      /// their access.
+      public: void Build(const std::vector<ISystemComponentAccess *> &_access);
+
+      /// \brief Get the stages computed by the last call to Build.
+      /// \return Stages in execution order. Each stage holds the indices of
+      /// its systems in the vector passed to Build, in ascending order.
+      public: const std::vector<std::vector<std::size_t>> &Stages() const;
+
+      /// \brief Whether any stage has more than one system.
+      /// \return True if running the stages concurrently is worthwhile.
+      public: bool HasParallelStages() const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<SystemSchedulerPrivate> dataPtr;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_SYSTEMSCHEDULER_HH_
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "ignition/gazebo/System.hh"
+
+#include "SystemScheduler.hh"
+
+using namespace ignition::gazebo;
+
+/////////////////////////////////////////////////
+class AccessSystem : public ISystemComponentAccess
+{
+  public: AccessSystem(std::set<ComponentTypeId> _reads,
+                       std::set<ComponentTypeId> _writes)
+      : reads(std::move(_reads)), writes(std::move(_writes))
+  {
+  }
+
+  // Documentation inherited
+  public: std::set<ComponentTypeId> ReadComponents() const override
+  {
+    return this->reads;
+  }
+
+  // Documentation inherited
+  public: std::set<ComponentTypeId> WriteComponents() const override
+  {
+    return this->writes;
+  }
+
+  private: std::set<ComponentTypeId> reads;
+  private: std::set<ComponentTypeId> writes;
+};
+
+using Stages = std::vector<std::vector<std::size_t>>;
+
+/////////////////////////////////////////////////
+TEST(SystemScheduler, Empty)
+{
+  SystemScheduler scheduler;
+  EXPECT_TRUE(scheduler.Stages().empty());
+  EXPECT_FALSE(scheduler.HasParallelStages());
+
+  scheduler.Build({});
+  EXPECT_TRUE(scheduler.Stages().empty());
+}
+
+/////////////////////////////////////////////////
+TEST(SystemScheduler, Undeclared)
+{
+  // Systems without declared access run one at a time, in order
+  AccessSystem reader({1}, {});
+  SystemScheduler scheduler;
+  scheduler.Build({nullptr, &reader, nullptr, &reader});
+  EXPECT_EQ((Stages{{0}, {1}, {2}, {3}}), scheduler.Stages());
+  EXPECT_FALSE(scheduler.HasParallelStages());
+}
+
+/////////////////////////////////////////////////
+TEST(SystemScheduler, Conflicts)
+{
+  AccessSystem readA({1}, {});
+  AccessSystem readB({2}, {});
+  AccessSystem writeA({}, {1});
+  AccessSystem readAWriteB({1}, {2});
+  AccessSystem writeC({}, {3});
+
+  SystemScheduler scheduler;
+
+  // Readers of the same component can run together
+  scheduler.Build({&readA, &readA, &readB});
+  EXPECT_EQ((Stages{{0, 1, 2}}), scheduler.Stages());
+  EXPECT_TRUE(scheduler.HasParallelStages());
+
+  // A writer waits for earlier readers, later readers wait for the writer
+  scheduler.Build({&readA, &writeA, &readA, &writeC});
+  EXPECT_EQ((Stages{{0, 3}, {1}, {2}}), scheduler.Stages());
+
+  // Ordering follows the longest chain of conflicts
+  scheduler.Build({&writeA, &readAWriteB, &readB, &writeC, &readA});
+  EXPECT_EQ((Stages{{0, 3}, {1, 4}, {2}}), scheduler.Stages());
+
+  // An undeclared system splits everything around it
+  scheduler.Build({&readA, &readB, nullptr, &readA, &readB});
+  EXPECT_EQ((Stages{{0, 1}, {2}, {3, 4}}), scheduler.Stages());
+}
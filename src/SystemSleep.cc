@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "SystemSleep.hh"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/transport/Node.hh>
+
+/// \brief Messages received on a topic which wakes systems.
+struct TopicMessages
+{
+  /// \brief Number of messages received, incremented by transport.
+  std::atomic<uint64_t> count{0u};
+
+  /// \brief Number of messages received before the current step.
+  uint64_t atStep{0u};
+};
+
+/// \brief Sleep state of a system implementing ISystemSleep.
+struct SleepingSystem
+{
+  /// \brief The system.
+  ignition::gazebo::ISystemSleep *system{nullptr};
+
+  /// \brief Whether the system is asleep.
+  bool asleep{false};
+
+  /// \brief Simulation time when the system fell asleep.
+  std::chrono::steady_clock::duration since{0};
+
+  /// \brief Simulation time to wake at, if any.
+  std::optional<std::chrono::steady_clock::duration> simTime;
+
+  /// \brief Component types which wake the system.
+  std::vector<ignition::gazebo::ComponentTypeId> components;
+
+  /// \brief Latest component version before the system fell asleep.
+  uint64_t version{0u};
+
+  /// \brief Topics which wake the system, with the number of messages
+  /// received on each before the system fell asleep.
+  std::vector<std::pair<std::shared_ptr<TopicMessages>, uint64_t>> topics;
+};
+
+class ignition::gazebo::SystemSleepPrivate
+{
+  /// \brief Whether a system's conditions were met.
+  /// \param[in] _system System which is asleep.
+  /// \param[in] _info Information of the step about to run.
+  /// \param[in] _ecm Entity component manager.
+  /// \return True to wake the system.
+  public: bool ShouldWake(const SleepingSystem &_system,
+              const UpdateInfo &_info,
+              const EntityComponentManager &_ecm) const;
+
+  /// \brief Get the messages of a topic, subscribing to it the first time.
+  /// \param[in] _topic Topic name.
+  /// \return The messages, or nullptr if subscribing failed.
+  public: std::shared_ptr<TopicMessages> Topic(const std::string &_topic);
+
+  /// \brief Systems implementing ISystemSleep, each once.
+  public: std::vector<SleepingSystem> systems;
+
+  /// \brief Index into systems of each system, per phase, or npos for
+  /// systems which never sleep.
+  public: std::array<std::vector<std::size_t>, 3> phases;
+
+  /// \brief Latest component version before the current step.
+  public: uint64_t stepVersion{0u};
+
+  /// \brief Messages of each topic which wakes systems.
+  public: std::unordered_map<std::string, std::shared_ptr<TopicMessages>>
+      topics;
+
+  /// \brief Node used to subscribe to the topics, created when the first
+  /// system asks to wake on a topic.
+  public: std::unique_ptr<transport::Node> node;
+};
+
+using namespace ignition;
+using namespace gazebo;
+
+namespace
+{
+constexpr std::size_t kNoSystem = std::numeric_limits<std::size_t>::max();
+}
+
+//////////////////////////////////////////////////
+bool SystemSleepPrivate::ShouldWake(const SleepingSystem &_system,
+    const UpdateInfo &_info, const EntityComponentManager &_ecm) const
+{
+  // Simulation went back, such as on reset
+  if (_info.simTime < _system.since)
+    return true;
+
+  if (_system.simTime && _info.simTime >= *_system.simTime)
+    return true;
+
+  for (const auto &typeId : _system.components)
+  {
+    if (_ecm.ComponentTypeVersion(typeId) > _system.version)
+      return true;
+  }
+
+  for (const auto &[messages, count] : _system.topics)
+  {
+    if (messages->count.load() != count)
+      return true;
+  }
+
+  return false;
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<TopicMessages> SystemSleepPrivate::Topic(
+    const std::string &_topic)
+{
+  auto it = this->topics.find(_topic);
+  if (it != this->topics.end())
+    return it->second;
+
+  if (nullptr == this->node)
+    this->node = std::make_unique<transport::Node>();
+
+  auto messages = std::make_shared<TopicMessages>();
+  auto cb = [messages](const char *, const size_t,
+      const transport::MessageInfo &)
+  {
+    ++messages->count;
+  };
+  if (!this->node->SubscribeRaw(_topic, cb))
+  {
+    ignerr << "Failed to subscribe to [" << _topic
+           << "] to wake sleeping systems." << std::endl;
+    return nullptr;
+  }
+
+  this->topics[_topic] = messages;
+  return messages;
+}
+
+//////////////////////////////////////////////////
+SystemSleep::SystemSleep()
+  : dataPtr(std::make_unique<SystemSleepPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+SystemSleep::~SystemSleep() = default;
+
+//////////////////////////////////////////////////
+void SystemSleep::Build(const std::vector<ISystemSleep *> &_preUpdate,
+    const std::vector<ISystemSleep *> &_update,
+    const std::vector<ISystemSleep *> &_postUpdate)
+{
+  this->dataPtr->systems.clear();
+
+  // A system implementing several phases has a single state
+  std::unordered_map<ISystemSleep *, std::size_t> indices;
+  auto index = [&](ISystemSleep *_system)
+  {
+    if (nullptr == _system)
+      return kNoSystem;
+
+    auto [it, inserted] = indices.emplace(_system,
+        this->dataPtr->systems.size());
+    if (inserted)
+    {
+      SleepingSystem state;
+      state.system = _system;
+      this->dataPtr->systems.push_back(std::move(state));
+    }
+    return it->second;
+  };
+
+  const std::array<const std::vector<ISystemSleep *> *, 3> phases{
+      &_preUpdate, &_update, &_postUpdate};
+  for (std::size_t p = 0; p < phases.size(); ++p)
+  {
+    auto &phase = this->dataPtr->phases[p];
+    phase.clear();
+    for (auto *system : *phases[p])
+      phase.push_back(index(system));
+  }
+}
+
+//////////////////////////////////////////////////
+void SystemSleep::Wake(const UpdateInfo &_info,
+    const EntityComponentManager &_ecm)
+{
+  if (this->dataPtr->systems.empty())
+    return;
+
+  IGN_PROFILE("SystemSleep::Wake");
+  this->dataPtr->stepVersion = _ecm.CurrentVersion();
+  for (auto &[topic, messages] : this->dataPtr->topics)
+    messages->atStep = messages->count.load();
+
+  for (auto &system : this->dataPtr->systems)
+  {
+    if (system.asleep && this->dataPtr->ShouldWake(system, _info, _ecm))
+    {
+      system.asleep = false;
+      system.components.clear();
+      system.topics.clear();
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+bool SystemSleep::Asleep(SystemTimings::Phase _phase,
+    std::size_t _index) const
+{
+  const auto &phase = this->dataPtr->phases[static_cast<std::size_t>(_phase)];
+  if (_index >= phase.size() || phase[_index] == kNoSystem)
+    return false;
+
+  return this->dataPtr->systems[phase[_index]].asleep;
+}
+
+//////////////////////////////////////////////////
+void SystemSleep::Sleep(const UpdateInfo &_info)
+{
+  if (this->dataPtr->systems.empty())
+    return;
+
+  IGN_PROFILE("SystemSleep::Sleep");
+  for (auto &system : this->dataPtr->systems)
+  {
+    if (system.asleep)
+      continue;
+
+    SystemWake wake;
+    if (!system.system->Sleep(_info, wake))
+      continue;
+
+    system.asleep = true;
+    system.since = _info.simTime;
+    system.simTime = wake.simTime;
+    system.components = std::move(wake.components);
+    system.version = this->dataPtr->stepVersion;
+    for (const auto &topic : wake.topics)
+    {
+      // Messages received since the step started may not have been seen
+      // by the system yet
+      if (auto messages = this->dataPtr->Topic(topic))
+        system.topics.emplace_back(messages, messages->atStep);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+std::size_t SystemSleep::AsleepCount() const
+{
+  return static_cast<std::size_t>(std::count_if(
+      this->dataPtr->systems.begin(), this->dataPtr->systems.end(),
+      [](const SleepingSystem &_system)
+      {
+        return _system.asleep;
+      }));
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMSLEEP_HH_
+#define IGNITION_GAZEBO_SYSTEMSLEEP_HH_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/System.hh>
+#include <ignition/gazebo/Types.hh>
+
+#include "SystemTimings.hh"
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class SystemSleepPrivate;
+
+    /// \class SystemSleep SystemSleep.hh
+    /// \brief Keeps track of which systems implementing ISystemSleep are
+    /// asleep, so the simulation runner can skip them.
+    ///
+    /// At each step, Wake is called before the systems run, Asleep tells
+    /// whether to skip a system in a phase, and Sleep asks the systems which
+    /// ran whether they can sleep from the next step on. All functions must
+    /// be called from the simulation thread, except Asleep, which may be
+    /// called from any thread while systems run.
+    class IGNITION_GAZEBO_VISIBLE SystemSleep
+    {
+      /// \brief Constructor
+      public: SystemSleep();
+
+      /// \brief Destructor
+      public: ~SystemSleep();
+
+      /// \brief Set the systems of each phase, waking all systems.
+      /// \param[in] _preUpdate Sleep interface of each PreUpdate system, or
+      /// nullptr for systems which never sleep.
+      /// \param[in] _update Sleep interface of each Update system.
+      /// \param[in] _postUpdate Sleep interface of each PostUpdate system.
+      /// \sa SystemManager::SystemsPreUpdateSleep
+      public: void Build(const std::vector<ISystemSleep *> &_preUpdate,
+                  const std::vector<ISystemSleep *> &_update,
+                  const std::vector<ISystemSleep *> &_postUpdate);
+
+      /// \brief Wake the systems whose conditions were met since they fell
+      /// asleep. Call it before the systems run.
+      /// \param[in] _info Information of the step about to run.
+      /// \param[in] _ecm Entity component manager, to look for component
+      /// changes.
+      public: void Wake(const UpdateInfo &_info,
+                  const EntityComponentManager &_ecm);
+
+      /// \brief Whether a system is asleep.
+      /// \param[in] _phase Update phase.
+      /// \param[in] _index Index of the system within its phase.
+      /// \return True if the system should be skipped in this step.
+      public: bool Asleep(SystemTimings::Phase _phase,
+                  std::size_t _index) const;
+
+      /// \brief Ask the systems which are awake whether they can sleep.
+      /// Call it after the systems ran.
+      /// \param[in] _info Information of the step which just ran.
+      public: void Sleep(const UpdateInfo &_info);
+
+      /// \brief Number of systems which are asleep.
+      /// \return Number of systems.
+      public: std::size_t AsleepCount() const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<SystemSleepPrivate> dataPtr;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_SYSTEMSLEEP_HH_
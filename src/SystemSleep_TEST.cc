@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ignition/msgs/empty.pb.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/System.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/Pose.hh"
+
+#include "SystemSleep.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+using Phase = SystemTimings::Phase;
+
+/////////////////////////////////////////////////
+/// \brief System which sleeps with the conditions it's given.
+class SleepySystem : public ISystemSleep
+{
+  // Documentation inherited
+  public: bool Sleep(const UpdateInfo &, SystemWake &_wake) override
+  {
+    ++this->asked;
+    if (!this->sleep)
+      return false;
+
+    _wake = this->wake;
+    return true;
+  }
+
+  /// \brief Whether to sleep when asked.
+  public: bool sleep{true};
+
+  /// \brief Conditions to wake.
+  public: SystemWake wake;
+
+  /// \brief Number of times the system was asked to sleep.
+  public: int asked{0};
+};
+
+/////////////////////////////////////////////////
+/// \brief Run a step, as the simulation runner does, at a simulation time.
+void Step(SystemSleep &_sleep, UpdateInfo &_info,
+    const EntityComponentManager &_ecm,
+    std::chrono::steady_clock::duration _simTime)
+{
+  _info.simTime = _simTime;
+  ++_info.iterations;
+  _sleep.Wake(_info, _ecm);
+  _sleep.Sleep(_info);
+}
+
+/////////////////////////////////////////////////
+TEST(SystemSleep, Phases)
+{
+  SleepySystem a;
+  SleepySystem b;
+  b.sleep = false;
+
+  // a implements all phases, b only Update, and the rest never sleep
+  SystemSleep sleep;
+  sleep.Build({&a, nullptr}, {nullptr, &a, &b}, {&a});
+
+  EntityComponentManager ecm;
+  UpdateInfo info;
+  EXPECT_EQ(0u, sleep.AsleepCount());
+  EXPECT_FALSE(sleep.Asleep(Phase::PRE_UPDATE, 0u));
+
+  Step(sleep, info, ecm, 1ms);
+  EXPECT_EQ(1u, sleep.AsleepCount());
+  EXPECT_EQ(1, a.asked);
+  EXPECT_EQ(1, b.asked);
+
+  EXPECT_TRUE(sleep.Asleep(Phase::PRE_UPDATE, 0u));
+  EXPECT_FALSE(sleep.Asleep(Phase::PRE_UPDATE, 1u));
+  EXPECT_FALSE(sleep.Asleep(Phase::UPDATE, 0u));
+  EXPECT_TRUE(sleep.Asleep(Phase::UPDATE, 1u));
+  EXPECT_FALSE(sleep.Asleep(Phase::UPDATE, 2u));
+  EXPECT_TRUE(sleep.Asleep(Phase::POST_UPDATE, 0u));
+  EXPECT_FALSE(sleep.Asleep(Phase::POST_UPDATE, 1u));
+
+  // Sleeping systems aren't asked again
+  Step(sleep, info, ecm, 2ms);
+  EXPECT_EQ(1, a.asked);
+  EXPECT_EQ(2, b.asked);
+
+  // Setting the systems wakes them all
+  sleep.Build({&a, nullptr}, {nullptr, &a, &b}, {&a});
+  EXPECT_EQ(0u, sleep.AsleepCount());
+  EXPECT_FALSE(sleep.Asleep(Phase::PRE_UPDATE, 0u));
+}
+
+/////////////////////////////////////////////////
+TEST(SystemSleep, SimTime)
+{
+  SleepySystem system;
+  system.wake.simTime = 10ms;
+
+  SystemSleep sleep;
+  sleep.Build({&system}, {}, {});
+
+  EntityComponentManager ecm;
+  UpdateInfo info;
+  Step(sleep, info, ecm, 5ms);
+  EXPECT_TRUE(sleep.Asleep(Phase::PRE_UPDATE, 0u));
+
+  Step(sleep, info, ecm, 9ms);
+  EXPECT_TRUE(sleep.Asleep(Phase::PRE_UPDATE, 0u));
+  EXPECT_EQ(1, system.asked);
+
+  // Wakes for the step, and falls asleep again after it
+  info.simTime = 10ms;
+  sleep.Wake(info, ecm);
+  EXPECT_FALSE(sleep.Asleep(Phase::PRE_UPDATE, 0u));
+  sleep.Sleep(info);
+  EXPECT_EQ(2, system.asked);
+
+  // Going back in time wakes it, even without conditions
+  system.wake = SystemWake();
+  Step(sleep, info, ecm, 20ms);
+  EXPECT_EQ(3, system.asked);
+  Step(sleep, info, ecm, 30ms);
+  EXPECT_EQ(3, system.asked);
+
+  info.simTime = 0ms;
+  sleep.Wake(info, ecm);
+  EXPECT_FALSE(sleep.Asleep(Phase::PRE_UPDATE, 0u));
+}
+
+/////////////////////////////////////////////////
+TEST(SystemSleep, Components)
+{
+  SleepySystem system;
+  system.wake.components = {components::Name::typeId};
+
+  SystemSleep sleep;
+  sleep.Build({}, {&system}, {});
+
+  EntityComponentManager ecm;
+  auto entity = ecm.CreateEntity();
+  ecm.CreateComponent(entity, components::Name("before"));
+
+  // Changes made during the step in which it fell asleep count
+  UpdateInfo info;
+  info.simTime = 1ms;
+  sleep.Wake(info, ecm);
+  ecm.SetComponentData<components::Name>(entity, "during");
+  sleep.Sleep(info);
+  EXPECT_EQ(1, system.asked);
+
+  // So it wakes for a step, and falls asleep again
+  Step(sleep, info, ecm, 2ms);
+  EXPECT_EQ(2, system.asked);
+  Step(sleep, info, ecm, 3ms);
+  EXPECT_TRUE(sleep.Asleep(Phase::UPDATE, 0u));
+  EXPECT_EQ(2, system.asked);
+
+  // Other types don't wake it
+  ecm.CreateComponent(entity, components::Pose());
+  info.simTime = 4ms;
+  sleep.Wake(info, ecm);
+  EXPECT_TRUE(sleep.Asleep(Phase::UPDATE, 0u));
+
+  ecm.SetComponentData<components::Name>(entity, "after");
+  info.simTime = 5ms;
+  sleep.Wake(info, ecm);
+  EXPECT_FALSE(sleep.Asleep(Phase::UPDATE, 0u));
+}
+
+/////////////////////////////////////////////////
+TEST(SystemSleep, Topics)
+{
+  const std::string topic = "/system_sleep_test/wake";
+  SleepySystem system;
+  system.wake.topics = {topic};
+
+  SystemSleep sleep;
+  sleep.Build({}, {}, {&system});
+
+  EntityComponentManager ecm;
+  UpdateInfo info;
+  Step(sleep, info, ecm, 1ms);
+  EXPECT_TRUE(sleep.Asleep(Phase::POST_UPDATE, 0u));
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Empty>(topic);
+
+  // Wait for the subscriber to be discovered
+  for (int i = 0; i < 100 && !pub.HasConnections(); ++i)
+    std::this_thread::sleep_for(10ms);
+  ASSERT_TRUE(pub.HasConnections());
+
+  info.simTime = 2ms;
+  sleep.Wake(info, ecm);
+  EXPECT_TRUE(sleep.Asleep(Phase::POST_UPDATE, 0u));
+
+  pub.Publish(msgs::Empty());
+  bool awake{false};
+  for (int i = 0; i < 100 && !awake; ++i)
+  {
+    std::this_thread::sleep_for(10ms);
+    sleep.Wake(info, ecm);
+    awake = !sleep.Asleep(Phase::POST_UPDATE, 0u);
+  }
+  EXPECT_TRUE(awake);
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "SystemTimings.hh"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/// \brief Ring buffer of the samples of one system in one phase.
+struct SystemSamples
+{
+  /// \brief Wall times in nanoseconds. Sized to the capacity up front.
+  std::vector<int64_t> values;
+
+  /// \brief Index where the next sample is written.
+  std::size_t next{0u};
+
+  /// \brief Number of valid samples, up to the capacity.
+  std::size_t count{0u};
+};
+
+class ignition::gazebo::SystemTimingsPrivate
+{
+  /// \brief Number of samples kept per system and phase.
+  public: std::size_t capacity{0u};
+
+  /// \brief Samples of each system, per phase.
+  public: std::array<std::vector<SystemSamples>, 3> phases;
+};
+
+using namespace ignition::gazebo;
+
+//////////////////////////////////////////////////
+SystemTimings::SystemTimings(std::size_t _capacity)
+  : dataPtr(std::make_unique<SystemTimingsPrivate>())
+{
+  this->dataPtr->capacity = std::max<std::size_t>(_capacity, 1u);
+}
+
+//////////////////////////////////////////////////
+SystemTimings::~SystemTimings() = default;
+
+//////////////////////////////////////////////////
+void SystemTimings::Resize(Phase _phase, std::size_t _count)
+{
+  auto &systems = this->dataPtr->phases[static_cast<std::size_t>(_phase)];
+  const auto previous = systems.size();
+  systems.resize(_count);
+  for (std::size_t i = previous; i < _count; ++i)
+    systems[i].values.resize(this->dataPtr->capacity);
+}
+
+//////////////////////////////////////////////////
+std::size_t SystemTimings::Count(Phase _phase) const
+{
+  return this->dataPtr->phases[static_cast<std::size_t>(_phase)].size();
+}
+
+//////////////////////////////////////////////////
+void SystemTimings::Record(Phase _phase, std::size_t _index,
+    std::chrono::steady_clock::duration _duration)
+{
+  auto &systems = this->dataPtr->phases[static_cast<std::size_t>(_phase)];
+  if (_index >= systems.size())
+    return;
+
+  auto &samples = systems[_index];
+  samples.values[samples.next] =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(_duration).count();
+  samples.next = (samples.next + 1u) % samples.values.size();
+  samples.count = std::min(samples.count + 1u, samples.values.size());
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration SystemTimings::Last(Phase _phase,
+    std::size_t _index) const
+{
+  const auto &systems =
+      this->dataPtr->phases[static_cast<std::size_t>(_phase)];
+  if (_index >= systems.size() || systems[_index].count == 0u)
+    return std::chrono::steady_clock::duration::zero();
+
+  const auto &samples = systems[_index];
+  const auto last =
+      (samples.next + samples.values.size() - 1u) % samples.values.size();
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::nanoseconds(samples.values[last]));
+}
+
+//////////////////////////////////////////////////
+SystemTimings::Statistics SystemTimings::Compute(Phase _phase,
+    std::size_t _index) const
+{
+  Statistics stats;
+  const auto &systems =
+      this->dataPtr->phases[static_cast<std::size_t>(_phase)];
+  if (_index >= systems.size() || systems[_index].count == 0u)
+    return stats;
+
+  // While the buffer isn't full, samples are at the beginning
+  const auto &samples = systems[_index];
+  std::vector<int64_t> sorted(samples.values.begin(),
+      samples.values.begin() + static_cast<std::ptrdiff_t>(samples.count));
+  std::sort(sorted.begin(), sorted.end());
+
+  auto toDuration = [](double _ns)
+  {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::nano>(_ns));
+  };
+
+  // Nearest rank
+  auto percentile = [&](double _p)
+  {
+    auto rank = static_cast<std::size_t>(
+        std::ceil(_p * static_cast<double>(sorted.size())));
+    return toDuration(static_cast<double>(
+        sorted[std::clamp<std::size_t>(rank, 1u, sorted.size()) - 1u]));
+  };
+
+  double sum{0.0};
+  for (auto value : sorted)
+    sum += static_cast<double>(value);
+
+  stats.samples = sorted.size();
+  stats.mean = toDuration(sum / static_cast<double>(sorted.size()));
+  stats.p50 = percentile(0.5);
+  stats.p90 = percentile(0.9);
+  stats.p99 = percentile(0.99);
+  stats.max = toDuration(static_cast<double>(sorted.back()));
+  return stats;
+}
+
+//////////////////////////////////////////////////
+void SystemTimings::Clear()
+{
+  for (auto &systems : this->dataPtr->phases)
+  {
+    for (auto &samples : systems)
+    {
+      samples.next = 0u;
+      samples.count = 0u;
+    }
+  }
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMTIMINGS_HH_
+#define IGNITION_GAZEBO_SYSTEMTIMINGS_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class SystemTimingsPrivate;
+
+    /// \class SystemTimings SystemTimings.hh
+    /// \brief Keeps the most recent wall times of each system in each update
+    /// phase.
+    ///
+    /// Each system has a fixed size ring buffer per phase, allocated up
+    /// front, so recording a sample never allocates. Recording samples of
+    /// different systems from different threads at the same time is safe,
+    /// which lets systems that run concurrently time themselves. All other
+    /// functions must not be called while samples are being recorded.
+    class IGNITION_GAZEBO_VISIBLE SystemTimings
+    {
+      /// \brief Update phases which are timed.
+      public: enum class Phase
+      {
+        /// \brief ISystemPreUpdate::PreUpdate
+        PRE_UPDATE = 0,
+
+        /// \brief ISystemUpdate::Update
+        UPDATE = 1,
+
+        /// \brief ISystemPostUpdate::PostUpdate
+        POST_UPDATE = 2
+      };
+
+      /// \brief Statistics of the samples of one system in one phase.
+      public: struct Statistics
+      {
+        /// \brief Number of samples the statistics were computed from.
+        std::size_t samples{0u};
+
+        /// \brief Average wall time.
+        std::chrono::steady_clock::duration mean{0};
+
+        /// \brief Median wall time.
+        std::chrono::steady_clock::duration p50{0};
+
+        /// \brief 90th percentile of the wall time.
+        std::chrono::steady_clock::duration p90{0};
+
+        /// \brief 99th percentile of the wall time.
+        std::chrono::steady_clock::duration p99{0};
+
+        /// \brief Longest wall time.
+        std::chrono::steady_clock::duration max{0};
+      };
+
+      /// \brief Constructor
+      /// \param[in] _capacity Number of samples kept per system and phase.
+      public: explicit SystemTimings(std::size_t _capacity = 1024u);
+
+      /// \brief Destructor
+      public: ~SystemTimings();
+
+      /// \brief Set the number of systems in a phase. Samples of systems
+      /// which are kept are preserved.
+      /// \param[in] _phase Update phase.
+      /// \param[in] _count Number of systems.
+      public: void Resize(Phase _phase, std::size_t _count);
+
+      /// \brief Number of systems in a phase.
+      /// \param[in] _phase Update phase.
+      /// \return Number of systems.
+      public: std::size_t Count(Phase _phase) const;
+
+      /// \brief Record the wall time of one update of a system, replacing
+      /// the oldest sample once the buffer is full.
+      /// \param[in] _phase Update phase.
+      /// \param[in] _index Index of the system within its phase.
+      /// \param[in] _duration Wall time.
+      public: void Record(Phase _phase, std::size_t _index,
+                  std::chrono::steady_clock::duration _duration);
+
+      /// \brief Most recent sample of a system.
+      /// \param[in] _phase Update phase.
+      /// \param[in] _index Index of the system within its phase.
+      /// \return Wall time of the last update, or zero if there are no
+      /// samples.
+      public: std::chrono::steady_clock::duration Last(Phase _phase,
+                  std::size_t _index) const;
+
+      /// \brief Compute statistics of the samples of a system.
+      /// \param[in] _phase Update phase.
+      /// \param[in] _index Index of the system within its phase.
+      /// \return Statistics, with zero samples if the index is out of range.
+      public: Statistics Compute(Phase _phase, std::size_t _index) const;
+
+      /// \brief Drop all samples, keeping the number of systems.
+      public: void Clear();
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<SystemTimingsPrivate> dataPtr;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_SYSTEMTIMINGS_HH_
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "SystemTimings.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+using Phase = SystemTimings::Phase;
+
+/////////////////////////////////////////////////
+TEST(SystemTimings, Statistics)
+{
+  SystemTimings timings(100u);
+  timings.Resize(Phase::UPDATE, 2u);
+  EXPECT_EQ(0u, timings.Count(Phase::PRE_UPDATE));
+  EXPECT_EQ(2u, timings.Count(Phase::UPDATE));
+
+  // No samples yet
+  EXPECT_EQ(0u, timings.Compute(Phase::UPDATE, 0u).samples);
+  EXPECT_EQ(0ns, timings.Last(Phase::UPDATE, 0u));
+
+  for (int i = 1; i <= 100; ++i)
+    timings.Record(Phase::UPDATE, 0u, std::chrono::microseconds(i));
+  timings.Record(Phase::UPDATE, 1u, 5ms);
+
+  EXPECT_EQ(100us, timings.Last(Phase::UPDATE, 0u));
+  EXPECT_EQ(5ms, timings.Last(Phase::UPDATE, 1u));
+
+  auto stats = timings.Compute(Phase::UPDATE, 0u);
+  EXPECT_EQ(100u, stats.samples);
+  EXPECT_EQ(50us, stats.p50);
+  EXPECT_EQ(90us, stats.p90);
+  EXPECT_EQ(99us, stats.p99);
+  EXPECT_EQ(100us, stats.max);
+  using Micros = std::chrono::duration<double, std::micro>;
+  EXPECT_NEAR(50.5, Micros(stats.mean).count(), 1e-6);
+
+  stats = timings.Compute(Phase::UPDATE, 1u);
+  EXPECT_EQ(1u, stats.samples);
+  EXPECT_EQ(5ms, stats.p50);
+  EXPECT_EQ(5ms, stats.p99);
+
+  // Out of range
+  timings.Record(Phase::UPDATE, 2u, 1ms);
+  EXPECT_EQ(0u, timings.Compute(Phase::UPDATE, 2u).samples);
+  EXPECT_EQ(0u, timings.Compute(Phase::POST_UPDATE, 0u).samples);
+}
+
+/////////////////////////////////////////////////
+TEST(SystemTimings, RingBuffer)
+{
+  SystemTimings timings(4u);
+  timings.Resize(Phase::PRE_UPDATE, 1u);
+
+  // Only the last 4 samples are kept
+  for (int i = 1; i <= 10; ++i)
+    timings.Record(Phase::PRE_UPDATE, 0u, std::chrono::milliseconds(i));
+
+  auto stats = timings.Compute(Phase::PRE_UPDATE, 0u);
+  EXPECT_EQ(4u, stats.samples);
+  EXPECT_EQ(10ms, stats.max);
+  EXPECT_EQ(8ms, stats.p50);
+  EXPECT_EQ(10ms, timings.Last(Phase::PRE_UPDATE, 0u));
+
+  // Growing keeps existing samples
+  timings.Resize(Phase::PRE_UPDATE, 3u);
+  EXPECT_EQ(4u, timings.Compute(Phase::PRE_UPDATE, 0u).samples);
+  EXPECT_EQ(0u, timings.Compute(Phase::PRE_UPDATE, 2u).samples);
+
+  timings.Clear();
+  EXPECT_EQ(3u, timings.Count(Phase::PRE_UPDATE));
+  EXPECT_EQ(0u, timings.Compute(Phase::PRE_UPDATE, 0u).samples);
+}
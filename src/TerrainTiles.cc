@@ -0,0 +1,404 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ignition/gazebo/TerrainTiles.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+#include <utility>
+
+#include <ignition/common/Profiler.hh>
+#include <ignition/math/Helpers.hh>
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Heightmap data of one level of detail of a tile, whose heights
+/// are already scaled to the terrain's size.
+class TileHeightmapData : public common::HeightmapData
+{
+  /// \brief Constructor
+  /// \param[in] _samples Samples along a side.
+  /// \param[in] _heights Heights, row by row.
+  /// \param[in] _minElevation Minimum elevation of the whole terrain.
+  /// \param[in] _maxElevation Maximum elevation of the whole terrain.
+  /// \param[in] _name Unique name of the tile.
+  public: TileHeightmapData(unsigned int _samples,
+      std::vector<float> &&_heights, float _minElevation,
+      float _maxElevation, std::string _name)
+    : samples(_samples), heights(std::move(_heights)),
+      minElevation(_minElevation), maxElevation(_maxElevation),
+      name(std::move(_name))
+  {
+  }
+
+  // Documentation inherited
+  public: void FillHeightMap(int _subSampling, unsigned int _vertSize,
+      const math::Vector3d &, const math::Vector3d &, bool _flipY,
+      std::vector<float> &_heights) const override
+  {
+    // Samples in between the tile's are interpolated, as image heightmaps
+    // do
+    const double sub = std::max(1, _subSampling);
+    const unsigned int last = this->samples - 1u;
+    _heights.resize(_vertSize * _vertSize);
+    for (unsigned int y = 0; y < _vertSize; ++y)
+    {
+      const double yf = std::min(static_cast<double>(last), y / sub);
+      const auto y1 = static_cast<unsigned int>(std::floor(yf));
+      const auto y2 = std::min(last, y1 + 1u);
+      const double dy = yf - y1;
+      const unsigned int row = _flipY ? _vertSize - y - 1u : y;
+      for (unsigned int x = 0; x < _vertSize; ++x)
+      {
+        const double xf = std::min(static_cast<double>(last), x / sub);
+        const auto x1 = static_cast<unsigned int>(std::floor(xf));
+        const auto x2 = std::min(last, x1 + 1u);
+        const double dx = xf - x1;
+        const double top = this->Sample(x1, y1) * (1.0 - dx) +
+            this->Sample(x2, y1) * dx;
+        const double bottom = this->Sample(x1, y2) * (1.0 - dx) +
+            this->Sample(x2, y2) * dx;
+        _heights[row * _vertSize + x] =
+            static_cast<float>(top * (1.0 - dy) + bottom * dy);
+      }
+    }
+  }
+
+  // Documentation inherited
+  public: unsigned int Height() const override
+  {
+    return this->samples;
+  }
+
+  // Documentation inherited
+  public: unsigned int Width() const override
+  {
+    return this->samples;
+  }
+
+  // Documentation inherited
+  public: float MaxElevation() const override
+  {
+    return this->maxElevation;
+  }
+
+  // Documentation inherited
+  public: float MinElevation() const override
+  {
+    return this->minElevation;
+  }
+
+  // Documentation inherited
+  public: std::string Filename() const override
+  {
+    return this->name;
+  }
+
+  /// \brief Height of a sample.
+  /// \param[in] _x Column.
+  /// \param[in] _y Row.
+  /// \return Height.
+  private: double Sample(unsigned int _x, unsigned int _y) const
+  {
+    return this->heights[_y * this->samples + _x];
+  }
+
+  /// \brief Samples along a side.
+  private: unsigned int samples{0u};
+
+  /// \brief Heights, row by row.
+  private: std::vector<float> heights;
+
+  /// \brief Minimum elevation of the whole terrain.
+  private: float minElevation{0.0f};
+
+  /// \brief Maximum elevation of the whole terrain.
+  private: float maxElevation{0.0f};
+
+  /// \brief Unique name of the tile.
+  private: std::string name;
+};
+
+/// \brief Private data of TerrainTiles
+class ignition::gazebo::TerrainTilesPrivate
+{
+  /// \brief Samples along a side of the whole terrain.
+  /// \param[in] _data Heightmap data.
+  /// \param[in] _sampling Samples per heightmap datum.
+  /// \return Samples.
+  public: static unsigned int TerrainSamples(
+      const common::HeightmapData &_data, unsigned int _sampling);
+
+  /// \brief Whether tiles of a size can be split from a terrain.
+  /// \param[in] _samples Samples along a side of the terrain.
+  /// \param[in] _tileSamples Samples along a side of a tile.
+  /// \return True if the terrain splits evenly into more than one tile.
+  public: static bool Splits(unsigned int _samples,
+      unsigned int _tileSamples);
+
+  /// \brief Heights of the whole terrain, row by row.
+  public: std::vector<float> heights;
+
+  /// \brief Samples along a side of the whole terrain.
+  public: unsigned int samples{0u};
+
+  /// \brief Samples along a side of a tile.
+  public: unsigned int tileSamples{0u};
+
+  /// \brief Tiles along a side of the terrain.
+  public: unsigned int tilesPerSide{0u};
+
+  /// \brief Levels of detail of each tile.
+  public: unsigned int lodCount{0u};
+
+  /// \brief Size of the whole terrain.
+  public: math::Vector3d size;
+
+  /// \brief Offset of the terrain.
+  public: math::Vector3d position;
+
+  /// \brief Minimum elevation of the heightmap data.
+  public: float minElevation{0.0f};
+
+  /// \brief Maximum elevation of the heightmap data.
+  public: float maxElevation{0.0f};
+
+  /// \brief Name of the heightmap data, used to name tiles.
+  public: std::string name;
+};
+
+//////////////////////////////////////////////////
+unsigned int TerrainTilesPrivate::TerrainSamples(
+    const common::HeightmapData &_data, unsigned int _sampling)
+{
+  const unsigned int sampling = std::max(1u, _sampling);
+  if (_data.Width() == 0u)
+    return 0u;
+  return _data.Width() * sampling - sampling + 1u;
+}
+
+//////////////////////////////////////////////////
+bool TerrainTilesPrivate::Splits(unsigned int _samples,
+    unsigned int _tileSamples)
+{
+  // Every level of detail halves the samples between the tile's edges
+  if (_tileSamples < 3u || !math::isPowerOfTwo(_tileSamples - 1u))
+    return false;
+  return _samples > _tileSamples &&
+      (_samples - 1u) % (_tileSamples - 1u) == 0u;
+}
+
+//////////////////////////////////////////////////
+TerrainTiles::TerrainTiles()
+  : dataPtr(std::make_unique<TerrainTilesPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+TerrainTiles::~TerrainTiles() = default;
+
+//////////////////////////////////////////////////
+bool TerrainTiles::Tiled(const common::HeightmapData &_data,
+    unsigned int _sampling, unsigned int _tileSamples)
+{
+  return _data.Width() == _data.Height() &&
+      TerrainTilesPrivate::Splits(
+      TerrainTilesPrivate::TerrainSamples(_data, _sampling), _tileSamples);
+}
+
+//////////////////////////////////////////////////
+bool TerrainTiles::Load(const common::HeightmapData &_data,
+    const math::Vector3d &_size, const math::Vector3d &_position,
+    unsigned int _sampling, unsigned int _tileSamples)
+{
+  IGN_PROFILE("TerrainTiles::Load");
+  auto &data = *this->dataPtr;
+  data = TerrainTilesPrivate();
+  if (!Tiled(_data, _sampling, _tileSamples))
+    return false;
+
+  // Heights are computed as physics engines do for whole heightmaps
+  const unsigned int samples =
+      TerrainTilesPrivate::TerrainSamples(_data, _sampling);
+  math::Vector3d scale;
+  scale.X(_size.X() / samples);
+  scale.Y(_size.Y() / samples);
+  if (math::equal(_data.MaxElevation(), 0.0f))
+    scale.Z(std::fabs(_size.Z()));
+  else
+    scale.Z(std::fabs(_size.Z()) / _data.MaxElevation());
+  _data.FillHeightMap(static_cast<int>(std::max(1u, _sampling)), samples,
+      _size, scale, false, data.heights);
+  if (data.heights.size() != static_cast<std::size_t>(samples) * samples)
+  {
+    data = TerrainTilesPrivate();
+    return false;
+  }
+
+  data.samples = samples;
+  data.tileSamples = _tileSamples;
+  data.tilesPerSide = (samples - 1u) / (_tileSamples - 1u);
+  for (unsigned int s = _tileSamples - 1u; s >= 2u; s /= 2u)
+    ++data.lodCount;
+  data.size = _size;
+  data.position = _position;
+  data.minElevation = _data.MinElevation();
+  data.maxElevation = _data.MaxElevation();
+  data.name = _data.Filename();
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::size_t TerrainTiles::TileCount() const
+{
+  return static_cast<std::size_t>(this->dataPtr->tilesPerSide) *
+      this->dataPtr->tilesPerSide;
+}
+
+//////////////////////////////////////////////////
+unsigned int TerrainTiles::LodCount() const
+{
+  return this->dataPtr->lodCount;
+}
+
+//////////////////////////////////////////////////
+math::Vector3d TerrainTiles::TileSize() const
+{
+  const auto &data = *this->dataPtr;
+  if (data.tilesPerSide == 0u)
+    return math::Vector3d::Zero;
+  return {data.size.X() / data.tilesPerSide,
+      data.size.Y() / data.tilesPerSide, data.size.Z()};
+}
+
+//////////////////////////////////////////////////
+math::Vector3d TerrainTiles::TilePosition(std::size_t _index) const
+{
+  const auto &data = *this->dataPtr;
+  if (_index >= this->TileCount())
+    return data.position;
+
+  const auto tileSize = this->TileSize();
+  const auto row = _index / data.tilesPerSide;
+  const auto col = _index % data.tilesPerSide;
+  return {data.position.X() - data.size.X() * 0.5 +
+          (col + 0.5) * tileSize.X(),
+      data.position.Y() + data.size.Y() * 0.5 - (row + 0.5) * tileSize.Y(),
+      data.position.Z()};
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<common::HeightmapData> TerrainTiles::TileData(
+    std::size_t _index, unsigned int _lod) const
+{
+  const auto &data = *this->dataPtr;
+  if (_index >= this->TileCount() || _lod >= data.lodCount)
+    return nullptr;
+
+  // Lower levels keep every other sample of the level above, so the
+  // corners of the tile and of its neighbors still match
+  const std::size_t stride = std::size_t{1u} << _lod;
+  const unsigned int samples = ((data.tileSamples - 1u) >> _lod) + 1u;
+  const std::size_t firstRow = (_index / data.tilesPerSide) *
+      (data.tileSamples - 1u);
+  const std::size_t firstCol = (_index % data.tilesPerSide) *
+      (data.tileSamples - 1u);
+
+  std::vector<float> heights;
+  heights.reserve(static_cast<std::size_t>(samples) * samples);
+  for (unsigned int r = 0; r < samples; ++r)
+  {
+    const float *row = &data.heights[(firstRow + r * stride) * data.samples +
+        firstCol];
+    for (unsigned int c = 0; c < samples; ++c)
+      heights.push_back(row[c * stride]);
+  }
+
+  return std::make_shared<TileHeightmapData>(samples, std::move(heights),
+      data.minElevation, data.maxElevation, data.name + "_tile_" +
+      std::to_string(_index) + "_lod_" + std::to_string(_lod));
+}
+
+//////////////////////////////////////////////////
+void TerrainTiles::Select(const std::vector<math::Vector3d> &_points,
+    double _radius, double _lodDistance, std::vector<Tile> &_tiles) const
+{
+  IGN_PROFILE("TerrainTiles::Select");
+  _tiles.clear();
+  const auto &data = *this->dataPtr;
+  if (data.tilesPerSide == 0u || _radius <= 0.0)
+    return;
+
+  const auto tileSize = this->TileSize();
+  const double left = data.position.X() - data.size.X() * 0.5;
+  const double top = data.position.Y() + data.size.Y() * 0.5;
+  const int maxTile = static_cast<int>(data.tilesPerSide) - 1;
+
+  // Distance from each selected tile to its closest point
+  std::map<std::size_t, double> distances;
+  for (const auto &point : _points)
+  {
+    // Only the tiles in the square around the point are checked
+    const double x = point.X() - left;
+    const double y = top - point.Y();
+    const int firstCol = std::max(0,
+        static_cast<int>(std::floor((x - _radius) / tileSize.X())));
+    const int lastCol = std::min(maxTile,
+        static_cast<int>(std::floor((x + _radius) / tileSize.X())));
+    const int firstRow = std::max(0,
+        static_cast<int>(std::floor((y - _radius) / tileSize.Y())));
+    const int lastRow = std::min(maxTile,
+        static_cast<int>(std::floor((y + _radius) / tileSize.Y())));
+
+    for (int row = firstRow; row <= lastRow; ++row)
+    {
+      const double minY = row * tileSize.Y();
+      const double dy = std::max({0.0, minY - y, y - minY - tileSize.Y()});
+      for (int col = firstCol; col <= lastCol; ++col)
+      {
+        const double minX = col * tileSize.X();
+        const double dx =
+            std::max({0.0, minX - x, x - minX - tileSize.X()});
+        const double distance = std::sqrt(dx * dx + dy * dy);
+        if (distance >= _radius)
+          continue;
+
+        const auto index = static_cast<std::size_t>(row) *
+            data.tilesPerSide + static_cast<std::size_t>(col);
+        auto it = distances.emplace(index, distance).first;
+        it->second = std::min(it->second, distance);
+      }
+    }
+  }
+
+  _tiles.reserve(distances.size());
+  for (const auto &[index, distance] : distances)
+  {
+    Tile tile;
+    tile.index = index;
+    if (_lodDistance > 0.0 && distance >= _lodDistance)
+    {
+      const auto lod = 1.0 + std::floor(std::log2(distance / _lodDistance));
+      tile.lod = static_cast<unsigned int>(std::min(lod,
+          static_cast<double>(data.lodCount - 1u)));
+    }
+    _tiles.push_back(tile);
+  }
+}
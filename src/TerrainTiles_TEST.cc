@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "ignition/gazebo/TerrainTiles.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Heightmap whose datum at column x and row y is x + 10 y.
+class TestHeightmapData : public common::HeightmapData
+{
+  /// \brief Constructor
+  /// \param[in] _width Data along x.
+  /// \param[in] _height Data along y.
+  public: TestHeightmapData(unsigned int _width, unsigned int _height)
+    : width(_width), height(_height)
+  {
+  }
+
+  // Documentation inherited
+  public: void FillHeightMap(int _subSampling, unsigned int _vertSize,
+      const math::Vector3d &, const math::Vector3d &_scale, bool,
+      std::vector<float> &_heights) const override
+  {
+    _heights.resize(_vertSize * _vertSize);
+    for (unsigned int y = 0; y < _vertSize; ++y)
+    {
+      for (unsigned int x = 0; x < _vertSize; ++x)
+      {
+        _heights[y * _vertSize + x] = static_cast<float>(
+            Datum(x / _subSampling, y / _subSampling) * _scale.Z());
+      }
+    }
+  }
+
+  // Documentation inherited
+  public: unsigned int Height() const override
+  {
+    return this->height;
+  }
+
+  // Documentation inherited
+  public: unsigned int Width() const override
+  {
+    return this->width;
+  }
+
+  // Documentation inherited
+  public: float MaxElevation() const override
+  {
+    return static_cast<float>(Datum(this->width - 1, this->height - 1));
+  }
+
+  // Documentation inherited
+  public: float MinElevation() const override
+  {
+    return 0.0f;
+  }
+
+  // Documentation inherited
+  public: std::string Filename() const override
+  {
+    return "test";
+  }
+
+  /// \brief Value of a datum.
+  /// \param[in] _x Column.
+  /// \param[in] _y Row.
+  /// \return Value.
+  public: static double Datum(unsigned int _x, unsigned int _y)
+  {
+    return _x + 10.0 * _y;
+  }
+
+  /// \brief Data along x.
+  private: unsigned int width;
+
+  /// \brief Data along y.
+  private: unsigned int height;
+};
+
+/////////////////////////////////////////////////
+TEST(TerrainTiles, Tiled)
+{
+  TestHeightmapData data(9, 9);
+  EXPECT_TRUE(TerrainTiles::Tiled(data, 1, 5));
+  EXPECT_TRUE(TerrainTiles::Tiled(data, 2, 9));
+  EXPECT_TRUE(TerrainTiles::Tiled(data, 1, 3));
+
+  // A single tile
+  EXPECT_FALSE(TerrainTiles::Tiled(data, 1, 9));
+
+  // Not a power of two plus one
+  EXPECT_FALSE(TerrainTiles::Tiled(data, 1, 4));
+  EXPECT_FALSE(TerrainTiles::Tiled(data, 1, 7));
+
+  // Doesn't split evenly
+  EXPECT_FALSE(TerrainTiles::Tiled(TestHeightmapData(10, 10), 1, 5));
+
+  // Not square
+  EXPECT_FALSE(TerrainTiles::Tiled(TestHeightmapData(9, 17), 1, 5));
+
+  TerrainTiles tiles;
+  EXPECT_FALSE(tiles.Load(TestHeightmapData(10, 10), {8, 8, 1}, {}, 1, 5));
+  EXPECT_EQ(0u, tiles.TileCount());
+  EXPECT_EQ(nullptr, tiles.TileData(0, 0));
+}
+
+/////////////////////////////////////////////////
+TEST(TerrainTiles, Tiles)
+{
+  TestHeightmapData data(9, 9);
+  TerrainTiles tiles;
+  ASSERT_TRUE(tiles.Load(data, {8, 8, 88}, {1, 2, 3}, 1, 5));
+  EXPECT_EQ(4u, tiles.TileCount());
+  EXPECT_EQ(2u, tiles.LodCount());
+  EXPECT_EQ(math::Vector3d(4, 4, 88), tiles.TileSize());
+
+  // Rows go from +y to -y
+  EXPECT_EQ(math::Vector3d(-1, 4, 3), tiles.TilePosition(0));
+  EXPECT_EQ(math::Vector3d(3, 4, 3), tiles.TilePosition(1));
+  EXPECT_EQ(math::Vector3d(-1, 0, 3), tiles.TilePosition(2));
+  EXPECT_EQ(math::Vector3d(3, 0, 3), tiles.TilePosition(3));
+
+  // Full resolution of the second tile
+  auto tile = tiles.TileData(1, 0);
+  ASSERT_NE(nullptr, tile);
+  EXPECT_EQ(5u, tile->Width());
+  EXPECT_EQ(5u, tile->Height());
+  EXPECT_FLOAT_EQ(88.0f, tile->MaxElevation());
+  std::vector<float> heights;
+  tile->FillHeightMap(1, 5, {4, 4, 88}, {1, 1, 1}, false, heights);
+  ASSERT_EQ(25u, heights.size());
+  for (unsigned int y = 0; y < 5; ++y)
+  {
+    for (unsigned int x = 0; x < 5; ++x)
+    {
+      EXPECT_FLOAT_EQ(static_cast<float>(TestHeightmapData::Datum(x + 4, y)),
+          heights[y * 5 + x]);
+    }
+  }
+
+  // Edges are shared with the neighbors
+  std::vector<float> left;
+  tiles.TileData(0, 0)->FillHeightMap(1, 5, {}, {}, false, left);
+  for (unsigned int y = 0; y < 5; ++y)
+    EXPECT_FLOAT_EQ(left[y * 5 + 4], heights[y * 5]);
+
+  // Lower level of the last tile keeps every other sample
+  tile = tiles.TileData(3, 1);
+  ASSERT_NE(nullptr, tile);
+  EXPECT_EQ(3u, tile->Width());
+  tile->FillHeightMap(1, 3, {}, {}, false, heights);
+  ASSERT_EQ(9u, heights.size());
+  EXPECT_FLOAT_EQ(44.0f, heights[0]);
+  EXPECT_FLOAT_EQ(66.0f, heights[4]);
+  EXPECT_FLOAT_EQ(88.0f, heights[8]);
+
+  // Sampling interpolates in between the tile's samples
+  tile->FillHeightMap(2, 5, {}, {}, false, heights);
+  ASSERT_EQ(25u, heights.size());
+  EXPECT_FLOAT_EQ(55.0f, heights[6]);
+  EXPECT_FLOAT_EQ(88.0f, heights[24]);
+
+  EXPECT_EQ(nullptr, tiles.TileData(4, 0));
+  EXPECT_EQ(nullptr, tiles.TileData(0, 2));
+}
+
+/////////////////////////////////////////////////
+TEST(TerrainTiles, Select)
+{
+  TestHeightmapData data(9, 9);
+  TerrainTiles tiles;
+  ASSERT_TRUE(tiles.Load(data, {8, 8, 1}, {1, 2, 3}, 1, 5));
+
+  std::vector<TerrainTiles::Tile> selected;
+  tiles.Select({{-1, 4, 0}}, 1.0, 0.0, selected);
+  ASSERT_EQ(1u, selected.size());
+  EXPECT_EQ(0u, selected[0].index);
+  EXPECT_EQ(0u, selected[0].lod);
+
+  // Corner tile is ~2.8 m away
+  tiles.Select({{-1, 4, 0}}, 2.5, 0.0, selected);
+  EXPECT_EQ(3u, selected.size());
+  tiles.Select({{-1, 4, 0}}, 3.0, 0.0, selected);
+  ASSERT_EQ(4u, selected.size());
+  for (unsigned int i = 0; i < 4; ++i)
+  {
+    EXPECT_EQ(i, selected[i].index);
+    EXPECT_EQ(0u, selected[i].lod);
+  }
+
+  // Farther tiles use lower levels of detail
+  tiles.Select({{-1, 4, 0}}, 3.0, 1.0, selected);
+  ASSERT_EQ(4u, selected.size());
+  EXPECT_EQ(0u, selected[0].lod);
+  EXPECT_EQ(1u, selected[1].lod);
+  EXPECT_EQ(1u, selected[3].lod);
+
+  // The closest point decides
+  tiles.Select({{-1, 4, 0}, {3, 0, 100}}, 1.0, 1.0, selected);
+  ASSERT_EQ(2u, selected.size());
+  EXPECT_EQ(0u, selected[0].index);
+  EXPECT_EQ(3u, selected[1].index);
+  EXPECT_EQ(0u, selected[1].lod);
+
+  // Far from the terrain
+  tiles.Select({{100, 100, 0}}, 10.0, 0.0, selected);
+  EXPECT_TRUE(selected.empty());
+}
@@ -15,8 +15,23 @@
  *
 */
 
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include <ignition/common/Console.hh>
+
+#include "ignition/gazebo/components/AngularVelocity.hh"
+#include "ignition/gazebo/components/AngularVelocityCmd.hh"
+#include "ignition/gazebo/components/JointForceCmd.hh"
+#include "ignition/gazebo/components/JointPosition.hh"
+#include "ignition/gazebo/components/JointVelocity.hh"
+#include "ignition/gazebo/components/JointVelocityCmd.hh"
+#include "ignition/gazebo/components/LinearVelocity.hh"
+#include "ignition/gazebo/components/LinearVelocityCmd.hh"
 #include "ignition/gazebo/Server.hh"
 #include "ignition/gazebo/ServerConfig.hh"
+#include "ignition/gazebo/Util.hh"
 
 #include "ignition/gazebo/TestFixture.hh"
 
@@ -105,6 +120,267 @@ void HelperSystem::PostUpdate(const UpdateInfo &_info,
     this->postUpdateCallback(_info, _ecm);
 }
 
+/// \brief Number of values of an observation.
+/// \param[in] _observation Observation type.
+/// \return Number of values it adds to each row.
+static std::size_t valueCount(TestFixture::Observation _observation)
+{
+  switch (_observation)
+  {
+    case TestFixture::Observation::POSE:
+      return 7u;
+    case TestFixture::Observation::LINEAR_VELOCITY:
+    case TestFixture::Observation::ANGULAR_VELOCITY:
+      return 3u;
+    default:
+      return 1u;
+  }
+}
+
+/// \brief Number of values of an action.
+/// \param[in] _action Action type.
+/// \return Number of values it takes from each row.
+static std::size_t valueCount(TestFixture::Action _action)
+{
+  switch (_action)
+  {
+    case TestFixture::Action::LINEAR_VELOCITY:
+    case TestFixture::Action::ANGULAR_VELOCITY:
+      return 3u;
+    default:
+      return 1u;
+  }
+}
+
+/// \brief An entity value which is part of each world's observations or
+/// actions.
+template <typename T>
+struct BatchItem
+{
+  /// \brief Scoped name of the entity.
+  std::string name;
+
+  /// \brief What is read or commanded.
+  T type;
+
+  /// \brief Offset within the row.
+  std::size_t offset{0u};
+};
+
+/// \brief System added to each world to read observations and apply
+/// actions during TestFixture::Step.
+class BatchSystem :
+  public System,
+  public ISystemPreUpdate,
+  public ISystemPostUpdate
+{
+  /// \brief Constructor
+  /// \param[in] _observations Observations of each world.
+  /// \param[in] _actions Actions of each world.
+  public: BatchSystem(
+      const std::vector<BatchItem<TestFixture::Observation>> &_observations,
+      const std::vector<BatchItem<TestFixture::Action>> &_actions);
+
+  // Documentation inherited
+  public: void PreUpdate(const UpdateInfo &_info,
+                EntityComponentManager &_ecm) override;
+
+  // Documentation inherited
+  public: void PostUpdate(const UpdateInfo &_info,
+                const EntityComponentManager &_ecm) override;
+
+  /// \brief Find the entities which haven't been found yet or have been
+  /// removed, and create the components physics needs to fill in their
+  /// observations.
+  /// \param[in] _ecm Entity component manager.
+  private: void Resolve(EntityComponentManager &_ecm);
+
+  /// \brief Observations of each world.
+  private: const std::vector<BatchItem<TestFixture::Observation>>
+      observations;
+
+  /// \brief Actions of each world.
+  private: const std::vector<BatchItem<TestFixture::Action>> actions;
+
+  /// \brief Entity of each observation, null until it's found.
+  private: std::vector<Entity> observationEntities;
+
+  /// \brief Entity of each action, null until it's found.
+  private: std::vector<Entity> actionEntities;
+
+  /// \brief This world's row of actions, only set during a step.
+  public: const double *actionRow{nullptr};
+
+  /// \brief This world's row of observations, only set during a step.
+  public: double *observationRow{nullptr};
+};
+
+/////////////////////////////////////////////////
+BatchSystem::BatchSystem(
+    const std::vector<BatchItem<TestFixture::Observation>> &_observations,
+    const std::vector<BatchItem<TestFixture::Action>> &_actions)
+  : observations(_observations), actions(_actions),
+    observationEntities(_observations.size(), kNullEntity),
+    actionEntities(_actions.size(), kNullEntity)
+{
+}
+
+/////////////////////////////////////////////////
+void BatchSystem::Resolve(EntityComponentManager &_ecm)
+{
+  auto find = [&](const std::string &_name)
+  {
+    auto entities = entitiesFromScopedName(_name, _ecm);
+    return entities.size() == 1u ? *entities.begin() : kNullEntity;
+  };
+
+  for (std::size_t i = 0; i < this->observations.size(); ++i)
+  {
+    if (_ecm.HasEntity(this->observationEntities[i]))
+      continue;
+
+    const Entity entity = find(this->observations[i].name);
+    if (kNullEntity == entity)
+      continue;
+    this->observationEntities[i] = entity;
+
+    // Physics only fills velocities and joint states which have components
+    switch (this->observations[i].type)
+    {
+      case TestFixture::Observation::LINEAR_VELOCITY:
+        if (!_ecm.Component<components::WorldLinearVelocity>(entity))
+          _ecm.CreateComponent(entity, components::WorldLinearVelocity());
+        break;
+      case TestFixture::Observation::ANGULAR_VELOCITY:
+        if (!_ecm.Component<components::WorldAngularVelocity>(entity))
+          _ecm.CreateComponent(entity, components::WorldAngularVelocity());
+        break;
+      case TestFixture::Observation::JOINT_POSITION:
+        if (!_ecm.Component<components::JointPosition>(entity))
+          _ecm.CreateComponent(entity, components::JointPosition());
+        break;
+      case TestFixture::Observation::JOINT_VELOCITY:
+        if (!_ecm.Component<components::JointVelocity>(entity))
+          _ecm.CreateComponent(entity, components::JointVelocity());
+        break;
+      default:
+        break;
+    }
+  }
+
+  for (std::size_t i = 0; i < this->actions.size(); ++i)
+  {
+    if (!_ecm.HasEntity(this->actionEntities[i]))
+      this->actionEntities[i] = find(this->actions[i].name);
+  }
+}
+
+/////////////////////////////////////////////////
+void BatchSystem::PreUpdate(const UpdateInfo &,
+      EntityComponentManager &_ecm)
+{
+  if (nullptr == this->actionRow && nullptr == this->observationRow)
+    return;
+
+  this->Resolve(_ecm);
+
+  if (nullptr == this->actionRow)
+    return;
+
+  for (std::size_t i = 0; i < this->actions.size(); ++i)
+  {
+    const Entity entity = this->actionEntities[i];
+    if (kNullEntity == entity)
+      continue;
+
+    const double *values = this->actionRow + this->actions[i].offset;
+    switch (this->actions[i].type)
+    {
+      case TestFixture::Action::JOINT_FORCE:
+        _ecm.SetComponentData<components::JointForceCmd>(entity,
+            {values[0]});
+        break;
+      case TestFixture::Action::JOINT_VELOCITY:
+        _ecm.SetComponentData<components::JointVelocityCmd>(entity,
+            {values[0]});
+        break;
+      case TestFixture::Action::LINEAR_VELOCITY:
+        _ecm.SetComponentData<components::LinearVelocityCmd>(entity,
+            math::Vector3d(values[0], values[1], values[2]));
+        break;
+      case TestFixture::Action::ANGULAR_VELOCITY:
+        _ecm.SetComponentData<components::AngularVelocityCmd>(entity,
+            math::Vector3d(values[0], values[1], values[2]));
+        break;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void BatchSystem::PostUpdate(const UpdateInfo &,
+    const EntityComponentManager &_ecm)
+{
+  if (nullptr == this->observationRow)
+    return;
+
+  auto copy = [](double *_out, const math::Vector3d &_v)
+  {
+    _out[0] = _v.X();
+    _out[1] = _v.Y();
+    _out[2] = _v.Z();
+  };
+  auto first = [](const auto *_component)
+  {
+    return nullptr == _component || _component->Data().empty() ?
+        std::numeric_limits<double>::quiet_NaN() : _component->Data().front();
+  };
+
+  for (std::size_t i = 0; i < this->observations.size(); ++i)
+  {
+    // Look the entity up again if it has been removed
+    if (!_ecm.HasEntity(this->observationEntities[i]))
+      this->observationEntities[i] = kNullEntity;
+
+    const Entity entity = this->observationEntities[i];
+    double *out = this->observationRow + this->observations[i].offset;
+    const auto size = valueCount(this->observations[i].type);
+
+    if (kNullEntity == entity)
+    {
+      std::fill(out, out + size, std::numeric_limits<double>::quiet_NaN());
+      continue;
+    }
+
+    switch (this->observations[i].type)
+    {
+      case TestFixture::Observation::POSE:
+      {
+        const auto pose = worldPose(entity, _ecm);
+        copy(out, pose.Pos());
+        out[3] = pose.Rot().W();
+        out[4] = pose.Rot().X();
+        out[5] = pose.Rot().Y();
+        out[6] = pose.Rot().Z();
+        break;
+      }
+      case TestFixture::Observation::LINEAR_VELOCITY:
+        copy(out, _ecm.ComponentData<components::WorldLinearVelocity>(
+            entity).value_or(math::Vector3d::Zero));
+        break;
+      case TestFixture::Observation::ANGULAR_VELOCITY:
+        copy(out, _ecm.ComponentData<components::WorldAngularVelocity>(
+            entity).value_or(math::Vector3d::Zero));
+        break;
+      case TestFixture::Observation::JOINT_POSITION:
+        out[0] = first(_ecm.Component<components::JointPosition>(entity));
+        break;
+      case TestFixture::Observation::JOINT_VELOCITY:
+        out[0] = first(_ecm.Component<components::JointVelocity>(entity));
+        break;
+    }
+  }
+}
+
 //////////////////////////////////////////////////
 class ignition::gazebo::TestFixturePrivate
 {
@@ -120,6 +396,22 @@ class ignition::gazebo::TestFixturePrivate
 
   /// \brief Flag to make sure Finalize is only called once
   public: bool finalized{false};
+
+  /// \brief Observations read from each world by Step.
+  public: std::vector<BatchItem<TestFixture::Observation>> observations;
+
+  /// \brief Actions applied to each world by Step.
+  public: std::vector<BatchItem<TestFixture::Action>> actions;
+
+  /// \brief Number of values in each row of observations.
+  public: std::size_t observationSize{0u};
+
+  /// \brief Number of values in each row of actions.
+  public: std::size_t actionSize{0u};
+
+  /// \brief One system per world, added on Finalize if there are
+  /// observations or actions.
+  public: std::vector<std::shared_ptr<BatchSystem>> batchSystems;
 };
 
 //////////////////////////////////////////////////
@@ -164,6 +456,17 @@ TestFixture &TestFixture::Finalize()
 
   this->dataPtr->server->AddSystem(this->dataPtr->helperSystem);
 
+  if (!this->dataPtr->observations.empty() || !this->dataPtr->actions.empty())
+  {
+    for (std::size_t i = 0; i < this->WorldCount(); ++i)
+    {
+      auto system = std::make_shared<BatchSystem>(
+          this->dataPtr->observations, this->dataPtr->actions);
+      this->dataPtr->server->AddSystem(system, static_cast<unsigned int>(i));
+      this->dataPtr->batchSystems.push_back(std::move(system));
+    }
+  }
+
   this->dataPtr->finalized = true;
   return *this;
 }
@@ -213,3 +516,113 @@ std::shared_ptr<Server> TestFixture::Server() const
   return this->dataPtr->server;
 }
 
+
+//////////////////////////////////////////////////
+std::optional<std::size_t> TestFixture::AddObservation(
+    const std::string &_scopedName, Observation _observation)
+{
+  if (this->dataPtr->finalized)
+  {
+    ignerr << "Observations must be added before finalizing the fixture."
+           << std::endl;
+    return std::nullopt;
+  }
+
+  const auto offset = this->dataPtr->observationSize;
+  this->dataPtr->observations.push_back({_scopedName, _observation, offset});
+  this->dataPtr->observationSize += valueCount(_observation);
+  return offset;
+}
+
+//////////////////////////////////////////////////
+std::optional<std::size_t> TestFixture::AddAction(
+    const std::string &_scopedName, Action _action)
+{
+  if (this->dataPtr->finalized)
+  {
+    ignerr << "Actions must be added before finalizing the fixture."
+           << std::endl;
+    return std::nullopt;
+  }
+
+  const auto offset = this->dataPtr->actionSize;
+  this->dataPtr->actions.push_back({_scopedName, _action, offset});
+  this->dataPtr->actionSize += valueCount(_action);
+  return offset;
+}
+
+//////////////////////////////////////////////////
+std::size_t TestFixture::ObservationSize() const
+{
+  return this->dataPtr->observationSize;
+}
+
+//////////////////////////////////////////////////
+std::size_t TestFixture::ActionSize() const
+{
+  return this->dataPtr->actionSize;
+}
+
+//////////////////////////////////////////////////
+std::size_t TestFixture::WorldCount() const
+{
+  unsigned int count{0u};
+  while (this->dataPtr->server->Running(count).has_value())
+    ++count;
+  return count;
+}
+
+//////////////////////////////////////////////////
+bool TestFixture::Step(const double *_actions, double *_observations,
+    uint64_t _iterations)
+{
+  if (!this->dataPtr->finalized)
+  {
+    ignerr << "Fixture must be finalized before stepping." << std::endl;
+    return false;
+  }
+
+  if ((nullptr == _actions && this->dataPtr->actionSize > 0u) ||
+      (nullptr == _observations && this->dataPtr->observationSize > 0u))
+  {
+    ignerr << "Missing buffer for actions or observations." << std::endl;
+    return false;
+  }
+
+  // Each world only touches its own rows, and worlds are stepped in
+  // parallel
+  for (std::size_t i = 0; i < this->dataPtr->batchSystems.size(); ++i)
+  {
+    auto &system = this->dataPtr->batchSystems[i];
+    system->actionRow = this->dataPtr->actionSize > 0u ?
+        _actions + i * this->dataPtr->actionSize : nullptr;
+    system->observationRow = this->dataPtr->observationSize > 0u ?
+        _observations + i * this->dataPtr->observationSize : nullptr;
+  }
+
+  const bool result = this->dataPtr->server->Run(true, _iterations, false);
+
+  for (auto &system : this->dataPtr->batchSystems)
+  {
+    system->actionRow = nullptr;
+    system->observationRow = nullptr;
+  }
+
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool TestFixture::Step(const std::vector<double> &_actions,
+    std::vector<double> &_observations, uint64_t _iterations)
+{
+  const auto worldCount = this->WorldCount();
+  if (_actions.size() != worldCount * this->dataPtr->actionSize)
+  {
+    ignerr << "Expected [" << worldCount * this->dataPtr->actionSize
+           << "] actions, got [" << _actions.size() << "]." << std::endl;
+    return false;
+  }
+
+  _observations.resize(worldCount * this->dataPtr->observationSize);
+  return this->Step(_actions.data(), _observations.data(), _iterations);
+}
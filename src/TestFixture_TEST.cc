@@ -17,8 +17,12 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <vector>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
+#include <ignition/math/Quaternion.hh>
 
 #include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/ServerConfig.hh"
@@ -259,3 +263,59 @@ TEST_F(TestFixtureTest, ChangeCallback)
   // New callback is called
   EXPECT_EQ(expectedIterations, preUpdate2);
 }
+
+/////////////////////////////////////////////////
+TEST_F(TestFixtureTest, BatchedStep)
+{
+  ServerConfig config;
+  config.SetSdfFile(common::joinPaths(std::string(PROJECT_SOURCE_PATH),
+      "test", "worlds", "apply_joint_force.sdf"));
+  config.SetWorldCopies(2u);
+
+  TestFixture testFixture(config);
+  EXPECT_EQ(2u, testFixture.WorldCount());
+
+  EXPECT_EQ(0u, *testFixture.AddObservation("joint_force_test::j1",
+      TestFixture::Observation::JOINT_VELOCITY));
+  EXPECT_EQ(1u, *testFixture.AddObservation("joint_force_test::rotor",
+      TestFixture::Observation::POSE));
+  EXPECT_EQ(8u, *testFixture.AddObservation("missing",
+      TestFixture::Observation::JOINT_POSITION));
+  EXPECT_EQ(0u, *testFixture.AddAction("joint_force_test::j1",
+      TestFixture::Action::JOINT_FORCE));
+  EXPECT_EQ(9u, testFixture.ObservationSize());
+  EXPECT_EQ(1u, testFixture.ActionSize());
+
+  std::vector<double> observations;
+  EXPECT_FALSE(testFixture.Step({0.0, 0.0}, observations));
+
+  testFixture.Finalize();
+  EXPECT_FALSE(testFixture.AddAction("joint_force_test::j1",
+      TestFixture::Action::JOINT_VELOCITY));
+  EXPECT_EQ(1u, testFixture.ActionSize());
+
+  // One action per world
+  EXPECT_FALSE(testFixture.Step({1.0}, observations));
+
+  // Only the second world's joint is pushed
+  ASSERT_TRUE(testFixture.Step({0.0, 10.0}, observations, 100u));
+  ASSERT_EQ(18u, observations.size());
+  EXPECT_EQ(100u, *testFixture.Server()->IterationCount(0));
+  EXPECT_EQ(100u, *testFixture.Server()->IterationCount(1));
+
+  EXPECT_NEAR(0.0, observations[0], 1e-6);
+  EXPECT_GT(observations[9], 0.1);
+
+  for (std::size_t world = 0; world < 2u; ++world)
+  {
+    const double *row = observations.data() + world * 9u;
+    math::Quaterniond rot(row[4], row[5], row[6], row[7]);
+    EXPECT_NEAR(1.0, rot.W() * rot.W() + rot.X() * rot.X() +
+        rot.Y() * rot.Y() + rot.Z() * rot.Z(), 1e-6);
+    EXPECT_TRUE(std::isnan(row[8]));
+  }
+
+  // Both worlds start from the same pose
+  EXPECT_NEAR(observations[1], observations[10], 1e-6);
+  EXPECT_NEAR(observations[3], observations[12], 1e-6);
+}
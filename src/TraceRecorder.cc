@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ignition/gazebo/TraceRecorder.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+
+/// \brief A recorded zone. Fields are atomic because a slot may be
+/// overwritten by its thread while the trace is being serialized.
+struct TraceZone
+{
+  /// \brief Zone name.
+  std::atomic<const char *> name{nullptr};
+
+  /// \brief Start time, in nanoseconds since the recorder's epoch.
+  std::atomic<int64_t> start{0};
+
+  /// \brief Duration in nanoseconds.
+  std::atomic<int64_t> duration{0};
+};
+
+/// \brief Ring buffer of the zones of one thread. Only its thread writes
+/// zones into it.
+struct TraceThreadBuffer
+{
+  /// \brief Thread id used in the trace.
+  uint32_t id{0u};
+
+  /// \brief Thread name, protected by the recorder's mutex.
+  std::string name;
+
+  /// \brief Zones, used as a ring buffer.
+  std::unique_ptr<TraceZone[]> zones;
+
+  /// \brief Number of slots in zones.
+  std::size_t capacity{0u};
+
+  /// \brief Number of zones recorded since Start, including overwritten
+  /// ones.
+  std::atomic<uint64_t> count{0u};
+
+  /// \brief Generation of the recorder when count was last reset.
+  std::atomic<uint64_t> generation{0u};
+};
+
+class ignition::gazebo::TraceRecorderPrivate
+{
+  /// \brief Get the buffer of the calling thread, creating it if needed.
+  /// \return The buffer.
+  public: TraceThreadBuffer &ThreadBuffer();
+
+  /// \brief True while recording.
+  public: std::atomic<bool> recording{false};
+
+  /// \brief Incremented on every Start, so threads can tell they need to
+  /// discard their zones.
+  public: std::atomic<uint64_t> generation{0u};
+
+  /// \brief Times are relative to this.
+  public: std::atomic<int64_t> epoch{0};
+
+  /// \brief Capacity of new thread buffers.
+  public: std::atomic<std::size_t> zonesPerThread{65536u};
+
+  /// \brief Protects buffers and thread names.
+  public: mutable std::mutex mutex;
+
+  /// \brief Buffers of all threads which recorded, kept after their thread
+  /// exits so their zones end up in the trace.
+  public: std::vector<std::unique_ptr<TraceThreadBuffer>> buffers;
+};
+
+using namespace ignition::gazebo;
+
+/// \brief Buffer of the calling thread.
+static thread_local TraceThreadBuffer *tlTraceBuffer{nullptr};
+
+/// \brief Name of the calling thread, kept until it records its first zone
+/// so threads which never record don't allocate a buffer.
+static thread_local std::string tlTraceThreadName;
+
+/// \brief Nanoseconds since the steady clock's epoch.
+/// \param[in] _time Time point.
+/// \return Nanoseconds.
+static int64_t toNanoseconds(std::chrono::steady_clock::time_point _time)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      _time.time_since_epoch()).count();
+}
+
+/// \brief Escape a string for a JSON string literal.
+/// \param[in] _str String to escape.
+/// \return Escaped string.
+static std::string jsonEscape(const std::string &_str)
+{
+  std::string escaped;
+  for (char c : _str)
+  {
+    if (c == '"' || c == '\\')
+    {
+      escaped += '\\';
+      escaped += c;
+    }
+    else if (static_cast<unsigned char>(c) < 0x20)
+    {
+      std::stringstream ss;
+      ss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+         << static_cast<int>(c);
+      escaped += ss.str();
+    }
+    else
+    {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+//////////////////////////////////////////////////
+TraceThreadBuffer &TraceRecorderPrivate::ThreadBuffer()
+{
+  if (nullptr == tlTraceBuffer)
+  {
+    auto buffer = std::make_unique<TraceThreadBuffer>();
+    buffer->capacity = std::max<std::size_t>(this->zonesPerThread, 1u);
+    buffer->zones = std::make_unique<TraceZone[]>(buffer->capacity);
+    buffer->generation = this->generation.load();
+    buffer->name = tlTraceThreadName;
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    buffer->id = static_cast<uint32_t>(this->buffers.size() + 1u);
+    tlTraceBuffer = buffer.get();
+    this->buffers.push_back(std::move(buffer));
+  }
+  return *tlTraceBuffer;
+}
+
+//////////////////////////////////////////////////
+TraceRecorder &TraceRecorder::Instance()
+{
+  static TraceRecorder recorder;
+  return recorder;
+}
+
+//////////////////////////////////////////////////
+TraceRecorder::TraceRecorder()
+  : dataPtr(std::make_unique<TraceRecorderPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+TraceRecorder::~TraceRecorder() = default;
+
+//////////////////////////////////////////////////
+void TraceRecorder::Start(std::size_t _zonesPerThread)
+{
+  this->dataPtr->zonesPerThread = _zonesPerThread;
+  this->dataPtr->epoch = toNanoseconds(std::chrono::steady_clock::now());
+
+  // Threads discard their old zones the next time they record. Zones which
+  // haven't been overwritten yet are skipped when serializing.
+  ++this->dataPtr->generation;
+  this->dataPtr->recording = true;
+}
+
+//////////////////////////////////////////////////
+void TraceRecorder::Stop()
+{
+  this->dataPtr->recording = false;
+}
+
+//////////////////////////////////////////////////
+bool TraceRecorder::Recording() const
+{
+  return this->dataPtr->recording.load(std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+void TraceRecorder::Record(const char *_name,
+    std::chrono::steady_clock::time_point _start,
+    std::chrono::steady_clock::time_point _end)
+{
+  if (!this->Recording() || nullptr == _name)
+    return;
+
+  auto &buffer = this->dataPtr->ThreadBuffer();
+
+  // Start over after a new Start
+  const auto generation = this->dataPtr->generation.load();
+  if (buffer.generation.load(std::memory_order_relaxed) != generation)
+  {
+    buffer.count.store(0u, std::memory_order_relaxed);
+    buffer.generation.store(generation, std::memory_order_release);
+  }
+
+  const auto count = buffer.count.load(std::memory_order_relaxed);
+  auto &zone = buffer.zones[count % buffer.capacity];
+  zone.name.store(_name, std::memory_order_relaxed);
+  zone.start.store(toNanoseconds(_start) - this->dataPtr->epoch,
+      std::memory_order_relaxed);
+  zone.duration.store(toNanoseconds(_end) - toNanoseconds(_start),
+      std::memory_order_relaxed);
+  buffer.count.store(count + 1u, std::memory_order_release);
+}
+
+//////////////////////////////////////////////////
+void TraceRecorder::SetThreadName(const std::string &_name)
+{
+  tlTraceThreadName = _name;
+  if (nullptr == tlTraceBuffer)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  tlTraceBuffer->name = _name;
+}
+
+//////////////////////////////////////////////////
+std::size_t TraceRecorder::ZoneCount() const
+{
+  const auto generation = this->dataPtr->generation.load();
+  std::size_t total{0u};
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  for (const auto &buffer : this->dataPtr->buffers)
+  {
+    if (buffer->generation.load(std::memory_order_acquire) != generation)
+      continue;
+    total += static_cast<std::size_t>(std::min<uint64_t>(
+        buffer->count.load(std::memory_order_acquire), buffer->capacity));
+  }
+  return total;
+}
+
+//////////////////////////////////////////////////
+std::string TraceRecorder::ChromeTrace() const
+{
+  const auto generation = this->dataPtr->generation.load();
+
+  std::stringstream json;
+  json << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+  bool first{true};
+  auto separator = [&]
+  {
+    if (!first)
+      json << ",";
+    first = false;
+  };
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  for (const auto &buffer : this->dataPtr->buffers)
+  {
+    if (!buffer->name.empty())
+    {
+      separator();
+      json << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+           << buffer->id << ",\"args\":{\"name\":\""
+           << jsonEscape(buffer->name) << "\"}}";
+    }
+
+    if (buffer->generation.load(std::memory_order_acquire) != generation)
+      continue;
+
+    // The thread may keep recording, only read the slots which can't have
+    // been overwritten by the time they're read
+    const auto count = buffer->count.load(std::memory_order_acquire);
+    const auto begin = count > buffer->capacity ? count - buffer->capacity : 0u;
+    for (auto i = begin; i < count; ++i)
+    {
+      const auto &zone = buffer->zones[i % buffer->capacity];
+      const auto name = zone.name.load(std::memory_order_relaxed);
+      const auto start = zone.start.load(std::memory_order_relaxed);
+      const auto duration = zone.duration.load(std::memory_order_relaxed);
+
+      const auto now = buffer->count.load(std::memory_order_acquire);
+      if (now > i + buffer->capacity || nullptr == name)
+        continue;
+
+      separator();
+      json << "{\"name\":\"" << jsonEscape(name)
+           << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+           << ",\"ts\":" << start * 1e-3 << ",\"dur\":" << duration * 1e-3
+           << "}";
+    }
+  }
+  json << "],\"displayTimeUnit\":\"ms\"}";
+  return json.str();
+}
+
+//////////////////////////////////////////////////
+bool TraceRecorder::WriteChromeTrace(const std::string &_path) const
+{
+  std::ofstream file(_path, std::ios::out | std::ios::trunc);
+  if (!file)
+  {
+    ignerr << "Failed to open trace file [" << _path << "]" << std::endl;
+    return false;
+  }
+
+  file << this->ChromeTrace();
+  if (!file)
+  {
+    ignerr << "Failed to write trace file [" << _path << "]" << std::endl;
+    return false;
+  }
+
+  ignmsg << "Wrote trace with [" << this->ZoneCount() << "] zones to ["
+         << _path << "]" << std::endl;
+  return true;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+#include "ignition/gazebo/TraceRecorder.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Count the occurrences of a string.
+/// \param[in] _str String to search.
+/// \param[in] _sub String to count.
+/// \return Number of occurrences.
+static std::size_t count(const std::string &_str, const std::string &_sub)
+{
+  std::size_t n{0u};
+  for (auto pos = _str.find(_sub); pos != std::string::npos;
+       pos = _str.find(_sub, pos + 1))
+  {
+    ++n;
+  }
+  return n;
+}
+
+/////////////////////////////////////////////////
+TEST(TraceRecorder, Record)
+{
+  auto &recorder = TraceRecorder::Instance();
+
+  // Nothing is recorded until started
+  {
+    IGN_GAZEBO_PROFILE("NotRecorded");
+  }
+  recorder.Start();
+  EXPECT_TRUE(recorder.Recording());
+  EXPECT_EQ(0u, recorder.ZoneCount());
+
+  recorder.SetThreadName("main \"thread\"");
+  {
+    IGN_GAZEBO_PROFILE("Outer");
+    {
+      IGN_GAZEBO_PROFILE("Inner");
+    }
+  }
+
+  std::thread worker([]
+  {
+    TraceRecorder::Instance().SetThreadName("worker");
+    IGN_GAZEBO_PROFILE("Worker");
+  });
+  worker.join();
+
+  recorder.Stop();
+  EXPECT_FALSE(recorder.Recording());
+  {
+    IGN_GAZEBO_PROFILE("AfterStop");
+  }
+
+  EXPECT_EQ(3u, recorder.ZoneCount());
+  const auto trace = recorder.ChromeTrace();
+  EXPECT_EQ(0u, trace.find("{\"traceEvents\":["));
+  EXPECT_EQ(1u, count(trace, "\"name\":\"Outer\""));
+  EXPECT_EQ(1u, count(trace, "\"name\":\"Inner\""));
+  EXPECT_EQ(1u, count(trace, "\"name\":\"Worker\""));
+  EXPECT_EQ(0u, count(trace, "NotRecorded"));
+  EXPECT_EQ(0u, count(trace, "AfterStop"));
+  EXPECT_EQ(3u, count(trace, "\"ph\":\"X\""));
+  EXPECT_EQ(1u, count(trace, "main \\\"thread\\\""));
+  EXPECT_EQ(1u, count(trace, "\"name\":\"worker\""));
+
+  // Starting again discards old zones
+  recorder.Start();
+  EXPECT_EQ(0u, recorder.ZoneCount());
+  recorder.Stop();
+}
+
+/////////////////////////////////////////////////
+TEST(TraceRecorder, Overwrite)
+{
+  auto &recorder = TraceRecorder::Instance();
+
+  // A new thread gets a small buffer, which only keeps the latest zones
+  recorder.Start(4u);
+  std::thread worker([]
+  {
+    for (int i = 0; i < 10; ++i)
+    {
+      IGN_GAZEBO_PROFILE("Zone");
+    }
+  });
+  worker.join();
+  recorder.Stop();
+
+  EXPECT_EQ(4u, recorder.ZoneCount());
+  EXPECT_EQ(4u, count(recorder.ChromeTrace(), "\"name\":\"Zone\""));
+}
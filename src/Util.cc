@@ -30,6 +30,20 @@
   #endif
 #endif
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include <ignition/common/Filesystem.hh>
 #include <ignition/common/StringUtils.hh>
 #include <ignition/common/Util.hh>
@@ -54,6 +68,7 @@
 #include "ignition/gazebo/components/Visual.hh"
 #include "ignition/gazebo/components/World.hh"
 
+#include "ignition/gazebo/TraceRecorder.hh"
 #include "ignition/gazebo/Util.hh"
 
 namespace ignition
@@ -62,6 +77,34 @@ namespace gazebo
 {
 // Inline bracket to help doxygen filtering.
 inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+/// \brief Resources resolved so far, shared by the whole process.
+struct ResourceCache
+{
+  /// \brief Protects all members.
+  std::mutex mutex;
+
+  /// \brief Value of the resource path environment variable which
+  /// gzPaths was split from.
+  std::string gzPathsEnv;
+
+  /// \brief Paths in the resource path environment variable.
+  std::vector<std::string> gzPaths;
+
+  /// \brief Paths of the URIs resolved by resolveResourceUri.
+  std::unordered_map<std::string, std::string> uris;
+
+  /// \brief SDF files found by findFuelResourceSdf, keyed by directory.
+  std::unordered_map<std::string, std::string> fuelSdfs;
+};
+
+/// \brief Get the process-wide resource cache.
+/// \return The cache.
+static ResourceCache &resourceCache()
+{
+  static ResourceCache cache;
+  return cache;
+}
+
 //////////////////////////////////////////////////
 math::Pose3d worldPose(const Entity &_entity,
     const EntityComponentManager &_ecm)
@@ -404,11 +447,19 @@ std::string asFullPath(const std::string &_uri, const std::string &_filePath)
 //////////////////////////////////////////////////
 std::vector<std::string> resourcePaths()
 {
+  const char *gzPathCStr = std::getenv(kResourcePathEnv.c_str());
+  std::string gzPathsEnv = gzPathCStr ? gzPathCStr : "";
+
+  // Only split the variable again when it changed
+  auto &cache = resourceCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  if (gzPathsEnv == cache.gzPathsEnv)
+    return cache.gzPaths;
+
   std::vector<std::string> gzPaths;
-  char *gzPathCStr = std::getenv(kResourcePathEnv.c_str());
-  if (gzPathCStr && *gzPathCStr != '\0')
+  if (!gzPathsEnv.empty())
   {
-    gzPaths = common::Split(gzPathCStr, common::SystemPaths::Delimiter());
+    gzPaths = common::Split(gzPathsEnv, common::SystemPaths::Delimiter());
   }
 
   gzPaths.erase(std::remove_if(gzPaths.begin(), gzPaths.end(),
@@ -417,9 +468,45 @@ std::vector<std::string> resourcePaths()
         return _path.empty();
       }), gzPaths.end());
 
+  cache.gzPathsEnv = gzPathsEnv;
+  cache.gzPaths = gzPaths;
   return gzPaths;
 }
 
+//////////////////////////////////////////////////
+std::string resolveResourceUri(const std::string &_uri,
+    const std::function<std::string(const std::string &)> &_resolve)
+{
+  auto &cache = resourceCache();
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto it = cache.uris.find(_uri);
+    if (it != cache.uris.end())
+      return it->second;
+  }
+
+  // Resolve without holding the lock, since it may download the resource and
+  // call back into this function
+  auto path = _resolve(_uri);
+
+  if (!path.empty() || (_uri.compare(0, 7, "http://") != 0 &&
+      _uri.compare(0, 8, "https://") != 0))
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.uris[_uri] = path;
+  }
+  return path;
+}
+
+//////////////////////////////////////////////////
+void clearResourceCache()
+{
+  auto &cache = resourceCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.uris.clear();
+  cache.fuelSdfs.clear();
+}
+
 //////////////////////////////////////////////////
 void addResourcePaths(const std::vector<std::string> &_paths)
 {
@@ -494,6 +581,9 @@ void addResourcePaths(const std::vector<std::string> &_paths)
   // Force re-evaluation
   // SDF is evaluated at find call
   systemPaths->SetFilePathEnv(systemPaths->FilePathEnv());
+
+  // Resources may now resolve to the new paths
+  clearResourceCache();
 }
 
 //////////////////////////////////////////////////
@@ -667,6 +757,14 @@ std::optional<math::Vector3d> sphericalCoordinates(Entity _entity,
 // Getting the first .sdf file in the path
 std::string findFuelResourceSdf(const std::string &_path)
 {
+  auto &cache = resourceCache();
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto it = cache.fuelSdfs.find(_path);
+    if (it != cache.fuelSdfs.end())
+      return it->second;
+  }
+
   if (!common::exists(_path))
     return "";
 
@@ -682,12 +780,34 @@ std::string findFuelResourceSdf(const std::string &_path)
 
     if (fileExtension == "sdf")
     {
+      // Resource directories are versioned, so their contents don't change
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      cache.fuelSdfs[_path] = current;
       return current;
     }
   }
   return "";
 }
 
+//////////////////////////////////////////////////
+std::vector<std::string> fuelResourceUris(const std::string &_sdfString)
+{
+  static const std::regex uriRegex(
+      "<uri>\\s*(https?://[^<]*[^<\\s])\\s*</uri>",
+      std::regex::icase | std::regex::optimize);
+
+  std::vector<std::string> uris;
+  std::unordered_set<std::string> seen;
+  for (auto it = std::sregex_iterator(_sdfString.begin(), _sdfString.end(),
+       uriRegex); it != std::sregex_iterator(); ++it)
+  {
+    auto uri = (*it)[1].str();
+    if (seen.insert(uri).second)
+      uris.push_back(std::move(uri));
+  }
+  return uris;
+}
+
 //////////////////////////////////////////////////
 std::string resolveSdfWorldFile(const std::string &_sdfFile,
     const std::string &_fuelResourceCache)
@@ -736,6 +856,105 @@ std::string resolveSdfWorldFile(const std::string &_sdfFile,
 
   return filePath;
 }
+
+//////////////////////////////////////////////////
+std::vector<unsigned int> parseCpuList(const std::string &_list)
+{
+  std::vector<unsigned int> cpus;
+  for (auto token : common::split(_list, ","))
+  {
+    const auto begin = token.find_first_not_of(" \t\n");
+    if (begin == std::string::npos)
+      continue;
+    token = token.substr(begin, token.find_last_not_of(" \t\n") - begin + 1);
+
+    unsigned long first{0u};
+    unsigned long last{0u};
+    try
+    {
+      std::size_t pos{0u};
+      first = std::stoul(token, &pos);
+      last = first;
+      if (pos < token.size())
+      {
+        if (token[pos] != '-')
+          return {};
+        std::size_t endPos{0u};
+        const auto rest = token.substr(pos + 1);
+        last = std::stoul(rest, &endPos);
+        if (endPos != rest.size() || last < first)
+          return {};
+      }
+    }
+    catch (...)
+    {
+      return {};
+    }
+
+    for (auto cpu = first; cpu <= last; ++cpu)
+      cpus.push_back(static_cast<unsigned int>(cpu));
+  }
+
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return cpus;
+}
+
+//////////////////////////////////////////////////
+std::vector<unsigned int> numaNodeCpus(unsigned int _node)
+{
+#ifdef __linux__
+  std::ifstream file("/sys/devices/system/node/node" + std::to_string(_node)
+      + "/cpulist");
+  std::string list;
+  if (file && std::getline(file, list))
+    return parseCpuList(list);
+#else
+  ignwarn << "NUMA nodes are only supported on Linux" << std::endl;
+  (void)_node;
+#endif
+  return {};
+}
+
+//////////////////////////////////////////////////
+bool setCurrentThreadAffinity(const std::vector<unsigned int> &_cpus)
+{
+  if (_cpus.empty())
+    return false;
+
+#ifdef __linux__
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  for (auto cpu : _cpus)
+  {
+    if (cpu < CPU_SETSIZE)
+      CPU_SET(cpu, &cpuSet);
+  }
+  if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0)
+  {
+    ignwarn << "Failed to set thread affinity" << std::endl;
+    return false;
+  }
+  return true;
+#else
+  ignwarn << "Setting thread affinity is only supported on Linux"
+          << std::endl;
+  return false;
+#endif
+}
+
+//////////////////////////////////////////////////
+void setCurrentThreadName(const std::string &_name)
+{
+  TraceRecorder::Instance().SetThreadName(_name);
+
+#ifdef __linux__
+  // Longer names are rejected, rather than truncated
+  pthread_setname_np(pthread_self(), _name.substr(0, 15).c_str());
+#else
+  (void)_name;
+#endif
+}
 }
 }
 }
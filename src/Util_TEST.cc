@@ -32,7 +32,9 @@
 #include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/ParticleEmitter.hh"
+#include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/Sensor.hh"
+#include "ignition/gazebo/components/Static.hh"
 #include "ignition/gazebo/components/Visual.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
@@ -718,6 +720,39 @@ TEST_F(UtilTest, EnableComponent)
   EXPECT_EQ(nullptr, ecm.Component<components::Name>(entity1));
 }
 
+/////////////////////////////////////////////////
+TEST_F(UtilTest, WorldPose)
+{
+  EntityComponentManager ecm;
+
+  auto modelEntity = ecm.CreateEntity();
+  ecm.CreateComponent(modelEntity, components::Model());
+  ecm.CreateComponent(modelEntity, components::Static(true));
+  ecm.CreateComponent(modelEntity,
+      components::Pose(math::Pose3d(1, 0, 0, 0, 0, 0)));
+
+  auto linkEntity = ecm.CreateEntity();
+  ecm.CreateComponent(linkEntity, components::Link());
+  ecm.CreateComponent(linkEntity, components::ParentEntity(modelEntity));
+  ecm.CreateComponent(linkEntity,
+      components::Pose(math::Pose3d(0, 2, 0, 0, 0, 0)));
+
+  EXPECT_EQ(math::Pose3d(1, 2, 0, 0, 0, 0), worldPose(linkEntity, ecm));
+  EXPECT_EQ(math::Pose3d(1, 2, 0, 0, 0, 0), *ecm.EntityWorldPose(linkEntity));
+
+  // Poses written in place are seen right away, even for static entities
+  ecm.Component<components::Pose>(modelEntity)->Data() =
+      math::Pose3d(3, 0, 0, 0, 0, 0);
+  EXPECT_EQ(math::Pose3d(3, 2, 0, 0, 0, 0), worldPose(linkEntity, ecm));
+  ecm.SetChanged(modelEntity, components::Pose::typeId);
+  EXPECT_EQ(math::Pose3d(3, 2, 0, 0, 0, 0), *ecm.EntityWorldPose(linkEntity));
+
+  // No pose
+  auto noPoseEntity = ecm.CreateEntity();
+  EXPECT_EQ(math::Pose3d::Zero, worldPose(noPoseEntity, ecm));
+  EXPECT_FALSE(ecm.EntityWorldPose(noPoseEntity));
+}
+
 /////////////////////////////////////////////////
 TEST_F(UtilTest, EntityFromMsg)
 {
@@ -994,3 +1029,102 @@ TEST_F(UtilTest, ResolveSdfWorldFile)
   // A bad relative path should return an empty string
   EXPECT_TRUE(resolveSdfWorldFile("../invalid/does_not_exist.sdf").empty());
 }
+
+/////////////////////////////////////////////////
+TEST_F(UtilTest, FuelResourceUris)
+{
+  const std::string sdf = R"(
+    <sdf version="1.6">
+      <world name="default">
+        <include>
+          <uri>https://fuel.example.com/1.0/org/models/Box</uri>
+        </include>
+        <include>
+          <uri>
+            https://fuel.example.com/1.0/org/models/Box
+          </uri>
+          <name>box_copy</name>
+        </include>
+        <include>
+          <uri>model://sphere</uri>
+        </include>
+        <model name="mesh">
+          <link name="link">
+            <visual name="visual">
+              <geometry>
+                <mesh>
+                  <uri>http://example.com/meshes/mesh.dae</uri>
+                </mesh>
+              </geometry>
+            </visual>
+          </link>
+        </model>
+      </world>
+    </sdf>)";
+
+  auto uris = fuelResourceUris(sdf);
+  ASSERT_EQ(2u, uris.size());
+  EXPECT_EQ("https://fuel.example.com/1.0/org/models/Box",
+      uris[0]);
+  EXPECT_EQ("http://example.com/meshes/mesh.dae", uris[1]);
+
+  EXPECT_TRUE(fuelResourceUris("").empty());
+  EXPECT_TRUE(fuelResourceUris("<uri>file:///tmp/box.dae</uri>").empty());
+}
+
+/////////////////////////////////////////////////
+TEST_F(UtilTest, ResolveResourceUri)
+{
+  clearResourceCache();
+
+  int calls{0};
+  std::string result{"/tmp/mesh.dae"};
+  auto resolve = [&](const std::string &)
+  {
+    ++calls;
+    return result;
+  };
+
+  // Resolved once, then cached
+  EXPECT_EQ("/tmp/mesh.dae", resolveResourceUri("model://mesh.dae", resolve));
+  result = "/tmp/other.dae";
+  EXPECT_EQ("/tmp/mesh.dae", resolveResourceUri("model://mesh.dae", resolve));
+  EXPECT_EQ(1, calls);
+
+  // Missing local resources are cached, missing remote ones aren't
+  result.clear();
+  EXPECT_TRUE(resolveResourceUri("model://missing", resolve).empty());
+  EXPECT_TRUE(resolveResourceUri("model://missing", resolve).empty());
+  EXPECT_EQ(2, calls);
+  EXPECT_TRUE(resolveResourceUri("https://example.com/a", resolve).empty());
+  EXPECT_TRUE(resolveResourceUri("https://example.com/a", resolve).empty());
+  EXPECT_EQ(4, calls);
+
+  // New resource paths clear the cache
+  addResourcePaths();
+  result = "/tmp/other.dae";
+  EXPECT_EQ("/tmp/other.dae", resolveResourceUri("model://mesh.dae", resolve));
+  EXPECT_EQ(5, calls);
+}
+
+/////////////////////////////////////////////////
+TEST_F(UtilTest, ParseCpuList)
+{
+  EXPECT_EQ(std::vector<unsigned int>({0u, 1u, 2u, 3u, 8u, 10u, 11u}),
+      parseCpuList("0-3, 8,10-11,2"));
+  EXPECT_EQ(std::vector<unsigned int>({5u}), parseCpuList("5"));
+
+  EXPECT_TRUE(parseCpuList("").empty());
+  EXPECT_TRUE(parseCpuList("3-1").empty());
+  EXPECT_TRUE(parseCpuList("1-").empty());
+  EXPECT_TRUE(parseCpuList("a,2").empty());
+  EXPECT_TRUE(parseCpuList("4x").empty());
+
+  // Restricting a thread to nothing is rejected
+  EXPECT_FALSE(setCurrentThreadAffinity({}));
+
+#ifdef __linux__
+  // Node 0 exists on every Linux machine with sysfs
+  EXPECT_FALSE(numaNodeCpus(0u).empty());
+#endif
+}
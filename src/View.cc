@@ -179,6 +179,30 @@ void View::Reset()
   this->missingCompTracker.clear();
 }
 
+//////////////////////////////////////////////////
+std::size_t View::MemoryUsage() const
+{
+  std::size_t bytes = BaseView::MemoryUsage();
+
+  // Each entity holds a vector of component pointers
+  auto addData = [&bytes](const auto &_data)
+  {
+    bytes += unorderedMemoryUsage(_data);
+    for (const auto &[entity, comps] : _data)
+      bytes += comps.capacity() * sizeof(void *);
+  };
+  addData(this->validData);
+  addData(this->validConstData);
+  addData(this->invalidData);
+  addData(this->invalidConstData);
+
+  bytes += unorderedMemoryUsage(this->missingCompTracker);
+  for (const auto &[entity, types] : this->missingCompTracker)
+    bytes += unorderedMemoryUsage(types);
+
+  return bytes;
+}
+
 }  // namespace detail
 }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
 }  // namespace gazebo
@@ -0,0 +1,450 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "WorkStealingPool.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <ignition/common/Profiler.hh>
+
+/// \brief Tasks of a single call to WorkStealingPool::Run.
+struct Batch
+{
+  /// \brief Function called for each task.
+  const std::function<void(std::size_t)> *task{nullptr};
+
+  /// \brief Number of tasks that haven't finished.
+  std::atomic<std::size_t> remaining{0u};
+};
+
+/// \brief A task waiting to be run.
+struct QueuedTask
+{
+  /// \brief Batch the task belongs to.
+  Batch *batch{nullptr};
+
+  /// \brief Index of the task within its batch.
+  std::size_t index{0u};
+};
+
+/// \brief Tasks owned by a single thread.
+struct TaskQueue
+{
+  /// \brief Protects tasks.
+  std::mutex mutex;
+
+  /// \brief Queued tasks. The owner takes from the back, thieves take from
+  /// the front.
+  std::deque<QueuedTask> tasks;
+};
+
+class ignition::gazebo::WorkStealingPoolPrivate
+{
+  /// \brief Loop run by each worker thread.
+  /// \param[in] _id Index of the thread's queue.
+  public: void WorkerLoop(std::size_t _id);
+
+  /// \brief Run a single task, from the own queue if possible.
+  /// \param[in] _id Index of the calling thread's queue.
+  /// \param[in] _only Only run a task of this batch, or of any batch if
+  /// null.
+  /// \return True if a task was run, false if no queue had a matching task.
+  public: bool RunOne(std::size_t _id, const Batch *_only = nullptr);
+
+  /// \brief Index of the queue owned by the calling thread. Worker threads
+  /// own one queue each, all other threads share queue 0.
+  /// \return Queue index.
+  public: std::size_t OwnQueue() const;
+
+  /// \brief Wake the workers for newly queued tasks of a batch, and help
+  /// until the batch is done.
+  /// \param[in] _batch Batch whose tasks were queued.
+  /// \param[in] _count Number of tasks queued.
+  /// \param[in] _own Index of the calling thread's queue.
+  public: void Wait(Batch &_batch, std::size_t _count, std::size_t _own);
+
+  /// \brief One queue per thread. Threads calling Run use queue 0.
+  public: std::vector<std::unique_ptr<TaskQueue>> queues;
+
+  /// \brief NUMA node of each queue.
+  public: std::vector<unsigned int> queueNodes;
+
+  /// \brief Queues of each NUMA node.
+  public: std::vector<std::vector<std::size_t>> nodeQueues;
+
+  /// \brief Order in which each queue's thread steals from the others,
+  /// queues of its own node first.
+  public: std::vector<std::vector<std::size_t>> stealOrder;
+
+  /// \brief Worker threads.
+  public: std::vector<std::thread> threads;
+
+  /// \brief Called on each worker thread when it starts.
+  public: std::function<void(unsigned int)> threadInit;
+
+  /// \brief Protects stop, used with the condition variables.
+  public: std::mutex mutex;
+
+  /// \brief Signals workers that tasks were queued or the pool is stopping.
+  public: std::condition_variable wakeCv;
+
+  /// \brief Signals callers of Run that a batch finished.
+  public: std::condition_variable doneCv;
+
+  /// \brief Number of queued tasks that haven't been taken yet.
+  public: std::atomic<std::size_t> queued{0u};
+
+  /// \brief True when the pool is being destroyed.
+  public: bool stop{false};
+
+  /// \brief Number of batches run.
+  public: std::atomic<uint64_t> batches{0u};
+
+  /// \brief Number of tasks run.
+  public: std::atomic<uint64_t> tasks{0u};
+
+  /// \brief Number of tasks stolen.
+  public: std::atomic<uint64_t> steals{0u};
+
+  /// \brief Number of tasks stolen from another node.
+  public: std::atomic<uint64_t> remoteSteals{0u};
+
+  /// \brief Deepest queue seen.
+  public: std::atomic<std::size_t> maxQueueDepth{0u};
+};
+
+/// \brief Pool that the current thread is a worker of, if any.
+static thread_local const ignition::gazebo::WorkStealingPoolPrivate
+    *tlWorkerPool{nullptr};
+
+/// \brief Queue owned by the current thread in tlWorkerPool.
+static thread_local std::size_t tlWorkerQueue{0u};
+
+using namespace ignition::gazebo;
+
+//////////////////////////////////////////////////
+WorkStealingPool::WorkStealingPool(unsigned int _threadCount,
+    const std::function<void(unsigned int)> &_threadInit,
+    const std::vector<unsigned int> &_threadNodes)
+  : dataPtr(std::make_unique<WorkStealingPoolPrivate>())
+{
+  this->dataPtr->threadInit = _threadInit;
+
+  if (_threadCount == 0u)
+    _threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+  for (unsigned int i = 0u; i < _threadCount; ++i)
+  {
+    this->dataPtr->queues.push_back(std::make_unique<TaskQueue>());
+    const unsigned int node = i < _threadNodes.size() ? _threadNodes[i] : 0u;
+    this->dataPtr->queueNodes.push_back(node);
+    if (node >= this->dataPtr->nodeQueues.size())
+      this->dataPtr->nodeQueues.resize(node + 1u);
+    this->dataPtr->nodeQueues[node].push_back(i);
+  }
+
+  // Thieves start with the next queue so that they spread out, and look at
+  // their own node before paying for remote memory
+  for (std::size_t id = 0u; id < _threadCount; ++id)
+  {
+    std::vector<std::size_t> order;
+    for (std::size_t offset = 1u; offset < _threadCount; ++offset)
+      order.push_back((id + offset) % _threadCount);
+    std::stable_partition(order.begin(), order.end(), [&](std::size_t _q)
+    {
+      return this->dataPtr->queueNodes[_q] == this->dataPtr->queueNodes[id];
+    });
+    this->dataPtr->stealOrder.push_back(std::move(order));
+  }
+
+  // The thread calling Run takes part, so one thread fewer is needed
+  for (unsigned int i = 1u; i < _threadCount; ++i)
+  {
+    this->dataPtr->threads.emplace_back(
+        &WorkStealingPoolPrivate::WorkerLoop, this->dataPtr.get(), i);
+  }
+}
+
+//////////////////////////////////////////////////
+WorkStealingPool::~WorkStealingPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->stop = true;
+  }
+  this->dataPtr->wakeCv.notify_all();
+
+  for (auto &thread : this->dataPtr->threads)
+    thread.join();
+}
+
+//////////////////////////////////////////////////
+void WorkStealingPool::Run(std::size_t _count,
+    const std::function<void(std::size_t)> &_task)
+{
+  IGN_PROFILE("WorkStealingPool::Run");
+  if (_count == 0u)
+    return;
+
+  ++this->dataPtr->batches;
+
+  // Nothing to share, skip waking the workers
+  if (_count == 1u || this->dataPtr->threads.empty())
+  {
+    for (std::size_t i = 0u; i < _count; ++i)
+      _task(i);
+    this->dataPtr->tasks += _count;
+    return;
+  }
+
+  Batch batch;
+  batch.task = &_task;
+  batch.remaining = _count;
+
+  // Deal tasks starting with the caller's own queue
+  const auto own = this->dataPtr->OwnQueue();
+  const auto queueCount = this->dataPtr->queues.size();
+  for (std::size_t q = 0u; q < queueCount && q < _count; ++q)
+  {
+    auto &queue = *this->dataPtr->queues[(own + q) % queueCount];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    for (std::size_t i = q; i < _count; i += queueCount)
+      queue.tasks.push_back({&batch, i});
+
+    if (queue.tasks.size() > this->dataPtr->maxQueueDepth)
+      this->dataPtr->maxQueueDepth = queue.tasks.size();
+  }
+
+  this->dataPtr->Wait(batch, _count, own);
+}
+
+//////////////////////////////////////////////////
+void WorkStealingPool::RunOnNodes(std::size_t _count,
+    const std::function<unsigned int(std::size_t)> &_node,
+    const std::function<void(std::size_t)> &_task)
+{
+  IGN_PROFILE("WorkStealingPool::RunOnNodes");
+  if (_count == 0u)
+    return;
+
+  if (_count == 1u || this->dataPtr->threads.empty())
+  {
+    this->Run(_count, _task);
+    return;
+  }
+
+  ++this->dataPtr->batches;
+
+  Batch batch;
+  batch.task = &_task;
+  batch.remaining = _count;
+
+  // Deal the tasks of each node to its queues in order, so a task index
+  // maps to the same thread on every call with the same count
+  const auto &nodeQueues = this->dataPtr->nodeQueues;
+  std::vector<std::vector<std::size_t>> queueTasks(
+      this->dataPtr->queues.size());
+  std::vector<std::size_t> dealt(nodeQueues.size(), 0u);
+  for (std::size_t i = 0u; i < _count; ++i)
+  {
+    auto node = _node(i) % nodeQueues.size();
+    while (nodeQueues[node].empty())
+      node = (node + 1u) % nodeQueues.size();
+    const auto &queues = nodeQueues[node];
+    queueTasks[queues[dealt[node]++ % queues.size()]].push_back(i);
+  }
+
+  for (std::size_t q = 0u; q < queueTasks.size(); ++q)
+  {
+    if (queueTasks[q].empty())
+      continue;
+
+    auto &queue = *this->dataPtr->queues[q];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    for (auto i : queueTasks[q])
+      queue.tasks.push_back({&batch, i});
+
+    if (queue.tasks.size() > this->dataPtr->maxQueueDepth)
+      this->dataPtr->maxQueueDepth = queue.tasks.size();
+  }
+
+  this->dataPtr->Wait(batch, _count, this->dataPtr->OwnQueue());
+}
+
+//////////////////////////////////////////////////
+unsigned int WorkStealingPool::NodeCount() const
+{
+  return static_cast<unsigned int>(this->dataPtr->nodeQueues.size());
+}
+
+//////////////////////////////////////////////////
+unsigned int WorkStealingPool::ThreadCount() const
+{
+  return static_cast<unsigned int>(this->dataPtr->queues.size());
+}
+
+//////////////////////////////////////////////////
+WorkStealingPoolStats WorkStealingPool::Stats() const
+{
+  WorkStealingPoolStats stats;
+  stats.batches = this->dataPtr->batches;
+  stats.tasks = this->dataPtr->tasks;
+  stats.steals = this->dataPtr->steals;
+  stats.remoteSteals = this->dataPtr->remoteSteals;
+  stats.maxQueueDepth = this->dataPtr->maxQueueDepth;
+  return stats;
+}
+
+//////////////////////////////////////////////////
+void WorkStealingPool::ResetStats()
+{
+  this->dataPtr->batches = 0u;
+  this->dataPtr->tasks = 0u;
+  this->dataPtr->steals = 0u;
+  this->dataPtr->remoteSteals = 0u;
+  this->dataPtr->maxQueueDepth = 0u;
+}
+
+//////////////////////////////////////////////////
+void WorkStealingPoolPrivate::WorkerLoop(std::size_t _id)
+{
+  std::stringstream ss;
+  ss << "WorkStealingPool: " << _id;
+  IGN_PROFILE_THREAD_NAME(ss.str().c_str());
+
+  tlWorkerPool = this;
+  tlWorkerQueue = _id;
+
+  if (this->threadInit)
+    this->threadInit(static_cast<unsigned int>(_id));
+
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->wakeCv.wait(lock, [&]
+      {
+        return this->stop || this->queued > 0u;
+      });
+      if (this->stop)
+        return;
+    }
+
+    while (this->RunOne(_id))
+    {
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void WorkStealingPoolPrivate::Wait(Batch &_batch, std::size_t _count,
+    std::size_t _own)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->queued += _count;
+  }
+  this->wakeCv.notify_all();
+
+  // Help with the tasks of this batch until it's done. Tasks of other
+  // batches aren't run here, since they could need a lock held by the
+  // caller, and nesting them could grow the stack without bound. Nested
+  // calls still make progress: the tasks of the innermost batch being waited
+  // on are either queued, so its caller runs them, or already running.
+  while (_batch.remaining > 0u)
+  {
+    if (this->RunOne(_own, &_batch))
+      continue;
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->doneCv.wait(lock, [&]
+    {
+      return _batch.remaining == 0u;
+    });
+  }
+}
+
+//////////////////////////////////////////////////
+std::size_t WorkStealingPoolPrivate::OwnQueue() const
+{
+  return tlWorkerPool == this ? tlWorkerQueue : 0u;
+}
+
+//////////////////////////////////////////////////
+bool WorkStealingPoolPrivate::RunOne(std::size_t _id, const Batch *_only)
+{
+  auto matches = [_only](const QueuedTask &_task)
+  {
+    return nullptr == _only || _task.batch == _only;
+  };
+
+  QueuedTask task;
+  bool found{false};
+  {
+    auto &own = *this->queues[_id];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    auto match = std::find_if(own.tasks.rbegin(), own.tasks.rend(), matches);
+    if (match != own.tasks.rend())
+    {
+      task = *match;
+      own.tasks.erase(std::prev(match.base()));
+      found = true;
+    }
+  }
+
+  for (auto it = this->stealOrder[_id].begin();
+       !found && it != this->stealOrder[_id].end(); ++it)
+  {
+    auto &victim = *this->queues[*it];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    auto match = std::find_if(victim.tasks.begin(), victim.tasks.end(),
+        matches);
+    if (match != victim.tasks.end())
+    {
+      task = *match;
+      victim.tasks.erase(match);
+      ++this->steals;
+      if (this->queueNodes[*it] != this->queueNodes[_id])
+        ++this->remoteSteals;
+      found = true;
+    }
+  }
+
+  if (!found)
+    return false;
+
+  --this->queued;
+  (*task.batch->task)(task.index);
+  ++this->tasks;
+
+  // The batch may be destroyed as soon as its last task is done, so it must
+  // not be used after this.
+  if (--task.batch->remaining == 0u)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->doneCv.notify_all();
+  }
+  return true;
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_WORKSTEALINGPOOL_HH_
+#define IGNITION_GAZEBO_WORKSTEALINGPOOL_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class WorkStealingPoolPrivate;
+
+    /// \brief Counters collected by a WorkStealingPool.
+    struct WorkStealingPoolStats
+    {
+      /// \brief Number of calls to WorkStealingPool::Run.
+      uint64_t batches{0u};
+
+      /// \brief Number of tasks run.
+      uint64_t tasks{0u};
+
+      /// \brief Number of tasks taken from another thread's queue.
+      uint64_t steals{0u};
+
+      /// \brief Number of stolen tasks that were queued for a thread on
+      /// another NUMA node.
+      uint64_t remoteSteals{0u};
+
+      /// \brief Largest number of tasks waiting in a single queue.
+      std::size_t maxQueueDepth{0u};
+    };
+
+    /// \class WorkStealingPool WorkStealingPool.hh
+    /// \brief Fixed-size pool of threads that runs batches of tasks.
+    ///
+    /// Each thread, including the one calling Run, owns a queue of tasks.
+    /// The tasks of a batch are dealt out to all queues. A thread runs tasks
+    /// from its own queue first, and once that's empty it steals tasks from
+    /// the other queues, so that long tasks don't leave the other threads
+    /// idle. Threads sleep between batches.
+    ///
+    /// Threads may be assigned to NUMA nodes. They then steal from threads
+    /// on their own node before stealing from other nodes, and RunOnNodes
+    /// queues each task on a thread of the node holding its data.
+    class IGNITION_GAZEBO_VISIBLE WorkStealingPool
+    {
+      /// \brief Constructor
+      /// \param[in] _threadCount Number of threads that run tasks, including
+      /// the thread calling Run. Zero uses the hardware concurrency.
+      /// \param[in] _threadInit Called on each worker thread, with its index
+      /// starting at 1, before it runs any task. Used to name the threads or
+      /// set their affinity.
+      /// \param[in] _threadNodes NUMA node of each thread, starting with the
+      /// thread calling Run, as an index into the nodes the caller uses.
+      /// Threads without an entry are on node 0. Empty puts all threads on
+      /// the same node. The pool doesn't set affinity itself, _threadInit
+      /// should restrict each thread to the CPUs of its node.
+      public: explicit WorkStealingPool(unsigned int _threadCount = 0u,
+                  const std::function<void(unsigned int)> &_threadInit = {},
+                  const std::vector<unsigned int> &_threadNodes = {});
+
+      /// \brief Destructor. Joins all threads.
+      public: ~WorkStealingPool();
+
+      /// \brief Run a batch of tasks and block until all of them are done.
+      /// Run may be called from multiple threads at once, and from within a
+      /// task, in which case the batches share the pool's threads. While
+      /// waiting, the caller runs queued tasks of its own batch, but never
+      /// tasks of other batches.
+      /// \param[in] _count Number of tasks.
+      /// \param[in] _task Function called once with each task index in
+      /// [0, _count). It's called concurrently from several threads.
+      public: void Run(std::size_t _count,
+                  const std::function<void(std::size_t)> &_task);
+
+      /// \brief Run a batch of tasks, queuing each one on a thread of a
+      /// given NUMA node, and block until all of them are done. Tasks of the
+      /// same node are dealt to its threads in order, so the same task
+      /// index lands on the same thread from one call to the next. Threads
+      /// of other nodes only run them once they ran out of local work.
+      /// \param[in] _count Number of tasks.
+      /// \param[in] _node Function returning the node of a task index.
+      /// Nodes without threads are wrapped around the pool's nodes.
+      /// \param[in] _task Function called once with each task index in
+      /// [0, _count). It's called concurrently from several threads.
+      public: void RunOnNodes(std::size_t _count,
+                  const std::function<unsigned int(std::size_t)> &_node,
+                  const std::function<void(std::size_t)> &_task);
+
+      /// \brief Number of NUMA nodes the threads are assigned to.
+      /// \return One more than the highest node, at least one.
+      public: unsigned int NodeCount() const;
+
+      /// \brief Number of threads that run tasks, including the thread
+      /// calling Run.
+      /// \return Thread count.
+      public: unsigned int ThreadCount() const;
+
+      /// \brief Get the counters collected since construction or since the
+      /// last call to ResetStats.
+      /// \return Pool statistics.
+      public: WorkStealingPoolStats Stats() const;
+
+      /// \brief Reset all counters to zero.
+      public: void ResetStats();
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<WorkStealingPoolPrivate> dataPtr;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_WORKSTEALINGPOOL_HH_
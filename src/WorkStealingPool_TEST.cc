@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "WorkStealingPool.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(WorkStealingPool, RunAll)
+{
+  WorkStealingPool pool(4u);
+  EXPECT_EQ(4u, pool.ThreadCount());
+
+  // Empty batch is a no-op
+  pool.Run(0u, [](std::size_t)
+  {
+    FAIL() << "Should not be called";
+  });
+
+  for (std::size_t count : {1u, 3u, 4u, 100u})
+  {
+    std::vector<std::atomic<int>> calls(count);
+    pool.Run(count, [&](std::size_t _i)
+    {
+      ++calls[_i];
+    });
+
+    for (const auto &call : calls)
+      EXPECT_EQ(1, call.load());
+  }
+
+  auto stats = pool.Stats();
+  EXPECT_EQ(4u, stats.batches);
+  EXPECT_EQ(108u, stats.tasks);
+  EXPECT_EQ(25u, stats.maxQueueDepth);
+
+  pool.ResetStats();
+  stats = pool.Stats();
+  EXPECT_EQ(0u, stats.batches);
+  EXPECT_EQ(0u, stats.tasks);
+  EXPECT_EQ(0u, stats.steals);
+  EXPECT_EQ(0u, stats.remoteSteals);
+  EXPECT_EQ(0u, stats.maxQueueDepth);
+}
+
+/////////////////////////////////////////////////
+TEST(WorkStealingPool, Steal)
+{
+  WorkStealingPool pool(4u);
+
+  // All slow tasks start in the calling thread's queue, so the other threads
+  // must steal them to finish early.
+  std::atomic<int> done{0};
+  pool.Run(16u, [&](std::size_t _i)
+  {
+    if (_i % 4u == 0u)
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ++done;
+  });
+  EXPECT_EQ(16, done.load());
+  EXPECT_GT(pool.Stats().steals, 0u);
+}
+
+/////////////////////////////////////////////////
+TEST(WorkStealingPool, RunOnNodes)
+{
+  // Threads 0 and 1 are on node 0, threads 2 and 3 on node 1
+  WorkStealingPool pool(4u, {}, {0u, 0u, 1u, 1u});
+  EXPECT_EQ(2u, pool.NodeCount());
+
+  // Tasks of node 1 are queued on threads 2 and 3 only, so while those are
+  // busy, threads of node 0 must steal them remotely
+  std::vector<std::atomic<int>> calls(40u);
+  pool.RunOnNodes(calls.size(), [](std::size_t _i)
+  {
+    return _i < 4u ? 0u : 1u;
+  },
+  [&](std::size_t _i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ++calls[_i];
+  });
+  for (const auto &call : calls)
+    EXPECT_EQ(1, call.load());
+
+  auto stats = pool.Stats();
+  EXPECT_EQ(1u, stats.batches);
+  EXPECT_EQ(40u, stats.tasks);
+  EXPECT_GT(stats.remoteSteals, 0u);
+  EXPECT_LE(stats.remoteSteals, stats.steals);
+
+  // Nodes without threads wrap around
+  std::atomic<int> done{0};
+  pool.RunOnNodes(8u, [](std::size_t) { return 5u; },
+      [&](std::size_t) { ++done; });
+  EXPECT_EQ(8, done.load());
+
+  // A pool without nodes never steals remotely
+  WorkStealingPool flat(4u);
+  EXPECT_EQ(1u, flat.NodeCount());
+  flat.RunOnNodes(16u, [](std::size_t _i) { return _i % 2u; },
+      [](std::size_t)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      });
+  EXPECT_EQ(0u, flat.Stats().remoteSteals);
+}
+
+/////////////////////////////////////////////////
+TEST(WorkStealingPool, SingleThread)
+{
+  WorkStealingPool pool(1u);
+  EXPECT_EQ(1u, pool.ThreadCount());
+
+  // Everything runs on the calling thread
+  const auto caller = std::this_thread::get_id();
+  int count{0};
+  pool.Run(10u, [&](std::size_t)
+  {
+    EXPECT_EQ(caller, std::this_thread::get_id());
+    ++count;
+  });
+  EXPECT_EQ(10, count);
+  EXPECT_EQ(0u, pool.Stats().steals);
+}
+
+/////////////////////////////////////////////////
+TEST(WorkStealingPool, ManyBatches)
+{
+  WorkStealingPool pool;
+  EXPECT_GE(pool.ThreadCount(), 1u);
+
+  std::atomic<int> total{0};
+  for (int i = 0; i < 1000; ++i)
+  {
+    pool.Run(8u, [&](std::size_t)
+    {
+      ++total;
+    });
+  }
+  EXPECT_EQ(8000, total.load());
+}
+
+/////////////////////////////////////////////////
+TEST(WorkStealingPool, Nested)
+{
+  WorkStealingPool pool(4u);
+
+  // Tasks may run batches of their own on the same pool
+  std::vector<std::atomic<int>> calls(8u * 50u);
+  pool.Run(8u, [&](std::size_t _outer)
+  {
+    pool.Run(50u, [&](std::size_t _inner)
+    {
+      ++calls[_outer * 50u + _inner];
+    });
+  });
+
+  for (const auto &call : calls)
+    EXPECT_EQ(1, call.load());
+  EXPECT_EQ(9u, pool.Stats().batches);
+  EXPECT_EQ(408u, pool.Stats().tasks);
+}
+
+/////////////////////////////////////////////////
+TEST(WorkStealingPool, ConcurrentCallers)
+{
+  WorkStealingPool pool(3u);
+
+  std::atomic<int> total{0};
+  std::vector<std::thread> callers;
+  for (int c = 0; c < 4; ++c)
+  {
+    callers.emplace_back([&]()
+    {
+      for (int i = 0; i < 200; ++i)
+      {
+        pool.Run(5u, [&](std::size_t)
+        {
+          ++total;
+        });
+      }
+    });
+  }
+  for (auto &caller : callers)
+    caller.join();
+
+  EXPECT_EQ(4 * 200 * 5, total.load());
+}
+
+/////////////////////////////////////////////////
+TEST(WorkStealingPool, CallersOnlyHelpTheirBatch)
+{
+  WorkStealingPool pool(2u);
+
+  // Tasks of one caller never run on the other caller's thread, so they
+  // can't be nested into a caller which may hold locks they need
+  std::vector<std::thread::id> ids(2u);
+  std::atomic<int> ready{0};
+  std::atomic<bool> crossed{false};
+  std::vector<std::thread> callers;
+  for (std::size_t c = 0u; c < 2u; ++c)
+  {
+    callers.emplace_back([&, c]()
+    {
+      ids[c] = std::this_thread::get_id();
+      ++ready;
+      while (ready < 2)
+        std::this_thread::yield();
+
+      for (int i = 0; i < 200; ++i)
+      {
+        pool.Run(8u, [&](std::size_t)
+        {
+          if (std::this_thread::get_id() == ids[1u - c])
+            crossed = true;
+          std::this_thread::sleep_for(std::chrono::microseconds(10));
+        });
+      }
+    });
+  }
+  for (auto &caller : callers)
+    caller.join();
+  EXPECT_FALSE(crossed.load());
+}
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "WorldCache.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include <sdf/Element.hh>
+#include <sdf/Param.hh>
+#include <sdf/Types.hh>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/common/Util.hh>
+
+#include "ignition/gazebo/Util.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief First line of cache entries, bump the version when the format or
+/// the way worlds are flattened changes.
+static const char kHeader[] = "ignition-gazebo-world-cache 1";
+
+/// \brief Names of elements which may hold paths relative to the file they
+/// were loaded from.
+static const std::set<std::string> kPathElements = {
+    "uri", "filename", "albedo_map", "normal_map", "roughness_map",
+    "metalness_map", "emissive_map", "light_map", "ambient_occlusion_map",
+    "environment_map", "diffuse", "normal"};
+
+//////////////////////////////////////////////////
+/// \brief Hash data with 64-bit FNV-1a.
+/// \param[in] _data Data to hash.
+/// \param[in] _hash Hash to continue from.
+/// \return Hash of the data.
+static uint64_t HashData(const std::string &_data,
+    uint64_t _hash = 14695981039346656037ull)
+{
+  for (const auto c : _data)
+  {
+    _hash ^= static_cast<unsigned char>(c);
+    _hash *= 1099511628211ull;
+  }
+  return _hash;
+}
+
+//////////////////////////////////////////////////
+/// \brief Hash the contents of a file.
+/// \param[in] _path File to hash.
+/// \param[out] _hash Hash of the contents, as hexadecimal.
+/// \return False if the file couldn't be read.
+static bool HashFile(const std::string &_path, std::string &_hash)
+{
+  std::ifstream file(_path, std::ios::binary);
+  if (!file)
+    return false;
+
+  const std::string data((std::istreambuf_iterator<char>(file)),
+      std::istreambuf_iterator<char>());
+  std::ostringstream stream;
+  stream << std::hex << std::setw(16) << std::setfill('0') << HashData(data);
+  _hash = stream.str();
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Make relative resource paths absolute, and collect the files all
+/// elements were loaded from.
+/// \param[in] _elem Element to fix, along with its descendants.
+/// \param[in,out] _files Files the elements were loaded from.
+static void Flatten(const sdf::ElementPtr &_elem, std::set<std::string> &_files)
+{
+  const auto &filePath = _elem->FilePath();
+  if (!filePath.empty() && filePath != sdf::kSdfStringSource)
+    _files.insert(filePath);
+
+  auto value = _elem->GetValue();
+  if (value && value->GetTypeName() == "string" &&
+      kPathElements.count(_elem->GetName()) > 0u && !filePath.empty() &&
+      filePath != sdf::kSdfStringSource)
+  {
+    const auto path = value->GetAsString();
+    const auto fullPath = asFullPath(path, filePath);
+    if (fullPath != path && common::exists(fullPath))
+      value->SetFromString(fullPath);
+  }
+
+  for (auto child = _elem->GetFirstElement(); child;
+       child = child->GetNextElement())
+  {
+    Flatten(child, _files);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Write a file under a temporary name and rename it into place.
+/// \param[in] _path File to write.
+/// \param[in] _data Contents.
+/// \return True if successful.
+static bool WriteAtomically(const std::string &_path, const std::string &_data)
+{
+  static std::random_device device;
+  std::ostringstream tmpPath;
+  tmpPath << _path << "." << std::hex << device() << ".tmp";
+
+  std::ofstream out(tmpPath.str(), std::ios::binary | std::ios::trunc);
+  out.write(_data.data(), static_cast<std::streamsize>(_data.size()));
+  out.close();
+  if (!out || std::rename(tmpPath.str().c_str(), _path.c_str()) != 0)
+  {
+    std::remove(tmpPath.str().c_str());
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+WorldCache::WorldCache(const std::string &_dir)
+  : dir(_dir)
+{
+}
+
+//////////////////////////////////////////////////
+std::string WorldCache::EntryPath(const std::string &_worldFile) const
+{
+  // Include the resource paths in the key, since they decide which files
+  // the includes resolve to
+  auto hash = HashData(_worldFile);
+  for (const auto &env : {kResourcePathEnv, kSdfPathEnv,
+       std::string("IGN_FILE_PATH")})
+  {
+    std::string value;
+    common::env(env, value);
+    hash = HashData(std::string(1, '\n') + value, hash);
+  }
+
+  std::ostringstream name;
+  name << std::hex << std::setw(16) << std::setfill('0') << hash
+       << ".sdfcache";
+  return common::joinPaths(this->dir, name.str());
+}
+
+//////////////////////////////////////////////////
+bool WorldCache::Load(const std::string &_worldFile, std::string &_sdfString,
+    std::unordered_map<std::string, std::string> &_fuelUriMap) const
+{
+  IGN_PROFILE("WorldCache::Load");
+  const auto entryPath = this->EntryPath(_worldFile);
+  std::ifstream entry(entryPath, std::ios::binary);
+  if (!entry)
+    return false;
+
+  std::string line;
+  if (!std::getline(entry, line) || line != kHeader ||
+      !std::getline(entry, line) || line != "world\t" + _worldFile)
+  {
+    return false;
+  }
+
+  std::unordered_map<std::string, std::string> fuelUriMap;
+  while (std::getline(entry, line) && line != "sdf")
+  {
+    const auto first = line.find('\t');
+    const auto second = line.find('\t', first + 1u);
+    if (first == std::string::npos || second == std::string::npos)
+      return false;
+
+    const auto kind = line.substr(0, first);
+    const auto key = line.substr(first + 1u, second - first - 1u);
+    const auto value = line.substr(second + 1u);
+    if (kind == "file")
+    {
+      std::string hash;
+      if (!HashFile(value, hash) || hash != key)
+      {
+        igndbg << "World cache entry [" << entryPath << "] is out of date, ["
+               << value << "] changed." << std::endl;
+        return false;
+      }
+    }
+    else if (kind == "fuel")
+    {
+      fuelUriMap[key] = value;
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  if (line != "sdf")
+    return false;
+
+  _sdfString.assign(std::istreambuf_iterator<char>(entry),
+      std::istreambuf_iterator<char>());
+  _fuelUriMap = std::move(fuelUriMap);
+  return !_sdfString.empty();
+}
+
+//////////////////////////////////////////////////
+bool WorldCache::Save(const std::string &_worldFile, const sdf::Root &_root,
+    const std::unordered_map<std::string, std::string> &_fuelUriMap) const
+{
+  IGN_PROFILE("WorldCache::Save");
+  if (nullptr == _root.Element())
+    return false;
+
+  auto elem = _root.Element()->Clone();
+  std::set<std::string> files{_worldFile};
+  Flatten(elem, files);
+
+  // Model configs decide which SDF file of a model is included
+  std::set<std::string> configs;
+  for (const auto &file : files)
+  {
+    const auto config = common::joinPaths(common::parentPath(file),
+        "model.config");
+    if (common::isFile(config))
+      configs.insert(config);
+  }
+  files.insert(configs.begin(), configs.end());
+
+  std::ostringstream out;
+  out << kHeader << "\n" << "world\t" << _worldFile << "\n";
+  for (const auto &file : files)
+  {
+    std::string hash;
+    if (!HashFile(file, hash))
+    {
+      ignwarn << "Not caching world [" << _worldFile << "], failed to read ["
+              << file << "]." << std::endl;
+      return false;
+    }
+    out << "file\t" << hash << "\t" << file << "\n";
+  }
+  // Sort for a stable entry
+  const std::map<std::string, std::string> fuelUris(_fuelUriMap.begin(),
+      _fuelUriMap.end());
+  for (const auto &[path, uri] : fuelUris)
+    out << "fuel\t" << path << "\t" << uri << "\n";
+  out << "sdf\n" << elem->ToString("");
+
+  if ((!common::exists(this->dir) && !common::createDirectories(this->dir)) ||
+      !WriteAtomically(this->EntryPath(_worldFile), out.str()))
+  {
+    ignwarn << "Failed to write world cache entry for [" << _worldFile
+            << "] in [" << this->dir << "]." << std::endl;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_WORLDCACHE_HH_
+#define IGNITION_GAZEBO_WORLDCACHE_HH_
+
+#include <string>
+#include <unordered_map>
+
+#include <sdf/Root.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class WorldCache WorldCache.hh
+    /// \brief On-disk cache of worlds with all their includes resolved.
+    ///
+    /// Loading a world file resolves every `<include>`, which means finding
+    /// each model on the resource paths or in the Fuel cache and parsing its
+    /// files one by one. The cache saves the loaded world as a single
+    /// document, with relative resource paths made absolute, together with
+    /// the list of files it was built from and a hash of each. Later loads
+    /// of the same world file use the document as long as none of those
+    /// files changed and the resource paths are the same.
+    ///
+    /// Entries are written under a temporary name and renamed into place,
+    /// so concurrent servers never read a partial entry.
+    class IGNITION_GAZEBO_VISIBLE WorldCache
+    {
+      /// \brief Constructor
+      /// \param[in] _dir Directory holding the cache. It's created when the
+      /// first entry is saved.
+      public: explicit WorldCache(const std::string &_dir);
+
+      /// \brief Get the cached document of a world file.
+      /// \param[in] _worldFile Absolute path to the world file.
+      /// \param[out] _sdfString Cached document.
+      /// \param[out] _fuelUriMap Fuel URIs of the cached resources, by local
+      /// path, as filled while the world was loaded.
+      /// \return False if there's no entry or it's out of date.
+      public: bool Load(const std::string &_worldFile,
+                  std::string &_sdfString,
+                  std::unordered_map<std::string, std::string> &_fuelUriMap)
+                  const;
+
+      /// \brief Save a loaded world, replacing any previous entry.
+      /// \param[in] _worldFile Absolute path to the world file.
+      /// \param[in] _root World loaded from _worldFile.
+      /// \param[in] _fuelUriMap Fuel URIs of the resources downloaded while
+      /// loading the world, by local path.
+      /// \return True if successful.
+      public: bool Save(const std::string &_worldFile, const sdf::Root &_root,
+                  const std::unordered_map<std::string, std::string>
+                  &_fuelUriMap) const;
+
+      /// \brief Path of the entry of a world file.
+      /// \param[in] _worldFile Absolute path to the world file.
+      /// \return Path inside the cache directory.
+      public: std::string EntryPath(const std::string &_worldFile) const;
+
+      /// \brief Directory holding the cache.
+      private: std::string dir;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_WORLDCACHE_HH_
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+#include <ignition/common/Filesystem.hh>
+#include <sdf/Geometry.hh>
+#include <sdf/Link.hh>
+#include <sdf/Mesh.hh>
+#include <sdf/Model.hh>
+#include <sdf/Root.hh>
+#include <sdf/Visual.hh>
+#include <sdf/World.hh>
+
+#include "ignition/gazebo/test_config.hh"
+#include "WorldCache.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+class WorldCacheTest : public ::testing::Test
+{
+  protected: void SetUp() override
+  {
+    this->dir = common::joinPaths(PROJECT_BINARY_PATH, "world_cache_test");
+    common::removeAll(this->dir);
+
+    const auto modelDir = common::joinPaths(this->dir, "box");
+    common::createDirectories(common::joinPaths(modelDir, "meshes"));
+    std::ofstream(common::joinPaths(modelDir, "meshes", "box.dae"))
+        << "<COLLADA/>";
+    std::ofstream(common::joinPaths(modelDir, "model.config")) << R"(
+      <model>
+        <name>box</name>
+        <sdf version="1.6">model.sdf</sdf>
+      </model>)";
+    this->modelFile = common::joinPaths(modelDir, "model.sdf");
+    this->WriteModel("1");
+
+    this->worldFile = common::joinPaths(this->dir, "world.sdf");
+    std::ofstream(this->worldFile) << R"(
+      <sdf version="1.6">
+        <world name="default">
+          <include>
+            <uri>)" << modelDir << R"(</uri>
+            <name>included_box</name>
+          </include>
+        </world>
+      </sdf>)";
+  }
+
+  protected: void TearDown() override
+  {
+    common::removeAll(this->dir);
+  }
+
+  /// \brief Write the included model.
+  /// \param[in] _mass Mass of its link, to tell versions apart.
+  protected: void WriteModel(const std::string &_mass)
+  {
+    std::ofstream(this->modelFile) << R"(
+      <sdf version="1.6">
+        <model name="box">
+          <link name="link">
+            <inertial><mass>)" << _mass << R"(</mass></inertial>
+            <visual name="visual">
+              <geometry>
+                <mesh><uri>meshes/box.dae</uri></mesh>
+              </geometry>
+            </visual>
+          </link>
+        </model>
+      </sdf>)";
+  }
+
+  /// \brief Directory with all test files.
+  protected: std::string dir;
+
+  /// \brief Included model file.
+  protected: std::string modelFile;
+
+  /// \brief World file.
+  protected: std::string worldFile;
+};
+
+/////////////////////////////////////////////////
+TEST_F(WorldCacheTest, SaveAndLoad)
+{
+  WorldCache cache(common::joinPaths(this->dir, "cache"));
+
+  std::string sdfString;
+  std::unordered_map<std::string, std::string> fuelUris;
+  EXPECT_FALSE(cache.Load(this->worldFile, sdfString, fuelUris));
+
+  sdf::Root root;
+  ASSERT_TRUE(root.Load(this->worldFile).empty());
+  const std::unordered_map<std::string, std::string> savedUris{
+      {"/cache/models/box", "https://fuel.example.com/1.0/org/models/box"}};
+  ASSERT_TRUE(cache.Save(this->worldFile, root, savedUris));
+  EXPECT_TRUE(common::isFile(cache.EntryPath(this->worldFile)));
+
+  ASSERT_TRUE(cache.Load(this->worldFile, sdfString, fuelUris));
+  EXPECT_EQ(savedUris, fuelUris);
+
+  // The cached document has the include resolved and the mesh path made
+  // absolute
+  sdf::Root cachedRoot;
+  ASSERT_TRUE(cachedRoot.LoadSdfString(sdfString).empty());
+  ASSERT_NE(nullptr, cachedRoot.WorldByIndex(0));
+  const auto *model =
+      cachedRoot.WorldByIndex(0)->ModelByName("included_box");
+  ASSERT_NE(nullptr, model);
+  const auto *mesh = model->LinkByIndex(0)->VisualByIndex(0)->Geom()->
+      MeshShape();
+  ASSERT_NE(nullptr, mesh);
+  EXPECT_EQ(common::joinPaths(this->dir, "box", "meshes", "box.dae"),
+      mesh->Uri());
+
+  // Other worlds don't have an entry
+  EXPECT_FALSE(cache.Load(common::joinPaths(this->dir, "other.sdf"),
+      sdfString, fuelUris));
+}
+
+/////////////////////////////////////////////////
+TEST_F(WorldCacheTest, Invalidate)
+{
+  WorldCache cache(common::joinPaths(this->dir, "cache"));
+
+  sdf::Root root;
+  ASSERT_TRUE(root.Load(this->worldFile).empty());
+  ASSERT_TRUE(cache.Save(this->worldFile, root, {}));
+
+  std::string sdfString;
+  std::unordered_map<std::string, std::string> fuelUris;
+  EXPECT_TRUE(cache.Load(this->worldFile, sdfString, fuelUris));
+
+  // Changing an included file invalidates the entry
+  this->WriteModel("2");
+  EXPECT_FALSE(cache.Load(this->worldFile, sdfString, fuelUris));
+
+  sdf::Root newRoot;
+  ASSERT_TRUE(newRoot.Load(this->worldFile).empty());
+  ASSERT_TRUE(cache.Save(this->worldFile, newRoot, {}));
+  EXPECT_TRUE(cache.Load(this->worldFile, sdfString, fuelUris));
+
+  // So does a corrupt entry
+  std::ofstream(cache.EntryPath(this->worldFile)) << "not a cache entry";
+  EXPECT_FALSE(cache.Load(this->worldFile, sdfString, fuelUris));
+}
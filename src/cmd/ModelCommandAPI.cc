@@ -30,6 +30,7 @@
 #include <sdf/Noise.hh>
 #include <sdf/Sensor.hh>
 
+#include <ignition/msgs/param.pb.h>
 #include <ignition/msgs/serialized.pb.h>
 #include <ignition/msgs/stringmsg.pb.h>
 
@@ -535,10 +536,15 @@ void printMagnetometer(const uint64_t _entity,
 }
 
 //////////////////////////////////////////////////
-// \brief Set the state of a ECM instance with a world snapshot.
+// \brief Set the state of a ECM instance with part of a world snapshot.
+// Only the entities and components requested are sent by the server.
 // \param _ecm ECM instance to be populated.
+// \param _model Name of the model whose subtree is needed, empty for all
+// entities.
+// \param _types Component types needed, empty for all of them.
 // \return boolean indicating if it was able to populate the ECM.
-bool populateECM(EntityComponentManager &_ecm)
+bool populateECM(EntityComponentManager &_ecm, const std::string &_model,
+    const std::vector<ComponentTypeId> &_types)
 {
   const std::string world = getWorldName();
   if (world.empty())
@@ -551,15 +557,31 @@ bool populateECM(EntityComponentManager &_ecm)
   transport::Node node;
   bool result{false};
   const unsigned int timeout{5000};
-  const std::string service{"/world/" + world + "/state"};
+  const std::string service{"/world/" + world + "/state/query"};
 
   std::cout << std::endl << "Requesting state for world [" << world
             << "]..." << std::endl << std::endl;
 
+  msgs::Param req;
+  auto &params = *req.mutable_params();
+  if (!_model.empty())
+  {
+    params["model"].set_type(msgs::Any::STRING);
+    params["model"].set_string_value(_model);
+  }
+  if (!_types.empty())
+  {
+    std::string types;
+    for (const auto &type : _types)
+      types += std::to_string(type) + " ";
+    params["component_types"].set_type(msgs::Any::STRING);
+    params["component_types"].set_string_value(types);
+  }
+
   // Request and block
   msgs::SerializedStepMap res;
 
-  if (!node.Request(service, timeout, res, result))
+  if (!node.Request(service, req, timeout, res, result))
   {
     std::cerr << std::endl << "Service call to [" << service << "] timed out"
               << std::endl;
@@ -781,7 +803,9 @@ void printJoints(const uint64_t _modelEntity,
 extern "C" void cmdModelList()
 {
   EntityComponentManager ecm{};
-  if (!populateECM(ecm))
+  if (!populateECM(ecm, "", {components::World::typeId,
+      components::Model::typeId, components::Name::typeId,
+      components::ParentEntity::typeId}))
   {
     return;
   }
@@ -835,8 +859,16 @@ extern "C" void cmdModelInfo(
     return;
   }
 
+  // Printing the pose only needs the model itself
+  std::vector<ComponentTypeId> types;
+  if (_pose && !_linkName && !_jointName && !_sensorName)
+  {
+    types = {components::Model::typeId, components::Name::typeId,
+        components::Pose::typeId};
+  }
+
   EntityComponentManager ecm{};
-  if (!populateECM(ecm))
+  if (!populateECM(ecm, _modelName, types))
     return;
 
   // Get the desired model entity.
@@ -22,6 +22,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include <ignition/transport/Node.hh>
 #include "ignition/gazebo/comms/Broker.hh"
@@ -58,6 +59,25 @@ using namespace ignition;
 using namespace gazebo;
 using namespace comms;
 
+/// \brief Started brokers of this process, keyed by their messages topic.
+/// Always lock the mutex before the mutex of a broker.
+struct LocalBrokers
+{
+  /// \brief Protect the brokers.
+  std::mutex mutex;
+
+  /// \brief Brokers keyed by messages topic.
+  std::unordered_map<std::string, Broker *> brokers;
+};
+
+/// \brief Get the started brokers of this process.
+/// \return The brokers.
+static LocalBrokers &StartedBrokers()
+{
+  static LocalBrokers brokers;
+  return brokers;
+}
+
 //////////////////////////////////////////////////
 Broker::Broker()
   : dataPtr(ignition::utils::MakeUniqueImpl<Implementation>())
@@ -65,6 +85,16 @@ Broker::Broker()
   this->dataPtr->node = std::make_unique<ignition::transport::Node>();
 }
 
+//////////////////////////////////////////////////
+Broker::~Broker()
+{
+  auto &started = StartedBrokers();
+  std::lock_guard<std::mutex> lock(started.mutex);
+  auto it = started.brokers.find(this->dataPtr->msgTopic);
+  if (it != started.brokers.end() && it->second == this)
+    started.brokers.erase(it);
+}
+
 //////////////////////////////////////////////////
 void Broker::Load(std::shared_ptr<const sdf::Element> _sdf)
 {
@@ -110,6 +140,21 @@ void Broker::Start()
     return;
   }
 
+  {
+    auto &started = StartedBrokers();
+    std::lock_guard<std::mutex> lock(started.mutex);
+    auto &broker = started.brokers[this->dataPtr->msgTopic];
+    if (broker && broker != this)
+    {
+      ignwarn << "Another broker already receives in-process messages on ["
+              << this->dataPtr->msgTopic << "]" << std::endl;
+    }
+    else
+    {
+      broker = this;
+    }
+  }
+
   igndbg << "Broker services:" << std::endl;
   igndbg << "  Bind: [" << this->dataPtr->bindSrv << "]" << std::endl;
   igndbg << "  Unbind: [" << this->dataPtr->unbindSrv << "]" << std::endl;
@@ -181,16 +226,95 @@ void Broker::OnUnbind(const ignition::msgs::StringMsg_V &_req)
 //////////////////////////////////////////////////
 void Broker::OnMsg(const ignition::msgs::Dataframe &_msg)
 {
-  // Place the message in the outbound queue of the sender.
-  auto msgPtr = std::make_shared<ignition::msgs::Dataframe>(_msg);
+  // The transport callback doesn't own the message.
+  this->Send(std::make_shared<ignition::msgs::Dataframe>(_msg));
+}
 
+//////////////////////////////////////////////////
+void Broker::Send(const msgs::DataframeSharedPtr &_msg)
+{
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
 
   // Stamp the time.
-  msgPtr->mutable_header()->mutable_stamp()->CopyFrom(
+  _msg->mutable_header()->mutable_stamp()->CopyFrom(
       gazebo::convert<msgs::Time>(this->dataPtr->time));
 
-  this->DataManager().AddOutbound(_msg.src_address(), msgPtr);
+  // Place the message in the outbound queue of the sender.
+  this->DataManager().AddOutbound(_msg->src_address(), _msg);
+}
+
+//////////////////////////////////////////////////
+bool Broker::BindLocal(const std::string &_address,
+                       const std::string &_modelName,
+                       const std::string &_name,
+                       const LocalCallback &_callback)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  if (!this->DataManager().AddLocalSubscriber(_address, _modelName, _name,
+      _callback))
+  {
+    return false;
+  }
+
+  igndbg << "Address [" << _address << "] bound to model [" << _modelName
+         << "] in process as [" << _name << "]" << std::endl;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Broker::UnbindLocal(const std::string &_address,
+                         const std::string &_name)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->DataManager().RemoveLocalSubscriber(_address, _name);
+}
+
+//////////////////////////////////////////////////
+bool Broker::SendLocal(const std::string &_msgTopic,
+                       const msgs::DataframeSharedPtr &_msg)
+{
+  auto &started = StartedBrokers();
+  std::lock_guard<std::mutex> lock(started.mutex);
+  auto it = started.brokers.find(_msgTopic);
+  if (it == started.brokers.end())
+    return false;
+
+  it->second->Send(_msg);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Broker::BindLocal(const std::string &_msgTopic,
+                       const std::string &_address,
+                       const std::string &_modelName,
+                       const std::string &_name,
+                       const LocalCallback &_callback)
+{
+  auto &started = StartedBrokers();
+  std::lock_guard<std::mutex> lock(started.mutex);
+  auto it = started.brokers.find(_msgTopic);
+  if (it == started.brokers.end())
+  {
+    ignerr << "No broker receives in-process messages on [" << _msgTopic
+           << "]" << std::endl;
+    return false;
+  }
+
+  return it->second->BindLocal(_address, _modelName, _name, _callback);
+}
+
+//////////////////////////////////////////////////
+bool Broker::UnbindLocal(const std::string &_msgTopic,
+                         const std::string &_address,
+                         const std::string &_name)
+{
+  auto &started = StartedBrokers();
+  std::lock_guard<std::mutex> lock(started.mutex);
+  auto it = started.brokers.find(_msgTopic);
+  if (it == started.brokers.end())
+    return false;
+
+  return it->second->UnbindLocal(_address, _name);
 }
 
 //////////////////////////////////////////////////
@@ -20,6 +20,8 @@
 #include <ignition/msgs/dataframe.pb.h>
 #include <ignition/msgs/stringmsg_v.pb.h>
 
+#include <memory>
+
 #include "ignition/gazebo/comms/Broker.hh"
 #include "ignition/gazebo/comms/MsgManager.hh"
 #include "helpers/EnvTestFixture.hh"
@@ -101,3 +103,57 @@ TEST_F(BrokerTest, Broker)
   broker.SetTime(time1);
   EXPECT_EQ(time1, broker.Time());
 }
+
+/////////////////////////////////////////////////
+TEST_F(BrokerTest, Local)
+{
+  auto msg = std::make_shared<msgs::Dataframe>();
+  msg->set_src_address("addr1");
+  EXPECT_FALSE(comms::Broker::SendLocal("/local_test/msgs", msg));
+
+  comms::DataQueue received;
+  auto callback = [&received](const comms::DataQueue &_msgs)
+  {
+    received = _msgs;
+  };
+
+  {
+    comms::Broker broker;
+    auto topicElem = std::make_shared<sdf::Element>();
+    topicElem->SetName("messages_topic");
+    topicElem->AddValue("string", "/local_test/msgs", true);
+    auto brokerElem = std::make_shared<sdf::Element>();
+    brokerElem->SetName("broker");
+    brokerElem->InsertElement(topicElem);
+    auto sdf = std::make_shared<sdf::Element>();
+    sdf->SetName("plugin");
+    sdf->InsertElement(brokerElem);
+    broker.Load(sdf);
+
+    // Not reachable until started.
+    EXPECT_FALSE(comms::Broker::BindLocal("/local_test/msgs", "addr2",
+        "model2", "local", callback));
+    broker.Start();
+    EXPECT_TRUE(comms::Broker::BindLocal("/local_test/msgs", "addr2",
+        "model2", "local", callback));
+
+    // Messages are queued without copies.
+    EXPECT_TRUE(comms::Broker::SendLocal("/local_test/msgs", msg));
+    auto &allData = broker.DataManager().Data();
+    ASSERT_EQ(1u, allData["addr1"].outboundMsgs.size());
+    EXPECT_EQ(msg, allData["addr1"].outboundMsgs[0u]);
+    EXPECT_TRUE(msg->header().has_stamp());
+
+    allData["addr2"].inboundMsgs.push_back(msg);
+    broker.DeliverMsgs();
+    ASSERT_EQ(1u, received.size());
+    EXPECT_EQ(msg, received[0u]);
+
+    EXPECT_TRUE(comms::Broker::UnbindLocal("/local_test/msgs", "addr2",
+        "local"));
+    EXPECT_TRUE(allData["addr2"].localSubscriptions.empty());
+  }
+
+  // The broker is gone.
+  EXPECT_FALSE(comms::Broker::SendLocal("/local_test/msgs", msg));
+}
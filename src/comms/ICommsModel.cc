@@ -114,12 +114,10 @@ void ICommsModel::StepImpl(const UpdateInfo &_info,
   // Update the time in the broker.
   this->dataPtr->broker.SetTime(_info.simTime);
 
-  // Step the comms model.
-  const Registry &currentRegistry =
-    this->dataPtr->broker.DataManager().DataConst();
-  Registry newRegistry = this->dataPtr->broker.DataManager().Copy();
-  this->Step(_info, currentRegistry, newRegistry, _ecm);
-  this->dataPtr->broker.DataManager().Set(newRegistry);
+  // Step the comms model. The registry is updated in place instead of on a
+  // copy, so only the queues which the model touches are modified.
+  Registry &registry = this->dataPtr->broker.DataManager().Data();
+  this->Step(_info, registry, registry, _ecm);
 
   this->dataPtr->broker.Unlock();
 
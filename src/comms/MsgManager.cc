@@ -72,6 +72,30 @@ bool MsgManager::AddSubscriber(const std::string &_address,
   return true;
 }
 
+//////////////////////////////////////////////////
+bool MsgManager::AddLocalSubscriber(const std::string &_address,
+                                    const std::string &_modelName,
+                                    const std::string &_name,
+                                    const LocalCallback &_callback)
+{
+  if (!_callback)
+  {
+    ignerr << "AddLocalSubscriber() error: Empty callback" << std::endl;
+    return false;
+  }
+
+  auto &content = this->dataPtr->data[_address];
+  if (!content.modelName.empty() && content.modelName != _modelName)
+  {
+    ignerr << "AddLocalSubscriber() error: Address already attached to a "
+           << "different model" << std::endl;
+    return false;
+  }
+  content.modelName = _modelName;
+  content.localSubscriptions[_name] = _callback;
+  return true;
+}
+
 //////////////////////////////////////////////////
 void MsgManager::AddInbound(const std::string &_address,
                             const msgs::DataframeSharedPtr &_msg)
@@ -102,8 +126,34 @@ bool MsgManager::RemoveSubscriber(const std::string &_address,
 
   // It there are no subscribers we clear the model name. This way the address
   // can be bound to a separate model. We also clear the queues.
-  if (it->second.subscriptions.empty())
+  if (it->second.subscriptions.empty() &&
+      it->second.localSubscriptions.empty())
+  {
+    it->second.modelName = "";
+  }
+
+  return res;
+}
+
+//////////////////////////////////////////////////
+bool MsgManager::RemoveLocalSubscriber(const std::string &_address,
+                                       const std::string &_name)
+{
+  auto it = this->dataPtr->data.find(_address);
+  if (it == this->dataPtr->data.end())
+  {
+    ignerr << "RemoveLocalSubscriber() error: Unable to find address ["
+           << _address << "]" << std::endl;
+    return false;
+  }
+
+  auto res = it->second.localSubscriptions.erase(_name) > 0;
+
+  if (it->second.subscriptions.empty() &&
+      it->second.localSubscriptions.empty())
+  {
     it->second.modelName = "";
+  }
 
   return res;
 }
@@ -149,6 +199,12 @@ void MsgManager::DeliverMsgs()
   {
     // Reference to the inbound queue for this address.
     auto &inbound = content.inboundMsgs;
+    if (inbound.empty())
+      continue;
+
+    // In-process subscribers share the whole batch.
+    for (auto & [name, callback] : content.localSubscriptions)
+      callback(inbound);
 
     // All these messages need to be delivered.
     for (auto &msg : inbound)
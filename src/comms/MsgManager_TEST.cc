@@ -19,6 +19,7 @@
 #include <ignition/msgs/dataframe.pb.h>
 
 #include <unordered_map>
+#include <vector>
 
 #include "ignition/gazebo/comms/MsgManager.hh"
 #include "helpers/EnvTestFixture.hh"
@@ -144,3 +145,52 @@ TEST_F(MsgManagerTest, MsgManager)
   EXPECT_TRUE(it->second.subscriptions.empty());
 
 }
+
+/////////////////////////////////////////////////
+TEST_F(MsgManagerTest, LocalSubscriber)
+{
+  comms::MsgManager msgManager;
+
+  std::vector<comms::DataQueue> batches;
+  auto callback = [&batches](const comms::DataQueue &_msgs)
+  {
+    batches.push_back(_msgs);
+  };
+
+  EXPECT_FALSE(msgManager.AddLocalSubscriber("addr1", "model1", "local",
+      comms::LocalCallback()));
+  EXPECT_TRUE(msgManager.AddLocalSubscriber("addr1", "model1", "local",
+      callback));
+  EXPECT_EQ("model1", msgManager.Data()["addr1"].modelName);
+  EXPECT_FALSE(msgManager.AddLocalSubscriber("addr1", "model2", "local",
+      callback));
+
+  // Nothing is delivered without messages.
+  msgManager.DeliverMsgs();
+  EXPECT_TRUE(batches.empty());
+
+  // All the messages of a step arrive at once, without copies.
+  auto msg1 = std::make_shared<msgs::Dataframe>();
+  auto msg2 = std::make_shared<msgs::Dataframe>();
+  msgManager.AddInbound("addr1", msg1);
+  msgManager.AddInbound("addr1", msg2);
+  msgManager.DeliverMsgs();
+  ASSERT_EQ(1u, batches.size());
+  ASSERT_EQ(2u, batches[0].size());
+  EXPECT_EQ(msg1, batches[0][0]);
+  EXPECT_EQ(msg2, batches[0][1]);
+  EXPECT_TRUE(msgManager.Data()["addr1"].inboundMsgs.empty());
+
+  // The address is kept while any subscriber remains.
+  EXPECT_TRUE(msgManager.AddSubscriber("addr1", "model1", "topic1"));
+  EXPECT_TRUE(msgManager.RemoveLocalSubscriber("addr1", "local"));
+  EXPECT_FALSE(msgManager.RemoveLocalSubscriber("addr1", "local"));
+  EXPECT_FALSE(msgManager.RemoveLocalSubscriber("not_found", "local"));
+  EXPECT_EQ("model1", msgManager.Data()["addr1"].modelName);
+  EXPECT_TRUE(msgManager.RemoveSubscriber("addr1", "topic1"));
+  EXPECT_TRUE(msgManager.Data()["addr1"].modelName.empty());
+
+  msgManager.AddInbound("addr1", msg1);
+  msgManager.DeliverMsgs();
+  EXPECT_EQ(1u, batches.size());
+}
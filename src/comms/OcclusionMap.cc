@@ -0,0 +1,656 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/common/Util.hh>
+#include <ignition/math/Quaternion.hh>
+#include <sdf/Box.hh>
+#include <sdf/Capsule.hh>
+#include <sdf/Cylinder.hh>
+#include <sdf/Ellipsoid.hh>
+#include <sdf/Geometry.hh>
+#include <sdf/Sphere.hh>
+#include "ignition/gazebo/comms/OcclusionMap.hh"
+#include "ignition/gazebo/components/Collision.hh"
+#include "ignition/gazebo/components/Geometry.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Static.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace comms;
+
+/// \brief Identifies occlusion map files.
+static const char kMagic[4] = {'I', 'G', 'O', 'M'};
+
+/// \brief Version of the occlusion map format, bump when it changes.
+static const uint32_t kVersion{1u};
+
+/// \brief Largest number of cells of a map. The pairs of this many cells
+/// take 32 MiB.
+static constexpr std::size_t kMaxCells{8192u};
+
+/// \brief An obstacle, stored in the form used to ray cast it.
+struct Obstacle
+{
+  /// \brief Center of the box in the world frame.
+  math::Vector3d center;
+
+  /// \brief Rotation from the world frame to the frame of the box.
+  math::Quaterniond inverse;
+
+  /// \brief Half of the size of the box.
+  math::Vector3d halfSize;
+
+  /// \brief Bounds of the box in the world frame.
+  math::AxisAlignedBox bounds;
+};
+
+/// \brief Private OcclusionMap data class.
+class ignition::gazebo::comms::OcclusionMap::Implementation
+{
+  /// \brief Get the cell containing a point, or the closest one.
+  /// \param[in] _point Point in the world frame.
+  /// \return Index of the cell.
+  public: std::size_t CellIndex(const math::Vector3d &_point) const;
+
+  /// \brief Get the center of a cell.
+  /// \param[in] _index Index of the cell.
+  /// \return Center in the world frame.
+  public: math::Vector3d CellCenter(std::size_t _index) const;
+
+  /// \brief Count the obstacles crossed by a segment.
+  /// \param[in] _from Start of the segment.
+  /// \param[in] _to End of the segment.
+  /// \return Number of obstacles, saturated.
+  public: uint8_t Cast(const math::Vector3d &_from,
+                       const math::Vector3d &_to) const;
+
+  /// \brief Hash everything the map depends on.
+  /// \return 64-bit FNV-1a hash of the grid and the obstacles.
+  public: uint64_t Hash() const;
+
+  /// \brief Read the pairs from a cached map.
+  /// \param[in] _path File to read.
+  /// \return True if the file held a map of the current size.
+  public: bool ReadCache(const std::string &_path);
+
+  /// \brief Write the pairs to a cached map. The file is written under a
+  /// temporary name and renamed, so other simulations never read a partial
+  /// file.
+  /// \param[in] _path File to write.
+  public: void WriteCache(const std::string &_path) const;
+
+  /// \brief Region of the world covered by the map.
+  public: math::AxisAlignedBox region;
+
+  /// \brief Requested size of a cell.
+  public: double resolution{1.0};
+
+  /// \brief Attenuation of each obstacle in dB.
+  public: double obstacleLoss{10.0};
+
+  /// \brief Directory of the cache, empty if disabled.
+  public: std::string cachePath;
+
+  /// \brief All the obstacles.
+  public: std::vector<Obstacle> obstacles;
+
+  /// \brief Number of cells along each axis.
+  public: std::size_t counts[3]{1u, 1u, 1u};
+
+  /// \brief Actual size of a cell, which divides the region evenly.
+  public: math::Vector3d cellSize;
+
+  /// \brief Number of obstacles between the centers of each pair of cells,
+  /// indexed by PairIndex.
+  public: std::vector<uint8_t> pairs;
+
+  /// \brief Whether the static collisions were added.
+  public: bool updated{false};
+};
+
+//////////////////////////////////////////////////
+/// \brief Index of an unordered pair of cells.
+/// \param[in] _a First cell.
+/// \param[in] _b Second cell.
+/// \return Index in the table of pairs.
+static std::size_t PairIndex(std::size_t _a, std::size_t _b)
+{
+  if (_a > _b)
+    std::swap(_a, _b);
+  return _b * (_b + 1u) / 2u + _a;
+}
+
+//////////////////////////////////////////////////
+/// \brief Mix a value into a 64-bit FNV-1a hash.
+/// \param[in, out] _hash Hash.
+/// \param[in] _value Value.
+static void HashValue(uint64_t &_hash, double _value)
+{
+  const auto *bytes = reinterpret_cast<const unsigned char *>(&_value);
+  for (std::size_t i = 0u; i < sizeof(_value); ++i)
+  {
+    _hash ^= bytes[i];
+    _hash *= 1099511628211ull;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Whether a segment crosses a box.
+/// \param[in] _obstacle Box.
+/// \param[in] _from Start of the segment.
+/// \param[in] _to End of the segment.
+/// \return True if any point of the segment is inside the box.
+static bool Crosses(const Obstacle &_obstacle, const math::Vector3d &_from,
+    const math::Vector3d &_to)
+{
+  const auto &bounds = _obstacle.bounds;
+  for (int a = 0; a < 3; ++a)
+  {
+    if (std::max(_from[a], _to[a]) < bounds.Min()[a] ||
+        std::min(_from[a], _to[a]) > bounds.Max()[a])
+    {
+      return false;
+    }
+  }
+
+  // Slab test in the frame of the box
+  const auto start = _obstacle.inverse * (_from - _obstacle.center);
+  const auto delta = _obstacle.inverse * (_to - _obstacle.center) - start;
+  double first = 0.0;
+  double last = 1.0;
+  for (int a = 0; a < 3; ++a)
+  {
+    const double half = _obstacle.halfSize[a];
+    if (std::abs(delta[a]) < 1e-12)
+    {
+      if (std::abs(start[a]) > half)
+        return false;
+      continue;
+    }
+
+    double enter = (-half - start[a]) / delta[a];
+    double exit = (half - start[a]) / delta[a];
+    if (enter > exit)
+      std::swap(enter, exit);
+    first = std::max(first, enter);
+    last = std::min(last, exit);
+    if (first > last)
+      return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Whether an entity belongs to a static model.
+/// \param[in] _ecm Entity component manager.
+/// \param[in] _entity Entity.
+/// \return True if the entity or any of its ancestors is static.
+static bool IsStatic(const EntityComponentManager &_ecm, Entity _entity)
+{
+  while (_entity != kNullEntity)
+  {
+    auto isStatic = _ecm.Component<components::Static>(_entity);
+    if (isStatic && isStatic->Data())
+      return true;
+
+    auto parent = _ecm.Component<components::ParentEntity>(_entity);
+    if (!parent)
+      break;
+    _entity = parent->Data();
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+/// \brief Size of the box bounding a geometry in its own frame.
+/// \param[in] _geom Geometry.
+/// \param[out] _size Size of the box.
+/// \return False if the geometry can't be an obstacle.
+static bool BoundingSize(const sdf::Geometry &_geom, math::Vector3d &_size)
+{
+  switch (_geom.Type())
+  {
+    case sdf::GeometryType::BOX:
+      if (!_geom.BoxShape())
+        return false;
+      _size = _geom.BoxShape()->Size();
+      return true;
+    case sdf::GeometryType::CYLINDER:
+    {
+      if (!_geom.CylinderShape())
+        return false;
+      const double diameter = _geom.CylinderShape()->Radius() * 2.0;
+      _size.Set(diameter, diameter, _geom.CylinderShape()->Length());
+      return true;
+    }
+    case sdf::GeometryType::SPHERE:
+    {
+      if (!_geom.SphereShape())
+        return false;
+      const double diameter = _geom.SphereShape()->Radius() * 2.0;
+      _size.Set(diameter, diameter, diameter);
+      return true;
+    }
+    case sdf::GeometryType::CAPSULE:
+    {
+      if (!_geom.CapsuleShape())
+        return false;
+      const double diameter = _geom.CapsuleShape()->Radius() * 2.0;
+      _size.Set(diameter, diameter,
+          _geom.CapsuleShape()->Length() + diameter);
+      return true;
+    }
+    case sdf::GeometryType::ELLIPSOID:
+      if (!_geom.EllipsoidShape())
+        return false;
+      _size = _geom.EllipsoidShape()->Radii() * 2.0;
+      return true;
+    default:
+      return false;
+  }
+}
+
+//////////////////////////////////////////////////
+std::size_t OcclusionMap::Implementation::CellIndex(
+    const math::Vector3d &_point) const
+{
+  std::size_t cell[3];
+  for (int a = 0; a < 3; ++a)
+  {
+    cell[a] = 0u;
+    if (this->cellSize[a] <= 0.0)
+      continue;
+
+    const double offset = std::floor(
+        (_point[a] - this->region.Min()[a]) / this->cellSize[a]);
+    if (offset > 0.0)
+    {
+      cell[a] = std::min(static_cast<std::size_t>(offset),
+          this->counts[a] - 1u);
+    }
+  }
+  return cell[0] + this->counts[0] * (cell[1] + this->counts[1] * cell[2]);
+}
+
+//////////////////////////////////////////////////
+math::Vector3d OcclusionMap::Implementation::CellCenter(
+    std::size_t _index) const
+{
+  const std::size_t cell[3] = {
+      _index % this->counts[0],
+      _index / this->counts[0] % this->counts[1],
+      _index / (this->counts[0] * this->counts[1])};
+
+  math::Vector3d center;
+  for (int a = 0; a < 3; ++a)
+  {
+    center[a] = this->region.Min()[a] +
+        (static_cast<double>(cell[a]) + 0.5) * this->cellSize[a];
+  }
+  return center;
+}
+
+//////////////////////////////////////////////////
+uint8_t OcclusionMap::Implementation::Cast(const math::Vector3d &_from,
+    const math::Vector3d &_to) const
+{
+  unsigned int count{0u};
+  for (const auto &obstacle : this->obstacles)
+  {
+    if (Crosses(obstacle, _from, _to) && ++count == 255u)
+      break;
+  }
+  return static_cast<uint8_t>(count);
+}
+
+//////////////////////////////////////////////////
+uint64_t OcclusionMap::Implementation::Hash() const
+{
+  uint64_t hash = 14695981039346656037ull;
+  for (int a = 0; a < 3; ++a)
+  {
+    HashValue(hash, this->region.Min()[a]);
+    HashValue(hash, this->region.Max()[a]);
+    HashValue(hash, this->cellSize[a]);
+  }
+  for (const auto &obstacle : this->obstacles)
+  {
+    for (int a = 0; a < 3; ++a)
+    {
+      HashValue(hash, obstacle.center[a]);
+      HashValue(hash, obstacle.halfSize[a]);
+    }
+    HashValue(hash, obstacle.inverse.W());
+    HashValue(hash, obstacle.inverse.X());
+    HashValue(hash, obstacle.inverse.Y());
+    HashValue(hash, obstacle.inverse.Z());
+  }
+  return hash;
+}
+
+//////////////////////////////////////////////////
+bool OcclusionMap::Implementation::ReadCache(const std::string &_path)
+{
+  std::ifstream in(_path, std::ios::binary);
+  if (!in)
+    return false;
+
+  char magic[4];
+  uint32_t version{0u};
+  uint64_t count{0u};
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char *>(&version), sizeof(version));
+  in.read(reinterpret_cast<char *>(&count), sizeof(count));
+  if (!in || !std::equal(magic, magic + 4, kMagic) || version != kVersion ||
+      count != this->pairs.size())
+  {
+    return false;
+  }
+
+  in.read(reinterpret_cast<char *>(this->pairs.data()),
+      static_cast<std::streamsize>(this->pairs.size()));
+  return static_cast<bool>(in);
+}
+
+//////////////////////////////////////////////////
+void OcclusionMap::Implementation::WriteCache(const std::string &_path) const
+{
+  std::ostringstream tmpSuffix;
+  tmpSuffix << "." << this << ".tmp";
+  const auto tmpPath = _path + tmpSuffix.str();
+  std::ofstream out(tmpPath, std::ios::binary);
+
+  const uint64_t count{this->pairs.size()};
+  out.write(kMagic, sizeof(kMagic));
+  out.write(reinterpret_cast<const char *>(&kVersion), sizeof(kVersion));
+  out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+  out.write(reinterpret_cast<const char *>(this->pairs.data()),
+      static_cast<std::streamsize>(this->pairs.size()));
+
+  out.close();
+  if (!out || std::rename(tmpPath.c_str(), _path.c_str()) != 0)
+  {
+    ignwarn << "Failed to write occlusion map cache file [" << _path << "]."
+            << std::endl;
+    std::remove(tmpPath.c_str());
+  }
+}
+
+//////////////////////////////////////////////////
+OcclusionMap::OcclusionMap()
+  : dataPtr(ignition::utils::MakeUniqueImpl<Implementation>())
+{
+}
+
+//////////////////////////////////////////////////
+OcclusionMap::~OcclusionMap() = default;
+
+//////////////////////////////////////////////////
+bool OcclusionMap::Load(std::shared_ptr<const sdf::Element> _sdf)
+{
+  if (!_sdf->HasElement("min") || !_sdf->HasElement("max"))
+  {
+    ignerr << "Occlusion map requires <min> and <max>." << std::endl;
+    return false;
+  }
+
+  const auto resolution = _sdf->Get<double>("resolution", 1.0).first;
+  if (resolution <= 0.0)
+  {
+    ignerr << "Occlusion map <resolution> must be positive." << std::endl;
+    return false;
+  }
+
+  this->SetGrid(math::AxisAlignedBox(
+      _sdf->Get<math::Vector3d>("min"), _sdf->Get<math::Vector3d>("max")),
+      resolution);
+  this->SetObstacleLoss(
+      _sdf->Get<double>("obstacle_loss", this->dataPtr->obstacleLoss).first);
+
+  if (_sdf->HasElement("cache"))
+  {
+    std::string home;
+    common::env(IGN_HOMEDIR, home);
+    auto elem = _sdf->Clone()->GetElement("cache");
+    this->SetCachePath(elem->Get<std::string>("path",
+        common::joinPaths(home, ".ignition", "gazebo",
+        "occlusion_cache")).first);
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+void OcclusionMap::SetGrid(const math::AxisAlignedBox &_region,
+    double _resolution)
+{
+  this->dataPtr->region = _region;
+  this->dataPtr->resolution = _resolution;
+}
+
+//////////////////////////////////////////////////
+void OcclusionMap::SetObstacleLoss(double _loss)
+{
+  this->dataPtr->obstacleLoss = _loss;
+}
+
+//////////////////////////////////////////////////
+void OcclusionMap::SetCachePath(const std::string &_path)
+{
+  this->dataPtr->cachePath = _path;
+  if (!_path.empty() && !common::exists(_path) &&
+      !common::createDirectories(_path))
+  {
+    ignwarn << "Failed to create occlusion map cache directory [" << _path
+            << "]. The map won't be cached." << std::endl;
+    this->dataPtr->cachePath.clear();
+  }
+}
+
+//////////////////////////////////////////////////
+void OcclusionMap::AddBox(const math::Pose3d &_pose,
+    const math::Vector3d &_size)
+{
+  Obstacle obstacle;
+  obstacle.center = _pose.Pos();
+  obstacle.inverse = _pose.Rot().Inverse();
+  obstacle.halfSize = _size.Abs() * 0.5;
+
+  math::Vector3d min = _pose.Pos();
+  math::Vector3d max = _pose.Pos();
+  for (double x : {-1.0, 1.0})
+  {
+    for (double y : {-1.0, 1.0})
+    {
+      for (double z : {-1.0, 1.0})
+      {
+        const auto corner = _pose.Pos() + _pose.Rot().RotateVector(
+            obstacle.halfSize * math::Vector3d(x, y, z));
+        min.Min(corner);
+        max.Max(corner);
+      }
+    }
+  }
+  obstacle.bounds = math::AxisAlignedBox(min, max);
+  this->dataPtr->obstacles.push_back(obstacle);
+}
+
+//////////////////////////////////////////////////
+std::size_t OcclusionMap::AddStaticCollisions(
+    const EntityComponentManager &_ecm)
+{
+  std::size_t added{0u};
+  std::size_t ignored{0u};
+  _ecm.Each<components::Collision, components::Geometry,
+            components::ParentEntity>(
+      [&](const Entity &_entity, const components::Collision *,
+          const components::Geometry *_geom,
+          const components::ParentEntity *_parent) -> bool
+      {
+        if (!IsStatic(_ecm, _parent->Data()))
+          return true;
+
+        math::Vector3d size;
+        auto pose = _ecm.EntityWorldPose(_entity);
+        if (!pose || !BoundingSize(_geom->Data(), size))
+        {
+          ++ignored;
+          return true;
+        }
+
+        this->AddBox(*pose, size);
+        ++added;
+        return true;
+      });
+
+  igndbg << "Occlusion map added [" << added << "] static collisions and "
+         << "ignored [" << ignored << "]." << std::endl;
+  return added;
+}
+
+//////////////////////////////////////////////////
+std::size_t OcclusionMap::ObstacleCount() const
+{
+  return this->dataPtr->obstacles.size();
+}
+
+//////////////////////////////////////////////////
+bool OcclusionMap::Build(const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("OcclusionMap::Build");
+
+  auto &d = *this->dataPtr;
+  d.pairs.clear();
+
+  std::size_t cellCount{1u};
+  for (int a = 0; a < 3; ++a)
+  {
+    const double extent = d.region.Max()[a] - d.region.Min()[a];
+    if (!(extent >= 0.0) || !std::isfinite(extent) || d.resolution <= 0.0)
+    {
+      ignerr << "Invalid occlusion map grid." << std::endl;
+      return false;
+    }
+
+    d.counts[a] = std::max(std::size_t{1u},
+        static_cast<std::size_t>(std::ceil(extent / d.resolution)));
+    d.cellSize[a] = extent / d.counts[a];
+    cellCount *= d.counts[a];
+  }
+
+  if (cellCount > kMaxCells)
+  {
+    ignerr << "Occlusion map has [" << cellCount << "] cells, the limit is ["
+           << kMaxCells << "]. Use a coarser resolution or a smaller region."
+           << std::endl;
+    return false;
+  }
+
+  d.pairs.resize(cellCount * (cellCount + 1u) / 2u);
+
+  std::string cacheFile;
+  if (!d.cachePath.empty())
+  {
+    std::ostringstream name;
+    name << std::hex << d.Hash() << ".occ";
+    cacheFile = common::joinPaths(d.cachePath, name.str());
+    if (d.ReadCache(cacheFile))
+    {
+      igndbg << "Loaded occlusion map from [" << cacheFile << "]."
+             << std::endl;
+      return true;
+    }
+  }
+
+  // Pairs are independent. Each chunk walks its range of the triangular
+  // table, starting from the pair its first index belongs to.
+  _ecm.ParallelFor(d.pairs.size(),
+      [&d](std::size_t _first, std::size_t _last)
+      {
+        auto b = static_cast<std::size_t>(
+            (std::sqrt(8.0 * static_cast<double>(_first) + 1.0) - 1.0) / 2.0);
+        while (b * (b + 1u) / 2u > _first)
+          --b;
+        while ((b + 1u) * (b + 2u) / 2u <= _first)
+          ++b;
+        std::size_t a = _first - b * (b + 1u) / 2u;
+
+        auto centerB = d.CellCenter(b);
+        for (std::size_t i = _first; i < _last; ++i)
+        {
+          d.pairs[i] = a == b ? 0u : d.Cast(d.CellCenter(a), centerB);
+          if (++a > b)
+          {
+            a = 0u;
+            centerB = d.CellCenter(++b);
+          }
+        }
+      }, 4096u);
+
+  if (!cacheFile.empty())
+    d.WriteCache(cacheFile);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool OcclusionMap::Valid() const
+{
+  return !this->dataPtr->pairs.empty();
+}
+
+//////////////////////////////////////////////////
+unsigned int OcclusionMap::Obstacles(const math::Vector3d &_from,
+    const math::Vector3d &_to) const
+{
+  if (this->dataPtr->pairs.empty())
+    return 0u;
+
+  return this->dataPtr->pairs[PairIndex(this->dataPtr->CellIndex(_from),
+      this->dataPtr->CellIndex(_to))];
+}
+
+//////////////////////////////////////////////////
+void OcclusionMap::Update(const UpdateInfo &/*_info*/,
+    const EntityComponentManager &_ecm)
+{
+  if (this->dataPtr->updated)
+    return;
+
+  // Only attempted once, an invalid map stays empty
+  this->dataPtr->updated = true;
+  this->AddStaticCollisions(_ecm);
+  this->Build(_ecm);
+}
+
+//////////////////////////////////////////////////
+double OcclusionMap::PathLoss(const math::Vector3d &_from,
+    const math::Vector3d &_to) const
+{
+  return this->Obstacles(_from, _to) * this->dataPtr->obstacleLoss;
+}
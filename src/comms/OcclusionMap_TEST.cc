@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <ignition/common/Filesystem.hh>
+#include <sdf/Box.hh>
+#include <sdf/Geometry.hh>
+
+#include "ignition/gazebo/comms/OcclusionMap.hh"
+#include "ignition/gazebo/components/Collision.hh"
+#include "ignition/gazebo/components/Geometry.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/Static.hh"
+#include "ignition/gazebo/test_config.hh"
+#include "helpers/EnvTestFixture.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Tests for OcclusionMap class
+class OcclusionMapTest : public InternalFixture<::testing::Test>
+{
+};
+
+/////////////////////////////////////////////////
+/// \brief Create a model with a box collision.
+/// \param[in] _ecm Entity component manager.
+/// \param[in] _pose Pose of the model.
+/// \param[in] _size Size of the box.
+/// \param[in] _static Whether the model is static.
+void CreateBoxModel(EntityComponentManager &_ecm, const math::Pose3d &_pose,
+    const math::Vector3d &_size, bool _static)
+{
+  auto model = _ecm.CreateEntity();
+  _ecm.CreateComponent(model, components::Pose(_pose));
+  _ecm.CreateComponent(model, components::Static(_static));
+
+  auto link = _ecm.CreateEntity();
+  _ecm.CreateComponent(link, components::Pose());
+  _ecm.CreateComponent(link, components::ParentEntity(model));
+
+  sdf::Box box;
+  box.SetSize(_size);
+  sdf::Geometry geom;
+  geom.SetType(sdf::GeometryType::BOX);
+  geom.SetBoxShape(box);
+
+  auto collision = _ecm.CreateEntity();
+  _ecm.CreateComponent(collision, components::Collision());
+  _ecm.CreateComponent(collision, components::Geometry(geom));
+  _ecm.CreateComponent(collision, components::Pose());
+  _ecm.CreateComponent(collision, components::ParentEntity(link));
+}
+
+/////////////////////////////////////////////////
+TEST_F(OcclusionMapTest, Walls)
+{
+  EntityComponentManager ecm;
+  comms::OcclusionMap map;
+  EXPECT_FALSE(map.Valid());
+  EXPECT_EQ(0u, map.Obstacles({0, 0, 0}, {10, 0, 0}));
+
+  // A corridor along X split by a wall, as a 2D map
+  map.SetGrid(math::AxisAlignedBox({0, 0, 1}, {10, 2, 1}), 1.0);
+  map.SetObstacleLoss(12.0);
+  map.AddBox({5, 1, 1, 0, 0, 0}, {0.2, 10, 10});
+  ASSERT_TRUE(map.Build(ecm));
+  EXPECT_TRUE(map.Valid());
+
+  EXPECT_EQ(1u, map.Obstacles({0.5, 0.5, 1}, {9.5, 1.5, 1}));
+  EXPECT_EQ(1u, map.Obstacles({9.5, 1.5, 1}, {0.5, 0.5, 1}));
+  EXPECT_EQ(0u, map.Obstacles({0.5, 0.5, 1}, {4.5, 1.5, 1}));
+  EXPECT_EQ(0u, map.Obstacles({0.5, 0.5, 1}, {0.5, 0.5, 1}));
+  EXPECT_DOUBLE_EQ(12.0, map.PathLoss({0.5, 0.5, 1}, {9.5, 0.5, 1}));
+
+  // Points outside of the region use the closest cell
+  EXPECT_EQ(1u, map.Obstacles({-100, 0.5, 5}, {100, 0.5, -5}));
+
+  // Rotated walls are ray cast in their own frame
+  map.AddBox({7.5, 1, 1, 0, 0, IGN_PI / 4}, {0.1, 3, 10});
+  ASSERT_TRUE(map.Build(ecm));
+  EXPECT_EQ(2u, map.Obstacles({0.5, 0.5, 1}, {9.5, 0.5, 1}));
+  EXPECT_EQ(1u, map.Obstacles({6.5, 0.5, 1}, {9.5, 0.5, 1}));
+
+  // Too many cells
+  map.SetGrid(math::AxisAlignedBox({0, 0, 0}, {1000, 1000, 0}), 1.0);
+  EXPECT_FALSE(map.Build(ecm));
+  EXPECT_FALSE(map.Valid());
+  EXPECT_DOUBLE_EQ(0.0, map.PathLoss({0, 0, 0}, {1000, 0, 0}));
+}
+
+/////////////////////////////////////////////////
+TEST_F(OcclusionMapTest, StaticCollisions)
+{
+  EntityComponentManager ecm;
+  CreateBoxModel(ecm, {5, 0, 0, 0, 0, 0}, {0.2, 10, 10}, true);
+  CreateBoxModel(ecm, {2, 0, 0, 0, 0, 0}, {0.2, 10, 10}, false);
+
+  comms::OcclusionMap map;
+  map.SetGrid(math::AxisAlignedBox({0, -1, 0}, {10, 1, 0}), 0.5);
+  EXPECT_EQ(1u, map.AddStaticCollisions(ecm));
+  EXPECT_EQ(1u, map.ObstacleCount());
+
+  // Update adds the static collisions and builds once
+  comms::OcclusionMap updated;
+  updated.SetGrid(math::AxisAlignedBox({0, -1, 0}, {10, 1, 0}), 0.5);
+  UpdateInfo info;
+  updated.Update(info, ecm);
+  updated.Update(info, ecm);
+  EXPECT_EQ(1u, updated.ObstacleCount());
+  EXPECT_TRUE(updated.Valid());
+  EXPECT_EQ(1u, updated.Obstacles({0, 0, 0}, {10, 0, 0}));
+  EXPECT_EQ(0u, updated.Obstacles({0, 0, 0}, {4, 0, 0}));
+}
+
+/////////////////////////////////////////////////
+TEST_F(OcclusionMapTest, Cache)
+{
+  const auto dir = common::joinPaths(PROJECT_BINARY_PATH,
+      "occlusion_map_test");
+  common::removeAll(dir);
+
+  EntityComponentManager ecm;
+  auto build = [&](double _wallX)
+  {
+    comms::OcclusionMap map;
+    map.SetCachePath(dir);
+    map.SetGrid(math::AxisAlignedBox({0, 0, 0}, {10, 0, 0}), 1.0);
+    map.AddBox({_wallX, 0, 0, 0, 0, 0}, {0.2, 1, 1});
+    EXPECT_TRUE(map.Build(ecm));
+    return map.Obstacles({0.5, 0, 0}, {3.5, 0, 0});
+  };
+
+  auto fileCount = [&dir]()
+  {
+    std::size_t count{0u};
+    for (common::DirIter file(dir); file != common::DirIter(); ++file)
+      ++count;
+    return count;
+  };
+
+  EXPECT_EQ(1u, build(3.0));
+  EXPECT_EQ(1u, fileCount());
+
+  // The same world loads the cached map
+  EXPECT_EQ(1u, build(3.0));
+  EXPECT_EQ(1u, fileCount());
+
+  // A different world gets its own map
+  EXPECT_EQ(0u, build(6.0));
+  EXPECT_EQ(2u, fileCount());
+
+  common::removeAll(dir);
+}
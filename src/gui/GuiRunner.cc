@@ -15,7 +15,12 @@
  *
 */
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -34,6 +39,7 @@
 #include "ignition/gazebo/EntityComponentManager.hh"
 #include <ignition/gazebo/gui/GuiEvents.hh>
 #include "ignition/gazebo/gui/GuiSystem.hh"
+#include "ignition/gazebo/QuantizedPose.hh"
 #include "ignition/gazebo/SystemLoader.hh"
 
 #include "GuiRunner.hh"
@@ -57,10 +63,14 @@ class ignition::gazebo::GuiRunner::Implementation
   /// \brief Topic to request state
   public: std::string stateTopic;
 
+  /// \brief Topic receiving the filtered state of this GUI, empty if it
+  /// receives the whole state.
+  public: std::string filteredStateTopic;
+
   /// \brief Latest update info
   public: UpdateInfo updateInfo;
 
-  /// \brief Flag used to end the updateThread.
+  /// \brief Flag used to end the updateThread and the stagingThread.
   public: bool running{false};
 
   /// \brief Mutex to protect the plugin update.
@@ -99,8 +109,80 @@ class ignition::gazebo::GuiRunner::Implementation
 
   /// \brief Manager of all events.
   public: EventManager eventMgr;
+
+  /// \brief Mutex to protect the pending and staged states, and running.
+  public: std::mutex pendingStateMutex;
+
+  /// \brief Notified when there's a pending state to stage, when the
+  /// staged state is taken, and when stopping.
+  public: std::condition_variable pendingStateCv;
+
+  /// \brief State received from the server which hasn't been staged yet.
+  /// States received before the staging thread gets to it are merged into
+  /// it, so there's never more than one state waiting.
+  public: msgs::SerializedStepMap pendingState;
+
+  /// \brief True if pendingState holds a state.
+  public: bool hasPendingState{false};
+
+  /// \brief State deserialized by the staging thread, waiting for the Qt
+  /// thread to apply it. The next state isn't staged until this one is
+  /// taken.
+  public: StagedState stagedState;
+
+  /// \brief Statistics of stagedState.
+  public: msgs::WorldStatistics stagedStats;
+
+  /// \brief True if stagedState holds a state, and applying it is queued
+  /// on the Qt thread.
+  public: bool hasStagedState{false};
+
+  /// \brief State already applied by the Qt thread, handed back so the
+  /// staging thread deserializes the next state into its components
+  /// instead of allocating new ones.
+  public: StagedState appliedState;
+
+  /// \brief Thread deserializing the states received from the server, so
+  /// the Qt thread only has to apply them.
+  public: std::thread stagingThread;
 };
 
+/////////////////////////////////////////////////
+/// \brief Merge a state into an older state which hasn't been applied yet,
+/// so applying the result is the same as applying both in order.
+/// Components in the newer state replace the older ones, entities removed
+/// by the newer state replace all their older changes, and the statistics
+/// are the newer ones. One time changes of either state are kept.
+/// \param[in, out] _older Older state, which receives the newer one.
+/// \param[in] _newer Newer state.
+static void mergeState(msgs::SerializedStepMap &_older,
+    const msgs::SerializedStepMap &_newer)
+{
+  IGN_PROFILE("GuiRunner::MergeState");
+
+  auto *olderState = _older.mutable_state();
+  auto &olderEntities = *olderState->mutable_entities();
+  for (const auto &[id, newerEntity] : _newer.state().entities())
+  {
+    auto olderIt = olderEntities.find(id);
+    if (olderIt == olderEntities.end() || newerEntity.remove() ||
+        olderIt->second.remove())
+    {
+      olderEntities[id] = newerEntity;
+      continue;
+    }
+
+    auto &olderComponents = *olderIt->second.mutable_components();
+    for (const auto &[type, newerComponent] : newerEntity.components())
+      olderComponents[type] = newerComponent;
+  }
+
+  olderState->set_has_one_time_component_changes(
+      olderState->has_one_time_component_changes() ||
+      _newer.state().has_one_time_component_changes());
+  _older.mutable_stats()->CopyFrom(_newer.stats());
+}
+
 /////////////////////////////////////////////////
 GuiRunner::GuiRunner(const std::string &_worldName)
   : dataPtr(utils::MakeUniqueImpl<Implementation>())
@@ -145,6 +227,9 @@ GuiRunner::GuiRunner(const std::string &_worldName)
   igndbg << "Requesting initial state from [" << this->dataPtr->stateTopic
          << "]..." << std::endl;
 
+  this->dataPtr->running = true;
+  this->dataPtr->stagingThread = std::thread(&GuiRunner::StageStates, this);
+
   this->RequestState();
 
   // Periodically update the plugins
@@ -159,7 +244,24 @@ GuiRunner::GuiRunner(const std::string &_worldName)
 }
 
 /////////////////////////////////////////////////
-GuiRunner::~GuiRunner() = default;
+GuiRunner::~GuiRunner()
+{
+  if (!this->dataPtr->filteredStateTopic.empty())
+  {
+    msgs::StringMsg req;
+    req.set_data(this->dataPtr->filteredStateTopic);
+    this->dataPtr->node.Request(this->dataPtr->stateTopic + "/unsubscribe",
+        req);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->pendingStateMutex);
+    this->dataPtr->running = false;
+  }
+  this->dataPtr->pendingStateCv.notify_all();
+  if (this->dataPtr->stagingThread.joinable())
+    this->dataPtr->stagingThread.join();
+}
 
 /////////////////////////////////////////////////
 bool GuiRunner::eventFilter(QObject *_obj, QEvent *_event)
@@ -259,13 +361,86 @@ void GuiRunner::RequestState()
   req.set_data(reqSrv);
 
   // Subscribe to periodic updates.
-  this->dataPtr->node.Subscribe(this->dataPtr->stateTopic,
-      &GuiRunner::OnState, this);
+  if (this->dataPtr->filteredStateTopic.empty())
+  {
+    this->dataPtr->node.Subscribe(this->dataPtr->stateTopic,
+        &GuiRunner::OnState, this);
+  }
 
   // send async state request
   this->dataPtr->node.Request(this->dataPtr->stateTopic + "_async", req);
 }
 
+/////////////////////////////////////////////////
+bool GuiRunner::SetStateInterest(
+    const std::unordered_set<ComponentTypeId> &_types,
+    const std::vector<Entity> &_entities,
+    const std::optional<math::AxisAlignedBox> &_region)
+{
+  std::string topic = this->dataPtr->filteredStateTopic;
+  if (topic.empty())
+  {
+    std::string id = std::to_string(ignition::gui::App()->applicationPid());
+    topic = transport::TopicUtils::AsValidTopic(
+        this->dataPtr->stateTopic + "/" + id);
+  }
+  if (topic.empty())
+  {
+    ignerr << "Failed to generate valid topic for filtered state"
+           << std::endl;
+    return false;
+  }
+
+  msgs::Param req;
+  auto setString = [&req](const std::string &_key,
+      const std::string &_value)
+  {
+    auto &any = (*req.mutable_params())[_key];
+    any.set_type(msgs::Any::STRING);
+    any.set_string_value(_value);
+  };
+  setString("topic", topic);
+
+  std::ostringstream types;
+  for (const auto &type : _types)
+    types << type << " ";
+  setString("component_types", types.str());
+
+  std::ostringstream entities;
+  for (const auto &entity : _entities)
+    entities << entity << " ";
+  setString("entities", entities.str());
+
+  if (_region)
+  {
+    auto &min = (*req.mutable_params())["region_min"];
+    min.set_type(msgs::Any::VECTOR3D);
+    msgs::Set(min.mutable_vector3d_value(), _region->Min());
+    auto &max = (*req.mutable_params())["region_max"];
+    max.set_type(msgs::Any::VECTOR3D);
+    msgs::Set(max.mutable_vector3d_value(), _region->Max());
+  }
+
+  msgs::Boolean rep;
+  bool result{false};
+  if (!this->dataPtr->node.Request(this->dataPtr->stateTopic + "/subscribe",
+      req, 5000, rep, result) || !result || !rep.data())
+  {
+    ignerr << "Failed to subscribe to filtered state on [" << topic << "]"
+           << std::endl;
+    return false;
+  }
+
+  // Switch from the whole state to the filtered one
+  if (this->dataPtr->filteredStateTopic.empty())
+  {
+    this->dataPtr->node.Unsubscribe(this->dataPtr->stateTopic);
+    this->dataPtr->node.Subscribe(topic, &GuiRunner::OnState, this);
+    this->dataPtr->filteredStateTopic = topic;
+  }
+  return true;
+}
+
 /////////////////////////////////////////////////
 void GuiRunner::OnPluginAdded(const QString &)
 {
@@ -302,12 +477,99 @@ void GuiRunner::OnState(const msgs::SerializedStepMap &_msg)
   if (!this->dataPtr->receivedInitialState)
     return;
 
-  // Since this function may be called from a transport thread, we push the
-  // OnStateQt function to the queue so that its called from the Qt thread. This
-  // ensures that only one thread has access to the ecm and updateInfo
-  // variables.
-  QMetaObject::invokeMethod(this, "OnStateQt", Qt::QueuedConnection,
-                            Q_ARG(msgs::SerializedStepMap, _msg));
+  // This function may be called from a transport thread, so the state is
+  // handed to the staging thread, which deserializes it and pushes the
+  // OnStagedStateQt function to the queue so that the state is applied
+  // from the Qt thread. This ensures that only one thread has access to
+  // the ecm and updateInfo variables.
+  // States which arrive while one is already pending are merged into it,
+  // so the GUI doesn't fall behind the server when it can't keep up.
+  std::lock_guard<std::mutex> lock(this->dataPtr->pendingStateMutex);
+  if (this->dataPtr->hasPendingState)
+  {
+    // Decode quantized poses here so the Qt thread doesn't have to
+    if (hasQuantizedPoses(_msg.state()))
+    {
+      msgs::SerializedStepMap msg(_msg);
+      dequantizePoses(*msg.mutable_state());
+      mergeState(this->dataPtr->pendingState, msg);
+    }
+    else
+    {
+      mergeState(this->dataPtr->pendingState, _msg);
+    }
+    return;
+  }
+
+  this->dataPtr->pendingState.CopyFrom(_msg);
+  if (hasQuantizedPoses(_msg.state()))
+    dequantizePoses(*this->dataPtr->pendingState.mutable_state());
+  this->dataPtr->hasPendingState = true;
+  this->dataPtr->pendingStateCv.notify_all();
+}
+
+/////////////////////////////////////////////////
+void GuiRunner::StageStates()
+{
+  IGN_PROFILE_THREAD_NAME("GuiRunner::StageStates");
+
+  msgs::SerializedStepMap msg;
+  std::unique_lock<std::mutex> lock(this->dataPtr->pendingStateMutex);
+  while (true)
+  {
+    // Wait for the Qt thread to take the previous state, so states are
+    // merged while it's busy instead of being staged one after another
+    this->dataPtr->pendingStateCv.wait(lock, [this]
+    {
+      return !this->dataPtr->running || (this->dataPtr->hasPendingState &&
+          !this->dataPtr->hasStagedState);
+    });
+    if (!this->dataPtr->running)
+      return;
+
+    msg.Swap(&this->dataPtr->pendingState);
+    this->dataPtr->pendingState.Clear();
+    this->dataPtr->hasPendingState = false;
+    auto staged = std::move(this->dataPtr->appliedState);
+    lock.unlock();
+
+    EntityComponentManager::StageState(msg.state(), staged);
+
+    lock.lock();
+    this->dataPtr->stagedState = std::move(staged);
+    this->dataPtr->stagedStats.Swap(msg.mutable_stats());
+    this->dataPtr->hasStagedState = true;
+    QMetaObject::invokeMethod(this, "OnStagedStateQt", Qt::QueuedConnection);
+  }
+}
+
+/////////////////////////////////////////////////
+void GuiRunner::OnStagedStateQt()
+{
+  IGN_PROFILE_THREAD_NAME("Qt thread");
+  IGN_PROFILE("GuiRunner::Update");
+
+  StagedState staged;
+  msgs::WorldStatistics stats;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->pendingStateMutex);
+    if (!this->dataPtr->hasStagedState)
+      return;
+    staged = std::move(this->dataPtr->stagedState);
+    stats.Swap(&this->dataPtr->stagedStats);
+    this->dataPtr->hasStagedState = false;
+  }
+  this->dataPtr->pendingStateCv.notify_all();
+
+  this->dataPtr->ecm.SetState(staged);
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->pendingStateMutex);
+    this->dataPtr->appliedState = std::move(staged);
+  }
+
+  // Update all plugins
+  this->dataPtr->updateInfo = convert<UpdateInfo>(stats);
+  this->UpdatePlugins();
 }
 
 /////////////////////////////////////////////////
@@ -325,6 +587,9 @@ void GuiRunner::OnStateQt(const msgs::SerializedStepMap &_msg)
 /////////////////////////////////////////////////
 void GuiRunner::UpdatePlugins()
 {
+  // Changes from the latest state, for component observers
+  this->dataPtr->ecm.NotifyComponentObservers();
+
   // gui plugins
   auto plugins = ignition::gui::App()->findChildren<GuiSystem *>();
   for (auto plugin : plugins)
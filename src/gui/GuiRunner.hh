@@ -20,11 +20,17 @@
 #include <ignition/msgs/serialized_map.pb.h>
 
 #include <QtCore>
+#include <optional>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
+#include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/utils/ImplPtr.hh>
 
 #include "ignition/gazebo/config.hh"
+#include "ignition/gazebo/Entity.hh"
+#include "ignition/gazebo/Types.hh"
 #include "ignition/gazebo/EventManager.hh"
 #include "ignition/gazebo/gui/Export.hh"
 
@@ -50,6 +56,22 @@ class IGNITION_GAZEBO_GUI_VISIBLE GuiRunner : public QObject
   /// \brief Get the event manager for the gui
   public: EventManager &GuiEventManager() const;
 
+  /// \brief Only receive part of the state from the server, which saves
+  /// bandwidth when the GUI doesn't show the whole world. The server
+  /// publishes the filtered state on a topic for this GUI, see
+  /// systems::SceneBroadcaster.
+  /// \param[in] _types Component types to receive, empty for all. New
+  /// entities are always received with all their components.
+  /// \param[in] _entities Entities whose subtrees are received, empty for
+  /// the whole world.
+  /// \param[in] _region Region of the world entities must be in to be
+  /// received, if any.
+  /// \return True if the server accepted the request.
+  public: bool SetStateInterest(
+      const std::unordered_set<ComponentTypeId> &_types,
+      const std::vector<Entity> &_entities = {},
+      const std::optional<math::AxisAlignedBox> &_region = std::nullopt);
+
   // Documentation inherited
   protected: bool eventFilter(QObject *_obj, QEvent *_event) override;
 
@@ -74,6 +96,15 @@ class IGNITION_GAZEBO_GUI_VISIBLE GuiRunner : public QObject
   /// \param[in] _msg New state message.
   private: Q_INVOKABLE void OnStateQt(const msgs::SerializedStepMap &_msg);
 
+  /// \brief Called by the Qt thread to update the ECM with the state
+  /// staged by StageStates, which merges the states received by OnState
+  /// since the last call.
+  private: Q_INVOKABLE void OnStagedStateQt();
+
+  /// \brief Run by the staging thread. Deserializes states received by
+  /// OnState, so the Qt thread only has to apply them.
+  private: void StageStates();
+
   /// \brief Update the plugins.
   /// \todo(anyone) Move to GuiRunner::Implementation when porting to v5
   private: Q_INVOKABLE void UpdatePlugins();
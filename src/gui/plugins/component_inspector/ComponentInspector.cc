@@ -15,10 +15,13 @@
  *
 */
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <list>
 #include <regex>
 #include <unordered_map>
+#include <vector>
 #include <ignition/common/Console.hh>
 #include <ignition/common/Profiler.hh>
 #include <ignition/gui/Application.hh>
@@ -126,6 +129,25 @@ namespace ignition::gazebo
 
     /// \brief Maps plugin display names to their filenames.
     public: std::unordered_map<std::string, std::string> systemMap;
+
+    /// \brief Minimum time between refreshes, zero to refresh on every
+    /// update.
+    public: std::chrono::steady_clock::duration updatePeriod{
+        std::chrono::milliseconds(100)};
+
+    /// \brief Wall time of the last refresh.
+    public: std::chrono::steady_clock::time_point lastUpdateTime;
+
+    /// \brief Entity whose components are currently displayed.
+    public: Entity shownEntity{kNullEntity};
+
+    /// \brief Version of each displayed component when it was last
+    /// refreshed, used to skip components which didn't change since.
+    public: std::unordered_map<ComponentTypeId, uint64_t> shownVersions;
+
+    /// \brief Component types of the inspected entity, kept across updates
+    /// so that listing them doesn't allocate.
+    public: std::vector<ComponentTypeId> componentTypes;
   };
 }
 
@@ -493,11 +515,26 @@ ComponentInspector::ComponentInspector()
 ComponentInspector::~ComponentInspector() = default;
 
 /////////////////////////////////////////////////
-void ComponentInspector::LoadConfig(const tinyxml2::XMLElement *)
+void ComponentInspector::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
 {
   if (this->title.empty())
     this->title = "Component inspector";
 
+  // Parameters from SDF
+  if (_pluginElem)
+  {
+    auto rateElem = _pluginElem->FirstChildElement("update_rate");
+    if (nullptr != rateElem && nullptr != rateElem->GetText())
+    {
+      double rate{0.0};
+      rateElem->QueryDoubleText(&rate);
+      this->dataPtr->updatePeriod = rate > 0.0 ?
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(1.0 / rate)) :
+          std::chrono::steady_clock::duration::zero();
+    }
+  }
+
   ignition::gui::App()->findChild<
       ignition::gui::MainWindow *>()->installEventFilter(this);
 
@@ -520,7 +557,33 @@ void ComponentInspector::Update(const UpdateInfo &,
   if (this->dataPtr->paused)
     return;
 
-  auto componentTypes = _ecm.ComponentTypes(this->dataPtr->entity);
+  // Nothing to refresh while hidden. Components which change in the
+  // meantime are refreshed once the inspector is shown again.
+  if (nullptr == this->PluginItem() || !this->PluginItem()->isVisible())
+    return;
+
+  // Throttle refreshes, unless a new entity was selected
+  auto now = std::chrono::steady_clock::now();
+  if (this->dataPtr->entity == this->dataPtr->shownEntity &&
+      now - this->dataPtr->lastUpdateTime < this->dataPtr->updatePeriod)
+  {
+    return;
+  }
+  this->dataPtr->lastUpdateTime = now;
+
+  if (this->dataPtr->entity != this->dataPtr->shownEntity)
+  {
+    this->dataPtr->shownEntity = this->dataPtr->entity;
+    this->dataPtr->shownVersions.clear();
+  }
+
+  auto &componentTypes = this->dataPtr->componentTypes;
+  componentTypes.clear();
+  _ecm.EachComponentType(this->dataPtr->entity, [&](ComponentTypeId _typeId)
+  {
+    componentTypes.push_back(_typeId);
+    return true;
+  });
 
   // List all components
   for (const auto &typeId : componentTypes)
@@ -601,8 +664,16 @@ void ComponentInspector::Update(const UpdateInfo &,
     // Get component item
     QStandardItem *item;
     auto itemIt = this->dataPtr->componentsModel.items.find(typeId);
+    auto version = _ecm.ComponentVersion(this->dataPtr->entity, typeId);
     if (itemIt != this->dataPtr->componentsModel.items.end())
     {
+      // Skip components which didn't change since they were displayed
+      auto shownIt = this->dataPtr->shownVersions.find(typeId);
+      if (shownIt != this->dataPtr->shownVersions.end() &&
+          shownIt->second == version)
+      {
+        continue;
+      }
       item = itemIt->second;
     }
     // Add component to list
@@ -611,9 +682,6 @@ void ComponentInspector::Update(const UpdateInfo &,
       item = this->dataPtr->componentsModel.AddComponentType(typeId);
     }
 
-    item->setData(QString::number(this->dataPtr->entity),
-                  ComponentsModel::RoleNames().key("entity"));
-
     if (nullptr == item)
     {
       ignerr << "Failed to get item for component type [" << typeId << "]"
@@ -621,6 +689,10 @@ void ComponentInspector::Update(const UpdateInfo &,
       continue;
     }
 
+    item->setData(QString::number(this->dataPtr->entity),
+                  ComponentsModel::RoleNames().key("entity"));
+    this->dataPtr->shownVersions[typeId] = version;
+
     // Populate component-specific data
     if (typeId == components::AngularAcceleration::typeId)
     {
@@ -933,9 +1005,11 @@ void ComponentInspector::Update(const UpdateInfo &,
   for (auto itemIt : this->dataPtr->componentsModel.items)
   {
     auto typeId = itemIt.first;
-    if (componentTypes.find(typeId) == componentTypes.end())
+    if (std::find(componentTypes.begin(), componentTypes.end(), typeId) ==
+        componentTypes.end())
     {
       itemsToRemove.push_back(typeId);
+      this->dataPtr->shownVersions.erase(typeId);
     }
   }
 
@@ -167,8 +167,14 @@ namespace gazebo
 
   /// \brief Displays a tree view with all the entities in the world.
   ///
+  /// Only components which changed since they were last displayed are
+  /// refreshed, and nothing is done while the inspector is hidden.
+  ///
   /// ## Configuration
-  /// None
+  ///
+  /// * `<update_rate>` (optional): Maximum rate in Hz at which components
+  /// are refreshed. Changes in between are displayed on the next refresh.
+  /// Zero or negative refreshes on every GUI update. Defaults to 10.
   class ComponentInspector : public gazebo::GuiSystem
   {
     Q_OBJECT
@@ -15,6 +15,7 @@
  *
 */
 
+#include <algorithm>
 #include <iostream>
 #include <list>
 #include <map>
@@ -99,6 +100,10 @@ namespace ignition::gazebo
     /// \brief Entity being inspected. Default to world.
     public: Entity entity{1};
 
+    /// \brief Component types of the inspected entity, kept across updates
+    /// so that listing them doesn't allocate.
+    public: std::vector<ComponentTypeId> componentTypes;
+
     /// \brief World entity
     public: Entity worldEntity{kNullEntity};
 
@@ -518,7 +523,13 @@ void ComponentInspectorEditor::Update(const UpdateInfo &_info,
 
   this->SetSimPaused(_info.paused);
 
-  auto componentTypes = _ecm.ComponentTypes(this->dataPtr->entity);
+  auto &componentTypes = this->dataPtr->componentTypes;
+  componentTypes.clear();
+  _ecm.EachComponentType(this->dataPtr->entity, [&](ComponentTypeId _typeId)
+  {
+    componentTypes.push_back(_typeId);
+    return true;
+  });
 
   // List all components
   for (const auto &typeId : componentTypes)
@@ -957,7 +968,8 @@ void ComponentInspectorEditor::Update(const UpdateInfo &_info,
   for (auto itemIt : this->dataPtr->componentsModel.items)
   {
     auto typeId = itemIt.first;
-    if (componentTypes.find(typeId) == componentTypes.end())
+    if (std::find(componentTypes.begin(), componentTypes.end(), typeId) ==
+        componentTypes.end())
     {
       itemsToRemove.push_back(typeId);
     }
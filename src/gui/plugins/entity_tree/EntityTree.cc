@@ -18,10 +18,14 @@
 #include "EntityTree.hh"
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <ignition/common/Console.hh>
@@ -119,67 +123,142 @@ QString entityType(Entity _entity,
 TreeModel::TreeModel() : QStandardItemModel()
 {
   qRegisterMetaType<Entity>("Entity");
+  qRegisterMetaType<TreeEntityInfos>("TreeEntityInfos");
+  qRegisterMetaType<TreeEntities>("TreeEntities");
 }
 
 /////////////////////////////////////////////////
 void TreeModel::AddEntity(Entity _entity, const QString &_entityName,
     Entity _parentEntity, const QString &_type)
+{
+  this->AddEntities({{_entity, _entityName, _parentEntity, _type}});
+}
+
+/////////////////////////////////////////////////
+QStandardItem *TreeModel::CreateItem(const TreeEntityInfo &_info)
+{
+  auto entityItem = new QStandardItem(_info.name);
+  entityItem->setData(_info.name, this->roleNames().key("entityName"));
+  entityItem->setData(QString::number(_info.entity),
+      this->roleNames().key("entity"));
+  entityItem->setData(_info.type, this->roleNames().key("type"));
+  this->entityItems[_info.entity] = entityItem;
+  return entityItem;
+}
+
+/////////////////////////////////////////////////
+void TreeModel::AddEntities(const TreeEntityInfos &_entities)
 {
   IGN_PROFILE_THREAD_NAME("Qt thread");
-  IGN_PROFILE("TreeModel::AddEntity");
-  QStandardItem *parentItem{nullptr};
+  IGN_PROFILE("TreeModel::AddEntities");
 
-  // check if entity has already been added or not.
+  // check if entities have already been added or not.
   // This could happen because we get new and removed entity updates from both
   // the ECM and GUI events.
-  if (this->entityItems.find(_entity) != this->entityItems.end())
-    return;
-
-  // Root
-  if (_parentEntity == kNullEntity)
+  std::vector<TreeEntityInfo> waiting;
+  waiting.swap(this->pendingEntities);
+  for (const auto &info : _entities)
   {
-    parentItem = this->invisibleRootItem();
+    if (this->entityInfos.find(info.entity) == this->entityInfos.end())
+      waiting.push_back(info);
   }
 
-  // Nested
-  // TODO(louise) There should be a way to easily access these from
-  // QStandardItemModel instead of keeping our own map
-  auto item = this->entityItems.find(_parentEntity);
-  if (item != this->entityItems.end())
+  // Entities can be added once their parent is known. Parents are
+  // usually added before their children, so this takes few passes.
+  std::vector<TreeEntityInfo> ready;
+  bool progress{true};
+  while (progress && !waiting.empty())
   {
-    parentItem = item->second;
+    progress = false;
+    std::vector<TreeEntityInfo> stillWaiting;
+    for (auto &info : waiting)
+    {
+      if (info.parentEntity == kNullEntity ||
+          this->entityInfos.find(info.parentEntity) != this->entityInfos.end())
+      {
+        this->entityInfos[info.entity] = info;
+        ready.push_back(std::move(info));
+        progress = true;
+      }
+      else
+      {
+        stillWaiting.push_back(std::move(info));
+      }
+    }
+    waiting.swap(stillWaiting);
   }
-
-  if (nullptr == parentItem)
+  this->pendingEntities.swap(waiting);
+
+  // Items are created for top level entities and children of fetched
+  // entities, and inserted with one notification per parent
+  std::vector<std::pair<QStandardItem *, QList<QStandardItem *>>> newRows;
+  std::unordered_map<QStandardItem *, std::size_t> newRowsIndex;
+  std::unordered_set<QStandardItem *> newlyExpandable;
+  for (const auto &info : ready)
   {
-    this->pendingEntities.push_back(
-      {_entity, _entityName, _parentEntity, _type});
-    return;
-  }
-
-  // New entity item
-  auto entityItem = new QStandardItem(_entityName);
-  entityItem->setData(_entityName, this->roleNames().key("entityName"));
-  entityItem->setData(QString::number(_entity),
-      this->roleNames().key("entity"));
-  entityItem->setData(_type, this->roleNames().key("type"));
+    QStandardItem *parentItem{nullptr};
+    if (info.parentEntity == kNullEntity)
+    {
+      parentItem = this->invisibleRootItem();
+    }
+    else if (this->fetchedEntities.find(info.parentEntity) !=
+        this->fetchedEntities.end())
+    {
+      parentItem = this->entityItems[info.parentEntity];
+    }
 
-  parentItem->appendRow(entityItem);
+    if (nullptr == parentItem)
+    {
+      auto &children = this->unfetchedChildren[info.parentEntity];
+      auto itemIt = this->entityItems.find(info.parentEntity);
+      if (children.empty() && itemIt != this->entityItems.end())
+        newlyExpandable.insert(itemIt->second);
+      children.push_back(info.entity);
+      continue;
+    }
 
-  this->entityItems[_entity] = entityItem;
+    auto indexIt = newRowsIndex.find(parentItem);
+    if (indexIt == newRowsIndex.end())
+    {
+      indexIt = newRowsIndex.emplace(parentItem, newRows.size()).first;
+      newRows.push_back({parentItem, {}});
+    }
+    newRows[indexIt->second].second.append(this->CreateItem(info));
+  }
 
-  // Check if there are pending children
-  auto sep = std::partition(this->pendingEntities.begin(),
-      this->pendingEntities.end(), [&_entity](const EntityInfo &_entityInfo)
-      {
-        return _entityInfo.parentEntity != _entity;
-      });
+  for (auto &[parentItem, items] : newRows)
+    parentItem->appendRows(items);
 
-  for (auto it = sep; it != this->pendingEntities.end(); ++it)
+  // Let the view know it can expand items which just got their first child
+  for (auto item : newlyExpandable)
   {
-    this->AddEntity(it->entity, it->name, it->parentEntity, it->type);
+    auto index = this->indexFromItem(item);
+    emit this->dataChanged(index, index);
   }
-  this->pendingEntities.erase(sep, this->pendingEntities.end());
+}
+
+/////////////////////////////////////////////////
+void TreeModel::RemoveEntities(const TreeEntities &_entities)
+{
+  IGN_PROFILE("TreeModel::RemoveEntities");
+  for (const auto &entity : _entities)
+    this->RemoveEntity(entity);
+}
+
+/////////////////////////////////////////////////
+void TreeModel::ForgetEntity(Entity _entity)
+{
+  this->entityInfos.erase(_entity);
+  this->fetchedEntities.erase(_entity);
+
+  auto childrenIt = this->unfetchedChildren.find(_entity);
+  if (childrenIt == this->unfetchedChildren.end())
+    return;
+
+  auto children = std::move(childrenIt->second);
+  this->unfetchedChildren.erase(childrenIt);
+  for (const auto &child : children)
+    this->ForgetEntity(child);
 }
 
 /////////////////////////////////////////////////
@@ -195,11 +274,24 @@ void TreeModel::RemoveEntity(Entity _entity)
 
   if (nullptr == item)
   {
+    // See if it's waiting to be fetched
+    auto infoIt = this->entityInfos.find(_entity);
+    if (infoIt != this->entityInfos.end())
+    {
+      auto &siblings = this->unfetchedChildren[infoIt->second.parentEntity];
+      siblings.erase(std::remove(siblings.begin(), siblings.end(), _entity),
+          siblings.end());
+      if (siblings.empty())
+        this->unfetchedChildren.erase(infoIt->second.parentEntity);
+      this->ForgetEntity(_entity);
+      return;
+    }
+
     // See if it's pending
     auto toRemove = std::remove_if(this->pendingEntities.begin(),
-        this->pendingEntities.end(), [&_entity](const EntityInfo &_entityInfo)
+        this->pendingEntities.end(), [&_entity](const TreeEntityInfo &_info)
         {
-          return _entityInfo.entity == _entity;
+          return _info.entity == _entity;
         });
     this->pendingEntities.erase(toRemove, this->pendingEntities.end());
 
@@ -214,11 +306,14 @@ void TreeModel::RemoveEntity(Entity _entity)
     {
       auto childItem = _item->child(i);
       removeChildren(childItem);
-      this->entityItems.erase(childItem->data(
-          this->roleNames().key("entity")).toUInt());
+      Entity child = childItem->data(
+          this->roleNames().key("entity")).toUInt();
+      this->entityItems.erase(child);
+      this->ForgetEntity(child);
     }
   };
   this->entityItems.erase(_entity);
+  this->ForgetEntity(_entity);
   removeChildren(item);
 
   // Remove from the view
@@ -228,6 +323,76 @@ void TreeModel::RemoveEntity(Entity _entity)
     item->parent()->removeRow(item->row());
 }
 
+/////////////////////////////////////////////////
+bool TreeModel::hasChildren(const QModelIndex &_parent) const
+{
+  return QStandardItemModel::hasChildren(_parent) ||
+      this->canFetchMore(_parent);
+}
+
+/////////////////////////////////////////////////
+bool TreeModel::canFetchMore(const QModelIndex &_parent) const
+{
+  if (!_parent.isValid())
+    return false;
+
+  auto childrenIt = this->unfetchedChildren.find(this->EntityId(_parent));
+  return childrenIt != this->unfetchedChildren.end() &&
+      !childrenIt->second.empty();
+}
+
+/////////////////////////////////////////////////
+void TreeModel::fetchMore(const QModelIndex &_parent)
+{
+  IGN_PROFILE("TreeModel::fetchMore");
+  QStandardItem *parentItem = this->itemFromIndex(_parent);
+  if (nullptr == parentItem)
+    return;
+
+  Entity entity = this->EntityId(_parent);
+  this->fetchedEntities.insert(entity);
+
+  auto childrenIt = this->unfetchedChildren.find(entity);
+  if (childrenIt == this->unfetchedChildren.end())
+    return;
+
+  QList<QStandardItem *> items;
+  for (const auto &child : childrenIt->second)
+  {
+    auto infoIt = this->entityInfos.find(child);
+    if (infoIt != this->entityInfos.end())
+      items.append(this->CreateItem(infoIt->second));
+  }
+  this->unfetchedChildren.erase(childrenIt);
+  parentItem->appendRows(items);
+}
+
+/////////////////////////////////////////////////
+void TreeModel::FetchEntity(Entity _entity)
+{
+  // Entities without items, from the entity up to the first ancestor with
+  // an item
+  std::vector<Entity> chain;
+  Entity entity = _entity;
+  while (this->entityItems.find(entity) == this->entityItems.end())
+  {
+    auto infoIt = this->entityInfos.find(entity);
+    if (infoIt == this->entityInfos.end())
+      return;
+    chain.push_back(entity);
+    entity = infoIt->second.parentEntity;
+  }
+
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+  {
+    Entity parent = this->entityInfos[*it].parentEntity;
+    auto parentIt = this->entityItems.find(parent);
+    if (parentIt == this->entityItems.end())
+      return;
+    this->fetchMore(this->indexFromItem(parentIt->second));
+  }
+}
+
 /////////////////////////////////////////////////
 QString TreeModel::EntityType(const QModelIndex &_index) const
 {
@@ -313,6 +478,11 @@ void EntityTree::LoadConfig(const tinyxml2::XMLElement *)
 void EntityTree::Update(const UpdateInfo &, EntityComponentManager &_ecm)
 {
   IGN_PROFILE("EntityTree::Update");
+
+  // Changes are sent to the model in batches
+  TreeEntityInfos newEntities;
+  TreeEntities removedEntities;
+
   // Treat all pre-existent entities as new at startup
   if (!this->dataPtr->initialized)
   {
@@ -345,12 +515,9 @@ void EntityTree::Update(const UpdateInfo &, EntityComponentManager &_ecm)
         parentEntity = kNullEntity;
       }
 
-      QMetaObject::invokeMethod(&this->dataPtr->treeModel, "AddEntity",
-          Qt::QueuedConnection,
-          Q_ARG(Entity, _entity),
-          Q_ARG(QString, QString::fromStdString(_name->Data())),
-          Q_ARG(Entity, parentEntity),
-          Q_ARG(QString, entityType(_entity, _ecm)));
+      newEntities.push_back({_entity,
+          QString::fromStdString(_name->Data()), parentEntity,
+          entityType(_entity, _ecm)});
       return true;
     });
 
@@ -375,12 +542,9 @@ void EntityTree::Update(const UpdateInfo &, EntityComponentManager &_ecm)
         parentEntity = kNullEntity;
       }
 
-      QMetaObject::invokeMethod(&this->dataPtr->treeModel, "AddEntity",
-          Qt::QueuedConnection,
-          Q_ARG(Entity, _entity),
-          Q_ARG(QString, QString::fromStdString(_name->Data())),
-          Q_ARG(Entity, parentEntity),
-          Q_ARG(QString, entityType(_entity, _ecm)));
+      newEntities.push_back({_entity,
+          QString::fromStdString(_name->Data()), parentEntity,
+          entityType(_entity, _ecm)});
       return true;
     });
   }
@@ -389,9 +553,7 @@ void EntityTree::Update(const UpdateInfo &, EntityComponentManager &_ecm)
     [&](const Entity &_entity,
         const components::Name *)->bool
   {
-    QMetaObject::invokeMethod(&this->dataPtr->treeModel, "RemoveEntity",
-        Qt::QueuedConnection,
-        Q_ARG(Entity, _entity));
+    removedEntities.push_back(_entity);
     return true;
   });
 
@@ -425,24 +587,32 @@ void EntityTree::Update(const UpdateInfo &, EntityComponentManager &_ecm)
         parentEntity = kNullEntity;
       }
 
-      QMetaObject::invokeMethod(&this->dataPtr->treeModel, "AddEntity",
-          Qt::QueuedConnection,
-          Q_ARG(Entity, entity),
-          Q_ARG(QString, QString::fromStdString(nameComp->Data())),
-          Q_ARG(Entity, parentEntity),
-          Q_ARG(QString, entityType(entity, _ecm)));
+      newEntities.push_back({entity,
+          QString::fromStdString(nameComp->Data()), parentEntity,
+          entityType(entity, _ecm)});
     }
 
-    for (auto entity : this->dataPtr->removedEntities)
-    {
-      QMetaObject::invokeMethod(&this->dataPtr->treeModel, "RemoveEntity",
-          Qt::QueuedConnection,
-          Q_ARG(Entity, entity));
-    }
+    removedEntities.insert(removedEntities.end(),
+        this->dataPtr->removedEntities.begin(),
+        this->dataPtr->removedEntities.end());
 
     this->dataPtr->newEntities.clear();
     this->dataPtr->removedEntities.clear();
   }
+
+  if (!newEntities.empty())
+  {
+    QMetaObject::invokeMethod(&this->dataPtr->treeModel, "AddEntities",
+        Qt::QueuedConnection,
+        Q_ARG(TreeEntityInfos, newEntities));
+  }
+
+  if (!removedEntities.empty())
+  {
+    QMetaObject::invokeMethod(&this->dataPtr->treeModel, "RemoveEntities",
+        Qt::QueuedConnection,
+        Q_ARG(TreeEntities, removedEntities));
+  }
 }
 
 /////////////////////////////////////////////////
@@ -537,6 +707,9 @@ bool EntityTree::eventFilter(QObject *_obj, QEvent *_event)
         if (entity == kNullEntity)
           continue;
 
+        // Create the items the view needs to find the entity
+        this->dataPtr->treeModel.FetchEntity(entity);
+
         QMetaObject::invokeMethod(this->PluginItem(), "onEntitySelectedFromCpp",
             Qt::QueuedConnection, Q_ARG(QVariant,
             QVariant(static_cast<qulonglong>(entity))));
@@ -20,6 +20,8 @@
 
 #include <map>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <ignition/gazebo/Entity.hh>
@@ -31,7 +33,36 @@ namespace gazebo
 {
   class EntityTreePrivate;
 
-  /// \brief TODO
+  /// \brief Entity information used to add entities to the tree
+  struct TreeEntityInfo
+  {
+    /// \brief Entity ID
+    // cppcheck-suppress unmatchedSuppression
+    // cppcheck-suppress unusedStructMember
+    Entity entity;
+
+    /// \brief Entity name
+    QString name;
+
+    /// \brief Parent ID
+    // cppcheck-suppress unmatchedSuppression
+    // cppcheck-suppress unusedStructMember
+    Entity parentEntity;
+
+    /// \brief Entity type
+    QString type;
+  };
+
+  /// \brief Batch of entities added to the tree at once
+  using TreeEntityInfos = std::vector<TreeEntityInfo>;
+
+  /// \brief Batch of entities removed from the tree at once
+  using TreeEntities = std::vector<Entity>;
+
+  /// \brief Model of the entity tree. Items are only created for top level
+  /// entities and for the children of items which were expanded, so large
+  /// worlds don't create items that are never seen. The children of other
+  /// entities are kept as plain data until the view fetches them.
   class TreeModel : public QStandardItemModel
   {
     Q_OBJECT
@@ -60,6 +91,30 @@ namespace gazebo
     /// \param[in] _entity Entity to be removed
     public slots: void RemoveEntity(Entity _entity);
 
+    /// \brief Add entities to the tree. Entities with the same parent are
+    /// inserted with a single notification to the view.
+    /// \param[in] _entities Entities to be added, in any order.
+    public slots: void AddEntities(const TreeEntityInfos &_entities);
+
+    /// \brief Remove entities from the tree.
+    /// \param[in] _entities Entities to be removed
+    public slots: void RemoveEntities(const TreeEntities &_entities);
+
+    /// \brief Create the items of an entity and its ancestors, so the
+    /// entity can be found in the view, i.e. to select it.
+    /// \param[in] _entity Entity
+    public: void FetchEntity(Entity _entity);
+
+    // Documentation inherited
+    public: bool hasChildren(const QModelIndex &_parent = QModelIndex())
+        const override;
+
+    // Documentation inherited
+    public: bool canFetchMore(const QModelIndex &_parent) const override;
+
+    // Documentation inherited
+    public: void fetchMore(const QModelIndex &_parent) override;
+
     /// \brief Get the entity type of a tree item at specified index
     /// \param[in] _index Model index
     /// \return Type of entity
@@ -75,32 +130,33 @@ namespace gazebo
     /// \return Entity ID
     public: Q_INVOKABLE Entity EntityId(const QModelIndex &_index) const;
 
+    /// \brief Create the item of an entity.
+    /// \param[in] _info Entity information
+    /// \return New item, owned by the caller until it's added to a parent.
+    private: QStandardItem *CreateItem(const TreeEntityInfo &_info);
+
+    /// \brief Forget an entity and all its descendants which don't have
+    /// items.
+    /// \param[in] _entity Entity
+    private: void ForgetEntity(Entity _entity);
+
     /// \brief Keep track of which item corresponds to which entity.
     private: std::map<Entity, QStandardItem *> entityItems;
 
-    /// \brief Entity information used to queue the pending entities
-    struct EntityInfo
-    {
-      /// \brief Entity ID
-      // cppcheck-suppress unmatchedSuppression
-      // cppcheck-suppress unusedStructMember
-      Entity entity;
+    /// \brief All entities in the tree, with or without items.
+    private: std::unordered_map<Entity, TreeEntityInfo> entityInfos;
 
-      /// \brief Entity name
-      QString name;
+    /// \brief Children without items, by parent. Their items are created
+    /// when the view fetches the parent's children.
+    private: std::unordered_map<Entity, std::vector<Entity>> unfetchedChildren;
 
-      /// \brief Parent ID
-      // cppcheck-suppress unmatchedSuppression
-      // cppcheck-suppress unusedStructMember
-      Entity parentEntity;
-
-      /// \brief Entity type
-      QString type;
-    };
+    /// \brief Entities whose children were fetched. Items of their new
+    /// children are created right away.
+    private: std::unordered_set<Entity> fetchedEntities;
 
     /// \brief If an entity is added before its parent, we queue it in this
     /// vector until their parent shows up or they are deleted.
-    private: std::vector<EntityInfo> pendingEntities;
+    private: std::vector<TreeEntityInfo> pendingEntities;
   };
 
   /// \brief Displays a tree view with all the entities in the world.
@@ -150,4 +206,7 @@ namespace gazebo
 }
 }
 
+Q_DECLARE_METATYPE(ignition::gazebo::TreeEntityInfos)
+Q_DECLARE_METATYPE(ignition::gazebo::TreeEntities)
+
 #endif
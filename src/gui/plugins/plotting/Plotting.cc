@@ -17,7 +17,23 @@
 
 #include "Plotting.hh"
 
+#include <ignition/msgs/boolean.pb.h>
+#include <ignition/msgs/param.pb.h>
+#include <ignition/msgs/serialized.pb.h>
+
+#include <cmath>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <ignition/common/Profiler.hh>
 #include <ignition/plugin/Register.hh>
+#include <ignition/transport/Node.hh>
+#include <ignition/transport/TopicUtils.hh>
 
 #include "ignition/gazebo/components/AngularAcceleration.hh"
 #include "ignition/gazebo/components/AngularVelocity.hh"
@@ -29,6 +45,7 @@
 #include "ignition/gazebo/components/LinearVelocity.hh"
 #include "ignition/gazebo/components/LinearVelocitySeed.hh"
 #include "ignition/gazebo/components/MagneticField.hh"
+#include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/Physics.hh"
 #include "ignition/gazebo/components/Pose.hh"
@@ -41,8 +58,67 @@
 
 namespace ignition::gazebo
 {
+  /// \brief Samples of an attribute which fall in the same time bucket,
+  /// which are plotted as their minimum and maximum.
+  struct PlotBucket
+  {
+    /// \brief Index of the bucket, which is its start time divided by the
+    /// decimation period.
+    int64_t index{0};
+
+    /// \brief Number of samples in the bucket.
+    int count{0};
+
+    /// \brief Time and value of the smallest sample.
+    std::pair<double, double> min;
+
+    /// \brief Time and value of the largest sample.
+    std::pair<double, double> max;
+  };
+
+  /// \brief A component sampled by the server.
+  struct PlotSample
+  {
+    /// \brief Simulation time of the sample in seconds.
+    double time;
+
+    /// \brief Component holding the sampled value.
+    std::unique_ptr<components::BaseComponent> comp;
+  };
+
   class PlottingPrivate
   {
+    /// \brief Subscribe to samples of a component taken by the server.
+    /// \param[in] _id Key of the component in the components map.
+    /// \param[in] _component The component.
+    public: void Subscribe(const std::string &_id,
+        PlotComponent &_component);
+
+    /// \brief Stop receiving samples of a component.
+    /// \param[in] _id Key of the component in the components map.
+    public: void Unsubscribe(const std::string &_id);
+
+    /// \brief Callback on the transport thread with a batch of samples.
+    /// \param[in] _id Key of the sampled component in the components map.
+    /// \param[in] _msg Samples.
+    public: void OnSamples(const std::string &_id,
+        const msgs::SerializedState &_msg);
+
+    /// \brief Plot the current values of a component's attributes,
+    /// decimating them.
+    /// \param[in] _id Key of the component in the components map.
+    /// \param[in] _component The component.
+    /// \param[in] _time Simulation time of the values in seconds.
+    public: void Plot(const std::string &_id,
+        const PlotComponent &_component, double _time);
+
+    /// \brief Plot the minimum and maximum of a bucket.
+    /// \param[in] _attributeName Name of the attribute on the charts.
+    /// \param[in] _data Data of the attribute.
+    /// \param[in] _bucket Bucket to plot.
+    public: void Plot(const QString &_attributeName,
+        const gui::PlotData &_data, const PlotBucket &_bucket);
+
     /// \brief Interface to communicate with Qml
     public: std::unique_ptr<gui::PlottingInterface> plottingIface{nullptr};
 
@@ -53,6 +129,38 @@ namespace ignition::gazebo
 
     /// \brief Mutex to protect the components map.
     public: std::recursive_mutex componentsMutex;
+
+    /// \brief Transport node used to request and receive samples.
+    public: transport::Node node;
+
+    /// \brief Name of the world.
+    public: std::string worldName;
+
+    /// \brief Rate at which the server samples components, zero to read
+    /// them from the GUI's ECM instead.
+    public: double sampleRate{0.0};
+
+    /// \brief Width of the time buckets samples are decimated into, in
+    /// seconds of simulation time. Zero to plot all samples.
+    public: double decimationPeriod{0.01};
+
+    /// \brief Topics of the components sampled by the server, by key in
+    /// the components map.
+    public: std::map<std::string, std::string> sampleTopics;
+
+    /// \brief Decimation buckets of each attribute, by name.
+    public: std::map<std::string, PlotBucket> buckets;
+
+    /// \brief Samples received since the last update, by key in the
+    /// components map. Protected by samplesMutex.
+    public: std::map<std::string, std::vector<PlotSample>> samples;
+
+    /// \brief Keys of components the server failed to sample, which are
+    /// read from the GUI's ECM instead. Protected by samplesMutex.
+    public: std::set<std::string> failedSamples;
+
+    /// \brief Mutex protecting samples and failedSamples.
+    public: std::mutex samplesMutex;
   };
 
   class PlotComponentPrivate
@@ -229,13 +337,28 @@ Plotting::Plotting() : GuiSystem(),
 //////////////////////////////////////////////////
 Plotting::~Plotting()
 {
+  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->componentsMutex);
+  while (!this->dataPtr->sampleTopics.empty())
+    this->dataPtr->Unsubscribe(this->dataPtr->sampleTopics.begin()->first);
 }
 
 //////////////////////////////////////////
-void Plotting::LoadConfig(const tinyxml2::XMLElement *)
+void Plotting::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
 {
   if (this->title.empty())
     this->title = "Plotting";
+
+  // Parameters from SDF
+  if (_pluginElem)
+  {
+    auto rateElem = _pluginElem->FirstChildElement("sample_rate");
+    if (nullptr != rateElem && nullptr != rateElem->GetText())
+      rateElem->QueryDoubleText(&this->dataPtr->sampleRate);
+
+    auto periodElem = _pluginElem->FirstChildElement("decimation_period");
+    if (nullptr != periodElem && nullptr != periodElem->GetText())
+      periodElem->QueryDoubleText(&this->dataPtr->decimationPeriod);
+  }
 }
 
 //////////////////////////////////////////////////
@@ -379,7 +502,18 @@ void Plotting::UnRegisterChartFromComponent(uint64_t _entity, uint64_t _typeId,
   this->dataPtr->components[id]->UnRegisterChart(_attribute, _chart);
 
   if (!this->dataPtr->components[id]->HasCharts())
+  {
     this->dataPtr->components.erase(id);
+    this->dataPtr->Unsubscribe(id);
+
+    auto prefix = id + ",";
+    auto it = this->dataPtr->buckets.lower_bound(prefix);
+    while (it != this->dataPtr->buckets.end() &&
+        it->first.compare(0, prefix.size(), prefix) == 0)
+    {
+      it = this->dataPtr->buckets.erase(it);
+    }
+  }
 }
 
 //////////////////////////////////////////////////
@@ -396,156 +530,342 @@ std::string Plotting::ComponentName(const uint64_t &_typeId)
 }
 
 //////////////////////////////////////////////////
-void Plotting::Update(const ignition::gazebo::UpdateInfo &_info,
-                       ignition::gazebo::EntityComponentManager &_ecm)
+/// \brief Set the data of a plotted component if it has the given type.
+/// \tparam ComponentT Component type.
+/// \param[in] _plotting Plotting plugin.
+/// \param[in] _id Key of the component in the components map.
+/// \param[in] _typeId Type of the component.
+/// \param[in] _get Function taking a null pointer to a component type, and
+/// returning the component as that type, or null if it's unavailable.
+/// \return True if the component has the given type.
+template <typename ComponentT, typename GetT>
+static bool setDataIfType(Plotting &_plotting, const std::string &_id,
+    ComponentTypeId _typeId, GetT &_get)
 {
-  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->componentsMutex);
-  for (auto component : this->dataPtr->components)
-  {
-    auto entity = component.second->Entity();
-    auto typeId = component.second->TypeId();
+  if (_typeId != ComponentT::typeId)
+    return false;
 
-    if (typeId == components::AngularAcceleration::typeId)
-    {
-      auto comp = _ecm.Component<components::AngularAcceleration>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
-    }
-    else if (typeId == components::AngularVelocity::typeId)
-    {
-      auto comp = _ecm.Component<components::AngularVelocity>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
-    }
-    else if (typeId == components::CastShadows::typeId)
-    {
-      auto comp = _ecm.Component<components::CastShadows>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
-    }
-    else if (typeId == components::Gravity::typeId)
-    {
-      auto comp = _ecm.Component<components::Gravity>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
-    }
-    else if (typeId == components::LinearAcceleration::typeId)
-    {
-      auto comp = _ecm.Component<components::LinearAcceleration>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
-    }
-    else if (typeId == components::LinearVelocity::typeId)
-    {
-      auto comp = _ecm.Component<components::LinearVelocity>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
-    }
-    else if (typeId == components::MagneticField::typeId)
-    {
-      auto comp = _ecm.Component<components::MagneticField>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
-    }
-    else if (typeId == components::ParentEntity::typeId)
-    {
-      auto comp = _ecm.Component<components::ParentEntity>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
-    }
-    else if (typeId == components::Physics::typeId)
-    {
-      auto comp = _ecm.Component<components::Physics>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
-    }
-    else if (typeId == components::Pose::typeId)
-    {
-      auto comp = _ecm.Component<components::Pose>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
-    }
-    else if (typeId == components::Static::typeId)
-    {
-      auto comp = _ecm.Component<components::Static>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
-    }
-    else if (typeId == components::SphericalCoordinates::typeId)
+  const ComponentT *comp = _get(static_cast<const ComponentT *>(nullptr));
+  if (comp)
+    _plotting.SetData(_id, comp->Data());
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Set the data of a plotted component if it has one of the given
+/// types.
+/// \tparam ComponentTs Component types.
+/// \param[in] _plotting Plotting plugin.
+/// \param[in] _id Key of the component in the components map.
+/// \param[in] _typeId Type of the component.
+/// \param[in] _get See setDataIfType.
+/// \return True if the component has one of the given types.
+template <typename... ComponentTs, typename GetT>
+static bool setDataIfTypes(Plotting &_plotting, const std::string &_id,
+    ComponentTypeId _typeId, GetT &_get)
+{
+  return (setDataIfType<ComponentTs>(_plotting, _id, _typeId, _get) || ...);
+}
+
+//////////////////////////////////////////////////
+/// \brief Set the data of a plotted component of any supported type.
+/// \param[in] _plotting Plotting plugin.
+/// \param[in] _id Key of the component in the components map.
+/// \param[in] _typeId Type of the component.
+/// \param[in] _get Function taking a null pointer to a component type, and
+/// returning the component as that type, or null if it's unavailable.
+/// \return True if the component type is supported.
+template <typename GetT>
+static bool setComponentData(Plotting &_plotting, const std::string &_id,
+    ComponentTypeId _typeId, GetT &&_get)
+{
+  if (_typeId == components::Light::typeId)
+  {
+    auto comp = _get(static_cast<const components::Light *>(nullptr));
+    if (comp)
     {
-      auto comp = _ecm.Component<components::SphericalCoordinates>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
+      _plotting.SetData(_id, convert<ignition::msgs::Light>(comp->Data()));
     }
-    else if (typeId == components::TrajectoryPose::typeId)
+    return true;
+  }
+
+  return setDataIfTypes<
+      components::AngularAcceleration,
+      components::AngularVelocity,
+      components::CastShadows,
+      components::Gravity,
+      components::LinearAcceleration,
+      components::LinearVelocity,
+      components::MagneticField,
+      components::ParentEntity,
+      components::Physics,
+      components::Pose,
+      components::Static,
+      components::SphericalCoordinates,
+      components::TrajectoryPose,
+      components::WindMode,
+      components::WorldAngularAcceleration,
+      components::WorldLinearVelocity,
+      components::WorldLinearVelocitySeed,
+      components::WorldPose,
+      components::WorldPoseCmd>(_plotting, _id, _typeId, _get);
+}
+
+//////////////////////////////////////////////////
+void PlottingPrivate::Subscribe(const std::string &_id,
+    PlotComponent &_component)
+{
+  auto &topic = this->sampleTopics[_id];
+  topic = transport::TopicUtils::AsValidTopic("/world/" + this->worldName +
+      "/plot/" + std::to_string(QCoreApplication::applicationPid()) + "/" +
+      std::to_string(_component.Entity()) + "_" +
+      std::to_string(_component.TypeId()));
+
+  std::function<void(const msgs::SerializedState &)> cb =
+      [this, _id](const msgs::SerializedState &_msg)
+      {
+        this->OnSamples(_id, _msg);
+      };
+  if (topic.empty() || !this->node.Subscribe(topic, cb))
+  {
+    ignerr << "Failed to subscribe to samples of [" << _id
+           << "], reading them from the GUI instead." << std::endl;
+    std::lock_guard<std::mutex> lock(this->samplesMutex);
+    this->failedSamples.insert(_id);
+    return;
+  }
+
+  msgs::Param req;
+  auto setString = [&req](const std::string &_key,
+      const std::string &_value)
+  {
+    auto &any = (*req.mutable_params())[_key];
+    any.set_type(msgs::Any::STRING);
+    any.set_string_value(_value);
+  };
+  setString("topic", topic);
+  setString("entity", std::to_string(_component.Entity()));
+  setString("component_type", std::to_string(_component.TypeId()));
+  auto &rate = (*req.mutable_params())["rate"];
+  rate.set_type(msgs::Any::DOUBLE);
+  rate.set_double_value(this->sampleRate);
+
+  std::function<void(const msgs::Boolean &, const bool)> reqCb =
+      [this, _id](const msgs::Boolean &_rep, const bool _result)
+      {
+        if (_result && _rep.data())
+          return;
+        ignerr << "The server failed to sample [" << _id
+               << "], reading it from the GUI instead." << std::endl;
+        std::lock_guard<std::mutex> lock(this->samplesMutex);
+        this->failedSamples.insert(_id);
+      };
+  this->node.Request("/world/" + this->worldName + "/plot/subscribe", req,
+      reqCb);
+}
+
+//////////////////////////////////////////////////
+void PlottingPrivate::Unsubscribe(const std::string &_id)
+{
+  auto topicIt = this->sampleTopics.find(_id);
+  if (topicIt == this->sampleTopics.end())
+    return;
+
+  if (!topicIt->second.empty())
+  {
+    this->node.Unsubscribe(topicIt->second);
+
+    msgs::StringMsg req;
+    req.set_data(topicIt->second);
+    this->node.Request("/world/" + this->worldName + "/plot/unsubscribe",
+        req);
+  }
+  this->sampleTopics.erase(topicIt);
+
+  std::lock_guard<std::mutex> lock(this->samplesMutex);
+  this->samples.erase(_id);
+  this->failedSamples.erase(_id);
+}
+
+//////////////////////////////////////////////////
+void PlottingPrivate::OnSamples(const std::string &_id,
+    const msgs::SerializedState &_msg)
+{
+  const auto &header = _msg.header();
+  if (header.data_size() == 0 || header.data(0).key() != "sim_time" ||
+      header.data(0).value_size() != _msg.entities_size())
+  {
+    ignerr << "Received samples of [" << _id << "] without their times."
+           << std::endl;
+    return;
+  }
+
+  std::vector<PlotSample> newSamples;
+  newSamples.reserve(_msg.entities_size());
+  for (int i = 0; i < _msg.entities_size(); ++i)
+  {
+    const auto &entityMsg = _msg.entities(i);
+    if (entityMsg.components_size() == 0)
+      continue;
+
+    const auto &compMsg = entityMsg.components(0);
+    auto comp = components::Factory::Instance()->New(compMsg.type());
+    if (nullptr == comp)
+      continue;
+
+    if (!components::DeserializeBinaryData(*comp, compMsg.component()))
     {
-      auto comp = _ecm.Component<components::TrajectoryPose>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
+      std::istringstream istr(compMsg.component());
+      comp->Deserialize(istr);
     }
-    else if (typeId == components::WindMode::typeId)
+
+    newSamples.push_back({std::stoll(header.data(0).value(i)) * 1e-9,
+        std::move(comp)});
+  }
+
+  std::lock_guard<std::mutex> lock(this->samplesMutex);
+  auto &queue = this->samples[_id];
+  for (auto &sample : newSamples)
+    queue.push_back(std::move(sample));
+}
+
+//////////////////////////////////////////////////
+void PlottingPrivate::Plot(const std::string &_id,
+    const PlotComponent &_component, double _time)
+{
+  for (const auto &[name, data] : _component.Data())
+  {
+    if (data->ChartCount() == 0)
+      continue;
+
+    QString attributeName = QString::fromStdString(_id + "," + name);
+    std::pair<double, double> sample{_time, data->Value()};
+    if (this->decimationPeriod <= 0.0)
     {
-      auto comp = _ecm.Component<components::WindMode>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
+      this->Plot(attributeName, *data, {0, 1, sample, sample});
+      continue;
     }
-    else if (typeId == components::WorldAngularAcceleration::typeId)
+
+    // Plot the previous bucket once a sample falls outside of it
+    auto &bucket = this->buckets[_id + "," + name];
+    auto index = static_cast<int64_t>(
+        std::floor(_time / this->decimationPeriod));
+    if (bucket.count > 0 && bucket.index != index)
     {
-      auto comp = _ecm.Component<components::WorldAngularAcceleration>(
-                  entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
+      this->Plot(attributeName, *data, bucket);
+      bucket.count = 0;
     }
-    else if (typeId == components::WorldLinearVelocity::typeId)
+
+    if (bucket.count == 0)
     {
-      auto comp = _ecm.Component<components::WorldLinearVelocity>(
-                  entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
+      bucket.index = index;
+      bucket.min = sample;
+      bucket.max = sample;
     }
-    else if (typeId == components::WorldLinearVelocitySeed::typeId)
+    else if (sample.second < bucket.min.second)
     {
-      auto comp = _ecm.Component<components::WorldLinearVelocitySeed>(
-                  entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
+      bucket.min = sample;
     }
-    else if (typeId == components::WorldPose::typeId)
+    else if (sample.second > bucket.max.second)
     {
-      auto comp = _ecm.Component<components::WorldPose>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
+      bucket.max = sample;
     }
-    else if (typeId == components::WorldPoseCmd::typeId)
+    ++bucket.count;
+  }
+}
+
+//////////////////////////////////////////////////
+void PlottingPrivate::Plot(const QString &_attributeName,
+    const gui::PlotData &_data, const PlotBucket &_bucket)
+{
+  // Plot in time order, and only once if it's the same sample
+  auto first = _bucket.min;
+  auto second = _bucket.max;
+  if (second.first < first.first)
+    std::swap(first, second);
+
+  for (auto chart : _data.Charts())
+  {
+    emit this->plottingIface->plot(chart, _attributeName, first.first,
+        first.second);
+    if (second.first != first.first)
     {
-      auto comp = _ecm.Component<components::WorldPoseCmd>(entity);
-      if (comp)
-        this->SetData(component.first, comp->Data());
+      emit this->plottingIface->plot(chart, _attributeName, second.first,
+          second.second);
     }
-    else if (typeId == components::Light::typeId)
+  }
+}
+
+//////////////////////////////////////////////////
+void Plotting::Update(const ignition::gazebo::UpdateInfo &_info,
+                       ignition::gazebo::EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("Plotting::Update");
+
+  if (this->dataPtr->worldName.empty())
+  {
+    _ecm.Each<components::World, components::Name>(
+        [&](const Entity &, const components::World *,
+            const components::Name *_name) -> bool
+        {
+          this->dataPtr->worldName = _name->Data();
+          return false;
+        });
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->componentsMutex);
+
+  // Take the samples received since the last update
+  std::map<std::string, std::vector<PlotSample>> samples;
+  std::set<std::string> failedSamples;
+  {
+    std::lock_guard<std::mutex> samplesLock(this->dataPtr->samplesMutex);
+    samples.swap(this->dataPtr->samples);
+    failedSamples = this->dataPtr->failedSamples;
+  }
+
+  for (auto component : this->dataPtr->components)
+  {
+    auto entity = component.second->Entity();
+    auto typeId = component.second->TypeId();
+
+    bool sampled = this->dataPtr->sampleRate > 0.0 &&
+        !this->dataPtr->worldName.empty() &&
+        failedSamples.count(component.first) == 0;
+    if (sampled && this->dataPtr->sampleTopics.count(component.first) == 0)
+      this->dataPtr->Subscribe(component.first, *component.second);
+
+    if (sampled)
     {
-      auto comp = _ecm.Component<components::Light>(entity);
-      if (comp)
+      auto samplesIt = samples.find(component.first);
+      if (samplesIt == samples.end())
+        continue;
+
+      for (const auto &sample : samplesIt->second)
       {
-        ignition::msgs::Light lightMsgs =
-          convert<ignition::msgs::Light>(comp->Data());
-        this->SetData(component.first, lightMsgs);
+        const components::BaseComponent *base = sample.comp.get();
+        setComponentData(*this, component.first, typeId,
+            [base](auto *_tag)
+            {
+              using ComponentT = std::remove_pointer_t<decltype(_tag)>;
+              return static_cast<ComponentT *>(base);
+            });
+        this->dataPtr->Plot(component.first, *component.second,
+            sample.time);
       }
+      continue;
     }
 
-    for (auto attribute : component.second->Data())
-    {
-      for (auto chart : attribute.second->Charts())
-      {
-        QString attributeName = QString::fromStdString(
-                    component.first + "," + attribute.first);
-        double y = attribute.second->Value();
-
-        double x = _info.simTime.count() * std::pow(10, -9);
+    setComponentData(*this, component.first, typeId,
+        [&_ecm, entity](auto *_tag)
+        {
+          using ComponentT = std::remove_const_t<
+              std::remove_pointer_t<decltype(_tag)>>;
+          return _ecm.Component<ComponentT>(entity);
+        });
 
-        emit this->dataPtr->plottingIface->plot(chart, attributeName, x, y);
-      }
-    }
+    double x = _info.simTime.count() * std::pow(10, -9);
+    this->dataPtr->Plot(component.first, *component.second, x);
   }
 }
 
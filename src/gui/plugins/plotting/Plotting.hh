@@ -95,6 +95,18 @@ class PlottingPrivate;
 
 /// \brief Physics data plotting handler that keeps track of the
 /// registered components, update them and update the plot
+///
+/// Values are decimated before being plotted: samples which fall in the
+/// same time bucket are plotted as their minimum and maximum.
+///
+/// ## Configuration
+///
+/// * `<sample_rate>` (optional): Rate in Hz of simulation time at which the
+/// server samples plotted components, which are received in batches.
+/// Requires the SceneBroadcaster system. Defaults to 0, which reads
+/// components from the GUI on every update instead, at the state rate.
+/// * `<decimation_period>` (optional): Width of the time buckets in
+/// seconds. Zero plots all values. Defaults to 0.01.
 class Plotting : public ignition::gazebo::GuiSystem
 {
   Q_OBJECT
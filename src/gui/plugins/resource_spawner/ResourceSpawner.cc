@@ -21,8 +21,16 @@
 #include <ignition/msgs/stringmsg.pb.h>
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
 #include <set>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+
+#include <QTimer>
 
 #include <sdf/Root.hh>
 #include <sdf/parser.hh>
@@ -30,6 +38,7 @@
 #include <ignition/common/Console.hh>
 #include <ignition/common/Filesystem.hh>
 #include <ignition/common/Profiler.hh>
+#include <ignition/common/Util.hh>
 #include <ignition/fuel_tools/ClientConfig.hh>
 #include <ignition/fuel_tools/FuelClient.hh>
 #include <ignition/gui/Application.hh>
@@ -43,8 +52,33 @@
 
 namespace ignition::gazebo
 {
+  /// \brief Number of resources added to the grid on each iteration of the
+  /// event loop.
+  constexpr int kResourceBatchSize{50};
+
   class ResourceSpawnerPrivate
   {
+    /// \brief Add the next batch of displayed resources to the grid, and
+    /// schedule the following one if there are more.
+    public: void AddResourceBatch();
+
+    /// \brief Read the Fuel listing saved by a previous run.
+    /// \return True if any resource was read.
+    public: bool LoadIndex();
+
+    /// \brief Save a Fuel listing so the next run can show it right away.
+    /// \param[in] _listing Resources of each owner.
+    public: void SaveIndex(const std::unordered_map<std::string,
+                std::vector<Resource>> &_listing) const;
+
+    /// \brief Body of the loading thread. It fetches the Fuel listing, then
+    /// finds which resources of the requested owners are cached, together
+    /// with their thumbnails.
+    /// \param[in] _spawner Plugin notified of the results.
+    /// \param[in] _servers Fuel servers to list.
+    public: void Load(ResourceSpawner *_spawner,
+                const std::vector<fuel_tools::ServerConfig> &_servers);
+
     /// \brief Ignition communication node.
     public: transport::Node node;
 
@@ -64,10 +98,43 @@ namespace ignition::gazebo
             fuelClient = nullptr;
 
     /// \brief The map to cache resources after a search is made on an owner,
-    /// reduces redundant searches
+    /// reduces redundant searches. Protected by mutex.
     public: std::unordered_map<std::string,
             std::vector<Resource>> ownerModelMap;
 
+    /// \brief Owners whose resources were checked against the local cache.
+    /// Protected by mutex.
+    public: std::unordered_set<std::string> resolvedOwners;
+
+    /// \brief Owners waiting to be checked by the loading thread. Protected
+    /// by mutex.
+    public: std::deque<std::string> ownersToResolve;
+
+    /// \brief True when the loading thread should stop. Protected by mutex.
+    public: bool stop{false};
+
+    /// \brief Protects the data shared with the loading thread.
+    public: std::mutex mutex;
+
+    /// \brief Wakes up the loading thread.
+    public: std::condition_variable cv;
+
+    /// \brief Fetches Fuel listings and thumbnails away from the GUI thread.
+    public: std::thread loadThread;
+
+    /// \brief File holding the Fuel listing of the last run.
+    public: std::string indexPath;
+
+    /// \brief Resources shown on the grid, in order. Only the first
+    /// displayedCount have been added to the resource model so far.
+    public: std::vector<Resource> displayedResources;
+
+    /// \brief Number of displayed resources added to the resource model.
+    public: int displayedCount{0};
+
+    /// \brief Schedules adding the next batch of resources to the grid.
+    public: QTimer batchTimer;
+
     /// \brief Holds all of the relevant data used by `DisplayData()` in order
     /// to filter and sort the displayed resources as desired by the user.
     public: Display displayData;
@@ -218,10 +285,200 @@ ResourceSpawner::ResourceSpawner()
       "OwnerList", &this->dataPtr->ownerModel);
   this->dataPtr->fuelClient =
     std::make_unique<fuel_tools::FuelClient>();
+
+  this->dataPtr->batchTimer.setSingleShot(true);
+  this->connect(&this->dataPtr->batchTimer, &QTimer::timeout, this,
+      [this]() {this->dataPtr->AddResourceBatch();});
+}
+
+/////////////////////////////////////////////////
+ResourceSpawner::~ResourceSpawner()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->stop = true;
+  }
+  this->dataPtr->cv.notify_all();
+  if (this->dataPtr->loadThread.joinable())
+    this->dataPtr->loadThread.join();
+}
+
+/////////////////////////////////////////////////
+void ResourceSpawnerPrivate::AddResourceBatch()
+{
+  IGN_PROFILE("ResourceSpawnerPrivate::AddResourceBatch");
+  int end = std::min(this->displayedCount + kResourceBatchSize,
+      static_cast<int>(this->displayedResources.size()));
+  for (; this->displayedCount < end; ++this->displayedCount)
+  {
+    this->resourceModel.AddResource(
+        this->displayedResources[this->displayedCount]);
+  }
+
+  // Let the event loop run before adding more
+  if (this->displayedCount <
+      static_cast<int>(this->displayedResources.size()))
+  {
+    this->batchTimer.start(0);
+  }
+}
+
+/////////////////////////////////////////////////
+bool ResourceSpawnerPrivate::LoadIndex()
+{
+  std::ifstream file(this->indexPath);
+  if (!file.is_open())
+    return false;
+
+  // Each line holds the owner, name and URI of a resource, separated by tabs
+  std::unordered_map<std::string, std::vector<Resource>> listing;
+  std::string line;
+  while (std::getline(file, line))
+  {
+    auto first = line.find('\t');
+    auto second = line.find('\t', first + 1);
+    if (first == std::string::npos || second == std::string::npos)
+      continue;
+
+    Resource resource;
+    resource.owner = line.substr(0, first);
+    resource.name = line.substr(first + 1, second - first - 1);
+    resource.sdfPath = line.substr(second + 1);
+    resource.isFuel = true;
+    listing[resource.owner].push_back(resource);
+  }
+
+  if (listing.empty())
+    return false;
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->ownerModelMap = std::move(listing);
+  return true;
+}
+
+/////////////////////////////////////////////////
+void ResourceSpawnerPrivate::SaveIndex(const std::unordered_map<std::string,
+    std::vector<Resource>> &_listing) const
+{
+  std::string dir = common::parentPath(this->indexPath);
+  if (!common::exists(dir) && !common::createDirectories(dir))
+  {
+    ignwarn << "Failed to create directory for Fuel index ["
+            << this->indexPath << "]" << std::endl;
+    return;
+  }
+
+  // Write to a temporary file first, so a crash never leaves half an index
+  std::string tmpPath = this->indexPath + ".tmp";
+  {
+    std::ofstream file(tmpPath, std::ios::trunc);
+    for (const auto &[owner, resources] : _listing)
+    {
+      for (const auto &resource : resources)
+      {
+        file << owner << '\t' << resource.name << '\t' << resource.sdfPath
+             << '\n';
+      }
+    }
+    if (!file.good())
+    {
+      ignwarn << "Failed to write Fuel index [" << tmpPath << "]"
+              << std::endl;
+      return;
+    }
+  }
+  common::moveFile(tmpPath, this->indexPath);
 }
 
 /////////////////////////////////////////////////
-ResourceSpawner::~ResourceSpawner() = default;
+void ResourceSpawnerPrivate::Load(ResourceSpawner *_spawner,
+    const std::vector<fuel_tools::ServerConfig> &_servers)
+{
+  IGN_PROFILE_THREAD_NAME("ResourceSpawner");
+
+  // Fetch the whole listing, without touching the local cache yet, which is
+  // slow for owners with many resources
+  std::unordered_map<std::string, std::vector<Resource>> listing;
+  for (auto const &server : _servers)
+  {
+    for (auto iter = this->fuelClient->Models(server); iter; ++iter)
+    {
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->stop)
+          return;
+      }
+
+      auto id = iter->Identification();
+      Resource resource;
+      resource.name = id.Name();
+      resource.isFuel = true;
+      resource.isDownloaded = false;
+      resource.owner = id.Owner();
+      resource.sdfPath = id.UniqueName();
+      listing[id.Owner()].push_back(resource);
+    }
+  }
+
+  // Keep the saved listing when offline
+  if (!listing.empty())
+  {
+    ignmsg << "Fuel resources loaded.\n";
+    this->SaveIndex(listing);
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->ownerModelMap = std::move(listing);
+    this->resolvedOwners.clear();
+  }
+  QMetaObject::invokeMethod(_spawner, "OnFuelResourcesLoaded",
+      Qt::QueuedConnection);
+
+  // Check the resources of each owner the user opens against the cache
+  while (true)
+  {
+    std::string owner;
+    std::vector<Resource> resources;
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->cv.wait(lock, [this]
+      {
+        return this->stop || !this->ownersToResolve.empty();
+      });
+      if (this->stop)
+        return;
+
+      owner = this->ownersToResolve.front();
+      this->ownersToResolve.pop_front();
+      if (this->resolvedOwners.count(owner) > 0)
+        continue;
+      resources = this->ownerModelMap[owner];
+    }
+
+    for (auto &resource : resources)
+    {
+      // If the resource is cached, we can go ahead and populate the
+      // respective information
+      std::string path;
+      if (!resource.isDownloaded && this->fuelClient->CachedModel(
+            common::URI(resource.sdfPath), path))
+      {
+        resource.isDownloaded = true;
+        resource.sdfPath = common::joinPaths(path, "model.sdf");
+        std::string thumbnailPath = common::joinPaths(path, "thumbnails");
+        _spawner->SetThumbnail(thumbnailPath, resource);
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if (this->stop)
+        return;
+      this->ownerModelMap[owner] = std::move(resources);
+      this->resolvedOwners.insert(owner);
+    }
+    QMetaObject::invokeMethod(_spawner, "OnOwnerResolved",
+        Qt::QueuedConnection, Q_ARG(QString, QString::fromStdString(owner)));
+  }
+}
 
 /////////////////////////////////////////////////
 void ResourceSpawner::SetThumbnail(const std::string &_thumbnailPath,
@@ -328,14 +585,10 @@ std::vector<Resource> ResourceSpawner::FuelResources(const std::string &_owner)
 {
   std::vector<Resource> fuelResources;
 
-  if (this->dataPtr->ownerModelMap.find(_owner) !=
-      this->dataPtr->ownerModelMap.end())
-  {
-    for (Resource resource : this->dataPtr->ownerModelMap[_owner])
-    {
-      fuelResources.push_back(resource);
-    }
-  }
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto it = this->dataPtr->ownerModelMap.find(_owner);
+  if (it != this->dataPtr->ownerModelMap.end())
+    fuelResources = it->second;
   return fuelResources;
 }
 
@@ -454,9 +707,87 @@ void ResourceSpawner::DisplayResources()
   // Sort the resources by the provided search method
   this->SortResources(resources);
 
-  // Clear the qml grid and add the resource results
+  // Clear the qml grid and add the resource results a batch at a time, so
+  // owners with thousands of resources don't block the GUI
+  this->dataPtr->batchTimer.stop();
   this->dataPtr->resourceModel.Clear();
-  this->dataPtr->resourceModel.AddResources(resources);
+  this->dataPtr->displayedResources = std::move(resources);
+  this->dataPtr->displayedCount = 0;
+  this->dataPtr->AddResourceBatch();
+
+  // Find out in the background which fuel resources are downloaded
+  if (this->dataPtr->displayData.isFuel)
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+      if (this->dataPtr->resolvedOwners.count(
+            this->dataPtr->displayData.ownerPath) > 0)
+      {
+        return;
+      }
+      this->dataPtr->ownersToResolve.push_back(
+          this->dataPtr->displayData.ownerPath);
+    }
+    this->dataPtr->cv.notify_all();
+  }
+}
+
+/////////////////////////////////////////////////
+void ResourceSpawner::OnFuelResourcesLoaded()
+{
+  // A set isn't necessary to keep track of the owners, but it
+  // maintains alphabetical order
+  std::set<std::string> ownerSet;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    for (const auto &owner : this->dataPtr->ownerModelMap)
+      ownerSet.insert(owner.first);
+  }
+
+  // Clear the loading message, or the owners from the saved index
+  this->dataPtr->ownerModel.clear();
+
+  // Add all unique owners to the owner model
+  for (const auto &owner : ownerSet)
+  {
+    this->dataPtr->ownerModel.AddPath(owner);
+  }
+
+  if (this->dataPtr->displayData.isFuel)
+    this->DisplayResources();
+}
+
+/////////////////////////////////////////////////
+void ResourceSpawner::OnOwnerResolved(const QString &_owner)
+{
+  if (!this->dataPtr->displayData.isFuel ||
+      this->dataPtr->displayData.ownerPath != _owner.toStdString())
+  {
+    return;
+  }
+
+  // Update the displayed resources in place, so the grid keeps its position
+  std::unordered_map<std::string, Resource> resolved;
+  for (const auto &resource : this->FuelResources(_owner.toStdString()))
+    resolved[resource.name] = resource;
+
+  auto &displayed = this->dataPtr->displayedResources;
+  for (int i = 0; i < static_cast<int>(displayed.size()); ++i)
+  {
+    auto it = resolved.find(displayed[i].name);
+    if (it == resolved.end() ||
+        it->second.isDownloaded == displayed[i].isDownloaded)
+    {
+      continue;
+    }
+    displayed[i] = it->second;
+    if (i < this->dataPtr->displayedCount)
+      this->dataPtr->resourceModel.UpdateResourceModel(i, displayed[i]);
+  }
+
+  // Downloaded resources may now sort differently
+  if (this->dataPtr->displayData.sortMethod == "Downloaded")
+    this->DisplayResources();
 }
 
 /////////////////////////////////////////////////
@@ -493,21 +824,29 @@ void ResourceSpawner::OnDownloadFuelResource(const QString &_path,
     // Update the current grid of resources
     this->dataPtr->resourceModel.UpdateResourceModel(index, modelResource);
 
+    // Keep the displayed copy in sync, in case it's added to the grid later
+    if (index >= 0 &&
+        index < static_cast<int>(this->dataPtr->displayedResources.size()))
+    {
+      auto &displayed = this->dataPtr->displayedResources[index];
+      displayed.isDownloaded = modelResource.isDownloaded;
+      displayed.sdfPath = modelResource.sdfPath;
+      displayed.thumbnailPath = modelResource.thumbnailPath;
+    }
+
     // Update the ground truth ownerModelMap
-    if (this->dataPtr->ownerModelMap.find(_owner.toStdString()) !=
-        this->dataPtr->ownerModelMap.end())
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    auto it = this->dataPtr->ownerModelMap.find(_owner.toStdString());
+    if (it != this->dataPtr->ownerModelMap.end())
     {
-      std::vector<Resource> fuelResources =
-        this->dataPtr->ownerModelMap[_owner.toStdString()];
-      for (auto &resource : fuelResources)
+      for (auto &resource : it->second)
       {
         if (resource.name == _name.toStdString())
         {
           resource.isDownloaded = modelResource.isDownloaded;
           resource.isFuel = modelResource.isFuel;
           resource.sdfPath = modelResource.sdfPath;
-          this->SetThumbnail(thumbnailPath, resource);
-          this->dataPtr->ownerModelMap[_owner.toStdString()] = fuelResources;
+          resource.thumbnailPath = modelResource.thumbnailPath;
           break;
         }
       }
@@ -573,62 +912,29 @@ void ResourceSpawner::LoadConfig(const tinyxml2::XMLElement *)
     }
   }
 
-  ignmsg << "Please wait... Loading models from Fuel.\n";
-
-  // Add notice for the user that fuel resources are being loaded
-  this->dataPtr->ownerModel.AddPath("Please wait... Loading models from Fuel.");
-
-  // Pull in fuel models asynchronously
-  std::thread t([this, servers]
+  // Show the listing saved by the last run right away, and refresh it in
+  // the background
+  std::string home;
+  common::env(IGN_HOMEDIR, home);
+  this->dataPtr->indexPath = common::joinPaths(home, ".ignition", "gazebo",
+      "resource_spawner", "fuel_index");
+  if (this->dataPtr->LoadIndex())
   {
-    // A set isn't necessary to keep track of the owners, but it
-    // maintains alphabetical order
-    std::set<std::string> ownerSet;
-    for (auto const &server : servers)
-    {
-      std::vector<fuel_tools::ModelIdentifier> models;
-      for (auto iter = this->dataPtr->fuelClient->Models(server); iter; ++iter)
-      {
-        models.push_back(iter->Identification());
-      }
-
-      // Create each fuel resource and add them to the ownerModelMap
-      for (const auto &id : models)
-      {
-        Resource resource;
-        resource.name = id.Name();
-        resource.isFuel = true;
-        resource.isDownloaded = false;
-        resource.owner = id.Owner();
-        resource.sdfPath = id.UniqueName();
-        std::string path;
-
-        // If the resource is cached, we can go ahead and populate the
-        // respective information
-        if (this->dataPtr->fuelClient->CachedModel(
-              common::URI(id.UniqueName()), path))
-        {
-          resource.isDownloaded = true;
-          resource.sdfPath = common::joinPaths(path, "model.sdf");
-          std::string thumbnailPath = common::joinPaths(path, "thumbnails");
-          this->SetThumbnail(thumbnailPath, resource);
-        }
-        ownerSet.insert(id.Owner());
-        this->dataPtr->ownerModelMap[id.Owner()].push_back(resource);
-      }
-    }
+    this->OnFuelResourcesLoaded();
+    ignmsg << "Refreshing models from Fuel in the background.\n";
+  }
+  else
+  {
+    ignmsg << "Please wait... Loading models from Fuel.\n";
 
-    // Clear the loading message
-    this->dataPtr->ownerModel.clear();
+    // Add notice for the user that fuel resources are being loaded
+    this->dataPtr->ownerModel.AddPath(
+        "Please wait... Loading models from Fuel.");
+  }
 
-    // Add all unique owners to the owner model
-    for (const auto &resource : ownerSet)
-    {
-      this->dataPtr->ownerModel.AddPath(resource);
-    }
-    ignmsg << "Fuel resources loaded.\n";
-  });
-  t.detach();
+  // Pull in fuel models asynchronously
+  this->dataPtr->loadThread = std::thread(&ResourceSpawnerPrivate::Load,
+      this->dataPtr.get(), this, servers);
 }
 
 /////////////////////////////////////////////////
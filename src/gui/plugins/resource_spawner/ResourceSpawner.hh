@@ -211,6 +211,16 @@ namespace gazebo
     /// \param[in] _owner The name of the owner
     public slots: void OnOwnerClicked(const QString &_owner);
 
+    /// \brief Callback in the GUI thread when the Fuel listing has been
+    /// loaded, will update the owner list and the displayed resources.
+    public slots: void OnFuelResourcesLoaded();
+
+    /// \brief Callback in the GUI thread when the resources of a Fuel owner
+    /// have been checked against the local cache, will update the displayed
+    /// resources which are downloaded.
+    /// \param[in] _owner The name of the owner
+    public slots: void OnOwnerResolved(const QString &_owner);
+
     /// \brief Callback when a request is made to download a fuel resource.
     /// \param[in] _path URI to the fuel resource
     /// \param[in] _name Name of the resource
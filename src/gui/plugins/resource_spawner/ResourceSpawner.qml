@@ -441,6 +441,10 @@ Rectangle {
                 (model.thumbnail == "" ?
                 "NoThumbnail.png" : "file:" + model.thumbnail)
                 fillMode: Image.PreserveAspectFit
+                // Decode thumbnails in the background, at the size shown
+                asynchronous: true
+                sourceSize.width: gridItemWidth
+                sourceSize.height: gridItemHeight
               }
             }
             MouseArea {
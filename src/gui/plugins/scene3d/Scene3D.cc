@@ -343,6 +343,13 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \brief Ray query for mouse clicks
     public: rendering::RayQueryPtr rayQuery;
 
+    /// \brief Points in the scene found under screen positions while
+    /// handling the current frame's mouse events. Each query renders the
+    /// scene again for picking, so hover, clicks and view control share
+    /// the results for the same position.
+    public: std::vector<std::pair<math::Vector2i, math::Vector3d>>
+        framePicks;
+
     /// \brief Rendering utility
     public: RenderUtil renderUtil;
 
@@ -1311,6 +1318,7 @@ Entity IgnRenderer::UniqueId()
 void IgnRenderer::HandleMouseEvent()
 {
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->framePicks.clear();
   this->BroadcastHoverPos();
   this->BroadcastLeftClick();
   this->BroadcastRightClick();
@@ -1318,6 +1326,10 @@ void IgnRenderer::HandleMouseEvent()
   this->HandleModelPlacement();
   this->HandleMouseTransformControl();
   this->HandleMouseViewControl();
+
+  // Hover events received since the last frame were coalesced into the
+  // latest position, which has now been handled
+  this->dataPtr->hoverDirty = false;
 }
 
 /////////////////////////////////////////////////
@@ -1325,7 +1337,7 @@ void IgnRenderer::BroadcastHoverPos()
 {
   if (this->dataPtr->hoverDirty)
   {
-    math::Vector3d pos = this->ScreenToScene(this->dataPtr->mouseHoverPos);
+    math::Vector3d pos = this->PickScenePoint(this->dataPtr->mouseHoverPos);
 
     ignition::gui::events::HoverToScene hoverToSceneEvent(pos);
     ignition::gui::App()->sendEvent(
@@ -1341,7 +1353,7 @@ void IgnRenderer::BroadcastLeftClick()
       this->dataPtr->mouseEvent.Type() == common::MouseEvent::RELEASE &&
       !this->dataPtr->mouseEvent.Dragging() && this->dataPtr->mouseDirty)
   {
-    math::Vector3d pos = this->ScreenToScene(this->dataPtr->mouseEvent.Pos());
+    math::Vector3d pos = this->PickScenePoint(this->dataPtr->mouseEvent.Pos());
 
     ignition::gui::events::LeftClickToScene leftClickToSceneEvent(pos);
     ignition::gui::App()->sendEvent(
@@ -1361,7 +1373,7 @@ void IgnRenderer::BroadcastRightClick()
     if (!this->dataPtr->dropdownMenuEnabled)
       this->dataPtr->mouseDirty = false;
 
-    math::Vector3d pos = this->ScreenToScene(this->dataPtr->mouseEvent.Pos());
+    math::Vector3d pos = this->PickScenePoint(this->dataPtr->mouseEvent.Pos());
 
     ignition::gui::events::RightClickToScene rightClickToSceneEvent(pos);
     ignition::gui::App()->sendEvent(
@@ -2035,7 +2047,7 @@ void IgnRenderer::HandleMouseViewControl()
   if (this->dataPtr->mouseEvent.Type() == common::MouseEvent::SCROLL)
   {
     this->dataPtr->target =
-        this->ScreenToScene(this->dataPtr->mouseEvent.Pos());
+        this->PickScenePoint(this->dataPtr->mouseEvent.Pos());
     this->dataPtr->viewControl->SetTarget(this->dataPtr->target);
     double distance = this->dataPtr->camera->WorldPosition().Distance(
         this->dataPtr->target);
@@ -2053,7 +2065,7 @@ void IgnRenderer::HandleMouseViewControl()
         this->dataPtr->mouseEvent.Dragging() &&
         std::isinf(this->dataPtr->target.X())))
     {
-      this->dataPtr->target = this->ScreenToScene(
+      this->dataPtr->target = this->PickScenePoint(
           this->dataPtr->mouseEvent.PressPos());
       this->dataPtr->viewControl->SetTarget(this->dataPtr->target);
     }
@@ -2572,6 +2584,20 @@ math::Vector3d IgnRenderer::ScreenToScene(
       this->dataPtr->rayQuery->Direction() * 10;
 }
 
+/////////////////////////////////////////////////
+math::Vector3d IgnRenderer::PickScenePoint(const math::Vector2i &_screenPos)
+{
+  for (const auto &[screenPos, point] : this->dataPtr->framePicks)
+  {
+    if (screenPos == _screenPos)
+      return point;
+  }
+
+  auto point = this->ScreenToScene(_screenPos);
+  this->dataPtr->framePicks.emplace_back(_screenPos, point);
+  return point;
+}
+
 ////////////////////////////////////////////////
 void IgnRenderer::RequestSelectionChange(Entity _selectedEntity,
     bool _deselectAll, bool _sendEvent)
@@ -3030,6 +3056,25 @@ void Scene3D::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
         ignwarn << "Child elements of <sky> are not supported yet" << std::endl;
     }
 
+    if (auto elem = _pluginElem->FirstChildElement("share_materials"))
+    {
+      auto shareMaterials = false;
+      elem->QueryBoolText(&shareMaterials);
+      this->dataPtr->renderUtil->SceneManager().SetShareMaterials(
+          shareMaterials);
+    }
+
+    if (auto elem = _pluginElem->FirstChildElement("pose_extrapolation"))
+    {
+      auto poseExtrapolation = false;
+      elem->QueryBoolText(&poseExtrapolation);
+      double maxTime = 0.2;
+      if (auto maxTimeElem = elem->FirstChildElement("max_time"))
+        maxTimeElem->QueryDoubleText(&maxTime);
+      this->dataPtr->renderUtil->SetPoseExtrapolation(poseExtrapolation,
+          maxTime);
+    }
+
     if (auto elem = _pluginElem->FirstChildElement("camera_pose"))
     {
       math::Pose3d pose;
@@ -79,6 +79,17 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
   ///     * \<p_gain\>    : Camera follow movement p gain.
   ///     * \<target\>    : Target to follow.
   /// * \<fullscreen\> : Optional starting the window in fullscreen.
+  /// * \<share_materials\> : Optional, true to share a single material
+  ///                         between visuals with identical materials, so
+  ///                         repeated models can be instanced. Defaults to
+  ///                         false.
+  /// * \<pose_extrapolation\> : Optional, true to keep moving entities
+  ///                            between state updates from the server by
+  ///                            extrapolating their last poses, so motion
+  ///                            is smooth when rendering faster than state
+  ///                            is published. Defaults to false.
+  ///     * \<max_time\> : Maximum time in seconds poses are extrapolated
+  ///                      past the last update. Defaults to 0.2.
   class Scene3D : public ignition::gazebo::GuiSystem
   {
     Q_OBJECT
@@ -544,6 +555,13 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     public: math::Vector3d ScreenToScene(const math::Vector2i &_screenPos)
         const;
 
+    /// \brief Same as ScreenToScene, but reuses the result of an earlier
+    /// call for the same position while handling the current frame's mouse
+    /// events. Must be called from the render thread.
+    /// \param[in] _screenPos 2D coordinates on the screen, in pixels.
+    /// \return 3D coordinates of a point in the 3D scene.
+    private: math::Vector3d PickScenePoint(const math::Vector2i &_screenPos);
+
     /// \brief Get the current camera pose.
     /// \return Pose of the camera.
     public: math::Pose3d CameraPose() const;
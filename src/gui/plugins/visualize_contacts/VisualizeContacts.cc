@@ -71,9 +71,14 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE
     /// \brief Previous state of the checkbox
     public: bool checkboxPrevState{false};
 
-    /// \brief Message for visualizing contact positions
+    /// \brief Message for visualizing contact positions. All contacts are
+    /// drawn by a single triangle list marker, which is reused across
+    /// updates.
     public: ignition::msgs::Marker positionMarkerMsg;
 
+    /// \brief Whether the contacts marker is currently displayed.
+    public: bool markerShown{false};
+
     /// \brief Radius of the visualized contact sphere
     public: double contactRadius{0.10};
 
@@ -110,6 +115,16 @@ VisualizeContacts::VisualizeContacts()
 /////////////////////////////////////////////////
 VisualizeContacts::~VisualizeContacts() = default;
 
+/////////////////////////////////////////////////
+/// \brief Set the lifetime of a marker.
+/// \param[in, out] _msg Marker message.
+/// \param[in] _milliseconds Lifetime in milliseconds.
+static void setLifetime(ignition::msgs::Marker &_msg, int64_t _milliseconds)
+{
+  _msg.mutable_lifetime()->set_sec(_milliseconds / 1000);
+  _msg.mutable_lifetime()->set_nsec((_milliseconds % 1000) * 1000000);
+}
+
 /////////////////////////////////////////////////
 void VisualizeContacts::LoadConfig(const tinyxml2::XMLElement *)
 {
@@ -118,22 +133,22 @@ void VisualizeContacts::LoadConfig(const tinyxml2::XMLElement *)
 
   // Configure Marker messages for position of the contacts
 
-  // Blue spheres for positions
+  // Blue octahedra for positions, all in a single marker
 
   // Create the marker message
   this->dataPtr->positionMarkerMsg.set_ns("positions");
+  this->dataPtr->positionMarkerMsg.set_id(1);
   this->dataPtr->positionMarkerMsg.set_action(
     ignition::msgs::Marker::ADD_MODIFY);
   this->dataPtr->positionMarkerMsg.set_type(
-    ignition::msgs::Marker::SPHERE);
+    ignition::msgs::Marker::TRIANGLE_LIST);
   this->dataPtr->positionMarkerMsg.set_visibility(
     ignition::msgs::Marker::GUI);
-  this->dataPtr->
-    positionMarkerMsg.mutable_lifetime()->
-      set_sec(0);
-  this->dataPtr->
-    positionMarkerMsg.mutable_lifetime()->
-      set_nsec(this->dataPtr->markerLifetime * 1000000);
+
+  // The marker is replaced on every update, the lifetime only removes it
+  // if updates stop
+  setLifetime(this->dataPtr->positionMarkerMsg,
+      2 * this->dataPtr->markerLifetime);
 
   // Set material properties
   ignition::msgs::Set(
@@ -142,12 +157,37 @@ void VisualizeContacts::LoadConfig(const tinyxml2::XMLElement *)
   ignition::msgs::Set(
     this->dataPtr->positionMarkerMsg.mutable_material()->mutable_diffuse(),
     ignition::math::Color(0, 0, 1, 1));
+}
 
-  // Set contact position scale
-  ignition::msgs::Set(this->dataPtr->positionMarkerMsg.mutable_scale(),
-    ignition::math::Vector3d(this->dataPtr->contactRadius,
-    this->dataPtr->contactRadius,
-    this->dataPtr->contactRadius));
+//////////////////////////////////////////////////
+/// \brief Append an octahedron to a triangle list marker.
+/// \param[in, out] _msg Marker message.
+/// \param[in] _center Center of the octahedron.
+/// \param[in] _radius Distance from the center to the vertices.
+static void appendOctahedron(ignition::msgs::Marker &_msg,
+    const ignition::math::Vector3d &_center, double _radius)
+{
+  const ignition::math::Vector3d top =
+      _center + _radius * math::Vector3d::UnitZ;
+  const ignition::math::Vector3d bottom =
+      _center - _radius * math::Vector3d::UnitZ;
+  const ignition::math::Vector3d ring[4] = {
+      _center + _radius * math::Vector3d::UnitX,
+      _center + _radius * math::Vector3d::UnitY,
+      _center - _radius * math::Vector3d::UnitX,
+      _center - _radius * math::Vector3d::UnitY};
+
+  for (int i = 0; i < 4; ++i)
+  {
+    const auto &current = ring[i];
+    const auto &next = ring[(i + 1) % 4];
+    ignition::msgs::Set(_msg.add_point(), current);
+    ignition::msgs::Set(_msg.add_point(), next);
+    ignition::msgs::Set(_msg.add_point(), top);
+    ignition::msgs::Set(_msg.add_point(), next);
+    ignition::msgs::Set(_msg.add_point(), current);
+    ignition::msgs::Set(_msg.add_point(), bottom);
+  }
 }
 
 /////////////////////////////////////////////////
@@ -189,12 +229,14 @@ void VisualizeContacts::Update(const UpdateInfo &_info,
     if (this->dataPtr->checkboxPrevState && !this->dataPtr->checkboxState)
     {
       // Remove the markers
+      this->dataPtr->positionMarkerMsg.clear_point();
       this->dataPtr->positionMarkerMsg.set_action(
         ignition::msgs::Marker::DELETE_ALL);
 
       igndbg << "Removing markers..." << std::endl;
       this->dataPtr->node.Request(
         "/marker", this->dataPtr->positionMarkerMsg);
+      this->dataPtr->markerShown = false;
 
       // Change action in case checkbox is checked again
       this->dataPtr->positionMarkerMsg.set_action(
@@ -218,32 +260,44 @@ void VisualizeContacts::Update(const UpdateInfo &_info,
   this->dataPtr->lastMarkersUpdateTime = _info.simTime;
 
   // Get the contacts and publish them
-  // Since we are setting a lifetime for the markers, we get all the
-  // contacts instead of getting new and removed ones
+  // All contacts are sent in a single marker, which replaces the previous
+  // one, so we get all the contacts instead of getting new and removed ones
+  std::lock_guard<std::mutex> lock(this->dataPtr->serviceMutex);
+  auto &markerMsg = this->dataPtr->positionMarkerMsg;
+  double radius = this->dataPtr->contactRadius * 0.5;
 
-  // Variable for setting the markers id through the iteration
-  int markerID = 1;
+  // Keeps the allocated points for reuse
+  markerMsg.clear_point();
   _ecm.Each<components::ContactSensorData>(
     [&](const Entity &,
         const components::ContactSensorData *_contacts) -> bool
     {
       for (const auto &contact : _contacts->Data().contact())
       {
-        for (int i = 0; i < contact.position_size(); ++i)
+        for (const auto &position : contact.position())
         {
-          // Set marker id, poses and request service
-          this->dataPtr->positionMarkerMsg.set_id(markerID++);
-          ignition::msgs::Set(this->dataPtr->positionMarkerMsg.mutable_pose(),
-            ignition::math::Pose3d(contact.position(i).x(),
-              contact.position(i).y(), contact.position(i).z(),
-              0, 0, 0));
-
-          this->dataPtr->node.Request(
-            "/marker", this->dataPtr->positionMarkerMsg);
+          appendOctahedron(markerMsg, ignition::msgs::Convert(position),
+              radius);
         }
       }
       return true;
     });
+
+  // A marker without points would keep its previous points
+  if (markerMsg.point_size() == 0)
+  {
+    if (this->dataPtr->markerShown)
+    {
+      markerMsg.set_action(ignition::msgs::Marker::DELETE_MARKER);
+      this->dataPtr->node.Request("/marker", markerMsg);
+      markerMsg.set_action(ignition::msgs::Marker::ADD_MODIFY);
+      this->dataPtr->markerShown = false;
+    }
+    return;
+  }
+
+  this->dataPtr->node.Request("/marker", markerMsg);
+  this->dataPtr->markerShown = true;
 }
 
 //////////////////////////////////////////////////
@@ -290,12 +344,6 @@ void VisualizeContacts::UpdateRadius(double _radius)
 {
   std::lock_guard<std::mutex> lock(this->dataPtr->serviceMutex);
   this->dataPtr->contactRadius = _radius;
-
-  // Set scale
-  ignition::msgs::Set(this->dataPtr->positionMarkerMsg.mutable_scale(),
-    ignition::math::Vector3d(this->dataPtr->contactRadius,
-    this->dataPtr->contactRadius,
-    this->dataPtr->contactRadius));
 }
 
 //////////////////////////////////////////////////
@@ -305,8 +353,8 @@ void VisualizeContacts::UpdatePeriod(double _period)
   this->dataPtr->markerLifetime = _period;
 
   // Set markers lifetime
-  this->dataPtr->
-    positionMarkerMsg.mutable_lifetime()->set_nsec(_period * 1000000);
+  setLifetime(this->dataPtr->positionMarkerMsg,
+      2 * static_cast<int64_t>(_period));
 }
 
 // Register this plugin
@@ -17,6 +17,8 @@
 
 #include "VisualizeLidar.hh"
 
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include <utility>
 #include <vector>
@@ -85,8 +87,21 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE
     /// \brief URI sequence to the lidar link
     public: std::string lidarString{""};
 
-    /// \brief LaserScan message from sensor
-    public: msgs::LaserScan msg;
+    /// \brief Ranges of the latest scan, decimated. Reused across scans.
+    public: std::vector<double> ranges;
+
+    /// \brief Minimum wall time between displayed scans, zero to display
+    /// all of them.
+    public: std::chrono::steady_clock::duration scanPeriod{0};
+
+    /// \brief Wall time the last displayed scan arrived.
+    public: std::chrono::steady_clock::time_point lastScanTime;
+
+    /// \brief Display one of every horizontalDecimation horizontal rays.
+    public: unsigned int horizontalDecimation{1u};
+
+    /// \brief Display one of every verticalDecimation vertical rays.
+    public: unsigned int verticalDecimation{1u};
 
     /// \brief Pose of the lidar visual
     public: math::Pose3d lidarPose{math::Pose3d::Zero};
@@ -108,7 +123,7 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE
 
     /// \brief Mutex for variable mutated by the checkbox and spinboxes
     /// callbacks.
-    /// The variables are: msg, visualType, minVisualRange and
+    /// The variables are: ranges, visualType, minVisualRange and
     /// maxVisualRange
     public: std::mutex serviceMutex;
 
@@ -209,11 +224,46 @@ void VisualizeLidar::LoadLidar()
 }
 
 /////////////////////////////////////////////////
-void VisualizeLidar::LoadConfig(const tinyxml2::XMLElement *)
+void VisualizeLidar::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
 {
   if (this->title.empty())
     this->title = "Visualize lidar";
 
+  // Parameters from SDF
+  if (_pluginElem)
+  {
+    auto rateElem = _pluginElem->FirstChildElement("max_rate");
+    if (nullptr != rateElem && nullptr != rateElem->GetText())
+    {
+      double rate{0.0};
+      rateElem->QueryDoubleText(&rate);
+      if (rate > 0.0)
+      {
+        this->dataPtr->scanPeriod =
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / rate));
+      }
+    }
+
+    auto horizontalElem =
+        _pluginElem->FirstChildElement("horizontal_decimation");
+    if (nullptr != horizontalElem && nullptr != horizontalElem->GetText())
+    {
+      horizontalElem->QueryUnsignedText(
+          &this->dataPtr->horizontalDecimation);
+      this->dataPtr->horizontalDecimation =
+          std::max(1u, this->dataPtr->horizontalDecimation);
+    }
+
+    auto verticalElem = _pluginElem->FirstChildElement("vertical_decimation");
+    if (nullptr != verticalElem && nullptr != verticalElem->GetText())
+    {
+      verticalElem->QueryUnsignedText(&this->dataPtr->verticalDecimation);
+      this->dataPtr->verticalDecimation =
+          std::max(1u, this->dataPtr->verticalDecimation);
+    }
+  }
+
   ignition::gui::App()->findChild<
     ignition::gui::MainWindow *>()->installEventFilter(this);
 }
@@ -467,30 +517,65 @@ void VisualizeLidar::SetTopicList(const QStringList &_topicList)
 //////////////////////////////////////////////////
 void VisualizeLidar::OnScan(const msgs::LaserScan &_msg)
 {
+  IGN_PROFILE("VisualizeLidar::OnScan");
+
   std::lock_guard<std::mutex> lock(this->dataPtr->serviceMutex);
+
+  // Drop scans arriving faster than they're meant to be displayed
+  auto now = std::chrono::steady_clock::now();
+  if (now - this->dataPtr->lastScanTime < this->dataPtr->scanPeriod)
+    return;
+
   if (this->dataPtr->initialized)
   {
-    this->dataPtr->msg = std::move(_msg);
+    this->dataPtr->lastScanTime = now;
+
+    // Keep one of every N rays in each direction. Ranges are stored row by
+    // row, one row per vertical ray.
+    unsigned int hStep = this->dataPtr->horizontalDecimation;
+    unsigned int vStep = this->dataPtr->verticalDecimation;
+    unsigned int count = _msg.count();
+    unsigned int verticalCount = std::max(1u, _msg.vertical_count());
+    if (static_cast<uint64_t>(count) * verticalCount >
+        static_cast<uint64_t>(_msg.ranges_size()))
+    {
+      count = _msg.ranges_size();
+      verticalCount = 1u;
+    }
+    unsigned int hCount = (count + hStep - 1) / hStep;
+    unsigned int vCount = (verticalCount + vStep - 1) / vStep;
+
+    this->dataPtr->ranges.clear();
+    this->dataPtr->ranges.reserve(static_cast<std::size_t>(hCount) * vCount);
+    for (unsigned int v = 0; v < verticalCount; v += vStep)
+    {
+      const auto *row = _msg.ranges().data() +
+          static_cast<std::size_t>(v) * count;
+      for (unsigned int h = 0; h < count; h += hStep)
+        this->dataPtr->ranges.push_back(row[h]);
+    }
+
+    double angleMax = hStep > 1 && hCount > 0 ?
+        _msg.angle_min() + (hCount - 1) * hStep * _msg.angle_step() :
+        _msg.angle_max();
+    double verticalAngleMax = vStep > 1 && vCount > 0 ?
+        _msg.vertical_angle_min() +
+        (vCount - 1) * vStep * _msg.vertical_angle_step() :
+        _msg.vertical_angle_max();
+
     this->dataPtr->lidar->SetVerticalRayCount(
-                                  this->dataPtr->msg.vertical_count());
-    this->dataPtr->lidar->SetHorizontalRayCount(
-                                  this->dataPtr->msg.count());
-    this->dataPtr->lidar->SetMinHorizontalAngle(
-                                  this->dataPtr->msg.angle_min());
-    this->dataPtr->lidar->SetMaxHorizontalAngle(
-                                  this->dataPtr->msg.angle_max());
-    this->dataPtr->lidar->SetMinVerticalAngle(
-                                  this->dataPtr->msg.vertical_angle_min());
-    this->dataPtr->lidar->SetMaxVerticalAngle(
-                                  this->dataPtr->msg.vertical_angle_max());
-
-    this->dataPtr->lidar->SetPoints(std::vector<double>(
-                                  this->dataPtr->msg.ranges().begin(),
-                                  this->dataPtr->msg.ranges().end()));
+        _msg.vertical_count() > 0 ? vCount : 0u);
+    this->dataPtr->lidar->SetHorizontalRayCount(hCount);
+    this->dataPtr->lidar->SetMinHorizontalAngle(_msg.angle_min());
+    this->dataPtr->lidar->SetMaxHorizontalAngle(angleMax);
+    this->dataPtr->lidar->SetMinVerticalAngle(_msg.vertical_angle_min());
+    this->dataPtr->lidar->SetMaxVerticalAngle(verticalAngleMax);
+
+    this->dataPtr->lidar->SetPoints(this->dataPtr->ranges);
 
     this->dataPtr->visualDirty = true;
 
-    for (auto data_values : this->dataPtr->msg.header().data())
+    for (const auto &data_values : _msg.header().data())
     {
       if (data_values.key() == "frame_id")
       {
@@ -499,8 +584,8 @@ void VisualizeLidar::OnScan(const msgs::LaserScan &_msg)
         {
           this->dataPtr->lidarString = common::trimmed(data_values.value(0));
           this->dataPtr->lidarEntityDirty = true;
-          this->dataPtr->maxVisualRange = this->dataPtr->msg.range_max();
-          this->dataPtr->minVisualRange = this->dataPtr->msg.range_min();
+          this->dataPtr->maxVisualRange = _msg.range_max();
+          this->dataPtr->minVisualRange = _msg.range_min();
           this->dataPtr->lidar->SetMaxRange(this->dataPtr->maxVisualRange);
           this->dataPtr->lidar->SetMinRange(this->dataPtr->minVisualRange);
           this->MinRangeChanged();
@@ -37,6 +37,16 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE
   /// checkbox to turn visualization of non-hitting rays on or off and
   /// the textfield to select the message to be visualised. The combobox is
   /// used to select the type of visual for the sensor data.
+  ///
+  /// ## Configuration
+  ///
+  /// * `<max_rate>` (optional): Maximum rate in Hz at which scans are
+  /// displayed. Scans arriving faster are dropped before any processing.
+  /// Defaults to 0, which displays all scans.
+  /// * `<horizontal_decimation>` (optional): Only display one of every N
+  /// horizontal rays. Defaults to 1, which displays all rays.
+  /// * `<vertical_decimation>` (optional): Only display one of every N
+  /// vertical rays. Defaults to 1, which displays all rays.
   class VisualizeLidar : public ignition::gazebo::GuiSystem
   {
     Q_OBJECT
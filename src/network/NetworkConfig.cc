@@ -17,6 +17,7 @@
 #include "NetworkConfig.hh"
 
 #include <algorithm>
+#include <string>
 
 #include "ignition/common/Console.hh"
 #include "ignition/common/Util.hh"
@@ -72,6 +73,63 @@ NetworkConfig NetworkConfig::FromValues(const std::string &_role,
         << "network secondaries not set, "
         << "no distributed sim available" << std::endl;
     }
+
+    std::string window;
+    if (common::env("IGN_GAZEBO_NETWORK_STEP_WINDOW", window))
+    {
+      try
+      {
+        config.stepWindow = static_cast<unsigned int>(std::stoul(window));
+      }
+      catch (...)
+      {
+        config.stepWindow = 0;
+      }
+
+      if (config.stepWindow == 0)
+      {
+        ignwarn << "Invalid setting for network step window [" << window
+                << "], expected a positive integer. Using 1." << std::endl;
+        config.stepWindow = 1;
+      }
+    }
+
+    if (common::env("IGN_GAZEBO_NETWORK_RECORD", config.recordPath) &&
+        !config.recordPath.empty())
+    {
+      ignmsg << "Recording network steps to [" << config.recordPath << "]"
+             << std::endl;
+    }
+  }
+
+  if (config.role == NetworkRole::SimulationSecondary &&
+      common::env("IGN_GAZEBO_NETWORK_REPLAY", config.replayPath) &&
+      !config.replayPath.empty())
+  {
+    common::env("IGN_GAZEBO_NETWORK_REPLAY_SECONDARY",
+        config.replaySecondary);
+  }
+
+  std::string sharedMemory;
+  if (config.role != NetworkRole::None &&
+      common::env("IGN_GAZEBO_NETWORK_SHARED_MEMORY", sharedMemory))
+  {
+    config.sharedMemory = sharedMemory == "1" || sharedMemory == "true";
+  }
+
+  // Shared memory bypasses ign-transport, so it can't be recorded
+  if (config.sharedMemory && !config.recordPath.empty())
+  {
+    ignwarn << "Shared memory is disabled while recording network steps."
+            << std::endl;
+    config.sharedMemory = false;
+  }
+
+  std::string spatial;
+  if (config.role != NetworkRole::None &&
+      common::env("IGN_GAZEBO_NETWORK_SPATIAL_PARTITIONING", spatial))
+  {
+    config.spatialPartitioning = spatial == "1" || spatial == "true";
   }
 
   return config;
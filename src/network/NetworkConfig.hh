@@ -43,6 +43,7 @@ namespace ignition
       /// \param[in] _role One of [primary, secondary].
       /// \param[in] _secondaries Number of secondaries the primary should
       /// expect. This is only meaningful if _role == primary.
+      /// Other parameters are populated from environment variables.
       /// \return A NetworkConfig object based on the provided values.
       public: static NetworkConfig FromValues(const std::string &_role,
                                               unsigned int _secondaries = 0);
@@ -52,6 +53,71 @@ namespace ignition
 
       /// \brief Expect number of network secondaries.
       public: size_t numSecondariesExpected { 0 };
+
+      /// \brief Number of iterations between attempts to rebalance
+      /// performers across secondaries. Set to 0 to keep the initial
+      /// assignment for the whole simulation.
+      public: unsigned int rebalancePeriod { 1000 };
+
+      /// \brief Relative step time difference between the slowest and the
+      /// fastest secondaries that triggers a rebalance. For example, 0.25
+      /// means performers will only be migrated if the fastest secondary
+      /// is at least 25% faster than the slowest one. Migrations must also
+      /// reduce the difference by at least this fraction, which avoids
+      /// moving performers back and forth.
+      public: double rebalanceThreshold { 0.25 };
+
+      /// \brief Maximum number of steps the primary may have in flight,
+      /// waiting for acknowledgements from secondaries. With 1, the primary
+      /// waits for all secondaries to finish a step before running its own
+      /// systems. With larger values, the primary runs its systems on
+      /// secondary state which is up to stepWindow - 1 iterations old, and
+      /// secondaries don't have to wait for the primary to start the next
+      /// step. Can be set with the IGN_GAZEBO_NETWORK_STEP_WINDOW
+      /// environment variable.
+      public: unsigned int stepWindow { 1 };
+
+      /// \brief Exchange steps and step acks through shared memory with
+      /// peers running on the same host. Peers on other hosts keep using
+      /// ign-transport. Both the primary and the secondaries must enable it.
+      /// Can be set by setting the IGN_GAZEBO_NETWORK_SHARED_MEMORY
+      /// environment variable to 1.
+      public: bool sharedMemory { false };
+
+      /// \brief Size in bytes of each shared memory queue. Messages which
+      /// don't fit are sent through ign-transport instead.
+      public: size_t sharedMemorySize { 64 * 1024 * 1024 };
+
+      /// \brief Split the world into one region per secondary instead of
+      /// assigning performers by level. Every dynamic model gets a
+      /// performer, and is simulated by the secondary owning the region it
+      /// is in. Can be set by setting the
+      /// IGN_GAZEBO_NETWORK_SPATIAL_PARTITIONING environment variable to 1
+      /// on all peers.
+      public: bool spatialPartitioning { false };
+
+      /// \brief Distance in meters a model must move past the border of
+      /// its region before it's handed off to another secondary.
+      public: double spatialHandoffMargin { 1.0 };
+
+      /// \brief Path of an ign-transport log where the primary records every
+      /// step sent to secondaries and every step ack received from them.
+      /// Shared memory is disabled on the primary while recording, so all
+      /// messages go through ign-transport. Empty to not record. Can be set
+      /// with the IGN_GAZEBO_NETWORK_RECORD environment variable.
+      public: std::string recordPath;
+
+      /// \brief Path of a log recorded by a primary. If set, the secondary
+      /// doesn't wait for a primary and instead runs all steps recorded in
+      /// the log, as fast as possible, then stops. Can be set with the
+      /// IGN_GAZEBO_NETWORK_REPLAY environment variable.
+      public: std::string replayPath;
+
+      /// \brief Prefix of the recorded secondary whose performers are
+      /// simulated during a replay. If empty, the first secondary found in
+      /// the log is used. Can be set with the
+      /// IGN_GAZEBO_NETWORK_REPLAY_SECONDARY environment variable.
+      public: std::string replaySecondary;
     };
     }
   }  // namespace gazebo
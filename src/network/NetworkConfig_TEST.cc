@@ -61,3 +61,115 @@ TEST(NetworkManager, ValueConstructor)
   }
 }
 
+TEST(NetworkManager, StepWindow)
+{
+  {
+    // Primaries default to lockstep
+    auto config = NetworkConfig::FromValues("PRIMARY", 3);
+    EXPECT_EQ(1u, config.stepWindow);
+  }
+
+  {
+    ASSERT_TRUE(ignition::common::setenv("IGN_GAZEBO_NETWORK_STEP_WINDOW",
+        "4"));
+    auto config = NetworkConfig::FromValues("PRIMARY", 3);
+    EXPECT_EQ(4u, config.stepWindow);
+  }
+
+  {
+    // Invalid values fall back to lockstep
+    ASSERT_TRUE(ignition::common::setenv("IGN_GAZEBO_NETWORK_STEP_WINDOW",
+        "0"));
+    auto config = NetworkConfig::FromValues("PRIMARY", 3);
+    EXPECT_EQ(1u, config.stepWindow);
+
+    ASSERT_TRUE(ignition::common::setenv("IGN_GAZEBO_NETWORK_STEP_WINDOW",
+        "banana"));
+    config = NetworkConfig::FromValues("PRIMARY", 3);
+    EXPECT_EQ(1u, config.stepWindow);
+  }
+
+  EXPECT_TRUE(ignition::common::unsetenv("IGN_GAZEBO_NETWORK_STEP_WINDOW"));
+}
+
+TEST(NetworkManager, SharedMemory)
+{
+  {
+    auto config = NetworkConfig::FromValues("SECONDARY");
+    EXPECT_FALSE(config.sharedMemory);
+  }
+
+  ASSERT_TRUE(ignition::common::setenv("IGN_GAZEBO_NETWORK_SHARED_MEMORY",
+      "1"));
+  {
+    auto config = NetworkConfig::FromValues("SECONDARY");
+    EXPECT_TRUE(config.sharedMemory);
+    config = NetworkConfig::FromValues("PRIMARY", 2);
+    EXPECT_TRUE(config.sharedMemory);
+  }
+
+  EXPECT_TRUE(ignition::common::unsetenv("IGN_GAZEBO_NETWORK_SHARED_MEMORY"));
+}
+
+TEST(NetworkManager, SpatialPartitioning)
+{
+  {
+    auto config = NetworkConfig::FromValues("PRIMARY", 2);
+    EXPECT_FALSE(config.spatialPartitioning);
+    EXPECT_LT(0.0, config.spatialHandoffMargin);
+  }
+
+  ASSERT_TRUE(ignition::common::setenv(
+      "IGN_GAZEBO_NETWORK_SPATIAL_PARTITIONING", "true"));
+  {
+    auto config = NetworkConfig::FromValues("PRIMARY", 2);
+    EXPECT_TRUE(config.spatialPartitioning);
+
+    // Not used without distributed simulation
+    config = NetworkConfig::FromValues("");
+    EXPECT_FALSE(config.spatialPartitioning);
+  }
+
+  EXPECT_TRUE(ignition::common::unsetenv(
+      "IGN_GAZEBO_NETWORK_SPATIAL_PARTITIONING"));
+}
+
+
+TEST(NetworkManager, RecordReplay)
+{
+  {
+    auto config = NetworkConfig::FromValues("PRIMARY", 2);
+    EXPECT_TRUE(config.recordPath.empty());
+    config = NetworkConfig::FromValues("SECONDARY");
+    EXPECT_TRUE(config.replayPath.empty());
+    EXPECT_TRUE(config.replaySecondary.empty());
+  }
+
+  ASSERT_TRUE(ignition::common::setenv("IGN_GAZEBO_NETWORK_SHARED_MEMORY",
+      "1"));
+  ASSERT_TRUE(ignition::common::setenv("IGN_GAZEBO_NETWORK_RECORD",
+      "steps.tlog"));
+  ASSERT_TRUE(ignition::common::setenv("IGN_GAZEBO_NETWORK_REPLAY",
+      "steps.tlog"));
+  ASSERT_TRUE(ignition::common::setenv("IGN_GAZEBO_NETWORK_REPLAY_SECONDARY",
+      "abcd1234"));
+  {
+    // Recording needs all messages to go through transport
+    auto config = NetworkConfig::FromValues("PRIMARY", 2);
+    EXPECT_EQ("steps.tlog", config.recordPath);
+    EXPECT_TRUE(config.replayPath.empty());
+    EXPECT_FALSE(config.sharedMemory);
+
+    config = NetworkConfig::FromValues("SECONDARY");
+    EXPECT_TRUE(config.recordPath.empty());
+    EXPECT_EQ("steps.tlog", config.replayPath);
+    EXPECT_EQ("abcd1234", config.replaySecondary);
+    EXPECT_TRUE(config.sharedMemory);
+  }
+
+  EXPECT_TRUE(ignition::common::unsetenv("IGN_GAZEBO_NETWORK_SHARED_MEMORY"));
+  EXPECT_TRUE(ignition::common::unsetenv("IGN_GAZEBO_NETWORK_RECORD"));
+  EXPECT_TRUE(ignition::common::unsetenv("IGN_GAZEBO_NETWORK_REPLAY"));
+  EXPECT_TRUE(ignition::common::unsetenv(
+      "IGN_GAZEBO_NETWORK_REPLAY_SECONDARY"));
+}
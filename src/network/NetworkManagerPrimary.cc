@@ -18,24 +18,34 @@
 #include "NetworkManagerPrimary.hh"
 
 #include <algorithm>
-#include <future>
+#include <chrono>
+#include <cmath>
+#include <regex>
 #include <set>
 #include <string>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
 #include <ignition/common/Profiler.hh>
+#include <ignition/transport/log/Recorder.hh>
 
+#include "msgs/network_metrics.pb.h"
 #include "msgs/peer_control.pb.h"
 #include "msgs/simulation_step.pb.h"
+#include "msgs/step_ack.pb.h"
 
+#include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/PerformerAffinity.hh"
+#include "ignition/gazebo/components/Performer.hh"
 #include "ignition/gazebo/components/PerformerLevels.hh"
 #include "ignition/gazebo/Conversions.hh"
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 #include "ignition/gazebo/Events.hh"
+#include "ignition/gazebo/Util.hh"
 
 #include "NetworkManagerPrivate.hh"
 #include "PeerTracker.hh"
@@ -44,6 +54,10 @@ using namespace ignition;
 using namespace gazebo;
 using namespace std::chrono_literals;
 
+/// \brief Upper bounds in seconds of the step latency histogram buckets.
+static const std::vector<double> kLatencyBounds{
+    0.0005, 0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1.0};
+
 //////////////////////////////////////////////////
 NetworkManagerPrimary::NetworkManagerPrimary(
     const std::function<void(const UpdateInfo &_info)> &_stepFunction,
@@ -55,6 +69,31 @@ NetworkManagerPrimary::NetworkManagerPrimary(
   this->simStepPub = this->node.Advertise<private_msgs::SimulationStep>("step");
 
   this->node.Subscribe("step_ack", &NetworkManagerPrimary::OnStepAck, this);
+
+  this->metricsPub =
+      this->node.Advertise<private_msgs::NetworkMetrics>("metrics");
+
+  const auto &recordPath = this->dataPtr->config.recordPath;
+  if (!recordPath.empty())
+  {
+    // Topics may be prefixed by the node's namespace
+    this->recorder = std::make_unique<transport::log::Recorder>();
+    this->recorder->AddTopic(std::regex(".*/step(_ack)?"));
+    if (this->recorder->Start(recordPath) !=
+        transport::log::RecorderError::SUCCESS)
+    {
+      ignerr << "Failed to record network steps to [" << recordPath << "]"
+             << std::endl;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+NetworkManagerPrimary::~NetworkManagerPrimary()
+{
+  this->sharedMemoryRunning = false;
+  if (this->sharedMemoryThread.joinable())
+    this->sharedMemoryThread.join();
 }
 
 //////////////////////////////////////////////////
@@ -69,6 +108,7 @@ void NetworkManagerPrimary::Handshake()
     auto sc = std::make_unique<SecondaryControl>();
     sc->id = peer;
     sc->prefix = peer.substr(0, 8);
+    sc->latencyCounts.resize(kLatencyBounds.size() + 1, 0u);
 
     bool result;
     std::string topic {sc->prefix + "/control"};
@@ -96,8 +136,73 @@ void NetworkManagerPrimary::Handshake()
              << timeout << " ms" << std::endl;
     }
 
+    // Secondaries on the same host have created shared memory channels
+    if (sc->ready && this->dataPtr->config.sharedMemory)
+    {
+      sc->stepChannel = SharedMemoryChannel::Open(sc->prefix + "_step");
+      sc->ackChannel = SharedMemoryChannel::Open(sc->prefix + "_ack");
+      if (sc->stepChannel && sc->ackChannel)
+      {
+        ignmsg << "Using shared memory to step secondary [" << sc->prefix
+               << "]" << std::endl;
+      }
+      else
+      {
+        sc->stepChannel.reset();
+        sc->ackChannel.reset();
+      }
+    }
+
     this->secondaries[sc->prefix] = std::move(sc);
   }
+
+  bool useSharedMemory = std::any_of(this->secondaries.begin(),
+      this->secondaries.end(), [](const auto &_sc)
+      {
+        return nullptr != _sc.second->ackChannel;
+      });
+  if (useSharedMemory && !this->sharedMemoryThread.joinable())
+  {
+    this->sharedMemoryRunning = true;
+    this->sharedMemoryThread =
+        std::thread(&NetworkManagerPrimary::SharedMemoryLoop, this);
+  }
+}
+
+//////////////////////////////////////////////////
+void NetworkManagerPrimary::SharedMemoryLoop()
+{
+  std::string data;
+  private_msgs::StepAck msg;
+  unsigned int idle{0};
+  while (this->sharedMemoryRunning)
+  {
+    bool received{false};
+    for (const auto &it : this->secondaries)
+    {
+      auto &channel = it.second->ackChannel;
+      while (channel && channel->Read(data))
+      {
+        received = true;
+        if (!msg.ParseFromString(data))
+        {
+          ignerr << "Failed to parse step ack from shared memory."
+                 << std::endl;
+          continue;
+        }
+        this->OnStepAck(msg);
+      }
+    }
+
+    // Spin for a while to keep latency low during simulation, then back off
+    // so an idle primary doesn't hog a core
+    if (received)
+      idle = 0;
+    else if (++idle < 10000)
+      std::this_thread::yield();
+    else
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
 }
 
 //////////////////////////////////////////////////
@@ -143,36 +248,117 @@ bool NetworkManagerPrimary::Step(const UpdateInfo &_info)
   }
 
   // Send step to all secondaries
-  this->secondaryStates.clear();
-  this->secondaryStatesPromise = std::promise<void>{};
-  auto future = this->secondaryStatesPromise.get_future();
-  this->simStepPub.Publish(step);
+  const uint64_t sequence = this->nextSequence++;
+  step.set_sequence(sequence);
+  {
+    std::lock_guard<std::mutex> lock(this->stepMutex);
+    this->pendingStates[sequence];
+    this->sendTimes[sequence] = std::chrono::steady_clock::now();
+  }
+  // Secondaries on the same host get the step through shared memory, the
+  // rest through transport. Secondaries drop duplicates, so everyone gets
+  // the transport message if anyone needs it.
+  bool needTransport{false};
+  bool serialized{false};
+  std::string data;
+  for (const auto &it : this->secondaries)
+  {
+    auto &channel = it.second->stepChannel;
+    if (nullptr == channel)
+    {
+      needTransport = true;
+      continue;
+    }
+    if (!serialized && !(serialized = step.SerializeToString(&data)))
+    {
+      needTransport = true;
+      break;
+    }
+    if (!channel->Write(data))
+    {
+      ignwarn << "Shared memory step queue to secondary [" << it.first
+              << "] is full, falling back to transport." << std::endl;
+      needTransport = true;
+    }
+  }
+  if (needTransport)
+    this->simStepPub.Publish(step);
+
+  {
+    const auto stepBytes = step.ByteSizeLong();
+    std::lock_guard<std::mutex> lock(this->stepMutex);
+    for (auto &it : this->secondaries)
+      it.second->bytesOut += stepBytes;
+  }
 
-  // Block until all secondaries are done
+  // Block until few enough steps are in flight. Secondaries keep working on
+  // later steps while the primary applies the states of earlier ones.
+  std::vector<std::vector<msgs::SerializedStateMap>> completed;
   {
     IGN_PROFILE("Waiting for secondaries");
+    const auto waitStart = std::chrono::steady_clock::now();
 
-    auto result = future.wait_for(10s);
+    const uint64_t window =
+        std::max(1u, this->dataPtr->config.stepWindow);
+    const std::size_t numSecondaries = this->secondaries.size();
 
-    if (std::future_status::ready != result)
+    std::unique_lock<std::mutex> lock(this->stepMutex);
+    uint64_t completedSequence = this->pendingStates.begin()->first - 1;
+    auto done = this->stepCv.wait_for(lock, 10s, [&]
     {
-      ignerr << "Waited 10 s and got only [" << this->secondaryStates.size()
-             << " / " << this->secondaries.size()
-             << "] responses from secondaries. Stopping simulation."
-             << std::endl;
+      // Steps complete in order, as secondaries process them in order
+      while (!this->pendingStates.empty() &&
+          this->pendingStates.begin()->second.size() == numSecondaries)
+      {
+        completedSequence = this->pendingStates.begin()->first;
+        completed.push_back(std::move(this->pendingStates.begin()->second));
+        this->pendingStates.erase(this->pendingStates.begin());
+        this->sendTimes.erase(completedSequence);
+      }
+      return sequence - completedSequence < window;
+    });
+    this->waitTime += std::chrono::steady_clock::now() - waitStart;
+
+    if (!done)
+    {
+      auto oldest = this->pendingStates.begin();
+      ignerr << "Waited 10 s and got only [" << oldest->second.size()
+             << " / " << numSecondaries
+             << "] responses from secondaries for step [" << oldest->first
+             << "]. Stopping simulation." << std::endl;
       this->dataPtr->eventMgr->Emit<events::Stop>();
       return false;
     }
   }
 
-  // Update primary state with states received from secondaries
+  // Update primary state with states received from secondaries. Each
+  // secondary only reports its own performers, so the states of a step touch
+  // disjoint entities and can be merged into a single message, which the ECM
+  // deserializes in parallel.
   {
     IGN_PROFILE("Updating primary state");
-    for (const auto &msg : this->secondaryStates)
+    const auto setStateStart = std::chrono::steady_clock::now();
+    for (auto &states : completed)
     {
-      this->dataPtr->ecm->SetState(msg);
+      if (states.empty())
+        continue;
+
+      auto &merged = states.front();
+      for (auto it = std::next(states.begin()); it != states.end(); ++it)
+      {
+        for (auto &entity : *it->mutable_entities())
+        {
+          (*merged.mutable_entities())[entity.first].Swap(&entity.second);
+        }
+        merged.set_has_one_time_component_changes(
+            merged.has_one_time_component_changes() ||
+            it->has_one_time_component_changes());
+      }
+
+      if (!merged.entities().empty())
+        this->dataPtr->ecm->SetState(merged);
     }
-    this->secondaryStates.clear();
+    this->setStateTime += std::chrono::steady_clock::now() - setStateStart;
   }
 
   // Step all systems
@@ -180,9 +366,60 @@ bool NetworkManagerPrimary::Step(const UpdateInfo &_info)
 
   this->dataPtr->ecm->SetAllComponentsUnchanged();
 
+  this->PublishMetrics();
+
   return true;
 }
 
+//////////////////////////////////////////////////
+void NetworkManagerPrimary::PublishMetrics()
+{
+  if (!this->metricsPub.HasConnections())
+    return;
+
+  const auto now = std::chrono::steady_clock::now();
+  if (now - this->lastMetricsTime < 1s)
+    return;
+  this->lastMetricsTime = now;
+
+  IGN_PROFILE("NetworkManagerPrimary::PublishMetrics");
+
+  std::map<std::string, uint32_t> performerCounts;
+  this->dataPtr->ecm->Each<components::PerformerAffinity>(
+      [&](const Entity &, const components::PerformerAffinity *_affinity)
+      {
+        ++performerCounts[_affinity->Data()];
+        return true;
+      });
+
+  private_msgs::NetworkMetrics msg;
+  msg.set_step_count(this->nextSequence - 1);
+  for (auto bound : kLatencyBounds)
+    msg.add_latency_bounds(bound);
+  msg.set_set_state_time(
+      std::chrono::duration<double>(this->setStateTime).count());
+  msg.set_wait_time(std::chrono::duration<double>(this->waitTime).count());
+
+  {
+    std::lock_guard<std::mutex> lock(this->stepMutex);
+    for (const auto &it : this->secondaries)
+    {
+      const auto &sc = it.second;
+      auto secondaryMsg = msg.add_secondaries();
+      secondaryMsg->set_secondary_prefix(sc->prefix);
+      secondaryMsg->set_step_count(sc->stepCount);
+      for (auto count : sc->latencyCounts)
+        secondaryMsg->add_latency_counts(count);
+      secondaryMsg->set_step_time(sc->stepTime);
+      secondaryMsg->set_bytes_out(sc->bytesOut);
+      secondaryMsg->set_bytes_in(sc->bytesIn);
+      secondaryMsg->set_performer_count(performerCounts[sc->prefix]);
+    }
+  }
+
+  this->metricsPub.Publish(msg);
+}
+
 //////////////////////////////////////////////////
 std::string NetworkManagerPrimary::Namespace() const
 {
@@ -197,13 +434,61 @@ std::map<std::string, SecondaryControl::Ptr>
 }
 
 //////////////////////////////////////////////////
-void NetworkManagerPrimary::OnStepAck(const msgs::SerializedStateMap &_msg)
+void NetworkManagerPrimary::OnStepAck(const private_msgs::StepAck &_msg)
 {
-  this->secondaryStates.push_back(_msg);
-  if (this->secondaryStates.size() == this->secondaries.size())
+  auto it = this->secondaries.find(_msg.secondary_prefix());
+  if (it == this->secondaries.end())
   {
-    this->secondaryStatesPromise.set_value();
+    ignerr << "Received step ack from unknown secondary ["
+           << _msg.secondary_prefix() << "]." << std::endl;
+    return;
   }
+  auto &sc = it->second;
+
+  std::lock_guard<std::mutex> lock(this->stepMutex);
+
+  // Each secondary acks steps in order, anything else is a duplicate or a
+  // late response to a step we already gave up on
+  if (_msg.sequence() != sc->ackedSequence + 1)
+  {
+    ignwarn << "Ignoring ack for step [" << _msg.sequence()
+            << "] from secondary [" << sc->prefix << "], expected step ["
+            << sc->ackedSequence + 1 << "]." << std::endl;
+    return;
+  }
+
+  auto pending = this->pendingStates.find(_msg.sequence());
+  if (pending == this->pendingStates.end())
+  {
+    ignwarn << "Ignoring ack for unknown step [" << _msg.sequence()
+            << "] from secondary [" << sc->prefix << "]." << std::endl;
+    return;
+  }
+
+  sc->ackedSequence = _msg.sequence();
+  pending->second.push_back(_msg.state());
+
+  ++sc->stepCount;
+  sc->bytesIn += _msg.ByteSizeLong();
+  auto sent = this->sendTimes.find(_msg.sequence());
+  if (sent != this->sendTimes.end())
+  {
+    const double latency = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - sent->second).count();
+    auto bucket = std::lower_bound(kLatencyBounds.begin(),
+        kLatencyBounds.end(), latency) - kLatencyBounds.begin();
+    ++sc->latencyCounts[bucket];
+  }
+
+  // Smooth out step times so a single slow iteration doesn't trigger a
+  // rebalance
+  if (sc->stepSamples == 0)
+    sc->stepTime = _msg.step_time();
+  else
+    sc->stepTime += 0.1 * (_msg.step_time() - sc->stepTime);
+  ++sc->stepSamples;
+
+  this->stepCv.notify_one();
 }
 
 //////////////////////////////////////////////////
@@ -222,6 +507,12 @@ void NetworkManagerPrimary::PopulateAffinities(
 {
   IGN_PROFILE("NetworkManagerPrimary::PopulateAffinities");
 
+  if (this->dataPtr->config.spatialPartitioning)
+  {
+    this->PopulateSpatialAffinities(_msg);
+    return;
+  }
+
   // p: performer
   // l: level
   // s: secondary
@@ -301,6 +592,240 @@ void NetworkManagerPrimary::PopulateAffinities(
   }
 
   // TODO(louise) Process level changes
+
+  this->RebalanceAffinities(_msg);
+}
+
+//////////////////////////////////////////////////
+void NetworkManagerPrimary::RebalanceAffinities(
+    private_msgs::SimulationStep &_msg)
+{
+  const auto &config = this->dataPtr->config;
+  if (config.rebalancePeriod == 0 || this->secondaries.size() < 2)
+    return;
+
+  if (++this->iterationsSinceRebalance < config.rebalancePeriod)
+    return;
+
+  IGN_PROFILE("NetworkManagerPrimary::RebalanceAffinities");
+
+  std::lock_guard<std::mutex> lock(this->stepMutex);
+
+  // Wait until all secondaries have reported step times since the last
+  // migration
+  SecondaryControl *slowest{nullptr};
+  SecondaryControl *fastest{nullptr};
+  for (const auto &it : this->secondaries)
+  {
+    auto sc = it.second.get();
+    if (sc->stepSamples == 0)
+      return;
+
+    if (nullptr == slowest || sc->stepTime > slowest->stepTime)
+      slowest = sc;
+    if (nullptr == fastest || sc->stepTime < fastest->stepTime)
+      fastest = sc;
+  }
+  this->iterationsSinceRebalance = 0;
+
+  const double gap = slowest->stepTime - fastest->stepTime;
+  if (gap <= slowest->stepTime * config.rebalanceThreshold)
+    return;
+
+  // Group the slowest secondary's performers which share levels, since
+  // they're expected to interact and must be simulated together. The cost
+  // of each group is estimated from the number of entities it holds.
+  struct PerformerGroup
+  {
+    std::set<Entity> performers;
+    std::set<Entity> levels;
+    std::size_t entityCount{0};
+  };
+  std::vector<PerformerGroup> groups;
+  std::size_t totalEntityCount{0};
+
+  this->dataPtr->ecm->Each<
+        components::PerformerAffinity,
+        components::PerformerLevels,
+        components::ParentEntity>(
+    [&](const Entity &_entity,
+        const components::PerformerAffinity *_affinity,
+        const components::PerformerLevels *_perfLevels,
+        const components::ParentEntity *_parent) -> bool
+    {
+      if (_affinity->Data() != slowest->prefix)
+        return true;
+
+      PerformerGroup group;
+      group.performers.insert(_entity);
+      group.levels = _perfLevels->Data();
+      group.entityCount =
+          this->dataPtr->ecm->Descendants(_parent->Data()).size();
+      totalEntityCount += group.entityCount;
+
+      // Merge with all existing groups that share a level
+      for (auto it = groups.begin(); it != groups.end();)
+      {
+        bool shared = std::any_of(it->levels.begin(), it->levels.end(),
+            [&](const Entity &_level)
+            {
+              return group.levels.count(_level) > 0;
+            });
+        if (!shared)
+        {
+          ++it;
+          continue;
+        }
+
+        group.performers.insert(it->performers.begin(), it->performers.end());
+        group.levels.insert(it->levels.begin(), it->levels.end());
+        group.entityCount += it->entityCount;
+        it = groups.erase(it);
+      }
+      groups.push_back(std::move(group));
+
+      return true;
+    });
+
+  if (groups.size() < 2 || totalEntityCount == 0)
+    return;
+
+  // Pick the group which brings both secondaries closest together. Moving a
+  // group of cost c turns the gap into |gap - 2c|. Skip moves which don't
+  // reduce the gap meaningfully, so performers don't bounce back and forth.
+  const PerformerGroup *best{nullptr};
+  double bestGap = gap * (1.0 - config.rebalanceThreshold);
+  for (const auto &group : groups)
+  {
+    double cost = slowest->stepTime * group.entityCount / totalEntityCount;
+    double newGap = std::abs(gap - 2.0 * cost);
+    if (newGap < bestGap)
+    {
+      bestGap = newGap;
+      best = &group;
+    }
+  }
+
+  if (nullptr == best)
+    return;
+
+  ignmsg << "Migrating [" << best->performers.size()
+         << "] performers from secondary [" << slowest->prefix << "] ("
+         << slowest->stepTime << " s / step) to secondary ["
+         << fastest->prefix << "] (" << fastest->stepTime << " s / step)."
+         << std::endl;
+
+  for (const auto &performer : best->performers)
+  {
+    auto affinityMsg = _msg.add_affinity();
+    this->SetAffinity(performer, fastest->prefix, affinityMsg);
+    this->AddMigrationState(performer, affinityMsg);
+  }
+
+  // Timings from before the migration no longer apply
+  slowest->stepSamples = 0;
+  fastest->stepSamples = 0;
+}
+
+//////////////////////////////////////////////////
+void NetworkManagerPrimary::PopulateSpatialAffinities(
+    private_msgs::SimulationStep &_msg)
+{
+  IGN_PROFILE("NetworkManagerPrimary::PopulateSpatialAffinities");
+
+  auto &ecm = *this->dataPtr->ecm;
+
+  struct PerformerPosition
+  {
+    Entity performer;
+    math::Vector3d position;
+    std::string secondary;
+  };
+  std::vector<PerformerPosition> performers;
+
+  ecm.Each<components::Performer, components::ParentEntity>(
+    [&](const Entity &_entity, const components::Performer *,
+        const components::ParentEntity *_parent) -> bool
+    {
+      PerformerPosition info{_entity,
+          worldPose(_parent->Data(), ecm).Pos(), ""};
+      auto affinity = ecm.Component<components::PerformerAffinity>(_entity);
+      if (affinity)
+        info.secondary = affinity->Data();
+      performers.push_back(info);
+      return true;
+    });
+
+  if (performers.empty())
+    return;
+
+  // Regions are assigned to secondaries in order
+  std::vector<std::string> owners;
+  for (const auto &it : this->secondaries)
+    owners.push_back(it.first);
+
+  // Balance regions according to where models start, regions are kept for
+  // the rest of the simulation
+  if (this->partition.RegionCount() == 0)
+  {
+    std::vector<math::Vector3d> positions;
+    for (const auto &info : performers)
+      positions.push_back(info.position);
+    this->partition.Build(positions, owners.size());
+
+    for (std::size_t r = 0; r < this->partition.RegionCount(); ++r)
+    {
+      math::Vector3d min, max;
+      this->partition.Bounds(r, min, max);
+      ignmsg << "Secondary [" << owners[r] << "] owns region [" << min.X()
+             << ", " << min.Y() << "] - [" << max.X() << ", " << max.Y()
+             << "]" << std::endl;
+    }
+  }
+
+  for (const auto &info : performers)
+  {
+    // Keep models which are just past the border of their region with the
+    // same secondary, so they don't bounce back and forth
+    auto ownerIt = std::find(owners.begin(), owners.end(), info.secondary);
+    if (ownerIt != owners.end() && this->partition.Contains(
+          static_cast<std::size_t>(ownerIt - owners.begin()), info.position,
+          this->dataPtr->config.spatialHandoffMargin))
+    {
+      continue;
+    }
+
+    const auto &owner = owners[this->partition.Region(info.position)];
+    if (owner == info.secondary)
+      continue;
+
+    auto affinityMsg = _msg.add_affinity();
+    this->SetAffinity(info.performer, owner, affinityMsg);
+
+    // Handing off from another secondary
+    if (!info.secondary.empty())
+    {
+      igndbg << "Handing off performer [" << info.performer
+             << "] from secondary [" << info.secondary << "] to ["
+             << owner << "]" << std::endl;
+      this->AddMigrationState(info.performer, affinityMsg);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void NetworkManagerPrimary::AddMigrationState(Entity _performer,
+    private_msgs::PerformerAffinity *_msg)
+{
+  // The new secondary may have removed the performer's entities, so send
+  // everything it needs to recreate them
+  auto parent =
+      this->dataPtr->ecm->Component<components::ParentEntity>(_performer);
+  if (nullptr == parent)
+    return;
+
+  auto entities = this->dataPtr->ecm->Descendants(parent->Data());
+  this->dataPtr->ecm->State(*_msg->mutable_state(), entities, {}, true);
 }
 
 //////////////////////////////////////////////////
@@ -18,10 +18,14 @@
 #define IGNITION_GAZEBO_NETWORK_NETWORKMANAGERPRIMARY_HH_
 
 #include <atomic>
-#include <future>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <ignition/gazebo/config.hh>
@@ -30,11 +34,25 @@
 #include <ignition/transport/Node.hh>
 
 #include "msgs/simulation_step.pb.h"
+#include "msgs/step_ack.pb.h"
 
 #include "NetworkManager.hh"
+#include "SharedMemoryChannel.hh"
+#include "SpatialPartition.hh"
 
 namespace ignition
 {
+  namespace transport
+  {
+    namespace log
+    {
+      inline namespace IGNITION_TRANSPORT_VERSION_NAMESPACE {
+      // Forward declarations.
+      class Recorder;
+      }
+    }
+  }
+
   namespace gazebo
   {
     // Inline bracket to help doxygen filtering.
@@ -50,6 +68,37 @@ namespace ignition
       /// \brief prefix namespace of the secondary peer
       std::string prefix;
 
+      /// \brief Exponential moving average of the wall time in seconds the
+      /// secondary takes to run a step.
+      double stepTime{0.0};
+
+      /// \brief Number of step times accumulated into stepTime since the
+      /// last time the secondary's performers changed.
+      unsigned int stepSamples{0};
+
+      /// \brief Sequence number of the last step acknowledged by the
+      /// secondary.
+      uint64_t ackedSequence{0};
+
+      /// \brief Sends steps to the secondary, if it's on the same host.
+      std::unique_ptr<SharedMemoryChannel> stepChannel;
+
+      /// \brief Receives step acks from the secondary, if it's on the same
+      /// host.
+      std::unique_ptr<SharedMemoryChannel> ackChannel;
+
+      /// \brief Number of step acks received.
+      uint64_t stepCount{0};
+
+      /// \brief Number of acks in each step latency bucket.
+      std::vector<uint64_t> latencyCounts;
+
+      /// \brief Serialized bytes of steps sent.
+      uint64_t bytesOut{0};
+
+      /// \brief Serialized bytes of acks received.
+      uint64_t bytesIn{0};
+
       /// \brief Convenience alias for unique_ptr.
       using Ptr = std::unique_ptr<SecondaryControl>;
     };
@@ -67,6 +116,9 @@ namespace ignition
           const NetworkConfig &_config,
           const NodeOptions &_options);
 
+      /// \brief Destructor.
+      public: ~NetworkManagerPrimary() override;
+
       // Documentation inherited
       public: void Handshake() override;
 
@@ -88,9 +140,24 @@ namespace ignition
       /// peers.
       public: std::map<std::string, SecondaryControl::Ptr>& Secondaries();
 
+      /// \brief Migrate performers from the slowest secondary to the fastest
+      /// one if their step times are too far apart. This is only attempted
+      /// every NetworkConfig::rebalancePeriod iterations, and only once all
+      /// secondaries reported step times since the last migration.
+      /// \param[in] _msg Step message, where migrated affinities are added.
+      public: void RebalanceAffinities(private_msgs::SimulationStep &_msg);
+
       /// \brief Callback for step ack messages.
       /// \param[in] _msg Message containing secondary's updated state.
-      private: void OnStepAck(const msgs::SerializedStateMap &_msg);
+      private: void OnStepAck(const private_msgs::StepAck &_msg);
+
+      /// \brief Poll the shared memory ack channels of all secondaries, run
+      /// from sharedMemoryThread.
+      private: void SharedMemoryLoop();
+
+      /// \brief Publish profiling counters, if anyone is listening and enough
+      /// time passed since they were last published.
+      private: void PublishMetrics();
 
       /// \brief Check if the step publisher has connections.
       private: bool SecondariesCanStep() const;
@@ -100,6 +167,20 @@ namespace ignition
       /// \param[in] _msg Step message.
       private: void PopulateAffinities(private_msgs::SimulationStep &_msg);
 
+      /// \brief Populate the step message with performers which moved into
+      /// another secondary's region. Used instead of level based affinities
+      /// when NetworkConfig::spatialPartitioning is set.
+      /// \param[in] _msg Step message.
+      private: void PopulateSpatialAffinities(
+          private_msgs::SimulationStep &_msg);
+
+      /// \brief Add the full state of a performer's model to an affinity
+      /// message, so a secondary which doesn't have it can recreate it.
+      /// \param[in] _performer Performer entity.
+      /// \param[out] _msg Affinity message to be populated.
+      private: void AddMigrationState(Entity _performer,
+          private_msgs::PerformerAffinity *_msg);
+
       /// \brief Set the performer to secondary affinity.
       /// \param[in] _performer Performer entity.
       /// \param[in] _secondary Secondary identifier.
@@ -116,11 +197,55 @@ namespace ignition
       /// \brief Publisher for network step sync
       private: ignition::transport::Node::Publisher simStepPub;
 
-      /// \brief Keep track of states received from secondaries.
-      private: std::vector<msgs::SerializedStateMap> secondaryStates;
+      /// \brief States received from secondaries for each step in flight,
+      /// keyed by step sequence number.
+      private: std::map<uint64_t, std::vector<msgs::SerializedStateMap>>
+          pendingStates;
+
+      /// \brief Time at which each step in flight was sent, keyed by step
+      /// sequence number.
+      private: std::map<uint64_t, std::chrono::steady_clock::time_point>
+          sendTimes;
+
+      /// \brief Sequence number to be used by the next step.
+      private: uint64_t nextSequence{1};
+
+      /// \brief Protects pendingStates and the step timings and sequence
+      /// numbers of secondaries, which are updated from transport threads.
+      private: std::mutex stepMutex;
+
+      /// \brief Notified whenever a step ack is received.
+      private: std::condition_variable stepCv;
+
+      /// \brief Thread waiting for acks on shared memory channels.
+      private: std::thread sharedMemoryThread;
+
+      /// \brief Tells sharedMemoryThread to stop.
+      private: std::atomic<bool> sharedMemoryRunning{false};
+
+      /// \brief Regions owned by each secondary, with the same order as
+      /// secondaries. Empty unless using spatial partitioning.
+      private: SpatialPartition partition;
+
+      /// \brief Iterations since performers were last considered for
+      /// rebalancing.
+      private: unsigned int iterationsSinceRebalance{0};
+
+      /// \brief Publisher for profiling counters.
+      private: ignition::transport::Node::Publisher metricsPub;
+
+      /// \brief Wall time at which metrics were last published.
+      private: std::chrono::steady_clock::time_point lastMetricsTime;
+
+      /// \brief Total time spent applying secondary states to the ECM.
+      private: std::chrono::steady_clock::duration setStateTime{0};
+
+      /// \brief Total time spent waiting for secondaries.
+      private: std::chrono::steady_clock::duration waitTime{0};
 
-      /// \brief Promise used to notify when all secondaryStates where received.
-      private: std::promise<void> secondaryStatesPromise;
+      /// \brief Records steps and step acks if NetworkConfig::recordPath is
+      /// set.
+      private: std::unique_ptr<transport::log::Recorder> recorder;
     };
     }
   }  // namespace gazebo
@@ -16,13 +16,18 @@
 */
 
 #include <algorithm>
+#include <chrono>
+#include <map>
 #include <string>
+#include <vector>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
 #include <ignition/common/Profiler.hh>
+#include <ignition/transport/log/Log.hh>
 
 #include "msgs/peer_control.pb.h"
+#include "msgs/step_ack.pb.h"
 
 #include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/Conversions.hh"
@@ -61,12 +66,48 @@ NetworkManagerSecondary::NetworkManagerSecondary(
 
   this->node.Subscribe("step", &NetworkManagerSecondary::OnStep, this);
 
-  this->stepAckPub = this->node.Advertise<msgs::SerializedStateMap>("step_ack");
+  this->stepAckPub =
+      this->node.Advertise<private_msgs::StepAck>("step_ack");
+
+  // The primary opens these channels if it's on the same host
+  if (this->dataPtr->config.sharedMemory)
+  {
+    this->stepChannel = SharedMemoryChannel::Create(this->Namespace() + "_step",
+        this->dataPtr->config.sharedMemorySize);
+    this->ackChannel = SharedMemoryChannel::Create(this->Namespace() + "_ack",
+        this->dataPtr->config.sharedMemorySize);
+    if (this->stepChannel && this->ackChannel)
+    {
+      igndbg << "Secondary [" << this->Namespace()
+             << "] listening for steps on shared memory segment ["
+             << this->stepChannel->SegmentName() << "]" << std::endl;
+      this->sharedMemoryRunning = true;
+      this->sharedMemoryThread =
+          std::thread(&NetworkManagerSecondary::SharedMemoryLoop, this);
+    }
+    else
+    {
+      this->stepChannel.reset();
+      this->ackChannel.reset();
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+NetworkManagerSecondary::~NetworkManagerSecondary()
+{
+  this->sharedMemoryRunning = false;
+  if (this->sharedMemoryThread.joinable())
+    this->sharedMemoryThread.join();
 }
 
 //////////////////////////////////////////////////
 bool NetworkManagerSecondary::Ready() const
 {
+  // Replays don't need a primary
+  if (!this->dataPtr->config.replayPath.empty())
+    return true;
+
   // The detected number of peers in the "Primary" role must be 1
   auto primaries = this->dataPtr->tracker->NumPrimary();
   return (primaries == 1);
@@ -75,6 +116,12 @@ bool NetworkManagerSecondary::Ready() const
 //////////////////////////////////////////////////
 void NetworkManagerSecondary::Handshake()
 {
+  if (!this->dataPtr->config.replayPath.empty())
+  {
+    this->Replay();
+    return;
+  }
+
   while (!this->enableSim && !this->dataPtr->stopReceived)
   {
     std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -96,11 +143,139 @@ bool NetworkManagerSecondary::OnControl(const private_msgs::PeerControl &_req,
   return true;
 }
 
+//////////////////////////////////////////////////
+void NetworkManagerSecondary::SharedMemoryLoop()
+{
+  std::string data;
+  private_msgs::SimulationStep msg;
+  unsigned int idle{0};
+  while (this->sharedMemoryRunning)
+  {
+    if (!this->stepChannel->Read(data))
+    {
+      // Spin for a while to keep latency low during simulation, then back
+      // off so an idle secondary doesn't hog a core
+      if (++idle < 10000)
+        std::this_thread::yield();
+      else
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      continue;
+    }
+    idle = 0;
+
+    if (!msg.ParseFromString(data))
+    {
+      ignerr << "Failed to parse step from shared memory." << std::endl;
+      continue;
+    }
+    this->ProcessStep(msg, true);
+  }
+}
+
+/////////////////////////////////////////////////
+void NetworkManagerSecondary::Replay()
+{
+  IGN_PROFILE("NetworkManagerSecondary::Replay");
+
+  const auto &path = this->dataPtr->config.replayPath;
+  std::string recorded = this->dataPtr->config.replaySecondary;
+
+  // Recorded step times of the replayed secondary, keyed by step sequence
+  std::map<uint64_t, double> recordedTimes;
+  std::map<uint64_t, private_msgs::SimulationStep> steps;
+
+  transport::log::Log log;
+  if (!log.Open(path))
+  {
+    ignerr << "Failed to open network log [" << path << "]" << std::endl;
+  }
+  else
+  {
+    for (const auto &message : log.QueryMessages())
+    {
+      if (message.Type() == "ignition.gazebo.private_msgs.SimulationStep")
+      {
+        private_msgs::SimulationStep step;
+        if (step.ParseFromString(message.Data()))
+          steps[step.sequence()] = std::move(step);
+      }
+      else if (message.Type() == "ignition.gazebo.private_msgs.StepAck")
+      {
+        private_msgs::StepAck ack;
+        if (!ack.ParseFromString(message.Data()))
+          continue;
+        if (recorded.empty())
+          recorded = ack.secondary_prefix();
+        if (ack.secondary_prefix() == recorded)
+          recordedTimes[ack.sequence()] = ack.step_time();
+      }
+    }
+  }
+
+  if (recorded.empty() || steps.empty())
+  {
+    ignerr << "No steps to replay found in network log [" << path << "]"
+           << std::endl;
+  }
+  else
+  {
+    ignmsg << "Secondary [" << this->Namespace() << "] replaying ["
+           << steps.size() << "] steps of secondary [" << recorded
+           << "] from [" << path << "]" << std::endl;
+  }
+
+  double replayedTotal{0.0};
+  double recordedTotal{0.0};
+  std::size_t compared{0};
+  for (auto &it : steps)
+  {
+    if (this->dataPtr->stopReceived)
+      break;
+
+    auto &step = it.second;
+
+    // Take over the performers of the recorded secondary
+    for (auto &affinity : *step.mutable_affinity())
+    {
+      if (affinity.secondary_prefix() == recorded)
+        affinity.set_secondary_prefix(this->Namespace());
+    }
+
+    this->ProcessStep(step, false);
+
+    auto recordedTime = recordedTimes.find(it.first);
+    if (recordedTime != recordedTimes.end())
+    {
+      recordedTotal += recordedTime->second;
+      replayedTotal += this->lastStepTime;
+      ++compared;
+    }
+  }
+
+  if (compared > 0)
+  {
+    ignmsg << "Replayed [" << compared << "] steps in an average of ["
+           << replayedTotal / compared << "] s, recorded average was ["
+           << recordedTotal / compared << "] s." << std::endl;
+  }
+
+  if (this->dataPtr->eventMgr)
+    this->dataPtr->eventMgr->Emit<events::Stop>();
+}
+
 /////////////////////////////////////////////////
 void NetworkManagerSecondary::OnStep(
     const private_msgs::SimulationStep &_msg)
+{
+  this->ProcessStep(_msg, false);
+}
+
+/////////////////////////////////////////////////
+void NetworkManagerSecondary::ProcessStep(
+    const private_msgs::SimulationStep &_msg, bool _sharedMemory)
 {
   IGN_PROFILE("NetworkManagerSecondary::OnStep");
+  std::lock_guard<std::mutex> lock(this->stepMutex);
 
   // Throttle the number of step messages going to the debug output.
   if (!_msg.stats().paused() && _msg.stats().iterations() % 1000 == 0)
@@ -109,6 +284,22 @@ void NetworkManagerSecondary::OnStep(
            << std::endl;
   }
 
+  // Steps are processed in order, drop anything we've already seen
+  if (_msg.sequence() <= this->lastSequence)
+  {
+    ignwarn << "Secondary [" << this->Namespace() << "] ignoring step ["
+            << _msg.sequence() << "], already processed step ["
+            << this->lastSequence << "]." << std::endl;
+    return;
+  }
+  if (_msg.sequence() != this->lastSequence + 1)
+  {
+    ignwarn << "Secondary [" << this->Namespace() << "] missed steps ["
+            << this->lastSequence + 1 << " - " << _msg.sequence() - 1
+            << "]." << std::endl;
+  }
+  this->lastSequence = _msg.sequence();
+
   // Update affinities
   for (int i = 0; i < _msg.affinity_size(); ++i)
   {
@@ -119,6 +310,10 @@ void NetworkManagerSecondary::OnStep(
     {
       this->performers.insert(entityId);
 
+      // Performer migrated from another secondary, recreate its entities
+      if (affinityMsg.has_state())
+        this->dataPtr->ecm->SetState(affinityMsg.state());
+
       ignmsg << "Secondary [" << this->Namespace()
              << "] assigned affinity to performer [" << entityId << "]."
              << std::endl;
@@ -126,9 +321,11 @@ void NetworkManagerSecondary::OnStep(
     // If performer has been assigned to another secondary, remove it
     else
     {
+      // The performer may have already been removed
       auto parent =
           this->dataPtr->ecm->Component<components::ParentEntity>(entityId);
-      this->dataPtr->ecm->RequestRemoveEntity(parent->Data());
+      if (parent)
+        this->dataPtr->ecm->RequestRemoveEntity(parent->Data());
 
       if (this->performers.find(entityId) != this->performers.end())
       {
@@ -144,7 +341,11 @@ void NetworkManagerSecondary::OnStep(
   auto info = convert<UpdateInfo>(_msg.stats());
 
   // Step runner
+  auto stepStart = std::chrono::steady_clock::now();
   this->dataPtr->stepFunction(info);
+  std::chrono::duration<double> stepTime =
+      std::chrono::steady_clock::now() - stepStart;
+  this->lastStepTime = stepTime.count();
 
   // Update state with all the performer's entities
   std::unordered_set<Entity> entities;
@@ -164,13 +365,24 @@ void NetworkManagerSecondary::OnStep(
     entities.insert(children.begin(), children.end());
   }
 
-  msgs::SerializedStateMap stateMsg;
+  private_msgs::StepAck ackMsg;
+  ackMsg.set_secondary_prefix(this->Namespace());
+  ackMsg.set_step_time(stepTime.count());
+  ackMsg.set_sequence(_msg.sequence());
+
+  auto stateMsg = ackMsg.mutable_state();
   if (!entities.empty())
-    this->dataPtr->ecm->State(stateMsg, entities);
-  stateMsg.set_has_one_time_component_changes(
+    this->dataPtr->ecm->State(*stateMsg, entities);
+  stateMsg->set_has_one_time_component_changes(
     this->dataPtr->ecm->HasOneTimeComponentChanges());
 
-  this->stepAckPub.Publish(stateMsg);
+  // Fall back to transport if the ack doesn't fit in shared memory
+  std::string data;
+  if (!_sharedMemory || !ackMsg.SerializeToString(&data) ||
+      !this->ackChannel->Write(data))
+  {
+    this->stepAckPub.Publish(ackMsg);
+  }
 
   this->dataPtr->ecm->SetAllComponentsUnchanged();
 }
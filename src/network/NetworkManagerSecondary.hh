@@ -18,8 +18,11 @@
 #define IGNITION_GAZEBO_NETWORK_NETWORKMANAGERSECONDARY_HH_
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_set>
 
 #include <ignition/gazebo/config.hh>
@@ -30,6 +33,7 @@
 #include "msgs/peer_control.pb.h"
 
 #include "NetworkManager.hh"
+#include "SharedMemoryChannel.hh"
 
 namespace ignition
 {
@@ -50,6 +54,9 @@ namespace ignition
           const NetworkConfig &_config,
           const NodeOptions &_options);
 
+      /// \brief Destructor.
+      public: ~NetworkManagerSecondary() override;
+
       // Documentation inherited
       public: bool Ready() const override;
 
@@ -70,6 +77,21 @@ namespace ignition
       /// \param[in] _msg Step message.
       private: void OnStep(const private_msgs::SimulationStep &_msg);
 
+      /// \brief Run a step received from the primary and ack it.
+      /// \param[in] _msg Step message.
+      /// \param[in] _sharedMemory True if the step was received through
+      /// shared memory, in which case the ack is sent back the same way.
+      private: void ProcessStep(const private_msgs::SimulationStep &_msg,
+          bool _sharedMemory);
+
+      /// \brief Poll the shared memory step channel, run from
+      /// sharedMemoryThread.
+      private: void SharedMemoryLoop();
+
+      /// \brief Run all steps recorded in NetworkConfig::replayPath as the
+      /// recorded secondary, then stop simulation.
+      private: void Replay();
+
       /// \brief Flag to control enabling/disabling simulation secondary.
       private: std::atomic<bool> enableSim {false};
 
@@ -81,6 +103,29 @@ namespace ignition
 
       /// \brief Collection of performers associated with this secondary.
       private: std::unordered_set<Entity> performers;
+
+      /// \brief Sequence number of the last step processed.
+      private: uint64_t lastSequence{0};
+
+      /// \brief Wall clock time in seconds spent running systems on the last
+      /// step processed.
+      private: double lastStepTime{0.0};
+
+      /// \brief Steps may be received through both transport and shared
+      /// memory, make sure they're processed one at a time.
+      private: std::mutex stepMutex;
+
+      /// \brief Receives steps from the primary, if it's on the same host.
+      private: std::unique_ptr<SharedMemoryChannel> stepChannel;
+
+      /// \brief Sends step acks to the primary, if it's on the same host.
+      private: std::unique_ptr<SharedMemoryChannel> ackChannel;
+
+      /// \brief Thread waiting for steps on stepChannel.
+      private: std::thread sharedMemoryThread;
+
+      /// \brief Tells sharedMemoryThread to stop.
+      private: std::atomic<bool> sharedMemoryRunning{false};
     };
     }
   }  // namespace gazebo
@@ -18,9 +18,18 @@
 #include <gtest/gtest.h>
 
 #include <cstdlib>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
 #include <ignition/common/Console.hh>
 
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Performer.hh"
+#include "ignition/gazebo/components/PerformerAffinity.hh"
+#include "ignition/gazebo/components/PerformerLevels.hh"
+#include "msgs/simulation_step.pb.h"
 #include "NetworkManager.hh"
 #include "NetworkManagerPrimary.hh"
 #include "NetworkManagerSecondary.hh"
@@ -31,6 +40,39 @@ void step(const UpdateInfo &)
 {
 }
 
+/// \brief Create a performer with a model of a few entities.
+/// \param[in] _ecm Entity component manager.
+/// \param[in] _secondary Prefix of the secondary running the performer.
+/// \param[in] _level Level the performer is in.
+/// \return The performer.
+Entity createPerformer(EntityComponentManager &_ecm,
+    const std::string &_secondary, Entity _level)
+{
+  auto model = _ecm.CreateEntity();
+  for (int i = 0; i < 4; ++i)
+  {
+    auto link = _ecm.CreateEntity();
+    _ecm.CreateComponent(link, components::ParentEntity(model));
+  }
+
+  auto performer = _ecm.CreateEntity();
+  _ecm.CreateComponent(performer, components::Performer());
+  _ecm.CreateComponent(performer, components::ParentEntity(model));
+  _ecm.CreateComponent(performer, components::PerformerAffinity(_secondary));
+  _ecm.CreateComponent(performer,
+      components::PerformerLevels(std::set<Entity>{_level}));
+  return performer;
+}
+
+/// \brief Set a secondary's step time as if it was reported for a while.
+/// \param[in] _sc Secondary.
+/// \param[in] _stepTime Step time in seconds.
+void reportStepTime(SecondaryControl &_sc, double _stepTime)
+{
+  _sc.stepTime = _stepTime;
+  _sc.stepSamples = 10;
+}
+
 //////////////////////////////////////////////////
 TEST(NetworkManager, ConfigConstructor)
 {
@@ -261,3 +303,92 @@ TEST(NetworkManager, Step)
 
   EXPECT_FALSE(running);
 }
+
+//////////////////////////////////////////////////
+TEST(NetworkManager, Rebalance)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  EntityComponentManager ecm;
+
+  NetworkConfig conf;
+  conf.role = NetworkRole::SimulationPrimary;
+  conf.numSecondariesExpected = 2;
+  conf.rebalancePeriod = 10;
+  conf.rebalanceThreshold = 0.25;
+  auto nm = NetworkManager::Create(step, ecm, nullptr, conf);
+  ASSERT_NE(nullptr, nm);
+  auto primary = static_cast<NetworkManagerPrimary *>(nm.get());
+
+  for (const std::string prefix : {"a", "b"})
+  {
+    auto sc = std::make_unique<SecondaryControl>();
+    sc->prefix = prefix;
+    primary->Secondaries()[prefix] = std::move(sc);
+  }
+  auto &a = *primary->Secondaries()["a"];
+  auto &b = *primary->Secondaries()["b"];
+
+  // Secondary "a" runs 3 groups of performers, performers sharing a level
+  // are a group. Secondary "b" runs 1.
+  std::map<Entity, Entity> levelOf;
+  for (Entity level = 1000; level < 1003; ++level)
+  {
+    levelOf[createPerformer(ecm, "a", level)] = level;
+    levelOf[createPerformer(ecm, "a", level)] = level;
+  }
+  createPerformer(ecm, "b", 1003);
+  createPerformer(ecm, "b", 1003);
+
+  // Performers are only migrated every rebalancePeriod iterations
+  auto rebalance = [&]()
+  {
+    private_msgs::SimulationStep msg;
+    for (unsigned int i = 0; i < conf.rebalancePeriod; ++i)
+      primary->RebalanceAffinities(msg);
+    return msg;
+  };
+
+  // Imbalance below the threshold
+  reportStepTime(a, 0.030);
+  reportStepTime(b, 0.025);
+  for (int i = 0; i < 5; ++i)
+    EXPECT_EQ(0, rebalance().affinity_size());
+
+  // Sustained imbalance migrates exactly one group from the slowest to the
+  // fastest secondary
+  reportStepTime(a, 0.030);
+  reportStepTime(b, 0.010);
+  {
+    private_msgs::SimulationStep msg;
+    for (unsigned int i = 0; i + 1 < conf.rebalancePeriod; ++i)
+      primary->RebalanceAffinities(msg);
+    EXPECT_EQ(0, msg.affinity_size());
+  }
+  auto msg = rebalance();
+  ASSERT_EQ(2, msg.affinity_size());
+  std::set<Entity> levels;
+  for (const auto &affinity : msg.affinity())
+  {
+    EXPECT_EQ("b", affinity.secondary_prefix());
+    ASSERT_EQ(1u, levelOf.count(affinity.entity().id()));
+    levels.insert(levelOf[affinity.entity().id()]);
+    EXPECT_EQ("b", ecm.Component<components::PerformerAffinity>(
+        affinity.entity().id())->Data());
+    EXPECT_LT(0, affinity.state().entities_size());
+  }
+  EXPECT_EQ(1u, levels.size());
+
+  // Nothing moves until both secondaries report times with the new
+  // performers
+  EXPECT_EQ(0, rebalance().affinity_size());
+
+  // Secondary "b" is now slower than expected, but moving a group back
+  // wouldn't shrink the gap enough, so performers stay
+  for (int i = 0; i < 5; ++i)
+  {
+    reportStepTime(a, 0.020);
+    reportStepTime(b, 0.028);
+    EXPECT_EQ(0, rebalance().affinity_size());
+  }
+}
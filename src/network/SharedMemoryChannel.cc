@@ -0,0 +1,380 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "SharedMemoryChannel.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include <ignition/common/Console.hh>
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Identifies segments created by SharedMemoryChannel.
+static const uint32_t kMagic{0x49474e43u};
+
+/// \brief Version of the segment layout, bump when ChannelHeader changes.
+static const uint32_t kVersion{2u};
+
+/// \brief Messages are stored with their size in front and padded to this
+/// alignment, so sizes never straddle the end of the ring.
+static const uint64_t kAlignment{8u};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+    "Ring positions must be lock free to be shared across processes");
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free &&
+    sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+    "The wake up counter must be usable as a futex word");
+
+/// \brief Layout at the start of the shared memory segment. Positions only
+/// ever increase and are wrapped around the capacity when accessing the
+/// ring, so the ring is empty when they're equal.
+struct ChannelHeader
+{
+  /// \brief Always kMagic.
+  uint32_t magic;
+
+  /// \brief Always kVersion.
+  uint32_t version;
+
+  /// \brief Size of the ring in bytes, a multiple of kAlignment.
+  uint64_t capacity;
+
+  /// \brief Position of the next write, only modified by the writer.
+  alignas(64) std::atomic<uint64_t> head;
+
+  /// \brief Position of the next read, only modified by the reader.
+  alignas(64) std::atomic<uint64_t> tail;
+
+  /// \brief Bumped by every write, the futex word a waiting reader sleeps
+  /// on.
+  alignas(64) std::atomic<uint32_t> writes;
+
+  /// \brief Number of readers sleeping on writes, so the writer only makes
+  /// the wake up syscall when someone is asleep.
+  std::atomic<uint32_t> sleepers;
+};
+
+/// \brief Size of the header, rounded so the ring starts on a cache line.
+static const std::size_t kHeaderSize{(sizeof(ChannelHeader) + 63u) & ~63u};
+
+/// \brief Round a size up to kAlignment.
+/// \param[in] _size Size in bytes.
+/// \return Padded size.
+static uint64_t Padded(uint64_t _size)
+{
+  return (_size + kAlignment - 1u) & ~(kAlignment - 1u);
+}
+
+//////////////////////////////////////////////////
+std::unique_ptr<SharedMemoryChannel> SharedMemoryChannel::Create(
+    const std::string &_name, std::size_t _capacity)
+{
+  std::unique_ptr<SharedMemoryChannel> channel(new SharedMemoryChannel());
+  channel->segmentName = "/ign_gazebo_net_" + _name;
+  if (!channel->Map(true, _capacity))
+    return nullptr;
+  return channel;
+}
+
+//////////////////////////////////////////////////
+std::unique_ptr<SharedMemoryChannel> SharedMemoryChannel::Open(
+    const std::string &_name)
+{
+  std::unique_ptr<SharedMemoryChannel> channel(new SharedMemoryChannel());
+  channel->segmentName = "/ign_gazebo_net_" + _name;
+  if (!channel->Map(false, 0u))
+    return nullptr;
+  return channel;
+}
+
+//////////////////////////////////////////////////
+SharedMemoryChannel::~SharedMemoryChannel()
+{
+#ifndef _WIN32
+  if (nullptr != this->memory)
+  {
+    munmap(this->memory, this->mappedSize);
+    if (this->owner)
+      shm_unlink(this->segmentName.c_str());
+  }
+#endif
+}
+
+//////////////////////////////////////////////////
+bool SharedMemoryChannel::Map(bool _create, std::size_t _capacity)
+{
+#ifdef _WIN32
+  (void)_create;
+  (void)_capacity;
+  ignerr << "Shared memory channels aren't supported on Windows."
+         << std::endl;
+  return false;
+#else
+  int fd{-1};
+  if (_create)
+  {
+    // Remove leftovers from peers that didn't shut down cleanly
+    shm_unlink(this->segmentName.c_str());
+    fd = shm_open(this->segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  }
+  else
+  {
+    fd = shm_open(this->segmentName.c_str(), O_RDWR, 0600);
+  }
+
+  if (fd < 0)
+  {
+    // Expected when opening channels of peers on other hosts
+    if (_create || errno != ENOENT)
+    {
+      ignerr << "Failed to open shared memory segment [" << this->segmentName
+             << "]: " << std::strerror(errno) << std::endl;
+    }
+    return false;
+  }
+
+  if (_create)
+  {
+    this->mappedSize = kHeaderSize + Padded(std::max<std::size_t>(
+        _capacity, kAlignment * 2u));
+    if (ftruncate(fd, static_cast<off_t>(this->mappedSize)) != 0)
+    {
+      ignerr << "Failed to size shared memory segment [" << this->segmentName
+             << "]: " << std::strerror(errno) << std::endl;
+      close(fd);
+      shm_unlink(this->segmentName.c_str());
+      return false;
+    }
+  }
+  else
+  {
+    struct stat info;
+    if (fstat(fd, &info) != 0 ||
+        static_cast<std::size_t>(info.st_size) <= kHeaderSize)
+    {
+      // The creator may not have sized the segment yet
+      close(fd);
+      return false;
+    }
+    this->mappedSize = static_cast<std::size_t>(info.st_size);
+  }
+
+  void *addr = mmap(nullptr, this->mappedSize, PROT_READ | PROT_WRITE,
+      MAP_SHARED, fd, 0);
+  close(fd);
+  if (MAP_FAILED == addr)
+  {
+    ignerr << "Failed to map shared memory segment [" << this->segmentName
+           << "]: " << std::strerror(errno) << std::endl;
+    if (_create)
+      shm_unlink(this->segmentName.c_str());
+    return false;
+  }
+
+  this->memory = addr;
+  this->owner = _create;
+  this->ring = static_cast<unsigned char *>(addr) + kHeaderSize;
+
+  auto header = static_cast<ChannelHeader *>(addr);
+  if (_create)
+  {
+    header = new (addr) ChannelHeader();
+    header->capacity = this->mappedSize - kHeaderSize;
+    header->head.store(0u, std::memory_order_relaxed);
+    header->tail.store(0u, std::memory_order_relaxed);
+    header->writes.store(0u, std::memory_order_relaxed);
+    header->sleepers.store(0u, std::memory_order_relaxed);
+    header->version = kVersion;
+
+    // Published last, so peers never see a half initialized header
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = kMagic;
+  }
+  else
+  {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->magic != kMagic || header->version != kVersion ||
+        header->capacity != this->mappedSize - kHeaderSize)
+    {
+      ignerr << "Shared memory segment [" << this->segmentName
+             << "] isn't a compatible channel." << std::endl;
+      return false;
+    }
+  }
+  this->capacity = header->capacity;
+
+  return true;
+#endif
+}
+
+//////////////////////////////////////////////////
+bool SharedMemoryChannel::Write(const std::string &_data)
+{
+  if (nullptr == this->memory)
+    return false;
+
+  auto header = static_cast<ChannelHeader *>(this->memory);
+  const uint64_t head = header->head.load(std::memory_order_relaxed);
+  const uint64_t tail = header->tail.load(std::memory_order_acquire);
+
+  const uint64_t size = _data.size();
+  const uint64_t needed = kAlignment + Padded(size);
+  if (needed > this->capacity - (head - tail))
+    return false;
+
+  this->CopyIn(head, &size, sizeof(size));
+  this->CopyIn(head + kAlignment, _data.data(), _data.size());
+
+  // Make the message visible to the reader
+  header->head.store(head + needed, std::memory_order_release);
+
+  // Sequentially consistent so that either the reader sees the new count
+  // before it sleeps, or we see it sleeping and wake it
+  header->writes.fetch_add(1u, std::memory_order_seq_cst);
+#ifdef __linux__
+  if (header->sleepers.load(std::memory_order_seq_cst) > 0u)
+  {
+    // Not FUTEX_PRIVATE_FLAG, the reader is in another process
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&header->writes),
+        FUTEX_WAKE, 1, nullptr, nullptr, 0);
+  }
+#endif
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool SharedMemoryChannel::Wait(
+    const std::chrono::steady_clock::duration &_timeout)
+{
+  if (nullptr == this->memory)
+    return false;
+
+  auto header = static_cast<ChannelHeader *>(this->memory);
+  const auto deadline = std::chrono::steady_clock::now() + _timeout;
+  while (true)
+  {
+    const uint32_t writes = header->writes.load(std::memory_order_seq_cst);
+    if (header->head.load(std::memory_order_acquire) !=
+        header->tail.load(std::memory_order_relaxed))
+    {
+      return true;
+    }
+
+    const auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining <= std::chrono::steady_clock::duration::zero())
+      return false;
+
+#ifdef __linux__
+    const auto nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(remaining);
+    struct timespec timeout;
+    timeout.tv_sec = static_cast<time_t>(nsec.count() / 1000000000);
+    timeout.tv_nsec = static_cast<long>(nsec.count() % 1000000000);  // NOLINT
+
+    // Returns right away if a write happened since the count was loaded,
+    // otherwise sleeps until Write wakes us, a signal or the timeout
+    header->sleepers.fetch_add(1u, std::memory_order_seq_cst);
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&header->writes),
+        FUTEX_WAIT, writes, &timeout, nullptr, 0);
+    header->sleepers.fetch_sub(1u, std::memory_order_seq_cst);
+#else
+    (void)writes;
+    std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+        remaining, std::chrono::microseconds(50)));
+#endif
+  }
+}
+
+//////////////////////////////////////////////////
+bool SharedMemoryChannel::Read(std::string &_data)
+{
+  if (nullptr == this->memory)
+    return false;
+
+  auto header = static_cast<ChannelHeader *>(this->memory);
+  const uint64_t tail = header->tail.load(std::memory_order_relaxed);
+  const uint64_t head = header->head.load(std::memory_order_acquire);
+  if (head == tail)
+    return false;
+
+  uint64_t size{0u};
+  this->CopyOut(tail, &size, sizeof(size));
+  if (kAlignment + Padded(size) > head - tail)
+  {
+    ignerr << "Corrupt message in shared memory segment ["
+           << this->segmentName << "], dropping queued messages."
+           << std::endl;
+    header->tail.store(head, std::memory_order_release);
+    return false;
+  }
+
+  _data.resize(size);
+  this->CopyOut(tail + kAlignment, &_data[0], size);
+
+  // Release the space back to the writer
+  header->tail.store(tail + kAlignment + Padded(size),
+      std::memory_order_release);
+  return true;
+}
+
+//////////////////////////////////////////////////
+const std::string &SharedMemoryChannel::SegmentName() const
+{
+  return this->segmentName;
+}
+
+//////////////////////////////////////////////////
+void SharedMemoryChannel::CopyIn(uint64_t _pos, const void *_src,
+    std::size_t _size)
+{
+  auto offset = static_cast<std::size_t>(_pos % this->capacity);
+  auto first = std::min<std::size_t>(_size, this->capacity - offset);
+  auto src = static_cast<const unsigned char *>(_src);
+  std::memcpy(this->ring + offset, src, first);
+  std::memcpy(this->ring, src + first, _size - first);
+}
+
+//////////////////////////////////////////////////
+void SharedMemoryChannel::CopyOut(uint64_t _pos, void *_dst,
+    std::size_t _size) const
+{
+  auto offset = static_cast<std::size_t>(_pos % this->capacity);
+  auto first = std::min<std::size_t>(_size, this->capacity - offset);
+  auto dst = static_cast<unsigned char *>(_dst);
+  std::memcpy(dst, this->ring + offset, first);
+  std::memcpy(dst + first, this->ring, _size - first);
+}
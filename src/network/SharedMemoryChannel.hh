@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_NETWORK_SHAREDMEMORYCHANNEL_HH_
+#define IGNITION_GAZEBO_NETWORK_SHAREDMEMORYCHANNEL_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class SharedMemoryChannel SharedMemoryChannel.hh
+    /// \brief Queue of messages in a POSIX shared memory ring buffer, used
+    /// to exchange steps and step acks between network peers running on the
+    /// same host without going through sockets.
+    ///
+    /// There must be exactly one process writing and one process reading
+    /// each channel. One of them creates the channel and owns the segment,
+    /// the other opens it by name. Opening fails if the segment doesn't
+    /// exist, which is the case when the peers are on different hosts.
+    class IGNITION_GAZEBO_VISIBLE SharedMemoryChannel
+    {
+      /// \brief Create a new channel, replacing any stale segment with the
+      /// same name. The segment is removed when the channel is destroyed.
+      /// \param[in] _name Unique name of the channel.
+      /// \param[in] _capacity Number of bytes available for queued messages.
+      /// \return The new channel, or null if it couldn't be created.
+      public: static std::unique_ptr<SharedMemoryChannel> Create(
+          const std::string &_name, std::size_t _capacity);
+
+      /// \brief Open a channel created by another process.
+      /// \param[in] _name Name the channel was created with.
+      /// \return The channel, or null if there's no such channel.
+      public: static std::unique_ptr<SharedMemoryChannel> Open(
+          const std::string &_name);
+
+      /// \brief Destructor.
+      public: ~SharedMemoryChannel();
+
+      /// \brief Queue a message. It never blocks.
+      /// \param[in] _data Serialized message.
+      /// \return False if there isn't enough free space for the message.
+      public: bool Write(const std::string &_data);
+
+      /// \brief Pop the oldest queued message. It never blocks.
+      /// \param[out] _data Serialized message.
+      /// \return False if the channel is empty.
+      public: bool Read(std::string &_data);
+
+      /// \brief Block until there's a message to read or the timeout
+      /// expires. On Linux the reader sleeps on a futex in the segment and
+      /// Write wakes it, so waiting costs no CPU and the wake up latency is
+      /// the kernel's. Elsewhere it polls with short sleeps.
+      /// \param[in] _timeout Maximum time to wait.
+      /// \return True if there's a message to read.
+      public: bool Wait(const std::chrono::steady_clock::duration &_timeout);
+
+      /// \brief Get the name of the shared memory segment.
+      /// \return Segment name.
+      public: const std::string &SegmentName() const;
+
+      /// \brief Use Create or Open instead.
+      private: SharedMemoryChannel() = default;
+
+      /// \brief Map the segment into memory.
+      /// \param[in] _create True to create the segment.
+      /// \param[in] _capacity Capacity of a new segment.
+      /// \return True if successful.
+      private: bool Map(bool _create, std::size_t _capacity);
+
+      /// \brief Copy bytes into the ring, wrapping around its end.
+      /// \param[in] _pos Absolute write position.
+      /// \param[in] _src Bytes to copy.
+      /// \param[in] _size Number of bytes.
+      private: void CopyIn(uint64_t _pos, const void *_src, std::size_t _size);
+
+      /// \brief Copy bytes out of the ring, wrapping around its end.
+      /// \param[in] _pos Absolute read position.
+      /// \param[out] _dst Destination.
+      /// \param[in] _size Number of bytes.
+      private: void CopyOut(uint64_t _pos, void *_dst, std::size_t _size)
+          const;
+
+      /// \brief Name of the shared memory segment.
+      private: std::string segmentName;
+
+      /// \brief Mapped segment, starting with the channel header.
+      private: void *memory{nullptr};
+
+      /// \brief Number of bytes mapped.
+      private: std::size_t mappedSize{0};
+
+      /// \brief Start of the ring buffer inside the segment.
+      private: unsigned char *ring{nullptr};
+
+      /// \brief Size of the ring buffer in bytes.
+      private: uint64_t capacity{0};
+
+      /// \brief True if this process created the segment.
+      private: bool owner{false};
+    };
+    }
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_NETWORK_SHAREDMEMORYCHANNEL_HH_
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <ignition/utilities/ExtraTestMacros.hh>
+
+#include "SharedMemoryChannel.hh"
+
+using namespace ignition::gazebo;
+
+/////////////////////////////////////////////////
+TEST(SharedMemoryChannel, IGN_UTILS_TEST_DISABLED_ON_WIN32(WriteRead))
+{
+  // Nothing to open before the channel is created
+  EXPECT_EQ(nullptr, SharedMemoryChannel::Open("test_channel_write_read"));
+
+  auto writer = SharedMemoryChannel::Create("test_channel_write_read", 64u);
+  ASSERT_NE(nullptr, writer);
+  auto reader = SharedMemoryChannel::Open("test_channel_write_read");
+  ASSERT_NE(nullptr, reader);
+  EXPECT_EQ(writer->SegmentName(), reader->SegmentName());
+
+  std::string data;
+  EXPECT_FALSE(reader->Read(data));
+
+  // Messages come out in order, including empty ones
+  EXPECT_TRUE(writer->Write("hello"));
+  EXPECT_TRUE(writer->Write(""));
+  EXPECT_TRUE(writer->Write("world!"));
+  ASSERT_TRUE(reader->Read(data));
+  EXPECT_EQ("hello", data);
+  ASSERT_TRUE(reader->Read(data));
+  EXPECT_EQ("", data);
+  ASSERT_TRUE(reader->Read(data));
+  EXPECT_EQ("world!", data);
+  EXPECT_FALSE(reader->Read(data));
+
+  // Messages that don't fit are rejected without corrupting the queue
+  EXPECT_FALSE(writer->Write(std::string(100u, 'x')));
+  EXPECT_TRUE(writer->Write(std::string(40u, 'a')));
+  EXPECT_FALSE(writer->Write(std::string(20u, 'b')));
+  ASSERT_TRUE(reader->Read(data));
+  EXPECT_EQ(std::string(40u, 'a'), data);
+
+  // Messages wrap around the end of the ring
+  for (int i = 0; i < 20; ++i)
+  {
+    std::string msg(static_cast<std::size_t>(i % 7) * 3u, 'a' + i);
+    ASSERT_TRUE(writer->Write(msg));
+    ASSERT_TRUE(reader->Read(data));
+    EXPECT_EQ(msg, data);
+  }
+
+  // The segment is gone once its owner is destroyed
+  reader.reset();
+  writer.reset();
+  EXPECT_EQ(nullptr, SharedMemoryChannel::Open("test_channel_write_read"));
+}
+
+/////////////////////////////////////////////////
+TEST(SharedMemoryChannel, IGN_UTILS_TEST_DISABLED_ON_WIN32(Threads))
+{
+  auto reader = SharedMemoryChannel::Create("test_channel_threads", 256u);
+  ASSERT_NE(nullptr, reader);
+  auto writer = SharedMemoryChannel::Open("test_channel_threads");
+  ASSERT_NE(nullptr, writer);
+
+  const int count{10000};
+  std::thread producer([&]
+  {
+    for (int i = 0; i < count; ++i)
+    {
+      while (!writer->Write(std::to_string(i)))
+        std::this_thread::yield();
+    }
+  });
+
+  std::string data;
+  for (int i = 0; i < count; ++i)
+  {
+    while (!reader->Read(data))
+      std::this_thread::yield();
+    ASSERT_EQ(std::to_string(i), data);
+  }
+  producer.join();
+}
+
+/////////////////////////////////////////////////
+TEST(SharedMemoryChannel, IGN_UTILS_TEST_DISABLED_ON_WIN32(Wait))
+{
+  auto reader = SharedMemoryChannel::Create("test_channel_wait", 256u);
+  ASSERT_NE(nullptr, reader);
+  auto writer = SharedMemoryChannel::Open("test_channel_wait");
+  ASSERT_NE(nullptr, writer);
+
+  // Times out on an empty channel
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(reader->Wait(std::chrono::milliseconds(20)));
+  EXPECT_GE(std::chrono::steady_clock::now() - start,
+      std::chrono::milliseconds(20));
+
+  // Returns right away if there's something queued
+  EXPECT_TRUE(writer->Write("queued"));
+  EXPECT_TRUE(reader->Wait(std::chrono::seconds(10)));
+  std::string data;
+  ASSERT_TRUE(reader->Read(data));
+  EXPECT_EQ("queued", data);
+
+  // Sleeping readers are woken up by writes, long before the timeout
+  const int count{100};
+  std::thread producer([&]
+  {
+    for (int i = 0; i < count; ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      EXPECT_TRUE(writer->Write(std::to_string(i)));
+    }
+  });
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < count; ++i)
+  {
+    ASSERT_TRUE(reader->Wait(std::chrono::seconds(10)));
+    ASSERT_TRUE(reader->Read(data));
+    EXPECT_EQ(std::to_string(i), data);
+  }
+  producer.join();
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+      std::chrono::seconds(5));
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "SpatialPartition.hh"
+
+#include <algorithm>
+#include <limits>
+
+using namespace ignition;
+using namespace gazebo;
+
+//////////////////////////////////////////////////
+void SpatialPartition::Build(const std::vector<math::Vector3d> &_points,
+    std::size_t _regions)
+{
+  this->mins.clear();
+  this->maxs.clear();
+
+  const double inf = std::numeric_limits<double>::infinity();
+  auto points = _points;
+  this->Split(points, 0u, points.size(), math::Vector3d(-inf, -inf, -inf),
+      math::Vector3d(inf, inf, inf), std::max<std::size_t>(_regions, 1u));
+}
+
+//////////////////////////////////////////////////
+void SpatialPartition::Split(std::vector<math::Vector3d> &_points,
+    std::size_t _begin, std::size_t _end, const math::Vector3d &_min,
+    const math::Vector3d &_max, std::size_t _regions)
+{
+  if (_regions == 1u)
+  {
+    this->mins.push_back(_min);
+    this->maxs.push_back(_max);
+    return;
+  }
+
+  // Split along the horizontal axis where the points are most spread out
+  const auto first = _points.begin() + _begin;
+  const auto last = _points.begin() + _end;
+  int axis{0};
+  if (_begin != _end)
+  {
+    auto [minX, maxX] = std::minmax_element(first, last,
+        [](const auto &_a, const auto &_b) { return _a.X() < _b.X(); });
+    auto [minY, maxY] = std::minmax_element(first, last,
+        [](const auto &_a, const auto &_b) { return _a.Y() < _b.Y(); });
+    if (maxY->Y() - minY->Y() > maxX->X() - minX->X())
+      axis = 1;
+  }
+
+  // Points are divided in proportion to the number of regions on each side
+  const std::size_t leftRegions = _regions / 2u;
+  const std::size_t count = _end - _begin;
+  const std::size_t leftCount = count * leftRegions / _regions;
+
+  std::sort(first, last, [axis](const auto &_a, const auto &_b)
+      {
+        return _a[axis] < _b[axis];
+      });
+
+  // Split halfway between the points on each side
+  double split{0.0};
+  if (count > 0u)
+  {
+    if (leftCount == 0u)
+      split = (*first)[axis] - 1.0;
+    else if (leftCount == count)
+      split = (*(last - 1))[axis] + 1.0;
+    else
+      split = 0.5 * ((*(first + leftCount - 1))[axis] +
+          (*(first + leftCount))[axis]);
+  }
+  split = std::clamp(split, _min[axis], _max[axis]);
+
+  math::Vector3d leftMax = _max;
+  leftMax[axis] = split;
+  math::Vector3d rightMin = _min;
+  rightMin[axis] = split;
+
+  this->Split(_points, _begin, _begin + leftCount, _min, leftMax,
+      leftRegions);
+  this->Split(_points, _begin + leftCount, _end, rightMin, _max,
+      _regions - leftRegions);
+}
+
+//////////////////////////////////////////////////
+std::size_t SpatialPartition::RegionCount() const
+{
+  return this->mins.size();
+}
+
+//////////////////////////////////////////////////
+std::size_t SpatialPartition::Region(const math::Vector3d &_point) const
+{
+  for (std::size_t i = 0; i < this->mins.size(); ++i)
+  {
+    if (this->Contains(i, _point))
+      return i;
+  }
+  return 0u;
+}
+
+//////////////////////////////////////////////////
+bool SpatialPartition::Contains(std::size_t _region,
+    const math::Vector3d &_point, double _margin) const
+{
+  if (_region >= this->mins.size())
+    return false;
+
+  // Regions are half open, so points on a split belong to one region only
+  const auto &min = this->mins[_region];
+  const auto &max = this->maxs[_region];
+  for (int axis : {0, 1})
+  {
+    if (_point[axis] < min[axis] - _margin ||
+        _point[axis] >= max[axis] + _margin)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool SpatialPartition::Bounds(std::size_t _region, math::Vector3d &_min,
+    math::Vector3d &_max) const
+{
+  if (_region >= this->mins.size())
+    return false;
+
+  _min = this->mins[_region];
+  _max = this->maxs[_region];
+  return true;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_NETWORK_SPATIALPARTITION_HH_
+#define IGNITION_GAZEBO_NETWORK_SPATIALPARTITION_HH_
+
+#include <cstddef>
+#include <vector>
+
+#include <ignition/math/Vector3.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class SpatialPartition SpatialPartition.hh
+    /// \brief Splits the world into regions, one per network secondary.
+    ///
+    /// Regions are the leaves of a k-d tree built over the horizontal
+    /// positions of entities, so that each region holds roughly the same
+    /// number of entities. Regions span the full height of the world, and
+    /// regions on the border of the tree extend to infinity, so every point
+    /// belongs to exactly one region.
+    class IGNITION_GAZEBO_VISIBLE SpatialPartition
+    {
+      /// \brief Build the partition.
+      /// \param[in] _points Positions of the entities to be balanced.
+      /// \param[in] _regions Number of regions, at least 1.
+      public: void Build(const std::vector<math::Vector3d> &_points,
+          std::size_t _regions);
+
+      /// \brief Number of regions, which is zero until Build is called.
+      /// \return Number of regions.
+      public: std::size_t RegionCount() const;
+
+      /// \brief Get the region a point belongs to.
+      /// \param[in] _point Point in the world frame.
+      /// \return Index of the region, or zero if there are no regions.
+      public: std::size_t Region(const math::Vector3d &_point) const;
+
+      /// \brief Check whether a point is inside a region grown by a margin.
+      /// This is used to keep entities close to a border in their current
+      /// region.
+      /// \param[in] _region Index of the region.
+      /// \param[in] _point Point in the world frame.
+      /// \param[in] _margin Distance to grow the region by, in meters.
+      /// \return True if the point is inside the grown region.
+      public: bool Contains(std::size_t _region, const math::Vector3d &_point,
+          double _margin = 0.0) const;
+
+      /// \brief Get the bounds of a region.
+      /// \param[in] _region Index of the region.
+      /// \param[out] _min Minimum corner, may be infinite.
+      /// \param[out] _max Maximum corner, may be infinite.
+      /// \return False if there's no such region.
+      public: bool Bounds(std::size_t _region, math::Vector3d &_min,
+          math::Vector3d &_max) const;
+
+      /// \brief Recursively split a box until there's one region per leaf.
+      /// \param[in] _points Points inside the box, reordered in place.
+      /// \param[in] _begin First point inside the box.
+      /// \param[in] _end One past the last point inside the box.
+      /// \param[in] _min Minimum corner of the box.
+      /// \param[in] _max Maximum corner of the box.
+      /// \param[in] _regions Number of regions to split the box into.
+      private: void Split(std::vector<math::Vector3d> &_points,
+          std::size_t _begin, std::size_t _end, const math::Vector3d &_min,
+          const math::Vector3d &_max, std::size_t _regions);
+
+      /// \brief Minimum corner of each region.
+      private: std::vector<math::Vector3d> mins;
+
+      /// \brief Maximum corner of each region.
+      private: std::vector<math::Vector3d> maxs;
+    };
+    }
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_NETWORK_SPATIALPARTITION_HH_
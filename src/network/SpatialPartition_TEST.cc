@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include <ignition/math/Vector3.hh>
+
+#include "SpatialPartition.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(SpatialPartition, Balanced)
+{
+  SpatialPartition partition;
+  EXPECT_EQ(0u, partition.RegionCount());
+  EXPECT_EQ(0u, partition.Region(math::Vector3d(1, 2, 3)));
+
+  // Points spread mostly along X
+  std::vector<math::Vector3d> points;
+  for (int i = 0; i < 12; ++i)
+    points.emplace_back(i * 10.0, (i % 3) * 1.0, 0.0);
+
+  partition.Build(points, 3u);
+  ASSERT_EQ(3u, partition.RegionCount());
+
+  // Each region gets the same number of points
+  std::vector<int> counts(3u, 0);
+  for (const auto &point : points)
+    ++counts[partition.Region(point)];
+  for (auto count : counts)
+    EXPECT_EQ(4, count);
+
+  // Regions are split along X, and the outer ones are unbounded
+  math::Vector3d min, max;
+  ASSERT_TRUE(partition.Bounds(0u, min, max));
+  EXPECT_TRUE(std::isinf(min.X()));
+  EXPECT_TRUE(std::isinf(min.Y()));
+  EXPECT_DOUBLE_EQ(35.0, max.X());
+  EXPECT_FALSE(partition.Bounds(3u, min, max));
+
+  EXPECT_EQ(0u, partition.Region(math::Vector3d(-1000, 0, 0)));
+  EXPECT_EQ(2u, partition.Region(math::Vector3d(1000, 0, 0)));
+
+  // Margins let points near the border stay in their region
+  EXPECT_FALSE(partition.Contains(0u, math::Vector3d(36, 0, 0)));
+  EXPECT_TRUE(partition.Contains(0u, math::Vector3d(36, 0, 0), 2.0));
+  EXPECT_FALSE(partition.Contains(5u, math::Vector3d(0, 0, 0), 2.0));
+}
+
+/////////////////////////////////////////////////
+TEST(SpatialPartition, FewPoints)
+{
+  // More regions than points still covers the whole world
+  SpatialPartition partition;
+  partition.Build({math::Vector3d(0, 0, 0)}, 4u);
+  ASSERT_EQ(4u, partition.RegionCount());
+
+  for (double x : {-100.0, 0.0, 100.0})
+  {
+    for (double y : {-100.0, 0.0, 100.0})
+    {
+      int owners{0};
+      for (std::size_t r = 0; r < partition.RegionCount(); ++r)
+        owners += partition.Contains(r, math::Vector3d(x, y, 0)) ? 1 : 0;
+      EXPECT_EQ(1, owners) << x << " " << y;
+    }
+  }
+
+  // No points and at least one region
+  partition.Build({}, 0u);
+  EXPECT_EQ(1u, partition.RegionCount());
+  EXPECT_EQ(0u, partition.Region(math::Vector3d(5, 5, 5)));
+}
@@ -15,12 +15,18 @@
  *
 */
 
+#include <array>
+#include <cmath>
 #include <functional>
 #include <list>
 #include <map>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
 #include <ignition/msgs.hh>
 #include <ignition/transport/Node.hh>
 
@@ -36,6 +42,194 @@
 using namespace ignition;
 using namespace gazebo;
 
+/// \brief Number of marker types used to draw batches.
+static constexpr std::size_t kBatchTypeCount{3u};
+
+/// \brief Marker types used to draw batches, in the order of
+/// MarkerBatchElement::vertices.
+static const std::array<rendering::MarkerType, kBatchTypeCount>
+    kBatchTypes{rendering::MarkerType::MT_TRIANGLE_LIST,
+    rendering::MarkerType::MT_LINE_LIST, rendering::MarkerType::MT_POINTS};
+
+/// \brief Geometry of a marker sent to the batch service, expanded into
+/// triangles, line segments and points in the batch frame.
+struct MarkerBatchElement
+{
+  /// \brief Vertices of triangles, line segments and points, one vector
+  /// per entry of kBatchTypes.
+  std::array<std::vector<math::Vector3d>, kBatchTypeCount> vertices;
+
+  /// \brief Material of the marker.
+  msgs::Material material;
+};
+
+/// \brief Markers of a namespace sent to the batch service. They are
+/// drawn by a single visual with one marker per type of primitive.
+struct MarkerBatch
+{
+  /// \brief Elements of the batch, by marker id.
+  std::map<uint64_t, MarkerBatchElement> elements;
+
+  /// \brief True if elements changed since the markers were last built.
+  bool dirty{true};
+
+  /// \brief Visual drawing the batch, null until first built.
+  rendering::VisualPtr visual;
+
+  /// \brief Markers drawing each type of primitive, null if the batch
+  /// has none of that type.
+  std::array<rendering::MarkerPtr, kBatchTypeCount> markers;
+};
+
+/// \brief Append the two triangles of a quad to a triangle list.
+/// \param[in] _a First corner, counter clockwise seen from the front.
+/// \param[in] _b Second corner.
+/// \param[in] _c Third corner.
+/// \param[in] _d Fourth corner.
+/// \param[out] _triangles Triangle list to append to.
+static void appendQuad(const math::Vector3d &_a, const math::Vector3d &_b,
+    const math::Vector3d &_c, const math::Vector3d &_d,
+    std::vector<math::Vector3d> &_triangles)
+{
+  _triangles.insert(_triangles.end(), {_a, _b, _c, _a, _c, _d});
+}
+
+/// \brief Append the triangles of a unit box, sphere or cylinder centered
+/// at the origin, the shapes used by markers of those types.
+/// \param[in] _type BOX, SPHERE or CYLINDER.
+/// \param[out] _triangles Triangle list to append to.
+static void appendShape(msgs::Marker::Type _type,
+    std::vector<math::Vector3d> &_triangles)
+{
+  if (_type == msgs::Marker::BOX)
+  {
+    auto corner = [](int _i)
+    {
+      return math::Vector3d((_i & 1) ? 0.5 : -0.5, (_i & 2) ? 0.5 : -0.5,
+          (_i & 4) ? 0.5 : -0.5);
+    };
+    const int faces[6][4] = {{0, 4, 6, 2}, {1, 3, 7, 5}, {0, 1, 5, 4},
+        {2, 6, 7, 3}, {0, 2, 3, 1}, {4, 5, 7, 6}};
+    for (const auto &face : faces)
+    {
+      appendQuad(corner(face[0]), corner(face[1]), corner(face[2]),
+          corner(face[3]), _triangles);
+    }
+    return;
+  }
+
+  // Spheres and cylinders are coarse, since batches are meant for many
+  // small markers
+  const int slices = 12;
+  const int stacks = _type == msgs::Marker::SPHERE ? 6 : 1;
+  auto vertex = [&](int _slice, int _stack)
+  {
+    double theta = 2 * IGN_PI * _slice / slices;
+    if (_type == msgs::Marker::SPHERE)
+    {
+      double phi = IGN_PI * _stack / stacks - IGN_PI / 2;
+      return math::Vector3d(0.5 * cos(phi) * cos(theta),
+          0.5 * cos(phi) * sin(theta), 0.5 * sin(phi));
+    }
+    return math::Vector3d(0.5 * cos(theta), 0.5 * sin(theta),
+        _stack - 0.5);
+  };
+  for (int i = 0; i < slices; ++i)
+  {
+    for (int j = 0; j < stacks; ++j)
+    {
+      appendQuad(vertex(i, j), vertex(i + 1, j), vertex(i + 1, j + 1),
+          vertex(i, j + 1), _triangles);
+    }
+    if (_type == msgs::Marker::CYLINDER)
+    {
+      _triangles.insert(_triangles.end(),
+          {math::Vector3d(0, 0, -0.5), vertex(i + 1, 0), vertex(i, 0),
+           math::Vector3d(0, 0, 0.5), vertex(i, 1), vertex(i + 1, 1)});
+    }
+  }
+}
+
+/// \brief Expand a marker into the primitives of a batch element.
+/// \param[in] _msg Marker to expand.
+/// \param[out] _element Element whose vertices are filled.
+/// \return False if the marker's type can't be batched.
+static bool expandMarker(const msgs::Marker &_msg,
+    MarkerBatchElement &_element)
+{
+  auto &triangles = _element.vertices[0];
+  auto &lines = _element.vertices[1];
+  auto &points = _element.vertices[2];
+
+  std::vector<math::Vector3d> msgPoints;
+  msgPoints.reserve(_msg.point().size());
+  for (const auto &point : _msg.point())
+    msgPoints.push_back(msgs::Convert(point));
+
+  switch (_msg.type())
+  {
+    case msgs::Marker::BOX:
+    case msgs::Marker::CYLINDER:
+    case msgs::Marker::SPHERE:
+      appendShape(_msg.type(), triangles);
+      break;
+    case msgs::Marker::TRIANGLE_LIST:
+      triangles.assign(msgPoints.begin(),
+          msgPoints.begin() + msgPoints.size() / 3 * 3);
+      break;
+    case msgs::Marker::TRIANGLE_STRIP:
+      for (std::size_t i = 2; i < msgPoints.size(); ++i)
+      {
+        // Every other triangle is flipped to keep the same winding
+        if (i % 2 == 0)
+        {
+          triangles.insert(triangles.end(),
+              {msgPoints[i - 2], msgPoints[i - 1], msgPoints[i]});
+        }
+        else
+        {
+          triangles.insert(triangles.end(),
+              {msgPoints[i - 1], msgPoints[i - 2], msgPoints[i]});
+        }
+      }
+      break;
+    case msgs::Marker::TRIANGLE_FAN:
+      for (std::size_t i = 2; i < msgPoints.size(); ++i)
+      {
+        triangles.insert(triangles.end(),
+            {msgPoints[0], msgPoints[i - 1], msgPoints[i]});
+      }
+      break;
+    case msgs::Marker::LINE_LIST:
+      lines.assign(msgPoints.begin(),
+          msgPoints.begin() + msgPoints.size() / 2 * 2);
+      break;
+    case msgs::Marker::LINE_STRIP:
+      for (std::size_t i = 1; i < msgPoints.size(); ++i)
+        lines.insert(lines.end(), {msgPoints[i - 1], msgPoints[i]});
+      break;
+    case msgs::Marker::POINTS:
+      points = std::move(msgPoints);
+      break;
+    default:
+      ignerr << "Markers of type[" << _msg.type() << "] can't be batched"
+             << std::endl;
+      return false;
+  }
+
+  // Apply the marker's scale and pose, which would be the scale and pose
+  // of its visual if it wasn't batched
+  math::Vector3d scale = _msg.has_scale() ?
+      msgs::Convert(_msg.scale()) : math::Vector3d::One;
+  math::Pose3d pose = convert<math::Pose3d>(_msg.pose());
+  for (auto &vertices : _element.vertices)
+  {
+    for (auto &vertex : vertices)
+      vertex = pose.Rot().RotateVector(vertex * scale) + pose.Pos();
+  }
+  return true;
+}
+
 /// Private data for the MarkerManager class
 class ignition::gazebo::MarkerManagerPrivate
 {
@@ -71,6 +265,18 @@ class ignition::gazebo::MarkerManagerPrivate
   public: bool OnMarkerMsgArray(const msgs::Marker_V &_req,
               msgs::Boolean &_res);
 
+  /// \brief Callback that receives markers to be drawn in batches.
+  /// \param[in] _req The vector of marker messages
+  /// \param[in] _res Response data
+  /// \return True if the request is received
+  public: bool OnMarkerMsgBatch(const msgs::Marker_V &_req,
+              msgs::Boolean &_res);
+
+  /// \brief Rebuild the visual and markers of a batch from its elements.
+  /// \param[in] _ns Namespace of the batch.
+  /// \param[in] _batch Batch to rebuild.
+  public: void BuildBatch(const std::string &_ns, MarkerBatch &_batch);
+
   /// \brief Services callback that returns a list of markers.
   /// \param[out] _rep Service reply
   /// \return True on success.
@@ -105,6 +311,12 @@ class ignition::gazebo::MarkerManagerPrivate
   /// \brief List of marker message to process.
   public: std::list<msgs::Marker> markerMsgs;
 
+  /// \brief Mutex to protect batches.
+  public: std::mutex batchMutex;
+
+  /// \brief Batches by namespace.
+  public: std::map<std::string, MarkerBatch> batches;
+
   /// \brief Pointer to the scene
   public: rendering::ScenePtr scene;
 
@@ -189,6 +401,14 @@ bool MarkerManager::Init(const rendering::ScenePtr &_scene)
            << "_array service.\n";
   }
 
+  // Advertise to the marker_batch service
+  if (!this->dataPtr->node.Advertise(this->dataPtr->topicName + "_batch",
+        &MarkerManagerPrivate::OnMarkerMsgBatch, this->dataPtr.get()))
+  {
+    ignerr << "Unable to advertise to the " << this->dataPtr->topicName
+           << "_batch service.\n";
+  }
+
   return true;
 }
 
@@ -252,6 +472,96 @@ void MarkerManagerPrivate::Update()
       ++mit;
   }
   this->lastSimTime = this->simTime;
+
+  std::lock_guard<std::mutex> batchLock(this->batchMutex);
+  for (auto it = this->batches.begin(); it != this->batches.end();)
+  {
+    if (it->second.dirty)
+      this->BuildBatch(it->first, it->second);
+
+    if (it->second.elements.empty())
+      it = this->batches.erase(it);
+    else
+      ++it;
+  }
+}
+
+/////////////////////////////////////////////////
+void MarkerManagerPrivate::BuildBatch(const std::string &_ns,
+    MarkerBatch &_batch)
+{
+  _batch.dirty = false;
+
+  std::array<bool, kBatchTypeCount> used{false, false, false};
+  for (const auto &element : _batch.elements)
+  {
+    for (std::size_t i = 0; i < kBatchTypeCount; ++i)
+      used[i] = used[i] || !element.second.vertices[i].empty();
+  }
+
+  // Markers can't be removed from a visual one by one, so the visual is
+  // recreated when the types of primitives in the batch change
+  bool recreate = !_batch.visual;
+  for (std::size_t i = 0; i < kBatchTypeCount; ++i)
+    recreate = recreate || (used[i] != (_batch.markers[i] != nullptr));
+
+  if (recreate)
+  {
+    if (_batch.visual)
+      this->scene->DestroyVisual(_batch.visual);
+    _batch.visual.reset();
+    _batch.markers = {};
+  }
+
+  if (_batch.elements.empty())
+    return;
+
+  if (!_batch.visual)
+  {
+    _batch.visual = this->scene->CreateVisual(
+        "__IGN_MARKER_BATCH_VISUAL_" + _ns);
+    this->scene->RootVisual()->AddChild(_batch.visual);
+  }
+  else
+  {
+    for (auto &marker : _batch.markers)
+    {
+      if (marker)
+        _batch.visual->RemoveGeometry(marker);
+    }
+  }
+
+  // All primitives share the material of the first element
+  msgs::Marker materialMsg;
+  *materialMsg.mutable_material() =
+      _batch.elements.begin()->second.material;
+  rendering::MaterialPtr material = this->MsgToMaterial(materialMsg);
+
+  for (std::size_t i = 0; i < kBatchTypeCount; ++i)
+  {
+    if (!used[i])
+      continue;
+
+    auto &marker = _batch.markers[i];
+    if (!marker)
+    {
+      marker = this->scene->CreateMarker();
+      marker->SetType(kBatchTypes[i]);
+    }
+    marker->SetMaterial(material, true /* clone */);
+    marker->ClearPoints();
+    for (const auto &element : _batch.elements)
+    {
+      const auto &diffuse = element.second.material.diffuse();
+      math::Color color(diffuse.r(), diffuse.g(), diffuse.b(), diffuse.a());
+      for (const auto &vertex : element.second.vertices[i])
+        marker->AddPoint(vertex, color);
+    }
+    _batch.visual->AddGeometry(marker);
+  }
+
+  // clean up material after clone
+  this->scene->DestroyMaterial(material);
 }
 
 /////////////////////////////////////////////////
@@ -621,6 +931,80 @@ void MarkerManagerPrivate::OnMarkerMsg(const msgs::Marker &_req)
   this->markerMsgs.push_back(_req);
 }
 
+/////////////////////////////////////////////////
+bool MarkerManagerPrivate::OnMarkerMsgBatch(
+    const msgs::Marker_V &_req, msgs::Boolean &_res)
+{
+  // Markers are expanded here, on the transport thread, so that the
+  // rendering thread only has to copy vertices
+  std::vector<std::pair<const msgs::Marker *, MarkerBatchElement>> added;
+  for (const auto &marker : _req.marker())
+  {
+    if (marker.action() != msgs::Marker::ADD_MODIFY)
+      continue;
+
+    MarkerBatchElement element;
+    if (expandMarker(marker, element))
+    {
+      element.material = marker.material();
+      added.emplace_back(&marker, std::move(element));
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(this->batchMutex);
+  bool success = true;
+  auto addedIt = added.begin();
+  for (const auto &marker : _req.marker())
+  {
+    if (marker.action() == msgs::Marker::ADD_MODIFY)
+    {
+      if (addedIt == added.end() || addedIt->first != &marker)
+      {
+        success = false;
+        continue;
+      }
+      auto &batch = this->batches[marker.ns()];
+      batch.elements[marker.id()] = std::move(addedIt->second);
+      batch.dirty = true;
+      ++addedIt;
+    }
+    else if (marker.action() == msgs::Marker::DELETE_MARKER)
+    {
+      auto batchIt = this->batches.find(marker.ns());
+      if (batchIt == this->batches.end() ||
+          batchIt->second.elements.erase(marker.id()) == 0u)
+      {
+        ignwarn << "Unable to delete batched marker with id["
+                << marker.id() << "] in namespace[" << marker.ns() << "]"
+                << std::endl;
+        success = false;
+        continue;
+      }
+      batchIt->second.dirty = true;
+    }
+    // Remove all markers of a batch, or of all batches
+    else if (marker.action() == msgs::Marker::DELETE_ALL)
+    {
+      for (auto &batch : this->batches)
+      {
+        if (marker.ns().empty() || batch.first == marker.ns())
+        {
+          batch.second.elements.clear();
+          batch.second.dirty = true;
+        }
+      }
+    }
+    else
+    {
+      ignerr << "Unknown marker action[" << marker.action() << "]\n";
+      success = false;
+    }
+  }
+
+  _res.set_data(success);
+  return true;
+}
+
 /////////////////////////////////////////////////
 bool MarkerManagerPrivate::OnMarkerMsgArray(
     const msgs::Marker_V&_req, msgs::Boolean &_res)
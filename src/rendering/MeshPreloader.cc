@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "ignition/gazebo/rendering/MeshPreloader.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sdf/Geometry.hh>
+#include <sdf/Mesh.hh>
+
+#include <ignition/common/ColladaLoader.hh>
+#include <ignition/common/Console.hh>
+#include <ignition/common/Mesh.hh>
+#include <ignition/common/MeshManager.hh>
+#include <ignition/common/OBJLoader.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/common/STLLoader.hh>
+#include <ignition/common/Util.hh>
+
+#include "ignition/gazebo/components/Geometry.hh"
+#include "ignition/gazebo/components/VisualLod.hh"
+#include "ignition/gazebo/Util.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Private data class
+class ignition::gazebo::MeshPreloaderPrivate
+{
+  /// \brief Worker thread loop, loads meshes until there are none left.
+  public: void Work();
+
+  /// \brief Parse a mesh file.
+  /// \param[in] _name Mesh name, see MeshPreloader::Meshes.
+  /// \return The mesh, or null if it couldn't be loaded.
+  public: static std::unique_ptr<common::Mesh> Parse(const std::string &_name);
+
+  /// \brief Meshes to load.
+  public: std::vector<std::string> meshes;
+
+  /// \brief Index of the next mesh to be picked by a worker.
+  public: std::atomic<std::size_t> next{0u};
+
+  /// \brief Number of meshes processed.
+  public: std::atomic<std::size_t> processed{0u};
+
+  /// \brief Worker threads.
+  public: std::vector<std::thread> threads;
+
+  /// \brief Parsed meshes waiting to be added to the mesh manager, keyed by
+  /// name. Protected by mutex.
+  public: std::vector<std::pair<std::string, std::unique_ptr<common::Mesh>>>
+      parsed;
+
+  /// \brief Protects parsed.
+  public: std::mutex mutex;
+
+  /// \brief Notified when a mesh is processed.
+  public: std::condition_variable cv;
+
+  /// \brief True once Start was called.
+  public: bool started{false};
+
+  /// \brief True once all meshes were added to the mesh manager.
+  public: bool committed{false};
+};
+
+//////////////////////////////////////////////////
+std::unique_ptr<common::Mesh> MeshPreloaderPrivate::Parse(
+    const std::string &_name)
+{
+  // Same lookup and loaders as common::MeshManager::Load, with one loader
+  // per call so files can be parsed concurrently
+  auto fullName = common::findFile(_name);
+  if (fullName.empty())
+    return nullptr;
+
+  auto dot = fullName.rfind('.');
+  if (dot == std::string::npos)
+    return nullptr;
+  auto extension = fullName.substr(dot + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+      [](unsigned char _c) { return std::tolower(_c); });
+
+  common::Mesh *mesh{nullptr};
+  if (extension == "dae")
+  {
+    common::ColladaLoader loader;
+    mesh = loader.Load(fullName);
+  }
+  else if (extension == "obj")
+  {
+    common::OBJLoader loader;
+    mesh = loader.Load(fullName);
+  }
+  else if (extension == "stl" || extension == "stlb" || extension == "stla")
+  {
+    common::STLLoader loader;
+    mesh = loader.Load(fullName);
+  }
+
+  if (nullptr != mesh)
+    mesh->SetName(_name);
+  return std::unique_ptr<common::Mesh>(mesh);
+}
+
+//////////////////////////////////////////////////
+void MeshPreloaderPrivate::Work()
+{
+  IGN_PROFILE_THREAD_NAME("MeshPreloader");
+  while (true)
+  {
+    auto index = this->next++;
+    if (index >= this->meshes.size())
+      return;
+
+    std::unique_ptr<common::Mesh> mesh;
+    {
+      IGN_PROFILE("MeshPreloader::Parse");
+      mesh = Parse(this->meshes[index]);
+    }
+    if (!mesh)
+    {
+      // It will fail again and be reported when it's used
+      igndbg << "Failed to preload mesh [" << this->meshes[index] << "]."
+             << std::endl;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if (mesh)
+        this->parsed.emplace_back(this->meshes[index], std::move(mesh));
+      ++this->processed;
+    }
+    this->cv.notify_all();
+  }
+}
+
+//////////////////////////////////////////////////
+MeshPreloader::MeshPreloader()
+  : dataPtr(std::make_unique<MeshPreloaderPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+MeshPreloader::~MeshPreloader()
+{
+  // Stop handing out meshes
+  this->dataPtr->next = this->dataPtr->meshes.size();
+  for (auto &thread : this->dataPtr->threads)
+  {
+    if (thread.joinable())
+      thread.join();
+  }
+}
+
+//////////////////////////////////////////////////
+std::set<std::string> MeshPreloader::Meshes(
+    const EntityComponentManager &_ecm)
+{
+  std::set<std::string> meshes;
+  _ecm.Each<components::Geometry>(
+      [&](const Entity &, const components::Geometry *_geom) -> bool
+      {
+        auto meshSdf = _geom->Data().MeshShape();
+        if (_geom->Data().Type() != sdf::GeometryType::MESH ||
+            nullptr == meshSdf)
+        {
+          return true;
+        }
+
+        auto fullPath = asFullPath(meshSdf->Uri(), meshSdf->FilePath());
+        if (!fullPath.empty())
+          meshes.insert(fullPath);
+        return true;
+      });
+
+  _ecm.Each<components::VisualLod>(
+      [&](const Entity &, const components::VisualLod *_lod) -> bool
+      {
+        for (const auto &level : _lod->Data())
+        {
+          if (!level.mesh.empty())
+            meshes.insert(level.mesh);
+        }
+        return true;
+      });
+  return meshes;
+}
+
+//////////////////////////////////////////////////
+void MeshPreloader::Start(const std::set<std::string> &_meshes,
+    unsigned int _threads)
+{
+  if (this->dataPtr->started)
+    return;
+  this->dataPtr->started = true;
+
+  auto meshManager = common::MeshManager::Instance();
+  for (const auto &mesh : _meshes)
+  {
+    if (!meshManager->HasMesh(mesh))
+      this->dataPtr->meshes.push_back(mesh);
+  }
+
+  if (this->dataPtr->meshes.empty())
+    return;
+
+  if (_threads == 0u)
+    _threads = std::max(1u, std::thread::hardware_concurrency());
+  _threads = std::min(_threads,
+      static_cast<unsigned int>(this->dataPtr->meshes.size()));
+
+  igndbg << "Preloading [" << this->dataPtr->meshes.size() << "] meshes on ["
+         << _threads << "] threads." << std::endl;
+
+  for (unsigned int i = 0; i < _threads; ++i)
+  {
+    this->dataPtr->threads.emplace_back(&MeshPreloaderPrivate::Work,
+        this->dataPtr.get());
+  }
+}
+
+//////////////////////////////////////////////////
+bool MeshPreloader::WaitFor(
+    const std::chrono::steady_clock::duration &_timeout)
+{
+  if (this->dataPtr->committed)
+    return true;
+
+  {
+    std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+    if (!this->dataPtr->cv.wait_for(lock, _timeout, [this]
+        {
+          return this->dataPtr->processed >= this->dataPtr->meshes.size();
+        }))
+    {
+      return false;
+    }
+  }
+
+  for (auto &thread : this->dataPtr->threads)
+  {
+    if (thread.joinable())
+      thread.join();
+  }
+
+  // Meshes are added by the caller instead of the workers, so the mesh
+  // manager is only modified from the threads that already use it
+  auto meshManager = common::MeshManager::Instance();
+  for (auto &[name, mesh] : this->dataPtr->parsed)
+  {
+    // May have been loaded by someone else in the meantime
+    if (!meshManager->HasMesh(name))
+      meshManager->AddMesh(mesh.release());
+  }
+  this->dataPtr->parsed.clear();
+  this->dataPtr->committed = true;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool MeshPreloader::Done() const
+{
+  return !this->dataPtr->started || this->dataPtr->committed ||
+      this->dataPtr->meshes.empty();
+}
+
+//////////////////////////////////////////////////
+std::size_t MeshPreloader::Processed() const
+{
+  return this->dataPtr->processed;
+}
+
+//////////////////////////////////////////////////
+std::size_t MeshPreloader::Total() const
+{
+  return this->dataPtr->meshes.size();
+}
@@ -15,11 +15,15 @@
  *
  */
 
+#include <algorithm>
+#include <chrono>
 #include <map>
+#include <mutex>
 #include <stack>
 #include <string>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <variant>
 #include <vector>
 
@@ -39,7 +43,9 @@
 #include <ignition/common/Skeleton.hh>
 #include <ignition/common/SkeletonAnimation.hh>
 
+#include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/Color.hh>
+#include <ignition/math/Frustum.hh>
 #include <ignition/math/Helpers.hh>
 #include <ignition/math/Matrix4.hh>
 #include <ignition/math/Pose3.hh>
@@ -52,6 +58,8 @@
 #include <ignition/rendering/Scene.hh>
 
 #include "ignition/gazebo/components/Actor.hh"
+#include "ignition/gazebo/components/AngularVelocity.hh"
+#include "ignition/gazebo/components/AxisAlignedBox.hh"
 #include "ignition/gazebo/components/BoundingBoxCamera.hh"
 #include "ignition/gazebo/components/Camera.hh"
 #include "ignition/gazebo/components/CastShadows.hh"
@@ -67,6 +75,7 @@
 #include "ignition/gazebo/components/LaserRetro.hh"
 #include "ignition/gazebo/components/Light.hh"
 #include "ignition/gazebo/components/LightCmd.hh"
+#include "ignition/gazebo/components/LinearVelocity.hh"
 #include "ignition/gazebo/components/Link.hh"
 #include "ignition/gazebo/components/Material.hh"
 #include "ignition/gazebo/components/Model.hh"
@@ -88,6 +97,7 @@
 #include "ignition/gazebo/components/Visibility.hh"
 #include "ignition/gazebo/components/Visual.hh"
 #include "ignition/gazebo/components/VisualCmd.hh"
+#include "ignition/gazebo/components/VisualLod.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 
@@ -101,6 +111,45 @@
 using namespace ignition;
 using namespace gazebo;
 
+/// \brief Render engines used by RenderUtil instances in this process.
+/// Scenes of the same engine share GPU resources such as meshes and
+/// textures, which are only uploaded once. Scenes of different engines
+/// can't share them.
+struct EngineUsage
+{
+  /// \brief Protects count.
+  std::mutex mutex;
+
+  /// \brief Key: Engine name. Value: Number of initialized RenderUtil
+  /// instances using it.
+  std::map<std::string, unsigned int> count;
+};
+
+/// \brief Get the process-wide engine usage.
+/// \return Engine usage.
+static EngineUsage &engineUsage()
+{
+  static EngineUsage usage;
+  return usage;
+}
+
+/// \brief Latest pose received for an entity and how fast it was moving,
+/// used to extrapolate its pose between updates.
+struct PoseMotion
+{
+  /// \brief Last received pose, relative to the parent.
+  math::Pose3d pose;
+
+  /// \brief Linear velocity in the parent frame.
+  math::Vector3d linear;
+
+  /// \brief Angular velocity in the parent frame.
+  math::Vector3d angular;
+
+  /// \brief Simulation time the pose was received at.
+  std::chrono::steady_clock::duration simTime{0};
+};
+
 // Private data class.
 class ignition::gazebo::RenderUtilPrivate
 {
@@ -138,6 +187,49 @@ class ignition::gazebo::RenderUtilPrivate
   /// \param[in] _ecm The entity-component manager
   public: void UpdateRenderingEntities(const EntityComponentManager &_ecm);
 
+  /// \brief Apply pose updates to the scene, skipping models that are
+  /// outside the frusta of all cameras if frustum culling is enabled.
+  /// \param[in] _entityPoses Poses received from the ECM. Poses that were
+  /// culled before are added to it.
+  public: void UpdatePoses(
+      std::unordered_map<Entity, math::Pose3d> &_entityPoses);
+
+  /// \brief Keep track of how entities move and, between updates, add
+  /// their extrapolated poses to the poses to be applied.
+  /// \param[in,out] _entityPoses Poses received from the ECM since the
+  /// last call. Extrapolated poses are added to it.
+  /// \param[in] _velocities World velocities received with the poses.
+  /// \param[in] _removed Entities that are being removed.
+  /// \param[in] _simTime Simulation time of the last ECM update.
+  /// \param[in] _paused Whether simulation was paused at that update.
+  public: void ExtrapolatePoses(
+      std::unordered_map<Entity, math::Pose3d> &_entityPoses,
+      const std::unordered_map<Entity,
+          std::pair<math::Vector3d, math::Vector3d>> &_velocities,
+      const std::unordered_map<Entity, uint64_t> &_removed,
+      const std::chrono::steady_clock::duration &_simTime, bool _paused);
+
+  /// \brief Set the local pose of a node, unless it's being manipulated.
+  /// \param[in] _node Node to update.
+  /// \param[in] _entity Entity the pose belongs to.
+  /// \param[in] _pose New local pose.
+  public: void ApplyPose(const rendering::NodePtr &_node, Entity _entity,
+      const math::Pose3d &_pose);
+
+  /// \brief Get the frusta of all cameras in the scene.
+  /// \param[out] _frusta Frustum of each camera.
+  /// \param[out] _cameraNodes IDs of the cameras and all their ancestors.
+  /// \return False if some sensor can't be represented by a frustum, such
+  /// as a lidar or a camera with a field of view wider than 180 degrees,
+  /// in which case nothing can be culled.
+  public: bool CameraFrusta(std::vector<math::Frustum> &_frusta,
+      std::unordered_set<uint64_t> &_cameraNodes) const;
+
+  /// \brief Get the poses of all rendered entities other than actors,
+  /// whether they changed or not.
+  /// \param[in] _ecm The entity-component manager
+  public: void UpdateAllPoses(const EntityComponentManager &_ecm);
+
   /// \breif Helper function to add new sensors
   /// \param[in] _ecm The entity-component manager
   /// \param[in] _entity Sensor entity
@@ -199,6 +291,10 @@ class ignition::gazebo::RenderUtilPrivate
   /// \brief Event manager used for emitting render / scene events
   public: EventManager *eventManager{nullptr};
 
+  /// \brief Scene update event, looked up once since it's emitted every
+  /// frame. Null without an event manager.
+  public: events::SceneUpdate *sceneUpdateEvent{nullptr};
+
   /// \brief Total time elapsed in simulation. This will not increase while
   /// paused.
   public: std::chrono::steady_clock::duration simTime{0};
@@ -206,12 +302,74 @@ class ignition::gazebo::RenderUtilPrivate
   /// \brief Name of rendering engine
   public: std::string engineName = "ogre2";
 
+  /// \brief Name of the engine which was actually loaded by Init, empty
+  /// until then. Used to track the engines in use in this process.
+  public: std::string loadedEngineName;
+
   /// \brief Name of scene
   public: std::string sceneName = "scene";
 
   //// \brief True to enable sky in the scene
   public: bool skyEnabled = false;
 
+  /// \brief True to only sync poses that were marked as changed in the ECM
+  public: bool incrementalUpdates = false;
+
+  /// \brief True to skip pose updates of models outside all camera frusta
+  public: bool frustumCulling = false;
+
+  /// \brief Distance bounding boxes are grown by on each side before being
+  /// tested against camera frusta.
+  public: double frustumCullingMargin = 1.0;
+
+  /// \brief World bounding boxes of models, gathered from the ECM.
+  public: std::unordered_map<Entity, math::AxisAlignedBox> entityBoxes;
+
+  /// \brief True if entityBoxes was filled since the last Update.
+  public: bool newEntityBoxes = false;
+
+  /// \brief Bounding boxes used by the rendering thread for culling.
+  public: std::unordered_map<Entity, math::AxisAlignedBox> cullingBoxes;
+
+  /// \brief Bounding box of each model the last time poses in its subtree
+  /// were applied, which is where its visuals currently are.
+  public: std::unordered_map<Entity, math::AxisAlignedBox> appliedBoxes;
+
+  /// \brief Latest poses that were culled and haven't been applied yet.
+  public: std::unordered_map<Entity, math::Pose3d> culledPoses;
+
+  /// \brief True to extrapolate poses between ECM updates.
+  public: bool poseExtrapolation = false;
+
+  /// \brief Maximum simulation time in seconds poses are extrapolated
+  /// past the last update.
+  public: double maxExtrapolationTime = 0.2;
+
+  /// \brief Whether simulation was paused at the last ECM update.
+  public: bool paused = true;
+
+  /// \brief World linear and angular velocities of top level models
+  /// received since the last Update, used instead of finite differences.
+  public: std::unordered_map<Entity,
+      std::pair<math::Vector3d, math::Vector3d>> entityVelocities;
+
+  /// \brief Motion of each entity whose pose was received, only used by
+  /// the rendering thread.
+  public: std::unordered_map<Entity, PoseMotion> poseMotions;
+
+  /// \brief Entities with a non zero velocity in poseMotions.
+  public: std::unordered_set<Entity> movingEntities;
+
+  /// \brief Simulation time of the last batch of poses.
+  public: std::chrono::steady_clock::duration lastPoseSimTime{-1};
+
+  /// \brief Wall time the last batch of poses was received at.
+  public: std::chrono::steady_clock::time_point lastPoseWallTime;
+
+  /// \brief Estimated ratio of simulation time to wall time, used to
+  /// convert the wall time since the last batch into simulation time.
+  public: double simRate = 1.0;
+
   /// \brief Scene background color. This is optional because a <scene> is
   /// always present, which has a default background color value. This
   /// backgroundColor variable is used to override the <scene> value.
@@ -328,8 +486,15 @@ class ignition::gazebo::RenderUtilPrivate
             }};
 
   /// \brief A map of entity ids and actor transforms.
-  public: std::map<Entity, std::map<std::string, math::Matrix4d>>
-                          actorTransforms;
+  public: std::map<Entity, ActorSkeletonFrame> actorTransforms;
+
+  /// \brief Bone transforms handed to the render engine, reused between
+  /// actors whose frames share the same bone names.
+  public: std::map<std::string, math::Matrix4d> skeletonLocalTransforms;
+
+  /// \brief Bone names skeletonLocalTransforms was filled with.
+  public: std::shared_ptr<const std::vector<std::string>>
+      skeletonLocalTransformsBones;
 
   /// \brief A map of entity ids and temperature data.
   /// The value of this map (tuple) represents either a single (uniform)
@@ -348,6 +513,26 @@ class ignition::gazebo::RenderUtilPrivate
   /// \brief A map of entity ids and label data for datasets annotations
   public: std::unordered_map<Entity, int> entityLabel;
 
+  /// \brief Temperatures last set on each visual, in the same format as
+  /// entityTemp, so that unchanged temperatures aren't set again.
+  public: std::unordered_map<Entity, std::tuple<float, float, std::string>>
+      visualTemps;
+
+  /// \brief Labels last set on each visual, so that unchanged labels
+  /// aren't set again.
+  public: std::unordered_map<Entity, int> visualLabels;
+
+  /// \brief Latest version of the label components seen by
+  /// UpdateRenderingEntities. \sa EntityComponentManager::ComponentVersion
+  public: uint64_t labelVersion{0u};
+
+  /// \brief Latest version of the temperature components seen by
+  /// UpdateRenderingEntities.
+  public: uint64_t temperatureVersion{0u};
+
+  /// \brief A map of new visual entity ids and their levels of detail
+  public: std::unordered_map<Entity, std::vector<lod::Level>> entityLods;
+
   /// \brief A map of entity ids and wire boxes
   public: std::unordered_map<Entity, ignition::rendering::WireBoxPtr> wireBoxes;
 
@@ -567,6 +752,21 @@ class ignition::gazebo::RenderUtilPrivate
   public: std::unordered_map<Entity,
       std::tuple<double, components::TemperatureRangeInfo>> thermalCameraData;
 
+  /// \brief Get the temperature of an entity, which is either uniform or
+  /// a heat signature, in the format of entityTemp.
+  /// \param[in] _ecm The entity-component manager
+  /// \param[in] _entity Entity.
+  /// \param[out] _temp Temperature.
+  /// \return False if the entity has no temperature.
+  public: static bool EntityTemperature(const EntityComponentManager &_ecm,
+      const Entity _entity, std::tuple<float, float, std::string> &_temp);
+
+  /// \brief Queue the labels and temperatures which changed since the last
+  /// call. They rarely change, so entities are only searched when a
+  /// component of their types changed.
+  /// \param[in] _ecm The entity-component manager
+  public: void UpdateLabelsAndTemperatures(const EntityComponentManager &_ecm);
+
   /// \brief Update the visuals with label user data
   /// \param[in] _entityLabel Map with key visual entity id and value label
   public: void UpdateVisualLabels(
@@ -620,7 +820,17 @@ RenderUtil::RenderUtil() : dataPtr(std::make_unique<RenderUtilPrivate>())
 }
 
 //////////////////////////////////////////////////
-RenderUtil::~RenderUtil() = default;
+RenderUtil::~RenderUtil()
+{
+  if (this->dataPtr->loadedEngineName.empty())
+    return;
+
+  auto &usage = engineUsage();
+  std::lock_guard<std::mutex> lock(usage.mutex);
+  auto it = usage.count.find(this->dataPtr->loadedEngineName);
+  if (it != usage.count.end() && --it->second == 0u)
+    usage.count.erase(it);
+}
 
 //////////////////////////////////////////////////
 rendering::ScenePtr RenderUtil::Scene() const
@@ -806,9 +1016,47 @@ void RenderUtil::UpdateFromECM(const UpdateInfo &_info,
   IGN_PROFILE("RenderUtil::UpdateFromECM");
   std::lock_guard<std::mutex> lock(this->dataPtr->updateMutex);
   this->dataPtr->simTime = _info.simTime;
+  this->dataPtr->paused = _info.paused;
 
   this->dataPtr->CreateRenderingEntities(_ecm, _info);
   this->dataPtr->UpdateRenderingEntities(_ecm);
+
+  if (this->dataPtr->poseExtrapolation)
+  {
+    for (const auto &pose : this->dataPtr->entityPoses)
+    {
+      auto linear = _ecm.Component<components::WorldLinearVelocity>(
+          pose.first);
+      auto angular = _ecm.Component<components::WorldAngularVelocity>(
+          pose.first);
+      if (!linear || !angular)
+        continue;
+
+      // Poses are relative to the parent, so world velocities only apply
+      // to entities that are children of the world
+      auto parent = _ecm.Component<components::ParentEntity>(pose.first);
+      if (!parent || !_ecm.Component<components::World>(parent->Data()))
+        continue;
+
+      this->dataPtr->entityVelocities[pose.first] =
+          {linear->Data(), angular->Data()};
+    }
+  }
+
+  if (this->dataPtr->frustumCulling)
+  {
+    this->dataPtr->entityBoxes.clear();
+    _ecm.Each<components::Model, components::AxisAlignedBox>(
+        [&](const Entity &_entity, const components::Model *,
+            const components::AxisAlignedBox *_box)->bool
+        {
+          // Boxes that haven't been computed yet are empty
+          if (_box->Data().Min().X() <= _box->Data().Max().X())
+            this->dataPtr->entityBoxes[_entity] = _box->Data();
+          return true;
+        });
+    this->dataPtr->newEntityBoxes = true;
+  }
   this->dataPtr->RemoveRenderingEntities(_ecm, _info);
   this->dataPtr->markerManager.SetSimTime(_info.simTime);
   this->dataPtr->PopulateViewModeVisualLinks(_ecm);
@@ -1083,6 +1331,10 @@ void RenderUtil::Update()
     std::move(this->dataPtr->newParticleEmittersCmds);
   auto removeEntities = std::move(this->dataPtr->removeEntities);
   auto entityPoses = std::move(this->dataPtr->entityPoses);
+  auto entityVelocities = std::move(this->dataPtr->entityVelocities);
+  auto simTime = this->dataPtr->simTime;
+  auto paused = this->dataPtr->paused;
+  auto poseExtrapolation = this->dataPtr->poseExtrapolation;
   auto entityLights = std::move(this->dataPtr->entityLights);
   auto entityVisuals = std::move(this->dataPtr->entityVisuals);
   auto updateJointParentPoses =
@@ -1092,6 +1344,7 @@ void RenderUtil::Update()
   auto actorAnimationData = std::move(this->dataPtr->actorAnimationData);
   auto entityTemp = std::move(this->dataPtr->entityTemp);
   auto entityLabel = std::move(this->dataPtr->entityLabel);
+  auto entityLods = std::move(this->dataPtr->entityLods);
   auto newTransparentVisualLinks =
     std::move(this->dataPtr->newTransparentVisualLinks);
   auto newInertiaLinks = std::move(this->dataPtr->newInertiaLinks);
@@ -1112,6 +1365,7 @@ void RenderUtil::Update()
   this->dataPtr->newParticleEmittersCmds.clear();
   this->dataPtr->removeEntities.clear();
   this->dataPtr->entityPoses.clear();
+  this->dataPtr->entityVelocities.clear();
   this->dataPtr->entityLights.clear();
   this->dataPtr->entityVisuals.clear();
   this->dataPtr->updateJointParentPoses.clear();
@@ -1120,6 +1374,7 @@ void RenderUtil::Update()
   this->dataPtr->actorAnimationData.clear();
   this->dataPtr->entityTemp.clear();
   this->dataPtr->entityLabel.clear();
+  this->dataPtr->entityLods.clear();
   this->dataPtr->newTransparentVisualLinks.clear();
   this->dataPtr->newInertiaLinks.clear();
   this->dataPtr->newJointModels.clear();
@@ -1128,6 +1383,13 @@ void RenderUtil::Update()
   this->dataPtr->newCollisionLinks.clear();
   this->dataPtr->thermalCameraData.clear();
 
+  if (this->dataPtr->newEntityBoxes)
+  {
+    this->dataPtr->cullingBoxes = std::move(this->dataPtr->entityBoxes);
+    this->dataPtr->entityBoxes.clear();
+    this->dataPtr->newEntityBoxes = false;
+  }
+
   this->dataPtr->markerManager.Update();
 
   std::vector<std::tuple<Entity, sdf::Sensor, Entity>> newSensors;
@@ -1174,6 +1436,10 @@ void RenderUtil::Update()
           this->dataPtr->selectedEntities.end(), entity.first),
           this->dataPtr->selectedEntities.end());
       this->dataPtr->sceneManager.RemoveEntity(entity.first);
+      this->dataPtr->appliedBoxes.erase(entity.first);
+      this->dataPtr->culledPoses.erase(entity.first);
+      this->dataPtr->visualTemps.erase(entity.first);
+      this->dataPtr->visualLabels.erase(entity.first);
 
       this->dataPtr->RemoveSensor(entity.first);
       this->dataPtr->RemoveBoundingBox(entity.first);
@@ -1216,6 +1482,9 @@ void RenderUtil::Update()
           std::get<0>(visual), std::get<1>(visual), std::get<2>(visual));
     }
 
+    for (const auto &lod : entityLods)
+      this->dataPtr->sceneManager.SetVisualLod(lod.first, lod.second);
+
     for (const auto &actor : newActors)
     {
       this->dataPtr->sceneManager.CreateActor(
@@ -1283,6 +1552,11 @@ void RenderUtil::Update()
 
         std::string sensorName =
             this->dataPtr->createSensorCb(entity, dataSdf, parentNode->Name());
+        // An empty name means the callback didn't create the sensor, it's
+        // responsible for reporting errors
+        if (sensorName.empty())
+          continue;
+
         // Add to the system's scene manager
         if (!this->dataPtr->sceneManager.AddSensor(entity, sensorName, parent))
         {
@@ -1298,36 +1572,12 @@ void RenderUtil::Update()
   // update entities' pose
   {
     IGN_PROFILE("RenderUtil::Update Poses");
-    for (const auto &pose : entityPoses)
+    if (poseExtrapolation)
     {
-      auto node = this->dataPtr->sceneManager.NodeById(pose.first);
-      if (!node)
-        continue;
-
-      // Don't move entity being manipulated (last selected)
-      // TODO(anyone) Check top level visual instead of parent
-      auto vis = std::dynamic_pointer_cast<rendering::Visual>(node);
-      int updateNode = 0;
-      Entity entityId = kNullEntity;
-      if (vis)
-      {
-        // Get information from the visual's user data to indicate if
-        // the render thread should pause updating it's true location,
-        // this functionality is needed for temporal placement of a
-        // visual such as an align preview
-        updateNode = std::get<int>(vis->UserData("pause-update"));
-        entityId = std::get<int>(vis->UserData("gazebo-entity"));
-      }
-      if ((this->dataPtr->transformActive &&
-          (pose.first == this->dataPtr->selectedEntities.back() ||
-          entityId == this->dataPtr->selectedEntities.back())) ||
-          updateNode)
-      {
-        continue;
-      }
-
-      node->SetLocalPose(pose.second);
+      this->dataPtr->ExtrapolatePoses(entityPoses, entityVelocities,
+          removeEntities, simTime, paused);
     }
+    this->dataPtr->UpdatePoses(entityPoses);
 
     // update entities' local transformations
     if (this->dataPtr->actorManualSkeletonUpdate)
@@ -1358,8 +1608,8 @@ void RenderUtil::Update()
         // Trajectory from the SDF script
         else
         {
-          trajPose.Pos() = tf.second["actorPose"].Translation();
-          trajPose.Rot() = tf.second["actorPose"].Rotation();
+          trajPose.Pos() = tf.second.actorPose.Translation();
+          trajPose.Rot() = tf.second.actorPose.Rotation();
         }
 
         math::Pose3d worldPose = globalPose * trajPose;
@@ -1370,8 +1620,27 @@ void RenderUtil::Update()
           this->dataPtr->actorWorldPoses[tf.first] = worldPose;
         }
 
-        tf.second.erase("actorPose");
-        actorMesh->SetSkeletonLocalTransforms(tf.second);
+        // Frames are sorted by bone name, so the map only needs to be
+        // rebuilt when the bones change, otherwise its values are
+        // overwritten in order
+        const auto &bones = tf.second.boneNames;
+        auto &localTransforms = this->dataPtr->skeletonLocalTransforms;
+        if (!bones)
+          continue;
+        if (bones != this->dataPtr->skeletonLocalTransformsBones)
+        {
+          localTransforms.clear();
+          for (std::size_t i = 0; i < bones->size(); ++i)
+            localTransforms[(*bones)[i]] = tf.second.transforms[i];
+          this->dataPtr->skeletonLocalTransformsBones = bones;
+        }
+        else
+        {
+          std::size_t i = 0u;
+          for (auto &bone : localTransforms)
+            bone.second = tf.second.transforms[i++];
+        }
+        actorMesh->SetSkeletonLocalTransforms(localTransforms);
       }
     }
     else
@@ -1381,9 +1650,16 @@ void RenderUtil::Update()
     }
   }
 
-  // set visual temperature
+  // set visual temperature, skipping visuals which already have it
   for (const auto &temp : entityTemp)
   {
+    auto pushed = this->dataPtr->visualTemps.find(temp.first);
+    if (pushed != this->dataPtr->visualTemps.end() &&
+        pushed->second == temp.second)
+    {
+      continue;
+    }
+
     auto node = this->dataPtr->sceneManager.NodeById(temp.first);
     if (!node)
       continue;
@@ -1401,6 +1677,7 @@ void RenderUtil::Update()
       visual->SetUserData("maxTemp", std::get<1>(temp.second));
       visual->SetUserData("temperature", heatSignature);
     }
+    this->dataPtr->visualTemps[temp.first] = temp.second;
   }
 
   this->dataPtr->UpdateVisualLabels(entityLabel);
@@ -1598,7 +1875,8 @@ void RenderUtil::Update()
         for (auto g = 0u; g < vis->GeometryCount(); ++g)
         {
           rendering::GeometryPtr geom = vis->GeometryByIndex(g);
-          rendering::MaterialPtr geomMat = geom->Material();
+          rendering::MaterialPtr geomMat =
+              this->dataPtr->sceneManager.UniqueMaterial(geom);
           if (!geomMat)
             continue;
 
@@ -1635,8 +1913,11 @@ void RenderUtil::Update()
     }
   }
 
-  if (this->dataPtr->eventManager)
-    this->dataPtr->eventManager->Emit<events::SceneUpdate>();
+  // Poses are up to date, pick levels of detail for the cameras' positions
+  this->dataPtr->sceneManager.UpdateLods();
+
+  if (this->dataPtr->sceneUpdateEvent)
+    this->dataPtr->sceneUpdateEvent->Signal();
 }
 
 //////////////////////////////////////////////////
@@ -2216,35 +2497,24 @@ void RenderUtilPrivate::UpdateRenderingEntities(
     const EntityComponentManager &_ecm)
 {
   IGN_PROFILE("RenderUtilPrivate::UpdateRenderingEntities");
-  _ecm.Each<components::Model, components::Pose>(
-      [&](const Entity &_entity,
-        const components::Model *,
-        const components::Pose *_pose)->bool
-      {
-        this->entityPoses[_entity] = _pose->Data();
-        return true;
-      });
-
-  _ecm.Each<components::Link, components::Pose>(
-      [&](const Entity &_entity,
-        const components::Link *,
-        const components::Pose *_pose)->bool
-      {
-        this->entityPoses[_entity] = _pose->Data();
-        return true;
-      });
+  this->UpdateLabelsAndTemperatures(_ecm);
 
-  // visuals
-  _ecm.Each<components::Visual, components::Pose >(
-      [&](const Entity &_entity,
-        const components::Visual *,
-        const components::Pose *_pose)->bool
-      {
-        this->entityPoses[_entity] = _pose->Data();
-        return true;
-      });
+  if (this->incrementalUpdates)
+  {
+    // Entities that aren't rendered are skipped when the poses are applied
+    _ecm.EachChanged<components::Pose>(
+        [&](const Entity &_entity, const components::Pose *_pose)->bool
+        {
+          this->entityPoses[_entity] = _pose->Data();
+          return true;
+        });
+  }
+  else
+  {
+    this->UpdateAllPoses(_ecm);
+  }
 
-  // actors
+  // actors are animated every update, even if their poses don't change
   _ecm.Each<components::Actor, components::Pose>(
       [&](const Entity &_entity,
         const components::Actor *,
@@ -2276,9 +2546,12 @@ void RenderUtilPrivate::UpdateRenderingEntities(
         // Bone poses calculated by ign-common
         else if (this->actorManualSkeletonUpdate)
         {
-          this->actorTransforms[_entity] =
-              this->sceneManager.ActorSkeletonTransformsAt(
-              _entity, this->simTime);
+          ActorSkeletonFrame frame;
+          if (this->sceneManager.ActorSkeletonFrameAt(
+              _entity, this->simTime, frame))
+          {
+            this->actorTransforms[_entity] = std::move(frame);
+          }
         }
         // Trajectory info from SDF so ign-rendering can calculate bone poses
         else
@@ -2298,6 +2571,38 @@ void RenderUtilPrivate::UpdateRenderingEntities(
           this->trajectoryPoses[_entity] = trajPoseComp->Data();
         return true;
       });
+}
+
+//////////////////////////////////////////////////
+void RenderUtilPrivate::UpdateAllPoses(const EntityComponentManager &_ecm)
+{
+  _ecm.Each<components::Model, components::Pose>(
+      [&](const Entity &_entity,
+        const components::Model *,
+        const components::Pose *_pose)->bool
+      {
+        this->entityPoses[_entity] = _pose->Data();
+        return true;
+      });
+
+  _ecm.Each<components::Link, components::Pose>(
+      [&](const Entity &_entity,
+        const components::Link *,
+        const components::Pose *_pose)->bool
+      {
+        this->entityPoses[_entity] = _pose->Data();
+        return true;
+      });
+
+  // visuals
+  _ecm.Each<components::Visual, components::Pose >(
+      [&](const Entity &_entity,
+        const components::Visual *,
+        const components::Pose *_pose)->bool
+      {
+        this->entityPoses[_entity] = _pose->Data();
+        return true;
+      });
 
   // update lights
   _ecm.Each<components::Light, components::Pose>(
@@ -2380,6 +2685,285 @@ void RenderUtilPrivate::UpdateRenderingEntities(
       });
 }
 
+//////////////////////////////////////////////////
+void RenderUtilPrivate::ExtrapolatePoses(
+    std::unordered_map<Entity, math::Pose3d> &_entityPoses,
+    const std::unordered_map<Entity,
+        std::pair<math::Vector3d, math::Vector3d>> &_velocities,
+    const std::unordered_map<Entity, uint64_t> &_removed,
+    const std::chrono::steady_clock::duration &_simTime, bool _paused)
+{
+  IGN_PROFILE("RenderUtil::ExtrapolatePoses");
+  for (const auto &removed : _removed)
+  {
+    this->poseMotions.erase(removed.first);
+    this->movingEntities.erase(removed.first);
+  }
+
+  auto wallNow = std::chrono::steady_clock::now();
+  auto prevSimTime = this->lastPoseSimTime;
+  bool newBatch = _simTime != prevSimTime;
+  if (newBatch)
+  {
+    if (prevSimTime.count() >= 0 && _simTime > prevSimTime)
+    {
+      double simDt =
+          std::chrono::duration<double>(_simTime - prevSimTime).count();
+      double wallDt = std::chrono::duration<double>(
+          wallNow - this->lastPoseWallTime).count();
+      if (wallDt > 0.0)
+        this->simRate = 0.8 * this->simRate + 0.2 * (simDt / wallDt);
+    }
+    this->lastPoseSimTime = _simTime;
+    this->lastPoseWallTime = wallNow;
+  }
+
+  // Received poses are applied as they are, and tell how fast entities
+  // are moving
+  for (const auto &pose : _entityPoses)
+  {
+    auto [it, inserted] = this->poseMotions.try_emplace(pose.first);
+    auto &motion = it->second;
+    auto velIt = _velocities.find(pose.first);
+    if (velIt != _velocities.end())
+    {
+      motion.linear = velIt->second.first;
+      motion.angular = velIt->second.second;
+    }
+    // Finite differences are only used if the previous pose came with the
+    // previous batch, otherwise the entity may have been still in between
+    else if (newBatch && !inserted && motion.simTime == prevSimTime &&
+        _simTime > prevSimTime)
+    {
+      double dt =
+          std::chrono::duration<double>(_simTime - motion.simTime).count();
+      motion.linear = (pose.second.Pos() - motion.pose.Pos()) / dt;
+
+      math::Vector3d axis;
+      double angle;
+      (pose.second.Rot() * motion.pose.Rot().Inverse()).AxisAngle(
+          axis, angle);
+      if (angle > IGN_PI)
+        angle -= 2 * IGN_PI;
+      motion.angular = axis * angle / dt;
+    }
+    else
+    {
+      motion.linear = math::Vector3d::Zero;
+      motion.angular = math::Vector3d::Zero;
+    }
+    motion.pose = pose.second;
+    motion.simTime = _simTime;
+
+    if (motion.linear == math::Vector3d::Zero &&
+        motion.angular == math::Vector3d::Zero)
+    {
+      this->movingEntities.erase(pose.first);
+    }
+    else
+    {
+      this->movingEntities.insert(pose.first);
+    }
+  }
+
+  // Entities that were moving but didn't come with a new batch, or that
+  // are moving while simulation is paused, are put back where they were
+  // last received
+  for (auto it = this->movingEntities.begin();
+       it != this->movingEntities.end();)
+  {
+    auto &motion = this->poseMotions[*it];
+    if ((newBatch && motion.simTime != _simTime) || _paused)
+    {
+      motion.linear = math::Vector3d::Zero;
+      motion.angular = math::Vector3d::Zero;
+      _entityPoses[*it] = motion.pose;
+      it = this->movingEntities.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  if (newBatch || _paused)
+    return;
+
+  double dt = std::chrono::duration<double>(
+      wallNow - this->lastPoseWallTime).count() * this->simRate;
+  dt = std::min(dt, this->maxExtrapolationTime);
+  for (auto entity : this->movingEntities)
+  {
+    if (_entityPoses.find(entity) != _entityPoses.end())
+      continue;
+
+    const auto &motion = this->poseMotions[entity];
+    math::Pose3d pose = motion.pose;
+    pose.Pos() += motion.linear * dt;
+    double speed = motion.angular.Length();
+    if (speed > 0.0)
+    {
+      pose.Rot() =
+          math::Quaterniond(motion.angular / speed, speed * dt) * pose.Rot();
+    }
+    _entityPoses[entity] = pose;
+  }
+}
+
+//////////////////////////////////////////////////
+void RenderUtilPrivate::UpdatePoses(
+    std::unordered_map<Entity, math::Pose3d> &_entityPoses)
+{
+  std::vector<math::Frustum> frusta;
+  std::unordered_set<uint64_t> cameraNodes;
+  bool cull = this->frustumCulling && !this->cullingBoxes.empty() &&
+      this->CameraFrusta(frusta, cameraNodes) && !frusta.empty();
+
+  // Retry poses that were culled before, newer poses take precedence
+  if (cull)
+  {
+    _entityPoses.insert(this->culledPoses.begin(), this->culledPoses.end());
+  }
+  else
+  {
+    for (const auto &pose : this->culledPoses)
+    {
+      if (auto node = this->sceneManager.NodeById(pose.first))
+        this->ApplyPose(node, pose.first, pose.second);
+    }
+  }
+  this->culledPoses.clear();
+
+  // Poses of entities whose models may be culled. Everything else, including
+  // cameras and their ancestors, is updated right away, so the frusta are
+  // computed from the cameras' latest poses.
+  std::vector<std::tuple<rendering::NodePtr, Entity, Entity>> deferred;
+  for (const auto &pose : _entityPoses)
+  {
+    auto node = this->sceneManager.NodeById(pose.first);
+    if (!node)
+      continue;
+
+    // Find the closest model with a bounding box
+    Entity model{kNullEntity};
+    for (auto n = node; cull && n; n = n->Parent())
+    {
+      if (cameraNodes.find(n->Id()) != cameraNodes.end())
+        break;
+      if (this->cullingBoxes.find(n->Id()) != this->cullingBoxes.end())
+      {
+        model = n->Id();
+        break;
+      }
+    }
+
+    if (model == kNullEntity)
+      this->ApplyPose(node, pose.first, pose.second);
+    else
+      deferred.emplace_back(node, pose.first, model);
+  }
+
+  if (deferred.empty())
+    return;
+
+  // Refresh the frusta now that the cameras have moved
+  frusta.clear();
+  this->CameraFrusta(frusta, cameraNodes);
+
+  auto visible = [&](const math::AxisAlignedBox &_box)
+  {
+    math::Vector3d margin(this->frustumCullingMargin,
+        this->frustumCullingMargin, this->frustumCullingMargin);
+    math::AxisAlignedBox grown(_box.Min() - margin, _box.Max() + margin);
+    for (const auto &frustum : frusta)
+    {
+      if (frustum.Contains(grown))
+        return true;
+    }
+    return false;
+  };
+
+  // A model's subtree is only skipped if the model is out of view both where
+  // it is now and where its visuals were last placed
+  std::unordered_map<Entity, bool> modelVisible;
+  for (const auto &[node, entity, model] : deferred)
+  {
+    auto visibleIt = modelVisible.find(model);
+    if (visibleIt == modelVisible.end())
+    {
+      const auto &box = this->cullingBoxes[model];
+      auto appliedIt = this->appliedBoxes.find(model);
+      bool show = visible(box) || appliedIt == this->appliedBoxes.end() ||
+          visible(appliedIt->second);
+      if (show)
+        this->appliedBoxes[model] = box;
+      visibleIt = modelVisible.emplace(model, show).first;
+    }
+
+    if (visibleIt->second)
+      this->ApplyPose(node, entity, _entityPoses[entity]);
+    else
+      this->culledPoses[entity] = _entityPoses[entity];
+  }
+}
+
+//////////////////////////////////////////////////
+void RenderUtilPrivate::ApplyPose(const rendering::NodePtr &_node,
+    Entity _entity, const math::Pose3d &_pose)
+{
+  // Don't move entity being manipulated (last selected)
+  // TODO(anyone) Check top level visual instead of parent
+  auto vis = std::dynamic_pointer_cast<rendering::Visual>(_node);
+  int updateNode = 0;
+  Entity entityId = kNullEntity;
+  if (vis)
+  {
+    // Get information from the visual's user data to indicate if
+    // the render thread should pause updating it's true location,
+    // this functionality is needed for temporal placement of a
+    // visual such as an align preview
+    updateNode = std::get<int>(vis->UserData("pause-update"));
+    entityId = std::get<int>(vis->UserData("gazebo-entity"));
+  }
+  if ((this->transformActive &&
+      (_entity == this->selectedEntities.back() ||
+      entityId == this->selectedEntities.back())) ||
+      updateNode)
+  {
+    return;
+  }
+
+  _node->SetLocalPose(_pose);
+}
+
+//////////////////////////////////////////////////
+bool RenderUtilPrivate::CameraFrusta(std::vector<math::Frustum> &_frusta,
+    std::unordered_set<uint64_t> &_cameraNodes) const
+{
+  if (!this->scene)
+    return false;
+
+  for (unsigned int i = 0; i < this->scene->SensorCount(); ++i)
+  {
+    auto sensor = this->scene->SensorByIndex(i);
+    auto camera = std::dynamic_pointer_cast<rendering::Camera>(sensor);
+
+    // Lidars render in several directions at once
+    if (!camera || std::dynamic_pointer_cast<rendering::GpuRays>(sensor) ||
+        camera->HFOV().Radian() >= IGN_PI)
+    {
+      return false;
+    }
+
+    _frusta.emplace_back(camera->NearClipPlane(), camera->FarClipPlane(),
+        camera->HFOV(), camera->AspectRatio(), camera->WorldPose());
+
+    for (rendering::NodePtr n = camera; n; n = n->Parent())
+      _cameraNodes.insert(n->Id());
+  }
+  return true;
+}
+
 //////////////////////////////////////////////////
 void RenderUtilPrivate::RemoveRenderingEntities(
     const EntityComponentManager &_ecm, const UpdateInfo &_info)
@@ -2579,6 +3163,28 @@ void RenderUtil::Init()
     this->dataPtr->engine = rendering::engine("ogre2", params);
   }
 
+  // GPU resources are shared between scenes of the same engine, so when
+  // the GUI and the sensors run in the same process they only upload
+  // meshes and textures once if they use the same engine.
+  if (this->dataPtr->engine)
+  {
+    this->dataPtr->loadedEngineName = this->dataPtr->engine->Name();
+    auto &usage = engineUsage();
+    std::lock_guard<std::mutex> lock(usage.mutex);
+    for (const auto &[otherEngine, count] : usage.count)
+    {
+      if (otherEngine != this->dataPtr->loadedEngineName && count > 0u)
+      {
+        ignmsg << "Render engines [" << otherEngine << "] and ["
+               << this->dataPtr->loadedEngineName << "] are both in use in "
+               << "this process. They can't share GPU resources, so meshes "
+               << "and textures will be loaded once per engine. Use the "
+               << "same engine everywhere to share them." << std::endl;
+      }
+    }
+    ++usage.count[this->dataPtr->loadedEngineName];
+  }
+
   // Scene
   this->dataPtr->scene =
       this->dataPtr->engine->SceneByName(this->dataPtr->sceneName);
@@ -2709,6 +3315,28 @@ void RenderUtil::SetSkyEnabled(bool _enabled)
   this->dataPtr->skyEnabled = _enabled;
 }
 
+/////////////////////////////////////////////////
+void RenderUtil::SetIncrementalUpdates(bool _enabled)
+{
+  this->dataPtr->incrementalUpdates = _enabled;
+}
+
+/////////////////////////////////////////////////
+void RenderUtil::SetFrustumCulling(bool _enabled, double _margin)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->updateMutex);
+  this->dataPtr->frustumCulling = _enabled;
+  this->dataPtr->frustumCullingMargin = std::max(0.0, _margin);
+}
+
+/////////////////////////////////////////////////
+void RenderUtil::SetPoseExtrapolation(bool _enabled, double _maxTime)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->updateMutex);
+  this->dataPtr->poseExtrapolation = _enabled;
+  this->dataPtr->maxExtrapolationTime = std::max(0.0, _maxTime);
+}
+
 /////////////////////////////////////////////////
 void RenderUtil::SetUseCurrentGLContext(bool _enable)
 {
@@ -2799,6 +3427,87 @@ void RenderUtil::SetTransformActive(bool _active)
   this->dataPtr->transformActive = _active;
 }
 
+////////////////////////////////////////////////
+bool RenderUtilPrivate::EntityTemperature(const EntityComponentManager &_ecm,
+    const Entity _entity, std::tuple<float, float, std::string> &_temp)
+{
+  if (auto temp = _ecm.Component<components::Temperature>(_entity))
+  {
+    // get the uniform temperature for the entity
+    _temp = std::make_tuple<float, float, std::string>(
+        temp->Data().Kelvin(), 0.0, "");
+    return true;
+  }
+
+  // entity doesn't have a uniform temperature. Check if it has
+  // a heat signature with an associated temperature range
+  auto heatSignature =
+    _ecm.Component<components::SourceFilePath>(_entity);
+  auto tempRange =
+     _ecm.Component<components::TemperatureRange>(_entity);
+  if (heatSignature && tempRange)
+  {
+    _temp = std::make_tuple<float, float, std::string>(
+        tempRange->Data().min.Kelvin(),
+        tempRange->Data().max.Kelvin(),
+        std::string(heatSignature->Data()));
+    return true;
+  }
+  return false;
+}
+
+////////////////////////////////////////////////
+void RenderUtilPrivate::UpdateLabelsAndTemperatures(
+    const EntityComponentManager &_ecm)
+{
+  const auto labelVersion =
+      _ecm.ComponentTypeVersion(components::SemanticLabel::typeId);
+  if (labelVersion > this->labelVersion)
+  {
+    IGN_PROFILE("RenderUtilPrivate::UpdateLabelsAndTemperatures Labels");
+    _ecm.Each<components::SemanticLabel>(
+        [&](const Entity &_entity, const components::SemanticLabel *_label)
+        {
+          if (_ecm.ComponentVersion(_entity, components::SemanticLabel::typeId)
+              > this->labelVersion)
+          {
+            this->entityLabel[_entity] = _label->Data();
+          }
+          return true;
+        });
+    this->labelVersion = labelVersion;
+  }
+
+  const auto temperatureVersion = std::max(
+      _ecm.ComponentTypeVersion(components::Temperature::typeId),
+      _ecm.ComponentTypeVersion(components::TemperatureRange::typeId));
+  if (temperatureVersion > this->temperatureVersion)
+  {
+    IGN_PROFILE("RenderUtilPrivate::UpdateLabelsAndTemperatures Temperatures");
+    auto update = [&](const Entity _entity, ComponentTypeId _type)
+    {
+      std::tuple<float, float, std::string> temp;
+      if (_ecm.ComponentVersion(_entity, _type) > this->temperatureVersion &&
+          EntityTemperature(_ecm, _entity, temp))
+      {
+        this->entityTemp[_entity] = std::move(temp);
+      }
+      return true;
+    };
+    _ecm.Each<components::Temperature>(
+        [&](const Entity &_entity, const components::Temperature *)
+        {
+          return update(_entity, components::Temperature::typeId);
+        });
+    _ecm.Each<components::TemperatureRange>(
+        [&](const Entity &_entity, const components::TemperatureRange *)
+        {
+          return update(_entity, components::TemperatureRange::typeId);
+        });
+    this->temperatureVersion = temperatureVersion;
+  }
+}
+
 ////////////////////////////////////////////////
 void RenderUtilPrivate::UpdateVisualLabels(
   const std::unordered_map<Entity, int> &_entityLabel)
@@ -2806,6 +3515,11 @@ void RenderUtilPrivate::UpdateVisualLabels(
   // set visual label
   for (const auto &label : _entityLabel)
   {
+    // Only set labels which changed
+    auto pushed = this->visualLabels.find(label.first);
+    if (pushed != this->visualLabels.end() && pushed->second == label.second)
+      continue;
+
     auto node = this->sceneManager.NodeById(label.first);
     if (!node)
       continue;
@@ -2815,6 +3529,7 @@ void RenderUtilPrivate::UpdateVisualLabels(
       continue;
 
     visual->SetUserData("label", label.second);
+    this->visualLabels[label.first] = label.second;
   }
 }
 
@@ -3781,30 +4496,16 @@ void RenderUtilPrivate::CreateVisual(
     this->entityLabel[_entity] = label->Data();
   }
 
-  if (auto temp = _ecm.Component<components::Temperature>(_entity))
-  {
-    // get the uniform temperature for the entity
-    this->entityTemp[_entity] = std::make_tuple
-        <float, float, std::string>(temp->Data().Kelvin(), 0.0, "");
-  }
-  else
+  auto lod = _ecm.Component<components::VisualLod>(_entity);
+  if (lod != nullptr)
   {
-    // entity doesn't have a uniform temperature. Check if it has
-    // a heat signature with an associated temperature range
-    auto heatSignature =
-      _ecm.Component<components::SourceFilePath>(_entity);
-    auto tempRange =
-       _ecm.Component<components::TemperatureRange>(_entity);
-    if (heatSignature && tempRange)
-    {
-      this->entityTemp[_entity] =
-        std::make_tuple<float, float, std::string>(
-            tempRange->Data().min.Kelvin(),
-            tempRange->Data().max.Kelvin(),
-            std::string(heatSignature->Data()));
-    }
+    this->entityLods[_entity] = lod->Data();
   }
 
+  std::tuple<float, float, std::string> temp;
+  if (EntityTemperature(_ecm, _entity, temp))
+    this->entityTemp[_entity] = std::move(temp);
+
   this->newVisuals.push_back(
       std::make_tuple(_entity, visual, _parent->Data()));
 
@@ -3827,4 +4528,6 @@ void RenderUtilPrivate::CreateLight(
 void RenderUtil::SetEventManager(EventManager *_mgr)
 {
   this->dataPtr->eventManager = _mgr;
+  this->dataPtr->sceneUpdateEvent =
+      nullptr == _mgr ? nullptr : _mgr->Handle<events::SceneUpdate>();
 }
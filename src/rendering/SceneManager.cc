@@ -16,8 +16,17 @@
  */
 
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <map>
 #include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <sdf/Box.hh>
 #include <sdf/Capsule.hh>
@@ -37,6 +46,7 @@
 #include <ignition/common/ImageHeightmap.hh>
 #include <ignition/common/KeyFrame.hh>
 #include <ignition/common/MeshManager.hh>
+#include <ignition/common/Profiler.hh>
 #include <ignition/common/Skeleton.hh>
 #include <ignition/common/SkeletonAnimation.hh>
 #include <ignition/common/Uuid.hh>
@@ -44,6 +54,7 @@
 #include <ignition/msgs/Utility.hh>
 
 #include "ignition/rendering/Capsule.hh"
+#include <ignition/rendering/Camera.hh>
 #include <ignition/rendering/COMVisual.hh>
 #include <ignition/rendering/Geometry.hh>
 #include <ignition/rendering/Heightmap.hh>
@@ -53,12 +64,15 @@
 #include <ignition/rendering/Light.hh>
 #include <ignition/rendering/LightVisual.hh>
 #include <ignition/rendering/Material.hh>
+#include <ignition/rendering/Mesh.hh>
 #include <ignition/rendering/ParticleEmitter.hh>
 #include <ignition/rendering/Scene.hh>
 #include <ignition/rendering/Visual.hh>
 #include <ignition/rendering/WireBox.hh>
 
 #include "ignition/gazebo/Conversions.hh"
+#include "ignition/gazebo/MeshCache.hh"
+#include "ignition/gazebo/TerrainTiles.hh"
 #include "ignition/gazebo/Util.hh"
 #include "ignition/gazebo/rendering/SceneManager.hh"
 
@@ -68,6 +82,13 @@ using namespace std::chrono_literals;
 
 using TP = std::chrono::steady_clock::time_point;
 
+/// \brief Ratio of the distance up to which terrain tiles are kept to the
+/// distance up to which they're created.
+static constexpr double kTerrainKeepRatio{1.25};
+
+/// \brief Most terrain tiles created per update.
+static constexpr std::size_t kTerrainTilesPerUpdate{4u};
+
 /// \brief Private data class.
 class ignition::gazebo::SceneManagerPrivate
 {
@@ -92,6 +113,61 @@ class ignition::gazebo::SceneManagerPrivate
   public: std::unordered_map<Entity, std::vector<common::TrajectoryInfo>>
                     actorTrajectories;
 
+  /// \brief Skeleton animation sampled at a fixed rate into flat arrays of
+  /// bone poses, shared by all actors playing it.
+  public: struct BakedClip
+  {
+    /// \brief Skeleton the animation belongs to, held so the animation
+    /// outlives the clip.
+    common::SkeletonPtr skeleton;
+
+    /// \brief Skin names of the animated bones, sorted.
+    std::shared_ptr<const std::vector<std::string>> boneNames;
+
+    /// \brief Index of the skeleton's root node in boneNames, or the size
+    /// of boneNames if it isn't animated.
+    std::size_t rootBone{0u};
+
+    /// \brief Length of the animation in seconds.
+    double length{0.0};
+
+    /// \brief Time between samples in seconds.
+    double step{0.0};
+
+    /// \brief Number of samples, spread evenly from zero to length.
+    std::size_t sampleCount{0u};
+
+    /// \brief Poses of all bones, already aligned to the skin, sample
+    /// after sample.
+    std::vector<math::Pose3d> poses;
+  };
+
+  /// \brief Baked clips, keyed by the animation they sample. Animations
+  /// are only ever appended to a skeleton, so their addresses are stable.
+  public: std::unordered_map<const common::SkeletonAnimation *,
+      std::shared_ptr<const BakedClip>> bakedClips;
+
+  /// \brief Map of actor entity to its baked clips, indexed by animation
+  /// index. Animations the actor doesn't play are null.
+  public: std::unordered_map<Entity,
+      std::vector<std::shared_ptr<const BakedClip>>> actorClips;
+
+  /// \brief Get the baked clip of an animation, baking it the first time.
+  /// \param[in] _skel Skeleton the animation belongs to.
+  /// \param[in] _animIndex Index of the animation in _skel.
+  /// \return The clip, null if the animation doesn't exist.
+  public: std::shared_ptr<const BakedClip> Bake(
+      const common::SkeletonPtr &_skel, unsigned int _animIndex);
+
+  /// \brief Interpolate the bone transforms of a clip at a point in time.
+  /// \param[in] _clip Clip to sample.
+  /// \param[in] _time Time in the animation in seconds.
+  /// \param[in] _loop True to wrap times past the end of the animation,
+  /// false to clamp them.
+  /// \param[out] _transforms Transform of each bone of the clip.
+  public: static void Sample(const BakedClip &_clip, double _time,
+      bool _loop, std::vector<math::Matrix4d> &_transforms);
+
   /// \brief Map of light entity in Gazebo to light pointers.
   public: std::unordered_map<Entity, rendering::LightPtr> lights;
 
@@ -108,6 +184,88 @@ class ignition::gazebo::SceneManagerPrivate
   /// \brief The map of the original depth write values for the nodes.
   public: std::map<std::string, bool> originalDepthWrite;
 
+  /// \brief True to share a single material between all visual geometries
+  /// which have identical material properties.
+  public: bool shareMaterials{false};
+
+  /// \brief Materials shared between geometries.
+  /// Key: Description of all the material's properties, see MaterialKey.
+  /// Value: The shared material.
+  public: std::unordered_map<std::string, rendering::MaterialPtr>
+      sharedMaterials;
+
+  /// \brief All the values in sharedMaterials, for fast lookup.
+  public: std::unordered_set<rendering::MaterialPtr> sharedMaterialSet;
+
+  /// \brief Levels of detail of a visual.
+  public: struct VisualLod
+  {
+    /// \brief The visual whose geometries are swapped.
+    rendering::VisualPtr visual;
+
+    /// \brief Distance from which each level is used. The first level is
+    /// the visual's original geometry, used from distance zero.
+    std::vector<double> distances;
+
+    /// \brief Geometries of each level. Geometries of levels which aren't
+    /// in use are detached from the visual.
+    std::vector<std::vector<rendering::GeometryPtr>> geometries;
+
+    /// \brief Index of the level currently attached to the visual.
+    std::size_t current{0u};
+  };
+
+  /// \brief Levels of detail of visuals, keyed by visual entity.
+  public: std::unordered_map<Entity, VisualLod> visualLods;
+
+  /// \brief Attach the geometries of another level of detail to a visual.
+  /// \param[in] _lod Levels of detail of the visual.
+  /// \param[in] _level Index of the level to use.
+  public: static void SwitchLod(VisualLod &_lod, std::size_t _level);
+
+  /// \brief Heightmap visual split into tiles, which are created around
+  /// the cameras.
+  public: struct TerrainVisual
+  {
+    /// \brief The visual which holds the tiles.
+    rendering::VisualPtr visual;
+
+    /// \brief Tiles of the heightmap.
+    std::shared_ptr<TerrainTiles> tiles;
+
+    /// \brief Descriptor of the whole heightmap, whose textures and blends
+    /// are given to every tile.
+    rendering::HeightmapDescriptor descriptor;
+
+    /// \brief Visuals of the tiles in use and their level of detail, by
+    /// tile index.
+    std::map<std::size_t, std::pair<unsigned int, rendering::VisualPtr>>
+        loaded;
+  };
+
+  /// \brief Heightmaps split into tiles, keyed by visual entity.
+  public: std::unordered_map<Entity, TerrainVisual> terrains;
+
+  /// \brief Terrain split into tiles by the last call to LoadGeometry, to
+  /// be taken by the visual being created, since it gets no geometry.
+  public: std::optional<TerrainVisual> newTerrain;
+
+  /// \brief Create and destroy the tiles of a terrain so that only those
+  /// around the viewpoints exist, at the level of detail their distance
+  /// requires.
+  /// \param[in] _terrain Terrain to update.
+  /// \param[in] _viewpoints Camera positions in the world frame.
+  /// \param[in] _radius Distance up to which tiles are created.
+  public: void UpdateTerrain(TerrainVisual &_terrain,
+      const std::vector<math::Vector3d> &_viewpoints, double _radius);
+
+  /// \brief Get a string which is the same for materials that render the
+  /// same way.
+  /// \param[in] _material Material to describe.
+  /// \return Description of the material's properties.
+  public: static std::string MaterialKey(
+      const rendering::MaterialPtr &_material);
+
   /// \brief Helper function to compute actor trajectory at specified tiime
   /// \param[in] _id Actor entity's unique id
   /// \param[in] _time Simulation time
@@ -131,6 +289,8 @@ SceneManager::~SceneManager() = default;
 void SceneManager::SetScene(rendering::ScenePtr _scene)
 {
   this->dataPtr->scene = std::move(_scene);
+  this->dataPtr->sharedMaterials.clear();
+  this->dataPtr->sharedMaterialSet.clear();
 }
 
 /////////////////////////////////////////////////
@@ -139,6 +299,35 @@ rendering::ScenePtr SceneManager::Scene() const
   return this->dataPtr->scene;
 }
 
+/////////////////////////////////////////////////
+void SceneManager::SetShareMaterials(bool _share)
+{
+  this->dataPtr->shareMaterials = _share;
+}
+
+/////////////////////////////////////////////////
+bool SceneManager::ShareMaterials() const
+{
+  return this->dataPtr->shareMaterials;
+}
+
+/////////////////////////////////////////////////
+rendering::MaterialPtr SceneManager::UniqueMaterial(
+    const rendering::GeometryPtr &_geom)
+{
+  if (!_geom)
+    return rendering::MaterialPtr();
+
+  auto material = _geom->Material();
+  if (material && this->dataPtr->sharedMaterialSet.count(material) > 0u)
+  {
+    // Setting a unique material clones it
+    _geom->SetMaterial(material, true);
+    material = _geom->Material();
+  }
+  return material;
+}
+
 /////////////////////////////////////////////////
 void SceneManager::SetWorldId(Entity _id)
 {
@@ -300,7 +489,14 @@ rendering::VisualPtr SceneManager::CreateVisual(Entity _id,
   rendering::GeometryPtr geom =
       this->LoadGeometry(*_visual.Geom(), scale, localPose);
 
-  if (geom)
+  if (this->dataPtr->newTerrain)
+  {
+    // Tiles are children of the visual, created by UpdateLods
+    this->dataPtr->newTerrain->visual = visualVis;
+    this->dataPtr->terrains[_id] = std::move(*this->dataPtr->newTerrain);
+    this->dataPtr->newTerrain.reset();
+  }
+  else if (geom)
   {
     /// localPose is currently used to handle the normal vector in plane visuals
     /// In general, this can be used to store any local transforms between the
@@ -346,6 +542,10 @@ rendering::VisualPtr SceneManager::CreateVisual(Entity _id,
         material->SetRoughness(0.2f);
         material->SetMetalness(1.0f);
       }
+      // The named material is modified below, so work on a copy if it may
+      // end up being shared
+      if (this->dataPtr->shareMaterials)
+        material = material->Clone();
     }
     else
     {
@@ -381,12 +581,34 @@ rendering::VisualPtr SceneManager::CreateVisual(Entity _id,
       // cast shadows
       material->SetCastShadows(_visual.CastShadows());
 
-      geom->SetMaterial(material);
-      // todo(anyone) SetMaterial function clones the input material.
-      // but does not take ownership of it so we need to destroy it here.
-      // This is not ideal. We should let ign-rendering handle the lifetime
-      // of this material
-      this->dataPtr->scene->DestroyMaterial(material);
+      if (this->dataPtr->shareMaterials)
+      {
+        // Geometries with the same material share it instead of each
+        // holding a clone. Render engines which batch draws by material,
+        // such as ogre2, can then instance identical geometries.
+        auto key = SceneManagerPrivate::MaterialKey(material);
+        auto sharedIt = this->dataPtr->sharedMaterials.find(key);
+        if (sharedIt == this->dataPtr->sharedMaterials.end())
+        {
+          sharedIt = this->dataPtr->sharedMaterials.emplace(
+              key, material).first;
+          this->dataPtr->sharedMaterialSet.insert(material);
+        }
+        else
+        {
+          this->dataPtr->scene->DestroyMaterial(material);
+        }
+        geom->SetMaterial(sharedIt->second, false);
+      }
+      else
+      {
+        geom->SetMaterial(material);
+        // todo(anyone) SetMaterial function clones the input material.
+        // but does not take ownership of it so we need to destroy it here.
+        // This is not ideal. We should let ign-rendering handle the lifetime
+        // of this material
+        this->dataPtr->scene->DestroyMaterial(material);
+      }
     }
   }
   else
@@ -405,6 +627,230 @@ rendering::VisualPtr SceneManager::CreateVisual(Entity _id,
   return visualVis;
 }
 
+/////////////////////////////////////////////////
+bool SceneManager::SetVisualLod(Entity _id,
+    const std::vector<lod::Level> &_levels)
+{
+  auto visIt = this->dataPtr->visuals.find(_id);
+  if (visIt == this->dataPtr->visuals.end())
+    return false;
+
+  auto visual = visIt->second;
+  if (this->dataPtr->visualLods.find(_id) !=
+      this->dataPtr->visualLods.end())
+  {
+    ignerr << "Visual [" << visual->Name()
+           << "] already has levels of detail." << std::endl;
+    return false;
+  }
+
+  // Geometries offset by a child visual, such as planes, aren't supported
+  if (visual->GeometryCount() == 0u)
+  {
+    ignwarn << "Visual [" << visual->Name() << "] has no geometry of its "
+            << "own, ignoring its levels of detail." << std::endl;
+    return false;
+  }
+
+  SceneManagerPrivate::VisualLod lod;
+  lod.visual = visual;
+  lod.distances.push_back(0.0);
+  lod.geometries.emplace_back();
+  for (auto g = 0u; g < visual->GeometryCount(); ++g)
+    lod.geometries[0].push_back(visual->GeometryByIndex(g));
+
+  // Primitives get their material from SDF, which is shared with the lower
+  // levels. Meshes keep the materials from their files.
+  auto originalGeom = lod.geometries[0][0];
+  rendering::MaterialPtr material;
+  if (!std::dynamic_pointer_cast<rendering::Mesh>(originalGeom))
+    material = originalGeom->Material();
+
+  for (const auto &level : _levels)
+  {
+    lod.distances.push_back(level.distance);
+    lod.geometries.emplace_back();
+    if (level.mesh.empty())
+      continue;
+
+    rendering::MeshDescriptor descriptor;
+    descriptor.meshName = level.mesh;
+    descriptor.mesh = MeshCache::Instance().Load(level.mesh);
+    if (nullptr == descriptor.mesh)
+    {
+      ignerr << "Failed to load mesh [" << level.mesh << "] for a level of "
+             << "detail of visual [" << visual->Name() << "]" << std::endl;
+      continue;
+    }
+
+    auto geom = this->dataPtr->scene->CreateMesh(descriptor);
+    if (nullptr == geom)
+      continue;
+    if (material)
+      geom->SetMaterial(material, false);
+    lod.geometries.back().push_back(geom);
+  }
+
+  this->dataPtr->visualLods[_id] = std::move(lod);
+  return true;
+}
+
+/////////////////////////////////////////////////
+void SceneManager::UpdateLods()
+{
+  if ((this->dataPtr->visualLods.empty() &&
+       this->dataPtr->terrains.empty()) || !this->dataPtr->scene)
+  {
+    return;
+  }
+
+  IGN_PROFILE("SceneManager::UpdateLods");
+
+  // Every camera in the scene, including the GUI's. Each visual uses the
+  // level required by the closest one.
+  std::vector<math::Vector3d> viewpoints;
+  double farClip{0.0};
+  for (auto i = 0u; i < this->dataPtr->scene->SensorCount(); ++i)
+  {
+    auto camera = std::dynamic_pointer_cast<rendering::Camera>(
+        this->dataPtr->scene->SensorByIndex(i));
+    if (camera)
+    {
+      viewpoints.push_back(camera->WorldPosition());
+      farClip = std::max(farClip, camera->FarClipPlane());
+    }
+  }
+
+  if (viewpoints.empty())
+    return;
+
+  // Terrain tiles which no camera can see aren't needed
+  for (auto &[id, terrain] : this->dataPtr->terrains)
+    this->dataPtr->UpdateTerrain(terrain, viewpoints, farClip);
+
+  for (auto &[id, lod] : this->dataPtr->visualLods)
+  {
+    auto position = lod.visual->WorldPosition();
+    double distance = std::numeric_limits<double>::max();
+    for (const auto &viewpoint : viewpoints)
+      distance = std::min(distance, position.Distance(viewpoint));
+
+    std::size_t level = 0u;
+    while (level + 1u < lod.distances.size() &&
+           distance >= lod.distances[level + 1u])
+    {
+      ++level;
+    }
+
+    if (level != lod.current)
+      SceneManagerPrivate::SwitchLod(lod, level);
+  }
+}
+
+/////////////////////////////////////////////////
+void SceneManagerPrivate::UpdateTerrain(TerrainVisual &_terrain,
+    const std::vector<math::Vector3d> &_viewpoints, double _radius)
+{
+  IGN_PROFILE("SceneManagerPrivate::UpdateTerrain");
+
+  // Tiles are selected in the frame of the visual
+  const auto pose = _terrain.visual->WorldPose();
+  std::vector<math::Vector3d> points;
+  points.reserve(_viewpoints.size());
+  for (const auto &viewpoint : _viewpoints)
+    points.push_back(pose.Rot().RotateVectorReverse(viewpoint - pose.Pos()));
+
+  // Tiles are kept a bit farther than they're created, so they aren't
+  // created and destroyed over and over by a camera moving around the
+  // limit. Each level of detail covers twice the distance of the
+  // previous one, starting at a tile's width.
+  const double lodDistance = _terrain.tiles->TileSize().X();
+  std::vector<TerrainTiles::Tile> needed;
+  std::vector<TerrainTiles::Tile> kept;
+  _terrain.tiles->Select(points, _radius, lodDistance, needed);
+  _terrain.tiles->Select(points, _radius * kTerrainKeepRatio, lodDistance,
+      kept);
+
+  std::unordered_set<std::size_t> keptIndices;
+  for (const auto &tile : kept)
+    keptIndices.insert(tile.index);
+  for (auto it = _terrain.loaded.begin(); it != _terrain.loaded.end();)
+  {
+    if (keptIndices.count(it->first) == 0u)
+    {
+      this->scene->DestroyVisual(it->second.second);
+      it = _terrain.loaded.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  // Closer tiles, which have lower levels, are created first, and only a
+  // few are created at a time so the frame rate doesn't drop
+  std::stable_sort(needed.begin(), needed.end(),
+      [](const TerrainTiles::Tile &_a, const TerrainTiles::Tile &_b)
+      {
+        return _a.lod < _b.lod;
+      });
+  std::size_t created{0u};
+  for (const auto &tile : needed)
+  {
+    if (created >= kTerrainTilesPerUpdate)
+      break;
+
+    auto loadedIt = _terrain.loaded.find(tile.index);
+    if (loadedIt != _terrain.loaded.end() &&
+        loadedIt->second.first == tile.lod)
+    {
+      continue;
+    }
+
+    auto descriptor = _terrain.descriptor;
+    descriptor.SetData(_terrain.tiles->TileData(tile.index, tile.lod));
+    descriptor.SetSize(_terrain.tiles->TileSize());
+    descriptor.SetPosition(_terrain.tiles->TilePosition(tile.index));
+    descriptor.SetSampling(1u);
+    auto heightmap = this->scene->CreateHeightmap(descriptor);
+    ++created;
+    if (nullptr == heightmap)
+    {
+      ignerr << "Failed to create tile [" << tile.index << "] of heightmap ["
+             << _terrain.visual->Name() << "]" << std::endl;
+      continue;
+    }
+
+    auto tileVis = this->scene->CreateVisual(_terrain.visual->Name() +
+        "_tile_" + std::to_string(tile.index) + "_lod_" +
+        std::to_string(tile.lod));
+    tileVis->AddGeometry(heightmap);
+    tileVis->SetLocalScale(descriptor.Size());
+    tileVis->SetVisibilityFlags(_terrain.visual->VisibilityFlags());
+    _terrain.visual->AddChild(tileVis);
+
+    if (loadedIt != _terrain.loaded.end())
+    {
+      this->scene->DestroyVisual(loadedIt->second.second);
+      loadedIt->second = {tile.lod, tileVis};
+    }
+    else
+    {
+      _terrain.loaded[tile.index] = {tile.lod, tileVis};
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void SceneManagerPrivate::SwitchLod(VisualLod &_lod, std::size_t _level)
+{
+  for (auto &geom : _lod.geometries[_lod.current])
+    _lod.visual->RemoveGeometry(geom);
+  for (auto &geom : _lod.geometries[_level])
+    _lod.visual->AddGeometry(geom);
+  _lod.current = _level;
+}
+
 /////////////////////////////////////////////////
 std::vector<rendering::NodePtr> SceneManager::Filter(const std::string &_node,
     std::function<bool(const rendering::NodePtr _nodeToFilter)> _filter) const
@@ -677,9 +1123,8 @@ rendering::GeometryPtr SceneManager::LoadGeometry(const sdf::Geometry &_geom,
     descriptor.subMeshName = _geom.MeshShape()->Submesh();
     descriptor.centerSubMesh = _geom.MeshShape()->CenterSubmesh();
 
-    common::MeshManager *meshManager =
-        common::MeshManager::Instance();
-    descriptor.mesh = meshManager->Load(descriptor.meshName);
+    // Cooked meshes are shared with physics and other rendering processes
+    descriptor.mesh = MeshCache::Instance().Load(descriptor.meshName);
     geom = this->dataPtr->scene->CreateMesh(descriptor);
     scale = _geom.MeshShape()->Scale();
   }
@@ -728,6 +1173,25 @@ rendering::GeometryPtr SceneManager::LoadGeometry(const sdf::Geometry &_geom,
       descriptor.AddBlend(blendDesc);
     }
 
+    // Large heightmaps are split into tiles instead, which are created
+    // around the cameras by UpdateLods
+    auto sampling = _geom.HeightmapShape()->Sampling();
+    if (TerrainTiles::Tiled(*data, sampling,
+        TerrainTiles::kDefaultTileSamples))
+    {
+      SceneManagerPrivate::TerrainVisual terrain;
+      terrain.tiles = std::make_shared<TerrainTiles>();
+      if (terrain.tiles->Load(*data, _geom.HeightmapShape()->Size(),
+          _geom.HeightmapShape()->Position(), sampling,
+          TerrainTiles::kDefaultTileSamples))
+      {
+        terrain.descriptor = descriptor;
+        terrain.descriptor.SetData(nullptr);
+        this->dataPtr->newTerrain = std::move(terrain);
+        return geom;
+      }
+    }
+
     geom = this->dataPtr->scene->CreateHeightmap(descriptor);
     if (nullptr == geom)
     {
@@ -1093,6 +1557,17 @@ rendering::VisualPtr SceneManager::CreateActor(Entity _id,
 
   this->dataPtr->actorTrajectories[_id] = trajectories;
 
+  // Bake the animations played by the actor, sharing them with the other
+  // actors using the same skeleton
+  auto &clips = this->dataPtr->actorClips[_id];
+  clips.assign(meshSkel->AnimationCount(), nullptr);
+  for (const auto &trajInfo : trajectories)
+  {
+    unsigned int animIndex = trajInfo.AnimIndex();
+    if (animIndex < clips.size() && !clips[animIndex])
+      clips[animIndex] = this->dataPtr->Bake(meshSkel, animIndex);
+  }
+
   // create mesh with animations
   rendering::MeshPtr actorMesh = this->dataPtr->scene->CreateMesh(
       descriptor);
@@ -1951,6 +2426,79 @@ std::map<std::string, math::Matrix4d> SceneManager::ActorSkeletonTransformsAt(
   return allFrames;
 }
 
+/////////////////////////////////////////////////
+bool SceneManager::ActorSkeletonFrameAt(Entity _id,
+    std::chrono::steady_clock::duration _time,
+    ActorSkeletonFrame &_frame) const
+{
+  auto clipsIt = this->dataPtr->actorClips.find(_id);
+  if (clipsIt == this->dataPtr->actorClips.end())
+    return false;
+
+  AnimationUpdateData animData = this->dataPtr->ActorTrajectoryAt(_id, _time);
+  if (!animData.valid)
+    return false;
+
+  const common::TrajectoryInfo &traj = animData.trajectory;
+  unsigned int animIndex = traj.AnimIndex();
+  if (animIndex >= clipsIt->second.size() || !clipsIt->second[animIndex])
+    return false;
+  const auto &clip = *clipsIt->second[animIndex];
+
+  // Same timing as ActorSkeletonTransformsAt
+  double timeSeconds = std::chrono::duration<double>(animData.time).count();
+  bool loop = !animData.loop;
+  if (animData.followTrajectory)
+  {
+    double distance = traj.DistanceSoFar(animData.time);
+    if (traj.Waypoints()->InterpolateX() && !math::equal(distance, 0.0))
+    {
+      // logic here is mostly taken from
+      // common::SkeletonAnimation::PoseAtX
+      common::NodeAnimation *rootNode =
+          clip.skeleton->Animation(animIndex)->NodeAnimationByName(
+          clip.skeleton->RootNode()->Name());
+      if (rootNode && rootNode->FrameCount() > 0)
+      {
+        double x = distance;
+        double firstX = rootNode->KeyFrame(0).second.Translation().X();
+        double lastX = rootNode->KeyFrame(
+            rootNode->FrameCount() - 1).second.Translation().X();
+        if (x < firstX)
+          x = firstX;
+        while (x > lastX)
+          x -= lastX;
+        timeSeconds = rootNode->TimeAtX(x);
+      }
+      loop = true;
+    }
+  }
+
+  SceneManagerPrivate::Sample(clip, timeSeconds, loop, _frame.transforms);
+  _frame.boneNames = clip.boneNames;
+
+  if (animData.followTrajectory)
+  {
+    common::PoseKeyFrame poseFrame(0.0);
+    traj.Waypoints()->InterpolatedKeyFrame(poseFrame);
+    _frame.actorPose = math::Matrix4d(poseFrame.Rotation());
+    _frame.actorPose.SetTranslation(poseFrame.Translation());
+  }
+  else
+  {
+    _frame.actorPose = math::Matrix4d(math::Quaterniond::Identity);
+    if (clip.rootBone < _frame.transforms.size())
+    {
+      _frame.actorPose.SetTranslation(
+          _frame.transforms[clip.rootBone].Translation());
+    }
+  }
+
+  if (clip.rootBone < _frame.transforms.size())
+    _frame.transforms[clip.rootBone].SetTranslation(math::Vector3d::Zero);
+  return true;
+}
+
 /////////////////////////////////////////////////
 void SceneManager::RemoveEntity(Entity _id)
 {
@@ -1978,6 +2526,7 @@ void SceneManager::RemoveEntity(Entity _id)
       this->dataPtr->actorSkeletons.erase(it);
     }
   }
+  this->dataPtr->actorClips.erase(_id);
 
   {
     auto it = this->dataPtr->visuals.find(_id);
@@ -1996,6 +2545,30 @@ void SceneManager::RemoveEntity(Entity _id)
         this->dataPtr->originalDepthWrite.erase(geom->Name());
       }
 
+      // Tiles of terrains are child visuals
+      auto terrainIt = this->dataPtr->terrains.find(_id);
+      if (terrainIt != this->dataPtr->terrains.end())
+      {
+        for (auto &loaded : terrainIt->second.loaded)
+          this->dataPtr->scene->DestroyVisual(loaded.second.second);
+        this->dataPtr->terrains.erase(terrainIt);
+      }
+
+      // Geometries of unused levels of detail aren't attached to the
+      // visual, so they're not destroyed with it
+      auto lodIt = this->dataPtr->visualLods.find(_id);
+      if (lodIt != this->dataPtr->visualLods.end())
+      {
+        for (auto l = 0u; l < lodIt->second.geometries.size(); ++l)
+        {
+          if (l == lodIt->second.current)
+            continue;
+          for (auto &lodGeom : lodIt->second.geometries[l])
+            lodGeom->Destroy();
+        }
+        this->dataPtr->visualLods.erase(lodIt);
+      }
+
       this->dataPtr->scene->DestroyVisual(it->second);
       this->dataPtr->visuals.erase(it);
       return;
@@ -2120,8 +2693,8 @@ void SceneManager::UpdateTransparency(const rendering::NodePtr &_node,
   {
     auto geom = vis->GeometryByIndex(g);
 
-    // Geometry material
-    auto geomMat = geom->Material();
+    // Geometry material, made unique so other geometries aren't affected
+    auto geomMat = this->UniqueMaterial(geom);
     if (nullptr == geomMat || visMat == geomMat)
       continue;
     auto geomTransparency =
@@ -2204,7 +2777,7 @@ AnimationUpdateData SceneManagerPrivate::ActorTrajectoryAt(
   if (trajIt == this->actorTrajectories.end())
     return animData;
 
-  auto trajs = trajIt->second;
+  const auto &trajs = trajIt->second;
   bool followTraj = true;
   if (1 == trajs.size() && nullptr == trajs[0].Waypoints())
     followTraj = false;
@@ -2264,6 +2837,129 @@ AnimationUpdateData SceneManagerPrivate::ActorTrajectoryAt(
   return animData;
 }
 
+/////////////////////////////////////////////////
+std::shared_ptr<const SceneManagerPrivate::BakedClip>
+SceneManagerPrivate::Bake(const common::SkeletonPtr &_skel,
+    unsigned int _animIndex)
+{
+  // Fast enough to look smooth once interpolated, yet small enough for
+  // clips of a few thousand bone poses
+  static constexpr double kSampleRate{60.0};
+
+  common::SkeletonAnimation *anim = _skel->Animation(_animIndex);
+  if (nullptr == anim)
+    return nullptr;
+
+  auto &cached = this->bakedClips[anim];
+  if (cached)
+    return cached;
+
+  auto clip = std::make_shared<BakedClip>();
+  clip->skeleton = _skel;
+  clip->length = std::max(anim->Length(), 0.0);
+  clip->sampleCount = std::max<std::size_t>(2u,
+      static_cast<std::size_t>(std::ceil(clip->length * kSampleRate)) + 1u);
+  clip->step = clip->length / static_cast<double>(clip->sampleCount - 1u);
+
+  // Resolve skin names and alignment once. Several nodes may map to the
+  // same skin bone, in which case the last one wins, as in
+  // SceneManager::ActorSkeletonTransformsAt.
+  std::vector<std::string> nodeNames;
+  std::map<std::string, std::size_t> skinToNode;
+  for (const auto &pair : anim->PoseAt(0.0, false))
+  {
+    skinToNode[_skel->NodeNameAnimToSkin(_animIndex, pair.first)] =
+        nodeNames.size();
+    nodeNames.push_back(pair.first);
+  }
+
+  auto boneNames = std::make_shared<std::vector<std::string>>();
+  std::vector<std::size_t> nodeToBone(nodeNames.size(), nodeNames.size());
+  for (const auto &pair : skinToNode)
+  {
+    nodeToBone[pair.second] = boneNames->size();
+    boneNames->push_back(pair.first);
+  }
+  auto rootIt = std::find(boneNames->begin(), boneNames->end(),
+      _skel->RootNode()->Name());
+  clip->rootBone = static_cast<std::size_t>(rootIt - boneNames->begin());
+
+  std::vector<math::Matrix4d> alignTranslations;
+  std::vector<math::Matrix4d> alignRotations;
+  for (const auto &nodeName : nodeNames)
+  {
+    alignTranslations.push_back(_skel->AlignTranslation(_animIndex, nodeName));
+    alignRotations.push_back(_skel->AlignRotation(_animIndex, nodeName));
+  }
+
+  const std::size_t boneCount = boneNames->size();
+  clip->poses.resize(clip->sampleCount * boneCount);
+  for (std::size_t sample = 0; sample < clip->sampleCount; ++sample)
+  {
+    double time = std::min(clip->length,
+        static_cast<double>(sample) * clip->step);
+    math::Pose3d *poses = clip->poses.data() + sample * boneCount;
+
+    // PoseAt returns nodes in the same order for any time
+    std::size_t node = 0u;
+    for (const auto &pair : anim->PoseAt(time, false))
+    {
+      if (node >= nodeNames.size())
+        break;
+      std::size_t bone = nodeToBone[node];
+      if (bone < boneCount)
+      {
+        poses[bone] = (alignTranslations[node] * pair.second *
+            alignRotations[node]).Pose();
+      }
+      ++node;
+    }
+  }
+
+  clip->boneNames = std::move(boneNames);
+  cached = std::move(clip);
+  return cached;
+}
+
+/////////////////////////////////////////////////
+void SceneManagerPrivate::Sample(const BakedClip &_clip, double _time,
+    bool _loop, std::vector<math::Matrix4d> &_transforms)
+{
+  const std::size_t boneCount = _clip.boneNames->size();
+  _transforms.resize(boneCount);
+  if (boneCount == 0u)
+    return;
+
+  double time = _time;
+  if (_loop && _clip.length > 0.0)
+  {
+    time = std::fmod(time, _clip.length);
+    if (time < 0.0)
+      time += _clip.length;
+  }
+  time = math::clamp(time, 0.0, _clip.length);
+
+  std::size_t first = 0u;
+  double t = 0.0;
+  if (_clip.step > 0.0)
+  {
+    double index = time / _clip.step;
+    first = std::min(static_cast<std::size_t>(index),
+        _clip.sampleCount - 2u);
+    t = math::clamp(index - static_cast<double>(first), 0.0, 1.0);
+  }
+
+  const math::Pose3d *a = _clip.poses.data() + first * boneCount;
+  const math::Pose3d *b = a + boneCount;
+  for (std::size_t bone = 0; bone < boneCount; ++bone)
+  {
+    math::Matrix4d &tf = _transforms[bone];
+    tf = math::Matrix4d(math::Quaterniond::Slerp(
+        t, a[bone].Rot(), b[bone].Rot(), true));
+    tf.SetTranslation(a[bone].Pos() + (b[bone].Pos() - a[bone].Pos()) * t);
+  }
+}
+
 std::unordered_map<std::string, unsigned int>
 SceneManager::LoadAnimations(const sdf::Actor &_actor)
 {
@@ -2390,3 +3086,26 @@ SceneManager::LoadAnimations(const sdf::Actor &_actor)
   }
   return mapAnimNameId;
 }
+
+/////////////////////////////////////////////////
+std::string SceneManagerPrivate::MaterialKey(
+    const rendering::MaterialPtr &_material)
+{
+  std::ostringstream key;
+  key << _material->Ambient() << "|" << _material->Diffuse() << "|"
+      << _material->Specular() << "|" << _material->Emissive() << "|"
+      << _material->Shininess() << "|" << _material->Transparency() << "|"
+      << _material->Reflectivity() << "|" << _material->CastShadows() << "|"
+      << _material->ReceiveShadows() << "|" << _material->LightingEnabled()
+      << "|" << _material->DepthCheckEnabled() << "|"
+      << _material->DepthWriteEnabled() << "|" << _material->RenderOrder()
+      << "|" << _material->TwoSidedEnabled() << "|"
+      << _material->AlphaFromTexture() << "|" << _material->AlphaThreshold()
+      << "|" << _material->Roughness() << "|" << _material->Metalness()
+      << "|" << _material->Texture() << "|" << _material->NormalMap() << "|"
+      << _material->RoughnessMap() << "|" << _material->MetalnessMap() << "|"
+      << _material->EnvironmentMap() << "|" << _material->EmissiveMap()
+      << "|" << _material->LightMap() << "|"
+      << _material->LightMapTexCoordSet();
+  return key.str();
+}
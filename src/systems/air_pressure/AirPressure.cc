@@ -41,6 +41,7 @@
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/Sensor.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/SensorScheduler.hh"
 #include "ignition/gazebo/Util.hh"
 
 using namespace ignition;
@@ -54,6 +55,9 @@ class ignition::gazebo::systems::AirPressurePrivate
   public: std::unordered_map<Entity,
       std::unique_ptr<sensors::AirPressureSensor>> entitySensorMap;
 
+  /// \brief Wakes the sensors when they're due
+  public: SensorScheduler scheduler;
+
   /// \brief Ign-sensors sensor factory for creating sensors
   public: sensors::SensorFactory sensorFactory;
 
@@ -140,31 +144,11 @@ void AirPressure::PostUpdate(const UpdateInfo &_info,
 
   if (!_info.paused)
   {
-    // check to see if update is necessary
-    // we only update if there is at least one sensor that needs data
-    // and that sensor has subscribers.
-    // note: ign-sensors does its own throttling. Here the check is mainly
-    // to avoid doing work in the AirPressurePrivate::UpdatePressures function
-    bool needsUpdate = false;
-    for (auto &it : this->dataPtr->entitySensorMap)
-    {
-      if (it.second->NextDataUpdateTime() <= _info.simTime &&
-          it.second->HasConnections())
-      {
-        needsUpdate = true;
-        break;
-      }
-    }
-    if (!needsUpdate)
-      return;
-
-    this->dataPtr->UpdateAirPressures(_ecm);
-
-    for (auto &it : this->dataPtr->entitySensorMap)
-    {
-      // Update measurement time
-      it.second.get()->sensors::Sensor::Update(_info.simTime, false);
-    }
+    this->dataPtr->scheduler.UpdateDue<sensors::Sensor>(_info.simTime,
+        this->dataPtr->entitySensorMap, [&]
+        {
+          this->dataPtr->UpdateAirPressures(_ecm);
+        });
   }
 
   this->dataPtr->RemoveAirPressureEntities(_ecm);
@@ -211,6 +195,8 @@ void AirPressurePrivate::AddAirPressure(
 
   this->entitySensorMap.insert(
       std::make_pair(_entity, std::move(sensor)));
+  this->scheduler.Schedule(_entity,
+      std::chrono::steady_clock::duration::zero());
   this->newSensors.insert(_entity);
 }
 
@@ -288,6 +274,7 @@ void AirPressurePrivate::RemoveAirPressureEntities(
         }
 
         this->entitySensorMap.erase(sensorId);
+        this->scheduler.Remove(_entity);
 
         return true;
       });
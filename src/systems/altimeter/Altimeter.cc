@@ -43,6 +43,7 @@
 #include "ignition/gazebo/components/Sensor.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/SensorScheduler.hh"
 #include "ignition/gazebo/Util.hh"
 
 using namespace ignition;
@@ -56,6 +57,9 @@ class ignition::gazebo::systems::AltimeterPrivate
   public: std::unordered_map<Entity,
       std::unique_ptr<sensors::AltimeterSensor>> entitySensorMap;
 
+  /// \brief Wakes the sensors when they're due
+  public: SensorScheduler scheduler;
+
   /// \brief Ign-sensors sensor factory for creating sensors
   public: sensors::SensorFactory sensorFactory;
 
@@ -141,31 +145,11 @@ void Altimeter::PostUpdate(const UpdateInfo &_info,
   // Only update and publish if not paused.
   if (!_info.paused)
   {
-    // check to see if update is necessary
-    // we only update if there is at least one sensor that needs data
-    // and that sensor has subscribers.
-    // note: ign-sensors does its own throttling. Here the check is mainly
-    // to avoid doing work in the AltimeterPrivate::UpdateAltimeters function
-    bool needsUpdate = false;
-    for (auto &it : this->dataPtr->entitySensorMap)
-    {
-      if (it.second->NextDataUpdateTime() <= _info.simTime &&
-          it.second->HasConnections())
-      {
-        needsUpdate = true;
-        break;
-      }
-    }
-    if (!needsUpdate)
-      return;
-
-    this->dataPtr->UpdateAltimeters(_ecm);
-
-    for (auto &it : this->dataPtr->entitySensorMap)
-    {
-      // Update measurement time
-      it.second.get()->sensors::Sensor::Update(_info.simTime, false);
-    }
+    this->dataPtr->scheduler.UpdateDue<sensors::Sensor>(_info.simTime,
+        this->dataPtr->entitySensorMap, [&]
+        {
+          this->dataPtr->UpdateAltimeters(_ecm);
+        });
   }
 
   this->dataPtr->RemoveAltimeterEntities(_ecm);
@@ -213,6 +197,8 @@ void AltimeterPrivate::AddAltimeter(
 
   this->entitySensorMap.insert(
       std::make_pair(_entity, std::move(sensor)));
+  this->scheduler.Schedule(_entity,
+      std::chrono::steady_clock::duration::zero());
   this->newSensors.insert(_entity);
 }
 
@@ -293,6 +279,7 @@ void AltimeterPrivate::RemoveAltimeterEntities(
         }
 
         this->entitySensorMap.erase(sensorId);
+        this->scheduler.Remove(_entity);
 
         return true;
       });
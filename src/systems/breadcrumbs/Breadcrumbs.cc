@@ -19,7 +19,6 @@
 
 #include <ignition/msgs/empty.pb.h>
 
-#include <algorithm>
 #include <iterator>
 #include <string>
 #include <utility>
@@ -33,6 +32,7 @@
 #include <sdf/Geometry.hh>
 
 #include "ignition/gazebo/components/CanonicalLink.hh"
+#include "ignition/gazebo/components/Collision.hh"
 #include "ignition/gazebo/components/DetachableJoint.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Link.hh"
@@ -41,6 +41,7 @@
 #include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/Performer.hh"
 #include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/Visual.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/Util.hh"
 
@@ -74,6 +75,12 @@ void Breadcrumbs::Configure(const Entity &_entity,
   this->allowRenaming =
       _sdf->Get<bool>("allow_renaming", this->allowRenaming).first;
 
+  this->cloneDeployments =
+      _sdf->Get<bool>("clone_deployments", this->cloneDeployments).first;
+
+  this->mergeStatic =
+      _sdf->Get<bool>("merge_static", this->mergeStatic).first;
+
   this->model = Model(_entity);
   if (!this->model.Valid(_ecm))
   {
@@ -198,6 +205,9 @@ void Breadcrumbs::PreUpdate(const UpdateInfo &_info,
 
     auto poseComp = _ecm.Component<components::Pose>(this->model.Entity());
 
+    // Names and poses of breadcrumbs to clone from the prototype
+    std::vector<std::pair<std::string, math::Pose3d>> clones;
+
     for (std::size_t i = 0; i < cmds.size(); ++i)
     {
       if (this->maxDeployments < 0 ||
@@ -207,18 +217,13 @@ void Breadcrumbs::PreUpdate(const UpdateInfo &_info,
         std::string desiredName =
             modelToSpawn.Name() + "_" + std::to_string(this->numDeployments);
 
-        std::vector<std::string> modelNames;
-        _ecm.Each<components::Name, components::Model>(
-            [&modelNames](const Entity &, const components::Name *_name,
-                          const components::Model *)
-            {
-              modelNames.push_back(_name->Data());
-              return true;
-            });
-
-        // Check if there's a model with the same name.
-        auto it = std::find(modelNames.begin(), modelNames.end(), desiredName);
-        if (it != modelNames.end())
+        // Check if there's a model with the same name in the world.
+        auto nameTaken = [&](const std::string &_name)
+        {
+          return kNullEntity != _ecm.ChildByName<components::Model>(
+              this->worldEntity, _name);
+        };
+        if (nameTaken(desiredName))
         {
           if (!this->allowRenaming)
           {
@@ -226,13 +231,12 @@ void Breadcrumbs::PreUpdate(const UpdateInfo &_info,
                     << "] already exists and "
                     << "[allow_renaming] is false. Entity not spawned."
                     << std::endl;
-            return;
+            break;
           }
 
           std::string newName = desiredName;
           int counter = 0;
-          while (std::find(modelNames.begin(), modelNames.end(), newName) !=
-                 modelNames.end())
+          while (nameTaken(newName))
           {
             newName = desiredName + "_" + std::to_string(++counter);
           }
@@ -243,8 +247,28 @@ void Breadcrumbs::PreUpdate(const UpdateInfo &_info,
         modelToSpawn.SetRawPose(poseComp->Data() * modelToSpawn.RawPose());
         ignmsg << "Deploying " << modelToSpawn.Name() << " at "
                << modelToSpawn.RawPose() << std::endl;
+
+        // Breadcrumbs are copied from a previously deployed one after the
+        // loop, all at once, which is much cheaper than creating them from
+        // SDF. Performers aren't cloned because the level manager adds
+        // children to them.
+        bool cloneable = this->cloneDeployments && !this->isPerformer;
+        if (cloneable && this->prototype != kNullEntity &&
+            _ecm.HasEntity(this->prototype))
+        {
+          clones.push_back({modelToSpawn.Name(), modelToSpawn.RawPose()});
+          ++this->numDeployments;
+
+          msgs::Int32 remainingMsg;
+          remainingMsg.set_data(this->maxDeployments - this->numDeployments);
+          this->remainingPub.Publish(remainingMsg);
+          continue;
+        }
+
         Entity entity = this->creator->CreateEntities(&modelToSpawn);
         this->creator->SetParent(entity, this->worldEntity);
+        if (cloneable)
+          this->prototype = entity;
 
         // keep track of entities that are set to auto disable
         if (!modelToSpawn.Static() &&
@@ -288,6 +312,38 @@ void Breadcrumbs::PreUpdate(const UpdateInfo &_info,
       this->remainingPub.Publish(remainingMsg);
     }
 
+    if (!clones.empty())
+    {
+      auto cloned = _ecm.CloneMany(this->prototype, this->worldEntity, "",
+          clones.size());
+      for (std::size_t i = 0; i < cloned.size(); ++i)
+      {
+        // Name and place the copies like the prototype was
+        auto nameComp = _ecm.Component<components::Name>(cloned[i]);
+        if (nameComp)
+        {
+          *nameComp = components::Name(clones[i].first);
+          _ecm.SetChanged(cloned[i], components::Name::typeId,
+              ComponentState::OneTimeChange);
+        }
+        auto clonePoseComp = _ecm.Component<components::Pose>(cloned[i]);
+        if (clonePoseComp)
+          *clonePoseComp = components::Pose(clones[i].second);
+
+        if (!this->modelRoot.Model()->Static() &&
+            this->disablePhysicsTime >
+            std::chrono::steady_clock::duration::zero())
+        {
+          this->autoStaticEntities[cloned[i]] = _info.simTime;
+        }
+      }
+      if (cloned.size() != clones.size())
+      {
+        ignerr << "Failed to clone [" << clones.size() - cloned.size()
+               << "] breadcrumbs." << std::endl;
+      }
+    }
+
     std::set<Entity> processedEntities;
     for (const auto &e : this->pendingGeometryUpdate)
     {
@@ -328,7 +384,20 @@ void Breadcrumbs::PreUpdate(const UpdateInfo &_info,
       if (td > this->disablePhysicsTime)
       {
         auto name = _ecm.Component<components::Name>(it->first)->Data();
-        if (!this->MakeStatic(it->first, _ecm))
+        if (this->mergeStatic && !this->isPerformer)
+        {
+          if (!this->MergeStatic(it->first, _ecm))
+          {
+            ignerr << "Failed to merge breadcrumb '" << name
+                   << "' into static geometry." << std::endl;
+          }
+          else
+          {
+            igndbg << "Breadcrumb '" << name << "' merged into static "
+                   << "geometry." << std::endl;
+          }
+        }
+        else if (!this->MakeStatic(it->first, _ecm))
         {
           ignerr << "Failed to make breadcrumb '" << name
                  << "' static." << std::endl;
@@ -399,6 +468,73 @@ bool Breadcrumbs::MakeStatic(Entity _entity, EntityComponentManager &_ecm)
 }
 
 
+//////////////////////////////////////////////////
+bool Breadcrumbs::MergeStatic(Entity _entity, EntityComponentManager &_ecm)
+{
+  // All breadcrumbs are merged into a single link of a static model, which
+  // is created the first time
+  if (this->mergedLink == kNullEntity || !_ecm.HasEntity(this->mergedLink))
+  {
+    std::string mergedName = this->modelRoot.Model()->Name() + "__merged__";
+    for (int counter = 0; kNullEntity != _ecm.ChildByName<components::Model>(
+        this->worldEntity, mergedName); ++counter)
+    {
+      mergedName = this->modelRoot.Model()->Name() + "__merged_" +
+          std::to_string(counter) + "__";
+    }
+
+    sdf::ElementPtr mergedModelSDF(new sdf::Element);
+    sdf::initFile("model.sdf", mergedModelSDF);
+    mergedModelSDF->GetAttribute("name")->Set(mergedName);
+    mergedModelSDF->GetElement("static")->Set(true);
+    sdf::ElementPtr linkElem = mergedModelSDF->AddElement("link");
+    linkElem->GetAttribute("name")->Set("merged_link");
+    sdf::Model mergedModel;
+    mergedModel.Load(mergedModelSDF);
+
+    Entity mergedEntity = this->creator->CreateEntities(&mergedModel);
+    this->creator->SetParent(mergedEntity, this->worldEntity);
+    this->mergedLink = _ecm.ChildByName<components::Link>(mergedEntity,
+        "merged_link");
+    if (this->mergedLink == kNullEntity)
+      return false;
+  }
+
+  auto nameComp = _ecm.Component<components::Name>(_entity);
+  if (!nameComp)
+    return false;
+
+  // Copy the collisions and visuals of the breadcrumb into the merged link,
+  // at their current world pose since the merged model is at the origin
+  for (Entity link : _ecm.ChildrenByComponents(_entity, components::Link()))
+  {
+    auto linkName = _ecm.Component<components::Name>(link)->Data();
+    std::vector<Entity> parts =
+        _ecm.ChildrenByComponents(link, components::Collision());
+    std::vector<Entity> visuals =
+        _ecm.ChildrenByComponents(link, components::Visual());
+    parts.insert(parts.end(), visuals.begin(), visuals.end());
+
+    for (Entity part : parts)
+    {
+      math::Pose3d partPose = worldPose(part, _ecm);
+      std::string partName = nameComp->Data() + "_" + linkName + "_" +
+          _ecm.Component<components::Name>(part)->Data();
+      Entity merged = _ecm.Clone(part, this->mergedLink, partName, false);
+      if (merged == kNullEntity)
+        return false;
+
+      auto mergedPoseComp = _ecm.Component<components::Pose>(merged);
+      if (mergedPoseComp)
+        *mergedPoseComp = components::Pose(partPose);
+    }
+  }
+
+  // The breadcrumb itself drops out of simulation
+  _ecm.RequestRemoveEntity(_entity);
+  return true;
+}
+
 //////////////////////////////////////////////////
 void Breadcrumbs::OnDeploy(const msgs::Empty &)
 {
@@ -85,6 +85,15 @@ namespace systems
   /// `<topic_statistics>`: If true, then topic statistics are enabled on
   /// `<topic>` and error messages will be generated when messages are
   /// dropped. Default to false.
+  /// - `<clone_deployments>`: If true, breadcrumbs are deployed by cloning
+  /// the entities of the first deployed breadcrumb instead of creating them
+  /// from SDF each time. Ignored for performers. Defaults to false.
+  /// - `<merge_static>`: If true, breadcrumbs which reach
+  /// `<disable_physics_time>` are removed, and their collisions and visuals
+  /// are copied into a single static model shared by all breadcrumbs of
+  /// this system, so they don't add any entities to physics. Other parts of
+  /// the breadcrumbs, such as sensors, are lost. Ignored for performers.
+  /// Defaults to false.
   class Breadcrumbs
       : public System,
         public ISystemConfigure,
@@ -113,6 +122,13 @@ namespace systems
     /// \return True if operation is successful, false otherwise
     public: bool MakeStatic(Entity _entity, EntityComponentManager &_ecm);
 
+    /// \brief Replace an entity with copies of its collisions and visuals
+    /// attached to the merged static link.
+    /// \param[in] _entity Entity to merge
+    /// \param[in] _ecm Entity component manager
+    /// \return True if operation is successful, false otherwise
+    public: bool MergeStatic(Entity _entity, EntityComponentManager &_ecm);
+
     /// \brief Set to true after initialization with valid parameters
     private: bool initialized{false};
 
@@ -167,6 +183,18 @@ namespace systems
     /// \brief SDF DOM of a static model with empty link
     private: sdf::Model staticModelToSpawn;
 
+    /// \brief Whether to deploy breadcrumbs by cloning the prototype
+    private: bool cloneDeployments{false};
+
+    /// \brief Breadcrumb cloned by later deployments
+    private: Entity prototype{kNullEntity};
+
+    /// \brief Whether to merge static breadcrumbs into a single model
+    private: bool mergeStatic{false};
+
+    /// \brief Link of the static model which breadcrumbs are merged into
+    private: Entity mergedLink{kNullEntity};
+
     /// \brief Publishes remaining deployments.
     public: transport::Node::Publisher remainingPub;
 
@@ -19,6 +19,7 @@
 #include <map>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -46,11 +47,13 @@
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/Volume.hh"
 #include "ignition/gazebo/components/World.hh"
+#include "ignition/gazebo/EnvironmentalForces.hh"
 #include "ignition/gazebo/Link.hh"
 #include "ignition/gazebo/Model.hh"
 #include "ignition/gazebo/Util.hh"
 
 #include "Buoyancy.hh"
+#include "MeshVolumeTable.hh"
 
 using namespace ignition;
 using namespace gazebo;
@@ -136,8 +139,65 @@ class ignition::gazebo::systems::BuoyancyPrivate
   /// \brief Scoped names of entities that buoyancy should apply to. If empty,
   /// all links will receive buoyancy.
   public: std::unordered_set<std::string> enabled;
+
+  /// \brief Destructor
+  public: ~BuoyancyPrivate();
+
+  /// \brief Compute the buoyancy of all buoyant links and add it to their
+  /// wrenches.
+  /// \param[in] _ecm Immutable reference to the EntityComponentManager.
+  /// \param[in] _links Kinematics and wrenches of the links.
+  public: void Update(const EntityComponentManager &_ecm,
+                      LinkKinematics &_links);
+
+  /// \brief A link which has a volume.
+  public: struct BuoyantLink
+  {
+    /// \brief Link entity.
+    Entity entity;
+
+    /// \brief Slot of the link in the stage's batch.
+    std::size_t slot;
+
+    /// \brief Volume of the link.
+    double volume;
+
+    /// \brief Center of volume, expressed in the link frame.
+    math::Vector3d centerOfVolume;
+  };
+
+  /// \brief Links which have a volume, refreshed on every update.
+  public: std::vector<BuoyantLink> buoyantLinks;
+
+  /// \brief Get the volume table of a mesh, building it on first use.
+  /// \param[in] _mesh Mesh shape of a collision.
+  /// \return The table, or nullptr if the mesh can't be loaded.
+  public: std::shared_ptr<const MeshVolumeTable> MeshTable(
+      const sdf::Mesh &_mesh);
+
+  /// \brief Volume tables of mesh collisions, used by graded buoyancy.
+  public: std::unordered_map<Entity, std::shared_ptr<const MeshVolumeTable>>
+      meshTables;
+
+  /// \brief Volume tables by mesh file and scale, so that models which
+  /// share a mesh share its table.
+  public: std::map<std::pair<std::string, math::Vector3d>,
+      std::shared_ptr<const MeshVolumeTable>> meshTableCache;
+
+  /// \brief Stage which gathers the link kinematics and applies the wrenches
+  public: std::shared_ptr<EnvironmentalForces> forces;
+
+  /// \brief Buoyancy model registered to the stage
+  public: EnvironmentalForces::ModelId forceModel{0};
 };
 
+//////////////////////////////////////////////////
+BuoyancyPrivate::~BuoyancyPrivate()
+{
+  if (this->forces)
+    this->forces->RemoveModel(this->forceModel);
+}
+
 //////////////////////////////////////////////////
 double BuoyancyPrivate::UniformFluidDensity(const math::Pose3d &/*_pose*/) const
 {
@@ -245,6 +305,30 @@ std::pair<math::Vector3d, math::Vector3d> BuoyancyPrivate::ResolveForces(
   return {force, torque};
 }
 
+//////////////////////////////////////////////////
+std::shared_ptr<const MeshVolumeTable> BuoyancyPrivate::MeshTable(
+    const sdf::Mesh &_mesh)
+{
+  std::string file = asFullPath(_mesh.Uri(), _mesh.FilePath());
+  auto key = std::make_pair(file, _mesh.Scale());
+  auto it = this->meshTableCache.find(key);
+  if (it != this->meshTableCache.end())
+    return it->second;
+
+  const common::Mesh *mesh{nullptr};
+  if (common::MeshManager::Instance()->IsValidFilename(file))
+    mesh = common::MeshManager::Instance()->Load(file);
+  if (!mesh)
+  {
+    ignerr << "Unable to load mesh[" << file << "]\n";
+    return nullptr;
+  }
+
+  auto table = std::make_shared<const MeshVolumeTable>(*mesh, _mesh.Scale());
+  this->meshTableCache[key] = table;
+  return table;
+}
+
 //////////////////////////////////////////////////
 Buoyancy::Buoyancy()
   : dataPtr(std::make_unique<BuoyancyPrivate>())
@@ -452,10 +536,44 @@ void Buoyancy::PreUpdate(const UpdateInfo &_info,
     return true;
   });
 
+  // Slicing meshes is expensive, so precompute the distribution of their
+  // volume as they are created
+  if (this->dataPtr->buoyancyType ==
+      BuoyancyPrivate::BuoyancyType::GRADED_BUOYANCY)
+  {
+    _ecm.EachNew<components::Collision, components::CollisionElement>(
+        [&](const Entity &_entity,
+            const components::Collision *,
+            const components::CollisionElement *_coll) -> bool
+    {
+      auto geom = _coll->Data().Geom();
+      if (geom && geom->Type() == sdf::GeometryType::MESH &&
+          geom->MeshShape())
+      {
+        auto table = this->dataPtr->MeshTable(*geom->MeshShape());
+        if (table)
+          this->dataPtr->meshTables[_entity] = table;
+      }
+      return true;
+    });
+  }
+
   // Only update if not paused.
   if (_info.paused)
     return;
 
+  if (!this->dataPtr->forces)
+  {
+    this->dataPtr->forces = EnvironmentalForces::For(_ecm);
+    this->dataPtr->forceModel = this->dataPtr->forces->AddModel(
+        [this](const UpdateInfo &, const EntityComponentManager &_stageEcm,
+               LinkKinematics &_links)
+        {
+          this->dataPtr->Update(_stageEcm, _links);
+        });
+  }
+
+  this->dataPtr->buoyantLinks.clear();
   _ecm.Each<components::Link,
             components::Volume,
             components::CenterOfVolume>(
@@ -464,88 +582,116 @@ void Buoyancy::PreUpdate(const UpdateInfo &_info,
           const components::Volume *_volume,
           const components::CenterOfVolume *_centerOfVolume) -> bool
     {
-      // World pose of the link.
-      math::Pose3d linkWorldPose = worldPose(_entity, _ecm);
+      this->dataPtr->buoyantLinks.push_back({_entity,
+          this->dataPtr->forces->AddLink(_ecm, _entity),
+          _volume->Data(), _centerOfVolume->Data()});
+      return true;
+    });
 
-      Link link(_entity);
+  this->dataPtr->forces->Update(_info, _ecm, this->dataPtr->forceModel);
+}
 
-      math::Vector3d buoyancy;
-      // By Archimedes' principle,
-      // buoyancy = -(mass*gravity)*fluid_density/object_density
-      // object_density = mass/volume, so the mass term cancels.
-      if (this->dataPtr->buoyancyType
-        == BuoyancyPrivate::BuoyancyType::UNIFORM_BUOYANCY)
-      {
-        buoyancy =
-        -this->dataPtr->UniformFluidDensity(linkWorldPose) *
-        _volume->Data() * gravity->Data();
-
-        // Convert the center of volume to the world frame
-        math::Vector3d offsetWorld = linkWorldPose.Rot().RotateVector(
-            _centerOfVolume->Data());
-        // Compute the torque that should be applied due to buoyancy and
-        // the center of volume.
-        math::Vector3d torque = offsetWorld.Cross(buoyancy);
-
-        // Apply the wrench to the link. This wrench is applied in the
-        // Physics System.
-        link.AddWorldWrench(_ecm, buoyancy, torque);
-      }
-      else if (this->dataPtr->buoyancyType
-        == BuoyancyPrivate::BuoyancyType::GRADED_BUOYANCY)
+//////////////////////////////////////////////////
+void BuoyancyPrivate::Update(const EntityComponentManager &_ecm,
+    LinkKinematics &_links)
+{
+  IGN_PROFILE("BuoyancyPrivate::Update");
+  const components::Gravity *gravity = _ecm.Component<components::Gravity>(
+      this->world);
+  if (!gravity)
+    return;
+
+  for (const auto &buoyant : this->buoyantLinks)
+  {
+    if (!_links.valid[buoyant.slot])
+      continue;
+
+    // World pose of the link.
+    const math::Pose3d &linkWorldPose = _links.worldPoses[buoyant.slot];
+
+    math::Vector3d buoyancy;
+    // By Archimedes' principle,
+    // buoyancy = -(mass*gravity)*fluid_density/object_density
+    // object_density = mass/volume, so the mass term cancels.
+    if (this->buoyancyType == BuoyancyType::UNIFORM_BUOYANCY)
+    {
+      buoyancy =
+      -this->UniformFluidDensity(linkWorldPose) *
+      buoyant.volume * gravity->Data();
+
+      // Convert the center of volume to the world frame
+      math::Vector3d offsetWorld = linkWorldPose.Rot().RotateVector(
+          buoyant.centerOfVolume);
+      // Compute the torque that should be applied due to buoyancy and
+      // the center of volume.
+      math::Vector3d torque = offsetWorld.Cross(buoyancy);
+
+      // Add the wrench to the link. The stage applies it and it's applied
+      // in the Physics System.
+      _links.AddWorldWrench(buoyant.slot, buoyancy, torque);
+    }
+    else if (this->buoyancyType == BuoyancyType::GRADED_BUOYANCY)
+    {
+      std::vector<Entity> collisions = _ecm.ChildrenByComponents(
+        buoyant.entity, components::Collision());
+      this->buoyancyForces.clear();
+
+      for (auto e : collisions)
       {
-        std::vector<Entity> collisions = _ecm.ChildrenByComponents(
-          _entity, components::Collision());
-        this->dataPtr->buoyancyForces.clear();
+        const components::CollisionElement *coll =
+          _ecm.Component<components::CollisionElement>(e);
 
-        for (auto e : collisions)
-        {
-          const components::CollisionElement *coll =
-            _ecm.Component<components::CollisionElement>(e);
+        auto pose = worldPose(e, _ecm);
 
-          auto pose = worldPose(e, _ecm);
+        if (!coll)
+        {
+          ignerr << "Invalid collision pointer. This shouldn't happen\n";
+          continue;
+        }
 
-          if (!coll)
+        switch (coll->Data().Geom()->Type())
+        {
+          case sdf::GeometryType::BOX:
+            this->GradedFluidDensity<math::Boxd>(
+              pose,
+              coll->Data().Geom()->BoxShape()->Shape(),
+              gravity->Data());
+            break;
+          case sdf::GeometryType::SPHERE:
+            this->GradedFluidDensity<math::Sphered>(
+              pose,
+              coll->Data().Geom()->SphereShape()->Shape(),
+              gravity->Data());
+            break;
+          case sdf::GeometryType::MESH:
           {
-            ignerr << "Invalid collision pointer. This shouldn't happen\n";
-            continue;
+            auto table = this->meshTables.find(e);
+            if (table != this->meshTables.end())
+            {
+              this->GradedFluidDensity<MeshVolumeTable>(
+                pose, *table->second, gravity->Data());
+            }
+            break;
           }
-
-          switch (coll->Data().Geom()->Type())
+          default:
           {
-            case sdf::GeometryType::BOX:
-              this->dataPtr->GradedFluidDensity<math::Boxd>(
-                pose,
-                coll->Data().Geom()->BoxShape()->Shape(),
-                gravity->Data());
-              break;
-            case sdf::GeometryType::SPHERE:
-              this->dataPtr->GradedFluidDensity<math::Sphered>(
-                pose,
-                coll->Data().Geom()->SphereShape()->Shape(),
-                gravity->Data());
-              break;
-            default:
+            static bool warned{false};
+            if (!warned)
             {
-              static bool warned{false};
-              if (!warned)
-              {
-                ignwarn << "Only <box> and <sphere> collisions are supported "
-                  << "by the graded buoyancy option." << std::endl;
-                warned = true;
-              }
-              break;
+              ignwarn << "Only <box>, <sphere> and <mesh> collisions are "
+                << "supported by the graded buoyancy option." << std::endl;
+              warned = true;
             }
+            break;
           }
         }
-        auto [force, torque] = this->dataPtr->ResolveForces(linkWorldPose);
-        // Apply the wrench to the link. This wrench is applied in the
-        // Physics System.
-        link.AddWorldWrench(_ecm, force, torque);
       }
-
-      return true;
-  });
+      auto [force, torque] = this->ResolveForces(linkWorldPose);
+      // Add the wrench to the link. The stage applies it and it's applied
+      // in the Physics System.
+      _links.AddWorldWrench(buoyant.slot, force, torque);
+    }
+  }
 }
 
 //////////////////////////////////////////////////
@@ -52,7 +52,10 @@ namespace systems
   /// simulating an open ocean with its surface and under water behaviour. This
   /// mode slices the volume of each collision mesh according to where the water
   /// line is set. When defining a `<graded_buoyancy>` tag, one must also define
-  /// `<default_density>` and `<density_change>` tags.
+  /// `<default_density>` and `<density_change>` tags. Box, sphere and mesh
+  /// collisions are supported. The distribution of the volume of each mesh
+  /// along its axes is computed once, when its collision is created, so
+  /// slicing a mesh on each step is a table lookup.
   /// * `<default_density>` is the default fluid which the world should be
   /// filled with. [Units: kgm^-3]
   /// * `<density_change>` allows you to define a new layer.
@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "MeshVolumeTable.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <ignition/common/SubMesh.hh>
+#include <ignition/math/Helpers.hh>
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/// \brief Offsets of the rays within their grid cells. They are off center
+/// and differ between the two directions, so rays don't go through the
+/// diagonals which split the faces of regular meshes.
+static constexpr double kRayOffsetU{0.5137};
+static constexpr double kRayOffsetV{0.4709};
+
+//////////////////////////////////////////////////
+MeshVolumeTable::MeshVolumeTable(const common::Mesh &_mesh,
+    const math::Vector3d &_scale, std::size_t _slices,
+    std::size_t _resolution)
+{
+  using Triangle = std::array<math::Vector3d, 3>;
+  std::vector<Triangle> triangles;
+
+  math::Vector3d min(math::MAX_D, math::MAX_D, math::MAX_D);
+  math::Vector3d max(math::LOW_D, math::LOW_D, math::LOW_D);
+  for (unsigned int i = 0; i < _mesh.SubMeshCount(); ++i)
+  {
+    auto subMesh = _mesh.SubMeshByIndex(i).lock();
+    if (!subMesh ||
+        subMesh->SubMeshPrimitiveType() != common::SubMesh::TRIANGLES)
+    {
+      continue;
+    }
+
+    for (unsigned int j = 0; j + 2 < subMesh->IndexCount(); j += 3)
+    {
+      Triangle triangle;
+      for (unsigned int k = 0; k < 3; ++k)
+      {
+        triangle[k] = subMesh->Vertex(subMesh->Index(j + k)) * _scale;
+        min.Min(triangle[k]);
+        max.Max(triangle[k]);
+      }
+      triangles.push_back(triangle);
+    }
+  }
+
+  if (triangles.empty() || _slices == 0u || _resolution == 0u)
+    return;
+
+  for (int a = 0; a < 3; ++a)
+  {
+    // The other two axes span the grid of rays
+    const int u = (a + 1) % 3;
+    const int v = (a + 2) % 3;
+
+    const double step = (max[a] - min[a]) / _slices;
+    const double cellU = (max[u] - min[u]) / _resolution;
+    const double cellV = (max[v] - min[v]) / _resolution;
+    if (step <= 0.0 || cellU <= 0.0 || cellV <= 0.0)
+      continue;
+
+    // Where each ray crosses the surface
+    std::vector<std::vector<double>> hits(_resolution * _resolution);
+    auto cellRange = [&](double _lo, double _hi, double _min, double _cell,
+        double _offset)
+    {
+      const auto first = static_cast<long>(
+          std::ceil((_lo - _min) / _cell - _offset));
+      const auto last = static_cast<long>(
+          std::floor((_hi - _min) / _cell - _offset));
+      return std::make_pair(std::max(first, 0l),
+          std::min(last, static_cast<long>(_resolution) - 1));
+    };
+
+    for (const auto &tri : triangles)
+    {
+      const double du1 = tri[1][u] - tri[0][u];
+      const double dv1 = tri[1][v] - tri[0][v];
+      const double du2 = tri[2][u] - tri[0][u];
+      const double dv2 = tri[2][v] - tri[0][v];
+      const double det = du1 * dv2 - du2 * dv1;
+
+      // Parallel to the rays
+      if (std::abs(det) < 1e-12)
+        continue;
+
+      const auto [firstU, lastU] = cellRange(
+          std::min({tri[0][u], tri[1][u], tri[2][u]}),
+          std::max({tri[0][u], tri[1][u], tri[2][u]}),
+          min[u], cellU, kRayOffsetU);
+      const auto [firstV, lastV] = cellRange(
+          std::min({tri[0][v], tri[1][v], tri[2][v]}),
+          std::max({tri[0][v], tri[1][v], tri[2][v]}),
+          min[v], cellV, kRayOffsetV);
+
+      for (long i = firstU; i <= lastU; ++i)
+      {
+        const double du = min[u] + (i + kRayOffsetU) * cellU - tri[0][u];
+        for (long j = firstV; j <= lastV; ++j)
+        {
+          const double dv = min[v] + (j + kRayOffsetV) * cellV - tri[0][v];
+          const double w1 = (du * dv2 - du2 * dv) / det;
+          const double w2 = (du1 * dv - du * dv1) / det;
+          if (w1 < 0.0 || w2 < 0.0 || w1 + w2 > 1.0)
+            continue;
+
+          hits[i * _resolution + j].push_back(
+              (1.0 - w1 - w2) * tri[0][a] + w1 * tri[1][a] + w2 * tri[2][a]);
+        }
+      }
+    }
+
+    // Distribute the segments of each ray inside the mesh over the slices
+    std::vector<double> sliceVolume(_slices, 0.0);
+    std::vector<math::Vector3d> sliceMoment(_slices);
+    const double cellArea = cellU * cellV;
+    for (long i = 0; i < static_cast<long>(_resolution); ++i)
+    {
+      for (long j = 0; j < static_cast<long>(_resolution); ++j)
+      {
+        auto &rayHits = hits[i * _resolution + j];
+
+        // Rays which graze the surface can't be split into segments
+        if (rayHits.size() % 2 != 0)
+          continue;
+        std::sort(rayHits.begin(), rayHits.end());
+
+        math::Vector3d point;
+        point[u] = min[u] + (i + kRayOffsetU) * cellU;
+        point[v] = min[v] + (j + kRayOffsetV) * cellV;
+
+        for (std::size_t h = 0; h < rayHits.size(); h += 2)
+        {
+          const double lo = rayHits[h];
+          const double hi = rayHits[h + 1];
+          const auto first = std::min(static_cast<std::size_t>(
+              std::max(0.0, (lo - min[a]) / step)), _slices - 1);
+          const auto last = std::min(static_cast<std::size_t>(
+              std::max(0.0, (hi - min[a]) / step)), _slices - 1);
+          for (std::size_t s = first; s <= last; ++s)
+          {
+            const double sliceLo = std::max(lo, min[a] + s * step);
+            const double sliceHi = std::min(hi, min[a] + (s + 1) * step);
+            if (sliceHi <= sliceLo)
+              continue;
+
+            const double volume = (sliceHi - sliceLo) * cellArea;
+            point[a] = 0.5 * (sliceLo + sliceHi);
+            sliceVolume[s] += volume;
+            sliceMoment[s] += volume * point;
+          }
+        }
+      }
+    }
+
+    auto &table = this->axes[a];
+    table.start = min[a];
+    table.step = step;
+    table.volume.assign(_slices + 1, 0.0);
+    table.moment.assign(_slices + 1, math::Vector3d::Zero);
+    for (std::size_t s = 0; s < _slices; ++s)
+    {
+      table.volume[s + 1] = table.volume[s] + sliceVolume[s];
+      table.moment[s + 1] = table.moment[s] + sliceMoment[s];
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+double MeshVolumeTable::Volume() const
+{
+  const auto &table = this->axes[2];
+  return table.volume.empty() ? 0.0 : table.volume.back();
+}
+
+//////////////////////////////////////////////////
+double MeshVolumeTable::VolumeBelow(const math::Planed &_plane) const
+{
+  math::Vector3d moment;
+  return this->Below(_plane, moment);
+}
+
+//////////////////////////////////////////////////
+std::optional<math::Vector3d> MeshVolumeTable::CenterOfVolumeBelow(
+    const math::Planed &_plane) const
+{
+  math::Vector3d moment;
+  const double volume = this->Below(_plane, moment);
+  if (volume <= 0.0)
+    return std::nullopt;
+  return moment / volume;
+}
+
+//////////////////////////////////////////////////
+double MeshVolumeTable::Below(const math::Planed &_plane,
+    math::Vector3d &_moment) const
+{
+  _moment = math::Vector3d::Zero;
+
+  // Slice along the axis closest to the plane normal
+  const auto &normal = _plane.Normal();
+  int a = 0;
+  for (int i = 1; i < 3; ++i)
+  {
+    if (std::abs(normal[i]) > std::abs(normal[a]))
+      a = i;
+  }
+
+  const auto &table = this->axes[a];
+  if (table.volume.empty() || std::abs(normal[a]) <= 0.0)
+    return 0.0;
+
+  // Interpolate the cumulative tables at the plane
+  const double height = _plane.Offset() / normal[a];
+  const double slices = static_cast<double>(table.volume.size() - 1);
+  const double f = math::clamp((height - table.start) / table.step,
+      0.0, slices);
+  const auto s = std::min(static_cast<std::size_t>(f),
+      table.volume.size() - 2);
+  const double r = f - s;
+
+  double volume = table.volume[s] + r * (table.volume[s + 1] -
+      table.volume[s]);
+  _moment = table.moment[s] + r * (table.moment[s + 1] - table.moment[s]);
+
+  // The normal points down the axis, so the volume below the plane is above
+  // the height
+  if (normal[a] < 0.0)
+  {
+    volume = table.volume.back() - volume;
+    _moment = table.moment.back() - _moment;
+  }
+  return volume;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_BUOYANCY_MESHVOLUMETABLE_HH_
+#define IGNITION_GAZEBO_SYSTEMS_BUOYANCY_MESHVOLUMETABLE_HH_
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include <ignition/common/Mesh.hh>
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/buoyancy-system/Export.hh>
+#include <ignition/math/Plane.hh>
+#include <ignition/math/Vector3.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  /// \brief Precomputed distribution of the volume of a closed mesh along
+  /// each of its axes, so that the volume below a plane and its center can
+  /// be looked up instead of clipping the mesh.
+  ///
+  /// For each axis, the mesh is sampled by a grid of rays parallel to that
+  /// axis, and the volume and first moment of volume of each slice are
+  /// accumulated. Lookups interpolate between slices, and are exact for
+  /// planes normal to an axis up to the sampling resolution. For other
+  /// planes, the axis closest to the plane normal is used.
+  ///
+  /// The table has the same interface as the primitive shapes of
+  /// ignition::math, so it can be used wherever those are sliced.
+  class IGNITION_GAZEBO_BUOYANCY_SYSTEM_VISIBLE MeshVolumeTable
+  {
+    /// \brief Build the table of a mesh.
+    /// \param[in] _mesh Closed triangle mesh.
+    /// \param[in] _scale Scale applied to the mesh vertices.
+    /// \param[in] _slices Number of slices along each axis.
+    /// \param[in] _resolution Number of rays along each side of the grid
+    /// which samples each axis.
+    public: MeshVolumeTable(const common::Mesh &_mesh,
+        const math::Vector3d &_scale = math::Vector3d::One,
+        std::size_t _slices = 100u, std::size_t _resolution = 64u);
+
+    /// \brief Get the volume of the mesh, as sampled.
+    /// \return Volume [m^3].
+    public: double Volume() const;
+
+    /// \brief Get the volume of the mesh below a plane.
+    /// \param[in] _plane Plane in the mesh frame. The volume on the side
+    /// opposite to the plane normal is returned.
+    /// \return Volume below the plane [m^3].
+    public: double VolumeBelow(const math::Planed &_plane) const;
+
+    /// \brief Get the center of the volume of the mesh below a plane.
+    /// \param[in] _plane Plane in the mesh frame.
+    /// \return Center of volume in the mesh frame, or nullopt if there is no
+    /// volume below the plane.
+    public: std::optional<math::Vector3d> CenterOfVolumeBelow(
+        const math::Planed &_plane) const;
+
+    /// \brief Cumulative volume and first moment of one axis.
+    private: struct AxisTable
+    {
+      /// \brief Coordinate of the first slice boundary along the axis.
+      double start{0.0};
+
+      /// \brief Thickness of each slice.
+      double step{0.0};
+
+      /// \brief Volume below each slice boundary.
+      std::vector<double> volume;
+
+      /// \brief First moment of the volume below each slice boundary.
+      std::vector<math::Vector3d> moment;
+    };
+
+    /// \brief Look up the volume and first moment below a plane.
+    /// \param[in] _plane Plane in the mesh frame.
+    /// \param[out] _moment First moment of the volume below the plane.
+    /// \return Volume below the plane.
+    private: double Below(const math::Planed &_plane,
+        math::Vector3d &_moment) const;
+
+    /// \brief Tables of the x, y and z axes.
+    private: std::array<AxisTable, 3> axes;
+  };
+}
+}
+}
+}
+#endif
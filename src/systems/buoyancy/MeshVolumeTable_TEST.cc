@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ignition/common/MeshManager.hh>
+#include <ignition/math/Box.hh>
+#include <ignition/math/Sphere.hh>
+
+#include "MeshVolumeTable.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/////////////////////////////////////////////////
+TEST(MeshVolumeTable, Box)
+{
+  auto meshManager = common::MeshManager::Instance();
+  meshManager->CreateBox("mesh_volume_table_box", {1, 2, 3}, {1, 1});
+  auto mesh = meshManager->MeshByName("mesh_volume_table_box");
+  ASSERT_NE(nullptr, mesh);
+
+  MeshVolumeTable table(*mesh);
+  math::Boxd box(1, 2, 3);
+  EXPECT_NEAR(box.Volume(), table.Volume(), 1e-6);
+
+  // Half submerged along each axis
+  for (const auto &normal : {math::Vector3d::UnitX, math::Vector3d::UnitY,
+      math::Vector3d::UnitZ})
+  {
+    math::Planed plane(normal, 0.0);
+    EXPECT_NEAR(box.VolumeBelow(plane), table.VolumeBelow(plane), 1e-6);
+
+    auto center = table.CenterOfVolumeBelow(plane);
+    auto expected = box.CenterOfVolumeBelow(plane);
+    ASSERT_TRUE(center.has_value());
+    ASSERT_TRUE(expected.has_value());
+    EXPECT_NEAR(expected->X(), center->X(), 1e-2);
+    EXPECT_NEAR(expected->Y(), center->Y(), 1e-2);
+    EXPECT_NEAR(expected->Z(), center->Z(), 1e-2);
+  }
+
+  // Normal pointing down, so the volume above z = 1 is below the plane
+  math::Planed flipped(-math::Vector3d::UnitZ, -1.0);
+  EXPECT_NEAR(1.0, table.VolumeBelow(flipped), 1e-6);
+
+  // Out of the mesh
+  EXPECT_DOUBLE_EQ(0.0, table.VolumeBelow(math::Planed(
+      math::Vector3d::UnitZ, -2.0)));
+  EXPECT_FALSE(table.CenterOfVolumeBelow(math::Planed(
+      math::Vector3d::UnitZ, -2.0)).has_value());
+  EXPECT_NEAR(table.Volume(), table.VolumeBelow(math::Planed(
+      math::Vector3d::UnitZ, 2.0)), 1e-6);
+}
+
+/////////////////////////////////////////////////
+TEST(MeshVolumeTable, ScaledSphere)
+{
+  auto meshManager = common::MeshManager::Instance();
+  meshManager->CreateSphere("mesh_volume_table_sphere", 0.5, 32, 32);
+  auto mesh = meshManager->MeshByName("mesh_volume_table_sphere");
+  ASSERT_NE(nullptr, mesh);
+
+  MeshVolumeTable table(*mesh, {2, 2, 2});
+  math::Sphered sphere(1.0);
+
+  // The tessellated sphere is slightly smaller than the sphere
+  EXPECT_NEAR(sphere.Volume(), table.Volume(), 0.05 * sphere.Volume());
+
+  math::Planed plane(math::Vector3d::UnitZ, 0.5);
+  EXPECT_NEAR(sphere.VolumeBelow(plane), table.VolumeBelow(plane),
+      0.05 * sphere.VolumeBelow(plane));
+
+  auto center = table.CenterOfVolumeBelow(plane);
+  ASSERT_TRUE(center.has_value());
+  EXPECT_NEAR(0.0, center->X(), 1e-2);
+  EXPECT_NEAR(0.0, center->Y(), 1e-2);
+  EXPECT_NEAR(sphere.CenterOfVolumeBelow(plane)->Z(), center->Z(), 0.05);
+}
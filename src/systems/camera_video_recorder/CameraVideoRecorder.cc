@@ -15,11 +15,18 @@
  *
 */
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <regex>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
+#include <ignition/common/FlagSet.hh>
+#include <ignition/common/HWEncoderType.hh>
 #include <ignition/common/Profiler.hh>
 #include <ignition/common/VideoEncoder.hh>
 #include <ignition/plugin/Register.hh>
@@ -53,6 +60,9 @@ using namespace systems;
 // Private data class.
 class ignition::gazebo::systems::CameraVideoRecorderPrivate
 {
+  /// \brief Destructor
+  public: ~CameraVideoRecorderPrivate();
+
   /// \brief Callback for the video recorder service
   public: bool OnRecordVideo(const msgs::VideoRecord &_msg,
       msgs::Boolean &_res);
@@ -63,6 +73,18 @@ class ignition::gazebo::systems::CameraVideoRecorderPrivate
   /// \brief Callback for new images
   public: void OnImage(const msgs::Image &_msg);
 
+  /// \brief Start the video encoder and the thread feeding it.
+  /// \param[in] _width Image width
+  /// \param[in] _height Image height
+  public: void StartEncoding(unsigned int _width, unsigned int _height);
+
+  /// \brief Encode the queued frames until stopped, run by encodeThread.
+  public: void EncodeFrames();
+
+  /// \brief Encode the remaining queued frames, then stop the encoding
+  /// thread and the video encoder. Does nothing if not encoding.
+  public: void StopEncoding();
+
   /// \brief Transport node
   public: transport::Node node;
 
@@ -90,12 +112,58 @@ class ignition::gazebo::systems::CameraVideoRecorderPrivate
   /// \brief Name of the camera
   public: std::string cameraName;
 
-  /// \brief Image from user camera
-  public: rendering::Image cameraImage;
+  /// \brief A camera image waiting to be encoded
+  public: struct EncodeFrame
+  {
+    /// \brief Image, taken from framePool
+    rendering::Image image;
+
+    /// \brief Timestamp of the image
+    std::chrono::steady_clock::time_point time;
+  };
 
-  /// \brief Video encoder
+  /// \brief Video encoder, only used by encodeThread while encoding.
   public: common::VideoEncoder videoEncoder;
 
+  /// \brief True while the video encoder and encodeThread run. Only used
+  /// in the rendering thread.
+  public: bool encoding{false};
+
+  /// \brief Thread encoding frames, so encoding doesn't hold up rendering.
+  public: std::thread encodeThread;
+
+  /// \brief Protects encodeQueue, framePool and stopEncoding.
+  public: std::mutex encodeMutex;
+
+  /// \brief Notified when a frame is queued or encoding should stop.
+  public: std::condition_variable encodeCv;
+
+  /// \brief Frames waiting to be encoded, oldest first.
+  public: std::deque<EncodeFrame> encodeQueue;
+
+  /// \brief Images free to be copied into. Frames are dropped when it's
+  /// empty, so memory stays bounded when encoding can't keep up. The
+  /// camera copies straight into these images, which are handed to the
+  /// encoder without further copies.
+  public: std::vector<rendering::Image> framePool;
+
+  /// \brief Set to ask encodeThread to stop once the queue is empty.
+  public: bool stopEncoding{false};
+
+  /// \brief Number of frames dropped during the current recording because
+  /// the frame pool was empty.
+  public: uint64_t droppedFrames{0u};
+
+  /// \brief Number of images in the frame pool.
+  public: unsigned int queueSize{4u};
+
+  /// \brief Hardware encoders which may be used, software encoding is
+  /// used if none of them is available.
+  public: common::FlagSet<common::HWEncoderType> hwEncoders;
+
+  /// \brief Device of the hardware encoder, empty to pick the default.
+  public: std::string hwEncoderDevice;
+
   /// \brief Video encoding format
   public: std::string recordVideoFormat;
 
@@ -145,6 +213,112 @@ void CameraVideoRecorderPrivate::OnImage(const msgs::Image &)
   // No work is done here. We need to subscribe to the sensor to make it active.
 }
 
+//////////////////////////////////////////////////
+CameraVideoRecorderPrivate::~CameraVideoRecorderPrivate()
+{
+  this->StopEncoding();
+}
+
+//////////////////////////////////////////////////
+void CameraVideoRecorderPrivate::StartEncoding(unsigned int _width,
+    unsigned int _height)
+{
+  this->videoEncoder.Start(this->recordVideoFormat,
+      this->tmpVideoFilename, _width, _height, this->fps,
+      this->recordVideoBitrate, this->hwEncoders, this->hwEncoderDevice);
+
+  this->recordStartTime = std::chrono::steady_clock::time_point(
+        std::chrono::duration(std::chrono::seconds(0)));
+
+  this->framePool.clear();
+  for (unsigned int i = 0; i < this->queueSize; ++i)
+    this->framePool.push_back(this->camera->CreateImage());
+  this->encodeQueue.clear();
+  this->stopEncoding = false;
+  this->droppedFrames = 0u;
+
+  this->encodeThread =
+      std::thread(&CameraVideoRecorderPrivate::EncodeFrames, this);
+  this->encoding = true;
+}
+
+//////////////////////////////////////////////////
+void CameraVideoRecorderPrivate::EncodeFrames()
+{
+  while (true)
+  {
+    EncodeFrame frame;
+    {
+      std::unique_lock<std::mutex> lock(this->encodeMutex);
+      this->encodeCv.wait(lock, [this]
+      {
+        return this->stopEncoding || !this->encodeQueue.empty();
+      });
+
+      // Only stop once all frames are encoded
+      if (this->encodeQueue.empty())
+        return;
+
+      frame = std::move(this->encodeQueue.front());
+      this->encodeQueue.pop_front();
+    }
+
+    bool frameAdded = this->videoEncoder.AddFrame(
+        frame.image.Data<unsigned char>(), frame.image.Width(),
+        frame.image.Height(), frame.time);
+
+    if (frameAdded)
+    {
+      // publish recorder stats
+      if (this->recordStartTime ==
+          std::chrono::steady_clock::time_point(
+            std::chrono::duration(std::chrono::seconds(0))))
+      {
+        // start time, i.e. time when first frame is added
+        this->recordStartTime = frame.time;
+      }
+
+      std::chrono::steady_clock::duration dt;
+      dt = frame.time - this->recordStartTime;
+      int64_t sec, nsec;
+      std::tie(sec, nsec) = math::durationToSecNsec(dt);
+      msgs::Time msg;
+      msg.set_sec(sec);
+      msg.set_nsec(nsec);
+      this->recorderStatsPub.Publish(msg);
+    }
+
+    std::lock_guard<std::mutex> lock(this->encodeMutex);
+    this->framePool.push_back(std::move(frame.image));
+  }
+}
+
+//////////////////////////////////////////////////
+void CameraVideoRecorderPrivate::StopEncoding()
+{
+  if (!this->encoding)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(this->encodeMutex);
+    this->stopEncoding = true;
+  }
+  this->encodeCv.notify_all();
+  this->encodeThread.join();
+
+  this->videoEncoder.Stop();
+  this->framePool.clear();
+  this->encoding = false;
+
+  if (this->droppedFrames > 0u)
+  {
+    ignwarn << "Dropped [" << this->droppedFrames << "] frames recording ["
+            << this->cameraName << "] because encoding couldn't keep up. "
+            << "Consider increasing <queue_size> or using a hardware "
+            << "encoder." << std::endl;
+  }
+}
+
 //////////////////////////////////////////////////
 bool CameraVideoRecorderPrivate::OnRecordVideo(const msgs::VideoRecord &_msg,
     msgs::Boolean &_res)
@@ -264,6 +438,34 @@ void CameraVideoRecorder::Configure(
 
   this->dataPtr->fps = _sdf->Get<unsigned int>("fps", this->dataPtr->fps).first;
 
+  this->dataPtr->queueSize = std::max(1u, _sdf->Get<unsigned int>(
+      "queue_size", this->dataPtr->queueSize).first);
+
+  // Hardware encoders to try before falling back to software encoding
+  auto hwEncoder = common::lowercase(
+      _sdf->Get<std::string>("hw_encoder", "none").first);
+  if (hwEncoder == "nvenc")
+  {
+    this->dataPtr->hwEncoders |= common::HWEncoderType::NVENC;
+  }
+  else if (hwEncoder == "vaapi")
+  {
+    this->dataPtr->hwEncoders |= common::HWEncoderType::VAAPI;
+  }
+  else if (hwEncoder == "auto")
+  {
+    this->dataPtr->hwEncoders |= common::HWEncoderType::NVENC;
+    this->dataPtr->hwEncoders |= common::HWEncoderType::VAAPI;
+  }
+  else if (hwEncoder != "none")
+  {
+    ignerr << "Unknown hardware encoder [" << hwEncoder << "], available "
+           << "ones are: none, nvenc, vaapi and auto. Using software "
+           << "encoding." << std::endl;
+  }
+  this->dataPtr->hwEncoderDevice = _sdf->Get<std::string>(
+      "hw_encoder_device", "").first;
+
   // recorder stats topic
   std::string recorderStatsTopic = this->dataPtr->sensorTopic + "/stats";
   this->dataPtr->recorderStatsPub =
@@ -322,45 +524,46 @@ void CameraVideoRecorderPrivate::OnPostRender()
     unsigned int width = this->camera->ImageWidth();
     unsigned int height = this->camera->ImageHeight();
 
-    if (this->cameraImage.Width() != width ||
-        this->cameraImage.Height() != height)
+    // Video recorder is on. Queue more frames for it
+    if (this->encoding)
     {
-      this->cameraImage = this->camera->CreateImage();
-    }
-
-    // Video recorder is on. Add more frames to it
-    if (this->videoEncoder.IsEncoding())
-    {
-      this->camera->Copy(this->cameraImage);
-      std::chrono::steady_clock::time_point t;
-        std::chrono::steady_clock::now();
-      if (this->recordVideoUseSimTime)
-        t = std::chrono::steady_clock::time_point(this->simTime);
-      else
-        t = std::chrono::steady_clock::now();
-
-      bool frameAdded = this->videoEncoder.AddFrame(
-          this->cameraImage.Data<unsigned char>(), width, height, t);
+      EncodeFrame frame;
+      bool haveImage{false};
+      {
+        std::lock_guard<std::mutex> encodeLock(this->encodeMutex);
+        if (!this->framePool.empty())
+        {
+          frame.image = std::move(this->framePool.back());
+          this->framePool.pop_back();
+          haveImage = true;
+        }
+      }
 
-      if (frameAdded)
+      if (!haveImage || frame.image.Width() != width ||
+          frame.image.Height() != height)
       {
-        // publish recorder stats
-        if (this->recordStartTime ==
-            std::chrono::steady_clock::time_point(
-              std::chrono::duration(std::chrono::seconds(0))))
+        // Drop the frame rather than stall rendering. Images of a
+        // different size than the video are dropped too.
+        ++this->droppedFrames;
+        if (haveImage)
         {
-          // start time, i.e. time when first frame is added
-          this->recordStartTime = t;
+          std::lock_guard<std::mutex> encodeLock(this->encodeMutex);
+          this->framePool.push_back(std::move(frame.image));
         }
+      }
+      else
+      {
+        this->camera->Copy(frame.image);
+        if (this->recordVideoUseSimTime)
+          frame.time = std::chrono::steady_clock::time_point(this->simTime);
+        else
+          frame.time = std::chrono::steady_clock::now();
 
-        std::chrono::steady_clock::duration dt;
-        dt = t - this->recordStartTime;
-        int64_t sec, nsec;
-        std::tie(sec, nsec) = math::durationToSecNsec(dt);
-        msgs::Time msg;
-        msg.set_sec(sec);
-        msg.set_nsec(nsec);
-        this->recorderStatsPub.Publish(msg);
+        {
+          std::lock_guard<std::mutex> encodeLock(this->encodeMutex);
+          this->encodeQueue.push_back(std::move(frame));
+        }
+        this->encodeCv.notify_one();
       }
     }
     // Video recorder is idle. Start recording.
@@ -374,26 +577,21 @@ void CameraVideoRecorderPrivate::OnPostRender()
       this->node.Subscribe(this->sensorTopic,
           &CameraVideoRecorderPrivate::OnImage, this);
 
-      this->videoEncoder.Start(this->recordVideoFormat,
-          this->tmpVideoFilename, width, height, this->fps,
-          this->recordVideoBitrate);
-
-      this->recordStartTime = std::chrono::steady_clock::time_point(
-            std::chrono::duration(std::chrono::seconds(0)));
+      this->StartEncoding(width, height);
 
       ignmsg << "Start video recording on [" << this->service << "]. "
              << "Encoding to tmp file: ["
              << this->tmpVideoFilename << "]" << std::endl;
     }
   }
-  else if (this->videoEncoder.IsEncoding())
+  else if (this->encoding)
   {
     // unsubscribe to let the sensor become inactive if there are no
     // other connections
     this->node.Unsubscribe(this->sensorTopic);
 
-    // stop encoding
-    this->videoEncoder.Stop();
+    // encode the queued frames and stop encoding
+    this->StopEncoding();
 
     ignmsg << "Stop video recording on [" << this->service << "]." << std::endl;
 
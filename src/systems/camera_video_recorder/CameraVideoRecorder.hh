@@ -51,6 +51,19 @@ namespace systems
   ///
   ///   <bitrate> Video recorder bitrate (bps). The default value is
   ///             2070000 bps, and the supported type is unsigned int.
+  ///
+  ///   <queue_size> Number of frames which can wait to be encoded. Frames
+  ///                are encoded in a separate thread, and dropped while
+  ///                this many are waiting. The default value is 4.
+  ///
+  ///   <hw_encoder> Hardware encoder to use, one of none, nvenc, vaapi or
+  ///                auto, which tries all of them. Software encoding is used
+  ///                if the hardware encoder isn't available. The default
+  ///                value is none.
+  ///
+  ///   <hw_encoder_device> Device of the hardware encoder, such as
+  ///                       /dev/dri/renderD128 for VAAPI. By default the
+  ///                       encoder picks one.
   class CameraVideoRecorder final:
     public System,
     public ISystemConfigure,
@@ -32,6 +32,7 @@
 #include <ignition/gazebo/components/Visual.hh>
 #include <ignition/gazebo/components/World.hh>
 #include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/MeshCache.hh>
 #include <ignition/gazebo/Util.hh>
 
 #include <sdf/Light.hh>
@@ -213,7 +214,7 @@ class ignition::gazebo::systems::ColladaWorldExporterPrivate
           ignerr << "Mesh geometry missing uri" << std::endl;
           return true;
         }
-        mesh = meshManager->Load(fullPath);
+        mesh = MeshCache::Instance().Load(fullPath);
 
         if (!mesh) {
           ignerr << "mesh not found!" << std::endl;
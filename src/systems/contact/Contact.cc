@@ -19,6 +19,7 @@
 
 #include <ignition/msgs/contact.pb.h>
 #include <ignition/msgs/contacts.pb.h>
+#include <ignition/msgs/Utility.hh>
 
 #include <string>
 #include <unordered_map>
@@ -37,7 +38,7 @@
 #include "ignition/gazebo/Util.hh"
 #include "ignition/gazebo/components/Collision.hh"
 #include "ignition/gazebo/components/ContactSensor.hh"
-#include "ignition/gazebo/components/ContactSensorData.hh"
+#include "ignition/gazebo/components/ContactPoints.hh"
 #include "ignition/gazebo/components/Link.hh"
 #include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/components/ParentEntity.hh"
@@ -58,9 +59,12 @@ class ContactSensor
 
   /// \brief Add contacts to the list to be published
   /// \param[in] _stamp Time stamp of the sensor measurement
-  /// \param[in] _contacts A contact message to be added to the list
+  /// \param[in] _points Contact points of one collision. Points with the same
+  /// collision2 are grouped into a single contact message.
+  /// \param[in] _ecm Immutable reference to ECM, used to get entity names.
   public: void AddContacts(const std::chrono::steady_clock::duration &_stamp,
-                           const msgs::Contacts &_contacts);
+                           const std::vector<contact::ContactPoint> &_points,
+                           const EntityComponentManager &_ecm);
 
   /// \brief Publish sensor data over ign transport
   public: void Publish();
@@ -129,14 +133,28 @@ void ContactSensor::Load(const sdf::ElementPtr &_sdf, const std::string &_topic,
 //////////////////////////////////////////////////
 void ContactSensor::AddContacts(
     const std::chrono::steady_clock::duration &_stamp,
-    const msgs::Contacts &_contacts)
+    const std::vector<contact::ContactPoint> &_points,
+    const EntityComponentManager &_ecm)
 {
   auto stamp = convert<msgs::Time>(_stamp);
-  for (const auto &contact : _contacts.contact())
+  msgs::Contact *newContact{nullptr};
+  for (const auto &point : _points)
   {
-    auto *newContact = this->contactsMsg.add_contact();
-    newContact->CopyFrom(contact);
-    newContact->mutable_header()->mutable_stamp()->CopyFrom(stamp);
+    if (nullptr == newContact ||
+        newContact->collision2().id() != point.collision2)
+    {
+      newContact = this->contactsMsg.add_contact();
+      newContact->mutable_header()->mutable_stamp()->CopyFrom(stamp);
+      newContact->mutable_collision1()->set_id(point.collision1);
+      newContact->mutable_collision2()->set_id(point.collision2);
+      newContact->mutable_collision1()->set_name(removeParentScope(
+          scopedName(point.collision1, _ecm, "::", 0), "::"));
+      newContact->mutable_collision2()->set_name(removeParentScope(
+          scopedName(point.collision2, _ecm, "::", 0), "::"));
+    }
+    msgs::Set(newContact->add_position(), point.position);
+    msgs::Set(newContact->add_normal(), point.normal);
+    newContact->add_depth(point.depth);
   }
 
   this->contactsMsg.mutable_header()->mutable_stamp()->CopyFrom(stamp);
@@ -196,7 +214,7 @@ void ContactPrivate::CreateSensors(EntityComponentManager &_ecm)
 
             // Create component to be filled by physics.
             _ecm.CreateComponent(childEntities.front(),
-                                 components::ContactSensorData());
+                                 components::ContactPoints());
           }
         }
 
@@ -218,15 +236,19 @@ void ContactPrivate::UpdateSensors(const UpdateInfo &_info,
   IGN_PROFILE("ContactPrivate::UpdateSensors");
   for (const auto &item : this->entitySensorMap)
   {
+    // Messages are only worth building if someone is listening
+    if (!item.second->pub.HasConnections())
+      continue;
+
     for (const Entity &entity : item.second->collisionEntities)
     {
-      auto contacts = _ecm.Component<components::ContactSensorData>(entity);
+      auto contacts = _ecm.Component<components::ContactPoints>(entity);
 
-      // We will assume that the ContactData component will have been created if
-      // this entity is in the collisionEntities list
-      if (contacts->Data().contact_size() > 0)
+      // We will assume that the ContactPoints component will have been
+      // created if this entity is in the collisionEntities list
+      if (!contacts->Data().empty())
       {
-        item.second->AddContacts(_info.simTime, contacts->Data());
+        item.second->AddContacts(_info.simTime, contacts->Data(), _ecm);
       }
     }
   }
@@ -15,6 +15,7 @@
  *
  */
 
+#include <memory>
 #include <vector>
 
 #include <ignition/plugin/Register.hh>
@@ -28,7 +29,6 @@
 #include "ignition/gazebo/components/Link.hh"
 #include "ignition/gazebo/components/Model.hh"
 #include "ignition/gazebo/components/Name.hh"
-#include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/Model.hh"
 #include "ignition/gazebo/Util.hh"
@@ -109,6 +109,26 @@ void DetachableJoint::Configure(const Entity &_entity,
       _sdf->Get<bool>("suppress_child_warning", this->suppressChildWarning)
           .first;
 
+  // Look for the child again only when entities are created or renamed. The
+  // observer stops itself if the system is gone.
+  std::weak_ptr<bool> pending = this->childSearchPending;
+  auto ecm = &_ecm;
+  auto observerId = std::make_shared<uint64_t>(0u);
+  *observerId = _ecm.AddComponentObserver(components::Name::typeId,
+      [pending, ecm, observerId](
+          const EntityComponentManager::ComponentChanges &_changes)
+      {
+        auto searchPending = pending.lock();
+        if (!searchPending)
+        {
+          ecm->RemoveComponentObserver(*observerId);
+          return;
+        }
+        if (!_changes.added.empty() || !_changes.changed.empty())
+          *searchPending = true;
+      });
+  this->nameObserver = *observerId;
+
   this->validConfig = true;
 }
 
@@ -118,8 +138,11 @@ void DetachableJoint::PreUpdate(
   EntityComponentManager &_ecm)
 {
   IGN_PROFILE("DetachableJoint::PreUpdate");
-  if (this->validConfig && !this->initialized)
+
+  if (this->validConfig && !this->initialized && *this->childSearchPending)
   {
+    *this->childSearchPending = false;
+
     // Look for the child model and link
     Entity modelEntity{kNullEntity};
 
@@ -134,9 +157,8 @@ void DetachableJoint::PreUpdate(
     }
     if (kNullEntity != modelEntity)
     {
-      this->childLinkEntity = _ecm.EntityByComponents(
-          components::Link(), components::ParentEntity(modelEntity),
-          components::Name(this->childLinkName));
+      this->childLinkEntity = _ecm.ChildByName<components::Link>(
+          modelEntity, this->childLinkName);
 
       if (kNullEntity != this->childLinkEntity)
       {
@@ -156,6 +178,7 @@ void DetachableJoint::PreUpdate(
                << "[" << this->topic << "]" << std::endl;
 
         this->initialized = true;
+        _ecm.RemoveComponentObserver(this->nameObserver);
       }
       else
       {
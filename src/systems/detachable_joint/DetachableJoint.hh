@@ -111,6 +111,15 @@ namespace systems
 
     /// \brief Whether the system has been initialized
     private: bool initialized{false};
+
+    /// \brief Whether Name components were added or changed since the child
+    /// was last searched for. Shared with the observer of Name components.
+    private: std::shared_ptr<bool> childSearchPending{
+        std::make_shared<bool>(true)};
+
+    /// \brief Id of the observer of Name components, which is removed once
+    /// the child is found.
+    private: uint64_t nameObserver{0u};
   };
   }
 }
@@ -22,6 +22,8 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <memory>
 #include <mutex>
 #include <regex>
 #include <string>
@@ -154,6 +156,10 @@ class ElevatorPrivate : public ElevatorCommonPrivate
   /// \brief Last state publish simulation time
   public: std::chrono::steady_clock::duration lastStatePubTime{0};
 
+  /// \brief Whether the cabin joint position changed since the state was
+  /// last computed. Set by the observer of the cabin joint position.
+  public: bool cabinMoved{true};
+
   /// \brief Elevator state publisher
   public: transport::Node::Publisher statePub;
 
@@ -199,6 +205,25 @@ void Elevator::Configure(const Entity &_entity,
                                 _ecm))
     return;
 
+  // Recompute the state only when the cabin moves. The observer stops itself
+  // if the system is gone.
+  std::weak_ptr<ElevatorPrivate> weakData = this->dataPtr;
+  auto ecm = &_ecm;
+  auto observerId = std::make_shared<uint64_t>(0u);
+  *observerId = _ecm.AddComponentObserver(
+      components::JointPosition::typeId,
+      [weakData, ecm, observerId](
+          const EntityComponentManager::ComponentChanges &)
+      {
+        auto data = weakData.lock();
+        if (!data)
+        {
+          ecm->RemoveComponentObserver(*observerId);
+          return;
+        }
+        data->cabinMoved = true;
+      }, this->dataPtr->cabinJoint);
+
   if (!this->dataPtr->InitDoors(doorJointPrefix, topicPrefix, _ecm))
     return;
 
@@ -251,8 +276,14 @@ void Elevator::PostUpdate(const UpdateInfo &_info,
 
   std::lock_guard<std::recursive_mutex> lock(this->dataPtr->mutex);
   this->dataPtr->UpdateState(_info, _ecm);
-  this->dataPtr->doorTimer->Update(
-      _info, this->dataPtr->isDoorwayBlockedStates[this->dataPtr->state]);
+
+  // The timer only matters while a door is held open, and it's reset when
+  // started, so an idle timer isn't updated
+  if (this->dataPtr->doorTimer->IsActive())
+  {
+    this->dataPtr->doorTimer->Update(
+        _info, this->dataPtr->isDoorwayBlockedStates[this->dataPtr->state]);
+  }
   this->dataPtr->doorJointMonitor.Update(_ecm);
   this->dataPtr->cabinJointMonitor.Update(_ecm);
 }
@@ -397,15 +428,24 @@ void ElevatorPrivate::SetCabinMonitor(
 void ElevatorPrivate::UpdateState(const ignition::gazebo::UpdateInfo &_info,
                                   const EntityComponentManager &_ecm)
 {
-  // Update state
-  double pos =
-      _ecm.ComponentData<components::JointPosition>(this->cabinJoint)->front();
-  std::vector<int32_t> diffs(this->cabinTargets.size());
-  std::transform(this->cabinTargets.begin(), this->cabinTargets.end(),
-                 diffs.begin(),
-                 [&pos](auto target) { return std::fabs(target - pos); });
-  auto it = std::min_element(diffs.begin(), diffs.end());
-  this->state = static_cast<int32_t>(std::distance(diffs.begin(), it));
+  // Update state, only if the cabin moved since it was last computed
+  if (this->cabinMoved)
+  {
+    this->cabinMoved = false;
+    const auto jointPos =
+        _ecm.ComponentData<components::JointPosition>(this->cabinJoint);
+    if (jointPos && !jointPos->empty())
+    {
+      const double pos = jointPos->front();
+      auto it = std::min_element(this->cabinTargets.begin(),
+          this->cabinTargets.end(), [&pos](double _a, double _b)
+          {
+            return std::fabs(_a - pos) < std::fabs(_b - pos);
+          });
+      this->state = static_cast<int32_t>(
+          std::distance(this->cabinTargets.begin(), it));
+    }
+  }
 
   // Throttle publish rate
   auto elapsed = _info.simTime - this->lastStatePubTime;
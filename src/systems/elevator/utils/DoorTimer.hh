@@ -67,6 +67,10 @@ class DoorTimer
   /// blocked
   public: void Update(const UpdateInfo &_info, bool _isDoorwayBlocked);
 
+  /// \brief Checks whether the timer is running
+  /// \return True if the timer was started and hasn't timed out yet
+  public: bool IsActive() const;
+
   /// \brief Private data pointer
   private: std::unique_ptr<DoorTimerPrivate> dataPtr;
 };
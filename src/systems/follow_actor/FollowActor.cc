@@ -15,7 +15,16 @@
  *
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <ignition/plugin/Register.hh>
 
@@ -33,36 +42,386 @@ using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+/// \brief All the actors of a world which follow a target. The first
+/// FollowActor plugin to update on a step moves all of them in a single
+/// parallel pass, so the cost of each step doesn't grow with the number of
+/// plugin instances. There's one crowd per entity component manager, see
+/// For.
+class FollowActorCrowd
+{
+  /// \brief Parameters and state of a following actor.
+  public: struct Agent
+  {
+    /// \brief Entity to follow.
+    Entity target{kNullEntity};
+
+    /// \brief Velocity of the actor.
+    double velocity{0.8};
+
+    /// \brief Minimum distance in meters to keep away from target.
+    double minDistance{1.2};
+
+    /// \brief Maximum distance in meters to keep away from target.
+    double maxDistance{4};
+
+    /// \brief Velocity of the animation dislocation on the X axis, in m/s.
+    double animationXVel{2.0};
+
+    /// \brief Distance in meters to keep from other actors of the crowd,
+    /// zero to walk through them.
+    double avoidanceRadius{0.0};
+
+    /// \brief True if currently following.
+    bool following{true};
+
+    /// \brief True if following changed on the last update.
+    bool followingChanged{false};
+
+    /// \brief True if the actor moved on the last update.
+    bool moved{false};
+  };
+
+  /// \brief Get the crowd of an entity component manager, creating it if
+  /// needed.
+  /// \param[in] _ecm Entity component manager.
+  /// \return The crowd, shared by all plugins of that manager.
+  public: static std::shared_ptr<FollowActorCrowd> For(
+      const EntityComponentManager &_ecm);
+
+  /// \brief Add an actor, or replace its parameters.
+  /// \param[in] _actor Actor entity.
+  /// \param[in] _agent Parameters of the actor.
+  public: void Add(Entity _actor, const Agent &_agent);
+
+  /// \brief Remove an actor.
+  /// \param[in] _actor Actor entity.
+  public: void Remove(Entity _actor);
+
+  /// \brief Move all actors, once per step.
+  /// \param[in] _info Update info.
+  /// \param[in] _ecm Entity component manager.
+  public: void Update(const UpdateInfo &_info, EntityComponentManager &_ecm);
+
+  /// \brief Fill the avoidance grid with the current positions of the
+  /// actors.
+  /// \param[in] _ecm Entity component manager.
+  private: void BuildGrid(const EntityComponentManager &_ecm);
+
+  /// \brief Get the direction pushing an actor away from its neighbors.
+  /// \param[in] _actor Actor entity.
+  /// \param[in] _pos Position of the actor.
+  /// \param[in] _radius Avoidance radius of the actor.
+  /// \return Sum of the pushes of all neighbors closer than _radius, each
+  /// stronger the closer the neighbor is, up to unit length.
+  private: math::Vector3d Avoidance(Entity _actor,
+      const math::Vector3d &_pos, double _radius) const;
+
+  /// \brief Key of the grid cell holding a position.
+  /// \param[in] _x Cell column.
+  /// \param[in] _y Cell row.
+  /// \return Key into grid.
+  private: static int64_t CellKey(int64_t _x, int64_t _y);
+
+  /// \brief Actors keyed by entity.
+  private: std::unordered_map<Entity, Agent> agents;
+
+  /// \brief Protects agents and the update bookkeeping.
+  private: std::mutex mutex;
+
+  /// \brief Iteration of the last update, to only update once per step.
+  private: uint64_t lastIterations{std::numeric_limits<uint64_t>::max()};
+
+  /// \brief Time of the last update.
+  private: std::chrono::steady_clock::duration lastUpdate{0};
+
+  /// \brief Size of the avoidance grid cells, the largest avoidance
+  /// radius. Zero if no actor avoids others.
+  private: double cellSize{0.0};
+
+  /// \brief Actors and their positions at the start of the update,
+  /// bucketed by grid cell.
+  private: std::unordered_map<int64_t,
+      std::vector<std::pair<Entity, math::Vector3d>>> grid;
+
+  /// \brief Position of each target at the start of the update.
+  private: std::unordered_map<Entity, math::Vector3d> targetPositions;
+};
+
 /// \brief Private FollowActor data class.
 class ignition::gazebo::systems::FollowActorPrivate
 {
   /// \brief Entity for the actor.
   public: Entity actorEntity{kNullEntity};
 
-  /// \brief Velocity of the actor
-  public: double velocity{0.8};
+  /// \brief Crowd the actor belongs to, null until configured.
+  public: std::shared_ptr<FollowActorCrowd> crowd;
+};
+
+//////////////////////////////////////////////////
+std::shared_ptr<FollowActorCrowd> FollowActorCrowd::For(
+    const EntityComponentManager &_ecm)
+{
+  static std::mutex mutex;
+  static std::unordered_map<const EntityComponentManager *,
+      std::weak_ptr<FollowActorCrowd>> crowds;
+
+  std::lock_guard<std::mutex> lock(mutex);
 
-  /// \brief Current target to follow
-  public: Entity targetEntity{kNullEntity};
+  // Forget crowds which are no longer used
+  for (auto it = crowds.begin(); it != crowds.end();)
+  {
+    if (it->second.expired())
+      it = crowds.erase(it);
+    else
+      ++it;
+  }
 
-  /// \brief Minimum distance in meters to keep away from target.
-  public: double minDistance{1.2};
+  auto &weak = crowds[&_ecm];
+  auto crowd = weak.lock();
+  if (!crowd)
+  {
+    crowd = std::make_shared<FollowActorCrowd>();
+    weak = crowd;
+  }
+  return crowd;
+}
 
-  /// \brief Maximum distance in meters to keep away from target.
-  public: double maxDistance{4};
+//////////////////////////////////////////////////
+void FollowActorCrowd::Add(Entity _actor, const Agent &_agent)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->agents[_actor] = _agent;
+}
 
-  /// \brief Velocity of the animation dislocation on the X axis, in m/s.
-  /// Used to coordinate translational motion with the actor's feet.
-  /// TODO(louise) Automatically calculate it from the root node's first and
-  /// last keyframes
-  public: double animationXVel{2.0};
+//////////////////////////////////////////////////
+void FollowActorCrowd::Remove(Entity _actor)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->agents.erase(_actor);
+}
 
-  /// \brief Time of the last update.
-  public: std::chrono::steady_clock::duration lastUpdate{0};
+//////////////////////////////////////////////////
+int64_t FollowActorCrowd::CellKey(int64_t _x, int64_t _y)
+{
+  return static_cast<int64_t>((static_cast<uint64_t>(_x) << 32) ^
+      (static_cast<uint64_t>(_y) & 0xffffffffu));
+}
 
-  /// \brief True if currently following
-  public: bool following{true};
-};
+//////////////////////////////////////////////////
+void FollowActorCrowd::BuildGrid(const EntityComponentManager &_ecm)
+{
+  this->cellSize = 0.0;
+  for (const auto &agent : this->agents)
+    this->cellSize = std::max(this->cellSize, agent.second.avoidanceRadius);
+
+  // Keep the buckets, they're reused from step to step
+  for (auto &cell : this->grid)
+    cell.second.clear();
+
+  if (this->cellSize <= 0.0)
+    return;
+
+  for (const auto &agent : this->agents)
+  {
+    auto trajPoseComp = _ecm.Component<components::TrajectoryPose>(
+        agent.first);
+    if (nullptr == trajPoseComp)
+      continue;
+
+    const auto &pos = trajPoseComp->Data().Pos();
+    auto x = static_cast<int64_t>(std::floor(pos.X() / this->cellSize));
+    auto y = static_cast<int64_t>(std::floor(pos.Y() / this->cellSize));
+    this->grid[CellKey(x, y)].emplace_back(agent.first, pos);
+  }
+}
+
+//////////////////////////////////////////////////
+math::Vector3d FollowActorCrowd::Avoidance(Entity _actor,
+    const math::Vector3d &_pos, double _radius) const
+{
+  math::Vector3d push;
+  auto x = static_cast<int64_t>(std::floor(_pos.X() / this->cellSize));
+  auto y = static_cast<int64_t>(std::floor(_pos.Y() / this->cellSize));
+
+  // The radius is at most the cell size, so neighbors are in the
+  // surrounding cells
+  for (int64_t dx = -1; dx <= 1; ++dx)
+  {
+    for (int64_t dy = -1; dy <= 1; ++dy)
+    {
+      auto cell = this->grid.find(CellKey(x + dx, y + dy));
+      if (cell == this->grid.end())
+        continue;
+
+      for (const auto &neighbor : cell->second)
+      {
+        if (neighbor.first == _actor)
+          continue;
+
+        math::Vector3d away = _pos - neighbor.second;
+        away.Z(0);
+        double distance = away.Length();
+        if (distance >= _radius || distance <= 0.0)
+          continue;
+
+        push += away / distance * ((_radius - distance) / _radius);
+      }
+    }
+  }
+
+  if (push.Length() > 1.0)
+    push.Normalize();
+  return push;
+}
+
+//////////////////////////////////////////////////
+void FollowActorCrowd::Update(const UpdateInfo &_info,
+    EntityComponentManager &_ecm)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (_info.iterations == this->lastIterations)
+    return;
+  this->lastIterations = _info.iterations;
+
+  IGN_PROFILE("FollowActorCrowd::Update");
+
+  // Time delta
+  std::chrono::duration<double> dtDuration = _info.simTime -
+      this->lastUpdate;
+  double dt = dtDuration.count();
+
+  this->lastUpdate = _info.simTime;
+
+  // Look up each target once, however many actors follow it
+  this->targetPositions.clear();
+  for (const auto &agent : this->agents)
+  {
+    Entity target = agent.second.target;
+    if (this->targetPositions.count(target) != 0)
+      continue;
+    auto targetPoseComp = _ecm.Component<components::Pose>(target);
+    if (nullptr != targetPoseComp)
+      this->targetPositions[target] = targetPoseComp->Data().Pos();
+  }
+
+  this->BuildGrid(_ecm);
+
+  // Each actor is visited by a single thread, which only writes to that
+  // actor's components and agent. Logging and change tracking are left for
+  // afterwards.
+  _ecm.EachParallel<components::TrajectoryPose, components::AnimationTime>(
+      [&](const Entity &_entity,
+          components::TrajectoryPose *_trajPose,
+          components::AnimationTime *_animTime) -> bool
+      {
+        auto agentIt = this->agents.find(_entity);
+        if (agentIt == this->agents.end())
+          return true;
+        Agent &agent = agentIt->second;
+        agent.moved = false;
+        agent.followingChanged = false;
+
+        auto targetIt = this->targetPositions.find(agent.target);
+        if (targetIt == this->targetPositions.end())
+          return true;
+
+        // Current world pose
+        auto actorPose = _trajPose->Data();
+        auto initialPose = actorPose;
+
+        // Direction to target
+        auto dir = targetIt->second - actorPose.Pos();
+        dir.Z(0);
+
+        // Stop if too close to target
+        if (dir.Length() <= agent.minDistance)
+          return true;
+
+        // Stop following if too far from target
+        if (dir.Length() > agent.maxDistance)
+        {
+          if (agent.following)
+          {
+            agent.following = false;
+            agent.followingChanged = true;
+          }
+          return true;
+        }
+        if (!agent.following)
+        {
+          agent.following = true;
+          agent.followingChanged = true;
+        }
+
+        dir.Normalize();
+
+        // Steer away from neighbors
+        if (agent.avoidanceRadius > 0.0 && this->cellSize > 0.0)
+        {
+          auto steered = dir + this->Avoidance(_entity, actorPose.Pos(),
+              agent.avoidanceRadius);
+          steered.Z(0);
+          if (steered.Length() > 1e-6)
+            dir = steered.Normalized();
+        }
+
+        // Towards target
+        math::Angle yaw = atan2(dir.Y(), dir.X());
+        yaw.Normalize();
+
+        actorPose.Pos() += dir * agent.velocity * dt;
+        actorPose.Pos().Z(0);
+        actorPose.Rot() = math::Quaterniond(0, 0, yaw.Radian());
+
+        // Distance traveled is used to coordinate motion with the walking
+        // animation
+        double distanceTraveled =
+            (actorPose.Pos() - initialPose.Pos()).Length();
+
+        // Update actor root pose
+        *_trajPose = components::TrajectoryPose(actorPose);
+
+        // Update actor bone trajectories based on animation time
+        auto animTime = _animTime->Data() +
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(distanceTraveled *
+          agent.animationXVel));
+        *_animTime = components::AnimationTime(animTime);
+
+        agent.moved = true;
+        return true;
+      });
+
+  for (auto &agent : this->agents)
+  {
+    if (agent.second.followingChanged)
+    {
+      if (agent.second.following)
+      {
+        ignmsg << "Target [" << agent.second.target
+               <<  "] within range, actor [" << agent.first
+               <<"] started following" << std::endl;
+      }
+      else
+      {
+        ignmsg << "Target [" << agent.second.target
+               <<  "] too far, actor [" << agent.first
+               <<"] stopped following" << std::endl;
+      }
+      agent.second.followingChanged = false;
+    }
+
+    if (!agent.second.moved)
+      continue;
+    agent.second.moved = false;
+
+    // Mark as a one-time-change so that the change is propagated to the GUI
+    _ecm.SetChanged(agent.first,
+        components::TrajectoryPose::typeId, ComponentState::OneTimeChange);
+    _ecm.SetChanged(agent.first,
+        components::AnimationTime::typeId, ComponentState::OneTimeChange);
+  }
+}
 
 //////////////////////////////////////////////////
 FollowActor::FollowActor() :
@@ -71,7 +430,11 @@ FollowActor::FollowActor() :
 }
 
 //////////////////////////////////////////////////
-FollowActor::~FollowActor() = default;
+FollowActor::~FollowActor()
+{
+  if (this->dataPtr->crowd)
+    this->dataPtr->crowd->Remove(this->dataPtr->actorEntity);
+}
 
 //////////////////////////////////////////////////
 void FollowActor::Configure(const Entity &_entity,
@@ -94,10 +457,10 @@ void FollowActor::Configure(const Entity &_entity,
     return;
   }
 
+  FollowActorCrowd::Agent agent;
   auto targetName = _sdf->Get<std::string>("target");
-  this->dataPtr->targetEntity = _ecm.EntityByComponents(components::Name(
-      targetName));
-  if (kNullEntity == this->dataPtr->targetEntity)
+  agent.target = _ecm.EntityByComponents(components::Name(targetName));
+  if (kNullEntity == agent.target)
   {
     ignerr << "Failed to find target entity [" << targetName << "]"
            << std::endl;
@@ -105,16 +468,19 @@ void FollowActor::Configure(const Entity &_entity,
   }
 
   if (_sdf->HasElement("velocity"))
-    this->dataPtr->velocity = _sdf->Get<double>("velocity");
+    agent.velocity = _sdf->Get<double>("velocity");
 
   if (_sdf->HasElement("min_distance"))
-    this->dataPtr->minDistance = _sdf->Get<double>("min_distance");
+    agent.minDistance = _sdf->Get<double>("min_distance");
 
   if (_sdf->HasElement("max_distance"))
-    this->dataPtr->maxDistance = _sdf->Get<double>("max_distance");
+    agent.maxDistance = _sdf->Get<double>("max_distance");
 
   if (_sdf->HasElement("animation_x_vel"))
-    this->dataPtr->animationXVel = _sdf->Get<double>("animation_x_vel");
+    agent.animationXVel = _sdf->Get<double>("animation_x_vel");
+
+  if (_sdf->HasElement("avoidance_radius"))
+    agent.avoidanceRadius = _sdf->Get<double>("avoidance_radius");
 
   std::string animationName;
 
@@ -188,6 +554,9 @@ void FollowActor::Configure(const Entity &_entity,
     initialPose.Pos().Z(0);
     _ecm.CreateComponent(_entity, components::TrajectoryPose(initialPose));
   }
+
+  this->dataPtr->crowd = FollowActorCrowd::For(_ecm);
+  this->dataPtr->crowd->Add(_entity, agent);
 }
 
 //////////////////////////////////////////////////
@@ -201,89 +570,11 @@ void FollowActor::PreUpdate(const UpdateInfo &_info,
 
   // TODO(louise) Throttle this system
 
-  // Time delta
-  std::chrono::duration<double> dtDuration = _info.simTime -
-      this->dataPtr->lastUpdate;
-  double dt = dtDuration.count();
-
-  this->dataPtr->lastUpdate = _info.simTime;
-
   // Is there a follow target?
-  if (this->dataPtr->targetEntity == kNullEntity)
+  if (!this->dataPtr->crowd)
     return;
 
-  // Current world pose
-  auto trajPoseComp = _ecm.Component<components::TrajectoryPose>(
-      this->dataPtr->actorEntity);
-  auto actorPose = trajPoseComp->Data();
-  auto initialPose = actorPose;
-
-  // Current target
-  auto targetPose = _ecm.Component<components::Pose>(
-      this->dataPtr->targetEntity)->Data();
-
-  // Direction to target
-  auto dir = targetPose.Pos() - actorPose.Pos();
-  dir.Z(0);
-
-  // Stop if too close to target
-  if (dir.Length() <= this->dataPtr->minDistance)
-  {
-    return;
-  }
-
-  // Stop following if too far from target
-  if (dir.Length() > this->dataPtr->maxDistance)
-  {
-    if (this->dataPtr->following)
-    {
-      ignmsg << "Target [" << this->dataPtr->targetEntity
-             <<  "] too far, actor [" << this->dataPtr->actorEntity
-             <<"] stopped following" << std::endl;
-      this->dataPtr->following = false;
-    }
-    return;
-  }
-  if (!this->dataPtr->following)
-  {
-    ignmsg << "Target [" << this->dataPtr->targetEntity
-           <<  "] within range, actor [" << this->dataPtr->actorEntity
-           <<"] started following" << std::endl;
-    this->dataPtr->following = true;
-  }
-
-  dir.Normalize();
-
-  // Towards target
-  math::Angle yaw = atan2(dir.Y(), dir.X());
-  yaw.Normalize();
-
-  actorPose.Pos() += dir * this->dataPtr->velocity * dt;
-  actorPose.Pos().Z(0);
-  actorPose.Rot() = math::Quaterniond(0, 0, yaw.Radian());
-
-  // Distance traveled is used to coordinate motion with the walking
-  // animation
-  double distanceTraveled = (actorPose.Pos() - initialPose.Pos()).Length();
-
-  // Update actor root pose
-  *trajPoseComp = components::TrajectoryPose(actorPose);
-  // Mark as a one-time-change so that the change is propagated to the GUI
-  _ecm.SetChanged(this->dataPtr->actorEntity,
-      components::TrajectoryPose::typeId, ComponentState::OneTimeChange);
-
-  // Update actor bone trajectories based on animation time
-  auto animTimeComp = _ecm.Component<components::AnimationTime>(
-      this->dataPtr->actorEntity);
-
-  auto animTime = animTimeComp->Data() +
-    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
-    std::chrono::duration<double>(distanceTraveled *
-    this->dataPtr->animationXVel));
-  *animTimeComp = components::AnimationTime(animTime);
-  // Mark as a one-time-change so that the change is propagated to the GUI
-  _ecm.SetChanged(this->dataPtr->actorEntity,
-      components::AnimationTime::typeId, ComponentState::OneTimeChange);
+  this->dataPtr->crowd->Update(_info, _ecm);
 }
 
 IGNITION_ADD_PLUGIN(FollowActor, System,
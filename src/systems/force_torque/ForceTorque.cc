@@ -44,6 +44,7 @@
 #include "ignition/gazebo/components/Sensor.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/SensorScheduler.hh"
 #include "ignition/gazebo/Util.hh"
 
 using namespace ignition;
@@ -57,6 +58,9 @@ class ignition::gazebo::systems::ForceTorquePrivate
   public: std::unordered_map<Entity,
       std::unique_ptr<ignition::sensors::ForceTorqueSensor>> entitySensorMap;
 
+  /// \brief Wakes the sensors when they're due
+  public: SensorScheduler scheduler;
+
   /// \brief A struct to hold the joint and link entities associated with a
   /// sensor
   public: struct SensorJointAndLinks
@@ -132,30 +136,11 @@ void ForceTorque::PostUpdate(const UpdateInfo &_info,
   // Only update and publish if not paused.
   if (!_info.paused)
   {
-    // check to see if update is necessary
-    // we only update if there is at least one sensor that needs data
-    // and that sensor has subscribers.
-    // note: ign-sensors does its own throttling. Here the check is mainly
-    // to avoid doing work in the ForceTorquePrivate::Update function
-    bool needsUpdate = false;
-    for (auto &it : this->dataPtr->entitySensorMap)
-    {
-      if (it.second->NextDataUpdateTime() <= _info.simTime &&
-          it.second->HasConnections())
-      {
-        needsUpdate = true;
-        break;
-      }
-    }
-    if (!needsUpdate)
-      return;
-
-    this->dataPtr->Update(_ecm);
-
-    for (auto &it : this->dataPtr->entitySensorMap)
-    {
-      it.second.get()->sensors::Sensor::Update(_info.simTime, false);
-    }
+    this->dataPtr->scheduler.UpdateDue<sensors::Sensor>(_info.simTime,
+        this->dataPtr->entitySensorMap, [&]
+        {
+          this->dataPtr->Update(_ecm);
+        });
   }
 
   this->dataPtr->RemoveForceTorqueEntities(_ecm);
@@ -261,6 +246,8 @@ void ForceTorquePrivate::CreateForceTorqueEntities(EntityComponentManager &_ecm)
 
         auto sensorIt = this->entitySensorMap.insert(
             std::make_pair(_entity, std::move(sensor))).first;
+        this->scheduler.Schedule(_entity,
+            std::chrono::steady_clock::duration::zero());
 
         const auto X_WC = worldPose(jointChildLinkEntity, _ecm);
         const auto X_CJ = _ecm.Component<components::Pose>(jointEntity)->Data();
@@ -357,6 +344,7 @@ void ForceTorquePrivate::RemoveForceTorqueEntities(
         }
 
         this->entitySensorMap.erase(sensorId);
+        this->scheduler.Remove(_entity);
 
         return true;
       });
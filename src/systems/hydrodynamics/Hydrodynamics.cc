@@ -14,18 +14,24 @@
  * limitations under the License.
  *
  */
+#include <array>
 #include <string>
+#include <vector>
 
 #include <Eigen/Eigen>
 
+#include <ignition/common/Profiler.hh>
 #include <ignition/plugin/Register.hh>
 
 #include "ignition/msgs/vector3d.pb.h"
 
 #include "ignition/gazebo/components/AngularVelocity.hh"
 #include "ignition/gazebo/components/LinearVelocity.hh"
+#include "ignition/gazebo/components/Link.hh"
+#include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/World.hh"
+#include "ignition/gazebo/EnvironmentalForces.hh"
 #include "ignition/gazebo/Link.hh"
 #include "ignition/gazebo/Model.hh"
 #include "ignition/gazebo/System.hh"
@@ -85,59 +91,84 @@ class ignition::gazebo::systems::HydrodynamicsPrivateData
   /// \brief Ocean current callback
   public: void UpdateCurrent(const msgs::Vector3d &_msg);
 
+  /// \brief Compute the hydrodynamic wrench and add it to the link's wrench
+  /// \param[in] _info Current simulation information
+  /// \param[in] _links Kinematics and wrenches of the links
+  public: void Update(const UpdateInfo &_info, LinkKinematics &_links);
+
+  /// \brief Compute the hydrodynamic wrenches of all vehicles at once and
+  /// add them to the links' wrenches. Used in world mode.
+  /// \param[in] _info Current simulation information
+  /// \param[in] _links Kinematics and wrenches of the links
+  public: void UpdateBatch(const UpdateInfo &_info, LinkKinematics &_links);
+
+  /// \brief Add a vehicle in world mode.
+  /// \param[in] _ecm Mutable reference to the EntityComponentManager
+  /// \param[in] _link Link of the vehicle
+  public: void AddVehicle(EntityComponentManager &_ecm, Entity _link);
+
+  /// \brief True if the plugin is attached to the world and acts on all
+  /// vehicles.
+  public: bool worldMode{false};
+
+  /// \brief Name of the links subject to hydrodynamic forces in world mode.
+  public: std::string linkName;
+
+  /// \brief State of all vehicles in world mode, as structure of arrays so
+  /// that each term is evaluated over all vehicles in one loop. The arrays
+  /// of a degree of freedom are indexed by vehicle.
+  public: struct Vehicles
+  {
+    /// \brief Slots of the vehicle links in the stage's batch.
+    std::vector<std::size_t> slots;
+
+    /// \brief Body frame velocities [u, v, w, p, q, r].
+    std::array<std::vector<double>, 6> state;
+
+    /// \brief Velocities on the previous step.
+    std::array<std::vector<double>, 6> prevState;
+
+    /// \brief Accelerations.
+    std::array<std::vector<double>, 6> stateDot;
+
+    /// \brief Hydrodynamic wrench in the body frame.
+    std::array<std::vector<double>, 6> wrench;
+
+    /// \brief Damping coefficients of one matrix entry.
+    std::vector<double> coeff;
+  };
+
+  /// \brief Vehicles in world mode.
+  public: Vehicles vehicles;
+
+  /// \brief Destructor
+  public: ~HydrodynamicsPrivateData();
+
   /// \brief Mutex
   public: std::mutex mtx;
-};
 
-/////////////////////////////////////////////////
-void HydrodynamicsPrivateData::UpdateCurrent(const msgs::Vector3d &_msg)
-{
-  std::lock_guard<std::mutex> lock(this->mtx);
-  this->currentVector = ignition::msgs::Convert(_msg);
-}
+  /// \brief Stage which gathers the link kinematics and applies the wrench
+  public: std::shared_ptr<EnvironmentalForces> forces;
 
-/////////////////////////////////////////////////
-void AddAngularVelocityComponent(
-  const ignition::gazebo::Entity &_entity,
-  ignition::gazebo::EntityComponentManager &_ecm)
-{
-  if (!_ecm.Component<ignition::gazebo::components::AngularVelocity>(_entity))
-  {
-    _ecm.CreateComponent(_entity,
-      ignition::gazebo::components::AngularVelocity());
-  }
+  /// \brief Hydrodynamics model registered to the stage
+  public: EnvironmentalForces::ModelId forceModel{0};
 
-  // Create an angular velocity component if one is not present.
-  if (!_ecm.Component<ignition::gazebo::components::WorldAngularVelocity>(
-      _entity))
-  {
-    _ecm.CreateComponent(_entity,
-      ignition::gazebo::components::WorldAngularVelocity());
-  }
-}
+  /// \brief Slot of linkEntity in the stage's batch
+  public: std::size_t linkSlot{0};
+};
 
 /////////////////////////////////////////////////
-void AddWorldPose(
-  const ignition::gazebo::Entity &_entity,
-  ignition::gazebo::EntityComponentManager &_ecm)
+HydrodynamicsPrivateData::~HydrodynamicsPrivateData()
 {
-  if (!_ecm.Component<ignition::gazebo::components::WorldPose>(_entity))
-  {
-    _ecm.CreateComponent(_entity, ignition::gazebo::components::WorldPose());
-  }
+  if (this->forces)
+    this->forces->RemoveModel(this->forceModel);
 }
 
 /////////////////////////////////////////////////
-void AddWorldLinearVelocity(
-  const ignition::gazebo::Entity &_entity,
-  ignition::gazebo::EntityComponentManager &_ecm)
+void HydrodynamicsPrivateData::UpdateCurrent(const msgs::Vector3d &_msg)
 {
-  if (!_ecm.Component<ignition::gazebo::components::WorldLinearVelocity>(
-      _entity))
-  {
-    _ecm.CreateComponent(_entity,
-      ignition::gazebo::components::WorldLinearVelocity());
-  }
+  std::lock_guard<std::mutex> lock(this->mtx);
+  this->currentVector = ignition::msgs::Convert(_msg);
 }
 
 /////////////////////////////////////////////////
@@ -265,23 +296,46 @@ void Hydrodynamics::Configure(
     return;
   }
   auto linkName = _sdf->Get<std::string>("link_name");
-  this->dataPtr->linkEntity = model.LinkByName(_ecm, linkName);
-  if (!_ecm.HasEntity(this->dataPtr->linkEntity))
+
+  if(_sdf->HasElement("default_current"))
   {
-    ignerr << "Link name" << linkName << "does not exist";
+    this->dataPtr->currentVector = _sdf->Get<math::Vector3d>("default_current");
+  }
+
+  // Attached to the world, act on all vehicles, which are added as their
+  // links are created
+  if (_ecm.Component<components::World>(_entity))
+  {
+    this->dataPtr->worldMode = true;
+    this->dataPtr->linkName = linkName;
+    this->dataPtr->forces = EnvironmentalForces::For(_ecm);
+    this->dataPtr->forceModel = this->dataPtr->forces->AddModel(
+        [this](const UpdateInfo &_info, const EntityComponentManager &,
+               LinkKinematics &_links)
+        {
+          this->dataPtr->UpdateBatch(_info, _links);
+        });
     return;
   }
 
-  if(_sdf->HasElement("default_current"))
+  this->dataPtr->linkEntity = model.LinkByName(_ecm, linkName);
+  if (!_ecm.HasEntity(this->dataPtr->linkEntity))
   {
-    this->dataPtr->currentVector = _sdf->Get<math::Vector3d>("default_current");
+    ignerr << "Link name" << linkName << "does not exist";
+    return;
   }
 
   this->dataPtr->prevState = Eigen::VectorXd::Zero(6);
 
-  AddWorldPose(this->dataPtr->linkEntity, _ecm);
-  AddAngularVelocityComponent(this->dataPtr->linkEntity, _ecm);
-  AddWorldLinearVelocity(this->dataPtr->linkEntity, _ecm);
+  this->dataPtr->forces = EnvironmentalForces::For(_ecm);
+  this->dataPtr->linkSlot =
+      this->dataPtr->forces->AddLink(_ecm, this->dataPtr->linkEntity);
+  this->dataPtr->forceModel = this->dataPtr->forces->AddModel(
+      [this](const UpdateInfo &_info, const EntityComponentManager &,
+             LinkKinematics &_links)
+      {
+        this->dataPtr->Update(_info, _links);
+      }, _entity);
 }
 
 /////////////////////////////////////////////////
@@ -289,7 +343,213 @@ void Hydrodynamics::PreUpdate(
       const ignition::gazebo::UpdateInfo &_info,
       ignition::gazebo::EntityComponentManager &_ecm)
 {
-  if (_info.paused)
+  if (this->dataPtr->worldMode)
+  {
+    _ecm.EachNew<components::Link, components::Name>(
+        [&](const Entity &_entity, const components::Link *,
+            const components::Name *_name) -> bool
+        {
+          if (_name->Data() == this->dataPtr->linkName)
+            this->dataPtr->AddVehicle(_ecm, _entity);
+          return true;
+        });
+  }
+
+  if (_info.paused || !this->dataPtr->forces)
+    return;
+
+  this->dataPtr->forces->Update(_info, _ecm, this->dataPtr->forceModel);
+}
+
+/////////////////////////////////////////////////
+void HydrodynamicsPrivateData::AddVehicle(EntityComponentManager &_ecm,
+    Entity _link)
+{
+  this->vehicles.slots.push_back(this->forces->AddLink(_ecm, _link));
+  for (int d = 0; d < 6; ++d)
+  {
+    this->vehicles.state[d].push_back(0.0);
+    this->vehicles.prevState[d].push_back(0.0);
+    this->vehicles.stateDot[d].push_back(0.0);
+    this->vehicles.wrench[d].push_back(0.0);
+  }
+  this->vehicles.coeff.push_back(0.0);
+}
+
+/////////////////////////////////////////////////
+void HydrodynamicsPrivateData::UpdateBatch(const UpdateInfo &_info,
+    LinkKinematics &_links)
+{
+  IGN_PROFILE("HydrodynamicsPrivateData::UpdateBatch");
+  auto &v = this->vehicles;
+  const std::size_t n = v.slots.size();
+  if (n == 0)
+    return;
+
+  math::Vector3d currentVector;
+  {
+    std::lock_guard lock(this->mtx);
+    currentVector = this->currentVector;
+  }
+
+  // Transform the states to the local frames, see Update
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const auto slot = v.slots[i];
+    if (!_links.valid[slot])
+    {
+      for (int d = 0; d < 6; ++d)
+        v.state[d][i] = 0.0;
+      continue;
+    }
+
+    const auto rotInv = _links.worldPoses[slot].Rot().Inverse();
+    const auto localLinearVelocity =
+        rotInv * (_links.linearVelocities[slot] - currentVector);
+    const auto localRotationalVelocity =
+        rotInv * _links.angularVelocities[slot];
+    v.state[0][i] = localLinearVelocity.X();
+    v.state[1][i] = localLinearVelocity.Y();
+    v.state[2][i] = localLinearVelocity.Z();
+    v.state[3][i] = localRotationalVelocity.X();
+    v.state[4][i] = localRotationalVelocity.Y();
+    v.state[5][i] = localRotationalVelocity.Z();
+  }
+
+  // The loops below run over vehicles, on contiguous arrays, so that the
+  // compiler vectorizes them.
+  const double dt = static_cast<double>(_info.dt.count())/1e9;
+  for (int d = 0; d < 6; ++d)
+  {
+    const double *s = v.state[d].data();
+    double *prev = v.prevState[d].data();
+    double *sDot = v.stateDot[d].data();
+    double *w = v.wrench[d].data();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      sDot[i] = (s[i] - prev[i]) / dt;
+      prev[i] = s[i];
+      w[i] = 0.0;
+    }
+  }
+
+  // Damping forces. Most derivatives are zero, so their terms are skipped.
+  double *coeff = v.coeff.data();
+  for (int r = 0; r < 6; ++r)
+  {
+    double *w = v.wrench[r].data();
+    for (int c = 0; c < 6; ++c)
+    {
+      const double linearTerm = this->stabilityLinearTerms[r * 6 + c];
+      bool nonZero = linearTerm != 0.0;
+      for (int k = 0; k < 6 && !nonZero; ++k)
+      {
+        const auto index = r * 36 + c * 6 + k;
+        nonZero = this->stabilityQuadraticAbsDerivative[index] != 0.0 ||
+            this->stabilityQuadraticDerivative[index] != 0.0;
+      }
+      if (!nonZero)
+        continue;
+
+      for (std::size_t i = 0; i < n; ++i)
+        coeff[i] = -linearTerm;
+
+      for (int k = 0; k < 6; ++k)
+      {
+        const auto index = r * 36 + c * 6 + k;
+        const double absTerm = this->stabilityQuadraticAbsDerivative[index];
+        const double velTerm = this->stabilityQuadraticDerivative[index];
+        if (absTerm == 0.0 && velTerm == 0.0)
+          continue;
+
+        const double *s = v.state[k].data();
+        for (std::size_t i = 0; i < n; ++i)
+          coeff[i] -= absTerm * std::abs(s[i]) + velTerm * s[i];
+      }
+
+      const double *s = v.state[c].data();
+      for (std::size_t i = 0; i < n; ++i)
+        w[i] += coeff[i] * s[i];
+    }
+  }
+
+  // The added mass
+  // Negative sign signifies the behaviour change
+  if (!this->disableAddedMass)
+  {
+    for (int r = 0; r < 6; ++r)
+    {
+      double *w = v.wrench[r].data();
+      for (int c = 0; c < 6; ++c)
+      {
+        const double ma = this->Ma(r, c);
+        if (ma == 0.0)
+          continue;
+
+        const double *sDot = v.stateDot[c].data();
+        for (std::size_t i = 0; i < n; ++i)
+          w[i] -= ma * sDot[i];
+      }
+    }
+  }
+
+  // Coriolis and Centripetal forces, -Cmat * state with the same diagonal
+  // terms as Update
+  if (!this->disableCoriolis)
+  {
+    const double ma0 = this->Ma(0, 0);
+    const double ma1 = this->Ma(1, 1);
+    const double ma2 = this->Ma(2, 2);
+    const double ma3 = this->Ma(3, 3);
+    const double ma4 = this->Ma(4, 4);
+    const double ma5 = this->Ma(5, 5);
+    const double *s0 = v.state[0].data();
+    const double *s1 = v.state[1].data();
+    const double *s2 = v.state[2].data();
+    const double *s3 = v.state[3].data();
+    const double *s4 = v.state[4].data();
+    const double *s5 = v.state[5].data();
+    double *w0 = v.wrench[0].data();
+    double *w1 = v.wrench[1].data();
+    double *w2 = v.wrench[2].data();
+    double *w3 = v.wrench[3].data();
+    double *w4 = v.wrench[4].data();
+    double *w5 = v.wrench[5].data();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      w0[i] -= (-ma2 * s2[i]) * s4[i] + (-ma1 * s1[i]) * s5[i];
+      w1[i] -= (ma2 * s2[i]) * s3[i] + (-ma0 * s0[i]) * s5[i];
+      w2[i] -= (-ma1 * s1[i]) * s3[i] + (ma0 * s0[i]) * s4[i];
+      w3[i] -= (-ma2 * s2[i]) * s1[i] + (ma1 * s1[i]) * s2[i] +
+               (-ma5 * s5[i]) * s4[i] + (ma4 * s4[i]) * s5[i];
+      w4[i] -= (ma2 * s2[i]) * s0[i] + (-ma0 * s0[i]) * s2[i] +
+               (ma5 * s5[i]) * s3[i] + (-ma3 * s3[i]) * s5[i];
+      w5[i] -= (ma2 * s2[i]) * s0[i] + (ma0 * s0[i]) * s1[i] +
+               (-ma4 * s4[i]) * s3[i] + (ma3 * s3[i]) * s4[i];
+    }
+  }
+
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const auto slot = v.slots[i];
+    if (!_links.valid[slot])
+      continue;
+
+    math::Vector3d totalForce(
+      -v.wrench[0][i], -v.wrench[1][i], -v.wrench[2][i]);
+    math::Vector3d totalTorque(
+      -v.wrench[3][i], -v.wrench[4][i], -v.wrench[5][i]);
+
+    const auto &rot = _links.worldPoses[slot].Rot();
+    _links.AddWorldWrench(slot, rot * totalForce, rot * totalTorque);
+  }
+}
+
+/////////////////////////////////////////////////
+void HydrodynamicsPrivateData::Update(const UpdateInfo &_info,
+    LinkKinematics &_links)
+{
+  if (!_links.valid[this->linkSlot])
     return;
 
   // These variables follow Fossen's scheme in "Guidance and Control
@@ -305,30 +565,22 @@ void Hydrodynamics::PreUpdate(
   Eigen::MatrixXd Dmat     = Eigen::MatrixXd::Zero(6, 6);
 
   // Get vehicle state
-  ignition::gazebo::Link baseLink(this->dataPtr->linkEntity);
-  auto linearVelocity =
-    _ecm.Component<components::WorldLinearVelocity>(this->dataPtr->linkEntity);
-  auto rotationalVelocity = baseLink.WorldAngularVelocity(_ecm);
-
-  if (!linearVelocity)
-  {
-    ignerr << "no linear vel" <<"\n";
-    return;
-  }
+  const auto &linearVelocity = _links.linearVelocities[this->linkSlot];
+  const auto &rotationalVelocity = _links.angularVelocities[this->linkSlot];
 
   // Get current vector
   math::Vector3d currentVector;
   {
-    std::lock_guard lock(this->dataPtr->mtx);
-    currentVector = this->dataPtr->currentVector;
+    std::lock_guard lock(this->mtx);
+    currentVector = this->currentVector;
   }
   // Transform state to local frame
-  auto pose = baseLink.WorldPose(_ecm);
+  const auto &pose = _links.worldPoses[this->linkSlot];
   // Since we are transforming angular and linear velocity we only care about
   // rotation. Also this is where we apply the effects of current to the link
-  auto localLinearVelocity = pose->Rot().Inverse() *
-    (linearVelocity->Data() - currentVector);
-  auto localRotationalVelocity = pose->Rot().Inverse() * *rotationalVelocity;
+  auto localLinearVelocity = pose.Rot().Inverse() *
+    (linearVelocity - currentVector);
+  auto localRotationalVelocity = pose.Rot().Inverse() * rotationalVelocity;
 
   state(0) = localLinearVelocity.X();
   state(1) = localLinearVelocity.Y();
@@ -339,13 +591,13 @@ void Hydrodynamics::PreUpdate(
   state(5) = localRotationalVelocity.Z();
 
   auto dt = static_cast<double>(_info.dt.count())/1e9;
-  stateDot = (state - this->dataPtr->prevState)/dt;
+  stateDot = (state - this->prevState)/dt;
 
-  this->dataPtr->prevState = state;
+  this->prevState = state;
 
   // The added mass
   // Negative sign signifies the behaviour change
-  const Eigen::VectorXd kAmassVec = - this->dataPtr->Ma * stateDot;
+  const Eigen::VectorXd kAmassVec = - this->Ma * stateDot;
 
   // Coriolis and Centripetal forces for under water vehicles (Fossen P. 37)
   // Note: this is significantly different from VRX because we need to account
@@ -353,24 +605,24 @@ void Hydrodynamics::PreUpdate(
   // diagonal terms here. Have yet to add the cross terms here. Also note, since
   // $M_a(0,0) = \dot X_u $ , $M_a(1,1) = \dot Y_v $ and so forth, we simply
   // load the stability derivatives from $M_a$.
-  Cmat(0, 4) = - this->dataPtr->Ma(2, 2) * state(2);
-  Cmat(0, 5) = - this->dataPtr->Ma(1, 1) * state(1);
-  Cmat(1, 3) =   this->dataPtr->Ma(2, 2) * state(2);
-  Cmat(1, 5) = - this->dataPtr->Ma(0, 0) * state(0);
-  Cmat(2, 3) = - this->dataPtr->Ma(1, 1) * state(1);
-  Cmat(2, 4) =   this->dataPtr->Ma(0, 0) * state(0);
-  Cmat(3, 1) = - this->dataPtr->Ma(2, 2) * state(2);
-  Cmat(3, 2) =   this->dataPtr->Ma(1, 1) * state(1);
-  Cmat(3, 4) = - this->dataPtr->Ma(5, 5) * state(5);
-  Cmat(3, 5) =   this->dataPtr->Ma(4, 4) * state(4);
-  Cmat(4, 0) =   this->dataPtr->Ma(2, 2) * state(2);
-  Cmat(4, 2) = - this->dataPtr->Ma(0, 0) * state(0);
-  Cmat(4, 3) =   this->dataPtr->Ma(5, 5) * state(5);
-  Cmat(4, 5) = - this->dataPtr->Ma(3, 3) * state(3);
-  Cmat(5, 0) =   this->dataPtr->Ma(2, 2) * state(2);
-  Cmat(5, 1) =   this->dataPtr->Ma(0, 0) * state(0);
-  Cmat(5, 3) = - this->dataPtr->Ma(4, 4) * state(4);
-  Cmat(5, 4) =   this->dataPtr->Ma(3, 3) * state(3);
+  Cmat(0, 4) = - this->Ma(2, 2) * state(2);
+  Cmat(0, 5) = - this->Ma(1, 1) * state(1);
+  Cmat(1, 3) =   this->Ma(2, 2) * state(2);
+  Cmat(1, 5) = - this->Ma(0, 0) * state(0);
+  Cmat(2, 3) = - this->Ma(1, 1) * state(1);
+  Cmat(2, 4) =   this->Ma(0, 0) * state(0);
+  Cmat(3, 1) = - this->Ma(2, 2) * state(2);
+  Cmat(3, 2) =   this->Ma(1, 1) * state(1);
+  Cmat(3, 4) = - this->Ma(5, 5) * state(5);
+  Cmat(3, 5) =   this->Ma(4, 4) * state(4);
+  Cmat(4, 0) =   this->Ma(2, 2) * state(2);
+  Cmat(4, 2) = - this->Ma(0, 0) * state(0);
+  Cmat(4, 3) =   this->Ma(5, 5) * state(5);
+  Cmat(4, 5) = - this->Ma(3, 3) * state(3);
+  Cmat(5, 0) =   this->Ma(2, 2) * state(2);
+  Cmat(5, 1) =   this->Ma(0, 0) * state(0);
+  Cmat(5, 3) = - this->Ma(4, 4) * state(4);
+  Cmat(5, 4) =   this->Ma(3, 3) * state(3);
   const Eigen::VectorXd kCmatVec = - Cmat * state;
 
   // Damping forces
@@ -378,15 +630,15 @@ void Hydrodynamics::PreUpdate(
   {
     for(int j = 0; j < 6; j++)
     {
-      auto coeff = - this->dataPtr->stabilityLinearTerms[i * 6 + j];
+      auto coeff = - this->stabilityLinearTerms[i * 6 + j];
       for(int k = 0; k < 6; k++)
       {
         auto index = i * 36 + j * 6 + k;
         auto absCoeff =
-          this->dataPtr->stabilityQuadraticAbsDerivative[index] * abs(state(k));
+          this->stabilityQuadraticAbsDerivative[index] * abs(state(k));
         coeff -= absCoeff;
         auto velCoeff =
-          this->dataPtr->stabilityQuadraticDerivative[index] * state(k);
+          this->stabilityQuadraticDerivative[index] * state(k);
         coeff -= velCoeff;
       }
 
@@ -398,11 +650,11 @@ void Hydrodynamics::PreUpdate(
 
   Eigen::VectorXd kTotalWrench = kDvec;
 
-  if (!this->dataPtr->disableAddedMass)
+  if (!this->disableAddedMass)
   {
     kTotalWrench += kAmassVec;
   }
-  if (!this->dataPtr->disableCoriolis)
+  if (!this->disableCoriolis)
   {
     kTotalWrench += kCmatVec;
   }
@@ -412,10 +664,10 @@ void Hydrodynamics::PreUpdate(
   math::Vector3d totalTorque(
     -kTotalWrench(3),  -kTotalWrench(4), -kTotalWrench(5));
 
-  baseLink.AddWorldWrench(
-    _ecm,
-    pose->Rot()*(totalForce),
-    pose->Rot()*totalTorque);
+  _links.AddWorldWrench(
+    this->linkSlot,
+    pose.Rot()*(totalForce),
+    pose.Rot()*totalTorque);
 }
 
 IGNITION_ADD_PLUGIN(
@@ -130,6 +130,13 @@ namespace systems
   /// ```
   /// You should observe your vehicle slowly drift to the side.
   ///
+  /// ## World mode
+  /// When attached to a world instead of a model, a single instance of the
+  /// plugin acts on the link called <link_name> of every model, including
+  /// models spawned later on. All of these vehicles share the same
+  /// parameters and are evaluated together, which scales to thousands of
+  /// vehicles. The ocean current applies to all of them.
+  ///
   /// # Citations
   /// [1] Fossen, Thor I. _Guidance and Control of Ocean Vehicles_.
   ///    United Kingdom: Wiley, 1994.
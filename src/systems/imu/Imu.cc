@@ -42,6 +42,7 @@
 #include "ignition/gazebo/components/Sensor.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/SensorScheduler.hh"
 #include "ignition/gazebo/Util.hh"
 
 using namespace ignition;
@@ -55,6 +56,9 @@ class ignition::gazebo::systems::ImuPrivate
   public: std::unordered_map<Entity,
       std::unique_ptr<sensors::ImuSensor>> entitySensorMap;
 
+  /// \brief Wakes the sensors when they're due
+  public: SensorScheduler scheduler;
+
   /// \brief Ign-sensors sensor factory for creating sensors
   public: sensors::SensorFactory sensorFactory;
 
@@ -145,31 +149,11 @@ void Imu::PostUpdate(const UpdateInfo &_info,
   // Only update and publish if not paused.
   if (!_info.paused)
   {
-    // check to see if update is necessary
-    // we only update if there is at least one sensor that needs data
-    // and that sensor has subscribers.
-    // note: ign-sensors does its own throttling. Here the check is mainly
-    // to avoid doing work in the ImuPrivate::Update function
-    bool needsUpdate = false;
-    for (auto &it : this->dataPtr->entitySensorMap)
-    {
-      if (it.second->NextDataUpdateTime() <= _info.simTime &&
-          it.second->HasConnections())
-      {
-        needsUpdate = true;
-        break;
-      }
-    }
-    if (!needsUpdate)
-      return;
-
-    this->dataPtr->Update(_ecm);
-
-    for (auto &it : this->dataPtr->entitySensorMap)
-    {
-      // Update measurement time
-      it.second.get()->sensors::Sensor::Update(_info.simTime, false);
-    }
+    this->dataPtr->scheduler.UpdateDue<sensors::Sensor>(_info.simTime,
+        this->dataPtr->entitySensorMap, [&]
+        {
+          this->dataPtr->Update(_ecm);
+        });
   }
 
   this->dataPtr->RemoveImuEntities(_ecm);
@@ -256,6 +240,8 @@ void ImuPrivate::AddSensor(
 
   this->entitySensorMap.insert(
       std::make_pair(_entity, std::move(sensor)));
+  this->scheduler.Schedule(_entity,
+      std::chrono::steady_clock::duration::zero());
   this->newSensors.insert(_entity);
 }
 
@@ -353,6 +339,7 @@ void ImuPrivate::RemoveImuEntities(
         }
 
         this->entitySensorMap.erase(sensorId);
+        this->scheduler.Remove(_entity);
 
         return true;
       });
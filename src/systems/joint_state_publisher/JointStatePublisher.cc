@@ -115,25 +115,14 @@ void JointStatePublisher::CreateComponents(EntityComponentManager &_ecm,
 
   this->joints.insert(_joint);
 
-  // Create joint position component if one doesn't exist
-  if (!_ecm.EntityHasComponentType(_joint,
-        components::JointPosition().TypeId()))
-  {
-    _ecm.CreateComponent(_joint, components::JointPosition());
-  }
-
-  // Create joint velocity component if one doesn't exist
-  if (!_ecm.EntityHasComponentType(_joint,
-        components::JointVelocity().TypeId()))
-  {
-    _ecm.CreateComponent(_joint, components::JointVelocity());
-  }
-
-  // Create joint force component if one doesn't exist
-  if (!_ecm.EntityHasComponentType(_joint, components::JointForce().TypeId()))
-  {
-    _ecm.CreateComponent(_joint, components::JointForce());
-  }
+  // Demand the joint state components, which are created if they don't
+  // exist, and removed with this plugin if nobody else needs them
+  this->demands.push_back(
+      _ecm.DemandComponent<components::JointPosition>(_joint));
+  this->demands.push_back(
+      _ecm.DemandComponent<components::JointVelocity>(_joint));
+  this->demands.push_back(
+      _ecm.DemandComponent<components::JointForce>(_joint));
 }
 
 //////////////////////////////////////////////////
@@ -183,48 +172,32 @@ void JointStatePublisher::PostUpdate(const UpdateInfo &_info,
   if (!this->modelPub)
     return;
 
-  // Create the message
-  msgs::Model msg;
-  msg.mutable_header()->mutable_stamp()->CopyFrom(
-      convert<msgs::Time>(_info.simTime));
+  // Names, IDs and axes don't change, so they're only set once
+  if (this->jointMsgs.empty() && !this->joints.empty())
+    this->InitializeMessage(_ecm);
 
-  // Set the name and ID.
-  msg.set_name(this->model.Name(_ecm));
-  msg.set_id(this->model.Entity());
+  this->msg.mutable_header()->mutable_stamp()->CopyFrom(
+      convert<msgs::Time>(_info.simTime));
 
   // Set the model pose
   const auto *pose = _ecm.Component<components::Pose>(
       this->model.Entity());
   if (pose)
-    msgs::Set(msg.mutable_pose(), pose->Data());
+    msgs::Set(this->msg.mutable_pose(), pose->Data());
 
   static bool hasWarned {false};
 
   // Process each joint
+  std::size_t index{0u};
   for (const Entity &joint : this->joints)
   {
-    // Add a joint message.
-    msgs::Joint *jointMsg = msg.add_joint();
-    jointMsg->set_name(_ecm.Component<components::Name>(joint)->Data());
-    jointMsg->set_id(joint);
+    msgs::Joint *jointMsg = this->jointMsgs[index++];
 
     // Set the joint pose
     pose = _ecm.Component<components::Pose>(joint);
     if (pose)
       msgs::Set(jointMsg->mutable_pose(), pose->Data());
 
-    auto child = _ecm.Component<components::ChildLinkName>(joint);
-    if (child)
-    {
-      jointMsg->set_child(child->Data());
-    }
-
-    auto parent = _ecm.Component<components::ParentLinkName>(joint);
-    if (parent)
-    {
-      jointMsg->set_parent(parent->Data());
-    }
-
     // Set the joint position
     const auto *jointPositions  =
       _ecm.Component<components::JointPosition>(joint);
@@ -235,19 +208,6 @@ void JointStatePublisher::PostUpdate(const UpdateInfo &_info,
         if (i == 0)
         {
           jointMsg->mutable_axis1()->set_position(jointPositions->Data()[i]);
-          auto jointAxis = _ecm.Component<components::JointAxis>(joint);
-          if (jointAxis)
-          {
-            msgs::Set(
-              jointMsg->mutable_axis1()->mutable_xyz(),
-              jointAxis->Data().Xyz());
-            jointMsg->mutable_axis1()->set_limit_upper(
-              jointAxis->Data().Upper());
-            jointMsg->mutable_axis1()->set_limit_lower(
-              jointAxis->Data().Lower());
-            jointMsg->mutable_axis1()->set_damping(
-              jointAxis->Data().Damping());
-          }
         }
         else if (i == 1)
         {
@@ -309,13 +269,55 @@ void JointStatePublisher::PostUpdate(const UpdateInfo &_info,
   }
 
   // Publish the message.
-  this->modelPub->Publish(msg);
+  this->modelPub->Publish(this->msg);
 }
 
-IGNITION_ADD_PLUGIN(JointStatePublisher,
-                    System,
-                    JointStatePublisher::ISystemConfigure,
-                    JointStatePublisher::ISystemPostUpdate)
+//////////////////////////////////////////////////
+void JointStatePublisher::InitializeMessage(const EntityComponentManager &_ecm)
+{
+  this->msg.Clear();
+  this->jointMsgs.clear();
+
+  // Set the name and ID.
+  this->msg.set_name(this->model.Name(_ecm));
+  this->msg.set_id(this->model.Entity());
+
+  for (const Entity &joint : this->joints)
+  {
+    // Add a joint message.
+    msgs::Joint *jointMsg = this->msg.add_joint();
+    this->jointMsgs.push_back(jointMsg);
+
+    const auto *name = _ecm.Component<components::Name>(joint);
+    if (name)
+      jointMsg->set_name(name->Data());
+    jointMsg->set_id(joint);
+
+    auto child = _ecm.Component<components::ChildLinkName>(joint);
+    if (child)
+    {
+      jointMsg->set_child(child->Data());
+    }
+
+    auto parent = _ecm.Component<components::ParentLinkName>(joint);
+    if (parent)
+    {
+      jointMsg->set_parent(parent->Data());
+    }
+
+    auto jointAxis = _ecm.Component<components::JointAxis>(joint);
+    if (jointAxis)
+    {
+      msgs::Set(
+        jointMsg->mutable_axis1()->mutable_xyz(),
+        jointAxis->Data().Xyz());
+      jointMsg->mutable_axis1()->set_limit_upper(
+        jointAxis->Data().Upper());
+      jointMsg->mutable_axis1()->set_limit_lower(
+        jointAxis->Data().Lower());
+      jointMsg->mutable_axis1()->set_damping(
+        jointAxis->Data().Damping());
+    }
+  }
+}
 
-IGNITION_ADD_PLUGIN_ALIAS(JointStatePublisher,
-    "ignition::gazebo::systems::JointStatePublisher")
@@ -21,6 +21,8 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
+#include <ignition/msgs/model.pb.h>
 #include <ignition/gazebo/Model.hh>
 #include <ignition/transport/Node.hh>
 #include <ignition/gazebo/System.hh>
@@ -75,6 +77,11 @@ namespace systems
     private: void CreateComponents(EntityComponentManager &_ecm,
                                    gazebo::Entity _joint);
 
+    /// \brief Set the parts of the message which don't change, such as
+    /// names and axes, and keep pointers to the joint messages.
+    /// \param[in] _ecm The EntityComponentManager.
+    private: void InitializeMessage(const EntityComponentManager &_ecm);
+
     /// \brief The model
     private: Model model;
 
@@ -87,8 +94,18 @@ namespace systems
     /// \brief The joints that will be published.
     private: std::set<Entity> joints;
 
+    /// \brief Demands for the state components of the joints.
+    private: std::vector<ComponentDemand> demands;
+
     /// \brief The topic
     private: std::string topic;
+
+    /// \brief Message reused for each publication. Only the time, poses
+    /// and joint states are updated.
+    private: msgs::Model msg;
+
+    /// \brief Joint messages within msg, in the same order as joints.
+    private: std::vector<msgs::Joint *> jointMsgs;
   };
   }
 }
@@ -35,11 +35,14 @@
 #include <ignition/transport/Publisher.hh>
 #include <ignition/transport/TopicUtils.hh>
 
+#include <limits>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "JointTrajectoryController.hh"
+#include "TrajectorySpline.hh"
 
 using namespace ignition;
 using namespace gazebo;
@@ -154,12 +157,9 @@ class ActuatedJoint
               ignition::gazebo::EntityComponentManager &_ecm) const;
 
   /// \brief Set target of the joint that the controller will attempt to reach
-  /// \param[in] _targetPoint Targets of all controlled joint
-  /// \param[in] _jointIndex Index of the joint, used to determine what index
-  /// of `_targetPoint` to use
-  public: void SetTarget(
-              const ignition::msgs::JointTrajectoryPoint &_targetPoint,
-              const size_t &_jointIndex);
+  /// \param[in] _sample Targets of the joint, of which only the ones defined
+  /// by the trajectory are set
+  public: void SetTarget(const TrajectorySpline::Sample &_sample);
 
   /// \brief Update command force that is applied on the joint
   /// \param[in,out] _ecm Ignition Entity Component Manager
@@ -244,13 +244,17 @@ class Trajectory
   /// \brief Index of the current trajectory point
   public: unsigned int pointIndex;
 
-  /// \brief Ordered joints that need to be actuated to follow the current
-  /// trajectory
-  public: std::vector<std::string> jointNames;
+  /// \brief Trajectory defined in terms of temporal points, precomputed into
+  /// segments on receipt
+  public: TrajectorySpline spline;
 
-  /// \brief Trajectory defined in terms of temporal points, whose members are
-  /// ordered according to `jointNames`
-  public: std::vector<ignition::msgs::JointTrajectoryPoint> points;
+  /// \brief Index in the actuated joints of each joint of the trajectory,
+  /// kUnknownJoint for joints that aren't configured
+  public: std::vector<std::size_t> jointIndices;
+
+  /// \brief Index of joints of the trajectory that aren't configured
+  public: static constexpr std::size_t kUnknownJoint =
+              std::numeric_limits<std::size_t>::max();
 };
 
 /// \brief Private data of the JointTrajectoryController plugin
@@ -279,15 +283,24 @@ class ignition::gazebo::systems::JointTrajectoryControllerPrivate
   /// components
   public: void Reset();
 
+  /// \brief Set the target of each actuated joint of the trajectory from
+  /// `samples`
+  public: void SetTargets();
+
   /// \brief Ignition communication node
   public: transport::Node node;
 
   /// \brief Publisher of the progress for currently followed trajectory
   public: transport::Node::Publisher progressPub;
 
-  /// \brief Map of actuated joints, where the first entry of pair is the name
-  /// of the joint
-  public: std::map<std::string, ActuatedJoint> actuatedJoints;
+  /// \brief Actuated joints, in the order they were configured
+  public: std::vector<ActuatedJoint> actuatedJoints;
+
+  /// \brief Index of each actuated joint, keyed by joint name
+  public: std::unordered_map<std::string, std::size_t> actuatedJointIndices;
+
+  /// \brief Targets of the joints of the trajectory, reused across updates
+  public: std::vector<TrajectorySpline::Sample> samples;
 
   /// \brief Mutex projecting trajectory
   public: std::mutex trajectoryMutex;
@@ -300,6 +313,11 @@ class ignition::gazebo::systems::JointTrajectoryControllerPrivate
   /// is used otherwise
   public: bool useHeaderStartTime;
 
+  /// \brief Flag that determines whether targets are interpolated between
+  /// trajectory points at every update, where the targets of the next point
+  /// are used otherwise
+  public: bool interpolate{false};
+
   /// \brief Flag that determines if all components required for control are
   /// already setup
   public: bool componentSetupFinished;
@@ -348,8 +366,10 @@ void JointTrajectoryController::Configure(
   {
     const auto jointName =
         _ecm.Component<components::Name>(jointEntity)->Data();
-    this->dataPtr->actuatedJoints[jointName] =
-        ActuatedJoint(jointEntity, jointParameters[jointName]);
+    this->dataPtr->actuatedJointIndices[jointName] =
+        this->dataPtr->actuatedJoints.size();
+    this->dataPtr->actuatedJoints.emplace_back(jointEntity,
+        jointParameters[jointName]);
     ignmsg << "[JointTrajectoryController] Configured joint ["
            << jointName << "(Entity=" << jointEntity << ")].\n";
   }
@@ -373,6 +393,7 @@ void JointTrajectoryController::Configure(
   {
     this->dataPtr->useHeaderStartTime = false;
   }
+  this->dataPtr->interpolate = _sdf->Get<bool>("interpolate", false).first;
 
   // Subscribe to joint trajectory commands
   auto trajectoryTopic = _sdf->Get<std::string>("topic");
@@ -416,10 +437,9 @@ void JointTrajectoryController::PreUpdate(
   // Create required components for each joint (only once)
   if (!this->dataPtr->componentSetupFinished)
   {
-    for (auto &actuatedJoint : this->dataPtr->actuatedJoints)
+    for (const auto &actuatedJoint : this->dataPtr->actuatedJoints)
     {
-      ActuatedJoint *joint = &actuatedJoint.second;
-      joint->SetupComponents(_ecm);
+      actuatedJoint.SetupComponents(_ecm);
     }
     this->dataPtr->componentSetupFinished = true;
   }
@@ -457,7 +477,7 @@ void JointTrajectoryController::PreUpdate(
       }
 
       // If the new trajectory has no points, consider it reached
-      if (this->dataPtr->trajectory.points.empty())
+      if (this->dataPtr->trajectory.spline.PointCount() == 0u)
       {
         this->dataPtr->trajectory.status = Trajectory::Reached;
       }
@@ -481,26 +501,18 @@ void JointTrajectoryController::PreUpdate(
     if (isTargetUpdateRequired &&
         this->dataPtr->trajectory.status != Trajectory::Reached)
     {
-      const auto targetPoint =
-          this->dataPtr->trajectory.points[this->dataPtr->trajectory
-                                               .pointIndex];
-      for (auto jointIndex = 0u;
-           jointIndex < this->dataPtr->trajectory.jointNames.size();
-           ++jointIndex)
+      if (!this->dataPtr->interpolate)
       {
-        const auto jointName = this->dataPtr->trajectory.jointNames[jointIndex];
-        if (this->dataPtr->actuatedJoints.count(jointName) == 0)
-        {
-          // Warning about unconfigured joint is already logged above
-          continue;
-        }
-        auto *joint = &this->dataPtr->actuatedJoints[jointName];
-        joint->SetTarget(targetPoint, jointIndex);
+        this->dataPtr->trajectory.spline.Point(
+            this->dataPtr->trajectory.pointIndex, this->dataPtr->samples);
+        this->dataPtr->SetTargets();
       }
 
       // If there are no more points after the current one, set the trajectory
-      // to Reached
-      if (this->dataPtr->trajectory.IsGoalReached())
+      // to Reached. When interpolating, the last point is reached only once
+      // its time has passed
+      if (this->dataPtr->trajectory.IsGoalReached() &&
+          !this->dataPtr->interpolate)
       {
         this->dataPtr->trajectory.status = Trajectory::Reached;
       }
@@ -510,13 +522,30 @@ void JointTrajectoryController::PreUpdate(
       progressMsg.set_data(this->dataPtr->trajectory.ComputeProgress());
       this->dataPtr->progressPub.Publish(progressMsg);
     }
+
+    // Evaluate the targets of all joints along the precomputed segments
+    if (this->dataPtr->interpolate &&
+        this->dataPtr->trajectory.status == Trajectory::Active)
+    {
+      const auto trajectoryTime =
+          _info.simTime - this->dataPtr->trajectory.startTime;
+      this->dataPtr->trajectory.spline.Evaluate(trajectoryTime,
+                                                this->dataPtr->samples);
+      this->dataPtr->SetTargets();
+
+      const auto &spline = this->dataPtr->trajectory.spline;
+      if (this->dataPtr->trajectory.IsGoalReached() &&
+          trajectoryTime >= spline.PointTime(spline.PointCount() - 1u))
+      {
+        this->dataPtr->trajectory.status = Trajectory::Reached;
+      }
+    }
   }
 
   // Control loop
   for (auto &actuatedJoint : this->dataPtr->actuatedJoints)
   {
-    auto *joint = &actuatedJoint.second;
-    joint->Update(_ecm, _info.dt);
+    actuatedJoint.Update(_ecm, _info.dt);
   }
 }
 
@@ -577,7 +606,7 @@ std::vector<Entity> JointTrajectoryControllerPrivate::GetEnabledJoints(
     // Ignore duplicate joints
     for (const auto &actuatedJoint : this->actuatedJoints)
     {
-      if (actuatedJoint.second.entity == jointEntity)
+      if (actuatedJoint.entity == jointEntity)
       {
         ignwarn << "[JointTrajectoryController] Ignoring duplicate joint ["
                 << jointName << "(Entity=" << jointEntity << ")].\n";
@@ -677,14 +706,29 @@ void JointTrajectoryControllerPrivate::JointTrajectoryCallback(
   // Reset for a new trajectory
   this->trajectory.Reset();
 
-  // Extract joint names and points
-  for (const auto &joint_name : _msg.joint_names())
+  // Precompute the segments between points, so that updates don't need to
+  // look at the message
+  if (!this->trajectory.spline.Build(_msg))
   {
-    this->trajectory.jointNames.push_back(joint_name);
+    ignwarn << "[JointTrajectoryController] JointTrajectory message has"
+               " points that are not ordered by time_from_start, ignoring"
+               " it.\n";
+    return;
   }
-  for (const auto &point : _msg.points())
+
+  // Resolve joint names once, so that updates don't need to look them up
+  for (const auto &jointName : _msg.joint_names())
   {
-    this->trajectory.points.push_back(point);
+    const auto index = this->actuatedJointIndices.find(jointName);
+    if (index == this->actuatedJointIndices.end())
+    {
+      ignwarn << "[JointTrajectoryController] JointTrajectory message"
+                 " contains joint [" << jointName << "], which is not"
+                 " configured and will be ignored.\n";
+      this->trajectory.jointIndices.push_back(Trajectory::kUnknownJoint);
+      continue;
+    }
+    this->trajectory.jointIndices.push_back(index->second);
   }
 }
 
@@ -693,17 +737,29 @@ void JointTrajectoryControllerPrivate::Reset()
 {
   for (auto &actuatedJoint : this->actuatedJoints)
   {
-    auto *joint = &actuatedJoint.second;
     // Reset joint target
-    joint->ResetTarget();
+    actuatedJoint.ResetTarget();
     // Reset PIDs
-    joint->ResetPIDs();
+    actuatedJoint.ResetPIDs();
   }
 
   // Reset trajectory
   this->trajectory.Reset();
 }
 
+//////////////////////////////////////////////////
+void JointTrajectoryControllerPrivate::SetTargets()
+{
+  const auto &jointIndices = this->trajectory.jointIndices;
+  for (std::size_t i = 0; i < jointIndices.size(); ++i)
+  {
+    if (jointIndices[i] != Trajectory::kUnknownJoint)
+    {
+      this->actuatedJoints[jointIndices[i]].SetTarget(this->samples[i]);
+    }
+  }
+}
+
 ///////////////////////
 /// JointParameters ///
 ///////////////////////
@@ -918,25 +974,19 @@ void ActuatedJoint::SetupComponents(
 }
 
 //////////////////////////////////////////////////
-void ActuatedJoint::SetTarget(
-    const ignition::msgs::JointTrajectoryPoint &_targetPoint,
-    const size_t &_jointIndex)
+void ActuatedJoint::SetTarget(const TrajectorySpline::Sample &_sample)
 {
-  if ((signed)_jointIndex < _targetPoint.positions_size())
-  {
-    this->target.position = _targetPoint.positions(_jointIndex);
-  }
-  if ((signed)_jointIndex < _targetPoint.velocities_size())
+  if (_sample.hasPosition)
   {
-    this->target.velocity = _targetPoint.velocities(_jointIndex);
+    this->target.position = _sample.position;
   }
-  if ((signed)_jointIndex < _targetPoint.accelerations_size())
+  if (_sample.hasVelocity)
   {
-    this->target.acceleration = _targetPoint.accelerations(_jointIndex);
+    this->target.velocity = _sample.velocity;
   }
-  if ((signed)_jointIndex < _targetPoint.effort_size())
+  if (_sample.hasEffort)
   {
-    this->target.effort = _targetPoint.effort(_jointIndex);
+    this->target.effort = _sample.effort;
   }
 }
 
@@ -1011,10 +1061,7 @@ bool Trajectory::UpdateCurrentPoint(
     }
 
     // Break if point needs to be followed
-    const auto pointTFS = this->points[this->pointIndex].time_from_start();
-    const auto pointTime = std::chrono::seconds(pointTFS.sec()) +
-                           std::chrono::nanoseconds(pointTFS.nsec());
-    if (pointTime >= trajectoryTime)
+    if (this->spline.PointTime(this->pointIndex) >= trajectoryTime)
     {
       break;
     }
@@ -1031,20 +1078,20 @@ bool Trajectory::UpdateCurrentPoint(
 //////////////////////////////////////////////////
 bool Trajectory::IsGoalReached() const
 {
-  return this->pointIndex + 1 >= this->points.size();
+  return this->pointIndex + 1 >= this->spline.PointCount();
 }
 
 //////////////////////////////////////////////////
 float Trajectory::ComputeProgress() const
 {
-  if (this->points.size() == 0)
+  if (this->spline.PointCount() == 0)
   {
     return 1.0;
   }
   else
   {
     return static_cast<float>(this->pointIndex + 1) /
-           static_cast<float>(this->points.size());
+           static_cast<float>(this->spline.PointCount());
   }
 }
 
@@ -1053,8 +1100,8 @@ void Trajectory::Reset()
 {
   this->status = Trajectory::New;
   this->pointIndex = 0;
-  this->jointNames.clear();
-  this->points.clear();
+  this->spline.Clear();
+  this->jointIndices.clear();
 }
 
 // Register plugin
@@ -74,6 +74,15 @@ namespace systems
   ///  Optional parameter.
   ///  Defaults to false.
   ///
+  /// `<interpolate>` If enabled, joint targets are interpolated between
+  ///  trajectory points at every update, instead of jumping to the targets of
+  ///  the next point. Positions follow a cubic spline through the positions
+  ///  and velocities of the points, or a line if the points have no
+  ///  velocities, and velocities and efforts follow the same curves. The
+  ///  curves are precomputed when a trajectory is received.
+  ///  Optional parameter.
+  ///  Defaults to false.
+  ///
   /// `<joint_name>` Name of a joint to control.
   ///  This parameter can be specified multiple times, i.e. once for each joint.
   ///  Optional parameter.
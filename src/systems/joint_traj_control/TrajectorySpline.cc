@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "TrajectorySpline.hh"
+
+#include <algorithm>
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/// \brief Convert a duration to seconds.
+/// \param[in] _duration Duration.
+/// \return Seconds.
+static double Seconds(std::chrono::steady_clock::duration _duration)
+{
+  return std::chrono::duration<double>(_duration).count();
+}
+
+//////////////////////////////////////////////////
+bool TrajectorySpline::Build(const msgs::JointTrajectory &_msg)
+{
+  this->Clear();
+
+  const std::size_t count = static_cast<std::size_t>(_msg.joint_names_size());
+  if (count == 0u)
+    return false;
+
+  // Values of the points
+  this->times.reserve(_msg.points_size());
+  this->points.reserve(_msg.points_size() * count);
+  for (const auto &point : _msg.points())
+  {
+    const auto time = std::chrono::seconds(point.time_from_start().sec()) +
+        std::chrono::nanoseconds(point.time_from_start().nsec());
+    if (!this->times.empty() && time < this->times.back())
+    {
+      this->Clear();
+      return false;
+    }
+    this->times.push_back(time);
+
+    for (int j = 0; j < static_cast<int>(count); ++j)
+    {
+      Sample sample;
+      sample.hasPosition = j < point.positions_size();
+      sample.hasVelocity = j < point.velocities_size();
+      sample.hasEffort = j < point.effort_size();
+      if (sample.hasPosition)
+        sample.position = point.positions(j);
+      if (sample.hasVelocity)
+        sample.velocity = point.velocities(j);
+      if (sample.hasEffort)
+        sample.effort = point.effort(j);
+      this->points.push_back(sample);
+    }
+  }
+
+  // Segments between consecutive points
+  if (this->times.size() > 1u)
+    this->segments.resize((this->times.size() - 1u) * count);
+  for (std::size_t i = 1; i < this->times.size(); ++i)
+  {
+    // Empty segments are never evaluated
+    const double duration = Seconds(this->times[i] - this->times[i - 1]);
+    if (duration <= 0.0)
+      continue;
+
+    for (std::size_t j = 0; j < count; ++j)
+    {
+      const Sample &a = this->points[(i - 1) * count + j];
+      const Sample &b = this->points[i * count + j];
+      Coefficients &c = this->segments[(i - 1) * count + j];
+      c = Coefficients();
+
+      if (a.hasPosition && b.hasPosition)
+      {
+        c.fields |= kPosition;
+        const double slope = (b.position - a.position) / duration;
+        c.position[0] = a.position;
+        if (a.hasVelocity && b.hasVelocity)
+        {
+          // Cubic Hermite spline, whose derivative gives the velocities
+          c.fields |= kVelocity;
+          c.position[1] = a.velocity;
+          c.position[2] =
+              (3.0 * slope - 2.0 * a.velocity - b.velocity) / duration;
+          c.position[3] =
+              (b.velocity + a.velocity - 2.0 * slope) / (duration * duration);
+          c.velocity[0] = c.position[1];
+          c.velocity[1] = 2.0 * c.position[2];
+          c.velocity[2] = 3.0 * c.position[3];
+        }
+        else
+        {
+          c.position[1] = slope;
+        }
+      }
+
+      if (!(c.fields & kVelocity) && a.hasVelocity && b.hasVelocity)
+      {
+        c.fields |= kVelocity;
+        c.velocity[0] = a.velocity;
+        c.velocity[1] = (b.velocity - a.velocity) / duration;
+      }
+
+      if (a.hasEffort && b.hasEffort)
+      {
+        c.fields |= kEffort;
+        c.effort[0] = a.effort;
+        c.effort[1] = (b.effort - a.effort) / duration;
+      }
+    }
+  }
+
+  this->jointCount = count;
+  return true;
+}
+
+//////////////////////////////////////////////////
+void TrajectorySpline::Clear()
+{
+  this->times.clear();
+  this->points.clear();
+  this->segments.clear();
+  this->jointCount = 0u;
+}
+
+//////////////////////////////////////////////////
+std::size_t TrajectorySpline::JointCount() const
+{
+  return this->jointCount;
+}
+
+//////////////////////////////////////////////////
+std::size_t TrajectorySpline::PointCount() const
+{
+  return this->times.size();
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration TrajectorySpline::PointTime(
+    std::size_t _index) const
+{
+  return this->times[_index];
+}
+
+//////////////////////////////////////////////////
+void TrajectorySpline::Point(std::size_t _index,
+    std::vector<Sample> &_samples) const
+{
+  _samples.assign(this->points.begin() + _index * this->jointCount,
+                  this->points.begin() + (_index + 1u) * this->jointCount);
+}
+
+//////////////////////////////////////////////////
+void TrajectorySpline::Evaluate(std::chrono::steady_clock::duration _time,
+    std::vector<Sample> &_samples) const
+{
+  const std::size_t count = this->jointCount;
+  _samples.resize(count);
+  if (this->times.empty())
+    return;
+
+  // First point after _time, so the segment ends there
+  const std::size_t end = static_cast<std::size_t>(
+      std::upper_bound(this->times.begin(), this->times.end(), _time) -
+      this->times.begin());
+
+  // Hold the first or last point
+  if (end == 0u || end == this->times.size())
+  {
+    this->Point(end == 0u ? 0u : end - 1u, _samples);
+    return;
+  }
+
+  const double t = Seconds(_time - this->times[end - 1u]);
+  const Coefficients *c = &this->segments[(end - 1u) * count];
+  const Sample *b = &this->points[end * count];
+  for (std::size_t j = 0; j < count; ++j, ++c, ++b)
+  {
+    Sample &sample = _samples[j];
+
+    // Fields which aren't interpolated take the value of the later point
+    sample = *b;
+    if (c->fields & kPosition)
+    {
+      sample.position = c->position[0] + t * (c->position[1] +
+          t * (c->position[2] + t * c->position[3]));
+    }
+    if (c->fields & kVelocity)
+    {
+      sample.velocity = c->velocity[0] + t * (c->velocity[1] +
+          t * c->velocity[2]);
+    }
+    if (c->fields & kEffort)
+      sample.effort = c->effort[0] + t * c->effort[1];
+  }
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_JOINTTRAJCONTROL_TRAJECTORYSPLINE_HH_
+#define IGNITION_GAZEBO_SYSTEMS_JOINTTRAJCONTROL_TRAJECTORYSPLINE_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <ignition/msgs/joint_trajectory.pb.h>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/joint-trajectory-controller-system/Export.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  /// \brief Joint trajectory turned into polynomial segments between its
+  /// points, so that the targets of all joints at any time can be evaluated
+  /// in a single pass, without touching the trajectory message.
+  ///
+  /// Between two points, positions follow a cubic Hermite spline if both
+  /// points have positions and velocities, and a line if they only have
+  /// positions. Velocities follow the derivative of the positions if both
+  /// points have both, and a line otherwise. Efforts follow a line. A field
+  /// missing from either point isn't interpolated, and takes the value of
+  /// the later point if it has one. Before the first point and after the
+  /// last one, the values of that point are held.
+  ///
+  /// Coefficients of all segments are stored contiguously, segment by
+  /// segment, with the joints of a segment next to each other.
+  class IGNITION_GAZEBO_JOINT_TRAJECTORY_CONTROLLER_SYSTEM_VISIBLE
+      TrajectorySpline
+  {
+    /// \brief Targets of one joint at some time.
+    public: struct Sample
+    {
+      /// \brief Target position, if hasPosition.
+      double position{0.0};
+
+      /// \brief Target velocity, if hasVelocity.
+      double velocity{0.0};
+
+      /// \brief Target effort, if hasEffort.
+      double effort{0.0};
+
+      /// \brief Whether the trajectory defines the position.
+      bool hasPosition{false};
+
+      /// \brief Whether the trajectory defines the velocity.
+      bool hasVelocity{false};
+
+      /// \brief Whether the trajectory defines the effort.
+      bool hasEffort{false};
+    };
+
+    /// \brief Precompute the segments of a trajectory, replacing the
+    /// current ones.
+    /// \param[in] _msg Trajectory, whose points must be ordered by time.
+    /// \return False if the trajectory has no joints or its points aren't
+    /// ordered, in which case the spline is empty.
+    public: bool Build(const msgs::JointTrajectory &_msg);
+
+    /// \brief Remove all points.
+    public: void Clear();
+
+    /// \brief Number of joints.
+    /// \return Number of joints of the trajectory.
+    public: std::size_t JointCount() const;
+
+    /// \brief Number of points.
+    /// \return Number of points of the trajectory.
+    public: std::size_t PointCount() const;
+
+    /// \brief Time of a point.
+    /// \param[in] _index Index of the point, less than PointCount().
+    /// \return Time from the start of the trajectory.
+    public: std::chrono::steady_clock::duration PointTime(
+        std::size_t _index) const;
+
+    /// \brief Get the values of all joints at a point, without
+    /// interpolating.
+    /// \param[in] _index Index of the point, less than PointCount().
+    /// \param[out] _samples Resized to JointCount() and filled with the
+    /// values of each joint at the point.
+    public: void Point(std::size_t _index,
+        std::vector<Sample> &_samples) const;
+
+    /// \brief Evaluate the targets of all joints.
+    /// \param[in] _time Time from the start of the trajectory.
+    /// \param[out] _samples Resized to JointCount() and filled with the
+    /// targets of each joint, in the order of the joints of the trajectory.
+    /// Reusing it avoids allocating.
+    public: void Evaluate(std::chrono::steady_clock::duration _time,
+        std::vector<Sample> &_samples) const;
+
+    /// \brief Fields of a segment which are defined.
+    private: enum Field : uint8_t
+    {
+      kPosition = 1u << 0,
+      kVelocity = 1u << 1,
+      kEffort = 1u << 2
+    };
+
+    /// \brief Coefficients of one joint over one segment, as polynomials of
+    /// the time since the start of the segment, lowest order first.
+    private: struct Coefficients
+    {
+      /// \brief Position polynomial.
+      double position[4];
+
+      /// \brief Velocity polynomial.
+      double velocity[3];
+
+      /// \brief Effort polynomial.
+      double effort[2];
+
+      /// \brief Defined fields, a combination of Field.
+      uint8_t fields;
+    };
+
+    /// \brief Times of the points from the start of the trajectory.
+    private: std::vector<std::chrono::steady_clock::duration> times;
+
+    /// \brief Values at each point, JointCount() per point.
+    private: std::vector<Sample> points;
+
+    /// \brief Coefficients of the segment ending at each point after the
+    /// first one, JointCount() per segment.
+    private: std::vector<Coefficients> segments;
+
+    /// \brief Number of joints.
+    private: std::size_t jointCount{0u};
+  };
+}
+}
+}
+}
+#endif
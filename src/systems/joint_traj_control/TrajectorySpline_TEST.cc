@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+#include "TrajectorySpline.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+using namespace std::chrono_literals;
+
+/// \brief Add a point to a trajectory.
+/// \param[in, out] _msg Trajectory.
+/// \param[in] _ms Time from start [ms].
+/// \param[in] _positions Positions.
+/// \param[in] _velocities Velocities.
+/// \param[in] _efforts Efforts.
+static void AddPoint(msgs::JointTrajectory &_msg, int _ms,
+    const std::vector<double> &_positions,
+    const std::vector<double> &_velocities = {},
+    const std::vector<double> &_efforts = {})
+{
+  auto *point = _msg.add_points();
+  point->mutable_time_from_start()->set_sec(_ms / 1000);
+  point->mutable_time_from_start()->set_nsec((_ms % 1000) * 1000000);
+  for (double value : _positions)
+    point->add_positions(value);
+  for (double value : _velocities)
+    point->add_velocities(value);
+  for (double value : _efforts)
+    point->add_effort(value);
+}
+
+/////////////////////////////////////////////////
+TEST(TrajectorySpline, Invalid)
+{
+  TrajectorySpline spline;
+  std::vector<TrajectorySpline::Sample> samples;
+  spline.Evaluate(1s, samples);
+  EXPECT_TRUE(samples.empty());
+
+  // No joints
+  msgs::JointTrajectory msg;
+  AddPoint(msg, 0, {1.0});
+  EXPECT_FALSE(spline.Build(msg));
+
+  // Points going back in time
+  msg.add_joint_names("joint");
+  AddPoint(msg, 1000, {1.0});
+  AddPoint(msg, 500, {1.0});
+  EXPECT_FALSE(spline.Build(msg));
+  EXPECT_EQ(0u, spline.JointCount());
+  EXPECT_EQ(0u, spline.PointCount());
+}
+
+/////////////////////////////////////////////////
+TEST(TrajectorySpline, Linear)
+{
+  msgs::JointTrajectory msg;
+  msg.add_joint_names("joint1");
+  msg.add_joint_names("joint2");
+  AddPoint(msg, 1000, {0.0, 2.0}, {}, {1.0, 0.0});
+  AddPoint(msg, 2000, {1.0, 0.0}, {}, {3.0, 0.0});
+
+  TrajectorySpline spline;
+  ASSERT_TRUE(spline.Build(msg));
+  EXPECT_EQ(2u, spline.JointCount());
+  EXPECT_EQ(2u, spline.PointCount());
+  EXPECT_EQ(std::chrono::steady_clock::duration(2s), spline.PointTime(1));
+
+  std::vector<TrajectorySpline::Sample> samples;
+
+  // Hold the first point
+  spline.Evaluate(500ms, samples);
+  ASSERT_EQ(2u, samples.size());
+  EXPECT_DOUBLE_EQ(0.0, samples[0].position);
+  EXPECT_DOUBLE_EQ(2.0, samples[1].position);
+
+  spline.Evaluate(1250ms, samples);
+  EXPECT_TRUE(samples[0].hasPosition);
+  EXPECT_FALSE(samples[0].hasVelocity);
+  EXPECT_TRUE(samples[0].hasEffort);
+  EXPECT_DOUBLE_EQ(0.25, samples[0].position);
+  EXPECT_DOUBLE_EQ(1.5, samples[1].position);
+  EXPECT_DOUBLE_EQ(1.5, samples[0].effort);
+
+  spline.Point(0, samples);
+  EXPECT_DOUBLE_EQ(0.0, samples[0].position);
+  EXPECT_DOUBLE_EQ(1.0, samples[0].effort);
+
+  // Hold the last point
+  spline.Evaluate(5s, samples);
+  EXPECT_DOUBLE_EQ(1.0, samples[0].position);
+  EXPECT_DOUBLE_EQ(0.0, samples[1].position);
+  EXPECT_DOUBLE_EQ(3.0, samples[0].effort);
+}
+
+/////////////////////////////////////////////////
+TEST(TrajectorySpline, Cubic)
+{
+  msgs::JointTrajectory msg;
+  msg.add_joint_names("joint");
+  AddPoint(msg, 0, {0.0}, {0.0});
+  AddPoint(msg, 2000, {1.0}, {0.0});
+  AddPoint(msg, 3000, {1.0}, {2.0});
+
+  TrajectorySpline spline;
+  ASSERT_TRUE(spline.Build(msg));
+
+  std::vector<TrajectorySpline::Sample> samples;
+
+  // Passes through the points with their velocities
+  spline.Evaluate(0s, samples);
+  EXPECT_DOUBLE_EQ(0.0, samples[0].position);
+  EXPECT_DOUBLE_EQ(0.0, samples[0].velocity);
+  spline.Evaluate(2s, samples);
+  EXPECT_DOUBLE_EQ(1.0, samples[0].position);
+  EXPECT_DOUBLE_EQ(0.0, samples[0].velocity);
+
+  // Symmetric between points with equal velocities
+  spline.Evaluate(1s, samples);
+  EXPECT_TRUE(samples[0].hasVelocity);
+  EXPECT_DOUBLE_EQ(0.5, samples[0].position);
+  EXPECT_DOUBLE_EQ(0.75, samples[0].velocity);
+
+  // Approaches the velocity of the next point
+  spline.Evaluate(2999ms, samples);
+  EXPECT_NEAR(1.0, samples[0].position, 1e-2);
+  EXPECT_NEAR(2.0, samples[0].velocity, 1e-2);
+}
+
+/////////////////////////////////////////////////
+TEST(TrajectorySpline, MissingFields)
+{
+  msgs::JointTrajectory msg;
+  msg.add_joint_names("joint");
+  AddPoint(msg, 0, {0.0});
+  AddPoint(msg, 1000, {}, {1.0});
+  AddPoint(msg, 2000, {}, {3.0});
+
+  TrajectorySpline spline;
+  ASSERT_TRUE(spline.Build(msg));
+
+  std::vector<TrajectorySpline::Sample> samples;
+
+  // Fields missing from either point take the value of the later one
+  spline.Evaluate(500ms, samples);
+  EXPECT_FALSE(samples[0].hasPosition);
+  EXPECT_TRUE(samples[0].hasVelocity);
+  EXPECT_DOUBLE_EQ(1.0, samples[0].velocity);
+
+  // Velocities are interpolated without positions
+  spline.Evaluate(1500ms, samples);
+  EXPECT_FALSE(samples[0].hasPosition);
+  EXPECT_DOUBLE_EQ(2.0, samples[0].velocity);
+}
@@ -28,6 +28,9 @@
 
 #include <ignition/msgs/double.pb.h>
 
+#include <atomic>
+#include <functional>
+#include <mutex>
 #include <string>
 
 #include <ignition/gazebo/components/AngularVelocity.hh>
@@ -38,10 +41,14 @@
 #include <ignition/gazebo/components/World.hh>
 #include <ignition/gazebo/components/Inertial.hh>
 #include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Events.hh>
+#include <ignition/gazebo/KinematicsSnapshot.hh>
 #include <ignition/gazebo/Link.hh>
 #include <ignition/gazebo/Model.hh>
 #include <ignition/gazebo/Util.hh>
 #include <ignition/common/Profiler.hh>
+#include <ignition/math/Inertial.hh>
+#include <ignition/math/Matrix3.hh>
 
 #include <ignition/plugin/Register.hh>
 
@@ -56,6 +63,17 @@ using namespace systems;
 /// \brief Private data class
 class ignition::gazebo::systems::KineticEnergyMonitorPrivate
 {
+  /// \brief Publish the loss of kinetic energy if it's above the
+  /// threshold. Must be called with mutex locked.
+  /// \param[in] _energy Kinetic energy in the latest step.
+  public: void CheckKineticEnergy(double _energy);
+
+  /// \brief Callback for the kinematics computed by physics after each
+  /// step, called from the event thread.
+  /// \param[in] _snapshot Kinematics of the step.
+  public: void OnKinematics(
+      std::shared_ptr<const KinematicsSnapshot> _snapshot);
+
   /// \brief Link of the model.
   public: Entity linkEntity;
 
@@ -73,6 +91,23 @@ class ignition::gazebo::systems::KineticEnergyMonitorPrivate
 
   /// \brief The model this plugin is attached to.
   public: Model model;
+
+  /// \brief Inertial of the link.
+  public: math::Inertiald inertial;
+
+  /// \brief Simulation time of the latest kinetic energy.
+  public: std::chrono::steady_clock::duration lastSimTime{0};
+
+  /// \brief Protects prevKineticEnergy and lastSimTime, which are updated
+  /// from PostUpdate or from the event thread.
+  public: std::mutex mutex;
+
+  /// \brief True once the kinetic energy is computed from the kinematics
+  /// published by physics instead of PostUpdate.
+  public: std::atomic<bool> useKinematics{false};
+
+  /// \brief Connection to the KinematicsUpdated event.
+  public: common::ConnectionPtr kinematicsConn;
 };
 
 //////////////////////////////////////////////////
@@ -88,7 +123,7 @@ KineticEnergyMonitor::~KineticEnergyMonitor() = default;
 void KineticEnergyMonitor::Configure(const Entity &_entity,
         const std::shared_ptr<const sdf::Element> &_sdf,
         EntityComponentManager &_ecm,
-        EventManager &/*_eventMgr*/)
+        EventManager &_eventMgr)
 {
   this->dataPtr->model = Model(_entity);
 
@@ -143,6 +178,13 @@ void KineticEnergyMonitor::Configure(const Entity &_entity,
 
   // Create a default inertia in case the link doesn't have it
   enableComponent<components::Inertial>(_ecm, this->dataPtr->linkEntity, true);
+  this->dataPtr->inertial =
+      _ecm.Component<components::Inertial>(this->dataPtr->linkEntity)->Data();
+
+  this->dataPtr->kinematicsConn =
+      _eventMgr.Connect<events::KinematicsUpdated>(
+      std::bind(&KineticEnergyMonitorPrivate::OnKinematics,
+      this->dataPtr.get(), std::placeholders::_1));
 }
 
 //////////////////////////////////////////////////
@@ -154,27 +196,70 @@ void KineticEnergyMonitor::PostUpdate(const UpdateInfo &_info,
   if (_info.paused || !this->dataPtr->pub)
     return;
 
-  if (this->dataPtr->linkEntity != kNullEntity)
+  // Computed off the step thread from the kinematics published by physics
+  if (this->dataPtr->useKinematics ||
+      this->dataPtr->linkEntity == kNullEntity)
+  {
+    return;
+  }
+
+  Link link(this->dataPtr->linkEntity);
+  auto currKineticEnergy = link.WorldKineticEnergy(_ecm);
+  if (std::nullopt == currKineticEnergy)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->lastSimTime = _info.simTime;
+  this->dataPtr->CheckKineticEnergy(*currKineticEnergy);
+}
+
+//////////////////////////////////////////////////
+void KineticEnergyMonitorPrivate::OnKinematics(
+    std::shared_ptr<const KinematicsSnapshot> _snapshot)
+{
+  if (!this->pub)
+    return;
+
+  auto kinematics = _snapshot->Find(this->linkEntity);
+  if (nullptr == kinematics)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->useKinematics = true;
+
+  // PostUpdate may have handled this step before the first snapshot arrived
+  if (_snapshot->info.simTime <= this->lastSimTime)
+    return;
+  this->lastSimTime = _snapshot->info.simTime;
+
+  // Same as Link::WorldKineticEnergy
+  const auto &pose = kinematics->worldPose;
+  const auto &angVel = kinematics->angularVelocity;
+  auto comVel = kinematics->linearVelocity +
+      angVel.Cross(pose.Rot().RotateVector(this->inertial.Pose().Pos()));
+  math::Matrix3d rot(pose.Rot() * this->inertial.Pose().Rot());
+  auto moi = rot * this->inertial.MassMatrix().Moi() * rot.Transposed();
+
+  this->CheckKineticEnergy(0.5 * (
+      this->inertial.MassMatrix().Mass() * comVel.SquaredLength() +
+      angVel.Dot(moi * angVel)));
+}
+
+//////////////////////////////////////////////////
+void KineticEnergyMonitorPrivate::CheckKineticEnergy(double _energy)
+{
+  // We only care about positive values of this (the links looses energy)
+  double deltaKE = this->prevKineticEnergy - _energy;
+  this->prevKineticEnergy = _energy;
+
+  if (deltaKE > this->keThreshold)
   {
-    Link link(this->dataPtr->linkEntity);
-    if (std::nullopt != link.WorldKineticEnergy(_ecm))
-    {
-      double currKineticEnergy = *link.WorldKineticEnergy(_ecm);
-
-      // We only care about positive values of this (the links looses energy)
-      double deltaKE = this->dataPtr->prevKineticEnergy - currKineticEnergy;
-      this->dataPtr->prevKineticEnergy = currKineticEnergy;
-
-      if (deltaKE > this->dataPtr->keThreshold)
-      {
-        ignmsg << this->dataPtr->modelName
-          << " Change in kinetic energy above threshold - deltaKE: "
-          << deltaKE << std::endl;
-        msgs::Double msg;
-        msg.set_data(deltaKE);
-        this->dataPtr->pub.Publish(msg);
-      }
-    }
+    ignmsg << this->modelName
+      << " Change in kinetic energy above threshold - deltaKE: "
+      << deltaKE << std::endl;
+    msgs::Double msg;
+    msg.set_data(deltaKE);
+    this->pub.Publish(msg);
   }
 }
 
@@ -38,6 +38,8 @@ namespace systems
   /// and publishes when there is a lost of kinetic energy during a timestep
   /// that surpasses a specific threshold.
   /// This system can be used to detect when a model could be damaged.
+  /// When the physics system is running, the kinetic energy is computed and
+  /// published from the event thread, see events::KinematicsUpdated.
   ///
   /// # System Parameters
   ///
@@ -0,0 +1,327 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "CoefficientTable.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <utility>
+
+#include <ignition/common/Console.hh>
+#include <ignition/math/Helpers.hh>
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/// \brief Number of bins of an axis index per interval between breakpoints.
+static constexpr std::size_t kBinsPerInterval{4u};
+
+/// \brief Split a CSV line into trimmed, lower case fields.
+/// \param[in] _line Line of text.
+/// \return Fields of the line.
+static std::vector<std::string> SplitFields(const std::string &_line)
+{
+  std::vector<std::string> fields;
+  std::istringstream stream(_line);
+  std::string field;
+  while (std::getline(stream, field, ','))
+  {
+    auto first = field.find_first_not_of(" \t\r");
+    auto last = field.find_last_not_of(" \t\r");
+    field = first == std::string::npos ? "" :
+        field.substr(first, last - first + 1);
+    std::transform(field.begin(), field.end(), field.begin(),
+        [](unsigned char _c) {return std::tolower(_c);});
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+//////////////////////////////////////////////////
+void CoefficientTable::Axis::BuildIndex()
+{
+  this->binStart.clear();
+  if (this->points.size() < 2u)
+    return;
+
+  const std::size_t bins = kBinsPerInterval * (this->points.size() - 1u);
+  this->binWidth = (this->points.back() - this->points.front()) / bins;
+
+  std::size_t index = 0u;
+  for (std::size_t b = 0; b < bins; ++b)
+  {
+    const double start = this->points.front() + b * this->binWidth;
+    while (index + 2u < this->points.size() &&
+        this->points[index + 1u] <= start)
+    {
+      ++index;
+    }
+    this->binStart.push_back(index);
+  }
+}
+
+//////////////////////////////////////////////////
+std::size_t CoefficientTable::Axis::Locate(double _value,
+    double &_fraction) const
+{
+  _fraction = 0.0;
+  if (this->points.size() < 2u)
+    return 0u;
+
+  const double value = math::clamp(_value, this->points.front(),
+      this->points.back());
+  const auto bin = std::min(static_cast<std::size_t>(
+      (value - this->points.front()) / this->binWidth),
+      this->binStart.size() - 1u);
+
+  // Only the breakpoints within the bin are stepped over. Rounding may
+  // land on the next bin.
+  std::size_t index = this->binStart[bin];
+  while (index + 2u < this->points.size() && value >= this->points[index + 1u])
+    ++index;
+  while (index > 0u && value < this->points[index])
+    --index;
+
+  _fraction = (value - this->points[index]) /
+      (this->points[index + 1u] - this->points[index]);
+  return index;
+}
+
+//////////////////////////////////////////////////
+bool CoefficientTable::Load(const std::string &_path)
+{
+  std::ifstream file(_path);
+  if (!file)
+  {
+    ignerr << "Failed to open coefficient table [" << _path << "]"
+           << std::endl;
+    this->values.clear();
+    return false;
+  }
+
+  std::stringstream text;
+  text << file.rdbuf();
+  if (!this->Parse(text.str()))
+  {
+    ignerr << "Failed to load coefficient table [" << _path << "]"
+           << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool CoefficientTable::Parse(const std::string &_csv)
+{
+  this->values.clear();
+
+  enum Column {kAlpha, kMach, kReynolds, kCl, kCd, kCm, kColumnCount};
+  static const std::array<std::string, kColumnCount> names{
+      {"alpha", "mach", "reynolds", "cl", "cd", "cm"}};
+
+  std::array<std::optional<std::size_t>, kColumnCount> columns;
+  std::size_t columnCount{0u};
+  std::vector<std::vector<double>> rows;
+
+  std::istringstream stream(_csv);
+  std::string line;
+  while (std::getline(stream, line))
+  {
+    auto fields = SplitFields(line);
+    if (fields.empty() || (fields.size() == 1u && fields[0].empty()) ||
+        fields[0].rfind("#", 0) == 0u)
+    {
+      continue;
+    }
+
+    // Header
+    if (columnCount == 0u)
+    {
+      columnCount = fields.size();
+      for (std::size_t i = 0; i < fields.size(); ++i)
+      {
+        auto it = std::find(names.begin(), names.end(), fields[i]);
+        if (it == names.end())
+        {
+          ignerr << "Unknown coefficient table column [" << fields[i] << "]"
+                 << std::endl;
+          return false;
+        }
+        columns[it - names.begin()] = i;
+      }
+
+      for (auto required : {kAlpha, kCl, kCd})
+      {
+        if (!columns[required])
+        {
+          ignerr << "Coefficient table is missing the [" << names[required]
+                 << "] column" << std::endl;
+          return false;
+        }
+      }
+      continue;
+    }
+
+    if (fields.size() != columnCount)
+    {
+      ignerr << "Coefficient table row [" << line << "] has "
+             << fields.size() << " values, expected " << columnCount
+             << std::endl;
+      return false;
+    }
+
+    std::vector<double> row;
+    for (const auto &field : fields)
+    {
+      std::istringstream valueStream(field);
+      double value;
+      if (!(valueStream >> value))
+      {
+        ignerr << "Invalid value [" << field << "] in coefficient table"
+               << std::endl;
+        return false;
+      }
+      row.push_back(value);
+    }
+    rows.push_back(row);
+  }
+
+  if (rows.empty())
+  {
+    ignerr << "Coefficient table has no rows" << std::endl;
+    return false;
+  }
+
+  // Breakpoints along each axis, missing axes have a single one
+  const std::array<Column, 3> axisColumns{{kAlpha, kMach, kReynolds}};
+  for (std::size_t a = 0; a < 3u; ++a)
+  {
+    auto &points = this->axes[a].points;
+    points.clear();
+    const auto column = columns[axisColumns[a]];
+    for (const auto &row : rows)
+      points.push_back(column ? row[*column] : 0.0);
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    this->axes[a].BuildIndex();
+  }
+
+  const std::size_t sampleCount = this->axes[0].points.size() *
+      this->axes[1].points.size() * this->axes[2].points.size();
+  if (sampleCount != rows.size())
+  {
+    ignerr << "Coefficient table has " << rows.size() << " rows, but its "
+           << "grid has " << sampleCount << " samples" << std::endl;
+    return false;
+  }
+
+  std::vector<Coefficients> grid(sampleCount);
+  std::vector<char> filled(sampleCount, 0);
+  for (const auto &row : rows)
+  {
+    std::array<std::size_t, 3> index;
+    for (std::size_t a = 0; a < 3u; ++a)
+    {
+      const auto &points = this->axes[a].points;
+      const auto column = columns[axisColumns[a]];
+      index[a] = std::lower_bound(points.begin(), points.end(),
+          column ? row[*column] : 0.0) - points.begin();
+    }
+    const std::size_t i = index[0] + this->axes[0].points.size() *
+        (index[1] + this->axes[1].points.size() * index[2]);
+    if (filled[i])
+    {
+      ignerr << "Coefficient table has duplicate rows" << std::endl;
+      return false;
+    }
+    filled[i] = 1;
+
+    grid[i].cl = row[*columns[kCl]];
+    grid[i].cd = row[*columns[kCd]];
+    if (columns[kCm])
+      grid[i].cm = row[*columns[kCm]];
+  }
+
+  this->values = std::move(grid);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool CoefficientTable::Valid() const
+{
+  return !this->values.empty();
+}
+
+//////////////////////////////////////////////////
+const CoefficientTable::Coefficients &CoefficientTable::At(std::size_t _a,
+    std::size_t _m, std::size_t _r) const
+{
+  return this->values[_a + this->axes[0].points.size() *
+      (_m + this->axes[1].points.size() * _r)];
+}
+
+//////////////////////////////////////////////////
+CoefficientTable::Coefficients CoefficientTable::Lookup(double _alpha,
+    double _mach, double _reynolds) const
+{
+  Coefficients result;
+  if (this->values.empty())
+    return result;
+
+  std::array<double, 3> f;
+  const std::array<std::size_t, 3> lo{{
+      this->axes[0].Locate(_alpha, f[0]),
+      this->axes[1].Locate(_mach, f[1]),
+      this->axes[2].Locate(_reynolds, f[2])}};
+
+  // Axes with a single breakpoint don't have an upper neighbor
+  std::array<std::size_t, 3> hi;
+  for (std::size_t a = 0; a < 3u; ++a)
+    hi[a] = this->axes[a].points.size() > 1u ? lo[a] + 1u : lo[a];
+
+  for (int r = 0; r < 2; ++r)
+  {
+    const double wr = r ? f[2] : 1.0 - f[2];
+    if (wr <= 0.0)
+      continue;
+
+    for (int m = 0; m < 2; ++m)
+    {
+      const double wm = wr * (m ? f[1] : 1.0 - f[1]);
+      if (wm <= 0.0)
+        continue;
+
+      for (int a = 0; a < 2; ++a)
+      {
+        const double w = wm * (a ? f[0] : 1.0 - f[0]);
+        if (w <= 0.0)
+          continue;
+
+        const auto &c = this->At(a ? hi[0] : lo[0], m ? hi[1] : lo[1],
+            r ? hi[2] : lo[2]);
+        result.cl += w * c.cl;
+        result.cd += w * c.cd;
+        result.cm += w * c.cm;
+      }
+    }
+  }
+  return result;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_LIFTDRAG_COEFFICIENTTABLE_HH_
+#define IGNITION_GAZEBO_SYSTEMS_LIFTDRAG_COEFFICIENTTABLE_HH_
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/lift-drag-system/Export.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  /// \brief Aerodynamic coefficients tabulated over angle of attack, and
+  /// optionally Mach and Reynolds numbers, such as wind tunnel or CFD data.
+  ///
+  /// The table is read from CSV text. The first line which isn't empty or a
+  /// comment starting with `#` names the columns, in any order:
+  /// - `alpha`: angle of attack [rad], required.
+  /// - `mach`: Mach number, optional.
+  /// - `reynolds`: Reynolds number, optional.
+  /// - `cl`, `cd`: lift and drag coefficients, required.
+  /// - `cm`: moment coefficient, optional.
+  ///
+  /// The rows must sample every combination of the alpha, mach and reynolds
+  /// values which appear in the table, which may be unevenly spaced.
+  /// Lookups interpolate linearly along each axis, and values outside of the
+  /// table take the value at the closest edge. Each axis has a precomputed
+  /// index of its breakpoints, so that a lookup doesn't search them.
+  class IGNITION_GAZEBO_LIFT_DRAG_SYSTEM_VISIBLE CoefficientTable
+  {
+    /// \brief Coefficients at one point.
+    public: struct Coefficients
+    {
+      /// \brief Lift coefficient.
+      double cl{0.0};
+
+      /// \brief Drag coefficient.
+      double cd{0.0};
+
+      /// \brief Moment coefficient.
+      double cm{0.0};
+    };
+
+    /// \brief Load a table from CSV text, replacing the current one.
+    /// \param[in] _csv CSV text.
+    /// \return True if the table was loaded. On failure the table is empty.
+    public: bool Parse(const std::string &_csv);
+
+    /// \brief Load a table from a CSV file, replacing the current one.
+    /// \param[in] _path Path to the file.
+    /// \return True if the table was loaded. On failure the table is empty.
+    public: bool Load(const std::string &_path);
+
+    /// \brief Whether a table has been loaded.
+    /// \return True if the table has samples.
+    public: bool Valid() const;
+
+    /// \brief Look up the coefficients.
+    /// \param[in] _alpha Angle of attack [rad].
+    /// \param[in] _mach Mach number. Ignored if the table has no mach column.
+    /// \param[in] _reynolds Reynolds number. Ignored if the table has no
+    /// reynolds column.
+    /// \return Interpolated coefficients, or zero if the table is empty.
+    public: Coefficients Lookup(double _alpha, double _mach = 0.0,
+        double _reynolds = 0.0) const;
+
+    /// \brief Breakpoints along one axis of the table.
+    private: struct Axis
+    {
+      /// \brief Build the index of the breakpoints.
+      void BuildIndex();
+
+      /// \brief Find the breakpoint before a value.
+      /// \param[in] _value Value along the axis.
+      /// \param[out] _fraction Fraction of the way to the next breakpoint.
+      /// \return Index of the breakpoint before the value.
+      std::size_t Locate(double _value, double &_fraction) const;
+
+      /// \brief Sorted breakpoints.
+      std::vector<double> points;
+
+      /// \brief Width of the bins of the index.
+      double binWidth{0.0};
+
+      /// \brief Index of the last breakpoint at or before the start of each
+      /// bin of equal width spanning the axis.
+      std::vector<std::size_t> binStart;
+    };
+
+    /// \brief Coefficients at one sample of the grid.
+    /// \param[in] _a Index along alpha.
+    /// \param[in] _m Index along mach.
+    /// \param[in] _r Index along reynolds.
+    /// \return Coefficients.
+    private: const Coefficients &At(std::size_t _a, std::size_t _m,
+        std::size_t _r) const;
+
+    /// \brief Alpha, mach and reynolds axes.
+    private: std::array<Axis, 3> axes;
+
+    /// \brief Coefficients on the grid, with alpha varying fastest.
+    private: std::vector<Coefficients> values;
+  };
+}
+}
+}
+}
+#endif
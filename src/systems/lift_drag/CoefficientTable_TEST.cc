@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "CoefficientTable.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/////////////////////////////////////////////////
+TEST(CoefficientTable, Invalid)
+{
+  CoefficientTable table;
+  EXPECT_FALSE(table.Valid());
+  EXPECT_DOUBLE_EQ(0.0, table.Lookup(0.1).cl);
+
+  // Missing required column
+  EXPECT_FALSE(table.Parse("alpha, cl\n0, 0\n1, 1\n"));
+
+  // Unknown column
+  EXPECT_FALSE(table.Parse("alpha, cl, cd, foo\n0, 0, 0, 0\n"));
+
+  // Incomplete grid
+  EXPECT_FALSE(table.Parse(
+      "alpha, mach, cl, cd\n"
+      "0, 0, 0, 0\n"
+      "1, 0, 1, 0\n"
+      "0, 1, 0, 0\n"));
+  EXPECT_FALSE(table.Valid());
+
+  EXPECT_FALSE(table.Load("/no/such/table.csv"));
+}
+
+/////////////////////////////////////////////////
+TEST(CoefficientTable, Alpha)
+{
+  // Unevenly spaced breakpoints, in any order
+  CoefficientTable table;
+  ASSERT_TRUE(table.Parse(
+      "# Flat plate\n"
+      "alpha, cl, cd\n"
+      "0.0, 0.0, 0.01\n"
+      "-0.2, -1.0, 0.05\n"
+      "0.05, 0.25, 0.02\n"
+      "0.2, 1.0, 0.05\n"
+      "\n"
+      "0.3, 0.5, 0.4\n"));
+  EXPECT_TRUE(table.Valid());
+
+  EXPECT_NEAR(0.0, table.Lookup(0.0).cl, 1e-9);
+  EXPECT_NEAR(0.125, table.Lookup(0.025).cl, 1e-9);
+  EXPECT_NEAR(0.015, table.Lookup(0.025).cd, 1e-9);
+  EXPECT_NEAR(0.75, table.Lookup(0.25).cl, 1e-9);
+  EXPECT_NEAR(-0.5, table.Lookup(-0.1).cl, 1e-9);
+  EXPECT_DOUBLE_EQ(0.0, table.Lookup(0.1).cm);
+
+  // Clamped outside of the table
+  EXPECT_NEAR(0.5, table.Lookup(1.0).cl, 1e-9);
+  EXPECT_NEAR(-1.0, table.Lookup(-1.0).cl, 1e-9);
+
+  // Extra axes are ignored when the table doesn't have them
+  EXPECT_NEAR(0.125, table.Lookup(0.025, 0.8, 1e6).cl, 1e-9);
+}
+
+/////////////////////////////////////////////////
+TEST(CoefficientTable, MachReynolds)
+{
+  // cl = alpha * (1 + mach) + reynolds * 1e-6, which is multilinear
+  std::string csv = "reynolds, mach, alpha, cl, cd, cm\n";
+  for (double re : {1e5, 1e6})
+    for (double mach : {0.0, 0.5})
+      for (double alpha : {-0.1, 0.1})
+      {
+        csv += std::to_string(re) + ", " + std::to_string(mach) + ", " +
+            std::to_string(alpha) + ", " +
+            std::to_string(alpha * (1 + mach) + re * 1e-6) + ", 0.02, " +
+            std::to_string(-alpha) + "\n";
+      }
+
+  CoefficientTable table;
+  ASSERT_TRUE(table.Parse(csv));
+
+  auto c = table.Lookup(0.05, 0.25, 5.5e5);
+  EXPECT_NEAR(0.05 * 1.25 + 0.55, c.cl, 1e-6);
+  EXPECT_NEAR(0.02, c.cd, 1e-9);
+  EXPECT_NEAR(-0.05, c.cm, 1e-6);
+}
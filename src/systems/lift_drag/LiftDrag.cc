@@ -18,16 +18,20 @@
 #include "LiftDrag.hh"
 
 #include <algorithm>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <ignition/common/Profiler.hh>
+#include <ignition/common/Util.hh>
 #include <ignition/plugin/Register.hh>
 #include <ignition/transport/Node.hh>
 
 #include <sdf/Element.hh>
 
 #include "ignition/gazebo/Link.hh"
+#include "ignition/gazebo/EnvironmentalForces.hh"
 #include "ignition/gazebo/Model.hh"
 #include "ignition/gazebo/Util.hh"
 
@@ -41,91 +45,198 @@
 #include "ignition/gazebo/components/ExternalWorldWrenchCmd.hh"
 #include "ignition/gazebo/components/Pose.hh"
 
+#include "CoefficientTable.hh"
+
 using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
-class ignition::gazebo::systems::LiftDragPrivate
+/// \brief Parameters of a lifting surface and its entities.
+struct LiftDragSurface
 {
-  // Initialize the system
-  public: void Load(const EntityComponentManager &_ecm,
-                    const sdf::ElementPtr &_sdf);
-
-  /// \brief Compute lift and drag forces and update the corresponding
-  /// components
-  /// \param[in] _ecm Immutable reference to the EntityComponentManager
-  public: void Update(EntityComponentManager &_ecm);
-
-  /// \brief Model interface
-  public: Model model{kNullEntity};
-
   /// \brief Coefficient of Lift / alpha slope.
   /// Lift = C_L * q * S
   /// where q (dynamic pressure) = 0.5 * rho * v^2
-  public: double cla = 1.0;
+  double cla = 1.0;
 
   /// \brief Coefficient of Drag / alpha slope.
   /// Drag = C_D * q * S
   /// where q (dynamic pressure) = 0.5 * rho * v^2
-  public: double cda = 0.01;
+  double cda = 0.01;
 
   /// \brief Coefficient of Moment / alpha slope.
   /// Moment = C_M * q * S
   /// where q (dynamic pressure) = 0.5 * rho * v^2
-  public: double cma = 0.01;
+  double cma = 0.01;
 
   /// \brief angle of attach when airfoil stalls
-  public: double alphaStall = IGN_PI_2;
+  double alphaStall = IGN_PI_2;
 
   /// \brief Cl-alpha rate after stall
-  public: double claStall = 0.0;
+  double claStall = 0.0;
 
   /// \brief Cd-alpha rate after stall
   /// \todo(anyone): what's flat plate drag?
-  public: double cdaStall = 1.0;
+  double cdaStall = 1.0;
 
   /// \brief Cm-alpha rate after stall
-  public: double cmaStall = 0.0;
+  double cmaStall = 0.0;
 
   /// \brief air density
   /// at 25 deg C it's about 1.1839 kg/m^3
   /// At 20 °C and 101.325 kPa, dry air has a density of 1.2041 kg/m3.
-  public: double rho = 1.2041;
+  double rho = 1.2041;
+
+  /// \brief Speed of sound in the fluid, for the Mach number.
+  double speedOfSound = 343.0;
+
+  /// \brief Dynamic viscosity of the fluid, for the Reynolds number.
+  /// Dry air at 20 °C has a viscosity of 1.81e-5 Pa s.
+  double viscosity = 1.81e-5;
+
+  /// \brief Chord length, for the Reynolds number.
+  double chord = 1.0;
 
   /// \brief if the shape is aerodynamically radially symmetric about
   /// the forward direction. Defaults to false for wing shapes.
   /// If set to true, the upward direction is determined by the
   /// angle of attack.
-  public: bool radialSymmetry = false;
+  bool radialSymmetry = false;
 
   /// \brief effective planeform surface area
-  public: double area = 1.0;
+  double area = 1.0;
 
   /// \brief initial angle of attack
-  public: double alpha0 = 0.0;
+  double alpha0 = 0.0;
 
   /// \brief center of pressure in link local coordinates with respect to the
   /// link's center of mass
-  public: math::Vector3d cp = math::Vector3d::Zero;
+  math::Vector3d cp = math::Vector3d::Zero;
 
   /// \brief Normally, this is taken as a direction parallel to the chord
   /// of the airfoil in zero angle of attack forward flight.
-  public: math::Vector3d forward = math::Vector3d::UnitX;
+  math::Vector3d forward = math::Vector3d::UnitX;
 
   /// \brief A vector in the lift/drag plane, perpendicular to the forward
   /// vector. Inflow velocity orthogonal to forward and upward vectors
   /// is considered flow in the wing sweep direction.
-  public: math::Vector3d upward = math::Vector3d::UnitZ;
+  math::Vector3d upward = math::Vector3d::UnitZ;
 
   /// \brief how much to change CL per radian of control surface joint
   /// value.
-  public: double controlJointRadToCL = 4.0;
+  double controlJointRadToCL = 4.0;
+
+  /// \brief Tabulated coefficients which replace the analytic model, if
+  /// given.
+  std::shared_ptr<const CoefficientTable> table;
 
   /// \brief Link entity targeted this plugin.
-  public: Entity linkEntity;
+  Entity linkEntity{kNullEntity};
+
+  /// \brief Joint entity that actuates a control surface for this lifting
+  /// body
+  Entity controlJointEntity{kNullEntity};
+
+  /// \brief Slot of linkEntity in the stage's batch
+  std::size_t linkSlot{0};
+};
+
+/// \brief Flow over a lifting surface on the current step.
+struct LiftDragFlow
+{
+  /// \brief Whether there is enough flow to generate forces.
+  bool valid{false};
+
+  /// \brief Center of pressure relative to the link origin, in the world
+  /// frame.
+  math::Vector3d cpWorld;
+
+  /// \brief Direction of lift in the world frame.
+  math::Vector3d liftI;
+
+  /// \brief Direction of drag in the world frame.
+  math::Vector3d dragDirection;
+
+  /// \brief Normal to the lift-drag plane in the world frame.
+  math::Vector3d spanwiseI;
+
+  /// \brief Angle of attack.
+  double alpha{0.0};
+
+  /// \brief Cosine of the sweep angle.
+  double cosSweepAngle{0.0};
+
+  /// \brief Dynamic pressure.
+  double q{0.0};
+
+  /// \brief Speed in the lift-drag plane.
+  double speed{0.0};
+};
+
+class ignition::gazebo::systems::LiftDragPrivate
+{
+  // Initialize the system
+  public: void Load(const EntityComponentManager &_ecm,
+                    const sdf::ElementPtr &_sdf);
+
+  /// \brief Read the parameters of a surface which are present in an
+  /// element. Missing parameters keep their current values.
+  /// \param[in] _sdf Element with the parameters.
+  /// \param[in, out] _surface Surface.
+  /// \return False if a coefficient table couldn't be loaded.
+  public: bool LoadParams(const sdf::ElementPtr &_sdf,
+                          LiftDragSurface &_surface);
+
+  /// \brief Find the entities of a surface.
+  /// \param[in] _ecm Immutable reference to the EntityComponentManager
+  /// \param[in] _sdf Element with the link and joint names.
+  /// \param[in, out] _surface Surface.
+  /// \return False if the entities weren't found.
+  public: bool LoadEntities(const EntityComponentManager &_ecm,
+                            const sdf::ElementPtr &_sdf,
+                            LiftDragSurface &_surface);
+
+  /// \brief Destructor.
+  public: ~LiftDragPrivate();
+
+  /// \brief Compute lift and drag forces of all surfaces and add them to
+  /// the links' wrenches
+  /// \param[in] _ecm Immutable reference to the EntityComponentManager
+  /// \param[in] _links Kinematics and wrenches of the links
+  public: void Update(const EntityComponentManager &_ecm,
+                      LinkKinematics &_links);
+
+  /// \brief Compute the flow over a surface.
+  /// \param[in] _surface Surface.
+  /// \param[in] _links Kinematics of the links.
+  /// \return Flow over the surface.
+  public: static LiftDragFlow ComputeFlow(const LiftDragSurface &_surface,
+                                          const LinkKinematics &_links);
+
+  /// \brief Compute the coefficients of the analytic model, before the
+  /// sweep correction.
+  /// \param[in] _surface Surface.
+  /// \param[in] _alpha Angle of attack.
+  /// \return Coefficients.
+  public: static CoefficientTable::Coefficients AnalyticCoefficients(
+              const LiftDragSurface &_surface, double _alpha);
+
+  /// \brief Model interface
+  public: Model model{kNullEntity};
+
+  /// \brief Lifting surfaces of the model.
+  public: std::vector<LiftDragSurface> surfaces;
 
-  /// \brief Joint entity that actuates a control surface for this lifting body
-  public: Entity controlJointEntity;
+  /// \brief Flow over each surface on the current step.
+  public: std::vector<LiftDragFlow> flows;
+
+  /// \brief Coefficients of each surface on the current step.
+  public: std::vector<CoefficientTable::Coefficients> coefficients;
+
+  /// \brief Coefficient tables loaded from files, shared by the surfaces
+  /// which use the same file.
+  public: std::unordered_map<std::string,
+              std::shared_ptr<const CoefficientTable>> tables;
 
   /// \brief Set during Load to true if the configuration for the system is
   /// valid and the post-update can run
@@ -136,39 +247,97 @@ class ignition::gazebo::systems::LiftDragPrivate
 
   /// \brief Initialization flag
   public: bool initialized{false};
+
+  /// \brief Stage which gathers the link kinematics and applies the wrench
+  public: std::shared_ptr<EnvironmentalForces> forces;
+
+  /// \brief Lift and drag model registered to the stage
+  public: EnvironmentalForces::ModelId forceModel{0};
 };
 
 //////////////////////////////////////////////////
-void LiftDragPrivate::Load(const EntityComponentManager &_ecm,
-                           const sdf::ElementPtr &_sdf)
+LiftDragPrivate::~LiftDragPrivate()
+{
+  if (this->forces)
+    this->forces->RemoveModel(this->forceModel);
+}
+
+//////////////////////////////////////////////////
+bool LiftDragPrivate::LoadParams(const sdf::ElementPtr &_sdf,
+                                 LiftDragSurface &_surface)
 {
-  this->cla = _sdf->Get<double>("cla", this->cla).first;
-  this->cda = _sdf->Get<double>("cda", this->cda).first;
-  this->cma = _sdf->Get<double>("cma", this->cma).first;
-  this->alphaStall = _sdf->Get<double>("alpha_stall", this->alphaStall).first;
-  this->claStall = _sdf->Get<double>("cla_stall", this->claStall).first;
-  this->cdaStall = _sdf->Get<double>("cda_stall", this->cdaStall).first;
-  this->cmaStall = _sdf->Get<double>("cma_stall", this->cmaStall).first;
-  this->rho = _sdf->Get<double>("air_density", this->rho).first;
-  this->radialSymmetry = _sdf->Get<bool>("radial_symmetry",
-      this->radialSymmetry).first;
-  this->area = _sdf->Get<double>("area", this->area).first;
-  this->alpha0 = _sdf->Get<double>("a0", this->alpha0).first;
-  this->cp = _sdf->Get<math::Vector3d>("cp", this->cp).first;
+  _surface.cla = _sdf->Get<double>("cla", _surface.cla).first;
+  _surface.cda = _sdf->Get<double>("cda", _surface.cda).first;
+  _surface.cma = _sdf->Get<double>("cma", _surface.cma).first;
+  _surface.alphaStall =
+      _sdf->Get<double>("alpha_stall", _surface.alphaStall).first;
+  _surface.claStall = _sdf->Get<double>("cla_stall", _surface.claStall).first;
+  _surface.cdaStall = _sdf->Get<double>("cda_stall", _surface.cdaStall).first;
+  _surface.cmaStall = _sdf->Get<double>("cma_stall", _surface.cmaStall).first;
+  _surface.rho = _sdf->Get<double>("air_density", _surface.rho).first;
+  _surface.speedOfSound =
+      _sdf->Get<double>("speed_of_sound", _surface.speedOfSound).first;
+  _surface.viscosity =
+      _sdf->Get<double>("air_viscosity", _surface.viscosity).first;
+  _surface.chord = _sdf->Get<double>("chord", _surface.chord).first;
+  _surface.radialSymmetry = _sdf->Get<bool>("radial_symmetry",
+      _surface.radialSymmetry).first;
+  _surface.area = _sdf->Get<double>("area", _surface.area).first;
+  _surface.alpha0 = _sdf->Get<double>("a0", _surface.alpha0).first;
+  _surface.cp = _sdf->Get<math::Vector3d>("cp", _surface.cp).first;
 
   // blade forward (-drag) direction in link frame
-  this->forward =
-      _sdf->Get<math::Vector3d>("forward", this->forward).first;
-  this->forward.Normalize();
+  _surface.forward =
+      _sdf->Get<math::Vector3d>("forward", _surface.forward).first;
+  _surface.forward.Normalize();
 
   // blade upward (+lift) direction in link frame
-  this->upward = _sdf->Get<math::Vector3d>(
-      "upward", this->upward) .first;
-  this->upward.Normalize();
+  _surface.upward = _sdf->Get<math::Vector3d>(
+      "upward", _surface.upward) .first;
+  _surface.upward.Normalize();
 
-  this->controlJointRadToCL = _sdf->Get<double>(
-      "control_joint_rad_to_cl", this->controlJointRadToCL).first;
+  _surface.controlJointRadToCL = _sdf->Get<double>(
+      "control_joint_rad_to_cl", _surface.controlJointRadToCL).first;
 
+  // Tabulated coefficients, either inline or from a file
+  if (_sdf->HasElement("coefficients"))
+  {
+    auto table = std::make_shared<CoefficientTable>();
+    if (!table->Parse(_sdf->Get<std::string>("coefficients")))
+    {
+      ignerr << "Invalid <coefficients>. "
+             << "The LiftDrag will not generate forces\n";
+      return false;
+    }
+    _surface.table = table;
+  }
+  else if (_sdf->HasElement("coefficients_uri"))
+  {
+    auto uri = _sdf->Get<std::string>("coefficients_uri");
+    auto path = common::findFile(asFullPath(uri, _sdf->FilePath()));
+    auto &table = this->tables[path];
+    if (!table)
+    {
+      auto loaded = std::make_shared<CoefficientTable>();
+      if (path.empty() || !loaded->Load(path))
+      {
+        this->tables.erase(path);
+        ignerr << "Failed to load <coefficients_uri> [" << uri << "]. "
+               << "The LiftDrag will not generate forces\n";
+        return false;
+      }
+      table = loaded;
+    }
+    _surface.table = table;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool LiftDragPrivate::LoadEntities(const EntityComponentManager &_ecm,
+                                   const sdf::ElementPtr &_sdf,
+                                   LiftDragSurface &_surface)
+{
   if (_sdf->HasElement("link_name"))
   {
     sdf::ElementPtr elem = _sdf->GetElement("link_name");
@@ -180,8 +349,7 @@ void LiftDragPrivate::Load(const EntityComponentManager &_ecm,
     {
       ignerr << "Link with name[" << linkName << "] not found. "
              << "The LiftDrag will not generate forces\n";
-      this->validConfig = false;
-      return;
+      return false;
     }
     else if (entities.size() > 1)
     {
@@ -189,21 +357,19 @@ void LiftDragPrivate::Load(const EntityComponentManager &_ecm,
              << "Using the first one.\n";
     }
 
-    this->linkEntity = *entities.begin();
-    if (!_ecm.EntityHasComponentType(this->linkEntity,
+    _surface.linkEntity = *entities.begin();
+    if (!_ecm.EntityHasComponentType(_surface.linkEntity,
                                      components::Link::typeId))
     {
-      this->linkEntity = kNullEntity;
+      _surface.linkEntity = kNullEntity;
       ignerr << "Entity with name[" << linkName << "] is not a link\n";
-      this->validConfig = false;
-      return;
+      return false;
     }
   }
   else
   {
     ignerr << "The LiftDrag system requires the 'link_name' parameter\n";
-    this->validConfig = false;
-    return;
+    return false;
   }
 
 
@@ -217,8 +383,7 @@ void LiftDragPrivate::Load(const EntityComponentManager &_ecm,
     {
       ignerr << "Joint with name[" << controlJointName << "] not found. "
              << "The LiftDrag will not generate forces\n";
-      this->validConfig = false;
-      return;
+      return false;
     }
     else if (entities.size() > 1)
     {
@@ -226,15 +391,47 @@ void LiftDragPrivate::Load(const EntityComponentManager &_ecm,
               << "] found. Using the first one.\n";
     }
 
-    this->controlJointEntity = *entities.begin();
-    if (!_ecm.EntityHasComponentType(this->controlJointEntity,
+    _surface.controlJointEntity = *entities.begin();
+    if (!_ecm.EntityHasComponentType(_surface.controlJointEntity,
                                      components::Joint::typeId))
     {
-      this->controlJointEntity = kNullEntity;
+      _surface.controlJointEntity = kNullEntity;
       ignerr << "Entity with name[" << controlJointName << "] is not a joint\n";
-      this->validConfig = false;
+      return false;
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+void LiftDragPrivate::Load(const EntityComponentManager &_ecm,
+                           const sdf::ElementPtr &_sdf)
+{
+  this->validConfig = false;
+
+  // Parameters outside of the surfaces apply to all of them
+  LiftDragSurface defaults;
+  if (!this->LoadParams(_sdf, defaults))
+    return;
+
+  if (!_sdf->HasElement("surface"))
+  {
+    if (!this->LoadEntities(_ecm, _sdf, defaults))
+      return;
+    this->surfaces.push_back(defaults);
+  }
+
+  for (auto elem = _sdf->FindElement("surface"); elem;
+       elem = elem->GetNextElement("surface"))
+  {
+    LiftDragSurface surface = defaults;
+    if (!this->LoadParams(elem, surface) ||
+        !this->LoadEntities(_ecm, elem, surface))
+    {
+      this->surfaces.clear();
       return;
     }
+    this->surfaces.push_back(surface);
   }
 
   // If we reached here, we have a valid configuration
@@ -248,41 +445,29 @@ LiftDrag::LiftDrag()
 }
 
 //////////////////////////////////////////////////
-void LiftDragPrivate::Update(EntityComponentManager &_ecm)
+LiftDragFlow LiftDragPrivate::ComputeFlow(const LiftDragSurface &_surface,
+                                          const LinkKinematics &_links)
 {
-  IGN_PROFILE("LiftDragPrivate::Update");
-  // get linear velocity at cp in world frame
-  const auto worldLinVel =
-      _ecm.Component<components::WorldLinearVelocity>(this->linkEntity);
-  const auto worldAngVel =
-      _ecm.Component<components::WorldAngularVelocity>(this->linkEntity);
-  const auto worldPose =
-      _ecm.Component<components::WorldPose>(this->linkEntity);
-
-  components::JointPosition *controlJointPosition = nullptr;
-  if (this->controlJointEntity != kNullEntity)
-  {
-    controlJointPosition =
-        _ecm.Component<components::JointPosition>(this->controlJointEntity);
-  }
+  LiftDragFlow flow;
+  if (!_links.valid[_surface.linkSlot])
+    return flow;
 
-  if (!worldLinVel || !worldAngVel || !worldPose)
-    return;
-
-  const auto &pose = worldPose->Data();
-  const auto cpWorld = pose.Rot().RotateVector(this->cp);
-  const auto vel = worldLinVel->Data() + worldAngVel->Data().Cross(cpWorld);
+  // get linear velocity at cp in world frame
+  const auto &pose = _links.worldPoses[_surface.linkSlot];
+  flow.cpWorld = pose.Rot().RotateVector(_surface.cp);
+  const auto vel = _links.linearVelocities[_surface.linkSlot] +
+      _links.angularVelocities[_surface.linkSlot].Cross(flow.cpWorld);
 
   if (vel.Length() <= 0.01)
-    return;
+    return flow;
 
   const auto velI = vel.Normalized();
 
   // rotate forward and upward vectors into world frame
-  const auto forwardI = pose.Rot().RotateVector(this->forward);
+  const auto forwardI = pose.Rot().RotateVector(_surface.forward);
 
   math::Vector3d upwardI;
-  if (this->radialSymmetry)
+  if (_surface.radialSymmetry)
   {
     // use inflow velocity to determine upward direction
     // which is the component of inflow perpendicular to forward direction.
@@ -291,27 +476,20 @@ void LiftDragPrivate::Update(EntityComponentManager &_ecm)
   }
   else
   {
-    upwardI = pose.Rot().RotateVector(this->upward);
+    upwardI = pose.Rot().RotateVector(_surface.upward);
   }
 
   // spanwiseI: a vector normal to lift-drag-plane described in world frame
-  const auto spanwiseI = forwardI.Cross(upwardI).Normalize();
+  flow.spanwiseI = forwardI.Cross(upwardI).Normalize();
 
   const double minRatio = -1.0;
   const double maxRatio = 1.0;
   // check sweep (angle between velI and lift-drag-plane)
   double sinSweepAngle = math::clamp(
-      spanwiseI.Dot(velI), minRatio, maxRatio);
+      flow.spanwiseI.Dot(velI), minRatio, maxRatio);
 
   // get cos from trig identity
-  const double cosSweepAngle = 1.0 - sinSweepAngle * sinSweepAngle;
-  double sweep = std::asin(sinSweepAngle);
-
-  // truncate sweep to within +/-90 deg
-  while (std::fabs(sweep) > 0.5 * IGN_PI)
-  {
-    sweep = sweep > 0 ? sweep - IGN_PI : sweep + IGN_PI;
-  }
+  flow.cosSweepAngle = 1.0 - sinSweepAngle * sinSweepAngle;
 
   // angle of attack is the angle between
   // velI projected into lift-drag plane
@@ -326,13 +504,13 @@ void LiftDragPrivate::Update(EntityComponentManager &_ecm)
   //    const auto velInLDPlane = vel - vel.Dot(spanwiseI)*velI;
   // I believe the projection should be onto spanwiseI which then gets removed
   // from vel
-  const auto velInLDPlane = vel - vel.Dot(spanwiseI)*spanwiseI;
+  const auto velInLDPlane = vel - vel.Dot(flow.spanwiseI)*flow.spanwiseI;
 
   // get direction of drag
-  const auto dragDirection = -velInLDPlane.Normalized();
+  flow.dragDirection = -velInLDPlane.Normalized();
 
   // get direction of lift
-  const auto liftI = spanwiseI.Cross(velInLDPlane).Normalized();
+  flow.liftI = flow.spanwiseI.Cross(velInLDPlane).Normalized();
 
   // compute angle between upwardI and liftI
   // in general, given vectors a and b:
@@ -340,159 +518,193 @@ void LiftDragPrivate::Update(EntityComponentManager &_ecm)
   // given upwardI and liftI are both unit vectors, we can drop the denominator
   //   cos(theta) = a.Dot(b)
   const double cosAlpha =
-      math::clamp(liftI.Dot(upwardI), minRatio, maxRatio);
+      math::clamp(flow.liftI.Dot(upwardI), minRatio, maxRatio);
 
   // Is alpha positive or negative? Test:
   // forwardI points toward zero alpha
   // if forwardI is in the same direction as lift, alpha is positive.
   // liftI is in the same direction as forwardI?
-  double alpha = this->alpha0 - std::acos(cosAlpha);
-  if (liftI.Dot(forwardI) >= 0.0)
-    alpha = this->alpha0 + std::acos(cosAlpha);
+  double alpha = _surface.alpha0 - std::acos(cosAlpha);
+  if (flow.liftI.Dot(forwardI) >= 0.0)
+    alpha = _surface.alpha0 + std::acos(cosAlpha);
 
   // normalize to within +/-90 deg
   while (fabs(alpha) > 0.5 * IGN_PI)
   {
     alpha = alpha > 0 ? alpha - IGN_PI : alpha + IGN_PI;
   }
+  flow.alpha = alpha;
 
   // compute dynamic pressure
-  const double speedInLDPlane = velInLDPlane.Length();
-  const double q = 0.5 * this->rho * speedInLDPlane * speedInLDPlane;
+  flow.speed = velInLDPlane.Length();
+  flow.q = 0.5 * _surface.rho * flow.speed * flow.speed;
+  flow.valid = true;
+  return flow;
+}
 
-  // compute cl at cp, check for stall, correct for sweep
-  double cl;
-  if (alpha > this->alphaStall)
+//////////////////////////////////////////////////
+CoefficientTable::Coefficients LiftDragPrivate::AnalyticCoefficients(
+    const LiftDragSurface &_surface, double _alpha)
+{
+  CoefficientTable::Coefficients c;
+
+  // compute cl at cp, check for stall
+  if (_alpha > _surface.alphaStall)
   {
-    cl = (this->cla * this->alphaStall +
-          this->claStall * (alpha - this->alphaStall)) *
-         cosSweepAngle;
+    c.cl = _surface.cla * _surface.alphaStall +
+          _surface.claStall * (_alpha - _surface.alphaStall);
     // make sure cl is still great than 0
-    cl = std::max(0.0, cl);
+    c.cl = std::max(0.0, c.cl);
   }
-  else if (alpha < -this->alphaStall)
+  else if (_alpha < -_surface.alphaStall)
   {
-    cl = (-this->cla * this->alphaStall +
-          this->claStall * (alpha + this->alphaStall))
-         * cosSweepAngle;
+    c.cl = -_surface.cla * _surface.alphaStall +
+          _surface.claStall * (_alpha + _surface.alphaStall);
     // make sure cl is still less than 0
-    cl = std::min(0.0, cl);
+    c.cl = std::min(0.0, c.cl);
   }
   else
-    cl = this->cla * alpha * cosSweepAngle;
+    c.cl = _surface.cla * _alpha;
 
-  // modify cl per control joint value
-  if (controlJointPosition && !controlJointPosition->Data().empty())
+  // compute cd at cp, check for stall
+  if (_alpha > _surface.alphaStall)
   {
-    cl = cl + this->controlJointRadToCL * controlJointPosition->Data()[0];
-    /// \todo(anyone): also change cm and cd
+    c.cd = _surface.cda * _surface.alphaStall +
+          _surface.cdaStall * (_alpha - _surface.alphaStall);
   }
-
-  // compute lift force at cp
-  math::Vector3d lift = cl * q * this->area * liftI;
-
-  // compute cd at cp, check for stall, correct for sweep
-  double cd;
-  if (alpha > this->alphaStall)
+  else if (_alpha < -_surface.alphaStall)
   {
-    cd = (this->cda * this->alphaStall +
-          this->cdaStall * (alpha - this->alphaStall))
-         * cosSweepAngle;
-  }
-  else if (alpha < -this->alphaStall)
-  {
-    cd = (-this->cda * this->alphaStall +
-          this->cdaStall * (alpha + this->alphaStall))
-         * cosSweepAngle;
+    c.cd = -_surface.cda * _surface.alphaStall +
+          _surface.cdaStall * (_alpha + _surface.alphaStall);
   }
   else
-    cd = (this->cda * alpha) * cosSweepAngle;
-
-  // make sure drag is positive
-  cd = std::fabs(cd);
+    c.cd = _surface.cda * _alpha;
 
-  // drag at cp
-  math::Vector3d drag = cd * q * this->area * dragDirection;
-
-  // compute cm at cp, check for stall, correct for sweep
-  double cm;
-  if (alpha > this->alphaStall)
+  // compute cm at cp, check for stall
+  if (_alpha > _surface.alphaStall)
   {
-    cm = (this->cma * this->alphaStall +
-          this->cmaStall * (alpha - this->alphaStall))
-         * cosSweepAngle;
+    c.cm = _surface.cma * _surface.alphaStall +
+          _surface.cmaStall * (_alpha - _surface.alphaStall);
     // make sure cm is still great than 0
-    cm = std::max(0.0, cm);
+    c.cm = std::max(0.0, c.cm);
   }
-  else if (alpha < -this->alphaStall)
+  else if (_alpha < -_surface.alphaStall)
   {
-    cm = (-this->cma * this->alphaStall +
-          this->cmaStall * (alpha + this->alphaStall))
-         * cosSweepAngle;
+    c.cm = -_surface.cma * _surface.alphaStall +
+          _surface.cmaStall * (_alpha + _surface.alphaStall);
     // make sure cm is still less than 0
-    cm = std::min(0.0, cm);
+    c.cm = std::min(0.0, c.cm);
   }
   else
-    cm = this->cma * alpha * cosSweepAngle;
+    c.cm = _surface.cma * _alpha;
 
   /// \todo(anyone): implement cm
   /// for now, reset cm to zero, as cm needs testing
-  cm = 0.0;
-
-  // compute moment (torque) at cp
-  // spanwiseI used to be momentDirection
-  math::Vector3d moment = cm * q * this->area * spanwiseI;
-
-
-  // force and torque about cg in world frame
-  math::Vector3d force = lift + drag;
-  math::Vector3d torque = moment;
-  // Correct for nan or inf
-  force.Correct();
-  this->cp.Correct();
-  torque.Correct();
-
-  // We want to apply the force at cp. The old LiftDrag plugin did the
-  // following:
-  //     this->link->AddForceAtRelativePosition(force, this->cp);
-  // The documentation of AddForceAtRelativePosition says:
-  //> Add a force (in world frame coordinates) to the body at a
-  //> position relative to the center of mass which is expressed in the
-  //> link's own frame of reference.
-  // But it appears that 'cp' is specified in the link frame so it probably
-  // should have been
-  //     this->link->AddForceAtRelativePosition(
-  //         force, this->cp - this->link->GetInertial()->CoG());
-  //
-  // \todo(addisu) Create a convenient API for applying forces at offset
-  // positions
-  const auto totalTorque = torque + cpWorld.Cross(force);
-  Link link(this->linkEntity);
-  link.AddWorldWrench(_ecm, force, totalTorque);
-
-  // Debug
-  // auto linkName = _ecm.Component<components::Name>(this->linkEntity)->Data();
-  // igndbg << "=============================\n";
-  // igndbg << "Link: [" << linkName << "] pose: [" << pose
-  //        << "] dynamic pressure: [" << q << "]\n";
-  // igndbg << "spd: [" << vel.Length() << "] vel: [" << vel << "]\n";
-  // igndbg << "LD plane spd: [" << velInLDPlane.Length() << "] vel : ["
-  //        << velInLDPlane << "]\n";
-  // igndbg << "forward (inertial): " << forwardI << "\n";
-  // igndbg << "upward (inertial): " << upwardI << "\n";
-  // igndbg << "q: " << q << "\n";
-  // igndbg << "cl: " << cl << "\n";
-  // igndbg << "lift dir (inertial): " << liftI << "\n";
-  // igndbg << "Span direction (normal to LD plane): " << spanwiseI << "\n";
-  // igndbg << "sweep: " << sweep << "\n";
-  // igndbg << "alpha: " << alpha << "\n";
-  // igndbg << "lift: " << lift << "\n";
-  // igndbg << "drag: " << drag << " cd: " << cd << " cda: "
-  //        << this->cda << "\n";
-  // igndbg << "moment: " << moment << "\n";
-  // igndbg << "force: " << force << "\n";
-  // igndbg << "torque: " << torque << "\n";
-  // igndbg << "totalTorque: " << totalTorque << "\n";
+  c.cm = 0.0;
+
+  return c;
+}
+
+//////////////////////////////////////////////////
+void LiftDragPrivate::Update(const EntityComponentManager &_ecm,
+                             LinkKinematics &_links)
+{
+  IGN_PROFILE("LiftDragPrivate::Update");
+  const std::size_t n = this->surfaces.size();
+
+  // Flow over all surfaces
+  this->flows.resize(n);
+  for (std::size_t i = 0; i < n; ++i)
+    this->flows[i] = ComputeFlow(this->surfaces[i], _links);
+
+  // Coefficients of all surfaces, from their tables or the analytic model
+  this->coefficients.resize(n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const auto &surface = this->surfaces[i];
+    const auto &flow = this->flows[i];
+    if (!flow.valid)
+      continue;
+
+    if (surface.table)
+    {
+      const double mach = flow.speed / surface.speedOfSound;
+      const double reynolds =
+          surface.rho * flow.speed * surface.chord / surface.viscosity;
+      this->coefficients[i] = surface.table->Lookup(flow.alpha, mach,
+          reynolds);
+    }
+    else
+    {
+      this->coefficients[i] = AnalyticCoefficients(surface, flow.alpha);
+    }
+  }
+
+  // Forces of all surfaces
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const auto &surface = this->surfaces[i];
+    const auto &flow = this->flows[i];
+    if (!flow.valid)
+      continue;
+
+    // correct for sweep
+    const auto &c = this->coefficients[i];
+    double cl = c.cl * flow.cosSweepAngle;
+    // make sure drag is positive
+    const double cd = std::fabs(c.cd * flow.cosSweepAngle);
+    const double cm = c.cm * flow.cosSweepAngle;
+
+    // modify cl per control joint value
+    if (surface.controlJointEntity != kNullEntity)
+    {
+      auto controlJointPosition =
+          _ecm.Component<components::JointPosition>(
+          surface.controlJointEntity);
+      if (controlJointPosition && !controlJointPosition->Data().empty())
+      {
+        cl = cl + surface.controlJointRadToCL *
+            controlJointPosition->Data()[0];
+        /// \todo(anyone): also change cm and cd
+      }
+    }
+
+    // compute lift force at cp
+    math::Vector3d lift = cl * flow.q * surface.area * flow.liftI;
+
+    // drag at cp
+    math::Vector3d drag = cd * flow.q * surface.area * flow.dragDirection;
+
+    // compute moment (torque) at cp
+    // spanwiseI used to be momentDirection
+    math::Vector3d moment = cm * flow.q * surface.area * flow.spanwiseI;
+
+    // force and torque about cg in world frame
+    math::Vector3d force = lift + drag;
+    math::Vector3d torque = moment;
+    // Correct for nan or inf
+    force.Correct();
+    math::Vector3d cpWorld = flow.cpWorld;
+    cpWorld.Correct();
+    torque.Correct();
+
+    // We want to apply the force at cp. The old LiftDrag plugin did the
+    // following:
+    //     this->link->AddForceAtRelativePosition(force, this->cp);
+    // The documentation of AddForceAtRelativePosition says:
+    //> Add a force (in world frame coordinates) to the body at a
+    //> position relative to the center of mass which is expressed in the
+    //> link's own frame of reference.
+    // But it appears that 'cp' is specified in the link frame so it probably
+    // should have been
+    //     this->link->AddForceAtRelativePosition(
+    //         force, this->cp - this->link->GetInertial()->CoG());
+    //
+    // \todo(addisu) Create a convenient API for applying forces at offset
+    // positions
+    const auto totalTorque = torque + cpWorld.Cross(force);
+    _links.AddWorldWrench(surface.linkSlot, force, totalTorque);
+  }
 }
 
 //////////////////////////////////////////////////
@@ -533,16 +745,26 @@ void LiftDrag::PreUpdate(const UpdateInfo &_info, EntityComponentManager &_ecm)
 
     if (this->dataPtr->validConfig)
     {
-      Link link(this->dataPtr->linkEntity);
-      link.EnableVelocityChecks(_ecm, true);
-
-      if ((this->dataPtr->controlJointEntity != kNullEntity) &&
-          !_ecm.Component<components::JointPosition>(
-              this->dataPtr->controlJointEntity))
+      this->dataPtr->forces = EnvironmentalForces::For(_ecm);
+      for (auto &surface : this->dataPtr->surfaces)
       {
-        _ecm.CreateComponent(this->dataPtr->controlJointEntity,
-            components::JointPosition());
+        surface.linkSlot =
+            this->dataPtr->forces->AddLink(_ecm, surface.linkEntity);
+
+        if ((surface.controlJointEntity != kNullEntity) &&
+            !_ecm.Component<components::JointPosition>(
+                surface.controlJointEntity))
+        {
+          _ecm.CreateComponent(surface.controlJointEntity,
+              components::JointPosition());
+        }
       }
+      this->dataPtr->forceModel = this->dataPtr->forces->AddModel(
+          [this](const UpdateInfo &, const EntityComponentManager &_stageEcm,
+                 LinkKinematics &_links)
+          {
+            this->dataPtr->Update(_stageEcm, _links);
+          }, this->dataPtr->model.Entity());
     }
   }
 
@@ -553,7 +775,7 @@ void LiftDrag::PreUpdate(const UpdateInfo &_info, EntityComponentManager &_ecm)
   // above
   if (this->dataPtr->initialized && this->dataPtr->validConfig)
   {
-    this->dataPtr->Update(_ecm);
+    this->dataPtr->forces->Update(_info, _ecm, this->dataPtr->forceModel);
   }
 }
 
@@ -63,6 +63,26 @@ namespace systems
   ///               stall.
   /// control_joint_name: Name of joint that actuates a control surface for this
   ///                     lifting body (Optional)
+  /// coefficients: Tabulated coefficients in CSV format, which replace the
+  ///               analytic model above (Optional). The columns are alpha,
+  ///               cl, cd and optionally mach, reynolds and cm. See
+  ///               CoefficientTable for details. The sweep correction and
+  ///               the control joint still apply.
+  /// coefficients_uri: Path to a CSV file with tabulated coefficients, as
+  ///                   above (Optional). Surfaces which use the same file
+  ///                   share the table.
+  /// speed_of_sound: Speed of sound in the fluid, used for the Mach number
+  ///                 of tabulated coefficients. Defaults to 343 m/s.
+  /// air_viscosity: Dynamic viscosity of the fluid, used for the Reynolds
+  ///                number of tabulated coefficients. Defaults to
+  ///                1.81e-5 Pa s.
+  /// chord       : Chord length, used for the Reynolds number of tabulated
+  ///               coefficients. Defaults to 1 m.
+  /// surface     : A lifting surface (Optional, may be repeated). Each
+  ///               surface takes all of the parameters above, and parameters
+  ///               outside of the surfaces apply to all of them. All surfaces
+  ///               of a vehicle can be described by a single plugin this way,
+  ///               so that they are evaluated together.
   class LiftDrag
       : public System,
         public ISystemConfigure,
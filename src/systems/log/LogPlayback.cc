@@ -19,7 +19,10 @@
 
 #include <ignition/msgs/log_playback_stats.pb.h>
 
+#include <algorithm>
+#include <chrono>
 #include <set>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 
@@ -29,6 +32,7 @@
 #include <ignition/math/Pose3.hh>
 #include <ignition/msgs/Utility.hh>
 #include <ignition/plugin/RegisterMore.hh>
+#include <ignition/transport/log/Descriptor.hh>
 #include <ignition/transport/log/QueryOptions.hh>
 #include <ignition/transport/log/Log.hh>
 #include <ignition/transport/log/Message.hh>
@@ -40,17 +44,126 @@
 #include "ignition/gazebo/Conversions.hh"
 #include "ignition/gazebo/Events.hh"
 #include "ignition/gazebo/SdfEntityCreator.hh"
+#include "ignition/gazebo/components/BoundingBoxCamera.hh"
+#include "ignition/gazebo/components/Camera.hh"
+#include "ignition/gazebo/components/DepthCamera.hh"
 #include "ignition/gazebo/components/Geometry.hh"
+#include "ignition/gazebo/components/GpuLidar.hh"
 #include "ignition/gazebo/components/LogPlaybackStatistics.hh"
 #include "ignition/gazebo/components/Material.hh"
 #include "ignition/gazebo/components/ParticleEmitter.hh"
 #include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/RgbdCamera.hh"
+#include "ignition/gazebo/components/SegmentationCamera.hh"
+#include "ignition/gazebo/components/ThermalCamera.hh"
 #include "ignition/gazebo/components/World.hh"
 
+#include "ResourceStore.hh"
+
 using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+/// \brief Reads the messages of a log in time order, through a sequence of
+/// queries which each cover a bounded window of sim time. A single query
+/// over a long log can make SQLite hold on to, and sort, a large part of it;
+/// with windows, the memory used only depends on how much was recorded
+/// within one window.
+class LogCursor
+{
+  /// \brief Start reading from a given time.
+  /// \param[in] _log Log to read. It must outlive the cursor.
+  /// \param[in] _start First message to read is the first one received at
+  /// or after this time.
+  /// \param[in] _window Sim time covered by each query.
+  public: void Reset(const transport::log::Log *_log,
+              std::chrono::steady_clock::duration _start,
+              std::chrono::steady_clock::duration _window)
+  {
+    // Let go of the old batch's statement before replacing it
+    this->iter = transport::log::Batch::iterator();
+    this->batch = transport::log::Batch();
+    this->log = _log;
+    this->windowEnd = _start;
+    this->window = std::max(_window, std::chrono::steady_clock::duration(1));
+    this->open = false;
+    this->advance = false;
+  }
+
+  /// \brief Move to the next message.
+  /// \param[in] _until Only move to messages received up to this time.
+  /// \return True if there is such a message, which is now available
+  /// through Message().
+  public: bool Next(std::chrono::steady_clock::duration _until)
+  {
+    if (nullptr == this->log)
+      return false;
+
+    if (this->advance)
+    {
+      ++this->iter;
+      this->advance = false;
+    }
+
+    while (!this->open || this->iter == this->batch.end())
+    {
+      // All messages up to _until have been read once the window reaches
+      // past it
+      if (this->open && (this->windowEnd > _until ||
+          this->windowEnd > this->log->EndTime()))
+      {
+        return false;
+      }
+
+      const auto begin = this->windowEnd;
+      this->windowEnd = begin + this->window;
+      this->iter = transport::log::Batch::iterator();
+      this->batch = this->log->QueryMessages(transport::log::AllTopics(
+          transport::log::QualifiedTimeRange(
+          transport::log::QualifiedTime(begin),
+          transport::log::QualifiedTime(this->windowEnd,
+          transport::log::QualifiedTime::Qualifier::EXCLUSIVE))));
+      this->iter = this->batch.begin();
+      this->open = true;
+    }
+
+    if (this->iter->TimeReceived() > _until)
+      return false;
+
+    this->advance = true;
+    return true;
+  }
+
+  /// \brief Current message. Only valid after Next returned true.
+  /// \return The message.
+  public: const transport::log::Message &Message() const
+  {
+    return *this->iter;
+  }
+
+  /// \brief Log being read.
+  private: const transport::log::Log *log{nullptr};
+
+  /// \brief Messages of the current window.
+  private: transport::log::Batch batch;
+
+  /// \brief Current message in the batch.
+  private: transport::log::Batch::iterator iter;
+
+  /// \brief End of the current window, exclusive.
+  private: std::chrono::steady_clock::duration windowEnd{0};
+
+  /// \brief Sim time covered by each window.
+  private: std::chrono::steady_clock::duration window{std::chrono::seconds(1)};
+
+  /// \brief Whether a window has been queried since the last reset.
+  private: bool open{false};
+
+  /// \brief Whether the current message was handed out already, so the
+  /// iterator must move before handing out the next one.
+  private: bool advance{false};
+};
+
 /// \brief Private LogPlayback data class.
 class ignition::gazebo::systems::LogPlaybackPrivate
 {
@@ -85,8 +198,85 @@ class ignition::gazebo::systems::LogPlaybackPrivate
   public: void Parse(EntityComponentManager &_ecm,
       const msgs::SerializedStateMap &_msg);
 
-  /// \brief A batch of data from log file, of all pose messages
-  public: transport::log::Batch batch;
+  /// \brief Merge a state update into the pending updates, so that the
+  /// latest data of each component wins.
+  /// \param[in] _msg State update.
+  public: void Accumulate(const msgs::SerializedStateMap &_msg);
+
+  /// \brief Apply pending state updates to the ECM in one go.
+  /// \param[in] _ecm Mutable ECM.
+  /// \return True if anything was applied.
+  public: bool ApplyPending(EntityComponentManager &_ecm);
+
+  /// \brief Whether any rendering sensor is due to generate data within a
+  /// time range.
+  /// \param[in] _ecm ECM holding the sensors.
+  /// \param[in] _start Start of the range, exclusive.
+  /// \param[in] _end End of the range, inclusive.
+  /// \return True if a rendering sensor will update in the range.
+  public: bool RenderingSensorDue(const EntityComponentManager &_ecm,
+      std::chrono::steady_clock::duration _start,
+      std::chrono::steady_clock::duration _end) const;
+
+  /// \brief Find the latest keyframe recorded at or before a given time.
+  /// \param[in] _time Sim time to look back from.
+  /// \param[out] _msg The keyframe.
+  /// \param[out] _keyframeTime Time at which the keyframe was recorded.
+  /// \return True if a keyframe was found.
+  public: bool FindKeyframe(std::chrono::steady_clock::duration _time,
+      msgs::SerializedStateMap &_msg,
+      std::chrono::steady_clock::duration &_keyframeTime) const;
+
+  /// \brief Decode a message into a reused buffer, keeping track of
+  /// decode throughput.
+  /// \param[in] _data Serialized message.
+  /// \param[out] _msg Decoded message.
+  /// \return True if successful.
+  public: bool Decode(const std::string &_data,
+      google::protobuf::Message &_msg);
+
+  /// \brief Print decode throughput, at most every few seconds unless
+  /// forced.
+  /// \param[in] _force True to print regardless of when it was last
+  /// printed.
+  public: void ReportThroughput(bool _force);
+
+  /// \brief Reads messages from the log. It's only reset when seeking, so
+  /// stepping forward through the log doesn't run a new query every
+  /// iteration.
+  public: LogCursor cursor;
+
+  /// \brief Whether the cursor has been positioned.
+  public: bool cursorValid{false};
+
+  /// \brief Sim time covered by each query of the cursor.
+  public: std::chrono::steady_clock::duration readWindow{
+      std::chrono::seconds(1)};
+
+  /// \brief Sim time up to which messages have been played.
+  public: std::chrono::steady_clock::duration playedUntil{0};
+
+  /// \brief Reused buffer for decoded state messages, so memory doesn't
+  /// grow with the number of messages played in one step.
+  public: msgs::SerializedStateMap stateMap;
+
+  /// \brief Reused buffer for legacy state messages.
+  public: msgs::SerializedState legacyState;
+
+  /// \brief Number of messages decoded since throughput was last printed.
+  public: uint64_t decodedMessages{0u};
+
+  /// \brief Number of bytes decoded since throughput was last printed.
+  public: uint64_t decodedBytes{0u};
+
+  /// \brief Wall time spent decoding since throughput was last printed.
+  public: std::chrono::steady_clock::duration decodeTime{0};
+
+  /// \brief Wall time throughput was last printed.
+  public: std::chrono::steady_clock::time_point lastReportTime;
+
+  /// \brief Topic holding keyframes, empty if the log doesn't have any.
+  public: std::string keyframeTopic;
 
   /// \brief Pointer to ign-transport Log
   public: std::unique_ptr<transport::log::Log> log;
@@ -113,6 +303,28 @@ class ignition::gazebo::systems::LogPlaybackPrivate
   /// plugin versions that did not record resources. False for older log files.
   public: bool doReplaceResourceURIs{true};
 
+  /// \brief Resources of the log which were recorded to a resource store.
+  /// Empty if they were copied into the log directory.
+  public: ResourceManifest resources;
+
+  /// \brief Resource store to use instead of the one the log was recorded
+  /// with, for example if it was moved to another machine.
+  public: std::string resourceStorePath;
+
+  /// \brief Store holding the recorded resources, null if the log doesn't
+  /// have a resource manifest.
+  public: std::unique_ptr<ResourceStore> resourceStore;
+
+  /// \brief Only apply recorded state on steps where a rendering sensor
+  /// is due, for fast regeneration of sensor data.
+  public: bool batchToSensors{false};
+
+  /// \brief State updates accumulated since they were last applied.
+  public: msgs::SerializedStateMap pending;
+
+  /// \brief Whether there are pending state updates.
+  public: bool hasPending{false};
+
   // \brief Saves which particle emitter emitting components have changed
   public: std::unordered_map<Entity, bool> prevParticleEmitterCmds;
 };
@@ -150,6 +362,165 @@ void LogPlaybackPrivate::Parse(EntityComponentManager &_ecm,
   _ecm.SetState(_msg);
 }
 
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::Accumulate(const msgs::SerializedStateMap &_msg)
+{
+  for (const auto &entIt : _msg.entities())
+  {
+    auto &entity = (*this->pending.mutable_entities())[entIt.first];
+
+    // Removals and creations replace whatever was pending for the entity
+    if (entIt.second.remove() || entity.remove())
+    {
+      entity = entIt.second;
+      continue;
+    }
+
+    entity.set_id(entIt.second.id());
+    for (const auto &compIt : entIt.second.components())
+      (*entity.mutable_components())[compIt.first] = compIt.second;
+  }
+  this->hasPending = true;
+}
+
+//////////////////////////////////////////////////
+bool LogPlaybackPrivate::ApplyPending(EntityComponentManager &_ecm)
+{
+  if (!this->hasPending)
+    return false;
+
+  IGN_PROFILE("LogPlayback::ApplyPending");
+  this->Parse(_ecm, this->pending);
+  this->pending.Clear();
+  this->hasPending = false;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool LogPlaybackPrivate::Decode(const std::string &_data,
+    google::protobuf::Message &_msg)
+{
+  const auto start = std::chrono::steady_clock::now();
+  const bool result = _msg.ParseFromString(_data);
+  this->decodeTime += std::chrono::steady_clock::now() - start;
+  ++this->decodedMessages;
+  this->decodedBytes += _data.size();
+
+  if (!result)
+    ignerr << "Failed to decode [" << _msg.GetTypeName() << "]" << std::endl;
+  return result;
+}
+
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::ReportThroughput(bool _force)
+{
+  const auto now = std::chrono::steady_clock::now();
+  if (this->decodedMessages == 0u ||
+      (!_force && now - this->lastReportTime < std::chrono::seconds(10)))
+  {
+    return;
+  }
+
+  const double seconds =
+      std::chrono::duration<double>(this->decodeTime).count();
+  std::stringstream stream;
+  stream << "Decoded [" << this->decodedMessages << "] messages, ["
+         << this->decodedBytes << "] bytes";
+  if (seconds > 0.0)
+  {
+    stream << ", at [" << this->decodedBytes / seconds / 1e6 << "] MB/s";
+  }
+  if (_force)
+    ignmsg << stream.str() << "." << std::endl;
+  else
+    igndbg << stream.str() << "." << std::endl;
+
+  this->decodedMessages = 0u;
+  this->decodedBytes = 0u;
+  this->decodeTime = std::chrono::steady_clock::duration::zero();
+  this->lastReportTime = now;
+}
+
+//////////////////////////////////////////////////
+bool LogPlaybackPrivate::RenderingSensorDue(
+    const EntityComponentManager &_ecm,
+    std::chrono::steady_clock::duration _start,
+    std::chrono::steady_clock::duration _end) const
+{
+  bool due{false};
+  auto check = [&](const Entity &, const auto *_sensor) -> bool
+  {
+    const double rate = _sensor->Data().UpdateRate();
+
+    // Same schedule as ignition::sensors::Sensor, which updates on
+    // multiples of its period truncated to milliseconds, and on every step
+    // if it has no rate.
+    const auto period = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::duration<double, std::milli>(
+        rate > 0.0 ? 1000.0 / rate : 0.0));
+    if (period <= std::chrono::milliseconds::zero() ||
+        _start <= std::chrono::steady_clock::duration::zero() ||
+        _end / period != _start / period)
+    {
+      due = true;
+    }
+    return !due;
+  };
+
+  _ecm.Each<components::Camera>(check);
+  if (!due)
+    _ecm.Each<components::DepthCamera>(check);
+  if (!due)
+    _ecm.Each<components::GpuLidar>(check);
+  if (!due)
+    _ecm.Each<components::RgbdCamera>(check);
+  if (!due)
+    _ecm.Each<components::ThermalCamera>(check);
+  if (!due)
+    _ecm.Each<components::SegmentationCamera>(check);
+  if (!due)
+    _ecm.Each<components::BoundingBoxCamera>(check);
+  return due;
+}
+
+//////////////////////////////////////////////////
+bool LogPlaybackPrivate::FindKeyframe(
+    std::chrono::steady_clock::duration _time,
+    msgs::SerializedStateMap &_msg,
+    std::chrono::steady_clock::duration &_keyframeTime) const
+{
+  if (this->keyframeTopic.empty())
+    return false;
+
+  IGN_PROFILE("LogPlayback::FindKeyframe");
+
+  // Keyframes are usually recorded periodically, so look back over growing
+  // windows instead of loading every keyframe in the log
+  std::string data;
+  for (std::chrono::steady_clock::duration window = std::chrono::seconds(1);;
+       window *= 2)
+  {
+    auto begin = _time > window ?
+        _time - window : std::chrono::steady_clock::duration::zero();
+
+    auto keyframes = this->log->QueryMessages(
+        transport::log::TopicList(this->keyframeTopic, {begin, _time}));
+    for (const auto &keyframe : keyframes)
+    {
+      data = keyframe.Data();
+      _keyframeTime = keyframe.TimeReceived();
+    }
+
+    if (!data.empty() ||
+        begin == std::chrono::steady_clock::duration::zero())
+    {
+      break;
+    }
+  }
+
+  return !data.empty() && _msg.ParseFromString(data);
+}
+
 //////////////////////////////////////////////////
 void LogPlayback::Configure(const Entity &,
     const std::shared_ptr<const sdf::Element> &_sdf,
@@ -160,6 +531,20 @@ void LogPlayback::Configure(const Entity &,
 
   this->dataPtr->eventManager = &_eventMgr;
 
+  this->dataPtr->batchToSensors = _sdf->Get<bool>("batch_to_sensors",
+      this->dataPtr->batchToSensors).first;
+
+  this->dataPtr->resourceStorePath =
+      _sdf->Get<std::string>("resource_store", "").first;
+
+  const auto readWindow = _sdf->Get<double>("read_window", 1.0).first;
+  if (readWindow > 0.0)
+  {
+    this->dataPtr->readWindow =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(readWindow));
+  }
+
   // Prepend working directory if path is relative
   this->dataPtr->logPath = common::absPath(this->dataPtr->logPath);
 
@@ -223,36 +608,76 @@ bool LogPlaybackPrivate::Start(EntityComponentManager &_ecm)
     ignerr << "Failed to open log file [" << dbPath << "]" << std::endl;
   }
 
-  // Access all messages in .tlog file
-  this->batch = this->log->QueryMessages();
-  auto iter = this->batch.begin();
+  // Resources recorded to a shared store are looked up by their original
+  // path
+  const auto manifestPath =
+      common::joinPaths(this->logPath, "resources.manifest");
+  if (common::exists(manifestPath))
+  {
+    if (this->resources.Load(manifestPath))
+    {
+      const auto storePath = this->resourceStorePath.empty() ?
+          this->resources.store : common::absPath(this->resourceStorePath);
+      this->resourceStore = std::make_unique<ResourceStore>(storePath);
+      igndbg << "Loading [" << this->resources.files.size()
+             << "] resources from store [" << storePath << "]" << std::endl;
+    }
+    else
+    {
+      ignerr << "Failed to load resource manifest [" << manifestPath << "]"
+             << std::endl;
+    }
+  }
 
-  if (iter == this->batch.end())
+  // Logs recorded with keyframes allow seeking without replaying from the
+  // beginning
+  if (this->log->Descriptor())
   {
-    ignerr << "No messages found in log file [" << dbPath << "]" << std::endl;
+    for (const auto &topic : this->log->Descriptor()->TopicsToMsgTypesToId())
+    {
+      const std::string suffix{"/keyframe_state"};
+      if (topic.first.size() >= suffix.size() &&
+          topic.first.compare(topic.first.size() - suffix.size(),
+          suffix.size(), suffix) == 0)
+      {
+        this->keyframeTopic = topic.first;
+        igndbg << "Seeking with keyframes from topic [" << topic.first
+               << "]" << std::endl;
+        break;
+      }
+    }
   }
 
   // Look for the first SerializedState message and use it to set the initial
   // state of the world. Messages received before this are ignored.
-  for (; iter != this->batch.end(); ++iter)
+  this->lastReportTime = std::chrono::steady_clock::now();
+  this->cursor.Reset(this->log.get(), std::chrono::steady_clock::duration(0),
+      this->readWindow);
+  bool found{false};
+  while (this->cursor.Next(this->log->EndTime()))
   {
-    auto msgType = iter->Type();
+    found = true;
+    const auto &message = this->cursor.Message();
+    auto msgType = message.Type();
     if (msgType == "ignition.msgs.SerializedState")
     {
-      msgs::SerializedState msg;
-      msg.ParseFromString(iter->Data());
-      this->Parse(_ecm, msg);
+      if (this->Decode(message.Data(), this->legacyState))
+        this->Parse(_ecm, this->legacyState);
       break;
     }
     else if (msgType == "ignition.msgs.SerializedStateMap")
     {
-      msgs::SerializedStateMap msg;
-      msg.ParseFromString(iter->Data());
-      this->Parse(_ecm, msg);
+      if (this->Decode(message.Data(), this->stateMap))
+        this->Parse(_ecm, this->stateMap);
       break;
     }
   }
 
+  if (!found)
+  {
+    ignerr << "No messages found in log file [" << dbPath << "]" << std::endl;
+  }
+
   msgs::LogPlaybackStatistics logStats;
   auto startTime = convert<msgs::Time>(this->log->StartTime());
   auto endTime = convert<msgs::Time>(this->log->EndTime());
@@ -377,6 +802,30 @@ std::string LogPlaybackPrivate::PrependLogPath(const std::string &_uri)
 
   const std::string filePrefix = "file://";
 
+  if (this->resourceStore)
+  {
+    std::string path = _uri;
+    if (path.compare(0, filePrefix.length(), filePrefix) == 0)
+      path = path.substr(filePrefix.length());
+
+    // Already replaced
+    const auto &storeRoot = this->resourceStore->Root();
+    if (path.compare(0, storeRoot.length(), storeRoot) == 0)
+      return std::string(_uri);
+
+    auto it = this->resources.files.find(path);
+    if (it != this->resources.files.end())
+    {
+      const auto storePath = this->resourceStore->Path(it->second);
+      if (common::exists(storePath))
+        return filePrefix + storePath;
+
+      ignerr << "Resource [" << path << "] is missing from store ["
+             << storeRoot << "]" << std::endl;
+    }
+    return std::string(_uri);
+  }
+
   // Prepend if path starts with file:// or /, but recorded path has not
   // already been prepended.
   if (((_uri.compare(0, filePrefix.length(), filePrefix) == 0) &&
@@ -459,21 +908,50 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
   // Get all messages from this timestep
   // TODO(anyone) Jumping forward can be expensive for long jumps. For now,
   // just playing every single step so we don't miss insertions and deletions.
-  auto startTime = _info.simTime - _info.dt;
+  const auto stepStart = _info.simTime - _info.dt;
+  auto startTime = stepStart;
   auto endTime = _info.simTime;
 
   bool seekRewind = false;
   std::set<Entity> entitiesToRemove;
-  if (_info.dt < std::chrono::steady_clock::duration::zero())
+
+  // When jumping back in time, or far enough forward that a keyframe was
+  // recorded in between, start from the latest keyframe and roll forward.
+  // Keyframes hold the absolute state, so every entity which isn't in it
+  // must be removed.
+  if (_info.dt < std::chrono::steady_clock::duration::zero() ||
+      _info.dt > std::chrono::seconds(1))
   {
-    // Detected jumping back in time. This can be expensive.
+    msgs::SerializedStateMap keyframe;
+    std::chrono::steady_clock::duration keyframeTime{0};
+    if (this->dataPtr->FindKeyframe(endTime, keyframe, keyframeTime) &&
+        (_info.dt < std::chrono::steady_clock::duration::zero() ||
+         keyframeTime > startTime))
+    {
+      seekRewind = true;
+      const auto &entities = _ecm.Entities().Vertices();
+      for (const auto &entity : entities)
+        entitiesToRemove.insert(Entity(entity.first));
+
+      for (const auto &entIt : keyframe.entities())
+        entitiesToRemove.erase(Entity(entIt.second.id()));
+
+      this->dataPtr->Parse(_ecm, keyframe);
+      this->dataPtr->ReplaceResourceURIs(_ecm);
+
+      startTime = keyframeTime;
+    }
+  }
+
+  if (!seekRewind &&
+      _info.dt < std::chrono::steady_clock::duration::zero())
+  {
+    // Detected jumping back in time in a log without keyframes. This can be
+    // expensive.
     // To rewind / seek backward in time, we also need to play every single
     // step from the beginning so we don't miss insertions and deletions
     // This is because each serialized state is a changed state and not an
     // absolute state.
-    // todo(anyone) Record absolute states during recording, i.e. key frames,
-    // so that playback can jump to these states without the need to
-    // incrementally build the states from the beginning
 
     // Create a list of entities to be removed. The list will be updated later
     // as the log steps forward below
@@ -485,18 +963,42 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
     startTime = std::chrono::steady_clock::duration::zero();
   }
 
-  this->dataPtr->batch = this->dataPtr->log->QueryMessages(
-      transport::log::AllTopics({startTime, endTime}));
+  // State accumulated before seeking is superseded by the new position
+  if (seekRewind)
+  {
+    this->dataPtr->pending.Clear();
+    this->dataPtr->hasPending = false;
+  }
+
+  // Keep reading from where the last step stopped, unless seeking
+  if (!this->dataPtr->cursorValid || seekRewind ||
+      startTime != this->dataPtr->playedUntil)
+  {
+    this->dataPtr->cursor.Reset(this->dataPtr->log.get(), startTime,
+        this->dataPtr->readWindow);
+    this->dataPtr->cursorValid = true;
+  }
+  this->dataPtr->playedUntil = endTime;
 
-  auto iter = this->dataPtr->batch.begin();
-  while (iter != this->dataPtr->batch.end())
+  bool parsed{false};
+  auto &cursor = this->dataPtr->cursor;
+  while (cursor.Next(endTime))
   {
-    auto msgType = iter->Type();
+    const auto &message = cursor.Message();
+    auto msgType = message.Type();
+
+    // Keyframes are only used for seeking
+    if (message.Topic() == this->dataPtr->keyframeTopic)
+      continue;
 
     if (msgType == "ignition.msgs.SerializedState")
     {
-      msgs::SerializedState msg;
-      msg.ParseFromString(iter->Data());
+      // Legacy messages can't be merged, so apply everything up to now
+      this->dataPtr->ApplyPending(_ecm);
+
+      auto &msg = this->dataPtr->legacyState;
+      if (!this->dataPtr->Decode(message.Data(), msg))
+        continue;
 
       // For seeking back in time only:
       // While stepping, update the list of entities to be removed
@@ -518,11 +1020,13 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
       }
 
       this->dataPtr->Parse(_ecm, msg);
+      parsed = true;
     }
     else if (msgType == "ignition.msgs.SerializedStateMap")
     {
-      msgs::SerializedStateMap msg;
-      msg.ParseFromString(iter->Data());
+      auto &msg = this->dataPtr->stateMap;
+      if (!this->dataPtr->Decode(message.Data(), msg))
+        continue;
 
       // For seeking back in time only:
       // While stepping, update the list of entities to be removed
@@ -544,7 +1048,15 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
         }
       }
 
-      this->dataPtr->Parse(_ecm, msg);
+      if (this->dataPtr->batchToSensors)
+      {
+        this->dataPtr->Accumulate(msg);
+      }
+      else
+      {
+        this->dataPtr->Parse(_ecm, msg);
+        parsed = true;
+      }
     }
     else if (msgType == "ignition.msgs.StringMsg")
     {
@@ -555,10 +1067,21 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
       ignwarn << "Trying to playback unsupported message type ["
               << msgType << "]" << std::endl;
     }
-    this->dataPtr->ReplaceResourceURIs(_ecm);
-    ++iter;
   }
 
+  // When batching, skip applying state until a rendering sensor needs it.
+  // Seeks and the end of the log always bring the ECM up to date.
+  if (this->dataPtr->hasPending &&
+      (seekRewind || _info.simTime >= this->dataPtr->log->EndTime() ||
+       this->dataPtr->RenderingSensorDue(_ecm, stepStart, endTime)))
+  {
+    parsed = this->dataPtr->ApplyPending(_ecm) || parsed;
+  }
+
+  // Resources only need to be fixed once for all the states of this step
+  if (parsed)
+    this->dataPtr->ReplaceResourceURIs(_ecm);
+
     // particle emitters
   _ecm.Each<components::ParticleEmitterCmd>(
       [&](const Entity &_entity,
@@ -592,7 +1115,9 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
   }
 
   // pause playback if end of log is reached
-  if (_info.simTime >= this->dataPtr->log->EndTime())
+  const bool end = _info.simTime >= this->dataPtr->log->EndTime();
+  this->dataPtr->ReportThroughput(end);
+  if (end)
   {
     ignmsg << "End of log file reached. Time: " <<
       std::chrono::duration_cast<std::chrono::seconds>(
@@ -18,13 +18,25 @@
 #include "LogRecord.hh"
 
 #include <sys/stat.h>
+#include <ignition/msgs/param.pb.h>
 #include <ignition/msgs/stringmsg.pb.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <string>
 #include <fstream>
 #include <ctime>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <regex>
 #include <set>
 #include <list>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
 #include <ignition/common/Time.hh>
 #include <ignition/common/Console.hh>
@@ -49,22 +61,97 @@
 #include <sdf/Visual.hh>
 #include <sdf/World.hh>
 
+#include "ignition/gazebo/components/AngularVelocity.hh"
+#include "ignition/gazebo/components/Factory.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Light.hh"
+#include "ignition/gazebo/components/LinearVelocity.hh"
 #include "ignition/gazebo/components/Link.hh"
 #include "ignition/gazebo/components/Material.hh"
 #include "ignition/gazebo/components/Model.hh"
 #include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/SourceFilePath.hh"
 #include "ignition/gazebo/components/Visual.hh"
 #include "ignition/gazebo/components/World.hh"
 
 #include "ignition/gazebo/Util.hh"
 
+#include "ResourceStore.hh"
+#include "SpscQueue.hh"
+#include "StateChunkLog.hh"
+
 using namespace ignition;
 using namespace ignition::gazebo;
 using namespace ignition::gazebo::systems;
 
+/// \brief Component types which are recorded at the same rate.
+struct ComponentGroup
+{
+  /// \brief Names of the component types, as given in SDF.
+  std::vector<std::string> names;
+
+  /// \brief Type ids of the component types, resolved from the names.
+  std::unordered_set<ComponentTypeId> types;
+
+  /// \brief Sim time between recordings, zero to record on every update.
+  std::chrono::steady_clock::duration period{0};
+
+  /// \brief Sim time this group was last recorded.
+  std::chrono::steady_clock::duration lastSimTime{0};
+
+  /// \brief ECM version when this group was last recorded.
+  uint64_t lastVersion{0u};
+
+  /// \brief Whether this group has been recorded yet.
+  bool recorded{false};
+};
+
+/// \brief Value of a pose or velocity, sampled for the columnar log.
+struct ColumnarSample
+{
+  /// \brief Sampled entity.
+  Entity entity{kNullEntity};
+
+  /// \brief Type of the sampled component.
+  ComponentTypeId typeId{kComponentTypeIdInvalid};
+
+  /// \brief Number of used values.
+  std::size_t count{0u};
+
+  /// \brief Values, enough for a pose.
+  std::array<double, 7> values;
+};
+
+/// \brief Everything recorded during one update. It's filled in PostUpdate,
+/// which is the only place where the ECM can be read, and then written
+/// either right away or by the writer thread.
+struct StateSnapshot
+{
+  /// \brief Sim time of the update.
+  std::chrono::steady_clock::duration simTime{0};
+
+  /// \brief Changed state, empty if nothing is recorded.
+  msgs::SerializedStateMap state;
+
+  /// \brief Full state, if a keyframe is due.
+  std::unique_ptr<msgs::SerializedStateMap> keyframe;
+
+  /// \brief Samples of poses and velocities in the changed state.
+  std::vector<ColumnarSample> samples;
+};
+
+/// \brief What to do with a snapshot when the writer queue is full.
+enum class QueuePolicy
+{
+  /// \brief Wait for the writer thread to make room.
+  BLOCK,
+
+  /// \brief Discard the snapshot, unless it creates or removes entities or
+  /// has one-time changes, which can't be recovered.
+  DROP
+};
+
 // Private data class.
 class ignition::gazebo::systems::LogRecordPrivate
 {
@@ -102,9 +189,70 @@ class ignition::gazebo::systems::LogRecordPrivate
   /// there are errors saving the models.
   public: bool SaveModels(const std::set<std::string> &_models);
 
+  /// \brief Add all files of a model directory to the resource store and
+  /// the manifest.
+  /// \param[in] _dir Model directory, or one of its subdirectories.
+  /// \return True if all files were added.
+  public: bool StoreModelDirectory(const std::string &_dir);
+
   /// \brief Compress model resource files and state file into one file.
   public: void CompressStateAndResources();
 
+  /// \brief Read the <record_entity> and <record_component> filters.
+  public: void LoadFilters();
+
+  /// \brief Whether any entity or component filter is set.
+  /// \return True if only part of the state is recorded.
+  public: bool HasFilters() const;
+
+  /// \brief Find the entities matching the entity filters, along with all
+  /// their descendants.
+  /// \param[in] _ecm Entity component manager.
+  public: void UpdateRecordedEntities(const EntityComponentManager &_ecm);
+
+  /// \brief Serialize the part of the changed state selected by the
+  /// filters. Components which aren't selected are never serialized.
+  /// \param[in] _info Current simulation update info.
+  /// \param[in] _ecm Entity component manager.
+  /// \param[out] _state Selected changed state.
+  public: void FilteredState(const UpdateInfo &_info,
+              const EntityComponentManager &_ecm,
+              msgs::SerializedStateMap &_state);
+
+  /// \brief Sample the poses and velocities in the changed state for the
+  /// columnar log.
+  /// \param[in] _ecm Entity component manager.
+  /// \param[in,out] _snapshot Snapshot to add samples to.
+  public: void SampleColumnarState(const EntityComponentManager &_ecm,
+              StateSnapshot &_snapshot) const;
+
+  /// \brief Write the sampled changed state to the columnar log. All
+  /// components which weren't sampled are stored as they change.
+  /// \param[in] _snapshot Recorded snapshot.
+  public: void WriteColumnarState(const StateSnapshot &_snapshot);
+
+  /// \brief Publish a snapshot for the transport recorder and write it to
+  /// the columnar log. This is where messages are encoded, compressed and
+  /// written to disk.
+  /// \param[in] _snapshot Recorded snapshot.
+  public: void WriteSnapshot(const StateSnapshot &_snapshot);
+
+  /// \brief Hand a snapshot to the writer thread, following the queue
+  /// policy if the queue is full.
+  /// \param[in] _snapshot Snapshot to write.
+  /// \param[in] _critical True if the snapshot must not be dropped.
+  public: void Enqueue(std::unique_ptr<StateSnapshot> _snapshot,
+              bool _critical);
+
+  /// \brief Writer thread loop.
+  public: void RunWriter();
+
+  /// \brief Stop the writer thread after it writes all queued snapshots.
+  public: void StopWriter();
+
+  /// \brief Publish queue metrics, at most once per second.
+  public: void PublishWriterMetrics();
+
   /// \brief Indicator of whether any recorder instance has ever been started.
   /// Currently, only one instance is allowed. This enforcement may be removed
   /// in the future.
@@ -159,11 +307,131 @@ class ignition::gazebo::systems::LogRecordPrivate
   /// \brief List of saved models if record with resources is enabled.
   public: std::set<std::string> savedModels;
 
+  /// \brief Directory of the shared resource store. If empty, resources
+  /// are copied into the log directory.
+  public: std::string resourceStorePath;
+
+  /// \brief Shared store which resources are added to, null if resources
+  /// are copied into the log directory.
+  public: std::unique_ptr<ResourceStore> resourceStore;
+
+  /// \brief Resources of this log which are in the resource store.
+  public: ResourceManifest resourceManifest;
+
+  /// \brief Number of resources which weren't in the store yet.
+  public: std::size_t storedResources{0u};
+
+  /// \brief Number of resources which were already in the store.
+  public: std::size_t reusedResources{0u};
+
   /// \brief Time period between state recording
   public: std::chrono::steady_clock::duration recordPeriod{0};
 
   /// \brief Last time states are recorded
   public: std::chrono::steady_clock::duration lastRecordSimTime{0};
+
+  /// \brief Publisher for keyframes, which hold the full state of the
+  /// world.
+  public: transport::Node::Publisher keyframePub;
+
+  /// \brief Sim time period between keyframes. Zero to not record
+  /// keyframes based on time.
+  public: std::chrono::steady_clock::duration keyframePeriod{0};
+
+  /// \brief Size of changed states recorded since the last keyframe which
+  /// triggers a new keyframe. Zero to not record keyframes based on size.
+  public: std::size_t keyframeBytes{0};
+
+  /// \brief Size of changed states recorded since the last keyframe.
+  public: std::size_t bytesSinceKeyframe{0};
+
+  /// \brief Sim time of the last keyframe.
+  public: std::chrono::steady_clock::duration lastKeyframeSimTime{0};
+
+  /// \brief Whether a keyframe has been recorded yet.
+  public: bool keyframeRecorded{false};
+
+  /// \brief Whether to also write the compressed, columnar state log.
+  public: bool columnarState{false};
+
+  /// \brief Quantization step of values in the columnar state log.
+  public: double columnarResolution{1e-6};
+
+  /// \brief Number of samples per chunk of the columnar state log.
+  public: std::size_t columnarChunkSamples{4096u};
+
+  /// \brief Number of chunks of the columnar state log which may wait to be
+  /// compressed and written by the background thread.
+  public: std::size_t columnarQueueSize{8u};
+
+  /// \brief Writer of the columnar state log, null if not recording one.
+  public: std::unique_ptr<StateChunkWriter> columnarWriter;
+
+  /// \brief Scoped names of entities to record.
+  public: std::vector<std::string> entityNames;
+
+  /// \brief Patterns of scoped model names to record.
+  public: std::vector<std::regex> entityPatterns;
+
+  /// \brief Entities selected by the entity filters, with descendants.
+  public: std::unordered_set<Entity> recordedEntities;
+
+  /// \brief Whether recordedEntities has been computed yet.
+  public: bool recordedEntitiesValid{false};
+
+  /// \brief Component types recorded on every update. Without
+  /// <record_component>, this holds a single group with no types, meaning
+  /// all types.
+  public: ComponentGroup everyUpdate;
+
+  /// \brief Component types recorded at lower rates.
+  public: std::vector<ComponentGroup> rateGroups;
+
+  /// \brief Whether <record_component> was set.
+  public: bool filterComponents{false};
+
+  /// \brief Whether component names have been resolved to type ids. This
+  /// is deferred to the first update, so components registered by other
+  /// systems are known.
+  public: bool componentsResolved{false};
+
+  /// \brief Whether snapshots are written by a separate thread.
+  public: bool asyncWrite{false};
+
+  /// \brief What to do when the writer queue is full.
+  public: QueuePolicy queuePolicy{QueuePolicy::BLOCK};
+
+  /// \brief Snapshots waiting for the writer thread. PostUpdate is the
+  /// only producer and the writer thread the only consumer.
+  public: std::unique_ptr<SpscQueue<std::unique_ptr<StateSnapshot>>> queue;
+
+  /// \brief Thread which writes queued snapshots.
+  public: std::thread writerThread;
+
+  /// \brief Tells the writer thread to finish.
+  public: std::atomic<bool> stopWriter{false};
+
+  /// \brief Only used by the writer thread to sleep while the queue is
+  /// empty. The queue itself doesn't need locking.
+  public: std::mutex writerMutex;
+
+  /// \brief Wakes up the writer thread.
+  public: std::condition_variable writerCv;
+
+  /// \brief Number of snapshots dropped because the queue was full.
+  public: uint64_t droppedSnapshots{0u};
+
+  /// \brief Number of times PostUpdate waited for room in the queue.
+  public: uint64_t blockedSnapshots{0u};
+
+  /// \brief Largest queue depth since metrics were last published.
+  public: std::size_t maxQueueDepth{0u};
+
+  /// \brief Publisher of writer queue metrics.
+  public: transport::Node::Publisher metricsPub;
+
+  /// \brief Wall time metrics were last published.
+  public: std::chrono::steady_clock::time_point lastMetricsTime;
 };
 
 bool LogRecordPrivate::started{false};
@@ -181,6 +449,207 @@ std::string LogRecordPrivate::AppendExtension(const std::string &_dir,
   return rv;
 }
 
+//////////////////////////////////////////////////
+void LogRecordPrivate::LoadFilters()
+{
+  auto ptr = const_cast<sdf::Element *>(this->sdf.get());
+
+  // Same check as for <record_topic>
+  std::regex regexMatch(".*[\\*\\?\\[\\]\\(\\)\\.]+.*");
+  for (auto elem = ptr->FindElement("record_entity"); elem;
+       elem = elem->GetNextElement("record_entity"))
+  {
+    auto name = elem->Get<std::string>();
+    if (name.empty())
+      continue;
+
+    if (std::regex_match(name, regexMatch))
+    {
+      this->entityPatterns.emplace_back(name);
+      igndbg << "Recording models matching [" << name << "].\n";
+    }
+    else
+    {
+      this->entityNames.push_back(name);
+      igndbg << "Recording entity [" << name << "].\n";
+    }
+  }
+
+  std::map<double, ComponentGroup> groups;
+  for (auto elem = ptr->FindElement("record_component"); elem;
+       elem = elem->GetNextElement("record_component"))
+  {
+    auto name = elem->Get<std::string>();
+    if (name.empty())
+      continue;
+
+    this->filterComponents = true;
+    double rate{0.0};
+    if (elem->HasAttribute("rate"))
+      elem->GetAttribute("rate")->Get<double>(rate);
+
+    if (rate > 0.0)
+    {
+      auto &group = groups[rate];
+      group.names.push_back(name);
+      group.period =
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(1.0 / rate));
+    }
+    else
+    {
+      this->everyUpdate.names.push_back(name);
+    }
+  }
+
+  for (auto &group : groups)
+    this->rateGroups.push_back(std::move(group.second));
+}
+
+//////////////////////////////////////////////////
+bool LogRecordPrivate::HasFilters() const
+{
+  return this->filterComponents || !this->entityNames.empty() ||
+      !this->entityPatterns.empty();
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::UpdateRecordedEntities(
+    const EntityComponentManager &_ecm)
+{
+  this->recordedEntities.clear();
+  auto addTree = [&](const Entity _entity)
+  {
+    _ecm.EachDescendant(_entity, [&](const Entity _descendant)
+    {
+      this->recordedEntities.insert(_descendant);
+      return true;
+    });
+  };
+
+  for (const auto &name : this->entityNames)
+  {
+    for (const auto &entity : entitiesFromScopedName(name, _ecm))
+      addTree(entity);
+  }
+
+  if (!this->entityPatterns.empty())
+  {
+    _ecm.Each<components::Model, components::Name>(
+        [&](const Entity &_entity, const components::Model *,
+            const components::Name *) -> bool
+        {
+          // Match names relative to the world, i.e. "parent::child"
+          auto name = scopedName(_entity, _ecm, "::", false);
+          auto worldSep = name.find("::");
+          if (worldSep != std::string::npos)
+            name = name.substr(worldSep + 2);
+
+          for (const auto &pattern : this->entityPatterns)
+          {
+            if (std::regex_match(name, pattern))
+            {
+              addTree(_entity);
+              break;
+            }
+          }
+          return true;
+        });
+  }
+  this->recordedEntitiesValid = true;
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::FilteredState(const UpdateInfo &_info,
+    const EntityComponentManager &_ecm, msgs::SerializedStateMap &_state)
+{
+  IGN_PROFILE("LogRecordPrivate::FilteredState");
+
+  if (!this->componentsResolved)
+  {
+    auto resolve = [](ComponentGroup &_group)
+    {
+      auto factory = components::Factory::Instance();
+      for (const auto &name : _group.names)
+      {
+        bool found{false};
+        for (const auto &[typeId, typeName] : factory->namesById)
+        {
+          // Accept both "ign_gazebo_components.Pose" and "Pose"
+          auto dot = typeName.rfind('.');
+          if (typeName == name || (dot != std::string::npos &&
+              typeName.compare(dot + 1, std::string::npos, name) == 0))
+          {
+            _group.types.insert(typeId);
+            found = true;
+          }
+        }
+        if (!found)
+        {
+          ignwarn << "Unknown component type [" << name
+                  << "] in <record_component>, it won't be recorded."
+                  << std::endl;
+        }
+      }
+    };
+    resolve(this->everyUpdate);
+    for (auto &group : this->rateGroups)
+      resolve(group);
+
+    // No valid types to record on every update. New and removed entities
+    // must still be recorded, so request a type no component has.
+    if (this->filterComponents && this->everyUpdate.types.empty())
+      this->everyUpdate.types.insert(kComponentTypeIdInvalid);
+
+    this->componentsResolved = true;
+  }
+
+  const bool filterEntities =
+      !this->entityNames.empty() || !this->entityPatterns.empty();
+  if (filterEntities)
+  {
+    if (!this->recordedEntitiesValid || _ecm.HasNewEntities())
+      this->UpdateRecordedEntities(_ecm);
+
+    // An empty set would select all entities
+    if (this->recordedEntities.empty())
+      return;
+  }
+
+  _ecm.ChangedState(_state, this->recordedEntities, this->everyUpdate.types);
+
+  for (auto &group : this->rateGroups)
+  {
+    if (group.types.empty() || (group.recorded &&
+        _info.simTime - group.lastSimTime < group.period))
+    {
+      continue;
+    }
+
+    // Pick up all changes since the last time this group was recorded, so
+    // that one-time changes in between aren't lost
+    msgs::SerializedStateMap groupState;
+    _ecm.ChangedStateSince(groupState, group.lastVersion, group.types);
+    for (const auto &[id, entityMsg] : groupState.entities())
+    {
+      if (filterEntities && this->recordedEntities.find(
+          static_cast<Entity>(id)) == this->recordedEntities.end())
+      {
+        continue;
+      }
+
+      auto &entry = (*_state.mutable_entities())[id];
+      entry.set_id(id);
+      for (const auto &[type, compMsg] : entityMsg.components())
+        (*entry.mutable_components())[type] = compMsg;
+    }
+
+    group.lastVersion = _ecm.CurrentVersion();
+    group.lastSimTime = _info.simTime;
+    group.recorded = true;
+  }
+}
+
 //////////////////////////////////////////////////
 LogRecord::LogRecord()
   : System(), dataPtr(std::make_unique<LogRecordPrivate>())
@@ -192,9 +661,31 @@ LogRecord::~LogRecord()
 {
   if (this->dataPtr->instStarted)
   {
+    // Write everything that's still queued before stopping the recorder
+    this->dataPtr->StopWriter();
+
     // Use ign-transport directly
     this->dataPtr->recorder.Stop();
 
+    if (this->dataPtr->columnarWriter)
+    {
+      this->dataPtr->columnarWriter->Close();
+      ignmsg << "Wrote [" << this->dataPtr->columnarWriter->WrittenBytes()
+             << "] bytes of columnar state, from ["
+             << this->dataPtr->columnarWriter->RawBytes()
+             << "] bytes of raw state." << std::endl;
+      this->dataPtr->columnarWriter.reset();
+    }
+
+    if (this->dataPtr->resourceStore)
+    {
+      ignmsg << "Added [" << this->dataPtr->storedResources
+             << "] new resources to store ["
+             << this->dataPtr->resourceStore->Root() << "], reused ["
+             << this->dataPtr->reusedResources << "]." << std::endl;
+      this->dataPtr->resourceStore.reset();
+    }
+
     if (this->dataPtr->compress)
       this->dataPtr->CompressStateAndResources();
     this->dataPtr->savedModels.clear();
@@ -215,12 +706,53 @@ void LogRecord::Configure(const Entity &_entity,
 
   this->dataPtr->SetRecordResources(_sdf->Get<bool>("record_resources",
     false).first);
+  this->dataPtr->resourceStorePath =
+    _sdf->Get<std::string>("resource_store", "").first;
 
   this->dataPtr->recordPeriod =
     std::chrono::duration_cast<std::chrono::steady_clock::duration>(
     std::chrono::duration<double>(
     _sdf->Get<double>("record_period", 0.0).first));
 
+  this->dataPtr->keyframePeriod =
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(
+    _sdf->Get<double>("keyframe_period", 0.0).first));
+
+  this->dataPtr->keyframeBytes = static_cast<std::size_t>(
+    _sdf->Get<double>("keyframe_bytes", 0.0).first);
+
+  this->dataPtr->columnarState =
+    _sdf->Get<bool>("columnar_state", false).first;
+  this->dataPtr->columnarResolution =
+    _sdf->Get<double>("columnar_resolution", 1e-6).first;
+  this->dataPtr->columnarChunkSamples = static_cast<std::size_t>(std::max(1,
+    _sdf->Get<int>("columnar_chunk_samples", 4096).first));
+  this->dataPtr->columnarQueueSize = static_cast<std::size_t>(std::max(1,
+    _sdf->Get<int>("columnar_queue_size", 8).first));
+
+  this->dataPtr->LoadFilters();
+
+  this->dataPtr->asyncWrite = _sdf->Get<bool>("async_write", false).first;
+  const auto queueSize = static_cast<std::size_t>(std::max(1,
+    _sdf->Get<int>("write_queue_size", 64).first));
+  const auto policy =
+    _sdf->Get<std::string>("write_queue_policy", "block").first;
+  if (policy == "drop")
+  {
+    this->dataPtr->queuePolicy = QueuePolicy::DROP;
+  }
+  else if (policy != "block")
+  {
+    ignwarn << "Unknown <write_queue_policy> [" << policy
+            << "], using [block]." << std::endl;
+  }
+  if (this->dataPtr->asyncWrite)
+  {
+    this->dataPtr->queue = std::make_unique<
+        SpscQueue<std::unique_ptr<StateSnapshot>>>(queueSize);
+  }
+
   this->dataPtr->compress = _sdf->Get<bool>("compress", false).first;
   this->dataPtr->cmpPath = _sdf->Get<std::string>("compress_path", "").first;
 
@@ -293,6 +825,18 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
     common::createDirectories(this->logPath);
   }
 
+  // Share resources with other logs through a content addressed store
+  if (this->recordResources && !this->resourceStorePath.empty())
+  {
+    const auto storePath = common::absPath(this->resourceStorePath);
+    this->resourceStore = std::make_unique<ResourceStore>(storePath);
+    this->resourceManifest = ResourceManifest();
+    this->resourceManifest.store = storePath;
+    this->storedResources = 0u;
+    this->reusedResources = 0u;
+    ignmsg << "Resources will be recorded to store [" << storePath << "]\n";
+  }
+
   // Use directory basename as topic name, to be able to retrieve at playback
   std::string sdfTopic = "/" + common::basename(this->logPath) + "/sdf";
   auto validSdfTopic = transport::TopicUtils::AsValidTopic(sdfTopic);
@@ -321,6 +865,26 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
            << stateTopic << "]." << std::endl;
   }
 
+  // Keyframes are only recorded if requested, to keep logs small otherwise
+  std::string keyframeTopic = "/world/" + this->worldName + "/keyframe_state";
+  const bool useKeyframes =
+      this->keyframePeriod > std::chrono::steady_clock::duration::zero() ||
+      this->keyframeBytes > 0u;
+  if (useKeyframes)
+  {
+    keyframeTopic = transport::TopicUtils::AsValidTopic(keyframeTopic);
+    if (!keyframeTopic.empty())
+    {
+      this->keyframePub = this->node.Advertise<msgs::SerializedStateMap>(
+          keyframeTopic);
+    }
+    else
+    {
+      ignerr << "Failed to generate valid topic to publish keyframes."
+             << std::endl;
+    }
+  }
+
   // Append file name
   std::string dbPath = common::joinPaths(this->logPath, "state.tlog");
   if (common::exists(dbPath))
@@ -330,11 +894,35 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
   }
   ignmsg << "Recording to log file [" << dbPath << "]" << std::endl;
 
+  // The columnar log holds the same state as the transport log, in a format
+  // which is much smaller and faster to read sequentially
+  if (this->columnarState)
+  {
+    std::string columnarPath = common::joinPaths(this->logPath, "state.scl");
+    this->columnarWriter = std::make_unique<StateChunkWriter>(
+        this->columnarResolution, this->columnarChunkSamples,
+        this->columnarQueueSize);
+    if (this->columnarWriter->Open(columnarPath))
+    {
+      ignmsg << "Recording columnar state to [" << columnarPath << "]"
+             << std::endl;
+    }
+    else
+    {
+      this->columnarWriter.reset();
+    }
+  }
+
   // Add default topics if no topics were specified.
   igndbg << "Recording default topic[" << sdfTopic << "].\n";
   igndbg << "Recording default topic[" << stateTopic << "].\n";
   this->recorder.AddTopic(sdfTopic);
   this->recorder.AddTopic(stateTopic);
+  if (this->keyframePub)
+  {
+    igndbg << "Recording keyframe topic[" << keyframeTopic << "].\n";
+    this->recorder.AddTopic(keyframeTopic);
+  }
 
   // Get the topics to record, if any.
   if (this->sdf->HasElement("record_topic"))
@@ -374,6 +962,18 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
       transport::log::RecorderError::SUCCESS)
   {
     this->instStarted = true;
+
+    if (this->asyncWrite)
+    {
+      auto metricsTopic = transport::TopicUtils::AsValidTopic(
+          "/world/" + this->worldName + "/log/metrics");
+      if (!metricsTopic.empty())
+        this->metricsPub = this->node.Advertise<msgs::Param>(metricsTopic);
+
+      this->writerThread = std::thread(&LogRecordPrivate::RunWriter, this);
+      ignmsg << "Writing log from a separate thread, with a queue of ["
+             << this->queue->Capacity() << "] updates." << std::endl;
+    }
     return true;
   }
   else
@@ -453,6 +1053,7 @@ bool LogRecordPrivate::SaveModels(const std::set<std::string> &_models)
   if (_models.empty())
     return true;
 
+  IGN_PROFILE("LogRecordPrivate::SaveModels");
   bool saveError = false;
   std::set<std::string> diff;
   std::set_difference(_models.begin(), _models.end(),
@@ -539,9 +1140,9 @@ bool LogRecordPrivate::SaveModels(const std::set<std::string> &_models)
     }
 
     // Copy resource
-    // TODO(anyone): support shared resources. Currently, the entire model
-    // directory is copied, which ensures that meshes and textures in the
-    // model directory are copied.
+    // The entire model directory is saved, which ensures that meshes and
+    // textures in the model directory are saved. With a resource store,
+    // files are only copied if they aren't in the store yet.
     if (fileFound)
     {
       std::string srcPath = common::parentPath(modelPath);
@@ -594,8 +1195,26 @@ bool LogRecordPrivate::SaveModels(const std::set<std::string> &_models)
         }
       }
 
+      if (this->resourceStore)
+      {
+        // Only the model SDF goes into the log directory
+        if (!this->StoreModelDirectory(srcPath) ||
+            !common::createDirectories(destPath))
+        {
+          ignerr << "Failed to store model directory [" << srcPath
+                 << "] in [" << this->resourceStore->Root() << "]"
+                 << std::endl;
+          saveError = true;
+        }
+        else
+        {
+          std::ofstream ofs(destModelPath);
+          ofs << root.Element()->ToString("").c_str();
+          ofs.close();
+        }
+      }
       // Copy entire model directory
-      if (!common::createDirectories(destPath) ||
+      else if (!common::createDirectories(destPath) ||
           !common::copyDirectory(srcPath, destPath))
       {
         ignerr << "Failed to copy model directory from [" << srcPath
@@ -617,9 +1236,51 @@ bool LogRecordPrivate::SaveModels(const std::set<std::string> &_models)
     }
   }
 
+  // Save the manifest as soon as it changes, so that it's in place even if
+  // recording doesn't stop cleanly.
+  if (this->resourceStore && !this->resourceManifest.Save(
+      common::joinPaths(this->logPath, "resources.manifest")))
+  {
+    saveError = true;
+  }
+
   return !saveError;
 }
 
+//////////////////////////////////////////////////
+bool LogRecordPrivate::StoreModelDirectory(const std::string &_dir)
+{
+  bool result = true;
+  for (common::DirIter file(_dir); file != common::DirIter(); ++file)
+  {
+    const std::string path = *file;
+    if (common::isDirectory(path))
+    {
+      result = this->StoreModelDirectory(path) && result;
+      continue;
+    }
+
+    // Already stored for another model
+    if (this->resourceManifest.files.count(path) > 0u)
+      continue;
+
+    bool copied{false};
+    const auto key = this->resourceStore->Add(path, &copied);
+    if (key.empty())
+    {
+      result = false;
+      continue;
+    }
+
+    this->resourceManifest.files[path] = key;
+    if (copied)
+      ++this->storedResources;
+    else
+      ++this->reusedResources;
+  }
+  return result;
+}
+
 //////////////////////////////////////////////////
 void LogRecordPrivate::CompressStateAndResources()
 {
@@ -646,6 +1307,236 @@ void LogRecordPrivate::CompressStateAndResources()
   }
 }
 
+//////////////////////////////////////////////////
+void LogRecordPrivate::SampleColumnarState(const EntityComponentManager &_ecm,
+    StateSnapshot &_snapshot) const
+{
+  IGN_PROFILE("LogRecordPrivate::SampleColumnarState");
+  for (const auto &[id, entityMsg] : _snapshot.state.entities())
+  {
+    if (entityMsg.remove())
+      continue;
+
+    const Entity entity = static_cast<Entity>(id);
+    for (const auto &[type, compMsg] : entityMsg.components())
+    {
+      if (compMsg.remove())
+        continue;
+
+      const auto typeId = static_cast<ComponentTypeId>(type);
+      ColumnarSample sample;
+      sample.entity = entity;
+      sample.typeId = typeId;
+      if (typeId == components::Pose::typeId)
+      {
+        auto pose = _ecm.Component<components::Pose>(entity);
+        if (nullptr == pose)
+          continue;
+        const auto &p = pose->Data();
+        sample.values = {p.Pos().X(), p.Pos().Y(), p.Pos().Z(), p.Rot().W(),
+            p.Rot().X(), p.Rot().Y(), p.Rot().Z()};
+        sample.count = 7u;
+      }
+      else if (typeId == components::LinearVelocity::typeId)
+      {
+        auto vel = _ecm.Component<components::LinearVelocity>(entity);
+        if (nullptr == vel)
+          continue;
+        sample.values = {vel->Data().X(), vel->Data().Y(), vel->Data().Z()};
+        sample.count = 3u;
+      }
+      else if (typeId == components::AngularVelocity::typeId)
+      {
+        auto vel = _ecm.Component<components::AngularVelocity>(entity);
+        if (nullptr == vel)
+          continue;
+        sample.values = {vel->Data().X(), vel->Data().Y(), vel->Data().Z()};
+        sample.count = 3u;
+      }
+      else
+      {
+        continue;
+      }
+      _snapshot.samples.push_back(sample);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::WriteColumnarState(const StateSnapshot &_snapshot)
+{
+  IGN_PROFILE("LogRecordPrivate::WriteColumnarState");
+  const int64_t time =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+      _snapshot.simTime).count();
+
+  std::set<std::pair<Entity, ComponentTypeId>> sampled;
+  for (const auto &sample : _snapshot.samples)
+  {
+    this->columnarWriter->AddSample(sample.entity, sample.typeId, time,
+        std::vector<double>(sample.values.begin(),
+        sample.values.begin() + sample.count));
+    sampled.insert({sample.entity, sample.typeId});
+  }
+
+  for (const auto &[id, entityMsg] : _snapshot.state.entities())
+  {
+    const Entity entity = static_cast<Entity>(id);
+    if (entityMsg.remove())
+    {
+      StateChunkRecord record;
+      record.entity = entity;
+      record.time = time;
+      record.remove = true;
+      this->columnarWriter->AddRecord(record);
+      continue;
+    }
+
+    for (const auto &[type, compMsg] : entityMsg.components())
+    {
+      const auto typeId = static_cast<ComponentTypeId>(type);
+      if (sampled.find({entity, typeId}) != sampled.end())
+        continue;
+
+      StateChunkRecord record;
+      record.entity = entity;
+      record.typeId = typeId;
+      record.time = time;
+      record.remove = compMsg.remove();
+      record.data = compMsg.component();
+      this->columnarWriter->AddRecord(record);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::WriteSnapshot(const StateSnapshot &_snapshot)
+{
+  IGN_PROFILE("LogRecordPrivate::WriteSnapshot");
+
+  // When writing from a separate thread, the recorder's clock must match
+  // the snapshot being written, not the update being simulated
+  if (this->asyncWrite)
+    this->clock->SetTime(_snapshot.simTime);
+
+  if (!_snapshot.state.entities().empty())
+  {
+    this->statePub.Publish(_snapshot.state);
+    if (this->columnarWriter)
+      this->WriteColumnarState(_snapshot);
+  }
+
+  if (_snapshot.keyframe)
+    this->keyframePub.Publish(*_snapshot.keyframe);
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::Enqueue(std::unique_ptr<StateSnapshot> _snapshot,
+    bool _critical)
+{
+  if (!this->queue->TryPush(std::move(_snapshot)))
+  {
+    if (this->queuePolicy == QueuePolicy::DROP && !_critical)
+    {
+      if (this->droppedSnapshots++ == 0u)
+      {
+        ignwarn << "Log writer can't keep up, dropping updates. Set "
+                << "<write_queue_policy> to [block] to keep them." << std::endl;
+      }
+    }
+    else
+    {
+      IGN_PROFILE("Wait for log writer");
+      ++this->blockedSnapshots;
+      while (!this->queue->TryPush(std::move(_snapshot)))
+      {
+        this->writerCv.notify_one();
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+    }
+  }
+
+  this->maxQueueDepth = std::max(this->maxQueueDepth, this->queue->Size());
+  this->writerCv.notify_one();
+  this->PublishWriterMetrics();
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::RunWriter()
+{
+  std::unique_ptr<StateSnapshot> snapshot;
+  while (true)
+  {
+    while (this->queue->TryPop(snapshot))
+    {
+      this->WriteSnapshot(*snapshot);
+      snapshot.reset();
+    }
+
+    if (this->stopWriter)
+    {
+      // Snapshots pushed right before stopping
+      if (this->queue->Size() > 0u)
+        continue;
+      break;
+    }
+
+    // The producer never locks, so a wake up may be missed. The timeout
+    // bounds how long that delays writing.
+    std::unique_lock<std::mutex> lock(this->writerMutex);
+    this->writerCv.wait_for(lock, std::chrono::milliseconds(10));
+  }
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::StopWriter()
+{
+  if (!this->writerThread.joinable())
+    return;
+
+  this->stopWriter = true;
+  this->writerCv.notify_one();
+  this->writerThread.join();
+
+  if (this->droppedSnapshots > 0u || this->blockedSnapshots > 0u)
+  {
+    ignmsg << "Log writer dropped [" << this->droppedSnapshots
+           << "] updates and made [" << this->blockedSnapshots
+           << "] updates wait for room in the queue." << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void LogRecordPrivate::PublishWriterMetrics()
+{
+  if (!this->metricsPub)
+    return;
+
+  auto now = std::chrono::steady_clock::now();
+  if (now - this->lastMetricsTime < std::chrono::seconds(1))
+    return;
+  this->lastMetricsTime = now;
+
+  if (this->metricsPub.HasConnections())
+  {
+    msgs::Param msg;
+    auto addInt = [&msg](const std::string &_name, uint64_t _value)
+    {
+      auto &any = (*msg.mutable_params())[_name];
+      any.set_type(msgs::Any::INT32);
+      any.set_int_value(static_cast<int32_t>(std::min<uint64_t>(_value,
+          static_cast<uint64_t>(std::numeric_limits<int32_t>::max()))));
+    };
+    addInt("queue_depth", this->queue->Size());
+    addInt("max_queue_depth", this->maxQueueDepth);
+    addInt("queue_capacity", this->queue->Capacity());
+    addInt("dropped", this->droppedSnapshots);
+    addInt("blocked", this->blockedSnapshots);
+    this->metricsPub.Publish(msg);
+  }
+  this->maxQueueDepth = 0u;
+}
+
 //////////////////////////////////////////////////
 void LogRecord::PreUpdate(const UpdateInfo &_info,
     EntityComponentManager &)
@@ -654,7 +1545,10 @@ void LogRecord::PreUpdate(const UpdateInfo &_info,
   // Safe guard to prevent seg faults if recorder could not be started
   if (!this->dataPtr->instStarted)
     return;
-  this->dataPtr->clock->SetTime(_info.simTime);
+
+  // The writer thread sets the clock to the time of each snapshot it writes
+  if (!this->dataPtr->asyncWrite)
+    this->dataPtr->clock->SetTime(_info.simTime);
 }
 
 //////////////////////////////////////////////////
@@ -717,18 +1611,60 @@ void LogRecord::PostUpdate(const UpdateInfo &_info,
     }
   }
 
+  auto snapshot = std::make_unique<StateSnapshot>();
+  snapshot->simTime = _info.simTime;
+
   // TODO(louise) Use the SceneBroadcaster's topic once that publishes
   // the changed state
-  // \todo(anyone) A potential enhancement here is have a keyframe mechanism
-  // to store complete state periodically, and then store incremental from
-  // that. It would reduce some of the compute on replaying
-  // (especially in tools like plotting or seeking through logs).
   if (record)
   {
-    msgs::SerializedStateMap stateMsg;
-    _ecm.ChangedState(stateMsg);
-    if (!stateMsg.entities().empty())
-      this->dataPtr->statePub.Publish(stateMsg);
+    if (this->dataPtr->HasFilters())
+      this->dataPtr->FilteredState(_info, _ecm, snapshot->state);
+    else
+      _ecm.ChangedState(snapshot->state);
+    if (!snapshot->state.entities().empty())
+    {
+      if (this->dataPtr->keyframeBytes > 0u)
+        this->dataPtr->bytesSinceKeyframe += snapshot->state.ByteSizeLong();
+      if (this->dataPtr->columnarWriter)
+        this->dataPtr->SampleColumnarState(_ecm, *snapshot);
+    }
+  }
+
+  // Keyframes hold the complete state periodically, so playback can seek to
+  // them without replaying all changes from the beginning
+  if (this->dataPtr->keyframePub)
+  {
+    const auto &period = this->dataPtr->keyframePeriod;
+    const auto &bytes = this->dataPtr->keyframeBytes;
+    if (!this->dataPtr->keyframeRecorded ||
+        (period > std::chrono::steady_clock::duration::zero() &&
+         _info.simTime - this->dataPtr->lastKeyframeSimTime >= period) ||
+        (bytes > 0u && this->dataPtr->bytesSinceKeyframe >= bytes))
+    {
+      IGN_PROFILE("Keyframe");
+      snapshot->keyframe = std::make_unique<msgs::SerializedStateMap>();
+      _ecm.State(*snapshot->keyframe, {}, {}, true);
+
+      this->dataPtr->lastKeyframeSimTime = _info.simTime;
+      this->dataPtr->bytesSinceKeyframe = 0u;
+      this->dataPtr->keyframeRecorded = true;
+    }
+  }
+
+  if (this->dataPtr->asyncWrite)
+  {
+    // Updates which create or remove entities, or have one-time changes,
+    // can't be recovered from later updates, so they're never dropped
+    const bool critical = _ecm.HasNewEntities() ||
+        _ecm.HasEntitiesMarkedForRemoval() ||
+        _ecm.HasOneTimeComponentChanges() || snapshot->keyframe != nullptr;
+    if (!snapshot->state.entities().empty() || snapshot->keyframe)
+      this->dataPtr->Enqueue(std::move(snapshot), critical);
+  }
+  else
+  {
+    this->dataPtr->WriteSnapshot(*snapshot);
   }
 
   // If there are new models loaded, save meshes and textures
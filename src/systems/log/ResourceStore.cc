@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ResourceStore.hh"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Util.hh>
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/// \brief First line of manifests.
+static const char kManifestHeader[] = "ignition-gazebo-resources 1";
+
+//////////////////////////////////////////////////
+/// \brief Write a file under a temporary name and rename it into place, so
+/// that readers never see a partial file.
+/// \param[in] _path File to write.
+/// \param[in] _data Contents.
+/// \return True if successful.
+static bool writeAtomically(const std::string &_path, const std::string &_data)
+{
+  // Random suffix so that concurrent writers don't clobber each other
+  static std::random_device device;
+  std::ostringstream tmpPath;
+  tmpPath << _path << "." << std::hex << device() << ".tmp";
+
+  std::ofstream out(tmpPath.str(), std::ios::binary | std::ios::trunc);
+  out.write(_data.data(), static_cast<std::streamsize>(_data.size()));
+  out.close();
+  if (!out || std::rename(tmpPath.str().c_str(), _path.c_str()) != 0)
+  {
+    std::remove(tmpPath.str().c_str());
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+ResourceStore::ResourceStore(const std::string &_root)
+  : root(_root)
+{
+  if (!common::exists(this->root) && !common::createDirectories(this->root))
+  {
+    ignerr << "Failed to create resource store [" << this->root << "]."
+           << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+const std::string &ResourceStore::Root() const
+{
+  return this->root;
+}
+
+//////////////////////////////////////////////////
+std::string ResourceStore::Add(const std::string &_path,
+    bool *_copied) const
+{
+  if (_copied)
+    *_copied = false;
+
+  std::ifstream file(_path, std::ios::binary);
+  if (!file)
+  {
+    ignerr << "Failed to read resource [" << _path << "]." << std::endl;
+    return "";
+  }
+  const std::string data((std::istreambuf_iterator<char>(file)),
+      std::istreambuf_iterator<char>());
+
+  // Keep the extension, mesh and image loaders rely on it
+  std::string extension;
+  const auto name = common::basename(_path);
+  const auto dot = name.rfind('.');
+  if (dot != std::string::npos && dot > 0u)
+    extension = name.substr(dot);
+
+  const auto key = common::sha1(data) + extension;
+  const auto storePath = this->Path(key);
+  if (common::exists(storePath))
+    return key;
+
+  const auto dir = common::parentPath(storePath);
+  if ((!common::exists(dir) && !common::createDirectories(dir)) ||
+      !writeAtomically(storePath, data))
+  {
+    ignerr << "Failed to add resource [" << _path << "] to store ["
+           << this->root << "]." << std::endl;
+    return "";
+  }
+
+  if (_copied)
+    *_copied = true;
+  return key;
+}
+
+//////////////////////////////////////////////////
+std::string ResourceStore::Path(const std::string &_key) const
+{
+  return common::joinPaths(common::joinPaths(this->root, _key.substr(0, 2)),
+      _key);
+}
+
+//////////////////////////////////////////////////
+bool ResourceManifest::Load(const std::string &_path)
+{
+  this->store.clear();
+  this->files.clear();
+
+  std::ifstream file(_path);
+  std::string line;
+  if (!std::getline(file, line) || line != kManifestHeader)
+    return false;
+
+  const std::string storePrefix{"store "};
+  if (!std::getline(file, line) ||
+      line.compare(0, storePrefix.size(), storePrefix) != 0)
+  {
+    return false;
+  }
+  this->store = line.substr(storePrefix.size());
+
+  while (std::getline(file, line))
+  {
+    const auto tab = line.find('\t');
+    if (tab == std::string::npos || tab == 0u)
+    {
+      ignwarn << "Skipping invalid line in resource manifest [" << _path
+              << "]: " << line << std::endl;
+      continue;
+    }
+    this->files[line.substr(tab + 1u)] = line.substr(0, tab);
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool ResourceManifest::Save(const std::string &_path) const
+{
+  std::ostringstream out;
+  out << kManifestHeader << "\n" << "store " << this->store << "\n";
+  for (const auto &[path, key] : this->files)
+    out << key << "\t" << path << "\n";
+
+  if (!writeAtomically(_path, out.str()))
+  {
+    ignerr << "Failed to write resource manifest [" << _path << "]."
+           << std::endl;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_LOG_RESOURCESTORE_HH_
+#define IGNITION_GAZEBO_SYSTEMS_LOG_RESOURCESTORE_HH_
+
+#include <map>
+#include <string>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/log-system/Export.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  /// \brief Content addressed storage for resources of recorded logs, such
+  /// as meshes and textures.
+  ///
+  /// Files are named after the SHA-1 of their contents, followed by their
+  /// original extension so that loaders can still tell their format, and
+  /// kept under a subdirectory named after the first two characters of the
+  /// hash. Identical files referenced by many logs are stored once, and
+  /// adding a file which is already in the store doesn't copy anything.
+  ///
+  /// New files are written under a temporary name and renamed into place,
+  /// so several recorders can share a store.
+  class IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE ResourceStore
+  {
+    /// \brief Constructor
+    /// \param[in] _root Directory of the store. It's created if needed.
+    public: explicit ResourceStore(const std::string &_root);
+
+    /// \brief Directory of the store.
+    /// \return Path to the store.
+    public: const std::string &Root() const;
+
+    /// \brief Add a file to the store.
+    /// \param[in] _path File to add.
+    /// \param[out] _copied Set to true if the file wasn't in the store yet.
+    /// \return Key of the file in the store, or empty if it couldn't be
+    /// read or written.
+    public: std::string Add(const std::string &_path,
+                bool *_copied = nullptr) const;
+
+    /// \brief Path of a file in the store.
+    /// \param[in] _key Key returned by Add.
+    /// \return Path to the file, which may not exist.
+    public: std::string Path(const std::string &_key) const;
+
+    /// \brief Directory of the store.
+    private: std::string root;
+  };
+
+  /// \brief List of the resources a log references in a ResourceStore,
+  /// saved with the log.
+  ///
+  /// The file has a "ignition-gazebo-resources 1" line, a "store <path>"
+  /// line, and then one line per resource with its key and original path,
+  /// separated by a tab.
+  struct IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE ResourceManifest
+  {
+    /// \brief Load a manifest.
+    /// \param[in] _path Path to the manifest.
+    /// \return True if successful.
+    bool Load(const std::string &_path);
+
+    /// \brief Save a manifest, replacing any existing one.
+    /// \param[in] _path Path to the manifest.
+    /// \return True if successful.
+    bool Save(const std::string &_path) const;
+
+    /// \brief Directory of the store the resources were added to.
+    std::string store;
+
+    /// \brief Key in the store of each recorded file, by original path.
+    std::map<std::string, std::string> files;
+  };
+}
+}
+}
+}
+#endif
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <ignition/common/Filesystem.hh>
+
+#include "ResourceStore.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/////////////////////////////////////////////////
+class ResourceStoreTest : public ::testing::Test
+{
+  protected: void SetUp() override
+  {
+    this->dir = common::joinPaths(common::cwd(), "resource_store_test");
+    common::removeAll(this->dir);
+    common::createDirectories(this->dir);
+  }
+
+  protected: void TearDown() override
+  {
+    common::removeAll(this->dir);
+  }
+
+  /// \brief Write a file inside the test directory.
+  /// \param[in] _name File name.
+  /// \param[in] _data Contents.
+  /// \return Path to the file.
+  protected: std::string Write(const std::string &_name,
+                 const std::string &_data)
+  {
+    auto path = common::joinPaths(this->dir, _name);
+    std::ofstream(path, std::ios::binary) << _data;
+    return path;
+  }
+
+  /// \brief Read a whole file.
+  /// \param[in] _path Path to the file.
+  /// \return Contents.
+  protected: static std::string Read(const std::string &_path)
+  {
+    std::ifstream file(_path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>());
+  }
+
+  /// \brief Directory with all test files.
+  protected: std::string dir;
+};
+
+/////////////////////////////////////////////////
+TEST_F(ResourceStoreTest, Deduplicate)
+{
+  ResourceStore store(common::joinPaths(this->dir, "store"));
+  EXPECT_TRUE(common::exists(store.Root()));
+
+  const auto mesh = this->Write("box.dae", "<COLLADA/>");
+  const auto copy = this->Write("other_box.dae", "<COLLADA/>");
+  const auto texture = this->Write("box.png", "not really a png");
+
+  bool copied{false};
+  const auto meshKey = store.Add(mesh, &copied);
+  ASSERT_FALSE(meshKey.empty());
+  EXPECT_TRUE(copied);
+  EXPECT_EQ(".dae", meshKey.substr(meshKey.size() - 4u));
+  EXPECT_EQ("<COLLADA/>", Read(store.Path(meshKey)));
+
+  // Same contents map to the same file, which isn't written again
+  EXPECT_EQ(meshKey, store.Add(copy, &copied));
+  EXPECT_FALSE(copied);
+  EXPECT_EQ(meshKey, store.Add(mesh, &copied));
+  EXPECT_FALSE(copied);
+
+  const auto textureKey = store.Add(texture, &copied);
+  EXPECT_TRUE(copied);
+  EXPECT_NE(meshKey, textureKey);
+  EXPECT_EQ("not really a png", Read(store.Path(textureKey)));
+
+  // A second store on the same directory sees the same files
+  ResourceStore sameStore(store.Root());
+  EXPECT_EQ(textureKey, sameStore.Add(texture, &copied));
+  EXPECT_FALSE(copied);
+
+  // Missing files can't be added
+  EXPECT_TRUE(store.Add(common::joinPaths(this->dir, "missing")).empty());
+}
+
+/////////////////////////////////////////////////
+TEST_F(ResourceStoreTest, Manifest)
+{
+  const auto path = common::joinPaths(this->dir, "resources.manifest");
+
+  ResourceManifest manifest;
+  manifest.store = "/some/store";
+  manifest.files["/models/box/meshes/box.dae"] = "0123.dae";
+  manifest.files["/models/box/materials/with space.png"] = "4567.png";
+  ASSERT_TRUE(manifest.Save(path));
+
+  ResourceManifest loaded;
+  ASSERT_TRUE(loaded.Load(path));
+  EXPECT_EQ(manifest.store, loaded.store);
+  EXPECT_EQ(manifest.files, loaded.files);
+
+  // Invalid lines are skipped
+  std::ofstream(path, std::ios::app) << "no tab here\n";
+  ASSERT_TRUE(loaded.Load(path));
+  EXPECT_EQ(manifest.files, loaded.files);
+
+  // Other files are rejected
+  this->Write("resources.manifest", "something else\n");
+  EXPECT_FALSE(loaded.Load(path));
+  EXPECT_TRUE(loaded.files.empty());
+  EXPECT_FALSE(loaded.Load(common::joinPaths(this->dir, "missing")));
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_LOG_SPSCQUEUE_HH_
+#define IGNITION_GAZEBO_SYSTEMS_LOG_SPSCQUEUE_HH_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  /// \brief Bounded, lock-free queue for exactly one producer thread and one
+  /// consumer thread. Neither side ever blocks; pushing to a full queue or
+  /// popping from an empty one fails instead, and the caller decides what
+  /// to do.
+  /// \tparam T Type of the items, which must be default constructible and
+  /// movable.
+  template <typename T>
+  class SpscQueue
+  {
+    /// \brief Constructor
+    /// \param[in] _capacity Maximum number of items in the queue.
+    public: explicit SpscQueue(std::size_t _capacity)
+            : slots(std::max<std::size_t>(_capacity, 1u))
+    {
+    }
+
+    /// \brief Add an item. Only call from the producer thread.
+    /// \param[in] _item Item to add. It's only moved from if there is room.
+    /// \return False if the queue is full.
+    public: bool TryPush(T &&_item)
+    {
+      const auto tail = this->tail.load(std::memory_order_relaxed);
+      const auto head = this->head.load(std::memory_order_acquire);
+      if (tail - head >= this->slots.size())
+        return false;
+
+      this->slots[tail % this->slots.size()] = std::move(_item);
+      this->tail.store(tail + 1u, std::memory_order_release);
+      return true;
+    }
+
+    /// \brief Take the oldest item. Only call from the consumer thread.
+    /// \param[out] _item The item.
+    /// \return False if the queue is empty.
+    public: bool TryPop(T &_item)
+    {
+      const auto head = this->head.load(std::memory_order_relaxed);
+      const auto tail = this->tail.load(std::memory_order_acquire);
+      if (head == tail)
+        return false;
+
+      auto &slot = this->slots[head % this->slots.size()];
+      _item = std::move(slot);
+      slot = T();
+      this->head.store(head + 1u, std::memory_order_release);
+      return true;
+    }
+
+    /// \brief Number of items in the queue. This is exact when called from
+    /// the producer or consumer while the other side is idle, and a snapshot
+    /// otherwise.
+    /// \return Number of items.
+    public: std::size_t Size() const
+    {
+      const auto head = this->head.load(std::memory_order_acquire);
+      const auto tail = this->tail.load(std::memory_order_acquire);
+      return tail - head;
+    }
+
+    /// \brief Maximum number of items in the queue.
+    /// \return Capacity.
+    public: std::size_t Capacity() const
+    {
+      return this->slots.size();
+    }
+
+    /// \brief Storage for the items.
+    private: std::vector<T> slots;
+
+    /// \brief Number of items popped so far. Written by the consumer only.
+    /// Kept on its own cache line so both threads don't fight over it.
+    private: alignas(64) std::atomic<std::size_t> head{0u};
+
+    /// \brief Number of items pushed so far. Written by the producer only.
+    private: alignas(64) std::atomic<std::size_t> tail{0u};
+  };
+}
+}
+}
+}
+#endif
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+
+#include "SpscQueue.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/////////////////////////////////////////////////
+TEST(SpscQueue, Bounded)
+{
+  SpscQueue<std::unique_ptr<int>> queue(2u);
+  EXPECT_EQ(2u, queue.Capacity());
+  EXPECT_EQ(0u, queue.Size());
+
+  std::unique_ptr<int> item;
+  EXPECT_FALSE(queue.TryPop(item));
+
+  auto first = std::make_unique<int>(1);
+  auto second = std::make_unique<int>(2);
+  auto third = std::make_unique<int>(3);
+  EXPECT_TRUE(queue.TryPush(std::move(first)));
+  EXPECT_TRUE(queue.TryPush(std::move(second)));
+  EXPECT_EQ(2u, queue.Size());
+
+  // Items aren't moved from if the queue is full
+  EXPECT_FALSE(queue.TryPush(std::move(third)));
+  ASSERT_NE(nullptr, third);
+
+  ASSERT_TRUE(queue.TryPop(item));
+  EXPECT_EQ(1, *item);
+  EXPECT_TRUE(queue.TryPush(std::move(third)));
+
+  ASSERT_TRUE(queue.TryPop(item));
+  EXPECT_EQ(2, *item);
+  ASSERT_TRUE(queue.TryPop(item));
+  EXPECT_EQ(3, *item);
+  EXPECT_FALSE(queue.TryPop(item));
+  EXPECT_EQ(0u, queue.Size());
+
+  // Zero capacity falls back to one item
+  SpscQueue<int> tiny(0u);
+  EXPECT_EQ(1u, tiny.Capacity());
+}
+
+/////////////////////////////////////////////////
+TEST(SpscQueue, Threads)
+{
+  SpscQueue<int> queue(16u);
+  const int count{100000};
+
+  std::thread consumer([&]
+  {
+    int expected{0};
+    while (expected < count)
+    {
+      int item;
+      if (queue.TryPop(item))
+      {
+        // Items arrive in order, none are lost
+        EXPECT_EQ(expected, item);
+        ++expected;
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  for (int i = 0; i < count; ++i)
+  {
+    int item = i;
+    while (!queue.TryPush(std::move(item)))
+      std::this_thread::yield();
+  }
+
+  consumer.join();
+  EXPECT_EQ(0u, queue.Size());
+}
@@ -0,0 +1,1467 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "StateChunkLog.hh"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+namespace
+{
+/// \brief Magic bytes at the start of every file.
+const char kMagic[] = {'I', 'G', 'N', 'S', 'C', 'L'};
+
+/// \brief Version of the file format. Version 2 added the time range to
+/// the header of each chunk.
+const unsigned char kVersion{2u};
+
+/// \brief Size of the file header.
+const std::size_t kHeaderSize{16u};
+
+/// \brief Size of the header of each chunk.
+const std::size_t kChunkHeaderSize{25u};
+
+/// \brief Size of the header of each chunk in version 1 files.
+const std::size_t kChunkHeaderSizeV1{9u};
+
+/// \brief Largest uncompressed chunk accepted by the reader, to avoid huge
+/// allocations on corrupt files.
+const uint32_t kMaxChunkSize{1u << 30};
+
+/// \brief Magic bytes at the start of every index file.
+const char kIndexMagic[] = {'I', 'G', 'N', 'S', 'C', 'I'};
+
+/// \brief Version of the index file format.
+const unsigned char kIndexVersion{1u};
+
+/// \brief Size of the index file header.
+const std::size_t kIndexHeaderSize{16u};
+
+/// \brief Buffered record data which triggers writing a chunk.
+const std::size_t kRecordChunkBytes{1u << 20};
+
+/// \brief Kinds of chunk.
+enum ChunkKind : unsigned char
+{
+  /// \brief Columnar samples.
+  STREAMS = 1u,
+
+  /// \brief Changed components.
+  RECORDS = 2u
+};
+
+//////////////////////////////////////////////////
+void putVarint(std::string &_out, uint64_t _value)
+{
+  while (_value >= 0x80u)
+  {
+    _out.push_back(static_cast<char>((_value & 0x7Fu) | 0x80u));
+    _value >>= 7;
+  }
+  _out.push_back(static_cast<char>(_value));
+}
+
+//////////////////////////////////////////////////
+bool getVarint(const std::string &_in, std::size_t &_pos, uint64_t &_value)
+{
+  _value = 0u;
+  for (unsigned int shift = 0u; shift < 64u; shift += 7u)
+  {
+    if (_pos >= _in.size())
+      return false;
+    const auto byte = static_cast<unsigned char>(_in[_pos++]);
+    _value |= static_cast<uint64_t>(byte & 0x7Fu) << shift;
+    if ((byte & 0x80u) == 0u)
+      return true;
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+uint64_t zigzag(int64_t _value)
+{
+  return (static_cast<uint64_t>(_value) << 1) ^
+      static_cast<uint64_t>(_value >> 63);
+}
+
+//////////////////////////////////////////////////
+int64_t unzigzag(uint64_t _value)
+{
+  return static_cast<int64_t>(_value >> 1) ^ -static_cast<int64_t>(_value & 1);
+}
+
+//////////////////////////////////////////////////
+void putSigned(std::string &_out, int64_t _value)
+{
+  putVarint(_out, zigzag(_value));
+}
+
+//////////////////////////////////////////////////
+bool getSigned(const std::string &_in, std::size_t &_pos, int64_t &_value)
+{
+  uint64_t raw;
+  if (!getVarint(_in, _pos, raw))
+    return false;
+  _value = unzigzag(raw);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void putFixed(char *_out, uint64_t _value, std::size_t _bytes)
+{
+  for (std::size_t i = 0u; i < _bytes; ++i)
+    _out[i] = static_cast<char>((_value >> (8u * i)) & 0xFFu);
+}
+
+//////////////////////////////////////////////////
+uint64_t getFixed(const char *_in, std::size_t _bytes)
+{
+  uint64_t value{0u};
+  for (std::size_t i = 0u; i < _bytes; ++i)
+  {
+    value |= static_cast<uint64_t>(static_cast<unsigned char>(_in[i]))
+        << (8u * i);
+  }
+  return value;
+}
+
+//////////////////////////////////////////////////
+int64_t quantize(double _value, double _resolution)
+{
+  if (!std::isfinite(_value))
+    return 0;
+
+  const double scaled = _value / _resolution;
+  const double limit = 9.2e18;
+  if (scaled >= limit)
+    return static_cast<int64_t>(limit);
+  if (scaled <= -limit)
+    return -static_cast<int64_t>(limit);
+  return std::llround(scaled);
+}
+}
+
+/// \brief Buffered samples of one stream.
+struct BufferedStream
+{
+  /// \brief Number of fields per sample.
+  std::size_t fieldCount{0u};
+
+  /// \brief Sim time of each sample.
+  std::vector<int64_t> times;
+
+  /// \brief Quantized values, one sample after the other.
+  std::vector<int64_t> values;
+};
+
+/// \brief A chunk waiting to be compressed and written.
+struct QueuedChunk
+{
+  /// \brief Kind of chunk.
+  ChunkKind kind;
+
+  /// \brief Uncompressed payload.
+  std::string raw;
+
+  /// \brief Sim time of the first sample or record in the chunk.
+  int64_t startTime{0};
+
+  /// \brief Sim time of the last sample or record in the chunk.
+  int64_t endTime{0};
+};
+
+class ignition::gazebo::systems::StateChunkWriterPrivate
+{
+  /// \brief Hand a chunk to the writer thread. Blocks while the queue is
+  /// full, so a slow disk slows down the caller instead of using unbounded
+  /// memory.
+  /// \param[in] _kind Kind of chunk.
+  /// \param[in] _raw Uncompressed payload.
+  /// \param[in] _startTime Earliest sim time in the chunk.
+  /// \param[in] _endTime Latest sim time in the chunk.
+  /// \return False if writing has failed before.
+  public: bool WriteChunk(ChunkKind _kind, std::string &&_raw,
+              int64_t _startTime, int64_t _endTime);
+
+  /// \brief Compress a payload and append it to the file as a chunk.
+  /// Only called from the writer thread.
+  /// \param[in] _chunk Chunk to write.
+  /// \return True if successful.
+  public: bool CompressAndWrite(const QueuedChunk &_chunk);
+
+  /// \brief Writer thread loop. Compresses and writes queued chunks until
+  /// stopped and the queue is empty.
+  public: void Run();
+
+  /// \brief Block until all queued chunks have been written.
+  public: void WaitForQueue();
+
+  /// \brief Write buffered samples as a chunk.
+  /// \return True if successful.
+  public: bool FlushStreams();
+
+  /// \brief Write buffered records as a chunk.
+  /// \return True if successful.
+  public: bool FlushRecords();
+
+  /// \brief Note that an entity has data in the chunk being built.
+  /// \param[in] _entity Entity.
+  public: void IndexEntity(uint64_t _entity);
+
+  /// \brief Write the entity index next to the log.
+  /// \return True if successful.
+  public: bool WriteIndex() const;
+
+  /// \brief Path to the log.
+  public: std::string path;
+
+  /// \brief Quantization step.
+  public: double resolution{1e-6};
+
+  /// \brief Samples buffered before writing a chunk.
+  public: std::size_t chunkSamples{4096u};
+
+  /// \brief Maximum number of chunks waiting to be written.
+  public: std::size_t queueDepth{8u};
+
+  /// \brief Output file. Only used by the writer thread while it runs.
+  public: std::ofstream file;
+
+  /// \brief Whether a file is open.
+  public: bool open{false};
+
+  /// \brief Thread which compresses and writes chunks.
+  public: std::thread writerThread;
+
+  /// \brief Protects the queue and the flags below.
+  public: std::mutex mutex;
+
+  /// \brief Notifies the writer thread of new chunks, and the producer of
+  /// free space in the queue.
+  public: std::condition_variable queueCv;
+
+  /// \brief Chunks waiting to be written.
+  public: std::deque<QueuedChunk> queue;
+
+  /// \brief Whether the writer thread is currently writing a chunk.
+  public: bool writing{false};
+
+  /// \brief Tells the writer thread to finish.
+  public: bool stop{false};
+
+  /// \brief Set by the writer thread when a chunk could not be written.
+  public: std::atomic<bool> failed{false};
+
+  /// \brief Buffered streams, keyed by entity and component type, so that
+  /// streams are laid out in a stable order within chunks.
+  public: std::map<std::pair<uint64_t, uint64_t>, BufferedStream> streams;
+
+  /// \brief Number of samples in all buffered streams.
+  public: std::size_t bufferedSamples{0u};
+
+  /// \brief Buffered records.
+  public: std::vector<StateChunkRecord> records;
+
+  /// \brief Size of the data of all buffered records.
+  public: std::size_t bufferedRecordBytes{0u};
+
+  /// \brief Uncompressed size of everything added.
+  public: uint64_t rawBytes{0u};
+
+  /// \brief Size of the file.
+  public: std::atomic<uint64_t> writtenBytes{0u};
+
+  /// \brief Number of chunks handed to the writer thread.
+  public: uint64_t chunkCount{0u};
+
+  /// \brief Chunks each entity has data in, in order.
+  public: std::map<uint64_t, std::vector<uint64_t>> entityChunks;
+};
+
+//////////////////////////////////////////////////
+bool StateChunkWriterPrivate::WriteChunk(ChunkKind _kind,
+    std::string &&_raw, int64_t _startTime, int64_t _endTime)
+{
+  std::unique_lock<std::mutex> lock(this->mutex);
+  this->queueCv.wait(lock, [this]
+      {
+        return this->queue.size() < this->queueDepth;
+      });
+  this->queue.push_back({_kind, std::move(_raw), _startTime, _endTime});
+  lock.unlock();
+  this->queueCv.notify_all();
+  return !this->failed;
+}
+
+//////////////////////////////////////////////////
+void StateChunkWriterPrivate::Run()
+{
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while (true)
+  {
+    this->queueCv.wait(lock, [this]
+        {
+          return this->stop || !this->queue.empty();
+        });
+    if (this->queue.empty())
+      break;
+
+    auto chunk = std::move(this->queue.front());
+    this->queue.pop_front();
+    this->writing = true;
+    lock.unlock();
+    this->queueCv.notify_all();
+
+    if (!this->CompressAndWrite(chunk))
+      this->failed = true;
+
+    lock.lock();
+    this->writing = false;
+    this->queueCv.notify_all();
+  }
+}
+
+//////////////////////////////////////////////////
+void StateChunkWriterPrivate::WaitForQueue()
+{
+  std::unique_lock<std::mutex> lock(this->mutex);
+  this->queueCv.wait(lock, [this]
+      {
+        return this->queue.empty() && !this->writing;
+      });
+}
+
+//////////////////////////////////////////////////
+bool StateChunkWriterPrivate::CompressAndWrite(const QueuedChunk &_chunk)
+{
+  const auto &raw = _chunk.raw;
+  uLongf compressedSize = compressBound(static_cast<uLong>(raw.size()));
+  std::string compressed(compressedSize, '\0');
+  if (compress2(reinterpret_cast<Bytef *>(&compressed[0]), &compressedSize,
+        reinterpret_cast<const Bytef *>(raw.data()),
+        static_cast<uLong>(raw.size()), Z_DEFAULT_COMPRESSION) != Z_OK)
+  {
+    ignerr << "Failed to compress state chunk." << std::endl;
+    return false;
+  }
+
+  char header[kChunkHeaderSize];
+  header[0] = static_cast<char>(_chunk.kind);
+  putFixed(header + 1, compressedSize, 4u);
+  putFixed(header + 5, raw.size(), 4u);
+  putFixed(header + 9, static_cast<uint64_t>(_chunk.startTime), 8u);
+  putFixed(header + 17, static_cast<uint64_t>(_chunk.endTime), 8u);
+  this->file.write(header, kChunkHeaderSize);
+  this->file.write(compressed.data(),
+      static_cast<std::streamsize>(compressedSize));
+
+  // Push every chunk to the OS right away, so that a killed process leaves
+  // all completed chunks in the file
+  this->file.flush();
+  if (!this->file)
+  {
+    ignerr << "Failed to write state chunk." << std::endl;
+    return false;
+  }
+
+  this->writtenBytes += kChunkHeaderSize + compressedSize;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool StateChunkWriterPrivate::FlushStreams()
+{
+  if (this->bufferedSamples == 0u)
+    return true;
+
+  std::size_t count{0u};
+  int64_t startTime{std::numeric_limits<int64_t>::max()};
+  int64_t endTime{std::numeric_limits<int64_t>::min()};
+  for (const auto &entry : this->streams)
+  {
+    const auto &times = entry.second.times;
+    if (times.empty())
+      continue;
+    ++count;
+    const auto [minTime, maxTime] =
+        std::minmax_element(times.begin(), times.end());
+    startTime = std::min(startTime, *minTime);
+    endTime = std::max(endTime, *maxTime);
+  }
+
+  std::string raw;
+  raw.reserve(this->bufferedSamples * 4u);
+  putVarint(raw, count);
+  for (auto &[key, stream] : this->streams)
+  {
+    if (stream.times.empty())
+      continue;
+
+    putVarint(raw, key.first);
+    putVarint(raw, key.second);
+    putVarint(raw, stream.fieldCount);
+    putVarint(raw, stream.times.size());
+
+    int64_t previous{0};
+    for (auto time : stream.times)
+    {
+      putSigned(raw, time - previous);
+      previous = time;
+    }
+
+    // Each field is one column, so consecutive values of the same signal
+    // end up next to each other
+    for (std::size_t f = 0u; f < stream.fieldCount; ++f)
+    {
+      previous = 0;
+      for (std::size_t s = 0u; s < stream.times.size(); ++s)
+      {
+        auto value = stream.values[s * stream.fieldCount + f];
+        putSigned(raw, value - previous);
+        previous = value;
+      }
+    }
+
+    this->IndexEntity(key.first);
+
+    // Keep the stream so its number of fields is still checked
+    stream.times.clear();
+    stream.values.clear();
+  }
+
+  this->bufferedSamples = 0u;
+  ++this->chunkCount;
+  return this->WriteChunk(STREAMS, std::move(raw), startTime, endTime);
+}
+
+//////////////////////////////////////////////////
+bool StateChunkWriterPrivate::FlushRecords()
+{
+  if (this->records.empty())
+    return true;
+
+  std::string raw;
+  raw.reserve(this->bufferedRecordBytes + this->records.size() * 8u);
+  putVarint(raw, this->records.size());
+  int64_t previous{0};
+  int64_t startTime{std::numeric_limits<int64_t>::max()};
+  int64_t endTime{std::numeric_limits<int64_t>::min()};
+  for (const auto &record : this->records)
+  {
+    startTime = std::min(startTime, record.time);
+    endTime = std::max(endTime, record.time);
+    putVarint(raw, record.entity);
+    putVarint(raw, record.typeId);
+    putSigned(raw, record.time - previous);
+    previous = record.time;
+    raw.push_back(record.remove ? 1 : 0);
+    putVarint(raw, record.data.size());
+    raw += record.data;
+    this->IndexEntity(record.entity);
+  }
+
+  this->records.clear();
+  this->bufferedRecordBytes = 0u;
+  ++this->chunkCount;
+  return this->WriteChunk(RECORDS, std::move(raw), startTime, endTime);
+}
+
+//////////////////////////////////////////////////
+void StateChunkWriterPrivate::IndexEntity(uint64_t _entity)
+{
+  auto &chunks = this->entityChunks[_entity];
+  if (chunks.empty() || chunks.back() != this->chunkCount)
+    chunks.push_back(this->chunkCount);
+}
+
+//////////////////////////////////////////////////
+bool StateChunkWriterPrivate::WriteIndex() const
+{
+  std::string raw;
+  putVarint(raw, this->entityChunks.size());
+  for (const auto &[entity, chunks] : this->entityChunks)
+  {
+    putVarint(raw, entity);
+    putVarint(raw, chunks.size());
+    uint64_t previous{0u};
+    for (auto chunk : chunks)
+    {
+      putVarint(raw, chunk - previous);
+      previous = chunk;
+    }
+  }
+
+  char header[kIndexHeaderSize];
+  std::memcpy(header, kIndexMagic, sizeof(kIndexMagic));
+  header[6] = static_cast<char>(kIndexVersion);
+  header[7] = 0;
+  putFixed(header + 8, this->chunkCount, 8u);
+
+  const auto indexPath = StateChunkIndexPath(this->path);
+  std::ofstream file(indexPath,
+      std::ios::binary | std::ios::out | std::ios::trunc);
+  file.write(header, kIndexHeaderSize);
+  file.write(raw.data(), static_cast<std::streamsize>(raw.size()));
+  if (!file)
+  {
+    ignerr << "Failed to write state log index [" << indexPath << "]."
+           << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::string ignition::gazebo::systems::StateChunkIndexPath(
+    const std::string &_path)
+{
+  return _path + ".idx";
+}
+
+//////////////////////////////////////////////////
+StateChunkWriter::StateChunkWriter(double _resolution,
+    std::size_t _chunkSamples, std::size_t _queueDepth)
+  : dataPtr(std::make_unique<StateChunkWriterPrivate>())
+{
+  if (_resolution > 0.0 && std::isfinite(_resolution))
+    this->dataPtr->resolution = _resolution;
+  else
+    ignwarn << "Invalid state log resolution [" << _resolution
+            << "], using [" << this->dataPtr->resolution << "]." << std::endl;
+
+  this->dataPtr->chunkSamples = std::max<std::size_t>(_chunkSamples, 1u);
+  this->dataPtr->queueDepth = std::max<std::size_t>(_queueDepth, 1u);
+}
+
+//////////////////////////////////////////////////
+StateChunkWriter::~StateChunkWriter()
+{
+  this->Close();
+}
+
+//////////////////////////////////////////////////
+bool StateChunkWriter::Open(const std::string &_path)
+{
+  this->Close();
+
+  this->dataPtr->file.open(_path,
+      std::ios::binary | std::ios::out | std::ios::trunc);
+  if (!this->dataPtr->file)
+  {
+    ignerr << "Failed to open state log [" << _path << "]." << std::endl;
+    return false;
+  }
+
+  // An index from a previous log doesn't describe this one
+  std::remove(StateChunkIndexPath(_path).c_str());
+
+  char header[kHeaderSize];
+  std::memcpy(header, kMagic, sizeof(kMagic));
+  header[6] = static_cast<char>(kVersion);
+  header[7] = 0;
+  uint64_t resolutionBits;
+  std::memcpy(&resolutionBits, &this->dataPtr->resolution,
+      sizeof(resolutionBits));
+  putFixed(header + 8, resolutionBits, 8u);
+  this->dataPtr->file.write(header, kHeaderSize);
+  this->dataPtr->file.flush();
+  if (!this->dataPtr->file)
+  {
+    ignerr << "Failed to write state log [" << _path << "]." << std::endl;
+    this->dataPtr->file.close();
+    return false;
+  }
+
+  this->dataPtr->path = _path;
+  this->dataPtr->rawBytes = 0u;
+  this->dataPtr->writtenBytes = kHeaderSize;
+  this->dataPtr->chunkCount = 0u;
+  this->dataPtr->entityChunks.clear();
+  this->dataPtr->failed = false;
+  this->dataPtr->stop = false;
+  this->dataPtr->open = true;
+  this->dataPtr->writerThread =
+      std::thread(&StateChunkWriterPrivate::Run, this->dataPtr.get());
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool StateChunkWriter::IsOpen() const
+{
+  return this->dataPtr->open;
+}
+
+//////////////////////////////////////////////////
+bool StateChunkWriter::AddSample(uint64_t _entity, uint64_t _typeId,
+    int64_t _time, const std::vector<double> &_values)
+{
+  if (!this->IsOpen() || _values.empty())
+    return false;
+
+  auto &stream = this->dataPtr->streams[{_entity, _typeId}];
+  if (stream.fieldCount == 0u)
+  {
+    stream.fieldCount = _values.size();
+  }
+  else if (stream.fieldCount != _values.size())
+  {
+    ignerr << "Sample of entity [" << _entity << "] component ["
+           << _typeId << "] has [" << _values.size() << "] fields, expected ["
+           << stream.fieldCount << "]." << std::endl;
+    return false;
+  }
+
+  stream.times.push_back(_time);
+  for (auto value : _values)
+  {
+    stream.values.push_back(quantize(value, this->dataPtr->resolution));
+  }
+
+  this->dataPtr->rawBytes += sizeof(int64_t) * (1u + _values.size());
+  if (++this->dataPtr->bufferedSamples >= this->dataPtr->chunkSamples)
+    return this->dataPtr->FlushStreams();
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool StateChunkWriter::AddRecord(const StateChunkRecord &_record)
+{
+  if (!this->IsOpen())
+    return false;
+
+  this->dataPtr->records.push_back(_record);
+  this->dataPtr->bufferedRecordBytes += _record.data.size();
+  this->dataPtr->rawBytes += _record.data.size() + 3u * sizeof(uint64_t);
+  if (this->dataPtr->bufferedRecordBytes >= kRecordChunkBytes ||
+      this->dataPtr->records.size() >= this->dataPtr->chunkSamples)
+  {
+    return this->dataPtr->FlushRecords();
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool StateChunkWriter::Flush()
+{
+  if (!this->IsOpen())
+    return false;
+
+  this->dataPtr->FlushStreams();
+  this->dataPtr->FlushRecords();
+  this->dataPtr->WaitForQueue();
+  return !this->dataPtr->failed;
+}
+
+//////////////////////////////////////////////////
+void StateChunkWriter::Close()
+{
+  if (!this->IsOpen())
+    return;
+
+  this->dataPtr->FlushStreams();
+  this->dataPtr->FlushRecords();
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->stop = true;
+  }
+  this->dataPtr->queueCv.notify_all();
+  this->dataPtr->writerThread.join();
+
+  this->dataPtr->file.close();
+  this->dataPtr->open = false;
+
+  // Without all chunks the index would point at data that isn't there, so
+  // readers fall back to scanning the log
+  if (!this->dataPtr->failed)
+    this->dataPtr->WriteIndex();
+}
+
+//////////////////////////////////////////////////
+uint64_t StateChunkWriter::RawBytes() const
+{
+  return this->dataPtr->rawBytes;
+}
+
+//////////////////////////////////////////////////
+uint64_t StateChunkWriter::WrittenBytes() const
+{
+  return this->dataPtr->writtenBytes;
+}
+
+namespace
+{
+//////////////////////////////////////////////////
+bool parseFileHeader(const char *_header, const std::string &_path,
+    double &_resolution, std::size_t &_chunkHeaderSize)
+{
+  if (std::memcmp(_header, kMagic, sizeof(kMagic)) != 0)
+  {
+    ignerr << "File [" << _path << "] is not a state log." << std::endl;
+    return false;
+  }
+
+  const auto version = static_cast<unsigned char>(_header[6]);
+  if (version != 1u && version != kVersion)
+  {
+    ignerr << "State log [" << _path << "] has unsupported version ["
+           << static_cast<int>(version) << "]." << std::endl;
+    return false;
+  }
+  _chunkHeaderSize = version == 1u ? kChunkHeaderSizeV1 : kChunkHeaderSize;
+
+  uint64_t resolutionBits = getFixed(_header + 8, 8u);
+  std::memcpy(&_resolution, &resolutionBits, sizeof(resolutionBits));
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool parseStreams(const std::string &_raw, double _resolution,
+    std::vector<StateChunkStream> &_streams)
+{
+  std::size_t pos{0u};
+  uint64_t count;
+  if (!getVarint(_raw, pos, count) || count > _raw.size())
+    return false;
+
+  _streams.resize(count);
+  for (auto &stream : _streams)
+  {
+    uint64_t fieldCount, sampleCount;
+    if (!getVarint(_raw, pos, stream.entity) ||
+        !getVarint(_raw, pos, stream.typeId) ||
+        !getVarint(_raw, pos, fieldCount) ||
+        !getVarint(_raw, pos, sampleCount) ||
+        fieldCount > _raw.size() || sampleCount > _raw.size() ||
+        // Every value takes at least one byte
+        (fieldCount + 1u) * sampleCount > _raw.size() - pos)
+    {
+      return false;
+    }
+
+    stream.times.resize(sampleCount);
+    int64_t previous{0};
+    for (auto &time : stream.times)
+    {
+      int64_t delta;
+      if (!getSigned(_raw, pos, delta))
+        return false;
+      time = previous + delta;
+      previous = time;
+    }
+
+    stream.fields.assign(fieldCount, std::vector<double>(sampleCount));
+    for (auto &field : stream.fields)
+    {
+      previous = 0;
+      for (auto &value : field)
+      {
+        int64_t delta;
+        if (!getSigned(_raw, pos, delta))
+          return false;
+        previous += delta;
+        value = static_cast<double>(previous) * _resolution;
+      }
+    }
+  }
+  return pos == _raw.size();
+}
+
+//////////////////////////////////////////////////
+bool parseRecords(const std::string &_raw,
+    std::vector<StateChunkRecord> &_records)
+{
+  std::size_t pos{0u};
+  uint64_t count;
+  if (!getVarint(_raw, pos, count) || count > _raw.size())
+    return false;
+
+  _records.resize(count);
+  int64_t previous{0};
+  for (auto &record : _records)
+  {
+    int64_t delta;
+    uint64_t size;
+    if (!getVarint(_raw, pos, record.entity) ||
+        !getVarint(_raw, pos, record.typeId) ||
+        !getSigned(_raw, pos, delta) ||
+        pos >= _raw.size())
+    {
+      return false;
+    }
+    record.time = previous + delta;
+    previous = record.time;
+    record.remove = _raw[pos++] != 0;
+
+    if (!getVarint(_raw, pos, size) || size > _raw.size() - pos)
+      return false;
+    record.data = _raw.substr(pos, size);
+    pos += size;
+  }
+  return pos == _raw.size();
+}
+
+//////////////////////////////////////////////////
+bool decodeChunk(unsigned char _kind, const char *_compressed,
+    uint32_t _compressedSize, uint32_t _rawSize, double _resolution,
+    std::vector<StateChunkStream> &_streams,
+    std::vector<StateChunkRecord> &_records)
+{
+  _streams.clear();
+  _records.clear();
+
+  std::string raw(_rawSize, '\0');
+  uLongf outSize = _rawSize;
+  if (uncompress(reinterpret_cast<Bytef *>(&raw[0]), &outSize,
+        reinterpret_cast<const Bytef *>(_compressed),
+        _compressedSize) != Z_OK || outSize != _rawSize)
+  {
+    ignerr << "Failed to decompress state log chunk." << std::endl;
+    return false;
+  }
+
+  bool valid{false};
+  if (_kind == STREAMS)
+    valid = parseStreams(raw, _resolution, _streams);
+  else if (_kind == RECORDS)
+    valid = parseRecords(raw, _records);
+
+  if (!valid)
+  {
+    ignerr << "Corrupt state log chunk." << std::endl;
+    _streams.clear();
+    _records.clear();
+  }
+  return valid;
+}
+}
+
+class ignition::gazebo::systems::StateChunkReaderPrivate
+{
+  /// \brief Input file.
+  public: std::ifstream file;
+
+  /// \brief Quantization step of the file.
+  public: double resolution{1e-6};
+
+  /// \brief Size of the chunk headers, which depends on the version.
+  public: std::size_t chunkHeaderSize{kChunkHeaderSize};
+};
+
+//////////////////////////////////////////////////
+StateChunkReader::StateChunkReader()
+  : dataPtr(std::make_unique<StateChunkReaderPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+StateChunkReader::~StateChunkReader() = default;
+
+//////////////////////////////////////////////////
+bool StateChunkReader::Open(const std::string &_path)
+{
+  if (this->dataPtr->file.is_open())
+    this->dataPtr->file.close();
+
+  this->dataPtr->file.open(_path, std::ios::binary | std::ios::in);
+  if (!this->dataPtr->file)
+  {
+    ignerr << "Failed to open state log [" << _path << "]." << std::endl;
+    return false;
+  }
+
+  char header[kHeaderSize];
+  if (!this->dataPtr->file.read(header, kHeaderSize))
+  {
+    ignerr << "File [" << _path << "] is not a state log." << std::endl;
+    this->dataPtr->file.close();
+    return false;
+  }
+
+  if (!parseFileHeader(header, _path, this->dataPtr->resolution,
+        this->dataPtr->chunkHeaderSize))
+  {
+    this->dataPtr->file.close();
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+double StateChunkReader::Resolution() const
+{
+  return this->dataPtr->resolution;
+}
+
+//////////////////////////////////////////////////
+bool StateChunkReader::Next(std::vector<StateChunkStream> &_streams,
+    std::vector<StateChunkRecord> &_records)
+{
+  _streams.clear();
+  _records.clear();
+
+  if (!this->dataPtr->file.is_open())
+    return false;
+
+  char header[kChunkHeaderSize];
+  if (!this->dataPtr->file.read(header,
+        static_cast<std::streamsize>(this->dataPtr->chunkHeaderSize)))
+  {
+    return false;
+  }
+
+  const auto kind = static_cast<unsigned char>(header[0]);
+  const auto compressedSize = static_cast<uint32_t>(getFixed(header + 1, 4u));
+  const auto rawSize = static_cast<uint32_t>(getFixed(header + 5, 4u));
+  if (rawSize > kMaxChunkSize || compressedSize > kMaxChunkSize)
+  {
+    ignerr << "Corrupt state log chunk." << std::endl;
+    return false;
+  }
+
+  std::string compressed(compressedSize, '\0');
+  if (!this->dataPtr->file.read(&compressed[0], compressedSize))
+  {
+    ignerr << "Truncated state log chunk." << std::endl;
+    return false;
+  }
+
+  return decodeChunk(kind, compressed.data(), compressedSize, rawSize,
+      this->dataPtr->resolution, _streams, _records);
+}
+
+class ignition::gazebo::systems::StateChunkMapPrivate
+{
+  /// \brief Release the mapping, if any.
+  public: void Unmap();
+
+  /// \brief Walk the chunk headers and fill the chunk table.
+  /// \param[in] _path Path of the file, for messages.
+  /// \return False if the file header is invalid.
+  public: bool Index(const std::string &_path);
+
+  /// \brief Load the entity index written along with the log. It's
+  /// ignored if it doesn't match the chunks in the file.
+  /// \param[in] _path Path of the log.
+  /// \return True if loaded.
+  public: bool LoadIndex(const std::string &_path);
+
+  /// \brief Build the entity index by decoding every chunk, if there's no
+  /// index yet.
+  public: void BuildIndex();
+
+  /// \brief Decode a chunk, reusing the last decoded one if possible.
+  /// \param[in] _index Index of the chunk.
+  /// \return Decoded streams, or null if the chunk is corrupt.
+  public: const std::vector<StateChunkStream> *CachedStreams(
+              std::size_t _index);
+
+  /// \brief Start of the file contents.
+  public: const char *data{nullptr};
+
+  /// \brief Size of the file contents.
+  public: std::size_t size{0u};
+
+#ifdef _WIN32
+  /// \brief File contents. There's no memory mapping on Windows, so the
+  /// whole file is read.
+  public: std::string buffer;
+#endif
+
+  /// \brief Quantization step of the file.
+  public: double resolution{1e-6};
+
+  /// \brief All complete chunks, in file order.
+  public: std::vector<StateChunkInfo> chunks;
+
+  /// \brief Indices of chunks with streams, in file order. Sim time only
+  /// moves forward while recording, so these are sorted by time.
+  public: std::vector<std::size_t> streamChunks;
+
+  /// \brief Chunks each entity has data in, in file order.
+  public: std::unordered_map<uint64_t, std::vector<std::size_t>>
+      entityChunks;
+
+  /// \brief Whether entityChunks is filled.
+  public: bool indexReady{false};
+
+  /// \brief Whether entityChunks was loaded from an index file.
+  public: bool indexLoaded{false};
+
+  /// \brief Index of the chunk held in cachedStreams.
+  public: std::size_t cachedIndex{std::numeric_limits<std::size_t>::max()};
+
+  /// \brief Streams of the most recently decoded chunk. Consecutive queries
+  /// usually hit the same chunk, and decompressing is the expensive part.
+  public: std::vector<StateChunkStream> cachedStreams;
+};
+
+//////////////////////////////////////////////////
+void StateChunkMapPrivate::Unmap()
+{
+#ifndef _WIN32
+  if (nullptr != this->data)
+    munmap(const_cast<char *>(this->data), this->size);
+#else
+  this->buffer.clear();
+#endif
+  this->data = nullptr;
+  this->size = 0u;
+  this->chunks.clear();
+  this->streamChunks.clear();
+  this->entityChunks.clear();
+  this->indexReady = false;
+  this->indexLoaded = false;
+  this->cachedIndex = std::numeric_limits<std::size_t>::max();
+  this->cachedStreams.clear();
+}
+
+//////////////////////////////////////////////////
+bool StateChunkMapPrivate::Index(const std::string &_path)
+{
+  std::size_t chunkHeaderSize{kChunkHeaderSize};
+  if (this->size < kHeaderSize)
+  {
+    ignerr << "File [" << _path << "] is not a state log." << std::endl;
+    return false;
+  }
+  if (!parseFileHeader(this->data, _path, this->resolution, chunkHeaderSize))
+    return false;
+
+  std::size_t pos{kHeaderSize};
+  std::vector<StateChunkStream> streams;
+  std::vector<StateChunkRecord> records;
+  while (this->size - pos >= chunkHeaderSize)
+  {
+    const char *header = this->data + pos;
+    StateChunkInfo info;
+    info.streams = static_cast<unsigned char>(header[0]) == STREAMS;
+    info.compressedSize = static_cast<uint32_t>(getFixed(header + 1, 4u));
+    info.rawSize = static_cast<uint32_t>(getFixed(header + 5, 4u));
+    info.offset = pos + chunkHeaderSize;
+    if (info.rawSize > kMaxChunkSize ||
+        info.compressedSize > this->size - info.offset)
+    {
+      // The last chunk may still be being written
+      igndbg << "Ignoring truncated chunk at offset [" << pos
+             << "] of state log [" << _path << "]." << std::endl;
+      break;
+    }
+
+    if (chunkHeaderSize == kChunkHeaderSize)
+    {
+      info.startTime = static_cast<int64_t>(getFixed(header + 9, 8u));
+      info.endTime = static_cast<int64_t>(getFixed(header + 17, 8u));
+    }
+    else
+    {
+      // Version 1 chunks don't have a time range, decode them once
+      if (!decodeChunk(static_cast<unsigned char>(header[0]),
+            this->data + info.offset, info.compressedSize, info.rawSize,
+            this->resolution, streams, records))
+      {
+        break;
+      }
+      info.startTime = std::numeric_limits<int64_t>::max();
+      info.endTime = std::numeric_limits<int64_t>::min();
+      for (const auto &stream : streams)
+      {
+        for (auto time : stream.times)
+        {
+          info.startTime = std::min(info.startTime, time);
+          info.endTime = std::max(info.endTime, time);
+        }
+      }
+      for (const auto &record : records)
+      {
+        info.startTime = std::min(info.startTime, record.time);
+        info.endTime = std::max(info.endTime, record.time);
+      }
+    }
+
+    if (info.streams)
+      this->streamChunks.push_back(this->chunks.size());
+    this->chunks.push_back(info);
+    pos = info.offset + info.compressedSize;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool StateChunkMapPrivate::LoadIndex(const std::string &_path)
+{
+  const auto indexPath = StateChunkIndexPath(_path);
+  std::ifstream file(indexPath, std::ios::binary | std::ios::in);
+  if (!file)
+    return false;
+
+  std::string raw((std::istreambuf_iterator<char>(file)),
+      std::istreambuf_iterator<char>());
+  if (raw.size() < kIndexHeaderSize ||
+      std::memcmp(raw.data(), kIndexMagic, sizeof(kIndexMagic)) != 0 ||
+      static_cast<unsigned char>(raw[6]) != kIndexVersion)
+  {
+    ignwarn << "Ignoring invalid state log index [" << indexPath << "]."
+            << std::endl;
+    return false;
+  }
+
+  if (getFixed(raw.data() + 8, 8u) != this->chunks.size())
+  {
+    ignwarn << "State log index [" << indexPath << "] doesn't match the "
+            << "log, ignoring it." << std::endl;
+    return false;
+  }
+
+  std::size_t pos{kIndexHeaderSize};
+  uint64_t count;
+  bool valid = getVarint(raw, pos, count) && count <= raw.size();
+  for (uint64_t i = 0u; valid && i < count; ++i)
+  {
+    uint64_t entity, chunkCount;
+    valid = getVarint(raw, pos, entity) && getVarint(raw, pos, chunkCount) &&
+        chunkCount <= this->chunks.size();
+    auto &chunks = this->entityChunks[entity];
+    uint64_t chunk{0u};
+    for (uint64_t c = 0u; valid && c < chunkCount; ++c)
+    {
+      uint64_t delta;
+      valid = getVarint(raw, pos, delta) && (chunk += delta) <
+          this->chunks.size();
+      chunks.push_back(static_cast<std::size_t>(chunk));
+    }
+  }
+
+  if (!valid || pos != raw.size())
+  {
+    ignwarn << "Ignoring corrupt state log index [" << indexPath << "]."
+            << std::endl;
+    this->entityChunks.clear();
+    return false;
+  }
+
+  this->indexReady = true;
+  this->indexLoaded = true;
+  return true;
+}
+
+//////////////////////////////////////////////////
+void StateChunkMapPrivate::BuildIndex()
+{
+  if (this->indexReady)
+    return;
+
+  IGN_PROFILE("StateChunkMap::BuildIndex");
+  std::vector<StateChunkStream> streams;
+  std::vector<StateChunkRecord> records;
+  auto add = [this](uint64_t _entity, std::size_t _chunk)
+  {
+    auto &chunks = this->entityChunks[_entity];
+    if (chunks.empty() || chunks.back() != _chunk)
+      chunks.push_back(_chunk);
+  };
+
+  for (std::size_t i = 0u; i < this->chunks.size(); ++i)
+  {
+    const auto &info = this->chunks[i];
+    if (!decodeChunk(info.streams ? STREAMS : RECORDS,
+          this->data + info.offset, info.compressedSize, info.rawSize,
+          this->resolution, streams, records))
+    {
+      continue;
+    }
+    for (const auto &stream : streams)
+      add(stream.entity, i);
+    for (const auto &record : records)
+      add(record.entity, i);
+  }
+  this->indexReady = true;
+}
+
+//////////////////////////////////////////////////
+const std::vector<StateChunkStream> *StateChunkMapPrivate::CachedStreams(
+    std::size_t _index)
+{
+  if (_index != this->cachedIndex)
+  {
+    const auto &info = this->chunks[_index];
+    std::vector<StateChunkRecord> records;
+    this->cachedIndex = std::numeric_limits<std::size_t>::max();
+    if (!decodeChunk(STREAMS, this->data + info.offset, info.compressedSize,
+          info.rawSize, this->resolution, this->cachedStreams, records))
+    {
+      return nullptr;
+    }
+    this->cachedIndex = _index;
+  }
+  return &this->cachedStreams;
+}
+
+//////////////////////////////////////////////////
+StateChunkMap::StateChunkMap()
+  : dataPtr(std::make_unique<StateChunkMapPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+StateChunkMap::~StateChunkMap()
+{
+  this->Close();
+}
+
+//////////////////////////////////////////////////
+bool StateChunkMap::Open(const std::string &_path)
+{
+  this->Close();
+
+#ifndef _WIN32
+  int fd = open(_path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    ignerr << "Failed to open state log [" << _path << "]: "
+           << std::strerror(errno) << std::endl;
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0)
+  {
+    ignerr << "File [" << _path << "] is not a state log." << std::endl;
+    close(fd);
+    return false;
+  }
+
+  const auto size = static_cast<std::size_t>(st.st_size);
+  void *memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after closing the descriptor
+  close(fd);
+  if (MAP_FAILED == memory)
+  {
+    ignerr << "Failed to map state log [" << _path << "]: "
+           << std::strerror(errno) << std::endl;
+    return false;
+  }
+  this->dataPtr->data = static_cast<const char *>(memory);
+  this->dataPtr->size = size;
+#else
+  std::ifstream file(_path, std::ios::binary | std::ios::in);
+  if (!file)
+  {
+    ignerr << "Failed to open state log [" << _path << "]." << std::endl;
+    return false;
+  }
+  this->dataPtr->buffer.assign(std::istreambuf_iterator<char>(file),
+      std::istreambuf_iterator<char>());
+  this->dataPtr->data = this->dataPtr->buffer.data();
+  this->dataPtr->size = this->dataPtr->buffer.size();
+#endif
+
+  if (!this->dataPtr->Index(_path))
+  {
+    this->Close();
+    return false;
+  }
+  this->dataPtr->LoadIndex(_path);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void StateChunkMap::Close()
+{
+  this->dataPtr->Unmap();
+}
+
+//////////////////////////////////////////////////
+bool StateChunkMap::IsOpen() const
+{
+  return nullptr != this->dataPtr->data;
+}
+
+//////////////////////////////////////////////////
+double StateChunkMap::Resolution() const
+{
+  return this->dataPtr->resolution;
+}
+
+//////////////////////////////////////////////////
+const std::vector<StateChunkInfo> &StateChunkMap::Chunks() const
+{
+  return this->dataPtr->chunks;
+}
+
+//////////////////////////////////////////////////
+std::vector<std::size_t> StateChunkMap::ChunksBetween(int64_t _start,
+    int64_t _end) const
+{
+  std::vector<std::size_t> result;
+  const auto &chunks = this->dataPtr->chunks;
+  for (std::size_t i = 0u; i < chunks.size(); ++i)
+  {
+    if (chunks[i].startTime <= _end && chunks[i].endTime >= _start)
+      result.push_back(i);
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool StateChunkMap::Decode(std::size_t _index,
+    std::vector<StateChunkStream> &_streams,
+    std::vector<StateChunkRecord> &_records) const
+{
+  if (_index >= this->dataPtr->chunks.size())
+  {
+    _streams.clear();
+    _records.clear();
+    return false;
+  }
+
+  const auto &info = this->dataPtr->chunks[_index];
+  return decodeChunk(info.streams ? STREAMS : RECORDS,
+      this->dataPtr->data + info.offset, info.compressedSize, info.rawSize,
+      this->dataPtr->resolution, _streams, _records);
+}
+
+//////////////////////////////////////////////////
+bool StateChunkMap::Sample(uint64_t _entity, uint64_t _typeId, int64_t _time,
+    std::vector<double> &_values, int64_t &_sampleTime)
+{
+  const auto &chunks = this->dataPtr->chunks;
+  const auto &streamChunks = this->dataPtr->streamChunks;
+
+  // First chunk which starts after the requested time
+  auto it = std::upper_bound(streamChunks.begin(), streamChunks.end(), _time,
+      [&chunks](int64_t _t, std::size_t _index)
+      {
+        return _t < chunks[_index].startTime;
+      });
+
+  // Walk back until a chunk has a sample of the stream
+  while (it != streamChunks.begin())
+  {
+    --it;
+    auto streams = this->dataPtr->CachedStreams(*it);
+    if (nullptr == streams)
+      return false;
+
+    for (const auto &stream : *streams)
+    {
+      if (stream.entity != _entity || stream.typeId != _typeId)
+        continue;
+
+      auto sample = std::upper_bound(stream.times.begin(),
+          stream.times.end(), _time);
+      if (sample == stream.times.begin())
+        break;
+
+      const auto s = static_cast<std::size_t>(
+          std::distance(stream.times.begin(), sample) - 1);
+      _sampleTime = stream.times[s];
+      _values.resize(stream.fields.size());
+      for (std::size_t f = 0u; f < stream.fields.size(); ++f)
+        _values[f] = stream.fields[f][s];
+      return true;
+    }
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+bool StateChunkMap::HasIndex() const
+{
+  return this->dataPtr->indexLoaded;
+}
+
+//////////////////////////////////////////////////
+std::vector<uint64_t> StateChunkMap::Entities()
+{
+  this->dataPtr->BuildIndex();
+
+  std::vector<uint64_t> entities;
+  entities.reserve(this->dataPtr->entityChunks.size());
+  for (const auto &entry : this->dataPtr->entityChunks)
+    entities.push_back(entry.first);
+  std::sort(entities.begin(), entities.end());
+  return entities;
+}
+
+//////////////////////////////////////////////////
+std::vector<std::size_t> StateChunkMap::EntityChunks(uint64_t _entity)
+{
+  this->dataPtr->BuildIndex();
+
+  auto it = this->dataPtr->entityChunks.find(_entity);
+  if (it == this->dataPtr->entityChunks.end())
+    return {};
+  return it->second;
+}
+
+//////////////////////////////////////////////////
+bool StateChunkMap::EntityHistory(uint64_t _entity,
+    const std::function<bool(const StateChunkStream &)> &_onStream,
+    const std::function<bool(const StateChunkRecord &)> &_onRecord)
+{
+  IGN_PROFILE("StateChunkMap::EntityHistory");
+
+  std::vector<StateChunkStream> streams;
+  std::vector<StateChunkRecord> records;
+  for (auto index : this->EntityChunks(_entity))
+  {
+    if (!this->Decode(index, streams, records))
+      return false;
+
+    for (const auto &stream : streams)
+    {
+      if (stream.entity == _entity && _onStream && !_onStream(stream))
+        return true;
+    }
+    for (const auto &record : records)
+    {
+      if (record.entity == _entity && _onRecord && !_onRecord(record))
+        return true;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,335 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_LOG_STATECHUNKLOG_HH_
+#define IGNITION_GAZEBO_SYSTEMS_LOG_STATECHUNKLOG_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/log-system/Export.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  // Forward declarations.
+  class StateChunkWriterPrivate;
+  class StateChunkReaderPrivate;
+  class StateChunkMapPrivate;
+
+  /// \brief Samples of one stream inside a chunk, stored column by column.
+  /// A stream is a fixed number of floating point fields of one component
+  /// type of one entity, such as the 7 fields of a pose.
+  struct StateChunkStream
+  {
+    /// \brief Entity the samples belong to.
+    uint64_t entity{0u};
+
+    /// \brief Type id of the sampled component.
+    uint64_t typeId{0u};
+
+    /// \brief Sim time of each sample, in nanoseconds.
+    std::vector<int64_t> times;
+
+    /// \brief One column per field, each with one value per sample.
+    std::vector<std::vector<double>> fields;
+  };
+
+  /// \brief A component which is stored whenever it changes.
+  struct StateChunkRecord
+  {
+    /// \brief Entity the component belongs to.
+    uint64_t entity{0u};
+
+    /// \brief Type id of the component, or zero if the whole entity was
+    /// removed.
+    uint64_t typeId{0u};
+
+    /// \brief Sim time of the change, in nanoseconds.
+    int64_t time{0};
+
+    /// \brief True if the component or entity was removed.
+    bool remove{false};
+
+    /// \brief Serialized component data.
+    std::string data;
+  };
+
+  /// \brief Path of the entity index written along with a log.
+  /// \param[in] _path Path to the log.
+  /// \return Path to its index.
+  IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE std::string StateChunkIndexPath(
+      const std::string &_path);
+
+  /// \brief Location and time range of a chunk inside a file.
+  struct StateChunkInfo
+  {
+    /// \brief True if the chunk holds streams, false if it holds records.
+    bool streams{false};
+
+    /// \brief Sim time of the first sample or record, in nanoseconds.
+    int64_t startTime{0};
+
+    /// \brief Sim time of the last sample or record, in nanoseconds.
+    int64_t endTime{0};
+
+    /// \brief Offset of the compressed payload from the start of the file.
+    uint64_t offset{0u};
+
+    /// \brief Size of the compressed payload.
+    uint32_t compressedSize{0u};
+
+    /// \brief Size of the uncompressed payload.
+    uint32_t rawSize{0u};
+  };
+
+  /// \brief Writes a compressed, columnar log of simulation state.
+  ///
+  /// Samples of frequently changing values, like poses and velocities, are
+  /// buffered per entity and component. Once enough samples have been
+  /// buffered they are written as one chunk, where each stream is stored as
+  /// a column of times followed by a column per field. Values are quantized
+  /// to a fixed resolution and delta encoded, so that slowly varying
+  /// signals become runs of small integers which compress very well with
+  /// zlib. Delta encoding restarts on each chunk, so chunks can be decoded
+  /// independently.
+  ///
+  /// All other components are written as records whenever they change, in
+  /// separate chunks.
+  ///
+  /// When the file is closed, an index of which chunks hold data of each
+  /// entity is written next to it, see StateChunkIndexPath. It lets readers
+  /// extract the history of one entity without decoding the whole log.
+  ///
+  /// Compression and file I/O happen on a background thread, which is fed
+  /// through a bounded queue of chunks. Each chunk is flushed to the file as
+  /// soon as it's written, so the file on disk is always compressed and
+  /// remains readable up to the last chunk if the process is killed.
+  ///
+  /// File layout:
+  ///   * Header: the "IGNSCL" magic, a version byte, a padding byte and the
+  ///     quantization resolution as a little endian double.
+  ///   * Chunks: a kind byte, the compressed and uncompressed payload sizes
+  ///     as little endian 32 bit integers, the sim times of the first and
+  ///     last sample or record as little endian 64 bit integers, and the
+  ///     zlib payload. Version 1 files don't have the times.
+  class IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE StateChunkWriter
+  {
+    /// \brief Constructor
+    /// \param[in] _resolution Quantization step for sampled values. Values
+    /// are rounded to the nearest multiple of this.
+    /// \param[in] _chunkSamples Number of samples, across all streams, which
+    /// are buffered before a chunk is written.
+    /// \param[in] _queueDepth Number of chunks which may wait to be written
+    /// before adding more data blocks.
+    public: explicit StateChunkWriter(double _resolution = 1e-6,
+                std::size_t _chunkSamples = 4096u,
+                std::size_t _queueDepth = 8u);
+
+    /// \brief Destructor. Writes pending chunks and closes the file.
+    public: ~StateChunkWriter();
+
+    /// \brief Open a file for writing, replacing any existing one.
+    /// \param[in] _path Path to the file.
+    /// \return True if the file could be opened.
+    public: bool Open(const std::string &_path);
+
+    /// \brief Whether a file is open.
+    /// \return True if open.
+    public: bool IsOpen() const;
+
+    /// \brief Add a sample to a stream. The number of fields of a stream
+    /// must be the same for all of its samples.
+    /// \param[in] _entity Entity being sampled.
+    /// \param[in] _typeId Type id of the sampled component.
+    /// \param[in] _time Sim time in nanoseconds.
+    /// \param[in] _values Values of all fields.
+    /// \return False if the number of fields doesn't match previous samples
+    /// or no file is open.
+    public: bool AddSample(uint64_t _entity, uint64_t _typeId, int64_t _time,
+                const std::vector<double> &_values);
+
+    /// \brief Add a component which changed.
+    /// \param[in] _record The change.
+    /// \return False if no file is open.
+    public: bool AddRecord(const StateChunkRecord &_record);
+
+    /// \brief Write all buffered data as chunks, and wait until they are
+    /// in the file.
+    /// \return False if writing any chunk failed.
+    public: bool Flush();
+
+    /// \brief Flush and close the file.
+    public: void Close();
+
+    /// \brief Number of bytes which would have been written without
+    /// compression, including quantized samples as 8 byte values.
+    /// \return Uncompressed size.
+    public: uint64_t RawBytes() const;
+
+    /// \brief Number of bytes written to the file so far. Chunks still
+    /// waiting in the queue are not counted.
+    /// \return File size.
+    public: uint64_t WrittenBytes() const;
+
+    /// \brief Private data pointer.
+    private: std::unique_ptr<StateChunkWriterPrivate> dataPtr;
+  };
+
+  /// \brief Reads files written by StateChunkWriter sequentially.
+  class IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE StateChunkReader
+  {
+    /// \brief Constructor
+    public: StateChunkReader();
+
+    /// \brief Destructor
+    public: ~StateChunkReader();
+
+    /// \brief Open a file and check its header.
+    /// \param[in] _path Path to the file.
+    /// \return True if the file is a valid state chunk log.
+    public: bool Open(const std::string &_path);
+
+    /// \brief Quantization resolution the file was written with.
+    /// \return Resolution.
+    public: double Resolution() const;
+
+    /// \brief Read the next chunk. Each chunk holds either streams or
+    /// records, so one of the outputs is always empty.
+    /// \param[out] _streams Sampled streams in the chunk.
+    /// \param[out] _records Changed components in the chunk.
+    /// \return False at the end of the file or if the chunk is corrupt.
+    public: bool Next(std::vector<StateChunkStream> &_streams,
+                std::vector<StateChunkRecord> &_records);
+
+    /// \brief Private data pointer.
+    private: std::unique_ptr<StateChunkReaderPrivate> dataPtr;
+  };
+
+  /// \brief Random access to files written by StateChunkWriter.
+  ///
+  /// The file is memory mapped and only the chunk headers are read when
+  /// opening it, to build a table of chunks and their time ranges. Chunks
+  /// are decompressed straight from the mapping when they are needed, so
+  /// looking up the state at any time only touches the chunks around it.
+  /// This is meant for seeking during playback and for offline analysis of
+  /// large logs.
+  ///
+  /// Chunks written after the file was opened aren't visible until it's
+  /// opened again. This class is not thread safe.
+  class IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE StateChunkMap
+  {
+    /// \brief Constructor
+    public: StateChunkMap();
+
+    /// \brief Destructor. Unmaps the file.
+    public: ~StateChunkMap();
+
+    /// \brief Map a file and index its chunks. A truncated last chunk, as
+    /// left by a writer which is still running, is ignored.
+    /// \param[in] _path Path to the file.
+    /// \return True if the file is a valid state chunk log.
+    public: bool Open(const std::string &_path);
+
+    /// \brief Unmap the file.
+    public: void Close();
+
+    /// \brief Whether a file is mapped.
+    /// \return True if open.
+    public: bool IsOpen() const;
+
+    /// \brief Quantization resolution the file was written with.
+    /// \return Resolution.
+    public: double Resolution() const;
+
+    /// \brief All complete chunks of the file, in the order they were
+    /// written.
+    /// \return Chunk table.
+    public: const std::vector<StateChunkInfo> &Chunks() const;
+
+    /// \brief Indices of the chunks which have data within a time range.
+    /// \param[in] _start Start of the range in nanoseconds, inclusive.
+    /// \param[in] _end End of the range in nanoseconds, inclusive.
+    /// \return Indices into Chunks(), in file order.
+    public: std::vector<std::size_t> ChunksBetween(int64_t _start,
+                int64_t _end) const;
+
+    /// \brief Decode one chunk. One of the outputs is always empty.
+    /// \param[in] _index Index into Chunks().
+    /// \param[out] _streams Sampled streams in the chunk.
+    /// \param[out] _records Changed components in the chunk.
+    /// \return False if the index is out of range or the chunk is corrupt.
+    public: bool Decode(std::size_t _index,
+                std::vector<StateChunkStream> &_streams,
+                std::vector<StateChunkRecord> &_records) const;
+
+    /// \brief Get the latest sample of a stream at or before a given time.
+    /// The most recently decoded chunk is cached, so querying nearby times
+    /// one after the other is cheap.
+    /// \param[in] _entity Sampled entity.
+    /// \param[in] _typeId Type id of the sampled component.
+    /// \param[in] _time Sim time in nanoseconds.
+    /// \param[out] _values Values of all fields.
+    /// \param[out] _sampleTime Sim time of the sample.
+    /// \return False if the stream has no samples up to that time.
+    public: bool Sample(uint64_t _entity, uint64_t _typeId, int64_t _time,
+                std::vector<double> &_values, int64_t &_sampleTime);
+
+    /// \brief Whether the entity index written along with the log was
+    /// loaded. Without it, the first query by entity decodes every chunk to
+    /// build the index in memory.
+    /// \return True if the index file was loaded.
+    public: bool HasIndex() const;
+
+    /// \brief All entities with data in the log.
+    /// \return Entity ids, sorted.
+    public: std::vector<uint64_t> Entities();
+
+    /// \brief Chunks which hold data of an entity.
+    /// \param[in] _entity Entity.
+    /// \return Indices into Chunks(), in file order.
+    public: std::vector<std::size_t> EntityChunks(uint64_t _entity);
+
+    /// \brief Go through all data of one entity in the order it was
+    /// recorded. Only chunks which hold data of the entity are decoded.
+    /// \param[in] _entity Entity.
+    /// \param[in] _onStream Called with each chunk's samples of each of the
+    /// entity's streams. Return false to stop.
+    /// \param[in] _onRecord Called with each change of the entity's other
+    /// components. Return false to stop.
+    /// \return False if a chunk is corrupt.
+    public: bool EntityHistory(uint64_t _entity,
+                const std::function<bool(const StateChunkStream &)> &_onStream,
+                const std::function<bool(const StateChunkRecord &)> &_onRecord);
+
+    /// \brief Private data pointer.
+    private: std::unique_ptr<StateChunkMapPrivate> dataPtr;
+  };
+}
+}
+}
+}
+#endif
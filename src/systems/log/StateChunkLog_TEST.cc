@@ -0,0 +1,433 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <ignition/common/Filesystem.hh>
+
+#include "StateChunkLog.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/////////////////////////////////////////////////
+class StateChunkLogTest : public ::testing::Test
+{
+  protected: void SetUp() override
+  {
+    this->path = common::joinPaths(common::cwd(), "state_chunk_test.scl");
+  }
+
+  protected: void TearDown() override
+  {
+    common::removeAll(this->path);
+    common::removeAll(StateChunkIndexPath(this->path));
+  }
+
+  /// \brief Path to the test log.
+  protected: std::string path;
+};
+
+/////////////////////////////////////////////////
+TEST_F(StateChunkLogTest, RoundTrip)
+{
+  const double resolution{1e-4};
+  const int64_t step{1000000};
+  {
+    StateChunkWriter writer(resolution, 100u);
+    ASSERT_TRUE(writer.Open(this->path));
+
+    for (int i = 0; i < 250; ++i)
+    {
+      const double t = i * 1e-3;
+      EXPECT_TRUE(writer.AddSample(1u, 10u, i * step,
+          {t, 2.0 * t, -3.0, 1.0, 0.0, 0.0, 0.0}));
+      EXPECT_TRUE(writer.AddSample(2u, 20u, i * step,
+          {std::sin(t), std::cos(t), 0.5}));
+    }
+
+    // Number of fields can't change within a stream
+    EXPECT_FALSE(writer.AddSample(2u, 20u, 0, {1.0}));
+
+    StateChunkRecord record;
+    record.entity = 3u;
+    record.typeId = 30u;
+    record.time = 5 * step;
+    record.data = "serialized";
+    EXPECT_TRUE(writer.AddRecord(record));
+
+    record.typeId = 0u;
+    record.time = 7 * step;
+    record.remove = true;
+    record.data.clear();
+    EXPECT_TRUE(writer.AddRecord(record));
+
+    EXPECT_TRUE(writer.Flush());
+    EXPECT_LT(writer.WrittenBytes(), writer.RawBytes());
+  }
+
+  StateChunkReader reader;
+  ASSERT_TRUE(reader.Open(this->path));
+  EXPECT_DOUBLE_EQ(resolution, reader.Resolution());
+
+  std::vector<StateChunkStream> streams;
+  std::vector<StateChunkRecord> records;
+  std::vector<int64_t> times1;
+  std::vector<double> x1;
+  std::vector<double> y2;
+  std::vector<StateChunkRecord> allRecords;
+  while (reader.Next(streams, records))
+  {
+    for (const auto &stream : streams)
+    {
+      if (stream.entity == 1u)
+      {
+        EXPECT_EQ(10u, stream.typeId);
+        ASSERT_EQ(7u, stream.fields.size());
+        times1.insert(times1.end(), stream.times.begin(), stream.times.end());
+        x1.insert(x1.end(), stream.fields[0].begin(), stream.fields[0].end());
+      }
+      else
+      {
+        EXPECT_EQ(2u, stream.entity);
+        ASSERT_EQ(3u, stream.fields.size());
+        y2.insert(y2.end(), stream.fields[1].begin(), stream.fields[1].end());
+      }
+    }
+    allRecords.insert(allRecords.end(), records.begin(), records.end());
+  }
+
+  ASSERT_EQ(250u, times1.size());
+  ASSERT_EQ(250u, x1.size());
+  ASSERT_EQ(250u, y2.size());
+  for (int i = 0; i < 250; ++i)
+  {
+    EXPECT_EQ(i * step, times1[i]);
+    EXPECT_NEAR(i * 1e-3, x1[i], resolution);
+    EXPECT_NEAR(std::cos(i * 1e-3), y2[i], resolution);
+  }
+
+  ASSERT_EQ(2u, allRecords.size());
+  EXPECT_EQ(3u, allRecords[0].entity);
+  EXPECT_EQ(30u, allRecords[0].typeId);
+  EXPECT_EQ(5 * step, allRecords[0].time);
+  EXPECT_FALSE(allRecords[0].remove);
+  EXPECT_EQ("serialized", allRecords[0].data);
+  EXPECT_EQ(0u, allRecords[1].typeId);
+  EXPECT_EQ(7 * step, allRecords[1].time);
+  EXPECT_TRUE(allRecords[1].remove);
+}
+
+/////////////////////////////////////////////////
+TEST_F(StateChunkLogTest, Compression)
+{
+  StateChunkWriter writer;
+  ASSERT_TRUE(writer.Open(this->path));
+
+  // A slowly moving body, typical of poses in a log
+  for (int i = 0; i < 10000; ++i)
+  {
+    const double t = i * 1e-3;
+    writer.AddSample(1u, 10u, int64_t{i} * 1000000,
+        {0.1 * t, 0.0, 0.5 - 0.01 * t * t, 1.0, 0.0, 0.0, 0.0});
+  }
+  writer.Close();
+  EXPECT_FALSE(writer.IsOpen());
+
+  EXPECT_LT(writer.WrittenBytes() * 10u, writer.RawBytes());
+}
+
+/////////////////////////////////////////////////
+TEST_F(StateChunkLogTest, ReadWhileWriting)
+{
+  // A single slot queue makes the producer wait on the writer thread
+  StateChunkWriter writer(1e-6, 10u, 1u);
+  ASSERT_TRUE(writer.Open(this->path));
+  for (int i = 0; i < 95; ++i)
+    EXPECT_TRUE(writer.AddSample(1u, 10u, i, {i * 0.5}));
+
+  // Completed chunks are already on disk, without closing the writer
+  EXPECT_TRUE(writer.Flush());
+  EXPECT_TRUE(writer.IsOpen());
+
+  StateChunkReader reader;
+  ASSERT_TRUE(reader.Open(this->path));
+  std::vector<StateChunkStream> streams;
+  std::vector<StateChunkRecord> records;
+  std::size_t chunks{0u};
+  std::size_t samples{0u};
+  while (reader.Next(streams, records))
+  {
+    ++chunks;
+    ASSERT_EQ(1u, streams.size());
+    samples += streams[0].times.size();
+  }
+  EXPECT_EQ(10u, chunks);
+  EXPECT_EQ(95u, samples);
+}
+
+/////////////////////////////////////////////////
+TEST_F(StateChunkLogTest, Invalid)
+{
+  StateChunkWriter writer;
+  EXPECT_FALSE(writer.AddSample(1u, 1u, 0, {1.0}));
+  EXPECT_FALSE(writer.AddRecord(StateChunkRecord()));
+
+  StateChunkReader reader;
+  EXPECT_FALSE(reader.Open(this->path));
+
+  {
+    std::ofstream file(this->path);
+    file << "not a state log";
+  }
+  EXPECT_FALSE(reader.Open(this->path));
+
+  // Truncated chunk
+  ASSERT_TRUE(writer.Open(this->path));
+  writer.AddSample(1u, 1u, 0, {1.0});
+  writer.Close();
+  {
+    std::ofstream file(this->path, std::ios::binary | std::ios::app);
+    file.write("\x01\xff\x00\x00\x00\x10\x00\x00\x00", 9);
+    file.write(std::string(16u, '\0').data(), 16);
+  }
+
+  ASSERT_TRUE(reader.Open(this->path));
+  std::vector<StateChunkStream> streams;
+  std::vector<StateChunkRecord> records;
+  EXPECT_TRUE(reader.Next(streams, records));
+  EXPECT_EQ(1u, streams.size());
+  EXPECT_FALSE(reader.Next(streams, records));
+
+  // The mapped reader skips the truncated chunk
+  StateChunkMap map;
+  ASSERT_TRUE(map.Open(this->path));
+  EXPECT_EQ(1u, map.Chunks().size());
+  EXPECT_FALSE(map.Decode(1u, streams, records));
+  map.Close();
+  EXPECT_FALSE(map.IsOpen());
+
+  common::removeAll(this->path);
+  EXPECT_FALSE(map.Open(this->path));
+}
+
+/////////////////////////////////////////////////
+TEST_F(StateChunkLogTest, RandomAccess)
+{
+  const int64_t step{1000000};
+  {
+    StateChunkWriter writer(1e-6, 50u);
+    ASSERT_TRUE(writer.Open(this->path));
+    for (int i = 0; i < 1000; ++i)
+    {
+      writer.AddSample(1u, 10u, i * step, {i * 0.001, -i * 0.002});
+
+      // Entity 2 is only sampled for a while
+      if (i >= 100 && i < 200)
+        writer.AddSample(2u, 10u, i * step, {1.0 * i});
+
+      if (i % 100 == 0)
+      {
+        StateChunkRecord record;
+        record.entity = 3u;
+        record.typeId = 30u;
+        record.time = i * step;
+        record.data = std::to_string(i);
+        writer.AddRecord(record);
+        writer.Flush();
+      }
+    }
+  }
+
+  StateChunkMap map;
+  ASSERT_TRUE(map.Open(this->path));
+  EXPECT_DOUBLE_EQ(1e-6, map.Resolution());
+
+  // Chunks cover increasing time ranges
+  const auto &chunks = map.Chunks();
+  ASSERT_LT(20u, chunks.size());
+  int64_t lastStreamEnd{-1};
+  for (const auto &chunk : chunks)
+  {
+    EXPECT_LE(chunk.startTime, chunk.endTime);
+    if (chunk.streams)
+    {
+      EXPECT_GE(chunk.startTime, lastStreamEnd);
+      lastStreamEnd = chunk.endTime;
+    }
+  }
+
+  // Only chunks within the range are returned, and they decode to data
+  // within it
+  std::vector<StateChunkStream> streams;
+  std::vector<StateChunkRecord> records;
+  std::size_t recordCount{0u};
+  auto indices = map.ChunksBetween(450 * step, 520 * step);
+  ASSERT_FALSE(indices.empty());
+  EXPECT_GT(chunks.size(), indices.size());
+  for (auto index : indices)
+  {
+    ASSERT_TRUE(map.Decode(index, streams, records));
+    for (const auto &stream : streams)
+    {
+      EXPECT_LE(450 * step, stream.times.back());
+      EXPECT_GE(520 * step, stream.times.front());
+    }
+    for (const auto &record : records)
+    {
+      EXPECT_EQ(500 * step, record.time);
+      EXPECT_EQ("500", record.data);
+      ++recordCount;
+    }
+  }
+  EXPECT_EQ(1u, recordCount);
+
+  // Latest sample at or before arbitrary times, in any order
+  std::vector<double> values;
+  int64_t sampleTime{0};
+  for (int i : {999, 3, 517, 516, 0, 250})
+  {
+    ASSERT_TRUE(map.Sample(1u, 10u, i * step + step / 2, values,
+        sampleTime)) << i;
+    EXPECT_EQ(i * step, sampleTime);
+    ASSERT_EQ(2u, values.size());
+    EXPECT_NEAR(i * 0.001, values[0], 1e-6);
+    EXPECT_NEAR(-i * 0.002, values[1], 1e-6);
+  }
+
+  // Stream which stopped being sampled keeps its last value
+  ASSERT_TRUE(map.Sample(2u, 10u, 900 * step, values, sampleTime));
+  EXPECT_EQ(199 * step, sampleTime);
+  EXPECT_NEAR(199.0, values[0], 1e-6);
+
+  EXPECT_FALSE(map.Sample(2u, 10u, 99 * step, values, sampleTime));
+  EXPECT_FALSE(map.Sample(1u, 10u, -1, values, sampleTime));
+  EXPECT_FALSE(map.Sample(5u, 10u, 500 * step, values, sampleTime));
+}
+
+/////////////////////////////////////////////////
+TEST_F(StateChunkLogTest, EntityIndex)
+{
+  const int64_t step{1000000};
+  auto write = [&]()
+  {
+    StateChunkWriter writer(1e-6, 20u);
+    ASSERT_TRUE(writer.Open(this->path));
+    for (int i = 0; i < 200; ++i)
+    {
+      writer.AddSample(1u, 10u, i * step, {i * 1.0});
+
+      // Entity 2 only moves at the end
+      if (i >= 180)
+        writer.AddSample(2u, 10u, i * step, {-i * 1.0});
+
+      if (i == 50 || i == 150)
+      {
+        StateChunkRecord record;
+        record.entity = 2u;
+        record.typeId = 30u;
+        record.time = i * step;
+        record.data = std::to_string(i);
+        writer.AddRecord(record);
+        writer.Flush();
+      }
+    }
+  };
+  write();
+  ASSERT_TRUE(common::exists(StateChunkIndexPath(this->path)));
+
+  auto check = [&](StateChunkMap &_map)
+  {
+    EXPECT_EQ((std::vector<uint64_t>{1u, 2u}), _map.Entities());
+    EXPECT_TRUE(_map.EntityChunks(3u).empty());
+
+    // Entity 2 is only in a few of the chunks
+    auto chunks = _map.EntityChunks(2u);
+    ASSERT_FALSE(chunks.empty());
+    EXPECT_LT(chunks.size() * 2u, _map.Chunks().size()) << chunks.size();
+
+    std::vector<int64_t> times;
+    std::vector<std::string> records;
+    EXPECT_TRUE(_map.EntityHistory(2u,
+        [&](const StateChunkStream &_stream)
+        {
+          EXPECT_EQ(2u, _stream.entity);
+          times.insert(times.end(), _stream.times.begin(),
+              _stream.times.end());
+          return true;
+        },
+        [&](const StateChunkRecord &_record)
+        {
+          EXPECT_EQ(2u, _record.entity);
+          records.push_back(_record.data);
+          return true;
+        }));
+    ASSERT_EQ(20u, times.size());
+    EXPECT_EQ(180 * step, times.front());
+    EXPECT_EQ(199 * step, times.back());
+    EXPECT_EQ((std::vector<std::string>{"50", "150"}), records);
+
+    // Stop early
+    int calls{0};
+    EXPECT_TRUE(_map.EntityHistory(1u,
+        [&](const StateChunkStream &)
+        {
+          return ++calls < 2;
+        }, nullptr));
+    EXPECT_EQ(2, calls);
+  };
+
+  {
+    StateChunkMap map;
+    ASSERT_TRUE(map.Open(this->path));
+    EXPECT_TRUE(map.HasIndex());
+    check(map);
+  }
+
+  // Without the index, it's built by scanning the log
+  common::removeAll(StateChunkIndexPath(this->path));
+  {
+    StateChunkMap map;
+    ASSERT_TRUE(map.Open(this->path));
+    EXPECT_FALSE(map.HasIndex());
+    check(map);
+  }
+
+  // An index which doesn't match the log is ignored
+  write();
+  {
+    std::ofstream file(this->path, std::ios::binary | std::ios::app);
+    file.write("garbage", 7);
+  }
+  {
+    std::ofstream file(StateChunkIndexPath(this->path),
+        std::ios::binary | std::ios::app);
+    file.write("\x01", 1);
+  }
+  {
+    StateChunkMap map;
+    ASSERT_TRUE(map.Open(this->path));
+    EXPECT_FALSE(map.HasIndex());
+    check(map);
+  }
+}
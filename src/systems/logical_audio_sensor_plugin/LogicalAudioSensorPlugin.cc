@@ -24,6 +24,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <ignition/gazebo/components/LogicalAudio.hh>
 #include <ignition/gazebo/components/Model.hh>
@@ -212,48 +213,75 @@ void LogicalAudioSensorPlugin::PostUpdate(const UpdateInfo &_info,
     std::chrono::duration_cast<std::chrono::nanoseconds>(_info.simTime);
   const auto nanosecondOffset = (simNanoseconds - simSeconds).count();
 
+  // Sources which aren't playing can't be heard. The world poses of the
+  // others are computed once, instead of once per microphone.
+  struct PlayingSource
+  {
+    Entity entity;
+    const logical_audio::Source *source;
+    math::Pose3d pose;
+  };
+  std::vector<PlayingSource> sources;
+  _ecm.Each<components::LogicalAudioSource,
+            components::LogicalAudioSourcePlayInfo>(
+    [&](const Entity &_entity,
+        const components::LogicalAudioSource *_source,
+        const components::LogicalAudioSourcePlayInfo *_playInfo)
+    {
+      if (_playInfo->Data().playing)
+        sources.push_back({_entity, &_source->Data(),
+            worldPose(_entity, _ecm)});
+      return true;
+    });
+  if (sources.empty())
+    return;
+
   for (auto & [micEntity, detectionPub] : this->dataPtr->micEntities)
   {
     const auto micPose = worldPose(micEntity, _ecm);
     const auto micInfo = _ecm.Component<components::LogicalMicrophone>(
         micEntity)->Data();
 
-    _ecm.Each<components::LogicalAudioSource,
-              components::LogicalAudioSourcePlayInfo>(
-      [&, &publisher = detectionPub](const Entity &_entity,
-          const components::LogicalAudioSource *_source,
-          const components::LogicalAudioSourcePlayInfo *_playInfo)
+    for (const auto &playing : sources)
+    {
+      const auto &source = *playing.source;
+
+      // Sources are silent beyond their falloff distance
+      const double distanceSquared =
+          (playing.pose.Pos() - micPose.Pos()).SquaredLength();
+      if (distanceSquared >= source.falloffDistance * source.falloffDistance &&
+          distanceSquared > source.innerRadius * source.innerRadius)
       {
-        const auto sourcePose = worldPose(_entity, _ecm);
-        const auto vol = logical_audio::computeVolume(
-            _playInfo->Data().playing,
-            _source->Data().attFunc,
-            _source->Data().attShape,
-            _source->Data().emissionVolume,
-            _source->Data().innerRadius,
-            _source->Data().falloffDistance,
-            sourcePose,
-            micPose);
-
-        if (logical_audio::detect(vol, micInfo.volumeDetectionThreshold))
-        {
-          // publish the source that the microphone heard, along with the
-          // volume level the microphone detected. The detected source's
-          // ID is embedded in the message's header
-          msgs::Double msg;
-          auto header = msg.mutable_header();
-          auto timeStamp = header->mutable_stamp();
-          timeStamp->set_sec(simSeconds.count());
-          timeStamp->set_nsec(nanosecondOffset);
-          auto headerData = header->add_data();
-          headerData->set_key(scopedName(_entity, _ecm));
-          msg.set_data(vol);
-
-          publisher.Publish(msg);
-        }
-
-        return true;
-      });
+        continue;
+      }
+
+      const auto vol = logical_audio::computeVolume(
+          true,
+          source.attFunc,
+          source.attShape,
+          source.emissionVolume,
+          source.innerRadius,
+          source.falloffDistance,
+          playing.pose,
+          micPose);
+
+      if (logical_audio::detect(vol, micInfo.volumeDetectionThreshold))
+      {
+        // publish the source that the microphone heard, along with the
+        // volume level the microphone detected. The detected source's
+        // ID is embedded in the message's header
+        msgs::Double msg;
+        auto header = msg.mutable_header();
+        auto timeStamp = header->mutable_stamp();
+        timeStamp->set_sec(simSeconds.count());
+        timeStamp->set_nsec(nanosecondOffset);
+        auto headerData = header->add_data();
+        headerData->set_key(scopedName(playing.entity, _ecm));
+        msg.set_data(vol);
+
+        detectionPub.Publish(msg);
+      }
+    }
   }
 }
 
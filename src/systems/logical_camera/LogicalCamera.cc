@@ -19,17 +19,21 @@
 
 #include <ignition/msgs/logical_camera_image.pb.h>
 
+#include <algorithm>
+#include <cmath>
 #include <map>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <ignition/common/Profiler.hh>
 #include <ignition/plugin/Register.hh>
 
 #include <sdf/Sensor.hh>
 
+#include <ignition/math/Frustum.hh>
 #include <ignition/math/Helpers.hh>
 #include <ignition/transport/Node.hh>
 
@@ -38,12 +42,13 @@
 
 #include "ignition/gazebo/components/LogicalCamera.hh"
 #include "ignition/gazebo/components/Name.hh"
-#include "ignition/gazebo/components/Model.hh"
 #include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/Sensor.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/SensorScheduler.hh"
+#include "ignition/gazebo/SpatialIndex.hh"
 #include "ignition/gazebo/Util.hh"
 
 using namespace ignition;
@@ -57,6 +62,9 @@ class ignition::gazebo::systems::LogicalCameraPrivate
   public: std::unordered_map<Entity,
       std::unique_ptr<sensors::LogicalCameraSensor>> entitySensorMap;
 
+  /// \brief Wakes the sensors when they're due
+  public: SensorScheduler scheduler;
+
   /// \brief Ign-sensors sensor factory for creating sensors
   public: sensors::SensorFactory sensorFactory;
 
@@ -68,6 +76,10 @@ class ignition::gazebo::systems::LogicalCameraPrivate
   /// True if the rendering component is initialized
   public: bool initialized = false;
 
+  /// \brief Index used to find the models within the range of each
+  /// camera, set on the first update.
+  public: std::shared_ptr<SpatialIndex> spatialIndex;
+
   /// \brief Create sensor
   /// \param[in] _ecm Immutable reference to ECM.
   /// \param[in] _entity Entity of the IMU
@@ -84,8 +96,19 @@ class ignition::gazebo::systems::LogicalCameraPrivate
   public: void CreateSensors(const EntityComponentManager &_ecm);
 
   /// \brief Update logicalCamera sensor data based on physics data
+  /// \param[in] _info Current simulation information.
   /// \param[in] _ecm Immutable reference to ECM.
-  public: void UpdateLogicalCameras(const EntityComponentManager &_ecm);
+  public: void UpdateLogicalCameras(const UpdateInfo &_info,
+      const EntityComponentManager &_ecm);
+
+  /// \brief Find the models whose origins are in a camera's frustum.
+  /// \param[in] _ecm Immutable reference to ECM.
+  /// \param[in] _sensor Logical camera.
+  /// \param[in] _worldPose World pose of the camera.
+  /// \param[out] _models Models in the frustum. It's cleared first.
+  public: void ModelsInFrustum(const EntityComponentManager &_ecm,
+      const sensors::LogicalCameraSensor &_sensor,
+      const math::Pose3d &_worldPose, std::vector<Entity> &_models) const;
 
   /// \brief Remove logicalCamera sensors if their entities have been removed
   /// from simulation.
@@ -143,32 +166,11 @@ void LogicalCamera::PostUpdate(const UpdateInfo &_info,
   // Only update and publish if not paused.
   if (!_info.paused)
   {
-    // check to see if update is necessary
-    // we only update if there is at least one sensor that needs data
-    // and that sensor has subscribers.
-    // note: ign-sensors does its own throttling. Here the check is mainly
-    // to avoid doing work in the LogicalCameraPrivate::UpdateLogicalCameras
-    // function
-    bool needsUpdate = false;
-    for (auto &it : this->dataPtr->entitySensorMap)
-    {
-      if (it.second->NextDataUpdateTime() <= _info.simTime &&
-          it.second->HasConnections())
-      {
-        needsUpdate = true;
-        break;
-      }
-    }
-    if (!needsUpdate)
-      return;
-
-    this->dataPtr->UpdateLogicalCameras(_ecm);
-
-    for (auto &it : this->dataPtr->entitySensorMap)
-    {
-      // Update sensor
-      it.second.get()->sensors::Sensor::Update(_info.simTime, false);
-    }
+    this->dataPtr->scheduler.UpdateDue<sensors::Sensor>(_info.simTime,
+        this->dataPtr->entitySensorMap, [&]
+        {
+          this->dataPtr->UpdateLogicalCameras(_info, _ecm);
+        });
   }
 
   this->dataPtr->RemoveLogicalCameraEntities(_ecm);
@@ -213,6 +215,8 @@ void LogicalCameraPrivate::AddLogicalCamera(
 
   this->entitySensorMap.insert(
       std::make_pair(_entity, std::move(sensor)));
+  this->scheduler.Schedule(_entity,
+      std::chrono::steady_clock::duration::zero());
   this->newSensors.insert(_entity);
 }
 
@@ -249,47 +253,95 @@ void LogicalCameraPrivate::CreateSensors(const EntityComponentManager &_ecm)
 }
 
 //////////////////////////////////////////////////
-void LogicalCameraPrivate::UpdateLogicalCameras(
+void LogicalCameraPrivate::UpdateLogicalCameras(const UpdateInfo &_info,
     const EntityComponentManager &_ecm)
 {
   IGN_PROFILE("LogicalCameraPrivate::UpdateLogicalCameras");
-  std::map<std::string, math::Pose3d> modelPoses;
-
-  _ecm.Each<components::Model, components::Name, components::Pose>(
-      [&](const Entity &,
-        const components::Model *,
-        const components::Name *_name,
-        const components::Pose *_pose)->bool
+  if (!this->spatialIndex)
+    this->spatialIndex = SpatialIndex::For(_ecm);
+  this->spatialIndex->Update(_info, _ecm);
+
+  // Cameras are independent, and index queries and component reads are
+  // safe from several threads
+  const auto &due = this->scheduler.DueSensors();
+  _ecm.ParallelFor(due.size(), [&](std::size_t _first, std::size_t _last)
+    {
+      std::vector<Entity> models;
+      for (std::size_t i = _first; i < _last; ++i)
       {
-        /// todo(anyone) We currently assume there are only top level models
-        /// Update to retrieve world pose when nested models are supported.
-        modelPoses[_name->Data()] = _pose->Data();
-        return true;
-      });
+        auto it = this->entitySensorMap.find(due[i]);
+        auto worldPose = _ecm.Component<components::WorldPose>(due[i]);
+        if (it == this->entitySensorMap.end() || nullptr == worldPose)
+          continue;
 
+        auto &sensor = *it->second;
+        sensor.SetPose(worldPose->Data());
+        this->ModelsInFrustum(_ecm, sensor, worldPose->Data(), models);
 
-  _ecm.Each<components::LogicalCamera, components::WorldPose>(
-    [&](const Entity &_entity,
-        const components::LogicalCamera * /*_logicalCamera*/,
-        const components::WorldPose *_worldPose)->bool
-      {
-        auto it = this->entitySensorMap.find(_entity);
-        if (it != this->entitySensorMap.end())
+        std::map<std::string, math::Pose3d> modelPoses;
+        for (const auto &model : models)
         {
-          const math::Pose3d &worldPose = _worldPose->Data();
-          it->second->SetPose(worldPose);
-          // Make a copy of modelPoses s.t. SetModelPoses can take ownership
-          auto modelPoses_ = modelPoses;
-          it->second->SetModelPoses(std::move(modelPoses_));
-        }
-        else
-        {
-          ignerr << "Failed to update logicalCamera: " << _entity << ". "
-                 << "Entity not found." << std::endl;
+          auto name = _ecm.Component<components::Name>(model);
+          auto pose = _ecm.Component<components::Pose>(model);
+          if (nullptr == name || nullptr == pose)
+            continue;
+
+          /// todo(anyone) We currently assume there are only top level
+          /// models. Update to retrieve world pose when nested models are
+          /// supported.
+          modelPoses[name->Data()] = pose->Data();
         }
+        sensor.SetModelPoses(std::move(modelPoses));
+      }
+    }, 4u);
+}
 
-        return true;
-      });
+//////////////////////////////////////////////////
+void LogicalCameraPrivate::ModelsInFrustum(
+    const EntityComponentManager &_ecm,
+    const sensors::LogicalCameraSensor &_sensor,
+    const math::Pose3d &_worldPose, std::vector<Entity> &_models) const
+{
+  // Models beyond the far clip distance can't be in the frustum. Very wide
+  // frusta have unbounded boxes, so use the sphere.
+  const double halfFov = _sensor.HorizontalFOV().Radian() * 0.5;
+  if (halfFov >= IGN_PI * 0.45 || _sensor.AspectRatio() <= 0.0)
+  {
+    this->spatialIndex->WithinRadius(_worldPose.Pos(), _sensor.Far(),
+        _models);
+    return;
+  }
+
+  // Box around the frustum's corners, which looks along +X
+  const double halfWidth = std::tan(halfFov);
+  const double halfHeight = halfWidth / _sensor.AspectRatio();
+  math::Vector3d min(math::MAX_D, math::MAX_D, math::MAX_D);
+  math::Vector3d max(-math::MAX_D, -math::MAX_D, -math::MAX_D);
+  for (double dist : {_sensor.Near(), _sensor.Far()})
+  {
+    for (double y : {-1.0, 1.0})
+    {
+      for (double z : {-1.0, 1.0})
+      {
+        auto corner = _worldPose.CoordPositionAdd(math::Vector3d(dist,
+            y * dist * halfWidth, z * dist * halfHeight));
+        min.Min(corner);
+        max.Max(corner);
+      }
+    }
+  }
+  this->spatialIndex->Overlapping(math::AxisAlignedBox(min, max), _models);
+
+  // Only pass the models which the sensor will report. It tests the
+  // models' origins against the frustum too.
+  math::Frustum frustum(_sensor.Near(), _sensor.Far(),
+      _sensor.HorizontalFOV(), _sensor.AspectRatio(), _worldPose);
+  _models.erase(std::remove_if(_models.begin(), _models.end(),
+      [&](const Entity &_model)
+      {
+        auto pose = _ecm.Component<components::Pose>(_model);
+        return nullptr == pose || !frustum.Contains(pose->Data().Pos());
+      }), _models.end());
 }
 
 //////////////////////////////////////////////////
@@ -310,6 +362,7 @@ void LogicalCameraPrivate::RemoveLogicalCameraEntities(
         }
 
         this->entitySensorMap.erase(sensorIt);
+        this->scheduler.Remove(_entity);
 
         return true;
       });
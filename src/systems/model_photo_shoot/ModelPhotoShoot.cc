@@ -16,16 +16,30 @@
  */
 #include "ModelPhotoShoot.hh"
 
+#include <ignition/msgs/boolean.pb.h>
+#include <ignition/msgs/server_control.pb.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <mutex>
 #include <random>
 #include <string>
+#include <thread>
+#include <variant>
 #include <vector>
 
+#include <ignition/common/Filesystem.hh>
 #include <ignition/common/Image.hh>
+#include <ignition/common/StringUtils.hh>
 #include <ignition/plugin/Register.hh>
 #include <ignition/rendering/Camera.hh>
 #include <ignition/rendering/Scene.hh>
 #include <ignition/rendering/RenderingIface.hh>
 #include <ignition/rendering/Visual.hh>
+#include <ignition/transport/Node.hh>
 
 #include "ignition/gazebo/components/Joint.hh"
 #include "ignition/gazebo/components/JointAxis.hh"
@@ -36,22 +50,55 @@
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/Model.hh"
 #include "ignition/gazebo/rendering/Events.hh"
+#include "ignition/gazebo/SdfEntityCreator.hh"
 #include "ignition/gazebo/Util.hh"
 
 using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+/// \brief An image captured in batch mode, waiting to be written.
+struct PendingImage
+{
+  /// \brief Pixel data.
+  std::vector<unsigned char> data;
+
+  /// \brief Width in pixels.
+  unsigned int width{0u};
+
+  /// \brief Height in pixels.
+  unsigned int height{0u};
+
+  /// \brief Pixel format.
+  ignition::common::Image::PixelFormatType format{
+      ignition::common::Image::UNKNOWN_PIXEL_FORMAT};
+
+  /// \brief Path of the file to write.
+  std::string fileName;
+};
+
 /// \brief Private ModelPhotoShoot data class.
 class ignition::gazebo::systems::ModelPhotoShootPrivate
 {
   /// \brief Callback for pos rendering operations.
   public: void PerformPostRenderingOperations();
 
-  /// \brief Save a pitcture with the camera from the given pose.
+  /// \brief Save a pitcture with the camera from the given pose. In batch
+  /// mode, the image is queued for the writer thread instead.
   public: void SavePicture (const ignition::rendering::CameraPtr _camera,
                     const ignition::math::Pose3d &_pose,
-                    const std::string &_fileName) const;
+                    const std::string &_fileName);
+
+  /// \brief Body of the writer thread, which saves queued images.
+  public: void WriteImages();
+
+  /// \brief Start parsing the next model of the batch in the background.
+  public: void ParseNextModel();
+
+  /// \brief Replace the photographed model by the next one of the batch,
+  /// or stop the server once the batch is done.
+  /// \param[in] _ecm Entity component manager.
+  public: void NextModel(ignition::gazebo::EntityComponentManager &_ecm);
 
   /// \brief Name of the loaded model.
   public: std::string modelName;
@@ -71,8 +118,69 @@ class ignition::gazebo::systems::ModelPhotoShootPrivate
   /// \brief Boolean to control if joints should adopt random poses.
   public: bool randomPoses{false};
 
+  /// \brief Whether each model's joints should adopt random poses.
+  public: bool randomJointsPose{false};
+
   /// \brief File to save translation and scaling info.
   public: std::ofstream savingFile;
+
+  /// \brief Protects modelName, modelEntity, modelPose3D and takePicture,
+  /// which are shared with the rendering thread.
+  public: std::mutex mutex;
+
+  /// \brief Entity of the photographed model.
+  public: Entity modelEntity{kNullEntity};
+
+  /// \brief Whether batch mode is enabled.
+  public: bool batch{false};
+
+  /// \brief URIs of the batch models which haven't been parsed yet.
+  public: std::deque<std::string> batchUris;
+
+  /// \brief Directory where batch images are written.
+  public: std::string outputDir{"."};
+
+  /// \brief URI of the model being parsed.
+  public: std::string nextUri;
+
+  /// \brief Model being parsed in the background.
+  public: std::future<std::shared_ptr<sdf::Root>> nextModel;
+
+  /// \brief Creates the batch models.
+  public: std::unique_ptr<SdfEntityCreator> creator;
+
+  /// \brief World entity.
+  public: Entity worldEntity{kNullEntity};
+
+  /// \brief Whether the server was asked to stop after the batch.
+  public: bool batchDone{false};
+
+  /// \brief Camera used for pictures, found once. Only used by the
+  /// rendering thread.
+  public: ignition::rendering::CameraPtr camera;
+
+  /// \brief Whether the lights were added to the scene. Only used by the
+  /// rendering thread.
+  public: bool lightsCreated{false};
+
+  /// \brief Images waiting to be written. Protected by imagesMutex.
+  public: std::deque<PendingImage> images;
+
+  /// \brief Whether the writer thread should stop once the queue is
+  /// empty. Protected by imagesMutex.
+  public: bool stopWriter{false};
+
+  /// \brief Protects images and stopWriter.
+  public: std::mutex imagesMutex;
+
+  /// \brief Wakes up the writer thread.
+  public: std::condition_variable imagesCv;
+
+  /// \brief Writes batch images, so encoding them doesn't stall rendering.
+  public: std::thread writer;
+
+  /// \brief Node used to stop the server after the batch.
+  public: transport::Node node;
 };
 
 //////////////////////////////////////////////////
@@ -81,6 +189,22 @@ ModelPhotoShoot::ModelPhotoShoot()
 {
 }
 
+//////////////////////////////////////////////////
+ModelPhotoShoot::~ModelPhotoShoot()
+{
+  if (this->dataPtr->writer.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->imagesMutex);
+      this->dataPtr->stopWriter = true;
+    }
+    this->dataPtr->imagesCv.notify_all();
+    this->dataPtr->writer.join();
+  }
+  if (this->dataPtr->nextModel.valid())
+    this->dataPtr->nextModel.wait();
+}
+
 //////////////////////////////////////////////////
 void ModelPhotoShoot::Configure(const ignition::gazebo::Entity &_entity,
                                 const std::shared_ptr<const sdf::Element> &_sdf,
@@ -103,7 +227,51 @@ void ModelPhotoShoot::Configure(const ignition::gazebo::Entity &_entity,
 
   if (_sdf->HasElement("random_joints_pose"))
   {
-    this->dataPtr->randomPoses = _sdf->Get<bool>("random_joints_pose");
+    this->dataPtr->randomJointsPose = _sdf->Get<bool>("random_joints_pose");
+    this->dataPtr->randomPoses = this->dataPtr->randomJointsPose;
+  }
+
+  if (_sdf->HasElement("batch"))
+  {
+    auto batchElem = _sdf->FindElement("batch");
+    for (auto modelElem = batchElem->FindElement("model"); modelElem;
+        modelElem = modelElem->GetNextElement("model"))
+    {
+      this->dataPtr->batchUris.push_back(modelElem->Get<std::string>());
+    }
+
+    if (batchElem->HasElement("model_list"))
+    {
+      auto listPath = batchElem->Get<std::string>("model_list");
+      std::ifstream list(listPath);
+      if (!list.is_open())
+      {
+        ignerr << "Failed to open model list [" << listPath << "]"
+               << std::endl;
+      }
+      std::string line;
+      while (std::getline(list, line))
+      {
+        common::trim(line);
+        if (!line.empty() && line[0] != '#')
+          this->dataPtr->batchUris.push_back(line);
+      }
+    }
+
+    if (batchElem->HasElement("output_dir"))
+    {
+      this->dataPtr->outputDir = batchElem->Get<std::string>("output_dir");
+    }
+
+    this->dataPtr->batch = true;
+    this->dataPtr->worldEntity = worldEntity(_entity, _ecm);
+    this->dataPtr->creator =
+        std::make_unique<SdfEntityCreator>(_ecm, _eventMgr);
+    this->dataPtr->writer = std::thread(&ModelPhotoShootPrivate::WriteImages,
+        this->dataPtr.get());
+    this->dataPtr->ParseNextModel();
+    ignmsg << "Taking pictures of ["
+           << this->dataPtr->batchUris.size() + 1 << "] models." << std::endl;
   }
 
   this->dataPtr->connection =
@@ -113,6 +281,7 @@ void ModelPhotoShoot::Configure(const ignition::gazebo::Entity &_entity,
 
   this->dataPtr->model = std::make_shared<ignition::gazebo::Model>(_entity);
   this->dataPtr->modelName = this->dataPtr->model->Name(_ecm);
+  this->dataPtr->modelEntity = _entity;
   // Get the pose of the model
   this->dataPtr->modelPose3D =
       ignition::gazebo::worldPose(this->dataPtr->model->Entity(), _ecm);
@@ -193,93 +362,273 @@ void ModelPhotoShoot::PreUpdate(
     // Only set random joint poses once
     this->dataPtr->randomPoses = false;
   }
+
+  if (this->dataPtr->batch)
+  {
+    {
+      // Still waiting for the pictures of the current model
+      std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+      if (this->dataPtr->takePicture)
+        return;
+    }
+    this->dataPtr->NextModel(_ecm);
+  }
+}
+
+//////////////////////////////////////////////////
+void ModelPhotoShootPrivate::ParseNextModel()
+{
+  if (this->batchUris.empty())
+    return;
+
+  this->nextUri = this->batchUris.front();
+  this->batchUris.pop_front();
+
+  // Parsing may download the model, so it's done while the previous model
+  // is photographed
+  this->nextModel = std::async(std::launch::async,
+      [uri = this->nextUri]() -> std::shared_ptr<sdf::Root>
+  {
+    auto root = std::make_shared<sdf::Root>();
+    auto errors = root->Load(uri);
+    if (!errors.empty() || nullptr == root->Model())
+    {
+      ignerr << "Failed to load model [" << uri << "]:" << std::endl;
+      for (const auto &error : errors)
+        ignerr << error << std::endl;
+      return nullptr;
+    }
+    return root;
+  });
+}
+
+//////////////////////////////////////////////////
+void ModelPhotoShootPrivate::NextModel(
+    ignition::gazebo::EntityComponentManager &_ecm)
+{
+  // Remove the model whose pictures were taken
+  if (this->model)
+  {
+    this->creator->RequestRemoveEntity(this->model->Entity());
+    this->model.reset();
+  }
+
+  if (!this->nextModel.valid())
+  {
+    if (this->batchDone)
+      return;
+
+    // Stop once all images are written
+    {
+      std::lock_guard<std::mutex> lock(this->imagesMutex);
+      if (!this->images.empty())
+        return;
+    }
+
+    ignmsg << "Finished taking pictures, stopping the server." << std::endl;
+    this->batchDone = true;
+    msgs::ServerControl req;
+    req.set_stop(true);
+    msgs::Boolean rep;
+    bool result{false};
+    if (!this->node.Request("/server_control", req, 1000u, rep, result) ||
+        !result)
+    {
+      ignwarn << "Failed to stop the server." << std::endl;
+    }
+    return;
+  }
+
+  // Don't block simulation while the next model is downloaded
+  if (this->nextModel.wait_for(std::chrono::seconds(0)) !=
+      std::future_status::ready)
+  {
+    return;
+  }
+
+  auto root = this->nextModel.get();
+  auto uri = this->nextUri;
+  this->ParseNextModel();
+  if (!root)
+    return;
+
+  sdf::Model sdfModel = *root->Model();
+  sdfModel.SetRawPose(this->modelPose3D);
+  auto entity = this->creator->CreateEntities(&sdfModel);
+  this->creator->SetParent(entity, this->worldEntity);
+  this->model = std::make_shared<ignition::gazebo::Model>(entity);
+  this->randomPoses = this->randomJointsPose;
+
+  if (this->savingFile.is_open())
+    this->savingFile << "Model: " << uri << std::endl;
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->modelName = this->model->Name(_ecm);
+  this->modelEntity = entity;
+  this->takePicture = true;
+}
+
+//////////////////////////////////////////////////
+void ModelPhotoShootPrivate::WriteImages()
+{
+  while (true)
+  {
+    PendingImage pending;
+    {
+      std::unique_lock<std::mutex> lock(this->imagesMutex);
+      this->imagesCv.wait(lock, [this]
+      {
+        return this->stopWriter || !this->images.empty();
+      });
+      if (this->images.empty())
+        return;
+      pending = std::move(this->images.front());
+    }
+
+    ignition::common::Image image;
+    image.SetFromData(pending.data.data(), pending.width, pending.height,
+        pending.format);
+    image.SavePNG(pending.fileName);
+    igndbg << "Saved image to [" << pending.fileName << "]" << std::endl;
+
+    // Only pop once written, so the batch isn't done before its images
+    std::lock_guard<std::mutex> lock(this->imagesMutex);
+    this->images.pop_front();
+  }
 }
 
 //////////////////////////////////////////////////
 void ModelPhotoShootPrivate::PerformPostRenderingOperations()
 {
+  std::string name;
+  Entity entity{kNullEntity};
+  math::Pose3d modelPose;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!this->takePicture)
+      return;
+    name = this->modelName;
+    entity = this->modelEntity;
+    modelPose = this->modelPose3D;
+  }
+
   ignition::rendering::ScenePtr scene =
       ignition::rendering::sceneFromFirstRenderEngine();
   ignition::rendering::VisualPtr modelVisual =
-      scene->VisualByName(this->modelName);
+      scene->VisualByName(name);
+
+  // In batch mode, the visual of a previous model with the same name may
+  // not have been removed yet
+  if (modelVisual && this->batch)
+  {
+    auto visualEntity = modelVisual->UserData("gazebo-entity");
+    auto visualId = std::get_if<int>(&visualEntity);
+    if (nullptr == visualId || static_cast<Entity>(*visualId) != entity)
+      return;
+  }
 
   ignition::rendering::VisualPtr root = scene->RootVisual();
 
-  if (modelVisual && this->takePicture)
+  if (modelVisual)
   {
-    scene->SetAmbientLight(0.3, 0.3, 0.3);
-
-    // create directional light
-    ignition::rendering::DirectionalLightPtr light0 =
-        scene->CreateDirectionalLight();
-    light0->SetDirection(-0.5, 0.5, -1);
-    light0->SetDiffuseColor(0.8, 0.8, 0.8);
-    light0->SetSpecularColor(0.5, 0.5, 0.5);
-    root->AddChild(light0);
-
-    // create point light
-    ignition::rendering::PointLightPtr light2 = scene->CreatePointLight();
-    light2->SetDiffuseColor(0.5, 0.5, 0.5);
-    light2->SetSpecularColor(0.5, 0.5, 0.5);
-    light2->SetLocalPosition(3, 5, 5);
-    root->AddChild(light2);
-
-    for (unsigned int i = 0; i < scene->NodeCount(); ++i)
+    // Lights are kept for the following models in batch mode
+    if (!this->lightsCreated)
+    {
+      scene->SetAmbientLight(0.3, 0.3, 0.3);
+
+      // create directional light
+      ignition::rendering::DirectionalLightPtr light0 =
+          scene->CreateDirectionalLight();
+      light0->SetDirection(-0.5, 0.5, -1);
+      light0->SetDiffuseColor(0.8, 0.8, 0.8);
+      light0->SetSpecularColor(0.5, 0.5, 0.5);
+      root->AddChild(light0);
+
+      // create point light
+      ignition::rendering::PointLightPtr light2 = scene->CreatePointLight();
+      light2->SetDiffuseColor(0.5, 0.5, 0.5);
+      light2->SetSpecularColor(0.5, 0.5, 0.5);
+      light2->SetLocalPosition(3, 5, 5);
+      root->AddChild(light2);
+      this->lightsCreated = true;
+    }
+
+    for (unsigned int i = 0; nullptr == this->camera &&
+        i < scene->NodeCount(); ++i)
     {
       auto camera = std::dynamic_pointer_cast<ignition::rendering::Camera>(
           scene->NodeByIndex(i));
       if (nullptr != camera && camera->Name() == "photo_shoot::link::camera")
+        this->camera = camera;
+    }
+
+    if (nullptr != this->camera)
+    {
+      auto camera = this->camera;
+
+      // Each model of a batch has its own directory
+      std::string prefix;
+      if (this->batch)
       {
-        // Compute the translation we have to apply to the cameras to
-        // center the model in the image.
-        ignition::math::AxisAlignedBox bbox = modelVisual->LocalBoundingBox();
-        double scaling = 1.0 / bbox.Size().Max();
-        ignition::math::Vector3d bboxCenter = bbox.Center();
-        ignition::math::Vector3d translation =
-            bboxCenter + this->modelPose3D.Pos();
-        if (this->savingFile.is_open()) {
-          this->savingFile << "Translation: " << translation << std::endl;
-          this->savingFile << "Scaling: " << scaling << std::endl;
+        prefix = common::joinPaths(this->outputDir, name);
+        if (!common::exists(prefix) && !common::createDirectories(prefix))
+        {
+          ignerr << "Failed to create directory [" << prefix << "]"
+                 << std::endl;
         }
+        prefix += "/";
+      }
 
-        ignition::math::Pose3d pose;
-        // Perspective view
-        pose.Pos().Set(1.6 / scaling + translation.X(),
-                       -1.6 / scaling + translation.Y(),
-                       1.2 / scaling + translation.Z());
-        pose.Rot().Euler(0, IGN_DTOR(30), IGN_DTOR(-225));
-        SavePicture(camera, pose, "1.png");
-
-        // Top view
-        pose.Pos().Set(0 + translation.X(),
-                       0 + translation.Y(),
-                       2.2 / scaling + translation.Z());
-        pose.Rot().Euler(0, IGN_DTOR(90), 0);
-        SavePicture(camera, pose, "2.png");
-
-        // Front view
-        pose.Pos().Set(2.2 / scaling + translation.X(),
-                       0 + translation.Y(),
-                       0 + translation.Z());
-        pose.Rot().Euler(0, 0, IGN_DTOR(-180));
-        SavePicture(camera, pose, "3.png");
-
-        // Side view
-        pose.Pos().Set(0 + translation.X(),
-                       2.2 / scaling + translation.Y(),
-                       0 + translation.Z());
-        pose.Rot().Euler(0, 0, IGN_DTOR(-90));
-        SavePicture(camera, pose, "4.png");
-
-        // Back view
-        pose.Pos().Set(-2.2 / scaling + translation.X(),
-                       0 + translation.Y(),
-                       0 + translation.Z());
-        pose.Rot().Euler(0, 0, 0);
-        SavePicture(camera, pose, "5.png");
-
-        this->takePicture = false;
+      // Compute the translation we have to apply to the cameras to
+      // center the model in the image.
+      ignition::math::AxisAlignedBox bbox = modelVisual->LocalBoundingBox();
+      double scaling = 1.0 / bbox.Size().Max();
+      ignition::math::Vector3d bboxCenter = bbox.Center();
+      ignition::math::Vector3d translation =
+          bboxCenter + modelPose.Pos();
+      if (this->savingFile.is_open()) {
+        this->savingFile << "Translation: " << translation << std::endl;
+        this->savingFile << "Scaling: " << scaling << std::endl;
       }
+
+      ignition::math::Pose3d pose;
+      // Perspective view
+      pose.Pos().Set(1.6 / scaling + translation.X(),
+                     -1.6 / scaling + translation.Y(),
+                     1.2 / scaling + translation.Z());
+      pose.Rot().Euler(0, IGN_DTOR(30), IGN_DTOR(-225));
+      SavePicture(camera, pose, prefix + "1.png");
+
+      // Top view
+      pose.Pos().Set(0 + translation.X(),
+                     0 + translation.Y(),
+                     2.2 / scaling + translation.Z());
+      pose.Rot().Euler(0, IGN_DTOR(90), 0);
+      SavePicture(camera, pose, prefix + "2.png");
+
+      // Front view
+      pose.Pos().Set(2.2 / scaling + translation.X(),
+                     0 + translation.Y(),
+                     0 + translation.Z());
+      pose.Rot().Euler(0, 0, IGN_DTOR(-180));
+      SavePicture(camera, pose, prefix + "3.png");
+
+      // Side view
+      pose.Pos().Set(0 + translation.X(),
+                     2.2 / scaling + translation.Y(),
+                     0 + translation.Z());
+      pose.Rot().Euler(0, 0, IGN_DTOR(-90));
+      SavePicture(camera, pose, prefix + "4.png");
+
+      // Back view
+      pose.Pos().Set(-2.2 / scaling + translation.X(),
+                     0 + translation.Y(),
+                     0 + translation.Z());
+      pose.Rot().Euler(0, 0, 0);
+      SavePicture(camera, pose, prefix + "5.png");
+
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->takePicture = false;
     }
   }
 }
@@ -288,11 +637,10 @@ void ModelPhotoShootPrivate::PerformPostRenderingOperations()
 void ModelPhotoShootPrivate::SavePicture(
                                   const ignition::rendering::CameraPtr _camera,
                                   const ignition::math::Pose3d &_pose,
-                                  const std::string &_fileName) const
+                                  const std::string &_fileName)
 {
   unsigned int width = _camera->ImageWidth();
   unsigned int height = _camera->ImageHeight();
-  ignition::common::Image image;
 
   _camera->SetWorldPose(_pose);
   auto cameraImage = _camera->CreateImage();
@@ -300,6 +648,26 @@ void ModelPhotoShootPrivate::SavePicture(
   auto formatStr =
       ignition::rendering::PixelUtil::Name(_camera->ImageFormat());
   auto format = ignition::common::Image::ConvertPixelFormat(formatStr);
+
+  // Encoding is slow, so batch images are written by another thread
+  if (this->batch)
+  {
+    PendingImage pending;
+    auto data = cameraImage.Data<unsigned char>();
+    pending.data.assign(data, data + cameraImage.MemorySize());
+    pending.width = width;
+    pending.height = height;
+    pending.format = format;
+    pending.fileName = _fileName;
+    {
+      std::lock_guard<std::mutex> lock(this->imagesMutex);
+      this->images.push_back(std::move(pending));
+    }
+    this->imagesCv.notify_all();
+    return;
+  }
+
+  ignition::common::Image image;
   image.SetFromData(cameraImage.Data<unsigned char>(), width, height, format);
   image.SavePNG(_fileName);
 
@@ -49,6 +49,22 @@ namespace systems
   /// - A camera sensor must be set in the SDF file as it will be used by the
   ///   plugin to take the pictures. This allows the plugin user to set the
   ///   camera parameters as needed. [Required]
+  /// - <batch> - Take pictures of many models in a single run, reusing the
+  ///   render engine, scene and camera. After the pictures of the model
+  ///   holding the plugin are taken, it's replaced by each of the batch
+  ///   models in turn, at the same pose. Images are written by a background
+  ///   thread to `<output_dir>/<model name>/1.png` to `5.png`, so models
+  ///   with the same name overwrite each other's. The next model is parsed,
+  ///   and downloaded if needed, while the previous one is photographed.
+  ///   The server is stopped once all images are written. [Optional]
+  ///   Children:
+  ///   - <model> - URI of a model, such as a Fuel URL or a path. Can be
+  ///     repeated.
+  ///   - <model_list> - Path to a file with one model URI per line, added
+  ///     after the <model> URIs. Empty lines and lines starting with `#`
+  ///     are skipped.
+  ///   - <output_dir> - Directory where images are written. Defaults to the
+  ///     current directory.
   ///
   /// ## Example
   /// An example configuration is installed with Gazebo. The example uses
@@ -74,7 +90,7 @@ namespace systems
     public: ModelPhotoShoot();
 
     /// \brief Destructor
-    public: ~ModelPhotoShoot() override = default;
+    public: ~ModelPhotoShoot() override;
 
     // Documentation inherited
     public: void Configure(const ignition::gazebo::Entity &_id,
@@ -0,0 +1,503 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "MultiJointController.hh"
+
+#include <ignition/msgs/double_v.pb.h>
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ignition/common/Profiler.hh>
+#include <ignition/plugin/Register.hh>
+#include <ignition/transport/Node.hh>
+
+#include <sdf/Joint.hh>
+
+#include "ignition/gazebo/components/JointForceCmd.hh"
+#include "ignition/gazebo/components/JointPosition.hh"
+#include "ignition/gazebo/components/JointType.hh"
+#include "ignition/gazebo/components/JointVelocity.hh"
+#include "ignition/gazebo/components/JointVelocityCmd.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/Model.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/// \brief What the command of a joint is.
+enum class JointCommandMode
+{
+  /// \brief Target position, reached with a PID.
+  POSITION,
+
+  /// \brief Target velocity, set directly or reached with a PID.
+  VELOCITY,
+
+  /// \brief Force or torque.
+  FORCE
+};
+
+class ignition::gazebo::systems::MultiJointControllerPrivate
+{
+  /// \brief Callback for command subscription
+  /// \param[in] _msg One command per joint
+  public: void OnCmd(const msgs::Double_V &_msg);
+
+  /// \brief Add a joint, reading its parameters from its `<joint>` element
+  /// and falling back to the system's.
+  /// \param[in] _name Joint name.
+  /// \param[in] _joint The joint's element, null if it has none.
+  /// \param[in] _sdf The system's element.
+  /// \return False if the parameters are invalid.
+  public: bool AddJoint(const std::string &_name,
+      const sdf::ElementPtr &_joint,
+      const std::shared_ptr<const sdf::Element> &_sdf);
+
+  /// \brief Ignition communication node.
+  public: transport::Node node;
+
+  /// \brief Model interface
+  public: Model model{kNullEntity};
+
+  /// \brief True if some joints weren't found yet.
+  public: bool missingJoints{false};
+
+  /// \brief Commands received on the topic, one per joint.
+  public: std::vector<double> commands;
+
+  /// \brief Protects commands.
+  public: std::mutex commandsMutex;
+
+  // The arrays below hold one element per joint, in command order, so the
+  // update is done in a few passes over contiguous data instead of one
+  // object per joint.
+
+  /// \brief Joint names.
+  public: std::vector<std::string> names;
+
+  /// \brief Joint entities, null until found.
+  public: std::vector<Entity> entities;
+
+  /// \brief Command modes.
+  public: std::vector<JointCommandMode> modes;
+
+  /// \brief True for joints whose output is computed by the PID.
+  public: std::vector<char> usePid;
+
+  /// \brief Proportional gains.
+  public: std::vector<double> pGains;
+
+  /// \brief Integral gains.
+  public: std::vector<double> iGains;
+
+  /// \brief Derivative gains.
+  public: std::vector<double> dGains;
+
+  /// \brief Integral upper limits.
+  public: std::vector<double> iMaxs;
+
+  /// \brief Integral lower limits.
+  public: std::vector<double> iMins;
+
+  /// \brief Output upper limits.
+  public: std::vector<double> cmdMaxs;
+
+  /// \brief Output lower limits.
+  public: std::vector<double> cmdMins;
+
+  /// \brief Output offsets.
+  public: std::vector<double> cmdOffsets;
+
+  /// \brief Integral errors.
+  public: std::vector<double> iErrs;
+
+  /// \brief Proportional errors of the previous update.
+  public: std::vector<double> pErrsLast;
+
+  /// \brief Commands used in the current update.
+  public: std::vector<double> targets;
+
+  /// \brief Measured positions or velocities in the current update.
+  public: std::vector<double> states;
+
+  /// \brief True for joints updated in the current update.
+  public: std::vector<char> ready;
+
+  /// \brief Forces or velocities set in the current update.
+  public: std::vector<double> outputs;
+};
+
+/// \brief Read a parameter of a joint, falling back to the system's.
+/// \param[in] _joint The joint's element, may be null.
+/// \param[in] _sdf The system's element.
+/// \param[in] _name Parameter name.
+/// \param[in] _default Value if neither has the parameter.
+/// \return The parameter's value.
+template <typename T>
+static T jointParam(const sdf::ElementPtr &_joint,
+    const std::shared_ptr<const sdf::Element> &_sdf, const std::string &_name,
+    const T &_default)
+{
+  if (_joint && _joint->HasElement(_name))
+    return _joint->Get<T>(_name);
+  return _sdf->Get<T>(_name, _default).first;
+}
+
+//////////////////////////////////////////////////
+MultiJointController::MultiJointController()
+  : dataPtr(std::make_unique<MultiJointControllerPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+void MultiJointController::Configure(const Entity &_entity,
+    const std::shared_ptr<const sdf::Element> &_sdf,
+    EntityComponentManager &_ecm,
+    EventManager &/*_eventMgr*/)
+{
+  this->dataPtr->model = Model(_entity);
+
+  if (!this->dataPtr->model.Valid(_ecm))
+  {
+    ignerr << "MultiJointController plugin should be attached to a model "
+           << "entity. Failed to initialize." << std::endl;
+    return;
+  }
+
+  // Ugly, but needed because the sdf::Element::GetElement is not a const
+  // function and _sdf is a const shared pointer to a const sdf::Element.
+  auto ptr = const_cast<sdf::Element *>(_sdf.get());
+
+  if (_sdf->HasElement("joint"))
+  {
+    sdf::ElementPtr sdfElem = ptr->GetElement("joint");
+    while (sdfElem)
+    {
+      auto name = sdfElem->HasElement("name") ?
+          sdfElem->Get<std::string>("name") : sdfElem->Get<std::string>();
+      if (name.empty())
+      {
+        ignerr << "MultiJointController found a <joint> without name. "
+               << "Failed to initialize." << std::endl;
+        return;
+      }
+      if (!this->dataPtr->AddJoint(name, sdfElem, _sdf))
+        return;
+      sdfElem = sdfElem->GetNextElement("joint");
+    }
+  }
+  else
+  {
+    // Entities are created in the order of the SDF
+    auto joints = this->dataPtr->model.Joints(_ecm);
+    std::sort(joints.begin(), joints.end());
+    for (auto joint : joints)
+    {
+      auto type = _ecm.Component<components::JointType>(joint);
+      auto name = _ecm.Component<components::Name>(joint);
+      if (nullptr == name ||
+          (nullptr != type && type->Data() == sdf::JointType::FIXED))
+      {
+        continue;
+      }
+      if (!this->dataPtr->AddJoint(name->Data(), nullptr, _sdf))
+        return;
+    }
+  }
+
+  if (this->dataPtr->names.empty())
+  {
+    ignerr << "MultiJointController found no joints to control. "
+           << "Failed to initialize." << std::endl;
+    return;
+  }
+
+  auto count = this->dataPtr->names.size();
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    this->dataPtr->entities.push_back(this->dataPtr->model.JointByName(_ecm,
+        this->dataPtr->names[i]));
+    if (this->dataPtr->entities.back() == kNullEntity)
+      this->dataPtr->missingJoints = true;
+  }
+  this->dataPtr->iErrs.assign(count, 0.0);
+  this->dataPtr->pErrsLast.assign(count, 0.0);
+  this->dataPtr->states.assign(count, 0.0);
+  this->dataPtr->ready.assign(count, 0);
+  this->dataPtr->outputs.assign(count, 0.0);
+  this->dataPtr->targets = this->dataPtr->commands;
+
+  // Subscribe to commands
+  std::string topic = transport::TopicUtils::AsValidTopic("/model/" +
+      this->dataPtr->model.Name(_ecm) + "/joint_cmd");
+  if (_sdf->HasElement("topic"))
+  {
+    topic = transport::TopicUtils::AsValidTopic(
+        _sdf->Get<std::string>("topic"));
+  }
+  if (topic.empty())
+  {
+    ignerr << "Failed to create topic for MultiJointController of model ["
+           << this->dataPtr->model.Name(_ecm) << "]" << std::endl;
+    return;
+  }
+  this->dataPtr->node.Subscribe(topic, &MultiJointControllerPrivate::OnCmd,
+      this->dataPtr.get());
+
+  ignmsg << "MultiJointController controlling [" << count << "] joints, "
+         << "subscribing to Double_V messages on [" << topic << "]"
+         << std::endl;
+}
+
+//////////////////////////////////////////////////
+bool MultiJointControllerPrivate::AddJoint(const std::string &_name,
+    const sdf::ElementPtr &_joint,
+    const std::shared_ptr<const sdf::Element> &_sdf)
+{
+  auto modeStr = jointParam<std::string>(_joint, _sdf, "mode", "position");
+  JointCommandMode mode;
+  if (modeStr == "position")
+  {
+    mode = JointCommandMode::POSITION;
+  }
+  else if (modeStr == "velocity")
+  {
+    mode = JointCommandMode::VELOCITY;
+  }
+  else if (modeStr == "force")
+  {
+    mode = JointCommandMode::FORCE;
+  }
+  else
+  {
+    ignerr << "MultiJointController found invalid mode [" << modeStr
+           << "] for joint [" << _name << "]. Failed to initialize."
+           << std::endl;
+    return false;
+  }
+
+  bool pid = mode == JointCommandMode::POSITION ||
+      (mode == JointCommandMode::VELOCITY &&
+       jointParam<bool>(_joint, _sdf, "use_force_commands", false));
+
+  // Same defaults as JointPositionController and JointController
+  bool position = mode == JointCommandMode::POSITION;
+  this->names.push_back(_name);
+  this->modes.push_back(mode);
+  this->usePid.push_back(pid);
+  this->pGains.push_back(jointParam<double>(_joint, _sdf, "p_gain", 1.0));
+  this->iGains.push_back(jointParam<double>(_joint, _sdf, "i_gain",
+      position ? 0.1 : 0.0));
+  this->dGains.push_back(jointParam<double>(_joint, _sdf, "d_gain",
+      position ? 0.01 : 0.0));
+  this->iMaxs.push_back(jointParam<double>(_joint, _sdf, "i_max", 1.0));
+  this->iMins.push_back(jointParam<double>(_joint, _sdf, "i_min", -1.0));
+  this->cmdMaxs.push_back(jointParam<double>(_joint, _sdf, "cmd_max",
+      1000.0));
+  this->cmdMins.push_back(jointParam<double>(_joint, _sdf, "cmd_min",
+      -1000.0));
+  this->cmdOffsets.push_back(jointParam<double>(_joint, _sdf, "cmd_offset",
+      0.0));
+  this->commands.push_back(jointParam<double>(_joint, _sdf,
+      "initial_command", 0.0));
+
+  igndbg << "[MultiJointController] Joint [" << _name << "] in mode ["
+         << modeStr << "]" << std::endl;
+  return true;
+}
+
+//////////////////////////////////////////////////
+void MultiJointController::PreUpdate(const UpdateInfo &_info,
+    EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("MultiJointController::PreUpdate");
+
+  auto &data = *this->dataPtr;
+  if (data.entities.empty())
+    return;
+
+  // \TODO(anyone) Support rewind
+  if (_info.dt < std::chrono::steady_clock::duration::zero())
+  {
+    ignwarn << "Detected jump back in time ["
+        << std::chrono::duration_cast<std::chrono::seconds>(_info.dt).count()
+        << "s]. System may not work properly." << std::endl;
+  }
+
+  // Joints may be created after the system is configured
+  if (data.missingJoints)
+  {
+    data.missingJoints = false;
+    for (std::size_t i = 0; i < data.entities.size(); ++i)
+    {
+      if (data.entities[i] != kNullEntity)
+        continue;
+      data.entities[i] = data.model.JointByName(_ecm, data.names[i]);
+      if (data.entities[i] == kNullEntity)
+        data.missingJoints = true;
+    }
+  }
+
+  // Nothing left to do if paused.
+  if (_info.paused)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(data.commandsMutex);
+    std::copy(data.commands.begin(), data.commands.end(),
+        data.targets.begin());
+  }
+
+  const auto count = data.entities.size();
+
+  // Read the measured state of PID controlled joints
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    data.ready[i] = 0;
+    const auto entity = data.entities[i];
+    if (entity == kNullEntity)
+      continue;
+
+    if (!data.usePid[i])
+    {
+      data.ready[i] = 1;
+      continue;
+    }
+
+    const std::vector<double> *measured{nullptr};
+    if (data.modes[i] == JointCommandMode::POSITION)
+    {
+      auto comp = _ecm.Component<components::JointPosition>(entity);
+      if (nullptr == comp)
+        _ecm.CreateComponent(entity, components::JointPosition());
+      else
+        measured = &comp->Data();
+    }
+    else
+    {
+      auto comp = _ecm.Component<components::JointVelocity>(entity);
+      if (nullptr == comp)
+        _ecm.CreateComponent(entity, components::JointVelocity());
+      else
+        measured = &comp->Data();
+    }
+
+    // Components which were just created are filled by physics in the next
+    // iteration
+    if (nullptr == measured || measured->empty())
+      continue;
+
+    data.states[i] = measured->front();
+    data.ready[i] = 1;
+  }
+
+  // Update all PIDs, same as math::PID::Update
+  const double dt = std::chrono::duration<double>(_info.dt).count();
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (!data.ready[i])
+      continue;
+
+    if (!data.usePid[i])
+    {
+      data.outputs[i] = data.targets[i];
+      continue;
+    }
+
+    const double error = data.states[i] - data.targets[i];
+    if (dt <= 0.0 || !std::isfinite(error))
+    {
+      data.outputs[i] = 0.0;
+      continue;
+    }
+
+    double iErr = data.iErrs[i] + data.iGains[i] * dt * error;
+    if (data.iMaxs[i] >= data.iMins[i])
+      iErr = std::clamp(iErr, data.iMins[i], data.iMaxs[i]);
+    data.iErrs[i] = iErr;
+
+    const double dErr = (error - data.pErrsLast[i]) / dt;
+    data.pErrsLast[i] = error;
+
+    double output = data.cmdOffsets[i] - data.pGains[i] * error - iErr -
+        data.dGains[i] * dErr;
+    if (data.cmdMaxs[i] >= data.cmdMins[i])
+      output = std::clamp(output, data.cmdMins[i], data.cmdMaxs[i]);
+    data.outputs[i] = output;
+  }
+
+  // Write the commands
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (!data.ready[i])
+      continue;
+
+    const auto entity = data.entities[i];
+    const double output = data.outputs[i];
+    if (data.modes[i] == JointCommandMode::VELOCITY && !data.usePid[i])
+    {
+      auto vel = _ecm.Component<components::JointVelocityCmd>(entity);
+      if (nullptr == vel)
+      {
+        _ecm.CreateComponent(entity, components::JointVelocityCmd({output}));
+      }
+      else if (!vel->Data().empty())
+      {
+        vel->Data()[0] = output;
+      }
+    }
+    else
+    {
+      auto force = _ecm.Component<components::JointForceCmd>(entity);
+      if (nullptr == force)
+      {
+        _ecm.CreateComponent(entity, components::JointForceCmd({output}));
+      }
+      else if (!force->Data().empty())
+      {
+        force->Data()[0] = output;
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void MultiJointControllerPrivate::OnCmd(const msgs::Double_V &_msg)
+{
+  std::lock_guard<std::mutex> lock(this->commandsMutex);
+  if (static_cast<std::size_t>(_msg.data_size()) != this->commands.size())
+  {
+    ignerr << "MultiJointController received [" << _msg.data_size()
+           << "] commands, expected [" << this->commands.size()
+           << "]. Ignoring." << std::endl;
+    return;
+  }
+  std::copy(_msg.data().begin(), _msg.data().end(), this->commands.begin());
+}
+
+IGNITION_ADD_PLUGIN(MultiJointController,
+                    System,
+                    MultiJointController::ISystemConfigure,
+                    MultiJointController::ISystemPreUpdate)
+
+IGNITION_ADD_PLUGIN_ALIAS(MultiJointController,
+                          "ignition::gazebo::systems::MultiJointController")
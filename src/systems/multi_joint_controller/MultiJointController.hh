@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_MULTIJOINTCONTROLLER_HH_
+#define IGNITION_GAZEBO_SYSTEMS_MULTIJOINTCONTROLLER_HH_
+
+#include <ignition/gazebo/System.hh>
+#include <memory>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  // Forward declaration
+  class MultiJointControllerPrivate;
+
+  /// \brief Controller for many joints of a model, which replaces one
+  /// JointPositionController, JointController or ApplyJointForce instance
+  /// per joint. All joints are commanded through a single topic and updated
+  /// together, so large fleets of articulated models don't pay for one
+  /// system, subscription and PID object per joint. Only the first axis of
+  /// each joint is actuated.
+  ///
+  /// Commands are `ignition::msgs::Double_V` messages holding one value per
+  /// controlled joint, in the order the joints are listed. Messages with a
+  /// different number of values are ignored.
+  ///
+  /// ## System Parameters
+  ///
+  /// `<topic>` Topic to receive commands in. Defaults to
+  ///     `/model/<model_name>/joint_cmd`.
+  ///
+  /// `<joint>` A joint to control, may be repeated. If there are none, all
+  /// non-fixed joints of the model are controlled, in the order they appear
+  /// in the model. Either holds the joint name, or these children:
+  ///   * `<name>`: Name of the joint. Required.
+  ///   * `<mode>`, `<initial_command>`, `<use_force_commands>` and the PID
+  ///     parameters below, which override the defaults for this joint.
+  ///
+  /// The following parameters set the defaults for all joints:
+  ///
+  /// `<mode>` One of:
+  ///   * `position`: The command is a target position, reached by applying
+  ///     forces computed by a PID on the position error. This is the
+  ///     default.
+  ///   * `velocity`: The command is a target velocity, set directly on the
+  ///     joint unless `<use_force_commands>` is true, in which case it's
+  ///     reached by applying forces computed by a PID on the velocity
+  ///     error.
+  ///   * `force`: The command is the force or torque applied to the joint.
+  ///
+  /// `<initial_command>` Command to start with. Defaults to 0.
+  ///
+  /// `<use_force_commands>` See `velocity` mode. Defaults to false.
+  ///
+  /// `<p_gain>` The proportional gain of the PID. Defaults to 1.
+  ///
+  /// `<i_gain>` The integral gain of the PID. Defaults to 0.1 in position
+  /// mode and 0 in velocity mode.
+  ///
+  /// `<d_gain>` The derivative gain of the PID. Defaults to 0.01 in
+  /// position mode and 0 in velocity mode.
+  ///
+  /// `<i_max>` The integral upper limit of the PID. Defaults to 1.
+  ///
+  /// `<i_min>` The integral lower limit of the PID. Defaults to -1.
+  ///
+  /// `<cmd_max>` Output max value of the PID. Defaults to 1000.
+  ///
+  /// `<cmd_min>` Output min value of the PID. Defaults to -1000.
+  ///
+  /// `<cmd_offset>` Command offset (feed-forward) of the PID. Defaults
+  /// to 0.
+  class MultiJointController
+      : public System,
+        public ISystemConfigure,
+        public ISystemPreUpdate
+  {
+    /// \brief Constructor
+    public: MultiJointController();
+
+    /// \brief Destructor
+    public: ~MultiJointController() override = default;
+
+    // Documentation inherited
+    public: void Configure(const Entity &_entity,
+                           const std::shared_ptr<const sdf::Element> &_sdf,
+                           EntityComponentManager &_ecm,
+                           EventManager &_eventMgr) override;
+
+    // Documentation inherited
+    public: void PreUpdate(
+                const ignition::gazebo::UpdateInfo &_info,
+                ignition::gazebo::EntityComponentManager &_ecm) override;
+
+    /// \brief Private data pointer
+    private: std::unique_ptr<MultiJointControllerPrivate> dataPtr;
+  };
+  }
+}
+}
+}
+
+#endif
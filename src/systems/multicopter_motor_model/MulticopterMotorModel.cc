@@ -24,8 +24,13 @@
 
 #include "MulticopterMotorModel.hh"
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include <ignition/common/Profiler.hh>
 
@@ -40,65 +45,19 @@
 #include <sdf/sdf.hh>
 
 #include "ignition/gazebo/components/Actuators.hh"
-#include "ignition/gazebo/components/ExternalWorldWrenchCmd.hh"
 #include "ignition/gazebo/components/JointAxis.hh"
 #include "ignition/gazebo/components/JointVelocity.hh"
 #include "ignition/gazebo/components/JointVelocityCmd.hh"
 #include "ignition/gazebo/components/LinearVelocity.hh"
+#include "ignition/gazebo/components/Model.hh"
 #include "ignition/gazebo/components/ParentLinkName.hh"
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/Wind.hh"
-#include "ignition/gazebo/Link.hh"
+#include "ignition/gazebo/components/World.hh"
+#include "ignition/gazebo/EnvironmentalForces.hh"
 #include "ignition/gazebo/Model.hh"
 #include "ignition/gazebo/Util.hh"
 
-// from rotors_gazebo_plugins/include/rotors_gazebo_plugins/common.h
-/// \brief    This class can be used to apply a first order filter on a signal.
-///           It allows different acceleration and deceleration time constants.
-/// \details
-///           Short reveiw of discrete time implementation of first order system
-///           Laplace:
-///             X(s)/U(s) = 1/(tau*s + 1)
-///           continous time system:
-///             dx(t) = (-1/tau)*x(t) + (1/tau)*u(t)
-///           discretized system (ZoH):
-///             x(k+1) = exp(samplingTime*(-1/tau))*x(k) + (1 - exp(samplingTime*(-1/tau))) * u(k) // NOLINT
-template <typename T>
-class FirstOrderFilter {
-  public:
-  FirstOrderFilter(double _timeConstantUp, double _timeConstantDown, T _initialState): // NOLINT
-      timeConstantUp(_timeConstantUp),
-      timeConstantDown(_timeConstantDown),
-      previousState(_initialState) {}
-
-  /// \brief    This method will apply a first order filter on the _inputState.
-  T UpdateFilter(T _inputState, double _samplingTime)
-  {
-    T outputState;
-    if (_inputState > previousState) {
-      // Calcuate the outputState if accelerating.
-      double alphaUp = exp(-_samplingTime / timeConstantUp);
-      // x(k+1) = Ad*x(k) + Bd*u(k)
-      outputState = alphaUp * previousState + (1 - alphaUp) * _inputState;
-    }
-    else
-    {
-      // Calculate the outputState if decelerating.
-      double alphaDown = exp(-_samplingTime / timeConstantDown);
-      outputState = alphaDown * previousState + (1 - alphaDown) * _inputState;
-    }
-    previousState = outputState;
-    return outputState;
-  }
-
-  ~FirstOrderFilter() = default;
-
-  protected:
-  double timeConstantUp;
-  double timeConstantDown;
-  T previousState;
-};
-
 using namespace ignition;
 using namespace gazebo;
 using namespace systems;
@@ -117,109 +76,336 @@ enum class MotorType {
   kForce
 };
 
-class ignition::gazebo::systems::MulticopterMotorModelPrivate
+/// \brief Parameters of a rotor, as given in SDF.
+struct RotorConfig
 {
-  /// \brief Callback for actuator commands.
-  public: void OnActuatorMsg(const msgs::Actuators &_msg);
-
-  /// \brief Apply link forces and moments based on propeller state.
-  public: void UpdateForcesAndMoments(EntityComponentManager &_ecm);
-
-  /// \brief Joint Entity
-  public: Entity jointEntity;
-
   /// \brief Joint name
-  public: std::string jointName;
-
-  /// \brief Link Entity
-  public: Entity linkEntity;
+  std::string jointName;
 
   /// \brief Link name
-  public: std::string linkName;
-
-  /// \brief Parent link Entity
-  public: Entity parentLinkEntity;
-
-  /// \brief Parent link name
-  public: std::string parentLinkName;
-
-  /// \brief Model interface
-  public: Model model{kNullEntity};
-
-  /// \brief Topic for actuator commands.
-  public: std::string commandSubTopic;
-
-  /// \brief Topic namespace.
-  public: std::string robotNamespace;
-
-  /// \brief Sampling time (from motor_model.hpp).
-  public: double samplingTime = 0.01;
+  std::string linkName;
 
   /// \brief Index of motor on multirotor_base.
-  public: int motorNumber = 0;
+  int motorNumber = 0;
 
   /// \brief Turning direction of the motor.
-  public: int turningDirection = turning_direction::kCw;
+  int turningDirection = turning_direction::kCw;
 
   /// \brief Type of input command to motor.
-  public: MotorType motorType = MotorType::kVelocity;
+  MotorType motorType = MotorType::kVelocity;
 
   /// \brief Maximum rotational velocity command with units of rad/s.
   /// The default value is taken from gazebo_motor_model.h
   /// and is approximately 8000 revolutions / minute (rpm).
-  public: double maxRotVelocity = 838.0;
+  double maxRotVelocity = 838.0;
 
   /// \brief Moment constant for computing drag torque based on thrust
   /// with units of length (m).
   /// The default value is taken from gazebo_motor_model.h
-  public: double momentConstant = 0.016;
+  double momentConstant = 0.016;
 
   /// \brief Thrust coefficient for propeller with units of N / (rad/s)^2.
   /// The default value is taken from gazebo_motor_model.h
-  public: double motorConstant = 8.54858e-06;
-
-  /// \brief Reference input to motor. For MotorType kVelocity, this
-  /// is the reference angular velocity in rad/s.
-  public: double refMotorInput = 0.0;
+  double motorConstant = 8.54858e-06;
 
   /// \brief Rolling moment coefficient with units of N*m / (m/s^2).
   /// The default value is taken from gazebo_motor_model.h
-  public: double rollingMomentCoefficient = 1.0e-6;
+  double rollingMomentCoefficient = 1.0e-6;
 
   /// \brief Rotor drag coefficient for propeller with units of N / (m/s^2).
   /// The default value is taken from gazebo_motor_model.h
-  public: double rotorDragCoefficient = 1.0e-4;
+  double rotorDragCoefficient = 1.0e-4;
 
   /// \brief Large joint velocities can cause problems with aliasing,
   /// so the joint velocity used by the physics engine is reduced
   /// this factor, while the larger value is used for computing
   /// propeller thrust.
   /// The default value is taken from gazebo_motor_model.h
-  public: double rotorVelocitySlowdownSim = 10.0;
+  double rotorVelocitySlowdownSim = 10.0;
 
   /// \brief Time constant for rotor deceleration.
   /// The default value is taken from gazebo_motor_model.h
-  public: double timeConstantDown = 1.0 / 40.0;
+  double timeConstantDown = 1.0 / 40.0;
 
   /// \brief Time constant for rotor acceleration.
   /// The default value is taken from gazebo_motor_model.h
-  public: double timeConstantUp = 1.0 / 80.0;
+  double timeConstantUp = 1.0 / 80.0;
+};
+
+/// \brief Read the rotor parameters which are present in an element. Missing
+/// parameters keep their current values.
+/// \param[in] _sdf Element with the parameters.
+/// \param[in, out] _config Parameters of the rotor.
+static void LoadRotorParams(const sdf::ElementPtr &_sdf, RotorConfig &_config)
+{
+  _sdf->Get<std::string>("jointName", _config.jointName, _config.jointName);
+  _sdf->Get<std::string>("linkName", _config.linkName, _config.linkName);
+  _sdf->Get<int>("motorNumber", _config.motorNumber, _config.motorNumber);
+
+  if (_sdf->HasElement("turningDirection"))
+  {
+    auto turningDirection =
+        _sdf->GetElement("turningDirection")->Get<std::string>();
+    if (turningDirection == "cw")
+      _config.turningDirection = turning_direction::kCw;
+    else if (turningDirection == "ccw")
+      _config.turningDirection = turning_direction::kCcw;
+    else
+      ignerr << "Please only use 'cw' or 'ccw' as turningDirection.\n";
+  }
+
+  if (_sdf->HasElement("motorType"))
+  {
+    auto motorType = _sdf->GetElement("motorType")->Get<std::string>();
+    if (motorType == "velocity")
+      _config.motorType = MotorType::kVelocity;
+    else if (motorType == "position")
+    {
+      _config.motorType = MotorType::kPosition;
+      ignerr << "motorType 'position' not supported" << std::endl;
+    }
+    else if (motorType == "force")
+    {
+      _config.motorType = MotorType::kForce;
+      ignerr << "motorType 'force' not supported" << std::endl;
+    }
+    else
+    {
+      ignerr << "Please only use 'velocity', 'position' or "
+               "'force' as motorType.\n";
+    }
+  }
+
+  _sdf->Get<double>("rotorDragCoefficient",
+      _config.rotorDragCoefficient, _config.rotorDragCoefficient);
+  _sdf->Get<double>("rollingMomentCoefficient",
+      _config.rollingMomentCoefficient, _config.rollingMomentCoefficient);
+  _sdf->Get<double>("maxRotVelocity",
+      _config.maxRotVelocity, _config.maxRotVelocity);
+  _sdf->Get<double>("motorConstant",
+      _config.motorConstant, _config.motorConstant);
+  _sdf->Get<double>("momentConstant",
+      _config.momentConstant, _config.momentConstant);
+
+  _sdf->Get<double>("timeConstantUp",
+      _config.timeConstantUp, _config.timeConstantUp);
+  _sdf->Get<double>("timeConstantDown",
+      _config.timeConstantDown, _config.timeConstantDown);
+  _sdf->Get<double>("rotorVelocitySlowdownSim",
+      _config.rotorVelocitySlowdownSim, _config.rotorVelocitySlowdownSim);
+}
+
+/// \brief Read the parameters of a rotor and check that the required ones
+/// are present.
+/// \param[in] _sdf Element with the parameters.
+/// \param[in, out] _config Parameters of the rotor.
+/// \param[in] _parent Element with parameters shared by all rotors, which
+/// were already read into _config, if any.
+/// \return False if the rotor can't be simulated.
+static bool LoadRotor(const sdf::ElementPtr &_sdf, RotorConfig &_config,
+    const sdf::ElementPtr &_parent = nullptr)
+{
+  LoadRotorParams(_sdf, _config);
+
+  auto has = [&](const std::string &_name)
+  {
+    return _sdf->HasElement(_name) || (_parent && _parent->HasElement(_name));
+  };
+
+  if (_config.jointName.empty())
+  {
+    ignerr << "MulticopterMotorModel found an empty jointName parameter. "
+           << "Failed to initialize.";
+    return false;
+  }
+
+  if (_config.linkName.empty())
+  {
+    ignerr << "MulticopterMotorModel found an empty linkName parameter. "
+           << "Failed to initialize.";
+    return false;
+  }
 
-  /// \brief Filter on rotor velocity that has different time constants
-  /// for increasing and decreasing values.
-  public: std::unique_ptr<FirstOrderFilter<double>> rotorVelocityFilter;
+  if (!has("motorNumber"))
+    ignerr << "Please specify a motorNumber.\n";
+
+  if (!has("turningDirection"))
+    ignerr << "Please specify a turning direction ('cw' or 'ccw').\n";
+
+  if (!has("motorType"))
+    ignwarn << "motorType not specified, using velocity.\n";
+
+  return true;
+}
+
+class ignition::gazebo::systems::MulticopterMotorModelPrivate
+{
+  /// \brief Callback for actuator commands.
+  /// \param[in] _vehicle Index of the vehicle the commands are for.
+  /// \param[in] _msg Commands of all motors of the vehicle.
+  public: void OnActuatorMsg(std::size_t _vehicle,
+      const msgs::Actuators &_msg);
+
+  /// \brief Add a vehicle and subscribe to its commands.
+  /// \param[in] _model Model of the vehicle.
+  /// \param[in] _namespace Namespace of the command topic.
+  /// \param[in] _firstRotor Index of the first rotor of the vehicle.
+  /// \param[in] _rotorCount Number of rotors of the vehicle.
+  /// \return False if the topic is invalid.
+  public: bool AddVehicle(const Model &_model, const std::string &_namespace,
+      std::size_t _firstRotor, std::size_t _rotorCount);
+
+  /// \brief Find the rotors of a model and add them to the batch.
+  /// \param[in] _ecm Mutable reference to the EntityComponentManager.
+  /// \param[in] _model Model of the vehicle.
+  /// \return Number of rotors added. In world mode, rotors which aren't in
+  /// the model are skipped, otherwise none are added unless all are found.
+  public: std::size_t AddRotors(EntityComponentManager &_ecm,
+      const Model &_model);
+
+  /// \brief Read the commands and joint velocities of all rotors, and
+  /// update the motor velocity commands.
+  /// \param[in] _ecm Mutable reference to the EntityComponentManager.
+  public: void UpdateMotors(EntityComponentManager &_ecm);
+
+  /// \brief Compute the forces and moments of all rotors from their
+  /// propeller state, and add them to the links' wrenches.
+  /// \param[in] _ecm Immutable reference to the EntityComponentManager.
+  /// \param[in] _links Kinematics and wrenches of the links.
+  public: void UpdateForcesAndMoments(const EntityComponentManager &_ecm,
+      LinkKinematics &_links);
+
+  /// \brief True if the plugin is attached to the world and acts on the
+  /// rotors of all models.
+  public: bool worldMode{false};
+
+  /// \brief Parameters of the rotors of each vehicle. There's a single rotor
+  /// unless in world mode.
+  public: std::vector<RotorConfig> rotorConfigs;
+
+  /// \brief Topic for actuator commands.
+  public: std::string commandSubTopic;
+
+  /// \brief Sampling time (from motor_model.hpp).
+  public: double samplingTime = 0.01;
+
+  /// \brief Vehicles whose rotors are simulated.
+  public: struct Vehicles
+  {
+    /// \brief Model of each vehicle.
+    std::vector<Model> models;
+
+    /// \brief Index of the first rotor of each vehicle. The rotors of a
+    /// vehicle are contiguous.
+    std::vector<std::size_t> firstRotor;
+
+    /// \brief Number of rotors of each vehicle.
+    std::vector<std::size_t> rotorCount;
+  };
+
+  /// \brief All vehicles.
+  public: Vehicles vehicles;
+
+  /// \brief State of all rotors, as structure of arrays so that the forces
+  /// of all rotors are computed in one loop.
+  public: struct Rotors
+  {
+    /// \brief Name of each joint, for error messages.
+    std::vector<std::string> jointNames;
+
+    /// \brief Joint entities.
+    std::vector<Entity> joints;
+
+    /// \brief Slots of the rotor links in the stage's batch.
+    std::vector<std::size_t> linkSlots;
+
+    /// \brief Slots of the parent links in the stage's batch.
+    std::vector<std::size_t> parentSlots;
+
+    /// \brief Index of the motor in the commands of its vehicle.
+    std::vector<int> motorNumbers;
+
+    /// \brief Type of input command to each motor.
+    std::vector<MotorType> motorTypes;
+
+    /// \brief Turning directions, as +/-1.
+    std::vector<double> turningDirections;
+
+    /// \brief See RotorConfig.
+    std::vector<double> maxRotVelocities;
+
+    /// \brief See RotorConfig.
+    std::vector<double> momentConstants;
+
+    /// \brief See RotorConfig.
+    std::vector<double> motorConstants;
+
+    /// \brief See RotorConfig.
+    std::vector<double> rollingMomentCoefficients;
+
+    /// \brief See RotorConfig.
+    std::vector<double> rotorDragCoefficients;
+
+    /// \brief See RotorConfig.
+    std::vector<double> rotorVelocitySlowdownSims;
 
-  /// \brief Received Actuators message. This is nullopt if no message has been
-  /// received.
-  public: std::optional<msgs::Actuators> recvdActuatorsMsg;
+    /// \brief See RotorConfig.
+    std::vector<double> timeConstantsUp;
 
-  /// \brief Mutex to protect recvdActuatorsMsg.
+    /// \brief See RotorConfig.
+    std::vector<double> timeConstantsDown;
+
+    /// \brief Reference input to each motor. For MotorType kVelocity, this
+    /// is the reference angular velocity in rad/s.
+    std::vector<double> refMotorInputs;
+
+    /// \brief State of the first order filter on the rotor velocity, which
+    /// has different time constants for increasing and decreasing values.
+    std::vector<double> filterStates;
+
+    /// \brief Rotor velocity used for the forces on this step.
+    std::vector<double> realMotorVelocities;
+
+    /// \brief Joint poses relative to the rotor links.
+    std::vector<math::Pose3d> jointPoses;
+
+    /// \brief Joint axes in the joint frames.
+    std::vector<math::Vector3d> jointAxes;
+
+    /// \brief Whether the forces of each rotor are applied on this step.
+    std::vector<char> active;
+  };
+
+  /// \brief All rotors.
+  public: Rotors rotors;
+
+  /// \brief Received Actuators message of each vehicle. This is nullopt if
+  /// no message has been received since the last step.
+  public: std::vector<std::optional<msgs::Actuators>> recvdActuatorsMsgs;
+
+  /// \brief Mutex to protect recvdActuatorsMsgs.
   public: std::mutex recvdActuatorsMsgMutex;
 
   /// \brief Ignition communication node.
   public: transport::Node node;
+
+  /// \brief Stage which gathers the link kinematics and applies the wrenches
+  public: std::shared_ptr<EnvironmentalForces> forces;
+
+  /// \brief Rotor model registered to the stage
+  public: EnvironmentalForces::ModelId forceModel{0};
+
+  /// \brief Destructor
+  public: ~MulticopterMotorModelPrivate();
 };
 
+//////////////////////////////////////////////////
+MulticopterMotorModelPrivate::~MulticopterMotorModelPrivate()
+{
+  if (this->forces)
+    this->forces->RemoveModel(this->forceModel);
+}
+
 //////////////////////////////////////////////////
 MulticopterMotorModel::MulticopterMotorModel()
   : dataPtr(std::make_unique<MulticopterMotorModelPrivate>())
@@ -232,148 +418,73 @@ void MulticopterMotorModel::Configure(const Entity &_entity,
     EntityComponentManager &_ecm,
     EventManager &/*_eventMgr*/)
 {
-  this->dataPtr->model = Model(_entity);
-
-  if (!this->dataPtr->model.Valid(_ecm))
-  {
-    ignerr << "MulticopterMotorModel plugin should be attached to a model "
-           << "entity. Failed to initialize." << std::endl;
-    return;
-  }
-
   auto sdfClone = _sdf->Clone();
 
-  this->dataPtr->robotNamespace.clear();
-
-  if (sdfClone->HasElement("robotNamespace"))
-  {
-    this->dataPtr->robotNamespace =
-        sdfClone->Get<std::string>("robotNamespace");
-  }
-  else
-  {
-    ignwarn << "No robotNamespace set using entity name.\n";
-    this->dataPtr->robotNamespace = this->dataPtr->model.Name(_ecm);
-  }
-
-  // Get params from SDF
-  if (sdfClone->HasElement("jointName"))
-  {
-    this->dataPtr->jointName = sdfClone->Get<std::string>("jointName");
-  }
-
-  if (this->dataPtr->jointName.empty())
-  {
-    ignerr << "MulticopterMotorModel found an empty jointName parameter. "
-           << "Failed to initialize.";
-    return;
-  }
+  sdfClone->Get<std::string>("commandSubTopic",
+      this->dataPtr->commandSubTopic, this->dataPtr->commandSubTopic);
 
-  if (sdfClone->HasElement("linkName"))
+  // Attached to the world, act on the rotors of all models, which are added
+  // as they are created
+  if (_ecm.Component<components::World>(_entity))
   {
-    this->dataPtr->linkName = sdfClone->Get<std::string>("linkName");
-  }
+    // Parameters outside of the rotors apply to all of them
+    RotorConfig defaults;
+    LoadRotorParams(sdfClone, defaults);
 
-  if (this->dataPtr->linkName.empty())
-  {
-    ignerr << "MulticopterMotorModel found an empty linkName parameter. "
-           << "Failed to initialize.";
-    return;
-  }
+    for (auto rotorElem = sdfClone->FindElement("rotor"); rotorElem;
+         rotorElem = rotorElem->GetNextElement("rotor"))
+    {
+      RotorConfig config = defaults;
+      if (LoadRotor(rotorElem, config, sdfClone))
+        this->dataPtr->rotorConfigs.push_back(config);
+    }
 
-  if (sdfClone->HasElement("motorNumber"))
-    this->dataPtr->motorNumber =
-      sdfClone->GetElement("motorNumber")->Get<int>();
-  else
-    ignerr << "Please specify a motorNumber.\n";
+    if (this->dataPtr->rotorConfigs.empty())
+    {
+      ignerr << "MulticopterMotorModel attached to a world needs at least "
+             << "one <rotor>. Failed to initialize." << std::endl;
+      return;
+    }
 
-  if (sdfClone->HasElement("turningDirection"))
-  {
-    auto turningDirection =
-        sdfClone->GetElement("turningDirection")->Get<std::string>();
-    if (turningDirection == "cw")
-      this->dataPtr->turningDirection = turning_direction::kCw;
-    else if (turningDirection == "ccw")
-      this->dataPtr->turningDirection = turning_direction::kCcw;
-    else
-      ignerr << "Please only use 'cw' or 'ccw' as turningDirection.\n";
+    this->dataPtr->worldMode = true;
   }
   else
   {
-    ignerr << "Please specify a turning direction ('cw' or 'ccw').\n";
-  }
-
-  if (sdfClone->HasElement("motorType"))
-  {
-    auto motorType = sdfClone->GetElement("motorType")->Get<std::string>();
-    if (motorType == "velocity")
-      this->dataPtr->motorType = MotorType::kVelocity;
-    else if (motorType == "position")
+    Model model(_entity);
+    if (!model.Valid(_ecm))
     {
-      this->dataPtr->motorType = MotorType::kPosition;
-      ignerr << "motorType 'position' not supported" << std::endl;
+      ignerr << "MulticopterMotorModel plugin should be attached to a model "
+             << "or world entity. Failed to initialize." << std::endl;
+      return;
     }
-    else if (motorType == "force")
+
+    std::string robotNamespace;
+    if (sdfClone->HasElement("robotNamespace"))
     {
-      this->dataPtr->motorType = MotorType::kForce;
-      ignerr << "motorType 'force' not supported" << std::endl;
+      robotNamespace = sdfClone->Get<std::string>("robotNamespace");
     }
     else
     {
-      ignerr << "Please only use 'velocity', 'position' or "
-               "'force' as motorType.\n";
+      ignwarn << "No robotNamespace set using entity name.\n";
+      robotNamespace = model.Name(_ecm);
     }
-  }
-  else
-  {
-    ignwarn << "motorType not specified, using velocity.\n";
-    this->dataPtr->motorType = MotorType::kVelocity;
-  }
 
-  sdfClone->Get<std::string>("commandSubTopic",
-      this->dataPtr->commandSubTopic, this->dataPtr->commandSubTopic);
-
-  sdfClone->Get<double>("rotorDragCoefficient",
-      this->dataPtr->rotorDragCoefficient,
-      this->dataPtr->rotorDragCoefficient);
-  sdfClone->Get<double>("rollingMomentCoefficient",
-      this->dataPtr->rollingMomentCoefficient,
-      this->dataPtr->rollingMomentCoefficient);
-  sdfClone->Get<double>("maxRotVelocity",
-      this->dataPtr->maxRotVelocity, this->dataPtr->maxRotVelocity);
-  sdfClone->Get<double>("motorConstant",
-      this->dataPtr->motorConstant, this->dataPtr->motorConstant);
-  sdfClone->Get<double>("momentConstant",
-      this->dataPtr->momentConstant, this->dataPtr->momentConstant);
-
-  sdfClone->Get<double>("timeConstantUp",
-      this->dataPtr->timeConstantUp, this->dataPtr->timeConstantUp);
-  sdfClone->Get<double>("timeConstantDown",
-      this->dataPtr->timeConstantDown, this->dataPtr->timeConstantDown);
-  sdfClone->Get<double>("rotorVelocitySlowdownSim",
-      this->dataPtr->rotorVelocitySlowdownSim, 10);
-
-  // Create the first order filter.
-  this->dataPtr->rotorVelocityFilter =
-      std::make_unique<FirstOrderFilter<double>>(
-          this->dataPtr->timeConstantUp, this->dataPtr->timeConstantDown,
-          this->dataPtr->refMotorInput);
+    RotorConfig config;
+    if (!LoadRotor(sdfClone, config))
+      return;
+    this->dataPtr->rotorConfigs.push_back(config);
 
-  // Subscribe to actuator command messages
-  std::string topic = transport::TopicUtils::AsValidTopic(
-      this->dataPtr->robotNamespace + "/" + this->dataPtr->commandSubTopic);
-  if (topic.empty())
-  {
-    ignerr << "Failed to create topic for [" << this->dataPtr->robotNamespace
-           << "]" << std::endl;
-    return;
-  }
-  else
-  {
-    igndbg << "Listening to topic: " << topic << std::endl;
+    if (!this->dataPtr->AddVehicle(model, robotNamespace, 0u, 0u))
+      return;
   }
-  this->dataPtr->node.Subscribe(topic,
-      &MulticopterMotorModelPrivate::OnActuatorMsg, this->dataPtr.get());
+
+  this->dataPtr->forces = EnvironmentalForces::For(_ecm);
+  this->dataPtr->forceModel = this->dataPtr->forces->AddModel(
+      [this](const UpdateInfo &, const EntityComponentManager &_stageEcm,
+             LinkKinematics &_links)
+      {
+        this->dataPtr->UpdateForcesAndMoments(_stageEcm, _links);
+      });
 }
 
 //////////////////////////////////////////////////
@@ -390,293 +501,355 @@ void MulticopterMotorModel::PreUpdate(const UpdateInfo &_info,
         << "s]. System may not work properly." << std::endl;
   }
 
-  // If the joint or links haven't been identified yet, look for them
-  if (this->dataPtr->jointEntity == kNullEntity)
-  {
-    this->dataPtr->jointEntity =
-        this->dataPtr->model.JointByName(_ecm, this->dataPtr->jointName);
-
-    const auto parentLinkName = _ecm.Component<components::ParentLinkName>(
-        this->dataPtr->jointEntity);
-    this->dataPtr->parentLinkName = parentLinkName->Data();
-  }
+  if (!this->dataPtr->forces)
+    return;
 
-  if (this->dataPtr->linkEntity == kNullEntity)
+  if (this->dataPtr->worldMode)
   {
-    this->dataPtr->linkEntity =
-        this->dataPtr->model.LinkByName(_ecm, this->dataPtr->linkName);
+    _ecm.EachNew<components::Model>(
+        [&](const Entity &_entity, const components::Model *) -> bool
+        {
+          Model model(_entity);
+          const std::size_t count = this->dataPtr->AddRotors(_ecm, model);
+          if (count > 0u)
+          {
+            this->dataPtr->AddVehicle(model, model.Name(_ecm),
+                this->dataPtr->rotors.joints.size() - count, count);
+          }
+          return true;
+        });
   }
-
-  if (this->dataPtr->parentLinkEntity == kNullEntity)
+  // If the joint or links haven't been identified yet, look for them
+  else if (this->dataPtr->vehicles.rotorCount[0] == 0u)
   {
-    this->dataPtr->parentLinkEntity =
-        this->dataPtr->model.LinkByName(_ecm, this->dataPtr->parentLinkName);
+    this->dataPtr->vehicles.rotorCount[0] = this->dataPtr->AddRotors(_ecm,
+        this->dataPtr->vehicles.models[0]);
   }
 
-  if (this->dataPtr->jointEntity == kNullEntity ||
-      this->dataPtr->linkEntity == kNullEntity ||
-      this->dataPtr->parentLinkEntity == kNullEntity)
+  // Nothing left to do if paused.
+  if (_info.paused)
     return;
 
-  // skip UpdateForcesAndMoments if needed components are missing
-  bool doUpdateForcesAndMoments = true;
+  this->dataPtr->samplingTime =
+    std::chrono::duration<double>(_info.dt).count();
+  this->dataPtr->UpdateMotors(_ecm);
+  this->dataPtr->forces->Update(_info, _ecm, this->dataPtr->forceModel);
+}
 
-  const auto jointVelocity = _ecm.Component<components::JointVelocity>(
-      this->dataPtr->jointEntity);
-  if (!jointVelocity)
+//////////////////////////////////////////////////
+bool MulticopterMotorModelPrivate::AddVehicle(const Model &_model,
+    const std::string &_namespace, std::size_t _firstRotor,
+    std::size_t _rotorCount)
+{
+  // Subscribe to actuator command messages
+  std::string topic = transport::TopicUtils::AsValidTopic(
+      _namespace + "/" + this->commandSubTopic);
+  if (topic.empty())
   {
-    _ecm.CreateComponent(this->dataPtr->jointEntity,
-        components::JointVelocity());
-    doUpdateForcesAndMoments = false;
+    ignerr << "Failed to create topic for [" << _namespace
+           << "]" << std::endl;
+    return false;
   }
-  else if (jointVelocity->Data().empty())
+  else
   {
-    doUpdateForcesAndMoments = false;
+    igndbg << "Listening to topic: " << topic << std::endl;
   }
 
-  if (!_ecm.Component<components::JointVelocityCmd>(
-      this->dataPtr->jointEntity))
+  const std::size_t vehicle = this->vehicles.models.size();
+  this->vehicles.models.push_back(_model);
+  this->vehicles.firstRotor.push_back(_firstRotor);
+  this->vehicles.rotorCount.push_back(_rotorCount);
   {
-    _ecm.CreateComponent(this->dataPtr->jointEntity,
-        components::JointVelocityCmd({0}));
-    doUpdateForcesAndMoments = false;
+    std::lock_guard<std::mutex> lock(this->recvdActuatorsMsgMutex);
+    this->recvdActuatorsMsgs.emplace_back();
   }
 
-  if (!_ecm.Component<components::WorldPose>(this->dataPtr->linkEntity))
+  std::function<void(const msgs::Actuators &)> callback =
+      [this, vehicle](const msgs::Actuators &_msg)
+      {
+        this->OnActuatorMsg(vehicle, _msg);
+      };
+  this->node.Subscribe(topic, callback);
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::size_t MulticopterMotorModelPrivate::AddRotors(
+    EntityComponentManager &_ecm, const Model &_model)
+{
+  struct Found
   {
-    _ecm.CreateComponent(this->dataPtr->linkEntity, components::WorldPose());
-    doUpdateForcesAndMoments = false;
-  }
-  if (!_ecm.Component<components::WorldLinearVelocity>(
-      this->dataPtr->linkEntity))
+    const RotorConfig *config;
+    Entity joint;
+    Entity link;
+    Entity parentLink;
+  };
+  std::vector<Found> found;
+
+  for (const auto &config : this->rotorConfigs)
   {
-    _ecm.CreateComponent(this->dataPtr->linkEntity,
-        components::WorldLinearVelocity());
-    doUpdateForcesAndMoments = false;
-  }
+    Found rotor{&config, _model.JointByName(_ecm, config.jointName),
+        _model.LinkByName(_ecm, config.linkName), kNullEntity};
 
-  if (!_ecm.Component<components::WorldPose>(this->dataPtr->parentLinkEntity))
-  {
-    _ecm.CreateComponent(this->dataPtr->parentLinkEntity,
-        components::WorldPose());
-    doUpdateForcesAndMoments = false;
-  }
+    const auto parentLinkName =
+        _ecm.Component<components::ParentLinkName>(rotor.joint);
+    if (parentLinkName)
+      rotor.parentLink = _model.LinkByName(_ecm, parentLinkName->Data());
 
-  // Nothing left to do if paused.
-  if (_info.paused)
-    return;
+    if (rotor.joint == kNullEntity || rotor.link == kNullEntity ||
+        rotor.parentLink == kNullEntity)
+    {
+      // Models may have only some of the rotors in world mode
+      if (this->worldMode)
+        continue;
+      return 0u;
+    }
+    found.push_back(rotor);
+  }
 
-  this->dataPtr->samplingTime =
-    std::chrono::duration<double>(_info.dt).count();
-  if (doUpdateForcesAndMoments)
+  auto &r = this->rotors;
+  for (const auto &rotor : found)
   {
-    this->dataPtr->UpdateForcesAndMoments(_ecm);
+    const auto &config = *rotor.config;
+
+    if (!_ecm.Component<components::JointVelocity>(rotor.joint))
+      _ecm.CreateComponent(rotor.joint, components::JointVelocity());
+    if (!_ecm.Component<components::JointVelocityCmd>(rotor.joint))
+      _ecm.CreateComponent(rotor.joint, components::JointVelocityCmd({0}));
+
+    r.jointNames.push_back(config.jointName);
+    r.joints.push_back(rotor.joint);
+    r.linkSlots.push_back(this->forces->AddLink(_ecm, rotor.link));
+    r.parentSlots.push_back(this->forces->AddLink(_ecm, rotor.parentLink));
+    r.motorNumbers.push_back(config.motorNumber);
+    r.motorTypes.push_back(config.motorType);
+    r.turningDirections.push_back(config.turningDirection);
+    r.maxRotVelocities.push_back(config.maxRotVelocity);
+    r.momentConstants.push_back(config.momentConstant);
+    r.motorConstants.push_back(config.motorConstant);
+    r.rollingMomentCoefficients.push_back(config.rollingMomentCoefficient);
+    r.rotorDragCoefficients.push_back(config.rotorDragCoefficient);
+    r.rotorVelocitySlowdownSims.push_back(config.rotorVelocitySlowdownSim);
+    r.timeConstantsUp.push_back(config.timeConstantUp);
+    r.timeConstantsDown.push_back(config.timeConstantDown);
+    r.refMotorInputs.push_back(0.0);
+    r.filterStates.push_back(0.0);
+    r.realMotorVelocities.push_back(0.0);
+    r.jointPoses.emplace_back();
+    r.jointAxes.emplace_back();
+    r.active.push_back(0);
   }
+  return found.size();
 }
 
 //////////////////////////////////////////////////
-void MulticopterMotorModelPrivate::OnActuatorMsg(
+void MulticopterMotorModelPrivate::OnActuatorMsg(std::size_t _vehicle,
     const msgs::Actuators &_msg)
 {
   std::lock_guard<std::mutex> lock(this->recvdActuatorsMsgMutex);
-  this->recvdActuatorsMsg = _msg;
+  this->recvdActuatorsMsgs[_vehicle] = _msg;
 }
 
 //////////////////////////////////////////////////
-void MulticopterMotorModelPrivate::UpdateForcesAndMoments(
-    EntityComponentManager &_ecm)
+void MulticopterMotorModelPrivate::UpdateMotors(EntityComponentManager &_ecm)
 {
-  IGN_PROFILE("MulticopterMotorModelPrivate::UpdateForcesAndMoments");
+  IGN_PROFILE("MulticopterMotorModelPrivate::UpdateMotors");
+  auto &r = this->rotors;
+  std::fill(r.active.begin(), r.active.end(), 0);
 
-  std::optional<msgs::Actuators> msg;
-  auto actuatorMsgComp =
-      _ecm.Component<components::Actuators>(this->model.Entity());
-
-  // Actuators messages can come in from transport or via a component. If a
-  // component is available, it takes precedence.
-  if (actuatorMsgComp)
-  {
-    msg = actuatorMsgComp->Data();
-  }
-  else
+  // Take the commands received since the last step, once per vehicle
+  std::vector<std::optional<msgs::Actuators>> received;
   {
     std::lock_guard<std::mutex> lock(this->recvdActuatorsMsgMutex);
-    if (this->recvdActuatorsMsg.has_value())
-    {
-      msg = *this->recvdActuatorsMsg;
-      this->recvdActuatorsMsg.reset();
-    }
+    received.swap(this->recvdActuatorsMsgs);
+    this->recvdActuatorsMsgs.resize(received.size());
   }
 
-  if (msg.has_value())
+  for (std::size_t v = 0; v < this->vehicles.models.size(); ++v)
   {
-    if (this->motorNumber > msg->velocity_size() - 1)
-    {
-      ignerr << "You tried to access index " << this->motorNumber
-        << " of the Actuator velocity array which is of size "
-        << msg->velocity_size() << std::endl;
-      return;
-    }
+    const auto first = this->vehicles.firstRotor[v];
+    const auto last = first + this->vehicles.rotorCount[v];
 
-    if (this->motorType == MotorType::kVelocity)
-    {
-      this->refMotorInput = std::min(
-          static_cast<double>(msg->velocity(this->motorNumber)),
-          static_cast<double>(this->maxRotVelocity));
-    }
-    //  else if (this->motorType == MotorType::kPosition)
-    else  // if (this->motorType == MotorType::kForce) {
-    {
-      this->refMotorInput = msg->velocity(this->motorNumber);
-    }
-  }
+    // Actuators messages can come in from transport or via a component. If a
+    // component is available, it takes precedence.
+    auto actuatorMsgComp = _ecm.Component<components::Actuators>(
+        this->vehicles.models[v].Entity());
+    const msgs::Actuators *msg = actuatorMsgComp ?
+        &actuatorMsgComp->Data() : (received[v] ? &*received[v] : nullptr);
 
-  switch (this->motorType)
-  {
-    case (MotorType::kPosition):
-    {
-      // double err = joint_->GetAngle(0).Radian() - this->refMotorInput;
-      // double force = pids_.Update(err, this->samplingTime);
-      // joint_->SetForce(0, force);
-      break;
-    }
-    case (MotorType::kForce):
-    {
-      // joint_->SetForce(0, this->refMotorInput);
-      break;
-    }
-    default:  // MotorType::kVelocity
+    for (std::size_t i = first; i < last; ++i)
     {
-      const auto jointVelocity = _ecm.Component<components::JointVelocity>(
-          this->jointEntity);
-      double motorRotVel = jointVelocity->Data()[0];
-      if (motorRotVel / (2 * IGN_PI) > 1 / (2 * this->samplingTime))
+      if (msg)
       {
-        ignerr << "Aliasing on motor [" << this->motorNumber
-              << "] might occur. Consider making smaller simulation time "
-                 "steps or raising the rotorVelocitySlowdownSim param.\n";
+        if (r.motorNumbers[i] > msg->velocity_size() - 1)
+        {
+          ignerr << "You tried to access index " << r.motorNumbers[i]
+            << " of the Actuator velocity array which is of size "
+            << msg->velocity_size() << std::endl;
+          continue;
+        }
+
+        if (r.motorTypes[i] == MotorType::kVelocity)
+        {
+          r.refMotorInputs[i] = std::min(
+              static_cast<double>(msg->velocity(r.motorNumbers[i])),
+              r.maxRotVelocities[i]);
+        }
+        //  else if (this->motorType == MotorType::kPosition)
+        else  // if (this->motorType == MotorType::kForce) {
+        {
+          r.refMotorInputs[i] = msg->velocity(r.motorNumbers[i]);
+        }
       }
-      double realMotorVelocity =
-          motorRotVel * this->rotorVelocitySlowdownSim;
-      // Get the direction of the rotor rotation.
-      int realMotorVelocitySign =
-          (realMotorVelocity > 0) - (realMotorVelocity < 0);
-      // Assuming symmetric propellers (or rotors) for the thrust calculation.
-      double thrust = this->turningDirection * realMotorVelocitySign *
-                      realMotorVelocity * realMotorVelocity *
-                      this->motorConstant;
-
-      using Pose = math::Pose3d;
-      using Vector3 = math::Vector3d;
-
-      Link link(this->linkEntity);
-      const auto worldPose = link.WorldPose(_ecm);
-
-      // Apply a force to the link.
-      link.AddWorldForce(_ecm,
-                         worldPose->Rot().RotateVector(Vector3(0, 0, thrust)));
-
-      const auto jointPose = _ecm.Component<components::Pose>(
-          this->jointEntity);
+
+      // Only velocity control is supported
+      if (r.motorTypes[i] != MotorType::kVelocity)
+        continue;
+
+      // The model may have been removed
+      const auto jointVelocity =
+          _ecm.Component<components::JointVelocity>(r.joints[i]);
+      const auto jointVelCmd =
+          _ecm.Component<components::JointVelocityCmd>(r.joints[i]);
+      if (!jointVelocity || jointVelocity->Data().empty() || !jointVelCmd)
+        continue;
+
+      const auto jointPose = _ecm.Component<components::Pose>(r.joints[i]);
       if (!jointPose)
       {
-        ignerr << "joint " << this->jointName << " has no Pose"
+        ignerr << "joint " << r.jointNames[i] << " has no Pose"
                << "component" << std::endl;
-        return;
+        continue;
       }
-      // computer joint world pose by multiplying child link WorldPose
-      // with joint Pose
-      Pose jointWorldPose = *worldPose * jointPose->Data();
-
-      const auto jointAxisComp = _ecm.Component<components::JointAxis>(
-          this->jointEntity);
+      const auto jointAxisComp =
+          _ecm.Component<components::JointAxis>(r.joints[i]);
       if (!jointAxisComp)
       {
-        ignerr << "joint " << this->jointName << " has no JointAxis"
+        ignerr << "joint " << r.jointNames[i] << " has no JointAxis"
                << "component" << std::endl;
-        return;
+        continue;
       }
+      r.jointPoses[i] = jointPose->Data();
+      r.jointAxes[i] = jointAxisComp->Data().Xyz();
 
-      const auto worldLinearVel = link.WorldLinearVelocity(_ecm);
-
-      Entity windEntity = _ecm.EntityByComponents(components::Wind());
-      auto windLinearVel =
-          _ecm.Component<components::WorldLinearVelocity>(windEntity);
-      Vector3 windSpeedWorld = windLinearVel->Data();
-
-      // Forces from Philppe Martin's and Erwan Salaun's
-      // 2010 IEEE Conference on Robotics and Automation paper
-      // The True Role of Accelerometer Feedback in Quadrotor Control
-      // - \omega * \lambda_1 * V_A^{\perp}
-      Vector3 jointAxis =
-          jointWorldPose.Rot().RotateVector(jointAxisComp->Data().Xyz());
-      Vector3 bodyVelocityWorld = *worldLinearVel;
-      Vector3 relativeWindVelocityWorld = bodyVelocityWorld - windSpeedWorld;
-      Vector3 bodyVelocityPerpendicular =
-          relativeWindVelocityWorld -
-          (relativeWindVelocityWorld.Dot(jointAxis) * jointAxis);
-      Vector3 airDrag = -std::abs(realMotorVelocity) *
-                               this->rotorDragCoefficient *
-                               bodyVelocityPerpendicular;
-
-      // Apply air drag to link.
-      link.AddWorldForce(_ecm, airDrag);
-      // Moments get the parent link, such that the resulting torques can be
-      // applied.
-      Vector3 parentWorldTorque;
-      auto parentWrenchComp =
-        _ecm.Component<components::ExternalWorldWrenchCmd>(
-          this->parentLinkEntity);
-      // gazebo_motor_model.cpp subtracts the GetWorldCoGPose() of the
-      // child link from the parent but only uses the rotation component.
-      // Since GetWorldCoGPose() uses the link frame orientation, it
-      // is equivalent to use WorldPose().Rot().
-      Link parentLink(this->parentLinkEntity);
-      const auto parentWorldPose = parentLink.WorldPose(_ecm);
-      // The tansformation from the parent_link to the link_.
-      // Pose poseDifference =
-      //  link_->GetWorldCoGPose() - parent_links.at(0)->GetWorldCoGPose();
-      Pose poseDifference = *worldPose - *parentWorldPose;
-      Vector3 dragTorque(
-          0, 0, -this->turningDirection * thrust * this->momentConstant);
-      // Transforming the drag torque into the parent frame to handle
-      // arbitrary rotor orientations.
-      Vector3 dragTorqueParentFrame =
-          poseDifference.Rot().RotateVector(dragTorque);
-      parentWorldTorque =
-          parentWorldPose->Rot().RotateVector(dragTorqueParentFrame);
-
-      Vector3 rollingMoment;
-      // - \omega * \mu_1 * V_A^{\perp}
-      rollingMoment = -std::abs(realMotorVelocity) *
-                       this->rollingMomentCoefficient *
-                       bodyVelocityPerpendicular;
-      parentWorldTorque += rollingMoment;
-      if (!parentWrenchComp)
-      {
-        components::ExternalWorldWrenchCmd wrench;
-        msgs::Set(wrench.Data().mutable_torque(), parentWorldTorque);
-        _ecm.CreateComponent(this->parentLinkEntity, wrench);
-      }
-      else
+      double motorRotVel = jointVelocity->Data()[0];
+      if (motorRotVel / (2 * IGN_PI) > 1 / (2 * this->samplingTime))
       {
-        msgs::Set(parentWrenchComp->Data().mutable_torque(),
-          msgs::Convert(parentWrenchComp->Data().torque()) + parentWorldTorque);
+        ignerr << "Aliasing on motor [" << r.motorNumbers[i]
+              << "] might occur. Consider making smaller simulation time "
+                 "steps or raising the rotorVelocitySlowdownSim param.\n";
       }
-      // Apply the filter on the motor's velocity.
-      double refMotorRotVel;
-      refMotorRotVel = this->rotorVelocityFilter->UpdateFilter(
-          this->refMotorInput, this->samplingTime);
+      r.realMotorVelocities[i] = motorRotVel * r.rotorVelocitySlowdownSims[i];
+
+      // Apply a first order filter on the motor's velocity, with different
+      // acceleration and deceleration time constants. Laplace:
+      //   X(s)/U(s) = 1/(tau*s + 1)
+      // discretized system (ZoH):
+      //   x(k+1) = exp(samplingTime*(-1/tau))*x(k)
+      //          + (1 - exp(samplingTime*(-1/tau))) * u(k)
+      const double tau = r.refMotorInputs[i] > r.filterStates[i] ?
+          r.timeConstantsUp[i] : r.timeConstantsDown[i];
+      const double alpha = std::exp(-this->samplingTime / tau);
+      r.filterStates[i] = alpha * r.filterStates[i] +
+          (1 - alpha) * r.refMotorInputs[i];
 
-      const auto jointVelCmd = _ecm.Component<components::JointVelocityCmd>(
-          this->jointEntity);
       *jointVelCmd = components::JointVelocityCmd(
-          {this->turningDirection * refMotorRotVel
-                              / this->rotorVelocitySlowdownSim});
+          {r.turningDirections[i] * r.filterStates[i]
+                              / r.rotorVelocitySlowdownSims[i]});
+      r.active[i] = 1;
     }
   }
 }
 
+//////////////////////////////////////////////////
+void MulticopterMotorModelPrivate::UpdateForcesAndMoments(
+    const EntityComponentManager &_ecm, LinkKinematics &_links)
+{
+  IGN_PROFILE("MulticopterMotorModelPrivate::UpdateForcesAndMoments");
+
+  using Pose = math::Pose3d;
+  using Vector3 = math::Vector3d;
+
+  Vector3 windSpeedWorld;
+  Entity windEntity = _ecm.EntityByComponents(components::Wind());
+  auto windLinearVel =
+      _ecm.Component<components::WorldLinearVelocity>(windEntity);
+  if (windLinearVel)
+    windSpeedWorld = windLinearVel->Data();
+
+  const auto &r = this->rotors;
+  for (std::size_t i = 0; i < r.joints.size(); ++i)
+  {
+    const auto linkSlot = r.linkSlots[i];
+    const auto parentSlot = r.parentSlots[i];
+    if (!r.active[i] || !_links.valid[linkSlot] || !_links.valid[parentSlot])
+      continue;
+
+    const double realMotorVelocity = r.realMotorVelocities[i];
+    // Get the direction of the rotor rotation.
+    int realMotorVelocitySign =
+        (realMotorVelocity > 0) - (realMotorVelocity < 0);
+    // Assuming symmetric propellers (or rotors) for the thrust calculation.
+    double thrust = r.turningDirections[i] * realMotorVelocitySign *
+                    realMotorVelocity * realMotorVelocity *
+                    r.motorConstants[i];
+
+    const Pose &worldPose = _links.worldPoses[linkSlot];
+
+    // Apply a force to the link.
+    _links.AddWorldForce(linkSlot,
+        worldPose.Rot().RotateVector(Vector3(0, 0, thrust)));
+
+    // computer joint world pose by multiplying child link WorldPose
+    // with joint Pose
+    Pose jointWorldPose = worldPose * r.jointPoses[i];
+
+    // Forces from Philppe Martin's and Erwan Salaun's
+    // 2010 IEEE Conference on Robotics and Automation paper
+    // The True Role of Accelerometer Feedback in Quadrotor Control
+    // - \omega * \lambda_1 * V_A^{\perp}
+    Vector3 jointAxis = jointWorldPose.Rot().RotateVector(r.jointAxes[i]);
+    Vector3 relativeWindVelocityWorld =
+        _links.linearVelocities[linkSlot] - windSpeedWorld;
+    Vector3 bodyVelocityPerpendicular =
+        relativeWindVelocityWorld -
+        (relativeWindVelocityWorld.Dot(jointAxis) * jointAxis);
+    Vector3 airDrag = -std::abs(realMotorVelocity) *
+                             r.rotorDragCoefficients[i] *
+                             bodyVelocityPerpendicular;
+
+    // Apply air drag to link.
+    _links.AddWorldForce(linkSlot, airDrag);
+
+    // Moments get the parent link, such that the resulting torques can be
+    // applied.
+    // gazebo_motor_model.cpp subtracts the GetWorldCoGPose() of the
+    // child link from the parent but only uses the rotation component.
+    // Since GetWorldCoGPose() uses the link frame orientation, it
+    // is equivalent to use WorldPose().Rot().
+    const Pose &parentWorldPose = _links.worldPoses[parentSlot];
+    // The tansformation from the parent_link to the link_.
+    // Pose poseDifference =
+    //  link_->GetWorldCoGPose() - parent_links.at(0)->GetWorldCoGPose();
+    Pose poseDifference = worldPose - parentWorldPose;
+    Vector3 dragTorque(
+        0, 0, -r.turningDirections[i] * thrust * r.momentConstants[i]);
+    // Transforming the drag torque into the parent frame to handle
+    // arbitrary rotor orientations.
+    Vector3 dragTorqueParentFrame =
+        poseDifference.Rot().RotateVector(dragTorque);
+    Vector3 parentWorldTorque =
+        parentWorldPose.Rot().RotateVector(dragTorqueParentFrame);
+
+    // - \omega * \mu_1 * V_A^{\perp}
+    Vector3 rollingMoment = -std::abs(realMotorVelocity) *
+                            r.rollingMomentCoefficients[i] *
+                            bodyVelocityPerpendicular;
+    parentWorldTorque += rollingMoment;
+    _links.AddWorldWrench(parentSlot, Vector3::Zero, parentWorldTorque);
+  }
+}
+
 IGNITION_ADD_PLUGIN(MulticopterMotorModel,
                     System,
                     MulticopterMotorModel::ISystemConfigure,
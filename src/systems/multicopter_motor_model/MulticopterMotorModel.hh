@@ -33,6 +33,19 @@ namespace systems
 
   /// \brief This system applies a thrust force to models with spinning
   /// propellers. See examples/worlds/quadcopter.sdf for a demonstration.
+  ///
+  /// ## World mode
+  /// When attached to a model, the system simulates a single rotor. When
+  /// attached to a world instead, a single instance simulates the rotors of
+  /// every model, including models spawned later on, which avoids the
+  /// overhead of one instance per rotor in large swarms. Each rotor is
+  /// described by a `<rotor>` element holding the same parameters as the
+  /// model plugin, such as `<jointName>`, `<linkName>`, `<motorNumber>` and
+  /// `<turningDirection>`. Parameters outside of the `<rotor>` elements apply
+  /// to all rotors. Every model with at least one of the rotor joints is a
+  /// vehicle, which receives its commands on
+  /// `/<model name>/<commandSubTopic>`. The forces of all rotors are computed
+  /// together on each step.
   class MulticopterMotorModel
       : public System,
         public ISystemConfigure,
@@ -20,7 +20,10 @@
 #include <ignition/msgs/odometry.pb.h>
 #include <ignition/msgs/odometry_with_covariance.pb.h>
 
+#include <atomic>
+#include <functional>
 #include <limits>
+#include <mutex>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -36,6 +39,8 @@
 
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/JointPosition.hh"
+#include "ignition/gazebo/Events.hh"
+#include "ignition/gazebo/KinematicsSnapshot.hh"
 #include "ignition/gazebo/Model.hh"
 #include "ignition/gazebo/Util.hh"
 
@@ -46,11 +51,17 @@ using namespace systems;
 class ignition::gazebo::systems::OdometryPublisherPrivate
 {
   /// \brief Calculates odometry and publishes an odometry message.
+  /// Must be called with mutex locked.
   /// \param[in] _info System update information.
-  /// \param[in] _ecm The EntityComponentManager of the given simulation
-  /// instance.
+  /// \param[in] _rawPose World pose of the model.
   public: void UpdateOdometry(const ignition::gazebo::UpdateInfo &_info,
-    const ignition::gazebo::EntityComponentManager &_ecm);
+    const math::Pose3d &_rawPose);
+
+  /// \brief Callback for the kinematics computed by physics after each
+  /// step, called from the event thread.
+  /// \param[in] _snapshot Kinematics of the step.
+  public: void OnKinematics(
+    std::shared_ptr<const KinematicsSnapshot> _snapshot);
 
   /// \brief Ignition communication node.
   public: transport::Node node;
@@ -105,6 +116,17 @@ class ignition::gazebo::systems::OdometryPublisherPrivate
 
   /// \brief Gaussian noise
   public: double gaussianNoise = 0.0;
+
+  /// \brief Protects the odometry state, which is updated from PostUpdate
+  /// or from the event thread.
+  public: std::mutex mutex;
+
+  /// \brief True once odometry is computed from the kinematics published
+  /// by physics instead of PostUpdate.
+  public: std::atomic<bool> useKinematics{false};
+
+  /// \brief Connection to the KinematicsUpdated event.
+  public: common::ConnectionPtr kinematicsConn;
 };
 
 //////////////////////////////////////////////////
@@ -133,7 +155,7 @@ OdometryPublisher::OdometryPublisher()
 void OdometryPublisher::Configure(const Entity &_entity,
     const std::shared_ptr<const sdf::Element> &_sdf,
     EntityComponentManager &_ecm,
-    EventManager &/*_eventMgr*/)
+    EventManager &_eventMgr)
 {
   this->dataPtr->model = Model(_entity);
 
@@ -268,6 +290,11 @@ void OdometryPublisher::Configure(const Entity &_entity,
     ignmsg << "OdometryPublisher publishing Pose_V (TF) on ["
            << tfTopicValid << "]" << std::endl;
   }
+
+  this->dataPtr->kinematicsConn =
+      _eventMgr.Connect<events::KinematicsUpdated>(
+      std::bind(&OdometryPublisherPrivate::OnKinematics, this->dataPtr.get(),
+      std::placeholders::_1));
 }
 
 //////////////////////////////////////////////////
@@ -303,13 +330,40 @@ void OdometryPublisher::PostUpdate(const UpdateInfo &_info,
   if (_info.paused)
     return;
 
-  this->dataPtr->UpdateOdometry(_info, _ecm);
+  // Computed off the step thread from the kinematics published by physics,
+  // if the model isn't static and physics is running
+  if (this->dataPtr->useKinematics)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->UpdateOdometry(_info,
+      worldPose(this->dataPtr->model.Entity(), _ecm));
+}
+
+//////////////////////////////////////////////////
+void OdometryPublisherPrivate::OnKinematics(
+    std::shared_ptr<const KinematicsSnapshot> _snapshot)
+{
+  auto kinematics = _snapshot->Find(this->model.Entity());
+  if (nullptr == kinematics)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->useKinematics = true;
+
+  // PostUpdate may have handled this step before the first snapshot arrived
+  if (this->initialized && math::clock::time_point(_snapshot->info.simTime) <=
+      this->lastUpdateTime)
+  {
+    return;
+  }
+  this->UpdateOdometry(_snapshot->info, kinematics->worldPose);
 }
 
 //////////////////////////////////////////////////
 void OdometryPublisherPrivate::UpdateOdometry(
     const ignition::gazebo::UpdateInfo &_info,
-    const ignition::gazebo::EntityComponentManager &_ecm)
+    const math::Pose3d &_rawPose)
 {
   IGN_PROFILE("OdometryPublisher::UpdateOdometry");
   // Record start time.
@@ -331,8 +385,7 @@ void OdometryPublisherPrivate::UpdateOdometry(
     return;
 
   // Get and set robotBaseFrame to odom transformation.
-  const math::Pose3d rawPose = worldPose(this->model.Entity(), _ecm);
-  math::Pose3d pose = rawPose * this->offset;
+  math::Pose3d pose = _rawPose * this->offset;
   msg.mutable_pose()->mutable_position()->set_x(pose.Pos().X());
   msg.mutable_pose()->mutable_position()->set_y(pose.Pos().Y());
   msgs::Set(msg.mutable_pose()->mutable_orientation(), pose.Rot());
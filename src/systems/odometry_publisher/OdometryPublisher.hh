@@ -36,6 +36,11 @@ namespace systems
   /// order to periodically publish 2D or 3D odometry data in the form of
   /// ignition::msgs::Odometry messages.
   ///
+  /// When the physics system is running and the model isn't static, the
+  /// odometry is computed and published from the event thread, using the
+  /// kinematics physics computes once per step, see
+  /// events::KinematicsUpdated.
+  ///
   /// # System Parameters
   ///
   /// `<odom_frame>`: Name of the world-fixed coordinate frame for the
@@ -17,6 +17,8 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstring>
 #include <optional>
 #include <string>
 #include <vector>
@@ -29,6 +31,7 @@
 #include <sdf/Element.hh>
 
 #include "ignition/gazebo/components/ContactSensor.hh"
+#include "ignition/gazebo/components/ContactPoints.hh"
 #include "ignition/gazebo/components/ContactSensorData.hh"
 #include "ignition/gazebo/components/Collision.hh"
 #include "ignition/gazebo/components/DepthCamera.hh"
@@ -64,27 +67,13 @@ class ignition::gazebo::systems::OpticalTactilePluginPrivate
   public: void DepthCameraCallback(
     const ignition::msgs::PointCloudPacked &_msg);
 
-  /// \brief Map the (i,j) coordinates defined in the top-left corner of the
-  /// camera into its corresponding (X,Y,Z) measurement with respect to the
-  /// camera's origin in the world frame
-  /// \param[in] _i Horizontal camera coordinate defined in the top-left corner
-  /// of the image, pointing rightwards
-  /// \param[in] _j Vertical camera coordinate defined in the top-left corner
-  /// of the image, pointing downwards
-  /// \param[in] _msgBuffer Buffer with the point cloud data
-  /// \returns The corresponding (X,Y,Z) point
-  public: ignition::math::Vector3f MapPointCloudData(const uint64_t &_i,
-    const uint64_t &_j, const char *_msgBuffer);
-
-  /// \brief Check if a specific point from the depth camera is inside
-  /// the contact surface.
-  /// \param[in] _point Point from the depth camera
-  public: bool PointInsideSensor(ignition::math::Vector3f _point);
-
   /// \brief Computes the normal forces of the Optical Tactile sensor
   /// \param[in] _msg Message from the depth camera
   /// \param[in] _visualizeForces Whether to visualize the forces or not
   ///
+  /// All the sampled points are read in one pass over the point cloud
+  /// into normalPoints, then the normals are computed from that array.
+  ///
   /// Implementation inspired by
   /// https://stackoverflow.com/questions/
   /// 34644101/calculate-surface-normals-from-depth-image-
@@ -102,6 +91,17 @@ class ignition::gazebo::systems::OpticalTactilePluginPrivate
   /// \brief Whether to visualize the contacts.
   public: bool visualizeContacts{false};
 
+  /// \brief False to disable all the markers, and not even create the
+  /// visualization.
+  public: bool visualize{true};
+
+  /// \brief Period between outputs in simulation time, zero to process
+  /// every depth camera message.
+  public: std::chrono::steady_clock::duration outputPeriod{0};
+
+  /// \brief Simulation time of the next output.
+  public: std::chrono::steady_clock::duration nextOutputTime{0};
+
   /// \brief Model interface.
   public: Model model{kNullEntity};
 
@@ -145,6 +145,18 @@ class ignition::gazebo::systems::OpticalTactilePluginPrivate
   /// \brief Message returned by the depth camera
   public: ignition::msgs::PointCloudPacked cameraMsg;
 
+  /// \brief Message being processed, swapped with cameraMsg so the camera
+  /// callback isn't blocked while the forces are computed.
+  public: ignition::msgs::PointCloudPacked processedMsg;
+
+  /// \brief Points read from the point cloud for each sampled pixel: the
+  /// pixel itself, then its right, left, lower and upper neighbors. Points
+  /// outside of the sensor are infinite. Reused between messages.
+  public: std::vector<ignition::math::Vector3f> normalPoints;
+
+  /// \brief Buffer of the normal forces message. Reused between messages.
+  public: std::vector<float> normalForcesBuffer;
+
   /// \brief Mutex for variables mutated by the camera callback.
   /// The variables are: newCameraMsg, cameraMsg.
   public: std::mutex serviceMutex;
@@ -248,6 +260,25 @@ void OpticalTactilePlugin::Configure(const Entity &_entity,
     this->dataPtr->visualizeContacts = _sdf->Get<bool>("visualize_contacts");
   }
 
+  if (_sdf->HasElement("visualize"))
+    this->dataPtr->visualize = _sdf->Get<bool>("visualize");
+
+  if (_sdf->HasElement("update_rate"))
+  {
+    auto rate = _sdf->Get<double>("update_rate");
+    if (rate < 0)
+    {
+      ignwarn << "Parameter <update_rate> must be positive, "
+        << "processing every depth camera message" << std::endl;
+    }
+    else if (rate > 0)
+    {
+      this->dataPtr->outputPeriod =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / rate));
+    }
+  }
+
   if (!_sdf->HasElement("extended_sensing"))
   {
     igndbg << "Missing parameter <extended_sensing>, "
@@ -276,6 +307,13 @@ void OpticalTactilePlugin::Configure(const Entity &_entity,
     this->dataPtr->visualizeSensor = _sdf->Get<bool>("visualize_sensor");
   }
 
+  if (!this->dataPtr->visualize)
+  {
+    this->dataPtr->visualizeForces = false;
+    this->dataPtr->visualizeContacts = false;
+    this->dataPtr->visualizeSensor = false;
+  }
+
   if (!_sdf->HasElement("force_length"))
   {
     igndbg << "Missing parameter <force_length>, "
@@ -377,6 +415,15 @@ void OpticalTactilePlugin::PreUpdate(const UpdateInfo &_info,
     // We call Load here instead of Configure because we can't be guaranteed
     // that all entities have been created when Configure is called
     this->dataPtr->Load(_ecm);
+
+    // Physics fills compact contact points, without creating messages
+    if (this->dataPtr->initialized &&
+        !_ecm.EntityHasComponentType(this->dataPtr->sensorCollisionEntity,
+        components::ContactPoints::typeId))
+    {
+      _ecm.CreateComponent(this->dataPtr->sensorCollisionEntity,
+          components::ContactPoints());
+    }
   }
 
   // This is not an "else" because "initialized" can be set
@@ -385,13 +432,12 @@ void OpticalTactilePlugin::PreUpdate(const UpdateInfo &_info,
   {
     // Get the first object being touched by the sensor
     // We assume there's only one object being touched
-    auto csd = _ecm.Component<components::ContactSensorData>(
+    auto contacts = _ecm.Component<components::ContactPoints>(
       this->dataPtr->sensorCollisionEntity);
-    for (const auto &contact : csd->Data().contact())
+    if (nullptr != contacts && !contacts->Data().empty())
     {
       this->dataPtr->objectCollisionEntity =
-        contact.collision2().id();
-      break;
+        contacts->Data().front().collision2;
     }
 
     // Get the tactile sensor pose, i.e. the model pose
@@ -422,30 +468,45 @@ void OpticalTactilePlugin::PostUpdate(
   if (_info.paused || !this->dataPtr->initialized || !this->dataPtr->enabled)
     return;
 
+  // Outputs and markers are throttled to the output rate
+  if (this->dataPtr->outputPeriod > std::chrono::steady_clock::duration::zero()
+      && _info.simTime < this->dataPtr->nextOutputTime)
+  {
+    return;
+  }
+  this->dataPtr->nextOutputTime = _info.simTime + this->dataPtr->outputPeriod;
+
   // TODO(anyone) Get ContactSensor data and merge it with DepthCamera data
   if (this->dataPtr->visualizeContacts)
   {
     auto *contacts =
-      _ecm.Component<components::ContactSensorData>(
+      _ecm.Component<components::ContactPoints>(
         this->dataPtr->sensorCollisionEntity);
 
     if (nullptr != contacts)
     {
-      this->dataPtr->visualizePtr->RequestContactsMarkerMsg(contacts);
+      this->dataPtr->visualizePtr->RequestContactsMarkerMsg(
+        contacts->Data());
     }
   }
 
-  // Process camera message if it's new
+  // Take the camera message if it's new, and process it without blocking
+  // the camera callback
+  bool newCameraMsg{false};
   {
     std::lock_guard<std::mutex> lock(this->dataPtr->serviceMutex);
     if (this->dataPtr->newCameraMsg)
     {
-      this->dataPtr->ComputeNormalForces(this->dataPtr->cameraMsg,
-        this->dataPtr->visualizeForces);
-
+      this->dataPtr->processedMsg.Swap(&this->dataPtr->cameraMsg);
       this->dataPtr->newCameraMsg = false;
+      newCameraMsg = true;
     }
   }
+  if (newCameraMsg)
+  {
+    this->dataPtr->ComputeNormalForces(this->dataPtr->processedMsg,
+      this->dataPtr->visualizeForces);
+  }
 
   // Publish sensor marker if required and sensor pose has changed
   if (this->dataPtr->visualizeSensor &&
@@ -499,6 +560,8 @@ void OpticalTactilePluginPrivate::Load(const EntityComponentManager &_ecm)
   for (const Entity &colEntity : linkCollisions)
   {
     if (_ecm.EntityHasComponentType(colEntity,
+        components::ContactPoints::typeId) ||
+        _ecm.EntityHasComponentType(colEntity,
         components::ContactSensorData::typeId))
     {
       this->sensorCollisionEntity = colEntity;
@@ -609,13 +672,16 @@ void OpticalTactilePluginPrivate::Load(const EntityComponentManager &_ecm)
   }
 
   // Instantiate the visualization class
-  this->visualizePtr = std::make_unique<
-    OpticalTactilePluginVisualization>(
-      this->modelName,
-      this->sensorSize,
-      this->forceLength,
-      this->cameraUpdateRate,
-      this->depthCameraOffset);
+  if (this->visualize)
+  {
+    this->visualizePtr = std::make_unique<
+      OpticalTactilePluginVisualization>(
+        this->modelName,
+        this->sensorSize,
+        this->forceLength,
+        this->cameraUpdateRate,
+        this->depthCameraOffset);
+  }
 
   this->initialized = true;
 }
@@ -631,7 +697,7 @@ void OpticalTactilePluginPrivate::Enable(const ignition::msgs::Boolean &_req)
 
   this->enabled = _req.data();
 
-  if (!_req.data())
+  if (!_req.data() && this->visualizePtr)
   {
     this->visualizePtr->RemoveNormalForcesAndContactsMarkers();
   }
@@ -668,81 +734,6 @@ void OpticalTactilePluginPrivate::DepthCameraCallback(
   }
 }
 
-//////////////////////////////////////////////////
-ignition::math::Vector3f OpticalTactilePluginPrivate::MapPointCloudData(
-  const uint64_t &_i, const uint64_t &_j, const char *_msgBuffer)
-{
-  IGN_PROFILE("OpticalTactilePlugin::MapPointCloudData");
-
-  // Initialize return variable
-  ignition::math::Vector3f measuredPoint(0, 0, 0);
-
-  // Nothing left to do if failed to initialize.
-  if (!this->initialized)
-    return measuredPoint;
-
-  // Save original position of the pointer
-  const char *temporaryMsgBuffer = _msgBuffer;
-
-  // Number of bytes from the beginning of the pointer (image coordinates at
-  // 0,0) to the desired (i,j) position
-  uint32_t msgBufferIndex =
-    _j*this->cameraMsg.row_step() + _i*this->cameraMsg.point_step();
-
-  temporaryMsgBuffer += msgBufferIndex;
-  int fieldIndex = 0;
-
-  // X coordinate
-  measuredPoint.X() = *reinterpret_cast<const float *>(
-    temporaryMsgBuffer + this->cameraMsg.field(fieldIndex++).offset());
-  // Y coordinate
-  measuredPoint.Y() = *reinterpret_cast<const float *>(
-    temporaryMsgBuffer + this->cameraMsg.field(fieldIndex++).offset());
-  // Z coordinate
-  measuredPoint.Z() = *reinterpret_cast<const float *>(
-    temporaryMsgBuffer + this->cameraMsg.field(fieldIndex).offset());
-
-  // Check if point is inside the sensor
-  bool pointInside = this->PointInsideSensor(measuredPoint);
-  if (!pointInside)
-  {
-    measuredPoint.X() = ignition::math::INF_F;
-    measuredPoint.Y() = ignition::math::INF_F;
-    measuredPoint.Z() = ignition::math::INF_F;
-  }
-
-  return measuredPoint;
-}
-
-//////////////////////////////////////////////////
-bool OpticalTactilePluginPrivate::PointInsideSensor(
-  ignition::math::Vector3f _point)
-{
-  IGN_PROFILE("OpticalTactilePlugin::PointInsideSensor");
-
-  // Nothing left to do if failed to initialize.
-  if (!this->initialized)
-    return false;
-
-  // We assume that the depth camera is placed behind the contact surface, i.e.
-  // displaced in the -X direction with respect to the model's origin
-  bool insideX =
-    (_point.X() >= std::abs(this->depthCameraOffset.X()) -
-      this->extendedSensing) &&
-    (_point.X() <= (std::abs(this->depthCameraOffset.X()) +
-      this->sensorSize.X() + this->extendedSensing));
-
-  bool insideY =
-    (_point.Y() <= this->sensorSize.Y() / 2 + this->extendedSensing) &&
-    (_point.Y() >= - this->sensorSize.Y() / 2 - this->extendedSensing);
-
-  bool insideZ =
-    (_point.Z() <= this->sensorSize.Z() / 2 + this->extendedSensing) &&
-    (_point.Z() >= - this->sensorSize.Z() / 2 - this->extendedSensing);
-
-  return (insideX && insideY && insideZ);
-}
-
 //////////////////////////////////////////////////
 void OpticalTactilePluginPrivate::ComputeNormalForces(
   const ignition::msgs::PointCloudPacked &_msg,
@@ -754,39 +745,97 @@ void OpticalTactilePluginPrivate::ComputeNormalForces(
   if (!this->initialized)
     return;
 
-  // Get data from the message
+  const uint64_t width = _msg.width();
+  const uint64_t height = _msg.height();
+  const uint64_t rowStep = _msg.row_step();
+  const uint64_t pointStep = _msg.point_step();
+  if (width < 3 || height < 3 || _msg.field_size() < 3 ||
+      _msg.data().size() < rowStep * height)
+  {
+    return;
+  }
+
+  // Field offsets and sensor bounds are the same for all points.
+  // We assume that the depth camera is placed behind the contact surface,
+  // i.e. displaced in the -X direction with respect to the model's origin
+  const uint32_t offsetX = _msg.field(0).offset();
+  const uint32_t offsetY = _msg.field(1).offset();
+  const uint32_t offsetZ = _msg.field(2).offset();
+  const float minX = static_cast<float>(
+    std::abs(this->depthCameraOffset.X()) - this->extendedSensing);
+  const float maxX = static_cast<float>(
+    std::abs(this->depthCameraOffset.X()) + this->sensorSize.X() +
+    this->extendedSensing);
+  const float maxY =
+    static_cast<float>(this->sensorSize.Y() / 2 + this->extendedSensing);
+  const float maxZ =
+    static_cast<float>(this->sensorSize.Z() / 2 + this->extendedSensing);
   const char *msgBuffer = _msg.data().data();
 
-  // Declare variables for storing the XYZ points
-  ignition::math::Vector3f p1, p2, p3, p4, markerPosition;
+  // Read the sampled pixels and their neighbors. We don't get the image's
+  // edges because there are no adjacent points to compute the forces.
+  const uint64_t step = std::max(this->visualizationResolution, 1);
+  const uint64_t columns = (width - 2 + step - 1) / step;
+  const uint64_t rows = (height - 2 + step - 1) / step;
+  this->normalPoints.resize(columns * rows * 5);
+
+  auto read = [&](uint64_t _i, uint64_t _j, ignition::math::Vector3f &_p)
+  {
+    const char *point = msgBuffer + _j * rowStep + _i * pointStep;
+    float x, y, z;
+    std::memcpy(&x, point + offsetX, sizeof(float));
+    std::memcpy(&y, point + offsetY, sizeof(float));
+    std::memcpy(&z, point + offsetZ, sizeof(float));
+    if (x >= minX && x <= maxX && y >= -maxY && y <= maxY &&
+        z >= -maxZ && z <= maxZ)
+    {
+      _p.Set(x, y, z);
+    }
+    else
+    {
+      _p.Set(ignition::math::INF_F, ignition::math::INF_F,
+          ignition::math::INF_F);
+    }
+  };
+
+  auto *points = this->normalPoints.data();
+  for (uint64_t j = 1; j < height - 1; j += step)
+  {
+    for (uint64_t i = 1; i < width - 1; i += step)
+    {
+      read(i, j, points[0]);
+      read(i + 1, j, points[1]);
+      read(i - 1, j, points[2]);
+      read(i, j + 1, points[3]);
+      read(i, j - 1, points[4]);
+      points += 5;
+    }
+  }
 
   // Message for publishing normal forces
   ignition::msgs::Image normalsMsg;
-  normalsMsg.set_width(_msg.width());
-  normalsMsg.set_height(_msg.height());
-  normalsMsg.set_step(3 * sizeof(float) * _msg.width());
+  normalsMsg.set_width(width);
+  normalsMsg.set_height(height);
+  normalsMsg.set_step(3 * sizeof(float) * width);
   normalsMsg.set_pixel_format_type(ignition::msgs::PixelFormatType::R_FLOAT32);
 
-  std::vector<float> normalForcesBuffer(3 * _msg.width() * _msg.height());
-  uint32_t bufferIndex;
+  // Forces buffer is composed of XYZ coordinates, while _msg buffer is
+  // made up of XYZRGB values
+  this->normalForcesBuffer.assign(3 * width * height, 0.0f);
 
   // Marker messages representing the normal forces
   ignition::msgs::Marker positionMarkerMsg;
   ignition::msgs::Marker forceMarkerMsg;
 
-  // We don't get the image's edges because there are no adjacent points to
-  // compute the forces
-  for (uint64_t j = 1; j < (_msg.height() - 1);
-      j += this->visualizationResolution)
+  points = this->normalPoints.data();
+  for (uint64_t j = 1; j < height - 1; j += step)
   {
-    for (uint64_t i = 1; i < (_msg.width() - 1);
-        i += this->visualizationResolution)
+    for (uint64_t i = 1; i < width - 1; i += step, points += 5)
     {
-      // Get points for computing normal forces
-      p1 = this->MapPointCloudData(i + 1, j, msgBuffer);
-      p2 = this->MapPointCloudData(i - 1, j, msgBuffer);
-      p3 = this->MapPointCloudData(i, j + 1, msgBuffer);
-      p4 = this->MapPointCloudData(i, j - 1, msgBuffer);
+      const auto &p1 = points[1];
+      const auto &p2 = points[2];
+      const auto &p3 = points[3];
+      const auto &p4 = points[4];
 
       float dxdi = (p1.X() - p2.X()) / std::abs(p1.Y() - p2.Y());
       float dxdj =  (p3.X() - p4.X()) / std::abs(p3.Z() - p4.Z());
@@ -794,25 +843,17 @@ void OpticalTactilePluginPrivate::ComputeNormalForces(
       ignition::math::Vector3f direction(-1, -dxdi, -dxdj);
 
       // todo(anyone) multiply vector by contact forces info
-
-      // todo(anyone) Replace with MatrixX and use vector multiplication instead
-      // of for-loops once the following issue is completed:
-      // https://github.com/ignitionrobotics/ign-math/issues/144
       ignition::math::Vector3f normalForce = direction.Normalized();
 
-      // Add force to buffer
-      // Forces buffer is composed of XYZ coordinates, while _msg buffer is
-      // made up of XYZRGB values
-
-      bufferIndex = j * (_msg.width() * 3) + i * 3;
-      normalForcesBuffer[bufferIndex] = normalForce.X();
-      normalForcesBuffer[bufferIndex+1] = normalForce.Y();
-      normalForcesBuffer[bufferIndex+2] = normalForce.Z();
+      const uint64_t bufferIndex = j * (width * 3) + i * 3;
+      this->normalForcesBuffer[bufferIndex] = normalForce.X();
+      this->normalForcesBuffer[bufferIndex+1] = normalForce.Y();
+      this->normalForcesBuffer[bufferIndex+2] = normalForce.Z();
 
       if (!_visualizeForces)
         continue;
 
-      markerPosition = this->MapPointCloudData(i, j, msgBuffer);
+      ignition::math::Vector3f markerPosition = points[0];
       this->visualizePtr->AddNormalForceToMarkerMsgs(positionMarkerMsg,
         forceMarkerMsg, markerPosition, normalForce,
         this->tactileSensorWorldPose);
@@ -820,8 +861,8 @@ void OpticalTactilePluginPrivate::ComputeNormalForces(
   }
 
   std::string *dataStr = normalsMsg.mutable_data();
-  dataStr->resize(sizeof(float) * normalForcesBuffer.size());
-  memcpy(&((*dataStr)[0]), normalForcesBuffer.data(), dataStr->size());
+  dataStr->resize(sizeof(float) * this->normalForcesBuffer.size());
+  memcpy(&((*dataStr)[0]), this->normalForcesBuffer.data(), dataStr->size());
 
   // Publish message
 
@@ -85,6 +85,18 @@ namespace systems
   /// <visualize_forces> Whether to visualize normal forces computed from the
   ///                    depth camera. This element is optional, and the
   ///                    default value is false.
+  ///
+  /// <visualize> Set to false to disable all the markers, overriding the
+  ///             elements above, and to not create the visualization at
+  ///             all. This element is optional, and the default value is
+  ///             true.
+  ///
+  /// <update_rate> Rate in Hz at which normal forces are computed and
+  ///               published, and markers are updated, in simulation time.
+  ///               Depth camera messages received in between are dropped,
+  ///               only the latest one is processed. This element is
+  ///               optional, and the default value is 0, which processes
+  ///               every depth camera message.
 
   class OpticalTactilePlugin :
     public System,
@@ -136,6 +136,27 @@ void OpticalTactilePluginVisualization::RequestContactsMarkerMsg(
   this->node.Request("/marker", contactsMarkerMsg);
 }
 
+//////////////////////////////////////////////////
+void OpticalTactilePluginVisualization::RequestContactsMarkerMsg(
+  const std::vector<contact::ContactPoint> &_contacts)
+{
+  ignition::msgs::Marker contactsMarkerMsg;
+  this->InitializeContactsMarkerMsg(contactsMarkerMsg);
+
+  for (const auto &contact : _contacts)
+  {
+    ignition::math::Vector3d contactNormal(0, 0, 0.03);
+    if (contact.normal != ignition::math::Vector3d::Zero)
+      contactNormal = contact.normal.Normalized() * 0.03;
+
+    ignition::msgs::Set(contactsMarkerMsg.add_point(), contact.position);
+    ignition::msgs::Set(contactsMarkerMsg.add_point(),
+        contact.position + contactNormal);
+  }
+
+  this->node.Request("/marker", contactsMarkerMsg);
+}
+
 //////////////////////////////////////////////////
 void OpticalTactilePluginVisualization::InitializeNormalForcesMarkerMsgs(
   ignition::msgs::Marker &_positionMarkerMsg,
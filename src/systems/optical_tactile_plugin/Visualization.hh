@@ -20,11 +20,13 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/System.hh>
 #include <ignition/msgs/marker.pb.h>
 
+#include "ignition/gazebo/components/ContactPoints.hh"
 #include "ignition/gazebo/components/ContactSensorData.hh"
 
 namespace ignition
@@ -91,6 +93,12 @@ namespace optical_tactile_sensor
     public: void RequestContactsMarkerMsg(
         components::ContactSensorData const *_contacts);
 
+    /// \brief Request the "/marker" service for the contacts marker.
+    /// Contacts are drawn along their normals.
+    /// \param[in] _contacts Contact points to visualize
+    public: void RequestContactsMarkerMsg(
+        const std::vector<contact::ContactPoint> &_contacts);
+
     /// \brief Initialize the marker messages representing the normal forces
     /// \param[out] _positionMarkerMsg Message for visualizing the contact
     /// positions
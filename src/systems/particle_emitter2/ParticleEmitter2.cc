@@ -21,6 +21,7 @@
 #include <map>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <ignition/common/Profiler.hh>
@@ -68,6 +69,13 @@ class ignition::gazebo::systems::ParticleEmitter2Private
 
   /// \brief Filled on demand for the emitter service.
   public: msgs::ParticleEmitter_V serviceMsg;
+
+  /// \brief Whether to drop commands identical to the previous command of
+  /// the same emitter.
+  public: bool skipUnchangedCmds{false};
+
+  /// \brief Serialized last command of each emitter, without its header.
+  public: std::unordered_map<Entity, std::string> lastCmds;
 };
 
 //////////////////////////////////////////////////
@@ -107,7 +115,7 @@ ParticleEmitter2::ParticleEmitter2()
 
 //////////////////////////////////////////////////
 void ParticleEmitter2::Configure(const Entity &_entity,
-    const std::shared_ptr<const sdf::Element> & /*_sdf*/,
+    const std::shared_ptr<const sdf::Element> &_sdf,
     EntityComponentManager &_ecm,
     EventManager & /*_eventMgr*/)
 {
@@ -120,6 +128,9 @@ void ParticleEmitter2::Configure(const Entity &_entity,
     return;
   }
 
+  this->dataPtr->skipUnchangedCmds = _sdf->Get<bool>("skip_unchanged_cmds",
+      this->dataPtr->skipUnchangedCmds).first;
+
   std::string emittersService = "/world/" + name->Data() + "/particle_emitters";
   if (this->dataPtr->node.Advertise(emittersService,
         &ParticleEmitter2Private::EmittersService, this->dataPtr.get()))
@@ -214,12 +225,33 @@ void ParticleEmitter2::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
         });
   }
 
+  _ecm.EachRemoved<components::ParticleEmitter>(
+      [&](const Entity &_entity, const components::ParticleEmitter *)->bool
+      {
+        this->dataPtr->lastCmds.erase(_entity);
+        return true;
+      });
+
   if (this->dataPtr->userCmd.empty() || _info.paused)
     return;
 
   // Process each command
   for (const auto &cmd : this->dataPtr->userCmd)
   {
+    // Applying the same command again doesn't change the emitter, so don't
+    // make it travel to every renderer again. Headers are ignored because
+    // they may hold timestamps.
+    if (this->dataPtr->skipUnchangedCmds)
+    {
+      msgs::ParticleEmitter withoutHeader(cmd.second);
+      withoutHeader.clear_header();
+      std::string serialized = withoutHeader.SerializeAsString();
+      std::string &last = this->dataPtr->lastCmds[cmd.first];
+      if (last == serialized)
+        continue;
+      last = std::move(serialized);
+    }
+
     // Create component.
     auto emitterComp = _ecm.Component<components::ParticleEmitterCmd>(
         cmd.first);
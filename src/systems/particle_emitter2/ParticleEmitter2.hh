@@ -39,6 +39,13 @@ namespace systems
   /// specified, the following topic naming scheme will be used:
   /// `/model/{model_name}/link/{link_name}/particle_emitter/{emitter_name}/cmd`
   ///
+  /// The system takes in the following parameter:
+  ///   <skip_unchanged_cmds> True to drop commands identical to the previous
+  ///                         command of the same emitter, so they aren't
+  ///                         broadcast to renderers again. Useful when
+  ///                         commands are published periodically. The
+  ///                         default is false.
+  ///
   /// \todo(nkoenig) Plan for ParticleEmitter and ParticleEmitter2:
   ///     1. Deprecate ParticleEmitter in Ignition Fortress.
   ///     2. Remove ParticleEmitter in Ignition G.
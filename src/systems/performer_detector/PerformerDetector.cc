@@ -17,6 +17,9 @@
 
 #include <ignition/msgs/pose.pb.h>
 
+#include <set>
+#include <vector>
+
 #include <ignition/common/Profiler.hh>
 #include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/Vector3.hh>
@@ -159,45 +162,89 @@ void PerformerDetector::PostUpdate(
   auto region = this->detectorGeometry -
     (-(modelPose.Pos() + modelPose.Rot() * this->poseOffset.Pos()));
 
-  _ecm.Each<components::Performer, components::Geometry,
-            components::ParentEntity>(
-      [&](const Entity &_entity, const components::Performer *,
-          const components::Geometry *_geometry,
-          const components::ParentEntity *_parent) -> bool
+  // Only models near the region may carry a performer inside it. Newly
+  // added performers may be larger than the ones seen so far.
+  auto growPerformerSize = [this](const Entity &,
+      const components::Performer *,
+      const components::Geometry *_geometry) -> bool
+  {
+    auto perfBox = _geometry->Data().BoxShape();
+    if (nullptr != perfBox)
+      this->maxPerformerSize.Max(perfBox->Size());
+    return true;
+  };
+  if (!this->spatialIndex)
+  {
+    this->spatialIndex = SpatialIndex::For(_ecm);
+    _ecm.Each<components::Performer, components::Geometry>(
+        growPerformerSize);
+  }
+  else
+  {
+    _ecm.EachNew<components::Performer, components::Geometry>(
+        growPerformerSize);
+  }
+  this->spatialIndex->Update(_info, _ecm);
+
+  // Performers are centered on their models
+  std::vector<Entity> models;
+  this->spatialIndex->Overlapping(math::AxisAlignedBox(
+      region.Min() - this->maxPerformerSize / 2,
+      region.Max() + this->maxPerformerSize / 2), models);
+
+  // Performers which were detected are checked too, in case they left
+  std::set<Entity> candidates(this->detectedEntities.begin(),
+      this->detectedEntities.end());
+  for (const auto &modelEntity : models)
+  {
+    for (const auto &performer : _ecm.ChildrenWithComponents<
+        components::Performer, components::Geometry>(modelEntity))
+    {
+      candidates.insert(performer);
+    }
+  }
+
+  for (const auto &entity : candidates)
+  {
+    auto geometry = _ecm.Component<components::Geometry>(entity);
+    auto parent = _ecm.Component<components::ParentEntity>(entity);
+    if (nullptr == geometry || nullptr == parent ||
+        nullptr == _ecm.Component<components::Performer>(entity))
+    {
+      continue;
+    }
+
+    auto pose = _ecm.Component<components::Pose>(parent->Data())->Data();
+    auto name = _ecm.Component<components::Name>(parent->Data())->Data();
+    const math::Pose3d relPose = modelPose.Inverse() * pose;
+
+    // We assume the geometry contains a box.
+    auto perfBox = geometry->Data().BoxShape();
+    if (nullptr == perfBox)
+    {
+      ignerr << "Internal error: geometry of performer [" << entity
+             << "] missing box." << std::endl;
+      continue;
+    }
+
+    math::AxisAlignedBox performerVolume{pose.Pos() - perfBox->Size() / 2,
+                                         pose.Pos() + perfBox->Size() / 2};
+
+    bool alreadyDetected = this->IsAlreadyDetected(entity);
+    if (region.Intersects(performerVolume))
+    {
+      if (!alreadyDetected)
       {
-        auto pose = _ecm.Component<components::Pose>(_parent->Data())->Data();
-        auto name = _ecm.Component<components::Name>(_parent->Data())->Data();
-        const math::Pose3d relPose = modelPose.Inverse() * pose;
-
-        // We assume the geometry contains a box.
-        auto perfBox = _geometry->Data().BoxShape();
-        if (nullptr == perfBox)
-        {
-          ignerr << "Internal error: geometry of performer [" << _entity
-                 << "] missing box." << std::endl;
-          return true;
-        }
-
-        math::AxisAlignedBox performerVolume{pose.Pos() - perfBox->Size() / 2,
-                                             pose.Pos() + perfBox->Size() / 2};
-
-        bool alreadyDetected = this->IsAlreadyDetected(_entity);
-        if (region.Intersects(performerVolume))
-        {
-          if (!alreadyDetected)
-          {
-            this->AddToDetected(_entity);
-            this->Publish(_entity, name, true, relPose, _info.simTime);
-          }
-        }
-        else if (alreadyDetected)
-        {
-          this->RemoveFromDetected(_entity);
-          this->Publish(_entity, name, false, relPose, _info.simTime);
-        }
-
-        return true;
-      });
+        this->AddToDetected(entity);
+        this->Publish(entity, name, true, relPose, _info.simTime);
+      }
+    }
+    else if (alreadyDetected)
+    {
+      this->RemoveFromDetected(entity);
+      this->Publish(entity, name, false, relPose, _info.simTime);
+    }
+  }
 }
 
 //////////////////////////////////////////////////
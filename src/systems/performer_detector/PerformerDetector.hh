@@ -26,6 +26,7 @@
 #include <ignition/transport/Node.hh>
 
 #include "ignition/gazebo/Model.hh"
+#include "ignition/gazebo/SpatialIndex.hh"
 #include "ignition/gazebo/System.hh"
 
 namespace ignition
@@ -145,6 +146,13 @@ namespace systems
 
     /// \brief Optional extra header data.
     private: std::map<std::string, std::string> extraHeaderData;
+
+    /// \brief Index used to find the models near the region, set on the
+    /// first update.
+    private: std::shared_ptr<SpatialIndex> spatialIndex;
+
+    /// \brief Size of the largest performer seen so far.
+    private: math::Vector3d maxPerformerSize;
   };
 
   }
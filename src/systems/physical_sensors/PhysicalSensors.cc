@@ -0,0 +1,691 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "PhysicalSensors.hh"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ignition/common/Profiler.hh>
+#include <ignition/plugin/Register.hh>
+#include <ignition/sensors/AirPressureSensor.hh>
+#include <ignition/sensors/AltimeterSensor.hh>
+#include <ignition/sensors/ImuSensor.hh>
+#include <ignition/sensors/MagnetometerSensor.hh>
+#include <ignition/sensors/NavSatSensor.hh>
+#include <ignition/sensors/SensorFactory.hh>
+#include <sdf/Element.hh>
+#include <sdf/Imu.hh>
+
+#include "ignition/gazebo/World.hh"
+#include "ignition/gazebo/components/AirPressureSensor.hh"
+#include "ignition/gazebo/components/Altimeter.hh"
+#include "ignition/gazebo/components/AngularVelocity.hh"
+#include "ignition/gazebo/components/Gravity.hh"
+#include "ignition/gazebo/components/Imu.hh"
+#include "ignition/gazebo/components/LinearAcceleration.hh"
+#include "ignition/gazebo/components/LinearVelocity.hh"
+#include "ignition/gazebo/components/MagneticField.hh"
+#include "ignition/gazebo/components/Magnetometer.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/NavSat.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/Sensor.hh"
+#include "ignition/gazebo/components/World.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/SensorScheduler.hh"
+#include "ignition/gazebo/Util.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/// \brief Kinds of sensors managed by the system.
+enum class PhysicalSensorKind
+{
+  /// \brief sensors::ImuSensor
+  kImu,
+
+  /// \brief sensors::AltimeterSensor
+  kAltimeter,
+
+  /// \brief sensors::MagnetometerSensor
+  kMagnetometer,
+
+  /// \brief sensors::AirPressureSensor
+  kAirPressure,
+
+  /// \brief sensors::NavSatSensor
+  kNavSat
+};
+
+/// \brief A sensor and the kinematics gathered for its next update.
+struct PhysicalSensor
+{
+  /// \brief Sensor entity.
+  Entity entity{kNullEntity};
+
+  /// \brief Kind of sensor, which is the type of the sensor object.
+  PhysicalSensorKind kind{PhysicalSensorKind::kImu};
+
+  /// \brief Sensor object.
+  std::unique_ptr<sensors::Sensor> sensor;
+
+  /// \brief Whether the sensor draws noise, so it must not be updated
+  /// concurrently with other noisy sensors.
+  bool noisy{true};
+
+  /// \brief Whether all the kinematics were found in the current step.
+  bool ready{false};
+
+  /// \brief World pose.
+  math::Pose3d worldPose;
+
+  /// \brief Linear velocity in the world frame.
+  math::Vector3d worldLinearVelocity;
+
+  /// \brief Angular velocity in the sensor frame.
+  math::Vector3d angularVelocity;
+
+  /// \brief Linear acceleration in the sensor frame.
+  math::Vector3d linearAcceleration;
+
+  /// \brief Latitude and longitude in degrees and elevation in meters.
+  math::Vector3d latLonEle;
+};
+
+/// \brief Private PhysicalSensors data class.
+class ignition::gazebo::systems::PhysicalSensors::Implementation
+{
+  /// \brief Create sensors for new sensor entities.
+  /// \param[in] _ecm Immutable reference to ECM.
+  public: void CreateSensors(const EntityComponentManager &_ecm);
+
+  /// \brief Create a sensor.
+  /// \param[in] _ecm Immutable reference to ECM.
+  /// \param[in] _entity Sensor entity.
+  /// \param[in] _kind Kind of sensor.
+  /// \param[in] _sdf Sensor description.
+  /// \param[in] _parent Parent entity.
+  public: void AddSensor(const EntityComponentManager &_ecm,
+                         const Entity _entity,
+                         PhysicalSensorKind _kind,
+                         const sdf::Sensor &_sdf,
+                         const Entity _parent);
+
+  /// \brief Read the kinematics of a sensor.
+  /// \param[in] _ecm Immutable reference to ECM.
+  /// \param[in, out] _sensor Sensor.
+  public: void Gather(const EntityComponentManager &_ecm,
+                      PhysicalSensor &_sensor) const;
+
+  /// \brief Pass the kinematics to a sensor and update it, which publishes
+  /// its message.
+  /// \param[in] _now Current simulation time.
+  /// \param[in, out] _sensor Sensor.
+  public: void Update(const std::chrono::steady_clock::duration &_now,
+                      PhysicalSensor &_sensor) const;
+
+  /// \brief Remove the sensors of removed entities.
+  /// \param[in] _ecm Immutable reference to ECM.
+  public: void RemoveSensors(const EntityComponentManager &_ecm);
+
+  /// \brief Remove a sensor.
+  /// \param[in] _entity Sensor entity.
+  public: void RemoveSensor(const Entity _entity);
+
+  /// \brief All the sensors, in a flat array so they can be split between
+  /// threads.
+  public: std::vector<PhysicalSensor> sensors;
+
+  /// \brief Index of each sensor entity in sensors.
+  public: std::unordered_map<Entity, std::size_t> sensorIndex;
+
+  /// \brief Ign-sensors sensor factory for creating sensors
+  public: sensors::SensorFactory sensorFactory;
+
+  /// \brief Sensors created during the previous PostUpdate, whose topic
+  /// components are created during the next PreUpdate.
+  public: std::vector<Entity> newSensors;
+
+  /// \brief Wakes the sensors when they're due
+  public: SensorScheduler scheduler;
+
+  /// \brief Sensors which are due this step.
+  public: std::vector<Entity> due;
+
+  /// \brief Indices of the sensors without noise to update this step.
+  public: std::vector<std::size_t> quiet;
+
+  /// \brief Indices of the sensors with noise to update this step.
+  public: std::vector<std::size_t> noisy;
+
+  /// \brief World entity.
+  public: Entity worldEntity{kNullEntity};
+
+  /// \brief True once the sensors which existed at startup were created.
+  public: bool initialized{false};
+};
+
+//////////////////////////////////////////////////
+/// \brief Whether an SDF element has noise enabled anywhere below it.
+/// \param[in] _elem Element.
+/// \return True if any <noise> element has a type other than none.
+static bool HasNoiseBelow(const sdf::ElementPtr &_elem)
+{
+  for (auto child = _elem->GetFirstElement(); child;
+       child = child->GetNextElement())
+  {
+    if (child->GetName() == "noise")
+    {
+      std::string type;
+      if (auto attr = child->GetAttribute("type"))
+        type = attr->GetAsString();
+      else if (child->HasElement("type"))
+        type = child->Get<std::string>("type");
+
+      if (type != "none")
+        return true;
+    }
+    else if (HasNoiseBelow(child))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+/// \brief Whether a sensor may draw noise.
+/// \param[in] _sdf Sensor description.
+/// \return True unless the sensor is known not to have noise.
+static bool HasNoise(const sdf::Sensor &_sdf)
+{
+  return !_sdf.Element() || HasNoiseBelow(_sdf.Element());
+}
+
+//////////////////////////////////////////////////
+/// \brief Whether a sensor has subscribers.
+/// \param[in] _sensor Sensor.
+/// \return True if it has subscribers.
+static bool HasConnections(const PhysicalSensor &_sensor)
+{
+  switch (_sensor.kind)
+  {
+    case PhysicalSensorKind::kImu:
+      return static_cast<sensors::ImuSensor *>(
+          _sensor.sensor.get())->HasConnections();
+    case PhysicalSensorKind::kAltimeter:
+      return static_cast<sensors::AltimeterSensor *>(
+          _sensor.sensor.get())->HasConnections();
+    case PhysicalSensorKind::kMagnetometer:
+      return static_cast<sensors::MagnetometerSensor *>(
+          _sensor.sensor.get())->HasConnections();
+    case PhysicalSensorKind::kAirPressure:
+      return static_cast<sensors::AirPressureSensor *>(
+          _sensor.sensor.get())->HasConnections();
+    case PhysicalSensorKind::kNavSat:
+      return static_cast<sensors::NavSatSensor *>(
+          _sensor.sensor.get())->HasConnections();
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+PhysicalSensors::PhysicalSensors()
+  : dataPtr(ignition::utils::MakeUniqueImpl<Implementation>())
+{
+}
+
+//////////////////////////////////////////////////
+void PhysicalSensors::PreUpdate(const UpdateInfo &/*_info*/,
+    EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("PhysicalSensors::PreUpdate");
+
+  // Create components
+  for (auto entity : this->dataPtr->newSensors)
+  {
+    auto it = this->dataPtr->sensorIndex.find(entity);
+    if (it == this->dataPtr->sensorIndex.end())
+      continue;
+
+    _ecm.CreateComponent(entity, components::SensorTopic(
+        this->dataPtr->sensors[it->second].sensor->Topic()));
+  }
+  this->dataPtr->newSensors.clear();
+}
+
+//////////////////////////////////////////////////
+void PhysicalSensors::PostUpdate(const UpdateInfo &_info,
+    const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("PhysicalSensors::PostUpdate");
+
+  // \TODO(anyone) Support rewind
+  if (_info.dt < std::chrono::steady_clock::duration::zero())
+  {
+    ignwarn << "Detected jump back in time ["
+        << std::chrono::duration_cast<std::chrono::seconds>(_info.dt).count()
+        << "s]. System may not work properly." << std::endl;
+  }
+
+  this->dataPtr->CreateSensors(_ecm);
+
+  // Only update and publish if not paused.
+  if (!_info.paused)
+  {
+    auto &d = *this->dataPtr;
+
+    // Only sensors which are due and have subscribers do any work
+    d.scheduler.TakeDue(_info.simTime, d.due);
+    d.quiet.clear();
+    d.noisy.clear();
+    for (auto entity : d.due)
+    {
+      auto it = d.sensorIndex.find(entity);
+      if (it == d.sensorIndex.end())
+        continue;
+
+      const auto &sensor = d.sensors[it->second];
+      if (HasConnections(sensor))
+        (sensor.noisy ? d.noisy : d.quiet).push_back(it->second);
+    }
+
+    if (!d.quiet.empty() || !d.noisy.empty())
+    {
+      IGN_PROFILE("PhysicalSensors::Update");
+
+      // Reading components is safe from several threads
+      auto gather = [&](const std::vector<std::size_t> &_indices)
+      {
+        _ecm.ParallelFor(_indices.size(),
+          [&](std::size_t _first, std::size_t _last)
+          {
+            for (std::size_t i = _first; i < _last; ++i)
+              d.Gather(_ecm, d.sensors[_indices[i]]);
+          });
+      };
+      gather(d.quiet);
+      gather(d.noisy);
+
+      _ecm.ParallelFor(d.quiet.size(),
+        [&](std::size_t _first, std::size_t _last)
+        {
+          for (std::size_t i = _first; i < _last; ++i)
+            d.Update(_info.simTime, d.sensors[d.quiet[i]]);
+        }, 8u);
+
+      for (auto i : d.noisy)
+        d.Update(_info.simTime, d.sensors[i]);
+    }
+
+    for (auto entity : d.due)
+    {
+      auto it = d.sensorIndex.find(entity);
+      if (it == d.sensorIndex.end())
+        continue;
+
+      const auto &sensor = d.sensors[it->second].sensor;
+      d.scheduler.Reschedule(entity, _info.simTime,
+          sensor->NextDataUpdateTime(), sensor->UpdateRate());
+    }
+  }
+
+  this->dataPtr->RemoveSensors(_ecm);
+}
+
+//////////////////////////////////////////////////
+void PhysicalSensors::Implementation::AddSensor(
+    const EntityComponentManager &_ecm, const Entity _entity,
+    PhysicalSensorKind _kind, const sdf::Sensor &_sdf, const Entity _parent)
+{
+  // create sensor
+  std::string sensorScopedName =
+      removeParentScope(scopedName(_entity, _ecm, "::", false), "::");
+  sdf::Sensor data = _sdf;
+  data.SetName(sensorScopedName);
+
+  // check topic
+  if (data.Topic().empty())
+  {
+    std::string suffix;
+    switch (_kind)
+    {
+      case PhysicalSensorKind::kImu: suffix = "/imu"; break;
+      case PhysicalSensorKind::kAltimeter: suffix = "/altimeter"; break;
+      case PhysicalSensorKind::kMagnetometer: suffix = "/magnetometer"; break;
+      case PhysicalSensorKind::kAirPressure: suffix = "/air_pressure"; break;
+      case PhysicalSensorKind::kNavSat: suffix = "/navsat"; break;
+    }
+    data.SetTopic(scopedName(_entity, _ecm) + suffix);
+  }
+
+  // The WorldPose component was just created and so it's empty
+  // We'll compute the world pose manually here
+  const math::Pose3d pose = worldPose(_entity, _ecm);
+
+  std::unique_ptr<sensors::Sensor> sensor;
+  switch (_kind)
+  {
+    case PhysicalSensorKind::kImu:
+    {
+      // Get the world acceleration (defined in world frame)
+      auto gravity = _ecm.Component<components::Gravity>(this->worldEntity);
+      if (nullptr == gravity)
+      {
+        ignerr << "World missing gravity." << std::endl;
+        return;
+      }
+
+      auto imu = this->sensorFactory.CreateSensor<sensors::ImuSensor>(data);
+      if (nullptr == imu)
+        break;
+
+      // set gravity - assume it remains fixed
+      imu->SetGravity(gravity->Data());
+      imu->SetOrientationReference(pose.Rot());
+
+      // If <orientation_reference_frame> includes a named frame like NED,
+      // that must be supplied to the IMU sensor, otherwise orientations are
+      // reported w.r.t to the initial orientation.
+      if (data.Element() && data.Element()->HasElement("imu") &&
+          data.Element()->GetElement("imu")->HasElement(
+          "orientation_reference_frame"))
+      {
+        double heading = 0.0;
+        World world(this->worldEntity);
+        if (auto sphericalCoordinates = world.SphericalCoordinates(_ecm))
+          heading = sphericalCoordinates->HeadingOffset().Radian();
+
+        imu->SetWorldFrameOrientation(math::Quaterniond(0, 0, heading),
+            sensors::WorldFrameEnumType::ENU);
+      }
+
+      if (data.ImuSensor())
+        imu->SetOrientationEnabled(data.ImuSensor()->OrientationEnabled());
+
+      sensor = std::move(imu);
+      break;
+    }
+    case PhysicalSensorKind::kAltimeter:
+    {
+      auto altimeter =
+          this->sensorFactory.CreateSensor<sensors::AltimeterSensor>(data);
+      if (nullptr == altimeter)
+        break;
+
+      altimeter->SetVerticalReference(pose.Pos().Z());
+      altimeter->SetPosition(pose.Pos().Z());
+      sensor = std::move(altimeter);
+      break;
+    }
+    case PhysicalSensorKind::kMagnetometer:
+    {
+      // Assume the field is uniform and doesn't change
+      auto field =
+          _ecm.Component<components::MagneticField>(this->worldEntity);
+      if (nullptr == field)
+      {
+        ignerr << "World missing magnetic field." << std::endl;
+        return;
+      }
+
+      auto magnetometer =
+          this->sensorFactory.CreateSensor<sensors::MagnetometerSensor>(data);
+      if (nullptr == magnetometer)
+        break;
+
+      magnetometer->SetWorldMagneticField(field->Data());
+      magnetometer->SetWorldPose(pose);
+      sensor = std::move(magnetometer);
+      break;
+    }
+    case PhysicalSensorKind::kAirPressure:
+    {
+      auto airPressure =
+          this->sensorFactory.CreateSensor<sensors::AirPressureSensor>(data);
+      if (nullptr == airPressure)
+        break;
+
+      airPressure->SetPose(pose);
+      sensor = std::move(airPressure);
+      break;
+    }
+    case PhysicalSensorKind::kNavSat:
+    {
+      sensor = this->sensorFactory.CreateSensor<sensors::NavSatSensor>(data);
+      break;
+    }
+  }
+
+  if (nullptr == sensor)
+  {
+    ignerr << "Failed to create sensor [" << sensorScopedName << "]"
+           << std::endl;
+    return;
+  }
+
+  // set sensor parent
+  sensor->SetParent(_ecm.Component<components::Name>(_parent)->Data());
+
+  PhysicalSensor entry;
+  entry.entity = _entity;
+  entry.kind = _kind;
+  entry.sensor = std::move(sensor);
+  entry.noisy = HasNoise(data);
+
+  this->scheduler.Schedule(_entity,
+      std::chrono::steady_clock::duration::zero());
+  this->sensorIndex[_entity] = this->sensors.size();
+  this->sensors.push_back(std::move(entry));
+  this->newSensors.push_back(_entity);
+}
+
+//////////////////////////////////////////////////
+void PhysicalSensors::Implementation::CreateSensors(
+    const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("PhysicalSensors::CreateSensors");
+  if (kNullEntity == this->worldEntity)
+    this->worldEntity = _ecm.EntityByComponents(components::World());
+  if (kNullEntity == this->worldEntity)
+  {
+    ignerr << "Missing world entity." << std::endl;
+    return;
+  }
+
+  // All the sensors on the first call, then the new ones
+  auto add = [&](auto _component, PhysicalSensorKind _kind)
+  {
+    using ComponentT = decltype(_component);
+    auto addSensor = [&](const Entity &_entity, const ComponentT *_sensor,
+        const components::ParentEntity *_parent) -> bool
+    {
+      this->AddSensor(_ecm, _entity, _kind, _sensor->Data(),
+          _parent->Data());
+      return true;
+    };
+
+    if (!this->initialized)
+      _ecm.Each<ComponentT, components::ParentEntity>(addSensor);
+    else
+      _ecm.EachNew<ComponentT, components::ParentEntity>(addSensor);
+  };
+
+  add(components::Imu(), PhysicalSensorKind::kImu);
+  add(components::Altimeter(), PhysicalSensorKind::kAltimeter);
+  add(components::Magnetometer(), PhysicalSensorKind::kMagnetometer);
+  add(components::AirPressureSensor(), PhysicalSensorKind::kAirPressure);
+  add(components::NavSat(), PhysicalSensorKind::kNavSat);
+  this->initialized = true;
+}
+
+//////////////////////////////////////////////////
+void PhysicalSensors::Implementation::Gather(
+    const EntityComponentManager &_ecm, PhysicalSensor &_sensor) const
+{
+  const auto entity = _sensor.entity;
+  _sensor.ready = false;
+
+  // Components filled by physics
+  auto worldPose = _ecm.Component<components::WorldPose>(entity);
+  auto worldLinearVel =
+      _ecm.Component<components::WorldLinearVelocity>(entity);
+
+  switch (_sensor.kind)
+  {
+    case PhysicalSensorKind::kImu:
+    {
+      auto angularVel = _ecm.Component<components::AngularVelocity>(entity);
+      auto linearAccel =
+          _ecm.Component<components::LinearAcceleration>(entity);
+      if (!worldPose || !angularVel || !linearAccel)
+        return;
+      _sensor.worldPose = worldPose->Data();
+      _sensor.angularVelocity = angularVel->Data();
+      _sensor.linearAcceleration = linearAccel->Data();
+      break;
+    }
+    case PhysicalSensorKind::kAltimeter:
+      if (!worldPose || !worldLinearVel)
+        return;
+      _sensor.worldPose = worldPose->Data();
+      _sensor.worldLinearVelocity = worldLinearVel->Data();
+      break;
+    case PhysicalSensorKind::kMagnetometer:
+    case PhysicalSensorKind::kAirPressure:
+      if (!worldPose)
+        return;
+      _sensor.worldPose = worldPose->Data();
+      break;
+    case PhysicalSensorKind::kNavSat:
+    {
+      if (!worldLinearVel)
+        return;
+      auto latLonEle = sphericalCoordinates(entity, _ecm);
+      if (!latLonEle)
+        return;
+      _sensor.latLonEle = *latLonEle;
+      _sensor.worldLinearVelocity = worldLinearVel->Data();
+      break;
+    }
+  }
+  _sensor.ready = true;
+}
+
+//////////////////////////////////////////////////
+void PhysicalSensors::Implementation::Update(
+    const std::chrono::steady_clock::duration &_now,
+    PhysicalSensor &_sensor) const
+{
+  if (!_sensor.ready)
+    return;
+
+  switch (_sensor.kind)
+  {
+    case PhysicalSensorKind::kImu:
+    {
+      auto imu = static_cast<sensors::ImuSensor *>(_sensor.sensor.get());
+      imu->SetWorldPose(_sensor.worldPose);
+      imu->SetAngularVelocity(_sensor.angularVelocity);
+      imu->SetLinearAcceleration(_sensor.linearAcceleration);
+      break;
+    }
+    case PhysicalSensorKind::kAltimeter:
+    {
+      auto altimeter =
+          static_cast<sensors::AltimeterSensor *>(_sensor.sensor.get());
+      altimeter->SetPosition(_sensor.worldPose.Pos().Z());
+      altimeter->SetVerticalVelocity(_sensor.worldLinearVelocity.Z());
+      break;
+    }
+    case PhysicalSensorKind::kMagnetometer:
+      static_cast<sensors::MagnetometerSensor *>(
+          _sensor.sensor.get())->SetWorldPose(_sensor.worldPose);
+      break;
+    case PhysicalSensorKind::kAirPressure:
+      static_cast<sensors::AirPressureSensor *>(
+          _sensor.sensor.get())->SetPose(_sensor.worldPose);
+      break;
+    case PhysicalSensorKind::kNavSat:
+    {
+      auto navSat =
+          static_cast<sensors::NavSatSensor *>(_sensor.sensor.get());
+      navSat->SetLatitude(IGN_DTOR(_sensor.latLonEle.X()));
+      navSat->SetLongitude(IGN_DTOR(_sensor.latLonEle.Y()));
+      navSat->SetAltitude(_sensor.latLonEle.Z());
+
+      // Velocity in ENU frame
+      navSat->SetVelocity(_sensor.worldLinearVelocity);
+      break;
+    }
+  }
+
+  // Update measurement time and publish
+  _sensor.sensor->Update(_now, false);
+}
+
+//////////////////////////////////////////////////
+void PhysicalSensors::Implementation::RemoveSensor(const Entity _entity)
+{
+  auto it = this->sensorIndex.find(_entity);
+  if (it == this->sensorIndex.end())
+    return;
+
+  this->scheduler.Remove(_entity);
+
+  // Swap with the last sensor to keep the array packed
+  const std::size_t index = it->second;
+  this->sensorIndex.erase(it);
+  if (index + 1u != this->sensors.size())
+  {
+    this->sensors[index] = std::move(this->sensors.back());
+    this->sensorIndex[this->sensors[index].entity] = index;
+  }
+  this->sensors.pop_back();
+}
+
+//////////////////////////////////////////////////
+void PhysicalSensors::Implementation::RemoveSensors(
+    const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("PhysicalSensors::RemoveSensors");
+  auto remove = [&](const Entity &_entity, const auto *) -> bool
+  {
+    this->RemoveSensor(_entity);
+    return true;
+  };
+  _ecm.EachRemoved<components::Imu>(remove);
+  _ecm.EachRemoved<components::Altimeter>(remove);
+  _ecm.EachRemoved<components::Magnetometer>(remove);
+  _ecm.EachRemoved<components::AirPressureSensor>(remove);
+  _ecm.EachRemoved<components::NavSat>(remove);
+}
+
+IGNITION_ADD_PLUGIN(PhysicalSensors, System,
+  PhysicalSensors::ISystemPreUpdate,
+  PhysicalSensors::ISystemPostUpdate
+)
+
+IGNITION_ADD_PLUGIN_ALIAS(PhysicalSensors,
+                          "ignition::gazebo::systems::PhysicalSensors")
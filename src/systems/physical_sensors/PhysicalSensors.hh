@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_PHYSICALSENSORS_HH_
+#define IGNITION_GAZEBO_SYSTEMS_PHYSICALSENSORS_HH_
+
+#include <ignition/utils/ImplPtr.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/System.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  /// \class PhysicalSensors PhysicalSensors.hh
+  /// ignition/gazebo/systems/PhysicalSensors.hh
+  /// \brief System that manages all the IMU, altimeter, magnetometer, air
+  /// pressure and navigation satellite sensors in simulation at once. It
+  /// replaces the Imu, Altimeter, Magnetometer, AirPressure and NavSat
+  /// systems, which shouldn't be loaded together with it, and publishes the
+  /// same messages on the same topics.
+  ///
+  /// Each step, only the sensors which are due and have subscribers are
+  /// updated. The kinematics filled by physics are read for all of them
+  /// in one parallel pass. Sensors without noise are then updated and
+  /// published in parallel. Sensors with noise are updated one after the
+  /// other, in a fixed order, because their noise is drawn from the
+  /// process wide random generator, so seeded runs stay reproducible.
+  ///
+  /// Navigation satellite sensors rely on the world origin's spherical
+  /// coordinates being set, see NavSat.
+  class PhysicalSensors:
+    public System,
+    public ISystemPreUpdate,
+    public ISystemPostUpdate
+  {
+    /// \brief Constructor
+    public: explicit PhysicalSensors();
+
+    // Documentation inherited
+    public: void PreUpdate(const UpdateInfo &_info,
+                           EntityComponentManager &_ecm) final;
+
+    // Documentation inherited
+    public: void PostUpdate(const UpdateInfo &_info,
+                            const EntityComponentManager &_ecm) final;
+
+    /// \brief Private data pointer.
+    IGN_UTILS_UNIQUE_IMPL_PTR(dataPtr)
+  };
+  }
+}
+}
+}
+#endif
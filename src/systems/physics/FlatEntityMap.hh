@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_PHYSICS_FLAT_ENTITY_MAP_HH_
+#define IGNITION_GAZEBO_SYSTEMS_PHYSICS_FLAT_ENTITY_MAP_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "ignition/gazebo/Entity.hh"
+#include "ignition/gazebo/config.hh"
+
+namespace ignition::gazebo
+{
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems::physics_system
+{
+  /// \brief Map from entities to values, stored as a vector of entries
+  /// sorted by entity.
+  ///
+  /// This is meant for tables that are filled and swept every physics step.
+  /// Iterating is a linear sweep over contiguous memory in ascending entity
+  /// order, which is a topological order since entities are created in
+  /// ascending order. Clearing keeps the allocated memory, so a map that's
+  /// reused across steps doesn't allocate once it has reached its
+  /// steady-state size.
+  ///
+  /// Entries can be added in any order with Append, followed by a call to
+  /// Sort before any lookup. operator[] keeps the entries sorted, so it can
+  /// be used while iterating by index, see LowerBound.
+  /// \tparam T Type of the values.
+  template <typename T>
+  class FlatEntityMap
+  {
+    /// \brief Entry type, the entity and its value.
+    public: using Entry = std::pair<Entity, T>;
+
+    /// \brief Iterator over entries.
+    public: using iterator = typename std::vector<Entry>::iterator;
+
+    /// \brief Constant iterator over entries.
+    public: using const_iterator = typename std::vector<Entry>::const_iterator;
+
+    /// \brief Get the value of an entity, adding a default constructed value
+    /// if the entity isn't in the map yet.
+    /// \param[in] _entity Entity.
+    /// \return Reference to the value, valid until the next insertion.
+    public: T &operator[](const Entity _entity)
+    {
+      auto it = this->LowerBoundIt(_entity);
+      if (it == this->entries.end() || it->first != _entity)
+        it = this->entries.insert(it, Entry(_entity, T()));
+      return it->second;
+    }
+
+    /// \brief Add an entry without keeping the entries sorted. Sort must be
+    /// called before using any other function.
+    /// \param[in] _entity Entity.
+    /// \param[in] _value Value.
+    public: void Append(const Entity _entity, const T &_value)
+    {
+      this->entries.emplace_back(_entity, _value);
+    }
+
+    /// \brief Sort entries added with Append. If an entity was appended more
+    /// than once, the last value is kept.
+    public: void Sort()
+    {
+      auto less = [](const Entry &_a, const Entry &_b)
+      {
+        return _a.first < _b.first;
+      };
+
+      // Entries are often appended in order already
+      if (std::is_sorted(this->entries.begin(), this->entries.end(), less))
+      {
+        if (std::adjacent_find(this->entries.begin(), this->entries.end(),
+            [](const Entry &_a, const Entry &_b)
+            {
+              return _a.first == _b.first;
+            }) == this->entries.end())
+        {
+          return;
+        }
+      }
+
+      std::stable_sort(this->entries.begin(), this->entries.end(), less);
+
+      // Keep the last of each run of equal entities
+      auto out = this->entries.begin();
+      for (auto it = this->entries.begin(); it != this->entries.end(); ++it)
+      {
+        auto next = std::next(it);
+        if (next != this->entries.end() && next->first == it->first)
+          continue;
+        if (out != it)
+          *out = std::move(*it);
+        ++out;
+      }
+      this->entries.erase(out, this->entries.end());
+    }
+
+    /// \brief Find the value of an entity.
+    /// \param[in] _entity Entity.
+    /// \return Pointer to the value, or nullptr if the entity isn't in the
+    /// map.
+    public: T *Find(const Entity _entity)
+    {
+      auto it = this->LowerBoundIt(_entity);
+      if (it == this->entries.end() || it->first != _entity)
+        return nullptr;
+      return &it->second;
+    }
+
+    /// \brief Find the value of an entity.
+    /// \param[in] _entity Entity.
+    /// \return Pointer to the value, or nullptr if the entity isn't in the
+    /// map.
+    public: const T *Find(const Entity _entity) const
+    {
+      return const_cast<FlatEntityMap *>(this)->Find(_entity);
+    }
+
+    /// \brief Remove an entity.
+    /// \param[in] _entity Entity.
+    /// \return True if the entity was in the map.
+    public: bool Erase(const Entity _entity)
+    {
+      auto it = this->LowerBoundIt(_entity);
+      if (it == this->entries.end() || it->first != _entity)
+        return false;
+      this->entries.erase(it);
+      return true;
+    }
+
+    /// \brief Index of the first entry whose entity isn't less than
+    /// _entity. When adding entries while iterating by index, use this to
+    /// find the position of the current entity again.
+    /// \param[in] _entity Entity.
+    /// \return Index in [0, Size()].
+    public: std::size_t LowerBound(const Entity _entity) const
+    {
+      auto it = std::lower_bound(this->entries.begin(), this->entries.end(),
+          _entity, &FlatEntityMap::EntryLess);
+      return static_cast<std::size_t>(
+          std::distance(this->entries.begin(), it));
+    }
+
+    /// \brief Get an entry by index.
+    /// \param[in] _index Index in [0, Size()).
+    /// \return The entry.
+    public: Entry &At(const std::size_t _index)
+    {
+      return this->entries[_index];
+    }
+
+    /// \brief Remove all entries, keeping the allocated memory.
+    public: void Clear()
+    {
+      this->entries.clear();
+    }
+
+    /// \brief Number of entries.
+    /// \return Number of entries.
+    public: std::size_t Size() const
+    {
+      return this->entries.size();
+    }
+
+    /// \brief Whether the map is empty.
+    /// \return True if there are no entries.
+    public: bool Empty() const
+    {
+      return this->entries.empty();
+    }
+
+    /// \brief Iterator to the first entry.
+    /// \return Iterator.
+    public: iterator begin()
+    {
+      return this->entries.begin();
+    }
+
+    /// \brief Iterator past the last entry.
+    /// \return Iterator.
+    public: iterator end()
+    {
+      return this->entries.end();
+    }
+
+    /// \brief Iterator to the first entry.
+    /// \return Iterator.
+    public: const_iterator begin() const
+    {
+      return this->entries.begin();
+    }
+
+    /// \brief Iterator past the last entry.
+    /// \return Iterator.
+    public: const_iterator end() const
+    {
+      return this->entries.end();
+    }
+
+    /// \brief Binary search for an entity.
+    /// \param[in] _entity Entity.
+    /// \return Iterator to the first entry not less than _entity.
+    private: iterator LowerBoundIt(const Entity _entity)
+    {
+      return std::lower_bound(this->entries.begin(), this->entries.end(),
+          _entity, &FlatEntityMap::EntryLess);
+    }
+
+    /// \brief Compare an entry with an entity, for binary searches.
+    /// \param[in] _entry Entry.
+    /// \param[in] _entity Entity.
+    /// \return True if the entry's entity is less than _entity.
+    private: static bool EntryLess(const Entry &_entry, const Entity _entity)
+    {
+      return _entry.first < _entity;
+    }
+
+    /// \brief Entries, sorted by entity except between Append and Sort.
+    private: std::vector<Entry> entries;
+  };
+}
+}
+}
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "FlatEntityMap.hh"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace ignition;
+using namespace ignition::gazebo;
+using namespace ignition::gazebo::systems::physics_system;
+
+/////////////////////////////////////////////////
+TEST(FlatEntityMap, InsertFindErase)
+{
+  FlatEntityMap<int> map;
+  EXPECT_TRUE(map.Empty());
+  EXPECT_EQ(nullptr, map.Find(1));
+
+  map[5] = 50;
+  map[2] = 20;
+  map[9] = 90;
+  map[5] = 55;
+  EXPECT_EQ(3u, map.Size());
+
+  ASSERT_NE(nullptr, map.Find(5));
+  EXPECT_EQ(55, *map.Find(5));
+  EXPECT_EQ(nullptr, map.Find(3));
+
+  // Iteration is in ascending entity order
+  std::vector<Entity> entities;
+  for (const auto &[entity, value] : map)
+    entities.push_back(entity);
+  EXPECT_EQ((std::vector<Entity>{2, 5, 9}), entities);
+
+  EXPECT_TRUE(map.Erase(5));
+  EXPECT_FALSE(map.Erase(5));
+  EXPECT_EQ(2u, map.Size());
+
+  map.Clear();
+  EXPECT_TRUE(map.Empty());
+}
+
+/////////////////////////////////////////////////
+TEST(FlatEntityMap, AppendSort)
+{
+  FlatEntityMap<int> map;
+  map.Append(7, 1);
+  map.Append(3, 2);
+  map.Append(7, 3);
+  map.Append(1, 4);
+  map.Sort();
+
+  ASSERT_EQ(3u, map.Size());
+  EXPECT_EQ(1u, map.At(0).first);
+  EXPECT_EQ(3u, map.At(1).first);
+  EXPECT_EQ(7u, map.At(2).first);
+
+  // Last appended value wins
+  EXPECT_EQ(3, *map.Find(7));
+
+  // Already sorted
+  map.Append(8, 5);
+  map.Sort();
+  EXPECT_EQ(4u, map.Size());
+  EXPECT_EQ(5, *map.Find(8));
+}
+
+/////////////////////////////////////////////////
+TEST(FlatEntityMap, InsertWhileIterating)
+{
+  FlatEntityMap<int> map;
+  map[10] = 0;
+  map[20] = 0;
+
+  // Like std::map, entries added after the current one are visited, and
+  // entries added before it aren't
+  std::vector<Entity> visited;
+  for (std::size_t i = 0; i < map.Size(); ++i)
+  {
+    const Entity entity = map.At(i).first;
+    visited.push_back(entity);
+    if (entity == 10)
+    {
+      map[15] = 0;
+      map[5] = 0;
+    }
+    i = map.LowerBound(entity);
+  }
+  EXPECT_EQ((std::vector<Entity>{10, 15, 20}), visited);
+  EXPECT_EQ(4u, map.Size());
+}
@@ -23,23 +23,30 @@
 #include <ignition/msgs/Utility.hh>
 
 #include <algorithm>
+#include <condition_variable>
 #include <iostream>
 #include <deque>
-#include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include <ignition/common/Filesystem.hh>
 #include <ignition/common/HeightmapData.hh>
 #include <ignition/common/ImageHeightmap.hh>
 #include <ignition/common/MeshManager.hh>
 #include <ignition/common/Profiler.hh>
 #include <ignition/common/SystemPaths.hh>
+#include <ignition/common/Util.hh>
 #include <ignition/common/Uuid.hh>
 #include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/eigen3/Conversions.hh>
+#include <ignition/math/Helpers.hh>
 #include <ignition/math/Vector3.hh>
 #include <ignition/physics/config.hh>
 #include <ignition/physics/FeatureList.hh>
@@ -86,7 +93,12 @@
 #include <sdf/World.hh>
 
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/Events.hh"
+#include "ignition/gazebo/KinematicsSnapshot.hh"
+#include "ignition/gazebo/MeshCache.hh"
 #include "ignition/gazebo/Model.hh"
+#include "ignition/gazebo/TerrainTiles.hh"
+#include "ignition/gazebo/TraceRecorder.hh"
 #include "ignition/gazebo/Util.hh"
 
 // Components
@@ -98,6 +110,7 @@
 #include "ignition/gazebo/components/CanonicalLink.hh"
 #include "ignition/gazebo/components/ChildLinkName.hh"
 #include "ignition/gazebo/components/Collision.hh"
+#include "ignition/gazebo/components/ContactPoints.hh"
 #include "ignition/gazebo/components/ContactSensorData.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Gravity.hh"
@@ -135,6 +148,8 @@
 #include "ignition/gazebo/components/Static.hh"
 #include "ignition/gazebo/components/ThreadPitch.hh"
 #include "ignition/gazebo/components/World.hh"
+#include "ignition/gazebo/components/WorldAngularVelocity.hh"
+#include "ignition/gazebo/components/WorldLinearVelocity.hh"
 #include "ignition/gazebo/components/HaltMotion.hh"
 
 #include "CanonicalLinkModelTracker.hh"
@@ -142,6 +157,7 @@
 #include "ignition/gazebo/physics/Events.hh"
 
 #include "EntityFeatureMap.hh"
+#include "FlatEntityMap.hh"
 
 using namespace ignition;
 using namespace ignition::gazebo;
@@ -225,12 +241,70 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// \param[in] _ecm Mutable reference to ECM.
   public: void UpdatePhysics(EntityComponentManager &_ecm);
 
-  /// \brief Step the simulation for each world
+  /// \brief Set the state of the engine from the components after a
+  /// snapshot was restored: joint positions and velocities, and the poses
+  /// and velocities of the free groups of top level models. Velocities of
+  /// free groups whose root link doesn't have world velocity components are
+  /// set to zero.
+  /// \param[in] _ecm Constant reference to ECM.
+  public: void RestoreState(const EntityComponentManager &_ecm);
+
+  /// \brief Step the simulation for each world, split into `substeps`
+  /// engine steps.
   /// \param[in] _dt Duration
+  /// \param[in] _ecm Constant reference to ECM, used to step islands in
+  /// parallel.
   /// \returns Output data from the physics engine (this currently contains
   /// data for links that experienced a pose change in the physics step)
   public: ignition::physics::ForwardStep::Output Step(
-              const std::chrono::steady_clock::duration &_dt);
+              const std::chrono::steady_clock::duration &_dt,
+              const EntityComponentManager &_ecm);
+
+  /// \brief Start stepping the simulation on the step thread, which is
+  /// created on first use. Nothing else may access the physics engine until
+  /// WaitForStep returns.
+  /// \param[in] _dt Duration
+  /// \param[in] _ecm Constant reference to ECM, which must outlive the
+  /// step.
+  public: void StartStep(const std::chrono::steady_clock::duration &_dt,
+              const EntityComponentManager &_ecm);
+
+  /// \brief Wait for the step started by StartStep to finish. Its output
+  /// is left in stepOutput.
+  public: void WaitForStep();
+
+  /// \brief Stop the step thread, waiting for the current step first.
+  public: void StopStepThread();
+
+  /// \brief Apply the commands cached by UpdatePhysics again, before a
+  /// sub-step other than the first.
+  public: void ApplySubStepCommands();
+
+  /// \brief Do a single engine step of each world, including islands.
+  /// \param[in] _dt Duration
+  /// \param[in] _ecm Constant reference to ECM, used to step islands in
+  /// parallel.
+  /// \returns Output data from the physics engine.
+  public: ignition::physics::ForwardStep::Output SubStep(
+              const std::chrono::steady_clock::duration &_dt,
+              const EntityComponentManager &_ecm);
+
+  /// \brief Create the physics world of a new island, which will hold a
+  /// single top-level model. Static top-level models which are already
+  /// known are copied into it.
+  /// \param[in] _world World entity the model belongs to.
+  /// \param[in] _model Top-level model entity.
+  /// \param[in] _ecm Constant reference to ECM.
+  /// \return The new physics world.
+  public: WorldPtrType CreateIsland(const Entity _world, const Entity _model,
+              const EntityComponentManager &_ecm);
+
+  /// \brief Copy a static top-level model into the physics world of an
+  /// island, so that the island's model can collide with it.
+  /// \param[in] _model Static model entity.
+  /// \param[in] _island Physics world of the island.
+  public: void AddStaticCopy(const Entity _model,
+              const WorldPtrType &_island);
 
   /// \brief Get data of links that were updated in the latest physics step.
   /// \param[in] _ecm Mutable reference to ECM.
@@ -238,13 +312,15 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// that were written to by the physics engine (some physics engines may
   /// not write this data to ForwardStep::Output. If not, _ecm is used to get
   /// this updated link pose data).
-  /// \return A map of gazebo link entities to their updated pose data.
-  /// std::map is used because canonical links must be in topological order
-  /// to ensure that nested models with multiple canonical links are updated
-  /// properly (models must be updated in topological order).
-  public: std::map<Entity, physics::FrameData3d> ChangedLinks(
+  /// \param[out] _linkFrameData Map of gazebo link entities to their
+  /// updated pose data. It's cleared first. The map is sorted by entity
+  /// because canonical links must be in topological order to ensure that
+  /// nested models with multiple canonical links are updated properly (models
+  /// must be updated in topological order).
+  public: void ChangedLinks(
               EntityComponentManager &_ecm,
-              const ignition::physics::ForwardStep::Output &_updatedLinks);
+              const ignition::physics::ForwardStep::Output &_updatedLinks,
+              FlatEntityMap<physics::FrameData3d> &_linkFrameData);
 
   /// \brief Helper function to update the pose of a model.
   /// \param[in] _model The model to update.
@@ -259,7 +335,7 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// updated since nested model poses are saved w.r.t. the parent model).
   public: void UpdateModelPose(const Entity _model,
               const Entity _canonicalLink, EntityComponentManager &_ecm,
-              std::map<Entity, physics::FrameData3d> &_linkFrameData);
+              FlatEntityMap<physics::FrameData3d> &_linkFrameData);
 
   /// \brief Get an entity's frame data relative to world from physics.
   /// \param[in] _entity The entity.
@@ -275,7 +351,43 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// most recent physics step. The key is the entity of the link, and the
   /// value is the updated frame data corresponding to that entity.
   public: void UpdateSim(EntityComponentManager &_ecm,
-              std::map<Entity, physics::FrameData3d> &_linkFrameData);
+              FlatEntityMap<physics::FrameData3d> &_linkFrameData);
+
+  /// \brief Update the kinematics of links and models with the latest
+  /// step and emit events::KinematicsUpdated, if it has subscribers.
+  /// \param[in] _info Update information.
+  /// \param[in] _ecm Constant reference to ECM.
+  /// \param[in] _linkFrameData Links that experienced a pose change in the
+  /// most recent physics step.
+  public: void PublishKinematics(const UpdateInfo &_info,
+              const EntityComponentManager &_ecm,
+              const FlatEntityMap<physics::FrameData3d> &_linkFrameData);
+
+  /// \brief A component which has been written to and needs to be marked
+  /// as changed on the ECM.
+  public: struct ComponentChange
+  {
+    /// \brief Entity which owns the component.
+    Entity entity;
+
+    /// \brief Type of the component.
+    ComponentTypeId typeId;
+
+    /// \brief State to mark the component with.
+    ComponentState state;
+  };
+
+  /// \brief Write the pose, velocity and acceleration components of a link
+  /// from its latest frame data. This only looks up existing components, so
+  /// it's safe to call for different links in parallel.
+  /// \param[in] _ecm Mutable reference to ECM.
+  /// \param[in] _entity Link entity.
+  /// \param[in] _frameData Frame data of the link relative to the world.
+  /// \param[out] _changes Components which need to be marked as changed
+  /// are appended here.
+  public: void UpdateLinkComponents(EntityComponentManager &_ecm,
+              const Entity _entity, const physics::FrameData3d &_frameData,
+              std::vector<ComponentChange> &_changes) const;
 
   /// \brief Update collision components from physics simulation
   /// \param[in] _ecm Mutable reference to ECM.
@@ -314,7 +426,7 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// \brief Keep track of poses for links attached to non-static models.
   /// This allows for skipping pose updates if a link's pose didn't change
   /// after a physics step.
-  public: std::unordered_map<Entity, ignition::math::Pose3d> linkWorldPoses;
+  public: FlatEntityMap<ignition::math::Pose3d> linkWorldPoses;
 
   /// \brief Keep a mapping of canonical links to models that have this
   /// canonical link. Useful for updating model poses efficiently after a
@@ -324,7 +436,72 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// \brief Keep track of non-static model world poses. Since non-static
   /// models may not move on a given iteration, we want to keep track of the
   /// most recent model world pose change that took place.
-  public: std::unordered_map<Entity, math::Pose3d> modelWorldPoses;
+  public: FlatEntityMap<math::Pose3d> modelWorldPoses;
+
+  /// \brief Frame data of the links that changed in the latest step. It's
+  /// kept across steps so its memory is reused.
+  public: FlatEntityMap<physics::FrameData3d> changedLinks;
+
+  /// \brief Link components which have been written in the latest step and
+  /// need to be marked as changed. Kept across steps so its memory is reused.
+  public: std::vector<ComponentChange> linkChanges;
+
+  /// \brief Frame data of sensors and collisions relative to the world,
+  /// computed once per step and shared by all their components.
+  public: FlatEntityMap<physics::FrameData3d> offsetFrameData;
+
+  /// \brief Whether link components are written back to the ECM in
+  /// parallel after each step.
+  public: bool parallelWriteBack{false};
+
+  /// \brief Whether the engine is stepped on a separate thread, overlapping
+  /// with the systems that run after physics.
+  public: bool asyncStep{false};
+
+  /// \brief Thread which steps the engine when asyncStep is enabled.
+  public: std::thread stepThread;
+
+  /// \brief Protects the step request and output below.
+  public: std::mutex stepMutex;
+
+  /// \brief Signals changes to stepPending and stopStep.
+  public: std::condition_variable stepCv;
+
+  /// \brief True from StartStep until the step thread is done stepping.
+  public: bool stepPending{false};
+
+  /// \brief True when the step thread should exit.
+  public: bool stopStep{false};
+
+  /// \brief Duration of the pending step.
+  public: std::chrono::steady_clock::duration stepDt{0};
+
+  /// \brief ECM passed to the pending step.
+  public: const EntityComponentManager *stepEcm{nullptr};
+
+  /// \brief Output of the latest asynchronous step.
+  public: ignition::physics::ForwardStep::Output stepOutput;
+
+  /// \brief Number of engine steps done for each simulation iteration.
+  /// Components are only synchronized after the last one.
+  public: unsigned int substeps{1u};
+
+  /// \brief Whether each non-static top-level model is simulated in its own
+  /// physics world, or island. Islands are stepped in parallel.
+  public: bool islands{false};
+
+  /// \brief Physics world of each island. The key is the top-level model
+  /// held by the island.
+  public: std::unordered_map<Entity, WorldPtrType> islandWorlds;
+
+  /// \brief SDF of static top-level models, which are copied into every
+  /// island.
+  public: std::unordered_map<Entity, sdf::Model> staticModelSdfs;
+
+  /// \brief Copies of each static top-level model in the islands, so they
+  /// can be removed together with the model.
+  public: std::unordered_map<Entity, std::vector<ModelPtrType>>
+      staticModelCopies;
 
   /// \brief A map between model entity ids in the ECM to whether its battery
   /// has drained.
@@ -337,6 +514,11 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// \brief IDs of the ContactSurfaceHandler callbacks registered for worlds
   public: std::unordered_map<Entity, std::string> worldContactCallbackIDs;
 
+  /// \brief ECM version at the last time slip compliance commands were
+  /// applied. Commands which didn't change since are already set on the
+  /// shapes.
+  public: uint64_t slipComplianceVersion{0u};
+
   /// \brief used to store whether physics objects have been created.
   public: bool initialized = false;
 
@@ -565,6 +747,47 @@ class ignition::gazebo::systems::PhysicsPrivate
             CollisionFeatureList,
             physics::heightmap::AttachHeightmapShapeFeature>{};
 
+  /// \brief Heightmap collision split into tiles, which are attached to
+  /// its link as dynamic models come near.
+  public: struct TerrainCollision
+  {
+    /// \brief Link the tiles are attached to.
+    Entity link{kNullEntity};
+
+    /// \brief Name of the collision.
+    std::string name;
+
+    /// \brief Pose of the collision in the link frame.
+    math::Pose3d pose;
+
+    /// \brief Collide bitmask of the collision.
+    uint16_t collideBitmask{0xFF};
+
+    /// \brief Tiles of the heightmap.
+    std::shared_ptr<TerrainTiles> tiles;
+
+    /// \brief Shapes of the tiles attached so far, by tile index.
+    std::unordered_map<std::size_t, ShapePtrType> attached;
+  };
+
+  /// \brief Heightmap collisions split into tiles, keyed by collision
+  /// entity.
+  public: std::unordered_map<Entity, TerrainCollision> terrainCollisions;
+
+  /// \brief Samples along a side of terrain tiles, zero if heightmaps
+  /// aren't split into tiles.
+  public: unsigned int terrainTileSamples{0u};
+
+  /// \brief Distance to a dynamic model from which terrain tiles are
+  /// attached.
+  public: double terrainRadius{50.0};
+
+  /// \brief Attach the terrain tiles which dynamic models came near to.
+  /// Tiles stay attached once they are, since physics engines can't
+  /// remove shapes.
+  /// \param[in] _ecm Constant reference to ECM.
+  public: void UpdateTerrainCollisions(const EntityComponentManager &_ecm);
+
   //////////////////////////////////////////////////
   // Collision detector
   /// \brief Feature list for setting and getting the collision detector
@@ -643,6 +866,24 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// ign-physics
   public: EntityJointMap entityJointMap;
 
+  /// \brief Joint forces applied by UpdatePhysics. Engines clear forces and
+  /// commands after each step, so when sub-stepping they're applied again
+  /// before every sub-step after the first.
+  public: std::vector<std::pair<EntityJointMap::RequiredEntityPtr,
+              std::vector<double>>> substepJointForces;
+
+  /// \brief Joint velocity commands applied by UpdatePhysics, applied again
+  /// like substepJointForces.
+  public: std::vector<std::pair<physics::JointPtr<physics::FeaturePolicy3d,
+              JointVelocityCommandFeatureList>, std::vector<double>>>
+              substepJointVelocities;
+
+  /// \brief Link wrenches applied by UpdatePhysics as force and torque,
+  /// applied again like substepJointForces.
+  public: std::vector<std::tuple<physics::LinkPtr<physics::FeaturePolicy3d,
+              LinkForceFeatureList>, math::Vector3d, math::Vector3d>>
+              substepWrenches;
+
   /// \brief Collision EntityFeatureMap
   public: using EntityCollisionMap = EntityFeatureMap3d<
             physics::Shape,
@@ -670,6 +911,28 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// \brief Event manager from simulation runner.
   public: EventManager *eventManager = nullptr;
 
+  /// \brief Event emitted with the kinematics of each step, looked up once
+  /// while configuring.
+  public: events::KinematicsUpdated *kinematicsEvent = nullptr;
+
+  /// \brief Connection to the SnapshotRestored event.
+  public: common::ConnectionPtr snapshotRestoredConn;
+
+  /// \brief True if a snapshot was restored since the last update, so the
+  /// engine must be set from the components.
+  public: bool snapshotRestored{false};
+
+  /// \brief Kinematics of non-static links and models, only kept up to
+  /// date while events::KinematicsUpdated has subscribers.
+  public: std::unordered_map<Entity, EntityKinematics> kinematics;
+
+  /// \brief True once kinematics holds all links and models.
+  public: bool kinematicsSeeded{false};
+
+  /// \brief Entities which moved in the latest step, whose velocities are
+  /// reset if they don't move in the next one.
+  public: std::vector<Entity> movedKinematics;
+
   /// \brief Keep track of what entities use customized contact surfaces.
   /// Map keys are expected to be world entities so that we keep a set of
   /// entities with customizations per world.
@@ -746,6 +1009,56 @@ void Physics::Configure(const Entity &_entity,
       "include_entity_names", true).first;
   }
 
+  // Check if cooked meshes should be stored somewhere else.
+  auto meshCacheElem = _sdf->FindElement("mesh_cache");
+  if (meshCacheElem && meshCacheElem->HasElement("path"))
+  {
+    MeshCache::Instance().SetCacheDir(
+        meshCacheElem->Get<std::string>("path"));
+  }
+
+  // Check if large heightmap collisions should be split into tiles.
+  auto terrainTilesElem = _sdf->FindElement("terrain_tiles");
+  if (terrainTilesElem)
+  {
+    auto tileSamples = terrainTilesElem->Get<int>("tile_samples",
+        TerrainTiles::kDefaultTileSamples).first;
+    if (tileSamples < 3 || !math::isPowerOfTwo(
+        static_cast<unsigned int>(tileSamples - 1)))
+    {
+      ignerr << "<terrain_tiles><tile_samples> must be a power of two plus "
+             << "one, got [" << tileSamples << "]. Using ["
+             << TerrainTiles::kDefaultTileSamples << "]." << std::endl;
+      tileSamples = static_cast<int>(TerrainTiles::kDefaultTileSamples);
+    }
+    this->dataPtr->terrainTileSamples =
+        static_cast<unsigned int>(tileSamples);
+    this->dataPtr->terrainRadius = terrainTilesElem->Get<double>("radius",
+        this->dataPtr->terrainRadius).first;
+  }
+
+  // Check if link components should be written back in parallel.
+  this->dataPtr->parallelWriteBack = _sdf->Get<bool>("parallel_write_back",
+      this->dataPtr->parallelWriteBack).first;
+
+  // Check if the engine should be stepped asynchronously.
+  this->dataPtr->asyncStep = _sdf->Get<bool>("async_step",
+      this->dataPtr->asyncStep).first;
+
+  // Check how many engine steps to do per iteration.
+  auto substeps = _sdf->Get<int>("substeps", 1).first;
+  if (substeps < 1)
+  {
+    ignerr << "<substeps> must be at least 1, got [" << substeps
+           << "]. Using 1." << std::endl;
+    substeps = 1;
+  }
+  this->dataPtr->substeps = static_cast<unsigned int>(substeps);
+
+  // Check if top-level models should be simulated in separate worlds.
+  this->dataPtr->islands = _sdf->Get<bool>("islands",
+      this->dataPtr->islands).first;
+
   // Find engine shared library
   // Look in:
   // * Paths from environment variable
@@ -828,36 +1141,83 @@ void Physics::Configure(const Entity &_entity,
   }
 
   this->dataPtr->eventManager = &_eventMgr;
+  this->dataPtr->kinematicsEvent =
+      _eventMgr.Handle<events::KinematicsUpdated>();
+  this->dataPtr->snapshotRestoredConn =
+      _eventMgr.Connect<events::SnapshotRestored>([this]()
+      {
+        this->dataPtr->snapshotRestored = true;
+      });
 }
 
 //////////////////////////////////////////////////
-Physics::~Physics() = default;
+Physics::~Physics()
+{
+  this->dataPtr->StopStepThread();
+}
 
 //////////////////////////////////////////////////
 void Physics::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
 {
-  IGN_PROFILE("Physics::Update");
+  IGN_GAZEBO_PROFILE("Physics::Update");
+
+  // Restored snapshots are the only supported way back in time
+  const bool restored = this->dataPtr->snapshotRestored;
+  this->dataPtr->snapshotRestored = false;
 
   // \TODO(anyone) Support rewind
-  if (_info.dt < std::chrono::steady_clock::duration::zero())
+  if (_info.dt < std::chrono::steady_clock::duration::zero() && !restored)
   {
     ignwarn << "Detected jump back in time ["
         << std::chrono::duration_cast<std::chrono::seconds>(_info.dt).count()
         << "s]. System may not work properly." << std::endl;
   }
 
-  if (this->dataPtr->engine)
+  if (this->dataPtr->engine && this->dataPtr->asyncStep)
   {
+    // The step started on the previous iteration ran while the rest of the
+    // systems were updating, so its results are written now and the next
+    // step is started right away. Components lag one iteration behind the
+    // engine. The step was normally joined in PostUpdate already.
+    this->dataPtr->WaitForStep();
+    auto stepOutput = std::move(this->dataPtr->stepOutput);
+    this->dataPtr->stepOutput = ignition::physics::ForwardStep::Output();
     this->dataPtr->CreatePhysicsEntities(_ecm);
+    if (restored)
+    {
+      // The results of the step predate the snapshot, so they're discarded
+      // and links are read back from the restored engine instead
+      stepOutput = ignition::physics::ForwardStep::Output();
+      this->dataPtr->RestoreState(_ecm);
+    }
+    this->dataPtr->UpdatePhysics(_ecm);
+    this->dataPtr->ChangedLinks(_ecm, stepOutput,
+        this->dataPtr->changedLinks);
+    this->dataPtr->UpdateSim(_ecm, this->dataPtr->changedLinks);
+    this->dataPtr->PublishKinematics(_info, _ecm,
+        this->dataPtr->changedLinks);
+    this->dataPtr->RemovePhysicsEntities(_ecm);
+
+    if (!_info.paused)
+      this->dataPtr->StartStep(_info.dt, _ecm);
+  }
+  else if (this->dataPtr->engine)
+  {
+    this->dataPtr->CreatePhysicsEntities(_ecm);
+    if (restored)
+      this->dataPtr->RestoreState(_ecm);
     this->dataPtr->UpdatePhysics(_ecm);
     ignition::physics::ForwardStep::Output stepOutput;
     // Only step if not paused.
     if (!_info.paused)
     {
-      stepOutput = this->dataPtr->Step(_info.dt);
+      stepOutput = this->dataPtr->Step(_info.dt, _ecm);
     }
-    auto changedLinks = this->dataPtr->ChangedLinks(_ecm, stepOutput);
-    this->dataPtr->UpdateSim(_ecm, changedLinks);
+    this->dataPtr->ChangedLinks(_ecm, stepOutput,
+        this->dataPtr->changedLinks);
+    this->dataPtr->UpdateSim(_ecm, this->dataPtr->changedLinks);
+    this->dataPtr->PublishKinematics(_info, _ecm,
+        this->dataPtr->changedLinks);
 
     // Entities scheduled to be removed should be removed from physics after the
     // simulation step. Otherwise, since the to-be-removed entity still shows up
@@ -866,6 +1226,19 @@ void Physics::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
   }
 }
 
+//////////////////////////////////////////////////
+void Physics::PostUpdate(const UpdateInfo &/*_info*/,
+    const EntityComponentManager &/*_ecm*/)
+{
+  IGN_GAZEBO_PROFILE("Physics::PostUpdate");
+
+  // The step may call back into other systems, such as contact surface
+  // customization in TrackController, and those read state which they write
+  // in PreUpdate, so it's not allowed to run into the next iteration
+  if (this->dataPtr->asyncStep)
+    this->dataPtr->WaitForStep();
+}
+
 //////////////////////////////////////////////////
 void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
 {
@@ -880,6 +1253,7 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
   this->CreateCollisionEntities(_ecm);
   this->CreateJointEntities(_ecm);
   this->CreateBatteryEntities(_ecm);
+  this->UpdateTerrainCollisions(_ecm);
 }
 
 //////////////////////////////////////////////////
@@ -1032,12 +1406,30 @@ void PhysicsPrivate::CreateModelEntities(const EntityComponentManager &_ecm)
             this->topLevelModelMap.insert(std::make_pair(_entity,
                 topLevelModel(_entity, _ecm)));
           }
+          else if (this->islands && !model.Static())
+          {
+            auto island = this->CreateIsland(_parent->Data(), _entity, _ecm);
+            auto modelPtrPhys = island->ConstructModel(model);
+            this->entityModelMap.AddEntity(_entity, modelPtrPhys);
+            this->topLevelModelMap.insert(std::make_pair(_entity,
+                topLevelModel(_entity, _ecm)));
+          }
           else
           {
             auto modelPtrPhys = worldPtrPhys->ConstructModel(model);
             this->entityModelMap.AddEntity(_entity, modelPtrPhys);
             this->topLevelModelMap.insert(std::make_pair(_entity,
                 topLevelModel(_entity, _ecm)));
+
+            // Islands can't see the main world, so give each of them its own
+            // copy of static models such as the ground
+            auto modelSdfComp = _ecm.Component<components::ModelSdf>(_entity);
+            if (this->islands && modelSdfComp)
+            {
+              this->staticModelSdfs[_entity] = modelSdfComp->Data();
+              for (const auto &island : this->islandWorlds)
+                this->AddStaticCopy(_entity, island.second);
+            }
           }
         }
         // check if parent is a model (nested model)
@@ -1226,9 +1618,8 @@ void PhysicsPrivate::CreateCollisionEntities(const EntityComponentManager &_ecm)
             return true;
           }
 
-          auto &meshManager = *common::MeshManager::Instance();
           auto fullPath = asFullPath(meshSdf->Uri(), meshSdf->FilePath());
-          auto *mesh = meshManager.Load(fullPath);
+          auto *mesh = MeshCache::Instance().Load(fullPath);
           if (nullptr == mesh)
           {
             ignwarn << "Failed to load mesh from [" << fullPath
@@ -1300,6 +1691,30 @@ void PhysicsPrivate::CreateCollisionEntities(const EntityComponentManager &_ecm)
             return true;
           }
 
+          // Large heightmaps may be split into tiles instead, which are
+          // attached by UpdateTerrainCollisions. As for whole heightmaps,
+          // the heightmap's position isn't applied.
+          if (this->terrainTileSamples > 0u &&
+              TerrainTiles::Tiled(data, heightmapSdf->Sampling(),
+                  this->terrainTileSamples))
+          {
+            TerrainCollision terrain;
+            terrain.link = _parent->Data();
+            terrain.name = _name->Data();
+            terrain.pose = _pose->Data();
+            terrain.collideBitmask = collideBitmask;
+            terrain.tiles = std::make_shared<TerrainTiles>();
+            if (terrain.tiles->Load(data, heightmapSdf->Size(),
+                math::Vector3d::Zero, heightmapSdf->Sampling(),
+                this->terrainTileSamples))
+            {
+              this->terrainCollisions[_entity] = std::move(terrain);
+              this->topLevelModelMap.insert(std::make_pair(_entity,
+                  topLevelModel(_entity, _ecm)));
+              return true;
+            }
+          }
+
           collisionPtrPhys = linkHeightmapFeature->AttachHeightmapShape(
               _name->Data(),
               data,
@@ -1416,6 +1831,86 @@ void PhysicsPrivate::CreateCollisionEntities(const EntityComponentManager &_ecm)
       });
 }
 
+//////////////////////////////////////////////////
+void PhysicsPrivate::UpdateTerrainCollisions(
+    const EntityComponentManager &_ecm)
+{
+  if (this->terrainCollisions.empty())
+    return;
+
+  IGN_GAZEBO_PROFILE("PhysicsPrivate::UpdateTerrainCollisions");
+
+  // Top-level dynamic models, whose poses are in the world frame. Nested
+  // models and links are expected to be within the radius of them.
+  std::vector<math::Vector3d> positions;
+  _ecm.EachDynamic<components::Model, components::Pose,
+      components::ParentEntity>(
+      [&](const Entity &, const components::Model *,
+          const components::Pose *_pose,
+          const components::ParentEntity *_parent) -> bool
+      {
+        if (nullptr == _ecm.Component<components::Model>(_parent->Data()))
+          positions.push_back(_pose->Data().Pos());
+        return true;
+      });
+  if (positions.empty())
+    return;
+
+  std::vector<math::Vector3d> points;
+  std::vector<TerrainTiles::Tile> tiles;
+  for (auto &[entity, terrain] : this->terrainCollisions)
+  {
+    // Tiles are selected in the frame of the collision
+    const auto linkPose = worldPose(terrain.link, _ecm);
+    const math::Pose3d pose(
+        linkPose.Pos() + linkPose.Rot().RotateVector(terrain.pose.Pos()),
+        linkPose.Rot() * terrain.pose.Rot());
+    points.clear();
+    for (const auto &position : positions)
+      points.push_back(pose.Rot().RotateVectorReverse(position - pose.Pos()));
+    terrain.tiles->Select(points, this->terrainRadius, 0.0, tiles);
+
+    auto linkHeightmapFeature =
+        this->entityLinkMap.EntityCast<HeightmapFeatureList>(terrain.link);
+    if (!linkHeightmapFeature)
+      continue;
+
+    for (const auto &tile : tiles)
+    {
+      if (terrain.attached.find(tile.index) != terrain.attached.end())
+        continue;
+
+      auto data = terrain.tiles->TileData(tile.index, 0u);
+      const auto tilePosition = terrain.tiles->TilePosition(tile.index);
+      const math::Pose3d tilePose(terrain.pose.Pos() +
+          terrain.pose.Rot().RotateVector(tilePosition), terrain.pose.Rot());
+      ShapePtrType shape = linkHeightmapFeature->AttachHeightmapShape(
+          terrain.name + "_tile_" + std::to_string(tile.index), *data,
+          math::eigen3::convert(tilePose),
+          math::eigen3::convert(terrain.tiles->TileSize()), 1);
+      if (nullptr == shape)
+      {
+        ignerr << "Failed to attach tile [" << tile.index
+               << "] of heightmap collision [" << terrain.name << "]."
+               << std::endl;
+        // Not retried every step
+        terrain.attached[tile.index] = nullptr;
+        continue;
+      }
+
+      // Contacts with any of the tiles are reported for the collision
+      this->entityCollisionMap.AddEntity(entity, shape);
+      terrain.attached[tile.index] = shape;
+
+      // Casts of the map are cached for the collision's first shape
+      auto filterMaskFeature =
+          physics::RequestFeatures<CollisionMaskFeatureList>::From(shape);
+      if (filterMaskFeature)
+        filterMaskFeature->SetCollisionFilterMask(terrain.collideBitmask);
+    }
+  }
+}
+
 //////////////////////////////////////////////////
 void PhysicsPrivate::CreateJointEntities(const EntityComponentManager &_ecm)
 {
@@ -1677,6 +2172,16 @@ void PhysicsPrivate::RemovePhysicsEntities(const EntityComponentManager &_ecm)
             for (const auto &childCollision :
                  _ecm.ChildrenByComponents(childLink, components::Collision()))
             {
+              auto terrainIt = this->terrainCollisions.find(childCollision);
+              if (terrainIt != this->terrainCollisions.end())
+              {
+                for (const auto &tile : terrainIt->second.attached)
+                {
+                  if (tile.second)
+                    this->entityCollisionMap.Remove(tile.second);
+                }
+                this->terrainCollisions.erase(terrainIt);
+              }
               this->entityCollisionMap.Remove(childCollision);
               this->topLevelModelMap.erase(childCollision);
               if (this->customContactSurfaceEntities[world].erase(
@@ -1693,7 +2198,7 @@ void PhysicsPrivate::RemovePhysicsEntities(const EntityComponentManager &_ecm)
             this->entityLinkMap.Remove(childLink);
             this->topLevelModelMap.erase(childLink);
             this->staticEntities.erase(childLink);
-            this->linkWorldPoses.erase(childLink);
+            this->linkWorldPoses.Erase(childLink);
             this->canonicalLinkModelTracker.RemoveLink(childLink);
           }
 
@@ -1704,13 +2209,28 @@ void PhysicsPrivate::RemovePhysicsEntities(const EntityComponentManager &_ecm)
             this->topLevelModelMap.erase(childJoint);
           }
 
+          // Cached sub-step commands may refer to the model's links and
+          // joints, they're dropped for this iteration
+          this->substepJointForces.clear();
+          this->substepJointVelocities.clear();
+          this->substepWrenches.clear();
+
           this->entityFreeGroupMap.Remove(_entity);
           // Remove the model from the physics engine
           modelPtrPhys->Remove();
           this->entityModelMap.Remove(_entity);
+
+          // The island's world is left empty, since ign-physics can't remove
+          // worlds, but it's no longer stepped
+          this->islandWorlds.erase(_entity);
+          for (auto &copy : this->staticModelCopies[_entity])
+            copy->Remove();
+          this->staticModelCopies.erase(_entity);
+          this->staticModelSdfs.erase(_entity);
           this->topLevelModelMap.erase(_entity);
           this->staticEntities.erase(_entity);
-          this->modelWorldPoses.erase(_entity);
+          this->modelWorldPoses.Erase(_entity);
+          this->entityOffMap.erase(_entity);
         }
         return true;
       });
@@ -1750,10 +2270,91 @@ void PhysicsPrivate::RemovePhysicsEntities(const EntityComponentManager &_ecm)
       });
 }
 
+//////////////////////////////////////////////////
+void PhysicsPrivate::RestoreState(const EntityComponentManager &_ecm)
+{
+  IGN_GAZEBO_PROFILE("PhysicsPrivate::RestoreState");
+
+  // Joints first, since free groups are placed by their root links
+  _ecm.Each<components::Joint, components::JointPosition>(
+      [&](const Entity &_entity, const components::Joint *,
+          const components::JointPosition *_position)
+      {
+        auto jointPhys = this->entityJointMap.Get(_entity);
+        if (nullptr == jointPhys)
+          return true;
+
+        const std::size_t nDofs = std::min(_position->Data().size(),
+            jointPhys->GetDegreesOfFreedom());
+        for (std::size_t i = 0; i < nDofs; ++i)
+          jointPhys->SetPosition(i, _position->Data()[i]);
+
+        auto velocity = _ecm.Component<components::JointVelocity>(_entity);
+        for (std::size_t i = 0; i < jointPhys->GetDegreesOfFreedom(); ++i)
+        {
+          jointPhys->SetVelocity(i, nullptr != velocity &&
+              i < velocity->Data().size() ? velocity->Data()[i] : 0.0);
+        }
+        return true;
+      });
+
+  _ecm.Each<components::Model, components::Pose>(
+      [&](const Entity &_entity, const components::Model *,
+          const components::Pose *_pose)
+      {
+        // Nested models move with their parents
+        auto topLevelIt = this->topLevelModelMap.find(_entity);
+        if (topLevelIt == this->topLevelModelMap.end() ||
+            topLevelIt->second != _entity)
+        {
+          return true;
+        }
+
+        auto modelPtrPhys = this->entityModelMap.Get(_entity);
+        if (nullptr == modelPtrPhys)
+          return true;
+
+        auto freeGroup = modelPtrPhys->FindFreeGroup();
+        if (!freeGroup)
+          return true;
+
+        const auto linkEntity = this->entityLinkMap.Get(freeGroup->RootLink());
+        if (linkEntity == kNullEntity)
+          return true;
+
+        freeGroup->SetWorldPose(math::eigen3::convert(_pose->Data() *
+            this->RelativePose(_entity, linkEntity, _ecm)));
+
+        if (this->staticEntities.find(_entity) != this->staticEntities.end())
+          return true;
+
+        this->entityFreeGroupMap.AddEntity(_entity, freeGroup);
+        auto velocityFeature = this->entityFreeGroupMap
+            .EntityCast<WorldVelocityCommandFeatureList>(_entity);
+        if (!velocityFeature)
+          return true;
+
+        auto linearVel =
+            _ecm.Component<components::WorldLinearVelocity>(linkEntity);
+        auto angularVel =
+            _ecm.Component<components::WorldAngularVelocity>(linkEntity);
+        velocityFeature->SetWorldLinearVelocity(math::eigen3::convert(
+            nullptr != linearVel ? linearVel->Data() : math::Vector3d::Zero));
+        velocityFeature->SetWorldAngularVelocity(math::eigen3::convert(
+            nullptr != angularVel ? angularVel->Data() :
+            math::Vector3d::Zero));
+        return true;
+      });
+}
+
 //////////////////////////////////////////////////
 void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
 {
-  IGN_PROFILE("PhysicsPrivate::UpdatePhysics");
+  IGN_GAZEBO_PROFILE("PhysicsPrivate::UpdatePhysics");
+  this->substepJointForces.clear();
+  this->substepJointVelocities.clear();
+  this->substepWrenches.clear();
+
   // Battery state
   _ecm.Each<components::BatterySoC>(
       [&](const Entity & _entity, const components::BatterySoC *_bat)
@@ -1980,6 +2581,8 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
           {
             jointPhys->SetForce(i, force->Data()[i]);
           }
+          if (this->substeps > 1u)
+            this->substepJointForces.emplace_back(jointPhys, force->Data());
         }
         // Only set joint velocity if joint force is not set.
         // If both the cmd and reset components are found, cmd is ignored.
@@ -2021,6 +2624,12 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
           {
             jointVelFeature->SetVelocityCommand(i, velocityCmd[i]);
           }
+          if (this->substeps > 1u)
+          {
+            velocityCmd.resize(nDofs);
+            this->substepJointVelocities.emplace_back(jointVelFeature,
+                std::move(velocityCmd));
+          }
         }
 
         return true;
@@ -2060,6 +2669,8 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
         math::Vector3 torque = msgs::Convert(_wrenchComp->Data().torque());
         linkForceFeature->AddExternalForce(math::eigen3::convert(force));
         linkForceFeature->AddExternalTorque(math::eigen3::convert(torque));
+        if (this->substeps > 1u)
+          this->substepWrenches.emplace_back(linkForceFeature, force, torque);
 
         return true;
       });
@@ -2131,11 +2742,19 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
     _ecm.RemoveComponent<components::WorldPoseCmd>(entity);
   }
 
-  // Slip compliance on Collisions
+  // Slip compliance on Collisions. The shapes keep their compliance, so only
+  // commands which changed since they were last applied are processed.
   _ecm.Each<components::SlipComplianceCmd>(
       [&](const Entity &_entity,
           const components::SlipComplianceCmd *_slipCmdComp)
       {
+        if (_ecm.ComponentVersion(_entity,
+            components::SlipComplianceCmd::typeId) <=
+            this->slipComplianceVersion)
+        {
+          return true;
+        }
+
         if (!this->entityCollisionMap.HasEntity(_entity))
         {
           ignwarn << "Failed to find shape [" << _entity << "]." << std::endl;
@@ -2166,6 +2785,7 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
 
         return true;
       });
+  this->slipComplianceVersion = _ecm.CurrentVersion();
 
   // Update model angular velocity
   _ecm.Each<components::Model, components::AngularVelocityCmd>(
@@ -2418,9 +3038,141 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
 
 //////////////////////////////////////////////////
 ignition::physics::ForwardStep::Output PhysicsPrivate::Step(
-    const std::chrono::steady_clock::duration &_dt)
+    const std::chrono::steady_clock::duration &_dt,
+    const EntityComponentManager &_ecm)
+{
+  IGN_GAZEBO_PROFILE("PhysicsPrivate::Step");
+  if (this->substeps <= 1u)
+    return this->SubStep(_dt, _ecm);
+
+  // The last sub-step takes whatever is left after rounding, so the total
+  // matches _dt exactly
+  const auto subDt = _dt / this->substeps;
+  physics::ForwardStep::Output merged;
+  auto &entries = merged.Get<physics::ChangedWorldPoses>().entries;
+  bool allChanged{true};
+  for (unsigned int i = 0u; i < this->substeps; ++i)
+  {
+    const auto dt = (i + 1u < this->substeps) ?
+        subDt : _dt - subDt * (this->substeps - 1u);
+    if (i > 0u)
+      this->ApplySubStepCommands();
+    auto output = this->SubStep(dt, _ecm);
+
+    // Links which moved in any of the sub-steps are reported, their frame
+    // data is read after the last one
+    auto changed = output.Query<physics::ChangedWorldPoses>();
+    allChanged = allChanged && nullptr != changed;
+    if (allChanged)
+    {
+      entries.insert(entries.end(), changed->entries.begin(),
+          changed->entries.end());
+    }
+  }
+
+  if (!allChanged)
+    return physics::ForwardStep::Output();
+
+  return merged;
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::ApplySubStepCommands()
 {
-  IGN_PROFILE("PhysicsPrivate::Step");
+  IGN_GAZEBO_PROFILE("PhysicsPrivate::ApplySubStepCommands");
+  for (const auto &[joint, forces] : this->substepJointForces)
+  {
+    const auto nDofs = std::min(forces.size(), joint->GetDegreesOfFreedom());
+    for (std::size_t i = 0; i < nDofs; ++i)
+      joint->SetForce(i, forces[i]);
+  }
+
+  for (const auto &[joint, velocities] : this->substepJointVelocities)
+  {
+    // Already trimmed to the joint's degrees of freedom
+    for (std::size_t i = 0; i < velocities.size(); ++i)
+      joint->SetVelocityCommand(i, velocities[i]);
+  }
+
+  for (const auto &[link, force, torque] : this->substepWrenches)
+  {
+    link->AddExternalForce(math::eigen3::convert(force));
+    link->AddExternalTorque(math::eigen3::convert(torque));
+  }
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::StartStep(const std::chrono::steady_clock::duration &_dt,
+    const EntityComponentManager &_ecm)
+{
+  if (!this->stepThread.joinable())
+  {
+    this->stepThread = std::thread([this]
+    {
+      std::unique_lock<std::mutex> lock(this->stepMutex);
+      while (true)
+      {
+        this->stepCv.wait(lock, [this]
+        {
+          return this->stopStep || (this->stepPending && this->stepEcm);
+        });
+        if (this->stopStep)
+          return;
+
+        // Step without holding the lock, the main thread only waits on
+        // stepPending in the meantime
+        const auto dt = this->stepDt;
+        const auto *ecm = this->stepEcm;
+        this->stepEcm = nullptr;
+        lock.unlock();
+        auto output = this->Step(dt, *ecm);
+        lock.lock();
+
+        this->stepOutput = std::move(output);
+        this->stepPending = false;
+        this->stepCv.notify_all();
+      }
+    });
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->stepMutex);
+    this->stepDt = _dt;
+    this->stepEcm = &_ecm;
+    this->stepPending = true;
+  }
+  this->stepCv.notify_all();
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::WaitForStep()
+{
+  IGN_GAZEBO_PROFILE("PhysicsPrivate::WaitForStep");
+  std::unique_lock<std::mutex> lock(this->stepMutex);
+  this->stepCv.wait(lock, [this] { return !this->stepPending; });
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::StopStepThread()
+{
+  if (!this->stepThread.joinable())
+    return;
+
+  this->WaitForStep();
+  {
+    std::lock_guard<std::mutex> lock(this->stepMutex);
+    this->stopStep = true;
+  }
+  this->stepCv.notify_all();
+  this->stepThread.join();
+}
+
+//////////////////////////////////////////////////
+ignition::physics::ForwardStep::Output PhysicsPrivate::SubStep(
+    const std::chrono::steady_clock::duration &_dt,
+    const EntityComponentManager &_ecm)
+{
+  IGN_GAZEBO_PROFILE("PhysicsPrivate::SubStep");
   physics::ForwardStep::Input input;
   physics::ForwardStep::State state;
   physics::ForwardStep::Output output;
@@ -2432,7 +3184,86 @@ ignition::physics::ForwardStep::Output PhysicsPrivate::Step(
     world.second->Step(output, state, input);
   }
 
-  return output;
+  if (this->islandWorlds.empty())
+    return output;
+
+  // Islands don't share any state, so each one is stepped on its own thread
+  // with its own output, which are merged afterwards.
+  std::vector<WorldPtrType> islandList;
+  islandList.reserve(this->islandWorlds.size());
+  for (const auto &island : this->islandWorlds)
+    islandList.push_back(island.second);
+
+  std::vector<physics::ForwardStep::Output> islandOutputs(islandList.size());
+  _ecm.ParallelFor(islandList.size(),
+      [&](std::size_t _begin, std::size_t _end)
+      {
+        physics::ForwardStep::State islandState;
+        for (std::size_t i = _begin; i < _end; ++i)
+          islandList[i]->Step(islandOutputs[i], islandState, input);
+      }, 1u);
+
+  // Only report changed poses if every world did, otherwise the links will
+  // be checked through the ECM
+  bool allChanged = output.Has<physics::ChangedWorldPoses>();
+  for (const auto &islandOutput : islandOutputs)
+    allChanged = allChanged && islandOutput.Has<physics::ChangedWorldPoses>();
+
+  physics::ForwardStep::Output merged;
+  if (allChanged)
+  {
+    auto &entries = merged.Get<physics::ChangedWorldPoses>().entries;
+    entries = output.Query<physics::ChangedWorldPoses>()->entries;
+    for (const auto &islandOutput : islandOutputs)
+    {
+      const auto &islandEntries =
+          islandOutput.Query<physics::ChangedWorldPoses>()->entries;
+      entries.insert(entries.end(), islandEntries.begin(),
+          islandEntries.end());
+    }
+  }
+
+  return merged;
+}
+
+//////////////////////////////////////////////////
+PhysicsPrivate::WorldPtrType PhysicsPrivate::CreateIsland(
+    const Entity _world, const Entity _model,
+    const EntityComponentManager &_ecm)
+{
+  sdf::World world;
+  auto nameComp = _ecm.Component<components::Name>(_world);
+  world.SetName((nameComp ? nameComp->Data() : "world") + "_island_" +
+      std::to_string(_model));
+  auto gravityComp = _ecm.Component<components::Gravity>(_world);
+  if (gravityComp)
+    world.SetGravity(gravityComp->Data());
+
+  auto island = this->engine->ConstructWorld(world);
+  this->islandWorlds[_model] = island;
+
+  for (const auto &staticModel : this->staticModelSdfs)
+    this->AddStaticCopy(staticModel.first, island);
+
+  return island;
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::AddStaticCopy(const Entity _model,
+    const WorldPtrType &_island)
+{
+  auto modelSdf = this->staticModelSdfs.find(_model);
+  if (modelSdf == this->staticModelSdfs.end())
+    return;
+
+  auto copy = _island->ConstructModel(modelSdf->second);
+  if (nullptr == copy)
+  {
+    ignwarn << "Failed to copy static model [" << modelSdf->second.Name()
+            << "] into an island." << std::endl;
+    return;
+  }
+  this->staticModelCopies[_model].push_back(copy);
 }
 
 //////////////////////////////////////////////////
@@ -2472,13 +3303,14 @@ math::Pose3d PhysicsPrivate::RelativePose(const Entity &_from,
 }
 
 //////////////////////////////////////////////////
-std::map<Entity, physics::FrameData3d> PhysicsPrivate::ChangedLinks(
+void PhysicsPrivate::ChangedLinks(
     EntityComponentManager &_ecm,
-    const ignition::physics::ForwardStep::Output &_updatedLinks)
+    const ignition::physics::ForwardStep::Output &_updatedLinks,
+    FlatEntityMap<physics::FrameData3d> &_linkFrameData)
 {
-  IGN_PROFILE("Links Frame Data");
+  IGN_GAZEBO_PROFILE("Links Frame Data");
 
-  std::map<Entity, physics::FrameData3d> linkFrameData;
+  _linkFrameData.Clear();
 
   // Check to see if the physics engine gave a list of changed poses. If not, we
   // will iterate through all of the links via the ECM to see which ones changed
@@ -2503,13 +3335,13 @@ std::map<Entity, physics::FrameData3d> PhysicsPrivate::ChangedLinks(
         continue;
       }
 
-      auto frameData = linkPhys->FrameDataRelativeToWorld();
-      linkFrameData[entity] = frameData;
+      _linkFrameData.Append(entity, linkPhys->FrameDataRelativeToWorld());
     }
   }
   else
   {
-    _ecm.Each<components::Link>(
+    // Links of static models never move, so they aren't visited at all
+    _ecm.EachDynamic<components::Link>(
       [&](const Entity &_entity, components::Link *) -> bool
       {
         if (this->staticEntities.find(_entity) != this->staticEntities.end() ||
@@ -2539,27 +3371,164 @@ std::map<Entity, physics::FrameData3d> PhysicsPrivate::ChangedLinks(
         // (if the link pose hasn't changed, there's no need for a pose update)
         const auto worldPoseMath3d = ignition::math::eigen3::convert(
             frameData.pose);
-        if ((this->linkWorldPoses.find(_entity) == this->linkWorldPoses.end())
-            || !this->pose3Eql(this->linkWorldPoses[_entity], worldPoseMath3d))
+        auto cachedPose = this->linkWorldPoses.Find(_entity);
+        if (nullptr == cachedPose ||
+            !this->pose3Eql(*cachedPose, worldPoseMath3d))
         {
           // cache the updated link pose to check if the link pose has changed
           // during the next iteration
-          this->linkWorldPoses[_entity] = worldPoseMath3d;
+          if (nullptr == cachedPose)
+            this->linkWorldPoses[_entity] = worldPoseMath3d;
+          else
+            *cachedPose = worldPoseMath3d;
 
-          linkFrameData[_entity] = frameData;
+          _linkFrameData.Append(_entity, frameData);
         }
 
         return true;
       });
   }
 
-  return linkFrameData;
+  // Physics engines report changed links in no particular order
+  _linkFrameData.Sort();
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::PublishKinematics(const UpdateInfo &_info,
+    const EntityComponentManager &_ecm,
+    const FlatEntityMap<physics::FrameData3d> &_linkFrameData)
+{
+  auto *event = this->kinematicsEvent;
+  if (nullptr == event || event->ConnectionCount() == 0u)
+  {
+    // Nobody's listening, stop tracking
+    if (this->kinematicsSeeded)
+    {
+      this->kinematics.clear();
+      this->movedKinematics.clear();
+      this->kinematicsSeeded = false;
+    }
+    return;
+  }
+
+  IGN_GAZEBO_PROFILE("Physics::PublishKinematics");
+
+  auto linkKinematics = [](const physics::FrameData3d &_data)
+  {
+    EntityKinematics kinematics;
+    kinematics.worldPose = math::eigen3::convert(_data.pose);
+    kinematics.linearVelocity = math::eigen3::convert(_data.linearVelocity);
+    kinematics.angularVelocity =
+        math::eigen3::convert(_data.angularVelocity);
+    return kinematics;
+  };
+
+  // The model frame is attached to its canonical link
+  auto modelKinematics = [](const math::Pose3d &_modelPose,
+      const EntityKinematics &_link)
+  {
+    EntityKinematics kinematics;
+    kinematics.worldPose = _modelPose;
+    kinematics.angularVelocity = _link.angularVelocity;
+    kinematics.linearVelocity = _link.linearVelocity +
+        _link.angularVelocity.Cross(
+        _modelPose.Pos() - _link.worldPose.Pos());
+    return kinematics;
+  };
+
+  // Read links and models which aren't tracked yet from physics and the
+  // components: all of them when the first subscriber connected, and new
+  // ones afterwards
+  auto addLink = [&](const Entity &_entity, const components::Link *)
+  {
+    if (this->staticEntities.find(_entity) != this->staticEntities.end())
+      return true;
+    if (auto linkPhys = this->entityLinkMap.Get(_entity))
+    {
+      this->kinematics[_entity] =
+          linkKinematics(linkPhys->FrameDataRelativeToWorld());
+    }
+    return true;
+  };
+  auto addModel = [&](const Entity &_entity, const components::Model *)
+  {
+    if (this->staticEntities.find(_entity) != this->staticEntities.end())
+      return true;
+    EntityKinematics link;
+    auto canonical = _ecm.Component<components::ModelCanonicalLink>(_entity);
+    if (nullptr != canonical)
+    {
+      auto it = this->kinematics.find(canonical->Data());
+      if (it != this->kinematics.end())
+        link = it->second;
+    }
+    this->kinematics[_entity] =
+        modelKinematics(worldPose(_entity, _ecm), link);
+    return true;
+  };
+  auto remove = [&](const Entity &_entity, const auto *)
+  {
+    this->kinematics.erase(_entity);
+    return true;
+  };
+
+  if (!this->kinematicsSeeded)
+  {
+    _ecm.Each<components::Link>(addLink);
+    _ecm.Each<components::Model>(addModel);
+    this->kinematicsSeeded = true;
+  }
+  else
+  {
+    _ecm.EachNew<components::Link>(addLink);
+    _ecm.EachNew<components::Model>(addModel);
+  }
+  _ecm.EachRemoved<components::Link>(remove);
+  _ecm.EachRemoved<components::Model>(remove);
+
+  // Entities which stopped moving are at rest
+  for (const auto entity : this->movedKinematics)
+  {
+    auto it = this->kinematics.find(entity);
+    if (it == this->kinematics.end())
+      continue;
+    it->second.linearVelocity = math::Vector3d::Zero;
+    it->second.angularVelocity = math::Vector3d::Zero;
+  }
+  this->movedKinematics.clear();
+
+  for (const auto &[link, frameData] : _linkFrameData)
+  {
+    auto &linkKin = this->kinematics[link];
+    linkKin = linkKinematics(frameData);
+    this->movedKinematics.push_back(link);
+
+    for (const auto model :
+        this->canonicalLinkModelTracker.CanonicalLinkModels(link))
+    {
+      auto modelPose = this->modelWorldPoses.Find(model);
+      if (nullptr == modelPose)
+        continue;
+      this->kinematics[model] = modelKinematics(*modelPose, linkKin);
+      this->movedKinematics.push_back(model);
+    }
+  }
+
+  // Nothing changes while paused
+  if (_info.paused)
+    return;
+
+  auto snapshot = std::make_shared<KinematicsSnapshot>();
+  snapshot->info = _info;
+  snapshot->entities = this->kinematics;
+  this->eventManager->EmitAsync(event,
+      std::shared_ptr<const KinematicsSnapshot>(std::move(snapshot)));
 }
 
 //////////////////////////////////////////////////
 void PhysicsPrivate::UpdateModelPose(const Entity _model,
     const Entity _canonicalLink, EntityComponentManager &_ecm,
-    std::map<Entity, physics::FrameData3d> &_linkFrameData)
+    FlatEntityMap<physics::FrameData3d> &_linkFrameData)
 {
   std::optional<math::Pose3d> parentWorldPose;
 
@@ -2568,12 +3537,11 @@ void PhysicsPrivate::UpdateModelPose(const Entity _model,
   // topological order. We expect to find the updated pose in
   // this->modelWorldPoses. If not found, this must not be nested, so this
   // model's pose component would reflect it's absolute pose.
-  auto parentModelPoseIt =
-    this->modelWorldPoses.find(
-        _ecm.Component<components::ParentEntity>(_model)->Data());
-  if (parentModelPoseIt != this->modelWorldPoses.end())
+  auto parentModelPose = this->modelWorldPoses.Find(
+      _ecm.Component<components::ParentEntity>(_model)->Data());
+  if (nullptr != parentModelPose)
   {
-    parentWorldPose = parentModelPoseIt->second;
+    parentWorldPose = *parentModelPose;
   }
 
   // Given the following frame names:
@@ -2628,7 +3596,7 @@ void PhysicsPrivate::UpdateModelPose(const Entity _model,
   for (const auto &childLink : model.Links(_ecm))
   {
     // skip links that are already marked as a link to be updated
-    if (_linkFrameData.find(childLink) != _linkFrameData.end())
+    if (nullptr != _linkFrameData.Find(childLink))
       continue;
 
     physics::FrameData3d childLinkFrameData;
@@ -2657,7 +3625,7 @@ void PhysicsPrivate::UpdateModelPose(const Entity _model,
 
     // skip links that are already marked as a link to be updated
     if (nestedCanonicalLink == _canonicalLink ||
-        _linkFrameData.find(nestedCanonicalLink) != _linkFrameData.end())
+        nullptr != _linkFrameData.Find(nestedCanonicalLink))
       continue;
 
     // mark this canonical link as one that needs to be updated so that all of
@@ -2693,9 +3661,9 @@ bool PhysicsPrivate::GetFrameDataRelativeToWorld(const Entity _entity,
 
 //////////////////////////////////////////////////
 void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
-    std::map<Entity, physics::FrameData3d> &_linkFrameData)
+    FlatEntityMap<physics::FrameData3d> &_linkFrameData)
 {
-  IGN_PROFILE("PhysicsPrivate::UpdateSim");
+  IGN_GAZEBO_PROFILE("PhysicsPrivate::UpdateSim");
 
   // Populate world components with default values
   _ecm.EachNew<components::World>(
@@ -2738,8 +3706,11 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
   // make sure we have an up-to-date mapping of canonical links to their models
   this->canonicalLinkModelTracker.AddNewModels(_ecm);
 
-  for (const auto &[linkEntity, frameData] : _linkFrameData)
+  // Iterate by index because UpdateModelPose may add links
+  for (std::size_t i = 0u; i < _linkFrameData.Size(); ++i)
   {
+    const Entity linkEntity = _linkFrameData.At(i).first;
+
     // get a topological ordering of the models that have linkEntity as the
     // model's canonical link. If linkEntity isn't a canonical link for any
     // models, canonicalLinkModels will be empty
@@ -2748,8 +3719,8 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
 
     // Update poses for all of the models that have this changed canonical link
     // (linkEntity). Since we have the models in topological order and
-    // _linkFrameData stores links in topological order thanks to the ordering
-    // of std::map (entity IDs are created in ascending order), this should
+    // _linkFrameData stores links in topological order since it's sorted by
+    // entity (entity IDs are created in ascending order), this should
     // properly handle pose updates for nested models that share the same
     // canonical link.
     //
@@ -2759,175 +3730,44 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
     // method also handles this case.
     for (auto &modelEnt : canonicalLinkModels)
       this->UpdateModelPose(modelEnt, linkEntity, _ecm, _linkFrameData);
+
+    // Links added before this one shifted it, find it again. Like with
+    // std::map, links added after it will be visited.
+    i = _linkFrameData.LowerBound(linkEntity);
   }
   IGN_PROFILE_END();
 
-  // Link poses, velocities...
+  // Link poses, velocities... Components are written in parallel when
+  // enabled, but marking them as changed isn't thread-safe, so that's done
+  // once all links are done.
   IGN_PROFILE_BEGIN("Links");
-  for (const auto &[entity, frameData] : _linkFrameData)
+  this->linkChanges.clear();
+  if (this->parallelWriteBack)
   {
-    IGN_PROFILE_BEGIN("Local pose");
-    auto canonicalLink =
-        _ecm.Component<components::CanonicalLink>(entity);
-
-    const auto &worldPose = frameData.pose;
-    const auto parentEntity = _ecm.ParentEntity(entity);
-
-    if (!canonicalLink)
-    {
-      // Compute the relative pose of this link from the parent model
-      auto parentModelPoseIt = this->modelWorldPoses.find(parentEntity);
-      if (parentModelPoseIt == this->modelWorldPoses.end())
-      {
-        ignerr << "Internal error: parent model [" << parentEntity
-              << "] does not have a world pose available for child entity["
-              << entity << "]" << std::endl;
-        continue;
-      }
-      const math::Pose3d &parentWorldPose = parentModelPoseIt->second;
-
-      // Unlike canonical links, pose of regular links can move relative.
-      // to the parent. Same for links inside nested models.
-      auto pose = _ecm.Component<components::Pose>(entity);
-      *pose = components::Pose(parentWorldPose.Inverse() *
-                                math::eigen3::convert(worldPose));
-      _ecm.SetChanged(entity, components::Pose::typeId,
-          ComponentState::PeriodicChange);
-    }
-    IGN_PROFILE_END();
-
-    // Populate world poses, velocities and accelerations of the link. For
-    // now these components are updated only if another system has created
-    // the corresponding component on the entity.
-    auto worldPoseComp = _ecm.Component<components::WorldPose>(entity);
-    if (worldPoseComp)
-    {
-      auto state =
-          worldPoseComp->SetData(math::eigen3::convert(frameData.pose),
-          this->pose3Eql) ?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity, components::WorldPose::typeId, state);
-    }
-
-    // Velocity in world coordinates
-    auto worldLinVelComp =
-        _ecm.Component<components::WorldLinearVelocity>(entity);
-    if (worldLinVelComp)
-    {
-      auto state = worldLinVelComp->SetData(
-            math::eigen3::convert(frameData.linearVelocity),
-            this->vec3Eql) ?
-            ComponentState::PeriodicChange :
-            ComponentState::NoChange;
-      _ecm.SetChanged(entity,
-          components::WorldLinearVelocity::typeId, state);
-    }
-
-    // Angular velocity in world frame coordinates
-    auto worldAngVelComp =
-        _ecm.Component<components::WorldAngularVelocity>(entity);
-    if (worldAngVelComp)
-    {
-      auto state = worldAngVelComp->SetData(
-          math::eigen3::convert(frameData.angularVelocity),
-          this->vec3Eql) ?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity,
-          components::WorldAngularVelocity::typeId, state);
-    }
-
-    // Acceleration in world frame coordinates
-    auto worldLinAccelComp =
-        _ecm.Component<components::WorldLinearAcceleration>(entity);
-    if (worldLinAccelComp)
-    {
-      auto state = worldLinAccelComp->SetData(
-          math::eigen3::convert(frameData.linearAcceleration),
-          this->vec3Eql) ?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity,
-          components::WorldLinearAcceleration::typeId, state);
-    }
-
-    // Angular acceleration in world frame coordinates
-    auto worldAngAccelComp =
-        _ecm.Component<components::WorldAngularAcceleration>(entity);
-
-    if (worldAngAccelComp)
-    {
-      auto state = worldAngAccelComp->SetData(
-          math::eigen3::convert(frameData.angularAcceleration),
-          this->vec3Eql) ?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity,
-          components::WorldAngularAcceleration::typeId, state);
-    }
-
-    const Eigen::Matrix3d R_bs = worldPose.linear().transpose(); // NOLINT
-
-    // Velocity in body-fixed frame coordinates
-    auto bodyLinVelComp =
-        _ecm.Component<components::LinearVelocity>(entity);
-    if (bodyLinVelComp)
-    {
-      Eigen::Vector3d bodyLinVel = R_bs * frameData.linearVelocity;
-      auto state =
-          bodyLinVelComp->SetData(math::eigen3::convert(bodyLinVel),
-          this->vec3Eql) ?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity, components::LinearVelocity::typeId, state);
-    }
-
-    // Angular velocity in body-fixed frame coordinates
-    auto bodyAngVelComp =
-        _ecm.Component<components::AngularVelocity>(entity);
-    if (bodyAngVelComp)
-    {
-      Eigen::Vector3d bodyAngVel = R_bs * frameData.angularVelocity;
-      auto state =
-          bodyAngVelComp->SetData(math::eigen3::convert(bodyAngVel),
-          this->vec3Eql) ?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity, components::AngularVelocity::typeId,
-          state);
-    }
-
-    // Acceleration in body-fixed frame coordinates
-    auto bodyLinAccelComp =
-        _ecm.Component<components::LinearAcceleration>(entity);
-    if (bodyLinAccelComp)
-    {
-      Eigen::Vector3d bodyLinAccel = R_bs * frameData.linearAcceleration;
-      auto state =
-          bodyLinAccelComp->SetData(math::eigen3::convert(bodyLinAccel),
-          this->vec3Eql)?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity, components::LinearAcceleration::typeId,
-          state);
-    }
+    std::mutex changesMutex;
+    _ecm.ParallelFor(_linkFrameData.Size(),
+        [&](std::size_t _begin, std::size_t _end)
+        {
+          std::vector<ComponentChange> changes;
+          for (std::size_t i = _begin; i < _end; ++i)
+          {
+            const auto &[entity, frameData] = _linkFrameData.At(i);
+            this->UpdateLinkComponents(_ecm, entity, frameData, changes);
+          }
 
-    // Angular acceleration in world frame coordinates
-    auto bodyAngAccelComp =
-        _ecm.Component<components::AngularAcceleration>(entity);
-    if (bodyAngAccelComp)
-    {
-      Eigen::Vector3d bodyAngAccel = R_bs * frameData.angularAcceleration;
-      auto state =
-          bodyAngAccelComp->SetData(math::eigen3::convert(bodyAngAccel),
-          this->vec3Eql) ?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity, components::AngularAcceleration::typeId,
-          state);
-    }
+          std::lock_guard<std::mutex> lock(changesMutex);
+          this->linkChanges.insert(this->linkChanges.end(), changes.begin(),
+              changes.end());
+        });
   }
+  else
+  {
+    for (const auto &[entity, frameData] : _linkFrameData)
+      this->UpdateLinkComponents(_ecm, entity, frameData, this->linkChanges);
+  }
+
+  for (const auto &change : this->linkChanges)
+    _ecm.SetChanged(change.entity, change.typeId, change.state);
   IGN_PROFILE_END();
 
   // pose/velocity/acceleration of non-link entities such as sensors /
@@ -2940,18 +3780,34 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
   // * LinearAcceleration
 
   IGN_PROFILE_BEGIN("Sensors / collisions");
+  // An entity usually has more than one of these components, so only query
+  // physics once per entity. The returned reference is valid until the next
+  // call.
+  this->offsetFrameData.Clear();
+  auto frameDataAtOffset = [this](const Entity _entity,
+      const LinkPtrType &_link, const math::Pose3d &_pose)
+      -> const physics::FrameData3d &
+  {
+    if (auto cached = this->offsetFrameData.Find(_entity))
+      return *cached;
+
+    auto &frameData = this->offsetFrameData[_entity];
+    frameData = this->LinkFrameDataAtOffset(_link, _pose);
+    return frameData;
+  };
+
   // world pose
   _ecm.Each<components::Pose, components::WorldPose,
             components::ParentEntity>(
-      [&](const Entity &,
+      [&](const Entity &_entity,
           const components::Pose *_pose, components::WorldPose *_worldPose,
           const components::ParentEntity *_parent)->bool
       {
         // check if parent entity is a link, e.g. entity is sensor / collision
         if (auto linkPhys = this->entityLinkMap.Get(_parent->Data()))
         {
-          const auto entityFrameData =
-              this->LinkFrameDataAtOffset(linkPhys, _pose->Data());
+          const auto &entityFrameData =
+              frameDataAtOffset(_entity, linkPhys, _pose->Data());
 
           *_worldPose = components::WorldPose(
               math::eigen3::convert(entityFrameData.pose));
@@ -2963,7 +3819,7 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
   // world linear velocity
   _ecm.Each<components::Pose, components::WorldLinearVelocity,
             components::ParentEntity>(
-      [&](const Entity &,
+      [&](const Entity &_entity,
           const components::Pose *_pose,
           components::WorldLinearVelocity *_worldLinearVel,
           const components::ParentEntity *_parent)->bool
@@ -2971,8 +3827,8 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
         // check if parent entity is a link, e.g. entity is sensor / collision
         if (auto linkPhys = this->entityLinkMap.Get(_parent->Data()))
         {
-          const auto entityFrameData =
-              this->LinkFrameDataAtOffset(linkPhys, _pose->Data());
+          const auto &entityFrameData =
+              frameDataAtOffset(_entity, linkPhys, _pose->Data());
 
           // set entity world linear velocity
           *_worldLinearVel = components::WorldLinearVelocity(
@@ -2985,7 +3841,7 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
   // body angular velocity
   _ecm.Each<components::Pose, components::AngularVelocity,
             components::ParentEntity>(
-      [&](const Entity &,
+      [&](const Entity &_entity,
           const components::Pose *_pose,
           components::AngularVelocity *_angularVel,
           const components::ParentEntity *_parent)->bool
@@ -2993,8 +3849,8 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
         // check if parent entity is a link, e.g. entity is sensor / collision
         if (auto linkPhys = this->entityLinkMap.Get(_parent->Data()))
         {
-          const auto entityFrameData =
-              this->LinkFrameDataAtOffset(linkPhys, _pose->Data());
+          const auto &entityFrameData =
+              frameDataAtOffset(_entity, linkPhys, _pose->Data());
 
           auto entityWorldPose = math::eigen3::convert(entityFrameData.pose);
           math::Vector3d entityWorldAngularVel =
@@ -3011,15 +3867,15 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
   // body linear acceleration
   _ecm.Each<components::Pose, components::LinearAcceleration,
             components::ParentEntity>(
-      [&](const Entity &,
+      [&](const Entity &_entity,
           const components::Pose *_pose,
           components::LinearAcceleration *_linearAcc,
           const components::ParentEntity *_parent)->bool
       {
         if (auto linkPhys = this->entityLinkMap.Get(_parent->Data()))
         {
-          const auto entityFrameData =
-              this->LinkFrameDataAtOffset(linkPhys, _pose->Data());
+          const auto &entityFrameData =
+              frameDataAtOffset(_entity, linkPhys, _pose->Data());
 
           auto entityWorldPose = math::eigen3::convert(entityFrameData.pose);
           math::Vector3d entityWorldLinearAcc =
@@ -3119,12 +3975,6 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
         return true;
       });
 
-  _ecm.Each<components::SlipComplianceCmd>(
-      [&](const Entity &, components::SlipComplianceCmd *_slip) -> bool
-      {
-        std::fill(_slip->Data().begin(), _slip->Data().end(), 0.0);
-        return true;
-      });
   IGN_PROFILE_END();
 
   _ecm.Each<components::AngularVelocityCmd>(
@@ -3225,10 +4075,14 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
 //////////////////////////////////////////////////
 void PhysicsPrivate::UpdateCollisions(EntityComponentManager &_ecm)
 {
-  IGN_PROFILE("PhysicsPrivate::UpdateCollisions");
+  IGN_GAZEBO_PROFILE("PhysicsPrivate::UpdateCollisions");
   // Quit early if the ContactData component hasn't been created. This means
   // there are no systems that need contact information
-  if (!_ecm.HasComponentType(components::ContactSensorData::typeId))
+  const bool needSensorData =
+      _ecm.HasComponentType(components::ContactSensorData::typeId);
+  const bool needPoints =
+      _ecm.HasComponentType(components::ContactPoints::typeId);
+  if (!needSensorData && !needPoints)
     return;
 
   // TODO(addisu) If systems are assumed to only have one world, we should
@@ -3263,39 +4117,177 @@ void PhysicsPrivate::UpdateCollisions(EntityComponentManager &_ecm)
     return;
   }
 
+  using ExtraContactData =
+      physics::GetContactsFromLastStepFeature::ExtraContactDataT<
+      physics::FeaturePolicy3d>;
+
+  // Contacts are stored together with the side of the contact the entity is
+  // on, since the normal goes from the first collision to the second.
+  struct EntityContact
+  {
+    const WorldShapeType::ContactPoint *point;
+    const ExtraContactData *extra;
+    bool flipped;
+  };
+
   // Each contact object we get from ign-physics contains the EntityPtrs of the
   // two colliding entities and other data about the contact such as the
   // position. This map groups contacts so that it is easy to query all the
   // contacts of one entity.
   using EntityContactMap = std::unordered_map<Entity,
-      std::deque<const WorldShapeType::ContactPoint *>>;
+      std::deque<EntityContact>>;
 
   // This data structure is essentially a mapping between a pair of entities and
   // a list of pointers to their contact object. We use a map inside a map to
   // create msgs::Contact objects conveniently later on.
   std::unordered_map<Entity, EntityContactMap> entityContactMap;
 
+  // Most contacts usually involve collisions nobody reads, like wheels on the
+  // ground, so find the physics ids of the collisions that are read, and the
+  // top-level models they belong to.
+  std::unordered_set<std::size_t> subscribedIds;
+  std::unordered_set<Entity> subscribedModels;
+  auto addSubscriber = [&](const Entity &_entity) -> bool
+  {
+    auto collisionPhys = this->entityCollisionMap.Get(_entity);
+    if (nullptr == collisionPhys)
+      return true;
+
+    subscribedIds.insert(collisionPhys->EntityID());
+    // Unknown models are assumed to be in the main world
+    auto topLevel = this->topLevelModelMap.find(_entity);
+    subscribedModels.insert(topLevel != this->topLevelModelMap.end() ?
+        topLevel->second : kNullEntity);
+    return true;
+  };
+  if (needSensorData)
+  {
+    _ecm.Each<components::Collision, components::ContactSensorData>(
+        [&](const Entity &_entity, const components::Collision *,
+            const components::ContactSensorData *) -> bool
+        {
+          return addSubscriber(_entity);
+        });
+  }
+  if (needPoints)
+  {
+    _ecm.Each<components::Collision, components::ContactPoints>(
+        [&](const Entity &_entity, const components::Collision *,
+            const components::ContactPoints *) -> bool
+        {
+          return addSubscriber(_entity);
+        });
+  }
+
+  // Contacts are only fetched from worlds which have subscribed collisions
+  bool needMainWorld{false};
+  for (const auto &model : subscribedModels)
+  {
+    if (this->islandWorlds.find(model) == this->islandWorlds.end())
+    {
+      needMainWorld = true;
+      break;
+    }
+  }
+
   // Note that we are temporarily storing pointers to elements in this
   // ("allContacts") container. Thus, we must make sure it doesn't get destroyed
   // until the end of this function.
-  auto allContacts =
-      std::move(worldCollisionFeature->GetContactsFromLastStep());
+  decltype(worldCollisionFeature->GetContactsFromLastStep()) allContacts;
+  if (needMainWorld)
+    allContacts = worldCollisionFeature->GetContactsFromLastStep();
+  for (const auto &island : this->islandWorlds)
+  {
+    if (subscribedModels.find(island.first) == subscribedModels.end())
+      continue;
+
+    auto islandCollisionFeature =
+        physics::RequestFeatures<ContactFeatureList>::From(island.second);
+    if (!islandCollisionFeature)
+      continue;
+
+    auto islandContacts = islandCollisionFeature->GetContactsFromLastStep();
+    allContacts.insert(allContacts.end(),
+        std::make_move_iterator(islandContacts.begin()),
+        std::make_move_iterator(islandContacts.end()));
+  }
 
   for (const auto &contactComposite : allContacts)
   {
     const auto &contact = contactComposite.Get<WorldShapeType::ContactPoint>();
-    auto coll1Entity =
-      this->entityCollisionMap.GetByPhysicsId(contact.collision1->EntityID());
-    auto coll2Entity =
-      this->entityCollisionMap.GetByPhysicsId(contact.collision2->EntityID());
+    const auto coll1Id = contact.collision1->EntityID();
+    const auto coll2Id = contact.collision2->EntityID();
+    const bool coll1Subscribed = subscribedIds.count(coll1Id) > 0;
+    const bool coll2Subscribed = subscribedIds.count(coll2Id) > 0;
+    if (!coll1Subscribed && !coll2Subscribed)
+      continue;
+
+    auto coll1Entity = this->entityCollisionMap.GetByPhysicsId(coll1Id);
+    auto coll2Entity = this->entityCollisionMap.GetByPhysicsId(coll2Id);
 
     if (coll1Entity != kNullEntity && coll2Entity != kNullEntity)
     {
-      entityContactMap[coll1Entity][coll2Entity].push_back(&contact);
-      entityContactMap[coll2Entity][coll1Entity].push_back(&contact);
+      const auto *extra = contactComposite.Query<ExtraContactData>();
+      if (coll1Subscribed)
+      {
+        entityContactMap[coll1Entity][coll2Entity].push_back(
+            {&contact, extra, false});
+      }
+      if (coll2Subscribed)
+      {
+        entityContactMap[coll2Entity][coll1Entity].push_back(
+            {&contact, extra, true});
+      }
     }
   }
 
+  // Fill the compact components straight from the engine data, this doesn't
+  // allocate once the vectors have grown to their usual size
+  if (needPoints)
+  {
+    _ecm.Each<components::Collision, components::ContactPoints>(
+        [&](const Entity &_collEntity1, components::Collision *,
+            components::ContactPoints *_points) -> bool
+        {
+          auto &points = _points->Data();
+          const bool hadPoints = !points.empty();
+          points.clear();
+
+          auto contactMap = entityContactMap.find(_collEntity1);
+          if (contactMap != entityContactMap.end())
+          {
+            for (const auto &[collEntity2, contactData] : contactMap->second)
+            {
+              for (const auto &contact : contactData)
+              {
+                contact::ContactPoint point;
+                point.collision1 = _collEntity1;
+                point.collision2 = collEntity2;
+                point.position = math::eigen3::convert(contact.point->point);
+                if (nullptr != contact.extra)
+                {
+                  point.normal = math::eigen3::convert(contact.extra->normal);
+                  if (contact.flipped)
+                    point.normal = -point.normal;
+                  point.depth = contact.extra->depth;
+                }
+                points.push_back(point);
+              }
+            }
+          }
+
+          auto state = (hadPoints || !points.empty()) ?
+              ComponentState::PeriodicChange :
+              ComponentState::NoChange;
+          _ecm.SetChanged(_collEntity1, components::ContactPoints::typeId,
+              state);
+          return true;
+        });
+  }
+
+  if (!needSensorData)
+    return;
+
   // Go through each collision entity that has a ContactData component and
   // set the component value to the list of contacts that correspond to
   // the collision entity
@@ -3333,9 +4325,9 @@ void PhysicsPrivate::UpdateCollisions(EntityComponentManager &_ecm)
           for (const auto &contact : contactData)
           {
             auto *position = contactMsg->add_position();
-            position->set_x(contact->point.x());
-            position->set_y(contact->point.y());
-            position->set_z(contact->point.z());
+            position->set_x(contact.point->point.x());
+            position->set_y(contact.point->point.y());
+            position->set_z(contact.point->point.z());
           }
         }
 
@@ -3350,6 +4342,172 @@ void PhysicsPrivate::UpdateCollisions(EntityComponentManager &_ecm)
       });
 }
 
+//////////////////////////////////////////////////
+void PhysicsPrivate::UpdateLinkComponents(EntityComponentManager &_ecm,
+    const Entity _entity, const physics::FrameData3d &_frameData,
+    std::vector<ComponentChange> &_changes) const
+{
+  auto canonicalLink =
+      _ecm.Component<components::CanonicalLink>(_entity);
+
+  const auto &worldPose = _frameData.pose;
+  const auto parentEntity = _ecm.ParentEntity(_entity);
+
+  if (!canonicalLink)
+  {
+    // Compute the relative pose of this link from the parent model
+    auto parentModelPose = this->modelWorldPoses.Find(parentEntity);
+    if (nullptr == parentModelPose)
+    {
+      ignerr << "Internal error: parent model [" << parentEntity
+            << "] does not have a world pose available for child entity["
+            << _entity << "]" << std::endl;
+      return;
+    }
+    const math::Pose3d &parentWorldPose = *parentModelPose;
+
+    // Unlike canonical links, pose of regular links can move relative.
+    // to the parent. Same for links inside nested models.
+    auto pose = _ecm.Component<components::Pose>(_entity);
+    *pose = components::Pose(parentWorldPose.Inverse() *
+                              math::eigen3::convert(worldPose));
+    _changes.push_back({_entity, components::Pose::typeId,
+        ComponentState::PeriodicChange});
+  }
+
+  // Populate world poses, velocities and accelerations of the link. For
+  // now these components are updated only if another system has created
+  // the corresponding component on the entity.
+  auto worldPoseComp = _ecm.Component<components::WorldPose>(_entity);
+  if (worldPoseComp)
+  {
+    auto state =
+        worldPoseComp->SetData(math::eigen3::convert(_frameData.pose),
+        this->pose3Eql) ?
+        ComponentState::PeriodicChange :
+        ComponentState::NoChange;
+    _changes.push_back({_entity, components::WorldPose::typeId, state});
+  }
+
+  // Velocity in world coordinates
+  auto worldLinVelComp =
+      _ecm.Component<components::WorldLinearVelocity>(_entity);
+  if (worldLinVelComp)
+  {
+    auto state = worldLinVelComp->SetData(
+          math::eigen3::convert(_frameData.linearVelocity),
+          this->vec3Eql) ?
+          ComponentState::PeriodicChange :
+          ComponentState::NoChange;
+    _changes.push_back({_entity, components::WorldLinearVelocity::typeId,
+        state});
+  }
+
+  // Angular velocity in world frame coordinates
+  auto worldAngVelComp =
+      _ecm.Component<components::WorldAngularVelocity>(_entity);
+  if (worldAngVelComp)
+  {
+    auto state = worldAngVelComp->SetData(
+        math::eigen3::convert(_frameData.angularVelocity),
+        this->vec3Eql) ?
+        ComponentState::PeriodicChange :
+        ComponentState::NoChange;
+    _changes.push_back({_entity, components::WorldAngularVelocity::typeId,
+        state});
+  }
+
+  // Acceleration in world frame coordinates
+  auto worldLinAccelComp =
+      _ecm.Component<components::WorldLinearAcceleration>(_entity);
+  if (worldLinAccelComp)
+  {
+    auto state = worldLinAccelComp->SetData(
+        math::eigen3::convert(_frameData.linearAcceleration),
+        this->vec3Eql) ?
+        ComponentState::PeriodicChange :
+        ComponentState::NoChange;
+    _changes.push_back({_entity, components::WorldLinearAcceleration::typeId,
+        state});
+  }
+
+  // Angular acceleration in world frame coordinates
+  auto worldAngAccelComp =
+      _ecm.Component<components::WorldAngularAcceleration>(_entity);
+
+  if (worldAngAccelComp)
+  {
+    auto state = worldAngAccelComp->SetData(
+        math::eigen3::convert(_frameData.angularAcceleration),
+        this->vec3Eql) ?
+        ComponentState::PeriodicChange :
+        ComponentState::NoChange;
+    _changes.push_back({_entity, components::WorldAngularAcceleration::typeId,
+        state});
+  }
+
+  const Eigen::Matrix3d R_bs = worldPose.linear().transpose(); // NOLINT
+
+  // Velocity in body-fixed frame coordinates
+  auto bodyLinVelComp =
+      _ecm.Component<components::LinearVelocity>(_entity);
+  if (bodyLinVelComp)
+  {
+    Eigen::Vector3d bodyLinVel = R_bs * _frameData.linearVelocity;
+    auto state =
+        bodyLinVelComp->SetData(math::eigen3::convert(bodyLinVel),
+        this->vec3Eql) ?
+        ComponentState::PeriodicChange :
+        ComponentState::NoChange;
+    _changes.push_back({_entity, components::LinearVelocity::typeId, state});
+  }
+
+  // Angular velocity in body-fixed frame coordinates
+  auto bodyAngVelComp =
+      _ecm.Component<components::AngularVelocity>(_entity);
+  if (bodyAngVelComp)
+  {
+    Eigen::Vector3d bodyAngVel = R_bs * _frameData.angularVelocity;
+    auto state =
+        bodyAngVelComp->SetData(math::eigen3::convert(bodyAngVel),
+        this->vec3Eql) ?
+        ComponentState::PeriodicChange :
+        ComponentState::NoChange;
+    _changes.push_back({_entity, components::AngularVelocity::typeId,
+        state});
+  }
+
+  // Acceleration in body-fixed frame coordinates
+  auto bodyLinAccelComp =
+      _ecm.Component<components::LinearAcceleration>(_entity);
+  if (bodyLinAccelComp)
+  {
+    Eigen::Vector3d bodyLinAccel = R_bs * _frameData.linearAcceleration;
+    auto state =
+        bodyLinAccelComp->SetData(math::eigen3::convert(bodyLinAccel),
+        this->vec3Eql)?
+        ComponentState::PeriodicChange :
+        ComponentState::NoChange;
+    _changes.push_back({_entity, components::LinearAcceleration::typeId,
+        state});
+  }
+
+  // Angular acceleration in world frame coordinates
+  auto bodyAngAccelComp =
+      _ecm.Component<components::AngularAcceleration>(_entity);
+  if (bodyAngAccelComp)
+  {
+    Eigen::Vector3d bodyAngAccel = R_bs * _frameData.angularAcceleration;
+    auto state =
+        bodyAngAccelComp->SetData(math::eigen3::convert(bodyAngAccel),
+        this->vec3Eql) ?
+        ComponentState::PeriodicChange :
+        ComponentState::NoChange;
+    _changes.push_back({_entity, components::AngularAcceleration::typeId,
+        state});
+  }
+}
+
 //////////////////////////////////////////////////
 physics::FrameData3d PhysicsPrivate::LinkFrameDataAtOffset(
       const LinkPtrType &_link, const math::Pose3d &_pose) const
@@ -3454,6 +4612,7 @@ void PhysicsPrivate::DisableContactSurfaceCustomization(const Entity &_world)
 IGNITION_ADD_PLUGIN(Physics,
                     gazebo::System,
                     Physics::ISystemConfigure,
-                    Physics::ISystemUpdate)
+                    Physics::ISystemUpdate,
+                    Physics::ISystemPostUpdate)
 
 IGNITION_ADD_PLUGIN_ALIAS(Physics, "ignition::gazebo::systems::Physics")
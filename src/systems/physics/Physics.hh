@@ -76,11 +76,80 @@ namespace systems
   ///    </contacts>
   ///  </plugin>
   ///  ```
+  ///
+  /// Physics entities are created when their model is added to the ECM and
+  /// destroyed when it's removed. When levels are enabled, the level
+  /// manager only adds models of the levels around performers, so the
+  /// physics engine only holds the active region of the world.
+  ///
+  /// Also includes optional parameter : <mesh_cache>. Mesh collisions are
+  /// loaded through MeshCache, which stores meshes in a compact binary form
+  /// the first time they're loaded and reads them back from there on later
+  /// runs, which is much faster than parsing large mesh files. The <path>
+  /// child sets the cache directory of the server process, which otherwise
+  /// defaults to `~/.ignition/gazebo/mesh_cache`.
+  /// ```
+  ///  <mesh_cache>
+  ///    <path>/tmp/mesh_cache</path>
+  ///  </mesh_cache>
+  /// ```
+  ///
+  /// Also includes optional parameter : <terrain_tiles>. When present,
+  /// heightmap collisions large enough are split into square tiles of
+  /// <tile_samples> samples per side, a power of two plus one which
+  /// defaults to 257, see TerrainTiles. A tile is only attached to the
+  /// engine once a dynamic top-level model, such as a performer, comes
+  /// within <radius> meters of it, 50 by default, and stays attached after
+  /// that. The radius should be larger than the models, plus how far they
+  /// move in a step. Static models copied into islands keep their whole
+  /// heightmaps.
+  /// ```
+  ///  <terrain_tiles>
+  ///    <tile_samples>129</tile_samples>
+  ///    <radius>100</radius>
+  ///  </terrain_tiles>
+  /// ```
+  ///
+  /// Also includes optional parameter : <parallel_write_back>. When set to
+  /// true, the pose, velocity and acceleration components of links are
+  /// written back to the ECM using multiple threads after each step. This
+  /// helps worlds with many moving links. The physics engine itself is
+  /// still only queried from the simulation thread. False by default.
+  ///
+  /// Also includes optional parameter : <islands>. When set to true, each
+  /// non-static top-level model is simulated in its own physics world and
+  /// the worlds are stepped in parallel. This suits worlds with many models
+  /// which never touch each other, such as fleets of robots. Static
+  /// top-level models, like the ground, are copied into every world from
+  /// their SDF, so they shouldn't be moved after they're loaded. Models in
+  /// different worlds can't collide or be connected by joints, and the
+  /// physics engine must support stepping different worlds from different
+  /// threads. False by default.
+  ///
+  /// Also includes optional parameter : <substeps>. Number of engine steps
+  /// to take on each simulation iteration, each one covering an equal part
+  /// of the iteration's time step. Components are only synchronized with
+  /// the physics engine before the first and after the last sub-step, so
+  /// this allows running a fine physics step, for example for stiff
+  /// contacts, while the rest of simulation runs at a coarser rate.
+  /// Joint forces, joint velocity commands and link wrenches from other
+  /// systems are applied again before every sub-step, since engines clear
+  /// them after each step. Defaults to 1.
+  ///
+  /// Also includes optional parameter : <async_step>. When set to true, the
+  /// physics engine is stepped on its own thread while the systems that
+  /// run after physics, such as sensors and broadcasters, update. The step
+  /// is joined in PostUpdate, so it never overlaps the next PreUpdate, and
+  /// its results are written to components at the start of the next
+  /// iteration, so components such as poses lag one iteration behind
+  /// the physics engine. The components themselves are never touched by
+  /// the step thread. False by default.
 
   class Physics:
     public System,
     public ISystemConfigure,
-    public ISystemUpdate
+    public ISystemUpdate,
+    public ISystemPostUpdate
   {
     /// \brief Constructor
     public: explicit Physics();
@@ -98,6 +167,10 @@ namespace systems
     public: void Update(const UpdateInfo &_info,
                 EntityComponentManager &_ecm) final;
 
+    // Documentation inherited
+    public: void PostUpdate(const UpdateInfo &_info,
+                const EntityComponentManager &_ecm) final;
+
     /// \brief Private data pointer.
     private: std::unique_ptr<PhysicsPrivate> dataPtr;
   };
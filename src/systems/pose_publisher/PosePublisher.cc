@@ -54,6 +54,25 @@ using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+/// \brief Pose messages of a group of entities published together, kept
+/// between publications so only stamps and poses are written each time.
+struct CachedPoses
+{
+  /// \brief Entities of the group, in publication order.
+  std::vector<Entity> entities;
+
+  /// \brief One message per entity, with its frame ids and name set. These
+  /// are published individually, or copied into poseV when entities are
+  /// missing poses.
+  std::vector<msgs::Pose> msgs;
+
+  /// \brief Messages of all entities, when publishing a vector of poses.
+  msgs::Pose_V poseV;
+
+  /// \brief Whether each entity had a pose during the last publication.
+  std::vector<bool> hasPose;
+};
+
 /// \brief Private data class for PosePublisher
 class ignition::gazebo::systems::PosePublisherPrivate
 {
@@ -62,22 +81,21 @@ class ignition::gazebo::systems::PosePublisherPrivate
   /// \param[in] _ecm Immutable reference to the entity component manager
   public: void InitializeEntitiesToPublish(const EntityComponentManager &_ecm);
 
-  /// \brief Helper function to collect entity pose data
+  /// \brief Add the entities to publish to a group, and create their
+  /// messages.
+  /// \param[out] _cache Group to add to
+  /// \param[in] _static True to add only static transforms,
+  /// false to add only dynamic transforms
+  public: void CachePoses(CachedPoses &_cache, bool _static);
+
+  /// \brief Publishes the current poses of a group of entities with the
+  /// provided time stamp.
   /// \param[in] _ecm Immutable reference to the entity component manager
-  /// \param[out] _poses Pose vector to be filled
-  /// \param[in] _static True to fill only static transforms,
-  /// false to fill only dynamic transforms
-  public: void FillPoses(const EntityComponentManager &_ecm,
-      std::vector<std::pair<Entity, math::Pose3d>> &_poses,
-      bool _static);
-
-  /// \brief Publishes poses collected by FillPoses with the provided time
-  /// stamp.
-  /// \param[in] _poses Pose to publish
+  /// \param[in] _cache Group to publish
   /// \param[in] _stampMsg Time stamp associated with published poses
   /// \param[in] _publisher Publisher to publish the message
-  public: void PublishPoses(
-      std::vector<std::pair<Entity, math::Pose3d>> &_poses,
+  public: void PublishPoses(const EntityComponentManager &_ecm,
+      CachedPoses &_cache,
       const msgs::Time &_stampMsg,
       transport::Node::Publisher &_publisher);
 
@@ -143,25 +161,12 @@ class ignition::gazebo::systems::PosePublisherPrivate
   /// by joints
   public: std::unordered_set<Entity> dynamicEntities;
 
-  /// \brief A vector that contains the entities and their poses. This could
-  /// easily be a temporary, but having it as a member variable improves
-  /// performance by avoiding memory allocation
-  public: std::vector<std::pair<Entity, math::Pose3d>> poses;
+  /// \brief Poses published to posePub: the dynamic ones if static poses
+  /// are published separately, all of them otherwise.
+  public: CachedPoses poses;
 
-  /// \brief A vector that contains the entities and poses that are static.
-  /// This could easily be a temporary, but having it as a member variable
-  /// improves performance by avoiding memory allocation
-  public: std::vector<std::pair<Entity, math::Pose3d>> staticPoses;
-
-  /// \brief A variable that gets populated with poses. This also here as a
-  /// member variable to avoid repeated memory allocations and improve
-  /// performance.
-  public: msgs::Pose poseMsg;
-
-  /// \brief A variable that gets populated with poses. This also here as a
-  /// member variable to avoid repeated memory allocations and improve
-  /// performance.
-  public: msgs::Pose_V poseVMsg;
+  /// \brief Poses published to poseStaticPub.
+  public: CachedPoses staticPoses;
 
   /// \brief True to publish a vector of poses. False to publish individual pose
   /// msgs.
@@ -338,18 +343,14 @@ void PosePublisher::PostUpdate(const UpdateInfo &_info,
   {
     if (publishStatic)
     {
-      this->dataPtr->staticPoses.clear();
-      this->dataPtr->FillPoses(_ecm, this->dataPtr->staticPoses, true);
-      this->dataPtr->PublishPoses(this->dataPtr->staticPoses,
+      this->dataPtr->PublishPoses(_ecm, this->dataPtr->staticPoses,
           convert<msgs::Time>(_info.simTime), this->dataPtr->poseStaticPub);
       this->dataPtr->lastStaticPosePubTime = _info.simTime;
     }
 
     if (publish)
     {
-      this->dataPtr->poses.clear();
-      this->dataPtr->FillPoses(_ecm, this->dataPtr->poses, false);
-      this->dataPtr->PublishPoses(this->dataPtr->poses,
+      this->dataPtr->PublishPoses(_ecm, this->dataPtr->poses,
           convert<msgs::Time>(_info.simTime), this->dataPtr->posePub);
       this->dataPtr->lastPosePubTime = _info.simTime;
     }
@@ -357,10 +358,7 @@ void PosePublisher::PostUpdate(const UpdateInfo &_info,
   // publish all transforms to the same topic
   else if (publish)
   {
-    this->dataPtr->poses.clear();
-    this->dataPtr->FillPoses(_ecm, this->dataPtr->poses, true);
-    this->dataPtr->FillPoses(_ecm, this->dataPtr->poses, false);
-    this->dataPtr->PublishPoses(this->dataPtr->poses,
+    this->dataPtr->PublishPoses(_ecm, this->dataPtr->poses,
         convert<msgs::Time>(_info.simTime), this->dataPtr->posePub);
     this->dataPtr->lastPosePubTime = _info.simTime;
   }
@@ -491,95 +489,101 @@ void PosePublisherPrivate::InitializeEntitiesToPublish(
 
   if (this->staticPosePublisher)
   {
-    this->poses.reserve(this->dynamicEntities.size());
-    this->staticPoses.reserve(
-        this->entitiesToPublish.size() - this->dynamicEntities.size());
+    this->CachePoses(this->poses, false);
+    this->CachePoses(this->staticPoses, true);
   }
   else
   {
-    this->poses.reserve(this->entitiesToPublish.size());
+    this->CachePoses(this->poses, true);
+    this->CachePoses(this->poses, false);
   }
 }
 
 //////////////////////////////////////////////////
-void PosePublisherPrivate::FillPoses(const EntityComponentManager &_ecm,
-    std::vector<std::pair<Entity, math::Pose3d>> &_poses, bool _static)
+void PosePublisherPrivate::CachePoses(CachedPoses &_cache, bool _static)
 {
-  IGN_PROFILE("PosePublisher::FillPose");
-
   for (const auto &entity : this->entitiesToPublish)
   {
-    auto pose = _ecm.Component<components::Pose>(entity.first);
-    if (!pose)
-      continue;
-
     bool isStatic = this->dynamicEntities.find(entity.first) ==
           this->dynamicEntities.end();
+    if (_static != isStatic)
+      continue;
 
-    if (_static == isStatic)
-      _poses.emplace_back(entity.first, pose->Data());
+    // fill the parts of the pose msg which don't change
+    // frame_id: parent entity name
+    // child_frame_id = entity name
+    // pose is the transform from frame_id to child_frame_id
+    msgs::Pose msg;
+    const std::string &frameId = entity.second.first;
+    const std::string &childFrameId = entity.second.second;
+    auto header = msg.mutable_header();
+    header->mutable_stamp();
+    auto frame = header->add_data();
+    frame->set_key("frame_id");
+    frame->add_value(frameId);
+    auto childFrame = header->add_data();
+    childFrame->set_key("child_frame_id");
+    childFrame->add_value(childFrameId);
+    msg.set_name(childFrameId);
+
+    if (this->usePoseV)
+      _cache.poseV.add_pose()->CopyFrom(msg);
+    _cache.entities.push_back(entity.first);
+    _cache.msgs.push_back(std::move(msg));
+    _cache.hasPose.push_back(true);
   }
 }
 
 //////////////////////////////////////////////////
-void PosePublisherPrivate::PublishPoses(
-    std::vector<std::pair<Entity, math::Pose3d>> &_poses,
+void PosePublisherPrivate::PublishPoses(const EntityComponentManager &_ecm,
+    CachedPoses &_cache,
     const msgs::Time &_stampMsg,
     transport::Node::Publisher &_publisher)
 {
   IGN_PROFILE("PosePublisher::PublishPoses");
 
   // publish poses
-  msgs::Pose *msg = nullptr;
-  if (this->usePoseV)
-    this->poseVMsg.Clear();
-
-  for (const auto &[entity, pose] : _poses)
+  bool allPoses{true};
+  for (std::size_t i = 0; i < _cache.entities.size(); ++i)
   {
-    auto entityIt = this->entitiesToPublish.find(entity);
-    if (entityIt == this->entitiesToPublish.end())
-      continue;
-
-    if (this->usePoseV)
-    {
-      msg = this->poseVMsg.add_pose();
-    }
-    else
+    auto pose = _ecm.Component<components::Pose>(_cache.entities[i]);
+    _cache.hasPose[i] = nullptr != pose;
+    if (!pose)
     {
-      this->poseMsg.Clear();
-      msg = &this->poseMsg;
+      allPoses = false;
+      continue;
     }
 
-    // fill pose msg
-    // frame_id: parent entity name
-    // child_frame_id = entity name
-    // pose is the transform from frame_id to child_frame_id
-    IGN_ASSERT(msg != nullptr, "Pose msg is null");
-    auto header = msg->mutable_header();
+    msgs::Pose *msg = this->usePoseV ?
+        _cache.poseV.mutable_pose(static_cast<int>(i)) : &_cache.msgs[i];
 
-    header->mutable_stamp()->CopyFrom(_stampMsg);
-    const std::string &frameId = entityIt->second.first;
-    const std::string &childFrameId = entityIt->second.second;
-    const math::Pose3d &transform = pose;
-    auto frame = header->add_data();
-    frame->set_key("frame_id");
-    frame->add_value(frameId);
-    auto childFrame = header->add_data();
-    childFrame->set_key("child_frame_id");
-    childFrame->add_value(childFrameId);
-
-    // set pose
-    msg->set_name(childFrameId);
-    msgs::Set(msg, transform);
+    // only the stamp and the transform change between publications
+    msg->mutable_header()->mutable_stamp()->CopyFrom(_stampMsg);
+    msgs::Set(msg, pose->Data());
 
     // publish individual pose msgs
     if (!this->usePoseV)
-      _publisher.Publish(this->poseMsg);
+      _publisher.Publish(*msg);
   }
 
+  if (!this->usePoseV)
+    return;
+
   // publish pose vector msg
-  if (this->usePoseV)
-    _publisher.Publish(this->poseVMsg);
+  if (allPoses)
+  {
+    _publisher.Publish(_cache.poseV);
+    return;
+  }
+
+  // entities without poses are left out, which is rare enough to copy
+  msgs::Pose_V poseVMsg;
+  for (std::size_t i = 0; i < _cache.entities.size(); ++i)
+  {
+    if (_cache.hasPose[i])
+      poseVMsg.add_pose()->CopyFrom(_cache.poseV.pose(static_cast<int>(i)));
+  }
+  _publisher.Publish(poseVMsg);
 }
 
 IGNITION_ADD_PLUGIN(PosePublisher,
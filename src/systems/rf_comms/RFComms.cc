@@ -17,20 +17,27 @@
 
 #include <ignition/msgs/dataframe.pb.h>
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <list>
+#include <memory>
 #include <random>
 #include <string>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <sdf/sdf.hh>
 #include <ignition/common/Profiler.hh>
+#include <ignition/math/Helpers.hh>
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/Rand.hh>
 #include <ignition/plugin/Register.hh>
 #include "ignition/gazebo/comms/MsgManager.hh"
+#include "ignition/gazebo/comms/OcclusionMap.hh"
+#include "ignition/gazebo/comms/PropagationModel.hh"
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/Link.hh"
 #include "ignition/gazebo/Model.hh"
@@ -41,6 +48,14 @@ using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+/// \brief Probability of receiving a single byte below which a radio is
+/// considered out of range.
+static constexpr double kMinByteProbability{1e-9};
+
+/// \brief Number of standard deviations of fading above the mean received
+/// power which are considered when computing the range.
+static constexpr double kFadingSigmas{6.0};
+
 /// \brief Parameters for simple log-normal fading model.
 struct RangeConfiguration
 {
@@ -170,6 +185,47 @@ class ignition::gazebo::systems::RFComms::Implementation
                                                RadioState &_rxState,
                                                const uint64_t &_numBytes);
 
+  /// \brief Record a packet sent by a transmitter, unless it exceeds the
+  /// capacity of the radio.
+  /// \param[in out] _txState Current state of the transmitter.
+  /// \param[in] _numBytes Size of the packet.
+  /// \return True if the packet can be sent.
+  public: bool RecordSent(RadioState &_txState, uint64_t _numBytes) const;
+
+  /// \brief Attempt to receive a packet which was sent.
+  /// \param[in] _now Time at which the packet was sent.
+  /// \param[in] _power Received power distribution.
+  /// \param[in out] _rxState Current state of the receiver.
+  /// \param[in] _numBytes Size of the packet.
+  /// \return std::tuple<bool, double> reporting if the packet should be
+  /// delivered and the received signal strength (in dBm).
+  public: std::tuple<bool, double> Receive(double _now,
+                                           const RFPower &_power,
+                                           RadioState &_rxState,
+                                           uint64_t _numBytes);
+
+  /// \brief Compute the distance beyond which packets can't be received.
+  /// \return Range in meters, may be infinite.
+  public: double ComputeRange() const;
+
+  /// \brief Add all radios to the grid used to find neighbors.
+  public: void IndexRadios();
+
+  /// \brief Find the radios within range of a transmitter.
+  /// \param[in] _txState State of the transmitter.
+  /// \param[out] _neighbors Addresses and states of the other radios in
+  /// range. It's cleared first.
+  public: void Neighbors(const RadioState &_txState,
+      std::vector<std::pair<const std::string *, RadioState *>> &_neighbors);
+
+  /// \brief Key of a cell of the neighbor grid.
+  /// \param[in] _x Cell coordinate along X.
+  /// \param[in] _y Cell coordinate along Y.
+  /// \param[in] _z Cell coordinate along Z.
+  /// \return Key of the cell. Far away cells may share keys, which only
+  /// adds candidates.
+  private: static int64_t CellKey(int64_t _x, int64_t _y, int64_t _z);
+
   /// \brief Convert from dBm to power.
   /// \param[in] _dBm Input in dBm.
   /// \return Power in watts (W).
@@ -188,9 +244,9 @@ class ignition::gazebo::systems::RFComms::Implementation
   /// \param[in] _txState Radio state of the transmitter.
   /// \param[in] _rxState Radio state of the receiver.
   /// \return The RFPower pathloss distribution of the two antenna poses.
-  private: RFPower LogNormalReceivedPower(const double &_txPower,
-                                          const RadioState &_txState,
-                                          const RadioState &_rxState) const;
+  public: RFPower LogNormalReceivedPower(const double &_txPower,
+                                         const RadioState &_txState,
+                                         const RadioState &_rxState) const;
 
   /// \brief Range configuration.
   public: RangeConfiguration rangeConfig;
@@ -198,9 +254,26 @@ class ignition::gazebo::systems::RFComms::Implementation
   /// \brief Radio configuration.
   public: RadioConfiguration radioConfig;
 
+  /// \brief Attenuation by the environment, added to the path loss. Null
+  /// if the environment is ignored.
+  public: std::unique_ptr<comms::PropagationModel> propagationModel;
+
   /// \brief A map where the key is the address and the value its radio state.
   public: std::unordered_map<std::string, RadioState> radioStates;
 
+  /// \brief Address which reaches all radios in range, empty if
+  /// broadcasting is disabled.
+  public: std::string broadcastAddress;
+
+  /// \brief Distance beyond which packets can't be received, may be
+  /// infinite.
+  public: double range{std::numeric_limits<double>::infinity()};
+
+  /// \brief Radios in each cell of a grid with cells the size of the range.
+  /// Empty if the range is infinite.
+  public: std::unordered_map<int64_t,
+      std::vector<std::pair<const std::string *, RadioState *>>> radioGrid;
+
   /// \brief Duration of an epoch (seconds).
   public: double epochDuration = 1.0;
 
@@ -234,15 +307,35 @@ RFPower RFComms::Implementation::LogNormalReceivedPower(
   if (this->rangeConfig.maxRange > 0.0 && kRange > this->rangeConfig.maxRange)
     return {-std::numeric_limits<double>::infinity(), 0.0};
 
-  const double kPL = this->rangeConfig.l0 +
+  double kPL = this->rangeConfig.l0 +
     10 * this->rangeConfig.fadingExponent * log10(kRange);
 
+  if (this->propagationModel)
+  {
+    kPL += this->propagationModel->PathLoss(_txState.pose.Pos(),
+      _rxState.pose.Pos());
+  }
+
   return {_txPower - kPL, pow(this->rangeConfig.sigma, 2.)};
 }
 
 /////////////////////////////////////////////
 std::tuple<bool, double> RFComms::Implementation::AttemptSend(
   RadioState &_txState, RadioState &_rxState, const uint64_t &_numBytes)
+{
+  if (!this->RecordSent(_txState, _numBytes))
+    return std::make_tuple(false, std::numeric_limits<double>::lowest());
+
+  // Get the received power based on TX power and position of each node.
+  auto rxPowerDist =
+    this->LogNormalReceivedPower(this->radioConfig.txPower, _txState, _rxState);
+
+  return this->Receive(_txState.timeStamp, rxPowerDist, _rxState, _numBytes);
+}
+
+/////////////////////////////////////////////
+bool RFComms::Implementation::RecordSent(RadioState &_txState,
+  uint64_t _numBytes) const
 {
   double now = _txState.timeStamp;
 
@@ -269,21 +362,23 @@ std::tuple<bool, double> RFComms::Implementation::AttemptSend(
             << " bits sent (limit: "
             << this->radioConfig.capacity * this->epochDuration << ")"
             << std::endl;
-    return std::make_tuple(false, std::numeric_limits<double>::lowest());
+    return false;
   }
 
   // Record these bytes.
   _txState.bytesSent.push_back(std::make_pair(now, _numBytes));
   _txState.bytesSentThisEpoch += _numBytes;
+  return true;
+}
 
-  // Get the received power based on TX power and position of each node.
-  auto rxPowerDist =
-    this->LogNormalReceivedPower(this->radioConfig.txPower, _txState, _rxState);
-
-  double rxPower = rxPowerDist.mean;
-  if (rxPowerDist.variance > 0.0)
+/////////////////////////////////////////////
+std::tuple<bool, double> RFComms::Implementation::Receive(double _now,
+  const RFPower &_power, RadioState &_rxState, uint64_t _numBytes)
+{
+  double rxPower = _power.mean;
+  if (_power.variance > 0.0)
   {
-    std::normal_distribution<> d{rxPowerDist.mean, sqrt(rxPowerDist.variance)};
+    std::normal_distribution<> d{_power.mean, sqrt(_power.variance)};
     rxPower = d(this->rndEngine);
   }
 
@@ -308,7 +403,7 @@ std::tuple<bool, double> RFComms::Implementation::AttemptSend(
 
   // Maintain running window of bytes received over the last epoch, e.g., 1s.
   while (!_rxState.bytesReceived.empty() &&
-         _rxState.bytesReceived.front().first <= now - this->epochDuration)
+         _rxState.bytesReceived.front().first <= _now - this->epochDuration)
   {
     _rxState.bytesReceivedThisEpoch -= _rxState.bytesReceived.front().second;
     _rxState.bytesReceived.pop_front();
@@ -333,12 +428,112 @@ std::tuple<bool, double> RFComms::Implementation::AttemptSend(
   }
 
   // Record these bytes.
-  _rxState.bytesReceived.push_back(std::make_pair(now, _numBytes));
+  _rxState.bytesReceived.push_back(std::make_pair(_now, _numBytes));
   _rxState.bytesReceivedThisEpoch += _numBytes;
 
   return std::make_tuple(true, rxPower);
 }
 
+/////////////////////////////////////////////
+double RFComms::Implementation::ComputeRange() const
+{
+  // For weak signals, the probability of receiving a byte is
+  // erf(sqrt(snr)) ~= 2 * sqrt(snr / pi). This is the weakest power which
+  // still gets a byte through with a meaningful probability.
+  const double snr = std::pow(kMinByteProbability * std::sqrt(IGN_PI) / 2.0,
+      2.0);
+  const double sensitivity = this->radioConfig.noiseFloor +
+      10.0 * std::log10(snr);
+
+  // Path loss which fading may still overcome
+  const double maxPathLoss = this->radioConfig.txPower +
+      kFadingSigmas * this->rangeConfig.sigma - sensitivity;
+
+  double result = std::numeric_limits<double>::infinity();
+  if (this->rangeConfig.fadingExponent > 0.0)
+  {
+    result = std::pow(10.0, (maxPathLoss - this->rangeConfig.l0) /
+        (10.0 * this->rangeConfig.fadingExponent));
+  }
+  if (this->rangeConfig.maxRange > 0.0)
+    result = std::min(result, this->rangeConfig.maxRange);
+  return result;
+}
+
+/////////////////////////////////////////////
+int64_t RFComms::Implementation::CellKey(int64_t _x, int64_t _y,
+  int64_t _z)
+{
+  const int64_t mask = (int64_t{1} << 21) - 1;
+  return (_x & mask) | ((_y & mask) << 21) | ((_z & mask) << 42);
+}
+
+/////////////////////////////////////////////
+void RFComms::Implementation::IndexRadios()
+{
+  for (auto &cell : this->radioGrid)
+    cell.second.clear();
+
+  if (!std::isfinite(this->range))
+    return;
+
+  for (auto & [address, state] : this->radioStates)
+  {
+    const auto &pos = state.pose.Pos();
+    this->radioGrid[CellKey(
+        static_cast<int64_t>(std::floor(pos.X() / this->range)),
+        static_cast<int64_t>(std::floor(pos.Y() / this->range)),
+        static_cast<int64_t>(std::floor(pos.Z() / this->range)))].emplace_back(
+        &address, &state);
+  }
+}
+
+/////////////////////////////////////////////
+void RFComms::Implementation::Neighbors(const RadioState &_txState,
+  std::vector<std::pair<const std::string *, RadioState *>> &_neighbors)
+{
+  _neighbors.clear();
+
+  // Without a finite range, every radio is a candidate
+  if (!std::isfinite(this->range))
+  {
+    for (auto & [address, state] : this->radioStates)
+    {
+      if (&state != &_txState)
+        _neighbors.emplace_back(&address, &state);
+    }
+    return;
+  }
+
+  const auto &pos = _txState.pose.Pos();
+  const auto x = static_cast<int64_t>(std::floor(pos.X() / this->range));
+  const auto y = static_cast<int64_t>(std::floor(pos.Y() / this->range));
+  const auto z = static_cast<int64_t>(std::floor(pos.Z() / this->range));
+  const double rangeSquared = this->range * this->range;
+  for (int64_t i = x - 1; i <= x + 1; ++i)
+  {
+    for (int64_t j = y - 1; j <= y + 1; ++j)
+    {
+      for (int64_t k = z - 1; k <= z + 1; ++k)
+      {
+        auto cell = this->radioGrid.find(CellKey(i, j, k));
+        if (cell == this->radioGrid.end())
+          continue;
+
+        for (const auto &radio : cell->second)
+        {
+          if (radio.second != &_txState &&
+              (radio.second->pose.Pos() - pos).SquaredLength() <=
+              rangeSquared)
+          {
+            _neighbors.push_back(radio);
+          }
+        }
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////
 RFComms::RFComms()
   : dataPtr(ignition::utils::MakeUniqueImpl<Implementation>())
@@ -388,11 +583,25 @@ void RFComms::Load(const Entity &/*_entity*/,
         this->dataPtr->radioConfig.noiseFloor).first;
   }
 
+  this->dataPtr->broadcastAddress =
+    _sdf->Get<std::string>("broadcast_address", "").first;
+
+  if (_sdf->HasElement("occlusion_map"))
+  {
+    auto occlusionMap = std::make_unique<comms::OcclusionMap>();
+    if (occlusionMap->Load(_sdf->Clone()->GetElement("occlusion_map")))
+      this->dataPtr->propagationModel = std::move(occlusionMap);
+  }
+
+  this->dataPtr->range = this->dataPtr->ComputeRange();
+
   igndbg << "Range configuration:" << std::endl
          << this->dataPtr->rangeConfig << std::endl;
 
   igndbg << "Radio configuration:" << std::endl
          << this->dataPtr->radioConfig << std::endl;
+
+  igndbg << "Effective range: " << this->dataPtr->range << std::endl;
 }
 
 //////////////////////////////////////////////////
@@ -423,14 +632,87 @@ void RFComms::Step(
     else
     {
       // Update radio state.
-      const auto kPose = gazebo::worldPose(content.entity, _ecm);
-      this->dataPtr->radioStates[address].pose = kPose;
-      this->dataPtr->radioStates[address].timeStamp =
-        std::chrono::duration<double>(_info.simTime).count();
-      this->dataPtr->radioStates[address].name = content.modelName;
+      auto &state = this->dataPtr->radioStates[address];
+      state.pose = gazebo::worldPose(content.entity, _ecm);
+      state.timeStamp = std::chrono::duration<double>(_info.simTime).count();
+      state.name = content.modelName;
     }
   }
 
+  if (this->dataPtr->propagationModel)
+    this->dataPtr->propagationModel->Update(_info, _ecm);
+
+  // Receivers of broadcasts from each transmitter, and the power they
+  // receive, which are computed once per step for all the messages.
+  struct BroadcastLink
+  {
+    RadioState *tx;
+    const std::string *rxAddress;
+    RadioState *rx;
+    RFPower power;
+  };
+  std::vector<BroadcastLink> links;
+  std::unordered_map<const RadioState *, std::pair<std::size_t, std::size_t>>
+    linkRanges;
+  const auto &broadcastAddress = this->dataPtr->broadcastAddress;
+  auto isBroadcast = [&broadcastAddress](const auto &_msg)
+  {
+    return !broadcastAddress.empty() &&
+      _msg->dst_address() == broadcastAddress;
+  };
+
+  if (!broadcastAddress.empty())
+  {
+    this->dataPtr->IndexRadios();
+
+    std::vector<std::pair<const std::string *, RadioState *>> neighbors;
+    for (auto & [address, content] : _currentRegistry)
+    {
+      auto itSrc = this->dataPtr->radioStates.find(address);
+      if (itSrc == this->dataPtr->radioStates.end() ||
+          std::none_of(content.outboundMsgs.begin(),
+            content.outboundMsgs.end(), isBroadcast))
+      {
+        continue;
+      }
+
+      this->dataPtr->Neighbors(itSrc->second, neighbors);
+      const std::size_t first = links.size();
+      for (const auto &neighbor : neighbors)
+      {
+        links.push_back({&itSrc->second, neighbor.first, neighbor.second,
+          {0.0, 0.0}});
+      }
+      linkRanges[&itSrc->second] = {first, links.size()};
+    }
+
+    // The power only depends on the poses, so links are independent
+    _ecm.ParallelFor(links.size(),
+      [&](std::size_t _first, std::size_t _last)
+      {
+        for (std::size_t i = _first; i < _last; ++i)
+        {
+          links[i].power = this->dataPtr->LogNormalReceivedPower(
+            this->dataPtr->radioConfig.txPower, *links[i].tx, *links[i].rx);
+        }
+      }, 256u);
+  }
+
+  auto deliver = [&_newRegistry](const std::string &_address,
+    const msgs::DataframeSharedPtr &_msg, double _rssi)
+  {
+    // We create a copy of the outbound message because each destination
+    // might have a different rssi value.
+    auto inboundMsg = std::make_shared<ignition::msgs::Dataframe>(*_msg);
+
+    // Add rssi.
+    auto *rssiPtr = inboundMsg->mutable_header()->add_data();
+    rssiPtr->set_key("rssi");
+    rssiPtr->add_value(std::to_string(_rssi));
+
+    _newRegistry[_address].inboundMsgs.push_back(inboundMsg);
+  };
+
   for (auto & [address, content] : _currentRegistry)
   {
     // Reference to the outbound queue for this address.
@@ -443,6 +725,24 @@ void RFComms::Step(
       // All these messages need to be processed.
       for (const auto &msg : outbound)
       {
+        if (isBroadcast(msg))
+        {
+          // The transmitter's capacity is used once for all receivers.
+          if (!this->dataPtr->RecordSent(itSrc->second, msg->data().size()))
+            continue;
+
+          const auto &linkRange = linkRanges[&itSrc->second];
+          for (std::size_t i = linkRange.first; i < linkRange.second; ++i)
+          {
+            auto [received, rssi] = this->dataPtr->Receive(
+              itSrc->second.timeStamp, links[i].power, *links[i].rx,
+              msg->data().size());
+            if (received)
+              deliver(*links[i].rxAddress, msg, rssi);
+          }
+          continue;
+        }
+
         // The destination address needs to be attached to a robot.
         auto itDst = this->dataPtr->radioStates.find(msg->dst_address());
         if (itDst == this->dataPtr->radioStates.end())
@@ -452,18 +752,7 @@ void RFComms::Step(
           itSrc->second, itDst->second, msg->data().size());
 
         if (sendPacket)
-        {
-          // We create a copy of the outbound message because each destination
-          // might have a different rssi value.
-          auto inboundMsg = std::make_shared<ignition::msgs::Dataframe>(*msg);
-
-          // Add rssi.
-          auto *rssiPtr = inboundMsg->mutable_header()->add_data();
-          rssiPtr->set_key("rssi");
-          rssiPtr->add_value(std::to_string(rssi));
-
-          _newRegistry[msg->dst_address()].inboundMsgs.push_back(inboundMsg);
-        }
+          deliver(msg->dst_address(), msg, rssi);
       }
     }
 
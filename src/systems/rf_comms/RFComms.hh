@@ -33,7 +33,8 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
 namespace systems
 {
   /// \brief A comms model that simulates communication using radio frequency
-  /// (RF) devices. The model uses a log-distance path loss function.
+  /// (RF) devices. The model uses a log-distance path loss function, optionally
+  /// attenuated by the environment.
   ///
   /// This communication model has been ported from:
   /// https://github.com/osrf/subt .
@@ -62,6 +63,27 @@ namespace systems
   ///    * <noise_floor>: Noise floor in dBm.  Default is -90dBm.
   ///    * <modulation>: Supported modulations: ["QPSK"]. Default is "QPSK".
   ///
+  /// <broadcast_address> Messages sent to this address are delivered to all
+  ///                     the other radios in range, each with its own signal
+  ///                     strength. The transmitter's capacity is only used
+  ///                     once per message. Broadcasting is disabled by
+  ///                     default.
+  ///
+  /// <occlusion_map> Attenuate the signal by a fixed amount for each static
+  ///                 collision between the radios, such as walls. The
+  ///                 obstacles between every pair of cells of a grid are
+  ///                 ray cast once, on the first step, and may be cached on
+  ///                 disk. See comms::OcclusionMap for its parameters.
+  ///                 Disabled by default.
+  ///
+  /// Broadcasts are only evaluated for the radios which are close enough to
+  /// possibly receive them, which are found through a grid with cells the
+  /// size of the range. The range is <max_range>, or the distance beyond
+  /// which the received power, six standard deviations above its mean, is
+  /// too weak for even a single byte to get through, whichever is smaller.
+  /// The received power of each transmitter and neighbor pair is computed
+  /// once per step, in parallel.
+  ///
   /// Here's an example:
   /// <plugin
   ///   filename="ignition-gazebo-rf-comms-system"
@@ -78,6 +100,14 @@ namespace systems
   ///     <noise_floor>-90</noise_floor>
   ///     <modulation>QPSK</modulation>
   ///   </radio_config>
+  ///   <broadcast_address>broadcast</broadcast_address>
+  ///   <occlusion_map>
+  ///     <min>-50 -50 1</min>
+  ///     <max>50 50 1</max>
+  ///     <resolution>2</resolution>
+  ///     <obstacle_loss>12</obstacle_loss>
+  ///     <cache/>
+  ///   </occlusion_map>
   /// </plugin>
   class RFComms
     : public comms::ICommsModel
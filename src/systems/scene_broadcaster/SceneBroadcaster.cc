@@ -17,16 +17,24 @@
 
 #include "SceneBroadcaster.hh"
 
+#include <ignition/msgs/param.pb.h>
 #include <ignition/msgs/scene.pb.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
 #include <map>
+#include <optional>
+#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <ignition/common/Profiler.hh>
+#include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/graph/Graph.hh>
 #include <ignition/plugin/Register.hh>
 #include <ignition/transport/Node.hh>
@@ -61,6 +69,9 @@
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/Conversions.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/QuantizedPose.hh"
+#include "ignition/gazebo/Snapshot.hh"
+#include "ignition/gazebo/TraceRecorder.hh"
 
 #include <sdf/Camera.hh>
 #include <sdf/Imu.hh>
@@ -75,6 +86,112 @@ using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+/// \brief A client which only receives part of the state, on its own
+/// topic.
+struct StateClient
+{
+  /// \brief Publisher of the client's state.
+  transport::Node::Publisher pub;
+
+  /// \brief Component types to send, empty for all.
+  std::unordered_set<ComponentTypeId> types;
+
+  /// \brief Roots of the subtrees to send, empty for the whole world.
+  std::vector<Entity> roots;
+
+  /// \brief Region entities must be in to be sent, if any.
+  std::optional<math::AxisAlignedBox> region;
+
+  /// \brief True until the client has been sent a full state.
+  bool full{true};
+};
+
+/// \brief A client which receives samples of one component at a fixed
+/// rate of simulation time, in batches.
+struct PlotClient
+{
+  /// \brief Publisher of the client's samples.
+  transport::Node::Publisher pub;
+
+  /// \brief Entity which has the component.
+  Entity entity{kNullEntity};
+
+  /// \brief Type of the sampled component.
+  ComponentTypeId type{0};
+
+  /// \brief Simulation time between samples, zero to sample every step.
+  std::chrono::steady_clock::duration period{0};
+
+  /// \brief Simulation time of the next sample.
+  std::chrono::steady_clock::duration nextSampleTime{0};
+
+  /// \brief Samples taken since the last publication.
+  msgs::SerializedState batch;
+};
+
+/// \brief A client receiving the scene and state of the world in chunks of
+/// top level models, so it can start rendering before it has everything.
+struct SceneStream
+{
+  /// \brief Publisher of the scene chunks.
+  transport::Node::Publisher scenePub;
+
+  /// \brief Publisher of the state chunks.
+  transport::Node::Publisher statePub;
+
+  /// \brief Top level models per chunk.
+  std::size_t chunkSize{100u};
+
+  /// \brief Chunks which may be sent before being acknowledged, zero for
+  /// no limit.
+  std::size_t window{4u};
+
+  /// \brief Models near this position are sent first, if set.
+  std::optional<math::Vector3d> camera;
+
+  /// \brief Top level models, in the order they're sent. Set when the
+  /// first chunk is sent.
+  std::vector<Entity> models;
+
+  /// \brief Index in models of the first model of the next chunk.
+  std::size_t nextModel{0u};
+
+  /// \brief Index of the next chunk.
+  std::size_t chunk{0u};
+
+  /// \brief Chunks sent but not acknowledged yet.
+  std::size_t unacked{0u};
+};
+
+/// \brief A state query waiting to be answered by the simulation thread.
+struct StateQuery
+{
+  /// \brief Name of the model whose subtree is sent, if any.
+  std::string model;
+
+  /// \brief Roots of the subtrees to send. Empty with no model for the
+  /// whole world.
+  std::vector<Entity> roots;
+
+  /// \brief Component types to send, empty for all.
+  std::unordered_set<ComponentTypeId> types;
+
+  /// \brief Response, filled by the simulation thread.
+  msgs::SerializedStepMap *res{nullptr};
+
+  /// \brief True once answered.
+  bool done{false};
+};
+
+/// \brief Maximum number of samples in a batch. Fuller batches are
+/// published right away, which only happens when simulation runs much
+/// faster than real time.
+static const int kMaxPlotBatchSize{1000};
+
+/// \brief Wall time after the last state request when the state snapshot
+/// stops being refreshed.
+static const std::chrono::seconds kStateSnapshotTimeout{10};
+
 // Private data class.
 class ignition::gazebo::systems::SceneBroadcasterPrivate
 {
@@ -105,6 +222,116 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   /// \param[out] _res Response containing the last available full state.
   public: void StateAsyncService(const msgs::StringMsg &_req);
 
+  /// \brief Callback for the service subscribing clients to filtered
+  /// state. See SceneBroadcaster for the request's format.
+  /// \param[in] _req Topic and filters of the client.
+  /// \param[out] _res True if the request was valid.
+  /// \return True.
+  public: bool StateSubscribeService(const msgs::Param &_req,
+      msgs::Boolean &_res);
+
+  /// \brief Callback for the state query service. Blocks until the
+  /// simulation thread answered. See SceneBroadcaster for the request's
+  /// format.
+  /// \param[in] _req Filters of the query.
+  /// \param[out] _res Filtered full state.
+  /// \return True if the query was answered.
+  public: bool StateQueryService(const msgs::Param &_req,
+      msgs::SerializedStepMap &_res);
+
+  /// \brief Refresh the state snapshot while there are state requests,
+  /// and drop it once they stop.
+  /// \param[in] _info The update information
+  /// \param[in] _manager The entity component manager
+  /// \param[in] _changeEvent True if entities or components were added or
+  /// removed, or time jumped back.
+  public: void UpdateStateSnapshot(const UpdateInfo &_info,
+      const EntityComponentManager &_manager, bool _changeEvent);
+
+  /// \brief Answer the pending state queries.
+  /// \param[in] _info The update information
+  /// \param[in] _manager The entity component manager
+  public: void AnswerStateQueries(const UpdateInfo &_info,
+      const EntityComponentManager &_manager);
+
+  /// \brief Read the `component_types` and `entities` filters of a
+  /// request.
+  /// \param[in] _params Parameters of the request.
+  /// \param[out] _types Component types, left empty for all.
+  /// \param[out] _roots Roots of subtrees, left empty for the world.
+  public: static void ParseFilters(
+      const google::protobuf::Map<std::string, msgs::Any> &_params,
+      std::unordered_set<ComponentTypeId> &_types,
+      std::vector<Entity> &_roots);
+
+  /// \brief Callback for the service unsubscribing clients from filtered
+  /// state.
+  /// \param[in] _req Topic of the client.
+  public: void StateUnsubscribeService(const msgs::StringMsg &_req);
+
+  /// \brief Callback for the service subscribing clients to component
+  /// samples. See SceneBroadcaster for the request's format.
+  /// \param[in] _req Topic, component and rate of the client.
+  /// \param[out] _res True if the request was valid.
+  /// \return True.
+  public: bool PlotSubscribeService(const msgs::Param &_req,
+      msgs::Boolean &_res);
+
+  /// \brief Callback for the service unsubscribing clients from component
+  /// samples.
+  /// \param[in] _req Topic of the client.
+  public: void PlotUnsubscribeService(const msgs::StringMsg &_req);
+
+  /// \brief Callback for the service streaming the scene and state to a
+  /// client in chunks. See SceneBroadcaster for the request's format.
+  /// \param[in] _req Topic and options of the client.
+  /// \param[out] _res True if the request was valid.
+  /// \return True.
+  public: bool SceneStreamService(const msgs::Param &_req,
+      msgs::Boolean &_res);
+
+  /// \brief Callback for the service acknowledging a chunk of a scene
+  /// stream.
+  /// \param[in] _req Topic of the client.
+  public: void SceneStreamAckService(const msgs::StringMsg &_req);
+
+  /// \brief Publish the next chunk of each scene stream which isn't held
+  /// back by unacknowledged chunks.
+  /// \param[in] _info The update information
+  /// \param[in] _manager The entity component manager
+  public: void PublishSceneStreams(const UpdateInfo &_info,
+      const EntityComponentManager &_manager);
+
+  /// \brief Get the message of a top level model with its whole subtree,
+  /// from sceneModels or built from the scene graph. Must be called with
+  /// graphMutex locked.
+  /// \param[in] _entity Top level model.
+  /// \return Message, or nullptr if the entity isn't a top level model.
+  public: const msgs::Model *SceneModel(const Entity _entity);
+
+  /// \brief Sample the components of plot clients which are due, and
+  /// publish batches of samples at the state rate.
+  /// \param[in] _info The update information
+  /// \param[in] _manager The entity component manager
+  public: void PublishPlotSamples(const UpdateInfo &_info,
+      const EntityComponentManager &_manager);
+
+  /// \brief Publish the filtered state of each client which is due.
+  /// \param[in] _info The update information
+  /// \param[in] _manager The entity component manager
+  /// \param[in] _changeEvent True if there are changes which must be
+  /// published right away, as for the state topic.
+  public: void PublishClientStates(const UpdateInfo &_info,
+      const EntityComponentManager &_manager, bool _changeEvent);
+
+  /// \brief Entities a client should receive.
+  /// \param[in] _client The client
+  /// \param[in] _manager The entity component manager
+  /// \return Entities, empty for all of them.
+  public: std::unordered_set<Entity> ClientEntities(
+      const StateClient &_client, const EntityComponentManager &_manager)
+      const;
+
   /// \brief Updates the scene graph when entities are added
   /// \param[in] _manager The entity component manager
   public: void SceneGraphAddEntities(const EntityComponentManager &_manager);
@@ -173,6 +400,13 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   public: static void RemoveFromGraph(const Entity _entity,
                                       SceneGraphType &_graph);
 
+  /// \brief Drop the cached message of the top level model which holds an
+  /// entity, because the entity was added to or removed from the scene
+  /// graph. Must be called with graphMutex locked, while the entity is in
+  /// the graph.
+  /// \param[in] _entity Entity in the scene graph.
+  public: void InvalidateSceneModel(const Entity _entity);
+
   /// \brief Create and send out pose updates.
   /// \param[in] _info The update information
   /// \param[in] _manager The entity component manager
@@ -188,9 +422,48 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   /// \brief Dynamic pose publisher, for non-static model poses
   public: transport::Node::Publisher dyPosePub;
 
+  /// \brief Decide whether a dynamic pose should go into a delta message,
+  /// and remember it as published if so.
+  /// \param[in] _entity Entity whose pose it is.
+  /// \param[in] _pose Current pose.
+  /// \return True if the pose should be published.
+  public: bool DynamicPoseChanged(const Entity _entity,
+    const math::Pose3d &_pose);
+
   /// \brief Rate at which to publish dynamic poses
   public: int dyPoseHertz{60};
 
+  /// \brief True to publish only dynamic poses that changed.
+  public: bool dyPoseDelta{false};
+
+  /// \brief Minimum translation for a pose to be published in delta mode.
+  public: double dyPoseDeltaPosition{0.001};
+
+  /// \brief Minimum rotation for a pose to be published in delta mode.
+  public: double dyPoseDeltaOrientation{0.001};
+
+  /// \brief Wall time between keyframes in delta mode.
+  public: std::chrono::steady_clock::duration dyPoseKeyframePeriod{
+      std::chrono::seconds(1)};
+
+  /// \brief Wall time of the last keyframe in delta mode.
+  public: std::optional<std::chrono::steady_clock::time_point>
+      lastDyPoseKeyframe;
+
+  /// \brief Wall time the dynamic poses were last published, used to
+  /// throttle delta mode.
+  public: std::optional<std::chrono::steady_clock::time_point>
+      lastDyPosePub;
+
+  /// \brief True while building a keyframe.
+  public: bool dyPoseKeyframe{false};
+
+  /// \brief Sequence number of the next dynamic pose message in delta mode.
+  public: uint64_t dyPoseSeq{0u};
+
+  /// \brief Last published pose of each dynamic entity, in delta mode.
+  public: std::unordered_map<Entity, math::Pose3d> lastDyPoses;
+
   /// \brief Scene publisher
   public: transport::Node::Publisher scenePub;
 
@@ -219,6 +492,12 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   /// \brief Protects scene graph.
   public: std::mutex graphMutex;
 
+  /// \brief Messages of top level models, with their whole subtree, so
+  /// that scene info requests only copy them. Entries are dropped when
+  /// entities are added to or removed from the subtree, and rebuilt from
+  /// the scene graph when requested. Protected by graphMutex.
+  public: std::unordered_map<Entity, msgs::Model> sceneModels;
+
   /// \brief Protects stepMsg.
   public: std::mutex stateMutex;
 
@@ -247,6 +526,24 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   /// \brief Flag used to indicate if the state service was called.
   public: bool stateServiceRequest{false};
 
+  /// \brief Full state of a recent step, read by the state service without
+  /// locking. Only published while there are state requests.
+  public: Snapshot<msgs::SerializedStepMap> stateSnapshot;
+
+  /// \brief Steady clock time of the last state request, in ticks since
+  /// the clock's epoch.
+  public: std::atomic<std::chrono::steady_clock::rep> lastStateRequestTime{0};
+
+  /// \brief Last time the state snapshot was published. Only accessed by
+  /// the simulation thread.
+  public: std::chrono::steady_clock::time_point lastSnapshotTime;
+
+  /// \brief True to publish poses in the state topic quantized.
+  public: bool quantizedPoses{false};
+
+  /// \brief Position resolution of quantized poses, in meters.
+  public: double quantizedPoseResolution{1e-4};
+
   /// \brief A list of async state requests
   public: std::unordered_set<std::string> stateRequests;
 
@@ -257,6 +554,52 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   /// \brief Flag used to indicate if periodic changes need to be published
   /// This is currently only used in playback mode.
   public: bool pubPeriodicChanges{false};
+
+  /// \brief Clients receiving filtered state, by topic.
+  public: std::unordered_map<std::string, StateClient> stateClients;
+
+  /// \brief Clients added or updated by the subscribe service, to be
+  /// moved into stateClients by the simulation thread. Protected by
+  /// stateMutex.
+  public: std::unordered_map<std::string, StateClient> newStateClients;
+
+  /// \brief Topics of clients removed by the unsubscribe service.
+  /// Protected by stateMutex.
+  public: std::vector<std::string> removedStateClients;
+
+  /// \brief Last time the filtered states were published.
+  public: std::chrono::time_point<std::chrono::system_clock>
+      lastClientStatePubTime{std::chrono::system_clock::now()};
+
+  /// \brief State queries waiting to be answered. Protected by stateMutex,
+  /// and answered ones are signaled through stateCv.
+  public: std::vector<StateQuery *> stateQueries;
+
+  /// \brief Clients receiving component samples, by topic.
+  public: std::unordered_map<std::string, PlotClient> plotClients;
+
+  /// \brief Clients added by the plot subscribe service, to be moved into
+  /// plotClients by the simulation thread. Protected by stateMutex.
+  public: std::unordered_map<std::string, PlotClient> newPlotClients;
+
+  /// \brief Topics of clients removed by the plot unsubscribe service.
+  /// Protected by stateMutex.
+  public: std::vector<std::string> removedPlotClients;
+
+  /// \brief Last time batches of samples were published.
+  public: std::chrono::time_point<std::chrono::system_clock>
+      lastPlotPubTime{std::chrono::system_clock::now()};
+
+  /// \brief Scene streams in progress, by topic.
+  public: std::unordered_map<std::string, SceneStream> sceneStreams;
+
+  /// \brief Streams requested by the scene stream service, to be moved
+  /// into sceneStreams by the simulation thread. Protected by stateMutex.
+  public: std::unordered_map<std::string, SceneStream> newSceneStreams;
+
+  /// \brief Chunks acknowledged by each stream since the last update.
+  /// Protected by stateMutex.
+  public: std::unordered_map<std::string, std::size_t> sceneStreamAcks;
 };
 
 //////////////////////////////////////////////////
@@ -285,6 +628,55 @@ void SceneBroadcaster::Configure(
   auto readHertz = _sdf->Get<int>("dynamic_pose_hertz", 60);
   this->dataPtr->dyPoseHertz = readHertz.first;
 
+  if (_sdf->HasElement("dynamic_pose_delta"))
+  {
+    auto deltaElem = _sdf->FindElement("dynamic_pose_delta");
+    this->dataPtr->dyPoseDelta = true;
+    this->dataPtr->dyPoseDeltaPosition = std::max(0.0,
+        deltaElem->Get<double>("position",
+        this->dataPtr->dyPoseDeltaPosition).first);
+    this->dataPtr->dyPoseDeltaOrientation = std::max(0.0,
+        deltaElem->Get<double>("orientation",
+        this->dataPtr->dyPoseDeltaOrientation).first);
+
+    auto keyframePeriod = deltaElem->Get<double>("keyframe_period", 1.0).first;
+    if (keyframePeriod <= 0.0)
+    {
+      ignerr << "SceneBroadcaster <dynamic_pose_delta><keyframe_period> must "
+             << "be positive, using default (1s)" << std::endl;
+      keyframePeriod = 1.0;
+    }
+    this->dataPtr->dyPoseKeyframePeriod =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(keyframePeriod));
+
+    igndbg << "Publishing dynamic pose deltas above ["
+           << this->dataPtr->dyPoseDeltaPosition << "] m / ["
+           << this->dataPtr->dyPoseDeltaOrientation << "] rad, with keyframes"
+           << " every [" << keyframePeriod << "] s." << std::endl;
+  }
+
+  if (_sdf->HasElement("quantized_poses"))
+  {
+    auto quantizedElem = _sdf->FindElement("quantized_poses");
+    this->dataPtr->quantizedPoses = true;
+    auto resolution = quantizedElem->Get<double>("resolution",
+        this->dataPtr->quantizedPoseResolution).first;
+    if (resolution <= 0.0)
+    {
+      ignerr << "SceneBroadcaster <quantized_poses><resolution> must be "
+             << "positive, using [" << this->dataPtr->quantizedPoseResolution
+             << "] m." << std::endl;
+    }
+    else
+    {
+      this->dataPtr->quantizedPoseResolution = resolution;
+    }
+
+    igndbg << "Publishing quantized poses with a resolution of ["
+           << this->dataPtr->quantizedPoseResolution << "] m." << std::endl;
+  }
+
   auto stateHertz = _sdf->Get<double>("state_hertz", 60);
   if (stateHertz.first > 0.0)
   {
@@ -317,7 +709,7 @@ void SceneBroadcaster::Configure(
 void SceneBroadcaster::PostUpdate(const UpdateInfo &_info,
     const EntityComponentManager &_manager)
 {
-  IGN_PROFILE("SceneBroadcaster::PostUpdate");
+  IGN_GAZEBO_PROFILE("SceneBroadcaster::PostUpdate");
 
   // Update scene graph with added entities before populating pose message
   if (_manager.HasNewEntities())
@@ -382,7 +774,7 @@ void SceneBroadcaster::PostUpdate(const UpdateInfo &_info,
     // Otherwise publish just periodic change components when running
     else if (!_info.paused)
     {
-      IGN_PROFILE("SceneBroadcast::PostUpdate UpdateState");
+      IGN_GAZEBO_PROFILE("SceneBroadcast::PostUpdate UpdateState");
 
       if (_manager.HasPeriodicComponentChanges())
       {
@@ -419,6 +811,7 @@ void SceneBroadcaster::PostUpdate(const UpdateInfo &_info,
     }
 
     // Full state on demand
+    bool servedStateRequest = this->dataPtr->stateServiceRequest;
     if (this->dataPtr->stateServiceRequest)
     {
       this->dataPtr->stateServiceRequest = false;
@@ -440,88 +833,502 @@ void SceneBroadcaster::PostUpdate(const UpdateInfo &_info,
     // changed components
     if (shouldPublish)
     {
-      IGN_PROFILE("SceneBroadcast::PostUpdate Publish State");
-      this->dataPtr->statePub.Publish(this->dataPtr->stepMsg);
+      IGN_GAZEBO_PROFILE("SceneBroadcast::PostUpdate Publish State");
+      if (this->dataPtr->quantizedPoses)
+      {
+        // The state service replies with stepMsg once the lock is released,
+        // so leave it untouched if it was requested.
+        if (servedStateRequest)
+        {
+          msgs::SerializedStepMap quantizedMsg(this->dataPtr->stepMsg);
+          quantizePoses(*quantizedMsg.mutable_state(),
+              this->dataPtr->quantizedPoseResolution);
+          this->dataPtr->statePub.Publish(quantizedMsg);
+        }
+        else
+        {
+          quantizePoses(*this->dataPtr->stepMsg.mutable_state(),
+              this->dataPtr->quantizedPoseResolution);
+          this->dataPtr->statePub.Publish(this->dataPtr->stepMsg);
+        }
+      }
+      else
+      {
+        this->dataPtr->statePub.Publish(this->dataPtr->stepMsg);
+      }
       this->dataPtr->lastStatePubTime = now;
     }
   }
+
+  this->dataPtr->UpdateStateSnapshot(_info, _manager, changeEvent);
+  this->dataPtr->PublishClientStates(_info, _manager, changeEvent);
+  this->dataPtr->PublishPlotSamples(_info, _manager);
+  this->dataPtr->PublishSceneStreams(_info, _manager);
+  this->dataPtr->AnswerStateQueries(_info, _manager);
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::UpdateStateSnapshot(const UpdateInfo &_info,
+    const EntityComponentManager &_manager, bool _changeEvent)
+{
+  auto now = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point lastRequest{
+      std::chrono::steady_clock::duration(this->lastStateRequestTime)};
+  bool hasSnapshot = this->stateSnapshot.Get() != nullptr;
+
+  // Nobody asked for the state lately, don't keep serializing it
+  if (now - lastRequest > kStateSnapshotTimeout)
+  {
+    if (hasSnapshot)
+      this->stateSnapshot.Publish(nullptr);
+    return;
+  }
+
+  if (hasSnapshot && !_changeEvent &&
+      now - this->lastSnapshotTime < this->statePublishPeriod[_info.paused])
+  {
+    return;
+  }
+
+  IGN_GAZEBO_PROFILE("SceneBroadcast::UpdateStateSnapshot");
+
+  auto msg = std::make_shared<msgs::SerializedStepMap>();
+  set(msg->mutable_stats(), _info);
+  _manager.State(*msg->mutable_state(), {}, {}, true);
+  this->stateSnapshot.Publish(std::move(msg));
+  this->lastSnapshotTime = now;
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::AnswerStateQueries(const UpdateInfo &_info,
+    const EntityComponentManager &_manager)
+{
+  std::lock_guard<std::mutex> lock(this->stateMutex);
+  if (this->stateQueries.empty())
+    return;
+
+  IGN_GAZEBO_PROFILE("SceneBroadcast::AnswerStateQueries");
+
+  for (auto *query : this->stateQueries)
+  {
+    set(query->res->mutable_stats(), _info);
+
+    StateClient client;
+    client.roots = query->roots;
+    auto entities = this->ClientEntities(client, _manager);
+    if (!query->model.empty())
+    {
+      // The world is always sent, so unknown models get a state without
+      // anything else
+      entities.insert(this->worldEntity);
+      auto model = _manager.EntityByComponents(
+          components::Name(query->model), components::Model());
+      if (kNullEntity != model)
+      {
+        _manager.EachDescendant(model, [&](const Entity _entity)
+        {
+          entities.insert(_entity);
+          return true;
+        });
+      }
+    }
+
+    // An empty set would send all entities
+    if (!entities.empty() || query->roots.empty())
+    {
+      _manager.State(*query->res->mutable_state(), entities, query->types,
+          true);
+    }
+    else
+    {
+      query->res->mutable_state();
+    }
+    query->done = true;
+  }
+  this->stateQueries.clear();
+  this->stateCv.notify_all();
+}
+
+//////////////////////////////////////////////////
+bool SceneBroadcasterPrivate::StateQueryService(const msgs::Param &_req,
+    msgs::SerializedStepMap &_res)
+{
+  _res.Clear();
+
+  StateQuery query;
+  query.res = &_res;
+  const auto &params = _req.params();
+  ParseFilters(params, query.types, query.roots);
+  auto modelIt = params.find("model");
+  if (modelIt != params.end())
+    query.model = modelIt->second.string_value();
+
+  // Lock and wait for an iteration to answer the query
+  std::unique_lock<std::mutex> lock(this->stateMutex);
+  this->stateQueries.push_back(&query);
+  auto success = this->stateCv.wait_for(lock, 5s, [&]
+  {
+    return query.done;
+  });
+
+  if (!success)
+  {
+    this->stateQueries.erase(std::remove(this->stateQueries.begin(),
+        this->stateQueries.end(), &query), this->stateQueries.end());
+    ignerr << "Timed out waiting for state query" << std::endl;
+  }
+  return success;
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::ParseFilters(
+    const google::protobuf::Map<std::string, msgs::Any> &_params,
+    std::unordered_set<ComponentTypeId> &_types,
+    std::vector<Entity> &_roots)
+{
+  auto typesIt = _params.find("component_types");
+  if (typesIt != _params.end())
+  {
+    std::istringstream stream(typesIt->second.string_value());
+    ComponentTypeId type;
+    while (stream >> type)
+      _types.insert(type);
+  }
+
+  auto entitiesIt = _params.find("entities");
+  if (entitiesIt != _params.end())
+  {
+    std::istringstream stream(entitiesIt->second.string_value());
+    Entity entity;
+    while (stream >> entity)
+      _roots.push_back(entity);
+  }
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::PublishPlotSamples(const UpdateInfo &_info,
+    const EntityComponentManager &_manager)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->stateMutex);
+    for (auto &[topic, client] : this->newPlotClients)
+    {
+      auto it = this->plotClients.find(topic);
+      if (it != this->plotClients.end())
+        client.pub = it->second.pub;
+      else
+        client.pub = this->node->Advertise<msgs::SerializedState>(topic);
+      this->plotClients[topic] = std::move(client);
+    }
+    this->newPlotClients.clear();
+
+    for (const auto &topic : this->removedPlotClients)
+      this->plotClients.erase(topic);
+    this->removedPlotClients.clear();
+  }
+
+  if (this->plotClients.empty())
+    return;
+
+  IGN_GAZEBO_PROFILE("SceneBroadcast::PublishPlotSamples");
+
+  auto now = std::chrono::system_clock::now();
+  bool itsPubTime = (now - this->lastPlotPubTime >
+       this->statePublishPeriod[_info.paused]);
+  if (itsPubTime)
+    this->lastPlotPubTime = now;
+
+  for (auto &[topic, client] : this->plotClients)
+  {
+    if (!client.pub.HasConnections())
+    {
+      client.batch.Clear();
+      continue;
+    }
+
+    // Simulation time went back, such as after a reset
+    if (client.nextSampleTime > _info.simTime + client.period)
+      client.nextSampleTime = _info.simTime;
+
+    // Sample once per step at most, when simulation time moves
+    if (!_info.paused && _info.simTime >= client.nextSampleTime)
+    {
+      // Samples stay on the grid of the period, unless simulation
+      // skipped a whole period
+      client.nextSampleTime += client.period;
+      if (client.nextSampleTime <= _info.simTime)
+        client.nextSampleTime = _info.simTime + client.period;
+
+      msgs::SerializedStateMap sample;
+      _manager.State(sample, {client.entity}, {client.type}, true);
+      auto entityIt = sample.mutable_entities()->find(client.entity);
+      if (entityIt != sample.mutable_entities()->end())
+      {
+        auto compIt = entityIt->second.mutable_components()->find(
+            client.type);
+        if (compIt != entityIt->second.mutable_components()->end())
+        {
+          auto entityMsg = client.batch.add_entities();
+          entityMsg->set_id(client.entity);
+          entityMsg->add_components()->Swap(&compIt->second);
+
+          // Sample times in nanoseconds, in the order of the entities
+          auto timeData = client.batch.mutable_header()->mutable_data();
+          if (timeData->empty())
+            timeData->Add()->set_key("sim_time");
+          timeData->Mutable(0)->add_value(
+              std::to_string(_info.simTime.count()));
+        }
+      }
+    }
+
+    if (client.batch.entities_size() == 0 ||
+        (!itsPubTime && client.batch.entities_size() < kMaxPlotBatchSize))
+    {
+      continue;
+    }
+
+    set(client.batch.mutable_header()->mutable_stamp(), _info.simTime);
+    client.pub.Publish(client.batch);
+    client.batch.Clear();
+  }
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::PublishClientStates(const UpdateInfo &_info,
+    const EntityComponentManager &_manager, bool _changeEvent)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->stateMutex);
+    for (auto &[topic, client] : this->newStateClients)
+    {
+      // Keep the publisher of clients updating their filters
+      auto it = this->stateClients.find(topic);
+      if (it != this->stateClients.end())
+        client.pub = it->second.pub;
+      else
+        client.pub = this->node->Advertise<msgs::SerializedStepMap>(topic);
+      this->stateClients[topic] = std::move(client);
+    }
+    this->newStateClients.clear();
+
+    for (const auto &topic : this->removedStateClients)
+      this->stateClients.erase(topic);
+    this->removedStateClients.clear();
+  }
+
+  if (this->stateClients.empty())
+    return;
+
+  IGN_GAZEBO_PROFILE("SceneBroadcast::PublishClientStates");
+
+  auto now = std::chrono::system_clock::now();
+  bool itsPubTime = (now - this->lastClientStatePubTime >
+       this->statePublishPeriod[_info.paused]);
+  if (itsPubTime)
+    this->lastClientStatePubTime = now;
+
+  auto periodicTypes = _manager.ComponentTypesWithPeriodicChanges();
+  for (auto &[topic, client] : this->stateClients)
+  {
+    if (!client.pub.HasConnections())
+      continue;
+
+    if (!client.full && !_changeEvent &&
+        (!itsPubTime || _info.paused || periodicTypes.empty()))
+    {
+      continue;
+    }
+
+    // An empty set would send all entities
+    auto entities = this->ClientEntities(client, _manager);
+    if (entities.empty() && (!client.roots.empty() || client.region))
+      continue;
+
+    msgs::SerializedStepMap msg;
+    set(msg.mutable_stats(), _info);
+    if (client.full)
+    {
+      _manager.State(*msg.mutable_state(), entities, client.types, true);
+      client.full = false;
+    }
+    else if (_changeEvent)
+    {
+      _manager.ChangedState(*msg.mutable_state(), entities, client.types);
+    }
+    else
+    {
+      std::unordered_set<ComponentTypeId> types;
+      for (const auto &type : periodicTypes)
+      {
+        if (client.types.empty() || client.types.count(type) > 0)
+          types.insert(type);
+      }
+      // An empty set would send all types
+      if (types.empty())
+        continue;
+      _manager.State(*msg.mutable_state(), entities, types);
+    }
+
+    if (this->quantizedPoses)
+    {
+      quantizePoses(*msg.mutable_state(), this->quantizedPoseResolution);
+    }
+    client.pub.Publish(msg);
+  }
 }
 
+//////////////////////////////////////////////////
+std::unordered_set<Entity> SceneBroadcasterPrivate::ClientEntities(
+    const StateClient &_client, const EntityComponentManager &_manager) const
+{
+  std::unordered_set<Entity> entities;
+  auto insert = [&](const Entity _entity)
+  {
+    entities.insert(_entity);
+    return true;
+  };
+  for (const auto &root : _client.roots)
+    _manager.EachDescendant(root, insert);
+
+  if (!_client.region)
+    return entities;
+
+  if (_client.roots.empty())
+    _manager.EachDescendant(this->worldEntity, insert);
+
+  // Entities without poses, such as the world, are kept
+  for (auto it = entities.begin(); it != entities.end();)
+  {
+    auto pose = _manager.EntityWorldPose(*it);
+    if (pose && !_client.region->Contains(pose->Pos()))
+      it = entities.erase(it);
+    else
+      ++it;
+  }
+  return entities;
+}
 //////////////////////////////////////////////////
 void SceneBroadcasterPrivate::PoseUpdate(const UpdateInfo &_info,
     const EntityComponentManager &_manager)
 {
-  IGN_PROFILE("SceneBroadcast::PoseUpdate");
+  IGN_GAZEBO_PROFILE("SceneBroadcast::PoseUpdate");
 
   msgs::Pose_V poseMsg, dyPoseMsg;
   bool dyPoseConnections = this->dyPosePub.HasConnections();
   bool poseConnections = this->posePub.HasConnections();
 
-  // Models
-  _manager.Each<components::Model, components::Name, components::Pose,
-                components::Static>(
-      [&](const Entity &_entity, const components::Model *,
-          const components::Name *_nameComp,
-          const components::Pose *_poseComp,
-          const components::Static *_staticComp) -> bool
+  // In delta mode, throttle here instead of in the publisher, so that poses
+  // are only remembered as published if they were actually sent.
+  if (dyPoseConnections && this->dyPoseDelta)
+  {
+    auto now = std::chrono::steady_clock::now();
+    if (this->dyPoseHertz > 0 && this->lastDyPosePub &&
+        now - *this->lastDyPosePub <
+        std::chrono::duration<double>(1.0 / this->dyPoseHertz))
+    {
+      dyPoseConnections = false;
+    }
+    else
+    {
+      this->lastDyPosePub = now;
+      this->dyPoseKeyframe = !this->lastDyPoseKeyframe ||
+          now - *this->lastDyPoseKeyframe >= this->dyPoseKeyframePeriod;
+      if (this->dyPoseKeyframe)
       {
-        if (poseConnections)
+        this->lastDyPoseKeyframe = now;
+        // Forget entities that no longer exist
+        this->lastDyPoses.clear();
+      }
+    }
+  }
+
+  auto addPose = [](msgs::Pose_V &_msg, const Entity _entity,
+      const components::Name *_nameComp, const components::Pose *_poseComp)
+  {
+    auto pose = _msg.add_pose();
+    msgs::Set(pose, _poseComp->Data());
+    pose->set_name(_nameComp->Data());
+    pose->set_id(_entity);
+  };
+
+  // Models and links
+  if (poseConnections)
+  {
+    _manager.Each<components::Model, components::Name, components::Pose,
+                  components::Static>(
+        [&](const Entity &_entity, const components::Model *,
+            const components::Name *_nameComp,
+            const components::Pose *_poseComp,
+            const components::Static *) -> bool
         {
-          // Add to pose msg
-          auto pose = poseMsg.add_pose();
-          msgs::Set(pose, _poseComp->Data());
-          pose->set_name(_nameComp->Data());
-          pose->set_id(_entity);
-        }
+          addPose(poseMsg, _entity, _nameComp, _poseComp);
+          return true;
+        });
 
-        if (dyPoseConnections && !_staticComp->Data())
+    _manager.Each<components::Link, components::Name, components::Pose,
+                  components::ParentEntity>(
+        [&](const Entity &_entity, const components::Link *,
+            const components::Name *_nameComp,
+            const components::Pose *_poseComp,
+            const components::ParentEntity *) -> bool
         {
-          // Add to dynamic pose msg
-          auto dyPose = dyPoseMsg.add_pose();
-          msgs::Set(dyPose, _poseComp->Data());
-          dyPose->set_name(_nameComp->Data());
-          dyPose->set_id(_entity);
-        }
-        return true;
-      });
+          addPose(poseMsg, _entity, _nameComp, _poseComp);
+          return true;
+        });
+  }
 
-  // Links
-  _manager.Each<components::Link, components::Name, components::Pose,
-                components::ParentEntity>(
-      [&](const Entity &_entity, const components::Link *,
-          const components::Name *_nameComp,
-          const components::Pose *_poseComp,
-          const components::ParentEntity *_parentComp) -> bool
-      {
-        // Add to pose msg
-        if (poseConnections)
+  // Only entities which may move are visited for the dynamic poses, which
+  // usually leaves out most of the world
+  if (dyPoseConnections)
+  {
+    _manager.EachDynamic<components::Model, components::Name,
+                         components::Pose, components::Static>(
+        [&](const Entity &_entity, const components::Model *,
+            const components::Name *_nameComp,
+            const components::Pose *_poseComp,
+            const components::Static *) -> bool
         {
-          auto pose = poseMsg.add_pose();
-          msgs::Set(pose, _poseComp->Data());
-          pose->set_name(_nameComp->Data());
-          pose->set_id(_entity);
-        }
+          if (this->DynamicPoseChanged(_entity, _poseComp->Data()))
+            addPose(dyPoseMsg, _entity, _nameComp, _poseComp);
+          return true;
+        });
 
-        // Check whether parent model is static
-        auto staticComp = _manager.Component<components::Static>(
-          _parentComp->Data());
-        if (dyPoseConnections && !staticComp->Data())
+    _manager.EachDynamic<components::Link, components::Name,
+                         components::Pose, components::ParentEntity>(
+        [&](const Entity &_entity, const components::Link *,
+            const components::Name *_nameComp,
+            const components::Pose *_poseComp,
+            const components::ParentEntity *) -> bool
         {
-          // Add to dynamic pose msg
-          auto dyPose = dyPoseMsg.add_pose();
-          msgs::Set(dyPose, _poseComp->Data());
-          dyPose->set_name(_nameComp->Data());
-          dyPose->set_id(_entity);
-        }
+          if (this->DynamicPoseChanged(_entity, _poseComp->Data()))
+            addPose(dyPoseMsg, _entity, _nameComp, _poseComp);
+          return true;
+        });
+  }
 
-        return true;
-      });
+  if (dyPoseConnections && this->dyPoseDelta)
+  {
+    if (this->dyPoseKeyframe || dyPoseMsg.pose_size() > 0)
+    {
+      auto header = dyPoseMsg.mutable_header();
+      set(header->mutable_stamp(), _info.simTime);
 
-  if (dyPoseConnections)
+      auto seqData = header->add_data();
+      seqData->set_key("seq");
+      seqData->add_value(std::to_string(this->dyPoseSeq++));
+
+      auto keyframeData = header->add_data();
+      keyframeData->set_key("keyframe");
+      keyframeData->add_value(this->dyPoseKeyframe ? "1" : "0");
+
+      this->dyPosePub.Publish(dyPoseMsg);
+    }
+  }
+  else if (dyPoseConnections)
   {
     // Set the time stamp in the header
-    dyPoseMsg.mutable_header()->mutable_stamp()->CopyFrom(
-        convert<msgs::Time>(_info.simTime));
+    set(dyPoseMsg.mutable_header()->mutable_stamp(), _info.simTime);
 
     this->dyPosePub.Publish(dyPoseMsg);
   }
@@ -529,8 +1336,7 @@ void SceneBroadcasterPrivate::PoseUpdate(const UpdateInfo &_info,
   // Visuals
   if (poseConnections)
   {
-    poseMsg.mutable_header()->mutable_stamp()->CopyFrom(
-        convert<msgs::Time>(_info.simTime));
+    set(poseMsg.mutable_header()->mutable_stamp(), _info.simTime);
 
     _manager.Each<components::Visual, components::Name, components::Pose>(
       [&](const Entity &_entity, const components::Visual *,
@@ -616,6 +1422,56 @@ void SceneBroadcasterPrivate::SetupTransport(const std::string &_worldName)
   ignmsg << "Serving full state (async) on [" << opts.NameSpace() << "/"
          << stateAsyncService << "]" << std::endl;
 
+  // Filtered state services
+  std::string stateSubscribeService{"state/subscribe"};
+
+  this->node->Advertise(stateSubscribeService,
+      &SceneBroadcasterPrivate::StateSubscribeService, this);
+
+  std::string stateUnsubscribeService{"state/unsubscribe"};
+
+  this->node->Advertise(stateUnsubscribeService,
+      &SceneBroadcasterPrivate::StateUnsubscribeService, this);
+
+  ignmsg << "Serving filtered state subscriptions on [" << opts.NameSpace()
+         << "/" << stateSubscribeService << "]" << std::endl;
+
+  std::string stateQueryService{"state/query"};
+
+  this->node->Advertise(stateQueryService,
+      &SceneBroadcasterPrivate::StateQueryService, this);
+
+  ignmsg << "Serving filtered state queries on [" << opts.NameSpace()
+         << "/" << stateQueryService << "]" << std::endl;
+
+  // Component sampling services
+  std::string plotSubscribeService{"plot/subscribe"};
+
+  this->node->Advertise(plotSubscribeService,
+      &SceneBroadcasterPrivate::PlotSubscribeService, this);
+
+  std::string plotUnsubscribeService{"plot/unsubscribe"};
+
+  this->node->Advertise(plotUnsubscribeService,
+      &SceneBroadcasterPrivate::PlotUnsubscribeService, this);
+
+  ignmsg << "Serving component sample subscriptions on [" << opts.NameSpace()
+         << "/" << plotSubscribeService << "]" << std::endl;
+
+  // Chunked scene and state services
+  std::string sceneStreamService{"scene/stream"};
+
+  this->node->Advertise(sceneStreamService,
+      &SceneBroadcasterPrivate::SceneStreamService, this);
+
+  std::string sceneStreamAckService{"scene/stream/ack"};
+
+  this->node->Advertise(sceneStreamAckService,
+      &SceneBroadcasterPrivate::SceneStreamAckService, this);
+
+  ignmsg << "Streaming scene and state in chunks on [" << opts.NameSpace()
+         << "/" << sceneStreamService << "]" << std::endl;
+
   // Scene info topic
   std::string sceneTopic{ns + "/scene/info"};
 
@@ -656,8 +1512,11 @@ void SceneBroadcasterPrivate::SetupTransport(const std::string &_worldName)
   // Dynamic pose info publisher
   std::string dyPoseTopic{"dynamic_pose/info"};
 
+  // In delta mode the rate is enforced by PoseUpdate, since messages dropped
+  // by the publisher would leave subscribers out of sync.
   transport::AdvertiseMessageOptions dyPoseAdvertOpts;
-  dyPoseAdvertOpts.SetMsgsPerSec(this->dyPoseHertz);
+  if (!this->dyPoseDelta)
+    dyPoseAdvertOpts.SetMsgsPerSec(this->dyPoseHertz);
   this->dyPosePub = this->node->Advertise<msgs::Pose_V>(dyPoseTopic,
       dyPoseAdvertOpts);
 
@@ -665,6 +1524,37 @@ void SceneBroadcasterPrivate::SetupTransport(const std::string &_worldName)
          << dyPoseTopic << "]" << std::endl;
 }
 
+//////////////////////////////////////////////////
+bool SceneBroadcasterPrivate::DynamicPoseChanged(const Entity _entity,
+    const math::Pose3d &_pose)
+{
+  if (!this->dyPoseDelta)
+    return true;
+
+  auto it = this->lastDyPoses.find(_entity);
+  if (this->dyPoseKeyframe || it == this->lastDyPoses.end())
+  {
+    this->lastDyPoses[_entity] = _pose;
+    return true;
+  }
+
+  const auto &last = it->second;
+  bool moved = (_pose.Pos() - last.Pos()).Length() >
+      this->dyPoseDeltaPosition;
+  if (!moved)
+  {
+    // Angle of the rotation between the two orientations
+    auto diff = last.Rot().Inverse() * _pose.Rot();
+    diff.Normalize();
+    double angle = 2.0 * std::acos(std::min(1.0, std::abs(diff.W())));
+    moved = angle > this->dyPoseDeltaOrientation;
+  }
+
+  if (moved)
+    it->second = _pose;
+  return moved;
+}
+
 //////////////////////////////////////////////////
 bool SceneBroadcasterPrivate::SceneInfoService(msgs::Scene &_res)
 {
@@ -675,8 +1565,13 @@ bool SceneBroadcasterPrivate::SceneInfoService(msgs::Scene &_res)
   // Populate scene message
   _res.CopyFrom(convert<msgs::Scene>(this->sdfScene));
 
-  // Add models
-  AddModels(&_res, this->worldEntity, this->sceneGraph);
+  // Add models, building those which aren't cached
+  for (const auto &vertex : this->sceneGraph.AdjacentsFrom(this->worldEntity))
+  {
+    auto modelMsg = this->SceneModel(vertex.first);
+    if (modelMsg)
+      _res.add_model()->CopyFrom(*modelMsg);
+  }
 
   // Add lights
   AddLights(&_res, this->worldEntity, this->sceneGraph);
@@ -684,6 +1579,24 @@ bool SceneBroadcasterPrivate::SceneInfoService(msgs::Scene &_res)
   return true;
 }
 
+//////////////////////////////////////////////////
+const msgs::Model *SceneBroadcasterPrivate::SceneModel(const Entity _entity)
+{
+  auto cached = this->sceneModels.find(_entity);
+  if (cached != this->sceneModels.end())
+    return &cached->second;
+
+  auto modelMsg = std::dynamic_pointer_cast<msgs::Model>(
+      this->sceneGraph.VertexFromId(_entity).Data());
+  if (!modelMsg)
+    return nullptr;
+
+  cached = this->sceneModels.emplace(_entity, *modelMsg).first;
+  AddModels(&cached->second, _entity, this->sceneGraph);
+  AddLinks(&cached->second, _entity, this->sceneGraph);
+  return &cached->second;
+}
+
 //////////////////////////////////////////////////
 void SceneBroadcasterPrivate::StateAsyncService(
     const msgs::StringMsg &_req)
@@ -693,12 +1606,328 @@ void SceneBroadcasterPrivate::StateAsyncService(
   this->stateRequests.insert(_req.data());
 }
 
+//////////////////////////////////////////////////
+bool SceneBroadcasterPrivate::StateSubscribeService(const msgs::Param &_req,
+    msgs::Boolean &_res)
+{
+  _res.set_data(false);
+  const auto &params = _req.params();
+
+  auto topicIt = params.find("topic");
+  if (topicIt == params.end())
+  {
+    ignerr << "Missing [topic] in state subscription request." << std::endl;
+    return true;
+  }
+  auto topic = transport::TopicUtils::AsValidTopic(
+      topicIt->second.string_value());
+  if (topic.empty())
+  {
+    ignerr << "Invalid topic [" << topicIt->second.string_value()
+           << "] in state subscription request." << std::endl;
+    return true;
+  }
+
+  StateClient client;
+  ParseFilters(params, client.types, client.roots);
+
+  auto minIt = params.find("region_min");
+  auto maxIt = params.find("region_max");
+  if (minIt != params.end() && maxIt != params.end())
+  {
+    client.region = math::AxisAlignedBox(
+        msgs::Convert(minIt->second.vector3d_value()),
+        msgs::Convert(maxIt->second.vector3d_value()));
+  }
+
+  std::lock_guard<std::mutex> lock(this->stateMutex);
+  this->newStateClients[topic] = std::move(client);
+  _res.set_data(true);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::StateUnsubscribeService(
+    const msgs::StringMsg &_req)
+{
+  auto topic = transport::TopicUtils::AsValidTopic(_req.data());
+  std::lock_guard<std::mutex> lock(this->stateMutex);
+  this->newStateClients.erase(topic);
+  this->removedStateClients.push_back(topic);
+}
+
+//////////////////////////////////////////////////
+bool SceneBroadcasterPrivate::PlotSubscribeService(const msgs::Param &_req,
+    msgs::Boolean &_res)
+{
+  _res.set_data(false);
+  const auto &params = _req.params();
+
+  auto topicIt = params.find("topic");
+  auto entityIt = params.find("entity");
+  auto typeIt = params.find("component_type");
+  if (topicIt == params.end() || entityIt == params.end() ||
+      typeIt == params.end())
+  {
+    ignerr << "Plot subscription requests need a [topic], an [entity] and a "
+           << "[component_type]." << std::endl;
+    return true;
+  }
+  auto topic = transport::TopicUtils::AsValidTopic(
+      topicIt->second.string_value());
+  if (topic.empty())
+  {
+    ignerr << "Invalid topic [" << topicIt->second.string_value()
+           << "] in plot subscription request." << std::endl;
+    return true;
+  }
+
+  PlotClient client;
+  std::istringstream(entityIt->second.string_value()) >> client.entity;
+  std::istringstream(typeIt->second.string_value()) >> client.type;
+
+  auto rateIt = params.find("rate");
+  if (rateIt != params.end() && rateIt->second.double_value() > 0.0)
+  {
+    client.period =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / rateIt->second.double_value()));
+  }
+
+  std::lock_guard<std::mutex> lock(this->stateMutex);
+  this->newPlotClients[topic] = std::move(client);
+  _res.set_data(true);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::PlotUnsubscribeService(
+    const msgs::StringMsg &_req)
+{
+  auto topic = transport::TopicUtils::AsValidTopic(_req.data());
+  std::lock_guard<std::mutex> lock(this->stateMutex);
+  this->newPlotClients.erase(topic);
+  this->removedPlotClients.push_back(topic);
+}
+
+//////////////////////////////////////////////////
+bool SceneBroadcasterPrivate::SceneStreamService(const msgs::Param &_req,
+    msgs::Boolean &_res)
+{
+  _res.set_data(false);
+  const auto &params = _req.params();
+
+  auto topicIt = params.find("topic");
+  if (topicIt == params.end())
+  {
+    ignerr << "Missing [topic] in scene stream request." << std::endl;
+    return true;
+  }
+  auto topic = transport::TopicUtils::AsValidTopic(
+      topicIt->second.string_value());
+  if (topic.empty())
+  {
+    ignerr << "Invalid topic [" << topicIt->second.string_value()
+           << "] in scene stream request." << std::endl;
+    return true;
+  }
+
+  SceneStream stream;
+  auto sizeIt = params.find("chunk_size");
+  if (sizeIt != params.end())
+  {
+    stream.chunkSize = static_cast<std::size_t>(
+        std::max<int64_t>(sizeIt->second.int_value(), 1));
+  }
+
+  auto windowIt = params.find("window");
+  if (windowIt != params.end())
+  {
+    stream.window = static_cast<std::size_t>(
+        std::max<int64_t>(windowIt->second.int_value(), 0));
+  }
+
+  auto cameraIt = params.find("camera");
+  if (cameraIt != params.end())
+    stream.camera = msgs::Convert(cameraIt->second.vector3d_value());
+
+  std::lock_guard<std::mutex> lock(this->stateMutex);
+  this->newSceneStreams[topic] = std::move(stream);
+  this->sceneStreamAcks.erase(topic);
+  _res.set_data(true);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::SceneStreamAckService(
+    const msgs::StringMsg &_req)
+{
+  auto topic = transport::TopicUtils::AsValidTopic(_req.data());
+  std::lock_guard<std::mutex> lock(this->stateMutex);
+  ++this->sceneStreamAcks[topic];
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::PublishSceneStreams(const UpdateInfo &_info,
+    const EntityComponentManager &_manager)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->stateMutex);
+    for (auto &[topic, stream] : this->newSceneStreams)
+    {
+      // Restarting a stream keeps its publishers
+      auto it = this->sceneStreams.find(topic);
+      if (it != this->sceneStreams.end())
+      {
+        stream.scenePub = it->second.scenePub;
+        stream.statePub = it->second.statePub;
+      }
+      else
+      {
+        stream.scenePub = this->node->Advertise<msgs::Scene>(topic + "/scene");
+        stream.statePub =
+            this->node->Advertise<msgs::SerializedStepMap>(topic + "/state");
+      }
+      this->sceneStreams[topic] = std::move(stream);
+    }
+    this->newSceneStreams.clear();
+
+    for (const auto &[topic, acks] : this->sceneStreamAcks)
+    {
+      auto it = this->sceneStreams.find(topic);
+      if (it != this->sceneStreams.end())
+        it->second.unacked -= std::min(acks, it->second.unacked);
+    }
+    this->sceneStreamAcks.clear();
+  }
+
+  if (this->sceneStreams.empty())
+    return;
+
+  IGN_GAZEBO_PROFILE("SceneBroadcast::PublishSceneStreams");
+
+  // At most one chunk per stream and step, so that the simulation thread is
+  // never blocked for long
+  std::lock_guard<std::mutex> lock(this->graphMutex);
+  for (auto it = this->sceneStreams.begin(); it != this->sceneStreams.end();)
+  {
+    auto &stream = it->second;
+    if (!stream.scenePub.HasConnections() ||
+        !stream.statePub.HasConnections() ||
+        (stream.window > 0u && stream.unacked >= stream.window))
+    {
+      ++it;
+      continue;
+    }
+
+    if (0u == stream.chunk)
+    {
+      for (const auto &vertex :
+           this->sceneGraph.AdjacentsFrom(this->worldEntity))
+      {
+        if (std::dynamic_pointer_cast<msgs::Model>(vertex.second.get().Data()))
+          stream.models.push_back(vertex.first);
+      }
+
+      if (stream.camera)
+      {
+        std::vector<std::pair<double, Entity>> byDistance;
+        byDistance.reserve(stream.models.size());
+        for (const auto entity : stream.models)
+        {
+          auto poseComp = _manager.Component<components::Pose>(entity);
+          const double distance = nullptr == poseComp ? 0.0 :
+              poseComp->Data().Pos().SquaredDistance(*stream.camera);
+          byDistance.emplace_back(distance, entity);
+        }
+        std::stable_sort(byDistance.begin(), byDistance.end(),
+            [](const auto &_a, const auto &_b)
+            {
+              return _a.first < _b.first;
+            });
+        for (std::size_t i = 0; i < byDistance.size(); ++i)
+          stream.models[i] = byDistance[i].second;
+      }
+    }
+
+    const std::size_t chunks = std::max<std::size_t>(1u,
+        (stream.models.size() + stream.chunkSize - 1u) / stream.chunkSize);
+
+    msgs::Scene sceneMsg;
+    std::unordered_set<Entity> entities;
+
+    // The first chunk holds the world's properties and lights
+    if (0u == stream.chunk)
+    {
+      sceneMsg.CopyFrom(convert<msgs::Scene>(this->sdfScene));
+      AddLights(&sceneMsg, this->worldEntity, this->sceneGraph);
+      entities.insert(this->worldEntity);
+      for (const auto &light : sceneMsg.light())
+        entities.insert(light.id());
+    }
+    sceneMsg.set_name(this->worldName);
+
+    // Models removed since the stream started are skipped
+    const std::size_t end = std::min(stream.models.size(),
+        stream.nextModel + stream.chunkSize);
+    for (; stream.nextModel < end; ++stream.nextModel)
+    {
+      const Entity entity = stream.models[stream.nextModel];
+      if (!_manager.HasEntity(entity))
+        continue;
+      auto modelMsg = this->SceneModel(entity);
+      if (nullptr == modelMsg)
+        continue;
+
+      sceneMsg.add_model()->CopyFrom(*modelMsg);
+      auto descendants = _manager.Descendants(entity);
+      entities.insert(descendants.begin(), descendants.end());
+    }
+
+    msgs::SerializedStepMap stateMsg;
+    set(stateMsg.mutable_stats(), _info);
+    _manager.State(*stateMsg.mutable_state(), entities, {}, true);
+
+    for (auto *header : {sceneMsg.mutable_header(),
+                         stateMsg.mutable_header()})
+    {
+      auto data = header->add_data();
+      data->set_key("chunk");
+      data->add_value(std::to_string(stream.chunk));
+      data = header->add_data();
+      data->set_key("chunks");
+      data->add_value(std::to_string(chunks));
+    }
+
+    stream.scenePub.Publish(sceneMsg);
+    stream.statePub.Publish(stateMsg);
+    ++stream.chunk;
+    ++stream.unacked;
+
+    if (stream.chunk >= chunks)
+      it = this->sceneStreams.erase(it);
+    else
+      ++it;
+  }
+}
+
 //////////////////////////////////////////////////
 bool SceneBroadcasterPrivate::StateService(
     msgs::SerializedStepMap &_res)
 {
   _res.Clear();
 
+  this->lastStateRequestTime =
+      std::chrono::steady_clock::now().time_since_epoch().count();
+
+  // Answer right away if the simulation thread is keeping a snapshot
+  auto snapshot = this->stateSnapshot.Get();
+  if (snapshot)
+  {
+    _res.CopyFrom(*snapshot);
+    return true;
+  }
+
   // Lock and wait for an iteration to be run and fill the state
   std::unique_lock<std::mutex> lock(this->stateMutex);
 
@@ -764,7 +1993,7 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
         auto modelMsg = std::make_shared<msgs::Model>();
         modelMsg->set_id(_entity);
         modelMsg->set_name(_nameComp->Data());
-        modelMsg->mutable_pose()->CopyFrom(msgs::Convert(_poseComp->Data()));
+        msgs::Set(modelMsg->mutable_pose(), _poseComp->Data());
 
         // Add to graph
         newGraph.AddVertex(_nameComp->Data(), modelMsg, _entity);
@@ -785,7 +2014,7 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
         auto linkMsg = std::make_shared<msgs::Link>();
         linkMsg->set_id(_entity);
         linkMsg->set_name(_nameComp->Data());
-        linkMsg->mutable_pose()->CopyFrom(msgs::Convert(_poseComp->Data()));
+        msgs::Set(linkMsg->mutable_pose(), _poseComp->Data());
 
         // Add to graph
         newGraph.AddVertex(_nameComp->Data(), linkMsg, _entity);
@@ -810,15 +2039,14 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
         visualMsg->set_id(_entity);
         visualMsg->set_parent_id(_parentComp->Data());
         visualMsg->set_name(_nameComp->Data());
-        visualMsg->mutable_pose()->CopyFrom(msgs::Convert(_poseComp->Data()));
+        msgs::Set(visualMsg->mutable_pose(), _poseComp->Data());
         visualMsg->set_cast_shadows(_castShadowsComp->Data());
 
         // Geometry is optional
         auto geometryComp = _manager.Component<components::Geometry>(_entity);
         if (geometryComp)
         {
-          visualMsg->mutable_geometry()->CopyFrom(
-              convert<msgs::Geometry>(geometryComp->Data()));
+          set(visualMsg->mutable_geometry(), geometryComp->Data());
         }
 
         // Material is optional
@@ -850,7 +2078,7 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
         lightMsg->set_id(_entity);
         lightMsg->set_parent_id(_parentComp->Data());
         lightMsg->set_name(_nameComp->Data());
-        lightMsg->mutable_pose()->CopyFrom(msgs::Convert(_poseComp->Data()));
+        msgs::Set(lightMsg->mutable_pose(), _poseComp->Data());
 
         // Add to graph
         newGraph.AddVertex(_nameComp->Data(), lightMsg, _entity);
@@ -871,7 +2099,7 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
         sensorMsg->set_id(_entity);
         sensorMsg->set_parent_id(_parentComp->Data());
         sensorMsg->set_name(_nameComp->Data());
-        sensorMsg->mutable_pose()->CopyFrom(msgs::Convert(_poseComp->Data()));
+        msgs::Set(sensorMsg->mutable_pose(), _poseComp->Data());
 
         auto altimeterComp = _manager.Component<components::Altimeter>(_entity);
         if (altimeterComp)
@@ -1054,7 +2282,7 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
         auto emitterMsg = std::make_shared<msgs::ParticleEmitter>();
         emitterMsg->CopyFrom(_emitterComp->Data());
         emitterMsg->set_id(_entity);
-        emitterMsg->mutable_pose()->CopyFrom(msgs::Convert(_poseComp->Data()));
+        msgs::Set(emitterMsg->mutable_pose(), _poseComp->Data());
 
         // Add to graph
         newGraph.AddVertex(emitterMsg->name(), emitterMsg, _entity);
@@ -1066,11 +2294,15 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
   // Update the whole scene graph from the new graph
   {
     std::lock_guard<std::mutex> lock(this->graphMutex);
+    std::vector<Entity> added;
     for (const auto &[id, vert] : newGraph.Vertices())
     {
       // Add the vertex only if it's not already in the graph
       if (!this->sceneGraph.VertexFromId(id).Valid())
+      {
         this->sceneGraph.AddVertex(vert.get().Name(), vert.get().Data(), id);
+        added.push_back(id);
+      }
     }
     for (const auto &[id, edge] : newGraph.Edges())
     {
@@ -1081,6 +2313,12 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
         this->sceneGraph.AddEdge(edge.get().Vertices(), edge.get().Data());
       }
     }
+
+    if (!this->sceneModels.empty())
+    {
+      for (const auto entity : added)
+        this->InvalidateSceneModel(entity);
+    }
   }
 
   if (newEntity)
@@ -1099,6 +2337,16 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
     // Add lights
     AddLights(&sceneMsg, this->worldEntity, newGraph);
     this->scenePub.Publish(sceneMsg);
+
+    // Models which are new as a whole hold their whole subtree, so they're
+    // cached for scene info requests
+    std::lock_guard<std::mutex> lock(this->graphMutex);
+    for (auto &modelMsg : *sceneMsg.mutable_model())
+    {
+      const Entity entity = modelMsg.id();
+      if (this->sceneGraph.VertexFromId(entity).Valid())
+        this->sceneModels[entity].Swap(&modelMsg);
+    }
   }
 }
 
@@ -1120,6 +2368,7 @@ void SceneBroadcasterPrivate::SceneGraphRemoveEntities(
       {
         removedEntities.push_back(_entity);
         // Remove from graph
+        this->InvalidateSceneModel(_entity);
         RemoveFromGraph(_entity, this->sceneGraph);
         return true;
       });
@@ -1130,6 +2379,7 @@ void SceneBroadcasterPrivate::SceneGraphRemoveEntities(
       {
         removedEntities.push_back(_entity);
         // Remove from graph
+        this->InvalidateSceneModel(_entity);
         RemoveFromGraph(_entity, this->sceneGraph);
         return true;
       });
@@ -1286,6 +2536,25 @@ void SceneBroadcasterPrivate::RemoveFromGraph(const Entity _entity,
   _graph.RemoveVertex(_entity);
 }
 
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::InvalidateSceneModel(const Entity _entity)
+{
+  // Walk up to the child of the world
+  Entity entity = _entity;
+  while (true)
+  {
+    const auto parents = this->sceneGraph.AdjacentsTo(entity);
+    if (parents.empty())
+      return;
+
+    const Entity parent = parents.begin()->first;
+    if (parent == this->worldEntity)
+      break;
+    entity = parent;
+  }
+  this->sceneModels.erase(entity);
+}
+
 
 IGNITION_ADD_PLUGIN(SceneBroadcaster,
                     System,
@@ -37,6 +37,124 @@ namespace systems
   **/
   /// \brief System which periodically publishes an ignition::msgs::Scene
   /// message with updated information.
+  ///
+  /// ## System Parameters
+  ///
+  /// `<dynamic_pose_hertz>`: Rate at which dynamic poses are published on
+  /// `dynamic_pose/info`. Defaults to 60.
+  ///
+  /// `<state_hertz>`: Rate at which state is published. Defaults to 60.
+  ///
+  /// `<dynamic_pose_delta>`: If present, `dynamic_pose/info` only carries
+  /// the poses that changed by more than the thresholds below since they were
+  /// last published, plus periodic keyframes with all dynamic poses. Each
+  /// message header has a `seq` key holding a sequence number that increases
+  /// by one for every published message, and a `keyframe` key which is
+  /// `1` for keyframes and `0` otherwise. Subscribers that detect a gap in
+  /// the sequence should wait for the next keyframe to resync. Messages are
+  /// only published if at least one pose changed or a keyframe is due.
+  /// Children:
+  ///   * `<position>`: Minimum translation in meters. Defaults to 0.001.
+  ///   * `<orientation>`: Minimum rotation in radians. Defaults to 0.001.
+  ///   * `<keyframe_period>`: Seconds of wall time between keyframes.
+  ///     Defaults to 1.
+  ///
+  /// `<quantized_poses>`: If present, poses in the `state` topic are encoded
+  /// with `encodeQuantizedPose` instead of being serialized as `msgs::Pose`,
+  /// which roughly divides their size by three. Subscribers must call
+  /// `dequantizePoses` on the state before passing it to
+  /// `EntityComponentManager::SetState`; the GUI does so automatically.
+  /// Replies from the `state` service are never quantized.
+  /// Children:
+  ///   * `<resolution>`: Position resolution in meters, rounded to a power
+  ///     of ten. Defaults to 0.0001.
+  ///
+  /// ## Filtered state
+  ///
+  /// Clients which only need part of the state, such as GUIs showing few
+  /// plugins over slow links, can call the `state/subscribe` service with
+  /// an `ignition::msgs::Param` holding:
+  ///   * `topic`: String, topic where the client's state is published.
+  ///   * `component_types`: String, optional. Space separated IDs of the
+  ///     component types to send. All types are sent by default. New
+  ///     entities are always sent with all their components.
+  ///   * `entities`: String, optional. Space separated IDs of entities
+  ///     whose subtrees are sent. The whole world is sent by default.
+  ///   * `region_min` and `region_max`: Vector3d, optional. Corners of a
+  ///     box in the world frame; only entities whose world pose is inside
+  ///     it are sent. Entities which leave it stop being updated.
+  ///
+  /// The client first receives a full filtered state, then changes, at the
+  /// same rate as the `state` topic. Calling the service again with the same
+  /// topic replaces its filters. The `state/unsubscribe` service takes an
+  /// `ignition::msgs::StringMsg` with the topic, and stops publishing to it.
+  ///
+  /// ## State queries
+  ///
+  /// Clients which need part of the state once, such as the `ign model`
+  /// command, can call the `state/query` service with an
+  /// `ignition::msgs::Param` holding the `component_types` and `entities`
+  /// filters above, and optionally:
+  ///   * `model`: String, name of a model whose subtree is sent, together
+  ///     with the world entity.
+  ///
+  /// The reply is an `ignition::msgs::SerializedStepMap` with the full
+  /// filtered state of the next step. Unlike the `state` service, only the
+  /// requested entities and components are serialized.
+  ///
+  /// ## State service
+  ///
+  /// The `state` service replies with the full state. The first request
+  /// waits for the next step, after which the system keeps a copy of the
+  /// full state of a recent step, refreshed at the `<state_hertz>` rate and
+  /// on entity creation and removal, so later requests are answered right
+  /// away from the transport thread without waiting for the simulation
+  /// thread. The copy is dropped once there were no requests for 10 seconds
+  /// of wall time.
+  ///
+  /// ## Component samples
+  ///
+  /// Clients plotting components faster than the state rate, such as the
+  /// Plotting GUI plugin, can call the `plot/subscribe` service with an
+  /// `ignition::msgs::Param` holding:
+  ///   * `topic`: String, topic where samples are published.
+  ///   * `entity`: String, ID of the entity.
+  ///   * `component_type`: String, ID of the component type.
+  ///   * `rate`: Double, optional. Samples per second of simulation time.
+  ///     Defaults to one sample per step.
+  ///
+  /// Samples are published as `ignition::msgs::SerializedState` batches at
+  /// the same rate as the `state` topic. Each sample is an entity holding
+  /// the serialized component, and the `sim_time` key of the header holds
+  /// their simulation times in nanoseconds, in the same order. The
+  /// `plot/unsubscribe` service takes an `ignition::msgs::StringMsg` with
+  /// the topic, and stops sampling for it.
+  ///
+  /// ## Chunked scene and state
+  ///
+  /// Clients joining a large world, which would otherwise wait for the
+  /// whole `scene/info` reply and full state, can call the `scene/stream`
+  /// service with an `ignition::msgs::Param` holding:
+  ///   * `topic`: String, prefix of the topics where chunks are published:
+  ///     `ignition::msgs::Scene` chunks on `<topic>/scene` and
+  ///     `ignition::msgs::SerializedStepMap` chunks on `<topic>/state`.
+  ///   * `chunk_size`: Int, optional. Top level models per chunk. Defaults
+  ///     to 100.
+  ///   * `camera`: Vector3d, optional. Models closest to this position are
+  ///     sent first.
+  ///   * `window`: Int, optional. Chunks which may be sent before the client
+  ///     acknowledges them, 0 for no limit. Defaults to 4.
+  ///
+  /// Each chunk is a scene holding some top level models with their whole
+  /// subtree, followed by the full state of those entities. The first chunk
+  /// also holds the scene properties, the world's lights and their state.
+  /// The `chunk` and `chunks` keys of both headers hold the index of the
+  /// chunk and the number of chunks. At most one chunk is published per
+  /// step, and none while `window` chunks are unacknowledged. Clients
+  /// acknowledge each chunk they processed by calling `scene/stream/ack`
+  /// with an `ignition::msgs::StringMsg` holding the topic. Entities
+  /// created or changed while streaming arrive on the usual `scene/info`
+  /// and `state` topics.
   class SceneBroadcaster:
     public System,
     public ISystemConfigure,
@@ -17,20 +17,32 @@
 
 #include "Sensors.hh"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <map>
+#include <memory>
 #include <set>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include <ignition/common/Event.hh>
 #include <ignition/common/Profiler.hh>
 #include <ignition/plugin/Register.hh>
 
 #include <sdf/Sensor.hh>
 
 #include <ignition/math/Helpers.hh>
+#include <ignition/msgs/image.pb.h>
+#include <ignition/msgs/pointcloud_packed.pb.h>
+#include <ignition/msgs/PointCloudPackedUtils.hh>
+#include <ignition/msgs/Utility.hh>
 
+#include <ignition/rendering/DepthCamera.hh>
 #include <ignition/rendering/Scene.hh>
 #include <ignition/sensors/BoundingBoxCameraSensor.hh>
 #include <ignition/sensors/CameraSensor.hh>
@@ -43,11 +55,13 @@
 #include <ignition/sensors/Manager.hh>
 
 #include "ignition/gazebo/components/Atmosphere.hh"
+#include "ignition/gazebo/components/AxisAlignedBox.hh"
 #include "ignition/gazebo/components/BatterySoC.hh"
 #include "ignition/gazebo/components/BoundingBoxCamera.hh"
 #include "ignition/gazebo/components/Camera.hh"
 #include "ignition/gazebo/components/DepthCamera.hh"
 #include "ignition/gazebo/components/GpuLidar.hh"
+#include "ignition/gazebo/components/Model.hh"
 #include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/RenderEngineServerHeadless.hh"
 #include "ignition/gazebo/components/RenderEngineServerPlugin.hh"
@@ -55,25 +69,37 @@
 #include "ignition/gazebo/components/SegmentationCamera.hh"
 #include "ignition/gazebo/components/ThermalCamera.hh"
 #include "ignition/gazebo/components/World.hh"
+#include "ignition/gazebo/CameraBatch.hh"
 #include "ignition/gazebo/Events.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/LocalTopics.hh"
+#include "ignition/gazebo/TraceRecorder.hh"
+#include "ignition/gazebo/Util.hh"
 
 #include "ignition/gazebo/rendering/Events.hh"
+#include "ignition/gazebo/rendering/MeshPreloader.hh"
 #include "ignition/gazebo/rendering/RenderUtil.hh"
 
+#include "SharedMemoryFrame.hh"
+
 using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
-// Private data class.
-class ignition::gazebo::systems::SensorsPrivate
+/// \brief A group of rendering sensors which are rendered into their own
+/// scene by their own thread. Each shard keeps its own replica of the scene,
+/// fed from the ECM.
+class SensorShard
 {
+  /// \brief Index of this shard
+  public: std::size_t index{0u};
+
   /// \brief Sensor manager object. This manages the lifecycle of the
-  /// instantiated sensors.
+  /// sensors instantiated in this shard.
   public: sensors::Manager sensorManager;
 
   /// \brief used to store whether rendering objects have been created.
-  public: bool initialized = false;
+  public: std::atomic<bool> initialized { false };
 
   /// \brief Main rendering interface
   public: RenderUtil renderUtil;
@@ -85,6 +111,94 @@ class ignition::gazebo::systems::SensorsPrivate
   /// generate sensor data
   public: rendering::ScenePtr scene;
 
+  /// \brief Flag to signal if initialization should occur
+  public: bool doInit { false };
+
+  /// \brief Flag to signal if rendering update is needed
+  public: bool updateAvailable { false };
+
+  /// \brief Thread that rendering will occur in
+  public: std::thread renderThread;
+
+  /// \brief Mutex to protect rendering data
+  public: std::mutex renderMutex;
+
+  /// \brief Condition variable to signal rendering thread
+  ///
+  /// This variable is used to block/unblock operations in the rendering
+  /// thread.  For a more detailed explanation on the flow refer to the
+  /// documentation on RenderThread.
+  public: std::condition_variable renderCv;
+
+  /// \brief Update time for the next rendering iteration
+  public: std::chrono::steady_clock::duration updateTime;
+
+  /// \brief Sensors to include in the next rendering iteration
+  public: std::vector<sensors::RenderingSensor *> activeSensors;
+
+  /// \brief Sensors which aren't due yet, but are due soon enough to be
+  /// rendered together with activeSensors in the next rendering iteration
+  public: std::vector<sensors::RenderingSensor *> batchedSensors;
+
+  /// \brief Number of consecutive rendering updates which were skipped
+  /// because the rendering thread was busy.
+  public: unsigned int skippedUpdates{0u};
+
+  /// \brief Held while using the render engine. Shards which share a render
+  /// engine share this mutex, because render engines aren't thread safe.
+  public: std::shared_ptr<std::mutex> engineMutex;
+};
+
+/// \brief Raw frames of a sensor which are exported through shared memory
+struct ExportedFrames
+{
+  /// \brief Segment the frames are written to
+  std::unique_ptr<sensors_system::SharedMemoryFrame> frame;
+
+  /// \brief Connection to the sensor's new frame event, released before
+  /// the segment
+  common::ConnectionPtr connection;
+};
+
+/// \brief Messages of a sensor which are also published to local
+/// subscribers and optionally to shared memory
+struct LocalMessages
+{
+  /// \brief Topic of the images
+  std::string imageTopic;
+
+  /// \brief Topic of the point clouds, empty if the sensor has none
+  std::string pointsTopic;
+
+  /// \brief Segment the images are written to, null if disabled
+  std::unique_ptr<sensors_system::SharedMemoryFrame> imageFrame;
+
+  /// \brief Segment the point clouds are written to, null if disabled
+  std::unique_ptr<sensors_system::SharedMemoryFrame> pointsFrame;
+
+  /// \brief Batch the images are written to, null if the sensor isn't in
+  /// one
+  std::shared_ptr<CameraBatch> batch;
+
+  /// \brief Slot of the sensor in batch
+  std::size_t batchSlot{0u};
+
+  /// \brief Connection to the sensor's image event, released before the
+  /// segments
+  common::ConnectionPtr imageConnection;
+
+  /// \brief Connection to the point cloud event, only held while the point
+  /// clouds are wanted because it makes the camera compute them
+  common::ConnectionPtr pointsConnection;
+};
+
+// Private data class.
+class ignition::gazebo::systems::SensorsPrivate
+{
+  /// \brief Rendering shards. There's always at least one, and the first
+  /// one is the only one which emits rendering events.
+  public: std::vector<std::unique_ptr<SensorShard>> shards;
+
   /// \brief Temperature used by thermal camera. Defaults to temperature at
   /// sea level
   public: double ambientTemperature = 288.15;
@@ -104,38 +218,23 @@ class ignition::gazebo::systems::SensorsPrivate
   /// the destruction of the corresponding ignition::sensors Sensor object
   public: std::unordered_map<Entity, sensors::SensorId> entityToIdMap;
 
-  /// \brief Flag to indicate if worker threads are running
-  public: std::atomic<bool> running { false };
+  /// \brief Maps gazebo entity to the shard its sensor was created in
+  public: std::unordered_map<Entity, SensorShard *> entityToShard;
 
-  /// \brief Flag to signal if initialization should occur
-  public: bool doInit { false };
+  /// \brief Mutex to protect cameras, entityToIdMap and entityToShard, which
+  /// are accessed by all rendering threads.
+  public: std::mutex sensorsMutex;
 
-  /// \brief Flag to signal if rendering update is needed
-  public: bool updateAvailable { false };
+  /// \brief Serializes render engine initialization across shards.
+  public: std::mutex initMutex;
 
-  /// \brief Thread that rendering will occur in
-  public: std::thread renderThread;
-
-  /// \brief Mutex to protect rendering data
-  public: std::mutex renderMutex;
-
-  /// \brief Condition variable to signal rendering thread
-  ///
-  /// This variable is used to block/unblock operations in the rendering
-  /// thread.  For a more detailed explanation on the flow refer to the
-  /// documentation on RenderThread.
-  public: std::condition_variable renderCv;
+  /// \brief Flag to indicate if worker threads are running
+  public: std::atomic<bool> running { false };
 
   /// \brief Connection to events::Stop event, used to stop thread
   public: common::ConnectionPtr stopConn;
 
-  /// \brief Update time for the next rendering iteration
-  public: std::chrono::steady_clock::duration updateTime;
-
-  /// \brief Sensors to include in the next rendering iteration
-  public: std::vector<sensors::RenderingSensor *> activeSensors;
-
-  /// \brief Mutex to protect sensorMask
+  /// \brief Mutex to protect sensorMask and the shards' active sensors
   public: std::mutex sensorMaskMutex;
 
   /// \brief Mask sensor updates for sensors currently being rendered
@@ -145,13 +244,77 @@ class ignition::gazebo::systems::SensorsPrivate
   /// \brief Pointer to the event manager
   public: EventManager *eventManager{nullptr};
 
+  /// \brief Events emitted around each render, looked up once since
+  /// they're emitted every frame from the rendering thread.
+  public: events::PreRender *preRenderEvent{nullptr};
+
+  /// \brief See preRenderEvent.
+  public: events::PostRender *postRenderEvent{nullptr};
+
+  /// \brief Event reporting mesh preloading, looked up once since it's
+  /// emitted while other systems may be connecting to events.
+  public: events::MeshPreloadProgress *meshPreloadEvent{nullptr};
+
+  /// \brief Maximum number of consecutive rendering updates that PostUpdate
+  /// may skip instead of waiting for a busy rendering thread. Zero keeps
+  /// rendering in lockstep with simulation.
+  public: unsigned int maxFrameLag{0u};
+
+  /// \brief True to skip pose updates of models that no camera sees.
+  public: bool frustumCulling{false};
+
+  /// \brief Sensors due within this time of a rendering update are
+  /// rendered in it too, instead of triggering an update of their own.
+  public: std::chrono::steady_clock::duration renderBatchWindow{0};
+
+  /// \brief True to load all meshes before the first render.
+  public: bool preloadMeshes{false};
+
+  /// \brief Number of threads used to preload meshes, zero for one per
+  /// hardware thread.
+  public: unsigned int preloadThreads{0u};
+
+  /// \brief CPUs the render threads are restricted to, empty for any.
+  public: std::vector<unsigned int> renderThreadCpus;
+
+  /// \brief Loads meshes before the first render, created once rendering
+  /// is needed.
+  public: std::unique_ptr<MeshPreloader> meshPreloader;
+
+  /// \brief True to export raw depth and lidar frames to shared memory.
+  public: bool sharedMemoryExport{false};
+
+  /// \brief Sensors whose frames are exported to shared memory. Protected
+  /// by sensorMaskMutex.
+  public: std::unordered_map<sensors::SensorId, ExportedFrames>
+      exportedFrames;
+
+  /// \brief True to write the images and point clouds of cameras and depth
+  /// cameras to shared memory.
+  public: bool sharedMemoryMessages{false};
+
+  /// \brief Sensors whose messages are published locally. Protected by
+  /// sensorMaskMutex.
+  public: std::unordered_map<sensors::SensorId, LocalMessages>
+      localMessages;
+
+  /// \brief Camera batches created from <camera_batch>.
+  public: std::vector<std::shared_ptr<CameraBatch>> cameraBatches;
+
+  /// \brief Batch and slot of each batched camera, keyed by topic.
+  public: std::unordered_map<std::string,
+      std::pair<std::shared_ptr<CameraBatch>, std::size_t>> batchSlots;
+
   /// \brief Wait for initialization to happen
-  private: void WaitForInit();
+  /// \param[in] _shard Shard to initialize
+  private: void WaitForInit(SensorShard &_shard);
 
   /// \brief Run one rendering iteration
-  private: void RunOnce();
+  /// \param[in] _shard Shard to render
+  private: void RunOnce(SensorShard &_shard);
 
-  /// \brief Top level function for the rendering thread
+  /// \brief Top level function for a rendering thread. There's one
+  /// rendering thread per shard.
   ///
   /// This function captures all of the behavior of the rendering thread.
   /// The behavior is captured in two phases: initialization and steady state.
@@ -177,14 +340,27 @@ class ignition::gazebo::systems::SensorsPrivate
   //
   /// The caller of PostUpdate will be blocked if there is a rendering
   /// operation currently ongoing, until that completes.
-  private: void RenderThread();
+  /// \param[in] _shard Shard rendered by this thread
+  private: void RenderThread(SensorShard &_shard);
 
-  /// \brief Launch the rendering thread
+  /// \brief Launch the rendering threads
   public: void Run();
 
-  /// \brief Stop the rendering thread
+  /// \brief Stop the rendering threads
   public: void Stop();
 
+  /// \brief Get the shard that a sensor should be created in. The
+  /// assignment only depends on the sensor's scoped name and on the number
+  /// of shards, so it's the same across runs.
+  /// \param[in] _sensorName Scoped name of the sensor
+  /// \return Index of the shard
+  public: std::size_t ShardIndex(const std::string &_sensorName) const;
+
+  /// \brief Get the shard a sensor entity was created in.
+  /// \param[in] _entity Sensor entity
+  /// \return The shard, or nullptr if no sensor was created for _entity
+  public: SensorShard *ShardOf(const Entity &_entity);
+
   /// \brief Update battery state of sensors in model
   /// \param[in] _ecm Entity component manager
   public: void UpdateBatteryState(const EntityComponentManager &_ecm);
@@ -194,6 +370,38 @@ class ignition::gazebo::systems::SensorsPrivate
   /// \return True if the sensor has subscribers, false otherwise
   public: bool HasConnections(sensors::RenderingSensor *_sensor) const;
 
+  /// \brief Start exporting the raw frames of a depth camera or GPU lidar
+  /// to shared memory. Other sensors are ignored.
+  /// \param[in] _sensor Sensor whose frames are exported
+  /// \param[in] _name Unique name of the sensor
+  /// \param[in] _shard Shard rendering the sensor
+  public: void ExportFrames(sensors::Sensor *_sensor,
+      const std::string &_name, SensorShard &_shard);
+
+  /// \brief Start publishing the images and point clouds of a camera or
+  /// depth camera to local subscribers, see LocalTopics, and to shared
+  /// memory if enabled. Other sensors are ignored.
+  /// \param[in] _sensor Sensor whose messages are published
+  /// \param[in] _type Type of the sensor
+  public: void PublishLocally(sensors::Sensor *_sensor,
+      sdf::SensorType _type);
+
+  /// \brief Connect or disconnect the point cloud callback of a depth
+  /// camera, depending on whether anyone wants its point clouds. Must be
+  /// called with sensorMaskMutex locked.
+  /// \param[in] _sensor Sensor
+  /// \param[in] _shard Shard rendering the sensor
+  public: void UpdatePointsConnection(sensors::Sensor *_sensor,
+      SensorShard &_shard);
+
+  /// \brief Whether the local messages of a sensor have readers. Must be
+  /// called with sensorMaskMutex locked.
+  /// \param[in] _id Sensor ID
+  /// \return True if there are local subscribers, or if messages are
+  /// written to shared memory or to a camera batch, whose readers can't be
+  /// counted.
+  public: bool HasLocalConnections(sensors::SensorId _id) const;
+
   /// \brief Use to optionally set the background color.
   public: std::optional<math::Color> backgroundColor;
 
@@ -221,77 +429,91 @@ class ignition::gazebo::systems::SensorsPrivate
 };
 
 //////////////////////////////////////////////////
-void SensorsPrivate::WaitForInit()
+void SensorsPrivate::WaitForInit(SensorShard &_shard)
 {
-  while (!this->initialized && this->running)
+  while (!_shard.initialized && this->running)
   {
     igndbg << "Waiting for init" << std::endl;
-    std::unique_lock<std::mutex> lock(this->renderMutex);
+    std::unique_lock<std::mutex> lock(_shard.renderMutex);
     // Wait to be ready for initialization or stopped running.
     // We need rendering sensors to be available to initialize.
-    this->renderCv.wait(lock, [this]()
+    _shard.renderCv.wait(lock, [this, &_shard]()
     {
-      return this->doInit || !this->running;
+      return _shard.doInit || !this->running;
     });
 
-    if (this->doInit)
+    if (_shard.doInit)
     {
       // Only initialize if there are rendering sensors
-      igndbg << "Initializing render context" << std::endl;
+      igndbg << "Initializing render context for shard [" << _shard.index
+             << "]" << std::endl;
+      std::lock_guard<std::mutex> initLock(this->initMutex);
+      std::lock_guard<std::mutex> engineLock(*_shard.engineMutex);
       if (this->backgroundColor)
-        this->renderUtil.SetBackgroundColor(*this->backgroundColor);
+        _shard.renderUtil.SetBackgroundColor(*this->backgroundColor);
       if (this->ambientLight)
-        this->renderUtil.SetAmbientLight(*this->ambientLight);
-      this->renderUtil.Init();
-      this->scene = this->renderUtil.Scene();
-      this->scene->SetCameraPassCountPerGpuFlush(6u);
-      this->initialized = true;
+        _shard.renderUtil.SetAmbientLight(*this->ambientLight);
+      _shard.renderUtil.Init();
+      _shard.scene = _shard.renderUtil.Scene();
+      _shard.scene->SetCameraPassCountPerGpuFlush(6u);
+      _shard.initialized = true;
     }
 
-    this->updateAvailable = false;
-    this->renderCv.notify_one();
+    _shard.updateAvailable = false;
+    _shard.renderCv.notify_one();
   }
   igndbg << "Rendering Thread initialized" << std::endl;
 }
 
 //////////////////////////////////////////////////
-void SensorsPrivate::RunOnce()
+void SensorsPrivate::RunOnce(SensorShard &_shard)
 {
-  std::unique_lock<std::mutex> lock(this->renderMutex);
-  this->renderCv.wait(lock, [this]()
+  std::unique_lock<std::mutex> lock(_shard.renderMutex);
+  _shard.renderCv.wait(lock, [this, &_shard]()
   {
-    return !this->running || this->updateAvailable;
+    return !this->running || _shard.updateAvailable;
   });
 
   if (!this->running)
     return;
 
-  if (!this->scene)
+  if (!_shard.scene)
     return;
 
-  IGN_PROFILE("SensorsPrivate::RunOnce");
+  // Only the first shard emits rendering events, so that listeners aren't
+  // called concurrently from several threads.
+  const bool emitEvents = _shard.index == 0u;
+
+  IGN_GAZEBO_PROFILE("SensorsPrivate::RunOnce");
+  std::lock_guard<std::mutex> engineLock(*_shard.engineMutex);
   {
-    IGN_PROFILE("Update");
-    this->renderUtil.Update();
+    IGN_GAZEBO_PROFILE("Update");
+    _shard.renderUtil.Update();
   }
 
-  if (!this->activeSensors.empty())
+  if (!_shard.activeSensors.empty())
   {
     // disable sensors that are out of battery or re-enable sensors that are
     // being charged
     if (this->disableOnDrainedBattery)
     {
       std::unique_lock<std::mutex> lock2(this->sensorStateMutex);
-      for (const auto &sensorIt : this->sensorStateChanged)
+      for (auto sensorIt = this->sensorStateChanged.begin();
+           sensorIt != this->sensorStateChanged.end();)
       {
+        // Other shards take care of the sensors they own
         sensors::Sensor *s =
-            this->sensorManager.Sensor(sensorIt.first);
+            _shard.sensorManager.Sensor(sensorIt->first);
         if (s)
         {
-          s->SetActive(sensorIt.second);
+          s->SetActive(sensorIt->second);
+          sensorIt = this->sensorStateChanged.erase(sensorIt);
+        }
+        else
+        {
+          ++sensorIt;
         }
       }
-      this->sensorStateChanged.clear();
     }
 
     this->sensorMaskMutex.lock();
@@ -304,33 +526,35 @@ void SensorsPrivate::RunOnce()
     // To prevent this, add sensors that are currently being rendered to
     // a mask. Sensors are removed from the mask when 90% of the update
     // delta has passed, which will allow rendering to proceed.
-    for (const auto & sensor : this->activeSensors)
+    for (const auto & sensor : _shard.activeSensors)
     {
       // 90% of update delta (1/UpdateRate());
       auto delta = std::chrono::duration_cast< std::chrono::milliseconds>(
         std::chrono::duration< double >(0.9 / sensor->UpdateRate()));
-      this->sensorMask[sensor->Id()] = this->updateTime + delta;
+      this->sensorMask[sensor->Id()] = _shard.updateTime + delta;
     }
     this->sensorMaskMutex.unlock();
 
     {
-      IGN_PROFILE("PreRender");
-      this->eventManager->Emit<events::PreRender>();
-      this->scene->SetTime(this->updateTime);
+      IGN_GAZEBO_PROFILE("PreRender");
+      if (emitEvents)
+        this->preRenderEvent->Signal();
+      _shard.scene->SetTime(_shard.updateTime);
       // Update the scene graph manually to improve performance
       // We only need to do this once per frame It is important to call
       // sensors::RenderingSensor::SetManualSceneUpdate and set it to true
       // so we don't waste cycles doing one scene graph update per sensor
-      this->scene->PreRender();
+      _shard.scene->PreRender();
     }
 
     // disable sensors that have no subscribers to prevent doing unnecessary
     // work
     std::unordered_set<sensors::RenderingSensor *> tmpDisabledSensors;
     this->sensorMaskMutex.lock();
-    for (auto id : this->sensorIds)
+    for (auto id : _shard.sensorIds)
     {
-      sensors::Sensor *s = this->sensorManager.Sensor(id);
+      sensors::Sensor *s = _shard.sensorManager.Sensor(id);
+      this->UpdatePointsConnection(s, _shard);
       auto rs = dynamic_cast<sensors::RenderingSensor *>(s);
       if (rs->IsActive() && !this->HasConnections(rs))
       {
@@ -342,8 +566,16 @@ void SensorsPrivate::RunOnce()
 
     {
       // publish data
-      IGN_PROFILE("RunOnce");
-      this->sensorManager.RunOnce(this->updateTime);
+      IGN_GAZEBO_PROFILE("RunOnce");
+      _shard.sensorManager.RunOnce(_shard.updateTime);
+
+      // Sensors that are due soon share this scene update instead of
+      // waiting for their own
+      for (auto &rs : _shard.batchedSensors)
+      {
+        if (rs->IsActive())
+          rs->Update(_shard.updateTime, true);
+      }
     }
 
     // re-enble sensors
@@ -353,43 +585,49 @@ void SensorsPrivate::RunOnce()
     }
 
     {
-      IGN_PROFILE("PostRender");
+      IGN_GAZEBO_PROFILE("PostRender");
       // Update the scene graph manually to improve performance
       // We only need to do this once per frame It is important to call
       // sensors::RenderingSensor::SetManualSceneUpdate and set it to true
       // so we don't waste cycles doing one scene graph update per sensor
-      this->scene->PostRender();
-      this->eventManager->Emit<events::PostRender>();
+      _shard.scene->PostRender();
+      if (emitEvents)
+        this->postRenderEvent->Signal();
     }
 
-    this->activeSensors.clear();
+    _shard.activeSensors.clear();
+    _shard.batchedSensors.clear();
   }
 
-  this->updateAvailable = false;
+  _shard.updateAvailable = false;
   lock.unlock();
-  this->renderCv.notify_one();
+  _shard.renderCv.notify_one();
 }
 
 //////////////////////////////////////////////////
-void SensorsPrivate::RenderThread()
+void SensorsPrivate::RenderThread(SensorShard &_shard)
 {
   IGN_PROFILE_THREAD_NAME("RenderThread");
+  setCurrentThreadName("gz-render-" + std::to_string(_shard.index));
+  setCurrentThreadAffinity(this->renderThreadCpus);
 
-  igndbg << "SensorsPrivate::RenderThread started" << std::endl;
+  igndbg << "SensorsPrivate::RenderThread started for shard ["
+         << _shard.index << "]" << std::endl;
 
   // We have to wait for rendering sensors to be available
-  this->WaitForInit();
+  this->WaitForInit(_shard);
 
   while (this->running)
   {
-    this->RunOnce();
+    this->RunOnce(_shard);
   }
 
   // clean up before exiting
-  for (const auto id : this->sensorIds)
-    this->sensorManager.Remove(id);
+  for (const auto id : _shard.sensorIds)
+    _shard.sensorManager.Remove(id);
 
-  igndbg << "SensorsPrivate::RenderThread stopped" << std::endl;
+  igndbg << "SensorsPrivate::RenderThread stopped for shard ["
+         << _shard.index << "]" << std::endl;
 }
 
 //////////////////////////////////////////////////
@@ -397,14 +635,17 @@ void SensorsPrivate::Run()
 {
   igndbg << "SensorsPrivate::Run" << std::endl;
   this->running = true;
-  this->renderThread = std::thread(&SensorsPrivate::RenderThread, this);
+  for (auto &shard : this->shards)
+  {
+    shard->renderThread = std::thread(&SensorsPrivate::RenderThread, this,
+        std::ref(*shard));
+  }
 }
 
 //////////////////////////////////////////////////
 void SensorsPrivate::Stop()
 {
   igndbg << "SensorsPrivate::Stop" << std::endl;
-  std::unique_lock<std::mutex> lock(this->renderMutex);
   this->running = false;
 
   if (this->stopConn)
@@ -413,18 +654,59 @@ void SensorsPrivate::Stop()
     this->stopConn.reset();
   }
 
-  lock.unlock();
-  this->renderCv.notify_all();
+  for (auto &shard : this->shards)
+  {
+    // Lock so that the thread can't miss the notification between checking
+    // the predicate and waiting.
+    {
+      std::lock_guard<std::mutex> lock(shard->renderMutex);
+    }
+    shard->renderCv.notify_all();
+  }
 
-  if (this->renderThread.joinable())
+  for (auto &shard : this->shards)
   {
-    this->renderThread.join();
+    if (shard->renderThread.joinable())
+    {
+      shard->renderThread.join();
+    }
   }
 }
 
+//////////////////////////////////////////////////
+std::size_t SensorsPrivate::ShardIndex(const std::string &_sensorName) const
+{
+  if (this->shards.size() <= 1u)
+    return 0u;
+
+  // FNV-1a, which unlike std::hash is the same on all platforms
+  std::uint64_t hash = 14695981039346656037ull;
+  for (const unsigned char c : _sensorName)
+  {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return static_cast<std::size_t>(hash % this->shards.size());
+}
+
+//////////////////////////////////////////////////
+SensorShard *SensorsPrivate::ShardOf(const Entity &_entity)
+{
+  std::lock_guard<std::mutex> lock(this->sensorsMutex);
+  auto it = this->entityToShard.find(_entity);
+  if (it == this->entityToShard.end())
+    return nullptr;
+  return it->second;
+}
+
 //////////////////////////////////////////////////
 void Sensors::RemoveSensor(const Entity &_entity)
 {
+  auto shard = this->dataPtr->ShardOf(_entity);
+  if (nullptr == shard)
+    return;
+
+  std::lock_guard<std::mutex> sensorsLock(this->dataPtr->sensorsMutex);
   auto idIter = this->dataPtr->entityToIdMap.find(_entity);
   if (idIter != this->dataPtr->entityToIdMap.end())
   {
@@ -433,14 +715,19 @@ void Sensors::RemoveSensor(const Entity &_entity)
     // the rendering thread is iterating over it
     {
       std::unique_lock<std::mutex> lock(this->dataPtr->sensorMaskMutex);
-      sensors::Sensor *s = this->dataPtr->sensorManager.Sensor(idIter->second);
+      sensors::Sensor *s = shard->sensorManager.Sensor(idIter->second);
       auto rs = dynamic_cast<sensors::RenderingSensor *>(s);
-      auto activeSensorIt = std::find(this->dataPtr->activeSensors.begin(),
-          this->dataPtr->activeSensors.end(), rs);
-      if (activeSensorIt != this->dataPtr->activeSensors.end())
+      auto activeSensorIt = std::find(shard->activeSensors.begin(),
+          shard->activeSensors.end(), rs);
+      if (activeSensorIt != shard->activeSensors.end())
       {
-        this->dataPtr->activeSensors.erase(activeSensorIt);
+        shard->activeSensors.erase(activeSensorIt);
       }
+      shard->batchedSensors.erase(std::remove(shard->batchedSensors.begin(),
+          shard->batchedSensors.end(), rs), shard->batchedSensors.end());
+      shard->sensorIds.erase(idIter->second);
+      this->dataPtr->exportedFrames.erase(idIter->second);
+      this->dataPtr->localMessages.erase(idIter->second);
     }
 
     // update cameras list
@@ -453,9 +740,9 @@ void Sensors::RemoveSensor(const Entity &_entity)
       }
     }
 
-    this->dataPtr->sensorIds.erase(idIter->second);
-    this->dataPtr->sensorManager.Remove(idIter->second);
+    shard->sensorManager.Remove(idIter->second);
     this->dataPtr->entityToIdMap.erase(idIter);
+    this->dataPtr->entityToShard.erase(_entity);
   }
 }
 
@@ -468,6 +755,13 @@ Sensors::Sensors() : System(), dataPtr(std::make_unique<SensorsPrivate>())
 Sensors::~Sensors()
 {
   this->dataPtr->Stop();
+
+  // Holders of the batches can keep using them
+  for (const auto &batch : this->dataPtr->cameraBatches)
+  {
+    if (CameraBatch::Find(batch->Name()) == batch)
+      CameraBatch::Remove(batch->Name());
+  }
 }
 
 //////////////////////////////////////////////////
@@ -487,6 +781,100 @@ void Sensors::Configure(const Entity &/*_id*/,
       _sdf->Get<bool>("disable_on_drained_battery",
      this->dataPtr-> disableOnDrainedBattery).first;
 
+  // get how many rendering updates can be skipped while rendering is busy
+  this->dataPtr->maxFrameLag = _sdf->Get<unsigned int>("max_frame_lag",
+      this->dataPtr->maxFrameLag).first;
+
+  // get whether geometries with identical materials share them, so the
+  // render engine can instance them
+  bool shareMaterials = _sdf->Get<bool>("share_materials", false).first;
+
+  // get whether pose updates of models outside all camera frusta are
+  // skipped, and by how much their bounding boxes are grown
+  this->dataPtr->frustumCulling =
+      _sdf->Get<bool>("frustum_culling", false).first;
+  double frustumCullingMargin =
+      _sdf->Get<double>("frustum_culling_margin", 1.0).first;
+
+  // get how far ahead sensors can be rendered to share a rendering update
+  double renderBatchWindow =
+      _sdf->Get<double>("render_batch_window", 0.0).first;
+  if (renderBatchWindow > 0.0)
+  {
+    this->dataPtr->renderBatchWindow =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(renderBatchWindow));
+  }
+
+  // get whether meshes are loaded in the background before rendering
+  this->dataPtr->preloadMeshes =
+      _sdf->Get<bool>("preload_meshes", false).first;
+  this->dataPtr->preloadThreads = _sdf->Get<unsigned int>("preload_threads",
+      this->dataPtr->preloadThreads).first;
+
+  // get which CPUs the render threads may run on
+  if (_sdf->HasElement("render_thread_cpus"))
+  {
+    const auto cpuList = _sdf->Get<std::string>("render_thread_cpus");
+    this->dataPtr->renderThreadCpus = parseCpuList(cpuList);
+    if (this->dataPtr->renderThreadCpus.empty())
+    {
+      ignerr << "Invalid <render_thread_cpus> [" << cpuList
+             << "], render threads won't be restricted." << std::endl;
+    }
+  }
+
+  // get whether raw frames are exported to shared memory
+  this->dataPtr->sharedMemoryExport =
+      _sdf->Get<bool>("shared_memory_export", false).first;
+
+  // get whether images and point clouds are written to shared memory
+  this->dataPtr->sharedMemoryMessages =
+      _sdf->Get<bool>("shared_memory_messages", false).first;
+
+  // get which cameras write their images to a shared batch buffer. Slots
+  // follow the order of the <topic> elements.
+  for (auto batchElem = _sdf->HasElement("camera_batch") ?
+      _sdf->FindElement("camera_batch") : nullptr;
+      batchElem != nullptr;
+      batchElem = batchElem->GetNextElement("camera_batch"))
+  {
+    const auto batchName = batchElem->Get<std::string>("name", "").first;
+    std::vector<std::string> topics;
+    for (auto topicElem = batchElem->HasElement("topic") ?
+        batchElem->FindElement("topic") : nullptr;
+        topicElem != nullptr;
+        topicElem = topicElem->GetNextElement("topic"))
+    {
+      topics.push_back(topicElem->Get<std::string>());
+    }
+    if (batchName.empty() || topics.empty())
+    {
+      ignerr << "Ignoring <camera_batch> without a <name> or <topic>."
+             << std::endl;
+      continue;
+    }
+
+    auto batch = CameraBatch::Create(batchName, topics.size());
+    for (std::size_t slot = 0u; slot < topics.size(); ++slot)
+    {
+      if (!this->dataPtr->batchSlots.emplace(topics[slot],
+          std::make_pair(batch, slot)).second)
+      {
+        ignerr << "Camera topic [" << topics[slot] << "] is already in a "
+               << "batch, it won't be written to batch [" << batchName
+               << "]." << std::endl;
+      }
+    }
+    this->dataPtr->cameraBatches.push_back(batch);
+    igndbg << "Writing the images of [" << topics.size()
+           << "] cameras to batch [" << batchName << "]." << std::endl;
+  }
+
+  // get whether only changed poses are synced to the rendering scenes
+  bool incrementalUpdates =
+      _sdf->Get<bool>("incremental_updates", false).first;
+
   // Get the background color, if specified.
   if (_sdf->HasElement("background_color"))
     this->dataPtr->backgroundColor = _sdf->Get<math::Color>("background_color");
@@ -495,13 +883,7 @@ void Sensors::Configure(const Entity &/*_id*/,
   if (_sdf->HasElement("ambient_light"))
     this->dataPtr->ambientLight = _sdf->Get<math::Color>("ambient_light");
 
-  this->dataPtr->renderUtil.SetEngineName(engineName);
-  this->dataPtr->renderUtil.SetEnableSensors(true,
-      std::bind(&Sensors::CreateSensor, this,
-      std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
-  this->dataPtr->renderUtil.SetRemoveSensorCb(
-      std::bind(&Sensors::RemoveSensor, this, std::placeholders::_1));
-  this->dataPtr->renderUtil.SetEventManager(&_eventMgr);
+  bool headless{false};
 
   // parse sensor-specific data
   auto worldEntity = _ecm.EntityByComponents(components::World());
@@ -522,7 +904,7 @@ void Sensors::Configure(const Entity &/*_id*/,
       _ecm.Component<components::RenderEngineServerPlugin>(worldEntity);
     if (renderEngineServerComp && !renderEngineServerComp->Data().empty())
     {
-      this->dataPtr->renderUtil.SetEngineName(renderEngineServerComp->Data());
+      engineName = renderEngineServerComp->Data();
     }
 
     // Set headless mode if specified from command line
@@ -530,12 +912,85 @@ void Sensors::Configure(const Entity &/*_id*/,
       _ecm.Component<components::RenderEngineServerHeadless>(worldEntity);
     if (renderEngineServerHeadlessComp)
     {
-      this->dataPtr->renderUtil.SetHeadlessRendering(
-        renderEngineServerHeadlessComp->Data());
+      headless = renderEngineServerHeadlessComp->Data();
+    }
+  }
+
+  // Each <render_shard> gets its own render thread and scene, and may use a
+  // different render engine.
+  std::vector<std::string> shardEngines;
+  if (_sdf->HasElement("render_shard"))
+  {
+    for (auto shardElem = _sdf->FindElement("render_shard");
+        shardElem != nullptr;
+        shardElem = shardElem->GetNextElement("render_shard"))
+    {
+      shardEngines.push_back(
+          shardElem->Get<std::string>("render_engine", engineName).first);
     }
   }
+  if (shardEngines.empty())
+    shardEngines.push_back(engineName);
+
+  // Render engines aren't thread safe, so shards that share an engine take
+  // turns using it
+  std::map<std::string, std::shared_ptr<std::mutex>> engineMutexes;
+  for (const auto &shardEngine : shardEngines)
+  {
+    auto shard = std::make_unique<SensorShard>();
+    shard->index = this->dataPtr->shards.size();
+
+    auto &engineMutex = engineMutexes[shardEngine];
+    if (!engineMutex)
+      engineMutex = std::make_shared<std::mutex>();
+    shard->engineMutex = engineMutex;
+
+    // The first shard keeps the default scene name, which other systems
+    // may look up
+    if (shard->index > 0u)
+    {
+      shard->renderUtil.SetSceneName(shard->renderUtil.SceneName() +
+          "_shard_" + std::to_string(shard->index));
+    }
+
+    auto shardPtr = shard.get();
+    shard->renderUtil.SetEngineName(shardEngine);
+    shard->renderUtil.SetHeadlessRendering(headless);
+    shard->renderUtil.SceneManager().SetShareMaterials(shareMaterials);
+    shard->renderUtil.SetIncrementalUpdates(incrementalUpdates);
+    shard->renderUtil.SetFrustumCulling(this->dataPtr->frustumCulling,
+        frustumCullingMargin);
+    shard->renderUtil.SetEnableSensors(true,
+        [this, shardPtr](const Entity &_entity, const sdf::Sensor &_sensorSdf,
+            const std::string &_parentName) -> std::string
+        {
+          // Every shard sees all sensors, but each sensor is only created
+          // in one of them
+          if (this->dataPtr->ShardIndex(_sensorSdf.Name()) != shardPtr->index)
+            return std::string();
+          return this->CreateSensor(_entity, _sensorSdf, _parentName);
+        });
+    shard->renderUtil.SetRemoveSensorCb(
+        [this, shardPtr](const Entity &_entity)
+        {
+          if (this->dataPtr->ShardOf(_entity) == shardPtr)
+            this->RemoveSensor(_entity);
+        });
+    shard->renderUtil.SetEventManager(&_eventMgr);
+    this->dataPtr->shards.push_back(std::move(shard));
+  }
+
+  if (this->dataPtr->shards.size() > 1u)
+  {
+    igndbg << "Rendering sensors in [" << this->dataPtr->shards.size()
+           << "] shards" << std::endl;
+  }
 
   this->dataPtr->eventManager = &_eventMgr;
+  this->dataPtr->preRenderEvent = _eventMgr.Handle<events::PreRender>();
+  this->dataPtr->postRenderEvent = _eventMgr.Handle<events::PostRender>();
+  this->dataPtr->meshPreloadEvent =
+      _eventMgr.Handle<events::MeshPreloadProgress>();
 
   this->dataPtr->stopConn = _eventMgr.Connect<events::Stop>(
       std::bind(&SensorsPrivate::Stop, this->dataPtr.get()));
@@ -548,11 +1003,36 @@ void Sensors::Configure(const Entity &/*_id*/,
 void Sensors::Update(const UpdateInfo &_info,
                      EntityComponentManager &_ecm)
 {
-  IGN_PROFILE("Sensors::Update");
-  std::unique_lock<std::mutex> lock(this->dataPtr->renderMutex);
-  if (this->dataPtr->running && this->dataPtr->initialized)
+  IGN_GAZEBO_PROFILE("Sensors::Update");
+
+  // Request bounding boxes for culling, the physics system keeps them up to
+  // date
+  if (this->dataPtr->frustumCulling)
+  {
+    std::vector<Entity> newModels;
+    _ecm.EachNew<components::Model>(
+        [&](const Entity &_entity, const components::Model *)->bool
+        {
+          if (!_ecm.Component<components::AxisAlignedBox>(_entity))
+            newModels.push_back(_entity);
+          return true;
+        });
+    for (const auto &model : newModels)
+      _ecm.CreateComponent(model, components::AxisAlignedBox());
+  }
+
+  for (auto &shard : this->dataPtr->shards)
   {
-    this->dataPtr->renderUtil.UpdateECM(_info, _ecm);
+    // RenderUtil guards its own data, so when frame lag is allowed don't
+    // wait for an ongoing rendering operation to finish
+    std::unique_lock<std::mutex> lock(shard->renderMutex, std::defer_lock);
+    if (this->dataPtr->maxFrameLag == 0u || !shard->initialized)
+      lock.lock();
+
+    if (this->dataPtr->running && shard->initialized)
+    {
+      shard->renderUtil.UpdateECM(_info, _ecm);
+    }
   }
 }
 
@@ -560,7 +1040,7 @@ void Sensors::Update(const UpdateInfo &_info,
 void Sensors::PostUpdate(const UpdateInfo &_info,
                          const EntityComponentManager &_ecm)
 {
-  IGN_PROFILE("Sensors::PostUpdate");
+  IGN_GAZEBO_PROFILE("Sensors::PostUpdate");
 
   // \TODO(anyone) Support rewind
   if (_info.dt < std::chrono::steady_clock::duration::zero())
@@ -570,9 +1050,14 @@ void Sensors::PostUpdate(const UpdateInfo &_info,
         << "s]. System may not work properly." << std::endl;
   }
 
+  bool renderingNeeded{false};
+  for (auto &shard : this->dataPtr->shards)
   {
-    std::unique_lock<std::mutex> lock(this->dataPtr->renderMutex);
-    if (!this->dataPtr->initialized &&
+    if (shard->initialized)
+      continue;
+
+    std::unique_lock<std::mutex> lock(shard->renderMutex);
+    if (!shard->initialized &&
         (_ecm.HasComponentType(components::Camera::typeId) ||
          _ecm.HasComponentType(components::DepthCamera::typeId) ||
          _ecm.HasComponentType(components::GpuLidar::typeId) ||
@@ -582,24 +1067,60 @@ void Sensors::PostUpdate(const UpdateInfo &_info,
          _ecm.HasComponentType(components::BoundingBoxCamera::typeId)))
     {
       igndbg << "Initialization needed" << std::endl;
-      this->dataPtr->doInit = true;
-      this->dataPtr->renderCv.notify_one();
+      shard->doInit = true;
+      shard->renderCv.notify_one();
+      renderingNeeded = true;
     }
   }
 
-  if (this->dataPtr->running && this->dataPtr->initialized)
+  // Load meshes while the rendering threads initialize, and hold the first
+  // render until they're all loaded
+  if (renderingNeeded && this->dataPtr->preloadMeshes &&
+      !this->dataPtr->meshPreloader)
   {
-    this->dataPtr->renderUtil.UpdateFromECM(_info, _ecm);
+    IGN_GAZEBO_PROFILE("Preload meshes");
+    auto &preloader = this->dataPtr->meshPreloader;
+    preloader = std::make_unique<MeshPreloader>();
+    preloader->Start(MeshPreloader::Meshes(_ecm),
+        this->dataPtr->preloadThreads);
+
+    std::size_t reported{0u};
+    while (!preloader->WaitFor(std::chrono::milliseconds(100)))
+    {
+      if (preloader->Processed() != reported)
+      {
+        reported = preloader->Processed();
+        this->dataPtr->eventManager->EmitAsync(
+            this->dataPtr->meshPreloadEvent, reported, preloader->Total());
+      }
+    }
+    this->dataPtr->eventManager->EmitAsync(this->dataPtr->meshPreloadEvent,
+        preloader->Total(), preloader->Total());
+    ignmsg << "Preloaded [" << preloader->Total() << "] meshes."
+           << std::endl;
+  }
 
-    auto time = math::durationToSecNsec(_info.simTime);
-    auto t = math::secNsecToDuration(time.first, time.second);
+  if (!this->dataPtr->running)
+    return;
+
+  auto time = math::durationToSecNsec(_info.simTime);
+  auto t = math::secNsecToDuration(time.first, time.second);
+
+  bool batteryUpdated{false};
+  for (auto &shard : this->dataPtr->shards)
+  {
+    if (!shard->initialized)
+      continue;
+
+    shard->renderUtil.UpdateFromECM(_info, _ecm);
 
     std::vector<sensors::RenderingSensor *> activeSensors;
+    std::vector<sensors::RenderingSensor *> batchedSensors;
 
     this->dataPtr->sensorMaskMutex.lock();
-    for (auto id : this->dataPtr->sensorIds)
+    for (auto id : shard->sensorIds)
     {
-      sensors::Sensor *s = this->dataPtr->sensorManager.Sensor(id);
+      sensors::Sensor *s = shard->sensorManager.Sensor(id);
       auto rs = dynamic_cast<sensors::RenderingSensor *>(s);
 
       auto it = this->dataPtr->sensorMask.find(id);
@@ -619,28 +1140,54 @@ void Sensors::PostUpdate(const UpdateInfo &_info,
       {
         activeSensors.push_back(rs);
       }
+      else if (rs && rs->NextDataUpdateTime() <=
+          t + this->dataPtr->renderBatchWindow)
+      {
+        batchedSensors.push_back(rs);
+      }
     }
     this->dataPtr->sensorMaskMutex.unlock();
 
+    // Sensors that aren't due only render along with others
+    if (activeSensors.empty())
+      batchedSensors.clear();
+
     if (!activeSensors.empty() ||
-        this->dataPtr->renderUtil.PendingSensors() > 0)
+        shard->renderUtil.PendingSensors() > 0)
     {
-      if (this->dataPtr->disableOnDrainedBattery)
+      if (this->dataPtr->disableOnDrainedBattery && !batteryUpdated)
+      {
         this->dataPtr->UpdateBatteryState(_ecm);
+        batteryUpdated = true;
+      }
+
+      // If the rendering thread is still busy with a previous update, skip
+      // this one as long as the frame lag allows. The scene will catch up
+      // with the latest state from the ECM on the next update.
+      std::unique_lock<std::mutex> lock(shard->renderMutex, std::try_to_lock);
+      if ((!lock.owns_lock() || shard->updateAvailable) &&
+          shard->skippedUpdates < this->dataPtr->maxFrameLag)
+      {
+        ++shard->skippedUpdates;
+        continue;
+      }
 
-      std::unique_lock<std::mutex> lock(this->dataPtr->renderMutex);
-      this->dataPtr->renderCv.wait(lock, [this] {
-        return !this->dataPtr->running || !this->dataPtr->updateAvailable; });
+      if (!lock.owns_lock())
+        lock.lock();
+      shard->renderCv.wait(lock, [this, &shard] {
+        return !this->dataPtr->running || !shard->updateAvailable; });
 
       if (!this->dataPtr->running)
       {
         return;
       }
 
-      this->dataPtr->activeSensors = std::move(activeSensors);
-      this->dataPtr->updateTime = t;
-      this->dataPtr->updateAvailable = true;
-      this->dataPtr->renderCv.notify_one();
+      shard->skippedUpdates = 0u;
+      shard->activeSensors = std::move(activeSensors);
+      shard->batchedSensors = std::move(batchedSensors);
+      shard->updateTime = t;
+      shard->updateAvailable = true;
+      shard->renderCv.notify_one();
     }
   }
 }
@@ -671,37 +1218,21 @@ void SensorsPrivate::UpdateBatteryState(const EntityComponentManager &_ecm)
 
   // disable sensor if parent model is out of battery or re-enable sensor
   // if battery is charging
+  std::lock_guard<std::mutex> sensorsLock(this->sensorsMutex);
   for (const auto & modelIt : this->modelBatteryStateChanged)
   {
-    // check if sensor is part of this model
-    for (const auto & sensorIt : this->entityToIdMap)
+    // update the active state of the sensors of this model, including
+    // those in nested models
+    _ecm.EachDescendant(modelIt.first, [&](Entity _descendant)
     {
-      // parent link
-      auto parentLinkComp =
-          _ecm.Component<components::ParentEntity>(sensorIt.first);
-      if (!parentLinkComp)
-        continue;
-
-      // parent model
-      auto parentModelComp = _ecm.Component<components::ParentEntity>(
-          parentLinkComp->Data());
-      if (!parentModelComp)
-        continue;
-
-      // keep going up the tree in case sensor is in a nested model
-      while (parentModelComp)
+      auto sensorIt = this->entityToIdMap.find(_descendant);
+      if (sensorIt != this->entityToIdMap.end())
       {
-        auto parentEnt = parentModelComp->Data();
-        if (parentEnt == modelIt.first)
-        {
-          std::unique_lock<std::mutex> lock(this->sensorStateMutex);
-          // sensor is part of model - update its active state
-          this->sensorStateChanged[sensorIt.second] = modelIt.second;
-          break;
-        }
-        parentModelComp = _ecm.Component<components::ParentEntity>(parentEnt);
+        std::unique_lock<std::mutex> lock(this->sensorStateMutex);
+        this->sensorStateChanged[sensorIt->second] = modelIt.second;
       }
-    }
+      return true;
+    });
   }
   this->modelBatteryStateChanged.clear();
 }
@@ -716,41 +1247,44 @@ std::string Sensors::CreateSensor(const Entity &_entity,
     return std::string();
   }
 
+  auto &shard = *this->dataPtr->shards[
+      this->dataPtr->ShardIndex(_sdf.Name())];
+
   // Create within ign-sensors
   sensors::Sensor *sensor{nullptr};
   if (_sdf.Type() == sdf::SensorType::CAMERA)
   {
-    sensor = this->dataPtr->sensorManager.CreateSensor<
+    sensor = shard.sensorManager.CreateSensor<
       sensors::CameraSensor>(_sdf);
   }
   else if (_sdf.Type() == sdf::SensorType::DEPTH_CAMERA)
   {
-    sensor = this->dataPtr->sensorManager.CreateSensor<
+    sensor = shard.sensorManager.CreateSensor<
       sensors::DepthCameraSensor>(_sdf);
   }
   else if (_sdf.Type() == sdf::SensorType::GPU_LIDAR)
   {
-    sensor = this->dataPtr->sensorManager.CreateSensor<
+    sensor = shard.sensorManager.CreateSensor<
       sensors::GpuLidarSensor>(_sdf);
   }
   else if (_sdf.Type() == sdf::SensorType::RGBD_CAMERA)
   {
-    sensor = this->dataPtr->sensorManager.CreateSensor<
+    sensor = shard.sensorManager.CreateSensor<
       sensors::RgbdCameraSensor>(_sdf);
   }
   else if (_sdf.Type() == sdf::SensorType::THERMAL_CAMERA)
   {
-    sensor = this->dataPtr->sensorManager.CreateSensor<
+    sensor = shard.sensorManager.CreateSensor<
       sensors::ThermalCameraSensor>(_sdf);
   }
   else if (_sdf.Type() == sdf::SensorType::BOUNDINGBOX_CAMERA)
   {
-    sensor = this->dataPtr->sensorManager.CreateSensor<
+    sensor = shard.sensorManager.CreateSensor<
       sensors::BoundingBoxCameraSensor>(_sdf);
   }
   else if (_sdf.Type() == sdf::SensorType::SEGMENTATION_CAMERA)
   {
-    sensor = this->dataPtr->sensorManager.CreateSensor<
+    sensor = shard.sensorManager.CreateSensor<
       sensors::SegmentationCameraSensor>(_sdf);
   }
 
@@ -763,12 +1297,17 @@ std::string Sensors::CreateSensor(const Entity &_entity,
 
   // Store sensor ID
   auto sensorId = sensor->Id();
+  std::lock_guard<std::mutex> sensorsLock(this->dataPtr->sensorsMutex);
   this->dataPtr->entityToIdMap.insert({_entity, sensorId});
-  this->dataPtr->sensorIds.insert(sensorId);
+  this->dataPtr->entityToShard[_entity] = &shard;
+  {
+    std::lock_guard<std::mutex> maskLock(this->dataPtr->sensorMaskMutex);
+    shard.sensorIds.insert(sensorId);
+  }
 
   // Set the scene so it can create the rendering sensor
   auto renderingSensor = dynamic_cast<sensors::RenderingSensor *>(sensor);
-  renderingSensor->SetScene(this->dataPtr->scene);
+  renderingSensor->SetScene(shard.scene);
   renderingSensor->SetParent(_parentName);
   renderingSensor->SetManualSceneUpdate(true);
 
@@ -838,15 +1377,269 @@ std::string Sensors::CreateSensor(const Entity &_entity,
            << " Kelvin." << std::endl;
   }
 
+  if (this->dataPtr->sharedMemoryExport)
+  {
+    this->dataPtr->ExportFrames(sensor, _parentName + "::" + _sdf.Name(),
+        shard);
+  }
+
+  this->dataPtr->PublishLocally(sensor, _sdf.Type());
+
   return sensor->Name();
 }
 
+//////////////////////////////////////////////////
+void SensorsPrivate::ExportFrames(sensors::Sensor *_sensor,
+    const std::string &_name, SensorShard &_shard)
+{
+  ExportedFrames exported;
+  exported.frame = std::make_unique<sensors_system::SharedMemoryFrame>(_name);
+
+  // Frames are written from the rendering thread while the shard renders
+  // the scene at its update time
+  auto frame = exported.frame.get();
+  auto shard = &_shard;
+  auto write = [frame, shard](const float *_data, unsigned int _width,
+      unsigned int _height, unsigned int _channels,
+      const std::string &_format)
+  {
+    frame->Write(_data, sizeof(float) * _width * _height * _channels,
+        _width, _height, _channels, _format, shard->updateTime);
+  };
+
+  if (auto lidar = dynamic_cast<sensors::GpuLidarSensor *>(_sensor))
+  {
+    exported.connection = lidar->ConnectNewLidarFrame(write);
+  }
+  else if (auto depth = dynamic_cast<sensors::DepthCameraSensor *>(_sensor))
+  {
+    if (depth->DepthCamera())
+    {
+      exported.connection = depth->DepthCamera()->ConnectNewDepthFrame(
+          [write](const float *_data, unsigned int _width,
+              unsigned int _height, unsigned int _channels,
+              const std::string &_format)
+          {
+            write(_data, _width, _height, _channels, _format);
+          });
+    }
+  }
+
+  if (!exported.connection)
+    return;
+
+  igndbg << "Exporting frames of sensor [" << _name << "] to shared memory "
+         << "segment [" << exported.frame->SegmentName() << "]." << std::endl;
+
+  std::lock_guard<std::mutex> maskLock(this->sensorMaskMutex);
+  this->exportedFrames[_sensor->Id()] = std::move(exported);
+}
+
+//////////////////////////////////////////////////
+/// \brief Bytes per channel of an image pixel format.
+/// \param[in] _format Pixel format.
+/// \return Bytes per channel.
+static unsigned int BytesPerChannel(msgs::PixelFormatType _format)
+{
+  switch (_format)
+  {
+    case msgs::PixelFormatType::L_INT16:
+    case msgs::PixelFormatType::RGB_INT16:
+    case msgs::PixelFormatType::BGR_INT16:
+    case msgs::PixelFormatType::R_FLOAT16:
+    case msgs::PixelFormatType::RGB_FLOAT16:
+      return 2u;
+    case msgs::PixelFormatType::RGB_INT32:
+    case msgs::PixelFormatType::BGR_INT32:
+    case msgs::PixelFormatType::R_FLOAT32:
+    case msgs::PixelFormatType::RGB_FLOAT32:
+      return 4u;
+    default:
+      return 1u;
+  }
+}
+
+//////////////////////////////////////////////////
+void SensorsPrivate::PublishLocally(sensors::Sensor *_sensor,
+    sdf::SensorType _type)
+{
+  // Both kinds of sensors publish images on their topic
+  sensors::DepthCameraSensor *depth{nullptr};
+  sensors::CameraSensor *camera{nullptr};
+  if (_type == sdf::SensorType::DEPTH_CAMERA)
+    depth = dynamic_cast<sensors::DepthCameraSensor *>(_sensor);
+  else if (_type == sdf::SensorType::CAMERA)
+    camera = dynamic_cast<sensors::CameraSensor *>(_sensor);
+  if (nullptr == depth && nullptr == camera)
+    return;
+
+  LocalMessages local;
+  local.imageTopic = _sensor->Topic();
+  if (nullptr != depth)
+    local.pointsTopic = _sensor->Topic() + "/points";
+
+  if (this->sharedMemoryMessages)
+  {
+    local.imageFrame = std::make_unique<sensors_system::SharedMemoryFrame>(
+        local.imageTopic);
+    if (!local.pointsTopic.empty())
+    {
+      local.pointsFrame =
+          std::make_unique<sensors_system::SharedMemoryFrame>(
+          local.pointsTopic);
+    }
+  }
+
+  auto batchIt = this->batchSlots.find(local.imageTopic);
+  if (batchIt != this->batchSlots.end())
+  {
+    local.batch = batchIt->second.first;
+    local.batchSlot = batchIt->second.second;
+  }
+
+  // Images are copied once for all local subscribers. The sensor still
+  // publishes its own message on ign-transport, which only serializes it
+  // for subscribers in other processes.
+  auto frame = local.imageFrame.get();
+  auto topic = local.imageTopic;
+  auto batch = local.batch;
+  auto slot = local.batchSlot;
+  auto onImage = [frame, topic, batch, slot](const msgs::Image &_msg)
+  {
+    if (LocalTopics::HasSubscribers(topic))
+      LocalTopics::Publish(topic, std::make_shared<msgs::Image>(_msg));
+
+    if ((nullptr == frame && nullptr == batch) || _msg.width() == 0u)
+      return;
+
+    const auto channels = _msg.step() / _msg.width() /
+        BytesPerChannel(_msg.pixel_format_type());
+    const auto format = msgs::PixelFormatType_Name(_msg.pixel_format_type());
+    const auto stamp = msgs::Convert(_msg.header().stamp());
+    if (nullptr != frame)
+    {
+      frame->Write(_msg.data().data(), _msg.data().size(), _msg.width(),
+          _msg.height(), channels, format, stamp);
+    }
+    if (nullptr != batch)
+    {
+      batch->Write(slot, _msg.data().data(), _msg.data().size(),
+          _msg.width(), _msg.height(), channels, format, stamp);
+    }
+  };
+
+  if (nullptr != depth)
+    local.imageConnection = depth->ConnectImageCallback(onImage);
+  else
+    local.imageConnection = camera->ConnectImageCallback(onImage);
+
+  if (!local.imageConnection)
+    return;
+
+  if (local.imageFrame)
+  {
+    igndbg << "Writing messages of sensor [" << _sensor->Name()
+           << "] to shared memory segment ["
+           << local.imageFrame->SegmentName() << "]." << std::endl;
+  }
+
+  std::lock_guard<std::mutex> maskLock(this->sensorMaskMutex);
+  this->localMessages[_sensor->Id()] = std::move(local);
+}
+
+//////////////////////////////////////////////////
+void SensorsPrivate::UpdatePointsConnection(sensors::Sensor *_sensor,
+    SensorShard &_shard)
+{
+  if (nullptr == _sensor)
+    return;
+
+  auto it = this->localMessages.find(_sensor->Id());
+  if (it == this->localMessages.end() || it->second.pointsTopic.empty())
+    return;
+
+  auto &local = it->second;
+  const bool wanted = local.pointsFrame ||
+      LocalTopics::HasSubscribers(local.pointsTopic);
+  if (!wanted)
+  {
+    local.pointsConnection.reset();
+    return;
+  }
+  if (local.pointsConnection)
+    return;
+
+  auto depth = dynamic_cast<sensors::DepthCameraSensor *>(_sensor);
+  if (nullptr == depth || !depth->DepthCamera())
+    return;
+
+  // Point clouds are built from the camera's XYZRGB frames, so they're only
+  // computed while someone reads them. Frames are written from the
+  // rendering thread while the shard renders the scene at its update time.
+  auto frame = local.pointsFrame.get();
+  auto topic = local.pointsTopic;
+  auto frameId = depth->FrameId();
+  auto shard = &_shard;
+  local.pointsConnection = depth->DepthCamera()->ConnectNewRgbPointCloud(
+      [frame, topic, frameId, shard](const float *_data,
+          unsigned int _width, unsigned int _height,
+          unsigned int _channels, const std::string &/*_format*/)
+      {
+        const auto stamp = shard->updateTime;
+        const std::size_t size = sizeof(float) * _width * _height * _channels;
+        if (nullptr != frame)
+        {
+          frame->Write(_data, size, _width, _height, _channels,
+              "XYZRGB_FLOAT32", stamp);
+        }
+
+        if (!LocalTopics::HasSubscribers(topic))
+          return;
+
+        auto msg = std::make_shared<msgs::PointCloudPacked>();
+        msgs::InitPointCloudPacked(*msg, frameId, true,
+            {{"xyz", msgs::PointCloudPacked::Field::FLOAT32},
+             {"rgb", msgs::PointCloudPacked::Field::FLOAT32}});
+        if (msg->point_step() != sizeof(float) * _channels)
+          return;
+
+        *msg->mutable_header()->mutable_stamp() = msgs::Convert(stamp);
+        msg->set_width(_width);
+        msg->set_height(_height);
+        msg->set_row_step(msg->point_step() * _width);
+        msg->set_is_dense(true);
+        msg->set_data(reinterpret_cast<const char *>(_data), size);
+        LocalTopics::Publish(topic, msg);
+      });
+}
+
+//////////////////////////////////////////////////
+bool SensorsPrivate::HasLocalConnections(sensors::SensorId _id) const
+{
+  auto it = this->localMessages.find(_id);
+  if (it == this->localMessages.end())
+    return false;
+
+  const auto &local = it->second;
+  return local.imageFrame || local.pointsFrame || local.batch ||
+      LocalTopics::HasSubscribers(local.imageTopic) ||
+      (!local.pointsTopic.empty() &&
+      LocalTopics::HasSubscribers(local.pointsTopic));
+}
+
 //////////////////////////////////////////////////
 bool SensorsPrivate::HasConnections(sensors::RenderingSensor *_sensor) const
 {
   if (!_sensor)
     return true;
 
+  // Shared memory readers can't be counted, so always render
+  if (this->exportedFrames.find(_sensor->Id()) != this->exportedFrames.end())
+    return true;
+
+  if (this->HasLocalConnections(_sensor->Id()))
+    return true;
+
   // \todo(iche033) Remove this function once a virtual
   // sensors::RenderingSensor::HasConnections function is available
   {
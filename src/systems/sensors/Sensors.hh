@@ -50,6 +50,91 @@ namespace systems
   /// - `<disable_on_drained_battery>` Disable sensors if the model's
   /// battery plugin charge reaches zero. Sensors that are in nested
   /// models are also affected.
+  /// - `<max_frame_lag>` Number of consecutive rendering updates that may
+  /// be skipped while the rendering thread is still busy with a previous
+  /// one, instead of blocking the simulation. Sensors skipped this way
+  /// render on a later update, using the world state of that update. Their
+  /// messages are stamped with the simulation time the scene was rendered
+  /// at, so a subscriber can tell how stale data is by comparing the stamp
+  /// against the clock. Defaults to 0, which keeps rendering in lockstep
+  /// with simulation.
+  /// - `<share_materials>` True to have visuals with identical materials
+  /// share a single material, which lets render engines such as ogre2
+  /// instance repeated geometries and cuts draw calls in scenes with many
+  /// copies of the same model. Visual plugins that modify materials in
+  /// place will affect all visuals sharing them. Defaults to false.
+  /// - `<incremental_updates>` True to only copy the poses of entities
+  /// that were marked as changed to the rendering scene each update,
+  /// instead of the poses of all entities, which is much cheaper in large
+  /// worlds where few entities move. Poses modified by systems that don't
+  /// call SetChanged won't be rendered. Defaults to false.
+  /// - `<frustum_culling>` True to skip pose updates of models that are
+  /// outside the view of all cameras, which saves scene graph updates when
+  /// narrow cameras look at large worlds. Bounding boxes are computed by
+  /// the physics system from collisions. Nothing is culled while there are
+  /// lidars or cameras wider than 180 degrees. Defaults to false.
+  /// - `<frustum_culling_margin>` Distance in meters bounding boxes are
+  /// grown by on each side before culling, to account for visuals larger
+  /// than collisions. Defaults to 1.
+  /// - `<render_batch_window>` Time in seconds. When sensors are rendered,
+  /// others which are due within this time are rendered in the same
+  /// rendering update, sharing its scene update, instead of waking up the
+  /// rendering thread for another update shortly after. This helps when
+  /// sensors have rates that don't line up, like 20 and 30 Hz. Batched
+  /// sensors keep their rate, but their data is stamped up to this much
+  /// earlier than it would otherwise be. Defaults to 0, which disables
+  /// batching.
+  /// - `<preload_meshes>` True to load all meshes used by the world on
+  /// background threads before the first render, instead of loading each
+  /// one when its visual is first created. Simulation waits for loading to
+  /// finish, and progress is reported through the
+  /// events::MeshPreloadProgress event. Meshes of models spawned later are
+  /// still loaded on first use. Defaults to false.
+  /// - `<preload_threads>` Number of threads used to preload meshes.
+  /// Defaults to 0, which uses one per hardware thread.
+  /// - `<shared_memory_export>` True to also write the raw frames of depth
+  /// cameras and GPU lidars to POSIX shared memory, so consumers on the
+  /// same machine can read them in place instead of deserializing
+  /// messages. There's one segment per sensor, named `/ign_gazebo_`
+  /// followed by the sensor's scoped name with non alphanumeric characters
+  /// replaced by underscores. Each segment starts with a header described
+  /// in SharedMemoryFrame.hh. Exported sensors render even without
+  /// subscribers. Not available on Windows. Defaults to false.
+  /// - `<shared_memory_messages>` True to also write the images of cameras
+  /// and depth cameras, and the point clouds of depth cameras, to POSIX
+  /// shared memory. Segments are named like above after the topics, such
+  /// as `<topic>` and `<topic>/points`. Images keep their pixel format and
+  /// point clouds have 4 floats per point, XYZ and packed RGB. Written
+  /// sensors render even without subscribers. Defaults to false.
+  ///
+  /// - `<camera_batch>` Can be repeated. Writes the images of a group of
+  /// cameras or depth cameras into one contiguous buffer, see CameraBatch,
+  /// which code in the same process, such as the Python bindings, reads
+  /// as a single array once all cameras rendered a frame at the same
+  /// simulation time. All cameras must have the same image size and
+  /// format. Batched cameras render even without subscribers.
+  ///   - `<name>` Name the batch is looked up by.
+  ///   - `<topic>` Repeated, image topic of each camera. Cameras are stored
+  ///   in the order of their topics.
+  ///
+  /// Regardless of the parameters, plugins in the same process can receive
+  /// the images and point clouds of cameras and depth cameras by shared
+  /// pointer through LocalTopics, on the same topics as ign-transport.
+  /// Sensors render for those subscribers too.
+  /// - `<render_shard>` Can be repeated. Each shard renders a subset of the
+  /// rendering sensors into its own scene, from its own thread. Sensors are
+  /// assigned to shards based on a hash of their scoped names, so the
+  /// assignment is the same across runs. Shards that share a render engine
+  /// take turns rendering, because render engines aren't thread safe, so
+  /// sharding only pays off when shards use different engines, for example
+  /// one per GPU. Only the first shard emits rendering events. When
+  /// omitted, there's a single shard.
+  ///   - `<render_engine>` Render engine used by the shard. Defaults to
+  ///   the system's render engine.
+  /// - `<render_thread_cpus>` CPUs the render threads are restricted to, in
+  /// the Linux format, such as `0-3,8`. Useful to keep rendering on the
+  /// NUMA node closest to the GPU. Only supported on Linux. Defaults to
+  /// no restriction.
   ///
   /// \TODO(louise) Have one system for all sensors, or one per
   /// sensor / sensor type?
@@ -83,7 +168,7 @@ namespace systems
     /// \param[in] _entity Entity of the sensor
     /// \param[in] _sdf SDF description of the sensor
     /// \param[in] _parentName Name of parent that the sensor is attached to
-    /// \return Sensor name
+    /// \return Sensor name, empty if the sensor couldn't be created
     private : std::string CreateSensor(const Entity &_entity,
                                        const sdf::Sensor &_sdf,
                                        const std::string &_parentName);
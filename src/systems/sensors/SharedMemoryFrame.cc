@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "SharedMemoryFrame.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/math/Helpers.hh>
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems::sensors_system;
+
+/// \brief Version of the segment layout, bump when SharedFrameHeader changes.
+static const uint32_t kVersion{1u};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+    "Frame sequence must be lock free to be shared across processes");
+
+//////////////////////////////////////////////////
+SharedMemoryFrame::SharedMemoryFrame(const std::string &_name)
+{
+  // Segment names can't contain slashes after the first character
+  std::string sanitized = _name;
+  std::replace_if(sanitized.begin(), sanitized.end(),
+      [](unsigned char _c) { return !std::isalnum(_c); }, '_');
+  this->segmentName = "/ign_gazebo_" + sanitized;
+}
+
+//////////////////////////////////////////////////
+SharedMemoryFrame::~SharedMemoryFrame()
+{
+#ifndef _WIN32
+  if (nullptr != this->header)
+  {
+    munmap(this->header, this->mappedSize);
+    shm_unlink(this->segmentName.c_str());
+  }
+#endif
+}
+
+//////////////////////////////////////////////////
+bool SharedMemoryFrame::Open(std::size_t _dataSize)
+{
+#ifdef _WIN32
+  (void)_dataSize;
+  ignerr << "Shared memory export isn't supported on Windows." << std::endl;
+  return false;
+#else
+  int fd = shm_open(this->segmentName.c_str(), O_CREAT | O_RDWR, 0644);
+  if (fd < 0)
+  {
+    ignerr << "Failed to open shared memory segment [" << this->segmentName
+           << "]: " << std::strerror(errno) << std::endl;
+    return false;
+  }
+
+  std::size_t size = sizeof(SharedFrameHeader) + _dataSize;
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+  {
+    ignerr << "Failed to resize shared memory segment ["
+           << this->segmentName << "]: " << std::strerror(errno)
+           << std::endl;
+    close(fd);
+    shm_unlink(this->segmentName.c_str());
+    return false;
+  }
+
+  void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  // The mapping stays valid after closing the descriptor
+  close(fd);
+  if (MAP_FAILED == addr)
+  {
+    ignerr << "Failed to map shared memory segment [" << this->segmentName
+           << "]: " << std::strerror(errno) << std::endl;
+    shm_unlink(this->segmentName.c_str());
+    return false;
+  }
+
+  this->header = new (addr) SharedFrameHeader();
+  std::memcpy(this->header->magic, "IGNF", 4);
+  this->header->version = kVersion;
+  this->header->sequence.store(0u, std::memory_order_relaxed);
+  this->header->dataSize = 0u;
+  this->mappedSize = size;
+
+  ignmsg << "Exporting frames to shared memory segment ["
+         << this->segmentName << "]." << std::endl;
+  return true;
+#endif
+}
+
+//////////////////////////////////////////////////
+bool SharedMemoryFrame::Write(const void *_data, std::size_t _size,
+    unsigned int _width, unsigned int _height, unsigned int _channels,
+    const std::string &_format,
+    const std::chrono::steady_clock::duration &_stamp)
+{
+  IGN_PROFILE("SharedMemoryFrame::Write");
+  if (nullptr == _data || this->failed)
+    return false;
+
+  if (nullptr == this->header && !this->Open(_size))
+  {
+    this->failed = true;
+    return false;
+  }
+
+  if (sizeof(SharedFrameHeader) + _size > this->mappedSize)
+  {
+    ignerr << "Frame of [" << _size << "] bytes doesn't fit in shared memory "
+           << "segment [" << this->segmentName << "], dropping it."
+           << std::endl;
+    return false;
+  }
+
+  // Odd sequence while writing, see SharedFrameHeader
+  auto seq = this->header->sequence.load(std::memory_order_relaxed);
+  this->header->sequence.store(seq + 1u, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  auto secNsec = math::durationToSecNsec(_stamp);
+  this->header->sec = secNsec.first;
+  this->header->nsec = secNsec.second;
+  this->header->width = _width;
+  this->header->height = _height;
+  this->header->channels = _channels;
+  this->header->dataSize = _size;
+  std::memset(this->header->format, 0, sizeof(this->header->format));
+  std::strncpy(this->header->format, _format.c_str(),
+      sizeof(this->header->format) - 1u);
+  std::memcpy(reinterpret_cast<unsigned char *>(this->header) +
+      sizeof(SharedFrameHeader), _data, _size);
+
+  this->header->sequence.store(seq + 2u, std::memory_order_release);
+  return true;
+}
+
+//////////////////////////////////////////////////
+const std::string &SharedMemoryFrame::SegmentName() const
+{
+  return this->segmentName;
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_SENSORS_SHARED_MEMORY_FRAME_HH_
+#define IGNITION_GAZEBO_SYSTEMS_SENSORS_SHARED_MEMORY_FRAME_HH_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ignition/gazebo/config.hh"
+
+namespace ignition::gazebo
+{
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems::sensors_system
+{
+  /// \brief Layout of the start of a shared memory segment written by
+  /// SharedMemoryFrame. The frame's raw data follows right after it.
+  ///
+  /// Readers should copy `sequence`, then the header fields and the data,
+  /// then check that `sequence` is even and hasn't changed. Otherwise the
+  /// frame was being overwritten and should be read again.
+  struct SharedFrameHeader
+  {
+    /// \brief Always "IGNF", to identify segments.
+    char magic[4];
+
+    /// \brief Version of this layout.
+    uint32_t version;
+
+    /// \brief Incremented before and after each frame is written, so it's
+    /// odd while a frame is being written.
+    std::atomic<uint64_t> sequence;
+
+    /// \brief Seconds of the simulation time the frame was rendered at.
+    int64_t sec;
+
+    /// \brief Nanoseconds of the simulation time the frame was rendered at.
+    int64_t nsec;
+
+    /// \brief Frame width.
+    uint32_t width;
+
+    /// \brief Frame height.
+    uint32_t height;
+
+    /// \brief Number of channels per pixel or ray.
+    uint32_t channels;
+
+    /// \brief Unused, keeps the data aligned.
+    uint32_t reserved;
+
+    /// \brief Size of the frame's data in bytes.
+    uint64_t dataSize;
+
+    /// \brief Pixel format, such as "FLOAT32", null terminated.
+    char format[32];
+  };
+
+  /// \brief Publishes the raw frames of a sensor through a POSIX shared
+  /// memory segment, so consumers on the same machine can read them in
+  /// place instead of deserializing messages received over ign-transport.
+  ///
+  /// The segment is created the first time a frame is written, sized to
+  /// fit that frame, and unlinked on destruction. Frames larger than the
+  /// first one are dropped. Not supported on Windows.
+  class SharedMemoryFrame
+  {
+    /// \brief Constructor
+    /// \param[in] _name Unique name used to derive the segment's name.
+    public: explicit SharedMemoryFrame(const std::string &_name);
+
+    /// \brief Destructor. Unmaps and unlinks the segment.
+    public: ~SharedMemoryFrame();
+
+    /// \brief Copy a frame into the segment.
+    /// \param[in] _data Frame data.
+    /// \param[in] _size Size of the data in bytes.
+    /// \param[in] _width Frame width.
+    /// \param[in] _height Frame height.
+    /// \param[in] _channels Number of channels.
+    /// \param[in] _format Pixel format.
+    /// \param[in] _stamp Simulation time the frame was rendered at.
+    /// \return True if the frame was written.
+    public: bool Write(const void *_data, std::size_t _size,
+        unsigned int _width, unsigned int _height, unsigned int _channels,
+        const std::string &_format,
+        const std::chrono::steady_clock::duration &_stamp);
+
+    /// \brief Name of the shared memory segment, which consumers pass to
+    /// shm_open.
+    /// \return Segment name, starting with a slash.
+    public: const std::string &SegmentName() const;
+
+    /// \brief Create and map the segment.
+    /// \param[in] _dataSize Bytes reserved for frame data.
+    /// \return True if successful.
+    private: bool Open(std::size_t _dataSize);
+
+    /// \brief Name of the shared memory segment.
+    private: std::string segmentName;
+
+    /// \brief Mapped segment, null until the first frame is written.
+    private: SharedFrameHeader *header{nullptr};
+
+    /// \brief Size of the mapped segment in bytes.
+    private: std::size_t mappedSize{0u};
+
+    /// \brief True if opening the segment failed, so it's not retried.
+    private: bool failed{false};
+  };
+}
+}
+}
+
+#endif
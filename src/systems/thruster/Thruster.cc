@@ -18,6 +18,7 @@
 #include <mutex>
 #include <limits>
 #include <string>
+#include <vector>
 
 #include <ignition/msgs/double.pb.h>
 
@@ -28,7 +29,6 @@
 #include <ignition/transport/Node.hh>
 
 #include "ignition/gazebo/components/AngularVelocity.hh"
-#include "ignition/gazebo/components/BatterySoC.hh"
 #include "ignition/gazebo/components/BatteryPowerLoad.hh"
 #include "ignition/gazebo/components/ChildLinkName.hh"
 #include "ignition/gazebo/components/JointAxis.hh"
@@ -37,6 +37,7 @@
 #include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/World.hh"
+#include "ignition/gazebo/BatteryTable.hh"
 #include "ignition/gazebo/Link.hh"
 #include "ignition/gazebo/Model.hh"
 #include "ignition/gazebo/Util.hh"
@@ -67,6 +68,10 @@ class ignition::gazebo::systems::ThrusterPrivateData
   /// \brief The link entity which will spin
   public: ignition::gazebo::Entity linkEntity;
 
+  /// \brief Demands for the velocities of the link, which are read on
+  /// every update
+  public: std::vector<ComponentDemand> linkDemands;
+
   /// \brief Battery consumer entity
   public: Entity consumerEntity;
 
@@ -140,6 +145,9 @@ class ignition::gazebo::systems::ThrusterPrivateData
   /// \brief Has the battery consumption being initialized.
   public: bool batteryInitialized = false;
 
+  /// \brief Batteries of the world, shared with other systems.
+  public: std::shared_ptr<BatteryTable> batteries;
+
   /// \brief Callback for handling thrust update
   public: void OnCmdThrust(const msgs::Double &_msg);
 
@@ -173,6 +181,7 @@ void Thruster::Configure(
 {
   // Create model object, to access convenient functions
   this->dataPtr->modelEntity = _entity;
+  this->dataPtr->batteries = BatteryTable::For(_ecm);
   auto model = Model(_entity);
   auto modelName = model.Name(_ecm);
 
@@ -303,11 +312,13 @@ void Thruster::Configure(
   this->dataPtr->linkEntity = model.LinkByName(_ecm, childLink->Data());
 
   // Create necessary components if not present.
-  enableComponent<components::AngularVelocity>(_ecm, this->dataPtr->linkEntity);
-  enableComponent<components::WorldAngularVelocity>(_ecm,
-      this->dataPtr->linkEntity);
-  enableComponent<ignition::gazebo::components::WorldLinearVelocity>(_ecm,
-      this->dataPtr->linkEntity);
+  auto &demands = this->dataPtr->linkDemands;
+  demands.push_back(_ecm.DemandComponent<components::AngularVelocity>(
+      this->dataPtr->linkEntity));
+  demands.push_back(_ecm.DemandComponent<components::WorldAngularVelocity>(
+      this->dataPtr->linkEntity));
+  demands.push_back(_ecm.DemandComponent<components::WorldLinearVelocity>(
+      this->dataPtr->linkEntity));
 
   double minThrustCmd = this->dataPtr->cmdMin;
   double maxThrustCmd = this->dataPtr->cmdMax;
@@ -442,22 +453,7 @@ void ThrusterPrivateData::UpdateThrustCoefficient()
 bool ThrusterPrivateData::HasSufficientBattery(
   const EntityComponentManager &_ecm) const
 {
-  bool result = true;
-  _ecm.Each<components::BatterySoC>([&](
-    const Entity &_entity,
-    const components::BatterySoC *_data
-  ){
-    if(_ecm.ParentEntity(_entity) == this->modelEntity)
-    {
-      if(_data->Data() <= 0)
-      {
-        result = false;
-      }
-    }
-
-    return true;
-  });
-  return result;
+  return this->batteries->HasCharge(this->modelEntity, _ecm);
 }
 
 /////////////////////////////////////////////////
@@ -480,20 +476,12 @@ void Thruster::PreUpdate(
     this->dataPtr->batteryInitialized = true;
 
     // Check that a battery exists with the specified name
-    Entity batteryEntity;
-    int numBatteriesWithName = 0;
-    _ecm.Each<components::BatterySoC, components::Name>(
-      [&](const Entity &_entity,
-        const components::BatterySoC */*_BatterySoC*/,
-        const components::Name *_name)->bool
-      {
-        if (this->dataPtr->batteryName == _name->Data())
-        {
-          ++numBatteriesWithName;
-          batteryEntity = _entity;
-        }
-        return true;
-      });
+    this->dataPtr->batteries->Update(_info, _ecm);
+    auto batteriesWithName =
+        this->dataPtr->batteries->BatteriesByName(this->dataPtr->batteryName);
+    auto numBatteriesWithName = batteriesWithName.size();
+    Entity batteryEntity =
+        batteriesWithName.empty() ? kNullEntity : batteriesWithName.back();
     if (numBatteriesWithName == 0)
     {
       ignerr << "Can't assign battery consumption to battery: ["
@@ -583,9 +571,10 @@ void Thruster::PreUpdate(
 }
 
 /////////////////////////////////////////////////
-void Thruster::PostUpdate(const UpdateInfo &/*unused*/,
+void Thruster::PostUpdate(const UpdateInfo &_info,
   const EntityComponentManager &_ecm)
 {
+  this->dataPtr->batteries->Update(_info, _ecm);
   this->dataPtr->enabled = this->dataPtr->HasSufficientBattery(_ecm);
 }
 
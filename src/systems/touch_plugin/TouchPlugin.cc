@@ -29,6 +29,7 @@
 #include <sdf/Element.hh>
 
 #include "ignition/gazebo/components/ContactSensor.hh"
+#include "ignition/gazebo/components/ContactPoints.hh"
 #include "ignition/gazebo/components/ContactSensorData.hh"
 #include "ignition/gazebo/components/Collision.hh"
 #include "ignition/gazebo/components/Link.hh"
@@ -138,8 +139,8 @@ void TouchPluginPrivate::Load(const EntityComponentManager &_ecm,
   this->AddTargetEntities(_ecm, potentialEntities);
 
   // Create a list of collision entities that have been marked as contact
-  // sensors in this model. These are collisions that have a ContactSensorData
-  // component
+  // sensors in this model. These are collisions that have a ContactPoints or
+  // ContactSensorData component
   auto allLinks =
       _ecm.ChildrenByComponents(this->model.Entity(), components::Link());
 
@@ -150,6 +151,8 @@ void TouchPluginPrivate::Load(const EntityComponentManager &_ecm,
     for (const Entity colEntity : linkCollisions)
     {
       if (_ecm.EntityHasComponentType(colEntity,
+                                      components::ContactPoints::typeId) ||
+          _ecm.EntityHasComponentType(colEntity,
                                       components::ContactSensorData::typeId))
       {
         this->collisionEntities.push_back(colEntity);
@@ -258,6 +261,21 @@ void TouchPluginPrivate::Update(const UpdateInfo &_info,
   // between the target entity and this model
   for (const Entity colEntity : this->collisionEntities)
   {
+    auto *points = _ecm.Component<components::ContactPoints>(colEntity);
+    if (points)
+    {
+      for (const auto &point : points->Data())
+      {
+        if (std::binary_search(this->targetEntities.begin(),
+            this->targetEntities.end(), point.collision2))
+        {
+          touching = true;
+          break;
+        }
+      }
+      continue;
+    }
+
     auto *contacts = _ecm.Component<components::ContactSensorData>(colEntity);
     if (contacts)
     {
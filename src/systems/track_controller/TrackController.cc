@@ -17,11 +17,12 @@
 
 #include "TrackController.hh"
 
+#include <algorithm>
 #include <limits>
 #include <mutex>
+#include <optional>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 #include <ignition/msgs/double.pb.h>
 #include <ignition/msgs/marker.pb.h>
@@ -55,6 +56,18 @@ class ignition::gazebo::systems::TrackControllerPrivate
   public: void RegisterCollision(EntityComponentManager& _ecm,
     const Entity& _entity, const Entity& _link);
 
+  /// \brief Find a collision of the track.
+  /// \param[in] _entity Collision entity.
+  /// \return Index of the collision in trackCollisions, or nullopt if it
+  /// isn't part of the track.
+  public: std::optional<std::size_t> CollisionIndex(
+    const Entity& _entity) const;
+
+  /// \brief Update the cached world poses of the link and its collisions,
+  /// if the link moved since they were last updated.
+  /// \param[in] _ecm Entity Component Manager
+  public: void UpdatePoses(const EntityComponentManager& _ecm);
+
   /// \brief Set velocity command to the track.
   /// \param[in] _msg The command.
   public: void OnCmdVel(const msgs::Double& _msg);
@@ -132,13 +145,22 @@ class ignition::gazebo::systems::TrackControllerPrivate
   public: Model model;
   /// \brief Entity of the link this track is attached to.
   public: Entity linkEntity {kNullEntity};
-  /// \brief Entities of all collision elements of the track's link.
-  public: std::unordered_set<Entity> trackCollisions;
+  /// \brief Sorted entities of all collision elements of the track's link.
+  /// Every contact in the world is checked against them, so they're kept
+  /// in a flat table rather than a hash set.
+  public: std::vector<Entity> trackCollisions;
 
   /// \brief World pose of the track's link.
   public: math::Pose3d linkWorldPose;
-  /// \brief World poses of all collision elements of the track's link.
-  public: std::unordered_map<Entity, math::Pose3d> collisionsWorldPose;
+  /// \brief World poses of all collision elements of the track's link, in
+  /// the same order as trackCollisions.
+  public: std::vector<math::Pose3d> collisionsWorldPose;
+  /// \brief Whether collisionsWorldPose has to be recomputed even if the
+  /// link didn't move, such as when a collision was added.
+  public: bool collisionPosesDirty {true};
+  /// \brief Y axis of the track in world coordinates, updated with the
+  /// link pose.
+  public: math::Vector3d trackYAxisGlobal {math::Vector3d::UnitY};
 
   /// \brief The last commanded velocity.
   public: double velocity {0};
@@ -151,6 +173,10 @@ class ignition::gazebo::systems::TrackControllerPrivate
   /// \brief The point around which the track circles (in world coords). Should
   /// be set to +Inf if the track is going straight.
   public: math::Vector3d centerOfRotation {math::Vector3d::Zero * math::INF_D};
+  /// \brief Copy of centerOfRotation taken at the start of the step, so that
+  /// contacts don't need to lock cmdMutex.
+  public: math::Vector3d stepCenterOfRotation
+    {math::Vector3d::Zero * math::INF_D};
   /// \brief protects velocity and centerOfRotation
   public: std::mutex cmdMutex;
 
@@ -392,11 +418,7 @@ void TrackController::PreUpdate(
     return;
   }
 
-  // Cache poses
-  this->dataPtr->linkWorldPose = worldPose(this->dataPtr->linkEntity, _ecm);
-  for (auto& collisionEntity : this->dataPtr->trackCollisions)
-    this->dataPtr->collisionsWorldPose[collisionEntity] =
-      worldPose(collisionEntity, _ecm);
+  this->dataPtr->UpdatePoses(_ecm);
 
   std::chrono::steady_clock::duration lastCommandTimeCopy;
   {
@@ -407,6 +429,7 @@ void TrackController::PreUpdate(
       this->dataPtr->hasNewCommand = false;
     }
     lastCommandTimeCopy = this->dataPtr->lastCommandTime;
+    this->dataPtr->stepCenterOfRotation = this->dataPtr->centerOfRotation;
 
     // Compute limited velocity command
     this->dataPtr->limitedVelocity = this->dataPtr->velocity;
@@ -456,46 +479,33 @@ void TrackControllerPrivate::ComputeSurfaceProperties(
     return;
   }
 
-  const auto isCollision1Track = this->trackCollisions.find(_collision1) !=
-    this->trackCollisions.end();
-  const auto isCollision2Track = this->trackCollisions.find(_collision2) !=
-    this->trackCollisions.end();
-  if (!isCollision1Track && !isCollision2Track)
+  auto trackIndex = this->CollisionIndex(_collision1);
+  const auto isCollision1Track = trackIndex.has_value();
+  if (!isCollision1Track)
+    trackIndex = this->CollisionIndex(_collision2);
+  if (!trackIndex)
     return;
 
-  const auto trackCollision = isCollision1Track ? _collision1 : _collision2;
-
   auto contactNormal = _normal.value();
 
   // In case we have not yet cached the collision pose, skip this iteration
-  if (this->collisionsWorldPose.find(trackCollision) ==
-      this->collisionsWorldPose.end())
+  if (this->collisionPosesDirty)
     return;
-  const auto& collisionPose = this->collisionsWorldPose[trackCollision];
+  const auto& collisionPose = this->collisionsWorldPose[*trackIndex];
 
   // Flip the contact normal if it points outside the track collision
   if (contactNormal.Dot(collisionPose.Pos() - _point) < 0)
     contactNormal = -contactNormal;
 
-  const auto trackWorldRot = this->linkWorldPose.Rot() * this->trackOrientation;
-  const auto trackYAxisGlobal =
-    trackWorldRot.RotateVector(math::Vector3d::UnitY);
-
   // Vector tangent to the belt pointing in the belt's movement direction
   // The belt's bottom moves backwards when the robot should move forward!
-  auto beltDirection = contactNormal.Cross(trackYAxisGlobal);
+  auto beltDirection = contactNormal.Cross(this->trackYAxisGlobal);
 
   if (this->limitedVelocity < 0)
     beltDirection = -beltDirection;
 
-  math::Vector3d cor;
-  {
-    std::lock_guard<std::mutex> lock(this->cmdMutex);
-    cor = this->centerOfRotation;
-  }
-
   const auto frictionDirection = this->ComputeFrictionDirection(
-    cor, _point, contactNormal, beltDirection);
+    this->stepCenterOfRotation, _point, contactNormal, beltDirection);
 
   _params.firstFrictionalDirection =
     convert(isCollision1Track ? frictionDirection : -frictionDirection);
@@ -518,8 +528,9 @@ void TrackControllerPrivate::ComputeSurfaceProperties(
     igndbg << "- surface motion       " << surfaceMotion << std::endl;
     igndbg << "- contact point        " << convert(_point) << std::endl;
     igndbg << "- contact normal       " << contactNormal << std::endl;
-    igndbg << "- track rot            " << trackWorldRot << std::endl;
-    igndbg << "- track Y              " << trackYAxisGlobal << std::endl;
+    igndbg << "- track rot            "
+           << this->linkWorldPose.Rot() * this->trackOrientation << std::endl;
+    igndbg << "- track Y              " << this->trackYAxisGlobal << std::endl;
     igndbg << "- belt direction       " << beltDirection << std::endl;
 
     this->debugMarker.set_id(++this->markerId);
@@ -591,12 +602,65 @@ void TrackControllerPrivate::RegisterCollision(EntityComponentManager& _ecm,
   if (_link != this->linkEntity)
     return;
 
-  this->trackCollisions.insert(_entity);
+  const auto it = std::lower_bound(this->trackCollisions.begin(),
+    this->trackCollisions.end(), _entity);
+  if (it != this->trackCollisions.end() && *it == _entity)
+    return;
+  this->collisionsWorldPose.insert(this->collisionsWorldPose.begin() +
+    (it - this->trackCollisions.begin()), math::Pose3d::Zero);
+  this->trackCollisions.insert(it, _entity);
+  this->collisionPosesDirty = true;
 
   _ecm.SetComponentData<components::EnableContactSurfaceCustomization>(
     _entity, true);
 }
 
+//////////////////////////////////////////////////
+std::optional<std::size_t> TrackControllerPrivate::CollisionIndex(
+  const Entity& _entity) const
+{
+  // Most contacts don't involve the track, reject them without a search
+  if (this->trackCollisions.empty() ||
+      _entity < this->trackCollisions.front() ||
+      _entity > this->trackCollisions.back())
+  {
+    return std::nullopt;
+  }
+
+  const auto it = std::lower_bound(this->trackCollisions.begin(),
+    this->trackCollisions.end(), _entity);
+  if (it == this->trackCollisions.end() || *it != _entity)
+    return std::nullopt;
+  return it - this->trackCollisions.begin();
+}
+
+//////////////////////////////////////////////////
+void TrackControllerPrivate::UpdatePoses(const EntityComponentManager& _ecm)
+{
+  const auto pose = worldPose(this->linkEntity, _ecm);
+  if (!this->collisionPosesDirty &&
+      pose.Pos().Equal(this->linkWorldPose.Pos(), 1e-6) &&
+      pose.Rot().Equal(this->linkWorldPose.Rot(), 1e-6))
+  {
+    return;
+  }
+
+  this->linkWorldPose = pose;
+  this->trackYAxisGlobal = (pose.Rot() * this->trackOrientation).RotateVector(
+    math::Vector3d::UnitY);
+
+  // Collisions are children of the link, so their world poses follow from
+  // the link's one
+  for (std::size_t i = 0; i < this->trackCollisions.size(); ++i)
+  {
+    const auto *collisionPose =
+      _ecm.Component<components::Pose>(this->trackCollisions[i]);
+    this->collisionsWorldPose[i] = collisionPose ?
+      pose * collisionPose->Data() : pose;
+  }
+  this->collisionPosesDirty = false;
+}
+
 //////////////////////////////////////////////////
 void TrackControllerPrivate::OnCmdVel(const msgs::Double& _msg)
 {
@@ -30,6 +30,8 @@
 #pragma warning(pop)
 #endif
 
+#include <cmath>
+#include <cstdint>
 #include <limits>
 #include <utility>
 
@@ -97,6 +99,9 @@ class systems::InputMatcher
   /// \brief State of the matcher
   protected: bool valid{false};
 
+  /// \brief Tolerance for float comparisons
+  protected: double tolerance{0.0};
+
   /// \brief Field comparator used by MessageDifferencer. This is where
   /// tolerance for float comparisons is set
   protected: google::protobuf::util::DefaultFieldComparator comparator;
@@ -181,6 +186,12 @@ class FieldMatcher : public InputMatcher
                      &_fieldDesc,
                  transport::ProtoMsg **_subMsg);
 
+  /// \brief Compare the field of a message against the matcher's value,
+  /// directly through reflection. Only valid if scalar is true.
+  /// \param[in] _msg Innermost submessage of the input holding the field
+  /// \return True if the values are equal, within tolerance for floats.
+  protected: bool CompareScalar(const transport::ProtoMsg &_msg) const;
+
   /// \brief Logic type of this matcher
   protected: const bool logicType;
 
@@ -190,6 +201,25 @@ class FieldMatcher : public InputMatcher
   /// \brief Field descriptor of the field compared by this matcher
   protected: std::vector<const google::protobuf::FieldDescriptor *>
                  fieldDescMatcher;
+
+  /// \brief True if the field is a singular scalar, which is compared
+  /// with CompareScalar instead of the MessageDifferencer.
+  protected: bool scalar{false};
+
+  /// \brief Value of integer and enum fields in the matcher.
+  protected: int64_t intValue{0};
+
+  /// \brief Value of unsigned integer fields in the matcher.
+  protected: uint64_t uintValue{0u};
+
+  /// \brief Value of floating point fields in the matcher.
+  protected: double doubleValue{0.0};
+
+  /// \brief Value of boolean fields in the matcher.
+  protected: bool boolValue{false};
+
+  /// \brief Value of string fields in the matcher.
+  protected: std::string stringValue;
 };
 
 //////////////////////////////////////////////////
@@ -214,6 +244,7 @@ bool InputMatcher::Match(const transport::ProtoMsg &_input) const
 
 void InputMatcher::SetTolerance(double _tol)
 {
+  this->tolerance = _tol;
   this->comparator.SetDefaultFractionAndMargin(
       std::numeric_limits<double>::min(), _tol);
 }
@@ -312,6 +343,49 @@ FieldMatcher::FieldMatcher(const std::string &_msgType, bool _logicType,
     return;
   }
 
+  // Singular scalar fields are compared directly, without the differencer,
+  // so the matcher's value is read once here
+  using FieldDescriptor = google::protobuf::FieldDescriptor;
+  const FieldDescriptor *leaf = this->fieldDescMatcher.back();
+  if (!leaf->is_repeated())
+  {
+    const auto *refl = matcherSubMsg->GetReflection();
+    this->scalar = true;
+    switch (leaf->cpp_type())
+    {
+      case FieldDescriptor::CPPTYPE_INT32:
+        this->intValue = refl->GetInt32(*matcherSubMsg, leaf);
+        break;
+      case FieldDescriptor::CPPTYPE_INT64:
+        this->intValue = refl->GetInt64(*matcherSubMsg, leaf);
+        break;
+      case FieldDescriptor::CPPTYPE_ENUM:
+        this->intValue = refl->GetEnumValue(*matcherSubMsg, leaf);
+        break;
+      case FieldDescriptor::CPPTYPE_UINT32:
+        this->uintValue = refl->GetUInt32(*matcherSubMsg, leaf);
+        break;
+      case FieldDescriptor::CPPTYPE_UINT64:
+        this->uintValue = refl->GetUInt64(*matcherSubMsg, leaf);
+        break;
+      case FieldDescriptor::CPPTYPE_DOUBLE:
+        this->doubleValue = refl->GetDouble(*matcherSubMsg, leaf);
+        break;
+      case FieldDescriptor::CPPTYPE_FLOAT:
+        this->doubleValue = refl->GetFloat(*matcherSubMsg, leaf);
+        break;
+      case FieldDescriptor::CPPTYPE_BOOL:
+        this->boolValue = refl->GetBool(*matcherSubMsg, leaf);
+        break;
+      case FieldDescriptor::CPPTYPE_STRING:
+        this->stringValue = refl->GetString(*matcherSubMsg, leaf);
+        break;
+      default:
+        this->scalar = false;
+        break;
+    }
+  }
+
   this->valid = true;
 }
 
@@ -395,10 +469,6 @@ bool FieldMatcher::FindFieldSubMessage(
 bool FieldMatcher::DoMatch(
     const transport::ProtoMsg &_input) const
 {
-  google::protobuf::util::DefaultFieldComparator comp;
-
-  auto *matcherRefl = this->matchMsg->GetReflection();
-  auto *inputRefl = _input.GetReflection();
   const transport::ProtoMsg *subMsgMatcher = this->matchMsg.get();
   const transport::ProtoMsg *subMsgInput = &_input;
   for (std::size_t i = 0; i < this->fieldDescMatcher.size() - 1; ++i)
@@ -412,17 +482,66 @@ bool FieldMatcher::DoMatch(
     }
     else
     {
-      subMsgMatcher = &matcherRefl->GetMessage(*subMsgMatcher, fieldDesc);
-      subMsgInput = &inputRefl->GetMessage(*subMsgInput, fieldDesc);
+      subMsgMatcher = &subMsgMatcher->GetReflection()->GetMessage(
+          *subMsgMatcher, fieldDesc);
+      subMsgInput = &subMsgInput->GetReflection()->GetMessage(
+          *subMsgInput, fieldDesc);
     }
   }
 
+  if (this->scalar)
+    return this->logicType == this->CompareScalar(*subMsgInput);
+
   return this->logicType ==
          this->diff.CompareWithFields(*subMsgMatcher, *subMsgInput,
                                       {this->fieldDescMatcher.back()},
                                       {this->fieldDescMatcher.back()});
 }
 
+//////////////////////////////////////////////////
+bool FieldMatcher::CompareScalar(const transport::ProtoMsg &_msg) const
+{
+  using FieldDescriptor = google::protobuf::FieldDescriptor;
+  const FieldDescriptor *leaf = this->fieldDescMatcher.back();
+  const auto *refl = _msg.GetReflection();
+
+  // Same as the approximate comparison of the DefaultFieldComparator with
+  // the margin set by SetTolerance
+  auto almostEqual = [this](double _value)
+  {
+    return _value == this->doubleValue ||
+        std::abs(_value - this->doubleValue) <= this->tolerance;
+  };
+
+  switch (leaf->cpp_type())
+  {
+    case FieldDescriptor::CPPTYPE_INT32:
+      return refl->GetInt32(_msg, leaf) == this->intValue;
+    case FieldDescriptor::CPPTYPE_INT64:
+      return refl->GetInt64(_msg, leaf) == this->intValue;
+    case FieldDescriptor::CPPTYPE_ENUM:
+      return refl->GetEnumValue(_msg, leaf) == this->intValue;
+    case FieldDescriptor::CPPTYPE_UINT32:
+      return refl->GetUInt32(_msg, leaf) == this->uintValue;
+    case FieldDescriptor::CPPTYPE_UINT64:
+      return refl->GetUInt64(_msg, leaf) == this->uintValue;
+    case FieldDescriptor::CPPTYPE_DOUBLE:
+      return almostEqual(refl->GetDouble(_msg, leaf));
+    case FieldDescriptor::CPPTYPE_FLOAT:
+      return almostEqual(refl->GetFloat(_msg, leaf));
+    case FieldDescriptor::CPPTYPE_BOOL:
+      return refl->GetBool(_msg, leaf) == this->boolValue;
+    case FieldDescriptor::CPPTYPE_STRING:
+    {
+      std::string scratch;
+      return refl->GetStringReference(_msg, leaf, &scratch) ==
+          this->stringValue;
+    }
+    default:
+      return false;
+  }
+}
+
 //////////////////////////////////////////////////
 bool InputMatcher::IsValid() const
 {
@@ -549,6 +668,14 @@ void TriggeredPublisher::Configure(const Entity &,
     return;
   }
 
+  // Check the type of inputs once for all matchers. Descriptors of
+  // generated messages outlive the messages.
+  auto inputMsg = msgs::Factory::New(this->inputMsgType);
+  if (nullptr != inputMsg)
+    this->inputDescriptor = inputMsg->GetDescriptor();
+
+  this->batchOutputs = sdfClone->Get<bool>("batch_outputs", false).first;
+
   // Read trigger delay, if present
   if (sdfClone->HasElement("delay_ms"))
   {
@@ -642,6 +769,23 @@ void TriggeredPublisher::Configure(const Entity &,
       }
 
       serviceInfo.timeout = std::stoi(timeoutInfo);
+
+      // Build the messages once instead of on every call
+      serviceInfo.reqMsgData =
+          msgs::Factory::New(serviceInfo.reqType, serviceInfo.reqMsg);
+      if (!serviceInfo.reqMsgData)
+      {
+        ignerr << "Unable to create request for type ["
+               << serviceInfo.reqType << "].\n";
+        continue;
+      }
+      serviceInfo.repMsgData = msgs::Factory::New(serviceInfo.repType);
+      if (!serviceInfo.repMsgData)
+      {
+        ignerr << "Unable to create response for type ["
+               << serviceInfo.repType << "].\n";
+        continue;
+      }
       this->srvOutputInfo.push_back(std::move(serviceInfo));
     }
   }
@@ -720,24 +864,9 @@ void TriggeredPublisher::CallService(std::size_t pendingSrv)
     for (std::size_t i = 0; i < pendingSrv; ++i)
     {
       bool result;
-      auto req = msgs::Factory::New(serviceInfo.reqType, serviceInfo.reqMsg);
-      if (!req)
-      {
-        ignerr << "Unable to create request for type ["
-               << serviceInfo.reqType << "].\n";
-        return;
-      }
-
-      auto rep = msgs::Factory::New(serviceInfo.repType);
-      if (!rep)
-      {
-        ignerr << "Unable to create response for type ["
-               << serviceInfo.repType << "].\n";
-        return;
-      }
-
-      bool executed = this->node.Request(serviceInfo.srvName, *req,
-                                         serviceInfo.timeout, *rep, result);
+      bool executed = this->node.Request(serviceInfo.srvName,
+          *serviceInfo.reqMsgData, serviceInfo.timeout,
+          *serviceInfo.repMsgData, result);
       if (executed)
       {
         if (!result)
@@ -779,6 +908,8 @@ void TriggeredPublisher::DoWork()
       }
       std::swap(pending, this->publishCount);
     }
+    if (this->batchOutputs)
+      pending = 1u;
 
     PublishMsg(pending);
 
@@ -791,6 +922,8 @@ void TriggeredPublisher::DoWork()
       }
       std::swap(pendingSrv, this->serviceCount);
     }
+    if (this->batchOutputs)
+      pendingSrv = 1u;
 
     CallService(pendingSrv);
   }
@@ -840,11 +973,23 @@ void TriggeredPublisher::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
 //////////////////////////////////////////////////
 bool TriggeredPublisher::MatchInput(const transport::ProtoMsg &_inputMsg)
 {
+  // Check the type once, instead of in each matcher
+  const bool typeChecked = nullptr != this->inputDescriptor;
+  if (typeChecked && _inputMsg.GetDescriptor() != this->inputDescriptor)
+  {
+    ignerr << "Received message has a different type than configured in "
+           << "<input>. Expected [" << this->inputDescriptor->full_name()
+           << "] got [" << _inputMsg.GetDescriptor()->full_name() << "]\n";
+    return false;
+  }
+
   return std::all_of(this->matchers.begin(), this->matchers.end(),
                      [&](const auto &_matcher)
                      {
                        try
                        {
+                         if (typeChecked)
+                           return _matcher->DoMatch(_inputMsg);
                          return _matcher->Match(_inputMsg);
                        } catch (const google::protobuf::FatalException &err)
                        {
@@ -80,6 +80,11 @@ namespace systems
   /// - `<delay_ms>`: Integer number of milliseconds, in simulation time,  to
   /// delay publication.
   ///
+  /// - `<batch_outputs>`: If true, all the matches which are pending when
+  /// outputs are sent result in a single publication on each output topic
+  /// and a single call to each service, instead of one per match. Useful
+  /// for triggers on high-rate topics. Defaults to false.
+  ///
   /// - `<service>`: Contains configuration for service to call: Multiple
   /// `<service>` tags are possible. A service will be called for each input
   /// that matches.
@@ -211,6 +216,13 @@ namespace systems
     /// \brief Input message topic
     private: std::string inputTopic;
 
+    /// \brief Descriptor of the input message type, used to check the type
+    /// of each input once for all matchers. Null if the type is unknown.
+    private: const google::protobuf::Descriptor *inputDescriptor{nullptr};
+
+    /// \brief True to send each output once for all pending matches.
+    private: bool batchOutputs{false};
+
     /// \brief Class that holds necessary bits for each specified output.
     private: struct OutputInfo
     {
@@ -243,6 +255,12 @@ namespace systems
       /// \brief Service request message
       std::string reqMsg;
 
+      /// \brief Service request built from reqMsg when configured.
+      transport::ProtoMsgPtr reqMsgData;
+
+      /// \brief Service response, reused across calls.
+      transport::ProtoMsgPtr repMsgData;
+
       /// \brief Serivce timeout
       int timeout;
     };
@@ -37,8 +37,18 @@
 #include <ignition/msgs/visual.pb.h>
 #include <ignition/msgs/wheel_slip_parameters_cmd.pb.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -55,10 +65,12 @@
 
 #include "ignition/common/Profiler.hh"
 
+#include "ignition/gazebo/components/AngularVelocityCmd.hh"
 #include "ignition/gazebo/components/Collision.hh"
 #include "ignition/gazebo/components/Joint.hh"
 #include "ignition/gazebo/components/Light.hh"
 #include "ignition/gazebo/components/LightCmd.hh"
+#include "ignition/gazebo/components/LinearVelocityCmd.hh"
 #include "ignition/gazebo/components/Link.hh"
 #include "ignition/gazebo/components/Model.hh"
 #include "ignition/gazebo/components/Name.hh"
@@ -92,6 +104,29 @@ namespace gazebo
 inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
 namespace systems
 {
+/// \brief SDF of a create request, parsed on the parsing thread.
+struct ParsedCreateSdf
+{
+  /// \brief Parsed SDF, null if there were errors.
+  std::shared_ptr<const sdf::Root> root;
+
+  /// \brief Errors found while parsing.
+  sdf::Errors errors;
+};
+
+/// \brief A create request waiting to be parsed.
+struct ParseJob
+{
+  /// \brief SDF string, or path of the SDF file.
+  std::string sdf;
+
+  /// \brief True if sdf is a file path.
+  bool isFile{false};
+
+  /// \brief Set once parsed.
+  std::promise<ParsedCreateSdf> promise;
+};
+
 /// \brief This class is passed to every command and contains interfaces that
 /// can be shared among all commands. For example, all create and remove
 /// commands can use the `creator` object.
@@ -112,6 +147,104 @@ class UserCommandsInterface
   /// \return True if a contact sensor is connected to the collision entity,
   /// false otherwise
   public: bool HasContactSensor(const Entity _collision);
+
+  /// \brief Destructor, which stops the parsing thread.
+  public: ~UserCommandsInterface();
+
+  /// \brief Queue the SDF of a create request to be parsed on the parsing
+  /// thread, so that it's usually ready by the time the command executes.
+  /// \param[in] _msg Create request.
+  /// \return Parsed SDF once ready, or an invalid future if the request
+  /// doesn't hold SDF.
+  public: std::shared_future<ParsedCreateSdf> ParseAsync(
+      const msgs::EntityFactory &_msg);
+
+  /// \brief Parse queued requests until stopped, run from the parsing
+  /// thread.
+  public: void RunParser();
+
+  /// \brief Get the parsed SDF of a create request. Recently parsed strings
+  /// are kept, so that spawning the same SDF many times only parses it once.
+  /// Only called from the parsing thread.
+  /// \param[in] _sdf SDF string.
+  /// \param[out] _errors Errors found while parsing.
+  /// \return Parsed SDF, or nullptr if there were errors.
+  public: std::shared_ptr<const sdf::Root> ParsedSdf(const std::string &_sdf,
+      sdf::Errors &_errors);
+
+  /// \brief Get the entities of pose requests, looking names up once for
+  /// all of them.
+  /// \param[in] _poses Pose requests.
+  /// \param[out] _entities Entity of each request, kNullEntity if not
+  /// found.
+  public: void PoseEntities(const std::vector<const msgs::Pose *> &_poses,
+      std::vector<Entity> &_entities);
+
+  /// \brief Maximum number of parsed SDF strings to keep. Zero disables
+  /// caching.
+  public: std::size_t sdfCacheSize{32u};
+
+  /// \brief Parsed SDF strings, most recently used first.
+  public: std::list<std::pair<std::string,
+      std::shared_ptr<const sdf::Root>>> sdfCache;
+
+  /// \brief Entries of sdfCache, keyed by the SDF string they hold.
+  public: std::unordered_map<std::string_view,
+      decltype(sdfCache)::iterator> sdfCacheIndex;
+
+  /// \brief Requests waiting to be parsed, oldest first.
+  public: std::deque<ParseJob> parseQueue;
+
+  /// \brief Protects parseQueue and stopParser.
+  public: std::mutex parseMutex;
+
+  /// \brief Notified when requests are queued or on shutdown.
+  public: std::condition_variable parseCv;
+
+  /// \brief True when the parsing thread should exit.
+  public: bool stopParser{false};
+
+  /// \brief Parsing thread, started with the first request.
+  public: std::thread parser;
+
+  /// \brief Park an entity spawned from a pooled prototype, instead of
+  /// removing it. It's moved out of the way and held still until it's
+  /// reused.
+  /// \param[in] _entity Top level model entity.
+  /// \return False if the entity isn't pooled or its pool is full, in which
+  /// case it should be removed.
+  public: bool Park(const Entity _entity);
+
+  /// \brief Take a parked entity of a prototype to reuse it.
+  /// \param[in] _prototype Name of the prototype model.
+  /// \return Parked entity, or kNullEntity if there's none.
+  public: Entity Unpark(const std::string &_prototype);
+
+  /// \brief Names of the prototype models whose entities are pooled.
+  public: std::unordered_set<std::string> poolPrototypes;
+
+  /// \brief Maximum number of parked entities per prototype.
+  public: std::size_t poolSize{16u};
+
+  /// \brief Pose of the first parking spot. The others are laid out on a
+  /// grid next to it.
+  public: math::Pose3d parkingPose{0, 0, -1000, 0, 0, 0};
+
+  /// \brief Prototype of each pooled entity which is in use.
+  public: std::unordered_map<Entity, std::string> pooledEntities;
+
+  /// \brief Size of pooledEntities after its last cleanup.
+  public: std::size_t pooledEntitiesPruned{0u};
+
+  /// \brief Parked entities of each prototype, with their parking spots.
+  public: std::unordered_map<std::string,
+      std::vector<std::pair<Entity, std::size_t>>> parkedEntities;
+
+  /// \brief Free parking spots below nextParkingSpot.
+  public: std::vector<std::size_t> freeParkingSpots;
+
+  /// \brief Next parking spot which has never been used.
+  public: std::size_t nextParkingSpot{0u};
 };
 
 /// \brief All user commands should inherit from this class so they can be
@@ -132,6 +265,16 @@ class UserCommandBase
   /// \return True if command was properly executed.
   public: virtual bool Execute() = 0;
 
+  /// \brief Get the poses set by the command, so that consecutive pose
+  /// commands are applied in one pass instead of being executed.
+  /// \param[out] _poses Poses are appended here.
+  /// \return False if the command doesn't only set poses.
+  public: virtual bool AppendPoses(
+      std::vector<const msgs::Pose *> &/*_poses*/) const
+  {
+    return false;
+  }
+
   /// \brief Message containing command.
   protected: google::protobuf::Message *msg{nullptr};
 
@@ -150,6 +293,9 @@ class CreateCommand : public UserCommandBase
 
   // Documentation inherited
   public: bool Execute() final;
+
+  /// \brief SDF of the request, parsed off the simulation thread.
+  private: std::shared_future<ParsedCreateSdf> parsed;
 };
 
 /// \brief Command to remove an entity from simulation.
@@ -287,6 +433,10 @@ class PoseCommand : public UserCommandBase
 
   // Documentation inherited
   public: bool Execute() final;
+
+  // Documentation inherited
+  public: bool AppendPoses(
+      std::vector<const msgs::Pose *> &_poses) const final;
 };
 
 /// \brief Command to update an entity's pose transform.
@@ -300,6 +450,10 @@ class PoseVectorCommand : public UserCommandBase
 
   // Documentation inherited
   public: bool Execute() final;
+
+  // Documentation inherited
+  public: bool AppendPoses(
+      std::vector<const msgs::Pose *> &_poses) const final;
 };
 
 /// \brief Command to modify the physics parameters of a simulation.
@@ -583,12 +737,13 @@ bool pose3Eql(const math::Pose3d &_a, const math::Pose3d &_b)
     math::equal(_a.Rot().W(), _b.Rot().W(), 1e-6);
 }
 
-/// \brief Update pose for a specific pose message
-/// \param[in] _req Message containing new pose
+/// \brief Update poses for pose messages, in one pass. When an entity is
+/// moved several times, only its last pose is set.
+/// \param[in] _poses Messages containing new poses
 /// \param[in] _iface Pointer to user commands interface.
-/// \return True if successful.
-bool updatePose(
-  const msgs::Pose &_req,
+/// \return True if all entities were found.
+bool updatePoses(
+  const std::vector<const msgs::Pose *> &_poses,
   std::shared_ptr<UserCommandsInterface> _iface);
 
 //////////////////////////////////////////////////
@@ -604,37 +759,30 @@ UserCommands::~UserCommands() = default;
 bool UserCommandsInterface::HasContactSensor(const Entity _collision)
 {
   auto *linkEntity = ecm->Component<components::ParentEntity>(_collision);
-  auto allLinkSensors =
-    ecm->EntitiesByComponents(components::Sensor(),
-      components::ParentEntity(*linkEntity));
+  const std::string &collisionName =
+      ecm->Component<components::Name>(_collision)->Data();
 
-  for (auto const &sensor : allLinkSensors)
+  bool found{false};
+  ecm->EachEntityByComponents([&](const Entity _sensor)
   {
     // Check if it is a contact sensor
-    auto isContactSensor =
-      ecm->EntityHasComponentType(sensor, components::ContactSensor::typeId);
-    if (!isContactSensor)
-      continue;
+    auto contactSensor = ecm->Component<components::ContactSensor>(_sensor);
+    if (!contactSensor)
+      return true;
 
     // Check if sensor is connected to _collision
-    auto componentName = ecm->Component<components::Name>(_collision);
-    std::string collisionName = componentName->Data();
-    auto sensorSDF = ecm->Component<components::ContactSensor>(sensor)->Data();
-    auto sensorCollisionName =
-      sensorSDF->GetElement("contact")->Get<std::string>("collision");
+    auto sensorCollisionName = contactSensor->Data()->GetElement(
+        "contact")->Get<std::string>("collision");
+    found = collisionName == sensorCollisionName;
+    return !found;
+  }, components::Sensor(), components::ParentEntity(*linkEntity));
 
-    if (collisionName == sensorCollisionName)
-    {
-      return true;
-    }
-  }
-
-  return false;
+  return found;
 }
 
 //////////////////////////////////////////////////
 void UserCommands::Configure(const Entity &_entity,
-    const std::shared_ptr<const sdf::Element> &,
+    const std::shared_ptr<const sdf::Element> &_sdf,
     EntityComponentManager &_ecm,
     EventManager &_eventManager)
 {
@@ -645,6 +793,31 @@ void UserCommands::Configure(const Entity &_entity,
   this->dataPtr->iface->creator =
       std::make_unique<SdfEntityCreator>(_ecm, _eventManager);
 
+  if (_sdf)
+  {
+    auto cacheSize = _sdf->Get<int>("sdf_cache_size",
+        static_cast<int>(this->dataPtr->iface->sdfCacheSize)).first;
+    this->dataPtr->iface->sdfCacheSize =
+        static_cast<std::size_t>(std::max(cacheSize, 0));
+  }
+
+  if (_sdf && _sdf->HasElement("entity_pool"))
+  {
+    auto poolElem = _sdf->FindElement("entity_pool");
+    for (auto protoElem = poolElem->FindElement("prototype"); protoElem;
+         protoElem = protoElem->GetNextElement("prototype"))
+    {
+      this->dataPtr->iface->poolPrototypes.insert(
+          protoElem->Get<std::string>());
+    }
+    auto poolSize = poolElem->Get<int>("size",
+        static_cast<int>(this->dataPtr->iface->poolSize)).first;
+    this->dataPtr->iface->poolSize =
+        static_cast<std::size_t>(std::max(poolSize, 0));
+    this->dataPtr->iface->parkingPose = poolElem->Get<math::Pose3d>(
+        "parking_pose", this->dataPtr->iface->parkingPose).first;
+  }
+
   const components::Name *constCmp = _ecm.Component<components::Name>(_entity);
   const std::string &worldName = constCmp->Data();
 
@@ -773,9 +946,20 @@ void UserCommands::PreUpdate(const UpdateInfo &/*_info*/,
 
   // TODO(louise) Record current world state for undo
 
-  // Execute pending commands
+  // Execute pending commands. Runs of pose commands are applied together,
+  // so that many poses only cost one pass.
+  std::vector<const msgs::Pose *> poses;
   for (auto &cmd : cmds)
   {
+    if (cmd->AppendPoses(poses))
+      continue;
+
+    if (!poses.empty())
+    {
+      updatePoses(poses, this->dataPtr->iface);
+      poses.clear();
+    }
+
     // Execute
     if (!cmd->Execute())
       continue;
@@ -784,6 +968,8 @@ void UserCommands::PreUpdate(const UpdateInfo &/*_info*/,
 
     // TODO(louise) Move to undo list
   }
+  if (!poses.empty())
+    updatePoses(poses, this->dataPtr->iface);
 
   // TODO(louise) Clear redo list
 }
@@ -1043,10 +1229,249 @@ UserCommandBase::~UserCommandBase()
   this->msg = nullptr;
 }
 
+//////////////////////////////////////////////////
+UserCommandsInterface::~UserCommandsInterface()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->parseMutex);
+    this->stopParser = true;
+  }
+  this->parseCv.notify_all();
+  if (this->parser.joinable())
+    this->parser.join();
+}
+
+//////////////////////////////////////////////////
+std::shared_future<ParsedCreateSdf> UserCommandsInterface::ParseAsync(
+    const msgs::EntityFactory &_msg)
+{
+  ParseJob job;
+  if (_msg.from_case() == msgs::EntityFactory::kSdf)
+    job.sdf = _msg.sdf();
+  else if (_msg.from_case() == msgs::EntityFactory::kSdfFilename)
+    job.sdf = _msg.sdf_filename();
+  else
+    return {};
+  job.isFile = _msg.from_case() == msgs::EntityFactory::kSdfFilename;
+  std::shared_future<ParsedCreateSdf> future = job.promise.get_future();
+
+  {
+    std::lock_guard<std::mutex> lock(this->parseMutex);
+    this->parseQueue.push_back(std::move(job));
+    if (!this->parser.joinable())
+      this->parser = std::thread(&UserCommandsInterface::RunParser, this);
+  }
+  this->parseCv.notify_one();
+  return future;
+}
+
+//////////////////////////////////////////////////
+void UserCommandsInterface::RunParser()
+{
+  IGN_PROFILE_THREAD_NAME("UserCommands parser");
+  while (true)
+  {
+    ParseJob job;
+    {
+      std::unique_lock<std::mutex> lock(this->parseMutex);
+      this->parseCv.wait(lock, [this]
+      {
+        return this->stopParser || !this->parseQueue.empty();
+      });
+      if (this->stopParser)
+        return;
+      job = std::move(this->parseQueue.front());
+      this->parseQueue.pop_front();
+    }
+
+    ParsedCreateSdf parsed;
+    if (job.isFile)
+    {
+      IGN_PROFILE("UserCommandsInterface::RunParser File");
+      auto root = std::make_shared<sdf::Root>();
+      parsed.errors = root->Load(job.sdf);
+      if (parsed.errors.empty())
+        parsed.root = std::move(root);
+    }
+    else
+    {
+      parsed.root = this->ParsedSdf(job.sdf, parsed.errors);
+    }
+    job.promise.set_value(std::move(parsed));
+  }
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<const sdf::Root> UserCommandsInterface::ParsedSdf(
+    const std::string &_sdf, sdf::Errors &_errors)
+{
+  IGN_PROFILE("UserCommandsInterface::ParsedSdf");
+
+  auto cached = this->sdfCacheIndex.find(_sdf);
+  if (cached != this->sdfCacheIndex.end())
+  {
+    this->sdfCache.splice(this->sdfCache.begin(), this->sdfCache,
+        cached->second);
+    return cached->second->second;
+  }
+
+  auto root = std::make_shared<sdf::Root>();
+  _errors = root->LoadSdfString(_sdf);
+  if (!_errors.empty())
+    return nullptr;
+
+  if (0u == this->sdfCacheSize)
+    return root;
+
+  this->sdfCache.emplace_front(_sdf, std::move(root));
+  this->sdfCacheIndex[this->sdfCache.front().first] = this->sdfCache.begin();
+  while (this->sdfCache.size() > this->sdfCacheSize)
+  {
+    this->sdfCacheIndex.erase(this->sdfCache.back().first);
+    this->sdfCache.pop_back();
+  }
+  return this->sdfCache.front().second;
+}
+
+//////////////////////////////////////////////////
+void UserCommandsInterface::PoseEntities(
+    const std::vector<const msgs::Pose *> &_poses,
+    std::vector<Entity> &_entities)
+{
+  _entities.assign(_poses.size(), kNullEntity);
+
+  // TODO(anyone) Update pose message to use Entity, with default ID null
+  std::unordered_map<std::string_view, std::size_t> byName;
+  for (std::size_t i = 0; i < _poses.size(); ++i)
+  {
+    const auto id = _poses[i]->id();
+    if (id != kNullEntity && id != 0)
+      _entities[i] = id;
+    else if (!_poses[i]->name().empty())
+      byName.emplace(_poses[i]->name(), i);
+  }
+
+  // A single request is looked up directly, many are matched against all
+  // top level entities at once
+  if (byName.size() == 1u)
+  {
+    const auto &[name, index] = *byName.begin();
+    _entities[index] = this->ecm->EntityByComponents(
+        components::Name(std::string(name)),
+        components::ParentEntity(this->worldEntity));
+  }
+  else if (byName.size() > 1u)
+  {
+    this->ecm->Each<components::Name, components::ParentEntity>(
+        [&](const Entity &_entity, const components::Name *_name,
+            const components::ParentEntity *_parent) -> bool
+        {
+          if (_parent->Data() != this->worldEntity)
+            return true;
+          auto it = byName.find(_name->Data());
+          if (it != byName.end())
+            _entities[it->second] = _entity;
+          return true;
+        });
+  }
+
+  // Requests for the same name share its entity
+  for (std::size_t i = 0; i < _poses.size(); ++i)
+  {
+    if (_entities[i] != kNullEntity || _poses[i]->name().empty())
+      continue;
+    auto it = byName.find(_poses[i]->name());
+    if (it != byName.end())
+      _entities[i] = _entities[it->second];
+  }
+}
+
+//////////////////////////////////////////////////
+bool UserCommandsInterface::Park(const Entity _entity)
+{
+  auto pooled = this->pooledEntities.find(_entity);
+  if (pooled == this->pooledEntities.end())
+    return false;
+
+  const std::string prototype = pooled->second;
+  this->pooledEntities.erase(pooled);
+
+  auto &parked = this->parkedEntities[prototype];
+  if (parked.size() >= this->poolSize)
+    return false;
+
+  std::size_t spot = this->nextParkingSpot;
+  if (this->freeParkingSpots.empty())
+  {
+    ++this->nextParkingSpot;
+  }
+  else
+  {
+    spot = this->freeParkingSpots.back();
+    this->freeParkingSpots.pop_back();
+  }
+  parked.emplace_back(_entity, spot);
+
+  // Spots are far enough apart for parked models not to touch
+  constexpr double kSpacing{10.0};
+  constexpr std::size_t kColumns{100u};
+  auto pose = this->parkingPose;
+  pose.Pos() += pose.Rot().RotateVector(math::Vector3d(
+      kSpacing * static_cast<double>(spot % kColumns),
+      kSpacing * static_cast<double>(spot / kColumns), 0.0));
+
+  // Free the name for new entities
+  this->ecm->SetComponentData<components::Name>(_entity,
+      "__pooled_" + prototype + "_" + std::to_string(_entity));
+  this->ecm->SetChanged(_entity, components::Name::typeId,
+      ComponentState::OneTimeChange);
+
+  this->ecm->SetComponentData<components::WorldPoseCmd>(_entity, pose);
+  this->ecm->SetComponentData<components::Pose>(_entity, pose);
+  this->ecm->SetChanged(_entity, components::Pose::typeId,
+      ComponentState::OneTimeChange);
+
+  // Velocity commands stay active while the components exist, which keeps
+  // the model from falling
+  this->ecm->SetComponentData<components::LinearVelocityCmd>(_entity,
+      math::Vector3d::Zero);
+  this->ecm->SetComponentData<components::AngularVelocityCmd>(_entity,
+      math::Vector3d::Zero);
+
+  igndbg << "Parked entity [" << _entity << "] of prototype [" << prototype
+         << "] at spot [" << spot << "]" << std::endl;
+  return true;
+}
+
+//////////////////////////////////////////////////
+Entity UserCommandsInterface::Unpark(const std::string &_prototype)
+{
+  auto parked = this->parkedEntities.find(_prototype);
+  if (parked == this->parkedEntities.end())
+    return kNullEntity;
+
+  // Parked entities may have been removed by someone else
+  while (!parked->second.empty())
+  {
+    const auto [entity, spot] = parked->second.back();
+    parked->second.pop_back();
+    this->freeParkingSpots.push_back(spot);
+
+    if (!this->ecm->HasEntity(entity))
+      continue;
+
+    this->ecm->RemoveComponent<components::LinearVelocityCmd>(entity);
+    this->ecm->RemoveComponent<components::AngularVelocityCmd>(entity);
+    this->pooledEntities[entity] = _prototype;
+    return entity;
+  }
+  return kNullEntity;
+}
+
 //////////////////////////////////////////////////
 CreateCommand::CreateCommand(msgs::EntityFactory *_msg,
     std::shared_ptr<UserCommandsInterface> &_iface)
-    : UserCommandBase(_msg, _iface)
+    : UserCommandBase(_msg, _iface), parsed(_iface->ParseAsync(*_msg))
 {
 }
 
@@ -1060,20 +1485,24 @@ bool CreateCommand::Execute()
     return false;
   }
 
-  // Load SDF
-  sdf::Root root;
+  // Load SDF. SDF strings and files were parsed on the parsing thread
+  // since the request arrived, this only waits if that's not done yet.
+  const sdf::Root emptyRoot;
+  const sdf::Root *root = &emptyRoot;
+  std::shared_ptr<const sdf::Root> parsedRoot;
   sdf::Light lightSdf;
   sdf::Errors errors;
   switch (createMsg->from_case())
   {
     case msgs::EntityFactory::kSdf:
-    {
-      errors = root.LoadSdfString(createMsg->sdf());
-      break;
-    }
     case msgs::EntityFactory::kSdfFilename:
     {
-      errors = root.Load(createMsg->sdf_filename());
+      IGN_PROFILE("CreateCommand::Execute WaitParse");
+      const ParsedCreateSdf &parsedSdf = this->parsed.get();
+      errors = parsedSdf.errors;
+      parsedRoot = parsedSdf.root;
+      if (parsedRoot)
+        root = parsedRoot.get();
       break;
     }
     case msgs::EntityFactory::kModel:
@@ -1143,17 +1572,17 @@ bool CreateCommand::Execute()
   bool isLight{false};
   bool isActor{false};
   bool isRoot{false};
-  if (nullptr != root.Model())
+  if (nullptr != root->Model())
   {
     isRoot = true;
     isModel = true;
   }
-  else if (nullptr != root.Light())
+  else if (nullptr != root->Light())
   {
     isRoot = true;
     isLight = true;
   }
-  else if (nullptr != root.Actor())
+  else if (nullptr != root->Actor())
   {
     isRoot = true;
     isActor = true;
@@ -1183,11 +1612,11 @@ bool CreateCommand::Execute()
   }
   else if (isModel)
   {
-    desiredName = root.Model()->Name();
+    desiredName = root->Model()->Name();
   }
   else if (isLight && isRoot)
   {
-    desiredName = root.Light()->Name();
+    desiredName = root->Light()->Name();
   }
   else if (isLight)
   {
@@ -1195,7 +1624,7 @@ bool CreateCommand::Execute()
   }
   else if (isActor)
   {
-    desiredName = root.Actor()->Name();
+    desiredName = root->Actor()->Name();
   }
 
   // Check if there's already a top-level entity with the given name
@@ -1225,15 +1654,31 @@ bool CreateCommand::Execute()
 
   // Create entities
   Entity entity{kNullEntity};
-  if (isModel)
+  bool reused{false};
+  const bool pooled = isModel && this->iface->poolPrototypes.count(
+      root->Model()->Name()) > 0;
+  if (pooled)
+  {
+    entity = this->iface->Unpark(root->Model()->Name());
+    reused = kNullEntity != entity;
+  }
+
+  if (reused)
+  {
+    this->iface->ecm->SetComponentData<components::Name>(entity,
+        desiredName);
+    this->iface->ecm->SetChanged(entity, components::Name::typeId,
+        ComponentState::OneTimeChange);
+  }
+  else if (isModel)
   {
-    auto model = *root.Model();
+    auto model = *root->Model();
     model.SetName(desiredName);
     entity = this->iface->creator->CreateEntities(&model);
   }
   else if (isLight && isRoot)
   {
-    auto light = *root.Light();
+    auto light = *root->Light();
     light.SetName(desiredName);
     entity = this->iface->creator->CreateEntities(&light);
   }
@@ -1244,12 +1689,32 @@ bool CreateCommand::Execute()
   }
   else if (isActor)
   {
-    auto actor = *root.Actor();
+    auto actor = *root->Actor();
     actor.SetName(desiredName);
     entity = this->iface->creator->CreateEntities(&actor);
   }
 
-  this->iface->creator->SetParent(entity, this->iface->worldEntity);
+  if (!reused)
+    this->iface->creator->SetParent(entity, this->iface->worldEntity);
+
+  if (pooled)
+  {
+    // Prune entities which were removed by others from time to time
+    if (this->iface->pooledEntities.size() >=
+        2u * std::max<std::size_t>(this->iface->pooledEntitiesPruned, 16u))
+    {
+      for (auto it = this->iface->pooledEntities.begin();
+           it != this->iface->pooledEntities.end();)
+      {
+        if (this->iface->ecm->HasEntity(it->first))
+          ++it;
+        else
+          it = this->iface->pooledEntities.erase(it);
+      }
+      this->iface->pooledEntitiesPruned = this->iface->pooledEntities.size();
+    }
+    this->iface->pooledEntities[entity] = root->Model()->Name();
+  }
 
   // Pose
   std::optional<math::Pose3d> createPose;
@@ -1257,6 +1722,10 @@ bool CreateCommand::Execute()
   {
     createPose = msgs::Convert(createMsg->pose());
   }
+  else if (reused)
+  {
+    createPose = root->Model()->RawPose();
+  }
 
   // Spherical coordinates
   if (createMsg->has_spherical_coordinates())
@@ -1298,6 +1767,22 @@ bool CreateCommand::Execute()
   {
     auto poseComp = this->iface->ecm->Component<components::Pose>(entity);
     *poseComp = components::Pose(createPose.value());
+
+    // Physics already knows reused entities, so move it there too
+    if (reused)
+    {
+      this->iface->ecm->SetChanged(entity, components::Pose::typeId,
+          ComponentState::OneTimeChange);
+      this->iface->ecm->SetComponentData<components::WorldPoseCmd>(entity,
+          createPose.value());
+    }
+  }
+
+  if (reused)
+  {
+    igndbg << "Reused pooled entity [" << entity << "] as [" << desiredName
+           << "]" << std::endl;
+    return true;
   }
 
   igndbg << "Created entity [" << entity << "] named [" << desiredName << "]"
@@ -1350,6 +1835,9 @@ bool RemoveCommand::Execute()
     return false;
   }
 
+  if (this->iface->Park(entity))
+    return true;
+
   igndbg << "Requesting removal of entity [" << entity << "]" << std::endl;
   this->iface->creator->RequestRemoveEntity(entity);
   return true;
@@ -1442,48 +1930,49 @@ bool LightCommand::Execute()
 }
 
 //////////////////////////////////////////////////
-bool updatePose(
-  const msgs::Pose &_poseMsg,
+bool updatePoses(
+  const std::vector<const msgs::Pose *> &_poses,
   std::shared_ptr<UserCommandsInterface> _iface)
 {
-  // Check the name of the entity being spawned
-  std::string entityName = _poseMsg.name();
-  Entity entity = kNullEntity;
-  // TODO(anyone) Update pose message to use Entity, with default ID null
-  if (_poseMsg.id() != kNullEntity && _poseMsg.id() != 0)
-  {
-    entity = _poseMsg.id();
-  }
-  else if (!entityName.empty())
-  {
-    entity = _iface->ecm->EntityByComponents(components::Name(entityName),
-      components::ParentEntity(_iface->worldEntity));
-  }
+  IGN_PROFILE("updatePoses");
+  std::vector<Entity> entities;
+  _iface->PoseEntities(_poses, entities);
 
-  if (!_iface->ecm->HasEntity(entity))
+  // Only the last pose of each entity takes effect
+  std::unordered_map<Entity, std::size_t> last;
+  bool result{true};
+  for (std::size_t i = 0; i < _poses.size(); ++i)
   {
-    ignerr << "Unable to update the pose for entity id:[" << _poseMsg.id()
-           << "], name[" << entityName << "]" << std::endl;
-    return false;
+    if (!_iface->ecm->HasEntity(entities[i]))
+    {
+      ignerr << "Unable to update the pose for entity id:[" << _poses[i]->id()
+             << "], name[" << _poses[i]->name() << "]" << std::endl;
+      result = false;
+      continue;
+    }
+    last[entities[i]] = i;
   }
 
-  auto poseCmdComp =
-    _iface->ecm->Component<components::WorldPoseCmd>(entity);
-  if (!poseCmdComp)
+  for (const auto &[entity, index] : last)
   {
-    _iface->ecm->CreateComponent(
-        entity, components::WorldPoseCmd(msgs::Convert(_poseMsg)));
-  }
-  else
-  {
-    /// \todo(anyone) Moving an object is not captured in a log file.
-    auto state = poseCmdComp->SetData(msgs::Convert(_poseMsg), pose3Eql) ?
-        ComponentState::OneTimeChange :
-        ComponentState::NoChange;
-    _iface->ecm->SetChanged(entity, components::WorldPoseCmd::typeId,
-        state);
+    const auto pose = msgs::Convert(*_poses[index]);
+    auto poseCmdComp =
+      _iface->ecm->Component<components::WorldPoseCmd>(entity);
+    if (!poseCmdComp)
+    {
+      _iface->ecm->CreateComponent(entity, components::WorldPoseCmd(pose));
+    }
+    else
+    {
+      /// \todo(anyone) Moving an object is not captured in a log file.
+      auto state = poseCmdComp->SetData(pose, pose3Eql) ?
+          ComponentState::OneTimeChange :
+          ComponentState::NoChange;
+      _iface->ecm->SetChanged(entity, components::WorldPoseCmd::typeId,
+          state);
+    }
   }
-  return true;
+  return result;
 }
 
 //////////////////////////////////////////////////
@@ -1503,7 +1992,16 @@ bool PoseCommand::Execute()
     return false;
   }
 
-  return updatePose(*poseMsg, this->iface);
+  return updatePoses({poseMsg}, this->iface);
+}
+
+//////////////////////////////////////////////////
+bool PoseCommand::AppendPoses(std::vector<const msgs::Pose *> &_poses) const
+{
+  auto poseMsg = dynamic_cast<const msgs::Pose *>(this->msg);
+  if (nullptr != poseMsg)
+    _poses.push_back(poseMsg);
+  return true;
 }
 
 //////////////////////////////////////////////////
@@ -1523,14 +2021,22 @@ bool PoseVectorCommand::Execute()
     return false;
   }
 
-  for (int i = 0; i < poseVectorMsg->pose_size(); i++)
-  {
-    if (!updatePose(poseVectorMsg->pose(i), this->iface))
-    {
-      return false;
-    }
-  }
+  std::vector<const msgs::Pose *> poses;
+  this->AppendPoses(poses);
+  return updatePoses(poses, this->iface);
+}
+
+//////////////////////////////////////////////////
+bool PoseVectorCommand::AppendPoses(
+    std::vector<const msgs::Pose *> &_poses) const
+{
+  auto poseVectorMsg = dynamic_cast<const msgs::Pose_V *>(this->msg);
+  if (nullptr == poseVectorMsg)
+    return true;
 
+  _poses.reserve(_poses.size() + poseVectorMsg->pose_size());
+  for (const auto &pose : poseVectorMsg->pose())
+    _poses.push_back(&pose);
   return true;
 }
 
@@ -44,6 +44,33 @@ namespace systems
   /// * **Request type*: ignition.msgs.EntityFactory
   /// * **Response type*: ignition.msgs.Boolean
   ///
+  /// SDF strings and files are parsed on a background thread as soon as the
+  /// request arrives, so the simulation thread only spawns the entities.
+  /// SDF strings of recent requests are kept parsed, so spawning the same
+  /// SDF over and over, like parts on a conveyor, only parses it once.
+  /// Files included by a cached string aren't loaded again. The number of
+  /// strings kept is set with `<sdf_cache_size>`, which defaults to 32. Set
+  /// it to 0 to parse every request.
+  ///
+  /// # Entity pool
+  ///
+  /// Models which are spawned and removed over and over, like debris, can
+  /// be pooled. When an entity spawned from a pooled prototype is removed
+  /// through the remove service, it is parked instead: it's renamed, moved
+  /// to a parking spot and held still with velocity commands. The next
+  /// spawn of the same prototype reuses a parked entity, only setting its
+  /// name and pose. The entity keeps its components, physics objects,
+  /// visuals and loaded plugins, so its internal state, like joint
+  /// positions, isn't reset.
+  ///
+  /// * `<entity_pool>`
+  ///   * `<prototype>`: Name of a top level model in the spawned SDF whose
+  ///     entities are pooled. May be repeated.
+  ///   * `<size>`: Maximum number of parked entities per prototype. Entities
+  ///     removed beyond that are really removed. Defaults to 16.
+  ///   * `<parking_pose>`: Pose of the first parking spot, the others are
+  ///     laid out 10 m apart on its XY plane. Defaults to `0 0 -1000 0 0 0`.
+  ///
   /// # Spawn multiple entities
   ///
   /// This service can spawn multiple entities in the same iteration,
@@ -69,6 +96,11 @@ namespace systems
   /// * **Request type*: ignition.msgs.Pose_V
   /// * **Response type*: ignition.msgs.Boolean
   ///
+  /// Pose requests received between steps, through either service, are
+  /// applied together: entities requested by name are looked up in one pass
+  /// and only the last pose requested for each entity is set. Prefer
+  /// `set_pose_vector` to move thousands of entities at once.
+  ///
   /// Try some examples described on examples/worlds/empty.sdf
   class UserCommands:
     public System,
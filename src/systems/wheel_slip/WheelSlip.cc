@@ -17,7 +17,8 @@
 
 #include "WheelSlip.hh"
 
-#include <map>
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <vector>
 
@@ -50,6 +51,12 @@ class ignition::gazebo::systems::WheelSlipPrivate
   /// \param[in] _ecm Immutable reference to the EntityComponentManager
   public: void Update(EntityComponentManager &_ecm);
 
+  /// \brief Whether a slip parameter changed enough to be sent to physics.
+  /// \param[in] _last Value last sent to physics.
+  /// \param[in] _slip New value.
+  /// \return True if the relative change exceeds the tolerance.
+  public: bool SlipChanged(double _last, double _slip) const;
+
   /// \brief Ignition communication node
   public: transport::Node node;
 
@@ -70,6 +77,9 @@ class ignition::gazebo::systems::WheelSlipPrivate
 
   public: class LinkSurfaceParams
     {
+      /// \brief Wheel link entity.
+      public: Entity link;
+
       /// \brief Pointer to wheel spin joint.
       public: Entity joint;
 
@@ -95,30 +105,19 @@ class ignition::gazebo::systems::WheelSlipPrivate
       /// \brief Wheel radius extracted from collision shape if not
       /// specified as xml parameter.
       public: double wheelRadius = 0;
+
+      /// \brief Slip parameters last sent to physics, empty until the
+      /// first update.
+      public: std::vector<double> slip;
     };
 
-  /// \brief The map relating links to their respective surface parameters.
-  public: std::map<Entity, LinkSurfaceParams> mapLinkSurfaceParams;
-
-  /// \brief Vector2d equality comparison function.
-  public: std::function<bool(const std::vector<double> &,
-              const std::vector<double> &)>
-          vecEql { [](const std::vector<double> &_a,
-              const std::vector<double> &_b)
-                    {
-                      if (_a.size() != _b.size() ||
-                          _a.size() < 2 ||_b.size() < 2)
-                      {
-                        return false;
-                      }
-
-                      for (size_t i = 0; i < _a.size(); i++)
-                      {
-                        if (std::abs(_a[i] - _b[i]) > 1e-6)
-                          return false;
-                      }
-                      return true;
-                    }};
+  /// \brief Surface parameters of each wheel, in the order they were
+  /// specified.
+  public: std::vector<LinkSurfaceParams> wheels;
+
+  /// \brief Relative change of a slip parameter below which physics isn't
+  /// updated.
+  public: double slipTolerance{1e-3};
 
   public: bool validConfig{false};
   public: bool initialized{false};
@@ -136,6 +135,15 @@ bool WheelSlipPrivate::Load(const EntityComponentManager &_ecm,
     return false;
   }
 
+  this->slipTolerance = _sdf->Get<double>("slip_update_tolerance",
+      this->slipTolerance).first;
+  if (this->slipTolerance < 0)
+  {
+    ignerr << "Found slip update tolerance [" << this->slipTolerance
+           << "], which is negative. Using zero." << std::endl;
+    this->slipTolerance = 0;
+  }
+
   // Read each wheel element
   for (auto wheelElem = _sdf->GetElement("wheel"); wheelElem;
       wheelElem = wheelElem->GetNextElement("wheel"))
@@ -229,10 +237,11 @@ bool WheelSlipPrivate::Load(const EntityComponentManager &_ecm,
       continue;
     }
 
-    this->mapLinkSurfaceParams[link.Entity()] = params;
+    params.link = link.Entity();
+    this->wheels.push_back(params);
   }
 
-  if (this->mapLinkSurfaceParams.empty())
+  if (this->wheels.empty())
   {
     ignerr << "No links and surfaces found, plugin is disabled"
            << std::endl;
@@ -245,11 +254,10 @@ bool WheelSlipPrivate::Load(const EntityComponentManager &_ecm,
 /////////////////////////////////////////////////
 void WheelSlipPrivate::Update(EntityComponentManager &_ecm)
 {
-  for (auto &linkSurface : this->mapLinkSurfaceParams)
+  for (auto &params : this->wheels)
   {
-    auto &params = linkSurface.second;
     const auto * wheelSlipCmdComp =
-      _ecm.Component<components::WheelSlipCmd>(linkSurface.first);
+      _ecm.Component<components::WheelSlipCmd>(params.link);
     if (wheelSlipCmdComp)
     {
       const auto & wheelSlipCmdParams = wheelSlipCmdComp->Data();
@@ -269,7 +277,7 @@ void WheelSlipPrivate::Update(EntityComponentManager &_ecm)
         params.slipComplianceLongitudinal =
           wheelSlipCmdParams.slip_compliance_longitudinal();
       }
-      _ecm.RemoveComponent<components::WheelSlipCmd>(linkSurface.first);
+      _ecm.RemoveComponent<components::WheelSlipCmd>(params.link);
     }
 
     // get user-defined normal force constant
@@ -305,7 +313,17 @@ void WheelSlipPrivate::Update(EntityComponentManager &_ecm)
     double slip1 = speed / force * params.slipComplianceLateral;
     double slip2 = speed / force * params.slipComplianceLongitudinal;
 
-    components::SlipComplianceCmd newSlipCmdComp({slip1, slip2});
+    // Physics keeps the last slip parameters, so they're only sent when
+    // they changed noticeably, such as when the wheel speeds up.
+    if (params.slip.size() == 2u &&
+        !this->SlipChanged(params.slip[0], slip1) &&
+        !this->SlipChanged(params.slip[1], slip2))
+    {
+      continue;
+    }
+    params.slip = {slip1, slip2};
+
+    components::SlipComplianceCmd newSlipCmdComp(params.slip);
 
     auto currSlipCmdComp =
         _ecm.Component<components::SlipComplianceCmd>(params.collision);
@@ -321,6 +339,17 @@ void WheelSlipPrivate::Update(EntityComponentManager &_ecm)
     }
   }
 }
+
+/////////////////////////////////////////////////
+bool WheelSlipPrivate::SlipChanged(double _last, double _slip) const
+{
+  // Going from or to zero slip is always sent
+  if ((_last == 0.0) != (_slip == 0.0))
+    return true;
+  return std::abs(_slip - _last) >
+      this->slipTolerance * std::max(std::abs(_last), std::abs(_slip));
+}
+
 //////////////////////////////////////////////////
 WheelSlip::WheelSlip()
   : dataPtr(std::make_unique<WheelSlipPrivate>())
@@ -358,18 +387,15 @@ void WheelSlip::PreUpdate(const UpdateInfo &_info, EntityComponentManager &_ecm)
   {
     if (this->dataPtr->validConfig)
     {
-      for (const auto &linkSurface : this->dataPtr->mapLinkSurfaceParams)
+      for (const auto &wheel : this->dataPtr->wheels)
       {
-        if (!_ecm.Component<components::WorldAngularVelocity>(
-                linkSurface.first))
+        if (!_ecm.Component<components::WorldAngularVelocity>(wheel.link))
         {
-          _ecm.CreateComponent(linkSurface.first, components::JointVelocity());
+          _ecm.CreateComponent(wheel.link, components::JointVelocity());
         }
-        if (!_ecm.Component<components::JointVelocity>(
-                linkSurface.second.joint))
+        if (!_ecm.Component<components::JointVelocity>(wheel.joint))
         {
-          _ecm.CreateComponent(linkSurface.second.joint,
-                               components::JointVelocity());
+          _ecm.CreateComponent(wheel.joint, components::JointVelocity());
         }
       }
     }
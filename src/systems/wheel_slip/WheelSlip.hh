@@ -49,6 +49,10 @@ namespace systems
   /// the linear wheel spin velocity and divided by the wheel_normal_force
   /// parameter specified below in order to match the units of the
   /// slip parameters.
+  /// The slip parameters are only sent to physics when one of them changes
+  /// by more than the optional `<slip_update_tolerance>` relative to its
+  /// previous value, which defaults to 1e-3. Wheels spinning at a steady
+  /// rate, or standing still, then cost no physics updates.
   ///
   /// A graphical interpretation of these parameters is provided below
   /// for a positive value of slip compliance.
@@ -32,12 +32,14 @@
 #include <ignition/msgs/entity_factory.pb.h>
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <sdf/Root.hh>
 #include <sdf/Error.hh>
 
 #include <ignition/common/Profiler.hh>
+#include <ignition/common/Util.hh>
 #include <ignition/msgs/Utility.hh>
 #include <ignition/plugin/Register.hh>
 #include <ignition/transport/Node.hh>
@@ -57,7 +59,11 @@
 #include "ignition/gazebo/components/Wind.hh"
 #include "ignition/gazebo/components/WindMode.hh"
 
+#include "ignition/gazebo/EnvironmentalForces.hh"
 #include "ignition/gazebo/Link.hh"
+#include "ignition/gazebo/Util.hh"
+
+#include "WindField.hh"
 
 using namespace ignition;
 using namespace gazebo;
@@ -83,11 +89,14 @@ class ignition::gazebo::systems::WindEffectsPrivate
   public: void UpdateWindVelocity(const UpdateInfo &_info,
                                   EntityComponentManager &_ecm);
 
-  /// \brief Calculate and apply forces on links affected by wind.
+  /// \brief Calculate forces on links affected by wind and add them to the
+  /// links' wrenches.
   /// \param[in] _info Simulation update info.
-  /// \param[in] _ecm Mutable reference to the EntityComponentManager.
+  /// \param[in] _ecm Immutable reference to the EntityComponentManager.
+  /// \param[in] _links Kinematics and wrenches of the links.
   public: void ApplyWindForce(const UpdateInfo &_info,
-                              EntityComponentManager &_ecm);
+                              const EntityComponentManager &_ecm,
+                              LinkKinematics &_links);
 
   /// \brief Callback for topic for setting the wind seed velocity and enabling
   /// this system.
@@ -146,6 +155,13 @@ class ignition::gazebo::systems::WindEffectsPrivate
   /// \brief The scaling factor to approximate wind as force on a mass.
   public: double forceApproximationScalingFactor{1.0};
 
+  /// \brief Spatially varying wind added to the uniform wind, if a field was
+  /// given.
+  public: WindField windField;
+
+  /// \brief Wind velocity sampled from the field for each of the windLinks.
+  public: std::vector<math::Vector3d> fieldVelocities;
+
   /// \brief Noise added to magnitude.
   public: sensors::NoisePtr noiseMagnitude;
 
@@ -171,8 +187,31 @@ class ignition::gazebo::systems::WindEffectsPrivate
   /// \brief Current wind velocity seed and global enable/disable state.
   /// This is set by a transport message.
   public: msgs::Wind currentWindInfo;
+
+  /// \brief Whether wind forces are applied on the current step.
+  public: bool applyWind{false};
+
+  /// \brief Links which have a wind mode and their slots in the stage's
+  /// batch.
+  public: std::vector<std::pair<Entity, std::size_t>> windLinks;
+
+  /// \brief Stage which gathers the link kinematics and applies the wrenches
+  public: std::shared_ptr<EnvironmentalForces> forces;
+
+  /// \brief Wind model registered to the stage
+  public: EnvironmentalForces::ModelId forceModel{0};
+
+  /// \brief Destructor
+  public: ~WindEffectsPrivate();
 };
 
+/////////////////////////////////////////////////
+WindEffectsPrivate::~WindEffectsPrivate()
+{
+  if (this->forces)
+    this->forces->RemoveModel(this->forceModel);
+}
+
 /////////////////////////////////////////////////
 void WindEffectsPrivate::Load(EntityComponentManager &_ecm,
                               const std::shared_ptr<const sdf::Element> &_sdf)
@@ -304,6 +343,18 @@ void WindEffectsPrivate::Load(EntityComponentManager &_ecm,
     return;
   }
 
+  if (_sdf->HasElement("wind_field"))
+  {
+    auto sdfField = _sdf->GetElementImpl("wind_field");
+    auto uri = sdfField->Get<std::string>("uri");
+    auto path = common::findFile(asFullPath(uri, _sdf->FilePath()));
+    if (path.empty() || !this->windField.Load(path))
+    {
+      ignerr << "Failed to load <wind_field><uri> [" << uri << "]"
+             << std::endl;
+      return;
+    }
+  }
 
   this->validConfig = true;
 }
@@ -410,42 +461,61 @@ void WindEffectsPrivate::UpdateWindVelocity(const UpdateInfo &_info,
 }
 
 //////////////////////////////////////////////////
-void WindEffectsPrivate::ApplyWindForce(const UpdateInfo &,
-                                        EntityComponentManager &_ecm)
+void WindEffectsPrivate::ApplyWindForce(const UpdateInfo &_info,
+                                        const EntityComponentManager &_ecm,
+                                        LinkKinematics &_links)
 {
   IGN_PROFILE("WindEffectsPrivate::ApplyWindForce");
+  if (!this->applyWind)
+    return;
+
   auto windVel =
       _ecm.Component<components::WorldLinearVelocity>(this->windEntity);
   if (!windVel)
     return;
 
-  Link link;
-
-  _ecm.Each<components::Link, components::Inertial, components::WindMode,
-            components::WorldLinearVelocity>(
-      [&](const Entity &_entity,
-          components::Link *,
-          components::Inertial *_inertial,
-          components::WindMode *_windMode,
-          components::WorldLinearVelocity *_linkVel) -> bool
-      {
-        // Skip links for which the wind is disabled
-        if (!_windMode->Data())
+  // Sample the field at the center of mass of every link in one pass. The
+  // samples are independent, so large batches are split across threads.
+  const bool hasField = this->windField.Valid();
+  if (hasField)
+  {
+    IGN_PROFILE("SampleWindField");
+    const double simTime =
+        std::chrono::duration<double>(_info.simTime).count();
+    this->fieldVelocities.resize(this->windLinks.size());
+    _ecm.ParallelFor(this->windLinks.size(),
+        [&](std::size_t _begin, std::size_t _end)
         {
-          return true;
-        }
+          for (std::size_t i = _begin; i < _end; ++i)
+          {
+            const std::size_t slot = this->windLinks[i].second;
+            this->fieldVelocities[i] = this->windField.Sample(
+                _links.worldPoses[slot].Pos() + _links.comOffsets[slot],
+                simTime);
+          }
+        }, 256u);
+  }
+
+  for (std::size_t i = 0; i < this->windLinks.size(); ++i)
+  {
+    const auto &[entity, slot] = this->windLinks[i];
 
-        link.ResetEntity(_entity);
+    // Skip links for which the wind is disabled
+    auto windMode = _ecm.Component<components::WindMode>(entity);
+    if (!_links.valid[slot] || !windMode || !windMode->Data())
+      continue;
 
-        math::Vector3d windForce = _inertial->Data().MassMatrix().Mass() *
-                                   this->forceApproximationScalingFactor *
-                                   (windVel->Data() - _linkVel->Data());
+    math::Vector3d linkWindVel = windVel->Data();
+    if (hasField)
+      linkWindVel += this->fieldVelocities[i];
 
-        // Apply force at center of mass
-        link.AddWorldForce(_ecm, windForce);
+    math::Vector3d windForce =
+        _links.masses[slot] * this->forceApproximationScalingFactor *
+        (linkWindVel - _links.linearVelocities[slot]);
 
-        return true;
-      });
+    // Apply force at center of mass
+    _links.AddWorldForce(slot, windForce);
+  }
 }
 
 
@@ -526,6 +596,15 @@ void WindEffects::Configure(const Entity &_entity,
       this->dataPtr->currentWindInfo.set_enable_wind(true);
     }
 
+    this->dataPtr->forces = EnvironmentalForces::For(_ecm);
+    this->dataPtr->forceModel = this->dataPtr->forces->AddModel(
+        [this](const UpdateInfo &_info,
+               const EntityComponentManager &_stageEcm,
+               LinkKinematics &_links)
+        {
+          this->dataPtr->ApplyWindForce(_info, _stageEcm, _links);
+        });
+
     auto windLinVelSeed = _ecm.Component<components::WorldLinearVelocitySeed>(
         this->dataPtr->windEntity);
 
@@ -561,25 +640,23 @@ void WindEffects::PreUpdate(const UpdateInfo &_info,
 
   _ecm.EachNew<components::Link, components::WindMode>(
       [&](const Entity &_entity, components::Link *,
-          components::WindMode *_windMode) -> bool
+          components::WindMode *) -> bool
   {
-    if (_windMode->Data())
-    {
-      Link link(_entity);
-      link.EnableVelocityChecks(_ecm, true);
-    }
+    // Wind mode may be enabled later on, so all links with a wind mode are
+    // added to the batch.
+    this->dataPtr->windLinks.emplace_back(_entity,
+        this->dataPtr->forces->AddLink(_ecm, _entity));
     return true;
   });
 
   if (_info.paused)
     return;
 
-  if (!this->dataPtr->currentWindInfo.enable_wind())
-    return;
-
-  this->dataPtr->UpdateWindVelocity(_info, _ecm);
-  this->dataPtr->ApplyWindForce(_info, _ecm);
+  this->dataPtr->applyWind = this->dataPtr->currentWindInfo.enable_wind();
+  if (this->dataPtr->applyWind)
+    this->dataPtr->UpdateWindVelocity(_info, _ecm);
 
+  this->dataPtr->forces->Update(_info, _ecm, this->dataPtr->forceModel);
 }
 
 IGNITION_ADD_PLUGIN(WindEffects, System,
@@ -86,6 +86,12 @@ namespace systems
   /// - `<vertical><noise>`
   /// Parameters for the noise that is added to the vertical wind velocity
   /// magnitude.
+  ///
+  /// - `<wind_field><uri>`
+  /// Optional file with a spatially varying wind, such as the output of a
+  /// CFD simulation, on a regular 3D grid which may also vary over time.
+  /// The field is interpolated at the center of mass of each link and added
+  /// to the uniform wind above. See WindField for the file format.
   class WindEffects:
     public System,
     public ISystemConfigure,
@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "WindField.hh"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include <ignition/common/Console.hh>
+#include <ignition/math/Helpers.hh>
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/// \brief Magic string at the start of wind field files.
+static constexpr char kMagic[8] = {'I', 'G', 'N', 'W', 'I', 'N', 'D', '1'};
+
+/// \brief Header of wind field files.
+struct WindFieldHeader
+{
+  /// \brief Magic string.
+  char magic[8];
+
+  /// \brief Number of samples along x, y, z and time.
+  uint32_t counts[4];
+
+  /// \brief Position of the first sample.
+  double origin[3];
+
+  /// \brief Spacing between samples along x, y and z.
+  double spacing[3];
+
+  /// \brief Time of the first sample.
+  double timeStart;
+
+  /// \brief Spacing between samples in time.
+  double timeStep;
+};
+
+/// \brief Samples are stored right after the header, so it must keep them
+/// aligned.
+static_assert(sizeof(WindFieldHeader) == 88u &&
+    sizeof(WindFieldHeader) % alignof(float) == 0u,
+    "Unexpected wind field header layout");
+
+/// \brief Find the sample before a coordinate and the fraction of the way to
+/// the next one.
+/// \param[in] _value Coordinate.
+/// \param[in] _start Coordinate of the first sample.
+/// \param[in] _step Spacing between samples.
+/// \param[in] _count Number of samples.
+/// \param[out] _fraction Fraction of the way to the next sample.
+/// \return Index of the sample before the coordinate.
+static std::size_t Locate(double _value, double _start, double _step,
+    uint32_t _count, double &_fraction)
+{
+  _fraction = 0.0;
+  if (_count < 2u)
+    return 0u;
+
+  const double f = math::clamp((_value - _start) / _step, 0.0,
+      static_cast<double>(_count - 1u));
+  const auto index = std::min(static_cast<std::size_t>(f),
+      static_cast<std::size_t>(_count - 2u));
+  _fraction = f - index;
+  return index;
+}
+
+//////////////////////////////////////////////////
+WindField::~WindField()
+{
+  this->Reset();
+}
+
+//////////////////////////////////////////////////
+void WindField::Reset()
+{
+#ifndef _WIN32
+  if (this->mapping)
+    munmap(this->mapping, this->mappingSize);
+#endif
+  this->mapping = nullptr;
+  this->mappingSize = 0u;
+  this->buffer.clear();
+  this->samples = nullptr;
+  this->counts = {{0u, 0u, 0u, 0u}};
+}
+
+//////////////////////////////////////////////////
+bool WindField::Load(const std::string &_path)
+{
+  this->Reset();
+
+  std::ifstream file(_path, std::ios::binary | std::ios::ate);
+  if (!file)
+  {
+    ignerr << "Failed to open wind field [" << _path << "]" << std::endl;
+    return false;
+  }
+  const auto fileSize = static_cast<std::size_t>(file.tellg());
+
+  WindFieldHeader header;
+  file.seekg(0);
+  if (fileSize < sizeof(header) ||
+      !file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+  {
+    ignerr << "File [" << _path << "] is not a wind field" << std::endl;
+    return false;
+  }
+
+  std::size_t sampleCount{1u};
+  for (int i = 0; i < 4; ++i)
+    sampleCount *= header.counts[i];
+
+  bool validSpacing = header.counts[3] < 2u || header.timeStep > 0.0;
+  for (int i = 0; i < 3; ++i)
+    validSpacing &= header.counts[i] < 2u || header.spacing[i] > 0.0;
+
+  const std::size_t dataSize = sampleCount * 3u * sizeof(float);
+  if (sampleCount == 0u || !validSpacing ||
+      fileSize - sizeof(header) < dataSize)
+  {
+    ignerr << "Wind field [" << _path << "] has an invalid grid or is "
+           << "truncated" << std::endl;
+    return false;
+  }
+
+#ifndef _WIN32
+  int fd = open(_path.c_str(), O_RDONLY);
+  if (fd >= 0)
+  {
+    void *addr = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr != MAP_FAILED)
+    {
+      this->mapping = addr;
+      this->mappingSize = fileSize;
+      this->samples = reinterpret_cast<const float *>(
+          static_cast<const char *>(addr) + sizeof(header));
+    }
+  }
+#endif
+
+  // Fall back to reading the samples
+  if (!this->samples)
+  {
+    this->buffer.resize(sampleCount * 3u);
+    if (!file.read(reinterpret_cast<char *>(this->buffer.data()), dataSize))
+    {
+      ignerr << "Failed to read wind field [" << _path << "]" << std::endl;
+      this->Reset();
+      return false;
+    }
+    this->samples = this->buffer.data();
+  }
+
+  for (int i = 0; i < 4; ++i)
+    this->counts[i] = header.counts[i];
+  this->origin.Set(header.origin[0], header.origin[1], header.origin[2]);
+  this->spacing.Set(header.spacing[0], header.spacing[1], header.spacing[2]);
+  this->timeStart = header.timeStart;
+  this->timeStep = header.timeStep;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool WindField::Valid() const
+{
+  return nullptr != this->samples;
+}
+
+//////////////////////////////////////////////////
+math::Vector3d WindField::At(std::size_t _i, std::size_t _j, std::size_t _k,
+    std::size_t _t) const
+{
+  const std::size_t index = _i + this->counts[0] * (_j + this->counts[1] *
+      (_k + this->counts[2] * _t));
+  const float *v = this->samples + 3u * index;
+  return {v[0], v[1], v[2]};
+}
+
+//////////////////////////////////////////////////
+math::Vector3d WindField::Sample(const math::Vector3d &_position,
+    double _time) const
+{
+  if (!this->samples)
+    return math::Vector3d::Zero;
+
+  std::array<std::size_t, 4> lo;
+  std::array<double, 4> r;
+  for (int a = 0; a < 3; ++a)
+  {
+    lo[a] = Locate(_position[a], this->origin[a], this->spacing[a],
+        this->counts[a], r[a]);
+  }
+  lo[3] = Locate(_time, this->timeStart, this->timeStep, this->counts[3],
+      r[3]);
+
+  // Axes with a single sample don't need their upper neighbor
+  std::array<std::size_t, 4> hi;
+  for (int a = 0; a < 4; ++a)
+    hi[a] = this->counts[a] > 1u ? lo[a] + 1u : lo[a];
+
+  // Trilinear interpolation in space at both ends of the time interval
+  math::Vector3d result;
+  for (int t = 0; t < 2; ++t)
+  {
+    const double wt = t ? r[3] : 1.0 - r[3];
+    if (wt <= 0.0)
+      continue;
+    const std::size_t ti = t ? hi[3] : lo[3];
+
+    for (int k = 0; k < 2; ++k)
+    {
+      const double wk = wt * (k ? r[2] : 1.0 - r[2]);
+      if (wk <= 0.0)
+        continue;
+      const std::size_t ki = k ? hi[2] : lo[2];
+
+      for (int j = 0; j < 2; ++j)
+      {
+        const double wj = wk * (j ? r[1] : 1.0 - r[1]);
+        if (wj <= 0.0)
+          continue;
+        const std::size_t ji = j ? hi[1] : lo[1];
+
+        result += wj * ((1.0 - r[0]) * this->At(lo[0], ji, ki, ti) +
+            r[0] * this->At(hi[0], ji, ki, ti));
+      }
+    }
+  }
+  return result;
+}
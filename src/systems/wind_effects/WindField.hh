@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_WINDEFFECTS_WINDFIELD_HH_
+#define IGNITION_GAZEBO_SYSTEMS_WINDEFFECTS_WINDFIELD_HH_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/wind-effects-system/Export.hh>
+#include <ignition/math/Vector3.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  /// \brief Wind velocity sampled on a regular grid, such as the output of a
+  /// CFD simulation, and optionally over time.
+  ///
+  /// The field is read from a little-endian binary file with the layout:
+  /// - 8 bytes: magic string `IGNWIND1`
+  /// - 4 x uint32: number of samples along x, y, z and time
+  /// - 3 x double: position of the first sample [m]
+  /// - 3 x double: spacing between samples along x, y and z [m]
+  /// - 2 x double: time of the first sample and spacing in time [s]
+  /// - 3 x float per sample: wind velocity [m/s], with x varying fastest,
+  ///   then y, z and time.
+  ///
+  /// The file is memory mapped where supported, so that large fields are
+  /// paged in on demand instead of being copied. Positions are interpolated
+  /// trilinearly, and time linearly. Positions and times outside of the grid
+  /// take the value at the closest edge.
+  class IGNITION_GAZEBO_WIND_EFFECTS_SYSTEM_VISIBLE WindField
+  {
+    /// \brief Constructor. The field is empty until loaded.
+    public: WindField() = default;
+
+    /// \brief Destructor. Unmaps the file.
+    public: ~WindField();
+
+    /// \brief Fields own a mapping, so they aren't copyable.
+    public: WindField(const WindField &) = delete;
+
+    /// \brief Fields own a mapping, so they aren't copyable.
+    public: WindField &operator=(const WindField &) = delete;
+
+    /// \brief Load a field from a file, replacing the current one.
+    /// \param[in] _path Path to the file.
+    /// \return True if the file was loaded. On failure the field is empty.
+    public: bool Load(const std::string &_path);
+
+    /// \brief Whether a field has been loaded.
+    /// \return True if the field has samples.
+    public: bool Valid() const;
+
+    /// \brief Sample the wind velocity.
+    /// \param[in] _position Position in the world frame [m].
+    /// \param[in] _time Simulation time [s].
+    /// \return Wind velocity [m/s], or zero if the field is empty.
+    public: math::Vector3d Sample(const math::Vector3d &_position,
+        double _time) const;
+
+    /// \brief Release the mapping and reset the field to empty.
+    private: void Reset();
+
+    /// \brief Velocity at one grid sample.
+    /// \param[in] _i Index along x.
+    /// \param[in] _j Index along y.
+    /// \param[in] _k Index along z.
+    /// \param[in] _t Index in time.
+    /// \return Wind velocity [m/s].
+    private: math::Vector3d At(std::size_t _i, std::size_t _j, std::size_t _k,
+        std::size_t _t) const;
+
+    /// \brief Number of samples along x, y, z and time.
+    private: std::array<uint32_t, 4> counts{{0u, 0u, 0u, 0u}};
+
+    /// \brief Position of the first sample.
+    private: math::Vector3d origin;
+
+    /// \brief Spacing between samples along each axis.
+    private: math::Vector3d spacing;
+
+    /// \brief Time of the first sample.
+    private: double timeStart{0.0};
+
+    /// \brief Spacing between samples in time.
+    private: double timeStep{0.0};
+
+    /// \brief First float of the samples, within the mapping or the buffer.
+    private: const float *samples{nullptr};
+
+    /// \brief Start of the memory mapped file, if mapped.
+    private: void *mapping{nullptr};
+
+    /// \brief Size of the memory mapped file.
+    private: std::size_t mappingSize{0u};
+
+    /// \brief Copy of the samples, where the file can't be mapped.
+    private: std::vector<float> buffer;
+  };
+}
+}
+}
+}
+#endif
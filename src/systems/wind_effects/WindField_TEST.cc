@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+
+#include <ignition/common/Filesystem.hh>
+
+#include "WindField.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/////////////////////////////////////////////////
+class WindFieldTest : public ::testing::Test
+{
+  protected: void SetUp() override
+  {
+    this->path = common::joinPaths(common::cwd(), "wind_field_test.bin");
+  }
+
+  protected: void TearDown() override
+  {
+    common::removeAll(this->path);
+  }
+
+  /// \brief Write a field on a unit grid starting at the origin.
+  /// \param[in] _counts Number of samples along x, y, z and time.
+  /// \param[in] _velocity Velocity at a sample, given its position and time.
+  /// \param[in] _truncate Number of bytes left out at the end of the file.
+  protected: void Write(const uint32_t (&_counts)[4],
+      const std::function<math::Vector3d(const math::Vector3d &, double)>
+      &_velocity, std::size_t _truncate = 0u)
+  {
+    std::string data("IGNWIND1");
+    auto append = [&](const auto &_value)
+    {
+      data.append(reinterpret_cast<const char *>(&_value), sizeof(_value));
+    };
+    for (auto count : _counts)
+      append(count);
+    for (double value : {0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 0.0, 1.0})
+      append(value);
+
+    for (uint32_t t = 0; t < _counts[3]; ++t)
+      for (uint32_t k = 0; k < _counts[2]; ++k)
+        for (uint32_t j = 0; j < _counts[1]; ++j)
+          for (uint32_t i = 0; i < _counts[0]; ++i)
+          {
+            auto v = _velocity(math::Vector3d(i, j, k), t);
+            for (int a = 0; a < 3; ++a)
+              append(static_cast<float>(v[a]));
+          }
+
+    data.resize(data.size() - _truncate);
+    std::ofstream file(this->path, std::ios::binary);
+    file.write(data.data(), data.size());
+  }
+
+  /// \brief Path to the test field.
+  protected: std::string path;
+};
+
+/////////////////////////////////////////////////
+TEST_F(WindFieldTest, Invalid)
+{
+  WindField field;
+  EXPECT_FALSE(field.Valid());
+  EXPECT_EQ(math::Vector3d::Zero, field.Sample({1, 2, 3}, 0.0));
+
+  EXPECT_FALSE(field.Load(this->path + "_missing"));
+
+  auto constant = [](const math::Vector3d &, double)
+  {
+    return math::Vector3d(1, 2, 3);
+  };
+  this->Write({2, 2, 2, 1}, constant, 4u);
+  EXPECT_FALSE(field.Load(this->path));
+  EXPECT_FALSE(field.Valid());
+
+  this->Write({2, 2, 2, 1}, constant);
+  EXPECT_TRUE(field.Load(this->path));
+  EXPECT_TRUE(field.Valid());
+  EXPECT_EQ(math::Vector3d(1, 2, 3), field.Sample({0.5, 0.5, 0.5}, 0.0));
+}
+
+/////////////////////////////////////////////////
+TEST_F(WindFieldTest, Trilinear)
+{
+  // Linear fields are reproduced exactly by trilinear interpolation
+  this->Write({4, 3, 5, 1}, [](const math::Vector3d &_p, double)
+      {
+        return math::Vector3d(_p.X() + 2 * _p.Y(), -_p.Z(), _p.X() - _p.Y());
+      });
+
+  WindField field;
+  ASSERT_TRUE(field.Load(this->path));
+
+  for (const math::Vector3d &p : {math::Vector3d(0.5, 0.5, 0.5),
+      math::Vector3d(2.25, 1.75, 3.5), math::Vector3d(3, 2, 4)})
+  {
+    auto v = field.Sample(p, 10.0);
+    EXPECT_NEAR(p.X() + 2 * p.Y(), v.X(), 1e-6);
+    EXPECT_NEAR(-p.Z(), v.Y(), 1e-6);
+    EXPECT_NEAR(p.X() - p.Y(), v.Z(), 1e-6);
+  }
+
+  // Outside of the grid, the closest edge is used
+  EXPECT_EQ(field.Sample({3, 2, 4}, 0.0), field.Sample({10, 5, 40}, 0.0));
+  EXPECT_EQ(field.Sample({0, 0, 0}, 0.0), field.Sample({-1, -1, -1}, 0.0));
+}
+
+/////////////////////////////////////////////////
+TEST_F(WindFieldTest, Time)
+{
+  this->Write({2, 2, 2, 3}, [](const math::Vector3d &, double _t)
+      {
+        return math::Vector3d(_t * _t, 0, 0);
+      });
+
+  WindField field;
+  ASSERT_TRUE(field.Load(this->path));
+
+  EXPECT_NEAR(0.0, field.Sample({0.5, 0.5, 0.5}, 0.0).X(), 1e-6);
+  EXPECT_NEAR(0.5, field.Sample({0.5, 0.5, 0.5}, 0.5).X(), 1e-6);
+  EXPECT_NEAR(2.5, field.Sample({0.5, 0.5, 0.5}, 1.5).X(), 1e-6);
+  EXPECT_NEAR(4.0, field.Sample({0.5, 0.5, 0.5}, 100.0).X(), 1e-6);
+}
@@ -30,6 +30,8 @@
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/World.hh"
 
+#include "../helpers/BenchmarkInstrumentation.hh"
+
 
 using namespace ignition;
 using namespace gazebo;
@@ -70,6 +72,7 @@ class EntityComponentManagerFixture: public benchmark::Fixture
 BENCHMARK_DEFINE_F(EntityComponentManagerFixture, EachNoCache)
 (benchmark::State &_st)
 {
+  test::BenchmarkInstrumentation instrumentation(_st);
   for (auto _ : _st)
   {
     auto matchingEntityCount = _st.range(0);
@@ -95,6 +98,7 @@ BENCHMARK_DEFINE_F(EntityComponentManagerFixture, EachNoCache)
 BENCHMARK_DEFINE_F(EntityComponentManagerFixture, EachCache)
 (benchmark::State &_st)
 {
+  test::BenchmarkInstrumentation instrumentation(_st);
   for (auto _ : _st)
   {
     auto matchingEntityCount = _st.range(0);
@@ -150,6 +154,7 @@ class ManyComponentFixture: public benchmark::Fixture
 BENCHMARK_DEFINE_F(ManyComponentFixture, Each1ComponentCache)
 (benchmark::State &_st)
 {
+  test::BenchmarkInstrumentation instrumentation(_st);
   for (auto _ : _st)
   {
     auto entityCount = _st.range(0);
@@ -176,6 +181,7 @@ BENCHMARK_DEFINE_F(ManyComponentFixture, Each1ComponentCache)
 BENCHMARK_DEFINE_F(ManyComponentFixture, Each5ComponentCache)
 (benchmark::State &_st)
 {
+  test::BenchmarkInstrumentation instrumentation(_st);
   for (auto _ : _st)
   {
     auto entityCount = _st.range(0);
@@ -211,6 +217,7 @@ BENCHMARK_DEFINE_F(ManyComponentFixture, Each5ComponentCache)
 BENCHMARK_DEFINE_F(ManyComponentFixture, Each10ComponentCache)
 (benchmark::State &_st)
 {
+  test::BenchmarkInstrumentation instrumentation(_st);
   for (auto _ : _st)
   {
     auto entityCount = _st.range(0);
@@ -256,6 +263,7 @@ BENCHMARK_DEFINE_F(ManyComponentFixture, Each10ComponentCache)
 BENCHMARK_DEFINE_F(ManyComponentFixture, Each1ComponentNoCache)
 (benchmark::State &_st)
 {
+  test::BenchmarkInstrumentation instrumentation(_st);
   for (auto _ : _st)
   {
     auto entityCount = _st.range(0);
@@ -282,6 +290,7 @@ BENCHMARK_DEFINE_F(ManyComponentFixture, Each1ComponentNoCache)
 BENCHMARK_DEFINE_F(ManyComponentFixture, Each5ComponentNoCache)
 (benchmark::State &_st)
 {
+  test::BenchmarkInstrumentation instrumentation(_st);
   for (auto _ : _st)
   {
     auto entityCount = _st.range(0);
@@ -317,6 +326,7 @@ BENCHMARK_DEFINE_F(ManyComponentFixture, Each5ComponentNoCache)
 BENCHMARK_DEFINE_F(ManyComponentFixture, Each10ComponentNoCache)
 (benchmark::State &_st)
 {
+  test::BenchmarkInstrumentation instrumentation(_st);
   for (auto _ : _st)
   {
     auto entityCount = _st.range(0);
@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "ignition/gazebo/Entity.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+
+#include "ignition/gazebo/components/AngularVelocity.hh"
+#include "ignition/gazebo/components/Inertial.hh"
+#include "ignition/gazebo/components/LinearVelocity.hh"
+#include "ignition/gazebo/components/Link.hh"
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/World.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace components;
+
+/// \brief Exposes the functions the simulation runner calls between steps.
+class BenchmarkEcm : public EntityComponentManager
+{
+  public: void EndStep()
+  {
+    this->ClearNewlyCreatedEntities();
+    this->ProcessRemoveEntityRequests();
+    this->ClearRemovedComponents();
+    this->SetAllComponentsUnchanged();
+  }
+};
+
+/// \brief Populate an ECM with models of one link each, which have the
+/// components the physics system keeps track of.
+/// \param[in] _ecm ECM to populate.
+/// \param[in] _count Number of models.
+/// \return The models.
+static std::vector<Entity> Populate(EntityComponentManager &_ecm,
+    int64_t _count)
+{
+  Entity world = _ecm.CreateEntity();
+  _ecm.CreateComponent(world, World());
+  _ecm.CreateComponent(world, components::Name("default"));
+
+  std::vector<Entity> models;
+  for (int64_t i = 0; i < _count; ++i)
+  {
+    Entity model = _ecm.CreateEntity();
+    _ecm.CreateComponent(model, Model());
+    _ecm.CreateComponent(model, components::Name("model_" +
+        std::to_string(i)));
+    _ecm.CreateComponent(model, ParentEntity(world));
+    _ecm.CreateComponent(model, Pose(math::Pose3d(i, 0, 0, 0, 0, 0)));
+
+    Entity link = _ecm.CreateEntity();
+    _ecm.CreateComponent(link, Link());
+    _ecm.CreateComponent(link, components::Name("link"));
+    _ecm.CreateComponent(link, ParentEntity(model));
+    _ecm.CreateComponent(link, Pose());
+    _ecm.CreateComponent(link, Inertial());
+    _ecm.CreateComponent(link, LinearVelocity());
+    _ecm.CreateComponent(link, AngularVelocity());
+
+    models.push_back(model);
+  }
+  return models;
+}
+
+// NOLINTNEXTLINE
+void BM_CreateEntities(benchmark::State &_st)
+{
+  for (auto _ : _st)
+  {
+    _st.PauseTiming();
+    auto ecm = std::make_unique<BenchmarkEcm>();
+    _st.ResumeTiming();
+
+    Populate(*ecm, _st.range(0));
+
+    _st.PauseTiming();
+    ecm.reset();
+    _st.ResumeTiming();
+  }
+  _st.SetItemsProcessed(_st.iterations() * _st.range(0));
+}
+
+// NOLINTNEXTLINE
+void BM_RemoveEntities(benchmark::State &_st)
+{
+  for (auto _ : _st)
+  {
+    _st.PauseTiming();
+    BenchmarkEcm ecm;
+    auto models = Populate(ecm, _st.range(0));
+    ecm.EndStep();
+    _st.ResumeTiming();
+
+    for (auto model : models)
+      ecm.RequestRemoveEntity(model);
+    ecm.EndStep();
+
+    if (ecm.EntityCount() != 1u)
+      _st.SkipWithError("Failed to remove all models");
+  }
+  _st.SetItemsProcessed(_st.iterations() * _st.range(0));
+}
+
+// NOLINTNEXTLINE
+void BM_CloneEntities(benchmark::State &_st)
+{
+  for (auto _ : _st)
+  {
+    _st.PauseTiming();
+    BenchmarkEcm ecm;
+    auto models = Populate(ecm, 1);
+    ecm.EndStep();
+    auto world = ecm.EntityByComponents(World());
+    _st.ResumeTiming();
+
+    for (int64_t i = 0; i < _st.range(0); ++i)
+    {
+      if (kNullEntity == ecm.Clone(models[0], world, "", true))
+        _st.SkipWithError("Failed to clone model");
+    }
+  }
+  _st.SetItemsProcessed(_st.iterations() * _st.range(0));
+}
+
+// NOLINTNEXTLINE
+void BM_RebuildViews(benchmark::State &_st)
+{
+  BenchmarkEcm ecm;
+  Populate(ecm, _st.range(0));
+  ecm.EndStep();
+
+  // Create the views that a typical set of systems would use
+  ecm.Each<Model, components::Name, Pose>(
+      [](const Entity &, const Model *, const components::Name *,
+         const Pose *) { return true; });
+  ecm.Each<Link, Pose, LinearVelocity, AngularVelocity>(
+      [](const Entity &, const Link *, const Pose *, const LinearVelocity *,
+         const AngularVelocity *) { return true; });
+  ecm.Each<Link, Inertial, ParentEntity>(
+      [](const Entity &, const Link *, const Inertial *,
+         const ParentEntity *) { return true; });
+
+  for (auto _ : _st)
+  {
+    ecm.RebuildViews();
+  }
+  _st.SetItemsProcessed(_st.iterations() * _st.range(0));
+}
+
+/// \brief Iterate over all links with a number of components.
+/// \param[in] _ecm ECM to iterate.
+/// \param[in] _components Number of components, from 1 to 6.
+/// \return Number of entities visited.
+static int64_t EachLink(const EntityComponentManager &_ecm, int64_t _components)
+{
+  int64_t count{0};
+  auto visit = [&](const Entity &, const auto *...) { ++count; return true; };
+
+  switch (_components)
+  {
+    case 1:
+      _ecm.Each<Link>(visit);
+      break;
+    case 2:
+      _ecm.Each<Link, Pose>(visit);
+      break;
+    case 3:
+      _ecm.Each<Link, Pose, LinearVelocity>(visit);
+      break;
+    case 4:
+      _ecm.Each<Link, Pose, LinearVelocity, AngularVelocity>(visit);
+      break;
+    case 5:
+      _ecm.Each<Link, Pose, LinearVelocity, AngularVelocity, Inertial>(visit);
+      break;
+    default:
+      _ecm.Each<Link, Pose, LinearVelocity, AngularVelocity, Inertial,
+          ParentEntity>(visit);
+      break;
+  }
+  return count;
+}
+
+// NOLINTNEXTLINE
+void BM_EachComponents(benchmark::State &_st)
+{
+  BenchmarkEcm ecm;
+  Populate(ecm, _st.range(0));
+  ecm.EndStep();
+
+  // Build the view outside of the timed loop
+  EachLink(ecm, _st.range(1));
+
+  for (auto _ : _st)
+  {
+    if (EachLink(ecm, _st.range(1)) != _st.range(0))
+      _st.SkipWithError("Failed to match correct number of entities");
+  }
+  _st.SetItemsProcessed(_st.iterations() * _st.range(0));
+}
+
+// NOLINTNEXTLINE
+void BM_PoseWriteBack(benchmark::State &_st)
+{
+  BenchmarkEcm ecm;
+  Populate(ecm, _st.range(0));
+  ecm.EndStep();
+
+  // Write the pose of every link back the way the physics system does
+  std::vector<Entity> links;
+  ecm.Each<Link, Pose>(
+      [&](const Entity &_entity, const Link *, const Pose *)
+      {
+        links.push_back(_entity);
+        return true;
+      });
+
+  double z{0.0};
+  for (auto _ : _st)
+  {
+    z += 1e-3;
+    for (auto link : links)
+    {
+      ecm.SetComponentData<Pose>(link, math::Pose3d(0, 0, z, 0, 0, 0));
+      ecm.SetComponentData<LinearVelocity>(link, math::Vector3d(0, 0, z));
+    }
+    ecm.EndStep();
+  }
+  _st.SetItemsProcessed(_st.iterations() * _st.range(0));
+}
+
+BENCHMARK(BM_CreateEntities)
+  ->Arg(100)
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_RemoveEntities)
+  ->Arg(100)
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_CloneEntities)
+  ->Arg(100)
+  ->Arg(1000)
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_RebuildViews)
+  ->Arg(100)
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
+/// Entity counts and number of components for BM_EachComponents.
+static void EachComponentsArgs(benchmark::internal::Benchmark *_b)
+{
+  for (int entityCount : {1000, 10000})
+  {
+    for (int components = 1; components <= 6; ++components)
+      _b->Args({entityCount, components});
+  }
+}
+
+BENCHMARK(BM_EachComponents)
+  ->Apply(EachComponentsArgs)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_PoseWriteBack)
+  ->Arg(100)
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Unit(benchmark::kMicrosecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
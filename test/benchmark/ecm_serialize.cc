@@ -32,6 +32,8 @@
 
 #include "ignition/gazebo/components/Factory.hh"
 
+#include "../helpers/BenchmarkInstrumentation.hh"
+
 
 namespace ignition
 {
@@ -75,16 +77,17 @@ void BM_Serialize1Component(benchmark::State &_st)
 {
   size_t serializedSize = 0;
   auto entityCount = _st.range(0);
-  for (auto _: _st)
+  test::BenchmarkInstrumentation instrumentation(_st);
+  for (auto _ : _st)
   {
-    _st.PauseTiming();
+    instrumentation.PauseTiming();
     auto mgr = std::make_unique<EntityComponentManager>();
     for (int ii = 0; ii < entityCount; ++ii)
     {
       auto e = mgr->CreateEntity();
       mgr->CreateComponent(e, IntComponent(ii));
     }
-    _st.ResumeTiming();
+    instrumentation.ResumeTiming();
 
     auto stateMsg = mgr->State();
 #if GOOGLE_PROTOBUF_VERSION >= 3004000
@@ -103,9 +106,10 @@ void BM_Serialize5Component(benchmark::State &_st)
 {
   size_t serializedSize = 0;
   auto entityCount = _st.range(0);
-  for (auto _: _st)
+  test::BenchmarkInstrumentation instrumentation(_st);
+  for (auto _ : _st)
   {
-    _st.PauseTiming();
+    instrumentation.PauseTiming();
     auto mgr = std::make_unique<EntityComponentManager>();
     for (int ii = 0; ii < entityCount; ++ii)
     {
@@ -116,7 +120,7 @@ void BM_Serialize5Component(benchmark::State &_st)
       mgr->CreateComponent(e, StringComponent("foobar"));
       mgr->CreateComponent(e, BoolComponent(ii%2));
     }
-    _st.ResumeTiming();
+    instrumentation.ResumeTiming();
 
     auto stateMsg = mgr->State();
 #if GOOGLE_PROTOBUF_VERSION >= 3004000
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/msgs/serialized_map.pb.h>
+
+#include "ignition/gazebo/Entity.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+
+#include "ignition/gazebo/components/LinearVelocity.hh"
+#include "ignition/gazebo/components/Link.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/Pose.hh"
+
+#include "../helpers/BenchmarkInstrumentation.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace components;
+
+/// \brief Exposes the functions the simulation runner calls between steps.
+class BenchmarkEcm : public EntityComponentManager
+{
+  public: void EndStep()
+  {
+    this->ClearNewlyCreatedEntities();
+    this->ProcessRemoveEntityRequests();
+    this->ClearRemovedComponents();
+    this->SetAllComponentsUnchanged();
+  }
+};
+
+/// \brief Populate an ECM with links.
+/// \param[in] _ecm ECM to populate.
+/// \param[in] _count Number of links.
+/// \return The links.
+static std::vector<Entity> Populate(BenchmarkEcm &_ecm, int64_t _count)
+{
+  std::vector<Entity> links;
+  for (int64_t i = 0; i < _count; ++i)
+  {
+    Entity link = _ecm.CreateEntity();
+    _ecm.CreateComponent(link, Link());
+    _ecm.CreateComponent(link, components::Name("link"));
+    _ecm.CreateComponent(link, Pose());
+    _ecm.CreateComponent(link, LinearVelocity());
+    links.push_back(link);
+  }
+  _ecm.EndStep();
+  return links;
+}
+
+/// \brief Change the pose of a percentage of the links.
+/// \param[in] _ecm ECM holding the links.
+/// \param[in] _links The links.
+/// \param[in] _percent Percentage of links to change.
+/// \param[in] _z Height to set.
+static void Change(BenchmarkEcm &_ecm, const std::vector<Entity> &_links,
+    int64_t _percent, double _z)
+{
+  const auto count = _links.size() * _percent / 100;
+  for (std::size_t i = 0; i < count; ++i)
+    _ecm.SetComponentData<Pose>(_links[i], math::Pose3d(0, 0, _z, 0, 0, 0));
+}
+
+// NOLINTNEXTLINE
+void BM_ChangedState(benchmark::State &_st)
+{
+  BenchmarkEcm ecm;
+  auto links = Populate(ecm, _st.range(0));
+
+  double z{0.0};
+  test::BenchmarkInstrumentation instrumentation(_st);
+  for (auto _ : _st)
+  {
+    instrumentation.PauseTiming();
+    z += 1e-3;
+    Change(ecm, links, _st.range(1), z);
+    instrumentation.ResumeTiming();
+
+    msgs::SerializedStateMap state;
+    ecm.ChangedState(state);
+    benchmark::DoNotOptimize(state);
+
+    instrumentation.PauseTiming();
+    ecm.EndStep();
+    instrumentation.ResumeTiming();
+  }
+  _st.SetItemsProcessed(_st.iterations() * _st.range(0) * _st.range(1) / 100);
+}
+
+// NOLINTNEXTLINE
+void BM_SetState(benchmark::State &_st)
+{
+  BenchmarkEcm source;
+  auto links = Populate(source, _st.range(0));
+
+  // Start the destination from the full state of the source
+  BenchmarkEcm destination;
+  msgs::SerializedStateMap full;
+  source.State(full);
+  destination.SetState(full);
+  destination.EndStep();
+
+  double z{0.0};
+  test::BenchmarkInstrumentation instrumentation(_st);
+  for (auto _ : _st)
+  {
+    instrumentation.PauseTiming();
+    z += 1e-3;
+    Change(source, links, _st.range(1), z);
+    msgs::SerializedStateMap state;
+    source.ChangedState(state);
+    source.EndStep();
+    instrumentation.ResumeTiming();
+
+    destination.SetState(state);
+
+    instrumentation.PauseTiming();
+    destination.EndStep();
+    instrumentation.ResumeTiming();
+  }
+  _st.SetItemsProcessed(_st.iterations() * _st.range(0) * _st.range(1) / 100);
+}
+
+/// Entity counts and percentage of changed entities.
+static void StateArgs(benchmark::internal::Benchmark *_b)
+{
+  for (int entityCount : {1000, 10000})
+  {
+    for (int percent : {1, 10, 100})
+      _b->Args({entityCount, percent});
+  }
+}
+
+BENCHMARK(BM_ChangedState)
+  ->Apply(StateArgs)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_SetState)
+  ->Apply(StateArgs)
+  ->Unit(benchmark::kMicrosecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <ignition/common/Console.hh>
+#include <sdf/Root.hh>
+
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/EventManager.hh"
+#include "ignition/gazebo/SdfEntityCreator.hh"
+#include "ignition/gazebo/Server.hh"
+#include "ignition/gazebo/ServerConfig.hh"
+
+#include "../helpers/WorldGenerator.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Canonical worlds which are benchmarked.
+enum CanonicalWorld : int64_t
+{
+  /// \brief Only a ground plane.
+  EMPTY = 0,
+
+  /// \brief 1000 boxes resting on the ground plane.
+  BOXES = 1,
+
+  /// \brief 100 robots with 4 links and 3 revolute joints each.
+  ROBOTS = 2
+};
+
+/// \brief Generator of a canonical world.
+/// \param[in] _world Which world.
+/// \return Generator of the world.
+static test::WorldGenerator Generator(int64_t _world)
+{
+  test::WorldGenerator generator;
+  generator.models = 0u;
+  if (_world == BOXES)
+  {
+    generator.models = 1000u;
+    generator.spacing = 0.5;
+  }
+  else if (_world == ROBOTS)
+  {
+    generator.models = 100u;
+    generator.links = 4u;
+  }
+  return generator;
+}
+
+// NOLINTNEXTLINE
+void BM_LoadWorld(benchmark::State &_st)
+{
+  const auto generator = Generator(_st.range(0));
+  sdf::Root root;
+  auto errors = root.LoadSdfString(generator.Sdf());
+  if (!errors.empty() || root.WorldCount() != 1u)
+  {
+    _st.SkipWithError("Failed to parse world");
+    return;
+  }
+
+  for (auto _ : _st)
+  {
+    EntityComponentManager ecm;
+    EventManager eventMgr;
+    SdfEntityCreator creator(ecm, eventMgr);
+    benchmark::DoNotOptimize(creator.CreateEntities(root.WorldByIndex(0)));
+  }
+}
+
+// NOLINTNEXTLINE
+void BM_StepWorld(benchmark::State &_st)
+{
+  common::Console::SetVerbosity(1);
+
+  ServerConfig config;
+  config.SetSdfString(Generator(_st.range(0)).Sdf());
+  Server server(config);
+
+  // Load the systems and let the first contacts settle
+  server.Run(true, 10, false);
+
+  for (auto _ : _st)
+  {
+    server.Run(true, 1, false);
+  }
+  _st.SetItemsProcessed(_st.iterations());
+}
+
+/// All canonical worlds.
+static void WorldArgs(benchmark::internal::Benchmark *_b)
+{
+  _b->ArgName("world");
+  for (int64_t world : {EMPTY, BOXES, ROBOTS})
+    _b->Arg(world);
+}
+
+BENCHMARK(BM_LoadWorld)
+  ->Apply(WorldArgs)
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_StepWorld)
+  ->Apply(WorldArgs)
+  ->Unit(benchmark::kMicrosecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
@@ -0,0 +1,313 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_TEST_HELPERS_BENCHMARKINSTRUMENTATION_HH_
+#define IGNITION_GAZEBO_TEST_HELPERS_BENCHMARKINSTRUMENTATION_HH_
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <ignition/common/Console.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+namespace test
+{
+/// \brief Heap allocations made while a BenchmarkInstrumentation counts.
+struct AllocationCounters
+{
+  /// \brief True while allocations are counted.
+  std::atomic<bool> counting{false};
+
+  /// \brief Number of allocations.
+  std::atomic<uint64_t> allocations{0u};
+
+  /// \brief Number of bytes allocated.
+  std::atomic<uint64_t> bytes{0u};
+};
+
+/// \brief Get the allocation counters of the process.
+/// \return The counters.
+inline AllocationCounters &Allocations()
+{
+  static AllocationCounters counters;
+  return counters;
+}
+
+/// \brief Counts heap allocations and, optionally, hardware events during
+/// the timed part of a benchmark, and reports them as counters per
+/// iteration. Nothing is counted unless the `IGN_BENCHMARK_INSTRUMENT`
+/// environment variable is set, to:
+///
+/// * `alloc`: Report the `allocs` and `alloc_bytes` made by all threads.
+/// * `perf`: Also report the `instructions` and `cache_misses` of the
+///   benchmark thread and threads it starts while counting, sampled through
+///   Linux perf events. They're left out if perf events can't be opened,
+///   for example because of `/proc/sys/kernel/perf_event_paranoid`.
+///
+/// Allocations are counted by replacing the global operator new, so this
+/// header must be included by a single source file of each benchmark.
+///
+/// ## Usage
+///
+///  void BM_Something(benchmark::State &_st)
+///  {
+///    test::BenchmarkInstrumentation instrumentation(_st);
+///    for (auto _ : _st)
+///    {
+///      instrumentation.PauseTiming();
+///      // Untimed setup
+///      instrumentation.ResumeTiming();
+///
+///      // Timed and counted code
+///    }
+///  }
+class BenchmarkInstrumentation
+{
+  /// \brief Constructor, which starts counting. Construct it right before
+  /// the benchmark loop.
+  /// \param[in] _st State of the benchmark.
+  public: explicit BenchmarkInstrumentation(benchmark::State &_st)
+    : st(_st)
+  {
+    const char *mode = std::getenv("IGN_BENCHMARK_INSTRUMENT");
+    if (nullptr == mode)
+      return;
+
+    this->countAllocations = true;
+    if (std::string(mode) == "perf")
+      this->OpenPerfEvents();
+
+    this->Start();
+  }
+
+  /// \brief Destructor, which stops counting and reports the counters.
+  public: ~BenchmarkInstrumentation()
+  {
+    if (!this->countAllocations)
+      return;
+
+    this->Stop();
+
+    this->st.counters["allocs"] = benchmark::Counter(
+        static_cast<double>(this->allocations),
+        benchmark::Counter::kAvgIterations);
+    this->st.counters["alloc_bytes"] = benchmark::Counter(
+        static_cast<double>(this->bytes),
+        benchmark::Counter::kAvgIterations);
+
+    for (auto &event : this->events)
+    {
+      this->st.counters[event.name] = benchmark::Counter(
+          static_cast<double>(event.count),
+          benchmark::Counter::kAvgIterations);
+#ifdef __linux__
+      close(event.fd);
+#endif
+    }
+  }
+
+  /// \brief Pause timing and counting, for setup which isn't measured.
+  public: void PauseTiming()
+  {
+    this->st.PauseTiming();
+    if (this->countAllocations)
+      this->Stop();
+  }
+
+  /// \brief Resume timing and counting.
+  public: void ResumeTiming()
+  {
+    if (this->countAllocations)
+      this->Start();
+    this->st.ResumeTiming();
+  }
+
+  /// \brief Start counting.
+  private: void Start()
+  {
+    auto &counters = Allocations();
+    this->startAllocations = counters.allocations.load();
+    this->startBytes = counters.bytes.load();
+    counters.counting = true;
+
+#ifdef __linux__
+    for (auto &event : this->events)
+      ioctl(event.fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+  }
+
+  /// \brief Stop counting, and accumulate what was counted since Start.
+  private: void Stop()
+  {
+#ifdef __linux__
+    for (auto &event : this->events)
+    {
+      ioctl(event.fd, PERF_EVENT_IOC_DISABLE, 0);
+      uint64_t value{0u};
+      if (read(event.fd, &value, sizeof(value)) ==
+          static_cast<ssize_t>(sizeof(value)))
+      {
+        event.count = value;
+      }
+    }
+#endif
+
+    auto &counters = Allocations();
+    counters.counting = false;
+    this->allocations += counters.allocations.load() - this->startAllocations;
+    this->bytes += counters.bytes.load() - this->startBytes;
+  }
+
+  /// \brief Open the perf events which are reported, disabled.
+  private: void OpenPerfEvents()
+  {
+#ifdef __linux__
+    for (const auto &[name, config] :
+         {std::make_pair("instructions", PERF_COUNT_HW_INSTRUCTIONS),
+          std::make_pair("cache_misses", PERF_COUNT_HW_CACHE_MISSES)})
+    {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = config;
+      attr.disabled = 1;
+      attr.inherit = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+
+      const int fd = static_cast<int>(
+          syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+      if (fd < 0)
+      {
+        ignwarn << "Failed to open perf event [" << name << "]: "
+                << std::strerror(errno) << std::endl;
+        continue;
+      }
+      this->events.push_back({name, fd, 0u});
+    }
+#else
+    ignwarn << "Perf events are only supported on Linux." << std::endl;
+#endif
+  }
+
+  /// \brief A hardware event counted through perf.
+  private: struct PerfEvent
+  {
+    /// \brief Name of the reported counter.
+    std::string name;
+
+    /// \brief File descriptor of the event.
+    int fd;
+
+    /// \brief Count of the event while counting. Perf events accumulate
+    /// while they're enabled, so this is the latest value read.
+    uint64_t count;
+  };
+
+  /// \brief State of the benchmark.
+  private: benchmark::State &st;
+
+  /// \brief True if counting.
+  private: bool countAllocations{false};
+
+  /// \brief Allocations counted so far.
+  private: uint64_t allocations{0u};
+
+  /// \brief Bytes allocated so far.
+  private: uint64_t bytes{0u};
+
+  /// \brief Allocations when counting was last started.
+  private: uint64_t startAllocations{0u};
+
+  /// \brief Bytes allocated when counting was last started.
+  private: uint64_t startBytes{0u};
+
+  /// \brief Perf events which are reported.
+  private: std::vector<PerfEvent> events;
+};
+}
+}
+}
+
+/////////////////////////////////////////////////
+// Replacements of the global operator new and delete, which count
+// allocations while a BenchmarkInstrumentation counts. They're used by
+// the shared libraries of the benchmark as well.
+void *operator new(std::size_t _size)
+{
+  auto &counters = ignition::gazebo::test::Allocations();
+  if (counters.counting.load(std::memory_order_relaxed))
+  {
+    counters.allocations.fetch_add(1u, std::memory_order_relaxed);
+    counters.bytes.fetch_add(_size, std::memory_order_relaxed);
+  }
+
+  if (void *ptr = std::malloc(_size == 0u ? 1u : _size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+/////////////////////////////////////////////////
+void *operator new[](std::size_t _size)
+{
+  return ::operator new(_size);
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_ptr) noexcept
+{
+  std::free(_ptr);
+}
+
+/////////////////////////////////////////////////
+void operator delete[](void *_ptr) noexcept
+{
+  std::free(_ptr);
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_ptr, std::size_t) noexcept
+{
+  std::free(_ptr);
+}
+
+/////////////////////////////////////////////////
+void operator delete[](void *_ptr, std::size_t) noexcept
+{
+  std::free(_ptr);
+}
+
+#endif
@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_TEST_HELPERS_WORLDGENERATOR_HH_
+#define IGNITION_GAZEBO_TEST_HELPERS_WORLDGENERATOR_HH_
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <sdf/Root.hh>
+
+#include <ignition/gazebo/test_config.hh>
+
+#include "ignition/gazebo/Entity.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/EventManager.hh"
+#include "ignition/gazebo/SdfEntityCreator.hh"
+
+namespace ignition
+{
+namespace gazebo
+{
+namespace test
+{
+/// \brief Generates worlds of any size for performance tests and
+/// benchmarks, so scaling can be measured without handcrafted SDF files.
+///
+/// Models are laid out on a square grid. Each model is a chain of box
+/// links connected by revolute joints, optionally with mesh collisions and
+/// sensors on every link. The grid can be split into levels, with the first
+/// model as the performer.
+///
+/// ## Usage
+///
+///  // 1000 robots with 4 links and an IMU each
+///  test::WorldGenerator generator;
+///  generator.models = 1000;
+///  generator.links = 4;
+///  generator.sensors = 1;
+///
+///  ServerConfig config;
+///  config.SetSdfString(generator.Sdf());
+///
+class WorldGenerator
+{
+  /// \brief World name.
+  public: std::string name{"default"};
+
+  /// \brief Number of models.
+  public: unsigned int models{100u};
+
+  /// \brief Number of links in each model. Consecutive links are connected
+  /// by revolute joints.
+  public: unsigned int links{1u};
+
+  /// \brief True to use mesh collisions instead of boxes.
+  public: bool meshCollisions{false};
+
+  /// \brief Mesh used for collisions and visuals when meshCollisions is
+  /// true.
+  public: std::string meshUri{common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "media", "duck_collider.dae")};
+
+  /// \brief Number of sensors on each link.
+  public: unsigned int sensors{0u};
+
+  /// \brief Type of the sensors, such as "imu" or "altimeter".
+  public: std::string sensorType{"imu"};
+
+  /// \brief Number of levels along each side of the grid, so there are
+  /// this number squared levels. Zero doesn't create levels.
+  public: unsigned int levelsPerSide{0u};
+
+  /// \brief Distance between neighboring models on the grid, in meters.
+  public: double spacing{2.0};
+
+  /// \brief True to load the physics system and a ground plane.
+  public: bool physics{true};
+
+  /// \brief Number of models along each side of the grid.
+  /// \return Grid side.
+  public: unsigned int GridSide() const
+  {
+    return std::max(1u, static_cast<unsigned int>(
+        std::ceil(std::sqrt(static_cast<double>(this->models)))));
+  }
+
+  /// \brief Name of a generated model.
+  /// \param[in] _index Model index.
+  /// \return Model name.
+  public: static std::string ModelName(unsigned int _index)
+  {
+    return "model_" + std::to_string(_index);
+  }
+
+  /// \brief Generate the world.
+  /// \return SDF of the world.
+  public: std::string Sdf() const
+  {
+    std::stringstream sdf;
+    sdf << "<?xml version='1.0' ?><sdf version='1.6'>"
+        << "<world name='" << this->name << "'>"
+        << "<physics name='1ms' type='ignored'>"
+        << "<max_step_size>0.001</max_step_size>"
+        << "<real_time_factor>0</real_time_factor></physics>";
+
+    if (this->physics)
+    {
+      sdf << "<plugin filename='ignition-gazebo-physics-system' "
+          << "name='ignition::gazebo::systems::Physics'/>"
+          << "<model name='ground_plane'><static>true</static>"
+          << "<link name='link'><collision name='collision'><geometry>"
+          << "<plane><normal>0 0 1</normal><size>10000 10000</size></plane>"
+          << "</geometry></collision></link></model>";
+    }
+
+    const auto side = this->GridSide();
+    for (unsigned int i = 0; i < this->models; ++i)
+    {
+      sdf << "<model name='" << ModelName(i) << "'><pose>"
+          << (i % side) * this->spacing << " " << (i / side) * this->spacing
+          << " 0.1 0 0 0</pose>";
+      for (unsigned int j = 0; j < this->links; ++j)
+      {
+        sdf << this->LinkSdf(j);
+        if (j > 0)
+        {
+          sdf << "<joint name='joint_" << j << "' type='revolute'>"
+              << "<parent>link_" << j - 1 << "</parent>"
+              << "<child>link_" << j << "</child>"
+              << "<axis><xyz>1 0 0</xyz></axis></joint>";
+        }
+      }
+      sdf << "</model>";
+    }
+
+    sdf << this->LevelsSdf() << "</world></sdf>";
+    return sdf.str();
+  }
+
+  /// \brief Generate the world and create its entities.
+  /// \param[in] _ecm ECM to create the entities in.
+  /// \param[in] _eventMgr Event manager used by the entity creator.
+  /// \return The world entity, or kNullEntity if the SDF failed to parse.
+  public: Entity CreateEntities(EntityComponentManager &_ecm,
+      EventManager &_eventMgr) const
+  {
+    sdf::Root root;
+    auto errors = root.LoadSdfString(this->Sdf());
+    if (!errors.empty() || root.WorldCount() != 1u)
+    {
+      ignerr << "Failed to parse generated world." << std::endl;
+      return kNullEntity;
+    }
+
+    SdfEntityCreator creator(_ecm, _eventMgr);
+    return creator.CreateEntities(root.WorldByIndex(0));
+  }
+
+  /// \brief Generate one link of a model.
+  /// \param[in] _index Link index in the model.
+  /// \return Link SDF.
+  private: std::string LinkSdf(unsigned int _index) const
+  {
+    std::stringstream geometry;
+    if (this->meshCollisions)
+      geometry << "<mesh><uri>" << this->meshUri << "</uri></mesh>";
+    else
+      geometry << "<box><size>0.2 0.2 0.2</size></box>";
+
+    std::stringstream sdf;
+    sdf << "<link name='link_" << _index << "'>"
+        << "<pose>0 0 " << _index * 0.3 << " 0 0 0</pose>"
+        << "<inertial><mass>1</mass></inertial>"
+        << "<collision name='collision'><geometry>" << geometry.str()
+        << "</geometry></collision>"
+        << "<visual name='visual'><geometry>" << geometry.str()
+        << "</geometry></visual>";
+    for (unsigned int k = 0; k < this->sensors; ++k)
+    {
+      sdf << "<sensor name='sensor_" << k << "' type='" << this->sensorType
+          << "'><always_on>1</always_on><update_rate>100</update_rate>"
+          << "</sensor>";
+    }
+    sdf << "</link>";
+    return sdf.str();
+  }
+
+  /// \brief Generate the levels and the performer.
+  /// \return Levels SDF, or an empty string if there are no levels.
+  private: std::string LevelsSdf() const
+  {
+    if (this->levelsPerSide == 0u || this->models == 0u)
+      return "";
+
+    const auto side = this->GridSide();
+    const auto modelsPerLevel =
+        (side + this->levelsPerSide - 1u) / this->levelsPerSide;
+    const auto levelSize = modelsPerLevel * this->spacing;
+
+    std::stringstream sdf;
+    sdf << "<plugin name='ignition::gazebo' filename='dummy'>"
+        << "<performer name='performer'><ref>" << ModelName(0) << "</ref>"
+        << "<geometry><box><size>2 2 2</size></box></geometry></performer>";
+
+    // Every model except the performer belongs to the level it's in
+    std::vector<std::vector<unsigned int>> levelModels(
+        this->levelsPerSide * this->levelsPerSide);
+    for (unsigned int i = 1; i < this->models; ++i)
+    {
+      const auto row = (i / side) / modelsPerLevel;
+      const auto col = (i % side) / modelsPerLevel;
+      levelModels[row * this->levelsPerSide + col].push_back(i);
+    }
+
+    for (unsigned int row = 0; row < this->levelsPerSide; ++row)
+    {
+      for (unsigned int col = 0; col < this->levelsPerSide; ++col)
+      {
+        sdf << "<level name='level_" << row << "_" << col << "'>"
+            << "<pose>" << (col + 0.5) * levelSize - this->spacing * 0.5
+            << " " << (row + 0.5) * levelSize - this->spacing * 0.5
+            << " 0 0 0 0</pose>"
+            << "<geometry><box><size>" << levelSize << " " << levelSize
+            << " 1000</size></box></geometry>"
+            << "<buffer>" << this->spacing << "</buffer>";
+
+        for (auto i : levelModels[row * this->levelsPerSide + col])
+          sdf << "<ref>" << ModelName(i) << "</ref>";
+        sdf << "</level>";
+      }
+    }
+    sdf << "</plugin>";
+    return sdf.str();
+  }
+};
+}
+}
+}
+#endif
@@ -34,9 +34,13 @@
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/Server.hh"
 #include "ignition/gazebo/SystemLoader.hh"
+#include "ignition/gazebo/components/Collision.hh"
+#include "ignition/gazebo/components/Link.hh"
 #include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Visual.hh"
+#include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/test_config.hh"
 
 #include "helpers/Relay.hh"
@@ -513,6 +517,91 @@ TEST_F(BreadcrumbsTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(DeployDisablePhysics))
   this->server->Run(true, iterTestStart + 2001, false);
 }
 
+/////////////////////////////////////////////////
+// The test verifies that breadcrumbs can be cloned, and merged into a single
+// static model once their physics is disabled.
+TEST_F(BreadcrumbsTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(CloneAndMerge))
+{
+  // Start server
+  this->LoadWorld("test/worlds/breadcrumbs.sdf");
+
+  test::Relay testSystem;
+  transport::Node node;
+  auto deploy = node.Advertise<msgs::Empty>("/merge_deploy");
+
+  std::size_t iterTestStart = 100;
+  testSystem.OnPostUpdate([&](const UpdateInfo &_info,
+                              const EntityComponentManager &_ecm)
+  {
+    Entity world = _ecm.EntityByComponents(components::World());
+    if (_info.iterations == iterTestStart)
+    {
+      // Both fall freely as they don't collide
+      deploy.Publish(msgs::Empty());
+      deploy.Publish(msgs::Empty());
+    }
+    else if (_info.iterations == iterTestStart + 300)
+    {
+      // The second breadcrumb is a clone of the first, with the same links
+      for (const std::string name : {"B3_0", "B3_1"})
+      {
+        Entity b3 = _ecm.ChildByName<components::Model>(world, name);
+        ASSERT_NE(kNullEntity, b3) << name;
+        EXPECT_NE(kNullEntity, _ecm.ChildByName<components::Link>(b3, "body"))
+            << name;
+      }
+    }
+    else if (_info.iterations == iterTestStart + 1000)
+    {
+      EXPECT_EQ(kNullEntity,
+          _ecm.ChildByName<components::Model>(world, "B3_0"));
+      EXPECT_EQ(kNullEntity,
+          _ecm.ChildByName<components::Model>(world, "B3_1"));
+
+      Entity merged =
+          _ecm.ChildByName<components::Model>(world, "B3__merged__");
+      ASSERT_NE(kNullEntity, merged);
+      Entity mergedLink =
+          _ecm.ChildByName<components::Link>(merged, "merged_link");
+      ASSERT_NE(kNullEntity, mergedLink);
+      EXPECT_EQ(2u, _ecm.ChildrenByComponents(mergedLink,
+          components::Collision()).size());
+      EXPECT_EQ(2u, _ecm.ChildrenByComponents(mergedLink,
+          components::Visual()).size());
+
+      Entity collision = _ecm.ChildByName<components::Collision>(mergedLink,
+          "B3_0_body_collision");
+      ASSERT_NE(kNullEntity, collision);
+
+      Entity vehicleBlue =
+          _ecm.ChildByName<components::Model>(world, "vehicle_blue");
+      ASSERT_NE(kNullEntity, vehicleBlue);
+      auto poseVehicle = _ecm.Component<components::Pose>(vehicleBlue);
+      ASSERT_NE(nullptr, poseVehicle);
+
+      // The merged collision is where the breadcrumb stopped falling after
+      // 0.5s, the merged model being at the origin
+      auto poseCollision = _ecm.Component<components::Pose>(collision);
+      ASSERT_NE(nullptr, poseCollision);
+      auto poseDiff = poseVehicle->Data().Inverse() * poseCollision->Data();
+      EXPECT_NEAR(-2.2, poseDiff.Pos().X(), 1e-2);
+      EXPECT_NEAR(0.0, poseDiff.Pos().Y(), 1e-2);
+
+      sdf::Root root;
+      root.Load(this->serverConfig.SdfFile());
+      const sdf::World *sdfWorld = root.WorldByIndex(0);
+      double gz = sdfWorld->Gravity().Z();
+      double z0 = 2.0 + 0.25;
+      double t = 0.5;
+      double z = z0 + gz/2*t*t;
+      EXPECT_NEAR(z, poseDiff.Pos().Z(), 2e-2);
+    }
+  });
+
+  this->server->AddSystem(testSystem.systemPtr);
+  this->server->Run(true, iterTestStart + 1001, false);
+}
+
 /////////////////////////////////////////////////
 // The test verifies that if allow_renaming is true, the Breadcrumb system
 // renames spawned models if a model with the same name exists.
@@ -43,6 +43,7 @@
 #include "ignition/gazebo/components/CanonicalLink.hh"
 #include "ignition/gazebo/components/ChildLinkName.hh"
 #include "ignition/gazebo/components/Collision.hh"
+#include "ignition/gazebo/components/ContactPoints.hh"
 #include "ignition/gazebo/components/DetachableJoint.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Gravity.hh"
@@ -84,6 +85,7 @@
 #include "ignition/gazebo/components/TemperatureRange.hh"
 #include "ignition/gazebo/components/ThreadPitch.hh"
 #include "ignition/gazebo/components/Visual.hh"
+#include "ignition/gazebo/components/VisualLod.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/test_config.hh"  // NOLINT(build/include)
 #include "../helpers/EnvTestFixture.hh"
@@ -382,6 +384,40 @@ TEST_F(ComponentsTest, Collision)
   comp3.Deserialize(istr);
 }
 
+/////////////////////////////////////////////////
+TEST_F(ComponentsTest, ContactPoints)
+{
+  contact::ContactPoint point;
+  point.collision1 = 1;
+  point.collision2 = 2;
+  point.position = math::Vector3d(1, 2, 3);
+  point.normal = math::Vector3d(0, 0, 1);
+  point.depth = 0.5;
+
+  // Create components
+  auto comp1 = components::ContactPoints({point, point});
+  auto comp2 = components::ContactPoints({point, point});
+
+  // Equality operators
+  EXPECT_EQ(comp1, comp2);
+  EXPECT_TRUE(comp1 == comp2);
+  EXPECT_FALSE(comp1 != comp2);
+
+  point.depth = 0.1;
+  auto comp3 = components::ContactPoints({point});
+  EXPECT_NE(comp1, comp3);
+
+  // Stream operators
+  std::ostringstream ostr;
+  comp1.Serialize(ostr);
+  EXPECT_EQ("2 1 2 1 2 3 0 0 1 0.5 1 2 1 2 3 0 0 1 0.5", ostr.str());
+
+  std::istringstream istr(ostr.str());
+  components::ContactPoints comp4;
+  comp4.Deserialize(istr);
+  EXPECT_EQ(comp1, comp4);
+}
+
 /////////////////////////////////////////////////
 TEST_F(ComponentsTest, DetachableJoint)
 {
@@ -1641,6 +1677,39 @@ TEST_F(ComponentsTest, Visual)
   comp3.Deserialize(istr);
 }
 
+/////////////////////////////////////////////////
+TEST_F(ComponentsTest, VisualLod)
+{
+  lod::Level low;
+  low.distance = 10.0;
+  low.mesh = "/path with spaces/low.dae";
+
+  lod::Level hidden;
+  hidden.distance = 100.0;
+
+  // Create components
+  auto comp1 = components::VisualLod({low, hidden});
+  auto comp2 = components::VisualLod({low, hidden});
+
+  // Equality operators
+  EXPECT_EQ(comp1, comp2);
+  EXPECT_TRUE(comp1 == comp2);
+  EXPECT_FALSE(comp1 != comp2);
+
+  auto comp3 = components::VisualLod({low});
+  EXPECT_NE(comp1, comp3);
+
+  // Stream operators
+  std::ostringstream ostr;
+  comp1.Serialize(ostr);
+  EXPECT_EQ("2 10 \"/path with spaces/low.dae\" 100 \"\"", ostr.str());
+
+  std::istringstream istr(ostr.str());
+  components::VisualLod comp4;
+  comp4.Deserialize(istr);
+  EXPECT_EQ(comp1, comp4);
+}
+
 /////////////////////////////////////////////////
 TEST_F(ComponentsTest, World)
 {
@@ -185,6 +185,62 @@ TEST_P(FollowActorTest,
   EXPECT_EQ(iterations / 500, boxMoveCount);
 }
 
+/////////////////////////////////////////////////
+TEST_P(FollowActorTest, IGN_UTILS_TEST_ENABLED_ONLY_ON_LINUX(Crowd))
+{
+  // Start server
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/follow_actor_crowd.sdf");
+
+  Server server(serverConfig);
+  EXPECT_FALSE(server.Running());
+  EXPECT_FALSE(*server.Running(0));
+
+  unsigned int postUpdateCount{0};
+  math::Vector3d first;
+  math::Vector3d second;
+
+  // Record the trajectory poses of both actors
+  Relay testSystem;
+  testSystem.OnPostUpdate(
+    [&](const gazebo::UpdateInfo &,
+        const gazebo::EntityComponentManager &_ecm)
+    {
+      auto firstEntity = _ecm.EntityByComponents(
+        components::Name("walker_1"));
+      auto secondEntity = _ecm.EntityByComponents(
+        components::Name("walker_2"));
+      ASSERT_NE(kNullEntity, firstEntity);
+      ASSERT_NE(kNullEntity, secondEntity);
+
+      auto firstComp = _ecm.Component<components::TrajectoryPose>(
+          firstEntity);
+      auto secondComp = _ecm.Component<components::TrajectoryPose>(
+          secondEntity);
+      ASSERT_NE(nullptr, firstComp);
+      ASSERT_NE(nullptr, secondComp);
+      first = firstComp->Data().Pos();
+      second = secondComp->Data().Pos();
+
+      postUpdateCount++;
+    });
+  server.AddSystem(testSystem.systemPtr);
+
+  unsigned int iterations{400};
+  server.Run(true /* blocking */, iterations, false /* paused */);
+  EXPECT_EQ(iterations, postUpdateCount);
+
+  // Both actors walked towards the box
+  EXPECT_GT(first.X(), 0.2);
+  EXPECT_GT(second.X(), 0.2);
+
+  // They started 0.2 m apart, within each other's avoidance radius, and
+  // moved apart while walking
+  EXPECT_GT(first.Distance(second), 0.3);
+  EXPECT_GT(first.Y(), second.Y());
+}
+
 // Run multiple times
 INSTANTIATE_TEST_SUITE_P(ServerRepeat, FollowActorTest,
     ::testing::Range(1, 2));
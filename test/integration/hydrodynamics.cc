@@ -43,18 +43,21 @@ class HydrodynamicsTest : public InternalFixture<::testing::Test>
   /// \brief Test a world file
   /// \param[in] _world Path to world file
   /// \param[in] _namespace Namespace for topic
+  /// \param[in] _linkName Name of the body's link, defaults to
+  /// `<namespace>_link`
   /// \param[in] _density Fluid density
   /// \param[in] _viscosity Fluid viscosity
   /// \param[in] _radius Body's radius
   /// \param[in] _area Body surface area
   /// \param[in] _drag_coeff Body drag coefficient
   public: std::vector<math::Vector3d> TestWorld(const std::string &_world,
-   const std::string &_namespace);
+   const std::string &_namespace, const std::string &_linkName = "");
 };
 
 //////////////////////////////////////////////////
 std::vector<math::Vector3d> HydrodynamicsTest::TestWorld(
-  const std::string &_world, const std::string &_namespace)
+  const std::string &_world, const std::string &_namespace,
+  const std::string &_linkName)
 {
   // Maximum verbosity for debugging
   ignition::common::Console::SetVerbosity(4);
@@ -81,7 +84,8 @@ std::vector<math::Vector3d> HydrodynamicsTest::TestWorld(
       EXPECT_NE(modelEntity, kNullEntity);
       model = Model(modelEntity);
 
-      auto bodyEntity = model.LinkByName(_ecm, _namespace + "_link");
+      auto bodyEntity = model.LinkByName(_ecm,
+          _linkName.empty() ? _namespace + "_link" : _linkName);
       EXPECT_NE(bodyEntity, kNullEntity);
 
       body = Link(bodyEntity);
@@ -175,3 +179,25 @@ TEST_F(HydrodynamicsTest,
     EXPECT_NEAR(cylinder2Vels[i].Z(), cylinder3Vels[i].Z(), 1e-4);
   }
 }
+
+/////////////////////////////////////////////////
+/// This test checks that a hydrodynamics plugin attached to the world acts
+/// on the links of all vehicles like a plugin attached to each vehicle.
+TEST_F(HydrodynamicsTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(WorldMode))
+{
+  auto world = common::joinPaths(std::string(PROJECT_SOURCE_PATH),
+      "test", "worlds", "hydrodynamics_world_mode.sdf");
+
+  auto referenceVels = this->TestWorld(world, "reference", "reference_link");
+  auto vehicle1Vels = this->TestWorld(world, "vehicle1", "body");
+  auto vehicle2Vels = this->TestWorld(world, "vehicle2", "body");
+
+  for (unsigned int i = 0; i < 1000; ++i)
+  {
+    EXPECT_NEAR(referenceVels[i].Z(), vehicle1Vels[i].Z(), 1e-6);
+    EXPECT_NEAR(referenceVels[i].Z(), vehicle2Vels[i].Z(), 1e-6);
+  }
+
+  // Drag slowed the vehicles down
+  EXPECT_LT(vehicle1Vels.back().Z(), vehicle1Vels[1].Z());
+}
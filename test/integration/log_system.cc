@@ -23,6 +23,9 @@
 #ifndef __APPLE__
 #include <filesystem>
 #endif
+#include <fstream>
+#include <iterator>
+#include <map>
 #include <numeric>
 #include <string>
 
@@ -1724,3 +1727,201 @@ TEST_F(LogSystemTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(RecordPeriod))
   this->CreateLogsDir();
 #endif
 }
+
+/////////////////////////////////////////////////
+TEST_F(LogSystemTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(Keyframes))
+{
+  // Create temp directory to store log
+  this->CreateLogsDir();
+
+  // Record with the plugin from SDF, with a keyframe every 100 ms
+  {
+    const auto recordSdfPath = common::joinPaths(
+      std::string(PROJECT_SOURCE_PATH), "test", "worlds",
+      "log_record_dbl_pendulum.sdf");
+
+    std::ifstream sdfFile(recordSdfPath);
+    std::string sdfString((std::istreambuf_iterator<char>(sdfFile)),
+        std::istreambuf_iterator<char>());
+
+    const std::string pluginName =
+        "name=\"ignition::gazebo::systems::LogRecord\">";
+    auto pluginPos = sdfString.find(pluginName);
+    ASSERT_NE(std::string::npos, pluginPos);
+    sdfString.insert(pluginPos + pluginName.size(),
+        "<record_path>" + this->logDir + "</record_path>"
+        "<keyframe_period>0.1</keyframe_period>");
+
+    ServerConfig recordServerConfig;
+    recordServerConfig.SetSdfString(sdfString);
+
+    // 1 s of sim time
+    Server recordServer(recordServerConfig);
+    recordServer.Run(true, 1000, false);
+  }
+
+  auto logFile = common::joinPaths(this->logDir, "state.tlog");
+  ASSERT_TRUE(common::exists(logFile));
+
+  transport::log::Log log;
+  ASSERT_TRUE(log.Open(logFile));
+
+  // Keyframes hold the full state, not just what changed
+  auto batch = log.QueryMessages(transport::log::TopicPattern(
+      std::regex(".*/keyframe_state")));
+  int keyframeCount{0};
+  std::chrono::steady_clock::duration lastTime{0};
+  for (const auto &keyframe : batch)
+  {
+    EXPECT_EQ("ignition.msgs.SerializedStateMap", keyframe.Type());
+    msgs::SerializedStateMap keyframeMsg;
+    EXPECT_TRUE(keyframeMsg.ParseFromString(keyframe.Data()));
+    EXPECT_LE(33, keyframeMsg.entities_size());
+
+    if (keyframeCount > 0)
+    {
+      EXPECT_NEAR(0.1, std::chrono::duration<double>(
+          keyframe.TimeReceived() - lastTime).count(), 0.002);
+    }
+    lastTime = keyframe.TimeReceived();
+    ++keyframeCount;
+  }
+
+  // One keyframe at the start, then one every 100 ms
+  EXPECT_EQ(10, keyframeCount);
+
+  this->RemoveLogsDir();
+}
+
+/////////////////////////////////////////////////
+TEST_F(LogSystemTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(RecordFilters))
+{
+  // Create temp directory to store log
+  this->CreateLogsDir();
+
+  // Record only the poses of the pendulum
+  {
+    const auto recordSdfPath = common::joinPaths(
+      std::string(PROJECT_SOURCE_PATH), "test", "worlds",
+      "log_record_dbl_pendulum.sdf");
+
+    std::ifstream sdfFile(recordSdfPath);
+    std::string sdfString((std::istreambuf_iterator<char>(sdfFile)),
+        std::istreambuf_iterator<char>());
+
+    const std::string pluginName =
+        "name=\"ignition::gazebo::systems::LogRecord\">";
+    auto pluginPos = sdfString.find(pluginName);
+    ASSERT_NE(std::string::npos, pluginPos);
+    sdfString.insert(pluginPos + pluginName.size(),
+        "<record_path>" + this->logDir + "</record_path>"
+        "<record_entity>double_pendulum_with_base</record_entity>"
+        "<record_component>Pose</record_component>");
+
+    ServerConfig recordServerConfig;
+    recordServerConfig.SetSdfString(sdfString);
+
+    Server recordServer(recordServerConfig);
+    recordServer.Run(true, 100, false);
+  }
+
+  auto logFile = common::joinPaths(this->logDir, "state.tlog");
+  ASSERT_TRUE(common::exists(logFile));
+
+  transport::log::Log log;
+  ASSERT_TRUE(log.Open(logFile));
+
+  auto batch = log.QueryMessages(transport::log::TopicPattern(
+      std::regex(".*/changed_state")));
+  int msgCount{0};
+  for (const auto &msg : batch)
+  {
+    msgs::SerializedStateMap stateMsg;
+    EXPECT_TRUE(stateMsg.ParseFromString(msg.Data()));
+    for (const auto &[id, entityMsg] : stateMsg.entities())
+    {
+      auto name = entityMsg.components().find(
+          static_cast<int64_t>(components::Name::typeId));
+      if (name != entityMsg.components().end())
+      {
+        components::Name nameComp;
+        std::istringstream istr(name->second.component());
+        nameComp.Deserialize(istr);
+        EXPECT_NE("ground_plane", nameComp.Data());
+      }
+
+      // After the entities are created, only poses are recorded
+      if (msgCount > 0)
+      {
+        for (const auto &[type, compMsg] : entityMsg.components())
+          EXPECT_EQ(components::Pose::typeId, compMsg.type());
+      }
+    }
+    ++msgCount;
+  }
+  EXPECT_LT(1, msgCount);
+
+  this->RemoveLogsDir();
+}
+
+/////////////////////////////////////////////////
+TEST_F(LogSystemTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(PlaybackBatchToSensors))
+{
+  // Create temp directory to store log
+  this->CreateLogsDir();
+
+  // Record a world without rendering sensors
+  {
+    const auto recordSdfPath = common::joinPaths(
+      std::string(PROJECT_SOURCE_PATH), "test", "worlds",
+      "log_record_dbl_pendulum.sdf");
+
+    ServerConfig recordServerConfig;
+    recordServerConfig.SetSdfFile(recordSdfPath);
+    recordServerConfig.SetUseLogRecord(true);
+    recordServerConfig.SetLogRecordPath(this->logDir);
+
+    Server recordServer(recordServerConfig);
+    recordServer.Run(true, 500, false);
+  }
+  ASSERT_TRUE(common::exists(common::joinPaths(this->logDir, "state.tlog")));
+
+  ServerConfig playServerConfig;
+  playServerConfig.SetLogPlaybackPath(this->logDir);
+  playServerConfig.SetLogPlaybackBatchToSensors(true);
+  Server playServer(playServerConfig);
+
+  // Count the steps on which any pose changed
+  std::map<Entity, math::Pose3d> poses;
+  int changedSteps{0};
+  test::Relay poseChecker;
+  poseChecker.OnPostUpdate(
+      [&](const UpdateInfo &, const EntityComponentManager &_ecm)
+      {
+        bool changed{false};
+        bool first = poses.empty();
+        _ecm.Each<components::Pose>(
+            [&](const Entity &_entity, const components::Pose *_pose)
+            {
+              auto &pose = poses[_entity];
+              if (!first && pose != _pose->Data())
+                changed = true;
+              pose = _pose->Data();
+              return true;
+            });
+        if (changed)
+          ++changedSteps;
+      });
+  playServer.AddSystem(poseChecker.systemPtr);
+
+  // Nothing renders, so recorded state is held back
+  playServer.Run(true, 400, false);
+  EXPECT_FALSE(poses.empty());
+  EXPECT_EQ(0, changedSteps);
+
+  // And applied all at once at the end of the log
+  playServer.Run(true, 200, false);
+  EXPECT_EQ(1, changedSteps);
+
+  this->RemoveLogsDir();
+}
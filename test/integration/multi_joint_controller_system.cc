@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ignition/msgs/double_v.pb.h>
+
+#include <map>
+#include <string>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Util.hh>
+#include <ignition/transport/Node.hh>
+#include <ignition/utilities/ExtraTestMacros.hh>
+
+#include "ignition/gazebo/components/Joint.hh"
+#include "ignition/gazebo/components/JointPosition.hh"
+#include "ignition/gazebo/components/JointVelocity.hh"
+#include "ignition/gazebo/components/Name.hh"
+
+#include "ignition/gazebo/Server.hh"
+#include "ignition/gazebo/SystemLoader.hh"
+#include "ignition/gazebo/test_config.hh"
+
+#include "../helpers/Relay.hh"
+#include "../helpers/EnvTestFixture.hh"
+
+#define TOL 1e-4
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Test fixture for MultiJointController system
+class MultiJointControllerTestFixture
+  : public InternalFixture<::testing::Test>
+{
+};
+
+/////////////////////////////////////////////////
+// Tests that one MultiJointController drives joints in different modes
+// from a single topic
+TEST_F(MultiJointControllerTestFixture,
+       IGN_UTILS_TEST_DISABLED_ON_WIN32(PositionAndVelocity))
+{
+  using namespace std::chrono_literals;
+
+  // Start server
+  ServerConfig serverConfig;
+  const auto sdfFile = std::string(PROJECT_SOURCE_PATH) +
+    "/test/worlds/multi_joint_controller.sdf";
+  serverConfig.SetSdfFile(sdfFile);
+
+  Server server(serverConfig);
+  EXPECT_FALSE(server.Running());
+  EXPECT_FALSE(*server.Running(0));
+
+  server.SetUpdatePeriod(0ns);
+
+  test::Relay testSystem;
+  std::map<std::string, double> positions;
+  std::map<std::string, double> velocities;
+  testSystem.OnPreUpdate(
+      [&](const UpdateInfo &, EntityComponentManager &_ecm)
+      {
+        // j2's velocity isn't read by the controller, ask physics for it
+        auto joint = _ecm.EntityByComponents(components::Joint(),
+                                             components::Name("j2"));
+        if (nullptr == _ecm.Component<components::JointVelocity>(joint))
+        {
+          _ecm.CreateComponent(joint, components::JointVelocity());
+        }
+      });
+
+  testSystem.OnPostUpdate([&](const UpdateInfo &,
+                              const EntityComponentManager &_ecm)
+      {
+        _ecm.Each<components::Joint, components::Name>(
+            [&](const Entity &_entity,
+                const components::Joint *,
+                const components::Name *_name) -> bool
+            {
+              auto pos = _ecm.Component<components::JointPosition>(_entity);
+              if (pos && !pos->Data().empty())
+                positions[_name->Data()] = pos->Data()[0];
+              auto vel = _ecm.Component<components::JointVelocity>(_entity);
+              if (vel && !vel->Data().empty())
+                velocities[_name->Data()] = vel->Data()[0];
+              return true;
+            });
+      });
+
+  server.AddSystem(testSystem.systemPtr);
+
+  const std::size_t initIters = 10;
+  server.Run(true, initIters, false);
+  ASSERT_EQ(1u, positions.count("j1"));
+  ASSERT_EQ(1u, velocities.count("j2"));
+  EXPECT_NEAR(0, positions["j1"], TOL);
+  EXPECT_NEAR(0, velocities["j2"], TOL);
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Double_V>(
+      "/model/multi_joint_controller_test/joint_cmd");
+
+  // Commands with the wrong number of joints are ignored
+  msgs::Double_V msg;
+  msg.add_data(2.0);
+  pub.Publish(msg);
+  std::this_thread::sleep_for(100ms);
+
+  server.Run(true, initIters, false);
+  EXPECT_NEAR(0, positions["j1"], TOL);
+
+  // Position for j1 and velocity for j2
+  const double targetPosition{2.0};
+  const double targetVelocity{0.5};
+  msg.Clear();
+  msg.add_data(targetPosition);
+  msg.add_data(targetVelocity);
+  pub.Publish(msg);
+  std::this_thread::sleep_for(100ms);
+
+  const std::size_t testIters = 1000;
+  server.Run(true, testIters, false);
+
+  EXPECT_NEAR(targetPosition, positions["j1"], TOL);
+  EXPECT_NEAR(targetVelocity, velocities["j2"], TOL);
+}
@@ -380,3 +380,57 @@ TEST_F(MulticopterTest,
   // one last check to verify drone is at least 5 meters off the ground
   EXPECT_LT(5.0, x3Pose.Pos().Z());
 }
+
+/////////////////////////////////////////////////
+// Test that a single instance attached to the world drives the rotors of all
+// models, each of which listens to its own commands
+TEST_F(MulticopterTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(WorldMode))
+{
+  // Start server
+  auto server = this->StartServer("/test/worlds/quadcopter_world_mode.sdf");
+
+  test::Relay testSystem;
+  transport::Node node;
+  auto cmdMotorSpeed =
+      node.Advertise<msgs::Actuators>("/X3/gazebo/command/motor_speed");
+
+  const std::size_t iterTestStart{100};
+  const std::size_t nIters{500};
+  testSystem.OnPostUpdate(
+      [&](const UpdateInfo &_info,
+          const EntityComponentManager &_ecm)
+      {
+        // Command a motor speed to X3 only
+        const double cmdSpeed{100};
+        if (_info.iterations == iterTestStart)
+        {
+          msgs::Actuators msg;
+          msg.mutable_velocity()->Resize(4, cmdSpeed);
+          cmdMotorSpeed.Publish(msg);
+        }
+        else if (_info.iterations == iterTestStart + nIters)
+        {
+          for (const std::string modelName : {"X3", "X4"})
+          {
+            Model model(_ecm.EntityByComponents(components::Model(),
+                components::Name(modelName)));
+            const double expected = modelName == "X3" ? cmdSpeed : 0.0;
+
+            int count = 0;
+            for (const auto &e : model.Joints(_ecm))
+            {
+              auto *jointVel = _ecm.Component<components::JointVelocity>(e);
+              ASSERT_NE(nullptr, jointVel);
+              ASSERT_FALSE(jointVel->Data().empty());
+              ++count;
+              EXPECT_NEAR(expected, std::abs(jointVel->Data()[0]), 1e-2)
+                  << modelName;
+            }
+            EXPECT_EQ(4, count) << modelName;
+          }
+        }
+      });
+
+  server->AddSystem(testSystem.systemPtr);
+  server->Run(true, iterTestStart + nIters, false);
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ignition/msgs/altimeter.pb.h>
+#include <ignition/msgs/fluid_pressure.pb.h>
+#include <ignition/msgs/imu.pb.h>
+#include <ignition/msgs/magnetometer.pb.h>
+#include <ignition/msgs/navsat.pb.h>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/transport/Node.hh>
+#include <ignition/utilities/ExtraTestMacros.hh>
+
+#include "ignition/gazebo/components/Sensor.hh"
+#include "ignition/gazebo/Server.hh"
+#include "ignition/gazebo/test_config.hh"
+
+#include "../helpers/Relay.hh"
+#include "../helpers/EnvTestFixture.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Test PhysicalSensors system
+class PhysicalSensorsTest : public InternalFixture<::testing::Test>
+{
+};
+
+/////////////////////////////////////////////////
+/// \brief Counts the messages received on a topic.
+class MsgCounter
+{
+  /// \brief Callback for any message type.
+  /// \param[in] _msg Message.
+  public: template <typename T>
+  void OnMsg(const T &/*_msg*/)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    ++this->count;
+  }
+
+  /// \brief Number of messages received.
+  /// \return Count.
+  public: std::size_t Count()
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->count;
+  }
+
+  /// \brief Protects count.
+  public: std::mutex mutex;
+
+  /// \brief Number of messages received.
+  public: std::size_t count{0u};
+};
+
+/////////////////////////////////////////////////
+// The test checks that every sensor publishes on its usual topic
+TEST_F(PhysicalSensorsTest, IGN_UTILS_TEST_ENABLED_ONLY_ON_LINUX(Publish))
+{
+  // Start server
+  ServerConfig serverConfig;
+  const auto sdfFile = std::string(PROJECT_SOURCE_PATH) +
+    "/test/worlds/physical_sensors.sdf";
+  serverConfig.SetSdfFile(sdfFile);
+
+  Server server(serverConfig);
+  EXPECT_FALSE(server.Running());
+  EXPECT_FALSE(*server.Running(0));
+
+  const std::string prefix =
+      "world/physical_sensors/model/sensors_model/link/link/sensor/";
+
+  // Check the topic components
+  std::vector<std::string> topics;
+  test::Relay testSystem;
+  testSystem.OnPostUpdate([&](const UpdateInfo &_info,
+                              const EntityComponentManager &_ecm)
+      {
+        // This component is created on the 2nd PreUpdate
+        if (_info.iterations != 2)
+          return;
+
+        _ecm.Each<components::Sensor, components::SensorTopic>(
+            [&](const Entity &,
+                const components::Sensor *,
+                const components::SensorTopic *_topic) -> bool
+            {
+              topics.push_back(_topic->Data());
+              return true;
+            });
+      });
+  server.AddSystem(testSystem.systemPtr);
+
+  transport::Node node;
+  MsgCounter imu;
+  MsgCounter altimeter;
+  MsgCounter magnetometer;
+  MsgCounter airPressure;
+  MsgCounter navSat;
+  node.Subscribe(prefix + "imu_sensor/imu",
+      &MsgCounter::OnMsg<msgs::IMU>, &imu);
+  node.Subscribe(prefix + "altimeter_sensor/altimeter",
+      &MsgCounter::OnMsg<msgs::Altimeter>, &altimeter);
+  node.Subscribe(prefix + "magnetometer_sensor/magnetometer",
+      &MsgCounter::OnMsg<msgs::Magnetometer>, &magnetometer);
+  node.Subscribe(prefix + "air_pressure_sensor/air_pressure",
+      &MsgCounter::OnMsg<msgs::FluidPressure>, &airPressure);
+  node.Subscribe(prefix + "navsat_sensor/navsat",
+      &MsgCounter::OnMsg<msgs::NavSat>, &navSat);
+
+  // Run server
+  size_t iters100 = 100u;
+  server.Run(true, iters100, false);
+
+  EXPECT_EQ(5u, topics.size());
+  for (const auto &name : {"imu_sensor/imu", "altimeter_sensor/altimeter",
+      "magnetometer_sensor/magnetometer", "air_pressure_sensor/air_pressure",
+      "navsat_sensor/navsat"})
+  {
+    EXPECT_NE(topics.end(),
+        std::find(topics.begin(), topics.end(), prefix + name)) << name;
+  }
+
+  // Wait for messages to be received
+  size_t updateRate = 30;
+  double stepSize = 0.001;
+  size_t waitForMsgs =
+      static_cast<size_t>(iters100 * stepSize * updateRate + 1);
+  for (int sleep = 0; sleep < 30; ++sleep)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (imu.Count() >= waitForMsgs && altimeter.Count() >= waitForMsgs &&
+        magnetometer.Count() >= waitForMsgs &&
+        airPressure.Count() >= waitForMsgs && navSat.Count() >= waitForMsgs)
+    {
+      break;
+    }
+  }
+
+  EXPECT_EQ(waitForMsgs, imu.Count());
+  EXPECT_EQ(waitForMsgs, altimeter.Count());
+  EXPECT_EQ(waitForMsgs, magnetometer.Count());
+  EXPECT_EQ(waitForMsgs, airPressure.Count());
+  EXPECT_EQ(waitForMsgs, navSat.Count());
+}
@@ -46,6 +46,7 @@
 #include "ignition/gazebo/components/AxisAlignedBox.hh"
 #include "ignition/gazebo/components/CanonicalLink.hh"
 #include "ignition/gazebo/components/Collision.hh"
+#include "ignition/gazebo/components/ExternalWorldWrenchCmd.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Inertial.hh"
 #include "ignition/gazebo/components/Joint.hh"
@@ -2264,3 +2265,79 @@ TEST_F(PhysicsSystemFixtureWithDart6_10,
   server->AddSystem(testSystem.systemPtr);
   server->Run(true, nIters, false);
 }
+
+/////////////////////////////////////////////////
+// Test that forces are applied on every sub-step, so sub-stepping doesn't
+// change the motion they cause
+TEST_F(PhysicsSystemFixture, IGN_UTILS_TEST_DISABLED_ON_WIN32(SubStepForces))
+{
+  // Pushes a floating box with a constant force and returns its position
+  auto push = [](unsigned int _substeps)
+  {
+    const std::string sdfStr = R"(
+<?xml version="1.0" ?>
+<sdf version="1.6">
+  <world name="substeps">
+    <physics name="1ms" type="ignored">
+      <max_step_size>0.001</max_step_size>
+      <real_time_factor>0</real_time_factor>
+    </physics>
+    <gravity>0 0 0</gravity>
+    <plugin
+      filename="ignition-gazebo-physics-system"
+      name="ignition::gazebo::systems::Physics">
+      <substeps>)" + std::to_string(_substeps) + R"(</substeps>
+    </plugin>
+    <model name="box">
+      <link name="link">
+        <inertial>
+          <mass>1.0</mass>
+        </inertial>
+        <collision name="collision">
+          <geometry><box><size>0.1 0.1 0.1</size></box></geometry>
+        </collision>
+      </link>
+    </model>
+  </world>
+</sdf>)";
+
+    ServerConfig serverConfig;
+    serverConfig.SetSdfString(sdfStr);
+    Server server(serverConfig);
+
+    math::Pose3d pose;
+    test::Relay testSystem;
+    testSystem.OnPreUpdate(
+        [&](const UpdateInfo &, EntityComponentManager &_ecm)
+        {
+          msgs::Wrench wrench;
+          msgs::Set(wrench.mutable_force(), math::Vector3d(2, 0, 0));
+          auto link = _ecm.EntityByComponents(components::Link(),
+              components::Name("link"));
+          ASSERT_NE(kNullEntity, link);
+          _ecm.SetComponentData<components::ExternalWorldWrenchCmd>(link,
+              wrench);
+        });
+    testSystem.OnPostUpdate(
+        [&](const UpdateInfo &, const EntityComponentManager &_ecm)
+        {
+          auto model = _ecm.EntityByComponents(components::Model(),
+              components::Name("box"));
+          auto poseComp = _ecm.Component<components::Pose>(model);
+          ASSERT_NE(nullptr, poseComp);
+          pose = poseComp->Data();
+        });
+    server.AddSystem(testSystem.systemPtr);
+    server.Run(true, 1000, false);
+    return pose;
+  };
+
+  // x = 0.5 * (F / m) * t^2 after 1s
+  const auto single = push(1u);
+  EXPECT_NEAR(1.0, single.Pos().X(), 1e-2);
+
+  const auto multiple = push(4u);
+  EXPECT_NEAR(single.Pos().X(), multiple.Pos().X(), 2e-3);
+  EXPECT_NEAR(0.0, multiple.Pos().Y(), 1e-6);
+  EXPECT_NEAR(0.0, multiple.Pos().Z(), 1e-6);
+}
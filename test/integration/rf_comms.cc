@@ -118,3 +118,70 @@ TEST_F(RFCommsTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(RFComms))
   }
   EXPECT_LT(expectedMsgCount, msgCounter);
 }
+
+/////////////////////////////////////////////////
+TEST_F(RFCommsTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(Broadcast))
+{
+  // Start server
+  ServerConfig serverConfig;
+  const auto sdfFile =
+    ignition::common::joinPaths(std::string(PROJECT_SOURCE_PATH),
+      "examples", "worlds", "rf_comms.sdf");
+  serverConfig.SetSdfFile(sdfFile);
+
+  Server server(serverConfig);
+  server.Run(true, 1000, false);
+
+  // Only the other radio receives the broadcasts
+  std::mutex mutex;
+  unsigned int addr1Counter = 0u;
+  unsigned int addr2Counter = 0u;
+  std::function<void(const msgs::Dataframe &)> cb1 =
+    [&](const msgs::Dataframe &_msg)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      EXPECT_EQ("broadcast", _msg.dst_address());
+      ASSERT_GT(_msg.header().data_size(), 0);
+      EXPECT_EQ("rssi", _msg.header().data(0).key());
+      addr1Counter++;
+    };
+  std::function<void(const msgs::Dataframe &)> cb2 =
+    [&](const msgs::Dataframe &)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      addr2Counter++;
+    };
+
+  ignition::transport::Node node;
+  EXPECT_TRUE(node.Subscribe("addr1/rx", cb1));
+  EXPECT_TRUE(node.Subscribe("addr2/rx", cb2));
+
+  auto pub = node.Advertise<ignition::msgs::Dataframe>("/broker/msgs");
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  ignition::msgs::Dataframe msg;
+  msg.set_src_address("addr2");
+  msg.set_dst_address("broadcast");
+  msg.set_data("hello world");
+
+  unsigned int pubCount = 10u;
+  for (unsigned int i = 0u; i < pubCount; ++i)
+  {
+    EXPECT_TRUE(pub.Publish(msg));
+    server.Run(true, 100, false);
+  }
+
+  // there is a non-zero probability that the packet may be lost
+  unsigned int expectedMsgCount = static_cast<unsigned int>(pubCount * 0.5);
+  int sleep = 0;
+  bool done = false;
+  while (!done && sleep++ < 10)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = addr1Counter > expectedMsgCount;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_LT(expectedMsgCount, addr1Counter);
+  EXPECT_EQ(0u, addr2Counter);
+}
@@ -28,7 +28,13 @@
 #pragma warning(pop)
 #endif
 
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
@@ -409,11 +415,34 @@ TEST_P(SceneBroadcasterTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(SpawnedModel))
     {
       found = rep.model(i).name() == "spawned_model";
       if (found)
+      {
+        // The whole subtree is included
+        ASSERT_EQ(1, rep.model(i).link_size());
+        EXPECT_EQ("link", rep.model(i).link(0).name());
+        ASSERT_EQ(1, rep.model(i).link(0).visual_size());
+        EXPECT_EQ("visual", rep.model(i).link(0).visual(0).name());
         break;
+      }
     }
     EXPECT_TRUE(found);
   }
   EXPECT_EQ(initEntityCount + 3, *server.EntityCount());
+
+  // Removed models leave the scene/info response
+  EXPECT_TRUE(server.RequestRemoveEntity("spawned_model"));
+  server.Run(true, 1, false);
+  {
+    msgs::Empty req;
+    msgs::Scene rep;
+    bool result;
+    unsigned int timeout = 2000;
+    EXPECT_TRUE(node.Request("/world/default/scene/info", req, timeout,
+          rep, result));
+    EXPECT_TRUE(result);
+
+    for (int i = 0; i < rep.model_size(); ++i)
+      EXPECT_NE("spawned_model", rep.model(i).name());
+  }
 }
 
 /////////////////////////////////////////////////
@@ -527,6 +556,67 @@ TEST_P(SceneBroadcasterTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(State))
   EXPECT_TRUE(received);
 }
 
+/////////////////////////////////////////////////
+TEST_P(SceneBroadcasterTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(StateQuery))
+{
+  // Start server
+  gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/shapes.sdf");
+
+  gazebo::Server server(serverConfig);
+  EXPECT_EQ(25u, *server.EntityCount());
+  server.Run(true, 1, false);
+
+  // Only the names of the world and the box's subtree
+  msgs::Param req;
+  auto &params = *req.mutable_params();
+  params["model"].set_type(msgs::Any::STRING);
+  params["model"].set_string_value("box");
+  params["component_types"].set_type(msgs::Any::STRING);
+  params["component_types"].set_string_value(
+      std::to_string(components::Name::typeId));
+
+  // The reply is only sent after a step, so request from another thread
+  transport::Node node;
+  msgs::SerializedStepMap res;
+  bool result{false};
+  std::atomic<bool> replied{false};
+  auto requestThread = std::thread([&]()
+  {
+    EXPECT_TRUE(node.Request("/world/default/state/query", req, 5000u, res,
+        result));
+    replied = true;
+  });
+
+  unsigned int sleep{0u};
+  unsigned int maxSleep{30u};
+  while (!replied && sleep++ < maxSleep)
+  {
+    server.Run(true, 1, false);
+    IGN_SLEEP_MS(100);
+  }
+  requestThread.join();
+  ASSERT_TRUE(result);
+
+  // World, model, link, collision and visual
+  ASSERT_TRUE(res.has_state());
+  EXPECT_EQ(5u, res.state().entities_size());
+  std::set<std::string> names;
+  for (const auto &[id, entity] : res.state().entities())
+  {
+    ASSERT_EQ(1u, entity.components_size()) << id;
+    const auto &comp = entity.components().begin()->second;
+    EXPECT_EQ(components::Name::typeId, comp.type());
+    components::Name name;
+    std::istringstream istr(comp.component());
+    name.Deserialize(istr);
+    names.insert(name.Data());
+  }
+  EXPECT_EQ(std::set<std::string>({"default", "box", "box_link",
+      "box_collision", "box_visual"}), names);
+}
+
 /////////////////////////////////////////////////
 TEST_P(SceneBroadcasterTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(StateStatic))
 {
@@ -890,6 +980,120 @@ TEST_P(SceneBroadcasterTest,
   EXPECT_GE(receivedStates, 7);
 }
 
+/////////////////////////////////////////////////
+TEST_P(SceneBroadcasterTest,
+    IGN_UTILS_TEST_DISABLED_ON_WIN32(DynamicPoseDelta))
+{
+  // A falling model and a floating model. Only the falling one should be in
+  // delta messages after the first keyframe.
+  std::string sdfStr = R"(
+<?xml version="1.0" ?>
+<sdf version="1.6">
+  <world name="default">
+    <physics name="1ms" type="ignored">
+      <max_step_size>0.001</max_step_size>
+      <real_time_factor>0</real_time_factor>
+    </physics>
+    <plugin
+      filename="ignition-gazebo-physics-system"
+      name="ignition::gazebo::systems::Physics">
+    </plugin>
+    <plugin
+      filename="ignition-gazebo-scene-broadcaster-system"
+      name="ignition::gazebo::systems::SceneBroadcaster">
+      <dynamic_pose_hertz>100000</dynamic_pose_hertz>
+      <dynamic_pose_delta>
+        <position>0.0001</position>
+        <orientation>0.0001</orientation>
+        <keyframe_period>1000</keyframe_period>
+      </dynamic_pose_delta>
+    </plugin>
+    <model name="falling">
+      <pose>0 0 10 0 0 0</pose>
+      <link name="link">
+        <collision name="collision">
+          <geometry><sphere><radius>0.5</radius></sphere></geometry>
+        </collision>
+      </link>
+    </model>
+    <model name="floating">
+      <pose>5 0 10 0 0 0</pose>
+      <link name="link">
+        <gravity>0</gravity>
+        <collision name="collision">
+          <geometry><sphere><radius>0.5</radius></sphere></geometry>
+        </collision>
+      </link>
+    </model>
+  </world>
+</sdf>)";
+  gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfString(sdfStr);
+
+  gazebo::Server server(serverConfig);
+  EXPECT_FALSE(server.Running());
+
+  std::mutex mutex;
+  std::vector<msgs::Pose_V> msgs;
+  std::function<void(const msgs::Pose_V &)> cb = [&](const msgs::Pose_V &_msg)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    msgs.push_back(_msg);
+  };
+  transport::Node node;
+  EXPECT_TRUE(node.Subscribe("/world/default/dynamic_pose/info", cb));
+
+  // Get the publisher connected before running
+  server.Run(true, 1, false);
+  IGN_SLEEP_MS(100);
+  server.Run(true, 100, false);
+
+  unsigned int sleep{0u};
+  unsigned int maxSleep{30u};
+  while (sleep++ < maxSleep)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (msgs.size() >= 10u)
+        break;
+    }
+    IGN_SLEEP_MS(100);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_GE(msgs.size(), 10u);
+
+  auto headerValue = [](const msgs::Pose_V &_msg, const std::string &_key)
+  {
+    for (const auto &data : _msg.header().data())
+    {
+      if (data.key() == _key && data.value_size() > 0)
+        return data.value(0);
+    }
+    return std::string();
+  };
+
+  // The first message published is a keyframe with all dynamic poses
+  uint64_t firstSeq = std::stoull(headerValue(msgs[0], "seq"));
+  if (firstSeq == 0u)
+  {
+    EXPECT_EQ("1", headerValue(msgs[0], "keyframe"));
+    EXPECT_EQ(4, msgs[0].pose_size());
+  }
+
+  for (std::size_t i = 1; i < msgs.size(); ++i)
+  {
+    // Sequence numbers have no gaps
+    EXPECT_EQ(firstSeq + i, std::stoull(headerValue(msgs[i], "seq")));
+    EXPECT_EQ("0", headerValue(msgs[i], "keyframe"));
+
+    // Only the falling model is moving. Link poses are relative to their
+    // model, so they don't change.
+    ASSERT_EQ(1, msgs[i].pose_size());
+    EXPECT_EQ("falling", msgs[i].pose(0).name());
+  }
+}
+
 /////////////////////////////////////////////////
 // Tests https://github.com/ignitionrobotics/ign-gazebo/issues/1414
 TEST_P(SceneBroadcasterTest,
@@ -930,6 +1134,113 @@ TEST_P(SceneBroadcasterTest,
   server.Run(true, 1, false);
 }
 
+/////////////////////////////////////////////////
+/// Test streaming the scene and state in chunks
+TEST_P(SceneBroadcasterTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(SceneStream))
+{
+  // Start server
+  gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/shapes.sdf");
+
+  gazebo::Server server(serverConfig);
+  server.Run(true, 1, false);
+
+  std::mutex mutex;
+  std::vector<msgs::Scene> scenes;
+  std::vector<msgs::SerializedStepMap> states;
+  transport::Node node;
+  std::function<void(const msgs::Scene &)> sceneCb =
+      [&](const msgs::Scene &_msg)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        scenes.push_back(_msg);
+      };
+  std::function<void(const msgs::SerializedStepMap &)> stateCb =
+      [&](const msgs::SerializedStepMap &_msg)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        states.push_back(_msg);
+      };
+  EXPECT_TRUE(node.Subscribe("/stream_test/scene", sceneCb));
+  EXPECT_TRUE(node.Subscribe("/stream_test/state", stateCb));
+
+  // Two models per chunk, nearest to the ellipsoid first, one chunk at a
+  // time
+  msgs::Param req;
+  (*req.mutable_params())["topic"].set_string_value("/stream_test");
+  (*req.mutable_params())["chunk_size"].set_int_value(2);
+  (*req.mutable_params())["window"].set_int_value(1);
+  msgs::Set((*req.mutable_params())["camera"].mutable_vector3d_value(),
+      math::Vector3d(4, 5, 6));
+  msgs::Boolean res;
+  bool result{false};
+  EXPECT_TRUE(node.Request("/world/default/scene/stream", req, 5000, res,
+      result));
+  EXPECT_TRUE(result);
+  EXPECT_TRUE(res.data());
+
+  auto waitForChunks = [&](std::size_t _count)
+  {
+    for (int sleep = 0; sleep < 50; ++sleep)
+    {
+      server.Run(true, 10, false);
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      std::lock_guard<std::mutex> lock(mutex);
+      if (scenes.size() >= _count && states.size() >= _count)
+        break;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(_count, scenes.size());
+    EXPECT_EQ(_count, states.size());
+  };
+
+  // Held back until acknowledged
+  waitForChunks(1u);
+  server.Run(true, 10, false);
+
+  msgs::StringMsg ack;
+  ack.set_data("/stream_test");
+  for (std::size_t count = 2u; count <= 3u; ++count)
+  {
+    EXPECT_TRUE(node.Request("/world/default/scene/stream/ack", ack));
+    waitForChunks(count);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(3u, scenes.size());
+  ASSERT_EQ(3u, states.size());
+
+  // The first chunk holds the world's lights
+  EXPECT_EQ(1, scenes[0].light_size());
+  EXPECT_EQ(0, scenes[1].light_size());
+
+  std::vector<std::string> names;
+  for (std::size_t i = 0; i < scenes.size(); ++i)
+  {
+    for (const auto &data : scenes[i].header().data())
+    {
+      if (data.key() == "chunk")
+        EXPECT_EQ(std::to_string(i), data.value(0));
+      else if (data.key() == "chunks")
+        EXPECT_EQ("3", data.value(0));
+    }
+    for (const auto &model : scenes[i].model())
+    {
+      names.push_back(model.name());
+      EXPECT_LT(0, model.link_size());
+
+      // The state chunk holds the model's entities
+      EXPECT_NE(states[i].state().entities().end(),
+          states[i].state().entities().find(model.id()));
+    }
+  }
+  ASSERT_EQ(5u, names.size());
+  EXPECT_EQ("ellipsoid", names[0]);
+  EXPECT_EQ("box", names[1]);
+  EXPECT_EQ("sphere", names[2]);
+}
+
 /////////////////////////////////////////////////
 TEST_P(SceneBroadcasterTest,
     IGN_UTILS_TEST_DISABLED_ON_WIN32(SceneInfoHasSceneSdf))
@@ -582,3 +582,14 @@ TEST_F(TrackedVehicleTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(Conveyor))
     "/test/worlds/conveyor.sdf",
     "/model/conveyor/link/base_link/track_cmd_vel");
 }
+
+/////////////////////////////////////////////////
+// Contact surfaces are customized from the physics step thread, while the
+// controller updates them in PreUpdate
+TEST_F(TrackedVehicleTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(AsyncConveyor))
+{
+  this->TestConveyor(
+    std::string(PROJECT_SOURCE_PATH) +
+    "/test/worlds/conveyor_async.sdf",
+    "/model/conveyor/link/base_link/track_cmd_vel");
+}
@@ -612,6 +612,37 @@ TEST_F(TriggeredPublisherTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(TriggerDelay))
   EXPECT_EQ(pubCount, recvCount);
 }
 
+/////////////////////////////////////////////////
+/// Check that matches pending at once are published a single time when
+/// outputs are batched
+TEST_F(TriggeredPublisherTest,
+       IGN_UTILS_TEST_DISABLED_ON_WIN32(BatchedOutputs))
+{
+  transport::Node node;
+  auto inputPub = node.Advertise<msgs::Empty>("/in_17");
+  std::atomic<std::size_t> recvCount{0};
+  auto msgCb = std::function<void(const msgs::Empty &)>(
+      [&recvCount](const auto &)
+      {
+        ++recvCount;
+      });
+  node.Subscribe("/out_17", msgCb);
+  IGN_SLEEP_MS(100ms);
+
+  const std::size_t pubCount{10};
+  for (std::size_t i = 0; i < pubCount; ++i)
+  {
+    EXPECT_TRUE(inputPub.Publish(msgs::Empty()));
+  }
+  IGN_SLEEP_MS(100ms);
+  EXPECT_EQ(0u, recvCount);
+
+  // All the delayed matches become due on the same step
+  this->server->Run(true, 1000, false);
+  waitUntil(1000, [&]{return recvCount > 1u;});
+  EXPECT_EQ(1u, recvCount);
+}
+
 TEST_F(TriggeredPublisherTest,
        IGN_UTILS_TEST_DISABLED_ON_WIN32(WrongInputWhenRepeatedFieldExpected))
 {
@@ -768,6 +768,37 @@ TEST_F(UserCommandsTest, IGN_UTILS_TEST_DISABLED_ON_WIN32(PoseVector))
   poseComp = ecm->Component<components::Pose>(sphereEntity);
   ASSERT_NE(nullptr, poseComp);
   EXPECT_NEAR(456, poseComp->Data().Pos().Y(), 0.2);
+
+  // Requests between steps are applied together, the last pose of each
+  // entity winning, and unknown entities don't stop the others
+  req.Clear();
+  poseBoxMsg = req.add_pose();
+  poseBoxMsg->set_name("box");
+  poseBoxMsg->mutable_position()->set_y(10.0);
+  auto poseUnknownMsg = req.add_pose();
+  poseUnknownMsg->set_name("unknown");
+  poseBoxMsg = req.add_pose();
+  poseBoxMsg->set_id(boxEntity);
+  poseBoxMsg->mutable_position()->set_y(20.0);
+  EXPECT_TRUE(node.Request(service, req, timeout, res, result));
+  EXPECT_TRUE(result);
+
+  msgs::Pose poseReq;
+  poseReq.set_name("sphere");
+  poseReq.mutable_position()->set_y(30.0);
+  EXPECT_TRUE(node.Request("/world/default/set_pose", poseReq, timeout, res,
+      result));
+  EXPECT_TRUE(result);
+
+  server.Run(true, 1, false);
+
+  poseComp = ecm->Component<components::Pose>(boxEntity);
+  ASSERT_NE(nullptr, poseComp);
+  EXPECT_NEAR(20.0, poseComp->Data().Pos().Y(), 0.2);
+
+  poseComp = ecm->Component<components::Pose>(sphereEntity);
+  ASSERT_NE(nullptr, poseComp);
+  EXPECT_NEAR(30.0, poseComp->Data().Pos().Y(), 0.2);
 }
 
 /////////////////////////////////////////////////
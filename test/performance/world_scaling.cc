@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2023 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+
+#include <ignition/common/Console.hh>
+#include <ignition/math/Stopwatch.hh>
+
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/EventManager.hh"
+#include "ignition/gazebo/Server.hh"
+#include "ignition/gazebo/ServerConfig.hh"
+#include "ignition/gazebo/test_config.hh"  // NOLINT(build/include)
+
+#include "../helpers/WorldGenerator.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Print how loading and stepping scale with the number of models.
+/// \param[in] _generator Generator of the worlds, its model count is varied.
+/// \param[in] _useLevels True to step with levels enabled.
+static void Scaling(test::WorldGenerator _generator, bool _useLevels)
+{
+  const uint64_t iterations{100u};
+
+  std::cout << "models\tentities\tload [ms]\tstep [us]" << std::endl;
+  for (unsigned int models : {10u, 100u, 1000u, 10000u})
+  {
+    _generator.models = models;
+
+    math::Stopwatch watch;
+    EntityComponentManager ecm;
+    EventManager eventMgr;
+    watch.Start(true);
+    EXPECT_NE(kNullEntity, _generator.CreateEntities(ecm, eventMgr));
+    watch.Stop();
+    const auto load = watch.ElapsedRunTime();
+
+    ServerConfig config;
+    config.SetSdfString(_generator.Sdf());
+    config.SetUseLevels(_useLevels);
+    Server server(config);
+    server.Run(true, 1, false);
+
+    watch.Start(true);
+    server.Run(true, iterations, false);
+    watch.Stop();
+    const auto step = watch.ElapsedRunTime() / iterations;
+
+    std::cout << models << "\t" << ecm.EntityCount() << "\t\t"
+              << std::chrono::duration<double, std::milli>(load).count()
+              << "\t\t"
+              << std::chrono::duration<double, std::micro>(step).count()
+              << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(WorldScalingPerformance, Boxes)
+{
+  common::Console::SetVerbosity(1);
+
+  test::WorldGenerator generator;
+  generator.physics = false;
+  Scaling(generator, false);
+}
+
+/////////////////////////////////////////////////
+TEST(WorldScalingPerformance, ArticulatedWithSensors)
+{
+  common::Console::SetVerbosity(1);
+
+  test::WorldGenerator generator;
+  generator.physics = false;
+  generator.links = 4u;
+  generator.sensors = 1u;
+  Scaling(generator, false);
+}
+
+/////////////////////////////////////////////////
+TEST(WorldScalingPerformance, Levels)
+{
+  common::Console::SetVerbosity(1);
+
+  test::WorldGenerator generator;
+  generator.physics = false;
+  generator.levelsPerSide = 4u;
+  Scaling(generator, true);
+}